@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/c/c_api_experimental.h"
 
+#include <cstring>
+#include <vector>
+
 #include "absl/strings/substitute.h"
 #include "tensorflow/c/c_api.h"
 #include "tensorflow/c/c_api_internal.h"
@@ -46,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/tensorflow_server.pb.h"
+#include "tensorflow/core/util/overflow.h"
 
 using tensorflow::FunctionDef;
 using tensorflow::Node;
@@ -750,3 +754,100 @@ TF_Library* TF_LoadPluggableDeviceLibrary(const char* library_filename,
 void TF_DeletePluggableDeviceLibraryHandle(TF_Library* lib_handle) {
   delete lib_handle;
 }
+
+TF_Tensor* TF_NewBorrowedTensor(TF_DataType dtype, const int64_t* dims,
+                                int num_dims, void* data, size_t len,
+                                void (*release)(void* data, size_t len,
+                                                void* arg),
+                                void* release_arg, TF_Status* status) {
+  if (release == nullptr) {
+    status->status =
+        tensorflow::errors::InvalidArgument("A release callback is required");
+    return nullptr;
+  }
+  const auto tf_dtype = static_cast<tensorflow::DataType>(dtype);
+  if (dtype == TF_STRING || dtype == TF_RESOURCE ||
+      !tensorflow::DataTypeCanUseMemcpy(tf_dtype)) {
+    status->status = tensorflow::errors::InvalidArgument(
+        "Cannot borrow a buffer for tensors of type ",
+        tensorflow::DataTypeString(tf_dtype));
+    return nullptr;
+  }
+  tensorflow::int64 expected_len = TF_DataTypeSize(dtype);
+  for (int i = 0; i < num_dims; ++i) {
+    if (dims[i] < 0) {
+      status->status = tensorflow::errors::InvalidArgument(
+          "Dimension ", i, " of a borrowed tensor is negative: ", dims[i]);
+      return nullptr;
+    }
+    expected_len = tensorflow::MultiplyWithoutOverflow(expected_len, dims[i]);
+    if (expected_len < 0) {
+      status->status = tensorflow::errors::InvalidArgument(
+          "The byte size of a borrowed tensor overflows at dimension ", i,
+          ": ", dims[i]);
+      return nullptr;
+    }
+  }
+  if (len != static_cast<size_t>(expected_len)) {
+    status->status = tensorflow::errors::InvalidArgument(
+        "Borrowed buffer has ", len, " bytes but its shape requires ",
+        expected_len);
+    return nullptr;
+  }
+  // TF_NewTensor wraps `data` without copying unless it is misaligned.
+  TF_Tensor* tensor =
+      TF_NewTensor(dtype, dims, num_dims, data, len, release, release_arg);
+  if (tensor == nullptr) {
+    status->status = tensorflow::errors::Internal(
+        "Failed to create a tensor from a borrowed buffer");
+    return nullptr;
+  }
+  status->status = tensorflow::Status::OK();
+  return tensor;
+}
+
+void TF_SessionRunWithOutputBuffers(
+    TF_Session* session, const TF_Buffer* run_options, const TF_Output* inputs,
+    TF_Tensor* const* input_values, int ninputs, const TF_Output* outputs,
+    TF_Tensor** output_values, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets,
+    TF_Buffer* run_metadata, TF_Status* status) {
+  std::vector<TF_Tensor*> results(noutputs, nullptr);
+  TF_SessionRun(session, run_options, inputs, input_values, ninputs, outputs,
+                results.data(), noutputs, target_opers, ntargets, run_metadata,
+                status);
+  for (int i = 0; status->status.ok() && i < noutputs; ++i) {
+    const TF_Tensor* src = results[i];
+    TF_Tensor* dst = output_values[i];
+    if (dst == nullptr) continue;
+    if (TF_TensorType(src) != TF_TensorType(dst) ||
+        TF_TensorByteSize(src) != TF_TensorByteSize(dst) ||
+        TF_TensorType(src) == TF_STRING || TF_TensorType(src) == TF_RESOURCE) {
+      status->status = tensorflow::errors::InvalidArgument(
+          "Output ", i, " of type ",
+          tensorflow::DataTypeString(
+              static_cast<tensorflow::DataType>(TF_TensorType(src))),
+          " with ", TF_TensorByteSize(src),
+          " bytes doesn't fit the provided buffer of type ",
+          tensorflow::DataTypeString(
+              static_cast<tensorflow::DataType>(TF_TensorType(dst))),
+          " with ", TF_TensorByteSize(dst), " bytes");
+      break;
+    }
+    if (TF_TensorData(src) != TF_TensorData(dst)) {
+      std::memcpy(TF_TensorData(dst), TF_TensorData(src),
+                  TF_TensorByteSize(src));
+    }
+  }
+  const bool ok = status->status.ok();
+  for (int i = 0; i < noutputs; ++i) {
+    if (output_values[i] != nullptr) {
+      // Provided by the caller: the result, if any, was copied into it.
+      if (results[i] != nullptr) TF_DeleteTensor(results[i]);
+    } else if (ok) {
+      output_values[i] = results[i];
+    } else if (results[i] != nullptr) {
+      TF_DeleteTensor(results[i]);
+    }
+  }
+}
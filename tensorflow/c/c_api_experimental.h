@@ -325,6 +325,43 @@ TF_CAPI_EXPORT extern TF_Library* TF_LoadPluggableDeviceLibrary(
 TF_CAPI_EXPORT extern void TF_DeletePluggableDeviceLibraryHandle(
     TF_Library* lib_handle);
 
+// Creates a tensor that borrows the caller-owned buffer `data` of `len` bytes,
+// e.g. a buffer from a pool of request buffers. TensorFlow reads and writes the
+// buffer in place and calls `release(data, len, release_arg)` once the last
+// reference to it is dropped, which may be after the returned TF_Tensor has
+// been deleted if a session still uses it.
+//
+// Only types with a flat in-memory representation are supported (not
+// TF_STRING or TF_RESOURCE), and `len` must match `dims` exactly. Buffers
+// aligned to 64 bytes are always borrowed; buffers that don't meet the
+// alignment required by TensorFlow's kernels are copied, in which case
+// `release` is called before this function returns.
+//
+// On failure, returns nullptr, places an error in `status` and does not call
+// `release`.
+TF_CAPI_EXPORT extern TF_Tensor* TF_NewBorrowedTensor(
+    TF_DataType dtype, const int64_t* dims, int num_dims, void* data,
+    size_t len, void (*release)(void* data, size_t len, void* arg),
+    void* release_arg, TF_Status* status);
+
+// Like TF_SessionRun, but lets the caller provide the buffers that receive the
+// outputs. If `output_values[i]` is non-null on entry, it must be a tensor with
+// the dtype and number of bytes of the i-th fetched value (e.g. created with
+// TF_NewBorrowedTensor); the value is stored in its buffer and
+// `output_values[i]` is left unchanged. The copy is skipped when the fetched
+// value already lives in that buffer, e.g. when it's an input fed in place.
+// Null entries are set to newly allocated tensors owned by the caller, as in
+// TF_SessionRun.
+//
+// On failure, the caller-provided tensors are left in place and the other
+// entries of `output_values` are set to nullptr.
+TF_CAPI_EXPORT extern void TF_SessionRunWithOutputBuffers(
+    TF_Session* session, const TF_Buffer* run_options, const TF_Output* inputs,
+    TF_Tensor* const* input_values, int ninputs, const TF_Output* outputs,
+    TF_Tensor** output_values, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets,
+    TF_Buffer* run_metadata, TF_Status* status);
+
 #ifdef __cplusplus
 } /* end extern "C" */
 #endif
@@ -255,5 +255,128 @@ TEST(CAPI_EXPERIMENTAL, LibraryPluggableDeviceLoadFunctions) {
 #endif  // !defined(PLATFORM_WINDOWS)
 }
 
+void CountRelease(void* data, size_t len, void* arg) {
+  ++*static_cast<int*>(arg);
+}
+
+TEST(CAPI_EXPERIMENTAL, BorrowedTensorSharesAlignedBuffer) {
+  alignas(64) float buffer[4] = {1, 2, 3, 4};
+  const int64_t dims[] = {2, 2};
+  int num_releases = 0;
+  TF_Status* status = TF_NewStatus();
+  TF_Tensor* t = TF_NewBorrowedTensor(TF_FLOAT, dims, 2, buffer,
+                                      sizeof(buffer), &CountRelease,
+                                      &num_releases, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(buffer, TF_TensorData(t));
+  EXPECT_EQ(0, num_releases);
+  TF_DeleteTensor(t);
+  EXPECT_EQ(1, num_releases);
+  TF_DeleteStatus(status);
+}
+
+TEST(CAPI_EXPERIMENTAL, BorrowedTensorCopiesMisalignedBuffer) {
+  alignas(64) float storage[5] = {0, 1, 2, 3, 4};
+  float* buffer = storage + 1;
+  const int64_t dims[] = {4};
+  int num_releases = 0;
+  TF_Status* status = TF_NewStatus();
+  TF_Tensor* t = TF_NewBorrowedTensor(TF_FLOAT, dims, 1, buffer,
+                                      4 * sizeof(float), &CountRelease,
+                                      &num_releases, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  if (TF_TensorData(t) != buffer) {
+    // The buffer was copied and handed back right away.
+    EXPECT_EQ(1, num_releases);
+    EXPECT_EQ(3.0f, static_cast<float*>(TF_TensorData(t))[2]);
+  }
+  TF_DeleteTensor(t);
+  EXPECT_EQ(1, num_releases);
+  TF_DeleteStatus(status);
+}
+
+TEST(CAPI_EXPERIMENTAL, BorrowedTensorRejectsSizeMismatch) {
+  alignas(64) float buffer[4];
+  const int64_t dims[] = {3};
+  int num_releases = 0;
+  TF_Status* status = TF_NewStatus();
+  TF_Tensor* t = TF_NewBorrowedTensor(TF_FLOAT, dims, 1, buffer,
+                                      sizeof(buffer), &CountRelease,
+                                      &num_releases, status);
+  EXPECT_EQ(nullptr, t);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+  EXPECT_EQ(0, num_releases);
+  TF_DeleteStatus(status);
+}
+
+TEST(CAPI_EXPERIMENTAL, BorrowedTensorRejectsOverflowingShape) {
+  alignas(64) float buffer[4];
+  // 4 * (2^62 + 1) * 4 bytes wraps around to sizeof(buffer) in 64 bits.
+  const int64_t dims[] = {(int64_t{1} << 62) + 1, 4};
+  int num_releases = 0;
+  TF_Status* status = TF_NewStatus();
+  TF_Tensor* t = TF_NewBorrowedTensor(TF_FLOAT, dims, 2, buffer,
+                                      sizeof(buffer), &CountRelease,
+                                      &num_releases, status);
+  EXPECT_EQ(nullptr, t);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+  EXPECT_EQ(0, num_releases);
+  TF_DeleteStatus(status);
+}
+
+TEST(CAPI_EXPERIMENTAL, SessionRunWithOutputBuffers) {
+  TF_Status* status = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+  TF_Operation* feed = Placeholder(graph, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TF_Operation* neg = Neg(feed, graph, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TF_SessionOptions* opts = TF_NewSessionOptions();
+  TF_Session* session = TF_NewSession(graph, opts, status);
+  TF_DeleteSessionOptions(opts);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  alignas(64) int32_t result = 0;
+  int num_releases = 0;
+  TF_Tensor* result_tensor =
+      TF_NewBorrowedTensor(TF_INT32, nullptr, 0, &result, sizeof(result),
+                           &CountRelease, &num_releases, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  TF_Output input{feed, 0};
+  TF_Tensor* input_value = Int32Tensor(3);
+  TF_Output outputs[] = {{neg, 0}, {feed, 0}};
+  TF_Tensor* output_values[] = {result_tensor, nullptr};
+  TF_SessionRunWithOutputBuffers(session, nullptr, &input, &input_value, 1,
+                                 outputs, output_values, 2, nullptr, 0,
+                                 nullptr, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(result_tensor, output_values[0]);
+  EXPECT_EQ(-3, result);
+  ASSERT_NE(nullptr, output_values[1]);
+  EXPECT_EQ(3, *static_cast<int32_t*>(TF_TensorData(output_values[1])));
+
+  // A buffer of the wrong size is rejected.
+  TF_Tensor* wrong_size = Int32Tensor({1, 2});
+  output_values[0] = wrong_size;
+  TF_DeleteTensor(output_values[1]);
+  output_values[1] = nullptr;
+  TF_SessionRunWithOutputBuffers(session, nullptr, &input, &input_value, 1,
+                                 outputs, output_values, 2, nullptr, 0,
+                                 nullptr, status);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+  EXPECT_EQ(wrong_size, output_values[0]);
+  EXPECT_EQ(nullptr, output_values[1]);
+
+  TF_DeleteTensor(wrong_size);
+  TF_DeleteTensor(input_value);
+  TF_DeleteTensor(result_tensor);
+  EXPECT_EQ(1, num_releases);
+  TF_CloseSession(session, status);
+  TF_DeleteSession(session, status);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(status);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -570,6 +570,17 @@ void TFE_OpSetCancellationManager(TFE_Op* op,
   status->status = tensorflow::Status::OK();
 }
 
+void TFE_OpSetInput(TFE_Op* op, int index, TFE_TensorHandle* input,
+                    TF_Status* status) {
+  if (index < 0) {
+    status->status = tensorflow::errors::InvalidArgument(
+        "Input index must be non-negative, got ", index);
+    return;
+  }
+  status->status =
+      tensorflow::unwrap(op)->SetInput(index, tensorflow::unwrap(input));
+}
+
 TFE_Executor* TFE_NewExecutor(bool is_async) {
   return new TFE_Executor(is_async);
 }
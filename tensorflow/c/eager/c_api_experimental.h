@@ -326,6 +326,17 @@ TF_CAPI_EXPORT extern void TFE_OpSetCancellationManager(
     TFE_Op* op, TFE_CancellationManager* cancellation_manager,
     TF_Status* status);
 
+// Replaces the `index`-th input already added to `op` with `input`.
+//
+// `op` keeps its attributes and placement across calls to `TFE_Execute`, which
+// release its inputs, so an op can be built once and then executed repeatedly,
+// adding new inputs between executions. Repeated executions of such an op
+// reuse the kernel chosen for the previous execution without consulting the
+// context's kernel cache, until `op` is reset with `TFE_OpReset`.
+TF_CAPI_EXPORT extern void TFE_OpSetInput(TFE_Op* op, int index,
+                                          TFE_TensorHandle* input,
+                                          TF_Status* status);
+
 // -----------------------------------------------------------------------------
 // Eager Executor APIs.
 typedef struct TFE_Executor TFE_Executor;
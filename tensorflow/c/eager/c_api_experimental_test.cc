@@ -360,6 +360,48 @@ void Executor_MatMul_CPU(bool async) {
 TEST(CAPI, Executor_MatMul_CPU) { Executor_MatMul_CPU(false); }
 TEST(CAPI, Executor_MatMul_CPUAsync) { Executor_MatMul_CPU(true); }
 
+TEST(CAPI, OpSetInputAndReexecute) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  TFE_TensorHandle* one = TestScalarTensorHandle(ctx, 1.0f);
+  TFE_TensorHandle* two = TestScalarTensorHandle(ctx, 2.0f);
+  TFE_Op* add = AddOp(ctx, one, one);
+  for (int i = 0; i < 3; ++i) {
+    // Executing the op released its inputs.
+    if (i > 0) {
+      TFE_OpAddInput(add, one, status);
+      ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+      TFE_OpAddInput(add, one, status);
+      ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    }
+    TFE_OpSetInput(add, 1, i % 2 == 0 ? one : two, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_TensorHandle* retval = nullptr;
+    int num_retvals = 1;
+    TFE_Execute(add, &retval, &num_retvals, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TF_Tensor* t = TFE_TensorHandleResolve(retval, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    EXPECT_EQ(i % 2 == 0 ? 2.0f : 3.0f,
+              *static_cast<float*>(TF_TensorData(t)));
+    TF_DeleteTensor(t);
+    TFE_DeleteTensorHandle(retval);
+  }
+
+  TFE_OpSetInput(add, 2, one, status);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+
+  TFE_DeleteOp(add);
+  TFE_DeleteTensorHandle(one);
+  TFE_DeleteTensorHandle(two);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+
 void Deleter(void* data, size_t unused, void* tensor_handle) {
   TFE_DeleteTensorHandle(static_cast<TFE_TensorHandle*>(tensor_handle));
 }
@@ -26,6 +26,8 @@ limitations under the License.
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
@@ -39,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace {
@@ -226,6 +229,10 @@ Status RunRestore(const RunOptions& run_options, const string& export_dir,
   }
   const string variables_path =
       io::JoinPath(variables_directory, kSavedModelVariablesFilename);
+  // SavedModel variables are never rewritten in place, so the restore may
+  // serve them from memory-mapped data files shared by all processes on the
+  // host instead of copying them.
+  MarkBundleImmutable(variables_path);
 
   // Add variables to the graph.
   Tensor variables_path_tensor(DT_STRING, TensorShape({}));
@@ -255,36 +262,68 @@ Status LoadMetagraphIntoSession(const SessionOptions& session_options,
   return (*session)->Create(meta_graph.graph_def());
 }
 
+namespace {
+
+// Like LoadMetagraphIntoSession(), but moves the GraphDef into the session
+// instead of copying it, which leaves `meta_graph` without a graph_def. For
+// large models the copy would otherwise double the peak RAM of the load.
+Status MoveMetagraphIntoSession(const SessionOptions& session_options,
+                                MetaGraphDef* meta_graph,
+                                std::unique_ptr<Session>* session) {
+  Session* session_p = nullptr;
+  TF_RETURN_IF_ERROR(NewSession(session_options, &session_p));
+  session->reset(session_p);
+  TF_RETURN_IF_ERROR(ValidateSavedTensors(meta_graph->graph_def()));
+  GraphDef graph_def;
+  graph_def.Swap(meta_graph->mutable_graph_def());
+  return (*session)->Create(std::move(graph_def));
+}
+
 Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const RunOptions& run_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
+                              SavedModel* saved_model_proto,
+                              bool keep_graph_def,
                               SavedModelBundle* const bundle) {
-  TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
-                                                    &bundle->meta_graph_def));
+  TF_RETURN_IF_ERROR(
+      FindMetaGraphDef(tags, saved_model_proto, &bundle->meta_graph_def));
+  // Release any other MetaGraphDefs before the session is created.
+  saved_model_proto->Clear();
   TF_RETURN_IF_ERROR(
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
-  TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
-      session_options, bundle->meta_graph_def, &bundle->session));
+  if (keep_graph_def) {
+    TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
+        session_options, bundle->meta_graph_def, &bundle->session));
+  } else {
+    TF_RETURN_IF_ERROR(MoveMetagraphIntoSession(
+        session_options, &bundle->meta_graph_def, &bundle->session));
+  }
   TF_RETURN_IF_ERROR(RestoreSession(run_options, bundle->meta_graph_def,
                                     export_dir, &bundle->session));
   return Status::OK();
 }
 
+// Loads the SavedModel into `bundle`. Unless `keep_graph_def` is set, the
+// GraphDef is moved into the session rather than kept in
+// `bundle->meta_graph_def`.
 Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
                       const std::unordered_set<string>& tags,
-                      SavedModelBundle* const bundle) {
+                      bool keep_graph_def, SavedModelBundle* const bundle) {
+  // TODO(robson): Add tests for the counters.
+  const uint64 start_microseconds = Env::Default()->NowMicros();
+  // saved_model.pb is parsed only once: for multi-GB models the parse is a
+  // large share of the load time.
   SavedModel saved_model_proto;
-  if (ReadSavedModel(export_dir, &saved_model_proto).ok()) {
+  Status status = ReadSavedModel(export_dir, &saved_model_proto);
+  if (status.ok()) {
     std::string version = libexport::GetWriteVersion(saved_model_proto);
     metrics::ReadApi(kCCLoadLabel, version).IncrementBy(1);
+    status = LoadSavedModelInternal(session_options, run_options, export_dir,
+                                    tags, &saved_model_proto, keep_graph_def,
+                                    bundle);
   }
-
-  // TODO(robson): Add tests for the counters.
-  const uint64 start_microseconds = Env::Default()->NowMicros();
-  const Status status = LoadSavedModelInternal(session_options, run_options,
-                                               export_dir, tags, bundle);
   auto log_and_count = [&](const string& status_str) {
     LOG(INFO) << "SavedModel load for tags { " << absl::StrJoin(tags, " ")
               << " }; Status: " << status_str << ": " << status << ". Took "
@@ -302,7 +341,6 @@ Status LoadSavedModel(const SessionOptions& session_options,
   return status;
 }
 
-namespace {
 // Session wrapper that prevents calls to Session::Create(), Session::Extend(),
 // and the deprecated partial-run methods.
 //
@@ -411,6 +449,14 @@ class LiteSessionWrapper : public Session {
 };
 }  // namespace
 
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      SavedModelBundle* const bundle) {
+  return LoadSavedModel(session_options, run_options, export_dir, tags,
+                        /*keep_graph_def=*/true, bundle);
+}
+
 Status RestoreSession(const RunOptions& run_options,
                       const MetaGraphDef& meta_graph, const string& export_dir,
                       std::unique_ptr<Session>* session) {
@@ -457,16 +503,97 @@ Status LoadSavedModel(const SessionOptions& session_options,
   // not storing the rewritten subgraph for each signature.
   rewritten_options.config.mutable_experimental()
       ->set_disable_output_partition_graphs(true);
-  // TODO(mrry): Consider specializing the session creation to reduce peak
-  // RAM consumption by using `Session::Create(GraphDef&&)`.
+  // The returned bundle has no MetaGraphDef, so the GraphDef can be moved
+  // into the session instead of copied, reducing peak RAM consumption.
   TF_RETURN_IF_ERROR(LoadSavedModel(rewritten_options, run_options, export_dir,
-                                    tags, &legacy_bundle));
+                                    tags, /*keep_graph_def=*/false,
+                                    &legacy_bundle));
   *bundle = SavedModelBundleLite(
       absl::make_unique<LiteSessionWrapper>(std::move(legacy_bundle.session)),
       std::move(*legacy_bundle.meta_graph_def.mutable_signature_def()));
   return Status::OK();
 }
 
+Status WarmupSavedModel(const SavedModelBundleInterface& bundle,
+                        const std::vector<SavedModelWarmupRequest>& requests,
+                        int num_threads,
+                        std::map<string, int64>* warmup_micros) {
+  if (num_threads < 1) {
+    return errors::InvalidArgument("num_threads must be positive; was ",
+                                   num_threads);
+  }
+  // Resolve the signatures up front, so that malformed requests fail before
+  // any of them runs.
+  struct ResolvedRequest {
+    const string* signature_name;
+    std::vector<std::pair<string, Tensor>> feeds;
+    std::vector<string> fetches;
+  };
+  std::vector<ResolvedRequest> resolved(requests.size());
+  for (size_t i = 0; i < requests.size(); ++i) {
+    const SavedModelWarmupRequest& request = requests[i];
+    const auto& signatures = bundle.GetSignatures();
+    auto it = signatures.find(request.signature_name);
+    if (it == signatures.end()) {
+      return errors::InvalidArgument("Warmup request ", i,
+                                     " refers to unknown signature '",
+                                     request.signature_name, "'");
+    }
+    const SignatureDef& signature = it->second;
+    resolved[i].signature_name = &request.signature_name;
+    for (const auto& input : request.inputs) {
+      auto input_it = signature.inputs().find(input.first);
+      if (input_it == signature.inputs().end()) {
+        return errors::InvalidArgument(
+            "Warmup request ", i, " feeds unknown input '", input.first,
+            "' of signature '", request.signature_name, "'");
+      }
+      resolved[i].feeds.emplace_back(input_it->second.name(), input.second);
+    }
+    for (const auto& output : signature.outputs()) {
+      resolved[i].fetches.push_back(output.second.name());
+    }
+  }
+
+  Session* session = bundle.GetSession();
+  mutex mu;
+  Status status;
+  std::map<string, int64> micros;
+  auto run_request = [&](const ResolvedRequest& request) {
+    const uint64 start_micros = Env::Default()->NowMicros();
+    std::vector<Tensor> outputs;
+    Status run_status =
+        session->Run(request.feeds, request.fetches, {}, &outputs);
+    const int64 elapsed_micros = GetLatencyMicroseconds(start_micros);
+    mutex_lock l(mu);
+    status.Update(run_status);
+    micros[*request.signature_name] += elapsed_micros;
+  };
+  if (num_threads == 1) {
+    for (const ResolvedRequest& request : resolved) {
+      run_request(request);
+    }
+  } else {
+    thread::ThreadPool pool(Env::Default(), "saved_model_warmup",
+                            num_threads);
+    BlockingCounter counter(resolved.size());
+    for (const ResolvedRequest& request : resolved) {
+      pool.Schedule([&run_request, &request, &counter] {
+        run_request(request);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  TF_RETURN_IF_ERROR(status);
+  if (warmup_micros != nullptr) {
+    for (const auto& signature_micros : micros) {
+      (*warmup_micros)[signature_micros.first] += signature_micros.second;
+    }
+  }
+  return Status::OK();
+}
+
 bool MaybeSavedModelDirectory(const string& export_dir) {
   const string saved_model_pb_path =
       io::JoinPath(export_dir, kSavedModelFilenamePb);
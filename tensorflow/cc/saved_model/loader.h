@@ -18,8 +18,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CC_SAVED_MODEL_LOADER_H_
 #define TENSORFLOW_CC_SAVED_MODEL_LOADER_H_
 
+#include <map>
 #include <string>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/graph_debug_info.pb.h"
@@ -135,6 +138,30 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const std::unordered_set<string>& tags,
                       SavedModelBundleLite* const bundle);
 
+/// A representative request to replay against a loaded SavedModel; see
+/// WarmupSavedModel().
+struct SavedModelWarmupRequest {
+  /// The key of the SignatureDef to run.
+  std::string signature_name;
+  /// The request's inputs, keyed by the signature's input aliases.
+  std::vector<std::pair<std::string, Tensor>> inputs;
+};
+
+/// Warms up a loaded SavedModel by running each of `requests` through its
+/// signature, fetching all of the signature's outputs. This takes the cold
+/// paths (kernel creation, autotuning, compilation, allocator growth) before
+/// the model serves real traffic. To cover every batch size a model may see,
+/// e.g. each of a batching op's allowed batch sizes, supply requests of each
+/// size.
+///
+/// Up to `num_threads` requests run concurrently. On success, adds the time
+/// (in microseconds) spent running the requests of each signature to
+/// `*warmup_micros` if it is not null. Returns the first error encountered.
+Status WarmupSavedModel(const SavedModelBundleInterface& bundle,
+                        const std::vector<SavedModelWarmupRequest>& requests,
+                        int num_threads,
+                        std::map<std::string, int64>* warmup_micros);
+
 /// Checks whether the provided directory could contain a SavedModel. Note that
 /// the method does not load any data by itself. If the method returns `false`,
 /// the export directory definitely does not contain a SavedModel. If the method
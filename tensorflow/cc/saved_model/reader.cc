@@ -36,7 +36,6 @@ namespace {
 
 // Swap tensor_content field of Const Op Tensors in the named functions
 static Status SwapTensorContent(MetaGraphDef* meta_graph_def) {
-  GraphDef graph_def = *meta_graph_def->mutable_graph_def();
   for (auto& function : *meta_graph_def->mutable_graph_def()
                              ->mutable_library()
                              ->mutable_function()) {
@@ -63,6 +62,8 @@ static Status SwapTensorContent(MetaGraphDef* meta_graph_def) {
   return Status::OK();
 }
 
+}  // namespace
+
 Status FindMetaGraphDef(const std::unordered_set<string>& tags,
                         SavedModel* saved_model_proto,
                         MetaGraphDef* meta_graph_def) {
@@ -92,7 +93,6 @@ Status FindMetaGraphDef(const std::unordered_set<string>& tags,
           " }. To inspect available tag-sets in the SavedModel, please "
           "use the SavedModel CLI: `saved_model_cli`"));
 }
-}  // namespace
 
 Status ReadSavedModel(const string& export_dir, SavedModel* saved_model_proto) {
   LOG(INFO) << "Reading SavedModel from: " << export_dir;
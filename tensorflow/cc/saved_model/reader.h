@@ -31,6 +31,13 @@ namespace tensorflow {
 // Returns a failure status when the SavedModel file does not exist.
 Status ReadSavedModel(const string& export_dir, SavedModel* saved_model_proto);
 
+// Finds the MetaGraphDef in `saved_model_proto` that matches the given set of
+// tags and moves it into `meta_graph_def`. Returns a failure status when no
+// MetaGraphDef matches the tags.
+Status FindMetaGraphDef(const std::unordered_set<string>& tags,
+                        SavedModel* saved_model_proto,
+                        MetaGraphDef* meta_graph_def);
+
 // Reads the SavedModel proto from saved_model.pb(txt) in the given directory,
 // finds the MetaGraphDef that matches the given set of tags and writes it to
 // the `meta_graph_def` parameter. Returns a failure status when the SavedModel
@@ -62,6 +62,18 @@ TEST_F(ReaderTest, TagMatch) {
   CheckMetaGraphDef(meta_graph_def);
 }
 
+TEST_F(ReaderTest, FindMetaGraphDef) {
+  SavedModel saved_model_proto;
+  const string export_dir = GetDataDependencyFilepath(TestDataSharded());
+  TF_ASSERT_OK(ReadSavedModel(export_dir, &saved_model_proto));
+
+  MetaGraphDef meta_graph_def;
+  TF_ASSERT_OK(FindMetaGraphDef({kSavedModelTagServe}, &saved_model_proto,
+                                &meta_graph_def));
+  CheckMetaGraphDef(meta_graph_def);
+  EXPECT_GT(meta_graph_def.graph_def().node_size(), 0);
+}
+
 TEST_F(ReaderTest, NoTagMatch) {
   MetaGraphDef meta_graph_def;
 
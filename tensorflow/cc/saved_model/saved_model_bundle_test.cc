@@ -127,6 +127,35 @@ TEST_F(LoaderTest, ResourceLeakTest) {
   }
 }
 
+TEST_F(LoaderTest, Warmup) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+
+  std::vector<SavedModelWarmupRequest> requests;
+  for (int batch_size : {1, 4}) {
+    std::vector<tstring> serialized_examples(batch_size,
+                                             MakeSerializedExample(1));
+    requests.push_back(
+        {"regress_x_to_y",
+         {{kRegressInputs, test::AsTensor<tstring>(serialized_examples)}}});
+  }
+  std::map<string, int64> warmup_micros;
+  TF_ASSERT_OK(WarmupSavedModel(bundle, requests, /*num_threads=*/2,
+                                &warmup_micros));
+  EXPECT_EQ(1, warmup_micros.size());
+  EXPECT_EQ(1, warmup_micros.count("regress_x_to_y"));
+
+  requests.push_back({"unknown_signature", {}});
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      WarmupSavedModel(bundle, requests, /*num_threads=*/1, nullptr)));
+}
+
 TEST_F(LoaderTest, TagMatch) {
   SavedModelBundle bundle;
   SessionOptions session_options;
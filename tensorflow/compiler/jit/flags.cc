@@ -164,6 +164,8 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_persistent_cache_directory = "";
+  ops_flags->tf_xla_shape_buckets = "";
 
   jitter_flags = new IntroduceFloatingPointJitterPassFlags;
   jitter_flags->jitter_amount = 1e-5;
@@ -222,6 +224,16 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_persistent_cache_directory",
+            &ops_flags->tf_xla_persistent_cache_directory,
+            "If non-empty, the directory in which compiled clusters are "
+            "persisted so that later processes can skip most of their "
+            "compilation."),
+       Flag("tf_xla_shape_buckets", &ops_flags->tf_xla_shape_buckets,
+            "If non-empty, pad the argument dimensions that vary between "
+            "calls of a cluster to buckets, either \"pow2\" or a "
+            "comma-separated list of ascending sizes, so that each bucket "
+            "is compiled only once."),
 
        Flag("tf_introduce_floating_point_jitter_to_tensors",
             setter_for_jitter_tensor_names, "",
@@ -102,6 +102,15 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // If non-empty, compiled clusters are persisted in this directory and reused
+  // by later processes that compile the same cluster with the same flags on
+  // the same kind of device.
+  string tf_xla_persistent_cache_directory;
+
+  // If non-empty, the dimensions of cluster arguments whose size varies from
+  // call to call are padded to buckets: "pow2" for powers of two, or an
+  // ascending, comma-separated list of sizes.
+  string tf_xla_shape_buckets;
 };
 
 // Flags for the build_xla_ops pass.
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -52,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/util/stream_executor_util.h"
 
 // OP_REQUIRES_OK_RETURN is the same as OP_REQUIRES_OK except that
@@ -73,6 +75,16 @@ auto* xla_launch_counter = monitoring::Counter<1>::New(
     "/tensorflow/core/xla_launch_counter",
     "The number of times a XlaLaunch is called.", "device");
 
+// Name of the profiler event of a cluster execution, which carries the
+// cluster name and its input bytes as metadata.
+string ClusterExecutionTraceMe(
+    const string& cluster_name,
+    const XlaComputationLaunchContext& launch_context) {
+  return tensorflow::profiler::TraceMeEncode(
+      "XlaClusterExecution", {{"cluster", cluster_name},
+                              {"input_bytes", launch_context.input_bytes()}});
+}
+
 // A closure describing how to run a compiled version of a TensorFlow function.
 //
 // It may seem unusual to stick the resource variable snapshots in this class.
@@ -85,12 +97,14 @@ class XlaExecutableClosure {
   explicit XlaExecutableClosure(
       xla::LocalClient* client, xla::LocalExecutable* executable,
       const XlaCompiler::CompilationResult* compilation_result,
-      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args)
+      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args,
+      string cluster_name)
       : client_(client),
         executable_(executable),
         compilation_result_(compilation_result),
         resource_var_snapshots_(std::move(resource_var_snapshots)),
-        num_constant_args_(num_constant_args) {}
+        num_constant_args_(num_constant_args),
+        cluster_name_(std::move(cluster_name)) {}
 
   XlaExecutableClosure(XlaExecutableClosure&&) = default;
   XlaExecutableClosure& operator=(XlaExecutableClosure&&) = default;
@@ -104,6 +118,7 @@ class XlaExecutableClosure {
     return resource_var_snapshots_;
   }
   int num_constant_args() const { return num_constant_args_; }
+  const string& cluster_name() const { return cluster_name_; }
 
  private:
   xla::LocalClient* client_;
@@ -111,6 +126,7 @@ class XlaExecutableClosure {
   const XlaCompiler::CompilationResult* compilation_result_;
   ResourceVarsSnapshot resource_var_snapshots_;
   int num_constant_args_;
+  string cluster_name_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(XlaExecutableClosure);
 };
@@ -296,12 +312,19 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
   auto start_time = env->NowMicros();
 
   StatusOr<xla::ExecutionOutput> execution_output;
-  if (!stream || platform_info_.platform_id() == se::host::kHostPlatformId) {
-    execution_output =
-        executable->Run(std::move(*execution_inputs), run_options);
-  } else {
-    execution_output =
-        executable->RunAsync(std::move(*execution_inputs), run_options);
+  {
+    tensorflow::profiler::TraceMe cluster_activity(
+        [&] {
+          return ClusterExecutionTraceMe(function_.name(), launch_context);
+        },
+        tensorflow::profiler::TraceMeLevel::kInfo);
+    if (!stream || platform_info_.platform_id() == se::host::kHostPlatformId) {
+      execution_output =
+          executable->Run(std::move(*execution_inputs), run_options);
+    } else {
+      execution_output =
+          executable->RunAsync(std::move(*execution_inputs), run_options);
+    }
   }
   OP_REQUIRES(ctx, execution_output.ok(), execution_output.status());
 
@@ -312,6 +335,9 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
                ctx, compilation_result, execution_output->ConsumeResult(),
                /*missing_ctx_input_prefix=*/0, absl::MakeSpan(variable_infos),
                input_output_alias, resource_var_ptrs));
+  metrics::RecordXlaClusterExecution(function_.name(), elapsed,
+                                     launch_context.input_bytes(),
+                                     launch_context.output_bytes());
 
   VLOG(1) << "Done";
 }
@@ -468,7 +494,8 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   // variables.
   XlaExecutableClosureStore::KeyT key =
       XlaExecutableClosureStore::Global()->Produce(XlaExecutableClosure(
-          client, executable, kernel, std::move(variables), constants_.size()));
+          client, executable, kernel, std::move(variables), constants_.size(),
+          function_.name()));
 
   Tensor compilation_key(cpu_allocator, DT_STRING, TensorShape({}));
   compilation_key.flat<tstring>()(0) = key;
@@ -539,12 +566,20 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
   auto start_time = env->NowMicros();
 
   StatusOr<xla::ExecutionOutput> execution_output;
-  if (!stream || platform_info_.platform_id() == se::host::kHostPlatformId) {
-    execution_output =
-        closure.executable()->Run(std::move(*execution_inputs), run_options);
-  } else {
-    execution_output = closure.executable()->RunAsync(
-        std::move(*execution_inputs), run_options);
+  {
+    tensorflow::profiler::TraceMe cluster_activity(
+        [&] {
+          return ClusterExecutionTraceMe(closure.cluster_name(),
+                                         launch_context);
+        },
+        tensorflow::profiler::TraceMeLevel::kInfo);
+    if (!stream || platform_info_.platform_id() == se::host::kHostPlatformId) {
+      execution_output =
+          closure.executable()->Run(std::move(*execution_inputs), run_options);
+    } else {
+      execution_output = closure.executable()->RunAsync(
+          std::move(*execution_inputs), run_options);
+    }
   }
   OP_REQUIRES(ctx, execution_output.ok(), execution_output.status());
 
@@ -568,6 +603,9 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
           ctx, closure.compilation_result(), execution_output->ConsumeResult(),
           /*missing_ctx_input_prefix=*/closure.num_constant_args(),
           absl::MakeSpan(*variable_infos), input_output_alias, snapshot_ptrs));
+  metrics::RecordXlaClusterExecution(closure.cluster_name(), elapsed,
+                                     launch_context.input_bytes(),
+                                     launch_context.output_bytes());
 }
 
 XlaMergeOp::XlaMergeOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
@@ -0,0 +1,128 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/types/variant.h"
+#include "tensorflow/compiler/tf2xla/shape_util.h"
+#include "tensorflow/compiler/xla/shape.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+
+constexpr int64 ShapeBucketer::kVaryingDimension;
+
+/*static*/ xla::StatusOr<std::unique_ptr<ShapeBucketer>> ShapeBucketer::Create(
+    absl::string_view spec) {
+  std::vector<int64> bounds;
+  if (spec != "pow2") {
+    for (absl::string_view bound_string : absl::StrSplit(spec, ',')) {
+      int64 bound;
+      if (!absl::SimpleAtoi(bound_string, &bound) || bound <= 0 ||
+          (!bounds.empty() && bound <= bounds.back())) {
+        return errors::InvalidArgument(
+            "Shape buckets must be \"pow2\" or an ascending list of positive "
+            "sizes, got \"",
+            spec, "\"");
+      }
+      bounds.push_back(bound);
+    }
+  }
+  return std::unique_ptr<ShapeBucketer>(new ShapeBucketer(std::move(bounds)));
+}
+
+int64 ShapeBucketer::BucketFor(int64 size) const {
+  if (bounds_.empty()) {
+    int64 bound = 1;
+    while (bound < size) {
+      bound *= 2;
+    }
+    return bound;
+  }
+  auto it = absl::c_lower_bound(bounds_, size);
+  return it == bounds_.end() ? size : *it;
+}
+
+bool ShapeBucketer::BucketArguments(const string& cluster,
+                                    std::vector<XlaCompiler::Argument>* args) {
+  std::vector<absl::InlinedVector<int64, 4>> varying(args->size());
+  {
+    mutex_lock lock(mu_);
+    auto inserted = dimensions_.emplace(
+        cluster, std::vector<absl::InlinedVector<int64, 4>>());
+    std::vector<absl::InlinedVector<int64, 4>>& dimensions =
+        inserted.first->second;
+    if (inserted.second || dimensions.size() != args->size()) {
+      dimensions.clear();
+      for (const XlaCompiler::Argument& arg : *args) {
+        dimensions.push_back(arg.DimensionSizesAsInlinedVector());
+      }
+      return false;
+    }
+    for (int i = 0; i < args->size(); ++i) {
+      absl::InlinedVector<int64, 4> sizes =
+          (*args)[i].DimensionSizesAsInlinedVector();
+      if ((*args)[i].kind != XlaCompiler::Argument::kParameter ||
+          sizes.size() != dimensions[i].size()) {
+        continue;
+      }
+      for (int d = 0; d < sizes.size(); ++d) {
+        if (dimensions[i][d] != sizes[d]) {
+          dimensions[i][d] = kVaryingDimension;
+        }
+        if (dimensions[i][d] == kVaryingDimension) {
+          varying[i].push_back(d);
+        }
+      }
+    }
+  }
+
+  bool changed = false;
+  for (int i = 0; i < args->size(); ++i) {
+    XlaCompiler::Argument& arg = (*args)[i];
+    if (varying[i].empty() ||
+        !absl::holds_alternative<TensorShape>(arg.shape)) {
+      continue;
+    }
+    xla::Shape shape;
+    if (!TensorShapeToXLAShape(arg.type, absl::get<TensorShape>(arg.shape),
+                               &shape)
+             .ok() ||
+        !shape.IsArray()) {
+      continue;
+    }
+    bool bucketed = false;
+    for (int64 d : varying[i]) {
+      const int64 bound = BucketFor(shape.dimensions(d));
+      if (bound == shape.dimensions(d) && !bounds_.empty() &&
+          bound > bounds_.back()) {
+        continue;
+      }
+      shape.set_dimensions(d, bound);
+      shape.set_dynamic_dimension(d, true);
+      bucketed = true;
+    }
+    if (bucketed) {
+      arg.shape = shape;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}  // namespace tensorflow
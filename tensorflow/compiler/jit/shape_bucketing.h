@@ -0,0 +1,80 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+#define TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Limits the recompilations of clusters whose argument shapes vary from call to
+// call, such as clusters that take sequences of arbitrary length.
+//
+// Once a dimension of a parameter of a cluster has taken two different sizes,
+// the bucketer rewrites that dimension into a dynamic dimension bounded by the
+// bucket the size falls in.  All the sizes of a bucket then share one
+// compilation: the argument is padded to the bound at run time, and XLA's
+// dynamic padder masks the padding out of the computation and slices it off the
+// results.
+class ShapeBucketer {
+ public:
+  // Parses `spec`, which is either "pow2", for buckets at every power of two,
+  // or an ascending, comma-separated list of bucket bounds.
+  static xla::StatusOr<std::unique_ptr<ShapeBucketer>> Create(
+      absl::string_view spec);
+
+  // Returns the smallest bucket bound that is at least `size`, or `size` if it
+  // exceeds every bound.
+  int64 BucketFor(int64 size) const;
+
+  // Records the shapes of the parameters in `args`, the arguments of a call to
+  // the cluster identified by `cluster`, and rewrites the dimensions that have
+  // varied in the calls to `cluster` into bounded dynamic dimensions.  Sizes
+  // larger than every bucket are left untouched.  Returns whether any argument
+  // was rewritten.
+  bool BucketArguments(const string& cluster,
+                       std::vector<XlaCompiler::Argument>* args);
+
+ private:
+  explicit ShapeBucketer(std::vector<int64> bounds)
+      : bounds_(std::move(bounds)) {}
+
+  // Empty for power-of-two buckets.
+  const std::vector<int64> bounds_;
+
+  // A dimension that has taken more than one size.
+  static constexpr int64 kVaryingDimension = -1;
+
+  mutex mu_;
+  // For each cluster, the dimension sizes of each of its arguments in the
+  // first call, with kVaryingDimension for the dimensions that have varied
+  // since.
+  absl::flat_hash_map<string, std::vector<absl::InlinedVector<int64, 4>>>
+      dimensions_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
@@ -0,0 +1,87 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+XlaCompiler::Argument MakeParameter(const TensorShape& shape) {
+  XlaCompiler::Argument arg;
+  arg.kind = XlaCompiler::Argument::kParameter;
+  arg.type = DT_FLOAT;
+  arg.shape = shape;
+  return arg;
+}
+
+TEST(ShapeBucketerTest, PowerOfTwoBuckets) {
+  auto bucketer = ShapeBucketer::Create("pow2").ValueOrDie();
+  EXPECT_EQ(bucketer->BucketFor(1), 1);
+  EXPECT_EQ(bucketer->BucketFor(5), 8);
+  EXPECT_EQ(bucketer->BucketFor(64), 64);
+}
+
+TEST(ShapeBucketerTest, ExplicitBuckets) {
+  auto bucketer = ShapeBucketer::Create("16,128").ValueOrDie();
+  EXPECT_EQ(bucketer->BucketFor(3), 16);
+  EXPECT_EQ(bucketer->BucketFor(17), 128);
+  EXPECT_EQ(bucketer->BucketFor(200), 200);
+}
+
+TEST(ShapeBucketerTest, RejectsBadSpecs) {
+  EXPECT_FALSE(ShapeBucketer::Create("16,8").ok());
+  EXPECT_FALSE(ShapeBucketer::Create("0").ok());
+  EXPECT_FALSE(ShapeBucketer::Create("pow").ok());
+}
+
+TEST(ShapeBucketerTest, BucketsVaryingDimensions) {
+  auto bucketer = ShapeBucketer::Create("pow2").ValueOrDie();
+  std::vector<XlaCompiler::Argument> args = {
+      MakeParameter(TensorShape({4, 10}))};
+  EXPECT_FALSE(bucketer->BucketArguments("cluster", &args));
+  EXPECT_TRUE(absl::holds_alternative<TensorShape>(args[0].shape));
+
+  args = {MakeParameter(TensorShape({4, 13}))};
+  EXPECT_TRUE(bucketer->BucketArguments("cluster", &args));
+  ASSERT_TRUE(absl::holds_alternative<xla::Shape>(args[0].shape));
+  const xla::Shape& shape = absl::get<xla::Shape>(args[0].shape);
+  EXPECT_EQ(shape.dimensions(0), 4);
+  EXPECT_FALSE(shape.is_dynamic_dimension(0));
+  EXPECT_EQ(shape.dimensions(1), 16);
+  EXPECT_TRUE(shape.is_dynamic_dimension(1));
+}
+
+TEST(ShapeBucketerTest, KeepsClustersApart) {
+  auto bucketer = ShapeBucketer::Create("pow2").ValueOrDie();
+  std::vector<XlaCompiler::Argument> args = {MakeParameter(TensorShape({3}))};
+  EXPECT_FALSE(bucketer->BucketArguments("a", &args));
+  args = {MakeParameter(TensorShape({5}))};
+  EXPECT_FALSE(bucketer->BucketArguments("b", &args));
+  EXPECT_FALSE(bucketer->BucketArguments("b", &args));
+}
+
+TEST(ShapeBucketerTest, LeavesSizesPastTheLastBucket) {
+  auto bucketer = ShapeBucketer::Create("8").ValueOrDie();
+  std::vector<XlaCompiler::Argument> args = {MakeParameter(TensorShape({3}))};
+  EXPECT_FALSE(bucketer->BucketArguments("cluster", &args));
+  args = {MakeParameter(TensorShape({20}))};
+  EXPECT_FALSE(bucketer->BucketArguments("cluster", &args));
+}
+
+}  // namespace
+}  // namespace tensorflow
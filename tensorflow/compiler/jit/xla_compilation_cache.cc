@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
+#include <cstdlib>
 #include <numeric>
 
 #include "tensorflow/compiler/mlir/mlir_bridge_rollout_policy.h"
 #include "absl/base/call_once.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/compiler/jit/flags.h"
@@ -60,7 +62,24 @@ constexpr int64
 
 XlaCompilationCache::XlaCompilationCache(xla::LocalClient* client,
                                          DeviceType device_type)
-    : client_(client), device_type_(std::move(device_type)) {}
+    : client_(client), device_type_(std::move(device_type)) {
+  const string& persistent_cache_directory =
+      GetXlaOpsCommonFlags().tf_xla_persistent_cache_directory;
+  if (!persistent_cache_directory.empty()) {
+    persistent_cache_ =
+        absl::make_unique<XlaPersistentCache>(persistent_cache_directory);
+  }
+  const string& shape_buckets = GetXlaOpsCommonFlags().tf_xla_shape_buckets;
+  if (!shape_buckets.empty()) {
+    auto shape_bucketer = ShapeBucketer::Create(shape_buckets);
+    if (shape_bucketer.ok()) {
+      shape_bucketer_ = std::move(shape_bucketer).ValueOrDie();
+    } else {
+      LOG(ERROR) << "Ignoring --tf_xla_shape_buckets: "
+                 << shape_bucketer.status();
+    }
+  }
+}
 
 XlaCompilationCache::~XlaCompilationCache() {
   // Ensure any use of our programs have completed by waiting for all stream
@@ -96,7 +115,14 @@ string XlaCompilationCache::Signature::HumanString() const {
   string result = name;
   for (const auto& a : arg_shapes) {
     absl::StrAppend(&result, ",", DataTypeString(a.first));
-    absl::StrAppend(&result, " [", absl::StrJoin(a.second, ","), "]");
+    absl::StrAppend(
+        &result, " [",
+        absl::StrJoin(a.second, ",",
+                      [](string* out, int64 dim) {
+                        absl::StrAppend(out, dim < 0 ? "<=" : "",
+                                        std::abs(dim));
+                      }),
+        "]");
   }
 
   for (const auto& v : arg_values) {
@@ -150,10 +176,20 @@ StatusOr<XlaCompilationCache::Signature> XlaCompilationCache::BuildSignature(
         signature.arg_values.push_back(arg.constant_value);
         break;
       case XlaCompiler::Argument::kParameter:
-      case XlaCompiler::Argument::kResource:
-        signature.arg_shapes.emplace_back(arg.type,
-                                          arg.DimensionSizesAsInlinedVector());
+      case XlaCompiler::Argument::kResource: {
+        absl::InlinedVector<int64, 4> dimensions =
+            arg.DimensionSizesAsInlinedVector();
+        if (absl::holds_alternative<xla::Shape>(arg.shape)) {
+          const xla::Shape& shape = absl::get<xla::Shape>(arg.shape);
+          for (int i = 0; i < dimensions.size(); ++i) {
+            if (shape.IsArray() && shape.is_dynamic_dimension(i)) {
+              dimensions[i] = -dimensions[i];
+            }
+          }
+        }
+        signature.arg_shapes.emplace_back(arg.type, std::move(dimensions));
         break;
+      }
       default:
         return errors::InvalidArgument(
             "Unhandled argument kind in XlaCompilationCache: ",
@@ -167,6 +203,15 @@ Status XlaCompilationCache::BuildExecutable(
     const XlaCompiler::Options& options,
     const XlaCompiler::CompilationResult& result,
     std::unique_ptr<xla::LocalExecutable>* executable) {
+  return BuildExecutable(options, result, *result.computation,
+                         /*run_backend_only=*/false, executable);
+}
+
+Status XlaCompilationCache::BuildExecutable(
+    const XlaCompiler::Options& options,
+    const XlaCompiler::CompilationResult& result,
+    const xla::XlaComputation& computation, bool run_backend_only,
+    std::unique_ptr<xla::LocalExecutable>* executable) {
   VLOG(2) << "Compiling to local executable";
 
   std::vector<const xla::Shape*> argument_layouts(
@@ -186,9 +231,10 @@ Status XlaCompilationCache::BuildExecutable(
   build_options.set_alias_passthrough_params(options.alias_passthrough_params);
   build_options.mutable_debug_options()->set_xla_detailed_logging_and_dumping(
       options.detailed_logging);
+  build_options.set_run_backend_only(run_backend_only);
   TF_ASSIGN_OR_RETURN(
       auto executables,
-      client_->Compile(*result.computation, argument_layouts, build_options));
+      client_->Compile(computation, argument_layouts, build_options));
   TF_RET_CHECK(executables.size() == 1);
   *executable = std::move(executables[0]);
   return Status::OK();
@@ -211,8 +257,44 @@ Status XlaCompilationCache::Compile(
                         XlaCompiler::CompilationResult* result) {
     return compiler->CompileFunction(compile_options, function, args, result);
   };
-  return CompileImpl(options, function, args, compile_fn, compile_mode,
-                     out_compilation_result, out_executable);
+  auto compile_with_args =
+      [&](const std::vector<XlaCompiler::Argument>& call_args) {
+        // Only called, synchronously, when the cluster is about to be
+        // compiled.
+        std::function<xla::StatusOr<string>()> persistent_key_fn;
+        if (persistent_cache_) {
+          persistent_key_fn = [&]() {
+            se::StreamExecutor* executor =
+                client_->backend().default_stream_executor();
+            return BuildPersistentCacheKey(
+                options, compile_options, function, call_args,
+                absl::StrCat(client_->platform()->Name(), ":",
+                             executor->GetDeviceDescription().name()));
+          };
+        }
+        return CompileImpl(options, function, call_args, compile_fn,
+                           persistent_key_fn, compile_mode,
+                           out_compilation_result, out_executable);
+      };
+
+  if (shape_bucketer_) {
+    std::vector<XlaCompiler::Argument> bucketed_args = args;
+    if (shape_bucketer_->BucketArguments(
+            Canonicalize(function.name(), AttrSlice(&function.attr())),
+            &bucketed_args)) {
+      Status status = compile_with_args(bucketed_args);
+      if (status.ok()) {
+        return status;
+      }
+      // The failed compilation stays cached, so that later calls in the same
+      // bucket go straight to the exact shapes.
+      VLOG(1) << "Compiling " << function.name()
+              << " with bucketed shapes failed, compiling the exact shapes "
+                 "instead: "
+              << status;
+    }
+  }
+  return compile_with_args(args);
 }
 
 static bool ShouldBeMegamorphic(int64 compile_count, int64 execution_count) {
@@ -348,7 +430,8 @@ Status XlaCompilationCache::CompileSingleOp(
     return XlaSingleOpToHlo(compiler, options, args, ctx, compile_options,
                             result);
   };
-  return CompileImpl(options, name, args, compile_op, CompileMode::kStrict,
+  return CompileImpl(options, name, args, compile_op,
+                     /*persistent_key_fn=*/nullptr, CompileMode::kStrict,
                      out_compilation_result, out_executable);
 }
 
@@ -369,6 +452,7 @@ void LogOnceXlaCompiledFirstCluster() {
 Status XlaCompilationCache::CompileStrict(
     Entry* entry, const XlaCompiler::Options& options,
     const std::vector<XlaCompiler::Argument>& args, const string& function_name,
+    const string& persistent_key,
     const std::function<Status(XlaCompiler* compiler,
                                const std::vector<XlaCompiler::Argument>& args,
                                XlaCompiler::CompilationResult*)>& compile_fn) {
@@ -378,16 +462,37 @@ Status XlaCompilationCache::CompileStrict(
   XlaCompiler compiler(options);
   entry->compile_state = CompileState::kCompiled;
 
-  entry->compilation_status =
-      compile_fn(&compiler, args, &entry->compilation_result);
-  TF_RETURN_IF_ERROR(entry->compilation_status);
-  TF_RET_CHECK(entry->executable.get() == nullptr);
-  entry->compilation_status =
-      BuildExecutable(options, entry->compilation_result, &entry->executable);
+  bool loaded = false;
+  if (!persistent_key.empty()) {
+    Status status = LoadPersistedEntry(options, persistent_key, entry);
+    loaded = status.ok();
+    if (loaded) {
+      VLOG(1) << "Loaded the persisted compilation of " << function_name;
+    } else if (!errors::IsNotFound(status)) {
+      LOG(WARNING) << "Ignoring the persisted compilation of " << function_name
+                   << ": " << status;
+    }
+  }
+  if (!loaded) {
+    entry->compilation_status =
+        compile_fn(&compiler, args, &entry->compilation_result);
+    TF_RETURN_IF_ERROR(entry->compilation_status);
+    TF_RET_CHECK(entry->executable.get() == nullptr);
+    entry->compilation_status =
+        BuildExecutable(options, entry->compilation_result, &entry->executable);
+    if (!persistent_key.empty() && entry->compilation_status.ok()) {
+      Status status = PersistEntry(persistent_key, entry);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to persist the compilation of "
+                     << function_name << ": " << status;
+      }
+    }
+  }
 
   const uint64 compile_end_us = env->NowMicros();
   const uint64 compile_time_us = compile_end_us - compile_start_us;
   metrics::UpdateXlaCompilationTime(compile_time_us);
+  metrics::UpdateXlaClusterCompilation(function_name, compile_time_us);
   {
     mutex_lock lock(cluster_compile_stats_mu_);
     auto it = cluster_compile_stats_.find(function_name);
@@ -422,6 +527,7 @@ Status XlaCompilationCache::CompileStrict(
 Status XlaCompilationCache::CompileAsynchronous(
     Entry* entry, const XlaCompiler::Options& options,
     const std::vector<XlaCompiler::Argument>& args, const string& function_name,
+    const string& persistent_key,
     const std::function<Status(XlaCompiler* compiler,
                                const std::vector<XlaCompiler::Argument>& args,
                                XlaCompiler::CompilationResult*)>& compile_fn) {
@@ -447,7 +553,8 @@ Status XlaCompilationCache::CompileAsynchronous(
     // We don't need to lock local_entry.mu, but do it anyway to satisfy
     // thread safety analysis.
     mutex_lock entry_lock(local_entry.mu);
-    (void)CompileStrict(&local_entry, options, args, function_name, compile_fn);
+    (void)CompileStrict(&local_entry, options, args, function_name,
+                        persistent_key, compile_fn);
 
     VLOG(2) << "Finished asynchronous compililation of cluster "
             << function_name << '.';
@@ -472,6 +579,7 @@ Status XlaCompilationCache::CompileImpl(
     const std::function<Status(XlaCompiler* compiler,
                                const std::vector<XlaCompiler::Argument>& args,
                                XlaCompiler::CompilationResult*)>& compile_fn,
+    const std::function<xla::StatusOr<string>()>& persistent_key_fn,
     CompileMode compile_mode,
     const XlaCompiler::CompilationResult** out_compilation_result,
     xla::LocalExecutable** out_executable) {
@@ -605,19 +713,30 @@ Status XlaCompilationCache::CompileImpl(
       return reached_compile_threshold;
     }();
 
+    string persistent_key;
+    if (should_compile && persistent_key_fn) {
+      xla::StatusOr<string> key = persistent_key_fn();
+      if (key.ok()) {
+        persistent_key = key.ValueOrDie();
+      } else {
+        VLOG(1) << "Not persisting the compilation of " << function.name()
+                << ": " << key.status();
+      }
+    }
+
     if (!should_compile) {
       VLOG(2) << "Not compiling for signature: " << human_signature;
       return_null = true;
     } else if (compile_mode == CompileMode::kAsync) {
       VLOG(2) << "Queueing asynchronous compilation for signature: "
               << human_signature;
-      TF_RETURN_IF_ERROR(CompileAsynchronous(entry, options, args,
-                                             function.name(), compile_fn));
+      TF_RETURN_IF_ERROR(CompileAsynchronous(
+          entry, options, args, function.name(), persistent_key, compile_fn));
       return_null = true;
     } else {
       VLOG(2) << "Instantly compiling for signature: " << human_signature;
-      TF_RETURN_IF_ERROR(
-          CompileStrict(entry, options, args, function.name(), compile_fn));
+      TF_RETURN_IF_ERROR(CompileStrict(entry, options, args, function.name(),
+                                       persistent_key, compile_fn));
     }
   } else if (state == CompileState::kCompiling) {
     VLOG(2) << "Ongoing asynchronous compilation for signature: "
@@ -626,6 +745,8 @@ Status XlaCompilationCache::CompileImpl(
   } else if (state == CompileState::kCompiled) {
     VLOG(2) << "Already Compiled for signature: " << human_signature;
   }
+  metrics::RecordXlaClusterCacheLookup(function.name(),
+                                       state == CompileState::kCompiled);
   if (return_null) {
     *out_compilation_result = nullptr;
     *out_executable = nullptr;
@@ -637,4 +758,39 @@ Status XlaCompilationCache::CompileImpl(
   return Status::OK();
 }
 
+Status XlaCompilationCache::LoadPersistedEntry(
+    const XlaCompiler::Options& options, const string& key, Entry* entry) {
+  XlaSerializedCacheEntry serialized;
+  TF_RETURN_IF_ERROR(persistent_cache_->Load(key, &serialized));
+  XlaCompiler::CompilationResult result;
+  TF_RETURN_IF_ERROR(
+      DeserializeCompilationResult(serialized.compilation_result(), &result));
+  result.computation =
+      std::make_shared<xla::XlaComputation>(serialized.computation());
+  std::unique_ptr<xla::LocalExecutable> executable;
+  TF_RETURN_IF_ERROR(BuildExecutable(
+      options, result, xla::XlaComputation(serialized.optimized_module()),
+      /*run_backend_only=*/true, &executable));
+  entry->compilation_result = std::move(result);
+  entry->executable = std::move(executable);
+  return Status::OK();
+}
+
+Status XlaCompilationCache::PersistEntry(const string& key, Entry* entry) {
+  // Computations with only constant outputs are cheap to compile.
+  if (entry->executable == nullptr) return Status::OK();
+  if (!entry->executable->executable()->has_module()) {
+    return errors::FailedPrecondition("The executable has no HLO module");
+  }
+  XlaSerializedCacheEntry serialized;
+  serialized.set_key(key);
+  SerializeCompilationResult(entry->compilation_result,
+                             serialized.mutable_compilation_result());
+  *serialized.mutable_computation() =
+      entry->compilation_result.computation->proto();
+  *serialized.mutable_optimized_module() =
+      entry->executable->executable()->module().ToProto();
+  return persistent_cache_->Save(serialized);
+}
+
 }  // namespace tensorflow
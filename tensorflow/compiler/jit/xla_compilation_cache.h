@@ -20,6 +20,8 @@ limitations under the License.
 #include "absl/container/inlined_vector.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+#include "tensorflow/compiler/jit/xla_persistent_cache.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
@@ -78,6 +80,14 @@ class XlaCompilationCache : public ResourceBase {
   // xla::LocalExecutable and sets `out_executable` to point to it. The
   // resulting executable pointer may be null if the computation has no
   // non-constant outputs.
+  //
+  // If --tf_xla_persistent_cache_directory is set, compilations are also
+  // persisted in that directory, and reused instead of compiling the cluster
+  // from scratch when this or a later process needs them again.
+  //
+  // If --tf_xla_shape_buckets is set, the dimensions of `args` that vary from
+  // call to call are padded to buckets, so that all the sizes of a bucket share
+  // a compilation.  See ShapeBucketer.
   Status Compile(const XlaCompiler::Options& options,
                  const NameAttrList& function,
                  const std::vector<XlaCompiler::Argument>& args,
@@ -108,7 +118,8 @@ class XlaCompilationCache : public ResourceBase {
     string name;
 
     // List of Tensor types & shapes for compile-time constant arguments to the
-    // compilation, ordered by argument number.
+    // compilation, ordered by argument number.  A dynamic dimension is recorded
+    // as its negated bound.
     absl::InlinedVector<std::pair<DataType, absl::InlinedVector<int64, 4>>, 4>
         arg_shapes;
 
@@ -139,6 +150,7 @@ class XlaCompilationCache : public ResourceBase {
       const std::function<Status(XlaCompiler* compiler,
                                  const std::vector<XlaCompiler::Argument>& args,
                                  XlaCompiler::CompilationResult*)>& compile_fn,
+      const std::function<xla::StatusOr<string>()>& persistent_key_fn,
       CompileMode compile_mode,
       const XlaCompiler::CompilationResult** out_compilation_result,
       xla::LocalExecutable** out_executable);
@@ -148,6 +160,14 @@ class XlaCompilationCache : public ResourceBase {
   Status BuildExecutable(const XlaCompiler::Options& options,
                          const XlaCompiler::CompilationResult& result,
                          std::unique_ptr<xla::LocalExecutable>* executable);
+  // Same as above, but builds the executable from `computation` instead of the
+  // computation of `result`.  If `run_backend_only` is true, `computation`
+  // must already have been optimized by the HLO passes of the device.
+  Status BuildExecutable(const XlaCompiler::Options& options,
+                         const XlaCompiler::CompilationResult& result,
+                         const xla::XlaComputation& computation,
+                         bool run_backend_only,
+                         std::unique_ptr<xla::LocalExecutable>* executable);
 
   xla::LocalClient* const client_;
   const DeviceType device_type_;
@@ -173,10 +193,12 @@ class XlaCompilationCache : public ResourceBase {
     std::unique_ptr<xla::LocalExecutable> executable TF_GUARDED_BY(mu);
   };
 
+  // If `persistent_key` is non-empty, the compilation is first looked up in,
+  // and after compiling stored in, the persistent cache under that key.
   Status CompileStrict(
       Entry* entry, const XlaCompiler::Options& options,
       const std::vector<XlaCompiler::Argument>& args,
-      const string& function_name,
+      const string& function_name, const string& persistent_key,
       const std::function<Status(XlaCompiler* compiler,
                                  const std::vector<XlaCompiler::Argument>& args,
                                  XlaCompiler::CompilationResult*)>& compile_fn)
@@ -184,11 +206,27 @@ class XlaCompilationCache : public ResourceBase {
   Status CompileAsynchronous(
       Entry* entry, const XlaCompiler::Options& options,
       const std::vector<XlaCompiler::Argument>& args,
-      const string& function_name,
+      const string& function_name, const string& persistent_key,
       const std::function<Status(XlaCompiler* compiler,
                                  const std::vector<XlaCompiler::Argument>& args,
                                  XlaCompiler::CompilationResult*)>& compile_fn);
 
+  // Fills `entry` from the persistent cache entry stored under `key`.  Leaves
+  // `entry` untouched on failure.
+  Status LoadPersistedEntry(const XlaCompiler::Options& options,
+                            const string& key, Entry* entry)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(entry->mu);
+  // Stores the compilation of `entry` in the persistent cache under `key`.
+  Status PersistEntry(const string& key, Entry* entry)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(entry->mu);
+
+  // Disk-backed tier of the cache, or null if there is none.
+  std::unique_ptr<XlaPersistentCache> persistent_cache_;
+
+  // Pads the argument shapes of Compile to buckets, or null if
+  // --tf_xla_shape_buckets is not set.
+  std::unique_ptr<ShapeBucketer> shape_bucketer_;
+
   mutex compile_cache_mu_;
   absl::flat_hash_map<Signature, std::unique_ptr<Entry>, Signature::Hash> cache_
       TF_GUARDED_BY(compile_cache_mu_);
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 
+#include <cstring>
 #include <memory>
 
 #include "absl/algorithm/container.h"
@@ -229,6 +230,44 @@ static void PopulateExecutionInputBuffer(xla::ExecutionInput& execution_input,
   }
 }
 
+// Copies `tensor` into a new buffer laid out for the dynamic `device_shape`,
+// which the shape-bucketed compilations use for the padded arguments: the
+// elements come first, followed by the int32 size of every dimension.  The
+// padding past the elements is never read.
+static StatusOr<se::OwningDeviceMemory> StageDynamicArgument(
+    OpKernelContext* ctx, const Tensor& tensor, const xla::Shape& device_shape,
+    xla::TransferManager* transfer_manager, int device_ordinal,
+    se::DeviceMemoryAllocator* allocator) {
+  TF_ASSIGN_OR_RETURN(
+      se::OwningDeviceMemory staged,
+      allocator->Allocate(device_ordinal,
+                          transfer_manager->GetByteSizeRequirement(
+                              device_shape)));
+  const int64 metadata_offset = xla::ShapeUtil::ByteSizeOf(
+      xla::ShapeUtil::MakeStaticShape(device_shape));
+  auto metadata = std::make_shared<std::vector<int32>>();
+  for (int64 dim_size : tensor.shape().dim_sizes()) {
+    metadata->push_back(dim_size);
+  }
+  const int64 metadata_size = metadata->size() * sizeof(int32);
+  se::DeviceMemoryBase source = XlaTensor::DeviceMemoryFromTensor(tensor);
+  se::DeviceMemoryBase elements(staged->opaque(), tensor.TotalBytes());
+  se::DeviceMemoryBase sizes(
+      static_cast<char*>(staged->opaque()) + metadata_offset, metadata_size);
+
+  se::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  if (stream == nullptr) {
+    std::memcpy(elements.opaque(), source.opaque(), elements.size());
+    std::memcpy(sizes.opaque(), metadata->data(), metadata_size);
+    return std::move(staged);
+  }
+  stream->ThenMemcpyD2D(&elements, source, elements.size())
+      .ThenMemcpy(&sizes, metadata->data(), metadata_size)
+      .ThenDoHostCallback([metadata]() {});
+  return std::move(staged);
+}
+
 StatusOr<std::vector<xla::ExecutionInput>>
 XlaComputationLaunchContext::PopulateInputs(
     OpKernelContext* ctx,
@@ -261,6 +300,7 @@ XlaComputationLaunchContext::PopulateInputs(
                           ? resource_vars.at(arg_num)
                           : &(ctx->input(arg_num - missing_ctx_input_prefix));
     CHECK(t);
+    input_bytes_ += t->TotalBytes();
     bool donate_buffer =
         t->RefCountIsOne() && is_updated_resource_variable &&
         input_output_alias.ParameterHasAlias(i, xla::ShapeIndex{});
@@ -280,7 +320,15 @@ XlaComputationLaunchContext::PopulateInputs(
 
     arguments.emplace_back(device_shape, shape);
     xla::ExecutionInput& execution_input = arguments.back();
-    if (xla::Shape::Equal().MinorToMajorOnlyInLayout()(shape, device_shape)) {
+    if (device_shape.is_dynamic() && device_shape.IsArray()) {
+      TF_ASSIGN_OR_RETURN(
+          se::OwningDeviceMemory staged,
+          StageDynamicArgument(ctx, *t, device_shape, transfer_manager,
+                               device_ordinal_, xla_allocator_));
+      execution_input.SetBuffer(
+          xla::ShapeIndex{}, xla::MaybeOwningDeviceMemory(std::move(staged)));
+    } else if (xla::Shape::Equal().MinorToMajorOnlyInLayout()(shape,
+                                                              device_shape)) {
       se::DeviceMemoryBase dmem = XlaTensor::DeviceMemoryFromTensor(*t);
       PopulateExecutionInputBuffer(execution_input, xla::ShapeIndex{}, dmem,
                                    donate_buffer, device_ordinal_,
@@ -554,6 +602,7 @@ Status XlaComputationLaunchContext::PopulateOutputs(
               resource_vars, ctx->expected_output_dtype(i), shape, allocator,
               allocate_xla_tensors_, stream, use_multiple_streams_,
               definition_event));
+      output_bytes_ += output_tensor.TotalBytes();
       ctx->set_output(i, output_tensor);
       ++output_num;
     }
@@ -594,6 +643,7 @@ Status XlaComputationLaunchContext::PopulateOutputs(
                                    allocator, allocate_xla_tensors_, stream,
                                    use_multiple_streams_, definition_event));
     var->is_initialized |= write.modified;
+    output_bytes_ += output_tensor.TotalBytes();
     *var->tensor() = output_tensor;
     ++output_num;
   }
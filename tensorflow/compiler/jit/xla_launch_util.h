@@ -184,12 +184,19 @@ class XlaComputationLaunchContext {
       const xla::HloInputOutputAliasConfig& input_output_alias,
       const std::map<int, const Tensor*>& resource_vars);
 
+  // Bytes of the tensors passed to the computation by PopulateInputs, and of
+  // the outputs and variable updates produced by PopulateOutputs.
+  int64 input_bytes() const { return input_bytes_; }
+  int64 output_bytes() const { return output_bytes_; }
+
  private:
   xla::LocalClient* client_;
   se::DeviceMemoryAllocator* xla_allocator_;
   bool allocate_xla_tensors_;
   bool use_multiple_streams_;
   int device_ordinal_;
+  int64 input_bytes_ = 0;
+  int64 output_bytes_ = 0;
 };
 
 // A simple TensorBuffer implementation that allows us to create Tensors that
@@ -0,0 +1,267 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_persistent_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+
+namespace {
+
+Status ShapeFromProto(const TensorShapeProto& proto, TensorShape* shape) {
+  TF_RETURN_IF_ERROR(TensorShape::IsValidShape(proto));
+  *shape = TensorShape(proto);
+  return Status::OK();
+}
+
+// Appends `part` to `key_material` in a form that can't be confused with the
+// concatenation of other parts.
+void AppendKeyPart(absl::string_view part, string* key_material) {
+  absl::StrAppend(key_material, part.size(), ":", part);
+}
+
+void AppendTensor(const Tensor& tensor, string* key_material) {
+  TensorProto proto;
+  tensor.AsProtoTensorContent(&proto);
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  AppendKeyPart(serialized, key_material);
+}
+
+// Unlike XlaArgument::HumanString, covers every field that affects the
+// compilation, including the values of constants.
+void AppendArgument(const XlaCompiler::Argument& arg, string* key_material) {
+  AppendKeyPart(absl::StrCat(arg.kind, ",", arg.type, ",", arg.resource_kind,
+                             ",", arg.initialized, ",", arg.fast_mem, ",",
+                             arg.max_array_size, ",",
+                             arg.is_same_data_across_replicas, ",",
+                             arg.requires_broadcast),
+                key_material);
+  if (absl::holds_alternative<xla::Shape>(arg.shape)) {
+    AppendKeyPart(xla::ShapeUtil::HumanStringWithLayout(
+                      absl::get<xla::Shape>(arg.shape)),
+                  key_material);
+  } else {
+    AppendKeyPart(absl::get<TensorShape>(arg.shape).DebugString(),
+                  key_material);
+  }
+  AppendKeyPart(absl::StrJoin(arg.tensor_array_gradients, ","), key_material);
+  if (arg.kind == XlaCompiler::Argument::kConstant ||
+      arg.kind == XlaCompiler::Argument::kConstantResource) {
+    AppendTensor(arg.constant_value, key_material);
+  }
+  AppendKeyPart(arg.value_bound ? "bound" : "", key_material);
+  if (arg.value_bound) AppendTensor(*arg.value_bound, key_material);
+  AppendKeyPart(arg.value_dynamism ? "dynamism" : "", key_material);
+  if (arg.value_dynamism) AppendTensor(*arg.value_dynamism, key_material);
+}
+
+}  // namespace
+
+void SerializeCompilationResult(const XlaCompiler::CompilationResult& result,
+                                XlaSerializedCompilationResult* serialized) {
+  serialized->Clear();
+  for (int index : result.input_mapping) {
+    serialized->add_input_mapping(index);
+  }
+  for (const xla::Shape& shape : result.xla_input_shapes) {
+    *serialized->add_xla_input_shapes() = shape.ToProto();
+  }
+  *serialized->mutable_xla_output_shape() = result.xla_output_shape.ToProto();
+  for (const XlaCompiler::OutputDescription& output : result.outputs) {
+    XlaSerializedCompilationResult::OutputDescription* proto =
+        serialized->add_outputs();
+    proto->set_type(output.type);
+    output.shape.AsProto(proto->mutable_shape());
+    proto->set_is_constant(output.is_constant);
+    if (output.is_constant) {
+      output.constant_value.AsProtoTensorContent(
+          proto->mutable_constant_value());
+    }
+    proto->set_input_index(output.input_index);
+    proto->set_is_tensor_list(output.is_tensor_list);
+  }
+  *serialized->mutable_host_compute_metadata() = result.host_compute_metadata;
+  for (const XlaCompiler::ResourceUpdate& update : result.resource_updates) {
+    XlaSerializedCompilationResult::ResourceUpdate* proto =
+        serialized->add_resource_updates();
+    proto->set_input_index(update.input_index);
+    proto->set_type(update.type);
+    update.shape.AsProto(proto->mutable_shape());
+    proto->set_modified(update.modified);
+    for (const string& gradient : update.tensor_array_gradients_accessed) {
+      proto->add_tensor_array_gradients_accessed(gradient);
+    }
+  }
+  if (result.collective_reduce_info) {
+    XlaSerializedCompilationResult::CollectiveReduceInfo* proto =
+        serialized->mutable_collective_reduce_info();
+    proto->set_group_key(result.collective_reduce_info->group_key);
+    proto->set_group_size(result.collective_reduce_info->group_size);
+  }
+}
+
+Status DeserializeCompilationResult(
+    const XlaSerializedCompilationResult& serialized,
+    XlaCompiler::CompilationResult* result) {
+  result->input_mapping.assign(serialized.input_mapping().begin(),
+                               serialized.input_mapping().end());
+  result->xla_input_shapes.clear();
+  for (const xla::ShapeProto& shape : serialized.xla_input_shapes()) {
+    result->xla_input_shapes.emplace_back(shape);
+  }
+  result->xla_output_shape = xla::Shape(serialized.xla_output_shape());
+  result->outputs.clear();
+  for (const auto& proto : serialized.outputs()) {
+    XlaCompiler::OutputDescription output;
+    output.type = proto.type();
+    TF_RETURN_IF_ERROR(ShapeFromProto(proto.shape(), &output.shape));
+    output.is_constant = proto.is_constant();
+    if (output.is_constant &&
+        !output.constant_value.FromProto(proto.constant_value())) {
+      return errors::DataLoss("Invalid constant value of output ",
+                              result->outputs.size());
+    }
+    output.input_index = proto.input_index();
+    output.is_tensor_list = proto.is_tensor_list();
+    result->outputs.push_back(std::move(output));
+  }
+  result->host_compute_metadata = serialized.host_compute_metadata();
+  result->resource_updates.clear();
+  for (const auto& proto : serialized.resource_updates()) {
+    XlaCompiler::ResourceUpdate update;
+    update.input_index = proto.input_index();
+    update.type = proto.type();
+    TF_RETURN_IF_ERROR(ShapeFromProto(proto.shape(), &update.shape));
+    update.modified = proto.modified();
+    update.tensor_array_gradients_accessed.insert(
+        proto.tensor_array_gradients_accessed().begin(),
+        proto.tensor_array_gradients_accessed().end());
+    result->resource_updates.push_back(std::move(update));
+  }
+  result->collective_reduce_info.reset();
+  if (serialized.has_collective_reduce_info()) {
+    result->collective_reduce_info.emplace();
+    result->collective_reduce_info->group_key =
+        serialized.collective_reduce_info().group_key();
+    result->collective_reduce_info->group_size =
+        serialized.collective_reduce_info().group_size();
+  }
+  return Status::OK();
+}
+
+xla::StatusOr<string> BuildPersistentCacheKey(
+    const XlaCompiler::Options& options,
+    const XlaCompiler::CompileOptions& compile_options,
+    const NameAttrList& function, absl::Span<const XlaCompiler::Argument> args,
+    const string& device_description) {
+  const FunctionDef* fdef =
+      options.flib_def ? options.flib_def->Find(function.name()) : nullptr;
+  if (fdef == nullptr) {
+    return errors::NotFound("Function ", function.name(),
+                            " is not in the function library");
+  }
+  // The library is a hash map, so sort it to make the key deterministic.
+  FunctionDefLibrary library =
+      options.flib_def->ReachableDefinitions(*fdef).ToProto();
+  std::sort(library.mutable_function()->begin(),
+            library.mutable_function()->end(),
+            [](const FunctionDef& a, const FunctionDef& b) {
+              return a.signature().name() < b.signature().name();
+            });
+  std::sort(library.mutable_gradient()->begin(),
+            library.mutable_gradient()->end(),
+            [](const GradientDef& a, const GradientDef& b) {
+              return a.function_name() < b.function_name();
+            });
+
+  string key_material;
+  AppendKeyPart(TF_VERSION_STRING, &key_material);
+  AppendKeyPart(tf_git_version(), &key_material);
+  AppendKeyPart(device_description, &key_material);
+  // The shape representation function is not fingerprinted; it is determined
+  // by the device type.
+  AppendKeyPart(absl::StrCat(options.device_type.type_string(), ",",
+                             options.graph_def_version, ",",
+                             options.allow_cpu_custom_calls, ",",
+                             options.custom_fake_quant_op_calls, ",",
+                             options.alias_passthrough_params),
+                &key_material);
+  AppendKeyPart(
+      absl::StrCat(compile_options.use_tuple_arg, ",",
+                   compile_options.return_updated_values_for_all_resources,
+                   ",", compile_options.always_return_tuple, ",",
+                   compile_options.is_entry_computation, ",",
+                   compile_options.add_token_input_output, ",",
+                   compile_options.alias_resource_update),
+      &key_material);
+  string serialized;
+  SerializeToStringDeterministic(xla::GetDebugOptionsFromFlags(), &serialized);
+  AppendKeyPart(serialized, &key_material);
+  AppendKeyPart(Canonicalize(function.name(), AttrSlice(&function.attr())),
+                &key_material);
+  SerializeToStringDeterministic(library, &serialized);
+  AppendKeyPart(serialized, &key_material);
+  for (const XlaCompiler::Argument& arg : args) {
+    AppendArgument(arg, &key_material);
+  }
+
+  const Fprint128 fingerprint = Fingerprint128(key_material);
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+XlaPersistentCache::XlaPersistentCache(string directory, Env* env)
+    : directory_(std::move(directory)), env_(env) {}
+
+string XlaPersistentCache::FilePath(const string& key) const {
+  return io::JoinPath(directory_, absl::StrCat(key, ".pb"));
+}
+
+Status XlaPersistentCache::Load(const string& key,
+                                XlaSerializedCacheEntry* entry) const {
+  const string path = FilePath(key);
+  TF_RETURN_IF_ERROR(env_->FileExists(path));
+  TF_RETURN_IF_ERROR(ReadBinaryProto(env_, path, entry));
+  if (entry->key() != key) {
+    return errors::DataLoss("The compilation persisted in ", path,
+                            " was stored under key ", entry->key());
+  }
+  return Status::OK();
+}
+
+Status XlaPersistentCache::Save(const XlaSerializedCacheEntry& entry) const {
+  Status status = env_->RecursivelyCreateDir(directory_);
+  if (!status.ok() && !errors::IsAlreadyExists(status)) return status;
+  // Concurrent readers never see a partially written entry.
+  return AtomicWriteBinaryProto(env_, FilePath(entry.key()), entry);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,76 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_PERSISTENT_CACHE_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_PERSISTENT_CACHE_H_
+
+#include "absl/types/span.h"
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// Converts a CompilationResult to and from its serialized form.  The
+// computation is not part of the serialized form, and is left untouched by
+// DeserializeCompilationResult.
+void SerializeCompilationResult(const XlaCompiler::CompilationResult& result,
+                                XlaSerializedCompilationResult* serialized);
+Status DeserializeCompilationResult(
+    const XlaSerializedCompilationResult& serialized,
+    XlaCompiler::CompilationResult* result);
+
+// Returns the key under which the compilation of `function` with `args` is
+// persisted.  The key fingerprints everything the compiled executable depends
+// on: the function and the functions it calls, the arguments, the compiler
+// options, the XLA flags, the TensorFlow version and `device_description`,
+// which must identify the kind of device the executable is built for.
+xla::StatusOr<string> BuildPersistentCacheKey(
+    const XlaCompiler::Options& options,
+    const XlaCompiler::CompileOptions& compile_options,
+    const NameAttrList& function, absl::Span<const XlaCompiler::Argument> args,
+    const string& device_description);
+
+// Disk-backed tier of XlaCompilationCache.  Each entry is stored in its own
+// file of `directory`, named after its key, so that processes sharing the
+// directory never need to coordinate beyond atomically renaming the files they
+// write.
+class XlaPersistentCache {
+ public:
+  explicit XlaPersistentCache(string directory, Env* env = Env::Default());
+
+  // Reads the entry stored under `key`.  Returns NotFound if there is none, and
+  // another error if the stored entry is unreadable or was stored under another
+  // key.
+  Status Load(const string& key, XlaSerializedCacheEntry* entry) const;
+
+  // Stores `entry` under its key, replacing any previous entry.
+  Status Save(const XlaSerializedCacheEntry& entry) const;
+
+ private:
+  string FilePath(const string& key) const;
+
+  const string directory_;
+  Env* const env_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(XlaPersistentCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_PERSISTENT_CACHE_H_
@@ -0,0 +1,159 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_persistent_cache.h"
+
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(XlaPersistentCacheTest, CompilationResultRoundTrip) {
+  XlaCompiler::CompilationResult result;
+  result.input_mapping = {0, 2};
+  result.xla_input_shapes = {xla::ShapeUtil::MakeShape(xla::F32, {2, 3}),
+                             xla::ShapeUtil::MakeShape(xla::S32, {})};
+  result.xla_output_shape = xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(xla::F32, {2, 3})});
+  result.outputs.resize(2);
+  result.outputs[0].type = DT_FLOAT;
+  result.outputs[0].shape = TensorShape({2, 3});
+  result.outputs[1].type = DT_INT32;
+  result.outputs[1].shape = TensorShape({2});
+  result.outputs[1].is_constant = true;
+  result.outputs[1].constant_value = test::AsTensor<int32>({4, 5});
+  result.resource_updates.resize(1);
+  result.resource_updates[0].input_index = 1;
+  result.resource_updates[0].type = DT_FLOAT;
+  result.resource_updates[0].shape = TensorShape({3});
+  result.resource_updates[0].modified = true;
+  result.resource_updates[0].tensor_array_gradients_accessed = {"grad"};
+  result.collective_reduce_info.emplace();
+  result.collective_reduce_info->group_key = 7;
+  result.collective_reduce_info->group_size = 4;
+
+  XlaSerializedCompilationResult serialized;
+  SerializeCompilationResult(result, &serialized);
+  XlaCompiler::CompilationResult restored;
+  TF_ASSERT_OK(DeserializeCompilationResult(serialized, &restored));
+
+  EXPECT_EQ(restored.input_mapping, result.input_mapping);
+  ASSERT_EQ(restored.xla_input_shapes.size(), 2);
+  EXPECT_TRUE(xla::ShapeUtil::Equal(restored.xla_input_shapes[0],
+                                    result.xla_input_shapes[0]));
+  EXPECT_TRUE(xla::ShapeUtil::Equal(restored.xla_input_shapes[1],
+                                    result.xla_input_shapes[1]));
+  EXPECT_TRUE(xla::ShapeUtil::Equal(restored.xla_output_shape,
+                                    result.xla_output_shape));
+  ASSERT_EQ(restored.outputs.size(), 2);
+  EXPECT_EQ(restored.outputs[0].type, DT_FLOAT);
+  EXPECT_EQ(restored.outputs[0].shape, TensorShape({2, 3}));
+  EXPECT_FALSE(restored.outputs[0].is_constant);
+  EXPECT_TRUE(restored.outputs[1].is_constant);
+  test::ExpectTensorEqual<int32>(restored.outputs[1].constant_value,
+                                 result.outputs[1].constant_value);
+  ASSERT_EQ(restored.resource_updates.size(), 1);
+  EXPECT_EQ(restored.resource_updates[0].input_index, 1);
+  EXPECT_EQ(restored.resource_updates[0].shape, TensorShape({3}));
+  EXPECT_TRUE(restored.resource_updates[0].modified);
+  EXPECT_EQ(restored.resource_updates[0].tensor_array_gradients_accessed,
+            std::set<string>({"grad"}));
+  ASSERT_TRUE(restored.collective_reduce_info.has_value());
+  EXPECT_EQ(restored.collective_reduce_info->group_key, 7);
+  EXPECT_EQ(restored.collective_reduce_info->group_size, 4);
+}
+
+TEST(XlaPersistentCacheTest, KeyCoversFunctionAndArguments) {
+  FunctionDefLibrary proto;
+  *proto.add_function() = test::function::XTimesTwo();
+  *proto.add_function() = test::function::XTimesFour();
+  FunctionLibraryDefinition flib_def(OpRegistry::Global(), proto);
+  XlaCompiler::Options options;
+  options.device_type = DeviceType("XLA_CPU_JIT");
+  options.flib_def = &flib_def;
+  XlaCompiler::CompileOptions compile_options;
+  NameAttrList function;
+  function.set_name("XTimesTwo");
+  (*function.mutable_attr())["T"].set_type(DT_FLOAT);
+  std::vector<XlaCompiler::Argument> args(1);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({2});
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      string key, BuildPersistentCacheKey(options, compile_options, function,
+                                          args, "Host:cpu"));
+  TF_ASSERT_OK_AND_ASSIGN(
+      string same_key, BuildPersistentCacheKey(options, compile_options,
+                                               function, args, "Host:cpu"));
+  EXPECT_EQ(key, same_key);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      string other_device, BuildPersistentCacheKey(options, compile_options,
+                                                   function, args, "CUDA:gpu"));
+  EXPECT_NE(key, other_device);
+
+  args[0].shape = TensorShape({3});
+  TF_ASSERT_OK_AND_ASSIGN(
+      string other_shape, BuildPersistentCacheKey(options, compile_options,
+                                                  function, args, "Host:cpu"));
+  EXPECT_NE(key, other_shape);
+
+  function.set_name("XTimesFour");
+  TF_ASSERT_OK_AND_ASSIGN(
+      string other_function, BuildPersistentCacheKey(
+                                 options, compile_options, function, args,
+                                 "Host:cpu"));
+  EXPECT_NE(other_shape, other_function);
+
+  function.set_name("Missing");
+  EXPECT_TRUE(errors::IsNotFound(
+      BuildPersistentCacheKey(options, compile_options, function, args,
+                              "Host:cpu")
+          .status()));
+}
+
+TEST(XlaPersistentCacheTest, SaveAndLoad) {
+  const string directory =
+      io::JoinPath(tensorflow::testing::TmpDir(), "xla_persistent_cache");
+  XlaPersistentCache cache(directory);
+
+  XlaSerializedCacheEntry entry;
+  EXPECT_TRUE(errors::IsNotFound(cache.Load("0123", &entry)));
+
+  entry.set_key("0123");
+  entry.mutable_compilation_result()->add_input_mapping(3);
+  entry.mutable_optimized_module()->set_name("cluster");
+  TF_ASSERT_OK(cache.Save(entry));
+
+  XlaSerializedCacheEntry loaded;
+  TF_ASSERT_OK(cache.Load("0123", &loaded));
+  EXPECT_EQ(loaded.compilation_result().input_mapping(0), 3);
+  EXPECT_EQ(loaded.optimized_module().name(), "cluster");
+
+  // An entry found under the wrong name is rejected.
+  TF_ASSERT_OK(Env::Default()->RenameFile(io::JoinPath(directory, "0123.pb"),
+                                          io::JoinPath(directory, "4567.pb")));
+  EXPECT_TRUE(errors::IsDataLoss(cache.Load("4567", &loaded)));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -2390,3 +2390,49 @@ func @dontReplaceOneHotFullyConnectedWithLookupBadBias(%arg: tensor<2xi32>) -> t
   // CHECK: %[[RES:.*]] = "tfl.fully_connected"(%[[TMP]], %[[CST4]], %[[CST5]]) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<2x3xf32>, tensor<5x3xf32>, tensor<f32>) -> tensor<2x5xf32>
   // CHECK: return %[[RES]] : tensor<2x5xf32>
 }
+
+// CHECK-LABEL: removeGatherOfTopKIndices
+func @removeGatherOfTopKIndices(%arg0: tensor<2x8xf32>) -> tensor<2x3xf32> {
+  %k = constant dense<3> : tensor<i32>
+  %values, %indices = "tfl.topk_v2"(%arg0, %k) : (tensor<2x8xf32>, tensor<i32>) -> (tensor<2x3xf32>, tensor<2x3xi32>)
+  %0 = "tfl.gather"(%arg0, %indices) {axis = 1 : i32, batch_dims = 1 : i32} : (tensor<2x8xf32>, tensor<2x3xi32>) -> tensor<2x3xf32>
+  %1 = "tfl.softmax"(%0) {beta = 1.000000e+00 : f32} : (tensor<2x3xf32>) -> tensor<2x3xf32>
+  return %1 : tensor<2x3xf32>
+
+  // CHECK: %[[TOPK:.*]]:2 = "tfl.topk_v2"(%arg0
+  // CHECK-NOT: "tfl.gather"
+  // CHECK: %[[RES:.*]] = "tfl.softmax"(%[[TOPK]]#0)
+  // CHECK: return %[[RES]]
+}
+
+// CHECK-LABEL: dontRemoveGatherOfTopKIndicesWithoutBatchDims
+func @dontRemoveGatherOfTopKIndicesWithoutBatchDims(%arg0: tensor<2x8xf32>) -> tensor<2x2x3xf32> {
+  %k = constant dense<3> : tensor<i32>
+  %values, %indices = "tfl.topk_v2"(%arg0, %k) : (tensor<2x8xf32>, tensor<i32>) -> (tensor<2x3xf32>, tensor<2x3xi32>)
+  %0 = "tfl.gather"(%arg0, %indices) {axis = 1 : i32} : (tensor<2x8xf32>, tensor<2x3xi32>) -> tensor<2x2x3xf32>
+  return %0 : tensor<2x2x3xf32>
+
+  // CHECK: "tfl.gather"
+}
+
+// CHECK-LABEL: removeCastOfGatherNdIndices
+func @removeCastOfGatherNdIndices(%arg0: tensor<10x4xf32>, %arg1: tensor<3x1xi32>) -> tensor<3x4xf32> {
+  %0 = "tfl.cast"(%arg1) : (tensor<3x1xi32>) -> tensor<3x1xi64>
+  %1 = "tfl.gather_nd"(%arg0, %0) : (tensor<10x4xf32>, tensor<3x1xi64>) -> tensor<3x4xf32>
+  return %1 : tensor<3x4xf32>
+
+  // CHECK-NOT: "tfl.cast"
+  // CHECK: %[[RES:.*]] = "tfl.gather_nd"(%arg0, %arg1) : (tensor<10x4xf32>, tensor<3x1xi32>) -> tensor<3x4xf32>
+  // CHECK: return %[[RES]]
+}
+
+// CHECK-LABEL: removeCastOfGatherIndices
+func @removeCastOfGatherIndices(%arg0: tensor<10x4xf32>, %arg1: tensor<3xi32>) -> tensor<3x4xf32> {
+  %0 = "tfl.cast"(%arg1) : (tensor<3xi32>) -> tensor<3xi64>
+  %1 = "tfl.gather"(%arg0, %0) {axis = 0 : i32} : (tensor<10x4xf32>, tensor<3xi64>) -> tensor<3x4xf32>
+  return %1 : tensor<3x4xf32>
+
+  // CHECK-NOT: "tfl.cast"
+  // CHECK: %[[RES:.*]] = "tfl.gather"(%arg0, %arg1)
+  // CHECK: return %[[RES]]
+}
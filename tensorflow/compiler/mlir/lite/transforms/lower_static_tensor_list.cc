@@ -274,7 +274,7 @@ struct ConvertConst : public OpConversionPattern<TF::ConstOp> {
 
     // Extract tensor elements for the TensorList and construct result type
     // based on the number of elements and element shape.
-    const std::vector<tensorflow::Tensor> &tensors = list->tensors();
+    const auto &tensors = list->tensors();
     llvm::SmallVector<int64_t, 4> result_shape = {
         static_cast<int64_t>(tensors.size())};
     result_shape.append(list_element_ty.getShape().begin(),
@@ -1397,6 +1397,54 @@ struct FuseUnpackAndConcatToReshape
   }
 };
 
+// Replaces a Gather of the TopK indices from the TopK input with the TopK
+// values, which hold the same elements. For example:
+//
+//   // %input: tensor<1x8xf32>
+//   %values, %indices = "tfl.topk_v2"(%input, %k)
+//   %res = "tfl.gather"(%input, %indices)
+//        {axis = 1 : i32, batch_dims = 1 : i32}
+//
+// can be optimized to
+//
+//   %values, %indices = "tfl.topk_v2"(%input, %k)
+//   %res = %values
+struct RemoveGatherOfTopKIndices : public OpRewritePattern<TFL::GatherOp> {
+  using OpRewritePattern::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(TFL::GatherOp gather_op,
+                                PatternRewriter &rewriter) const override {
+    auto topk_op =
+        dyn_cast_or_null<TFL::TopKV2Op>(gather_op.indices().getDefiningOp());
+    if (!topk_op || gather_op.indices() != topk_op.indices() ||
+        gather_op.params() != topk_op.input()) {
+      return failure();
+    }
+
+    // TopK works on the last dimension, and the indices of each row are
+    // relative to that row, so the Gather must batch over all the other
+    // dimensions.
+    auto input_type = topk_op.input().getType().dyn_cast<RankedTensorType>();
+    if (!input_type || input_type.getRank() == 0) {
+      return failure();
+    }
+    const int64_t rank = input_type.getRank();
+    int64_t axis = static_cast<int32_t>(gather_op.axis());
+    int64_t batch_dims = static_cast<int32_t>(gather_op.batch_dims());
+    if (axis < 0) axis += rank;
+    if (batch_dims < 0) batch_dims += rank;
+    if (axis != rank - 1 || batch_dims != rank - 1) {
+      return failure();
+    }
+
+    if (gather_op.getType() != topk_op.values().getType()) {
+      return failure();
+    }
+    rewriter.replaceOp(gather_op, topk_op.values());
+    return success();
+  }
+};
+
 using FuseBinaryOpToFollowingFullyConnected =
     FuseBinaryOpToFollowingAffineOp<FullyConnectedOp>;
 using FuseBinaryOpToFollowingDepthwiseConv2D =
@@ -1449,7 +1497,7 @@ void OptimizePass::runOnFunction() {
       FuseBinaryOpToFollowingFullyConnected, FuseConv2DAndMulWithQDQs,
       FuseDepthwiseConv2DAndMulWithQDQs, ConvertTrivialTransposeOpToReshapeOp,
       RemoveReshapeAfterFullyConnected, RemoveReshapeBeforeFullyConnected,
-      FuseUnpackAndConcatToReshape>(ctx);
+      FuseUnpackAndConcatToReshape, RemoveGatherOfTopKIndices>(ctx);
   if (enable_canonicalization_)
     AddCanonicalizationPatterns(ctx, &phase_2_patterns);
   (void)applyPatternsAndFoldGreedily(func, std::move(phase_2_patterns));
@@ -105,11 +105,13 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/transitive_fanin.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/graph_debug_info.pb.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
@@ -256,6 +258,12 @@ class ImporterBase {
   // interface.
   Status ConvertLibFunction(llvm::StringRef func_name);
 
+  // Converts the definitions of the given library functions to graphs in
+  // parallel, ahead of their import by `ConvertLibFunction`. Only the MLIR
+  // part of the import then remains sequential. Definitions that fail to
+  // convert are left to `ConvertLibFunction`, which reports the error.
+  void ConvertLibFunctionBodies(const std::vector<std::string>& func_names);
+
   // Returns the list of nodes in the graph. Nodes are presented in the reverse
   // order of a post-order depth-first visit starting from the graph's source
   // nodes.
@@ -439,6 +447,12 @@ class ImporterBase {
   std::unique_ptr<ShapeRefiner> shape_refiner_ = nullptr;
   NameUniquifier* function_name_uniquifier_;
   mlir::StatusScopedDiagnosticHandler error_handler_;
+  // Library function bodies converted by `ConvertLibFunctionBodies` and not
+  // imported yet, shared with the importers of the library functions.
+  using FunctionBodies =
+      absl::flat_hash_map<std::string, std::unique_ptr<FunctionBody>>;
+  std::shared_ptr<FunctionBodies> function_bodies_ =
+      std::make_shared<FunctionBodies>();
 
  protected:
   // Maps feed as TensorId to new Placeholder node name.
@@ -1261,10 +1275,17 @@ Status ImporterBase::ConvertLibFunction(llvm::StringRef func_name) {
                      "'. The imported TensorFlow GraphDef is ill-formed."));
   }
 
-  // Converts the function definition to a graph.
+  // Converts the function definition to a graph, unless it was converted
+  // ahead of time.
   std::unique_ptr<FunctionBody> fbody;
-  TF_RETURN_IF_ERROR(
-      FunctionDefToBodyHelper(*func_def, AttrSlice(), &func_lib, &fbody));
+  auto converted_body = function_bodies_->find(std::string(func_name));
+  if (converted_body != function_bodies_->end()) {
+    fbody = std::move(converted_body->second);
+    function_bodies_->erase(converted_body);
+  } else {
+    TF_RETURN_IF_ERROR(
+        FunctionDefToBodyHelper(*func_def, AttrSlice(), &func_lib, &fbody));
+  }
 
   // Converts the argument and return types to MLIR types.
   absl::InlinedVector<mlir::NamedAttribute, 8> attributes;
@@ -1331,6 +1352,7 @@ Status ImporterBase::ConvertLibFunction(llvm::StringRef func_name) {
   ImporterBase child_importer(graph_flib_, debug_info_, specs, module_,
                               tf_name_to_mlir_name_, function_name_uniquifier_,
                               func_name);
+  child_importer.function_bodies_ = function_bodies_;
   TF_RETURN_IF_ERROR(child_importer.PrepareConvert(*fbody->graph));
 
   TF_ASSIGN_OR_RETURN(auto func_type,
@@ -1348,6 +1370,42 @@ Status ImporterBase::ConvertLibFunction(llvm::StringRef func_name) {
   return Status::OK();
 }
 
+void ImporterBase::ConvertLibFunctionBodies(
+    const std::vector<std::string>& func_names) {
+  std::vector<std::string> names;
+  for (const std::string& name : func_names) {
+    if (!tf_name_to_mlir_name_->count(name) && !function_bodies_->count(name))
+      names.push_back(name);
+  }
+  // Not worth a thread pool.
+  constexpr size_t kMinFunctionsForParallelConversion = 4;
+  if (names.size() < kMinFunctionsForParallelConversion) return;
+
+  std::vector<std::unique_ptr<FunctionBody>> bodies(names.size());
+  {
+    thread::ThreadPool pool(
+        Env::Default(), "mlir_import_functions",
+        std::min<int>(port::MaxParallelism(), names.size()));
+    // Each definition is converted to a whole graph, which is expensive
+    // compared to scheduling.
+    constexpr int64 kCostPerFunction = 1 << 20;
+    auto convert = [&](int64 start, int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        const FunctionDef* func_def = graph_flib_.Find(names[i]);
+        if (func_def == nullptr) continue;
+        FunctionDefToBodyHelper(*func_def, AttrSlice(), &graph_flib_,
+                                &bodies[i])
+            .IgnoreError();
+      }
+    };
+    pool.ParallelFor(names.size(), kCostPerFunction, convert);
+  }
+  for (int i = 0, end = names.size(); i < end; ++i) {
+    if (bodies[i] != nullptr)
+      function_bodies_->emplace(names[i], std::move(bodies[i]));
+  }
+}
+
 Status ImporterBase::PruneUnreachableNodes(
     std::unordered_map<string, Node*>* node_name_map) {
   std::unordered_set<const Node*> prune_start;
@@ -2287,6 +2345,17 @@ StatusOr<mlir::OwningModuleRef> GraphDefImporter::Convert(
 
   TF_RETURN_IF_ERROR(importer.PrepareConvert(graph));
 
+  // The library functions reachable from the graph are imported on demand,
+  // convert their definitions in parallel beforehand.
+  if (flib_def.num_functions() > 0) {
+    GraphDef nodes;
+    for (const Node* node : importer.GetOrderedNodes()) {
+      *nodes.add_node() = node->def();
+    }
+    importer.ConvertLibFunctionBodies(
+        flib_def.ReachableDefinitions(nodes).ListFunctionNames());
+  }
+
   mlir::FunctionType func_type;
   absl::InlinedVector<OutputTensor, 4> arg_nodes;
   absl::InlinedVector<OutputTensor, 4> ret_nodes;
@@ -3371,6 +3440,7 @@ StatusOr<mlir::OwningModuleRef> SavedModelObjectGraphImporter::Convert(
   TF_RETURN_IF_ERROR(importer.PrepareConvert(graph));
 
   auto fn_names = graph.flib_def().ListFunctionNames();
+  importer.ConvertLibFunctionBodies(fn_names);
   for (const auto& fn_name : fn_names) {
     TF_RETURN_IF_ERROR(importer.ConvertLibFunction(fn_name));
   }
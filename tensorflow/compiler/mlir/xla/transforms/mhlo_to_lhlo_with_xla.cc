@@ -1841,6 +1841,12 @@ Status LhloDialectEmitter::Initialize() {
           builder_.getStringAttr(
               xla::llvm_ir::ConstantBufferAllocationToGlobalName(*alloc)));
     }
+    // Optional: the allocations outside of the default memory space are only
+    // accessed by copies.
+    if (alloc->color() != 0) {
+      arg_attr_list.set("lmhlo.memory_space",
+                        builder_.getI64IntegerAttr(alloc->color()));
+    }
     auto iter = allocation_to_output_info.find(alloc);
     if (iter != allocation_to_output_info.end()) {
       const Shape* sub_shape = iter->second.first;
@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -686,6 +687,23 @@ static bool AllowEngineNativeSegmentExecution() {
   return value;
 }
 
+// Maximum number of execution contexts per profile of an engine, so that up to
+// this many executions of the engine run concurrently.
+static int64 MaxExecutionContextsPerProfile() {
+  static const int64 value = [] {
+    int64 value;
+    Status status =
+        ReadInt64FromEnvVar("TF_TRT_MAX_EXECUTION_CONTEXTS_PER_ENGINE",
+                            /*default_val=*/1, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      value = 1;
+    }
+    return std::max<int64>(value, 1);
+  }();
+  return value;
+}
+
 void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
                                AsyncOpKernel::DoneCallback done) {
   tensorflow::profiler::TraceMe activity(
@@ -863,12 +881,19 @@ Status TRTEngineOp::ExecuteTrtEngine(
   const int num_binding = cuda_engine->getNbBindings();
   std::vector<void*> buffers(num_binding);
 
-  // nvinfer1::IExecutionContext::enqueue is not thread safe and we need a mutex
-  // for it.
-  mutex_lock lock(engine_context->mu);
+  // nvinfer1::IExecutionContext::enqueue is not thread safe, so each
+  // execution uses a context of its own until the enqueue returns. The
+  // contexts of an engine share its weights and get their device memory per
+  // execution below.
   nvinfer1::IExecutionContext* execution_context;
-  TF_RETURN_IF_ERROR(
-      engine_context->GetExecutionContext(trt_context_idx, &execution_context));
+  TF_RETURN_IF_ERROR(engine_context->AcquireExecutionContext(
+      trt_context_idx,
+      profiles.NeedProfiles() ? 1 : MaxExecutionContextsPerProfile(),
+      &execution_context));
+  auto release_context = gtl::MakeCleanup([&]() {
+    engine_context->ReleaseExecutionContext(trt_context_idx,
+                                            execution_context);
+  });
 
   if (VLOG_IS_ON(2)) {
     VLOG(2) << "Selected execution context: " << trt_context_idx;
@@ -1100,6 +1125,7 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     cache.emplace(input_concrete_shapes,
                   absl::make_unique<EngineContext>(std::move(engine),
                                                    std::move(exec_contexts)));
+    cache_res->EvictToMemoryLimit(input_concrete_shapes);
     VLOG(1) << "Added new engine to cache of " << name()
             << ". Cache size: " << cache.size();
     engine_contexts = cache.at(input_concrete_shapes).get();
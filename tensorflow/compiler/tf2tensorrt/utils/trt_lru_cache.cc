@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
 #include "third_party/tensorrt/NvInfer.h"
@@ -49,6 +50,51 @@ string CalibrationContext::TerminateCalibration() {
   return calibration_table_;
 }
 
+Status EngineContext::AcquireExecutionContext(
+    int idx, int max_contexts, nvinfer1::IExecutionContext** exec_ctx) {
+  mutex_lock lock(mu);
+  if (idx >= execution_contexts.size()) {
+    return errors::Internal("Requested engine context with index ", idx,
+                            ", but only ", execution_contexts.size(),
+                            "contexts are present.");
+  }
+  if (free_execution_contexts_.empty()) {
+    for (const ExecutionContext& context : execution_contexts) {
+      free_execution_contexts_.push_back({context.get()});
+      num_execution_contexts_.push_back(1);
+    }
+  }
+  std::vector<nvinfer1::IExecutionContext*>& free_contexts =
+      free_execution_contexts_[idx];
+  while (free_contexts.empty()) {
+    if (num_execution_contexts_[idx] < max_contexts) {
+      ExecutionContext context = ExecutionContext::Create(cuda_engine.get());
+      if (context) {
+        VLOG(1) << "Creating execution context "
+                << num_execution_contexts_[idx] << " for profile " << idx
+                << " for a concurrent execution";
+        free_contexts.push_back(context.get());
+        extra_execution_contexts_.push_back(std::move(context));
+        ++num_execution_contexts_[idx];
+        continue;
+      }
+      LOG(WARNING) << "Failed to create an additional execution context, "
+                   << "waiting for one in use";
+    }
+    context_released_.wait(lock);
+  }
+  *exec_ctx = free_contexts.back();
+  free_contexts.pop_back();
+  return Status::OK();
+}
+
+void EngineContext::ReleaseExecutionContext(
+    int idx, nvinfer1::IExecutionContext* exec_ctx) {
+  mutex_lock lock(mu);
+  free_execution_contexts_[idx].push_back(exec_ctx);
+  context_released_.notify_one();
+}
+
 const absl::string_view kTfTrtContainerName = "TF-TRT";
 
 Logger& TRTEngineCacheResource::GetLogger() {
@@ -68,6 +114,8 @@ TRTEngineCacheResource::TRTEngineCacheResource(OpKernelContext* ctx,
   } else {
     allocator_.reset(new TRTDeviceAllocator(alloc));
   }
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_TRT_ENGINE_CACHE_MEMORY_LIMIT_BYTES",
+                                  /*default_val=*/0, &memory_limit_bytes_));
 }
 
 TRTEngineCacheResource::~TRTEngineCacheResource() {
@@ -99,6 +147,7 @@ string TRTEngineCacheResource::DebugString() const {
 EngineContext* TRTEngineCacheResource::GetEngineContext(
     const std::vector<TensorShape>& input_shapes) {
   EngineContext* engine_context = nullptr;
+  const std::vector<TensorShape>* matched_input_shapes = nullptr;
   int64 min_matched_batch_size = kint64max;
   for (const auto& pair : cache_) {
     const std::vector<TensorShape>& cached_input_shapes = pair.first;
@@ -113,12 +162,48 @@ EngineContext* TRTEngineCacheResource::GetEngineContext(
       if (min_matched_batch_size > cached_batch_size) {
         min_matched_batch_size = cached_batch_size;
         engine_context = pair.second.get();
+        matched_input_shapes = &cached_input_shapes;
       }
     }
   }
+  // Mark the engine as recently used for the eviction order of the cache.
+  if (matched_input_shapes != nullptr) cache_.at(*matched_input_shapes);
   return engine_context;
 }
 
+void TRTEngineCacheResource::EvictToMemoryLimit(
+    const std::vector<TensorShape>& input_shapes) {
+  if (memory_limit_bytes_ <= 0 || cache_.count(input_shapes) == 0) return;
+  EngineContext* engine_context = cache_.at(input_shapes).get();
+  if (engine_context->cuda_engine) {
+    // Weights, approximated by the serialized engine, and the activation
+    // memory of each execution context.
+    TrtUniquePtrType<nvinfer1::IHostMemory> serialized(
+        engine_context->cuda_engine->serialize());
+    engine_context->device_memory_bytes =
+        (serialized ? serialized->size() : 0) +
+        engine_context->cuda_engine->getDeviceMemorySize() *
+            engine_context->GetNumContexts();
+  }
+
+  int64 total_bytes = 0;
+  for (const auto& pair : cache_) {
+    total_bytes += pair.second->device_memory_bytes;
+  }
+  // The engine for input_shapes was just used, so it is the most recently used
+  // one and is never evicted.
+  while (total_bytes > memory_limit_bytes_ && cache_.size() > 1) {
+    const std::vector<TensorShape> evicted = cache_.least_recently_used();
+    const int64 evicted_bytes = cache_.at(evicted)->device_memory_bytes;
+    VLOG(1) << "Evicting the TensorRT engine for input shapes "
+            << TensorShapeUtils::ShapeListString(evicted) << " holding "
+            << evicted_bytes << " bytes, cache memory limit: "
+            << memory_limit_bytes_ << " bytes";
+    cache_.erase(evicted);
+    total_bytes -= evicted_bytes;
+  }
+}
+
 EngineContext* TRTEngineCacheResource::GetEngineContext(const int profile_id) {
   if (profiles_.NeedProfiles() && profile_id >= profiles_.GetNumProfiles()) {
     LOG(ERROR) << "Out of range: profile_id " << profile_id
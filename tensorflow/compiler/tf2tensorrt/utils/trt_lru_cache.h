@@ -68,6 +68,17 @@ class LRUCache {
   iterator begin() { return objects_.begin(); }
   iterator end() { return objects_.end(); }
 
+  // Removes the entry of key, if any.
+  void erase(const key_type& key) {
+    if (objects_.erase(key) > 0) {
+      keys_.remove(key);
+    }
+  }
+
+  // Returns the key of the least recently used entry. The cache must not be
+  // empty.
+  const key_type& least_recently_used() const { return keys_.back(); }
+
   template <typename... Args>
   std::pair<iterator, bool> emplace(Args&&... args) {
     DiscardOld(1);
@@ -133,6 +144,10 @@ struct EngineContext {
   mutex mu;
   TrtUniquePtrType<nvinfer1::ICudaEngine> cuda_engine;
 
+  // Estimated device memory held by the engine and its execution contexts,
+  // see TRTEngineCacheResource::EvictToMemoryLimit().
+  int64 device_memory_bytes = 0;
+
   Status GetExecutionContext(int idx, nvinfer1::IExecutionContext** exec_ctx)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
     if (idx >= execution_contexts.size()) {
@@ -149,6 +164,20 @@ struct EngineContext {
     return execution_contexts.size();
   }
 
+  // Acquires an execution context for profile idx for the duration of one
+  // execution, to be returned with ReleaseExecutionContext(). Unlike
+  // GetExecutionContext(), mu is not held during the execution, so executions
+  // on different contexts of the engine run concurrently. When all the
+  // contexts of the profile are in use, a new one is created if the profile
+  // has fewer than max_contexts, and otherwise this waits for a release.
+  // Engines with optimization profiles must pass max_contexts=1, since a
+  // profile can only be used by one context at a time.
+  Status AcquireExecutionContext(int idx, int max_contexts,
+                                 nvinfer1::IExecutionContext** exec_ctx)
+      TF_LOCKS_EXCLUDED(mu);
+  void ReleaseExecutionContext(int idx, nvinfer1::IExecutionContext* exec_ctx)
+      TF_LOCKS_EXCLUDED(mu);
+
   // In explicit batch mode, we maintain a vector of contexts for each engine,
   // where each context is created for a specific profile. This is because it is
   // either not possible or non-trivial to change the profile of a context for
@@ -165,6 +194,17 @@ struct EngineContext {
   // Additional discussion about execution context management and thread safety
   // at https://github.com/tensorflow/tensorflow/issues/36959
   std::vector<ExecutionContext> execution_contexts TF_GUARDED_BY(mu);
+
+ private:
+  // Contexts created by AcquireExecutionContext() in addition to
+  // execution_contexts.
+  std::vector<ExecutionContext> extra_execution_contexts_ TF_GUARDED_BY(mu);
+  // Per profile, the contexts not used by an execution and the total number
+  // of contexts. Filled from execution_contexts on the first acquire.
+  std::vector<std::vector<nvinfer1::IExecutionContext*>>
+      free_execution_contexts_ TF_GUARDED_BY(mu);
+  std::vector<int> num_execution_contexts_ TF_GUARDED_BY(mu);
+  condition_variable context_released_;
 };
 
 // Contains the context required to build the calibration data.
@@ -217,6 +257,16 @@ class TRTEngineCacheResource : public ResourceBase {
   // Returns nullptr if no compatible EngineContexts is found in cache.
   EngineContext* GetEngineContext(const int profile_id);
 
+  // Sets the estimated device memory of the engine cached for input_shapes,
+  // then evicts the least recently used other engines until the engines in
+  // the cache fit in memory_limit_bytes_. Does nothing without a limit.
+  void EvictToMemoryLimit(const std::vector<TensorShape>& input_shapes);
+
+  // Upper bound of the estimated device memory of the cached engines, read
+  // from TF_TRT_ENGINE_CACHE_MEMORY_LIMIT_BYTES. Zero means no limit, leaving
+  // only the engine count bound of the cache.
+  int64 memory_limit_bytes_ = 0;
+
   // Keep device allocator for TRT.
   std::unique_ptr<TRTBaseAllocator> allocator_;
 
@@ -53,5 +53,29 @@ TEST(LRUCacheTest, Basic) {
   EXPECT_EQ(cache.count(40), 1);
 }
 
+TEST(LRUCacheTest, EraseAndLeastRecentlyUsed) {
+  LRUCache<int, int, std::hash<int>> cache(3);
+  cache.emplace(10, 100);
+  cache.emplace(20, 200);
+  cache.emplace(30, 300);
+  EXPECT_EQ(cache.least_recently_used(), 10);
+  // Touch 10
+  cache.at(10);
+  EXPECT_EQ(cache.least_recently_used(), 20);
+  cache.erase(20);
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.count(20), 0);
+  EXPECT_EQ(cache.least_recently_used(), 30);
+  // Erasing a missing key does nothing.
+  cache.erase(20);
+  EXPECT_EQ(cache.size(), 2);
+  // Insert 40 and 50, evicting 30 only.
+  cache.emplace(40, 400);
+  cache.emplace(50, 500);
+  EXPECT_EQ(cache.count(30), 0);
+  EXPECT_EQ(cache.count(10), 1);
+  EXPECT_EQ(cache.least_recently_used(), 10);
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
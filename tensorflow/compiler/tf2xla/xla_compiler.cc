@@ -63,6 +63,14 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+// Returns whether `arg` is a parameter with bounded dynamic dimensions, as
+// produced by shape bucketing in the XLA JIT.
+bool IsDynamicParameter(const XlaCompiler::Argument& arg) {
+  return arg.kind == XlaCompiler::Argument::kParameter &&
+         absl::holds_alternative<xla::Shape>(arg.shape) &&
+         absl::get<xla::Shape>(arg.shape).is_dynamic();
+}
+
 // Checks that arguments `args` match types `types`.
 Status CheckSignature(const DataTypeVector& types,
                       absl::Span<const XlaCompiler::Argument> args) {
@@ -861,6 +869,15 @@ Status XlaCompiler::XLAShapeForArgument(
         TF_RETURN_IF_ERROR(RewriteLayoutWithShardedShape(
             arg_sharding, /*use_fast_memory=*/false,
             options_.shape_representation_fn, xla_shape));
+        if (IsDynamicParameter(arg) && xla_shape->IsArray() &&
+            xla_shape->rank() == shape.dims()) {
+          // Keep the bounded dynamic dimensions of the argument.
+          const xla::Shape& arg_shape = absl::get<xla::Shape>(arg.shape);
+          for (int i = 0; i < arg_shape.rank(); ++i) {
+            xla_shape->set_dynamic_dimension(
+                i, arg_shape.is_dynamic_dimension(i));
+          }
+        }
       } else {
         if (absl::holds_alternative<xla::Shape>(arg.shape)) {
           *xla_shape = absl::get<xla::Shape>(arg.shape);
@@ -1152,9 +1169,12 @@ Status XlaCompiler::BuildArguments(
         // Reshape parameters back to their correct shapes.
         // TODO(b/76097077): propagate device assignments onto arguments and
         // return values of functions, and then reshape unconditionally.
-        if (is_entry_computation) {
+        if (is_entry_computation && !IsDynamicParameter(arg)) {
           arg_expression = XlaExpression::XlaOp(
               xla::Reshape(arg_handles[i], arg.DimensionSizes()), arg.type);
+        } else if (is_entry_computation) {
+          // A static reshape would drop the dynamic dimensions.
+          arg_expression = XlaExpression::XlaOp(arg_handles[i], arg.type);
         } else {
           arg_expression = XlaExpression::XlaOp(arg_handles[i], arg.type);
           if (arg.value_bound) {
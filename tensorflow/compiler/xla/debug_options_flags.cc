@@ -140,6 +140,13 @@ static void AllocateFlags() {
     };
   };
 
+  auto int64_setter_for = [](void (DebugOptions::*member_setter)(int64)) {
+    return [member_setter](int64 value) {
+      (flag_values->*member_setter)(value);
+      return true;
+    };
+  };
+
   auto string_setter_for =
       [](void (DebugOptions::*member_setter)(const string& value)) {
         return [member_setter](const string& value) {
@@ -335,6 +342,38 @@ static void AllocateFlags() {
       "over time.  The only 'guarantee', such as it is, is that if you compile "
       "XLA and dump the optimized HLO for some graph, you should be able to "
       "run it again on the same device with the same build of XLA."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_hlo_pass_fix_fast_compile",
+      bool_setter_for(&DebugOptions::set_xla_hlo_pass_fix_fast_compile),
+      flag_values->xla_hlo_pass_fix_fast_compile(),
+      "Stops running a pass to a fixed point as soon as an iteration no longer "
+      "reduces the number of instructions in the module."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_buffer_assignment_repacking",
+      bool_setter_for(&DebugOptions::set_xla_buffer_assignment_repacking),
+      flag_values->xla_buffer_assignment_repacking(),
+      "Repacks the temp buffers after buffer assignment, moving each to the "
+      "lowest free offset during its live range, to lower the size of the "
+      "temp allocations."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_vectorize_column_reductions",
+      bool_setter_for(&DebugOptions::set_xla_gpu_vectorize_column_reductions),
+      flag_values->xla_gpu_vectorize_column_reductions(),
+      "Lets each thread of a column reduction over 16-bit or narrower inputs "
+      "read four adjacent columns, to use wider vector loads."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_rewrite_column_reductions_as_gemv",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_rewrite_column_reductions_as_gemv),
+      flag_values->xla_gpu_rewrite_column_reductions_as_gemv(),
+      "Rewrites column reductions that sum many rows into fewer columns than "
+      "a warp as cuBLAS matrix-vector products."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_enable_dynamic_dots",
+      bool_setter_for(&DebugOptions::set_xla_cpu_enable_dynamic_dots),
+      flag_values->xla_cpu_enable_dynamic_dots(),
+      "Multiplies only the rows in use of a matrix multiply whose LHS rows are "
+      "a bounded dynamic dimension, instead of padding them to the bound."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_embed_ir_in_executable",
       bool_setter_for(&DebugOptions::set_xla_embed_ir_in_executable),
@@ -581,6 +620,53 @@ static void AllocateFlags() {
       flag_values->xla_gpu_algorithm_denylist_path(),
       "An AlgorithmDenylist text proto file as a denylist of convolutions to "
       "avoid to use."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_autotune_results_path",
+      string_setter_for(&DebugOptions::set_xla_gpu_autotune_results_path),
+      flag_values->xla_gpu_autotune_results_path(),
+      "An AutotuneResults proto file to load GEMM and convolution autotuning "
+      "results from, and to save new results to. Text format is used if the "
+      "file name ends in .pbtxt."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_cuda_graphs",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_cuda_graphs),
+      flag_values->xla_gpu_enable_cuda_graphs(),
+      "Capture the thunks of executables without control flow into CUDA "
+      "graphs, and replay them when the buffer addresses do not change."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_batch_kernel_launches",
+      bool_setter_for(&DebugOptions::set_xla_gpu_batch_kernel_launches),
+      flag_values->xla_gpu_batch_kernel_launches(),
+      "Issue the launches of consecutive kernel thunks on a stream back to "
+      "back instead of one by one."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_enable_inter_op_parallelism",
+      bool_setter_for(&DebugOptions::set_xla_cpu_enable_inter_op_parallelism),
+      flag_values->xla_cpu_enable_inter_op_parallelism(),
+      "Run independent instructions concurrently on the intra-op thread pool "
+      "in the CPU backend."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_host_offload_memory_limit_bytes",
+      int64_setter_for(
+          &DebugOptions::set_xla_gpu_host_offload_memory_limit_bytes),
+      flag_values->xla_gpu_host_offload_memory_limit_bytes(),
+      "If positive, offload large activations to pinned host memory between "
+      "distant uses until the estimated peak device memory fits this budget."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_latency_hiding_scheduler",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_latency_hiding_scheduler),
+      flag_values->xla_gpu_enable_latency_hiding_scheduler(),
+      "Overlap asynchronous collectives with independent computation by "
+      "reordering the GPU schedule with a cost model."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_latency_hiding_scheduler_memory_limit_bytes",
+      int64_setter_for(
+          &DebugOptions::
+              set_xla_gpu_latency_hiding_scheduler_memory_limit_bytes),
+      flag_values->xla_gpu_latency_hiding_scheduler_memory_limit_bytes(),
+      "Estimated peak memory the latency-hiding scheduler may reach per "
+      "computation. If zero, the peak of the memory-minimizing schedule."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_gpu_deterministic_reductions",
       bool_setter_for(&DebugOptions::set_xla_gpu_deterministic_reductions),
@@ -628,7 +714,8 @@ static void AllocateFlags() {
           &DebugOptions::set_xla_gpu_force_compilation_parallelism),
       flag_values->xla_gpu_force_compilation_parallelism(),
       "Overrides normal multi-threaded compilation settting to use this many "
-      "threads. Setting to 0 (the default value) means no enforcement."));
+      "threads. Setting to 0 (the default value) means no enforcement, and a "
+      "negative value means one thread per core."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_gpu_deterministic_ops",
       bool_setter_for(&DebugOptions::set_xla_gpu_deterministic_ops),
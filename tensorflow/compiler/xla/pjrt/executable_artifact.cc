@@ -0,0 +1,131 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/executable_artifact.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/pjrt/executable_artifact.pb.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/shape.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/public/version.h"
+
+namespace xla {
+
+namespace {
+
+absl::string_view DeviceKind(const PjRtClient& client) {
+  if (client.addressable_devices().empty()) {
+    return "";
+  }
+  return client.addressable_devices().front()->device_kind();
+}
+
+}  // namespace
+
+std::string ExecutableArtifactCompilerVersion() {
+  return absl::StrCat(TF_VERSION_STRING, "-", tf_git_version());
+}
+
+StatusOr<std::string> SerializeExecutableArtifact(
+    const PjRtClient& client, const PjRtExecutable& executable,
+    bool parameter_is_tupled_arguments) {
+  if (executable.client() != &client) {
+    return InvalidArgument(
+        "Executable %s was not compiled by this client and can't be "
+        "serialized by it",
+        executable.name());
+  }
+  TF_ASSIGN_OR_RETURN(std::vector<std::shared_ptr<HloModule>> modules,
+                      executable.GetHloModules());
+  if (modules.size() != 1) {
+    return Unimplemented(
+        "SerializeExecutable is not implemented for MPMD executables, got %d "
+        "modules",
+        modules.size());
+  }
+
+  PjRtExecutableArtifact artifact;
+  artifact.set_platform_name(std::string(client.platform_name()));
+  artifact.set_device_kind(std::string(DeviceKind(client)));
+  artifact.set_compiler_version(ExecutableArtifactCompilerVersion());
+  artifact.set_num_replicas(executable.num_replicas());
+  artifact.set_num_partitions(executable.num_partitions());
+  artifact.set_parameter_is_tupled_arguments(parameter_is_tupled_arguments);
+  *artifact.mutable_optimized_module() = modules.front()->ToProto();
+
+  std::string serialized;
+  if (!artifact.SerializeToString(&serialized)) {
+    return InternalError("Failed to serialize executable %s",
+                         executable.name());
+  }
+  return serialized;
+}
+
+StatusOr<XlaComputation> DeserializeExecutableArtifact(
+    const PjRtClient& client, absl::string_view serialized,
+    CompileOptions* options) {
+  PjRtExecutableArtifact artifact;
+  if (!artifact.ParseFromArray(serialized.data(), serialized.size())) {
+    return InvalidArgument("Failed to parse serialized executable");
+  }
+  if (artifact.platform_name() != client.platform_name() ||
+      artifact.device_kind() != DeviceKind(client)) {
+    return InvalidArgument(
+        "Serialized executable was compiled for %s device %s, but the client "
+        "is for %s device %s",
+        artifact.platform_name(), artifact.device_kind(),
+        client.platform_name(), DeviceKind(client));
+  }
+  if (artifact.compiler_version() != ExecutableArtifactCompilerVersion()) {
+    return InvalidArgument(
+        "Serialized executable was compiled by compiler version %s, but the "
+        "client runs version %s",
+        artifact.compiler_version(), ExecutableArtifactCompilerVersion());
+  }
+
+  ExecutableBuildOptions& build_options = options->executable_build_options;
+  if (build_options.has_device_assignment() &&
+      (build_options.device_assignment().replica_count() !=
+           artifact.num_replicas() ||
+       build_options.device_assignment().computation_count() !=
+           artifact.num_partitions())) {
+    return InvalidArgument(
+        "Serialized executable has %d replicas and %d partitions, but the "
+        "device assignment has %d replicas and %d partitions",
+        artifact.num_replicas(), artifact.num_partitions(),
+        build_options.device_assignment().replica_count(),
+        build_options.device_assignment().computation_count());
+  }
+  build_options.set_num_replicas(artifact.num_replicas());
+  build_options.set_num_partitions(artifact.num_partitions());
+  build_options.set_run_backend_only(true);
+  options->parameter_is_tupled_arguments =
+      artifact.parameter_is_tupled_arguments();
+
+  // The layouts chosen during optimization are part of the module; the
+  // backend has to be given exactly those.
+  const ProgramShape program_shape(
+      artifact.optimized_module().host_program_shape());
+  options->argument_layouts.emplace(program_shape.parameters().begin(),
+                                    program_shape.parameters().end());
+  build_options.set_result_layout(program_shape.result());
+  return XlaComputation(std::move(*artifact.mutable_optimized_module()));
+}
+
+}  // namespace xla
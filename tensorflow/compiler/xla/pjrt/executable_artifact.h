@@ -0,0 +1,59 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_PJRT_EXECUTABLE_ARTIFACT_H_
+#define TENSORFLOW_COMPILER_XLA_PJRT_EXECUTABLE_ARTIFACT_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/client/xla_computation.h"
+#include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+
+// Helpers for clients that implement SerializeExecutable and
+// DeserializeExecutable with a PjRtExecutableArtifact.
+//
+// The artifact holds the optimized HLO module of the executable rather than
+// the generated code, so loading it skips the HLO optimization passes, which
+// dominate compilation time, but still runs the code generation of the
+// backend.
+
+// Returns the compiler version recorded in artifacts: the TensorFlow version
+// and git revision the binary was built from.
+std::string ExecutableArtifactCompilerVersion();
+
+// Serializes `executable`, which must have been compiled by `client` from a
+// single module with `parameter_is_tupled_arguments`, into a
+// PjRtExecutableArtifact.
+StatusOr<std::string> SerializeExecutableArtifact(
+    const PjRtClient& client, const PjRtExecutable& executable,
+    bool parameter_is_tupled_arguments);
+
+// Parses `serialized`, which must have been produced by
+// SerializeExecutableArtifact for the platform and device kind of `client`
+// with the same compiler version.  Returns the optimized module, and sets up
+// `options` so that compiling the module with them only runs the backend: the
+// argument and result layouts, the number of replicas and partitions and the
+// argument tupling are taken from the artifact.
+StatusOr<XlaComputation> DeserializeExecutableArtifact(
+    const PjRtClient& client, absl::string_view serialized,
+    CompileOptions* options);
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_PJRT_EXECUTABLE_ARTIFACT_H_
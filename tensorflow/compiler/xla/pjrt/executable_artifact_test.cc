@@ -0,0 +1,99 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/executable_artifact.h"
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/compiler/xla/client/xla_builder.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/pjrt/executable_artifact.pb.h"
+#include "tensorflow/compiler/xla/pjrt/tfrt_cpu_pjrt_client.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace xla {
+namespace {
+
+XlaComputation AddOne() {
+  XlaBuilder builder("add_one");
+  XlaOp x = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {4}), "x");
+  Add(x, ConstantR0<float>(&builder, 1.0f));
+  return builder.Build().ConsumeValueOrDie();
+}
+
+Literal Run(PjRtExecutable* executable, const Literal& argument) {
+  PjRtClient* client = executable->client();
+  std::unique_ptr<PjRtBuffer> buffer =
+      client->BufferFromHostLiteral(argument, client->addressable_devices()[0])
+          .ConsumeValueOrDie();
+  auto results = executable->Execute({{buffer.get()}}, ExecuteOptions())
+                     .ConsumeValueOrDie();
+  return std::move(*results[0][0]->ToLiteral().ConsumeValueOrDie());
+}
+
+TEST(ExecutableArtifactTest, DeserializedExecutableRuns) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PjRtClient> client,
+                          GetTfrtCpuClient(/*asynchronous=*/false));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PjRtExecutable> executable,
+                          client->Compile(AddOne(), CompileOptions()));
+  TF_ASSERT_OK_AND_ASSIGN(std::string serialized,
+                          client->SerializeExecutable(*executable));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtExecutable> deserialized,
+      client->DeserializeExecutable(serialized, /*hlo_module=*/nullptr,
+                                    CompileOptions()));
+  Literal argument = LiteralUtil::CreateR1<float>({1, 2, 3, 4});
+  LiteralTestUtil::ExpectR1Equal<float>({2, 3, 4, 5},
+                                        Run(deserialized.get(), argument));
+  EXPECT_TRUE(
+      LiteralTestUtil::Equal(Run(executable.get(), argument),
+                             Run(deserialized.get(), argument)));
+}
+
+TEST(ExecutableArtifactTest, RejectsOtherCompilerVersions) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PjRtClient> client,
+                          GetTfrtCpuClient(/*asynchronous=*/false));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PjRtExecutable> executable,
+                          client->Compile(AddOne(), CompileOptions()));
+  TF_ASSERT_OK_AND_ASSIGN(std::string serialized,
+                          client->SerializeExecutable(*executable));
+
+  PjRtExecutableArtifact artifact;
+  ASSERT_TRUE(artifact.ParseFromString(serialized));
+  artifact.set_compiler_version("0.0.0-unknown");
+  EXPECT_FALSE(client
+                   ->DeserializeExecutable(artifact.SerializeAsString(),
+                                           /*hlo_module=*/nullptr,
+                                           CompileOptions())
+                   .ok());
+}
+
+TEST(ExecutableArtifactTest, RejectsGarbage) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PjRtClient> client,
+                          GetTfrtCpuClient(/*asynchronous=*/false));
+  EXPECT_FALSE(client
+                   ->DeserializeExecutable("not an executable",
+                                           /*hlo_module=*/nullptr,
+                                           CompileOptions())
+                   .ok());
+}
+
+}  // namespace
+}  // namespace xla
@@ -20,6 +20,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/notification.h"
@@ -147,6 +148,13 @@ struct CompileOptions {
   // single-device executables. Beware: on GPUs, sometimes an executable
   // compiled for one device doesn't run on another.
   bool compile_portable_executable = false;
+
+  // Parameters whose buffers the executions give up, so that an output of the
+  // same shape can be written in place, e.g. the weights and optimizer state
+  // of a training step. Each one is aliased with the first output of the same
+  // shape not aliased yet, on top of the aliases set up in the computation.
+  // With parameter_is_tupled_arguments, these index the tupled arguments.
+  std::vector<int> donated_parameters;
 };
 
 class PjRtExecutable;
@@ -595,6 +603,15 @@ class PjRtBuffer {
   // immediate use on the device. Useful in particular for timing benchmarks.
   virtual Status BlockHostUntilReady() = 0;
 
+  // Calls `on_ready` once the buffer's value has been computed, or with the
+  // error that kept it from being computed. Unlike BlockHostUntilReady, the
+  // caller is not blocked, so that e.g. the host transfer for the next
+  // execution can be issued while this one runs. The default implementation
+  // does block and calls `on_ready` before returning.
+  virtual void OnReady(std::function<void(Status)> on_ready) {
+    on_ready(BlockHostUntilReady());
+  }
+
   // Whether this buffer is on CPU and thus allows for certain optimizations.
   virtual bool IsOnCpu() const = 0;
 };
@@ -624,12 +641,21 @@ struct ExecuteOptions {
   // If true, check that the PjRtBuffer argument shapes match the compiled
   // shapes. Otherwise, any shape with the right size on device may be passed.
   bool strict_shape_checking = true;
+  // Arguments that are not donated to this execution even though the
+  // executable aliases them with an output; the output is written to a new
+  // buffer instead, and the argument stays valid. Parameters that must alias
+  // their output can't be listed.
+  absl::flat_hash_set<int> non_donatable_input_indices;
 };
 
 // Represents a compiled computation that can be executed given handles to
 // device-allocated literals. If any input/output alias has been specified in
-// the computation, the parameter containing the input buffer will be donated
-// when passed to the execution.
+// the computation, or the parameter was listed in
+// CompileOptions::donated_parameters, the parameter containing the input buffer
+// will be donated when passed to the execution, unless it is listed in
+// ExecuteOptions::non_donatable_input_indices. A donated buffer is deleted, and
+// the output it aliases reuses its memory, so feeding the outputs of one
+// execution to the next updates them in place.
 class PjRtExecutable {
  public:
   virtual ~PjRtExecutable() = default;
@@ -75,6 +75,7 @@ limitations under the License.
 #include "absl/container/inlined_vector.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
@@ -88,6 +89,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/literal_util.h"
 #include "tensorflow/compiler/xla/pjrt/distributed/protocol.pb.h"
 #include "tensorflow/compiler/xla/pjrt/event_pool.h"
+#include "tensorflow/compiler/xla/pjrt/executable_artifact.h"
 #include "tensorflow/compiler/xla/pjrt/local_device_state.h"
 #include "tensorflow/compiler/xla/pjrt/metrics.h"
 #include "tensorflow/compiler/xla/pjrt/tracked_device_buffer.h"
@@ -1839,6 +1841,8 @@ StatusOr<ScopedShapedBuffer> PjRtStreamExecutorExecutable::EnqueueExecution(
     bool must_donate = donate_it != donated_params.end() && *donate_it == i;
     if (must_donate) {
       ++donate_it;
+      // The executable copies the argument to a fresh output buffer instead.
+      must_donate = !options.non_donatable_input_indices.contains(i);
     }
     device_buffers->emplace_back(handle->GetBufferWithHold(
         must_donate ? PjRtStreamExecutorBuffer::ScopedHold::kDonation
@@ -2341,9 +2345,26 @@ StatusOr<std::unique_ptr<PjRtExecutable>> PjRtStreamExecutorClient::Compile(
       addressable_device_logical_ids = extras.addressable_device_logical_ids;
   std::vector<PjRtDevice*>& addressable_devices = extras.addressable_devices;
 
+  absl::optional<XlaComputation> donating_computation;
+  if (!options.donated_parameters.empty()) {
+    donating_computation.emplace(computation.proto());
+    TF_ASSIGN_OR_RETURN(
+        std::vector<int> unaliased,
+        AliasDonatedParameters(options.donated_parameters,
+                               options.parameter_is_tupled_arguments,
+                               &*donating_computation));
+    if (!unaliased.empty()) {
+      LOG(WARNING) << "No output of " << computation.proto().name()
+                   << " can reuse the buffers of donated parameters "
+                   << absl::StrJoin(unaliased, ", ");
+    }
+  }
+  const XlaComputation& to_compile =
+      donating_computation ? *donating_computation : computation;
+
   std::vector<const Shape*> argument_layout_pointers;
   TF_RETURN_IF_ERROR(DetermineArgumentLayoutsFromCompileOptions(
-      computation,
+      to_compile,
       [local_client = client()](Shape shape) {
         return local_client->backend()
             .transfer_manager()
@@ -2354,7 +2375,7 @@ StatusOr<std::unique_ptr<PjRtExecutable>> PjRtStreamExecutorClient::Compile(
 
   TF_ASSIGN_OR_RETURN(
       std::vector<std::unique_ptr<LocalExecutable>> local_executables,
-      client()->Compile(computation, argument_layout_pointers,
+      client()->Compile(to_compile, argument_layout_pointers,
                         options.executable_build_options));
 
   auto executable = absl::make_unique<PjRtStreamExecutorExecutable>(
@@ -2366,4 +2387,24 @@ StatusOr<std::unique_ptr<PjRtExecutable>> PjRtStreamExecutorClient::Compile(
   return std::unique_ptr<PjRtExecutable>(std::move(executable));
 }
 
+StatusOr<std::string> PjRtStreamExecutorClient::SerializeExecutable(
+    const PjRtExecutable& executable) const {
+  return SerializeExecutableArtifact(
+      *this, executable,
+      tensorflow::down_cast<const PjRtStreamExecutorExecutable&>(executable)
+          .parameter_is_tupled_arguments());
+}
+
+StatusOr<std::unique_ptr<PjRtExecutable>>
+PjRtStreamExecutorClient::DeserializeExecutable(
+    absl::string_view serialized, std::unique_ptr<HloModule> hlo_module,
+    CompileOptions options) {
+  tensorflow::profiler::TraceMe traceme(
+      "PjRtStreamExecutorClient::DeserializeExecutable");
+  TF_ASSIGN_OR_RETURN(
+      XlaComputation computation,
+      DeserializeExecutableArtifact(*this, serialized, &options));
+  return Compile(computation, std::move(options));
+}
+
 }  // namespace xla
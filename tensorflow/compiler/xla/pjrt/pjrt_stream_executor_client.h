@@ -176,18 +176,15 @@ class PjRtStreamExecutorClient : public PjRtClient {
     return absl::optional<std::string>();
   }
 
+  // The serialized executable holds the optimized HLO module, and is tied to
+  // the platform, the device kind and the compiler version. Deserializing it
+  // only runs the code generation of the backend; `hlo_module` is unused.
   StatusOr<std::string> SerializeExecutable(
-      const PjRtExecutable& executable) const override {
-    return Unimplemented("SerializeExecutable not implemented on %s",
-                         platform_name());
-  }
+      const PjRtExecutable& executable) const override;
 
   StatusOr<std::unique_ptr<PjRtExecutable>> DeserializeExecutable(
       absl::string_view serialized, std::unique_ptr<HloModule> hlo_module,
-      CompileOptions options) override {
-    return Unimplemented("DeserializeExecutable not implemented on %s",
-                         platform_name());
-  }
+      CompileOptions options) override;
 
   StatusOr<std::unique_ptr<HloCostAnalysis>> GetHloCostAnalysis() override;
 
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/optional.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/client/xla_computation.h"
 #include "tensorflow/compiler/xla/layout.h"
 #include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/pjrt/executable_artifact.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
 #include "tensorflow/compiler/xla/pjrt/semaphore.h"
 #include "tensorflow/compiler/xla/pjrt/utils.h"
@@ -65,10 +67,10 @@ static tfrt::AsyncValueRef<CpuEvent> GetOrCreateReadyEvent(
   return ready_event->CopyRef();
 }
 
-TfrtCpuDevice::TfrtCpuDevice(int id, bool asynchronous)
+TfrtCpuDevice::TfrtCpuDevice(int id, int max_inflight_computations)
     : id_(id),
-      max_inflight_computations_semaphore_(/*capacity=*/asynchronous ? 32 : 1) {
-}
+      max_inflight_computations_semaphore_(
+          /*capacity=*/max_inflight_computations) {}
 
 absl::string_view TfrtCpuDevice::device_kind() const {
   return kCpuPlatformName;
@@ -94,17 +96,23 @@ static int CpuDeviceCount() {
 }
 
 static StatusOr<std::vector<std::unique_ptr<TfrtCpuDevice>>> GetTfrtCpuDevices(
-    bool asynchronous) {
+    int max_inflight_computations) {
   std::vector<std::unique_ptr<TfrtCpuDevice>> devices;
   for (int i = 0; i < CpuDeviceCount(); ++i) {
     auto device = std::make_unique<TfrtCpuDevice>(
-        /*id=*/i, asynchronous);
+        /*id=*/i, max_inflight_computations);
     devices.push_back(std::move(device));
   }
   return std::move(devices);
 }
 
-StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous) {
+StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(
+    bool asynchronous, int max_inflight_computations_per_device) {
+  if (max_inflight_computations_per_device < 1) {
+    return InvalidArgument(
+        "max_inflight_computations_per_device must be positive, got %d",
+        max_inflight_computations_per_device);
+  }
   // TODO(zhangqiaorjc): Allow users set the number of threads.
   // `num_blocking_threads=16` is picked arbitrarily for now.
   // Need at least CpuDeviceCount threads to launch one collective.
@@ -118,8 +126,10 @@ StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous) {
           /*num_threads=*/num_threads,
           /*num_blocking_threads=*/16));
 
+  int max_inflight_computations =
+      asynchronous ? max_inflight_computations_per_device : 1;
   TF_ASSIGN_OR_RETURN(std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
-                      GetTfrtCpuDevices(asynchronous));
+                      GetTfrtCpuDevices(max_inflight_computations));
 
   return std::unique_ptr<PjRtClient>(std::make_unique<TfrtCpuClient>(
       /*process_index=*/0, std::move(devices), std::move(host_context)));
@@ -216,12 +226,14 @@ static StatusOr<std::unique_ptr<xla::Executable>> JitCompile(
       xla::HloModule::CreateFromProto(hlo_module_proto, *hlo_module_config));
   VLOG(3) << "Unoptimized HLO module: " << hlo_module->ToString();
 
-  // Run Hlo Passes
+  // Run Hlo Passes, unless the module was optimized already.
   cpu::CpuCompiler compiler;
   xla::Compiler::CompileOptions dummy;
-  TF_ASSIGN_OR_RETURN(hlo_module,
-                      compiler.RunHloPasses(std::move(hlo_module),
-                                            /*stream_exec=*/nullptr, dummy));
+  if (!build_options.run_backend_only()) {
+    TF_ASSIGN_OR_RETURN(hlo_module,
+                        compiler.RunHloPasses(std::move(hlo_module),
+                                              /*stream_exec=*/nullptr, dummy));
+  }
 
   // Run backend.
   return compiler.RunBackend(std::move(hlo_module), /*stream_exec=*/nullptr,
@@ -293,9 +305,26 @@ StatusOr<std::unique_ptr<PjRtExecutable>> TfrtCpuClient::Compile(
       },
       &num_replicas, &num_partitions, &device_assignment));
 
+  absl::optional<XlaComputation> donating_computation;
+  if (!options.donated_parameters.empty()) {
+    donating_computation.emplace(computation.proto());
+    TF_ASSIGN_OR_RETURN(
+        std::vector<int> unaliased,
+        AliasDonatedParameters(options.donated_parameters,
+                               options.parameter_is_tupled_arguments,
+                               &*donating_computation));
+    if (!unaliased.empty()) {
+      LOG(WARNING) << "No output of " << computation.proto().name()
+                   << " can reuse the buffers of donated parameters "
+                   << absl::StrJoin(unaliased, ", ");
+    }
+  }
+  const XlaComputation& to_compile =
+      donating_computation ? *donating_computation : computation;
+
   std::vector<const Shape*> argument_layout_pointers;
   TF_RETURN_IF_ERROR(DetermineArgumentLayoutsFromCompileOptions(
-      computation, &LayoutUtil::GetWithDefaultLayout, options.argument_layouts,
+      to_compile, &LayoutUtil::GetWithDefaultLayout, options.argument_layouts,
       &options.executable_build_options, &argument_layout_pointers));
 
   std::vector<PjRtExecutable::LogicalDeviceIds> addressable_device_logical_ids;
@@ -331,11 +360,11 @@ StatusOr<std::unique_ptr<PjRtExecutable>> TfrtCpuClient::Compile(
   }
 
   TF_ASSIGN_OR_RETURN(ProgramShape program_shape,
-                      computation.GetProgramShape());
+                      to_compile.GetProgramShape());
   ExecutionOptions execution_options =
       CreateExecutionOptions(build_options, &program_shape);
   TF_ASSIGN_OR_RETURN(std::unique_ptr<Executable> cpu_executable,
-                      JitCompile(computation, argument_layout_pointers,
+                      JitCompile(to_compile, argument_layout_pointers,
                                  build_options, execution_options));
   auto cpu_executable_ptr =
       tensorflow::down_cast<cpu::CpuExecutable*>(cpu_executable.get());
@@ -366,6 +395,24 @@ StatusOr<std::unique_ptr<PjRtExecutable>> TfrtCpuClient::Compile(
   return std::unique_ptr<PjRtExecutable>(std::move(executable));
 }
 
+StatusOr<std::string> TfrtCpuClient::SerializeExecutable(
+    const PjRtExecutable& executable) const {
+  return SerializeExecutableArtifact(
+      *this, executable,
+      tensorflow::down_cast<const TfrtCpuExecutable&>(executable)
+          .parameter_is_tupled_arguments());
+}
+
+StatusOr<std::unique_ptr<PjRtExecutable>> TfrtCpuClient::DeserializeExecutable(
+    absl::string_view serialized, std::unique_ptr<HloModule> hlo_module,
+    CompileOptions options) {
+  tensorflow::profiler::TraceMe traceme("TfrtCpuClient::DeserializeExecutable");
+  TF_ASSIGN_OR_RETURN(
+      XlaComputation computation,
+      DeserializeExecutableArtifact(*this, serialized, &options));
+  return Compile(computation, std::move(options));
+}
+
 StatusOr<std::unique_ptr<TfrtCpuBuffer>> AllocateDestinationBuffer(
     const Shape& on_device_shape,
     absl::InlinedVector<tfrt::AsyncValueRef<CpuEvent>, 4> definition_events,
@@ -1170,6 +1217,39 @@ Status TfrtCpuBuffer::BlockHostUntilReady() {
   return status;
 }
 
+void TfrtCpuBuffer::OnReady(std::function<void(Status)> on_ready) {
+  std::shared_ptr<TrackedTfrtCpuDeviceBuffer> device_buffer;
+  {
+    absl::MutexLock lock(&mu_);
+    if (tracked_device_buffer_ == nullptr) {
+      on_ready(
+          InvalidArgument("OnReady() called on deleted or donated buffer"));
+      return;
+    }
+    device_buffer = tracked_device_buffer_;
+  }
+
+  std::vector<tfrt::RCReference<tfrt::AsyncValue>> definition_avs =
+      GetAsyncValues(device_buffer->DefinitionEvents());
+  std::vector<tfrt::RCReference<tfrt::AsyncValue>> definition_avs_copy =
+      CopyAsyncValues(definition_avs);
+  EnqueueWorkWhenReady(
+      client_->GetHostContext(), definition_avs,
+      [device_buffer = std::move(device_buffer),
+       definition_avs = std::move(definition_avs_copy),
+       on_ready = std::move(on_ready)]() {
+        Status status;
+        for (const auto& av : definition_avs) {
+          if (auto* error = av->GetErrorIfPresent()) {
+            status.Update(FailedPrecondition(
+                "Error in OnReady waiting for definition events: %s",
+                error->message));
+          }
+        }
+        on_ready(status);
+      });
+}
+
 TfrtCpuExecutable::TfrtCpuExecutable(
     int num_replicas, int num_partitions,
     std::shared_ptr<DeviceAssignment> device_assignment,
@@ -1394,6 +1474,13 @@ TfrtCpuExecutable::ExecuteHelper(
         donate_it != parameters_that_must_be_donated_.end() && *donate_it == i;
     if (must_donate) {
       ++donate_it;
+      // The outputs are written to the aliased argument buffers in place.
+      if (options.non_donatable_input_indices.contains(i)) {
+        return Unimplemented(
+            "Argument %d to replica %d is aliased with an output and must be "
+            "donated on CPU.",
+            i, replica);
+      }
     }
     device_buffers.emplace_back(tfrt_buffer->GetBufferWithHold(
         must_donate ? TfrtCpuBuffer::ScopedHold::kDonation
@@ -44,7 +44,9 @@ namespace xla {
 
 class TfrtCpuDevice final : public PjRtDevice {
  public:
-  TfrtCpuDevice(int id, bool asynchronous);
+  // At most `max_inflight_computations` executions can be enqueued on the
+  // device ahead of it, see max_inflight_computations_semaphore().
+  TfrtCpuDevice(int id, int max_inflight_computations);
 
   void SetClient(PjRtClient* client) {
     CHECK(client_ == nullptr);
@@ -135,18 +137,15 @@ class TfrtCpuClient final : public PjRtClient {
   StatusOr<absl::optional<std::string>> ExecutableFingerprint(
       const PjRtExecutable& executable) const override;
 
+  // The serialized executable holds the optimized HLO module, and is tied to
+  // the platform, the device kind and the compiler version. Deserializing it
+  // only runs the code generation of the backend; `hlo_module` is unused.
   StatusOr<std::string> SerializeExecutable(
-      const PjRtExecutable& executable) const override {
-    return Unimplemented("SerializeExecutable not implemented on %s",
-                         platform_name());
-  }
+      const PjRtExecutable& executable) const override;
 
   StatusOr<std::unique_ptr<PjRtExecutable>> DeserializeExecutable(
       absl::string_view serialized, std::unique_ptr<HloModule> hlo_module,
-      CompileOptions options) override {
-    return Unimplemented("DeserializeExecutable not implemented on %s",
-                         platform_name());
-  }
+      CompileOptions options) override;
 
   StatusOr<std::unique_ptr<PjRtBuffer>> CreateUninitializedBuffer(
       const Shape& shape, PjRtDevice* device) override;
@@ -451,6 +450,10 @@ class TfrtCpuBuffer final : public PjRtBuffer {
 
   Status BlockHostUntilReady() override;
 
+  // `on_ready` runs on the client's work queue, not on the thread that
+  // completed the computation.
+  void OnReady(std::function<void(Status)> on_ready) override;
+
   bool IsOnCpu() const override { return true; }
 
   // Returns a hold on the TrackedTfrtCpuDeviceBuffer holding the device
@@ -543,6 +546,10 @@ class TfrtCpuExecutable final : public PjRtExecutable {
 
   int num_partitions() const override { return num_partitions_; }
 
+  bool parameter_is_tupled_arguments() const {
+    return parameter_is_tupled_arguments_;
+  }
+
   int64 SizeOfGeneratedCodeInBytes() const override {
     return cpu_executable_->SizeOfGeneratedCodeInBytes();
   }
@@ -644,7 +651,12 @@ class TfrtCpuExecutable final : public PjRtExecutable {
   bool cheap_computation_;
 };
 
-StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous);
+// With `asynchronous`, Execute returns as soon as the computation is enqueued,
+// and blocks once `max_inflight_computations_per_device` executions are
+// pending on the device, so that a host loop can run ahead of the computations
+// by a bounded amount. Otherwise every execution waits for the previous one.
+StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(
+    bool asynchronous, int max_inflight_computations_per_device = 32);
 
 }  // namespace xla
 
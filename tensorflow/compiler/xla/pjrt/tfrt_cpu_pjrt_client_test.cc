@@ -0,0 +1,82 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/tfrt_cpu_pjrt_client.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+#include "tensorflow/compiler/xla/client/xla_builder.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace xla {
+namespace {
+
+XlaComputation AddOne() {
+  XlaBuilder builder("add_one");
+  XlaOp x = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {4}), "x");
+  Add(x, ConstantR0<float>(&builder, 1.0f));
+  return builder.Build().ConsumeValueOrDie();
+}
+
+TEST(TfrtCpuClientTest, OnReadyAfterPipelinedExecutions) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtClient> client,
+      GetTfrtCpuClient(/*asynchronous=*/true,
+                       /*max_inflight_computations_per_device=*/1));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PjRtExecutable> executable,
+                          client->Compile(AddOne(), CompileOptions()));
+  Literal input = LiteralUtil::CreateR1<float>({1, 2, 3, 4});
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<PjRtBuffer> buffer,
+      client->BufferFromHostLiteral(input, client->addressable_devices()[0]));
+
+  // Each execution consumes the output of the previous one.
+  constexpr int kNumExecutions = 4;
+  std::vector<std::unique_ptr<PjRtBuffer>> outputs;
+  PjRtBuffer* argument = buffer.get();
+  for (int i = 0; i < kNumExecutions; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto results, executable->Execute({{argument}}, ExecuteOptions()));
+    outputs.push_back(std::move(results[0][0]));
+    argument = outputs.back().get();
+  }
+
+  absl::Notification ready;
+  Status status;
+  outputs.back()->OnReady([&](Status s) {
+    status = s;
+    ready.Notify();
+  });
+  ready.WaitForNotification();
+  TF_ASSERT_OK(status);
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> literal,
+                          outputs.back()->ToLiteral());
+  LiteralTestUtil::ExpectR1Equal<float>({5, 6, 7, 8}, *literal);
+}
+
+TEST(TfrtCpuClientTest, RejectsEmptyExecutionQueue) {
+  EXPECT_FALSE(GetTfrtCpuClient(/*asynchronous=*/true,
+                                /*max_inflight_computations_per_device=*/0)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace xla
@@ -55,6 +55,11 @@ limitations under the License.
 // coalescing adjacent dimensions that do not change their order and removing
 // trivial dimensions.
 //
+// To run a plan in parallel, plan creation splits the outermost loop of the
+// loop nest into contiguous ranges, one for each piece of work. The ranges
+// start at multiples of the loop increment, so every piece but the last
+// applies only complete macrokernels along that loop.
+//
 // TODO(phawkins):
 // * we don't incorporate a number of optimizations from HPTT, notably explicit
 //   prefetching, and manual loop unrolling.
@@ -63,11 +68,9 @@ limitations under the License.
 //   case.
 // * we don't yet search for a good loop ordering. This probably matters less
 //   for arrays that fit entirely in cache.
-// * we don't yet parallelize.
 // * we could do a better job of vectorizing where the stride-1 dimensions are
 //   small (e.g., inner dimensions of size [..., 3] are not uncommon in some
 //   use cases.)
-// * consider adding a TransposePlanCache.
 
 #include "tensorflow/compiler/xla/pjrt/transpose.h"
 
@@ -79,6 +82,7 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "tensorflow/compiler/xla/permutation_util.h"
@@ -543,7 +547,8 @@ void TransposePlan::BuildPlanNodes(
 StatusOr<std::unique_ptr<TransposePlan>> TransposePlan::Create(
     size_t elem_size_in_bytes, absl::Span<int64_t const> dims,
     absl::Span<int64_t const> permutation,
-    absl::variant<Tiling, Striding> input_layout, Tiling output_tiling) {
+    absl::variant<Tiling, Striding> input_layout, Tiling output_tiling,
+    int num_threads) {
   auto is_negative = [](int d) { return d < 0; };
   if (absl::c_find_if(dims, is_negative) != dims.end()) {
     return InvalidArgument("dims must be non-negative, got %s",
@@ -558,6 +563,10 @@ StatusOr<std::unique_ptr<TransposePlan>> TransposePlan::Create(
     return InvalidArgument("permutation argument is not valid, got: %s",
                            absl::StrJoin(permutation, ","));
   }
+  if (num_threads < 1) {
+    return InvalidArgument("num_threads argument must be >= 1, got: %d",
+                           num_threads);
+  }
 
   int ndim = dims.size();
 
@@ -652,6 +661,7 @@ StatusOr<std::unique_ptr<TransposePlan>> TransposePlan::Create(
   }
 
   plan->Initialize();
+  plan->ChooseParallelization(num_threads);
   VLOG(5) << plan->ToString();
   return plan;
 }
@@ -704,7 +714,12 @@ void TransposePlan::Initialize() {
   } else {
     switch (elem_size_in_bytes_) {
       case 1:
+#ifdef EIGEN_VECTORIZE_NEON
+        // The widest NEON byte kernel transposes 8x8 blocks.
+        inner_block_elems_ = 8;
+#else
         inner_block_elems_ = 16;
+#endif
         break;
       case 2:
         inner_block_elems_ = 8;
@@ -748,40 +763,80 @@ void TransposePlan::Initialize() {
   BuildPlanNodes(inverse_permutation, 0, root_nodes_);
 }
 
+// Smallest number of bytes of input worth handing to a separate thread.
+static constexpr int64_t kMinBytesPerThread = 64 * 1024;
+
+void TransposePlan::ChooseParallelization(int num_threads) {
+  // A piece of work is at least one iteration of an outermost loop.
+  int64_t max_iterations = 1;
+  for (Node const* node : root_nodes_) {
+    max_iterations = std::max(max_iterations,
+                              CeilOfRatio(node->end - node->start, node->inc));
+  }
+  const int64_t n = std::max<int64_t>(
+      1, std::min<int64_t>(
+             {static_cast<int64_t>(num_threads), max_iterations,
+              elem_size_in_bytes_ * num_elems_ / kMinBytesPerThread}));
+  root_nodes_per_thread_.clear();
+  if (n == 1) {
+    root_nodes_per_thread_.push_back(root_nodes_);
+    return;
+  }
+  root_nodes_per_thread_.resize(n);
+  for (Node const* node : root_nodes_) {
+    const int64_t num_iterations =
+        CeilOfRatio(node->end - node->start, node->inc);
+    for (int64_t t = 0; t < n; ++t) {
+      const int64_t begin_iteration = num_iterations * t / n;
+      const int64_t end_iteration = num_iterations * (t + 1) / n;
+      if (begin_iteration == end_iteration) {
+        continue;
+      }
+      nodes_.push_back(std::make_unique<Node>(*node));
+      Node* piece = nodes_.back().get();
+      piece->start = node->start + begin_iteration * node->inc;
+      piece->end = t == n - 1 ? node->end
+                              : node->start + end_iteration * node->inc;
+      root_nodes_per_thread_[t].push_back(piece);
+    }
+  }
+}
+
 template <typename T>
-void TransposePlan::ExecuteTyped(const char* a, char* b) const {
+void TransposePlan::ExecuteTyped(const char* a, char* b,
+                                 absl::Span<Node* const> root_nodes) const {
   if (inner_kernel_is_memcpy_) {
-    for (Node const* node : root_nodes_) {
+    for (Node const* node : root_nodes) {
       TransposeConstStride1<T>(a, b, node);
     }
   } else {
     switch (inner_block_elems_) {
       case 1:
-        for (Node const* node : root_nodes_) {
+        for (Node const* node : root_nodes) {
           Transpose<T, 1>(a, outer_block_elems_a_, b, outer_block_elems_b_,
                           node);
         }
         break;
       case 2:
-        for (Node const* node : root_nodes_) {
+        for (Node const* node : root_nodes) {
           Transpose<T, 2>(a, outer_block_elems_a_, b, outer_block_elems_b_,
                           node);
         }
         break;
       case 4:
-        for (Node const* node : root_nodes_) {
+        for (Node const* node : root_nodes) {
           Transpose<T, 4>(a, outer_block_elems_a_, b, outer_block_elems_b_,
                           node);
         }
         break;
       case 8:
-        for (Node const* node : root_nodes_) {
+        for (Node const* node : root_nodes) {
           Transpose<T, 8>(a, outer_block_elems_a_, b, outer_block_elems_b_,
                           node);
         }
         break;
       case 16:
-        for (Node const* node : root_nodes_) {
+        for (Node const* node : root_nodes) {
           Transpose<T, 16>(a, outer_block_elems_a_, b, outer_block_elems_b_,
                            node);
         }
@@ -798,7 +853,10 @@ struct uint128 {
 };
 static_assert(sizeof(uint128) == 16, "uint128 should be 16 bytes in size");
 
-void TransposePlan::Execute(const void* a, void* b) const {
+void TransposePlan::Execute(
+    const void* a, void* b,
+    const std::function<void(std::function<void(void)>)>& schedule_work)
+    const {
   if (num_elems_ == 0) {
     return;
   }
@@ -806,25 +864,44 @@ void TransposePlan::Execute(const void* a, void* b) const {
   char* bc = static_cast<char*>(b);
   DCHECK((ac + elem_size_in_bytes_ * num_elems_ <= b ||
           bc + elem_size_in_bytes_ * num_elems_ <= a));
-  switch (elem_size_in_bytes_) {
-    case 1:
-      ExecuteTyped<uint8_t>(ac, bc);
-      break;
-    case 2:
-      ExecuteTyped<uint16_t>(ac, bc);
-      break;
-    case 4:
-      ExecuteTyped<uint32_t>(ac, bc);
-      break;
-    case 8:
-      ExecuteTyped<uint64_t>(ac, bc);
-      break;
-    case 16:
-      ExecuteTyped<uint128>(ac, bc);
-      break;
-    default:
-      LOG(FATAL) << "Unimplemented element size " << elem_size_in_bytes_;
+  auto execute_by_type = [&](absl::Span<Node* const> root_nodes) {
+    switch (elem_size_in_bytes_) {
+      case 1:
+        ExecuteTyped<uint8_t>(ac, bc, root_nodes);
+        break;
+      case 2:
+        ExecuteTyped<uint16_t>(ac, bc, root_nodes);
+        break;
+      case 4:
+        ExecuteTyped<uint32_t>(ac, bc, root_nodes);
+        break;
+      case 8:
+        ExecuteTyped<uint64_t>(ac, bc, root_nodes);
+        break;
+      case 16:
+        ExecuteTyped<uint128>(ac, bc, root_nodes);
+        break;
+      default:
+        LOG(FATAL) << "Unimplemented element size " << elem_size_in_bytes_;
+    }
+  };
+  if (!schedule_work || root_nodes_per_thread_.size() == 1) {
+    for (const auto& root_nodes : root_nodes_per_thread_) {
+      execute_by_type(root_nodes);
+    }
+    return;
+  }
+  absl::BlockingCounter counter(root_nodes_per_thread_.size() - 1);
+  for (size_t i = 1; i < root_nodes_per_thread_.size(); ++i) {
+    absl::Span<Node* const> root_nodes = root_nodes_per_thread_[i];
+    schedule_work([&, root_nodes]() {
+      execute_by_type(root_nodes);
+      counter.DecrementCount();
+    });
   }
+  // Runs the first piece on the calling thread.
+  execute_by_type(root_nodes_per_thread_[0]);
+  counter.Wait();
 }
 
 static void PrintPlan(TransposePlan::Node const* node, int indent,
@@ -847,7 +924,7 @@ std::string TransposePlan::ToString() const {
   return absl::StrFormat(
       "a_dims=%s b_dims=%s permutation=%s a_tiling=%s b_tiling=%s "
       "lda=%s lda_tile=%s ldb=%s ldb_tile=%s loop_order=%s "
-      "outer_bs=[%d,%d] inner_bs=%d\n"
+      "outer_bs=[%d,%d] inner_bs=%d parallelism=%d\n"
       "nodes:\n%s",
       absl::StrJoin(a_dims_, ","),
       absl::StrJoin(Permute(a_dims_, permutation_), ","),
@@ -855,7 +932,8 @@ std::string TransposePlan::ToString() const {
       absl::StrJoin(b_tiling_, ","), absl::StrJoin(lda_, ","),
       absl::StrJoin(lda_tile_, ","), absl::StrJoin(ldb_, ","),
       absl::StrJoin(ldb_tile_, ","), absl::StrJoin(loop_order_, ","),
-      outer_block_elems_a_, outer_block_elems_b_, inner_block_elems_, nodes);
+      outer_block_elems_a_, outer_block_elems_b_, inner_block_elems_,
+      Parallelism(), nodes);
 }
 
 struct TransposePlanCacheKey {
@@ -865,6 +943,7 @@ struct TransposePlanCacheKey {
   bool input_layout_is_tiling;
   absl::InlinedVector<int64_t, 4> input_layout;
   absl::InlinedVector<int64_t, 4> output_tiling;
+  int num_threads;
 
   bool operator==(const TransposePlanCacheKey& other) const;
 };
@@ -875,13 +954,14 @@ bool TransposePlanCacheKey::operator==(
          permutation == other.permutation &&
          input_layout_is_tiling == other.input_layout_is_tiling &&
          input_layout == other.input_layout &&
-         output_tiling == other.output_tiling;
+         output_tiling == other.output_tiling &&
+         num_threads == other.num_threads;
 }
 
 template <typename H>
 H AbslHashValue(H h, const TransposePlanCacheKey& key) {
   h = H::combine(std::move(h), key.elem_size_in_bytes,
-                 key.input_layout_is_tiling);
+                 key.input_layout_is_tiling, key.num_threads);
   h = H::combine_contiguous(std::move(h), key.dims.data(), key.dims.size());
   h = H::combine_contiguous(std::move(h), key.permutation.data(),
                             key.permutation.size());
@@ -897,11 +977,16 @@ TransposePlanCache::TransposePlanCache(int capacity)
 
 TransposePlanCache::~TransposePlanCache() = default;
 
+/*static*/ TransposePlanCache* TransposePlanCache::Global() {
+  static TransposePlanCache* cache = new TransposePlanCache(/*capacity=*/64);
+  return cache;
+}
+
 StatusOr<std::shared_ptr<TransposePlan>> TransposePlanCache::GetOrCreate(
     size_t elem_size_in_bytes, absl::Span<int64_t const> dims,
     absl::Span<int64_t const> permutation,
     absl::variant<TransposePlan::Tiling, TransposePlan::Striding> input_layout,
-    TransposePlan::Tiling output_tiling) {
+    TransposePlan::Tiling output_tiling, int num_threads) {
   TransposePlanCacheKey key;
   key.elem_size_in_bytes = elem_size_in_bytes;
   key.dims.resize(dims.size());
@@ -921,6 +1006,10 @@ StatusOr<std::shared_ptr<TransposePlan>> TransposePlanCache::GetOrCreate(
                                                        input_tiling.end());
     key.input_layout_is_tiling = true;
   }
+  key.output_tiling.resize(output_tiling.tiling.size());
+  absl::c_copy(output_tiling.tiling, key.output_tiling.begin());
+  key.num_threads = num_threads;
+  absl::MutexLock lock(&mu_);
   return cache_.GetOrCreateIfAbsent(
       key,
       [&](const TransposePlanCacheKey& key)
@@ -928,7 +1017,7 @@ StatusOr<std::shared_ptr<TransposePlan>> TransposePlanCache::GetOrCreate(
         TF_ASSIGN_OR_RETURN(
             std::unique_ptr<TransposePlan> plan,
             TransposePlan::Create(elem_size_in_bytes, dims, permutation,
-                                  input_layout, output_tiling));
+                                  input_layout, output_tiling, num_threads));
         return std::shared_ptr<TransposePlan>(std::move(plan));
       });
 }
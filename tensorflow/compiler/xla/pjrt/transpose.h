@@ -27,11 +27,14 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_PJRT_TRANSPOSE_H_
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/variant.h"
 #include "tensorflow/compiler/xla/pjrt/lru_cache.h"
 #include "tensorflow/compiler/xla/statusor.h"
@@ -66,6 +69,10 @@ class TransposePlan {
   // this code we expect at most 2 tiled dimensions on input and output.
   //
   // The input may have either a striding or a tiling but not both.
+  //
+  // num_threads: the maximum number of pieces the plan is split into so that
+  //   Execute() can run them in parallel. The plan may use fewer pieces if the
+  //   transpose is small.
   struct Tiling {
     absl::Span<int64_t const> tiling;
   };
@@ -76,7 +83,7 @@ class TransposePlan {
       size_t elem_size_in_bytes, absl::Span<int64_t const> dims,
       absl::Span<int64_t const> permutation,
       absl::variant<Tiling, Striding> input_layout = Tiling{},
-      Tiling output_tiling = Tiling{});
+      Tiling output_tiling = Tiling{}, int num_threads = 1);
 
   TransposePlan();
   ~TransposePlan();
@@ -86,13 +93,24 @@ class TransposePlan {
   // arrays must not overlap.
   // Currently there are no alignment requirements on either `a` or `b`. However
   // performance may be better if either or both are aligned.
-  void Execute(const void* a, void* b) const;
+  //
+  // If the plan has more than one piece of work (see Parallelism()) and
+  // `schedule_work` is provided, all pieces but one are passed to
+  // `schedule_work`, which must arrange for them to run, for example on a
+  // thread pool; the remaining piece runs on the calling thread. Execute()
+  // returns once all pieces have finished.
+  void Execute(const void* a, void* b,
+               const std::function<void(std::function<void(void)>)>&
+                   schedule_work = {}) const;
 
   // Returns a human-readable description of the plan.
   std::string ToString() const;
 
   size_t ElemSizeInBytes() const { return elem_size_in_bytes_; }
 
+  // Number of pieces of work the plan is split into.
+  int Parallelism() const { return root_nodes_per_thread_.size(); }
+
   // Input and output size, in number of elements. Ignores any input striding,
   // but accounts for tiling.
   int64_t InputNumElems() const;
@@ -133,11 +151,16 @@ class TransposePlan {
   void BuildPlanNodes(absl::Span<int64_t const> inverse_permutation, int i,
                       absl::InlinedVector<Node*, 1>& output_nodes);
 
+  // Splits the outermost loops of the plan into at most `num_threads` pieces
+  // of work and populates root_nodes_per_thread_.
+  void ChooseParallelization(int num_threads);
+
   // The signature of ExecuteTyped uses char* pointers because we perform
   // address calculations with strides in bytes; the strides need not be
   // multiples of the element size.
   template <typename T>
-  void ExecuteTyped(const char* a, char* b) const;
+  void ExecuteTyped(const char* a, char* b,
+                    absl::Span<Node* const> root_nodes) const;
 
   // Size of each element in bytes.
   int64_t elem_size_in_bytes_;
@@ -187,6 +210,10 @@ class TransposePlan {
   // nest. A plan may have multiple root nodes.
   absl::InlinedVector<Node*, 1> root_nodes_;
 
+  // Root nodes of each piece of work. Each piece covers a disjoint range of
+  // the outermost loops of root_nodes_.
+  std::vector<absl::InlinedVector<Node*, 1>> root_nodes_per_thread_;
+
   // Are the innermost (stride-1) dimensions the same dimension? This determines
   // whether the inner kernel is a transpose or a memcpy.
   bool inner_kernel_is_memcpy_;
@@ -200,7 +227,7 @@ class TransposePlan {
   int outer_block_elems_b_ = 4;
 };
 
-// An LRU cache for transpose plans. Not thread-safe.
+// An LRU cache for transpose plans. Thread-safe.
 struct TransposePlanCacheKey;
 
 template <typename H>
@@ -211,6 +238,11 @@ class TransposePlanCache {
   explicit TransposePlanCache(int capacity);
   ~TransposePlanCache();
 
+  // Returns a cache shared by the whole process, so that callers that see the
+  // same transposes repeatedly, such as host-to-device transfers, create each
+  // plan once.
+  static TransposePlanCache* Global();
+
   TransposePlanCache(const TransposePlanCache&) = delete;
   TransposePlanCache(TransposePlanCache&&) = delete;
   TransposePlanCache& operator=(const TransposePlanCache&) = delete;
@@ -222,13 +254,16 @@ class TransposePlanCache {
       absl::Span<int64_t const> permutation,
       absl::variant<TransposePlan::Tiling, TransposePlan::Striding>
           input_layout = TransposePlan::Tiling{},
-      TransposePlan::Tiling output_tiling = TransposePlan::Tiling{});
+      TransposePlan::Tiling output_tiling = TransposePlan::Tiling{},
+      int num_threads = 1);
 
  private:
+  absl::Mutex mu_;
   LRUCache<TransposePlanCacheKey,
-           StatusOr<std::shared_ptr<TransposePlan>>>::LRUList lru_list_;
+           StatusOr<std::shared_ptr<TransposePlan>>>::LRUList lru_list_
+      ABSL_GUARDED_BY(mu_);
   LRUCache<TransposePlanCacheKey, StatusOr<std::shared_ptr<TransposePlan>>>
-      cache_;
+      cache_ ABSL_GUARDED_BY(mu_);
 };
 
 }  // namespace xla
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_PJRT_TRANSPOSE_KERNELS_H_
 #define TENSORFLOW_COMPILER_XLA_PJRT_TRANSPOSE_KERNELS_H_
 
+#include <array>
 #include <cstdint>
 
 #include "third_party/eigen3/Eigen/Core"
@@ -69,7 +70,50 @@ struct TransposeMicroKernel<uint8_t, /*bs=*/4> {
   }
 };
 
-// TODO(phawkins): add an 8x8 byte transpose kernel.
+template <>
+struct TransposeMicroKernel<uint8_t, /*bs=*/8> {
+  static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
+                    int64_t ldb) {
+    std::array<__m128i, 8> packet;
+    for (int i = 0; i < 8; ++i) {
+      packet[i] =
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + lda * i));
+    }
+    // 00 10 01 11 02 12 03 13 04 14 05 15 06 16 07 17
+    __m128i t0 = _mm_unpacklo_epi8(packet[0], packet[1]);
+    // 20 30 21 31 22 32 23 33 24 34 25 35 26 36 27 37
+    __m128i t1 = _mm_unpacklo_epi8(packet[2], packet[3]);
+    __m128i t2 = _mm_unpacklo_epi8(packet[4], packet[5]);
+    __m128i t3 = _mm_unpacklo_epi8(packet[6], packet[7]);
+
+    // 00 10 20 30 01 11 21 31 02 12 22 32 03 13 23 33
+    __m128i s0 = _mm_unpacklo_epi16(t0, t1);
+    // 04 14 24 34 05 15 25 35 06 16 26 36 07 17 27 37
+    __m128i s1 = _mm_unpackhi_epi16(t0, t1);
+    __m128i s2 = _mm_unpacklo_epi16(t2, t3);  // 40 50 60 70 41 51 61 71 ...
+    __m128i s3 = _mm_unpackhi_epi16(t2, t3);  // 44 54 64 74 45 55 65 75 ...
+
+    // 00 10 20 30 40 50 60 70 01 11 21 31 41 51 61 71
+    __m128i u0 = _mm_unpacklo_epi32(s0, s2);
+    // 02 12 22 32 42 52 62 72 03 13 23 33 43 53 63 73
+    __m128i u1 = _mm_unpackhi_epi32(s0, s2);
+    __m128i u2 = _mm_unpacklo_epi32(s1, s3);
+    __m128i u3 = _mm_unpackhi_epi32(s1, s3);
+
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 0), u0);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 1),
+                     _mm_srli_si128(u0, 8));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 2), u1);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 3),
+                     _mm_srli_si128(u1, 8));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 4), u2);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 5),
+                     _mm_srli_si128(u2, 8));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 6), u3);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 7),
+                     _mm_srli_si128(u3, 8));
+  }
+};
 
 // TODO(phawkins): Eigen doesn't have a SSE/AVX byte Packet16c type. Add one
 // and call it here rather than using AVX intrinsics.
@@ -183,7 +227,31 @@ struct TransposeMicroKernel<uint8_t, /*bs=*/16> {
   }
 };
 
-// TODO(phawkins): add an 4x4 uint16 transpose kernel.
+template <>
+struct TransposeMicroKernel<uint16_t, /*bs=*/4> {
+  static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
+                    int64_t ldb) {
+    std::array<__m128i, 4> packet;
+    for (int i = 0; i < 4; ++i) {
+      packet[i] =
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + lda * i));
+    }
+    // 00 10 01 11 02 12 03 13
+    __m128i t0 = _mm_unpacklo_epi16(packet[0], packet[1]);
+    // 20 30 21 31 22 32 23 33
+    __m128i t1 = _mm_unpacklo_epi16(packet[2], packet[3]);
+    // 00 10 20 30 01 11 21 31
+    __m128i u0 = _mm_unpacklo_epi32(t0, t1);
+    // 02 12 22 32 03 13 23 33
+    __m128i u1 = _mm_unpackhi_epi32(t0, t1);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 0), u0);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 1),
+                     _mm_srli_si128(u0, 8));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 2), u1);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(b + ldb * 3),
+                     _mm_srli_si128(u1, 8));
+  }
+};
 
 template <>
 struct TransposeMicroKernel<uint16_t, /*bs=*/8> {
@@ -287,6 +355,135 @@ struct TransposeMicroKernel<uint64_t, /*bs=*/4> {
 
 #endif  // EIGEN_VECTORIZE_AVX
 
+#ifdef EIGEN_VECTORIZE_NEON
+
+// NEON has no byte or halfword transpose instructions wider than a pair of
+// registers, so the kernels below build the transpose out of vtrn steps on
+// successively wider lanes.
+
+template <>
+struct TransposeMicroKernel<uint8_t, /*bs=*/8> {
+  static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
+                    int64_t ldb) {
+    std::array<uint8x8_t, 8> packet;
+    for (int i = 0; i < 8; ++i) {
+      packet[i] = vld1_u8(reinterpret_cast<const uint8_t*>(a + lda * i));
+    }
+    // t0.val[0] = 00 10 02 12 04 14 06 16, t0.val[1] = 01 11 03 13 ...
+    uint8x8x2_t t0 = vtrn_u8(packet[0], packet[1]);
+    uint8x8x2_t t1 = vtrn_u8(packet[2], packet[3]);
+    uint8x8x2_t t2 = vtrn_u8(packet[4], packet[5]);
+    uint8x8x2_t t3 = vtrn_u8(packet[6], packet[7]);
+
+    // s0.val[0] = 00 10 20 30 04 14 24 34, s0.val[1] = 02 12 22 32 06 ...
+    uint16x4x2_t s0 = vtrn_u16(vreinterpret_u16_u8(t0.val[0]),
+                               vreinterpret_u16_u8(t1.val[0]));
+    // s1.val[0] = 01 11 21 31 05 15 25 35, s1.val[1] = 03 13 23 33 07 ...
+    uint16x4x2_t s1 = vtrn_u16(vreinterpret_u16_u8(t0.val[1]),
+                               vreinterpret_u16_u8(t1.val[1]));
+    uint16x4x2_t s2 = vtrn_u16(vreinterpret_u16_u8(t2.val[0]),
+                               vreinterpret_u16_u8(t3.val[0]));
+    uint16x4x2_t s3 = vtrn_u16(vreinterpret_u16_u8(t2.val[1]),
+                               vreinterpret_u16_u8(t3.val[1]));
+
+    // u0.val[0] = 00 10 20 30 40 50 60 70, u0.val[1] = 04 14 24 34 44 ...
+    uint32x2x2_t u0 = vtrn_u32(vreinterpret_u32_u16(s0.val[0]),
+                               vreinterpret_u32_u16(s2.val[0]));
+    uint32x2x2_t u1 = vtrn_u32(vreinterpret_u32_u16(s1.val[0]),
+                               vreinterpret_u32_u16(s3.val[0]));
+    uint32x2x2_t u2 = vtrn_u32(vreinterpret_u32_u16(s0.val[1]),
+                               vreinterpret_u32_u16(s2.val[1]));
+    uint32x2x2_t u3 = vtrn_u32(vreinterpret_u32_u16(s1.val[1]),
+                               vreinterpret_u32_u16(s3.val[1]));
+
+    auto store = [&](int i, uint32x2_t x) {
+      vst1_u8(reinterpret_cast<uint8_t*>(b + ldb * i), vreinterpret_u8_u32(x));
+    };
+    store(0, u0.val[0]);
+    store(1, u1.val[0]);
+    store(2, u2.val[0]);
+    store(3, u3.val[0]);
+    store(4, u0.val[1]);
+    store(5, u1.val[1]);
+    store(6, u2.val[1]);
+    store(7, u3.val[1]);
+  }
+};
+
+template <>
+struct TransposeMicroKernel<uint16_t, /*bs=*/4> {
+  static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
+                    int64_t ldb) {
+    std::array<uint16x4_t, 4> packet;
+    for (int i = 0; i < 4; ++i) {
+      packet[i] = vld1_u16(reinterpret_cast<const uint16_t*>(a + lda * i));
+    }
+    // t0.val[0] = 00 10 02 12, t0.val[1] = 01 11 03 13
+    uint16x4x2_t t0 = vtrn_u16(packet[0], packet[1]);
+    uint16x4x2_t t1 = vtrn_u16(packet[2], packet[3]);
+    // u0.val[0] = 00 10 20 30, u0.val[1] = 02 12 22 32
+    uint32x2x2_t u0 = vtrn_u32(vreinterpret_u32_u16(t0.val[0]),
+                               vreinterpret_u32_u16(t1.val[0]));
+    uint32x2x2_t u1 = vtrn_u32(vreinterpret_u32_u16(t0.val[1]),
+                               vreinterpret_u32_u16(t1.val[1]));
+    auto store = [&](int i, uint32x2_t x) {
+      vst1_u16(reinterpret_cast<uint16_t*>(b + ldb * i),
+               vreinterpret_u16_u32(x));
+    };
+    store(0, u0.val[0]);
+    store(1, u1.val[0]);
+    store(2, u0.val[1]);
+    store(3, u1.val[1]);
+  }
+};
+
+template <>
+struct TransposeMicroKernel<uint16_t, /*bs=*/8> {
+  static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
+                    int64_t ldb) {
+    std::array<uint16x8_t, 8> packet;
+    for (int i = 0; i < 8; ++i) {
+      packet[i] = vld1q_u16(reinterpret_cast<const uint16_t*>(a + lda * i));
+    }
+    // t0.val[0] = 00 10 02 12 04 14 06 16, t0.val[1] = 01 11 03 13 ...
+    uint16x8x2_t t0 = vtrnq_u16(packet[0], packet[1]);
+    uint16x8x2_t t1 = vtrnq_u16(packet[2], packet[3]);
+    uint16x8x2_t t2 = vtrnq_u16(packet[4], packet[5]);
+    uint16x8x2_t t3 = vtrnq_u16(packet[6], packet[7]);
+
+    // u0.val[0] = 00 10 20 30 04 14 24 34, u0.val[1] = 02 12 22 32 06 ...
+    uint32x4x2_t u0 = vtrnq_u32(vreinterpretq_u32_u16(t0.val[0]),
+                                vreinterpretq_u32_u16(t1.val[0]));
+    // u1.val[0] = 01 11 21 31 05 15 25 35, u1.val[1] = 03 13 23 33 07 ...
+    uint32x4x2_t u1 = vtrnq_u32(vreinterpretq_u32_u16(t0.val[1]),
+                                vreinterpretq_u32_u16(t1.val[1]));
+    uint32x4x2_t u2 = vtrnq_u32(vreinterpretq_u32_u16(t2.val[0]),
+                                vreinterpretq_u32_u16(t3.val[0]));
+    uint32x4x2_t u3 = vtrnq_u32(vreinterpretq_u32_u16(t2.val[1]),
+                                vreinterpretq_u32_u16(t3.val[1]));
+
+    // Row i of the output joins the halves of the rows 0-3 and 4-7 vectors
+    // that hold column i of the input.
+    auto store = [&](int i, uint32x4_t lo, uint32x4_t hi, bool high_half) {
+      uint16x4_t x = high_half ? vget_high_u16(vreinterpretq_u16_u32(lo))
+                               : vget_low_u16(vreinterpretq_u16_u32(lo));
+      uint16x4_t y = high_half ? vget_high_u16(vreinterpretq_u16_u32(hi))
+                               : vget_low_u16(vreinterpretq_u16_u32(hi));
+      vst1q_u16(reinterpret_cast<uint16_t*>(b + ldb * i), vcombine_u16(x, y));
+    };
+    store(0, u0.val[0], u2.val[0], /*high_half=*/false);
+    store(1, u1.val[0], u3.val[0], /*high_half=*/false);
+    store(2, u0.val[1], u2.val[1], /*high_half=*/false);
+    store(3, u1.val[1], u3.val[1], /*high_half=*/false);
+    store(4, u0.val[0], u2.val[0], /*high_half=*/true);
+    store(5, u1.val[0], u3.val[0], /*high_half=*/true);
+    store(6, u0.val[1], u2.val[1], /*high_half=*/true);
+    store(7, u1.val[1], u3.val[1], /*high_half=*/true);
+  }
+};
+
+#endif  // EIGEN_VECTORIZE_NEON
+
 }  // namespace xla
 
 #endif  // TENSORFLOW_COMPILER_XLA_PJRT_TRANSPOSE_KERNELS_H_
@@ -16,7 +16,9 @@ limitations under the License.
 #include "tensorflow/compiler/xla/pjrt/transpose.h"
 
 #include <algorithm>
+#include <functional>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
@@ -347,14 +349,14 @@ std::vector<TransposeTestCase> GetTransposeTestCases() {
 class TransposeTest : public ::testing::TestWithParam<TransposeTestCase> {
  protected:
   template <typename T>
-  void TestTranspose() {
+  void TestTranspose(int parallelism) {
     const TransposeTestCase test = GetParam();
     std::vector<int64> output_dims = Permute(test.dims, test.permutation);
     TF_ASSERT_OK_AND_ASSIGN(
-        auto plan,
-        TransposePlan::Create(sizeof(T), test.dims, test.permutation,
-                              TransposePlan::Tiling{test.input_tiling},
-                              TransposePlan::Tiling{test.output_tiling}));
+        auto plan, TransposePlan::Create(
+                       sizeof(T), test.dims, test.permutation,
+                       TransposePlan::Tiling{test.input_tiling},
+                       TransposePlan::Tiling{test.output_tiling}, parallelism));
     VLOG(1) << plan->ToString();
     xla::Array<T> untiled_input(test.dims);
     untiled_input.FillIota(0);
@@ -368,17 +370,28 @@ class TransposeTest : public ::testing::TestWithParam<TransposeTestCase> {
 
     std::vector<T> output(
         SizeOfTiledArray(plan->OutputDims(), test.output_tiling), -1);
-    plan->Execute(tiled_input.data(), output.data());
+    std::vector<std::thread> threads;
+    plan->Execute(tiled_input.data(), output.data(),
+                  [&](std::function<void()> fn) {
+                    threads.emplace_back(std::move(fn));
+                  });
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
 
     EXPECT_EQ(expected_tiled_output, output);
   }
 };
 
-TEST_P(TransposeTest, TransposeInt8) { TestTranspose<int8>(); }
-TEST_P(TransposeTest, TransposeInt16) { TestTranspose<int16>(); }
-TEST_P(TransposeTest, TransposeInt32) { TestTranspose<int32>(); }
-TEST_P(TransposeTest, TransposeInt64) { TestTranspose<int64>(); }
-TEST_P(TransposeTest, TransposeInt128) { TestTranspose<absl::int128>(); }
+TEST_P(TransposeTest, TransposeInt8) { TestTranspose<int8>(1); }
+TEST_P(TransposeTest, TransposeInt16) { TestTranspose<int16>(1); }
+TEST_P(TransposeTest, TransposeInt32) { TestTranspose<int32>(1); }
+TEST_P(TransposeTest, TransposeInt64) { TestTranspose<int64>(1); }
+TEST_P(TransposeTest, TransposeInt128) { TestTranspose<absl::int128>(1); }
+
+TEST_P(TransposeTest, ParallelTransposeInt8) { TestTranspose<int8>(4); }
+TEST_P(TransposeTest, ParallelTransposeInt16) { TestTranspose<int16>(4); }
+TEST_P(TransposeTest, ParallelTransposeInt32) { TestTranspose<int32>(4); }
 
 INSTANTIATE_TEST_SUITE_P(TransposeTestInstance, TransposeTest,
                          ::testing::ValuesIn(GetTransposeTestCases()));
@@ -435,12 +448,43 @@ void BM_Transpose(::testing::benchmark::State& state) {
 void BM_Transpose_uint8(::testing::benchmark::State& state) {
   BM_Transpose<uint8_t>(state);
 }
+void BM_Transpose_uint16(::testing::benchmark::State& state) {
+  BM_Transpose<uint16_t>(state);
+}
 void BM_Transpose_float(::testing::benchmark::State& state) {
   BM_Transpose<float>(state);
 }
 BENCHMARK(BM_Transpose_uint8)->Range(0, benchmark_cases->size() - 1);
+BENCHMARK(BM_Transpose_uint16)->Range(0, benchmark_cases->size() - 1);
 BENCHMARK(BM_Transpose_float)->Range(0, benchmark_cases->size() - 1);
 
+TEST(TransposeTest, SplitsLargePlans) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto plan, TransposePlan::Create(/*elem_size_in_bytes=*/2,
+                                       /*dims=*/{1024, 1024},
+                                       /*permutation=*/{1, 0},
+                                       TransposePlan::Tiling{},
+                                       TransposePlan::Tiling{},
+                                       /*num_threads=*/4));
+  EXPECT_EQ(plan->Parallelism(), 4);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      plan, TransposePlan::Create(/*elem_size_in_bytes=*/2, /*dims=*/{8, 8},
+                                  /*permutation=*/{1, 0},
+                                  TransposePlan::Tiling{},
+                                  TransposePlan::Tiling{},
+                                  /*num_threads=*/4));
+  EXPECT_EQ(plan->Parallelism(), 1);
+
+  EXPECT_FALSE(TransposePlan::Create(/*elem_size_in_bytes=*/2,
+                                     /*dims=*/{8, 8},
+                                     /*permutation=*/{1, 0},
+                                     TransposePlan::Tiling{},
+                                     TransposePlan::Tiling{},
+                                     /*num_threads=*/0)
+                   .ok());
+}
+
 TEST(TransposePlanCache, Basics) {
   TransposePlanCache cache(2);
   TF_ASSERT_OK_AND_ASSIGN(
@@ -464,4 +508,24 @@ TEST(TransposePlanCache, Basics) {
   EXPECT_TRUE(p1.get() != p1b.get());
 }
 
+TEST(TransposePlanCache, KeysIncludeOutputTilingAndThreads) {
+  TransposePlanCache cache(4);
+  const std::vector<int64_t> tiling = {2};
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto p1, cache.GetOrCreate(/*elem_size_in_bytes=*/4, /*dims=*/{4, 6},
+                                 /*permutation=*/{1, 0}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto p2, cache.GetOrCreate(/*elem_size_in_bytes=*/4, /*dims=*/{4, 6},
+                                 /*permutation=*/{1, 0},
+                                 TransposePlan::Tiling{},
+                                 TransposePlan::Tiling{tiling}));
+  EXPECT_TRUE(p1.get() != p2.get());
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto p3, cache.GetOrCreate(/*elem_size_in_bytes=*/4, /*dims=*/{4, 6},
+                                 /*permutation=*/{1, 0},
+                                 TransposePlan::Tiling{},
+                                 TransposePlan::Tiling{}, /*num_threads=*/2));
+  EXPECT_TRUE(p1.get() != p3.get());
+}
+
 }  // namespace xla
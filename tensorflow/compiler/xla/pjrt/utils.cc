@@ -15,13 +15,16 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/pjrt/utils.h"
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 #include "tensorflow/compiler/xla/client/executable_build_options.h"
 #include "tensorflow/compiler/xla/client/xla_computation.h"
 #include "tensorflow/compiler/xla/service/hlo.pb.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/hlo_sharding.h"
 #include "tensorflow/compiler/xla/shape.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
 
@@ -262,6 +265,87 @@ StatusOr<std::vector<int>> ComputeParametersThatMustBeDonated(
   return parameters_to_donate;
 }
 
+StatusOr<std::vector<int>> AliasDonatedParameters(
+    absl::Span<int const> donated_parameters, bool tuple_inputs,
+    XlaComputation* computation) {
+  TF_ASSIGN_OR_RETURN(ProgramShape program_shape,
+                      computation->GetProgramShape());
+  if (tuple_inputs && (program_shape.parameters_size() != 1 ||
+                       !program_shape.parameters(0).IsTuple())) {
+    return InvalidArgument(
+        "Tupled inputs require a single tuple parameter, got %s",
+        program_shape.ToString());
+  }
+  const int number_of_parameters =
+      tuple_inputs ? program_shape.parameters(0).tuple_shapes_size()
+                   : program_shape.parameters_size();
+
+  HloInputOutputAliasProto* alias_proto =
+      computation->mutable_proto()->mutable_input_output_alias();
+  absl::flat_hash_set<ShapeIndex> aliased_outputs;
+  absl::flat_hash_set<int> aliased_parameters;
+  for (const auto& entry : alias_proto->entries()) {
+    aliased_outputs.insert(ShapeIndex(entry.output_shape_index().begin(),
+                                      entry.output_shape_index().end()));
+    if (!tuple_inputs) {
+      aliased_parameters.insert(entry.parameter_number());
+    } else if (entry.parameter_shape_index_size() > 0) {
+      aliased_parameters.insert(entry.parameter_shape_index(0));
+    }
+  }
+
+  std::vector<std::pair<ShapeIndex, const Shape*>> outputs;
+  ShapeUtil::ForEachSubshape(
+      program_shape.result(),
+      [&](const Shape& subshape, const ShapeIndex& index) {
+        if (subshape.IsArray() && !aliased_outputs.contains(index)) {
+          outputs.emplace_back(index, &subshape);
+        }
+      });
+
+  std::vector<int> unaliased;
+  for (int parameter : donated_parameters) {
+    if (parameter < 0 || parameter >= number_of_parameters) {
+      return InvalidArgument(
+          "Donated parameter %d is out of range for a computation with %d "
+          "parameters",
+          parameter, number_of_parameters);
+    }
+    if (aliased_parameters.contains(parameter)) {
+      continue;
+    }
+    const Shape& parameter_shape =
+        tuple_inputs ? program_shape.parameters(0).tuple_shapes(parameter)
+                     : program_shape.parameters(parameter);
+    auto output = absl::c_find_if(
+        outputs, [&](const std::pair<ShapeIndex, const Shape*>& output) {
+          return parameter_shape.IsArray() &&
+                 ShapeUtil::Compatible(*output.second, parameter_shape);
+        });
+    if (output == outputs.end()) {
+      unaliased.push_back(parameter);
+      continue;
+    }
+    HloInputOutputAliasProto::AliasEntryProto* entry =
+        alias_proto->add_entries();
+    for (int64 i : output->first) {
+      entry->add_output_shape_index(i);
+    }
+    if (tuple_inputs) {
+      entry->set_parameter_number(0);
+      entry->add_parameter_shape_index(parameter);
+    } else {
+      entry->set_parameter_number(parameter);
+    }
+    entry->set_kind(Kind::MAY_ALIAS);
+    VLOG(2) << "Aliasing donated parameter " << parameter << " with output "
+            << output->first.ToString();
+    aliased_parameters.insert(parameter);
+    outputs.erase(output);
+  }
+  return unaliased;
+}
+
 int DefaultThreadPoolSize() {
   // Google's CI system exposes an environment variable NPROC that describes
   // a CPU reservation for tests.
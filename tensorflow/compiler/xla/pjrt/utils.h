@@ -52,6 +52,15 @@ Status DetermineArgumentLayoutsFromCompileOptions(
 StatusOr<std::vector<int>> ComputeParametersThatMustBeDonated(
     const HloModule& hlo_module, bool tuple_inputs);
 
+// Adds may-alias entries to the input/output alias config of `computation`, so
+// that each parameter in `donated_parameters` shares its buffer with the first
+// output of the same shape that is not aliased yet. With tupled arguments the
+// donated parameters are elements of the single parameter tuple. Returns the
+// donated parameters that no output could alias.
+StatusOr<std::vector<int>> AliasDonatedParameters(
+    absl::Span<int const> donated_parameters, bool tuple_inputs,
+    XlaComputation* computation);
+
 // Return max parallelism level.
 int DefaultThreadPoolSize();
 
@@ -0,0 +1,107 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/utils.h"
+
+#include "tensorflow/compiler/xla/client/xla_builder.h"
+#include "tensorflow/compiler/xla/service/hlo.pb.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test.h"
+
+namespace xla {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(AliasDonatedParametersTest, AliasesOutputsOfTheSameShape) {
+  XlaBuilder builder("step");
+  Shape vector = ShapeUtil::MakeShape(F32, {4});
+  XlaOp weights = Parameter(&builder, 0, vector, "weights");
+  XlaOp gradients = Parameter(&builder, 1, vector, "gradients");
+  XlaOp step = Parameter(&builder, 2, ShapeUtil::MakeShape(S32, {}), "step");
+  XlaOp momentum = Parameter(&builder, 3, vector, "momentum");
+  XlaOp new_momentum = Add(momentum, gradients);
+  Tuple(&builder, {Sub(weights, new_momentum), new_momentum,
+                   Add(step, ConstantR0<int32>(&builder, 1))});
+  TF_ASSERT_OK_AND_ASSIGN(XlaComputation computation, builder.Build());
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<int> unaliased,
+      AliasDonatedParameters({0, 2, 3}, /*tuple_inputs=*/false, &computation));
+  EXPECT_THAT(unaliased, IsEmpty());
+
+  const HloInputOutputAliasProto& aliases =
+      computation.proto().input_output_alias();
+  ASSERT_EQ(aliases.entries_size(), 3);
+  EXPECT_EQ(aliases.entries(0).parameter_number(), 0);
+  EXPECT_THAT(aliases.entries(0).output_shape_index(), ElementsAre(0));
+  EXPECT_EQ(aliases.entries(1).parameter_number(), 2);
+  EXPECT_THAT(aliases.entries(1).output_shape_index(), ElementsAre(2));
+  EXPECT_EQ(aliases.entries(2).parameter_number(), 3);
+  EXPECT_THAT(aliases.entries(2).output_shape_index(), ElementsAre(1));
+  for (const auto& entry : aliases.entries()) {
+    EXPECT_EQ(entry.kind(), Kind::MAY_ALIAS);
+    EXPECT_THAT(entry.parameter_shape_index(), IsEmpty());
+  }
+}
+
+TEST(AliasDonatedParametersTest, ReturnsParametersWithoutMatchingOutput) {
+  XlaBuilder builder("reduce");
+  XlaOp x = Parameter(&builder, 0, ShapeUtil::MakeShape(F32, {8}), "x");
+  XlaOp y = Parameter(&builder, 1, ShapeUtil::MakeShape(F32, {4}), "y");
+  Tuple(&builder, {Neg(y), Neg(y)});
+  TF_ASSERT_OK_AND_ASSIGN(XlaComputation computation, builder.Build());
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<int> unaliased,
+      AliasDonatedParameters({0, 1}, /*tuple_inputs=*/false, &computation));
+  EXPECT_THAT(unaliased, ElementsAre(0));
+  EXPECT_EQ(computation.proto().input_output_alias().entries_size(), 1);
+
+  // A parameter is aliased at most once.
+  TF_ASSERT_OK_AND_ASSIGN(
+      unaliased,
+      AliasDonatedParameters({1}, /*tuple_inputs=*/false, &computation));
+  EXPECT_THAT(unaliased, IsEmpty());
+  EXPECT_EQ(computation.proto().input_output_alias().entries_size(), 1);
+
+  EXPECT_FALSE(
+      AliasDonatedParameters({2}, /*tuple_inputs=*/false, &computation).ok());
+}
+
+TEST(AliasDonatedParametersTest, TupledInputs) {
+  XlaBuilder builder("tupled");
+  Shape vector = ShapeUtil::MakeShape(F32, {4});
+  XlaOp arguments = Parameter(
+      &builder, 0, ShapeUtil::MakeTupleShape({vector, vector}), "arguments");
+  Tuple(&builder, {Add(GetTupleElement(arguments, 0),
+                       GetTupleElement(arguments, 1))});
+  TF_ASSERT_OK_AND_ASSIGN(XlaComputation computation, builder.Build());
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<int> unaliased,
+      AliasDonatedParameters({1}, /*tuple_inputs=*/true, &computation));
+  EXPECT_THAT(unaliased, IsEmpty());
+  const HloInputOutputAliasProto& aliases =
+      computation.proto().input_output_alias();
+  ASSERT_EQ(aliases.entries_size(), 1);
+  EXPECT_EQ(aliases.entries(0).parameter_number(), 0);
+  EXPECT_THAT(aliases.entries(0).parameter_shape_index(), ElementsAre(1));
+  EXPECT_THAT(aliases.entries(0).output_shape_index(), ElementsAre(0));
+}
+
+}  // namespace
+}  // namespace xla
@@ -417,8 +417,7 @@ class CpuCallback {
                        std::vector<Result> results)
       : callable_(std::move(callable)),
         args_(std::move(args)),
-        results_(std::move(results)),
-        transpose_cache_(/*capacity=*/16) {}
+        results_(std::move(results)) {}
 
   void Call(void* result, void** arg_ptrs);
 
@@ -426,7 +425,6 @@ class CpuCallback {
   py::function callable_;
   std::vector<Arg> const args_;
   std::vector<Result> const results_;
-  TransposePlanCache transpose_cache_;
 };
 
 void CpuCallback::Call(void* result, void** arg_ptrs) {
@@ -485,7 +483,7 @@ void CpuCallback::Call(void* result, void** arg_ptrs) {
       std::memcpy(outputs[i], array.data(), results_[i].size_in_bytes);
     } else {
       StatusOr<std::shared_ptr<TransposePlan>> plan =
-          transpose_cache_.GetOrCreate(
+          TransposePlanCache::Global()->GetOrCreate(
               primitive_util::ByteWidth(results_[i].type), dims,
               results_[i].reversed_layout,
               /*input_layout=*/TransposePlan::Striding{strides});
@@ -768,6 +768,10 @@ string BufferAssignment::Stats::ToString() const {
         &s, "  preallocated temp fragmentation: %10s (%.2f%%)\n",
         HumanReadableNumBytes(preallocated_temp_fragmentation_bytes), percent);
   }
+  if (preallocated_temp_repacked_bytes > 0) {
+    StrAppendFormat(&s, "      preallocated temp repacking: %10s saved\n",
+                    HumanReadableNumBytes(preallocated_temp_repacked_bytes));
+  }
   StrAppendFormat(&s, "                 total allocation: %10s\n",
                   HumanReadableNumBytes(total_allocation_bytes));
   if (total_fragmentation_bytes >= 0) {
@@ -1427,17 +1431,22 @@ Status BufferAssigner::AssignBuffersWithSequentialOrdering(
 
   // Returns a heap algorithm that chooses the best result from several
   // algorithms.
+  const bool repack = assignment->module()
+                          .config()
+                          .debug_options()
+                          .xla_buffer_assignment_repacking();
   auto get_heap_algorithm = [&](int64 alignment) {
     auto algorithms = absl::make_unique<
         std::vector<std::unique_ptr<HeapAlgorithm<HloValue>>>>();
-    algorithms->push_back(
-        absl::make_unique<ConstrainedGlobalDecreasingSizeBestFitHeap>(
-            assignment->multiheap_size_constraint_per_heap(), alignment,
-            GlobalDecreasingSizeBestFitHeap<HloValue>::kSpatial));
-    algorithms->push_back(
-        absl::make_unique<ConstrainedGlobalDecreasingSizeBestFitHeap>(
-            assignment->multiheap_size_constraint_per_heap(), alignment,
-            GlobalDecreasingSizeBestFitHeap<HloValue>::kTemporal));
+    for (auto type : {GlobalDecreasingSizeBestFitHeap<HloValue>::kSpatial,
+                      GlobalDecreasingSizeBestFitHeap<HloValue>::kTemporal}) {
+      auto algorithm =
+          absl::make_unique<ConstrainedGlobalDecreasingSizeBestFitHeap>(
+              assignment->multiheap_size_constraint_per_heap(), alignment,
+              type);
+      algorithm->set_repack(repack);
+      algorithms->push_back(std::move(algorithm));
+    }
     return absl::make_unique<ChooseBestHeapAlgorithm<HloValue>>(
         std::move(algorithms));
   };
@@ -1612,6 +1621,7 @@ void BufferAssigner::AssignBuffersFromHeapSimulator(
     assignment->stats_.preallocated_temp_fragmentation_bytes +=
         result.fragmentation_size;
   }
+  assignment->stats_.preallocated_temp_repacked_bytes += result.repacked_size;
   VLOG(1) << "Result size from heap simulator: " << result.heap_size;
 
   // Iterate through heap_results. For each heap_result, create a new allocation
@@ -484,6 +484,9 @@ class BufferAssignment {
     int64 preallocated_temp_allocation_count = 0;
     int64 preallocated_temp_allocation_bytes = 0;
     int64 preallocated_temp_fragmentation_bytes = -1;
+    // The preallocated temp bytes saved by repacking the heaps, see
+    // DebugOptions::xla_buffer_assignment_repacking.
+    int64 preallocated_temp_repacked_bytes = 0;
     int64 total_allocation_count = 0;
     int64 total_allocation_bytes = 0;
     int64 total_fragmentation_bytes = -1;
@@ -74,11 +74,13 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/compiler_functor.h"
 #include "tensorflow/compiler/xla/service/cpu/conv_canonicalization.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_horizontal_loop_fusion.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_layout_assignment.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_options.h"
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/cpu/inter_op_task_assignment.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 #include "tensorflow/compiler/xla/service/cpu/simple_orc_jit.h"
@@ -305,8 +307,12 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
   pipeline.AddInvariantChecker<HloVerifier>(/*layout_sensitive=*/false,
                                             /*allow_mixed_precision=*/false);
 
-  pipeline.AddPass<OperandUpcaster>();
-  pipeline.AddPass<ResultCaster>();
+  OpExpanderPass::PatternExtraFilter upcaster_filter =
+      [](const HloInstruction* instr) {
+        return !IsS8MatrixMultiplication(*instr);
+      };
+  pipeline.AddPass<OperandUpcaster>(upcaster_filter);
+  pipeline.AddPass<ResultCaster>(upcaster_filter);
 
   // Expand random number generation.
   pipeline.AddPass<RngExpander>();
@@ -358,7 +364,16 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
   pipeline.AddPass<LogisticExpander>(
       /*expansion_type=*/LogisticExpansionType::kExp);
   pipeline.AddPass<ConditionalCanonicalizer>();
-  pipeline.AddPass<DynamicPadder>();
+  DynamicPadder::OpSupportsDynamismHandler op_supports_dynamism_handler;
+  if (module->config().debug_options().xla_cpu_enable_dynamic_dots()) {
+    op_supports_dynamism_handler = [](HloInstruction* hlo) {
+      return DotSupportsDynamicRows(*hlo) ? OpDynamismSupport::kRequired
+                                          : OpDynamismSupport::kNoSupport;
+    };
+  }
+  pipeline.AddPass<DynamicPadder>(/*slice_dynamic_output=*/true,
+                                  /*custom_call_handler=*/nullptr,
+                                  op_supports_dynamism_handler);
   pipeline.AddPass<ScatterExpander>(ScatterExpander::kEliminateAllScatters);
   pipeline.AddPass<ConvCanonicalization>(target_machine_features);
 
@@ -418,6 +433,7 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
       LayoutAssignment::InstructionCanChangeLayout, target_machine_features);
 
   pipeline.AddPass<CpuInstructionFusion>();
+  pipeline.AddPass<CpuHorizontalLoopFusion>();
 
   return pipeline.Run(module).status();
 }
@@ -463,6 +479,13 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
     // TODO(b/29630486) Support multi-threaded AOT.
     pipeline.AddPass<ParallelTaskAssigner>(
         max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
+    if (module->config()
+            .debug_options()
+            .xla_cpu_enable_inter_op_parallelism()) {
+      // Runs after ParallelTaskAssigner, whose fork/join calls are not grouped.
+      pipeline.AddPass<InterOpTaskAssigner>(
+          max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
+    }
   }
   // Copy insertion should be performed immediately before IR emission to
   // avoid inserting unnecessary copies (later pass adds an instruction which
@@ -0,0 +1,113 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_horizontal_loop_fusion.h"
+
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+
+namespace xla {
+namespace cpu {
+
+bool CpuHorizontalLoopFusion::IsCandidate(const HloInstruction* instr) const {
+  if (!instr->shape().IsArray() || instr->shape().is_dynamic() ||
+      ShapeUtil::ElementsIn(instr->shape()) > max_elements_per_output_) {
+    return false;
+  }
+  if (instr->opcode() == HloOpcode::kFusion) {
+    // The emitter writes dynamic-update-slice roots in place, outside of the
+    // loop emitter, and multi-output fusions are already tuple-shaped.
+    return instr->IsLoopFusion() &&
+           instr->fused_expression_root()->opcode() !=
+               HloOpcode::kDynamicUpdateSlice;
+  }
+  return instr->IsElementwise() && instr->operand_count() > 0 &&
+         !instr->HasSideEffect();
+}
+
+StatusOr<bool> CpuHorizontalLoopFusion::RunOnComputation(
+    HloComputation* computation) {
+  bool changed = false;
+  // The fused instructions are operands of the consumer, so they are visited
+  // before it and removing them does not affect the rest of the traversal.
+  for (HloInstruction* consumer : computation->MakeInstructionPostOrder()) {
+    // Collects the operands of `consumer` that have no other users, grouped by
+    // shape in order of first appearance.
+    std::vector<std::vector<HloInstruction*>> groups;
+    absl::flat_hash_set<const HloInstruction*> seen;
+    for (HloInstruction* operand : consumer->operands()) {
+      if (!seen.insert(operand).second || !IsCandidate(operand) ||
+          operand == computation->root_instruction() ||
+          absl::c_any_of(operand->users(), [&](const HloInstruction* user) {
+            return user != consumer;
+          })) {
+        continue;
+      }
+      auto group = absl::c_find_if(groups, [&](const auto& group) {
+        return ShapeUtil::EqualIgnoringElementType(group.front()->shape(),
+                                                   operand->shape()) &&
+               group.size() < max_outputs_per_fusion_;
+      });
+      if (group == groups.end()) {
+        groups.push_back({operand});
+      } else {
+        group->push_back(operand);
+      }
+    }
+
+    for (const std::vector<HloInstruction*>& group : groups) {
+      if (group.size() < 2) {
+        continue;
+      }
+      VLOG(2) << "Horizontally fusing " << group.size() << " operands of "
+              << consumer->name();
+      HloInstruction* fusion = group.front();
+      if (fusion->opcode() != HloOpcode::kFusion) {
+        fusion = computation->CreateFusionInstruction(
+            {fusion}, HloInstruction::FusionKind::kLoop);
+      }
+      for (int64 i = 1; i < group.size(); ++i) {
+        HloInstruction* instr = group[i];
+        if (instr->opcode() == HloOpcode::kFusion) {
+          fusion->MergeFusionInstructionIntoMultiOutput(instr);
+        } else {
+          fusion->FuseInstructionIntoMultiOutput(instr);
+          TF_RET_CHECK(instr->user_count() == 0);
+          TF_RETURN_IF_ERROR(computation->RemoveInstruction(instr));
+        }
+      }
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+StatusOr<bool> CpuHorizontalLoopFusion::Run(HloModule* module) {
+  bool changed = false;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    TF_ASSIGN_OR_RETURN(bool computation_changed,
+                        RunOnComputation(computation));
+    changed |= computation_changed;
+  }
+  return changed;
+}
+
+}  // namespace cpu
+}  // namespace xla
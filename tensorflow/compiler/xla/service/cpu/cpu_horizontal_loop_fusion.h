@@ -0,0 +1,68 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_HORIZONTAL_LOOP_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_HORIZONTAL_LOOP_FUSION_H_
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace cpu {
+
+// Horizontally fuses small independent loop fusions and elementwise ops into
+// multi-output loop fusions.
+//
+// Optimizer updates apply the same few elementwise formulas to every variable
+// of a model. After vertical fusion each of them is still its own loop, and
+// each loop walks its own small arrays. A multi-output loop fusion computes all
+// of its outputs in a single loop nest, which amortizes the loop overhead and
+// touches the operands shared between the outputs once per element.
+//
+// Like the GPU pass of the same name, candidates are only fused if all of
+// their users are the same instruction, typically the ROOT tuple; this keeps
+// the fused instructions independent without a reachability analysis. The CPU
+// loop emitter needs all the outputs of a multi-output loop to share one
+// iteration space, so only candidates of the same shape (ignoring the element
+// type) are fused together. Arrays with more than `max_elements_per_output`
+// elements are left alone so that they keep their own parallel loops.
+class CpuHorizontalLoopFusion : public HloModulePass {
+ public:
+  explicit CpuHorizontalLoopFusion(int64 max_elements_per_output = 32 * 1024,
+                                   int64 max_outputs_per_fusion = 32)
+      : max_elements_per_output_(max_elements_per_output),
+        max_outputs_per_fusion_(max_outputs_per_fusion) {}
+
+  absl::string_view name() const override {
+    return "cpu-horizontal-loop-fusion";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  StatusOr<bool> RunOnComputation(HloComputation* computation);
+
+  // Returns whether `instr` may be fused horizontally.
+  bool IsCandidate(const HloInstruction* instr) const;
+
+  const int64 max_elements_per_output_;
+  const int64 max_outputs_per_fusion_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_HORIZONTAL_LOOP_FUSION_H_
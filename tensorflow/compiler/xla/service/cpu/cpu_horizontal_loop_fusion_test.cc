@@ -0,0 +1,132 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_horizontal_loop_fusion.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class CpuHorizontalLoopFusionTest : public HloTestBase {};
+
+TEST_F(CpuHorizontalLoopFusionTest, FusesSameShapedUpdates) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+fused_computation.0 {
+  p0 = f32[128]{0} parameter(0)
+  p1 = f32[128]{0} parameter(1)
+  m = f32[128]{0} multiply(p0, p1)
+  ROOT s = f32[128]{0} subtract(p0, m)
+}
+
+ENTRY e {
+  var0 = f32[128]{0} parameter(0)
+  grad0 = f32[128]{0} parameter(1)
+  var1 = f32[128]{0} parameter(2)
+  grad1 = f32[128]{0} parameter(3)
+  fusion.0 = f32[128]{0} fusion(var0, grad0), kind=kLoop,
+      calls=fused_computation.0
+  sub = f32[128]{0} subtract(var1, grad1)
+  ROOT t = (f32[128]{0}, f32[128]{0}) tuple(fusion.0, sub)
+})"));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          CpuHorizontalLoopFusion().Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Tuple(op::GetTupleElement(op::Fusion()),
+                              op::GetTupleElement(op::Fusion())));
+  const HloInstruction* fusion = root->operand(0)->operand(0);
+  EXPECT_EQ(fusion, root->operand(1)->operand(0));
+  EXPECT_TRUE(fusion->IsLoopFusion());
+  EXPECT_THAT(fusion->fused_expression_root(),
+              op::Tuple(op::Subtract(), op::Subtract()));
+}
+
+TEST_F(CpuHorizontalLoopFusionTest, GroupsByShape) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[16,8]{1,0} parameter(0)
+  p1 = f32[16,8]{1,0} parameter(1)
+  p2 = f32[128]{0} parameter(2)
+  p3 = s32[16,8]{1,0} parameter(3)
+  n0 = f32[16,8]{1,0} negate(p0)
+  n1 = f32[128]{0} negate(p2)
+  a0 = f32[16,8]{1,0} add(p0, p1)
+  n2 = s32[16,8]{1,0} negate(p3)
+  ROOT t = (f32[16,8]{1,0}, f32[128]{0}, f32[16,8]{1,0}, s32[16,8]{1,0})
+      tuple(n0, n1, a0, n2)
+})"));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          CpuHorizontalLoopFusion().Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Tuple(op::GetTupleElement(op::Fusion()), op::Negate(),
+                              op::GetTupleElement(op::Fusion()),
+                              op::GetTupleElement(op::Fusion())));
+  const HloInstruction* fusion = root->operand(0)->operand(0);
+  EXPECT_EQ(fusion, root->operand(2)->operand(0));
+  EXPECT_EQ(fusion, root->operand(3)->operand(0));
+  EXPECT_EQ(ShapeUtil::TupleElementCount(fusion->shape()), 3);
+}
+
+TEST_F(CpuHorizontalLoopFusionTest, KeepsOpsWithOtherUsers) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[128]{0} parameter(0)
+  p1 = f32[128]{0} parameter(1)
+  n0 = f32[128]{0} negate(p0)
+  n1 = f32[128]{0} negate(p1)
+  e1 = f32[128]{0} exponential(n1)
+  ROOT t = (f32[128]{0}, f32[128]{0}, f32[128]{0}) tuple(n0, n1, e1)
+})"));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          CpuHorizontalLoopFusion().Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(CpuHorizontalLoopFusionTest, KeepsLargeArrays) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+HloModule m
+
+ENTRY e {
+  p0 = f32[1024]{0} parameter(0)
+  p1 = f32[1024]{0} parameter(1)
+  n0 = f32[1024]{0} negate(p0)
+  n1 = f32[1024]{0} negate(p1)
+  ROOT t = (f32[1024]{0}, f32[1024]{0}) tuple(n0, n1)
+})"));
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed,
+      CpuHorizontalLoopFusion(/*max_elements_per_output=*/512)
+          .Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
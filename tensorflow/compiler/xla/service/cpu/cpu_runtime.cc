@@ -75,6 +75,8 @@ extern const char* const kEigenMatMulC128SymbolName =
     "__xla_cpu_runtime_EigenMatMulC128";
 extern const char* const kEigenMatMulS32SymbolName =
     "__xla_cpu_runtime_EigenMatMulS32";
+extern const char* const kEigenMatMulS8S32SymbolName =
+    "__xla_cpu_runtime_EigenMatMulS8S32";
 extern const char* const kMKLConvF32SymbolName = "__xla_cpu_runtime_MKLConvF32";
 extern const char* const kMKLMatMulF32SymbolName =
     "__xla_cpu_runtime_MKLMatMulF32";
@@ -103,6 +105,8 @@ extern const char* const kEigenSingleThreadedMatMulC128SymbolName =
     "__xla_cpu_runtime_EigenSingleThreadedMatMulC128";
 extern const char* const kEigenSingleThreadedMatMulS32SymbolName =
     "__xla_cpu_runtime_EigenSingleThreadedMatMulS32";
+extern const char* const kEigenSingleThreadedMatMulS8S32SymbolName =
+    "__xla_cpu_runtime_EigenSingleThreadedMatMulS8S32";
 extern const char* const kEigenSingleThreadedConvF16SymbolName =
     "__xla_cpu_runtime_EigenSingleThreadedConvF16";
 extern const char* const kEigenSingleThreadedConvF32SymbolName =
@@ -117,6 +121,8 @@ extern const char* const kReleaseOutfeedBufferAfterPopulationSymbolName =
     "__xla_cpu_runtime_ReleaseOutfeedBufferAfterPopulation";
 extern const char* const kParallelForkJoinSymbolName =
     "__xla_cpu_runtime_ParallelForkJoin";
+extern const char* const kParallelCallsSymbolName =
+    "__xla_cpu_runtime_ParallelCalls";
 extern const char* const kPrintfToStderrSymbolName =
     "__xla_cpu_runtime_PrintfToStderr";
 extern const char* const kKeyValueSortSymbolName =
@@ -69,6 +69,9 @@ struct DotInfo {
   Shape result_shape;
   DotDimensionNumbers dim_nums;
 
+  // The runtime number of rows of the LHS, if only some of them are in use.
+  llvm::Value* dynamic_lhs_rows = nullptr;
+
   DotInfo() = default;
 
   explicit DotInfo(const HloInstruction& instr) {
@@ -785,9 +788,15 @@ Status DotOpEmitter::EmitCallToRuntime() {
       float_type = llvm_ir::PrimitiveTypeToIrType(C128, module);
       break;
     case S32:
-      fn_name = multi_threaded
-                    ? runtime::kEigenMatMulS32SymbolName
-                    : runtime::kEigenSingleThreadedMatMulS32SymbolName;
+      if (lhs_array_.GetShape().element_type() == S8) {
+        fn_name = multi_threaded
+                      ? runtime::kEigenMatMulS8S32SymbolName
+                      : runtime::kEigenSingleThreadedMatMulS8S32SymbolName;
+      } else {
+        fn_name = multi_threaded
+                      ? runtime::kEigenMatMulS32SymbolName
+                      : runtime::kEigenSingleThreadedMatMulS32SymbolName;
+      }
       float_type = b_->getInt32Ty();
       break;
     default:
@@ -796,12 +805,18 @@ Status DotOpEmitter::EmitCallToRuntime() {
   }
 
   llvm::Type* float_ptr_type = float_type->getPointerTo();
+  // The operands have the element type of the result, except for int8 matrix
+  // multiplications.
+  llvm::Type* operand_ptr_type =
+      llvm_ir::PrimitiveTypeToIrType(lhs_array_.GetShape().element_type(),
+                                     module)
+          ->getPointerTo();
   llvm::Type* int64_type = b_->getInt64Ty();
   llvm::Type* int32_type = b_->getInt32Ty();
   llvm::Type* int8_ptr_type = b_->getInt8Ty()->getPointerTo();
   llvm::FunctionType* matmul_type = llvm::FunctionType::get(
       b_->getVoidTy(),
-      {int8_ptr_type, float_ptr_type, float_ptr_type, float_ptr_type,
+      {int8_ptr_type, float_ptr_type, operand_ptr_type, operand_ptr_type,
        int64_type, int64_type, int64_type, int32_type, int32_type},
       /*isVarArg=*/false);
 
@@ -833,8 +848,17 @@ Status DotOpEmitter::EmitCallToRuntime() {
   bool transpose_lhs = !mat_mult_dims.lhs_canonical;
   bool transpose_rhs = !mat_mult_dims.rhs_canonical;
 
+  llvm::Value* m = b_->getInt64(mat_mult_dims.m);
+  llvm::Value* n = b_->getInt64(mat_mult_dims.n);
+  // The rows in use are a prefix of a row-major LHS and result. Otherwise the
+  // whole bound is multiplied, which leaves the same values in the rows in use.
+  if (dot_info_.dynamic_lhs_rows != nullptr &&
+      !mat_mult_dims.lhs_column_major && mat_mult_dims.lhs_canonical) {
+    m = dot_info_.dynamic_lhs_rows;
+  }
+
   if (!mat_mult_dims.lhs_column_major) {
-    std::swap(mat_mult_dims.m, mat_mult_dims.n);
+    std::swap(m, n);
     std::swap(lhs, rhs);
     std::swap(transpose_lhs, transpose_rhs);
   }
@@ -843,9 +867,8 @@ Status DotOpEmitter::EmitCallToRuntime() {
       matmul_func,
       {b_->CreateBitCast(executable_run_options_value_, int8_ptr_type),
        b_->CreateBitCast(target_array_.GetBasePointer(), float_ptr_type),
-       b_->CreateBitCast(lhs->GetBasePointer(), float_ptr_type),
-       b_->CreateBitCast(rhs->GetBasePointer(), float_ptr_type),
-       b_->getInt64(mat_mult_dims.m), b_->getInt64(mat_mult_dims.n),
+       b_->CreateBitCast(lhs->GetBasePointer(), operand_ptr_type),
+       b_->CreateBitCast(rhs->GetBasePointer(), operand_ptr_type), m, n,
        b_->getInt64(mat_mult_dims.k), b_->getInt32(transpose_lhs),
        b_->getInt32(transpose_rhs)});
   return Status::OK();
@@ -1018,6 +1041,12 @@ DotImplementationStrategy GetDotImplementationStrategy(
     const HloModuleConfig& config, const DotInfo& dot_info,
     const TargetMachineFeatures& target_machine_features) {
   PrimitiveType element_type = dot_info.result_shape.element_type();
+  // Only the Eigen runtime widens the operands of a mixed precision dot, see
+  // IsS8MatrixMultiplication.
+  if (dot_info.lhs_shape.element_type() != element_type) {
+    return DotImplementationStrategy::kEigen;
+  }
+
   // Any Matrix-Vector product of floating point or integral type, or
   // a transpose-dot fusion of the same can be lowered to a tiled LLVM
   // IR implementation.
@@ -1231,6 +1260,49 @@ bool DotOperandsAndResultMustHaveRowMajorLayout(
          impl_strategy == DotImplementationStrategy::kEigen;
 }
 
+bool PotentiallyImplementedAsEigenDot(
+    const HloInstruction& dot_instr,
+    const TargetMachineFeatures& target_machine_features) {
+  // Each of the dots of a batch dot may be lowered to an Eigen call.
+  if (IsBatchDot(dot_instr)) {
+    return true;
+  }
+  return GetDotImplementationStrategy(
+             dot_instr.parent()->parent()->config(), DotInfo(dot_instr),
+             target_machine_features) == DotImplementationStrategy::kEigen;
+}
+
+bool DotSupportsDynamicRows(const HloInstruction& instr) {
+  if (instr.opcode() != HloOpcode::kDot || IsBatchDot(instr)) {
+    return false;
+  }
+  const Shape& lhs_shape = instr.operand(0)->shape();
+  const Shape& rhs_shape = instr.operand(1)->shape();
+  const Shape& result_shape = instr.shape();
+  const DotDimensionNumbers& dim_nums = instr.dot_dimension_numbers();
+  // The rows of the LHS are the rows of the result.
+  return lhs_shape.rank() == 2 && rhs_shape.rank() == 2 &&
+         dim_nums.lhs_contracting_dimensions_size() == 1 &&
+         dim_nums.lhs_contracting_dimensions(0) == 1 &&
+         !lhs_shape.is_dynamic_dimension(1) && rhs_shape.is_static() &&
+         result_shape.is_dynamic_dimension(0) &&
+         !result_shape.is_dynamic_dimension(1);
+}
+
+bool IsS8MatrixMultiplication(const HloInstruction& instr) {
+  if (instr.opcode() != HloOpcode::kDot) {
+    return false;
+  }
+  const Shape& lhs_shape = instr.operand(0)->shape();
+  const Shape& rhs_shape = instr.operand(1)->shape();
+  const Shape& result_shape = instr.shape();
+  // Matrix-vector products are left to the tiled LLVM IR implementation.
+  return lhs_shape.element_type() == S8 && rhs_shape.element_type() == S8 &&
+         result_shape.element_type() == S32 && lhs_shape.rank() == 2 &&
+         rhs_shape.rank() == 2 && result_shape.rank() == 2 &&
+         result_shape.dimensions(0) > 1 && result_shape.dimensions(1) > 1;
+}
+
 Status EmitDotOperation(const HloInstruction& dot,
                         const llvm_ir::IrArray& target_array,
                         const llvm_ir::IrArray& lhs_array,
@@ -1239,19 +1311,25 @@ Status EmitDotOperation(const HloInstruction& dot,
                         llvm::Value* executable_run_options_value,
                         llvm::IRBuilder<>* b, mlir::MLIRContext* mlir_context,
                         const HloModuleConfig& hlo_module_config,
-                        const TargetMachineFeatures& target_machine_features) {
+                        const TargetMachineFeatures& target_machine_features,
+                        llvm::Value* dynamic_lhs_rows) {
   // This routine assumes that the dot operation is not in a parallelized
   // enclosing computation.
   CHECK(dot.parent()->root_instruction()->outer_dimension_partitions().empty());
 
   if (IsBatchDot(dot)) {
-    TF_RET_CHECK(addend_array == nullptr);
+    TF_RET_CHECK(addend_array == nullptr && dynamic_lhs_rows == nullptr);
     return EmitBatchDotOperation(dot, target_array, lhs_array, rhs_array,
                                  executable_run_options_value, b, mlir_context,
                                  hlo_module_config, target_machine_features);
   }
 
-  return EmitNonBatchDotOperation(DotInfo(dot), dot.name(), target_array,
+  DotInfo dot_info(dot);
+  if (dynamic_lhs_rows != nullptr) {
+    TF_RET_CHECK(DotSupportsDynamicRows(dot));
+    dot_info.dynamic_lhs_rows = dynamic_lhs_rows;
+  }
+  return EmitNonBatchDotOperation(std::move(dot_info), dot.name(), target_array,
                                   lhs_array, rhs_array, addend_array,
                                   executable_run_options_value, b, mlir_context,
                                   hlo_module_config, target_machine_features);
@@ -43,6 +43,23 @@ bool DotImplementationCanHandleTranspose(
     const HloInstruction& dot_instr,
     const TargetMachineFeatures& target_machine_features);
 
+// Returns true if `dot_instr` is lowered to a call into an Eigen routine, which
+// may use the intra-op thread pool.
+bool PotentiallyImplementedAsEigenDot(
+    const HloInstruction& dot_instr,
+    const TargetMachineFeatures& target_machine_features);
+
+// Returns true if `instr` is a product of int8 matrices with an int32 result.
+// Such products are lowered to an Eigen routine that widens the operands as it
+// packs them, so they must not be upcast beforehand.
+bool IsS8MatrixMultiplication(const HloInstruction& instr);
+
+// Returns true if `instr` is a non-batch matrix multiply whose only dynamic
+// dimension is the rows of the LHS. Such dots are emitted in dynamic form when
+// xla_cpu_enable_dynamic_dots is set: the Eigen matmul only computes the rows
+// that are in use.
+bool DotSupportsDynamicRows(const HloInstruction& instr);
+
 // Returns the index for an operand to `hlo` that should ideally be column
 // major.  Returns nullopt if there is no such operand or if `hlo` is not a dot
 // or a fusion containing a dot.
@@ -58,6 +75,10 @@ absl::optional<int64> ProfitableToMakeDotOperandColumnMajor(
 // dimensions as the result, and the result is computed as `addend_array` +
 // dot(`lhs_array`, `rhs_array`).  A non-null `addend_array` is only supported
 // for Matrix-vector products.
+//
+// If `dynamic_lhs_rows` is not nullptr, `dot` must satisfy
+// DotSupportsDynamicRows and only that many rows of the LHS are in use; the
+// rows of the result past them are left undefined.
 Status EmitDotOperation(const HloInstruction& dot,
                         const llvm_ir::IrArray& target_array,
                         const llvm_ir::IrArray& lhs_array,
@@ -66,7 +87,8 @@ Status EmitDotOperation(const HloInstruction& dot,
                         llvm::Value* executable_run_options_value,
                         llvm::IRBuilder<>* b, mlir::MLIRContext* mlir_context,
                         const HloModuleConfig& hlo_module_config,
-                        const TargetMachineFeatures& target_machine_features);
+                        const TargetMachineFeatures& target_machine_features,
+                        llvm::Value* dynamic_lhs_rows = nullptr);
 }  // namespace cpu
 }  // namespace xla
 
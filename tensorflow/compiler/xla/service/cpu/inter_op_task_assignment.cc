@@ -0,0 +1,251 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/inter_op_task_assignment.h"
+
+#include <algorithm>
+#include <map>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
+#include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/dynamic_update_slice_util.h"
+
+namespace xla {
+namespace cpu {
+
+namespace {
+
+// Returns true if 'instruction' is lowered to a call into a multi-threaded
+// Eigen routine, which blocks on the intra-op thread pool.
+bool UsesMultiThreadedEigen(
+    const HloInstruction& instruction,
+    const TargetMachineFeatures& target_machine_features) {
+  if (!instruction.parent()
+           ->parent()
+           ->config()
+           .debug_options()
+           .xla_cpu_multi_thread_eigen()) {
+    return false;
+  }
+  switch (instruction.opcode()) {
+    case HloOpcode::kDot:
+      return PotentiallyImplementedAsEigenDot(instruction,
+                                              target_machine_features);
+    case HloOpcode::kConvolution:
+      return PotentiallyImplementedAsEigenConvolution(instruction,
+                                                      target_machine_features);
+    case HloOpcode::kFft:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+StatusOr<bool> InterOpTaskAssigner::Run(HloModule* module) {
+  if (max_parallelism_ < 2) {
+    return false;
+  }
+  XLA_VLOG_LINES(2, "InterOpTaskAssigner ENTRY");
+  XLA_VLOG_LINES(3, module->ToString());
+  TF_ASSIGN_OR_RETURN(bool changed,
+                      AssignTasks(module, module->entry_computation()));
+  XLA_VLOG_LINES(2, "InterOpTaskAssigner EXIT");
+  XLA_VLOG_LINES(3, module->ToString());
+  return changed;
+}
+
+bool InterOpTaskAssigner::IsTaskCandidate(
+    const HloInstruction& instruction) const {
+  // Currently, we do not run instructions concurrently if they have at least
+  // one of the following properties:
+  // *) Side effects, or control dependencies.
+  // *) Tuple-shaped.
+  // *) Dead, so that outlining them would make them outputs.
+  // *) Operations that might be implemented as an in-place
+  //    dynamic-update-slice, which write to their operand's buffer.
+  // *) Calls to other computations that are not thread-local, and calls to
+  //    multi-threaded library routines.
+  if (instruction.HasSideEffect() || instruction.shape().IsTuple() ||
+      !instruction.control_predecessors().empty() ||
+      !instruction.control_successors().empty() ||
+      (instruction.user_count() == 0 &&
+       instruction.parent()->root_instruction() != &instruction) ||
+      llvm_ir::MayBeImplementedAsInPlaceDynamicUpdateSlice(&instruction)) {
+    return false;
+  }
+
+  auto opcode = instruction.opcode();
+  if (opcode == HloOpcode::kFusion) {
+    for (const HloInstruction* fused : instruction.fused_instructions()) {
+      if (UsesMultiThreadedEigen(*fused, target_machine_features_)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  // Only allow known good instructions.
+  return instruction.IsElementwise() || opcode == HloOpcode::kBroadcast ||
+         opcode == HloOpcode::kConcatenate || opcode == HloOpcode::kCopy ||
+         opcode == HloOpcode::kDynamicSlice || opcode == HloOpcode::kGather ||
+         opcode == HloOpcode::kIota || opcode == HloOpcode::kPad ||
+         opcode == HloOpcode::kReduce || opcode == HloOpcode::kReduceWindow ||
+         opcode == HloOpcode::kReverse || opcode == HloOpcode::kSlice ||
+         opcode == HloOpcode::kTranspose ||
+         ((opcode == HloOpcode::kDot || opcode == HloOpcode::kConvolution) &&
+          !UsesMultiThreadedEigen(instruction, target_machine_features_));
+}
+
+StatusOr<bool> InterOpTaskAssigner::AssignTasks(HloModule* module,
+                                                HloComputation* computation) {
+  bool changed = false;
+  // Assign tasks to sub-computations for While and Call HLOs, except for the
+  // calls outlined by ParallelTaskAssigner.
+  std::vector<HloInstruction*> instructions =
+      computation->MakeInstructionPostOrder();
+  for (HloInstruction* instruction : instructions) {
+    if (instruction->opcode() == HloOpcode::kWhile) {
+      TF_ASSIGN_OR_RETURN(bool body_changed,
+                          AssignTasks(module, instruction->while_body()));
+      changed |= body_changed;
+    } else if (instruction->opcode() == HloOpcode::kCall &&
+               instruction->to_apply()
+                   ->root_instruction()
+                   ->outer_dimension_partitions()
+                   .empty()) {
+      TF_ASSIGN_OR_RETURN(bool callee_changed,
+                          AssignTasks(module, instruction->to_apply()));
+      changed |= callee_changed;
+    }
+  }
+
+  HloCostAnalysis cost_analysis(shape_size_function_);
+  Status status = computation->Accept(&cost_analysis);
+  if (!status.ok()) {
+    // HloCostAnalysis does not support some HLOs, like CustomCall.
+    VLOG(2) << "Not assigning tasks in " << computation->name() << ": "
+            << status;
+    return changed;
+  }
+
+  // An instruction's depth is the length of the longest dependency path from
+  // a source of 'computation' to it.  Instructions with the same depth are
+  // independent.
+  absl::flat_hash_map<const HloInstruction*, int64> depths;
+  std::map<int64, std::vector<HloInstruction*>> candidates_by_depth;
+  for (HloInstruction* instruction : instructions) {
+    int64 depth = 0;
+    for (const HloInstruction* operand : instruction->operands()) {
+      depth = std::max(depth, depths.at(operand) + 1);
+    }
+    for (const HloInstruction* predecessor :
+         instruction->control_predecessors()) {
+      depth = std::max(depth, depths.at(predecessor) + 1);
+    }
+    depths[instruction] = depth;
+
+    if (!IsTaskCandidate(*instruction)) {
+      continue;
+    }
+    // Same cost model as the compute bound case of ParallelTaskAssignment.
+    const int64 cost = cost_analysis.flop_count(*instruction) +
+                       2 * cost_analysis.transcendental_count(*instruction) +
+                       10 * cost_analysis.bytes_accessed(*instruction);
+    if (cost >= min_task_cost_) {
+      candidates_by_depth[depth].push_back(instruction);
+    }
+  }
+
+  for (const auto& depth_and_candidates : candidates_by_depth) {
+    const std::vector<HloInstruction*>& candidates =
+        depth_and_candidates.second;
+    for (int64 begin = 0; begin + 1 < candidates.size();
+         begin += max_parallelism_) {
+      const int64 end =
+          std::min<int64>(begin + max_parallelism_, candidates.size());
+      if (end - begin < 2) {
+        break;
+      }
+      TF_RETURN_IF_ERROR(OutlineTaskGroup(
+          module, computation,
+          std::vector<HloInstruction*>(candidates.begin() + begin,
+                                       candidates.begin() + end)));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+Status InterOpTaskAssigner::OutlineTaskGroup(
+    HloModule* module, HloComputation* computation,
+    const std::vector<HloInstruction*>& tasks) {
+  // Outline each task into its own computation, so that it is compiled as a
+  // separate compute function.
+  std::vector<HloInstruction*> calls;
+  calls.reserve(tasks.size());
+  for (HloInstruction* task : tasks) {
+    calls.push_back(module->OutlineExpressionFromComputation(
+        {task}, absl::StrCat("task_", task->name()), computation));
+  }
+
+  // Outline the calls together.
+  auto builder = HloComputation::Builder(
+      absl::StrCat("inter_op_tasks_", tasks.front()->name()));
+  absl::flat_hash_map<HloInstruction*, HloInstruction*> parameters;
+  std::vector<HloInstruction*> arguments;
+  std::vector<HloInstruction*> outlined_calls;
+  for (HloInstruction* call : calls) {
+    std::vector<HloInstruction*> operands;
+    for (HloInstruction* operand : call->operands()) {
+      HloInstruction*& parameter = parameters[operand];
+      if (parameter == nullptr) {
+        parameter = builder.AddInstruction(HloInstruction::CreateParameter(
+            arguments.size(), operand->shape(), "p"));
+        arguments.push_back(operand);
+      }
+      operands.push_back(parameter);
+    }
+    outlined_calls.push_back(builder.AddInstruction(
+        call->CloneWithNewOperands(call->shape(), operands)));
+  }
+  HloComputation* group_computation = module->AddEmbeddedComputation(
+      builder.Build(builder.AddInstruction(
+          HloInstruction::CreateTuple(outlined_calls))));
+  HloInstruction* group =
+      computation->AddInstruction(HloInstruction::CreateCall(
+          group_computation->root_instruction()->shape(), arguments,
+          group_computation));
+  group->set_raw_backend_config_string(kInterOpTaskGroupConfig);
+
+  for (int64 i = 0; i < calls.size(); ++i) {
+    HloInstruction* element =
+        computation->AddInstruction(HloInstruction::CreateGetTupleElement(
+            calls[i]->shape(), group, i));
+    TF_RETURN_IF_ERROR(calls[i]->ReplaceAllUsesWith(element));
+    TF_RETURN_IF_ERROR(computation->RemoveInstruction(calls[i]));
+  }
+  VLOG(2) << "Assigned " << calls.size() << " concurrent tasks to "
+          << group->name() << " parent: " << computation->name();
+  return Status::OK();
+}
+
+}  // namespace cpu
+}  // namespace xla
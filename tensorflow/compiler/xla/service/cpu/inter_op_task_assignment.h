@@ -0,0 +1,92 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_INTER_OP_TASK_ASSIGNMENT_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_INTER_OP_TASK_ASSIGNMENT_H_
+
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/cpu/target_machine_features.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace cpu {
+
+// InterOpTaskAssigner groups independent HLOs in the entry computation, or in
+// embedded computations invoked by (potentially nested) kWhile or kCall
+// instructions, into tasks that are run concurrently.
+//
+// HLOs are independent if none of them is reachable from another one; the
+// assigner only groups HLOs at the same depth of the dependency graph, so the
+// groups run one after the other, in dependency order.
+// Each HLO of a group is outlined into its own embedded computation, which is
+// compiled as a compute function.  The calls to these computations are
+// outlined together into an embedded computation which is invoked from a kCall
+// instruction with backend config kInterOpTaskGroupConfig, and which is
+// lowered in codegen to a runtime call dispatching the compute functions onto
+// the intra-op thread pool.  Codegen falls back to calling the compute
+// functions one after the other if the buffer assignment lets one of them write
+// a buffer that another one accesses.
+//
+// HLOs that may block on the intra-op thread pool themselves, like calls to
+// multi-threaded Eigen routines or HLOs assigned parallel tasks by
+// ParallelTaskAssigner, are never grouped.
+class InterOpTaskAssigner : public HloModulePass {
+ public:
+  // 'max_parallelism': the maximum number of HLOs per group.
+  // 'shape_size': shape size function used by HloCostAnalysis to estimate the
+  //               cost of HLOs.
+  // 'min_task_cost': the cost below which HLOs are not worth running as
+  //                  separate tasks.
+  InterOpTaskAssigner(const int64 max_parallelism,
+                      const HloCostAnalysis::ShapeSizeFunction& shape_size,
+                      const TargetMachineFeatures* target_machine_features,
+                      const int64 min_task_cost = 100000)
+      : max_parallelism_(max_parallelism),
+        shape_size_function_(shape_size),
+        target_machine_features_(*target_machine_features),
+        min_task_cost_(min_task_cost) {}
+  ~InterOpTaskAssigner() override {}
+
+  absl::string_view name() const override {
+    return "cpu-inter-op-task-assigner";
+  }
+
+  // Run inter-op task assigner on 'module'.
+  // Returns true if the computation was changed, false otherwise.
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  StatusOr<bool> AssignTasks(HloModule* module, HloComputation* computation);
+
+  // Returns true if 'instruction' may be run concurrently with other HLOs.
+  bool IsTaskCandidate(const HloInstruction& instruction) const;
+
+  // Outlines the independent HLOs in 'tasks' into a task group.
+  Status OutlineTaskGroup(HloModule* module, HloComputation* computation,
+                          const std::vector<HloInstruction*>& tasks);
+
+  int64 max_parallelism_;
+  HloCostAnalysis::ShapeSizeFunction shape_size_function_;
+  const TargetMachineFeatures& target_machine_features_;
+  int64 min_task_cost_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_INTER_OP_TASK_ASSIGNMENT_H_
@@ -0,0 +1,172 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/inter_op_task_assignment.h"
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
+#include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/cpu/target_machine_features_fake.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace xla {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class InterOpTaskAssignmentTest : public HloTestBase {
+ protected:
+  const HloCostAnalysis::ShapeSizeFunction shape_size_func_ =
+      cpu::CpuExecutable::ShapeSizeBytes;
+
+  const int max_parallelism_ = 2;
+
+  cpu::TargetMachineFeaturesWithFakeAlignmentLogic target_machine_features_;
+
+  InterOpTaskAssignmentTest()
+      : HloTestBase(), target_machine_features_([](int64 shape_size) {
+          return cpu::TargetMachineFeatures::kEigenExpectedTensorAlignment;
+        }) {}
+
+  StatusOr<bool> RunInterOpTaskAssigner(HloModule* module,
+                                        int64 min_task_cost = 0) {
+    return cpu::InterOpTaskAssigner(max_parallelism_, shape_size_func_,
+                                    &target_machine_features_, min_task_cost)
+        .Run(module);
+  }
+};
+
+TEST_F(InterOpTaskAssignmentTest, IndependentOperationsGrouped) {
+  const string hlo_string = R"(
+    HloModule TestInterOpTasks_Independent
+    ENTRY Independent {
+      p0 = f32[1024,1024]{1,0} parameter(0)
+      p1 = f32[1024,1024]{1,0} parameter(1)
+      exp = f32[1024,1024]{1,0} exponential(p0)
+      log = f32[1024,1024]{1,0} log(p1)
+      ROOT add = f32[1024,1024]{1,0} add(exp, log)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunInterOpTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+
+  const HloInstruction* root = m->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Add(op::GetTupleElement(op::Call(), 0),
+                            op::GetTupleElement(op::Call(), 1)));
+  const HloInstruction* group = root->operand(0)->operand(0);
+  EXPECT_TRUE(cpu::IsInterOpTaskGroup(*group));
+  EXPECT_THAT(group->to_apply()->root_instruction(),
+              op::Tuple(op::Call(op::Parameter()), op::Call(op::Parameter())));
+  EXPECT_THAT(
+      group->to_apply()->root_instruction()->operand(0)->to_apply()
+          ->root_instruction(),
+      op::Exp(op::Parameter()));
+}
+
+TEST_F(InterOpTaskAssignmentTest, DependentOperationsNotGrouped) {
+  const string hlo_string = R"(
+    HloModule TestInterOpTasks_Dependent
+    ENTRY Dependent {
+      p0 = f32[1024,1024]{1,0} parameter(0)
+      exp = f32[1024,1024]{1,0} exponential(p0)
+      ROOT log = f32[1024,1024]{1,0} log(exp)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunInterOpTaskAssigner(m.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(InterOpTaskAssignmentTest, CheapOperationsNotGrouped) {
+  const string hlo_string = R"(
+    HloModule TestInterOpTasks_Cheap
+    ENTRY Cheap {
+      p0 = f32[16]{0} parameter(0)
+      p1 = f32[16]{0} parameter(1)
+      exp = f32[16]{0} exponential(p0)
+      log = f32[16]{0} log(p1)
+      ROOT add = f32[16]{0} add(exp, log)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunInterOpTaskAssigner(m.get(),
+                                                 /*min_task_cost=*/100000));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(InterOpTaskAssignmentTest, RngOperationNotGrouped) {
+  const string hlo_string = R"(
+    HloModule TestInterOpTasks_Rng
+    ENTRY Rng {
+      src0 = f32[] parameter(0)
+      src1 = f32[] parameter(1)
+      p0 = f32[1024,1024]{1,0} parameter(2)
+      rng = f32[1024,1024]{1,0} rng(src0, src1), distribution=rng_uniform
+      exp = f32[1024,1024]{1,0} exponential(p0)
+      ROOT add = f32[1024,1024]{1,0} add(rng, exp)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunInterOpTaskAssigner(m.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(InterOpTaskAssignmentTest, GroupsLimitedToMaxParallelism) {
+  const string hlo_string = R"(
+    HloModule TestInterOpTasks_Wide
+    ENTRY Wide {
+      p0 = f32[1024,1024]{1,0} parameter(0)
+      exp = f32[1024,1024]{1,0} exponential(p0)
+      log = f32[1024,1024]{1,0} log(p0)
+      neg = f32[1024,1024]{1,0} negate(p0)
+      ROOT tuple = (f32[1024,1024]{1,0}, f32[1024,1024]{1,0},
+                    f32[1024,1024]{1,0}) tuple(exp, log, neg)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunInterOpTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+
+  // Two of the three operations share a group, the third one is left as is.
+  int64 num_groups = 0;
+  for (const HloInstruction* instruction :
+       m->entry_computation()->instructions()) {
+    if (cpu::IsInterOpTaskGroup(*instruction)) {
+      ++num_groups;
+      EXPECT_EQ(instruction->to_apply()->root_instruction()->operand_count(),
+                2);
+      // Both tasks read the same parameter.
+      EXPECT_EQ(instruction->operand_count(), 1);
+    }
+  }
+  EXPECT_EQ(num_groups, 1);
+}
+
+}  // namespace
+}  // namespace xla
@@ -24,6 +24,8 @@ limitations under the License.
 namespace xla {
 namespace cpu {
 
+extern const char* const kInterOpTaskGroupConfig = "inter_op_task_group";
+
 int64 GetMinimumAlignmentForArray(
     const Shape& shape, const TargetMachineFeatures& target_machine_features) {
   CHECK(shape.IsArray());
@@ -112,5 +114,10 @@ bool PotentiallyImplementedAsEigenConvolution(
              kernel_shape.dimensions_size() - 1;
 }
 
+bool IsInterOpTaskGroup(const HloInstruction& instruction) {
+  return instruction.opcode() == HloOpcode::kCall &&
+         instruction.raw_backend_config_string() == kInterOpTaskGroupConfig;
+}
+
 }  // namespace cpu
 }  // namespace xla
@@ -27,6 +27,14 @@ bool PotentiallyImplementedAsEigenConvolution(
     const HloInstruction& convolution,
     const TargetMachineFeatures& target_machine_features);
 
+// Backend config of the kCall instructions outlined by InterOpTaskAssigner.
+extern const char* const kInterOpTaskGroupConfig;
+
+// Returns true if `instruction` is a kCall whose called computation only calls
+// independent computations, which can be run concurrently. See
+// InterOpTaskAssigner for details.
+bool IsInterOpTaskGroup(const HloInstruction& instruction);
+
 // Computes the minimum alignment guaranteed for a tensor of shape `shape` on
 // the target machine.
 int64 GetMinimumAlignmentForArray(
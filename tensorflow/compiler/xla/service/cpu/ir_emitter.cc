@@ -26,6 +26,7 @@ limitations under the License.
 #include <vector>
 
 // IWYU pragma: no_include "llvm/IR/Intrinsics.gen.inc"
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
@@ -860,11 +861,38 @@ Status IrEmitter::HandleDot(HloInstruction* dot) {
   VLOG(2) << "  target: "
           << llvm_ir::DumpToString(*target_array.GetBasePointer());
 
+  // A dot left in dynamic form by the DynamicPadder reads the number of rows
+  // in use from the metadata after the data of the LHS, and records the
+  // dimension sizes of its result the same way.
+  llvm::Value* dynamic_lhs_rows = nullptr;
+  if (dot->shape().is_dynamic()) {
+    TF_RET_CHECK(DotSupportsDynamicRows(*dot) &&
+                 lhs->shape().is_dynamic_dimension(0));
+    auto metadata_address = [&](const HloInstruction* hlo, int64 dim) {
+      llvm::Value* raw_buffer = b_.CreateBitCast(
+          GetEmittedValueFor(hlo), b_.getInt8Ty()->getPointerTo());
+      int64 raw_data_size =
+          ShapeUtil::ByteSizeOf(ShapeUtil::MakeStaticShape(hlo->shape()));
+      return b_.CreateBitCast(
+          b_.CreateConstInBoundsGEP1_32(b_.getInt8Ty(), raw_buffer,
+                                        raw_data_size + dim * sizeof(int32)),
+          b_.getInt32Ty()->getPointerTo());
+    };
+    llvm::Value* dyn_dim_size =
+        b_.CreateLoad(metadata_address(lhs, 0), "dyn_dim_size");
+    b_.CreateStore(dyn_dim_size, metadata_address(dot, 0));
+    b_.CreateStore(b_.getInt32(dot->shape().dimensions(1)),
+                   metadata_address(dot, 1));
+    dynamic_lhs_rows = b_.CreateIntCast(dyn_dim_size, b_.getInt64Ty(),
+                                        /*isSigned=*/true, "i64_dyn_dim_size");
+  }
+
   // Dot operation is complicated so we delegate to a helper class.
   return EmitDotOperation(*dot, target_array, lhs_array, rhs_array,
                           /*addend_array=*/nullptr,
                           GetExecutableRunOptionsArgument(), &b_, mlir_context_,
-                          hlo_module_config_, target_machine_features_);
+                          hlo_module_config_, target_machine_features_,
+                          dynamic_lhs_rows);
 }
 
 Status IrEmitter::HandleConvolution(HloInstruction* convolution) {
@@ -2123,6 +2151,13 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
 
   TF_RETURN_IF_ERROR(EmitTargetAddressForOp(call));
 
+  if (IsInterOpTaskGroup(*call)) {
+    TF_ASSIGN_OR_RETURN(bool emitted, EmitParallelCalls(call));
+    if (emitted) {
+      return Status::OK();
+    }
+  }
+
   if (!computation->root_instruction()->outer_dimension_partitions().empty()) {
     // ParallelTaskAssignment assigned partitions, emit call to
     // ParallelForkJoin.
@@ -3324,6 +3359,97 @@ void IrEmitter::EmitGlobalCall(const HloComputation& callee,
            /*profile_counters_arg=*/GetProfileCountersArgument()));
 }
 
+StatusOr<bool> IrEmitter::EmitParallelCalls(HloInstruction* call) {
+  const HloComputation* computation = call->to_apply();
+  const HloInstruction* root = computation->root_instruction();
+  // InterOpTaskAssigner outlines a tuple of calls to computations that take
+  // parameters of the task group; later passes may have changed that.
+  if (root->opcode() != HloOpcode::kTuple ||
+      computation->instruction_count() !=
+          computation->num_parameters() + root->operand_count() + 1) {
+    return false;
+  }
+  absl::flat_hash_set<const HloInstruction*> tasks;
+  for (const HloInstruction* task : root->operands()) {
+    if (task->opcode() != HloOpcode::kCall || !tasks.insert(task).second ||
+        absl::c_any_of(task->operands(), [](const HloInstruction* operand) {
+          return operand->opcode() != HloOpcode::kParameter;
+        })) {
+      return false;
+    }
+  }
+
+  // Collect the buffers each task reads and writes.
+  const int64 num_tasks = root->operand_count();
+  std::vector<std::vector<BufferAllocation::Slice>> reads(num_tasks);
+  std::vector<std::vector<BufferAllocation::Slice>> writes(num_tasks);
+  for (int64 i = 0; i < num_tasks; ++i) {
+    for (const HloInstruction* instruction :
+         root->operand(i)->to_apply()->instructions()) {
+      for (const HloComputation* callee : instruction->called_computations()) {
+        if (absl::c_binary_search(global_computations_, callee)) {
+          return false;
+        }
+      }
+      std::vector<BufferAllocation::Slice>& slices =
+          instruction->opcode() == HloOpcode::kParameter ? reads[i]
+                                                         : writes[i];
+      ShapeUtil::ForEachSubshape(
+          instruction->shape(), [&](const Shape&, const ShapeIndex& index) {
+            for (const BufferAllocation::Slice& slice :
+                 assignment_.GetAllSlices(instruction, index)) {
+              if (!slice.allocation()->is_thread_local()) {
+                slices.push_back(slice);
+              }
+            }
+          });
+    }
+  }
+  // The buffer assignment follows the sequential schedule, so it may reuse the
+  // buffer a task reads for the result of another task.
+  const auto overlaps = [](const BufferAllocation::Slice& slice,
+                           const std::vector<BufferAllocation::Slice>& others) {
+    return absl::c_any_of(others, [&](const BufferAllocation::Slice& other) {
+      return slice.OverlapsWith(other);
+    });
+  };
+  for (int64 i = 0; i < num_tasks; ++i) {
+    for (int64 j = 0; j < num_tasks; ++j) {
+      if (i == j) {
+        continue;
+      }
+      for (const BufferAllocation::Slice& slice : writes[i]) {
+        if (overlaps(slice, reads[j]) || overlaps(slice, writes[j])) {
+          VLOG(2) << "Running the tasks of " << call->name()
+                  << " sequentially: " << root->operand(i)->name()
+                  << " writes a buffer used by " << root->operand(j)->name();
+          return false;
+        }
+      }
+    }
+  }
+
+  std::vector<llvm::Function*> functions;
+  std::vector<llvm::Value*> task_results;
+  for (const HloInstruction* task : root->operands()) {
+    functions.push_back(FindOrDie(emitted_functions_, task->to_apply()));
+    TF_ASSIGN_OR_RETURN(BufferAllocation::Slice slice,
+                        assignment_.GetUniqueTopLevelSlice(task));
+    task_results.push_back(EmitBufferPointer(slice, task->shape()));
+  }
+  std::vector<llvm::Value*> call_args = GetArrayFunctionCallArguments(
+      /*parameter_addresses=*/{}, &b_, computation->name(),
+      /*return_value_buffer=*/llvm::Constant::getNullValue(b_.getInt8PtrTy()),
+      /*exec_run_options_arg=*/GetExecutableRunOptionsArgument(),
+      /*buffer_table_arg=*/GetBufferTableArgument(),
+      /*profile_counters_arg=*/GetProfileCountersArgument());
+  EmitCallToParallelCalls(call_args, functions, &b_, computation->name());
+  // The task group computation, which is not called, would have emitted the
+  // tuple of the task results.
+  llvm_ir::EmitTuple(GetIrArrayFor(call), task_results, &b_);
+  return true;
+}
+
 llvm::Value* IrEmitter::GetBufferForGlobalCallReturnValue(
     const HloComputation& callee) {
   const HloInstruction* root_inst = callee.root_instruction();
@@ -287,6 +287,11 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   // to explicitly pass parameters or return results.
   void EmitGlobalCall(const HloComputation& callee, absl::string_view name);
 
+  // Tries to emit the calls of the task group `call` (see IsInterOpTaskGroup)
+  // as a single runtime call running them concurrently.  Returns false, and
+  // emits nothing, if the calls can't be run concurrently.
+  StatusOr<bool> EmitParallelCalls(HloInstruction* call);
+
   // Returns the buffer to which a global call to `callee` would have written
   // its result.
   llvm::Value* GetBufferForGlobalCallReturnValue(const HloComputation& callee);
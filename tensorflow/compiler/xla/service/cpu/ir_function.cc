@@ -337,5 +337,61 @@ Status EmitCallToParallelForkJoin(
   return Status::OK();
 }
 
+void EmitCallToParallelCalls(const std::vector<llvm::Value*>& arguments,
+                             absl::Span<llvm::Function* const> functions,
+                             llvm::IRBuilder<>* b, const string& name) {
+  llvm::Module* module = b->GetInsertBlock()->getModule();
+  llvm::Type* i8_ptr_type = b->getInt8PtrTy();
+
+  // Build ParallelCalls function type.
+  std::vector<llvm::Type*> compute_function_params =
+      GetComputeFunctionParams(module, /*num_dynamic_loop_bounds=*/0);
+  // Number of compute functions.
+  compute_function_params.push_back(b->getInt32Ty());
+  // Array of function pointers for the compute functions.
+  compute_function_params.push_back(i8_ptr_type->getPointerTo());
+
+  llvm::FunctionType* parallel_calls_type = llvm::FunctionType::get(
+      /*Result=*/llvm::Type::getVoidTy(module->getContext()),
+      /*Params=*/compute_function_params,
+      /*isVarArg=*/false);
+
+  llvm::Function* parallel_calls_func = llvm::dyn_cast<llvm::Function>(
+      module
+          ->getOrInsertFunction(runtime::kParallelCallsSymbolName,
+                                parallel_calls_type)
+          .getCallee());
+  parallel_calls_func->setCallingConv(llvm::CallingConv::C);
+  parallel_calls_func->setDoesNotThrow();
+
+  // Store the function pointers as llvm constants in a global variable.
+  std::vector<llvm::Constant*> function_ptrs;
+  function_ptrs.reserve(functions.size());
+  for (llvm::Function* function : functions) {
+    function_ptrs.push_back(
+        llvm::ConstantExpr::getBitCast(function, i8_ptr_type));
+  }
+  llvm::ArrayType* function_ptrs_type =
+      llvm::ArrayType::get(i8_ptr_type, function_ptrs.size());
+  llvm::Constant* function_ptrs_array =
+      llvm::ConstantArray::get(function_ptrs_type, function_ptrs);
+  llvm::GlobalVariable* global_function_ptrs = new llvm::GlobalVariable(
+      /*M=*/*module,
+      /*Ty=*/function_ptrs_type,
+      /*isConstant=*/true,
+      /*Linkage=*/llvm::GlobalValue::PrivateLinkage,
+      /*Initializer=*/function_ptrs_array,
+      /*Name=*/absl::StrCat(name, "_parallel_functions"));
+
+  std::vector<llvm::Value*> parallel_calls_arguments(arguments);
+  // Add argument specifying the number of compute functions.
+  parallel_calls_arguments.push_back(b->getInt32(functions.size()));
+  // Add argument specifying the compute function pointers.
+  parallel_calls_arguments.push_back(
+      b->CreateBitCast(global_function_ptrs, i8_ptr_type->getPointerTo()));
+  // Emit call to parallel calls.
+  b->CreateCall(parallel_calls_func, parallel_calls_arguments);
+}
+
 }  // namespace cpu
 }  // namespace xla
@@ -134,6 +134,12 @@ Status EmitCallToParallelForkJoin(
     const std::vector<int64>& dimension_partition_counts, llvm::IRBuilder<>* b,
     llvm::Function* parallel_function, const string& name);
 
+// Emits a call to a runtime function which dispatches parallel calls to each
+// of 'functions' (and joins threads before returning).
+void EmitCallToParallelCalls(const std::vector<llvm::Value*>& arguments,
+                             absl::Span<llvm::Function* const> functions,
+                             llvm::IRBuilder<>* b, const string& name);
+
 }  // namespace cpu
 }  // namespace xla
 
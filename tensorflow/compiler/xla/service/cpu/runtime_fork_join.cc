@@ -102,3 +102,59 @@ TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   bc.Wait();
   VLOG(2) << "ParallelForkJoin EXIT";
 }
+
+using GlobalFunctionType = void (*)(void*, const void*, const void**, void**,
+                                    uint64*);
+
+// Dispatches calls to 'function_ptrs[1]' ... 'function_ptrs[num_functions - 1]'
+// in parallel, and calls 'function_ptrs[0]' inline.
+// Uses blocking counter to synchronize threads after parallel calls complete.
+//
+// The functions are compute functions of distinct global computations, which
+// read and write their buffers through 'buffer_table'. The caller guarantees
+// that none of them writes a buffer that another one reads or writes.
+//
+// Runs the functions one after the other if there is no intra-op thread pool.
+TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelCalls(
+    void* result_ptr, const void* run_options_ptr, const void** params,
+    void** buffer_table, uint64* prof_counters, int32 num_functions,
+    void** function_ptrs) {
+  VLOG(2) << "ParallelCalls ENTRY"
+          << " num_functions: " << num_functions;
+  CHECK_GT(num_functions, 1);
+  CHECK_NE(function_ptrs, nullptr);
+  const xla::ExecutableRunOptions* run_options =
+      static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
+  CHECK_NE(run_options, nullptr);
+
+  const auto call = [&](int32 i) {
+    GlobalFunctionType function =
+        reinterpret_cast<GlobalFunctionType>(function_ptrs[i]);
+    function(result_ptr, run_options_ptr, params, buffer_table, prof_counters);
+  };
+
+  if (run_options->intra_op_thread_pool() == nullptr) {
+    for (int32 i = 0; i < num_functions; ++i) {
+      call(i);
+    }
+    VLOG(2) << "ParallelCalls EXIT";
+    return;
+  }
+
+  // Dispatch 'num_functions - 1' compute functions to run in parallel.
+  tensorflow::BlockingCounter bc(num_functions - 1);
+  for (int32 i = 1; i < num_functions; ++i) {
+    run_options->intra_op_thread_pool()->enqueueNoNotification(
+        [i, &call, &bc]() {
+          call(i);
+          bc.DecrementCount();
+          VLOG(3) << "ParallelCalls function " << i << " done.";
+        });
+  }
+
+  // Call first compute function inline.
+  call(0);
+  VLOG(3) << "ParallelCalls function 0 done.";
+  bc.Wait();
+  VLOG(2) << "ParallelCalls EXIT";
+}
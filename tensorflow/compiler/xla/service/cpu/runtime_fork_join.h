@@ -28,6 +28,14 @@ extern void __xla_cpu_runtime_ParallelForkJoin(
     tensorflow::int32 num_partitions, tensorflow::int64* partitions,
     tensorflow::int32 num_partitioned_dims, void* function_ptr);
 
+// Dispatches parallel calls to each of the 'num_functions' compute functions in
+// 'function_ptrs' and joins threads before returning. See comments in
+// runtime_fork_join.cc for details.
+extern void __xla_cpu_runtime_ParallelCalls(
+    void* result_ptr, const void* run_options_ptr, const void** params,
+    void** buffer_table, tensorflow::uint64* prof_counters,
+    tensorflow::int32 num_functions, void** function_ptrs);
+
 }  // extern "C"
 
 #endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_FORK_JOIN_H_
@@ -64,6 +64,13 @@ extern void __xla_cpu_runtime_EigenMatMulS32(
     tensorflow::int64 m, tensorflow::int64 n, tensorflow::int64 k,
     tensorflow::int32 transpose_lhs, tensorflow::int32 transpose_rhs);
 
+// Performs a matrix multiplication of int8 matrices, accumulating in int32.
+extern void __xla_cpu_runtime_EigenMatMulS8S32(
+    const void* /* xla::ExecutableRunOptions* */ run_options_ptr,
+    tensorflow::int32* out, tensorflow::int8* lhs, tensorflow::int8* rhs,
+    tensorflow::int64 m, tensorflow::int64 n, tensorflow::int64 k,
+    tensorflow::int32 transpose_lhs, tensorflow::int32 transpose_rhs);
+
 }  // extern "C"
 
 #endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_RUNTIME_MATMUL_H_
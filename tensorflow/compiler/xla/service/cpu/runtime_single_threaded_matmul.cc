@@ -63,6 +63,40 @@ void MatMul(const void* run_options_ptr, T* out, T* lhs, T* rhs,
   C = A.contract(B, dims);
 }
 
+// Like MatMul, but for inputs of a narrower type than the output, which are
+// widened to the output type as they are packed.
+template <typename T, typename InputT, Eigen::AlignmentType Alignment>
+void WideningMatMul(const void* run_options_ptr, T* out, InputT* lhs,
+                    InputT* rhs, tensorflow::int64 m, tensorflow::int64 n,
+                    tensorflow::int64 k, tensorflow::int32 transpose_lhs,
+                    tensorflow::int32 transpose_rhs) {
+  tensorflow::int64 lhs_rows = m;
+  tensorflow::int64 lhs_cols = k;
+  if (transpose_lhs) {
+    std::swap(lhs_rows, lhs_cols);
+  }
+
+  tensorflow::int64 rhs_rows = k;
+  tensorflow::int64 rhs_cols = n;
+  if (transpose_rhs) {
+    std::swap(rhs_rows, rhs_cols);
+  }
+
+  const Eigen::TensorMap<Eigen::Tensor<const InputT, 2>, Alignment> A(
+      lhs, lhs_rows, lhs_cols);
+  const Eigen::TensorMap<Eigen::Tensor<const InputT, 2>, Alignment> B(
+      rhs, rhs_rows, rhs_cols);
+  Eigen::TensorMap<Eigen::Tensor<T, 2>, Alignment> C(out, m, n);
+
+  typedef typename Eigen::Tensor<T, 2>::DimensionPair DimPair;
+  int lhs_contract_dim = transpose_lhs ? 0 : 1;
+  int rhs_contract_dim = transpose_rhs ? 1 : 0;
+  const Eigen::array<DimPair, 1> dims(
+      {DimPair(lhs_contract_dim, rhs_contract_dim)});
+
+  C = A.template cast<T>().contract(B.template cast<T>(), dims);
+}
+
 template <typename T>
 void SingleThreadedMatMulDispatch(const void* run_options_ptr, T* out, T* lhs,
                                   T* rhs, tensorflow::int64 m,
@@ -140,3 +174,15 @@ __xla_cpu_runtime_EigenSingleThreadedMatMulS32(
   SingleThreadedMatMulDispatch<tensorflow::int32>(
       run_options_ptr, out, lhs, rhs, m, n, k, transpose_lhs, transpose_rhs);
 }
+
+TF_ATTRIBUTE_NO_SANITIZE_MEMORY void
+__xla_cpu_runtime_EigenSingleThreadedMatMulS8S32(
+    const void* run_options_ptr, tensorflow::int32* out, tensorflow::int8* lhs,
+    tensorflow::int8* rhs, tensorflow::int64 m, tensorflow::int64 n,
+    tensorflow::int64 k, tensorflow::int32 transpose_lhs,
+    tensorflow::int32 transpose_rhs) {
+  // The inputs are widened as they are packed, so there is little to gain from
+  // aligned loads.
+  WideningMatMul<tensorflow::int32, tensorflow::int8, Eigen::Unaligned>(
+      run_options_ptr, out, lhs, rhs, m, n, k, transpose_lhs, transpose_rhs);
+}
@@ -57,6 +57,47 @@ TEST_F(CpuDynamicShapeTest, DynamicShapeR2) {
                                 /*match_optimized_ir=*/false);
 }
 
+TEST_F(CpuDynamicShapeTest, DynamicRowsDot) {
+  HloComputation::Builder builder(TestName());
+
+  Shape lhs_shape = ShapeUtil::MakeShape(F32, {32, 128});
+  lhs_shape.set_dynamic_dimension(0, true);
+  Shape rhs_shape = ShapeUtil::MakeShape(F32, {128, 64});
+  Shape result_shape = ShapeUtil::MakeShape(F32, {32, 64});
+  result_shape.set_dynamic_dimension(0, true);
+  HloInstruction* lhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, lhs_shape, "lhs"));
+  HloInstruction* rhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(1, rhs_shape, "rhs"));
+  DotDimensionNumbers dnums;
+  dnums.add_lhs_contracting_dimensions(1);
+  dnums.add_rhs_contracting_dimensions(0);
+  builder.AddInstruction(HloInstruction::CreateDot(
+      result_shape, lhs, rhs, dnums, DefaultPrecisionConfig(2)));
+  auto hlo_module = CreateNewVerifiedModule();
+  hlo_module->AddEntryComputation(builder.Build());
+  HloModuleConfig config = hlo_module->config();
+  DebugOptions debug_options = config.debug_options();
+  debug_options.set_xla_cpu_enable_dynamic_dots(true);
+  config.set_debug_options(debug_options);
+  hlo_module->set_config(config);
+
+  // The row-major operands are swapped, so the rows in use are passed as n.
+  string filecheck_pattern = R"(
+; CHECK: call void @__xla_cpu_runtime_EigenMatMulF32({{.*}}, i64 64, i64 %{{.*}}, i64 128, i32 0, i32 0)
+)";
+
+  CpuAotCompilationOptions options{
+      /*triple=*/kTargetTripleForHost, /*cpu_name=*/kTargetCpuForHost,
+      /*features=*/"",
+      /*entry_point_name=*/"entry",
+      /*relocation_model=*/CpuAotCompilationOptions::RelocationModel::Static};
+
+  CompileAheadOfTimeAndVerifyIr(std::move(hlo_module), options,
+                                filecheck_pattern,
+                                /*match_optimized_ir=*/false);
+}
+
 }  // namespace
 }  // namespace cpu
 }  // namespace xla
@@ -92,6 +92,24 @@ TEST_P(CpuEigenDotOperationTest, DotTransposeOp) {
   CompileAndCheck(builder.Build(), spec.filecheck_lines);
 }
 
+TEST_F(CpuEigenDotOperationTest, S8DotOpKeepsNarrowOperands) {
+  HloComputation::Builder builder(TestName());
+
+  auto param_shape = ShapeUtil::MakeShape(S8, {128, 128});
+  auto result_shape = ShapeUtil::MakeShape(S32, {128, 128});
+
+  HloInstruction* lhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, param_shape, "input"));
+  HloInstruction* rhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(1, param_shape, "input"));
+
+  builder.AddInstruction(CreateCanonicalDot(result_shape, lhs, rhs));
+  CompileAndCheck(builder.Build(), R"(
+CHECK-NOT: sext i8
+CHECK: call void @__xla_cpu_runtime_EigenMatMulS8S32
+)");
+}
+
 std::vector<DotTestSpec> GetDotTestCases() {
   std::vector<DotTestSpec> result;
   result.push_back(
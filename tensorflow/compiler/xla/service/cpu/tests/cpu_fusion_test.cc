@@ -333,6 +333,34 @@ TEST_F(CpuFusionTest, DoNotDuplicateExpensiveOps) {
   EXPECT_EQ(0, fusion_inst->operand_count());
 }
 
+TEST_F(CpuFusionTest, HorizontallyFusedUpdates) {
+  // The updates of w0 and w1 are computed by one multi-output loop fusion; the
+  // update of w2 has a different shape and stays a separate fusion.
+  const char* const kModule = R"(
+HloModule m
+
+ENTRY e {
+  lr = f32[] parameter(0)
+  w0 = f32[8,3] parameter(1)
+  g0 = f32[8,3] parameter(2)
+  w1 = f32[8,3] parameter(3)
+  g1 = f32[8,3] parameter(4)
+  w2 = f32[17] parameter(5)
+  g2 = f32[17] parameter(6)
+  lr0 = f32[8,3] broadcast(lr), dimensions={}
+  step0 = f32[8,3] multiply(lr0, g0)
+  new_w0 = f32[8,3] subtract(w0, step0)
+  lr1 = f32[8,3] broadcast(lr), dimensions={}
+  step1 = f32[8,3] multiply(lr1, g1)
+  new_w1 = f32[8,3] subtract(w1, step1)
+  lr2 = f32[17] broadcast(lr), dimensions={}
+  step2 = f32[17] multiply(lr2, g2)
+  new_w2 = f32[17] subtract(w2, step2)
+  ROOT t = (f32[8,3], f32[8,3], f32[17]) tuple(new_w0, new_w1, new_w2)
+})";
+  EXPECT_TRUE(RunAndCompare(kModule, error_spec_));
+}
+
 }  // namespace
 }  // namespace cpu
 }  // namespace xla
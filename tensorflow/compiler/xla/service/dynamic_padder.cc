@@ -1722,10 +1722,13 @@ HloInstruction* DynamicShapeRemovingVisitor::ConvertToDynamic(
     }
     return comp->AddInstruction(HloInstruction::CreateTuple(dynamic_operands));
   } else {
+    // Ops with a dynamic lowering already produce the dynamic form.
+    if (shape.is_dynamic()) {
+      return inst;
+    }
     // Collect the data input, as well as dimension sizes, and feed them to
     // slice to dynamic to create a dynamic tensor.
     Shape output_shape = shape;  // 0th element.
-    CHECK(output_shape.is_static());
     std::vector<HloInstruction*> slice_operand;
     slice_operand.push_back(inst);
     for (int64 i = 0; i < output_shape.dimensions_size(); ++i) {
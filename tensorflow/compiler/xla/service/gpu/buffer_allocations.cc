@@ -44,6 +44,10 @@ Status BufferAllocations::TearDown(
     se::DeviceMemoryBase buffer_address = GetDeviceAddress(allocation.index());
     // Deallocate buffers marked "maybe_live_out" but aren't actually live out,
     // and temp buffers.
+    // The host buffers are owned by the executable.
+    if (allocation.color() == kHostMemorySpace) {
+      continue;
+    }
     if ((allocation.maybe_live_out() &&
          !live_addresses.count(buffer_address)) ||
         allocation.IsPreallocatedTempBuffer()) {
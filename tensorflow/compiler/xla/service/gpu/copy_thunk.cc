@@ -56,5 +56,64 @@ Status DeviceToDeviceCopyThunk::ExecuteOnStream(const ExecuteParams& params) {
   params.stream->ThenMemcpy(&destination_data, source_data, mem_size_);
   return Status::OK();
 }
+
+AsyncCopyStartThunk::AsyncCopyStartThunk(
+    ThunkInfo thunk_info, const BufferAllocation::Slice& source_buffer,
+    const BufferAllocation::Slice& destination_buffer, uint64 mem_size,
+    bool device_to_host)
+    : Thunk(Kind::kAsyncCopyStart, thunk_info),
+      source_buffer_(source_buffer),
+      destination_buffer_(destination_buffer),
+      mem_size_(mem_size),
+      device_to_host_(device_to_host) {}
+
+Status AsyncCopyStartThunk::ExecuteOnStream(const ExecuteParams& params) {
+  se::Stream& async_stream = *params.async_comms_stream;
+  // The source may have just been written, and the destination may still be
+  // read by the buffer it was reused from.
+  async_stream.ThenWaitFor(params.stream);
+
+  se::DeviceMemoryBase destination_data =
+      params.buffer_allocations->GetDeviceAddress(destination_buffer_);
+  se::DeviceMemoryBase source_data =
+      params.buffer_allocations->GetDeviceAddress(source_buffer_);
+  if (device_to_host_) {
+    async_stream.ThenMemcpy(destination_data.opaque(), source_data, mem_size_);
+  } else {
+    async_stream.ThenMemcpy(&destination_data, source_data.opaque(),
+                            mem_size_);
+  }
+
+  se::Event done_event(async_stream.parent());
+  TF_RET_CHECK(done_event.Init());
+  async_stream.ThenRecordEvent(&done_event);
+  int device_ordinal = async_stream.parent()->device_ordinal();
+  absl::MutexLock lock(&mu_);
+  auto result = done_events_.emplace(device_ordinal, std::move(done_event));
+  TF_RET_CHECK(result.second) << "done event has not been consumed";
+  return Status::OK();
+}
+
+StatusOr<se::Event> AsyncCopyStartThunk::TakeDoneEvent(int device_ordinal) {
+  absl::MutexLock lock(&mu_);
+  auto it = done_events_.find(device_ordinal);
+  TF_RET_CHECK(it != done_events_.end()) << "done event not found";
+  se::Event done_event = std::move(it->second);
+  done_events_.erase(it);
+  return done_event;
+}
+
+AsyncCopyDoneThunk::AsyncCopyDoneThunk(ThunkInfo thunk_info,
+                                       AsyncCopyStartThunk& start_thunk)
+    : Thunk(Kind::kAsyncCopyDone, thunk_info), start_thunk_(start_thunk) {}
+
+Status AsyncCopyDoneThunk::ExecuteOnStream(const ExecuteParams& params) {
+  int device_ordinal = params.stream->parent()->device_ordinal();
+  TF_ASSIGN_OR_RETURN(se::Event done_event,
+                      start_thunk_.TakeDoneEvent(device_ordinal));
+  params.stream->ThenWaitFor(&done_event);
+  return Status::OK();
+}
+
 }  // namespace gpu
 }  // namespace xla
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_COPY_THUNK_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_COPY_THUNK_H_
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
 #include "tensorflow/compiler/xla/service/gpu/hlo_execution_profiler.h"
@@ -70,6 +73,50 @@ class DeviceToDeviceCopyThunk : public Thunk {
   const uint64 mem_size_;
 };
 
+// A thunk that starts copying data between a device buffer and a host buffer
+// on the async stream, once the work enqueued so far on the compute stream is
+// done.  The compute stream keeps going; it only waits for the copy at the
+// paired AsyncCopyDoneThunk.
+class AsyncCopyStartThunk : public Thunk {
+ public:
+  // Copies `mem_size` bytes from `source_buffer` to `destination_buffer`.  The
+  // source is in host memory, or the destination is if `device_to_host`.
+  AsyncCopyStartThunk(ThunkInfo thunk_info,
+                      const BufferAllocation::Slice& source_buffer,
+                      const BufferAllocation::Slice& destination_buffer,
+                      uint64 mem_size, bool device_to_host);
+
+  AsyncCopyStartThunk(const AsyncCopyStartThunk&) = delete;
+  AsyncCopyStartThunk& operator=(const AsyncCopyStartThunk&) = delete;
+
+  Status ExecuteOnStream(const ExecuteParams& params) override;
+
+  // Returns the event recorded after the copy started on `device_ordinal`.
+  StatusOr<se::Event> TakeDoneEvent(int device_ordinal)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  const BufferAllocation::Slice source_buffer_;
+  const BufferAllocation::Slice destination_buffer_;
+  const uint64 mem_size_;
+  const bool device_to_host_;
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<int, se::Event> done_events_ ABSL_GUARDED_BY(mu_);
+};
+
+// A thunk that makes the compute stream wait for the copy started by an
+// AsyncCopyStartThunk.
+class AsyncCopyDoneThunk : public Thunk {
+ public:
+  AsyncCopyDoneThunk(ThunkInfo thunk_info, AsyncCopyStartThunk& start_thunk);
+
+  Status ExecuteOnStream(const ExecuteParams& params) override;
+
+ private:
+  AsyncCopyStartThunk& start_thunk_;
+};
+
 }  // namespace gpu
 }  // namespace xla
 
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/buffer_comparator.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/gpu/persistent_autotune_cache.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
@@ -243,10 +244,39 @@ static StatusOr<absl::optional<se::blas::AlgorithmType>> DoGemmAutotune(
   cache_misses++;
   VLOG(4) << "Autotuning cache miss";
 
+  const DebugOptions& debug_options =
+      instr->GetModule()->config().debug_options();
+  PersistentAutotuneCache* persistent_cache = PersistentAutotuneCache::Get(
+      debug_options.xla_gpu_autotune_results_path());
+  AutotuneResultsEntry persistent_key;
+  if (persistent_cache != nullptr) {
+    auto options = HloPrintOptions::Canonical();
+    options.set_print_backend_config(true);
+    persistent_key = PersistentAutotuneCache::MakeKey(stream->parent(),
+                                                      instr->ToString(options));
+    absl::optional<AutotuneResult> persistent_result =
+        persistent_cache->Lookup(persistent_key);
+    if (persistent_result.has_value() && persistent_result->has_gemm()) {
+      VLOG(4) << "Persistent autotuning cache hit, using algorithm: "
+              << persistent_result->gemm().algorithm();
+      absl::optional<se::blas::AlgorithmType> result =
+          persistent_result->gemm().algorithm();
+      CHECK(autotune_cache.emplace(key, result).second);
+      return result;
+    }
+  }
+
   TF_ASSIGN_OR_RETURN(absl::optional<se::blas::AlgorithmType> result,
                       DoUncachedGemmAutotune(instr, stream, allocator));
 
   CHECK(autotune_cache.emplace(key, result).second);
+  // Failures to find an algorithm may be transient, so only successful results
+  // are shared with other processes.
+  if (persistent_cache != nullptr && result.has_value()) {
+    AutotuneResult persistent_result;
+    persistent_result.mutable_gemm()->set_algorithm(*result);
+    persistent_cache->Insert(persistent_key, persistent_result);
+  }
   return result;
 }
 
@@ -24,7 +24,6 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
-#include "llvm/AsmParser/Parser.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/DiagnosticInfo.h"
@@ -90,6 +89,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/nccl_all_gather_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/reduction_degenerate_dim_remover.h"
 #include "tensorflow/compiler/xla/service/gpu/reduction_dimension_grouper.h"
+#include "tensorflow/compiler/xla/service/gpu/reduction_gemv_rewriter.h"
 #include "tensorflow/compiler/xla/service/gpu/reduction_layout_normalizer.h"
 #include "tensorflow/compiler/xla/service/gpu/reduction_splitter.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
@@ -142,6 +142,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/regexp.h"
@@ -575,6 +576,13 @@ Status GpuCompiler::OptimizeHloPostLayoutAssignment(
                                            : TransposeFolding::OperandIndices{};
       },
       TransposeFolding::NeverFoldTranspose);
+  // Narrow column reductions are faster as cuBLAS GEMVs. This must run after
+  // the last algebraic simplification, which strength-reduces them back.
+  if (hlo_module->config()
+          .debug_options()
+          .xla_gpu_rewrite_column_reductions_as_gemv()) {
+    pipeline.AddPass<ReductionGemvRewriter>();
+  }
   // Rewrite GEMMs into custom calls.
   pipeline.AddPass<GemmRewriter>();
 
@@ -884,8 +892,12 @@ GpuCompiler::CompileToTargetBinary(const HloModuleConfig& module_config,
 
   tensorflow::thread::ThreadPool* thread_pool;
   absl::optional<tensorflow::thread::ThreadPool> overriding_thread_pool;
-  switch (
-      module_config.debug_options().xla_gpu_force_compilation_parallelism()) {
+  int parallelism =
+      module_config.debug_options().xla_gpu_force_compilation_parallelism();
+  if (parallelism < 0) {
+    parallelism = tensorflow::port::MaxParallelism();
+  }
+  switch (parallelism) {
     case 0:
       thread_pool = options.thread_pool;
       break;
@@ -893,10 +905,8 @@ GpuCompiler::CompileToTargetBinary(const HloModuleConfig& module_config,
       thread_pool = nullptr;
       break;
     default:
-      overriding_thread_pool.emplace(
-          tensorflow::Env::Default(), "",
-          module_config.debug_options()
-              .xla_gpu_force_compilation_parallelism());
+      overriding_thread_pool.emplace(tensorflow::Env::Default(), "",
+                                     parallelism);
       thread_pool = &*overriding_thread_pool;
       break;
   }
@@ -931,38 +941,36 @@ GpuCompiler::CompileToTargetBinary(const HloModuleConfig& module_config,
       },
       /*PreserveLocals=*/true);
 
-  std::vector<StatusOr<BackendCompileResult>> compile_results(
-      llvm_modules.size());
-  tensorflow::BlockingCounter counter(llvm_modules.size());
+  // Each thread compiles its partition in its own context to avoid race
+  // conditions.  The partitions are moved there as bitcode, which is much
+  // cheaper to write and read back than textual IR for large modules.  All of
+  // them are written here, since they still share the context of the module.
+  std::vector<std::string> bitcodes(llvm_modules.size());
   for (int i = 0; i < llvm_modules.size(); i++) {
+    llvm::raw_string_ostream os(bitcodes[i]);
+    llvm::WriteBitcodeToFile(*llvm_modules[i], os);
+    os.flush();
+  }
+  llvm_modules.clear();
+
+  std::vector<StatusOr<BackendCompileResult>> compile_results(bitcodes.size());
+  tensorflow::BlockingCounter counter(bitcodes.size());
+  for (int i = 0; i < bitcodes.size(); i++) {
     thread_pool->Schedule(
-        [&compile_results, compile_single_module, i, &llvm_modules, &counter] {
-          llvm::Module* original_module = llvm_modules[i].get();
+        [&compile_results, compile_single_module, i, &bitcodes, &counter] {
           llvm::LLVMContext context;
-          std::string buffer;
-          llvm::raw_string_ostream error(buffer);
-
-          std::unique_ptr<llvm::Module> new_llvm_module;
-          // Switch to a new context by dumping and re-parsing LLVM IR. Each
-          // thread has its own context to avoid race conditions.
-          {
-            std::string ir;
-            {
-              llvm::raw_string_ostream os(ir);
-              original_module->print(os, nullptr);
-            }
-            llvm::SMDiagnostic err;
-            new_llvm_module = llvm::parseAssemblyString(ir, err, context);
-            if (!new_llvm_module) {
-              std::string err_string;
-              llvm::raw_string_ostream os(err_string);
-              err.print(/*ProgName=*/nullptr, os, /*ShowColors=*/false);
-              LOG(FATAL) << "Failed to parse IR: " << err_string;
-            }
+          llvm::Expected<std::unique_ptr<llvm::Module>> new_llvm_module =
+              llvm::parseBitcodeFile(
+                  llvm::MemoryBufferRef(bitcodes[i], "partition"), context);
+          if (new_llvm_module) {
+            compile_results[i] = compile_single_module(
+                new_llvm_module->get(), /*relocatable=*/true,
+                /*shard_number=*/i);
+          } else {
+            compile_results[i] = InternalError(
+                "Failed to read back partition %d of the LLVM module: %s", i,
+                llvm::toString(new_llvm_module.takeError()));
           }
-
-          compile_results[i] = compile_single_module(
-              new_llvm_module.get(), /*relocatable=*/true, /*shard_number=*/i);
           counter.DecrementCount();
         });
   }
@@ -983,11 +991,15 @@ GpuCompiler::CompileToTargetBinary(const HloModuleConfig& module_config,
   auto maybe_backend_result =
       this->LinkModules(stream_exec, std::move(submodule_compile_results));
   if (!maybe_backend_result.ok()) {
-    LOG(ERROR) << "The CUDA linking API did not work. Please use "
-                  "XLA_FLAGS=--xla_gpu_force_compilation_parallelism=1 to "
-                  "bypass it, but expect to get longer compilation time due to "
-                  "the lack of multi-threading.";
-    return maybe_backend_result.status();
+    // SplitModule left the module untouched, so it can still be compiled as a
+    // whole.
+    LOG(WARNING) << "The CUDA linking API did not work ("
+                 << maybe_backend_result.status()
+                 << "), compiling the module on a single thread instead. Use "
+                    "XLA_FLAGS=--xla_gpu_force_compilation_parallelism=1 to "
+                    "skip the parallel attempt.";
+    return compile_single_module(llvm_module.get(), /*relocatable=*/false,
+                                 /*shard_number=*/absl::nullopt);
   }
 
   return std::make_pair(ptx_snippets, std::move(*maybe_backend_result));
@@ -1153,7 +1165,12 @@ static Status GetMlirAllocationInfo(mlir::FuncOp func,
     TF_ASSIGN_OR_RETURN(auto element_type_bytes,
                         GetElementTypeBytes(type.getElementType()));
     size_t size = type.getNumElements() * element_type_bytes;
-    allocations->emplace_back(i, size, 0);
+    LogicalBuffer::Color color = 0;
+    if (auto memory_space_attr =
+            func.getArgAttrOfType<mlir::IntegerAttr>(i, "lmhlo.memory_space")) {
+      color = memory_space_attr.getInt();
+    }
+    allocations->emplace_back(i, size, color);
   }
 
   for (int i = 0; i < func.getNumArguments(); i++) {
@@ -1162,6 +1179,7 @@ static Status GetMlirAllocationInfo(mlir::FuncOp func,
                    attr.first == "lmhlo.param_shape_index" ||
                    attr.first == "lmhlo.constant_name" ||
                    attr.first == "lmhlo.must_alias" ||
+                   attr.first == "lmhlo.memory_space" ||
                    attr.first == "lmhlo.output_index");
     }
   }
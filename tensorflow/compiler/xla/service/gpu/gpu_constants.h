@@ -31,6 +31,10 @@ extern const int64 kXlaAllocatedBufferAlignBytes;
 // Minimum alignment for constant buffers.
 extern const int64 kConstantBufferAlignBytes;
 
+// Memory space, and buffer color, of the pinned host buffers that hold the
+// activations offloaded by HostOffloader.
+extern const int64 kHostMemorySpace;
+
 }  // namespace gpu
 }  // namespace xla
 
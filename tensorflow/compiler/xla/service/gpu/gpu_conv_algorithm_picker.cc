@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/hlo_algorithm_denylist.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/gpu/persistent_autotune_cache.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_executor_util.h"
 #include "tensorflow/compiler/xla/service/hlo_casting_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_instructions.h"
@@ -299,6 +300,22 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
     autotune_cache_stats.cache_misses++;
   }
 
+  const DebugOptions& debug_options =
+      instr->GetModule()->config().debug_options();
+  PersistentAutotuneCache* persistent_cache = PersistentAutotuneCache::Get(
+      debug_options.xla_gpu_autotune_results_path());
+  AutotuneResultsEntry persistent_key;
+  if (persistent_cache != nullptr) {
+    persistent_key =
+        PersistentAutotuneCache::MakeKey(stream_exec_, std::get<1>(key));
+    if (absl::optional<AutotuneResult> result =
+            persistent_cache->Lookup(persistent_key)) {
+      tensorflow::mutex_lock lock(autotune_cache_lock);
+      CHECK(autotune_cache.insert({key, *result}).second);
+      return *std::move(result);
+    }
+  }
+
   // Make sure any previous activity on this executor is done. We don't want to
   // interfere with programs that are still running on the GPU.
   if (!stream_exec_->SynchronizeAllActivity()) {
@@ -334,6 +351,9 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
     tensorflow::mutex_lock lock(autotune_cache_lock);
     CHECK(autotune_cache.insert({key, result_or.ValueOrDie()}).second);
   }
+  if (result_or.ok() && persistent_cache != nullptr) {
+    persistent_cache->Insert(persistent_key, result_or.ValueOrDie());
+  }
   return result_or;
 }
 
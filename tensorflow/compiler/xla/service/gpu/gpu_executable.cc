@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/map_util.h"
@@ -27,6 +28,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable_run_options.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_types.h"
 #include "tensorflow/compiler/xla/service/gpu/hlo_execution_profiler.h"
+#include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/buffer_assignment_util.h"
 #include "tensorflow/compiler/xla/service/logical_buffer.h"
@@ -52,6 +54,8 @@ using ::tensorflow::profiler::ScopedAnnotation;
 
 bool NeedsAsyncCommsStream(Thunk& thunk) {
   switch (thunk.kind()) {
+    case Thunk::Kind::kAsyncCopyDone:
+    case Thunk::Kind::kAsyncCopyStart:
     case Thunk::Kind::kNcclAllReduceStart:
     case Thunk::Kind::kNcclAllReduceDone:
       return true;
@@ -60,6 +64,42 @@ bool NeedsAsyncCommsStream(Thunk& thunk) {
   }
 }
 
+// Returns whether `thunk` only enqueues device work, in the same way on every
+// run, so that it can be captured into a graph and replayed.
+bool CanCaptureThunk(const Thunk& thunk) {
+  switch (thunk.kind()) {
+    case Thunk::Kind::kConvolution:
+    case Thunk::Kind::kCopy:
+    case Thunk::Kind::kGemm:
+    case Thunk::Kind::kKernel:
+    case Thunk::Kind::kMemset32BitValue:
+    case Thunk::Kind::kMemzero:
+      return true;
+    case Thunk::Kind::kSequential:
+      return absl::c_all_of(
+          static_cast<const SequentialThunk&>(thunk).thunks(),
+          [](const std::unique_ptr<Thunk>& t) { return CanCaptureThunk(*t); });
+    default:
+      // Control flow, collectives, host transfers and custom calls may enqueue
+      // different work on every run, or synchronize with the host.
+      return false;
+  }
+}
+
+bool CanCaptureThunks(const ThunkSchedule& thunk_schedule,
+                      const HloModule& module) {
+  if (thunk_schedule.StreamCount() != 1) return false;
+  // The sizes of dynamic shapes are only known at run time.
+  const HloComputation* entry = module.entry_computation();
+  if (entry->root_instruction()->shape().is_dynamic()) return false;
+  for (const HloInstruction* parameter : entry->parameter_instructions()) {
+    if (parameter->shape().is_dynamic()) return false;
+  }
+  return absl::c_all_of(
+      thunk_schedule.TotalOrder(),
+      [](const std::unique_ptr<Thunk>& t) { return CanCaptureThunk(*t); });
+}
+
 }  // namespace
 
 // Implementation note: HLO profiling is always enabled for GPU executables,
@@ -81,6 +121,12 @@ GpuExecutable::GpuExecutable(GpuExecutable::Params params)
       output_info_(std::move(params.output_info)) {
   XlaDebugInfoManager::Get()->RegisterModule(module_name_, shared_module(),
                                              debug_buffer_assignment_);
+  if (has_module() &&
+      module().config().debug_options().xla_gpu_enable_cuda_graphs()) {
+    use_graphs_ = CanCaptureThunks(*thunk_schedule_, module());
+    VLOG(1) << (use_graphs_ ? "Capturing" : "Not capturing")
+            << " the thunks of " << module_name_ << " into CUDA graphs";
+  }
 }
 
 GpuExecutable::~GpuExecutable() {
@@ -99,6 +145,14 @@ GpuExecutable::~GpuExecutable() {
       CHECK(pair.first->SynchronizeAllActivity());
     }
   }
+
+  tensorflow::mutex_lock lock(host_buffer_pool_->mutex);
+  for (auto& entry : host_buffer_pool_->free_buffers) {
+    for (void* buffer : entry.second) {
+      entry.first.first->HostMemoryDeallocate(buffer);
+    }
+  }
+  host_buffer_pool_->free_buffers.clear();
 }
 
 Status GpuExecutable::CheckCompatibilityWithServiceExecutableRunOptions(
@@ -174,49 +228,98 @@ Status GpuExecutable::ExecuteThunks(
   absl::flat_hash_map<const Thunk*, std::unique_ptr<se::Event>>
       thunk_to_finish_event;
   std::vector<std::function<void()>> deferred_host_callbacks;
-  for (const std::unique_ptr<Thunk>& thunk : thunk_schedule_->TotalOrder()) {
-    // Annotate execution of this op if tracing was enabled when we started
-    // running this module.  If tracing is enabled *while* we're running the
-    // module, we won't get any data, but that's probably an OK trade-off.
-    ScopedAnnotation annotation([&] { return thunk->profile_annotation(); });
+  // Timers of the profiler flush launch batches, so batching only pays off
+  // when not profiling.
+  const bool batch_launches =
+      !do_profile &&
+      module().config().debug_options().xla_gpu_batch_kernel_launches();
+  auto end_launch_batch = [](se::Stream* stream) -> Status {
+    if (!stream->in_launch_batch()) {
+      return Status::OK();
+    }
+    return stream->EndLaunchBatch();
+  };
+  auto end_launch_batches = [&]() -> Status {
+    TF_RETURN_IF_ERROR(end_launch_batch(main_stream));
+    for (const auto& sub_stream : sub_streams) {
+      TF_RETURN_IF_ERROR(end_launch_batch(sub_stream.get()));
+    }
+    return Status::OK();
+  };
+  auto run_thunks = [&]() -> Status {
+    // Do not leave the streams deferring launches if a thunk fails.
+    auto batch_cleanup = MakeCleanup([&]() {
+      if (batch_launches) end_launch_batches().IgnoreError();
+    });
+    for (const std::unique_ptr<Thunk>& thunk : thunk_schedule_->TotalOrder()) {
+      // Annotate execution of this op if tracing was enabled when we started
+      // running this module.  If tracing is enabled *while* we're running the
+      // module, we won't get any data, but that's probably an OK trade-off.
+      ScopedAnnotation annotation([&] { return thunk->profile_annotation(); });
+
+      int32 stream_no = thunk_schedule_->StreamNumberForThunk(thunk.get());
+      se::Stream* stream =
+          (stream_no == 0 ? main_stream : sub_streams[stream_no - 1].get());
+
+      if (batch_launches) {
+        // Only kernel thunks enqueue nothing but launches; any other thunk
+        // issues the launches deferred so far before running.
+        if (thunk->kind() == Thunk::kKernel) {
+          if (!stream->in_launch_batch()) stream->BeginLaunchBatch();
+        } else {
+          TF_RETURN_IF_ERROR(end_launch_batch(stream));
+        }
+      }
 
-    int32 stream_no = thunk_schedule_->StreamNumberForThunk(thunk.get());
-    se::Stream* stream =
-        (stream_no == 0 ? main_stream : sub_streams[stream_no - 1].get());
+      for (const Thunk* dependency : thunk_schedule_->DependsOn(thunk.get())) {
+        stream->ThenWaitFor(FindOrDie(thunk_to_finish_event, dependency).get());
+      }
 
-    for (const Thunk* dependency : thunk_schedule_->DependsOn(thunk.get())) {
-      stream->ThenWaitFor(FindOrDie(thunk_to_finish_event, dependency).get());
+      VLOG(2) << "Executing the thunk for " << thunk->profile_annotation()
+              << " on stream " << stream_no;
+
+      TF_RET_CHECK(async_comms_stream.ok() || !NeedsAsyncCommsStream(*thunk))
+          << "`run_options` must have a stream borrower for async thunks.";
+
+      const GpuExecutableRunOptions* gpu_options =
+          run_options->run_options().gpu_executable_run_options();
+      Thunk::ExecuteParams thunk_params{
+          &buffer_allocations,
+          stream,
+          async_comms_stream.ok() ? async_comms_stream->get() : nullptr,
+          run_options->run_options().run_id(),
+          &profiler,
+          run_options->run_options().device_assignment(),
+          &deferred_host_callbacks,
+          gpu_options && gpu_options->gpu_global_device_ids()
+              ? &*gpu_options->gpu_global_device_ids()
+              : nullptr,
+          gpu_options && gpu_options->nccl_unique_id_callback()
+              ? &gpu_options->nccl_unique_id_callback()
+              : nullptr};
+      TF_RETURN_IF_ERROR(thunk->ExecuteOnStream(thunk_params));
+      if (thunk_schedule_->Depended(thunk.get())) {
+        auto finish_event = absl::make_unique<se::Event>(main_stream->parent());
+        finish_event->Init();
+        stream->ThenRecordEvent(finish_event.get());
+        thunk_to_finish_event[thunk.get()] = std::move(finish_event);
+      }
     }
-
-    VLOG(2) << "Executing the thunk for " << thunk->profile_annotation()
-            << " on stream " << stream_no;
-
-    TF_RET_CHECK(async_comms_stream.ok() || !NeedsAsyncCommsStream(*thunk))
-        << "`run_options` must have a stream borrower for async thunks.";
-
-    const GpuExecutableRunOptions* gpu_options =
-        run_options->run_options().gpu_executable_run_options();
-    Thunk::ExecuteParams thunk_params{
-        &buffer_allocations,
-        stream,
-        async_comms_stream.ok() ? async_comms_stream->get() : nullptr,
-        run_options->run_options().run_id(),
-        &profiler,
-        run_options->run_options().device_assignment(),
-        &deferred_host_callbacks,
-        gpu_options && gpu_options->gpu_global_device_ids()
-            ? &*gpu_options->gpu_global_device_ids()
-            : nullptr,
-        gpu_options && gpu_options->nccl_unique_id_callback()
-            ? &gpu_options->nccl_unique_id_callback()
-            : nullptr};
-    TF_RETURN_IF_ERROR(thunk->ExecuteOnStream(thunk_params));
-    if (thunk_schedule_->Depended(thunk.get())) {
-      auto finish_event = absl::make_unique<se::Event>(main_stream->parent());
-      finish_event->Init();
-      stream->ThenRecordEvent(finish_event.get());
-      thunk_to_finish_event[thunk.get()] = std::move(finish_event);
+    if (batch_launches) {
+      TF_RETURN_IF_ERROR(end_launch_batches());
     }
+    return Status::OK();
+  };
+
+  bool launched_graph = false;
+  if (use_graphs_ && !do_profile) {
+    TF_ASSIGN_OR_RETURN(
+        launched_graph,
+        ExecuteThunksWithGraph(main_stream, buffer_allocations, run_thunks,
+                               &deferred_host_callbacks));
+  }
+  if (!launched_graph) {
+    TF_RETURN_IF_ERROR(run_thunks());
   }
 
   main_stream->ThenWaitFor(&sub_streams);
@@ -399,6 +502,12 @@ StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
   buffers.reserve(num_buffers);
   for (int64 i = 0; i < num_buffers; ++i) {
     const BufferAllocation& allocation = allocations_[i];
+    if (allocation.color() == kHostMemorySpace) {
+      TF_ASSIGN_OR_RETURN(se::DeviceMemoryBase buffer,
+                          AcquireHostBuffer(executor, allocation));
+      buffers.push_back(buffer);
+      continue;
+    }
     TF_ASSIGN_OR_RETURN(
         se::DeviceMemoryBase buffer,
         BufferForAllocation(arguments, globals, allocation, memory_allocator,
@@ -409,6 +518,53 @@ StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
   return {{buffers, executor->device_ordinal(), memory_allocator}};
 }
 
+StatusOr<se::DeviceMemoryBase> GpuExecutable::AcquireHostBuffer(
+    se::StreamExecutor* executor, const BufferAllocation& allocation) {
+  {
+    tensorflow::mutex_lock lock(host_buffer_pool_->mutex);
+    std::vector<void*>& free_buffers =
+        host_buffer_pool_->free_buffers[{executor, allocation.index()}];
+    if (!free_buffers.empty()) {
+      void* buffer = free_buffers.back();
+      free_buffers.pop_back();
+      return se::DeviceMemoryBase(buffer, allocation.size());
+    }
+  }
+  // Pinning the memory lets the async copies run without blocking the host.
+  void* buffer = executor->HostMemoryAllocate(allocation.size());
+  if (buffer == nullptr) {
+    return ResourceExhausted(
+        "Failed to allocate %d bytes of pinned host memory for allocation %d",
+        allocation.size(), allocation.index());
+  }
+  return se::DeviceMemoryBase(buffer, allocation.size());
+}
+
+void GpuExecutable::ReleaseHostBuffers(
+    se::Stream* stream, const BufferAllocations& buffer_allocations) {
+  std::vector<std::pair<BufferAllocation::Index, void*>> buffers;
+  for (const BufferAllocation& allocation : allocations_) {
+    if (allocation.color() == kHostMemorySpace) {
+      buffers.emplace_back(
+          allocation.index(),
+          buffer_allocations.GetDeviceAddress(allocation.index()).opaque());
+    }
+  }
+  if (buffers.empty()) {
+    return;
+  }
+  // Host callbacks must not call into the driver, so the buffers are only
+  // deallocated with the executable.
+  stream->ThenDoHostCallback([pool = host_buffer_pool_,
+                              executor = stream->parent(),
+                              buffers = std::move(buffers)]() {
+    tensorflow::mutex_lock lock(pool->mutex);
+    for (const auto& buffer : buffers) {
+      pool->free_buffers[{executor, buffer.first}].push_back(buffer.second);
+    }
+  });
+}
+
 StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStream(
     const ServiceExecutableRunOptions* run_options,
     std::vector<ExecutionInput> arguments,
@@ -570,6 +726,7 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
   TF_RETURN_IF_ERROR(ExecuteThunks(run_options, buffer_allocations,
                                    block_host_until_done,
                                    hlo_execution_profile));
+  ReleaseHostBuffers(run_options->stream(), buffer_allocations);
 
   // Free all temporary allocations.
   TF_RETURN_IF_ERROR(
@@ -582,6 +739,56 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
   return std::move(result);
 }
 
+StatusOr<bool> GpuExecutable::ExecuteThunksWithGraph(
+    se::Stream* stream, const BufferAllocations& buffer_allocations,
+    const std::function<Status()>& run_thunks,
+    std::vector<std::function<void()>>* deferred_host_callbacks) {
+  std::vector<const void*> buffer_addresses(buffer_allocations.size());
+  for (int i = 0; i < buffer_allocations.size(); ++i) {
+    buffer_addresses[i] = buffer_allocations.GetDeviceAddress(i).opaque();
+  }
+
+  // Concurrent runs are serialized, since a thread can't capture the work of
+  // other threads.
+  tensorflow::mutex_lock lock(graph_mutex_);
+  if (graph_capture_failed_) return false;
+  CapturedGraph& captured = graphs_[stream->parent()];
+  if (captured.graph == nullptr ||
+      captured.buffer_addresses != buffer_addresses) {
+    VLOG(2) << "Capturing the thunks of " << module_name_
+            << " into a CUDA graph";
+    std::unique_ptr<GpuGraph> graph;
+    Status status = GpuGraph::BeginCapture(stream);
+    if (status.ok()) {
+      status = run_thunks();
+      StatusOr<std::unique_ptr<GpuGraph>> end_status =
+          GpuGraph::EndCapture(stream);
+      if (status.ok()) status = end_status.status();
+      if (status.ok()) graph = std::move(end_status).ValueOrDie();
+    }
+    // Host callbacks are not part of the graph, so replaying it would skip
+    // them.
+    if (status.ok() && !deferred_host_callbacks->empty()) {
+      status = Unimplemented("The thunks enqueue host callbacks");
+    }
+    if (!status.ok()) {
+      // Nothing captured was executed, so the thunks can still be launched
+      // one by one.
+      LOG(WARNING) << "Failed to capture the thunks of " << module_name_
+                   << " into a CUDA graph, launching them one by one: "
+                   << status;
+      deferred_host_callbacks->clear();
+      graph_capture_failed_ = true;
+      graphs_.clear();
+      return false;
+    }
+    captured.buffer_addresses = std::move(buffer_addresses);
+    captured.graph = std::move(graph);
+  }
+  TF_RETURN_IF_ERROR(captured.graph->Launch(stream));
+  return true;
+}
+
 int64 GpuExecutable::SizeOfGeneratedCodeInBytes() const {
   // Non-empty PTX but empty cubin: compilation must have failed, return
   // "unknown".
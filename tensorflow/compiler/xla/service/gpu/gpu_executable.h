@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_EXECUTABLE_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_EXECUTABLE_H_
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/executable.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_graph.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_types.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/thunk.h"
@@ -142,6 +145,15 @@ class GpuExecutable : public Executable {
                        bool block_host_until_done,
                        HloExecutionProfile* hlo_execution_profile);
 
+  // Launches the graph captured from the thunks on `stream` if it was captured
+  // with the same buffer addresses, and otherwise captures `run_thunks`, which
+  // enqueues the thunks on `stream`, into a new graph and launches it.
+  // Returns false, with nothing enqueued, if the thunks can't be captured.
+  StatusOr<bool> ExecuteThunksWithGraph(
+      se::Stream* stream, const BufferAllocations& buffer_allocations,
+      const std::function<Status()>& run_thunks,
+      std::vector<std::function<void()>>* deferred_host_callbacks);
+
   using BufferAllocToDeviceMemoryMap =
       absl::flat_hash_map<BufferAllocation::Index, se::DeviceMemoryBase>;
 
@@ -169,6 +181,16 @@ class GpuExecutable : public Executable {
       se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal,
       int64 arg_idx);
 
+  // Returns a pinned host buffer for `allocation`, which is in
+  // kHostMemorySpace.
+  StatusOr<se::DeviceMemoryBase> AcquireHostBuffer(
+      se::StreamExecutor* executor, const BufferAllocation& allocation);
+
+  // Makes the host buffers of `buffer_allocations` available to later runs
+  // once the work enqueued on `stream` is done.
+  void ReleaseHostBuffers(se::Stream* stream,
+                          const BufferAllocations& buffer_allocations);
+
   // The LLVM IR, in string format, of the unoptimized module generated for
   // this GpuExecutable. We save a string instead of an llvm::Module* because
   // leaving llvm::Module* in a singleton can cause the heap checker to emit
@@ -216,6 +238,35 @@ class GpuExecutable : public Executable {
   std::vector<ConstantInfo> constants_;
   const absl::flat_hash_map<ShapeIndex, OutputInfo> output_info_;
 
+  // Whether the thunks are captured into graphs, see
+  // DebugOptions::xla_gpu_enable_cuda_graphs.
+  bool use_graphs_ = false;
+
+  // The last graph captured for each executor, and the buffer addresses it
+  // was captured with.
+  struct CapturedGraph {
+    std::vector<const void*> buffer_addresses;
+    std::unique_ptr<GpuGraph> graph;
+  };
+  tensorflow::mutex graph_mutex_;
+  std::map<stream_executor::StreamExecutor*, CapturedGraph> graphs_
+      TF_GUARDED_BY(graph_mutex_);
+  // Set once capturing failed, after which the thunks are always launched one
+  // by one.
+  bool graph_capture_failed_ TF_GUARDED_BY(graph_mutex_) = false;
+
+  // The pinned host buffers of the allocations in kHostMemorySpace that no run
+  // is using, by executor and allocation.  Shared with the host callbacks that
+  // return the buffers.
+  struct HostBufferPool {
+    tensorflow::mutex mutex;
+    std::map<std::pair<se::StreamExecutor*, BufferAllocation::Index>,
+             std::vector<void*>>
+        free_buffers TF_GUARDED_BY(mutex);
+  };
+  std::shared_ptr<HostBufferPool> host_buffer_pool_ =
+      std::make_shared<HostBufferPool>();
+
   TF_DISALLOW_COPY_AND_ASSIGN(GpuExecutable);
 };
 
@@ -0,0 +1,93 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_graph.h"
+
+#include "tensorflow/compiler/xla/util.h"
+
+#if GOOGLE_CUDA
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
+#include "tensorflow/stream_executor/gpu/gpu_executor.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
+#endif  // GOOGLE_CUDA
+
+namespace xla {
+namespace gpu {
+
+#if GOOGLE_CUDA
+
+namespace {
+
+se::gpu::GpuContext* GetContext(se::StreamExecutor* executor) {
+  return se::gpu::ExtractGpuExecutor(executor)->gpu_context();
+}
+
+}  // namespace
+
+/*static*/ Status GpuGraph::BeginCapture(se::Stream* stream) {
+  return se::gpu::GpuDriver::StreamBeginCapture(
+      GetContext(stream->parent()), se::gpu::AsGpuStreamValue(stream));
+}
+
+/*static*/ StatusOr<std::unique_ptr<GpuGraph>> GpuGraph::EndCapture(
+    se::Stream* stream) {
+  se::gpu::GpuContext* context = GetContext(stream->parent());
+  se::gpu::GpuGraphHandle graph = nullptr;
+  TF_RETURN_IF_ERROR(se::gpu::GpuDriver::StreamEndCapture(
+      context, se::gpu::AsGpuStreamValue(stream), &graph));
+  se::gpu::GpuGraphExecHandle graph_exec = nullptr;
+  Status status =
+      se::gpu::GpuDriver::GraphInstantiate(context, graph, &graph_exec);
+  // The executable graph does not refer to the graph it was created from.
+  se::gpu::GpuDriver::DestroyGraph(context, graph);
+  TF_RETURN_IF_ERROR(status);
+  return std::unique_ptr<GpuGraph>(new GpuGraph(stream->parent(), graph_exec));
+}
+
+GpuGraph::~GpuGraph() {
+  se::gpu::GpuDriver::DestroyGraphExec(
+      GetContext(executor_),
+      static_cast<se::gpu::GpuGraphExecHandle>(graph_exec_));
+}
+
+Status GpuGraph::Launch(se::Stream* stream) {
+  TF_RET_CHECK(stream->parent() == executor_);
+  return se::gpu::GpuDriver::GraphLaunch(
+      GetContext(executor_),
+      static_cast<se::gpu::GpuGraphExecHandle>(graph_exec_),
+      se::gpu::AsGpuStreamValue(stream));
+}
+
+#else  // GOOGLE_CUDA
+
+/*static*/ Status GpuGraph::BeginCapture(se::Stream* stream) {
+  return Unimplemented("GPU graphs are only supported on CUDA");
+}
+
+/*static*/ StatusOr<std::unique_ptr<GpuGraph>> GpuGraph::EndCapture(
+    se::Stream* stream) {
+  return Unimplemented("GPU graphs are only supported on CUDA");
+}
+
+GpuGraph::~GpuGraph() {}
+
+Status GpuGraph::Launch(se::Stream* stream) {
+  return Unimplemented("GPU graphs are only supported on CUDA");
+}
+
+#endif  // GOOGLE_CUDA
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,64 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_GRAPH_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_GRAPH_H_
+
+#include <memory>
+
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+
+namespace xla {
+namespace gpu {
+
+// Work captured from a stream into an executable CUDA graph, which can be
+// launched again and again at the cost of a single launch.  The captured work
+// keeps the device addresses it was enqueued with.
+//
+// Only supported on CUDA; elsewhere BeginCapture fails with Unimplemented.
+class GpuGraph {
+ public:
+  // Starts capturing the work that the calling thread enqueues on `stream`.
+  // The work is recorded, not executed.
+  static Status BeginCapture(se::Stream* stream);
+
+  // Stops the capture started by BeginCapture and instantiates the captured
+  // work.  Must be called even if enqueuing the work failed.
+  static StatusOr<std::unique_ptr<GpuGraph>> EndCapture(se::Stream* stream);
+
+  ~GpuGraph();
+
+  // Enqueues the captured work on `stream`, which must belong to the executor
+  // of the stream the work was captured from.
+  Status Launch(se::Stream* stream);
+
+ private:
+  GpuGraph(se::StreamExecutor* executor, void* graph_exec)
+      : executor_(executor), graph_exec_(graph_exec) {}
+
+  se::StreamExecutor* executor_;
+  void* graph_exec_;  // A se::gpu::GpuGraphExecHandle.
+
+  GpuGraph(const GpuGraph&) = delete;
+  GpuGraph& operator=(const GpuGraph&) = delete;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_GRAPH_H_
@@ -21,6 +21,8 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/service/buffer_value.h"
+#include "tensorflow/compiler/xla/service/gpu/host_offloader.h"
+#include "tensorflow/compiler/xla/service/gpu/latency_hiding_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_instructions.h"
 #include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_reachability.h"
@@ -331,6 +333,30 @@ StatusOr<std::unique_ptr<GpuHloSchedule>> GpuHloSchedule::Build(
             ComputationSchedulerToModuleScheduler(
                 DefaultMemoryScheduler,
                 PostprocessorToScheduleAsEarlyOrLateAsPossible)));
+    const DebugOptions& debug_options = module->config().debug_options();
+    const int64 host_offload_memory_limit =
+        debug_options.xla_gpu_host_offload_memory_limit_bytes();
+    if (debug_options.xla_gpu_enable_latency_hiding_scheduler() ||
+        host_offload_memory_limit > 0) {
+      // These passes reorder the schedule, and the offloader inserts the
+      // copies to and from host memory into it.
+      auto shape_size = [pointer_size](const Shape& shape) {
+        return ShapeUtil::ByteSizeOf(shape, pointer_size);
+      };
+      TF_RETURN_IF_ERROR(module->set_schedule(sequences));
+      if (debug_options.xla_gpu_enable_latency_hiding_scheduler()) {
+        LatencyHidingScheduler scheduler(
+            shape_size,
+            debug_options
+                .xla_gpu_latency_hiding_scheduler_memory_limit_bytes());
+        TF_RETURN_IF_ERROR(scheduler.Run(module).status());
+      }
+      if (host_offload_memory_limit > 0) {
+        HostOffloader offloader(host_offload_memory_limit, shape_size);
+        TF_RETURN_IF_ERROR(offloader.Run(module).status());
+      }
+      sequences = module->schedule();
+    }
     schedule->thunk_launch_order_ =
         sequences.sequence(entry_computation).instructions();
     schedule->hlo_ordering_ =
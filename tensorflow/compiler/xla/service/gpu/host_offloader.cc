@@ -0,0 +1,211 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_offloader.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/hlo_schedule.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// Returns whether `instr` allocates a temp buffer for its result, as opposed
+// to aliasing an operand or living in memory owned by the caller.
+bool DefinesTempBuffer(const HloInstruction* instr) {
+  switch (instr->opcode()) {
+    case HloOpcode::kAddDependency:
+    case HloOpcode::kAfterAll:
+    case HloOpcode::kBitcast:
+    case HloOpcode::kConstant:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kParameter:
+    case HloOpcode::kTuple:
+      return false;
+    default:
+      return true;
+  }
+}
+
+// An array that is not used between the instructions at positions `start` and
+// `end` of the schedule.
+struct IdleStretch {
+  HloInstruction* array;
+  int64 size;
+  int64 start;
+  int64 end;
+};
+
+}  // namespace
+
+StatusOr<bool> HostOffloader::Run(HloModule* module) {
+  if (memory_limit_bytes_ <= 0) {
+    return false;
+  }
+  TF_RET_CHECK(module->has_schedule());
+  HloComputation* entry = module->entry_computation();
+  const std::vector<HloInstruction*> sequence =
+      module->schedule().sequence(entry).instructions();
+  const int64 num_instructions = sequence.size();
+  absl::flat_hash_map<const HloInstruction*, int64> positions;
+  for (int64 i = 0; i < num_instructions; ++i) {
+    positions[sequence[i]] = i;
+  }
+
+  // Estimate the bytes in use while each instruction runs: every buffer is
+  // live from its definition to its last use.
+  std::vector<int64> bytes_in_use(num_instructions + 1, 0);
+  std::vector<IdleStretch> candidates;
+  for (int64 i = 0; i < num_instructions; ++i) {
+    HloInstruction* instr = sequence[i];
+    if (!DefinesTempBuffer(instr)) {
+      continue;
+    }
+    int64 size = 0;
+    ShapeUtil::ForEachSubshape(
+        instr->shape(), [&](const Shape& subshape, const ShapeIndex&) {
+          size += shape_size_(subshape);
+        });
+    std::vector<int64> uses = {i};
+    for (const HloInstruction* user : instr->users()) {
+      uses.push_back(positions.at(user));
+    }
+    if (instr == entry->root_instruction()) {
+      uses.push_back(num_instructions - 1);
+    }
+    absl::c_sort(uses);
+    bytes_in_use[i] += size;
+    bytes_in_use[uses.back() + 1] -= size;
+
+    if (instr == entry->root_instruction() || !instr->shape().IsArray() ||
+        instr->shape().is_dynamic() ||
+        instr->shape().layout().memory_space() != 0 ||
+        size < min_offload_bytes_) {
+      continue;
+    }
+    // Only the longest idle stretch of each array is considered, so that the
+    // array is copied at most once in each direction.
+    IdleStretch longest{instr, size, 0, 0};
+    for (int64 j = 1; j < uses.size(); ++j) {
+      if (uses[j] - uses[j - 1] > longest.end - longest.start) {
+        longest.start = uses[j - 1];
+        longest.end = uses[j];
+      }
+    }
+    // Offloading must free the buffer for at least one instruction.
+    if (longest.end - prefetch_distance_ > longest.start + 1) {
+      candidates.push_back(longest);
+    }
+  }
+  for (int64 i = 1; i < num_instructions; ++i) {
+    bytes_in_use[i] += bytes_in_use[i - 1];
+  }
+  bytes_in_use.pop_back();
+
+  absl::c_stable_sort(candidates,
+                      [](const IdleStretch& a, const IdleStretch& b) {
+                        return a.size > b.size;
+                      });
+  std::vector<bool> offloaded(candidates.size(), false);
+  std::vector<const IdleStretch*> stretches;
+  while (true) {
+    const int64 peak = absl::c_max_element(bytes_in_use) -
+                       bytes_in_use.begin();
+    if (bytes_in_use[peak] <= memory_limit_bytes_) {
+      break;
+    }
+    // The array is off the device from the instruction after the copy to host
+    // memory up to the copy back.
+    auto covers_peak = [&](const IdleStretch& stretch) {
+      return stretch.start < peak &&
+             peak < stretch.end - prefetch_distance_;
+    };
+    int64 picked = 0;
+    while (picked < candidates.size() &&
+           (offloaded[picked] || !covers_peak(candidates[picked]))) {
+      ++picked;
+    }
+    if (picked == candidates.size()) {
+      VLOG(1) << "The estimated peak memory of " << module->name() << ", "
+              << bytes_in_use[peak] << " bytes, exceeds the "
+              << memory_limit_bytes_ << " bytes limit after offloading "
+              << stretches.size() << " arrays";
+      break;
+    }
+    offloaded[picked] = true;
+    const IdleStretch& stretch = candidates[picked];
+    for (int64 i = stretch.start + 1; i < stretch.end - prefetch_distance_;
+         ++i) {
+      bytes_in_use[i] -= stretch.size;
+    }
+    stretches.push_back(&stretch);
+  }
+  if (stretches.empty()) {
+    return false;
+  }
+
+  std::vector<std::vector<HloInstruction*>> inserted_after(num_instructions);
+  std::vector<std::vector<HloInstruction*>> inserted_before(num_instructions);
+  for (const IdleStretch* stretch : stretches) {
+    HloInstruction* array = stretch->array;
+    Shape host_shape = array->shape();
+    host_shape.mutable_layout()->set_memory_space(kHostMemorySpace);
+    HloInstruction* offload = entry->AddInstruction(
+        HloInstruction::CreateUnary(host_shape, HloOpcode::kCopy, array));
+    HloInstruction* prefetch = entry->AddInstruction(
+        HloInstruction::CreateUnary(array->shape(), HloOpcode::kCopy, offload));
+    std::vector<HloInstruction*> later_users;
+    for (HloInstruction* user : array->users()) {
+      if (user != offload && positions.at(user) >= stretch->end) {
+        later_users.push_back(user);
+      }
+    }
+    for (HloInstruction* user : later_users) {
+      TF_RETURN_IF_ERROR(array->ReplaceUseWith(user, prefetch));
+    }
+    VLOG(2) << "Offloading " << array->name() << " to host memory after "
+            << sequence[stretch->start]->name() << " until "
+            << sequence[stretch->end]->name();
+    inserted_after[stretch->start].push_back(offload);
+    inserted_before[stretch->end - prefetch_distance_].push_back(prefetch);
+  }
+
+  HloInstructionSequence new_sequence;
+  for (int64 i = 0; i < num_instructions; ++i) {
+    for (HloInstruction* prefetch : inserted_before[i]) {
+      new_sequence.push_back(prefetch);
+    }
+    new_sequence.push_back(sequence[i]);
+    for (HloInstruction* offload : inserted_after[i]) {
+      new_sequence.push_back(offload);
+    }
+  }
+  module->schedule().set_sequence(entry, std::move(new_sequence));
+  TF_RETURN_IF_ERROR(module->schedule().Verify());
+  return true;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,70 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_OFFLOADER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_OFFLOADER_H_
+
+#include <functional>
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/shape.h"
+
+namespace xla {
+namespace gpu {
+
+// Lowers the peak device memory of the entry computation by offloading large
+// arrays, such as the activations kept from the forward to the backward pass,
+// to host memory while they are not used.
+//
+// An offloaded array is copied to a buffer in kHostMemorySpace right after the
+// use that precedes its longest idle stretch, and copied back ahead of the use
+// that ends it.  The later uses read the copy.  The backend runs both copies
+// asynchronously, so the copy back overlaps with the `prefetch_distance`
+// instructions scheduled before the use.
+//
+// Arrays are picked greedily, largest first, among those idle across the point
+// where the estimated memory in use peaks, until the estimate fits in
+// `memory_limit_bytes` or no array is left to offload.  The estimate ignores
+// buffer sharing and fragmentation.
+//
+// The module must be scheduled; the pass updates the schedule of the entry
+// computation.
+class HostOffloader : public HloModulePass {
+ public:
+  using ShapeSizeFunction = std::function<int64(const Shape&)>;
+
+  HostOffloader(int64 memory_limit_bytes, ShapeSizeFunction shape_size,
+                int64 min_offload_bytes = 1 << 20, int64 prefetch_distance = 4)
+      : memory_limit_bytes_(memory_limit_bytes),
+        shape_size_(std::move(shape_size)),
+        min_offload_bytes_(min_offload_bytes),
+        prefetch_distance_(prefetch_distance) {}
+
+  absl::string_view name() const override { return "host-offloader"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  const int64 memory_limit_bytes_;
+  const ShapeSizeFunction shape_size_;
+  const int64 min_offload_bytes_;
+  const int64 prefetch_distance_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_OFFLOADER_H_
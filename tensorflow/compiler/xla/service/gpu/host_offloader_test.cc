@@ -0,0 +1,97 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_offloader.h"
+
+#include "absl/algorithm/container.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+int64 ShapeSize(const Shape& shape) {
+  return ShapeUtil::ByteSizeOf(shape, /*pointer_size=*/8);
+}
+
+// The 1MiB activation is used by the first and the last instruction only,
+// while two other 1MiB arrays are live at every point in between.
+constexpr char kModule[] = R"(
+HloModule m, is_scheduled=true
+
+ENTRY e {
+  p0 = f32[256,1024]{1,0} parameter(0)
+  activation = f32[256,1024]{1,0} exponential(p0)
+  n0 = f32[256,1024]{1,0} negate(p0)
+  n1 = f32[256,1024]{1,0} negate(n0)
+  n2 = f32[256,1024]{1,0} negate(n1)
+  n3 = f32[256,1024]{1,0} negate(n2)
+  n4 = f32[256,1024]{1,0} negate(n3)
+  n5 = f32[256,1024]{1,0} negate(n4)
+  n6 = f32[256,1024]{1,0} negate(n5)
+  n7 = f32[256,1024]{1,0} negate(n6)
+  ROOT sum = f32[256,1024]{1,0} add(activation, n7)
+})";
+
+class HostOffloaderTest : public HloTestBase {};
+
+TEST_F(HostOffloaderTest, OffloadsIdleActivation) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kModule));
+  HostOffloader offloader(/*memory_limit_bytes=*/(5 << 20) / 2, ShapeSize,
+                          /*min_offload_bytes=*/1 << 20,
+                          /*prefetch_distance=*/2);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offloader.Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Add(op::Copy(op::Copy(op::Exp())), op::Negate()));
+  const HloInstruction* prefetch = root->operand(0);
+  const HloInstruction* offload = prefetch->operand(0);
+  EXPECT_EQ(offload->shape().layout().memory_space(), kHostMemorySpace);
+  EXPECT_EQ(prefetch->shape().layout().memory_space(), 0);
+
+  const std::vector<HloInstruction*>& sequence =
+      module->schedule().sequence(module->entry_computation()).instructions();
+  auto position = [&](const HloInstruction* instr) {
+    return absl::c_find(sequence, instr) - sequence.begin();
+  };
+  EXPECT_EQ(position(offload), position(offload->operand(0)) + 1);
+  EXPECT_EQ(position(prefetch), position(root) - 3);
+}
+
+TEST_F(HostOffloaderTest, KeepsArraysThatFit) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kModule));
+  HostOffloader offloader(/*memory_limit_bytes=*/3 << 20, ShapeSize);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offloader.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(HostOffloaderTest, KeepsSmallArrays) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kModule));
+  HostOffloader offloader(/*memory_limit_bytes=*/1, ShapeSize,
+                          /*min_offload_bytes=*/2 << 20);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offloader.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
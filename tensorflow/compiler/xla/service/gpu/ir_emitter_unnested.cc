@@ -2105,6 +2105,20 @@ Status IrEmitterUnnested::EmitCopy(mlir::Operation* op) {
 
   CHECK(ShapeUtil::Compatible(operand_shape, output_shape));
   auto maybe_slice = GetAllocationSlice(copy.operand());
+  auto maybe_destination = GetAllocationSlice(copy.output());
+  if (maybe_slice.ok() && maybe_destination.ok()) {
+    bool from_host = maybe_slice->allocation()->color() == kHostMemorySpace;
+    bool to_host = maybe_destination->allocation()->color() == kHostMemorySpace;
+    if (from_host || to_host) {
+      // Copies to and from host memory are only inserted by HostOffloader.
+      TF_RET_CHECK(from_host != to_host);
+      TF_RET_CHECK(
+          LayoutUtil::Equal(operand_shape.layout(), output_shape.layout()));
+      EmitAsyncCopy(op, *maybe_slice, *maybe_destination,
+                    ByteSizeOf(operand_shape));
+      return Status::OK();
+    }
+  }
   if (LayoutUtil::Equal(operand_shape.layout(), output_shape.layout()) &&
       maybe_slice.ok()) {
     // Copy the operand into the output if it's not the same buffer already.
@@ -2128,6 +2142,59 @@ Status IrEmitterUnnested::EmitCopy(mlir::Operation* op) {
   return EmitUsingElementalIrEmitter(op);
 }
 
+void IrEmitterUnnested::EmitAsyncCopy(
+    mlir::Operation* op, const BufferAllocation::Slice& source_buffer,
+    const BufferAllocation::Slice& destination_buffer, uint64 mem_size) {
+  bool device_to_host =
+      destination_buffer.allocation()->color() == kHostMemorySpace;
+  auto thunk = absl::make_unique<AsyncCopyStartThunk>(
+      GetThunkInfo(op), source_buffer, destination_buffer, mem_size,
+      device_to_host);
+  // The host buffers are only accessed by async copies, which run in order.
+  pending_async_copies_.emplace_back(
+      thunk.get(), device_to_host ? source_buffer : destination_buffer);
+  AddThunkToThunkSequence(std::move(thunk));
+}
+
+void IrEmitterUnnested::EmitAsyncCopyDones(mlir::Operation* op) {
+  if (pending_async_copies_.empty()) {
+    return;
+  }
+  std::vector<BufferAllocation::Slice> accessed_buffers;
+  if (op != nullptr) {
+    op->walk([&](mlir::Operation* nested_op) {
+      for (mlir::Value operand : nested_op->getOperands()) {
+        if (!operand.getType().isa<mlir::MemRefType>()) {
+          continue;
+        }
+        auto slice = GetAllocationSlice(operand);
+        if (slice.ok()) {
+          accessed_buffers.push_back(*slice);
+        }
+      }
+    });
+  }
+  auto is_accessed = [&](const BufferAllocation::Slice& buffer) {
+    return op == nullptr ||
+           absl::c_any_of(accessed_buffers,
+                          [&](const BufferAllocation::Slice& accessed) {
+                            return accessed.OverlapsWith(buffer);
+                          });
+  };
+  auto pending = pending_async_copies_.begin();
+  while (pending != pending_async_copies_.end()) {
+    if (is_accessed(pending->second)) {
+      Thunk::ThunkInfo thunk_info;
+      thunk_info.profile_annotation = pending->first->profile_annotation();
+      AddThunkToThunkSequence(
+          absl::make_unique<AsyncCopyDoneThunk>(thunk_info, *pending->first));
+      pending = pending_async_copies_.erase(pending);
+    } else {
+      ++pending;
+    }
+  }
+}
+
 Status IrEmitterUnnested::EmitExtraOutputsForReduce(
     absl::Span<const llvm_ir::IrArray> result_ir_arrays,
     const IrArray::Index& index, bool use_linear_index,
@@ -4999,6 +5066,23 @@ ReductionCodegenInfo IrEmitterUnnested::ComputeReductionCodegenInfo(
                   0;
   se::CudaComputeCapability cc = ir_emitter_context_->cuda_compute_capability();
 
+  // Each thread of a column reduction over narrow inputs may read four
+  // adjacent columns rather than two, so that its loads are as wide as the
+  // ones of a 32-bit input. The shared cache grows with the number of partial
+  // results, so this is limited to fusions with a single output.
+  auto column_partial_results = [&]() -> int {
+    if (hlo_module_config_.debug_options()
+            .xla_gpu_vectorize_column_reductions() &&
+        smallest_input_dtype_bits <= 16 &&
+        reduction_dimensions.dimensions[2] % (4 * kWarpSize) == 0) {
+      auto fusion = mlir::dyn_cast<mlir::lmhlo::FusionOp>(unnested_hlo);
+      if (!fusion || fusion.getFusionResults().size() == 1) {
+        return 4;
+      }
+    }
+    return 2;
+  };
+
   int num_partial_results = 1;
   KernelMappingScheme::IndexingOrder indexing_order = [&]() {
     if (reduction_dimensions.is_row_reduction &&
@@ -5014,7 +5098,7 @@ ReductionCodegenInfo IrEmitterUnnested::ComputeReductionCodegenInfo(
                IsUnrollingColumnReductionBeneficial(
                    unnested_hlo, input_shape,
                    reduction_dimensions.dimensions[2], layout_analysis)) {
-      num_partial_results = 2;
+      num_partial_results = column_partial_results();
       reduction_tiling[2] *= num_partial_results;
       return kLinearIndexingX;
     } else {
@@ -5492,6 +5576,8 @@ Status IrEmitterUnnested::EmitOp(mlir::Operation* op) {
     return Status::OK();
   }
 
+  EmitAsyncCopyDones(op);
+
   if (mlir::isa<mlir::memref::GetGlobalOp>(op)) {
     return EmitConstant(op);
   }
@@ -5629,6 +5715,7 @@ Status IrEmitterUnnested::EmitLmhloRegion(mlir::Region* region) {
   for (mlir::Operation& op : llvm::make_early_inc_range(region->front())) {
     TF_RETURN_IF_ERROR(EmitOp(&op));
   }
+  EmitAsyncCopyDones(/*op=*/nullptr);
   return Status::OK();
 }
 
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "absl/container/inlined_vector.h"
 #include "tensorflow/compiler/mlir/xla/transforms/mhlo_to_lhlo_with_xla.h"
+#include "tensorflow/compiler/xla/service/gpu/copy_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emitter.h"
 #include "tensorflow/compiler/xla/service/gpu/kernel_mapping_scheme.h"
@@ -140,6 +141,15 @@ class IrEmitterUnnested : public IrEmitter {
   Status EmitConstant(mlir::Operation* op);
 
   Status EmitCopy(mlir::Operation* op);
+  // Emits a copy between host and device memory that runs on the async
+  // stream, see AsyncCopyStartThunk.
+  void EmitAsyncCopy(mlir::Operation* op,
+                     const BufferAllocation::Slice& source_buffer,
+                     const BufferAllocation::Slice& destination_buffer,
+                     uint64 mem_size);
+  // Makes the compute stream wait for the async copies that access the device
+  // buffers `op` accesses, or for all of them if `op` is null.
+  void EmitAsyncCopyDones(mlir::Operation* op);
 
   Status EmitConditional(mlir::Operation* op);
   Status EmitCustomCall(mlir::Operation* op);
@@ -663,6 +673,11 @@ class IrEmitterUnnested : public IrEmitter {
   absl::flat_hash_map<mlir::Operation*, NcclAllReduceStartThunk*>
       all_reduce_start_thunks_;
 
+  // The async copies the compute stream has not waited for yet, with the
+  // device buffer each of them accesses.
+  std::vector<std::pair<AsyncCopyStartThunk*, BufferAllocation::Slice>>
+      pending_async_copies_;
+
   // Begin optional members for XLA HLO -> LMHLO:
   absl::flat_hash_map<const mlir::Region*, std::unique_ptr<HloModule>>
       scratch_nested_computations_;
@@ -0,0 +1,307 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/latency_hiding_scheduler.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+bool IsAsyncCollectiveStart(const HloInstruction* instr) {
+  switch (instr->opcode()) {
+    case HloOpcode::kAllGatherStart:
+    case HloOpcode::kAllReduceStart:
+    case HloOpcode::kCollectivePermuteStart:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsAsyncCollectiveDone(const HloInstruction* instr) {
+  switch (instr->opcode()) {
+    case HloOpcode::kAllGatherDone:
+    case HloOpcode::kAllReduceDone:
+    case HloOpcode::kCollectivePermuteDone:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns whether `instr` neither launches work nor allocates a buffer.
+bool IsFree(const HloInstruction* instr) {
+  switch (instr->opcode()) {
+    case HloOpcode::kAddDependency:
+    case HloOpcode::kAfterAll:
+    case HloOpcode::kBitcast:
+    case HloOpcode::kConstant:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kParameter:
+    case HloOpcode::kTuple:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Tracks the estimated bytes in use as instructions of a sequence are
+// scheduled: a result is live from its instruction to its last user.
+class MemoryTracker {
+ public:
+  MemoryTracker(const std::vector<HloInstruction*>& instructions,
+                const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+    for (HloInstruction* instr : instructions) {
+      int64 size = 0;
+      if (!IsFree(instr)) {
+        ShapeUtil::ForEachSubshape(
+            instr->shape(), [&](const Shape& subshape, const ShapeIndex&) {
+              if (subshape.IsArray()) {
+                size += shape_size(subshape);
+              }
+            });
+      }
+      sizes_[instr] = size;
+      // The root stays live past the end of the sequence.
+      remaining_users_[instr] =
+          instr->user_count() +
+          (instr == instr->parent()->root_instruction() ? 1 : 0);
+    }
+  }
+
+  // The bytes in use while `instr` runs, if it is scheduled next.
+  int64 BytesInUseIfScheduled(const HloInstruction* instr) const {
+    return bytes_in_use_ + sizes_.at(instr);
+  }
+
+  void Schedule(const HloInstruction* instr) {
+    bytes_in_use_ += sizes_.at(instr);
+    if (remaining_users_.at(instr) == 0) {
+      bytes_in_use_ -= sizes_.at(instr);
+    }
+    absl::flat_hash_set<const HloInstruction*> operands(
+        instr->operands().begin(), instr->operands().end());
+    for (const HloInstruction* operand : operands) {
+      auto it = remaining_users_.find(operand);
+      if (it != remaining_users_.end() && --it->second == 0) {
+        bytes_in_use_ -= sizes_.at(operand);
+      }
+    }
+  }
+
+ private:
+  absl::flat_hash_map<const HloInstruction*, int64> sizes_;
+  absl::flat_hash_map<const HloInstruction*, int64> remaining_users_;
+  int64 bytes_in_use_ = 0;
+};
+
+int64 PeakBytesInUse(const std::vector<HloInstruction*>& instructions,
+                     const HloCostAnalysis::ShapeSizeFunction& shape_size) {
+  MemoryTracker tracker(instructions, shape_size);
+  int64 peak = 0;
+  for (const HloInstruction* instr : instructions) {
+    peak = std::max(peak, tracker.BytesInUseIfScheduled(instr));
+    tracker.Schedule(instr);
+  }
+  return peak;
+}
+
+}  // namespace
+
+double GpuLatencyEstimator::ComputeTime(const HloInstruction& instr) const {
+  if (IsFree(&instr) || IsAsyncCollectiveStart(&instr) ||
+      IsAsyncCollectiveDone(&instr)) {
+    return 0;
+  }
+  const double flops = cost_analysis_->flop_count(instr) +
+                       cost_analysis_->transcendental_count(instr);
+  const double bytes = cost_analysis_->bytes_accessed(instr);
+  return options_.kernel_launch_seconds +
+         std::max(flops / options_.flops_per_second,
+                  bytes / options_.memory_bytes_per_second);
+}
+
+double GpuLatencyEstimator::CollectiveTime(const HloInstruction& start) const {
+  double operand_bytes = 0;
+  for (const HloInstruction* operand : start.operands()) {
+    ShapeUtil::ForEachSubshape(
+        operand->shape(), [&](const Shape& subshape, const ShapeIndex&) {
+          if (subshape.IsArray()) {
+            operand_bytes += shape_size_(subshape);
+          }
+        });
+  }
+  double transferred_bytes = operand_bytes;
+  if (start.opcode() != HloOpcode::kCollectivePermuteStart) {
+    const int64 group_size =
+        start.replica_groups().empty()
+            ? start.parent()->parent()->config().replica_count()
+            : start.replica_groups().front().replica_ids_size();
+    if (group_size <= 1) {
+      return 0;
+    }
+    // A ring all-reduce sends each byte twice around the ring, once to reduce
+    // and once to broadcast; a ring all-gather forwards every other shard.
+    transferred_bytes = start.opcode() == HloOpcode::kAllReduceStart
+                            ? 2 * operand_bytes * (group_size - 1) / group_size
+                            : operand_bytes * (group_size - 1);
+  }
+  return options_.collective_latency_seconds +
+         transferred_bytes / options_.collective_bytes_per_second;
+}
+
+StatusOr<HloInstructionSequence> LatencyHidingScheduler::ScheduleComputation(
+    const HloInstructionSequence& sequence,
+    const GpuLatencyEstimator& estimator) const {
+  const std::vector<HloInstruction*>& instructions = sequence.instructions();
+  const int64 memory_limit =
+      memory_limit_bytes_ > 0 ? memory_limit_bytes_
+                              : PeakBytesInUse(instructions, shape_size_);
+
+  absl::flat_hash_map<const HloInstruction*, int64> positions;
+  absl::flat_hash_map<const HloInstruction*, int64> remaining_dependencies;
+  // Positions in `sequence` of the instructions whose operands and control
+  // predecessors are all scheduled.
+  std::set<int64> ready;
+  for (int64 i = 0; i < instructions.size(); ++i) {
+    const HloInstruction* instr = instructions[i];
+    positions[instr] = i;
+    const int64 dependencies =
+        absl::flat_hash_set<const HloInstruction*>(instr->operands().begin(),
+                                                   instr->operands().end())
+            .size() +
+        instr->control_predecessors().size();
+    remaining_dependencies[instr] = dependencies;
+    if (dependencies == 0) {
+      ready.insert(i);
+    }
+  }
+
+  MemoryTracker tracker(instructions, shape_size_);
+  // The simulated time at which the collective of each done completes.
+  absl::flat_hash_map<const HloInstruction*, double> completion_times;
+  double clock = 0;
+  HloInstructionSequence result;
+  while (!ready.empty()) {
+    HloInstruction* next = nullptr;
+    for (int64 position : ready) {
+      if (IsAsyncCollectiveStart(instructions[position])) {
+        next = instructions[position];
+        break;
+      }
+    }
+    if (next == nullptr) {
+      HloInstruction* first_done = nullptr;
+      HloInstruction* first_other = nullptr;
+      HloInstruction* first_fitting = nullptr;
+      for (int64 position : ready) {
+        HloInstruction* instr = instructions[position];
+        if (IsAsyncCollectiveDone(instr)) {
+          if (first_done == nullptr || completion_times.at(instr) <
+                                           completion_times.at(first_done)) {
+            first_done = instr;
+          }
+          continue;
+        }
+        if (first_other == nullptr) {
+          first_other = instr;
+        }
+        if (first_fitting == nullptr &&
+            tracker.BytesInUseIfScheduled(instr) <= memory_limit) {
+          first_fitting = instr;
+        }
+      }
+      if (first_done == nullptr ||
+          (first_other != nullptr &&
+           positions.at(first_other) < positions.at(first_done))) {
+        // Nothing would be hoisted above a done.
+        next = first_other;
+      } else if (completion_times.at(first_done) <= clock ||
+                 first_fitting == nullptr) {
+        next = first_done;
+      } else {
+        next = first_fitting;
+      }
+    }
+
+    if (IsAsyncCollectiveDone(next)) {
+      clock = std::max(clock, completion_times.at(next));
+    }
+    clock += estimator.ComputeTime(*next);
+    if (IsAsyncCollectiveStart(next)) {
+      for (const HloInstruction* user : next->users()) {
+        completion_times[user] = clock + estimator.CollectiveTime(*next);
+      }
+    }
+    tracker.Schedule(next);
+    result.push_back(next);
+    ready.erase(positions.at(next));
+
+    std::vector<HloInstruction*> successors = next->users();
+    successors.insert(successors.end(), next->control_successors().begin(),
+                      next->control_successors().end());
+    for (HloInstruction* successor : successors) {
+      if (--remaining_dependencies.at(successor) == 0) {
+        ready.insert(positions.at(successor));
+      }
+    }
+  }
+  TF_RET_CHECK(result.size() == instructions.size());
+  return result;
+}
+
+StatusOr<bool> LatencyHidingScheduler::Run(HloModule* module) {
+  TF_RET_CHECK(module->has_schedule());
+  bool changed = false;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    if (!module->schedule().is_computation_scheduled(computation) ||
+        !absl::c_any_of(computation->instructions(), IsAsyncCollectiveStart)) {
+      continue;
+    }
+    HloCostAnalysis cost_analysis(shape_size_);
+    TF_RETURN_IF_ERROR(computation->Accept(&cost_analysis));
+    GpuLatencyEstimator estimator(&cost_analysis, shape_size_, options_);
+    const HloInstructionSequence& sequence =
+        module->schedule().sequence(computation);
+    TF_ASSIGN_OR_RETURN(HloInstructionSequence new_sequence,
+                        ScheduleComputation(sequence, estimator));
+    if (new_sequence.ids() != sequence.ids()) {
+      VLOG(2) << "Reordered " << computation->name()
+              << " to overlap async collectives";
+      module->schedule().set_sequence(computation, std::move(new_sequence));
+      changed = true;
+    }
+  }
+  if (changed) {
+    TF_RETURN_IF_ERROR(module->schedule().Verify());
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,107 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_LATENCY_HIDING_SCHEDULER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_LATENCY_HIDING_SCHEDULER_H_
+
+#include <functional>
+
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/service/hlo_schedule.h"
+#include "tensorflow/compiler/xla/shape.h"
+
+namespace xla {
+namespace gpu {
+
+// Estimates, in seconds, how long HLO instructions take on a GPU.
+//
+// Computation is modeled as bound by either the arithmetic or the memory
+// throughput, as counted by HloCostAnalysis, plus a fixed launch overhead.
+// Collectives are modeled as ring algorithms over a link of the given
+// bandwidth and latency.
+class GpuLatencyEstimator {
+ public:
+  struct Options {
+    double flops_per_second = 1e13;
+    double memory_bytes_per_second = 5e11;
+    double kernel_launch_seconds = 5e-6;
+    double collective_bytes_per_second = 2e10;
+    double collective_latency_seconds = 2e-5;
+  };
+
+  // `cost_analysis` must have visited the instructions to estimate.
+  GpuLatencyEstimator(const HloCostAnalysis* cost_analysis,
+                      const HloCostAnalysis::ShapeSizeFunction& shape_size,
+                      const Options& options)
+      : cost_analysis_(cost_analysis),
+        shape_size_(shape_size),
+        options_(options) {}
+
+  // Time `instr` occupies the compute stream.  Zero for async collective
+  // starts and dones, which only enqueue or wait for work, and for
+  // instructions that don't launch anything.
+  double ComputeTime(const HloInstruction& instr) const;
+
+  // Time between an async collective start and the completion of the
+  // collective.
+  double CollectiveTime(const HloInstruction& start) const;
+
+ private:
+  const HloCostAnalysis* cost_analysis_;
+  HloCostAnalysis::ShapeSizeFunction shape_size_;
+  Options options_;
+};
+
+// Reorders the sequences of a scheduled module so that asynchronous
+// collectives overlap with independent computation.
+//
+// Each sequence is list-scheduled against a simulated clock.  Async starts run
+// as soon as their operands are ready; other instructions run in their order
+// in the input sequence, except that a done waits until its collective is
+// estimated to have completed while independent instructions are available.
+// An instruction is only hoisted above a pending done if the estimated memory
+// in use stays within `memory_limit_bytes`, or within the peak of the input
+// sequence if the limit is zero.
+class LatencyHidingScheduler : public HloModulePass {
+ public:
+  LatencyHidingScheduler(
+      HloCostAnalysis::ShapeSizeFunction shape_size, int64 memory_limit_bytes,
+      GpuLatencyEstimator::Options options = GpuLatencyEstimator::Options())
+      : shape_size_(std::move(shape_size)),
+        memory_limit_bytes_(memory_limit_bytes),
+        options_(options) {}
+
+  absl::string_view name() const override {
+    return "latency-hiding-scheduler";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  StatusOr<HloInstructionSequence> ScheduleComputation(
+      const HloInstructionSequence& sequence,
+      const GpuLatencyEstimator& estimator) const;
+
+  const HloCostAnalysis::ShapeSizeFunction shape_size_;
+  const int64 memory_limit_bytes_;
+  const GpuLatencyEstimator::Options options_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_LATENCY_HIDING_SCHEDULER_H_
@@ -0,0 +1,104 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/latency_hiding_scheduler.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+using ::testing::ElementsAre;
+
+int64 ShapeSize(const Shape& shape) {
+  return ShapeUtil::ByteSizeOf(shape, /*pointer_size=*/8);
+}
+
+// The memory-minimizing order waits for the all-reduce before running the
+// negates, which don't depend on it.
+constexpr char kModule[] = R"(
+HloModule m, is_scheduled=true
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY e {
+  p0 = f32[1024,1024]{1,0} parameter(0)
+  p1 = f32[1024,1024]{1,0} parameter(1)
+  ars = (f32[1024,1024]{1,0}, f32[1024,1024]{1,0}) all-reduce-start(p0), replica_groups={}, to_apply=add
+  ard = f32[1024,1024]{1,0} all-reduce-done(ars)
+  n0 = f32[1024,1024]{1,0} negate(p1)
+  n1 = f32[1024,1024]{1,0} negate(n0)
+  n2 = f32[1024,1024]{1,0} negate(n1)
+  ROOT t = (f32[1024,1024]{1,0}, f32[1024,1024]{1,0}) tuple(ard, n2)
+})";
+
+class LatencyHidingSchedulerTest : public HloTestBase {
+ protected:
+  std::vector<std::string> EntrySequence(const HloModule& module) {
+    std::vector<std::string> names;
+    const HloInstructionSequence& sequence =
+        module.schedule().sequence(module.entry_computation());
+    for (const HloInstruction* instr : sequence.instructions()) {
+      names.push_back(instr->name());
+    }
+    return names;
+  }
+};
+
+TEST_F(LatencyHidingSchedulerTest, OverlapsAllReduceWithIndependentWork) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module, ParseAndReturnVerifiedModule(kModule, /*replica_count=*/8));
+  LatencyHidingScheduler scheduler(ShapeSize,
+                                   /*memory_limit_bytes=*/int64{1} << 30);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, scheduler.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(EntrySequence(*module),
+              ElementsAre("p0", "p1", "ars", "n0", "n1", "n2", "ard", "t"));
+}
+
+TEST_F(LatencyHidingSchedulerTest, KeepsPeakMemoryOfInputSchedule) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module, ParseAndReturnVerifiedModule(kModule, /*replica_count=*/8));
+  // The input schedule peaks at three live 4MiB arrays, so only one negate
+  // fits next to the all-reduce buffers.
+  LatencyHidingScheduler scheduler(ShapeSize, /*memory_limit_bytes=*/0);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, scheduler.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(EntrySequence(*module),
+              ElementsAre("p0", "p1", "ars", "n0", "ard", "n1", "n2", "t"));
+}
+
+TEST_F(LatencyHidingSchedulerTest, KeepsOrderWithoutCommunication) {
+  // With a single replica the all-reduce completes immediately.
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kModule));
+  LatencyHidingScheduler scheduler(ShapeSize,
+                                   /*memory_limit_bytes=*/int64{1} << 30);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, scheduler.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
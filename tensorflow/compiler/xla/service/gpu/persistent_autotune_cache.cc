@@ -0,0 +1,168 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/persistent_autotune_cache.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+tensorflow::mutex caches_mu(tensorflow::LINKER_INITIALIZED);
+auto& caches TF_GUARDED_BY(caches_mu) = *new absl::flat_hash_map<
+    std::string, std::unique_ptr<PersistentAutotuneCache>>();
+
+std::string KeyString(const AutotuneResultsEntry& entry) {
+  return absl::StrCat(
+      entry.device(), "|", entry.cc().major(), ".", entry.cc().minor(), "|",
+      entry.cudnn_version().major(), ".", entry.cudnn_version().minor(), ".",
+      entry.cudnn_version().patch(), "|", entry.blas_version(), "|",
+      entry.hlo());
+}
+
+}  // namespace
+
+PersistentAutotuneCache::PersistentAutotuneCache(std::string path)
+    : path_(std::move(path)) {
+  tensorflow::mutex_lock lock(mu_);
+  results_.set_version(kAutotuneResultsVersion);
+  Status status = MergeFromFile();
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to load autotuning results from " << path_ << ": "
+                 << status;
+  }
+  VLOG(1) << "Loaded " << results_.entries_size()
+          << " autotuning results from " << path_;
+}
+
+/*static*/ PersistentAutotuneCache* PersistentAutotuneCache::Get(
+    const std::string& path) {
+  if (path.empty()) return nullptr;
+  tensorflow::mutex_lock lock(caches_mu);
+  std::unique_ptr<PersistentAutotuneCache>& cache = caches[path];
+  if (cache == nullptr) {
+    cache = absl::make_unique<PersistentAutotuneCache>(path);
+  }
+  return cache.get();
+}
+
+/*static*/ AutotuneResultsEntry PersistentAutotuneCache::MakeKey(
+    se::StreamExecutor* stream_exec, const std::string& hlo) {
+  AutotuneResultsEntry key;
+  key.set_hlo(hlo);
+  const se::DeviceDescription& description =
+      stream_exec->GetDeviceDescription();
+  key.set_device(description.name());
+  se::CudaComputeCapability cc = description.cuda_compute_capability();
+  key.mutable_cc()->set_major(cc.major);
+  key.mutable_cc()->set_minor(cc.minor);
+  if (auto* dnn = stream_exec->AsDnn()) {
+    StatusOr<se::dnn::VersionInfo> version_or = dnn->GetVersion();
+    if (version_or.ok()) {
+      const se::dnn::VersionInfo& version = version_or.ValueOrDie();
+      key.mutable_cudnn_version()->set_major(version.major_version());
+      key.mutable_cudnn_version()->set_minor(version.minor_version());
+      key.mutable_cudnn_version()->set_patch(version.patch());
+    }
+  }
+  if (auto* blas = stream_exec->AsBlas()) {
+    std::string blas_version;
+    if (blas->GetVersion(&blas_version).ok()) {
+      key.set_blas_version(blas_version);
+    }
+  }
+  return key;
+}
+
+absl::optional<tensorflow::AutotuneResult> PersistentAutotuneCache::Lookup(
+    const AutotuneResultsEntry& key) {
+  tensorflow::mutex_lock lock(mu_);
+  auto it = index_.find(KeyString(key));
+  if (it == index_.end()) return absl::nullopt;
+  return results_.entries(it->second).result();
+}
+
+void PersistentAutotuneCache::Insert(const AutotuneResultsEntry& key,
+                                     const tensorflow::AutotuneResult& result) {
+  tensorflow::mutex_lock lock(mu_);
+  AutotuneResultsEntry entry = key;
+  *entry.mutable_result() = result;
+  AddEntry(entry);
+  Status status = Save();
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to save autotuning results to " << path_ << ": "
+                 << status;
+  }
+}
+
+int PersistentAutotuneCache::size() {
+  tensorflow::mutex_lock lock(mu_);
+  return results_.entries_size();
+}
+
+void PersistentAutotuneCache::AddEntry(const AutotuneResultsEntry& entry) {
+  auto inserted = index_.emplace(KeyString(entry), results_.entries_size());
+  if (inserted.second) {
+    *results_.add_entries() = entry;
+  } else {
+    *results_.mutable_entries(inserted.first->second) = entry;
+  }
+}
+
+Status PersistentAutotuneCache::MergeFromFile() {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  if (!env->FileExists(path_).ok()) return Status::OK();
+  AutotuneResults results;
+  if (absl::EndsWith(path_, ".pbtxt")) {
+    TF_RETURN_IF_ERROR(tensorflow::ReadTextProto(env, path_, &results));
+  } else {
+    TF_RETURN_IF_ERROR(tensorflow::ReadBinaryProto(env, path_, &results));
+  }
+  if (results.version() != kAutotuneResultsVersion) {
+    return tensorflow::errors::FailedPrecondition(
+        "Version ", results.version(), " of the autotuning results does not ",
+        "match the expected version ", kAutotuneResultsVersion);
+  }
+  for (const AutotuneResultsEntry& entry : results.entries()) {
+    if (!index_.contains(KeyString(entry))) AddEntry(entry);
+  }
+  return Status::OK();
+}
+
+Status PersistentAutotuneCache::Save() {
+  Status status = MergeFromFile();
+  if (!status.ok()) {
+    VLOG(1) << "Overwriting autotuning results in " << path_ << ": " << status;
+  }
+  // Concurrent readers never see a partially written file.
+  tensorflow::Env* env = tensorflow::Env::Default();
+  if (absl::EndsWith(path_, ".pbtxt")) {
+    return tensorflow::AtomicWriteTextProto(env, path_, results_);
+  }
+  return tensorflow::AtomicWriteBinaryProto(env, path_, results_);
+}
+
+}  // namespace gpu
+}  // namespace xla
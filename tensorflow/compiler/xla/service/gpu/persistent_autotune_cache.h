@@ -0,0 +1,88 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_PERSISTENT_AUTOTUNE_CACHE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_PERSISTENT_AUTOTUNE_CACHE_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/autotuning.pb.h"
+
+namespace xla {
+namespace gpu {
+
+// Version of the AutotuneResults files written by PersistentAutotuneCache.
+// Bump it whenever the meaning of the results changes, e.g. when the way the
+// instructions are printed changes; files of other versions are ignored.
+constexpr int kAutotuneResultsVersion = 1;
+
+// Autotuning results that outlive the process.
+//
+// The cache reads the AutotuneResults proto at `path` when it is created, and
+// rewrites the file each time a result is added, merging in the results other
+// processes wrote in the meantime.  The file is written in text format if
+// `path` ends in ".pbtxt", and in binary format otherwise.
+//
+// Results are keyed by the canonical text of the tuned instruction, the GPU
+// model and the cuDNN and cuBLAS versions, so that hosts with different GPUs or
+// libraries can share a file, e.g. on a distributed file system.
+class PersistentAutotuneCache {
+ public:
+  explicit PersistentAutotuneCache(std::string path);
+
+  // Returns the process-wide cache for `path`, or nullptr if `path` is empty.
+  static PersistentAutotuneCache* Get(const std::string& path);
+
+  // Returns the key of the results for `hlo` on `stream_exec`.
+  static AutotuneResultsEntry MakeKey(se::StreamExecutor* stream_exec,
+                                      const std::string& hlo);
+
+  // Returns the result recorded for `key`, if any; `key.result` is ignored.
+  absl::optional<tensorflow::AutotuneResult> Lookup(
+      const AutotuneResultsEntry& key);
+
+  // Records `result` for `key` and writes the cache to its file.  Failures to
+  // write the file are logged and otherwise ignored.
+  void Insert(const AutotuneResultsEntry& key,
+              const tensorflow::AutotuneResult& result);
+
+  int size();
+
+ private:
+  // Adds the results in the file that are not in the cache yet.
+  Status MergeFromFile() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status Save() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void AddEntry(const AutotuneResultsEntry& entry)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::string path_;
+  tensorflow::mutex mu_;
+  AutotuneResults results_ TF_GUARDED_BY(mu_);
+  // Maps the keys of the entries to their index in `results_`.
+  absl::flat_hash_map<std::string, int> index_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_PERSISTENT_AUTOTUNE_CACHE_H_
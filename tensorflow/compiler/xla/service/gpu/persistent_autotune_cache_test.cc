@@ -0,0 +1,117 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/persistent_autotune_cache.h"
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_autotuning.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+AutotuneResultsEntry MakeTestKey(const std::string& hlo, int cc_major) {
+  AutotuneResultsEntry key;
+  key.set_hlo(hlo);
+  key.set_device("Test GPU");
+  key.mutable_cc()->set_major(cc_major);
+  key.mutable_cudnn_version()->set_major(8);
+  key.set_blas_version("11000");
+  return key;
+}
+
+tensorflow::AutotuneResult MakeGemmResult(int64 algorithm) {
+  tensorflow::AutotuneResult result;
+  result.mutable_gemm()->set_algorithm(algorithm);
+  return result;
+}
+
+// The parameter is the extension of the results file, which selects its
+// format.
+class PersistentAutotuneCacheTest
+    : public ::testing::TestWithParam<std::string> {
+ protected:
+  std::string TestPath() {
+    return tensorflow::io::JoinPath(
+        tensorflow::testing::TmpDir(),
+        absl::StrCat("autotune_results", GetParam()));
+  }
+
+  void SetUp() override {
+    tensorflow::Env::Default()->DeleteFile(TestPath()).IgnoreError();
+  }
+};
+
+TEST_P(PersistentAutotuneCacheTest, ResultsArePersisted) {
+  const AutotuneResultsEntry key = MakeTestKey("dot", /*cc_major=*/7);
+  {
+    PersistentAutotuneCache cache(TestPath());
+    EXPECT_FALSE(cache.Lookup(key).has_value());
+    cache.Insert(key, MakeGemmResult(3));
+    ASSERT_TRUE(cache.Lookup(key).has_value());
+  }
+
+  PersistentAutotuneCache cache(TestPath());
+  EXPECT_EQ(cache.size(), 1);
+  absl::optional<tensorflow::AutotuneResult> result = cache.Lookup(key);
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->gemm().algorithm(), 3);
+
+  // The same instruction on another GPU needs its own result.
+  EXPECT_FALSE(cache.Lookup(MakeTestKey("dot", /*cc_major=*/8)).has_value());
+}
+
+TEST_P(PersistentAutotuneCacheTest, MergesResultsOfOtherProcesses) {
+  const AutotuneResultsEntry key_a = MakeTestKey("a", /*cc_major=*/7);
+  const AutotuneResultsEntry key_b = MakeTestKey("b", /*cc_major=*/7);
+  PersistentAutotuneCache cache_a(TestPath());
+  PersistentAutotuneCache cache_b(TestPath());
+  cache_a.Insert(key_a, MakeGemmResult(1));
+  cache_b.Insert(key_b, MakeGemmResult(2));
+
+  PersistentAutotuneCache cache(TestPath());
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_TRUE(cache.Lookup(key_a).has_value());
+  EXPECT_TRUE(cache.Lookup(key_b).has_value());
+}
+
+TEST_P(PersistentAutotuneCacheTest, IgnoresOtherVersions) {
+  AutotuneResults results;
+  results.set_version(kAutotuneResultsVersion + 1);
+  AutotuneResultsEntry* entry = results.add_entries();
+  *entry = MakeTestKey("dot", /*cc_major=*/7);
+  *entry->mutable_result() = MakeGemmResult(3);
+  if (GetParam() == ".pbtxt") {
+    TF_ASSERT_OK(tensorflow::WriteTextProto(tensorflow::Env::Default(),
+                                            TestPath(), results));
+  } else {
+    TF_ASSERT_OK(tensorflow::WriteBinaryProto(tensorflow::Env::Default(),
+                                              TestPath(), results));
+  }
+
+  PersistentAutotuneCache cache(TestPath());
+  EXPECT_EQ(cache.size(), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Formats, PersistentAutotuneCacheTest,
+                         ::testing::Values(".pb", ".pbtxt"));
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
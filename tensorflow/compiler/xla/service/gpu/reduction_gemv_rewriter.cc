@@ -0,0 +1,116 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/reduction_gemv_rewriter.h"
+
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/dfs_hlo_visitor_with_default.h"
+#include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/pattern_matcher.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+namespace m = match;
+
+class ReductionGemvRewriterVisitor : public DfsHloRewriteVisitor {
+ public:
+  ReductionGemvRewriterVisitor(int64 min_reduced_rows, int64 max_kept_columns)
+      : min_reduced_rows_(min_reduced_rows),
+        max_kept_columns_(max_kept_columns) {}
+
+  Status HandleReduce(HloInstruction* reduce) override {
+    if (!reduce->shape().IsArray()) {
+      return Status::OK();
+    }
+    const PrimitiveType type = reduce->shape().element_type();
+    if (type != F16 && type != F32 && type != F64) {
+      return Status::OK();
+    }
+    if (!Match(reduce->to_apply()->root_instruction(),
+               m::Add(m::Parameter(), m::Parameter())) ||
+        !Match(reduce->operand(1), m::ConstantScalar(0))) {
+      return Status::OK();
+    }
+    if (!IsReductionFromOrToContiguousDimensions(*reduce)) {
+      return Status::OK();
+    }
+    ReductionDimensions reduction_dimensions =
+        GetReductionKindAndContiguousComponents(*reduce);
+    if (reduction_dimensions.is_row_reduction ||
+        reduction_dimensions.dimensions[0] != 1) {
+      return Status::OK();
+    }
+    const int64 rows = reduction_dimensions.dimensions[1];
+    const int64 columns = reduction_dimensions.dimensions[2];
+    if (rows < min_reduced_rows_ || columns == 0 ||
+        columns > max_kept_columns_) {
+      return Status::OK();
+    }
+    // With descending layouts the reduced dimensions are the major ones, and
+    // the product comes out with the kept dimensions in the output order.
+    HloInstruction* input = reduce->mutable_operand(0);
+    if (!LayoutUtil::IsMonotonicWithDim0Major(input->shape().layout()) ||
+        !LayoutUtil::IsMonotonicWithDim0Major(reduce->shape().layout())) {
+      return Status::OK();
+    }
+
+    VLOG(3) << "Rewriting " << reduce->name() << " reducing " << rows
+            << " rows into " << columns << " columns as a GEMV";
+    HloComputation* computation = reduce->parent();
+    HloInstruction* one = computation->AddInstruction(
+        HloInstruction::CreateConstant(LiteralUtil::One(type)));
+    HloInstruction* ones =
+        computation->AddInstruction(HloInstruction::CreateBroadcast(
+            ShapeUtil::MakeShapeWithDescendingLayout(type, {1, rows}), one,
+            {}));
+    HloInstruction* matrix =
+        computation->AddInstruction(HloInstruction::CreateBitcast(
+            ShapeUtil::MakeShapeWithDescendingLayout(type, {rows, columns}),
+            input));
+    DotDimensionNumbers dot_dimension_numbers;
+    dot_dimension_numbers.add_lhs_contracting_dimensions(1);
+    dot_dimension_numbers.add_rhs_contracting_dimensions(0);
+    PrecisionConfig precision_config;
+    precision_config.mutable_operand_precision()->Resize(
+        2, PrecisionConfig::DEFAULT);
+    HloInstruction* gemv =
+        computation->AddInstruction(HloInstruction::CreateDot(
+            ShapeUtil::MakeShapeWithDescendingLayout(type, {1, columns}), ones,
+            matrix, dot_dimension_numbers, precision_config));
+    gemv->set_metadata(reduce->metadata());
+    return ReplaceWithNewInstruction(
+        reduce, HloInstruction::CreateBitcast(reduce->shape(), gemv));
+  }
+
+ private:
+  const int64 min_reduced_rows_;
+  const int64 max_kept_columns_;
+};
+
+}  // namespace
+
+StatusOr<bool> ReductionGemvRewriter::Run(HloModule* module) {
+  return ReductionGemvRewriterVisitor(min_reduced_rows_, max_kept_columns_)
+      .RunOnModule(module);
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,72 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_REDUCTION_GEMV_REWRITER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_REDUCTION_GEMV_REWRITER_H_
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+namespace gpu {
+
+// Rewrites column reductions that sum many rows into few columns as a
+// matrix-vector product, which GemmRewriter then turns into a cuBLAS call.
+//
+// The tiled column reduction emitter assigns a warp to each 32 columns, so a
+// reduction into fewer columns than a warp leaves most of the threads idle,
+// while cuBLAS GEMV keeps the whole device busy reading the rows.
+//
+// Rewriting:
+//
+// f32[N] out = reduce(f32[K, N] input, f32[] 0), dimensions={0}, to_apply=add
+//
+// Into:
+//
+// f32[1, K] ones = broadcast(f32[] 1)
+// f32[1, N] gemv = dot(ones, input), lhs_contracting_dims={1},
+//                                    rhs_contracting_dims={0}
+// f32[N] out = bitcast(gemv)
+//
+// Only F16, F32 and F64 sums with zero as the initial value are rewritten,
+// when K is at least `min_reduced_rows` and N is at most `max_kept_columns`.
+//
+// Precondition: the reduction layouts have been normalized and the adjacent
+// reduced dimensions grouped. Run it after AlgebraicSimplifier, which would
+// strength-reduce the matrix-vector product back into a reduction.
+class ReductionGemvRewriter : public HloModulePass {
+ public:
+  explicit ReductionGemvRewriter(int64 min_reduced_rows = 1 << 16,
+                                 int64 max_kept_columns = 16)
+      : min_reduced_rows_(min_reduced_rows),
+        max_kept_columns_(max_kept_columns) {}
+
+  absl::string_view name() const override {
+    return "reduction-gemv-rewriter";
+  }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  const int64 min_reduced_rows_;
+  const int64 max_kept_columns_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_REDUCTION_GEMV_REWRITER_H_
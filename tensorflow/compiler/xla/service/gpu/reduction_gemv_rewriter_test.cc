@@ -0,0 +1,145 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/reduction_gemv_rewriter.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class ReductionGemvRewriterTest : public HloTestBase {};
+
+TEST_F(ReductionGemvRewriterTest, RewritesNarrowColumnReduction) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test
+
+  add {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  ENTRY entry {
+    p = f32[4096,8]{1,0} parameter(0)
+    zero = f32[] constant(0)
+    ROOT reduce = f32[8]{0} reduce(p, zero), dimensions={0}, to_apply=add
+  }
+  )")
+                    .ValueOrDie();
+  ASSERT_TRUE(ReductionGemvRewriter(/*min_reduced_rows=*/1024)
+                  .Run(module.get())
+                  .ValueOrDie());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::Bitcast(op::Dot(op::Broadcast(op::Constant()),
+                                        op::Bitcast(op::Parameter(0)))));
+  EXPECT_TRUE(ShapeUtil::Equal(root->shape(), ShapeUtil::MakeShape(F32, {8})));
+  EXPECT_TRUE(ShapeUtil::Equal(root->operand(0)->shape(),
+                               ShapeUtil::MakeShape(F32, {1, 8})));
+}
+
+TEST_F(ReductionGemvRewriterTest, RewritesGroupedKeptDimensions) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test
+
+  add {
+    x = f16[] parameter(0)
+    y = f16[] parameter(1)
+    ROOT add = f16[] add(x, y)
+  }
+
+  ENTRY entry {
+    p = f16[2048,2,4]{2,1,0} parameter(0)
+    zero = f16[] constant(0)
+    ROOT reduce = f16[2,4]{1,0} reduce(p, zero), dimensions={0}, to_apply=add
+  }
+  )")
+                    .ValueOrDie();
+  ASSERT_TRUE(ReductionGemvRewriter(/*min_reduced_rows=*/1024)
+                  .Run(module.get())
+                  .ValueOrDie());
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::Bitcast(op::Dot()));
+  EXPECT_TRUE(ShapeUtil::Equal(root->operand(0)->operand(1)->shape(),
+                               ShapeUtil::MakeShape(F16, {2048, 8})));
+}
+
+TEST_F(ReductionGemvRewriterTest, KeepsWideAndShortColumnReductions) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test
+
+  add {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  ENTRY entry {
+    p0 = f32[4096,256]{1,0} parameter(0)
+    p1 = f32[64,8]{1,0} parameter(1)
+    zero = f32[] constant(0)
+    wide = f32[256]{0} reduce(p0, zero), dimensions={0}, to_apply=add
+    short = f32[8]{0} reduce(p1, zero), dimensions={0}, to_apply=add
+    ROOT tuple = (f32[256]{0}, f32[8]{0}) tuple(wide, short)
+  }
+  )")
+                    .ValueOrDie();
+  EXPECT_FALSE(ReductionGemvRewriter(/*min_reduced_rows=*/1024)
+                   .Run(module.get())
+                   .ValueOrDie());
+}
+
+TEST_F(ReductionGemvRewriterTest, KeepsRowAndNonAddReductions) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+  HloModule test
+
+  add {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT add = f32[] add(x, y)
+  }
+
+  max {
+    x = f32[] parameter(0)
+    y = f32[] parameter(1)
+    ROOT max = f32[] maximum(x, y)
+  }
+
+  ENTRY entry {
+    p0 = f32[8,4096]{1,0} parameter(0)
+    p1 = f32[4096,8]{1,0} parameter(1)
+    zero = f32[] constant(0)
+    one = f32[] constant(1)
+    row = f32[8]{0} reduce(p0, zero), dimensions={1}, to_apply=add
+    maximum = f32[8]{0} reduce(p1, zero), dimensions={0}, to_apply=max
+    offset = f32[8]{0} reduce(p1, one), dimensions={0}, to_apply=add
+    ROOT tuple = (f32[8]{0}, f32[8]{0}, f32[8]{0}) tuple(row, maximum, offset)
+  }
+  )")
+                    .ValueOrDie();
+  EXPECT_FALSE(ReductionGemvRewriter(/*min_reduced_rows=*/1024)
+                   .Run(module.get())
+                   .ValueOrDie());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,105 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/gpu/tests/gpu_codegen_test.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+class CudaGraphTest : public GpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = GpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_gpu_enable_cuda_graphs(true);
+    return debug_options;
+  }
+};
+
+// A fusion followed by a gemm can be captured; running the same executable
+// again replays the captured graph.
+TEST_F(CudaGraphTest, ReplaysCapturedThunks) {
+  const char* hlo_text = R"(
+HloModule mod
+ENTRY main {
+  p0 = f32[16,16] parameter(0)
+  p1 = f32[16,16] parameter(1)
+  add = f32[16,16] add(p0, p1)
+  exp = f32[16,16] exponential(add)
+  ROOT dot = f32[16,16] dot(exp, p1), lhs_contracting_dims={1},
+                                      rhs_contracting_dims={0}
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-3, 1e-3}));
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Executable> executable,
+      test_runner_.CreateExecutable(std::move(module),
+                                    /*run_hlo_passes=*/true));
+  Literal p0 =
+      LiteralUtil::CreateFullWithDescendingLayout<float>({16, 16}, 0.f);
+  Literal p1 =
+      LiteralUtil::CreateFullWithDescendingLayout<float>({16, 16}, 1.f);
+  Literal expected = LiteralUtil::CreateFullWithDescendingLayout<float>(
+      {16, 16}, 16 * std::exp(1.f));
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(
+        Literal result,
+        test_runner_.ExecuteWithExecutable(executable.get(), {&p0, &p1}));
+    EXPECT_TRUE(LiteralTestUtil::Near(expected, result, ErrorSpec{1e-2, 1e-3}))
+        << "run " << i;
+  }
+}
+
+// Control flow can't be captured, so the thunks are run one by one.
+TEST_F(CudaGraphTest, FallsBackOnWhileLoop) {
+  const char* hlo_text = R"(
+HloModule mod
+cond {
+  p = (s32[], f32[8]) parameter(0)
+  i = s32[] get-tuple-element(p), index=0
+  n = s32[] constant(4)
+  ROOT lt = pred[] compare(i, n), direction=LT
+}
+body {
+  p = (s32[], f32[8]) parameter(0)
+  i = s32[] get-tuple-element(p), index=0
+  x = f32[8] get-tuple-element(p), index=1
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  next_x = f32[8] add(x, x)
+  ROOT t = (s32[], f32[8]) tuple(next_i, next_x)
+}
+ENTRY main {
+  x = f32[8] parameter(0)
+  zero = s32[] constant(0)
+  init = (s32[], f32[8]) tuple(zero, x)
+  loop = (s32[], f32[8]) while(init), condition=cond, body=body
+  ROOT out = f32[8] get-tuple-element(loop), index=1
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-5, 1e-5}));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
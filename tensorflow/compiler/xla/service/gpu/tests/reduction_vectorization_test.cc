@@ -44,6 +44,14 @@ class ReductionVectorizationNoOptTest : public GpuCodegenTest {
   }
 };
 
+class ColumnReductionVectorizationTest : public GpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = GpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_gpu_vectorize_column_reductions(true);
+    return debug_options;
+  }
+};
+
 TEST_F(ReductionVectorizationNoOptTest, MultiOutputStore) {
   const char* hlo_text = R"(
 HloModule MultiOutputStore
@@ -106,6 +114,26 @@ CHECK: st.global.v2.f32
   EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-5, 1e-5}));
 }
 
+TEST_F(ColumnReductionVectorizationTest, HalfColumnReduction) {
+  const char* hlo_text = R"(
+HloModule HalfColumnReduction
+
+%add_f32 {
+  %x = f32[] parameter(0)
+  %y = f32[] parameter(1)
+  ROOT %add = f32[] add(%x, %y)
+}
+
+ENTRY %cluster {
+  %param = f16[1000,512] parameter(0)
+  %convert = f32[1000,512] convert(%param)
+  %constant = f32[] constant(0)
+  ROOT %reduce = f32[512] reduce(%convert, %constant), dimensions={0}, to_apply=%add_f32
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-3, 1e-3}));
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
@@ -32,6 +32,10 @@ StatusOr<GlobalDeviceId> Thunk::ExecuteParams::GetGlobalDeviceId() const {
 
 /*static*/ absl::string_view Thunk::KindToString(Thunk::Kind kind) {
   switch (kind) {
+    case Thunk::kAsyncCopyDone:
+      return "kAsyncCopyDone";
+    case Thunk::kAsyncCopyStart:
+      return "kAsyncCopyStart";
     case Thunk::kCholesky:
       return "kCholesky";
     case Thunk::kCollectivePermute:
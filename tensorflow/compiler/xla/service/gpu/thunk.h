@@ -44,6 +44,8 @@ class GpuExecutable;
 class Thunk {
  public:
   enum Kind {
+    kAsyncCopyDone,
+    kAsyncCopyStart,
     kCholesky,
     kCollectivePermute,
     kConditional,
@@ -425,6 +425,11 @@ HeapSimulator::Result<HloValue> HeapSimulator::Finish() {
   // Fragmentation is the difference between the actual and ideal sizes.
   const Result<HloValue> no_frag_result = no_fragmentation_stats_->Finish();
   result.fragmentation_size = result.heap_size - no_frag_result.heap_size;
+  if (result.repacked_size > 0) {
+    VLOG(1) << "Repacking lowered the heap fragmentation from "
+            << result.fragmentation_size + result.repacked_size << " to "
+            << result.fragmentation_size << " bytes";
+  }
 
   // Copy the debug trace we collected to the final result.
   result.debug_trace.Swap(&debug_trace_);
@@ -829,8 +834,11 @@ GlobalDecreasingSizeBestFitHeap<BufferType>::Finish() {
     // maximum heap size, so it just commits.
     CommitChunk(buffer_interval, chunk_candidate);
   }
-  VLOG(1) << "result heap_size: " << result_.heap_size;
   Result result;
+  if (repack_) {
+    result.repacked_size = RepackChunks();
+  }
+  VLOG(1) << "result heap_size: " << result_.heap_size;
   result.heap_size = result_.heap_size;
   result.heap_results.emplace_back(result_);
   return result;
@@ -976,6 +984,89 @@ void GlobalDecreasingSizeBestFitHeap<BufferType>::AddToChunkMap(
   DCHECK(emplace_result.second);
 }
 
+template <typename BufferType>
+int64 GlobalDecreasingSizeBestFitHeap<BufferType>::RepackChunks() {
+  // Every chunk that moves lands lower, so the passes converge; a few of them
+  // catch nearly all of the gains.
+  constexpr int kMaxRepackingPasses = 4;
+
+  // Zero-sized buffers have no interval and stay at offset 0.
+  std::vector<const BufferInterval*> intervals;
+  for (const auto& entry : result_.chunk_map) {
+    auto it = buffer_intervals_.find(entry.first);
+    if (it != buffer_intervals_.end() && it->second.need_allocation) {
+      intervals.push_back(&it->second);
+    }
+  }
+  const int64 original_heap_size = result_.heap_size;
+  bool moved = true;
+  for (int pass = 0; moved && pass < kMaxRepackingPasses; ++pass) {
+    moved = false;
+    auto offset_of = [&](const BufferInterval* interval) {
+      return result_.chunk_map.at(interval->buffer).offset;
+    };
+    absl::c_sort(intervals,
+                 [&](const BufferInterval* x, const BufferInterval* y) {
+                   if (offset_of(x) != offset_of(y)) {
+                     return offset_of(x) < offset_of(y);
+                   }
+                   return *x->buffer < *y->buffer;
+                 });
+    for (const BufferInterval* interval : intervals) {
+      // A buffer moves together with the buffers colocated with it.
+      std::vector<const BufferInterval*> group = {interval};
+      for (const BufferType* colocation : GetTransitiveColocations(*interval)) {
+        group.push_back(&buffer_intervals_.at(colocation));
+      }
+      const Chunk old_chunk = result_.chunk_map.at(interval->buffer);
+      for (const BufferInterval* member : group) {
+        CHECK(interval_tree_.Remove(member->start, member->end, old_chunk));
+      }
+      std::vector<Chunk> chunks_overlapping_in_time;
+      for (const BufferInterval* member : group) {
+        std::vector<Chunk> overlapping =
+            interval_tree_.ChunksOverlappingInTime(member->start, member->end);
+        chunks_overlapping_in_time.insert(chunks_overlapping_in_time.end(),
+                                          overlapping.begin(),
+                                          overlapping.end());
+      }
+      absl::c_sort(chunks_overlapping_in_time,
+                   [](const Chunk& x, const Chunk& y) {
+                     return x.offset < y.offset;
+                   });
+
+      // Find the lowest free chunk that can hold this buffer.
+      int64 offset = 0;
+      for (const Chunk& chunk : chunks_overlapping_in_time) {
+        if (offset + old_chunk.size <= chunk.offset) {
+          break;
+        }
+        offset =
+            std::max(offset, RoundUpToNearest(chunk.chunk_end(), alignment_));
+      }
+      Chunk new_chunk = old_chunk;
+      if (offset < old_chunk.offset) {
+        VLOG(3) << "Repacking " << interval->buffer->ToString() << " from "
+                << old_chunk.offset << " to " << offset;
+        new_chunk.offset = offset;
+        moved = true;
+      }
+      for (const BufferInterval* member : group) {
+        interval_tree_.Add(member->start, member->end, new_chunk);
+        result_.chunk_map[member->buffer] = new_chunk;
+      }
+    }
+  }
+
+  result_.heap_size = 0;
+  for (const auto& entry : result_.chunk_map) {
+    result_.heap_size = std::max(result_.heap_size, entry.second.chunk_end());
+  }
+  VLOG(1) << "Repacking shrank the heap from " << original_heap_size << " to "
+          << result_.heap_size << " bytes";
+  return original_heap_size - result_.heap_size;
+}
+
 HeapSimulator::Result<HloValue>
 ConstrainedGlobalDecreasingSizeBestFitHeap::Finish() {
   std::vector<BufferInterval> sorted_buffer_vec = GetSortedBufferIntervals();
@@ -1017,6 +1108,9 @@ ConstrainedGlobalDecreasingSizeBestFitHeap::Finish() {
     }
     // Collect the result from the currently processed heap and reset the heap
     // states.
+    if (repack_) {
+      multi_heap_result.repacked_size += RepackChunks();
+    }
     multi_heap_result.heap_size += result_.heap_size;
     multi_heap_result.heap_results.push_back(std::move(result_));
     result_ = {};
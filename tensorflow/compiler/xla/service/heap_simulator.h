@@ -88,6 +88,10 @@ class HeapSimulator {
     // The total size in bytes of heap fragmentation.
     int64 fragmentation_size = 0;
 
+    // The total size in bytes by which repacking shrank the heaps; the
+    // fragmentation before repacking is fragmentation_size + repacked_size.
+    int64 repacked_size = 0;
+
     // A trace of heap simulation events.
     HeapSimulatorTrace debug_trace;
   };
@@ -399,6 +403,14 @@ class GlobalDecreasingSizeBestFitHeap : public HeapAlgorithm<BufferType> {
 
   Result Finish() override;
 
+  // Enables a repacking phase at the end of Finish(). Best-fit can place a
+  // buffer in a tight hole high in the heap while a larger hole below stays
+  // empty. Repacking visits the chunks in increasing offset order and slides
+  // each down to the lowest offset that is free during its live interval, so
+  // that the chunks visited later can use the space left behind. Chunks never
+  // move up, so the heap never grows.
+  void set_repack(bool repack) { repack_ = repack; }
+
   // Return a BufferIntervalCompare function that sort by spatial size. We don't
   // look at co-locates as they should have the same size.
   static BufferIntervalCompare GetSpatialBufferIntervalCompare();
@@ -430,6 +442,10 @@ class GlobalDecreasingSizeBestFitHeap : public HeapAlgorithm<BufferType> {
   // Adds the buffer and the chunk to the result chunk map.
   virtual void AddToChunkMap(const BufferType* buffer, Chunk chunk);
 
+  // Runs the repacking phase described in set_repack() on the chunks committed
+  // to result_, and returns the number of bytes by which the heap shrank.
+  int64 RepackChunks();
+
   // Return a BufferIntervalCompare function that sorts by live ranges.  A live
   // range is defined by the range between the start of the first buffer and the
   // end of the last co-located buffer.  There could be "holes" in the live
@@ -441,6 +457,7 @@ class GlobalDecreasingSizeBestFitHeap : public HeapAlgorithm<BufferType> {
   HeapResult result_;
   BufferIntervalCompare buffer_interval_compare_;
   BufferIntervalTree interval_tree_;
+  bool repack_ = false;
 
  private:
   int64 alignment_;
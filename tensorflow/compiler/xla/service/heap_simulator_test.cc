@@ -1285,6 +1285,55 @@ TEST_F(GlobalDecreasingSizeBestFitHeapTest, ColocatedIII) {
   EXPECT_EQ(30, result.chunk_map.at(buffer_c_).offset);
 }
 
+TEST_F(GlobalDecreasingSizeBestFitHeapTest, Repack) {
+  // Best-fit places a in the tight hole above b instead of the hole that d
+  // leaves at the bottom, which pushes c to the top of the heap:
+  //
+  // space                                     after repacking
+  //   ^                                         ^
+  //   |        +-c-+                            |
+  //   |+--b--+  +----a----+                     |+--b--+ +-c-+
+  //   |                                         |
+  //   |   +-----------e-----------+             |   +-----------e-----------+
+  //   |                                         |
+  //   | +-----d-----+                           | +-----d-----+ +----a----+
+  //   ---------------------> time               ---------------------> time
+  auto run = [&](bool repack) {
+    GlobalDecreasingSizeBestFitHeap<HloValue> heap(/*alignment=*/1);
+    heap.set_repack(repack);
+    heap.Alloc(buffer_b_, 40);
+    heap.Alloc(buffer_d_, 60);
+    heap.Alloc(buffer_e_, 50);
+    heap.Free(buffer_b_, 40);
+    heap.Alloc(buffer_c_, 20);
+    heap.Free(buffer_d_, 60);
+    heap.Alloc(buffer_a_, 30);
+    heap.Free(buffer_c_, 20);
+    heap.Free(buffer_a_, 30);
+    heap.Free(buffer_e_, 50);
+    return heap.Finish();
+  };
+
+  const HeapSimulator::Result<HloValue> best_fit = run(/*repack=*/false);
+  EXPECT_EQ(160, best_fit.heap_size);
+  EXPECT_EQ(0, best_fit.repacked_size);
+  EXPECT_EQ(110, best_fit.heap_results.at(0).chunk_map.at(buffer_a_).offset);
+  EXPECT_EQ(140, best_fit.heap_results.at(0).chunk_map.at(buffer_c_).offset);
+
+  const HeapSimulator::Result<HloValue> results = run(/*repack=*/true);
+  EXPECT_EQ(150, results.heap_size);
+  EXPECT_EQ(10, results.repacked_size);
+  EXPECT_EQ(1, results.heap_results.size());
+  const HeapSimulator::HeapResult<HloValue>& result =
+      results.heap_results.at(0);
+  EXPECT_EQ(150, result.heap_size);
+  EXPECT_EQ(0, result.chunk_map.at(buffer_a_).offset);
+  EXPECT_EQ(110, result.chunk_map.at(buffer_b_).offset);
+  EXPECT_EQ(110, result.chunk_map.at(buffer_c_).offset);
+  EXPECT_EQ(0, result.chunk_map.at(buffer_d_).offset);
+  EXPECT_EQ(60, result.chunk_map.at(buffer_e_).offset);
+}
+
 TEST_F(GlobalDecreasingSizeBestFitHeapTest, ChunkCandidate) {
   // space
   //   ^
@@ -49,8 +49,12 @@ limitations under the License.
 #include "tensorflow/core/lib/core/bitmap.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/stream_executor/lib/statusor.h"
 
@@ -58,6 +62,119 @@ namespace xla {
 
 namespace {
 
+// The number of elements below which handing a range of an array to another
+// thread costs more than it saves.
+constexpr int64 kMinParallelWork = 1 << 14;
+
+tensorflow::thread::ThreadPool* EvaluatorThreadPool() {
+  static tensorflow::thread::ThreadPool* pool =
+      new tensorflow::thread::ThreadPool(tensorflow::Env::Default(),
+                                         "hlo_evaluator",
+                                         tensorflow::port::MaxParallelism());
+  return pool;
+}
+
+// Returns the distance in the linear storage of an array of `shape` between
+// consecutive indices of each dimension.
+std::vector<int64> LinearStrides(const Shape& shape) {
+  std::vector<int64> strides(shape.rank());
+  int64 stride = 1;
+  for (int64 dim : LayoutUtil::MinorToMajor(shape)) {
+    strides[dim] = stride;
+    stride *= shape.dimensions(dim);
+  }
+  return strides;
+}
+
+// Fills `result`, an array of `result_shape`, with the elements of `source`
+// such that the element at index I of the result is the element at linear
+// index sum(I[d] * strides[d]) of the source.  Both transposes and broadcasts
+// are such gathers.  The result is written in its storage order, so each run
+// along its most minor dimension reads the source at a fixed stride.
+template <typename T>
+void StridedGather(const T* source, absl::Span<const int64> strides,
+                   const Shape& result_shape, T* result) {
+  const int64 rank = result_shape.rank();
+  const int64 size = ShapeUtil::ElementsIn(result_shape);
+  if (size == 0) {
+    return;
+  }
+  if (rank == 0) {
+    result[0] = source[0];
+    return;
+  }
+  const int64 minor = LayoutUtil::Minor(result_shape.layout(), 0);
+  const int64 minor_size = result_shape.dimensions(minor);
+  const int64 minor_stride = strides[minor];
+  HloEvaluator::ParallelForLinearRange(size, [&](int64 begin, int64 end) {
+    std::vector<int64> index =
+        IndexUtil::LinearIndexToMultidimensionalIndex(result_shape, begin);
+    int64 offset = 0;
+    for (int64 d = 0; d < rank; ++d) {
+      offset += index[d] * strides[d];
+    }
+    for (int64 i = begin; i < end;) {
+      const int64 run = std::min(minor_size - index[minor], end - i);
+      for (int64 k = 0; k < run; ++k) {
+        result[i + k] = source[offset + k * minor_stride];
+      }
+      i += run;
+      index[minor] += run;
+      offset += run * minor_stride;
+      // Carry into the more major dimensions.
+      for (int64 n = 0; n + 1 < rank; ++n) {
+        const int64 dim = LayoutUtil::Minor(result_shape.layout(), n);
+        if (index[dim] < result_shape.dimensions(dim)) {
+          break;
+        }
+        offset -= index[dim] * strides[dim];
+        index[dim] = 0;
+        const int64 next = LayoutUtil::Minor(result_shape.layout(), n + 1);
+        ++index[next];
+        offset += strides[next];
+      }
+    }
+  });
+}
+
+// Evaluates a transpose or broadcast of `operand` into a literal of
+// `result_shape` with StridedGather.  Returns nullopt for the element types
+// and shapes the gather does not support, which take the generic path.
+absl::optional<Literal> GatherWithStrides(const Literal& operand,
+                                          absl::Span<const int64> strides,
+                                          const Shape& result_shape) {
+  if (!LayoutUtil::IsDenseArray(operand.shape()) ||
+      !LayoutUtil::IsDenseArray(result_shape) ||
+      !LayoutUtil::HasLayout(result_shape) || operand.shape().is_dynamic() ||
+      result_shape.is_dynamic()) {
+    return absl::nullopt;
+  }
+  Literal result(result_shape);
+  const void* source = operand.untyped_data();
+  void* destination = result.untyped_data();
+  switch (ShapeUtil::ByteSizeOfPrimitiveType(result_shape.element_type())) {
+    case 1:
+      StridedGather(static_cast<const uint8*>(source), strides, result_shape,
+                    static_cast<uint8*>(destination));
+      break;
+    case 2:
+      StridedGather(static_cast<const uint16*>(source), strides, result_shape,
+                    static_cast<uint16*>(destination));
+      break;
+    case 4:
+      StridedGather(static_cast<const uint32*>(source), strides, result_shape,
+                    static_cast<uint32*>(destination));
+      break;
+    case 8:
+      StridedGather(static_cast<const uint64*>(source), strides, result_shape,
+                    static_cast<uint64*>(destination));
+      break;
+    default:
+      return absl::nullopt;
+  }
+  return std::move(result);
+}
+
 template <typename OperandT>
 StatusOr<Literal> Compare(const Shape& shape, ComparisonDirection direction,
                           LiteralSlice lhs_literal, LiteralSlice rhs_literal) {
@@ -513,9 +630,50 @@ Status HloEvaluator::HandleReshape(HloInstruction* reshape) {
   return Status::OK();
 }
 
+/*static*/ bool HloEvaluator::HasSameElementOrder(const LiteralBase& literal,
+                                                 const Shape& shape) {
+  return LayoutUtil::IsDenseArray(literal.shape()) &&
+         LayoutUtil::IsDenseArray(shape) &&
+         ShapeUtil::SameDimensions(literal.shape(), shape) &&
+         Layout::Equal().MinorToMajorOnly()(literal.shape().layout(),
+                                            shape.layout());
+}
+
+/*static*/ void HloEvaluator::ParallelForLinearRange(
+    int64 size, const std::function<void(int64, int64)>& fn,
+    int64 work_per_index) {
+  const int64 num_ranges = std::min<int64>(
+      {static_cast<int64>(tensorflow::port::MaxParallelism()), size,
+       CeilOfRatio(size * work_per_index, kMinParallelWork)});
+  // The evaluations nested in a parallel range, such as the reduction
+  // computations, run on a single thread.
+  if (num_ranges <= 1 || EvaluatorThreadPool()->CurrentThreadId() != -1) {
+    fn(0, size);
+    return;
+  }
+  EvaluatorThreadPool()->ParallelFor(
+      size,
+      tensorflow::thread::ThreadPool::SchedulingParams(
+          tensorflow::thread::ThreadPool::SchedulingStrategy::kFixedBlockSize,
+          /*cost_per_unit=*/absl::nullopt,
+          /*block_size=*/CeilOfRatio(size, num_ranges)),
+      fn);
+}
+
 Status HloEvaluator::HandleTranspose(HloInstruction* transpose) {
-  evaluated_[transpose] = GetEvaluatedLiteralFor(transpose->operand(0))
-                              .Transpose(transpose->dimensions());
+  const Literal& operand = GetEvaluatedLiteralFor(transpose->operand(0));
+  // Gathering straight into the layout of the transpose saves the relayout
+  // of the permuted literal in Postprocess.
+  const std::vector<int64> operand_strides = LinearStrides(operand.shape());
+  std::vector<int64> strides;
+  for (int64 operand_dim : transpose->dimensions()) {
+    strides.push_back(operand_strides[operand_dim]);
+  }
+  absl::optional<Literal> result =
+      GatherWithStrides(operand, strides, transpose->shape());
+  evaluated_[transpose] = result.has_value()
+                              ? std::move(*result)
+                              : operand.Transpose(transpose->dimensions());
   return Status::OK();
 }
 
@@ -1889,6 +2047,17 @@ Status HloEvaluator::HandleBroadcast(HloInstruction* broadcast) {
         broadcast->ToString());
   }
 
+  const std::vector<int64> operand_strides = LinearStrides(operand.shape());
+  std::vector<int64> strides(broadcast->shape().rank(), 0);
+  for (int64 i = 0; i < broadcast->dimensions().size(); ++i) {
+    strides[broadcast->dimensions(i)] = operand_strides[i];
+  }
+  absl::optional<Literal> result =
+      GatherWithStrides(operand, strides, broadcast->shape());
+  if (result.has_value()) {
+    evaluated_[broadcast] = std::move(*result);
+    return Status::OK();
+  }
   TF_ASSIGN_OR_RETURN(
       evaluated_[broadcast],
       operand.Broadcast(broadcast->shape(), broadcast->dimensions()));
@@ -2524,19 +2693,41 @@ Status HloEvaluator::HandleReduce(HloInstruction* instr) {
     }
   }
 
-  HloEvaluator embedded_evaluator(max_loop_iterations_);
   absl::InlinedVector<Literal, 1> results(num_args);
   for (int64 i = 0; i < num_args; ++i) {
     results[i] = Literal(is_tuple ? out_shape.tuple_shapes(i) : out_shape);
   }
 
-  TF_RETURN_IF_ERROR(ShapeUtil::ForEachIndexWithStatus(
-      output_shape, [&](absl::Span<const int64> output_index) {
-        return GenerateReduceOutputElement(
-            is_tuple, output_index, init_values, input_args,
-            absl::Span<Literal>(results), function, &embedded_evaluator,
-            arg_dim_steps, arg_dim_counts, result_to_arg_index);
-      }));
+  // The output elements are independent, so ranges of them are reduced in
+  // parallel, each with its own evaluator for the reduction computation.
+  int64 reduced_size = 1;
+  for (const int64 dim : dimensions_to_reduce) {
+    reduced_size *= arg_dimensions[dim];
+  }
+  // Literals always have a layout, which maps linear indices to indices.
+  const Shape& indexed_shape = results[0].shape();
+  tensorflow::mutex status_mu;
+  Status status;
+  ParallelForLinearRange(
+      ShapeUtil::ElementsIn(indexed_shape),
+      [&](int64 begin, int64 end) {
+        HloEvaluator embedded_evaluator(max_loop_iterations_);
+        for (int64 i = begin; i < end; ++i) {
+          StatusOr<bool> generated = GenerateReduceOutputElement(
+              is_tuple,
+              IndexUtil::LinearIndexToMultidimensionalIndex(indexed_shape, i),
+              init_values, input_args, absl::Span<Literal>(results), function,
+              &embedded_evaluator, arg_dim_steps, arg_dim_counts,
+              result_to_arg_index);
+          if (!generated.ok()) {
+            tensorflow::mutex_lock lock(status_mu);
+            status.Update(generated.status());
+            return;
+          }
+        }
+      },
+      /*work_per_index=*/std::max<int64>(reduced_size, 1));
+  TF_RETURN_IF_ERROR(status);
 
   if (is_tuple) {
     Literal tuple_result(inferred_return_shape);
@@ -182,6 +182,14 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
   static std::unique_ptr<Array2D<int32>> MatmulArray2D(
       const Array2D<int32>& lhs, const Array2D<int32>& rhs);
 
+  // Calls `fn(begin, end)` on consecutive ranges that cover [0, size).  When
+  // the work is large enough, the ranges run in parallel on a thread pool
+  // shared by all evaluators; `work_per_index` scales the size of the work.
+  // `fn` must be thread-safe.
+  static void ParallelForLinearRange(
+      int64 size, const std::function<void(int64, int64)>& fn,
+      int64 work_per_index = 1);
+
  protected:
   // Make HloEvaluatorTypedVisitor a friend because it is logically part of this
   // class.
@@ -337,6 +345,12 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
   bool use_fast_path_ = false;
 
  private:
+  // Returns whether `literal` is a dense array that stores its elements in the
+  // same order as an array of `shape`, so that elementwise operations can walk
+  // both by linear index.
+  static bool HasSameElementOrder(const LiteralBase& literal,
+                                  const Shape& shape);
+
   template <typename ReturnT, typename NativeT>
   static StatusOr<Literal> ElementWiseUnaryOpImpl(
       HloInstruction* instruction,
@@ -347,6 +361,16 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     TF_RET_CHECK(ShapeUtil::SameDimensions(shape, operand->shape()));
 
     Literal result(shape);
+    if (HasSameElementOrder(operand_literal, shape)) {
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      absl::Span<const NativeT> operand_data = operand_literal.data<NativeT>();
+      ParallelForLinearRange(result_data.size(), [&](int64 begin, int64 end) {
+        for (int64 i = begin; i < end; ++i) {
+          result_data[i] = unary_op(operand_data[i]);
+        }
+      });
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
           return unary_op(operand_literal.Get<NativeT>(multi_index));
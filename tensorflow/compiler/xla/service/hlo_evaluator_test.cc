@@ -4678,5 +4678,100 @@ TEST_F(HloEvaluatorTest, SortC64) {
   EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
 }
 
+// Returns an s32 literal of `shape` whose elements encode their index.
+Literal MakeIndexLiteral(const Shape& shape) {
+  Literal literal(shape);
+  TF_CHECK_OK(literal.Populate<int32>([](absl::Span<const int64> index) {
+    int32 value = 0;
+    for (int64 i : index) {
+      value = value * 1000 + i;
+    }
+    return value;
+  }));
+  return literal;
+}
+
+// The following arrays are large enough for the evaluator to split the work
+// across threads, and mix layouts to cover the strided paths.
+TEST_F(HloEvaluatorTest, LargeTransposeAcrossLayouts) {
+  const absl::string_view hlo_text = R"(
+  HloModule m
+
+  ENTRY main {
+    p = s32[40,50,60]{0,2,1} parameter(0)
+    ROOT t = s32[60,40,50]{2,1,0} transpose(p), dimensions={2,0,1}
+  }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  Literal arg = MakeIndexLiteral(
+      ShapeUtil::MakeShapeWithLayout(S32, {40, 50, 60}, {0, 2, 1}));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate({&arg}));
+  EXPECT_TRUE(LiteralTestUtil::Equal(arg.Transpose({2, 0, 1}), result));
+}
+
+TEST_F(HloEvaluatorTest, LargeBroadcastIntoMinorMajorLayout) {
+  const absl::string_view hlo_text = R"(
+  HloModule m
+
+  ENTRY main {
+    p = s32[300,20]{1,0} parameter(0)
+    ROOT b = s32[20,50,300]{0,2,1} broadcast(p), dimensions={2,0}
+  }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  Literal arg = MakeIndexLiteral(ShapeUtil::MakeShape(S32, {300, 20}));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate({&arg}));
+  result.EachCell<int32>([&](absl::Span<const int64> index, int32 value) {
+    EXPECT_EQ(value, arg.Get<int32>({index[2], index[0]}));
+  });
+}
+
+TEST_F(HloEvaluatorTest, LargeElementwiseOps) {
+  const absl::string_view hlo_text = R"(
+  HloModule m
+
+  ENTRY main {
+    p0 = s32[400,300]{1,0} parameter(0)
+    p1 = s32[400,300]{0,1} parameter(1)
+    same_layout = s32[400,300]{1,0} add(p0, p0)
+    mixed_layouts = s32[400,300]{1,0} subtract(same_layout, p1)
+    ROOT negate = s32[400,300]{1,0} negate(mixed_layouts)
+  }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  Literal arg0 = MakeIndexLiteral(ShapeUtil::MakeShape(S32, {400, 300}));
+  Literal arg1 = MakeIndexLiteral(
+      ShapeUtil::MakeShapeWithLayout(S32, {400, 300}, {0, 1}));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate({&arg0, &arg1}));
+  result.EachCell<int32>([&](absl::Span<const int64> index, int32 value) {
+    const int32 x = arg0.Get<int32>(index);
+    EXPECT_EQ(value, -(x + x - x));
+  });
+}
+
+TEST_F(HloEvaluatorTest, LargeReduce) {
+  const absl::string_view hlo_text = R"(
+  HloModule m
+
+  max {
+    a = s32[] parameter(0)
+    b = s32[] parameter(1)
+    ROOT max = s32[] maximum(a, b)
+  }
+
+  ENTRY main {
+    p = s32[300,200]{1,0} parameter(0)
+    init = s32[] constant(-1)
+    ROOT reduce = s32[300]{0} reduce(p, init), dimensions={1}, to_apply=max
+  }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(m_, ParseAndReturnVerifiedModule(hlo_text));
+  Literal arg = MakeIndexLiteral(ShapeUtil::MakeShape(S32, {300, 200}));
+  TF_ASSERT_OK_AND_ASSIGN(Literal result, Evaluate({&arg}));
+  for (int64 i = 0; i < 300; ++i) {
+    EXPECT_EQ(result.Get<int32>({i}), i * 1000 + 199);
+  }
+}
+
 }  // namespace
 }  // namespace xla
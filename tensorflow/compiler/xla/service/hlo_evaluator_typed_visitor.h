@@ -2998,6 +2998,21 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     const Literal& rhs_literal = parent_->GetEvaluatedLiteralFor(rhs);
 
     Literal result(shape);
+    if (HloEvaluator::HasSameElementOrder(lhs_literal, shape) &&
+        HloEvaluator::HasSameElementOrder(rhs_literal, shape)) {
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      absl::Span<const ReturnT> lhs_data = lhs_literal.data<ReturnT>();
+      absl::Span<const ReturnT> rhs_data = rhs_literal.data<ReturnT>();
+      const std::function<ReturnT(ReturnT, ReturnT)> typed_op =
+          ConvertBinaryFunction(binary_op);
+      HloEvaluator::ParallelForLinearRange(
+          result_data.size(), [&](int64 begin, int64 end) {
+            for (int64 i = begin; i < end; ++i) {
+              result_data[i] = typed_op(lhs_data[i], rhs_data[i]);
+            }
+          });
+      return std::move(result);
+    }
 
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
@@ -3025,6 +3040,22 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     const Literal& ehs_literal = parent_->GetEvaluatedLiteralFor(ehs);
 
     Literal result(shape);
+    if (HloEvaluator::HasSameElementOrder(lhs_literal, shape) &&
+        HloEvaluator::HasSameElementOrder(rhs_literal, shape) &&
+        HloEvaluator::HasSameElementOrder(ehs_literal, shape)) {
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      absl::Span<const LhsType> lhs_data = lhs_literal.data<LhsType>();
+      absl::Span<const RhsType> rhs_data = rhs_literal.data<RhsType>();
+      absl::Span<const EhsType> ehs_data = ehs_literal.data<EhsType>();
+      HloEvaluator::ParallelForLinearRange(
+          result_data.size(), [&](int64 begin, int64 end) {
+            for (int64 i = begin; i < end; ++i) {
+              result_data[i] =
+                  ternary_op(lhs_data[i], rhs_data[i], ehs_data[i]);
+            }
+          });
+      return std::move(result);
+    }
 
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
@@ -92,6 +92,18 @@ class HloModuleMetadata {
           pass_metadata->set_module_changed(module_changed);
         });
   }
+  Status set_current_pass_instruction_count_before(int64 count) {
+    return MutateCurrentHloPassMetadata(
+        [&count](HloPassMetadata* pass_metadata) {
+          pass_metadata->set_instruction_count_before(count);
+        });
+  }
+  Status set_current_pass_instruction_count_after(int64 count) {
+    return MutateCurrentHloPassMetadata(
+        [&count](HloPassMetadata* pass_metadata) {
+          pass_metadata->set_instruction_count_after(count);
+        });
+  }
   Status set_current_pass_module_id(int64 module_id) {
     return MutateCurrentHloPassMetadata(
         [&module_id](HloPassMetadata* pass_metadata) {
@@ -30,6 +30,9 @@ limitations under the License.
 namespace xla {
 
 // Do an HLO pass to a fix point.
+//
+// With --xla_hlo_pass_fix_fast_compile, the loop also ends after the first
+// iteration that does not reduce the number of instructions in the module.
 template <typename Pass, int kIterationLimit = 25>
 class HloPassFix : public Pass {
  public:
@@ -59,6 +62,13 @@ class HloPassFix : public Pass {
     bool changed = false;
     bool changed_this_iteration = true;
     int64 iteration_count = 0;
+    const bool fast_compile =
+        !module_group->modules().empty() &&
+        module_group->module(0)
+            .config()
+            .debug_options()
+            .xla_hlo_pass_fix_fast_compile();
+    int64 instruction_count = InstructionCount(*module_group);
     VLOG(3) << "Running HloPassFix.";
     while (changed_this_iteration) {
       TF_ASSIGN_OR_RETURN(changed_this_iteration,
@@ -72,13 +82,38 @@ class HloPassFix : public Pass {
         // Return false in case this is fixed point is nested.
         return false;
       }
+      if (fast_compile && changed_this_iteration &&
+          !Shrank(InstructionCount(*module_group), &instruction_count)) {
+        VLOG(2) << Pass::name() << " stopped making progress after "
+                << iteration_count << " iterations";
+        break;
+      }
     }
     return changed;
   }
 
  private:
+  static int64 InstructionCount(const HloModuleGroup& module_group) {
+    int64 count = 0;
+    for (const HloModule* module : module_group.modules()) {
+      count += module->instruction_count();
+    }
+    return count;
+  }
+
+  // Returns whether `count` is lower than `*last_count`, and updates
+  // `*last_count`.
+  static bool Shrank(int64 count, int64* last_count) {
+    const bool shrank = count < *last_count;
+    *last_count = count;
+    return shrank;
+  }
+
   Status RunToFixPoint(HloModule* module, RunState* run_state) {
     VLOG(3) << "Running HloPassFix on " << Pass::name();
+    const bool fast_compile =
+        module->config().debug_options().xla_hlo_pass_fix_fast_compile();
+    int64 instruction_count = module->instruction_count();
     while (!run_state->changed_last_iteration.empty()) {
       TF_RETURN_IF_ERROR(RunOnChangedComputationsOnce(module, run_state));
       VLOG(3) << Pass::name() << " iteration " << run_state->iteration
@@ -93,6 +128,13 @@ class HloPassFix : public Pass {
         run_state->changed.clear();
         break;
       }
+      if (fast_compile && !run_state->changed_last_iteration.empty() &&
+          !Shrank(module->instruction_count(), &instruction_count)) {
+        VLOG(2) << Pass::name() << " stopped making progress on module '"
+                << module->name() << "' after " << run_state->iteration
+                << " iterations";
+        break;
+      }
     }
     return Status::OK();
   }
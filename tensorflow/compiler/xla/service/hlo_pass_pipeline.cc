@@ -39,6 +39,8 @@ void RecordPassStartMetadata(HloModule& module, const std::string& pass_name,
   // An HloPassMetadata was just created so Status should always be OK.
   TF_CHECK_OK(module.metadata()->set_current_pass_name(pass_name));
   TF_CHECK_OK(module.metadata()->set_current_pass_pipeline_name(pipeline_name));
+  TF_CHECK_OK(module.metadata()->set_current_pass_instruction_count_before(
+      module.instruction_count()));
 }
 
 void RecordPassStartMetadata(HloModuleGroup& module_group,
@@ -58,6 +60,9 @@ Status AttemptRecordPassEndMetadata(HloModule& module,
       module.metadata()->set_current_pass_module_id(module.unique_id()));
   TF_RETURN_IF_ERROR(
       module.metadata()->set_current_pass_module_changed(module_changed));
+  TF_RETURN_IF_ERROR(
+      module.metadata()->set_current_pass_instruction_count_after(
+          module.instruction_count()));
   TF_RETURN_IF_ERROR(module.metadata()->RecordPassEnd());
   return Status::OK();
 }
@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 
+#include "absl/algorithm/container.h"
+#include "absl/strings/match.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -99,6 +102,105 @@ class BarBlowerUpper : public HloModulePass {
   }
 };
 
+// A module pass which removes one instruction that has no users.
+class RemoveOneDeadInstructionPass : public HloModulePass {
+ public:
+  absl::string_view name() const override { return "remove-one-dead"; }
+
+  StatusOr<bool> Run(HloModule* module) override {
+    HloComputation* computation = module->entry_computation();
+    for (HloInstruction* instruction : computation->instructions()) {
+      if (instruction->user_count() == 0 &&
+          instruction != computation->root_instruction() &&
+          instruction->opcode() != HloOpcode::kParameter) {
+        TF_RETURN_IF_ERROR(computation->RemoveInstruction(instruction));
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+// A module pass which renames one instruction named 'foo.*' to 'bar'.
+class RenameOneFooPass : public HloModulePass {
+ public:
+  absl::string_view name() const override { return "rename-one-foo"; }
+
+  StatusOr<bool> Run(HloModule* module) override {
+    for (HloInstruction* instruction :
+         module->entry_computation()->instructions()) {
+      if (absl::StartsWith(instruction->name(), "foo")) {
+        instruction->SetAndSanitizeName("bar");
+        instruction->UniquifyName(&module->instruction_name_uniquer());
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+constexpr char kFixPointModule[] = R"(
+HloModule FixPoint
+
+ENTRY main {
+  a = f32[] parameter(0)
+  foo.1 = f32[] negate(a)
+  foo.2 = f32[] negate(a)
+  ROOT foo.3 = f32[] negate(a)
+}
+)";
+
+int64 CountInstructionsNamedFoo(const HloModule& module) {
+  return absl::c_count_if(module.entry_computation()->instructions(),
+                          [](const HloInstruction* instruction) {
+                            return absl::StartsWith(instruction->name(), "foo");
+                          });
+}
+
+TEST_F(HloPassPipelineTest, PassFixRunsToFixPoint) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(kFixPointModule));
+  HloPassFix<RenameOneFooPass> pass;
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pass.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(CountInstructionsNamedFoo(*module), 0);
+}
+
+TEST_F(HloPassPipelineTest, FastCompilePassFixStopsWithoutProgress) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(kFixPointModule));
+  DebugOptions debug_options = module->config().debug_options();
+  debug_options.set_xla_hlo_pass_fix_fast_compile(true);
+  module->config().set_debug_options(debug_options);
+
+  HloPassFix<RenameOneFooPass> rename;
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, rename.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(CountInstructionsNamedFoo(*module), 2);
+
+  // Removing instructions makes progress, so the loop goes on.
+  HloPassFix<RemoveOneDeadInstructionPass> remove;
+  TF_ASSERT_OK_AND_ASSIGN(changed, remove.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(module->entry_computation()->instruction_count(), 2);
+}
+
+TEST_F(HloPassPipelineTest, RecordsInstructionCounts) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(kFixPointModule));
+  HloPassPipeline pipeline(TestName());
+  pipeline.AddPass<RemoveOneDeadInstructionPass>();
+  TF_ASSERT_OK(pipeline.Run(module.get()).status());
+
+  const HloModuleMetadataProto& metadata = module->metadata()->proto();
+  ASSERT_THAT(metadata.pass_metadata(), SizeIs(2));
+  const HloPassMetadata& pass_metadata = metadata.pass_metadata(1);
+  EXPECT_THAT(pass_metadata.pass_name(), StrEq("remove-one-dead"));
+  EXPECT_TRUE(pass_metadata.module_changed());
+  EXPECT_EQ(pass_metadata.instruction_count_before(), 4);
+  EXPECT_EQ(pass_metadata.instruction_count_after(), 3);
+}
+
 TEST_F(HloPassPipelineTest, ModulePassChanged) {
   // Test an HLO module pass which changes a module.
   const string module_str = R"(
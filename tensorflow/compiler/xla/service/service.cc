@@ -323,6 +323,14 @@ StatusOr<std::vector<std::unique_ptr<Executable>>> Service::BuildExecutables(
     }
   }
 
+  std::vector<HloModule*> optimized_modules;
+  for (const std::unique_ptr<Executable>& executable : executables) {
+    if (executable != nullptr && executable->has_module()) {
+      optimized_modules.push_back(&executable->module());
+    }
+  }
+  DumpHloModuleMetadataIfEnabled(optimized_modules);
+
   return std::move(executables);
 }
 
@@ -761,6 +769,9 @@ StatusOr<std::unique_ptr<Executable>> Service::BuildExecutable(
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<Executable> executable,
       backend->compiler()->RunBackend(std::move(module), executor, options));
+  if (executable->has_module()) {
+    DumpHloModuleMetadataIfEnabled({&executable->module()});
+  }
 
   return std::move(executable);
 }
@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <list>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -1798,44 +1799,83 @@ StatusOr<bool> ShardingPropagation::Run(HloModule* module) {
   // sharding as its sharding have to match with the one expected by the host.
   provided_shardings.insert(module->entry_computation()->root_instruction());
 
+  // The instructions do not change during propagation, so the post order of
+  // each computation is computed once. Rather than sweeping every instruction
+  // on every iteration, each computation keeps the post order positions of the
+  // instructions that have to be visited again; an instruction is revisited
+  // only after the sharding of one of its operands (for the forward pass) or
+  // users (for the backward pass) changed.
+  struct ComputationWorklist {
+    std::vector<HloInstruction*> instructions;
+    absl::flat_hash_map<const HloInstruction*, int64> positions;
+    std::set<int64> pending_from_operands;
+    std::set<int64> pending_from_users;
+  };
+  std::vector<ComputationWorklist> worklists;
+  absl::flat_hash_map<const HloComputation*, ComputationWorklist*>
+      worklist_for_computation;
+  worklists.reserve(module->computation_count());
+  int64 instruction_counter = 0;
+  for (const HloComputation* computation : module->computations()) {
+    worklists.emplace_back();
+    ComputationWorklist& worklist = worklists.back();
+    worklist.instructions = computation->MakeInstructionPostOrder();
+    for (int64 i = 0; i < worklist.instructions.size(); ++i) {
+      worklist.positions[worklist.instructions[i]] = i;
+    }
+    worklist_for_computation[computation] = &worklist;
+    instruction_counter += worklist.instructions.size();
+  }
+
+  stats_ = Stats();
   // Iterate to a fixpoint that is guaranteed to be reached because we only
   // strictly improve the sharding of the graph and it can't be improved
   // indefinitely.
   int64 iterations = 0;
   auto run_to_fix_point = [&](int64 aggressiveness) {
-    absl::flat_hash_set<const HloInstruction*> already_inferred_from_operands;
-    absl::flat_hash_set<const HloInstruction*> already_inferred_from_users;
+    for (ComputationWorklist& worklist : worklists) {
+      for (int64 i = 0; i < worklist.instructions.size(); ++i) {
+        if (!provided_shardings.contains(worklist.instructions[i])) {
+          worklist.pending_from_operands.insert(i);
+          worklist.pending_from_users.insert(i);
+        }
+      }
+    }
+    auto mark_pending = [&](const HloInstruction* hlo,
+                            std::set<int64> ComputationWorklist::*pending) {
+      if (provided_shardings.contains(hlo)) {
+        return;
+      }
+      ComputationWorklist* worklist =
+          worklist_for_computation.at(hlo->parent());
+      (worklist->*pending).insert(worklist->positions.at(hlo));
+    };
+    auto clear_cache = [&](HloInstruction* hlo) {
+      for (auto operand : hlo->operands()) {
+        mark_pending(operand, &ComputationWorklist::pending_from_users);
+      }
+      for (auto user : hlo->users()) {
+        mark_pending(user, &ComputationWorklist::pending_from_operands);
+      }
+    };
     bool changed_last_iter = true;
     while (changed_last_iter) {
       changed_last_iter = false;
       int64 inferred_from_operand_counter = 0;
       int64 inferred_from_user_counter = 0;
-      int64 instruction_counter = 0;
-      int64 already_sharded_counter = 0;
-      for (const HloComputation* computation : module->computations()) {
-        std::vector<HloInstruction*> instructions =
-            computation->MakeInstructionPostOrder();
-
-        instruction_counter += instructions.size();
-        for (const HloInstruction* instruction : instructions) {
-          already_sharded_counter += (instruction->has_sharding() ? 1 : 0);
-        }
-        auto clear_cache = [&](HloInstruction* hlo) {
-          for (auto operand : hlo->operands()) {
-            already_inferred_from_users.erase(operand);
-          }
-          for (auto user : hlo->users()) {
-            already_inferred_from_operands.erase(user);
-          }
-        };
+      int64 visited_counter = 0;
+      for (ComputationWorklist& worklist : worklists) {
         // First iterate the HLO graph in post order taking shardings from
-        // operands.
-        for (HloInstruction* instruction : instructions) {
-          if (already_inferred_from_operands.contains(instruction) ||
-              provided_shardings.contains(instruction)) {
-            continue;
-          }
-          already_inferred_from_operands.insert(instruction);
+        // operands. Users marked while this pass runs come later in the post
+        // order and are visited by the same pass.
+        int64 next_position = 0;
+        for (auto it = worklist.pending_from_operands.begin();
+             it != worklist.pending_from_operands.end();
+             it = worklist.pending_from_operands.lower_bound(next_position)) {
+          HloInstruction* instruction = worklist.instructions[*it];
+          next_position = *it + 1;
+          worklist.pending_from_operands.erase(it);
+          ++visited_counter;
           if (InferShardingFromOperands(instruction, computation_map, is_spmd_,
                                         aggressiveness)) {
             ++inferred_from_operand_counter;
@@ -1854,20 +1894,26 @@ StatusOr<bool> ShardingPropagation::Run(HloModule* module) {
 
         // Then iterate the HLO graph in reverse post order taking shardings
         // from users.
-        for (auto it = instructions.rbegin(); it != instructions.rend(); ++it) {
-          if (already_inferred_from_users.contains(*it) ||
-              provided_shardings.contains(*it)) {
-            continue;
+        next_position = worklist.instructions.size();
+        while (!worklist.pending_from_users.empty()) {
+          auto it = worklist.pending_from_users.lower_bound(next_position);
+          if (it == worklist.pending_from_users.begin()) {
+            break;
           }
-          already_inferred_from_users.insert(*it);
-          if (InferShardingFromUsers(*it, computation_map, aggressiveness,
-                                     is_spmd_)) {
+          --it;
+          next_position = *it;
+          worklist.pending_from_users.erase(it);
+          HloInstruction* instruction = worklist.instructions[next_position];
+          ++visited_counter;
+          if (InferShardingFromUsers(instruction, computation_map,
+                                     aggressiveness, is_spmd_)) {
             ++inferred_from_user_counter;
             any_changed = true;
-            VLOG(2) << "Add sharding (backward-pass): " << (*it)->ToString();
+            VLOG(2) << "Add sharding (backward-pass): "
+                    << instruction->ToString();
             absl::flat_hash_set<HloInstruction*> changed_in_comp_prop;
-            maybe_computation_propagation(*it, &changed_in_comp_prop);
-            clear_cache(*it);
+            maybe_computation_propagation(instruction, &changed_in_comp_prop);
+            clear_cache(instruction);
             for (auto hlo : changed_in_comp_prop) {
               clear_cache(hlo);
             }
@@ -1877,21 +1923,28 @@ StatusOr<bool> ShardingPropagation::Run(HloModule* module) {
       }
       VLOG(1) << "Sharding propagation iteration " << iterations << ";";
       VLOG(1) << "  total instructions: " << instruction_counter;
-      VLOG(1) << "  instructions already sharded: " << already_sharded_counter;
+      VLOG(1) << "  instructions visited: " << visited_counter;
       VLOG(1) << "  shardings inferred from operands: "
               << inferred_from_operand_counter;
       VLOG(1) << "  shardings inferred from users: "
               << inferred_from_user_counter;
       VLOG(1) << "  aggressiveness: " << aggressiveness;
+      stats_.instructions_visited += visited_counter;
+      stats_.inferred_from_operands += inferred_from_operand_counter;
+      stats_.inferred_from_users += inferred_from_user_counter;
       ++iterations;
     }
   };
   for (int64 aggressiveness = 0; aggressiveness < 4; ++aggressiveness) {
     run_to_fix_point(aggressiveness);
   }
+  stats_.iterations = iterations;
 
   VLOG(1) << "Sharding propagation completed after " << iterations
-          << " iterations";
+          << " iterations, visiting " << stats_.instructions_visited
+          << " instructions out of " << instruction_counter << "; inferred "
+          << stats_.inferred_from_operands << " shardings from operands and "
+          << stats_.inferred_from_users << " from users";
   return any_changed;
 }
 
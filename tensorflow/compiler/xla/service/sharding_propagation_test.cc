@@ -4983,5 +4983,36 @@ ENTRY %module {
   EXPECT_THAT(operand, op::Sharding("{replicated}"));
 }
 
+TEST_F(ShardingPropagationTest, RevisitsOnlyInstructionsWithChangedNeighbors) {
+  constexpr int kChainLength = 100;
+  std::string hlo_string = R"(
+HloModule module
+ENTRY %entry {
+  %n0 = f32[64,64] parameter(0), sharding={devices=[2,1]0,1}
+)";
+  for (int i = 1; i <= kChainLength; ++i) {
+    absl::StrAppend(&hlo_string, i == kChainLength ? "  ROOT" : " ", " %n", i,
+                    " = f32[64,64] negate(%n", i - 1, ")\n");
+  }
+  absl::StrAppend(&hlo_string, "}");
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  ShardingPropagation propagation(/*is_spmd=*/true);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, propagation.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(FindInstruction(module.get(), "n50"),
+              op::Sharding("{devices=[2,1]0,1}"));
+
+  // The parameter and the root keep their shardings. The forward pass of the
+  // first iteration shards the rest of the chain, and nothing is left to
+  // revisit afterwards, so every other iteration only runs to start a new
+  // aggressiveness level.
+  const ShardingPropagation::Stats& stats = propagation.stats();
+  EXPECT_EQ(stats.iterations, 5);
+  EXPECT_EQ(stats.inferred_from_operands, kChainLength - 1);
+  EXPECT_EQ(stats.inferred_from_users, 0);
+  EXPECT_EQ(stats.instructions_visited, 4 * 2 * (kChainLength - 1));
+}
+
 }  // namespace
 }  // namespace xla
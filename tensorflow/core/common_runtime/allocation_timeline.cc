@@ -0,0 +1,285 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/allocation_timeline.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <map>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tracking_allocator.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kAllocationsLineId = 0;
+constexpr int64 kStepMemoryLineId = 1;
+
+// Only forwards the allocators wrapped by the executor for one node to its
+// `AllocationTimelineCollector`.
+class NodeAllocationStats : public NodeExecStatsInterface {
+ public:
+  NodeAllocationStats(const NodeDef* node,
+                      AllocationTimelineCollector* collector)
+      : node_(node), collector_(collector) {}
+
+  void Done(const string& device) override { delete this; }
+  void RecordExecutorStarted() override {}
+  void RecordComputeStarted() override {}
+  void RecordComputeEnded() override {}
+  void RecordExecutorEnded() override {}
+  bool TrackAllocations() const override { return true; }
+
+  void SetMemory(OpKernelContext* ctx) override {
+    for (const auto& allocator_pair : ctx->ConsumeWrappedAllocators()) {
+      collector_->AddAllocations(node_->name(), allocator_pair.first,
+                                 allocator_pair.second);
+    }
+  }
+
+  void SetOutput(int slot, const Tensor* tensor) override {}
+  void SetScheduled(int64 nanos) override {}
+
+ private:
+  const NodeDef* const node_;                     // Not owned.
+  AllocationTimelineCollector* const collector_;  // Not owned.
+};
+
+// Returns the fraction of the free bytes in the heap of `allocator` that are
+// outside its largest free block.
+double Fragmentation(Allocator* allocator) {
+  absl::optional<AllocatorStats> stats = allocator->GetStats();
+  if (!stats) return 0.0;
+  const int64 free_bytes = stats->heap_bytes - stats->bytes_in_use;
+  if (free_bytes <= 0 || stats->largest_free_block_bytes <= 0) return 0.0;
+  return static_cast<double>(free_bytes - stats->largest_free_block_bytes) /
+         free_bytes;
+}
+
+}  // namespace
+
+AllocationTimeline::AllocationTimeline(int capacity, int max_steps)
+    : capacity_(std::max(capacity, 1)), max_steps_(std::max(max_steps, 1)) {
+  records_.reserve(capacity_);
+}
+
+void AllocationTimeline::AddStep(std::vector<Record> records,
+                                 std::vector<StepSummary> summaries) {
+  mutex_lock l(mu_);
+  for (Record& record : records) {
+    if (records_.size() < capacity_) {
+      records_.push_back(std::move(record));
+    } else {
+      records_[next_] = std::move(record);
+      next_ = (next_ + 1) % capacity_;
+    }
+  }
+  for (StepSummary& summary : summaries) {
+    summaries_.push_back(std::move(summary));
+  }
+  while (summaries_.size() > max_steps_) {
+    summaries_.pop_front();
+  }
+}
+
+std::vector<AllocationTimeline::Record> AllocationTimeline::records() const {
+  mutex_lock l(mu_);
+  std::vector<Record> records;
+  records.reserve(records_.size());
+  records.insert(records.end(), records_.begin() + next_, records_.end());
+  records.insert(records.end(), records_.begin(), records_.begin() + next_);
+  return records;
+}
+
+std::vector<AllocationTimeline::StepSummary> AllocationTimeline::summaries()
+    const {
+  mutex_lock l(mu_);
+  return std::vector<StepSummary>(summaries_.begin(), summaries_.end());
+}
+
+void AllocationTimeline::ExportToXPlane(profiler::XPlane* plane) const {
+  const std::vector<Record> records = this->records();
+  const std::vector<StepSummary> summaries = this->summaries();
+
+  int64 begin_micros = std::numeric_limits<int64>::max();
+  int64 end_micros = 0;
+  for (const Record& record : records) {
+    begin_micros = std::min(begin_micros, record.alloc_micros);
+    end_micros = std::max(end_micros, std::max(record.alloc_micros,
+                                               record.free_micros));
+  }
+  for (const StepSummary& summary : summaries) {
+    begin_micros = std::min(begin_micros, summary.begin_micros);
+    end_micros = std::max(end_micros, summary.end_micros);
+  }
+  if (end_micros == 0) begin_micros = 0;
+
+  profiler::XPlaneBuilder builder(plane);
+  const profiler::XStatMetadata& step_id_stat =
+      *builder.GetOrCreateStatMetadata("step_id");
+  const profiler::XStatMetadata& bytes_stat =
+      *builder.GetOrCreateStatMetadata("bytes");
+  const profiler::XStatMetadata& allocator_stat =
+      *builder.GetOrCreateStatMetadata("allocator");
+  const profiler::XStatMetadata& peak_bytes_stat =
+      *builder.GetOrCreateStatMetadata("peak_bytes");
+  const profiler::XStatMetadata& fragmentation_stat =
+      *builder.GetOrCreateStatMetadata("fragmentation");
+
+  profiler::XLineBuilder allocations =
+      builder.GetOrCreateLine(kAllocationsLineId);
+  allocations.SetName("Allocations");
+  allocations.SetTimestampNs(begin_micros * EnvTime::kMicrosToNanos);
+  allocations.ReserveEvents(records.size());
+  for (const Record& record : records) {
+    profiler::XEventBuilder event =
+        allocations.AddEvent(*builder.GetOrCreateEventMetadata(record.tensor));
+    event.SetTimestampNs(record.alloc_micros * EnvTime::kMicrosToNanos);
+    const int64 free_micros =
+        record.free_micros > 0 ? record.free_micros : end_micros;
+    event.SetEndTimestampNs(free_micros * EnvTime::kMicrosToNanos);
+    event.AddStatValue(step_id_stat, record.step_id);
+    event.AddStatValue(bytes_stat, record.bytes);
+    // Allocator names are interned as stat metadata, since they repeat.
+    event.AddStatValue(allocator_stat,
+                       *builder.GetOrCreateStatMetadata(record.allocator_name));
+  }
+
+  profiler::XLineBuilder steps = builder.GetOrCreateLine(kStepMemoryLineId);
+  steps.SetName("Step memory");
+  steps.SetTimestampNs(begin_micros * EnvTime::kMicrosToNanos);
+  for (const StepSummary& summary : summaries) {
+    profiler::XEventBuilder event = steps.AddEvent(
+        *builder.GetOrCreateEventMetadata(summary.allocator_name));
+    event.SetTimestampNs(summary.begin_micros * EnvTime::kMicrosToNanos);
+    event.SetEndTimestampNs(summary.end_micros * EnvTime::kMicrosToNanos);
+    event.AddStatValue(step_id_stat, summary.step_id);
+    event.AddStatValue(peak_bytes_stat, summary.peak_bytes);
+    event.AddStatValue(fragmentation_stat, summary.fragmentation);
+  }
+}
+
+AllocationTimelineCollector::AllocationTimelineCollector(
+    int64 step_id, AllocationTimeline* timeline)
+    : step_id_(step_id), timeline_(timeline) {}
+
+AllocationTimelineCollector::~AllocationTimelineCollector() { Finalize(); }
+
+NodeExecStatsInterface* AllocationTimelineCollector::CreateNodeExecStats(
+    const NodeDef* node) {
+  return new NodeAllocationStats(node, this);
+}
+
+string AllocationTimelineCollector::ReportAllocsOnResourceExhausted(
+    const string& err) {
+  return "";
+}
+
+void AllocationTimelineCollector::AddAllocations(
+    const string& node_name, Allocator* allocator,
+    TrackingAllocator* tracking_allocator) {
+  mutex_lock l(mu_);
+  if (finalized_) {
+    // Release the wrapper, since nobody will read its records.
+    tracking_allocator->GetRecordsAndUnRef();
+    return;
+  }
+  allocations_.push_back({node_name, allocator, tracking_allocator});
+}
+
+void AllocationTimelineCollector::Finalize() {
+  std::vector<NodeAllocations> allocations;
+  {
+    mutex_lock l(mu_);
+    if (finalized_) return;
+    finalized_ = true;
+    allocations.swap(allocations_);
+  }
+
+  std::vector<AllocationTimeline::Record> records;
+  // The (time, bytes) of the allocations (positive) and deallocations
+  // (negative) made in each allocator during the step.
+  std::map<string, std::vector<std::pair<int64, int64>>> deltas;
+  std::map<string, Allocator*> allocators;
+  for (const NodeAllocations& node_allocations : allocations) {
+    const string allocator_name = node_allocations.allocator->Name();
+    allocators.emplace(allocator_name, node_allocations.allocator);
+    std::vector<std::pair<int64, int64>>& allocator_deltas =
+        deltas[allocator_name];
+
+    // A TrackingAllocator records each deallocation with the size of its
+    // allocation, so a deallocation is matched with the oldest live allocation
+    // of the same size.
+    absl::flat_hash_map<int64, std::deque<int>> live;
+    for (const AllocRecord& alloc_record :
+         node_allocations.tracking_allocator->GetRecordsAndUnRef()) {
+      allocator_deltas.emplace_back(alloc_record.alloc_micros,
+                                    alloc_record.alloc_bytes);
+      if (alloc_record.alloc_bytes >= 0) {
+        live[alloc_record.alloc_bytes].push_back(records.size());
+        AllocationTimeline::Record record;
+        record.step_id = step_id_;
+        record.tensor = node_allocations.node_name;
+        record.allocator_name = allocator_name;
+        record.bytes = alloc_record.alloc_bytes;
+        record.alloc_micros = alloc_record.alloc_micros;
+        records.push_back(std::move(record));
+      } else {
+        auto it = live.find(-alloc_record.alloc_bytes);
+        if (it == live.end() || it->second.empty()) continue;
+        records[it->second.front()].free_micros = alloc_record.alloc_micros;
+        it->second.pop_front();
+      }
+    }
+  }
+
+  std::vector<AllocationTimeline::StepSummary> summaries;
+  for (auto& name_and_deltas : deltas) {
+    std::vector<std::pair<int64, int64>>& allocator_deltas =
+        name_and_deltas.second;
+    if (allocator_deltas.empty()) continue;
+    // Keeps the order of the records of each node made at the same time.
+    std::stable_sort(allocator_deltas.begin(), allocator_deltas.end(),
+                     [](const std::pair<int64, int64>& a,
+                        const std::pair<int64, int64>& b) {
+                       return a.first < b.first;
+                     });
+    AllocationTimeline::StepSummary summary;
+    summary.step_id = step_id_;
+    summary.allocator_name = name_and_deltas.first;
+    summary.begin_micros = allocator_deltas.front().first;
+    summary.end_micros = allocator_deltas.back().first;
+    int64 bytes = 0;
+    for (const auto& delta : allocator_deltas) {
+      bytes += delta.second;
+      summary.peak_bytes = std::max(summary.peak_bytes, bytes);
+    }
+    summary.fragmentation = Fragmentation(allocators[name_and_deltas.first]);
+    summaries.push_back(std::move(summary));
+  }
+
+  VLOG(2) << "Adding " << records.size() << " allocations of step " << step_id_
+          << " to the allocation timeline";
+  timeline_->AddStep(std::move(records), std::move(summaries));
+}
+
+}  // namespace tensorflow
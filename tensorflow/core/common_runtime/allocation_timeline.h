@@ -0,0 +1,156 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_ALLOCATION_TIMELINE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_ALLOCATION_TIMELINE_H_
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+
+class Allocator;
+class TrackingAllocator;
+
+// A fixed-size ring buffer of the allocations made by the nodes of recent
+// steps, together with the peak memory and fragmentation of each allocator at
+// the end of each step.
+//
+// The timeline is filled by an `AllocationTimelineCollector` per step, which
+// records much less than a `StepStatsCollector` (no node timings, tensor
+// descriptions or timeline labels), so it can stay enabled in production. When
+// the buffer is full, the oldest records are overwritten. This class is
+// thread-safe.
+class AllocationTimeline {
+ public:
+  // One allocation made by a node.
+  struct Record {
+    int64 step_id = 0;
+    // Name of the node that allocated the buffer.
+    std::string tensor;
+    std::string allocator_name;
+    int64 bytes = 0;
+    int64 alloc_micros = 0;
+    // Zero if the buffer was still alive when the step finished.
+    int64 free_micros = 0;
+  };
+
+  // The memory usage of one allocator during one step.
+  struct StepSummary {
+    int64 step_id = 0;
+    std::string allocator_name;
+    // The times of the first and the last allocation or deallocation of the
+    // step in the allocator.
+    int64 begin_micros = 0;
+    int64 end_micros = 0;
+    // The high watermark of the bytes allocated by the step's nodes.
+    int64 peak_bytes = 0;
+    // The fraction of the free bytes of the allocator's heap that are outside
+    // its largest free block when the step finished, or 0 if the allocator
+    // doesn't report its heap (see `AllocatorStats::heap_bytes`).
+    double fragmentation = 0.0;
+  };
+
+  // Keeps the last `capacity` records and the summaries of the last
+  // `max_steps` steps.
+  AllocationTimeline(int capacity, int max_steps);
+
+  // Called by `AllocationTimelineCollector` when a step finishes.
+  void AddStep(std::vector<Record> records,
+               std::vector<StepSummary> summaries);
+
+  // Returns the buffered records, oldest first.
+  std::vector<Record> records() const;
+
+  // Returns the buffered step summaries, oldest first.
+  std::vector<StepSummary> summaries() const;
+
+  // Adds to `plane` a line named "Allocations" with one event per record,
+  // spanning from its allocation to its deallocation (or to the end of the
+  // line for live buffers), and a line named "Step memory" with one event per
+  // step summary.
+  void ExportToXPlane(profiler::XPlane* plane) const;
+
+ private:
+  const int capacity_;
+  const int max_steps_;
+
+  mutable mutex mu_;
+  std::vector<Record> records_ TF_GUARDED_BY(mu_);
+  // Index in `records_` of the oldest record once the buffer is full.
+  int next_ TF_GUARDED_BY(mu_) = 0;
+  std::deque<StepSummary> summaries_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AllocationTimeline);
+};
+
+// An implementation of `StepStatsCollectorInterface` that only tracks the
+// allocations of the nodes of one step, and adds them to an
+// `AllocationTimeline` when the step finishes:
+//
+//   AllocationTimelineCollector collector(step_id, &timeline);
+//   args.stats_collector = &collector;
+//   ...  // Run the step.
+//   collector.Finalize();
+class AllocationTimelineCollector : public StepStatsCollectorInterface {
+ public:
+  // Does not take ownership of `timeline`.
+  AllocationTimelineCollector(int64 step_id, AllocationTimeline* timeline);
+
+  // Calls Finalize().
+  ~AllocationTimelineCollector() override;
+
+  NodeExecStatsInterface* CreateNodeExecStats(const NodeDef* node) override;
+  string ReportAllocsOnResourceExhausted(const string& err) override;
+
+  // Takes ownership of `tracking_allocator`, which wraps `allocator` for the
+  // execution of the node named `node_name`. Does not take ownership of
+  // `allocator`.
+  void AddAllocations(const string& node_name, Allocator* allocator,
+                      TrackingAllocator* tracking_allocator);
+
+  // Adds the allocations of the step to the timeline. Must be called once the
+  // step has finished; calling it more than once has no effect.
+  void Finalize();
+
+ private:
+  struct NodeAllocations {
+    string node_name;
+    Allocator* allocator;                   // Not owned.
+    TrackingAllocator* tracking_allocator;  // Owned.
+  };
+
+  const int64 step_id_;
+  AllocationTimeline* const timeline_;  // Not owned.
+
+  mutex mu_;
+  bool finalized_ TF_GUARDED_BY(mu_) = false;
+  std::vector<NodeAllocations> allocations_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AllocationTimelineCollector);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_ALLOCATION_TIMELINE_H_
@@ -0,0 +1,139 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/allocation_timeline.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tracking_allocator.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Reports exactly the requested size of each allocation.
+class SizeTrackingAllocator : public Allocator {
+ public:
+  string Name() override { return "size_tracking"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    void* ptr = port::AlignedMalloc(num_bytes, alignment);
+    mutex_lock l(mu_);
+    sizes_[ptr] = num_bytes;
+    return ptr;
+  }
+  void DeallocateRaw(void* ptr) override {
+    {
+      mutex_lock l(mu_);
+      sizes_.erase(ptr);
+    }
+    port::AlignedFree(ptr);
+  }
+  bool TracksAllocationSizes() const override { return true; }
+  size_t RequestedSize(const void* ptr) const override {
+    mutex_lock l(mu_);
+    return sizes_.at(ptr);
+  }
+
+ private:
+  mutable mutex mu_;
+  std::unordered_map<const void*, size_t> sizes_ TF_GUARDED_BY(mu_);
+};
+
+// Runs one step in which `node_name` allocates `sizes` bytes and frees all but
+// the last allocation, which is freed after the step.
+void RunStep(int64 step_id, const string& node_name,
+             const std::vector<size_t>& sizes, AllocationTimeline* timeline) {
+  static SizeTrackingAllocator* allocator = new SizeTrackingAllocator;
+  AllocationTimelineCollector collector(step_id, timeline);
+  TrackingAllocator* tracking_allocator =
+      new TrackingAllocator(allocator, /*track_ids=*/true);
+  std::vector<void*> ptrs;
+  for (size_t size : sizes) {
+    ptrs.push_back(tracking_allocator->AllocateRaw(64, size));
+  }
+  for (int i = 0; i + 1 < ptrs.size(); ++i) {
+    tracking_allocator->DeallocateRaw(ptrs[i]);
+  }
+  collector.AddAllocations(node_name, allocator, tracking_allocator);
+  collector.Finalize();
+  // Deletes `tracking_allocator`.
+  tracking_allocator->DeallocateRaw(ptrs.back());
+}
+
+TEST(AllocationTimelineTest, RecordsAllocationsAndPeak) {
+  AllocationTimeline timeline(/*capacity=*/8, /*max_steps=*/4);
+  RunStep(/*step_id=*/1, "matmul", {256, 512}, &timeline);
+
+  const std::vector<AllocationTimeline::Record> records = timeline.records();
+  ASSERT_EQ(2, records.size());
+  EXPECT_EQ(1, records[0].step_id);
+  EXPECT_EQ("matmul", records[0].tensor);
+  EXPECT_EQ("size_tracking", records[0].allocator_name);
+  EXPECT_EQ(256, records[0].bytes);
+  EXPECT_GT(records[0].free_micros, 0);
+  EXPECT_GE(records[0].free_micros, records[0].alloc_micros);
+  EXPECT_EQ(512, records[1].bytes);
+  // Still alive when the step finished.
+  EXPECT_EQ(0, records[1].free_micros);
+
+  const std::vector<AllocationTimeline::StepSummary> summaries =
+      timeline.summaries();
+  ASSERT_EQ(1, summaries.size());
+  EXPECT_EQ(1, summaries[0].step_id);
+  EXPECT_EQ(768, summaries[0].peak_bytes);
+}
+
+TEST(AllocationTimelineTest, OverwritesOldestRecords) {
+  AllocationTimeline timeline(/*capacity=*/3, /*max_steps=*/1);
+  RunStep(/*step_id=*/1, "a", {16, 32}, &timeline);
+  RunStep(/*step_id=*/2, "b", {64, 128}, &timeline);
+
+  const std::vector<AllocationTimeline::Record> records = timeline.records();
+  ASSERT_EQ(3, records.size());
+  EXPECT_EQ(32, records[0].bytes);
+  EXPECT_EQ(64, records[1].bytes);
+  EXPECT_EQ(128, records[2].bytes);
+
+  const std::vector<AllocationTimeline::StepSummary> summaries =
+      timeline.summaries();
+  ASSERT_EQ(1, summaries.size());
+  EXPECT_EQ(2, summaries[0].step_id);
+}
+
+TEST(AllocationTimelineTest, ExportsToXPlane) {
+  AllocationTimeline timeline(/*capacity=*/8, /*max_steps=*/4);
+  RunStep(/*step_id=*/1, "conv", {1024, 2048, 4096}, &timeline);
+
+  profiler::XPlane plane;
+  timeline.ExportToXPlane(&plane);
+  ASSERT_EQ(2, plane.lines_size());
+  const profiler::XLine& allocations = plane.lines(0);
+  EXPECT_EQ("Allocations", allocations.name());
+  ASSERT_EQ(3, allocations.events_size());
+  EXPECT_EQ("conv",
+            plane.event_metadata()
+                .at(allocations.events(0).metadata_id())
+                .name());
+  const profiler::XLine& steps = plane.lines(1);
+  EXPECT_EQ("Step memory", steps.name());
+  ASSERT_EQ(1, steps.events_size());
+  EXPECT_EQ(3, steps.events(0).stats_size());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -19,10 +19,13 @@ limitations under the License.
 
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -33,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/bfc_memory_map.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -77,6 +81,15 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  int64 metrics_interval_ms;
+  Status status = ReadInt64FromEnvVar("TF_BFC_ALLOCATOR_METRICS_INTERVAL_MS",
+                                      0, &metrics_interval_ms);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  } else {
+    metrics_interval_micros_ = std::max<int64>(metrics_interval_ms, 0) * 1000;
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -254,6 +267,28 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(1) << "AllocateRaw " << Name() << "  " << num_bytes;
+  const int size_class =
+      (cache_stripes_ != nullptr && num_bytes > 0 &&
+       allocation_attr.freed_by_func == nullptr)
+          ? CachedSizeClass(RoundedBytes(num_bytes))
+          : -1;
+  if (size_class >= 0) {
+    void* ptr = AllocateFromSmallChunkCache(size_class, num_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+  void* result = AllocateRawUncached(unused_alignment, num_bytes,
+                                     allocation_attr);
+  if (size_class >= 0 && result != nullptr) {
+    AddToSmallChunkCache(result, size_class, num_bytes);
+  }
+  return result;
+}
+
+void* BFCAllocator::AllocateRawUncached(
+    size_t unused_alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
   if (!allocation_attr.retry_on_failure) {
     // Return immediately upon the first failure if this is for allocating an
     // optional scratch space.
@@ -379,6 +414,16 @@ void BFCAllocator::DeallocateRegions(
       DeleteChunk(h_to_delete);
     }
 
+    // The physical memory released behind the free chunks of the region was
+    // already subtracted.
+    const char* region_begin = static_cast<const char*>(it->ptr());
+    const char* region_end = static_cast<const char*>(it->end_ptr());
+    for (auto r = released_ranges_.lower_bound(region_begin);
+         r != released_ranges_.end() && r->first < region_end;) {
+      total_region_allocated_bytes_ += r->second.released_bytes;
+      r = released_ranges_.erase(r);
+    }
+
     // Deallocate the memory.
     sub_allocator_->Free(it->ptr(), it->memory_size());
     total_region_allocated_bytes_ -= it->memory_size();
@@ -413,6 +458,24 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     return ptr;
   }
 
+  // Chunks parked in the small chunk cache may coalesce into a large enough
+  // free chunk; use them before growing the heap.
+  if (cached_bytes_.load(std::memory_order_relaxed) > 0) {
+    std::vector<void*> cached_chunks = TakeSmallChunkCache();
+    for (void* cached_ptr : cached_chunks) {
+      DeallocateRawInternalLocked(cached_ptr);
+    }
+    if (!cached_chunks.empty()) {
+      VLOG(2) << "Flushed " << cached_chunks.size() << " chunks from the "
+              << "small chunk cache of " << Name() << " before extending it";
+      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+      if (ptr != nullptr) {
+        AddTraceMe("MemoryAllocation", ptr);
+        return ptr;
+      }
+    }
+  }
+
   // Try to extend
   if (Extend(unused_alignment, rounded_bytes)) {
     ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
@@ -449,6 +512,18 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // With a sub-allocator backed by virtual memory, the physical memory behind
+  // the free chunks, none of which is large enough, can be released and mapped
+  // again by Extend() at the end of the address range as one large chunk.
+  if (ReleaseFreePhysicalMemoryInternal() > 0 &&
+      Extend(unused_alignment, rounded_bytes)) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // We searched all bins for an existing free chunk to use and
   // couldn't find one.  This means we must have run out of memory,
   // Dump the memory log for analysis.
@@ -540,10 +615,6 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         continue;
       }
       if (chunk->size >= rounded_bytes) {
-        // We found an existing chunk that fits us that wasn't in use, so remove
-        // it from the free bin structure prior to using.
-        RemoveFreeChunkIterFromBin(&b->free_chunks, citer);
-
         // If we can break the size of the chunk into two reasonably large
         // pieces, do so.  In any case don't waste more than a threshold of
         // kMaxInternalFragmentation bytes on padding this alloc. If this
@@ -553,9 +624,20 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
             (internal_fragmentation_fraction_ > 0.0)
                 ? internal_fragmentation_fraction_ * memory_limit_
                 : 128 << 20;
-        if (chunk->size >= rounded_bytes * 2 ||
-            static_cast<int64>(chunk->size) - rounded_bytes >=
-                kMaxInternalFragmentation) {
+        const bool split = chunk->size >= rounded_bytes * 2 ||
+                           static_cast<int64>(chunk->size) - rounded_bytes >=
+                               kMaxInternalFragmentation;
+        if (!released_ranges_.empty() &&
+            !RestorePhysicalMemory(chunk->ptr,
+                                   split ? rounded_bytes : chunk->size)) {
+          continue;
+        }
+
+        // We found an existing chunk that fits us that wasn't in use, so remove
+        // it from the free bin structure prior to using.
+        RemoveFreeChunkIterFromBin(&b->free_chunks, citer);
+
+        if (split) {
           SplitChunk(h, rounded_bytes);
           chunk = ChunkFromHandle(h);  // Update chunk pointer in case it moved
         }
@@ -566,6 +648,9 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         // Assign a unique id and increment the id counter, marking the
         // chunk as being in use.
         chunk->allocation_id = next_allocation_id_++;
+        if (metrics_interval_micros_ > 0) {
+          chunk->allocated_at_micros = Env::Default()->NowMicros();
+        }
 
         // Update stats.
         ++stats_.num_allocs;
@@ -649,17 +734,213 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(1) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  if (ptr != nullptr && DeallocateToSmallChunkCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
 
+void BFCAllocator::EnableSmallChunkCache(int num_stripes) {
+  if (num_stripes <= 0) return;
+  DCHECK(cache_stripes_ == nullptr);
+  num_cache_stripes_ = num_stripes;
+  cache_stripes_.reset(new CacheStripe[num_stripes]);
+  VLOG(1) << "Enabled small chunk cache with " << num_stripes
+          << " stripes for " << Name();
+}
+
+BFCAllocator::CacheStripe* BFCAllocator::StripeForPtr(const void* ptr) const {
+  const uint64 h = Hash64Combine(reinterpret_cast<uintptr_t>(ptr), 0);
+  return &cache_stripes_[h % num_cache_stripes_];
+}
+
+BFCAllocator::CacheStripe* BFCAllocator::StripeForCurrentThread() const {
+  static std::atomic<int> next_thread_index{0};
+  static thread_local int thread_index =
+      next_thread_index.fetch_add(1, std::memory_order_relaxed);
+  return &cache_stripes_[thread_index % num_cache_stripes_];
+}
+
+void* BFCAllocator::AllocateFromSmallChunkCache(int size_class,
+                                                size_t num_bytes) {
+  void* ptr = nullptr;
+  {
+    CacheStripe* stripe = StripeForCurrentThread();
+    mutex_lock l(stripe->mu);
+    std::vector<void*>& free_chunks = stripe->free_chunks[size_class];
+    if (free_chunks.empty()) return nullptr;
+    ptr = free_chunks.back();
+    free_chunks.pop_back();
+  }
+  CacheStripe* home = StripeForPtr(ptr);
+  {
+    mutex_lock l(home->mu);
+    CachedChunk& cached = home->chunks[ptr];
+    DCHECK(!cached.in_use);
+    cached.in_use = true;
+    cached.requested_size = num_bytes;
+    cached_bytes_.fetch_sub(cached.chunk_size, std::memory_order_relaxed);
+  }
+  cache_hits_.fetch_add(1, std::memory_order_relaxed);
+  return ptr;
+}
+
+void BFCAllocator::AddToSmallChunkCache(void* ptr, int size_class,
+                                        size_t num_bytes) {
+  cache_misses_.fetch_add(1, std::memory_order_relaxed);
+  const size_t chunk_size = AllocatedSize(ptr);
+  CacheStripe* home = StripeForPtr(ptr);
+  mutex_lock l(home->mu);
+  CachedChunk& cached = home->chunks[ptr];
+  cached.chunk_size = chunk_size;
+  cached.requested_size = num_bytes;
+  cached.size_class = size_class;
+  cached.in_use = true;
+}
+
+bool BFCAllocator::DeallocateToSmallChunkCache(void* ptr) {
+  if (cache_stripes_ == nullptr) return false;
+  CacheStripe* home = StripeForPtr(ptr);
+  int size_class;
+  size_t chunk_size;
+  {
+    mutex_lock l(home->mu);
+    auto it = home->chunks.find(ptr);
+    if (it == home->chunks.end()) return false;
+    if (timing_counter_ != nullptr) {
+      home->chunks.erase(it);
+      return false;
+    }
+    DCHECK(it->second.in_use);
+    it->second.in_use = false;
+    size_class = it->second.size_class;
+    chunk_size = it->second.chunk_size;
+  }
+  // The free chunk is parked on the stripe of the deallocating thread, which
+  // is likely to allocate a chunk of the same size again.
+  {
+    CacheStripe* stripe = StripeForCurrentThread();
+    mutex_lock l(stripe->mu);
+    std::vector<void*>& free_chunks = stripe->free_chunks[size_class];
+    if (free_chunks.size() < kMaxCachedChunksPerClass) {
+      free_chunks.push_back(ptr);
+      cached_bytes_.fetch_add(chunk_size, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  // The free list is full; return the chunk to the bins.
+  mutex_lock l(home->mu);
+  home->chunks.erase(ptr);
+  return false;
+}
+
+size_t BFCAllocator::ReleaseFreePhysicalMemory() {
+  mutex_lock l(lock_);
+  return ReleaseFreePhysicalMemoryInternal();
+}
+
+size_t BFCAllocator::ReleaseFreePhysicalMemoryInternal() {
+  size_t total_released_bytes = 0;
+  for (BinNum b = 0; b < kNumBins; b++) {
+    for (ChunkHandle h : BinFromIndex(b)->free_chunks) {
+      const Chunk* c = ChunkFromHandle(h);
+      // The last chunk of a region gets merged with the memory added by the
+      // next Extend(), which must be usable without restoring anything.
+      if (c->next == kInvalidChunkHandle) continue;
+      const size_t released_bytes =
+          sub_allocator_->ReleasePhysical(c->ptr, c->size);
+      if (released_bytes == 0) continue;
+
+      // Ranges released before the chunk was coalesced with its neighbors are
+      // merged into the range of the whole chunk.
+      const char* begin = static_cast<const char*>(c->ptr);
+      ReleasedRange range = {c->size, released_bytes};
+      for (auto it = released_ranges_.lower_bound(begin);
+           it != released_ranges_.end() && it->first < begin + c->size;) {
+        range.released_bytes += it->second.released_bytes;
+        it = released_ranges_.erase(it);
+      }
+      released_ranges_.emplace(begin, range);
+      total_released_bytes += released_bytes;
+    }
+  }
+  if (total_released_bytes > 0) {
+    total_region_allocated_bytes_ -= total_released_bytes;
+    VLOG(1) << Name() << " released "
+            << strings::HumanReadableNumBytes(total_released_bytes)
+            << " of physical memory behind free chunks";
+  }
+  return total_released_bytes;
+}
+
+bool BFCAllocator::RestorePhysicalMemory(const void* ptr, size_t num_bytes) {
+  const char* begin = static_cast<const char*>(ptr);
+  const char* end = begin + num_bytes;
+  // The range containing `begin`, if any, starts before it.
+  auto it = released_ranges_.upper_bound(begin);
+  if (it != released_ranges_.begin() &&
+      std::prev(it)->first + std::prev(it)->second.size > begin) {
+    --it;
+  }
+  while (it != released_ranges_.end() && it->first < end) {
+    const ReleasedRange& range = it->second;
+    if (total_region_allocated_bytes_ + range.released_bytes > memory_limit_ ||
+        !sub_allocator_->RestorePhysical(const_cast<char*>(it->first),
+                                         range.size)) {
+      return false;
+    }
+    total_region_allocated_bytes_ += range.released_bytes;
+    it = released_ranges_.erase(it);
+  }
+  return true;
+}
+
+bool BFCAllocator::FlushSmallChunkCache() {
+  std::vector<void*> to_free = TakeSmallChunkCache();
+  for (void* ptr : to_free) {
+    DeallocateRawInternal(ptr);
+  }
+  if (!to_free.empty()) {
+    VLOG(2) << "Flushed " << to_free.size() << " chunks from the small chunk "
+            << "cache of " << Name();
+    retry_helper_.NotifyDealloc();
+  }
+  return !to_free.empty();
+}
+
+std::vector<void*> BFCAllocator::TakeSmallChunkCache() {
+  std::vector<void*> to_free;
+  if (cache_stripes_ == nullptr) return to_free;
+  for (int i = 0; i < num_cache_stripes_; ++i) {
+    CacheStripe& stripe = cache_stripes_[i];
+    mutex_lock l(stripe.mu);
+    for (std::vector<void*>& free_chunks : stripe.free_chunks) {
+      to_free.insert(to_free.end(), free_chunks.begin(), free_chunks.end());
+      free_chunks.clear();
+    }
+  }
+  for (void* ptr : to_free) {
+    CacheStripe* home = StripeForPtr(ptr);
+    mutex_lock l(home->mu);
+    auto it = home->chunks.find(ptr);
+    DCHECK(it != home->chunks.end());
+    cached_bytes_.fetch_sub(it->second.chunk_size, std::memory_order_relaxed);
+    home->chunks.erase(it);
+  }
+  return to_free;
+}
+
 void BFCAllocator::DeallocateRawInternal(void* ptr) {
   if (ptr == nullptr) {
     VLOG(2) << "tried to deallocate nullptr";
     return;
   }
   mutex_lock l(lock_);
+  DeallocateRawInternalLocked(ptr);
+}
 
+void BFCAllocator::DeallocateRawInternalLocked(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -668,6 +949,16 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   void* chunk_ptr = chunk->ptr;
   int64 req_bytes = chunk->requested_size;
   int64 alloc_bytes = chunk->size;
+  const uint64 now_micros =
+      metrics_interval_micros_ > 0 ? Env::Default()->NowMicros() : 0;
+  // Chunks eligible for the small chunk cache may have been reused from the
+  // cache without being reallocated, so their lifetimes are unknown.
+  if (metrics_interval_micros_ > 0 &&
+      (cache_stripes_ == nullptr ||
+       CachedSizeClass(RoundedBytes(req_bytes)) < 0)) {
+    metrics::RecordBfcAllocationLifetime(
+        name_, now_micros - chunk->allocated_at_micros);
+  }
 
   MarkFree(h);
 
@@ -683,11 +974,32 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   // correct aggregation stats (bytes_in_use, fragmentation).
   AddTraceMe("MemoryDeallocation", chunk_ptr, req_bytes, alloc_bytes);
 
+  if (metrics_interval_micros_ > 0) {
+    MaybeExportMetrics(now_micros);
+  }
+
   if (VLOG_IS_ON(4)) {
     LOG(INFO) << "F: " << RenderOccupancy();
   }
 }
 
+void BFCAllocator::MaybeExportMetrics(uint64 now_micros) {
+  if (now_micros < next_metrics_export_micros_) return;
+  next_metrics_export_micros_ = now_micros + metrics_interval_micros_;
+  for (BinNum b = 0; b < kNumBins; b++) {
+    const Bin* bin = BinFromIndex(b);
+    int64 free_bytes = 0;
+    for (ChunkHandle h : bin->free_chunks) {
+      free_bytes += ChunkFromHandle(h)->size;
+    }
+    metrics::UpdateBfcAllocatorBinFreeChunks(name_, BinNumToSize(b),
+                                             bin->free_chunks.size(),
+                                             free_bytes);
+  }
+  metrics::UpdateBfcAllocatorRegions(name_, LargestFreeChunk(),
+                                     region_manager_.regions().size());
+}
+
 // Merges h1 and h2 when Chunk(h1)->next is h2 and Chunk(h2)->prev is c1.
 // We merge Chunk(h2) into Chunk(h1).
 void BFCAllocator::Merge(BFCAllocator::ChunkHandle h1,
@@ -902,6 +1214,16 @@ bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
+  if (cache_stripes_ != nullptr) {
+    // Chunks served from the small chunk cache don't update the requested
+    // size recorded in the bins.
+    CacheStripe* stripe = StripeForPtr(ptr);
+    mutex_lock l(stripe->mu);
+    auto it = stripe->chunks.find(ptr);
+    if (it != stripe->chunks.end()) {
+      return it->second.requested_size;
+    }
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -1173,10 +1495,21 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.largest_free_block_bytes = LargestFreeChunk();
+  stats.heap_bytes = total_region_allocated_bytes_;
+  if (cache_stripes_ != nullptr) {
+    stats.cache_hits = cache_hits_.load(std::memory_order_relaxed);
+    stats.cache_misses = cache_misses_.load(std::memory_order_relaxed);
+    stats.num_allocs += stats.cache_hits;
+    stats.bytes_in_use -= cached_bytes_.load(std::memory_order_relaxed);
+  }
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
+  cache_hits_.store(0, std::memory_order_relaxed);
+  cache_misses_.store(0, std::memory_order_relaxed);
   mutex_lock l(lock_);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
@@ -17,12 +17,15 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <deque>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
@@ -85,6 +88,36 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Enables a lock-striped cache of recently freed small chunks. A chunk that
+  // served a request of at most kMaxCachedChunkBytes (after rounding) is not
+  // returned to the bins when it is deallocated, but parked on a per-size-class
+  // free list of one of `num_stripes` stripes, each guarded by its own lock.
+  // Later requests of the same rounded size are served from the stripe of the
+  // calling thread without taking the allocator's global lock.
+  //
+  // Cached chunks are flushed back to the bins when no free chunk fits an
+  // allocation, before the allocator grows its heap, or by calling
+  // FlushSmallChunkCache(). Chunks parked in
+  // the cache are not counted in `bytes_in_use`, and a chunk served from the
+  // cache keeps the allocation id it was first assigned.
+  //
+  // Must be called before the first allocation. Has no effect if `num_stripes`
+  // is not positive. Allocations that specify `freed_by_func`, and all
+  // deallocations once a timing counter is set, bypass the cache.
+  void EnableSmallChunkCache(int num_stripes);
+
+  // Returns every chunk parked in the small chunk cache to the bins. Returns
+  // true if any chunk was returned.
+  bool FlushSmallChunkCache();
+
+  // Releases the physical memory behind the free chunks, keeping their
+  // addresses, if the sub-allocator supports it (see
+  // SubAllocator::ReleasePhysical). The memory is restored when the chunks
+  // are allocated again. Returns the number of bytes released. This is also
+  // tried before running out of memory, and can be called when the allocator
+  // is idle to leave the memory to other processes sharing the device.
+  size_t ReleaseFreePhysicalMemory();
+
  protected:
   // This setting controls when a chunk should be split, if its size exceeds the
   // requested allocation size. It is not expected to be changed after
@@ -100,11 +133,33 @@ class BFCAllocator : public Allocator {
                             bool dump_log_on_failure,
                             uint64 freed_before_count);
 
+  // Allocates from the bins, bypassing the small chunk cache.
+  void* AllocateRawUncached(size_t alignment, size_t num_bytes,
+                            const AllocationAttributes& allocation_attr);
+
   void* AllocateRawInternalWithRetry(
       size_t alignment, size_t num_bytes,
       const AllocationAttributes& allocation_attr);
 
   void DeallocateRawInternal(void* ptr);
+  void DeallocateRawInternalLocked(void* ptr)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns a chunk parked in the small chunk cache for requests of
+  // `size_class`, or nullptr if there is none.
+  void* AllocateFromSmallChunkCache(int size_class, size_t num_bytes);
+
+  // Registers `ptr`, newly allocated from the bins, with the small chunk cache
+  // so that it is parked there when deallocated.
+  void AddToSmallChunkCache(void* ptr, int size_class, size_t num_bytes);
+
+  // Parks `ptr` in the small chunk cache. Returns false if `ptr` must be
+  // returned to the bins instead.
+  bool DeallocateToSmallChunkCache(void* ptr);
+
+  // Removes every chunk parked in the small chunk cache from it, and returns
+  // them. The caller must return them to the bins.
+  std::vector<void*> TakeSmallChunkCache();
 
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
@@ -194,6 +249,9 @@ class BFCAllocator : public Allocator {
     // Optional count when this chunk was most recently made free.
     uint64 freed_at_count = 0;
 
+    // When the chunk was allocated, if allocator metrics are enabled.
+    uint64 allocated_at_micros = 0;
+
     bool in_use() const { return allocation_id != -1; }
 
 #ifdef TENSORFLOW_MEM_DEBUG
@@ -451,6 +509,14 @@ class BFCAllocator : public Allocator {
   void DeallocateRegions(const absl::flat_hash_set<void*>& region_ptrs)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  size_t ReleaseFreePhysicalMemoryInternal() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Restores the physical memory released behind [ptr, ptr + num_bytes).
+  // Returns false if that would exceed the memory limit or the sub-allocator
+  // failed.
+  bool RestorePhysicalMemory(const void* ptr, size_t num_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Returns a pointer to an underlying allocated chunk of size
   // 'rounded_bytes'.
   void* FindChunkPtr(BinNum bin_num, size_t rounded_bytes, size_t num_bytes,
@@ -486,6 +552,11 @@ class BFCAllocator : public Allocator {
   MemoryDump RecordMemoryMapInternal() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   void MaybeWriteMemoryMap() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Exports the free chunks of each bin, the largest free chunk and the number
+  // of regions to the allocator metrics, if metrics_interval_micros_ passed
+  // since the last export.
+  void MaybeExportMetrics(uint64 now_micros) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   ChunkHandle AllocateChunk() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   void DeallocateChunk(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
@@ -561,9 +632,20 @@ class BFCAllocator : public Allocator {
   // The size of the current region allocation.
   size_t curr_region_allocation_bytes_;
 
-  // The total number of allocated bytes by the allocator.
+  // The total number of allocated bytes by the allocator. Excludes the
+  // physical memory released behind free chunks.
   size_t total_region_allocated_bytes_ = 0;
 
+  // A range of addresses within a free chunk whose physical memory was
+  // released, see ReleaseFreePhysicalMemory().
+  struct ReleasedRange {
+    size_t size;
+    size_t released_bytes;
+  };
+  // Keyed by the start of the range. Ranges never overlap, and lie within a
+  // single free chunk.
+  std::map<const char*, ReleasedRange> released_ranges_ TF_GUARDED_BY(lock_);
+
   // An indicator that expansion of a region has hit the limits
   // of the available memory.
   bool started_backpedal_ = false;
@@ -584,8 +666,60 @@ class BFCAllocator : public Allocator {
   SharedCounter* timing_counter_ = nullptr;
   std::deque<ChunkHandle> timestamped_chunks_;
 
+  // Small chunk cache; see EnableSmallChunkCache().
+  static constexpr size_t kMaxCachedChunkBytes = 4096;
+  static constexpr int kNumCachedSizeClasses =
+      kMaxCachedChunkBytes >> kMinAllocationBits;
+  // Caps the number of free chunks of each size class held by one stripe.
+  static constexpr int kMaxCachedChunksPerClass = 64;
+
+  // Returns the cache size class for requests of `rounded_bytes`, or -1 if
+  // such requests are not cached.
+  static int CachedSizeClass(size_t rounded_bytes) {
+    if (rounded_bytes > kMaxCachedChunkBytes) return -1;
+    return (rounded_bytes >> kMinAllocationBits) - 1;
+  }
+
+  struct CachedChunk {
+    size_t chunk_size = 0;
+    size_t requested_size = 0;
+    int size_class = -1;
+    bool in_use = false;
+  };
+
+  // The metadata of a chunk registered with the cache always lives in the
+  // stripe selected by the chunk's address (its "home" stripe), so that any
+  // thread can find it on deallocation. Free chunks are parked on the stripe of
+  // the thread that freed them. A thread never holds two stripe locks at once.
+  // Stripes are padded to avoid false sharing between them; the padding is
+  // explicit because new[] does not honor alignas() beyond the default
+  // alignment before C++17.
+  struct CacheStripe {
+    mutex mu;
+    absl::flat_hash_map<const void*, CachedChunk> chunks TF_GUARDED_BY(mu);
+    std::array<std::vector<void*>, kNumCachedSizeClasses> free_chunks
+        TF_GUARDED_BY(mu);
+    char pad[64];
+  };
+
+  CacheStripe* StripeForPtr(const void* ptr) const;
+  CacheStripe* StripeForCurrentThread() const;
+
+  int num_cache_stripes_ = 0;
+  std::unique_ptr<CacheStripe[]> cache_stripes_;
+  std::atomic<int64> cache_hits_{0};
+  std::atomic<int64> cache_misses_{0};
+  // Bytes of the free chunks parked in the cache. The bins consider these
+  // chunks to be in use.
+  std::atomic<int64> cached_bytes_{0};
+
   double internal_fragmentation_fraction_ = {0.0};
 
+  // How often fragmentation metrics are exported, from the environment
+  // variable TF_BFC_ALLOCATOR_METRICS_INTERVAL_MS. 0 disables the metrics,
+  // including the allocation lifetimes.
+  int64 metrics_interval_micros_ = 0;
+
   std::atomic<uint64> safe_frontier_ = {0};
 
   // Structures mutable after construction
@@ -603,6 +737,7 @@ class BFCAllocator : public Allocator {
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+  uint64 next_metrics_export_micros_ TF_GUARDED_BY(lock_) = 0;
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ = 0 TF_GUARDED_BY(lock_);
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
@@ -60,13 +60,39 @@ void CollectiveParamResolverLocal::CompleteGroupAsync(
 }
 
 namespace {
+// Returns true if the group spans several tasks that each contribute the same
+// number, greater than one, of devices, and the devices of each task are
+// adjacent in the default rank order.  A flat ring over such a group sends
+// most of its data between tasks, which a hierarchical algorithm avoids.
+bool IsMultiTaskGroupWithUniformTasks(const CollGroupParams& group) {
+  if (group.num_tasks < 2 || group.group_size <= group.num_tasks ||
+      group.group_size % group.num_tasks != 0 ||
+      group.task_names.size() != static_cast<size_t>(group.group_size)) {
+    return false;
+  }
+  const int devices_per_task = group.group_size / group.num_tasks;
+  for (int rank = 0; rank < group.group_size; ++rank) {
+    if (group.task_names[rank] !=
+        group.task_names[rank - rank % devices_per_task]) {
+      return false;
+    }
+  }
+  return true;
+}
+
 const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
   switch (cp->instance.type) {
     case BROADCAST_COLLECTIVE:
       return nccl ? "NcclBroadcast" : "HierarchicalTreeBroadcast";
 
     case REDUCTION_COLLECTIVE:
-      return nccl ? "NcclReduce" : "RingReduce";
+      if (nccl) return "NcclReduce";
+      // The "ring" hint keeps the flat ring over all devices.
+      if (cp->instance.impl_details.communication_hint != "ring" &&
+          IsMultiTaskGroupWithUniformTasks(cp->group)) {
+        return "HierarchicalRingReduce";
+      }
+      return "RingReduce";
 
     case GATHER_COLLECTIVE:
       return nccl ? "NcclGather" : "RingGather";
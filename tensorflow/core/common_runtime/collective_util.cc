@@ -108,5 +108,29 @@ Status ComputeBinOp(OpKernelContext* op_ctx, OpKernelContext::Params* params,
   return sub_ctx->sub_ctx_->status();
 }
 
+Status ComputeUnaryOp(OpKernelContext* op_ctx, OpKernelContext::Params* params,
+                      Device* device, OpKernel* op, Tensor* input,
+                      Tensor* output) {
+  OpKernelContext::Params sub_params(*params);
+  gtl::InlinedVector<TensorValue, 4> sub_inputs({TensorValue(input)});
+  gtl::InlinedVector<AllocatorAttributes, 4> sub_input_attr(
+      {op_ctx->input_alloc_attr(0)});
+  // Unlike ComputeBinOp the output has its own buffer, since it may not have
+  // the type of the input.
+  int forward_from = OpKernelContext::Params::kNoReservation;
+  sub_params.op_kernel = op;
+  sub_params.inputs = &sub_inputs;
+  sub_params.input_alloc_attrs = &sub_input_attr;
+  sub_params.op_device_context = op_ctx->op_device_context();
+  sub_params.eigen_gpu_device = nullptr;
+  sub_params.ensure_eigen_gpu_device();
+  sub_params.forward_from_array = &forward_from;
+  OpKernelContext sub_ctx(&sub_params, 1);
+  device->Compute(op, &sub_ctx);
+  TF_RETURN_IF_ERROR(sub_ctx.status());
+  *output = *sub_ctx.mutable_output(0);
+  return Status::OK();
+}
+
 }  // namespace collective_util
 }  // namespace tensorflow
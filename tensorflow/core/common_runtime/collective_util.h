@@ -53,6 +53,12 @@ Status ComputeBinOp(OpKernelContext* op_ctx, OpKernelContext::Params* params,
                     Device* device, OpKernel* op, Tensor* output,
                     Tensor* input);
 
+// Runs the single-input, single-output `op`, e.g. a Cast, on `input` and sets
+// `output` to the tensor it allocates.
+Status ComputeUnaryOp(OpKernelContext* op_ctx, OpKernelContext::Params* params,
+                      Device* device, OpKernel* op, Tensor* input,
+                      Tensor* output);
+
 }  // namespace collective_util
 }  // namespace tensorflow
 
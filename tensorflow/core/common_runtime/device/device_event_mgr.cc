@@ -95,12 +95,21 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      use_host_callbacks_(
+          gpu_options.experimental().use_host_callback_event_completion()),
       threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
   StartPollingLoop();
 }
 
 EventMgr::~EventMgr() {
+  {
+    // The pending host callbacks refer to this object.
+    mutex_lock l(mu_);
+    while (pending_host_callbacks_ > 0) {
+      host_callbacks_done_.wait(l);
+    }
+  }
   StopPollingLoop();
 
   // Events are owned by this object.
@@ -166,6 +175,23 @@ void EventMgr::PollLoop() {
   polling_stopped_->Notify();
 }
 
+void EventMgr::ThenExecuteWithHostCallback(se::Stream* stream,
+                                           std::function<void()> func) {
+  {
+    mutex_lock l(mu_);
+    ++pending_host_callbacks_;
+  }
+  stream->ThenDoHostCallback([this, func = std::move(func)]() {
+    // Host callbacks must not call into the device API and block the stream
+    // until they return, so func runs on the threadpool as with events.
+    threadpool_.Schedule(func);
+    mutex_lock l(mu_);
+    if (--pending_host_callbacks_ == 0) {
+      host_callbacks_done_.notify_all();
+    }
+  });
+}
+
 void EventMgr::QueueInUse(se::Stream* stream, InUse in_use) {
   VLOG(2) << "QueueInUse  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
@@ -71,6 +71,10 @@ class EventMgr {
   // func must be brief and non-blocking since it executes in the one
   // thread used for all such callbacks and also buffer deletions.
   inline void ThenExecute(se::Stream* stream, std::function<void()> func) {
+    if (use_host_callbacks_ && stream->ok()) {
+      ThenExecuteWithHostCallback(stream, std::move(func));
+      return;
+    }
     ToFreeVector to_free;
     {
       mutex_lock l(mu_);
@@ -86,6 +90,8 @@ class EventMgr {
   friend class EventMgrFactory;
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  // GPUOptions::Experimental::use_host_callback_event_completion.
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
 
@@ -111,6 +117,11 @@ class EventMgr {
   void QueueInUse(se::Stream* stream, InUse in_use)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Enqueues on the stream a host callback that schedules func on the
+  // threadpool, instead of an event for the polling loop.
+  void ThenExecuteWithHostCallback(se::Stream* stream,
+                                   std::function<void()> func);
+
   void QueueFunc(se::Stream* stream, std::function<void()> func)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     QueueInUse(stream, {nullptr, std::move(func)});
@@ -139,6 +150,11 @@ class EventMgr {
   std::deque<InUse> used_events_ TF_GUARDED_BY(mu_);
 
   bool stop_polling_ TF_GUARDED_BY(mu_);
+
+  // Number of host callbacks enqueued by ThenExecuteWithHostCallback() that
+  // have not run yet, and the condition signaled when it drops to zero.
+  int64 pending_host_callbacks_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable host_callbacks_done_;
   std::unique_ptr<Notification> polling_stopped_;
 
   // The main PollLoop for the event manager runs in this threadpool.
@@ -138,6 +138,32 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that with host callback completion, functions run without events and
+// without the polling loop.
+TEST(EventMgr, HostCallbackCompletion) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_use_host_callback_event_completion(
+      true);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  TEST_EventMgrHelper th(&em);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  const int kNumFuncs = 16;
+  std::atomic<int> num_done(0);
+  Notification note;
+  for (int i = 0; i < kNumFuncs; ++i) {
+    em.ThenExecute(stream.get(), [&num_done, &note]() {
+      if (++num_done == kNumFuncs) note.Notify();
+    });
+  }
+  EXPECT_EQ(0, th.queue_size());
+  EXPECT_EQ(0, th.free_size());
+  note.WaitForNotification();
+  EXPECT_EQ(kNumFuncs, num_done);
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
@@ -0,0 +1,177 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/device_feed_stager.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+
+namespace {
+
+DeviceContext* DefaultContext(Device* device) {
+  const DeviceBase::GpuDeviceInfo* info = device->tensorflow_gpu_device_info();
+  return info == nullptr ? nullptr : info->default_context;
+}
+
+}  // namespace
+
+// The tensors of one staged step. `host_tensors` hold the pinned copies of the
+// feeds until the device copies that read them are done.
+struct DeviceFeedStager::StagedStep {
+  std::vector<Tensor> host_tensors;
+  std::vector<Tensor> device_tensors;
+
+  mutex mu;
+  int num_pending TF_GUARDED_BY(mu) = 0;
+  Status status TF_GUARDED_BY(mu);
+  Notification done;
+
+  void CopyDone(const Status& s) {
+    bool last;
+    {
+      mutex_lock l(mu);
+      status.Update(s);
+      last = --num_pending == 0;
+    }
+    if (last) done.Notify();
+  }
+};
+
+DeviceFeedStager::DeviceFeedStager(Device* device, int max_staged_steps)
+    : device_(device),
+      device_context_(DefaultContext(device)),
+      max_staged_steps_(std::max(max_staged_steps, 1)) {}
+
+DeviceFeedStager::~DeviceFeedStager() {
+  mutex_lock l(mu_);
+  for (const auto& step : staged_) {
+    step->done.WaitForNotification();
+  }
+}
+
+Status DeviceFeedStager::Stage(const std::vector<Tensor>& host_tensors) {
+  if (device_context_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Device ", device_->name(),
+        " has no device context for copies from the host");
+  }
+  for (const Tensor& t : host_tensors) {
+    if (!DataTypeCanUseMemcpy(t.dtype())) {
+      return errors::InvalidArgument("Cannot stage a feed of type ",
+                                     DataTypeString(t.dtype()));
+    }
+  }
+
+  {
+    mutex_lock l(mu_);
+    while (staged_.size() + num_staging_ >= max_staged_steps_) {
+      staged_cv_.wait(l);
+    }
+    ++num_staging_;
+  }
+  std::shared_ptr<StagedStep> step;
+  Status s = StartCopies(host_tensors, &step);
+  {
+    mutex_lock l(mu_);
+    --num_staging_;
+    if (s.ok()) staged_.push_back(std::move(step));
+  }
+  if (!s.ok()) staged_cv_.notify_one();
+  return s;
+}
+
+Status DeviceFeedStager::StartCopies(const std::vector<Tensor>& host_tensors,
+                                     std::shared_ptr<StagedStep>* out_step) {
+  AllocatorAttributes pinned_attr;
+  pinned_attr.set_on_host(true);
+  pinned_attr.set_gpu_compatible(true);
+  Allocator* pinned_allocator = device_->GetAllocator(pinned_attr);
+  Allocator* device_allocator = device_->GetAllocator(AllocatorAttributes());
+
+  auto step = std::make_shared<StagedStep>();
+  const int num_tensors = host_tensors.size();
+  step->host_tensors.resize(num_tensors);
+  step->device_tensors.resize(num_tensors);
+  std::vector<int> to_copy;
+  for (int i = 0; i < num_tensors; ++i) {
+    const Tensor& host_tensor = host_tensors[i];
+    if (MTypeFromDType(host_tensor.dtype()) == HOST_MEMORY ||
+        host_tensor.NumElements() == 0) {
+      step->device_tensors[i] = host_tensor;
+      continue;
+    }
+    // Copying into pinned memory here lets the DMA below run asynchronously.
+    Tensor pinned(pinned_allocator, host_tensor.dtype(), host_tensor.shape());
+    Tensor device_tensor(device_allocator, host_tensor.dtype(),
+                         host_tensor.shape());
+    if (!pinned.IsInitialized() || !device_tensor.IsInitialized()) {
+      return errors::ResourceExhausted("Failed to allocate ",
+                                       host_tensor.TotalBytes(),
+                                       " bytes to stage a feed on ",
+                                       device_->name());
+    }
+    std::memcpy(pinned.data(), host_tensor.tensor_data().data(),
+                host_tensor.TotalBytes());
+    step->host_tensors[i] = std::move(pinned);
+    step->device_tensors[i] = std::move(device_tensor);
+    to_copy.push_back(i);
+  }
+
+  {
+    mutex_lock l(step->mu);
+    step->num_pending = to_copy.size() + 1;
+  }
+  for (int i : to_copy) {
+    device_context_->CopyCPUTensorToDevice(
+        &step->host_tensors[i], device_, &step->device_tensors[i],
+        [step](const Status& s) { step->CopyDone(s); });
+  }
+  // Accounts for the "+ 1" above, so that `done` isn't notified before all
+  // the copies have been enqueued.
+  step->CopyDone(Status::OK());
+  *out_step = std::move(step);
+  return Status::OK();
+}
+
+Status DeviceFeedStager::Take(std::vector<Tensor>* device_tensors) {
+  std::shared_ptr<StagedStep> step;
+  {
+    mutex_lock l(mu_);
+    if (staged_.empty()) {
+      return errors::FailedPrecondition("No feeds have been staged");
+    }
+    step = std::move(staged_.front());
+    staged_.pop_front();
+  }
+  staged_cv_.notify_one();
+
+  step->done.WaitForNotification();
+  {
+    mutex_lock l(step->mu);
+    TF_RETURN_IF_ERROR(step->status);
+  }
+  *device_tensors = std::move(step->device_tensors);
+  return Status::OK();
+}
+
+}  // namespace tensorflow
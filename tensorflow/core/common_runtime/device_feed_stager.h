@@ -0,0 +1,98 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_FEED_STAGER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_FEED_STAGER_H_
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Uploads the feeds of upcoming steps to an accelerator while the current step
+// runs, so that a session doesn't wait for host-to-device copies on the step
+// path.
+//
+// Each call to Stage() copies the host tensors into pinned host memory and
+// starts asynchronous copies to the device on the host-to-device stream of
+// the device's default context; the device's EventMgr signals their
+// completion. Take() returns the device tensors of the oldest staged step,
+// to be fed to a callable whose `feed_devices` name `device`:
+//
+//   DeviceFeedStager stager(gpu_device, /*max_staged_steps=*/2);
+//   TF_CHECK_OK(stager.Stage(host_feeds_for_step_0));
+//   for (int step = 0; step < num_steps; ++step) {
+//     std::vector<Tensor> feeds;
+//     TF_CHECK_OK(stager.Take(&feeds));
+//     if (step + 1 < num_steps) {
+//       TF_CHECK_OK(stager.Stage(host_feeds_for_step[step + 1]));
+//     }
+//     TF_CHECK_OK(session->RunCallable(handle, feeds, &fetches, nullptr));
+//   }
+//
+// Tensors whose type is kept in host memory on the device (e.g. DT_INT32 on
+// GPUs) are returned unchanged. This class is thread-safe.
+class DeviceFeedStager {
+ public:
+  // Does not take ownership of `device`, which must outlive this object. At
+  // most `max_staged_steps` steps can be staged before Stage() blocks for
+  // Take() to be called.
+  DeviceFeedStager(Device* device, int max_staged_steps);
+
+  // Waits for the copies still in flight.
+  ~DeviceFeedStager();
+
+  // Starts copying `host_tensors` to the device. Returns an error if the
+  // device doesn't support asynchronous copies from the host or if a tensor
+  // can't be copied by value (e.g. DT_STRING).
+  Status Stage(const std::vector<Tensor>& host_tensors);
+
+  // Waits for the oldest staged step and returns its device tensors, or the
+  // error of one of its copies. Returns FailedPrecondition if nothing is
+  // staged.
+  Status Take(std::vector<Tensor>* device_tensors);
+
+ private:
+  struct StagedStep;
+
+  // Allocates the buffers of one step and starts its copies.
+  Status StartCopies(const std::vector<Tensor>& host_tensors,
+                     std::shared_ptr<StagedStep>* out_step);
+
+  Device* const device_;  // Not owned.
+  DeviceContext* const device_context_;  // Not owned.
+  const int max_staged_steps_;
+
+  mutex mu_;
+  condition_variable staged_cv_;
+  std::deque<std::shared_ptr<StagedStep>> staged_ TF_GUARDED_BY(mu_);
+  // Number of Stage() calls that have reserved a slot but haven't appended
+  // their step to `staged_` yet.
+  int num_staging_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeviceFeedStager);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_DEVICE_FEED_STAGER_H_
@@ -0,0 +1,129 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/device_feed_stager.h"
+
+#include <cstring>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Copies host tensors asynchronously on another thread, like a GPU context
+// would on its host-to-device stream.
+class FakeDeviceContext : public DeviceContext {
+ public:
+  explicit FakeDeviceContext(Status copy_status) : copy_status_(copy_status) {}
+
+  void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
+                             Tensor* device_tensor, StatusCallback done,
+                             bool sync_dst_compute) const override {
+    Status status = copy_status_;
+    Env::Default()->SchedClosure([cpu_tensor, device_tensor, done, status]() {
+      if (status.ok()) {
+        std::memcpy(device_tensor->data(), cpu_tensor->tensor_data().data(),
+                    cpu_tensor->TotalBytes());
+      }
+      done(status);
+    });
+  }
+
+ private:
+  const Status copy_status_;
+};
+
+class FakeDevice : public Device {
+ public:
+  explicit FakeDevice(DeviceContext* context)
+      : Device(nullptr, Attributes()), context_(context) {
+    if (context_ != nullptr) {
+      gpu_device_info_.default_context = context_;
+      set_tensorflow_gpu_device_info(&gpu_device_info_);
+    }
+  }
+  ~FakeDevice() override {
+    if (context_ != nullptr) context_->Unref();
+  }
+
+  Status Sync() override { return Status::OK(); }
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+ private:
+  static DeviceAttributes Attributes() {
+    DeviceAttributes attributes;
+    attributes.set_name("/job:localhost/replica:0/task:0/device:FAKE:0");
+    attributes.set_device_type("FAKE");
+    return attributes;
+  }
+
+  DeviceContext* const context_;
+  GpuDeviceInfo gpu_device_info_;
+};
+
+TEST(DeviceFeedStagerTest, TakesStagedStepsInOrder) {
+  FakeDevice device(new FakeDeviceContext(Status::OK()));
+  DeviceFeedStager stager(&device, /*max_staged_steps=*/2);
+
+  Tensor step0 = test::AsTensor<float>({1, 2, 3});
+  Tensor step1 = test::AsTensor<float>({4, 5});
+  Tensor step1_int = test::AsTensor<int32>({7});
+  TF_ASSERT_OK(stager.Stage({step0}));
+  TF_ASSERT_OK(stager.Stage({step1, step1_int}));
+
+  std::vector<Tensor> feeds;
+  TF_ASSERT_OK(stager.Take(&feeds));
+  ASSERT_EQ(1, feeds.size());
+  test::ExpectTensorEqual<float>(step0, feeds[0]);
+  EXPECT_NE(step0.tensor_data().data(), feeds[0].tensor_data().data());
+
+  TF_ASSERT_OK(stager.Take(&feeds));
+  ASSERT_EQ(2, feeds.size());
+  test::ExpectTensorEqual<float>(step1, feeds[0]);
+  // Tensors kept in host memory are passed through without a copy.
+  EXPECT_TRUE(step1_int.SharesBufferWith(feeds[1]));
+
+  EXPECT_TRUE(errors::IsFailedPrecondition(stager.Take(&feeds)));
+}
+
+TEST(DeviceFeedStagerTest, ReportsCopyErrors) {
+  FakeDevice device(new FakeDeviceContext(errors::Internal("copy failed")));
+  DeviceFeedStager stager(&device, /*max_staged_steps=*/1);
+  TF_ASSERT_OK(stager.Stage({test::AsTensor<float>({1})}));
+  std::vector<Tensor> feeds;
+  EXPECT_TRUE(errors::IsInternal(stager.Take(&feeds)));
+}
+
+TEST(DeviceFeedStagerTest, RequiresDeviceContext) {
+  FakeDevice device(nullptr);
+  DeviceFeedStager stager(&device, /*max_staged_steps=*/1);
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      stager.Stage({test::AsTensor<float>({1})})));
+}
+
+TEST(DeviceFeedStagerTest, RejectsStrings) {
+  FakeDevice device(new FakeDeviceContext(Status::OK()));
+  DeviceFeedStager stager(&device, /*max_staged_steps=*/1);
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      stager.Stage({test::AsTensor<tstring>({"a"})})));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -21,6 +21,8 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/collective_executor_mgr.h"
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/common_runtime/constant_folding.h"
@@ -36,8 +38,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
+#include "tensorflow/core/common_runtime/shared_kernel_cache.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -60,6 +64,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/core/threadpool_options.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -78,6 +83,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -346,6 +352,20 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!status.ok()) {
     LOG(ERROR) << status.error_message();
   }
+  // Sessions in one process share the intra-op thread pool, which is sized by
+  // whichever session created it. Optionally cap the sharding of this
+  // session's ops at its own `intra_op_parallelism_threads`, so that many
+  // sessions do not each fan out over the whole pool.
+  bool limit_intra_op_parallelism = false;
+  const Status limit_status =
+      ReadBoolFromEnvVar("TF_LIMIT_SESSION_INTRA_OP_PARALLELISM", false,
+                         &limit_intra_op_parallelism);
+  if (!limit_status.ok()) {
+    LOG(ERROR) << limit_status.error_message();
+  } else if (limit_intra_op_parallelism) {
+    max_intra_op_parallelism_ =
+        std::max(0, options_.config.intra_op_parallelism_threads());
+  }
   session_handle_ =
       strings::StrCat("direct", strings::FpToString(random::New64()));
   int devices_added = 0;
@@ -620,6 +640,16 @@ Status DirectSession::RunInternal(
       pool->Schedule(std::move(c));
     };
   }
+  if (max_intra_op_parallelism_ > 0 && default_runner != nullptr) {
+    default_runner = [runner = std::move(default_runner),
+                      max_parallelism = max_intra_op_parallelism_](
+                         Executor::Args::Closure c) {
+      runner([max_parallelism, c = std::move(c)]() {
+        ScopedPerThreadMaxParallelism scope(max_parallelism);
+        c();
+      });
+    };
+  }
 
   // Start parallel Executors.
 
@@ -707,6 +737,21 @@ Status DirectSession::RunInternal(
         }
       };
 
+  for (const auto& item : executors_and_keys->items) {
+    if (item.static_plan_allocator) item.static_plan_allocator->BeginStep();
+  }
+  auto end_static_plan_steps = gtl::MakeCleanup([executors_and_keys] {
+    for (const auto& item : executors_and_keys->items) {
+      if (item.static_plan_allocator) item.static_plan_allocator->EndStep();
+    }
+  });
+
+  // Ops may also run inline on the calling thread.
+  absl::optional<ScopedPerThreadMaxParallelism> max_parallelism_scope;
+  if (max_intra_op_parallelism_ > 0) {
+    max_parallelism_scope.emplace(max_intra_op_parallelism_);
+  }
+
   if (can_execute_synchronously) {
     PrivateIntraProcessRendezvous rendezvous(device_mgr_.get());
     args.rendezvous = &rendezvous;
@@ -1364,12 +1409,38 @@ Status DirectSession::CreateExecutors(
 
     LocalExecutorParams params;
     params.device = device;
+    const int static_plan_steps =
+        options_.config.experimental().static_memory_plan_recorded_steps();
+    if (static_plan_steps > 0 && !run_state_args->is_partial_run &&
+        device->device_type() == DEVICE_CPU) {
+      item->static_plan_allocator =
+          absl::make_unique<StaticMemoryPlanAllocator>(
+              device->GetAllocator(AllocatorAttributes()), static_plan_steps);
+      item->static_plan_device = RenamedDevice::NewRenamedDevice(
+          device->name(), device, /*owns_underlying=*/false,
+          /*isolate_session_state=*/false, /*underlying_threadpool=*/nullptr,
+          item->static_plan_allocator.get());
+      params.device = item->static_plan_device.get();
+    }
     params.session_metadata = session_metadata;
     params.function_library = lib;
     auto opseg = device->op_segment();
+    const bool share_kernels = options_.config.experimental()
+                                   .share_immutable_kernels_across_sessions();
+    const string& device_name = device->name();
     params.create_kernel =
-        [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
-                           OpKernel** kernel) {
+        [this, lib, opseg, share_kernels, device_name](
+            const std::shared_ptr<const NodeProperties>& props,
+            OpKernel** kernel) {
+          if (share_kernels &&
+              SharedKernelCache::IsShareable(props->node_def.op())) {
+            return SharedKernelCache::Global()->FindOrCreate(
+                device_name, props->node_def,
+                [lib, &props](OpKernel** kernel) {
+                  return lib->CreateKernel(props, kernel);
+                },
+                kernel);
+          }
           // NOTE(mrry): We must not share function kernels (implemented
           // using `CallOp`) between subgraphs, because `CallOp::handle_`
           // is tied to a particular subgraph. Even if the function itself
@@ -1386,7 +1457,10 @@ Status DirectSession::CreateExecutors(
           return opseg->FindOrCreate(session_handle_, props->node_def.name(),
                                      kernel, create_fn);
         };
-    params.delete_kernel = [lib](OpKernel* kernel) {
+    params.delete_kernel = [lib, share_kernels](OpKernel* kernel) {
+      if (share_kernels && SharedKernelCache::Global()->Release(kernel)) {
+        return;
+      }
       if (kernel && !OpSegment::ShouldOwnKernel(lib, kernel->type_string()))
         delete kernel;
     };
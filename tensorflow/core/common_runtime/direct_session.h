@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
+#include "tensorflow/core/common_runtime/static_memory_plan_allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -147,6 +148,11 @@ class DirectSession : public Session {
     std::unique_ptr<Graph> graph = nullptr;
     Device* device = nullptr;                // not owned.
     FunctionLibraryRuntime* flib = nullptr;  // not owned.
+    // If the session uses static memory plans, the allocator that plans this
+    // partition's allocations, and the device wrapper the executor uses to
+    // reach it. Both must outlive `executor`.
+    std::unique_ptr<StaticMemoryPlanAllocator> static_plan_allocator;
+    std::unique_ptr<Device> static_plan_device;
     std::unique_ptr<Executor> executor;
   };
 
@@ -355,6 +361,10 @@ class DirectSession : public Session {
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
 
+  // If positive, caps the number of shards that this session's ops split their
+  // work into on the shared intra-op thread pool (see work_sharder.h).
+  int max_intra_op_parallelism_ = 0;
+
   std::vector<std::unique_ptr<FunctionInfo>> functions_
       TF_GUARDED_BY(executor_lock_);
 
@@ -18,6 +18,7 @@ limitations under the License.
 #include <map>
 #include <memory>
 #include <random>
+#include <set>
 #include <string>
 #include <thread>  // NOLINT
 #include <unordered_map>
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/function_testlib.h"
+#include "tensorflow/core/common_runtime/shared_kernel_cache.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -52,6 +54,7 @@ limitations under the License.
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA
 #include "third_party/gpus/cuda/include/cuda.h"
@@ -652,6 +655,28 @@ TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, LimitSessionIntraOpParallelism) {
+  Initialize({1, 2, 3, 4});
+
+  setenv("TF_LIMIT_SESSION_INTRA_OP_PARALLELISM", "true", 1);
+  SessionOptions options;
+  options.config.set_intra_op_parallelism_threads(1);
+  std::unique_ptr<Session> session(NewSession(options));
+  unsetenv("TF_LIMIT_SESSION_INTRA_OP_PARALLELISM");
+
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<string> output_names = {y_ + ":0"};
+  for (int i = 0; i < 10; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, output_names, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(3.0, outputs[0].matrix<float>()(0, 0));
+  }
+  // The limit only applies while the session runs ops.
+  EXPECT_GT(GetPerThreadMaxParallelism(), 1);
+}
+
 TEST_F(DirectSessionMinusAXTest, TwoCreateCallsFails) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -800,6 +825,73 @@ TEST_F(DirectSessionMinusAXTest, UseRunHandlerPool) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, ShareImmutableKernelsAcrossSessions) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()
+      ->set_share_immutable_kernels_across_sessions(true);
+  SharedKernelCache* cache = SharedKernelCache::Global();
+  const int num_kernels_before = cache->num_kernels();
+
+  auto run = [this](Session* session) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  };
+  std::unique_ptr<Session> first(NewSession(options));
+  TF_ASSERT_OK(first->Create(def_));
+  run(first.get());
+  const int num_kernels = cache->num_kernels();
+  EXPECT_GT(num_kernels, num_kernels_before);
+
+  // A second copy of the model reuses the constant kernels of the first.
+  std::unique_ptr<Session> second(NewSession(options));
+  TF_ASSERT_OK(second->Create(def_));
+  run(second.get());
+  EXPECT_EQ(num_kernels, cache->num_kernels());
+
+  TF_ASSERT_OK(first->Close());
+  first.reset();
+  run(second.get());
+  TF_ASSERT_OK(second->Close());
+  second.reset();
+  EXPECT_EQ(num_kernels_before, cache->num_kernels());
+}
+
+TEST(DirectSessionTest, SharedKernelsKeepTheirNodeNames) {
+  Graph g(OpRegistry::Global());
+  const Tensor value = test::AsScalar<float>(1.0f);
+  test::graph::Constant(&g, value, "a");
+  test::graph::Constant(&g, value, "b");
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()
+      ->set_share_immutable_kernels_across_sessions(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_ASSERT_OK(session->Create(def));
+  RunOptions run_options;
+  run_options.set_trace_level(RunOptions::FULL_TRACE);
+  RunMetadata run_metadata;
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run(run_options, {}, {"a:0", "b:0"}, {}, &outputs,
+                            &run_metadata));
+
+  // Constants with the same value do not share a kernel, so each is reported
+  // under its own name.
+  std::set<string> node_names;
+  for (const auto& dev_stats : run_metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      node_names.insert(node_stats.node_name());
+    }
+  }
+  EXPECT_EQ(1, node_names.count("a"));
+  EXPECT_EQ(1, node_names.count("b"));
+  TF_ASSERT_OK(session->Close());
+}
+
 TEST(DirectSessionTest, KeepsStateAcrossRunsOfSession) {
   GraphDef def;
   Graph g(OpRegistry::Global());
@@ -251,6 +251,12 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   core::RefCountPtr<KernelAndDevice> GetCachedKernel(Fprint128 cache_key);
 
+  // Incremented whenever kernels are evicted from the kernel cache. Holders of
+  // a cached kernel outside the cache use it to detect that it may be stale.
+  int64 KernelCacheGeneration() const {
+    return kernel_cache_generation_.load(std::memory_order_acquire);
+  }
+
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
 
   bool LogDevicePlacement() const { return log_device_placement_; }
@@ -640,6 +646,7 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
                      Fprint128Hasher>
       kernel_cache_ TF_GUARDED_BY(cache_mu_);
+  std::atomic<int64> kernel_cache_generation_{0};
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
 
@@ -494,6 +494,8 @@ tensorflow::Status UpdateContextWithServerDef(
     // NOTE(b/143914772): Potential memory leak if rendezvous has pending
     // tensors for removed / replaced workers.
     context->ClearCachesAndDefaultExecutor();
+    // Replaced workers do not know the operation templates of the old ones.
+    context->RemoteMgr()->ClearOpTemplates();
 
     remote_device_mgr = context->GetOwnedRemoteDeviceMgr();
     if (remote_device_mgr == nullptr) {
@@ -517,6 +519,10 @@ tensorflow::Status UpdateContextWithServerDef(
         VLOG(1) << "  Replaced worker " << w;
     }
     if (!replaced_workers.empty()) {
+      // The collective state of the surviving workers is kept by
+      // UpdateServerDef, but replaced workers keep their addresses and must be
+      // resolved again.
+      grpc_server->RemoveTasksFromCollectiveState(replaced_workers);
       // Treat replaced workers as removed then added back, so that we recreate
       // remote devices and contexts, and re-register functions on those workers
       removed_workers.insert(removed_workers.end(), replaced_workers.begin(),
@@ -115,8 +115,13 @@ Status EagerExecutor::SyncExecute(EagerNode* node) {
 
   // Inline execution in sync mode.
   s = node->Run();
-  tensorflow::mutex_lock l(node_queue_mutex_);
-  NotifyWaiters(id);
+  // Nobody waits on a node run inline, so the lock is only needed if some
+  // thread waits for earlier async nodes. A waiter that registers after this
+  // check is woken when the async nodes it waits for complete.
+  if (num_waiters_.load(std::memory_order_acquire) > 0) {
+    tensorflow::mutex_lock l(node_queue_mutex_);
+    NotifyWaiters(id);
+  }
   return s;
 }
 
@@ -186,6 +191,8 @@ tensorflow::Status EagerExecutor::WaitForAllPendingNodesLocked(
   auto last_id = next_node_id_ - 1;
   DVLOG(3) << "Wait for Node: [id " << last_id << "] ";
   node_done_notifications_.insert(std::make_pair(last_id, &cond));
+  num_waiters_.store(node_done_notifications_.size(),
+                     std::memory_order_release);
   cond.wait(*lock);
   // Note that we could be woken up if an error occurs, even though the node has
   // not actually executed.
@@ -314,6 +321,8 @@ void EagerExecutor::NotifyWaiters(uint64 id) {
       it->second->notify_all();
     }
     node_done_notifications_.erase(range.first, range.second);
+    num_waiters_.store(node_done_notifications_.size(),
+                       std::memory_order_release);
   }
 }
 
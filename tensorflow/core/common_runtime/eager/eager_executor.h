@@ -239,6 +239,8 @@ class EagerExecutor {
   // The map is ordered by id.
   std::multimap<uint64, condition_variable*, std::less<uint64>>
       node_done_notifications_ TF_GUARDED_BY(node_queue_mutex_);
+  // Size of `node_done_notifications_`, readable without the lock.
+  std::atomic<size_t> num_waiters_{0};
 
   // thread_exited_notification_ is notified by the `thread_` right before it
   // exits.
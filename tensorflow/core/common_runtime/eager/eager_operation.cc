@@ -32,6 +32,11 @@ namespace tensorflow {
 // Clear(), and then Reset(...) with the same arguments that would have
 // been provided to the constructor.
 void EagerOperation::Clear() {
+  ClearInputs();
+  last_kernel_.reset();
+}
+
+void EagerOperation::ClearInputs() {
   for (ImmediateExecutionTensorHandle* h : inputs_) {
     h->Unref();
   }
@@ -309,6 +314,27 @@ Status EagerOperation::SetInput(size_t index,
   return Status::OK();
 }
 
+core::RefCountPtr<KernelAndDevice> EagerOperation::GetLastKernel(
+    const Fprint128& cache_key, int64 cache_generation) {
+  if (last_kernel_ == nullptr) return nullptr;
+  if (last_kernel_cache_generation_ != cache_generation) {
+    last_kernel_.reset();
+    return nullptr;
+  }
+  if (!(last_kernel_cache_key_ == cache_key)) return nullptr;
+  last_kernel_->Ref();
+  return core::RefCountPtr<KernelAndDevice>(last_kernel_.get());
+}
+
+void EagerOperation::SetLastKernel(const Fprint128& cache_key,
+                                   int64 cache_generation,
+                                   KernelAndDevice* kernel) {
+  kernel->Ref();
+  last_kernel_.reset(kernel);
+  last_kernel_cache_key_ = cache_key;
+  last_kernel_cache_generation_ = cache_generation;
+}
+
 Status EagerOperation::Reset(
     const char* op, const char* device_name, bool remote,
     EagerExecutor* executor,
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/managed_stack_trace.h"
 
@@ -46,7 +47,11 @@ class EagerOperation : public ImmediateExecutionOperation {
 
   void Release() override { delete this; }
 
+  // Releases the inputs and drops the last kernel, see GetLastKernel.
   void Clear() override;
+  // Releases the inputs only, so that the operation can be executed again
+  // with new inputs and reuse its last kernel.
+  void ClearInputs();
   Status Reset(const char* op, const char* raw_device_name) override {
     return Reset(op, raw_device_name, false, nullptr);
   }
@@ -166,6 +171,15 @@ class EagerOperation : public ImmediateExecutionOperation {
 
   void UpdateInput(int i, TensorHandle* h);
 
+  // Returns the kernel that was last used to execute this operation if it was
+  // cached under `cache_key` and the context's kernel cache has not evicted
+  // anything since, and nullptr otherwise. This lets an operation that is
+  // executed repeatedly skip the lookup in the context's kernel cache.
+  core::RefCountPtr<KernelAndDevice> GetLastKernel(const Fprint128& cache_key,
+                                                   int64 cache_generation);
+  void SetLastKernel(const Fprint128& cache_key, int64 cache_generation,
+                     KernelAndDevice* kernel);
+
   // Like TensorHandles, EagerOperations may be placed either on a virtual
   // CustomDevice or on a physical Device.
   VariantDevice Device() const { return device_; }
@@ -255,6 +269,15 @@ class EagerOperation : public ImmediateExecutionOperation {
   EagerExecutor* executor_;                              // Not owned.
   absl::optional<EagerRemoteFunctionParams> remote_func_params_;
 
+  // The kernel last looked up for this operation, see GetLastKernel. Kept
+  // across ClearInputs(), which runs after each execution, since
+  // `last_kernel_cache_key_` covers the op name, attributes and device.
+  // Dropped by Clear(), so that an operation that is reset or released does
+  // not keep the kernel alive.
+  core::RefCountPtr<KernelAndDevice> last_kernel_;
+  Fprint128 last_kernel_cache_key_ = {0, 0};
+  int64 last_kernel_cache_generation_ = -1;
+
   // Inference information
   const tensorflow::OpDef* op_def_;  // op definition from protobuf
   int inference_arg_idx_;  // arg definition index for the next input to be
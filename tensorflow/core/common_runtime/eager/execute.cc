@@ -877,7 +877,17 @@ Status GetOrCreateKernelAndDevice(
     }
   }
 
-  core::RefCountPtr<KernelAndDevice> kernel = ctx.GetCachedKernel(cache_key);
+  // Ops that are executed repeatedly usually hit the kernel they used last
+  // time, which saves the lookup in the context's kernel cache.
+  const int64 kernel_cache_generation = ctx.KernelCacheGeneration();
+  core::RefCountPtr<KernelAndDevice> kernel =
+      op->GetLastKernel(cache_key, kernel_cache_generation);
+  if (kernel == nullptr) {
+    kernel = ctx.GetCachedKernel(cache_key);
+    if (kernel != nullptr) {
+      op->SetLastKernel(cache_key, kernel_cache_generation, kernel.get());
+    }
+  }
   AbstractOperationPtr wrapped_op_releaser;
   if (kernel == nullptr) {
     if (ctx.RunEagerOpAsFunction() && !op->is_function()) {
@@ -1080,7 +1090,7 @@ Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
     // Release the inputs from the eager operation since the AsyncExecuteNode
     // would have taken ownership. This allows the inputs to be forwarded if
     // possible.
-    op->Clear();
+    op->ClearInputs();
     // For async mode, execution order will make sure that all
     // input handles are ready before executing them.
     // TODO(b/137118203): Consider executing "cheap" kernels inline for
@@ -1100,7 +1110,7 @@ Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
     // We release the inputs AFTER executing the operation in sync mode since
     // ExecuteNode does not increment the reference count and thus does not have
     // ownership of the inputs while executing.
-    op->Clear();
+    op->ClearInputs();
     return s;
   }
 }
@@ -1375,6 +1385,11 @@ Status EagerRemoteExecute(EagerOperation* op, TensorHandle** retvals,
   TF_RETURN_IF_ERROR(
       StoreResourceDtypesAndShapes(*remote_op, output_dtypes, retvals));
 
+  // Once the remote task knows the name, attrs and device of this kind of
+  // operation, only send its inputs.
+  ctx.RemoteMgr()->ApplyOpTemplate(
+      remote_task, op->MutableAttrs()->CacheKey(op_device->name()), remote_op);
+
   auto& executor = op->Executor();
   DVLOG(4) << "Execute remote eager op: " << op->Name()
            << " (is async?: " << executor.Async() << ").";
@@ -1845,7 +1860,7 @@ void EagerLocalExecuteAsync(EagerOperation* op, TensorHandle** retvals,
       &ctx, *inputs, op->remote_func_params(), std::move(kernel),
       graph_collector, op->GetCancellationManager(), retvals, num_outputs,
       [op, num_outputs, retvals, done = std::move(done)](const Status& s) {
-        op->Clear();
+        op->ClearInputs();
         // Since the operation failed, we need to Unref any outputs if they were
         // allocated.
         if (!s.ok()) {
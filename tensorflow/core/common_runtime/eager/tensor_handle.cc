@@ -46,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -62,6 +63,24 @@ string SafeDeviceDebugString(Device* device) {
     return device->DebugString();
   }
 }
+
+// Whether TensorHandle::CopyToDevice() may skip the Sync() of a source device
+// that copies through its default DeviceContext. Such contexts order the copy
+// after the kernels that produced the tensor, so the Sync() only adds a
+// host/device round trip per copy.
+bool SkipSourceSyncForDeviceContextCopies() {
+  static const bool skip = [] {
+    bool skip = false;
+    Status s = ReadBoolFromEnvVar("TF_EAGER_COPY_SKIP_SOURCE_DEVICE_SYNC",
+                                  false, &skip);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return false;
+    }
+    return skip;
+  }();
+  return skip;
+}
 }  // namespace
 
 TensorHandle::PackedTensorHandleData::PackedTensorHandleData(
@@ -1016,7 +1035,10 @@ Status TensorHandle::CopyToDevice(const EagerContext& ctx,
   // With that setup, Sync()ing across all 3 streams should be sufficient
   // but more than necessary (since it waits for operations that might have
   // nothing to do with this tensor to complete).
-  TF_RETURN_IF_ERROR(srcd->Sync());
+  if (src_device_context == nullptr ||
+      !SkipSourceSyncForDeviceContextCopies()) {
+    TF_RETURN_IF_ERROR(srcd->Sync());
+  }
   tensorflow::Notification n;
   tensorflow::Status status;
   tensorflow::CopyTensor::ViaDMA("copy", src_device_context, dst_device_context,
@@ -105,10 +105,13 @@ string LocalTensorHandleData::DebugString() const {
 void LocalTensorHandleData::BlockingControl::SetReady() {
   mutex_lock l(mu_);
   is_ready_ = true;
+  ready_.store(true, std::memory_order_release);
 }
 
 Status LocalTensorHandleData::BlockingControl::WaitReady(
     const char* caller) const {
+  if (IsReady()) return PoisonedStatusOfReadyHandle();
+
   tf_shared_lock l(mu_);
   if (!is_ready_) {
     profiler::TraceMe activity(
@@ -130,6 +133,7 @@ void LocalTensorHandleData::BlockingControl::Poison(Status status) {
   }
   is_poisoned_ = status;
   is_ready_ = true;
+  ready_.store(true, std::memory_order_release);
 }
 
 }  // namespace tensorflow
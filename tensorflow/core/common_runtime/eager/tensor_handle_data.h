@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_TENSOR_HANDLE_DATA_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_TENSOR_HANDLE_DATA_H_
 
+#include <atomic>
+
 #include "absl/types/variant.h"
 #include "tensorflow/core/common_runtime/eager/context.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -82,24 +84,32 @@ class LocalTensorHandleData {
     Status IsPoisoned() const { return Status::OK(); }
   };
 
+  // Once ready, a BlockingControl never changes again, so readiness is also
+  // published through an atomic and checking a ready handle takes no lock.
   class BlockingControl {
    public:
-    bool IsReady() const {
-      tf_shared_lock l(mu_);
-      return is_ready_;
-    }
+    bool IsReady() const { return ready_.load(std::memory_order_acquire); }
     void SetReady();
     Status WaitReady(const char* caller) const;
     void Poison(Status status);
     Status IsPoisoned() const {
+      if (IsReady()) return PoisonedStatusOfReadyHandle();
       tf_shared_lock l(mu_);
       return is_poisoned_;
     }
 
    private:
+    // `is_poisoned_` is only written before `ready_` is set.
+    const Status& PoisonedStatusOfReadyHandle() const
+        TF_NO_THREAD_SAFETY_ANALYSIS {
+      return is_poisoned_;
+    }
+
     mutable mutex mu_;
-    bool is_ready_ TF_GUARDED_BY(mu_);
+    bool is_ready_ TF_GUARDED_BY(mu_) = false;
     Status is_poisoned_ TF_GUARDED_BY(mu_);
+    // Mirrors `is_ready_`, set with release semantics under `mu_`.
+    std::atomic<bool> ready_{false};
   };
 
   absl::variant<NonBlockingControl, BlockingControl> ctrl_;
@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <algorithm>
 #include <atomic>
+#include <deque>
 #include <memory>
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
@@ -56,6 +59,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -134,9 +138,126 @@ struct KernelTimer {
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// Returns a small, stable integer identifying the calling thread. Used to map
+// inter-op worker threads onto per-thread ready deques.
+inline int CurrentThreadIndex() {
+  static std::atomic<int> next_thread_index{0};
+  static thread_local int thread_index =
+      next_thread_index.fetch_add(1, std::memory_order_relaxed);
+  return thread_index;
+}
+
+// A set of per-thread ready deques used when an executor runs in work-stealing
+// mode (executor type "WORK_STEALING").
+//
+// Each inter-op worker pushes the expensive nodes it makes ready onto its own
+// deque and pops them back in LIFO order, so that a consumer tends to run on
+// the core that just produced its inputs. A worker whose deque is empty steals
+// the oldest entry from one of its peers. Instead of one closure per node, at
+// most `max_workers` draining closures are outstanding in the inter-op
+// threadpool at any time.
+template <typename TaggedNode>
+class WorkStealingReadyQueues {
+ public:
+  struct Item {
+    TaggedNode node;
+    int64 scheduled_nsec;
+  };
+
+  WorkStealingReadyQueues(int num_queues, int max_workers)
+      : num_queues_(std::max(num_queues, 1)),
+        max_workers_(std::max(max_workers, 1)),
+        queues_(new Queue[num_queues_]) {}
+
+  // Returns the index of the deque owned by the calling thread.
+  int CurrentQueue() const { return CurrentThreadIndex() % num_queues_; }
+
+  void Push(int queue, const TaggedNode& node, int64 scheduled_nsec) {
+    Queue& q = queues_[queue];
+    {
+      mutex_lock l(q.mu);
+      q.items.push_back({node, scheduled_nsec});
+    }
+    num_items_.fetch_add(1);
+  }
+
+  // Pops the most recently pushed item of deque `queue`, or steals the oldest
+  // item of another deque if `queue` is empty. Returns nullopt if every deque
+  // is empty.
+  absl::optional<Item> Pop(int queue) {
+    if (num_items_.load() == 0) return absl::nullopt;
+    {
+      Queue& q = queues_[queue];
+      mutex_lock l(q.mu);
+      if (!q.items.empty()) {
+        Item item = q.items.back();
+        q.items.pop_back();
+        num_items_.fetch_sub(1);
+        return item;
+      }
+    }
+    for (int i = 1; i < num_queues_; ++i) {
+      Queue& victim = queues_[(queue + i) % num_queues_];
+      mutex_lock l(victim.mu);
+      if (!victim.items.empty()) {
+        Item item = victim.items.front();
+        victim.items.pop_front();
+        num_items_.fetch_sub(1);
+        return item;
+      }
+    }
+    return absl::nullopt;
+  }
+
+  // Registers a new draining worker. Returns false if `max_workers` workers
+  // are already active, in which case one of them will pick up the work.
+  bool TryAddWorker() {
+    int active = num_active_workers_.load();
+    while (active < max_workers_) {
+      if (num_active_workers_.compare_exchange_weak(active, active + 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Unregisters a draining worker that found every deque empty. Returns true
+  // if the worker must keep draining because an item was pushed concurrently
+  // and no other worker is available to run it.
+  bool RemoveWorker() {
+    num_active_workers_.fetch_sub(1);
+    return num_items_.load() > 0 && TryAddWorker();
+  }
+
+ private:
+  // Padded to avoid false sharing between the deques of different workers,
+  // assuming the cacheline size is 64 bytes or smaller.  The padding is
+  // explicit because operator new does not honor alignas() beyond the
+  // default alignment before C++17.
+  struct Queue {
+    mutex mu;
+    std::deque<Item> items TF_GUARDED_BY(mu);
+    char pad[64];
+  };
+
+  const int num_queues_;
+  const int max_workers_;
+  std::unique_ptr<Queue[]> queues_;
+  // Keeps the counters, which all workers update, on cache lines of their own.
+  char pad0_[64];
+  std::atomic<int64_t> num_items_{0};
+  char pad1_[64];
+  std::atomic<int> num_active_workers_{0};
+  char pad2_[64];
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WorkStealingReadyQueues);
+};
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool use_work_stealing = false)
+      : immutable_state_(p), use_work_stealing_(use_work_stealing) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
@@ -214,6 +335,9 @@ class ExecutorImpl : public Executor {
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  // If true, ready nodes are dispatched through per-thread ready deques. See
+  // `WorkStealingReadyQueues`.
+  const bool use_work_stealing_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
@@ -272,7 +396,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                bool use_work_stealing);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -283,6 +408,7 @@ class ExecutorState {
   typedef
       typename PropagatorStateType::TaggedNodeReadyQueue TaggedNodeReadyQueue;
   typedef typename PropagatorStateType::TaggedNodeSeq TaggedNodeSeq;
+  typedef WorkStealingReadyQueues<TaggedNode> ReadyQueues;
 
   struct AsyncState;
 
@@ -330,6 +456,17 @@ class ExecutorState {
   template <typename Closure>
   void RunTask(Closure&& c);
 
+  // Dispatches `tagged_node` to another thread, either as its own closure or,
+  // in work-stealing mode, through the calling thread's ready deque.
+  void DispatchReady(const TaggedNode& tagged_node, int64 scheduled_nsec);
+
+  // Body of a work-stealing worker closure: processes nodes from the ready
+  // deques until they are all empty.
+  //
+  // NOTE: `this` may be deleted as soon as the last node of the step is
+  // processed, so the loop only touches `queues` between nodes.
+  void RunWorkStealingLoop(std::shared_ptr<ReadyQueues> queues);
+
   // Clean up when this executor is done.
   void Finish();
   void ScheduleFinish();
@@ -372,6 +509,9 @@ class ExecutorState {
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
 
+  // Not null iff this executor runs in work-stealing mode.
+  std::shared_ptr<ReadyQueues> ready_queues_;
+
   PropagatorStateType propagator_;
 
   // Invoked when the execution finishes.
@@ -392,7 +532,7 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, bool use_work_stealing)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -423,6 +563,10 @@ ExecutorState<PropagatorStateType>::ExecutorState(
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (use_work_stealing && !run_all_kernels_inline_) {
+    const int num_queues = port::MaxParallelism();
+    ready_queues_ = std::make_shared<ReadyQueues>(num_queues, num_queues);
+  }
 }
 
 template <class PropagatorStateType>
@@ -457,6 +601,30 @@ void ExecutorState<PropagatorStateType>::RunTask(Closure&& c) {
   });
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::DispatchReady(
+    const TaggedNode& tagged_node, int64 scheduled_nsec) {
+  if (!ready_queues_) {
+    RunTask([=]() { Process(tagged_node, scheduled_nsec); });
+    return;
+  }
+  ready_queues_->Push(ready_queues_->CurrentQueue(), tagged_node,
+                      scheduled_nsec);
+  if (ready_queues_->TryAddWorker()) {
+    RunTask([this, queues = ready_queues_]() { RunWorkStealingLoop(queues); });
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunWorkStealingLoop(
+    std::shared_ptr<ReadyQueues> queues) {
+  do {
+    while (auto item = queues->Pop(queues->CurrentQueue())) {
+      Process(item->node, item->scheduled_nsec);
+    }
+  } while (queues->RemoveWorker());
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::RunAsync(Executor::DoneCallback done) {
   TaggedNodeSeq ready;
@@ -830,6 +998,24 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
         (first_input + i)->ClearVal();
       }
       propagator_.MaybeMarkCompleted(tagged_node);
+
+      if (s.ok() && item.chain_successor != nullptr &&
+          !tagged_node.get_is_dead() &&
+          !kernel_stats_->IsExpensive(*item.chain_successor)) {
+        // Run the only consumer of this node's output next, in place of this
+        // node. The output is moved to the consumer's input, so its buffer can
+        // be forwarded to the consumer's output.
+        if (stats) {
+          nodestats::SetAllEnd(stats);
+          stats->Done(device->name());
+          scheduled_nsec = nodestats::NowInNsec();
+        }
+        propagator_.ForwardToChainSuccessor(&tagged_node, &outputs[0]);
+        outputs[0].ClearVal();
+        inline_ready.push_front(tagged_node);
+        continue;
+      }
+
       // Propagates outputs.
       if (s.ok()) {
         propagator_.PropagateOutputs(tagged_node, &outputs, &ready);
@@ -1155,6 +1341,15 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     scheduled_nsec = nodestats::NowInNsec();
   }
 
+  if (immutable_state_.has_priorities() && ready->size() > 1) {
+    // Dispatch higher-priority nodes first.
+    std::stable_sort(ready->begin(), ready->end(),
+                     [](const TaggedNode& a, const TaggedNode& b) {
+                       return a.get_node_item().priority >
+                              b.get_node_item().priority;
+                     });
+  }
+
   if (run_all_kernels_inline_) {
     if (inline_ready == nullptr) {
       // Schedule all ready kernels from a single closure. This ensure that,
@@ -1176,24 +1371,34 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     if (inline_ready == nullptr) {
       // Schedule to run all the ready ops in thread pool.
       for (auto& tagged_node : *ready) {
-        RunTask([=]() { Process(tagged_node, scheduled_nsec); });
+        DispatchReady(tagged_node, scheduled_nsec);
       }
     } else {
+      const bool has_priorities = immutable_state_.has_priorities();
+      gtl::InlinedVector<const TaggedNode*, 8> prioritized;
       for (auto& tagged_node : *ready) {
         const NodeItem& item = *tagged_node.node_item;
         if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
           // Inline this inexpensive node.
-          inline_ready->push_back(tagged_node);
+          if (has_priorities && item.priority > 0) {
+            prioritized.push_back(&tagged_node);
+          } else {
+            inline_ready->push_back(tagged_node);
+          }
         } else {
           if (curr_expensive_node) {
             // Dispatch to another thread since there is plenty of work to
             // do for this thread.
-            RunTask(std::bind(&ExecutorState::Process, this,
-                              *curr_expensive_node, scheduled_nsec));
+            DispatchReady(*curr_expensive_node, scheduled_nsec);
           }
           curr_expensive_node = &tagged_node;
         }
       }
+      // Prioritized nodes go ahead of the nodes this thread has already
+      // queued. Push them in reverse to keep their relative order.
+      for (auto it = prioritized.rbegin(); it != prioritized.rend(); ++it) {
+        inline_ready->push_front(**it);
+      }
     }
     if (curr_expensive_node) {
       if (inline_ready->empty()) {
@@ -1201,8 +1406,7 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       } else {
         // There are inline nodes to run already. We dispatch this expensive
         // node to other thread.
-        RunTask(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                          scheduled_nsec));
+        DispatchReady(*curr_expensive_node, scheduled_nsec);
       }
     }
   }
@@ -1346,11 +1550,12 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
   if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        use_work_stealing_))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_, use_work_stealing_))
         ->RunAsync(std::move(done));
   }
 }
@@ -1404,6 +1609,26 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl = absl::make_unique<ExecutorImpl>(params,
+                                                  /*use_work_stealing=*/true);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return Status::OK();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
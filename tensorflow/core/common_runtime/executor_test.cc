@@ -25,7 +25,9 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
 #include "tensorflow/core/common_runtime/process_util.h"
@@ -66,8 +68,11 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor based on a graph 'gdef'. If
+  // 'executor_type' is not empty, the executor is created through the
+  // ExecutorFactory registered under that name.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
@@ -82,7 +87,13 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    if (executor_type.empty()) {
+      TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    } else {
+      std::unique_ptr<Executor> executor;
+      TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &executor));
+      exec_ = executor.release();
+    }
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -255,6 +266,21 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -430,6 +456,73 @@ TEST_F(ExecutorTest, NoInputTensors) {
   TF_ASSERT_OK(Run(rendez_));
 }
 
+TEST_F(ExecutorTest, HigherPriorityNodesRunFirst) {
+  // Three constants become ready at the same time. With all kernels run
+  // inline, they must execute in order of decreasing priority.
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  Node* low = test::graph::Constant(g.get(), V(1.0), "low");
+  Node* high = test::graph::Constant(g.get(), V(2.0), "high");
+  Node* medium = test::graph::Constant(g.get(), V(3.0), "medium");
+  low->AddAttr(kExecutorPriorityAttr, -1);
+  high->AddAttr(kExecutorPriorityAttr, 2);
+  medium->AddAttr(kExecutorPriorityAttr, 1);
+  Create(std::move(g));
+
+  Executor::Args args;
+  args.rendezvous = rendez_;
+  args.stats_collector = &step_stats_collector_;
+  args.runner = runner_;
+  args.run_all_kernels_inline = true;
+  TF_ASSERT_OK(exec_->Run(args));
+  step_stats_collector_.Finalize();
+
+  std::vector<string> order;
+  for (const auto& dev_stats : step_stats_.dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      if (node_stats.node_name() == "low" ||
+          node_stats.node_name() == "medium" ||
+          node_stats.node_name() == "high") {
+        order.push_back(node_stats.node_name());
+      }
+    }
+  }
+  EXPECT_EQ(order, std::vector<string>({"high", "medium", "low"}));
+}
+
+TEST_F(ExecutorTest, RunsChainOfInexpensiveNodes) {
+  // b <- a, through a chain of Identity nodes that is run without propagating
+  // the intermediate values.
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  Node* v = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  const int N = 4;
+  for (int i = 0; i < N; ++i) {
+    v = test::graph::Identity(g.get(), v);
+  }
+  test::graph::Send(g.get(), v, "b", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(2.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  step_stats_collector_.Finalize();
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(2.0, V(out));
+
+  // Each node of the chain still reports its own statistics.
+  int num_identity_nodes = 0;
+  for (const auto& dev_stats : step_stats_.dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      if (node_stats.timeline_label().find(" = Identity(") != string::npos) {
+        ++num_identity_nodes;
+      }
+    }
+  }
+  EXPECT_EQ(N, num_identity_nodes);
+}
+
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/function.h"
 
+#include <atomic>
 #include <deque>
 #include <vector>
 
@@ -51,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 // See core/kernels/function_ops.cc for related kernels.
 
@@ -954,43 +956,49 @@ bool IsOpSingleThreadedExecutorCompatible(const Node& n) {
   return true;
 }
 
-// Returns true if the given Graph is safe & efficient to run via the single
-// threaded executor. The single-threaded executor has lower dispatch overhead
-// for simple functions.
-//
-// This currently specializes for the case of a single operation, as created
-// via eager execution.
-bool IsSingleThreadedExecutorCompatible(const Graph* g) {
-  // TODO(b/187729969): Temporarily disabled due to b/187306798.
-  return false;
+// Whether CreateItem selects the single-threaded executor for small functions.
+// Initialized from TF_SINGLE_THREADED_EXECUTOR_FOR_SMALL_FUNCTIONS once.
+std::atomic<bool>& SingleThreadedExecutorForSmallFunctions() {
+  // TODO(b/187729969): Off by default due to b/187306798.
+  static std::atomic<bool>* enabled = [] {
+    bool enabled = false;
+    Status s = ReadBoolFromEnvVar(
+        "TF_SINGLE_THREADED_EXECUTOR_FOR_SMALL_FUNCTIONS", false, &enabled);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      enabled = false;
+    }
+    return new std::atomic<bool>(enabled);
+  }();
+  return *enabled;
+}
+
+}  // namespace
+
+void TestOnlySetSingleThreadedExecutorForSmallFunctions(bool enabled) {
+  SingleThreadedExecutorForSmallFunctions().store(enabled,
+                                                  std::memory_order_relaxed);
+}
+
+bool IsSingleThreadedExecutorCompatible(const Graph* g, const Device* device) {
+  if (device->device_type() != DEVICE_CPU) {
+    return false;
+  }
 
-  // Not worth analyzing large graphs.
+  // Not worth analyzing large graphs, which also benefit from running
+  // independent nodes in parallel.
   if (g->num_nodes() > kMaxNodesForSingleThreadedExecutor) {
     return false;
   }
 
-  int count = 0;
   for (Node* n : g->nodes()) {
     if (!IsOpSingleThreadedExecutorCompatible(*n)) {
       return false;
     }
-    if (n->op_def().name() == "_Arg" || n->op_def().name() == "_Retval" ||
-        n->op_def().name() == "NoOp") {
-      continue;
-    }
-
-    count += 1;
   }
-
-  if (count == 1) {
-    return true;
-  }
-
-  return false;
+  return true;
 }
 
-}  // namespace
-
 Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
   const FunctionBody* fbody;
   FunctionLibraryRuntime* flr;
@@ -1033,10 +1041,22 @@ Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
   params.session_metadata = session_metadata_;
   std::unique_ptr<Executor> exec;
 
-  if (executor_type.empty() && IsSingleThreadedExecutorCompatible(g.get())) {
-    executor_type = "SINGLE_THREADED_EXECUTOR";
+  if (executor_type.empty() &&
+      SingleThreadedExecutorForSmallFunctions().load(
+          std::memory_order_relaxed) &&
+      IsSingleThreadedExecutorCompatible(g.get(), device())) {
+    // The single-threaded executor rejects some graphs only once it creates
+    // their kernels; use the default executor for those.
+    Status s = NewExecutor("SINGLE_THREADED_EXECUTOR", params, *g, &exec);
+    if (!s.ok()) {
+      VLOG(1) << "Using the default executor for a function on "
+              << device()->name() << ": " << s;
+      exec.reset();
+    }
+  }
+  if (exec == nullptr) {
+    TF_RETURN_IF_ERROR(NewExecutor(executor_type, params, *g, &exec));
   }
-  TF_RETURN_IF_ERROR(NewExecutor(executor_type, params, *g, &exec));
   {
     // Guard item since it is already inserted in items_.
     mutex_lock l(mu_);
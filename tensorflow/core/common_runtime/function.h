@@ -64,6 +64,23 @@ std::unique_ptr<FunctionLibraryRuntime> NewFunctionLibraryRuntime(
     const SessionMetadata* session_metadata,
     ProcessFunctionLibraryRuntime* parent);
 
+// Returns true if the graph "g" of a function is safe & efficient to run via
+// the single-threaded executor on "device". The single-threaded executor has
+// lower dispatch overhead for simple functions.
+//
+// This selects small straight-line functions on CPU, e.g. single operations
+// created via eager execution or tf.data map functions. Functional control
+// flow is not lowered here, so functions with If/While keep the default
+// executor.
+//
+// Functions instantiated without an explicit executor type use it when this
+// returns true and TF_SINGLE_THREADED_EXECUTOR_FOR_SMALL_FUNCTIONS is set.
+bool IsSingleThreadedExecutorCompatible(const Graph* g, const Device* device);
+
+// Overrides TF_SINGLE_THREADED_EXECUTOR_FOR_SMALL_FUNCTIONS, which is read
+// once per process, for functions instantiated after the call.
+void TestOnlySetSingleThreadedExecutorForSmallFunctions(bool enabled);
+
 // Given a numerical function "f", returns another numerical function
 // "g", such that if "f" takes N inputs and produces M outputs, "g"
 // takes N + M inputs and produces N outputs. I.e., if
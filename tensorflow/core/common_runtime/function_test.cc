@@ -369,6 +369,122 @@ TEST_F(FunctionLibraryRuntimeTest, XTimesTwo) {
   test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
 }
 
+// Returns the type of the executor that runs it.
+class ExecutorTypeOp : public OpKernel {
+ public:
+  using OpKernel::OpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, {}, &output));
+    output->scalar<tstring>()() = ctx->executor_type();
+  }
+};
+
+REGISTER_OP("ExecutorType").Input("x: float").Output("executor_type: string");
+REGISTER_KERNEL_BUILDER(Name("ExecutorType").Device(DEVICE_CPU),
+                        ExecutorTypeOp);
+
+TEST_F(FunctionLibraryRuntimeTest, XTimesTwo_SingleThreadedExecutor) {
+  auto straight_line =
+      FDH::Create("StraightLine", {"x: float"}, {"ret: string"}, {},
+                  {{{"y"}, "ExecutorType", {"x"}, {}}},
+                  {{"ret", "y:executor_type:0"}});
+  auto control_flow = FDH::Create(
+      "ControlFlow", {"x: float", "p: bool"}, {"ret: string"}, {},
+      {{{"s"}, "Switch", {"x", "p"}, {{"T", DT_FLOAT}}},
+       {{"y"}, "ExecutorType", {"s:output_true:0"}, {}}},
+      {{"ret", "y:executor_type:0"}});
+  // XTimes16 calls other functions: unless they are inlined, it keeps the
+  // default executor.
+  Init({straight_line, control_flow, test::function::XTimesTwo(),
+        test::function::XTimesFour(), test::function::XTimes16()});
+  TestOnlySetSingleThreadedExecutorForSmallFunctions(true);
+
+  auto x = test::AsScalar<float>(1);
+  Tensor executor_type;
+  TF_CHECK_OK(
+      InstantiateAndRun(flr0_, "StraightLine", {}, {x}, {&executor_type}));
+  EXPECT_EQ(executor_type.scalar<tstring>()(), "SINGLE_THREADED_EXECUTOR");
+  TF_CHECK_OK(InstantiateAndRun(flr0_, "ControlFlow", {},
+                                {x, test::AsScalar<bool>(true)},
+                                {&executor_type}));
+  EXPECT_EQ(executor_type.scalar<tstring>()(), "");
+
+  auto v = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor y;
+  TF_CHECK_OK(
+      InstantiateAndRun(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, {v}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+  TF_CHECK_OK(
+      InstantiateAndRun(flr0_, "XTimes16", {{"T", DT_FLOAT}}, {v}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({16, 32, 48, 64}));
+
+  TestOnlySetSingleThreadedExecutorForSmallFunctions(false);
+  TF_CHECK_OK(
+      InstantiateAndRun(flr0_, "StraightLine", {}, {x}, {&executor_type}));
+  EXPECT_EQ(executor_type.scalar<tstring>()(), "");
+}
+
+class FakeDevice : public Device {
+ public:
+  explicit FakeDevice(const string& type) : Device(nullptr, Attributes(type)) {}
+
+  Status Sync() override { return Status::OK(); }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override { return nullptr; }
+
+ private:
+  static DeviceAttributes Attributes(const string& type) {
+    DeviceAttributes attributes;
+    attributes.set_name(
+        strings::StrCat("/job:localhost/replica:0/task:0/device:", type, ":0"));
+    attributes.set_device_type(type);
+    return attributes;
+  }
+};
+
+TEST(SingleThreadedExecutorCompatibilityTest, SmallCpuFunctions) {
+  Scope s = Scope::NewRootScope();
+  auto x = ops::_Arg(s.WithOpName("x"), DT_FLOAT, 0);
+  auto y = ops::Mul(s.WithOpName("y"), x, x);
+  auto ret = ops::_Retval(s.WithOpName("ret"), y, 0);
+  Graph g(OpRegistry::Global());
+  TF_ASSERT_OK(s.ToGraph(&g));
+
+  FakeDevice cpu(DEVICE_CPU);
+  FakeDevice gpu(DEVICE_GPU);
+  EXPECT_TRUE(IsSingleThreadedExecutorCompatible(&g, &cpu));
+  EXPECT_FALSE(IsSingleThreadedExecutorCompatible(&g, &gpu));
+}
+
+TEST(SingleThreadedExecutorCompatibilityTest, ControlFlow) {
+  Scope s = Scope::NewRootScope();
+  auto x = ops::_Arg(s.WithOpName("x"), DT_FLOAT, 0);
+  auto p = ops::_Arg(s.WithOpName("p"), DT_BOOL, 1);
+  auto sw = ops::Switch(s.WithOpName("switch"), x, p);
+  auto ret = ops::_Retval(s.WithOpName("ret"), sw.output_true, 0);
+  Graph g(OpRegistry::Global());
+  TF_ASSERT_OK(s.ToGraph(&g));
+
+  FakeDevice cpu(DEVICE_CPU);
+  EXPECT_FALSE(IsSingleThreadedExecutorCompatible(&g, &cpu));
+}
+
+TEST(SingleThreadedExecutorCompatibilityTest, LargeFunctions) {
+  Scope s = Scope::NewRootScope();
+  Output y = ops::_Arg(s.WithOpName("x"), DT_FLOAT, 0);
+  for (int i = 0; i < 32; ++i) {
+    y = ops::Mul(s.WithOpName(strings::StrCat("y", i)), y, y);
+  }
+  auto ret = ops::_Retval(s.WithOpName("ret"), y, 0);
+  Graph g(OpRegistry::Global());
+  TF_ASSERT_OK(s.ToGraph(&g));
+
+  FakeDevice cpu(DEVICE_CPU);
+  EXPECT_FALSE(IsSingleThreadedExecutorCompatible(&g, &cpu));
+}
+
 TEST_F(FunctionLibraryRuntimeTest, InstantiationStackTraceCopying) {
   class DummyStackTrace : public AbstractStackTrace {
     absl::Span<StackFrame const> ToFrames() const override { return {}; }
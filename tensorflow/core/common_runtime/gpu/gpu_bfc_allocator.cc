@@ -88,6 +88,8 @@ GPUBFCAllocator::GPUBFCAllocator(SubAllocator* sub_allocator,
                    GPUBFCAllocator::GetAllowGrowthValue(gpu_options), name,
                    GPUBFCAllocator::GetGarbageCollectionValue()) {
   SetInternalFragmentationFraction(fragmentation_fraction);
+  EnableSmallChunkCache(
+      gpu_options.experimental().small_allocation_cache_stripes());
 }
 
 }  // namespace tensorflow
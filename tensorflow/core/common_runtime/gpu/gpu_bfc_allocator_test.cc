@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/framework/typed_allocator.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/strcat.h"
@@ -321,6 +322,132 @@ TEST_P(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   }
 }
 
+TEST_P(GPUBFCAllocatorTest, SmallChunkCache) {
+  GPUOptions options;
+  options.mutable_experimental()->set_small_allocation_cache_stripes(4);
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, options, "GPU_0_bfc");
+
+  // The first allocation of each size misses the cache.
+  void* small = a.AllocateRaw(1, 1000);
+  void* large = a.AllocateRaw(1, 1 << 20);
+  EXPECT_EQ(1000, a.RequestedSize(small));
+  a.DeallocateRaw(small);
+  a.DeallocateRaw(large);
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->cache_hits);
+  EXPECT_EQ(1, stats->cache_misses);
+  EXPECT_EQ(0, stats->bytes_in_use);
+
+  // A request of the same rounded size is served from the cache, and the
+  // requested size reflects the new request.
+  void* reused = a.AllocateRaw(1, 900);
+  EXPECT_EQ(small, reused);
+  EXPECT_EQ(900, a.RequestedSize(reused));
+  stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(1, stats->cache_hits);
+  EXPECT_EQ(1024, stats->bytes_in_use);
+  a.DeallocateRaw(reused);
+
+  // Flushing returns the parked chunk to the bins.
+  EXPECT_TRUE(a.FlushSmallChunkCache());
+  EXPECT_FALSE(a.FlushSmallChunkCache());
+  void* fresh = a.AllocateRaw(1, 900);
+  stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(1, stats->cache_hits);
+  EXPECT_EQ(2, stats->cache_misses);
+  a.DeallocateRaw(fresh);
+}
+
+TEST_P(GPUBFCAllocatorTest, SmallChunkCacheIsFlushedBeforeGrowing) {
+  GPUOptions options;
+  options.set_allow_growth(true);
+  options.mutable_experimental()->set_small_allocation_cache_stripes(4);
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, options, "GPU_0_bfc");
+
+  // Fill the first region with small chunks and one chunk for the rest.
+  std::vector<void*> small;
+  for (int i = 0; i < 64; ++i) {
+    small.push_back(a.AllocateRaw(1, 4096));
+  }
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  const int64 heap_bytes = stats->heap_bytes;
+  void* rest = a.AllocateRaw(1, heap_bytes - stats->bytes_in_use);
+  ASSERT_NE(rest, nullptr);
+  EXPECT_EQ(heap_bytes, a.GetStats()->heap_bytes);
+
+  // The freed small chunks are parked in the cache.
+  for (void* ptr : small) {
+    a.DeallocateRaw(ptr);
+  }
+  stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(heap_bytes - 64 * 4096, stats->bytes_in_use);
+  EXPECT_EQ(0, stats->largest_free_block_bytes);
+
+  // A larger request is served from the flushed chunks instead of a new
+  // region, and the cache holds nothing afterwards.
+  void* large = a.AllocateRaw(1, 64 * 4096);
+  ASSERT_NE(large, nullptr);
+  stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(heap_bytes, stats->heap_bytes);
+  EXPECT_EQ(heap_bytes, stats->bytes_in_use);
+  EXPECT_FALSE(a.FlushSmallChunkCache());
+
+  a.DeallocateRaw(large);
+  a.DeallocateRaw(rest);
+}
+
+// Returns the value of the int64 gauge `metric_name` for `allocator` and, if
+// not empty, `bin`, or -1 if the gauge has no such cell.
+int64 GetBfcAllocatorGauge(const string& metric_name, const string& allocator,
+                           const string& bin = "") {
+  std::unique_ptr<monitoring::CollectedMetrics> collected =
+      monitoring::CollectionRegistry::Default()->CollectMetrics({});
+  auto it = collected->point_set_map.find(metric_name);
+  if (it == collected->point_set_map.end()) return -1;
+  for (const auto& point : it->second->points) {
+    bool matches = true;
+    for (const monitoring::Point::Label& label : point->labels) {
+      if (label.name == "allocator") matches &= label.value == allocator;
+      if (label.name == "bin") matches &= label.value == bin;
+    }
+    if (matches) return point->int64_value;
+  }
+  return -1;
+}
+
+TEST_P(GPUBFCAllocatorTest, ExportsFragmentationMetrics) {
+  setenv("TF_BFC_ALLOCATOR_METRICS_INTERVAL_MS", "1", 1);
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc_metrics");
+  unsetenv("TF_BFC_ALLOCATOR_METRICS_INTERVAL_MS");
+
+  // Leave a 1MiB hole between two allocations, and free it.
+  void* first = a.AllocateRaw(1, 1 << 20);
+  void* hole = a.AllocateRaw(1, 1 << 20);
+  void* last = a.AllocateRaw(1, 1 << 20);
+  a.DeallocateRaw(hole);
+
+  EXPECT_EQ(1, GetBfcAllocatorGauge("/tensorflow/core/bfc_allocator/regions",
+                                    "GPU_0_bfc_metrics"));
+  EXPECT_EQ(1,
+            GetBfcAllocatorGauge("/tensorflow/core/bfc_allocator/free_chunks",
+                                 "GPU_0_bfc_metrics", "1048576"));
+  EXPECT_EQ(1 << 20,
+            GetBfcAllocatorGauge("/tensorflow/core/bfc_allocator/free_bytes",
+                                 "GPU_0_bfc_metrics", "1048576"));
+  EXPECT_GE(GetBfcAllocatorGauge(
+                "/tensorflow/core/bfc_allocator/largest_free_chunk_bytes",
+                "GPU_0_bfc_metrics"),
+            1 << 20);
+  a.DeallocateRaw(first);
+  a.DeallocateRaw(last);
+}
+
 TEST_P(GPUBFCAllocatorTest, DISABLED_AllocatorReceivesZeroMemory) {
   GPUBFCAllocator a(GetParam()(1ul << 62), 1UL << 60, "GPU_0_bfc");
   GPUBFCAllocator b(GetParam()(1ul << 62), 1UL << 60, "GPU_0_bfc");
@@ -624,6 +751,43 @@ TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
   void* big_alloc = a.AllocateRaw(1, k512MiB - size);
   EXPECT_NE(big_alloc, nullptr);
 }
+
+TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
+       VirtualAllocatorRemapsFragmentedMemory) {
+  GPUOptions options;
+  options.set_allow_growth(true);
+
+  constexpr size_t k512MiB = 512ull << 20;
+
+  // 512 MiB allocator.
+  GPUBFCAllocator a(CreateVirtualMemorySubAllocator(1ull << 32), k512MiB,
+                    options, "GPU_0_bfc");
+  // Allocate 128 raw pointers of 4 megs, then free every other one so that
+  // half of the memory is free but no free chunk is larger than 4 megs.
+  const size_t size = 1LL << 22;
+  std::vector<void*> initial_ptrs;
+  for (size_t s = 0; s < 128; s++) {
+    void* raw = a.AllocateRaw(1, size);
+    initial_ptrs.push_back(raw);
+  }
+  for (int i = 0; i < 128; i += 2) {
+    a.DeallocateRaw(initial_ptrs[i]);
+  }
+  // The physical memory behind the free chunks is mapped again at the end of
+  // the address range.
+  void* big_alloc = a.AllocateRaw(1, k512MiB / 4);
+  EXPECT_NE(big_alloc, nullptr);
+  a.DeallocateRaw(big_alloc);
+
+  // Restoring the memory behind the released chunks would exceed the limit,
+  // so the remapped memory is used instead.
+  void* small_alloc = a.AllocateRaw(1, size);
+  EXPECT_NE(small_alloc, nullptr);
+  a.DeallocateRaw(small_alloc);
+  for (int i = 1; i < 128; i += 2) {
+    a.DeallocateRaw(initial_ptrs[i]);
+  }
+}
 #endif
 
 TEST_F(GPUBFCAllocatorTest_SubAllocatorSpecific,
@@ -0,0 +1,178 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_copy_batcher.h"
+
+#include <cstring>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/device/device_event_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// Keeps every copy in the staging buffer aligned for any element type.
+constexpr int64 kStagingAlignment = 16;
+
+int64 AlignStagingOffset(int64 offset) {
+  return (offset + kStagingAlignment - 1) / kStagingAlignment *
+         kStagingAlignment;
+}
+
+}  // namespace
+
+constexpr int64 GpuCopyBatcher::kMaxBatchedCopyBytes;
+
+// static
+bool GpuCopyBatcher::ShouldBatch(const Tensor& tensor) {
+  static const bool enabled = [] {
+    bool enabled = false;
+    Status status = ReadBoolFromEnvVar("TF_GPU_BATCH_SMALL_COPIES",
+                                       /*default_val=*/false, &enabled);
+    if (!status.ok()) {
+      LOG(ERROR) << "Not batching small GPU copies: " << status;
+      return false;
+    }
+    return enabled;
+  }();
+  const int64 num_bytes = tensor.TotalBytes();
+  return enabled && num_bytes > 0 && num_bytes <= kMaxBatchedCopyBytes;
+}
+
+void GpuCopyBatcher::CopyHostToDevice(const Tensor& cpu_tensor,
+                                      Tensor* gpu_tensor,
+                                      se::Stream* copy_stream,
+                                      se::Stream* compute_stream,
+                                      bool sync_dst_compute,
+                                      EventMgr* event_mgr,
+                                      StatusCallback done) {
+  Enqueue(&host_to_device_,
+          {TensorReference(cpu_tensor), DMAHelper::base(&cpu_tensor),
+           DMAHelper::base(gpu_tensor), cpu_tensor.TotalBytes(),
+           sync_dst_compute, std::move(done)},
+          copy_stream, compute_stream, event_mgr);
+}
+
+void GpuCopyBatcher::CopyDeviceToHost(const Tensor& gpu_tensor,
+                                      Tensor* cpu_tensor,
+                                      se::Stream* copy_stream,
+                                      se::Stream* compute_stream,
+                                      EventMgr* event_mgr,
+                                      StatusCallback done) {
+  Enqueue(&device_to_host_,
+          {TensorReference(gpu_tensor), DMAHelper::base(&gpu_tensor),
+           DMAHelper::base(cpu_tensor), gpu_tensor.TotalBytes(),
+           /*wait_for_compute=*/true, std::move(done)},
+          copy_stream, compute_stream, event_mgr);
+}
+
+void GpuCopyBatcher::Enqueue(Queue* queue, Copy copy, se::Stream* copy_stream,
+                             se::Stream* compute_stream, EventMgr* event_mgr) {
+  std::vector<Copy> batch;
+  {
+    mutex_lock l(queue->mu);
+    queue->pending.push_back(std::move(copy));
+    if (queue->in_flight) return;
+    queue->in_flight = true;
+    // Only read by Issue() while a batch is in flight.
+    queue->copy_stream = copy_stream;
+    queue->compute_stream = compute_stream;
+    queue->event_mgr = event_mgr;
+    batch.swap(queue->pending);
+  }
+  Issue(queue, std::move(batch));
+}
+
+void GpuCopyBatcher::Issue(Queue* queue, std::vector<Copy> batch) {
+  se::Stream* copy_stream = queue->copy_stream;
+  std::vector<int64> offsets;
+  offsets.reserve(batch.size());
+  int64 staging_bytes = 0;
+  bool wait_for_compute = false;
+  for (const Copy& copy : batch) {
+    offsets.push_back(staging_bytes);
+    staging_bytes = AlignStagingOffset(staging_bytes + copy.num_bytes);
+    wait_for_compute |= copy.wait_for_compute;
+  }
+  Allocator* host_allocator =
+      staging_allocator_ != nullptr
+          ? staging_allocator_
+          : GPUProcessState::singleton()->GetGpuHostAllocator(0);
+  char* staging = static_cast<char*>(
+      host_allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                  staging_bytes));
+  if (staging == nullptr) {
+    for (const Copy& copy : batch) copy.src_ref.Unref();
+    Finish(queue, batch,
+           errors::ResourceExhausted("Failed to allocate ", staging_bytes,
+                                     " bytes of pinned host memory to copy ",
+                                     batch.size(), " tensors"));
+    return;
+  }
+  if (wait_for_compute) copy_stream->ThenWaitFor(queue->compute_stream);
+  for (int i = 0, end = batch.size(); i < end; ++i) {
+    const Copy& copy = batch[i];
+    char* slot = staging + offsets[i];
+    if (queue->host_to_device) {
+      std::memcpy(slot, copy.src, copy.num_bytes);
+      se::DeviceMemoryBase gpu_dst(copy.dst, copy.num_bytes);
+      copy_stream->ThenMemcpy(&gpu_dst, slot, copy.num_bytes);
+    } else {
+      se::DeviceMemoryBase gpu_src(const_cast<void*>(copy.src),
+                                   copy.num_bytes);
+      copy_stream->ThenMemcpy(slot, gpu_src, copy.num_bytes);
+    }
+  }
+
+  queue->event_mgr->ThenExecute(
+      copy_stream, [this, queue, copy_stream, host_allocator, staging,
+                    batch = std::move(batch), offsets = std::move(offsets)]() {
+        if (!copy_stream->ok()) {
+          LOG(FATAL) << (queue->host_to_device ? "CPU->GPU" : "GPU->CPU")
+                     << " Memcpy failed";
+        }
+        for (int i = 0, end = batch.size(); i < end; ++i) {
+          const Copy& copy = batch[i];
+          if (!queue->host_to_device) {
+            std::memcpy(copy.dst, staging + offsets[i], copy.num_bytes);
+          }
+          copy.src_ref.Unref();
+        }
+        host_allocator->DeallocateRaw(staging);
+        Finish(queue, batch, Status::OK());
+      });
+}
+
+void GpuCopyBatcher::Finish(Queue* queue, const std::vector<Copy>& batch,
+                            const Status& status) {
+  // Issue the copies that arrived meanwhile before running the done
+  // callbacks, which may take a while.
+  std::vector<Copy> next;
+  {
+    mutex_lock l(queue->mu);
+    next.swap(queue->pending);
+    queue->in_flight = !next.empty();
+  }
+  if (!next.empty()) Issue(queue, std::move(next));
+  for (const Copy& copy : batch) copy.done(status);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,124 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_COPY_BATCHER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_COPY_BATCHER_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_reference.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace stream_executor {
+class Stream;
+}  // namespace stream_executor
+
+namespace tensorflow {
+
+class EventMgr;
+
+// Batches the copies of small tensors, e.g. shapes, loop counters and other
+// scalars, between the host and a GPU.
+//
+// A copy is issued right away when no batch of the same direction is in
+// flight. Otherwise it waits for the batch in flight to complete and is
+// issued with all other copies that arrived meanwhile: the batch goes
+// through one pinned host staging buffer, waits once for the compute stream
+// and completes with a single event, rather than each copy doing so. Going
+// through pinned memory also keeps copies to and from pageable host tensors
+// asynchronous.
+//
+// Because a copy may wait for the completion of the batch in flight, which
+// is a host round trip, rather than being enqueued on the stream right away,
+// batching is opt-in.
+class GpuCopyBatcher {
+ public:
+  // Stages the copies in pinned host memory.
+  GpuCopyBatcher() = default;
+  // Stages the copies in memory from `staging_allocator`, which must be
+  // usable for asynchronous copies. Does not take ownership.
+  explicit GpuCopyBatcher(Allocator* staging_allocator)
+      : staging_allocator_(staging_allocator) {}
+
+  // Copies of at most this many bytes are batched.
+  static constexpr int64 kMaxBatchedCopyBytes = 4096;
+
+  // Whether the copy of `tensor` should be batched, which is the case for
+  // small tensors when the TF_GPU_BATCH_SMALL_COPIES environment variable is
+  // set to true.
+  static bool ShouldBatch(const Tensor& tensor);
+
+  // Copies `cpu_tensor` into `gpu_tensor` on `copy_stream`, first waiting
+  // for `compute_stream` if `sync_dst_compute`, and calls `done` once the
+  // copy completed. The streams and `event_mgr` must be the same for all
+  // calls.
+  void CopyHostToDevice(const Tensor& cpu_tensor, Tensor* gpu_tensor,
+                        se::Stream* copy_stream, se::Stream* compute_stream,
+                        bool sync_dst_compute, EventMgr* event_mgr,
+                        StatusCallback done);
+
+  // Copies `gpu_tensor` into `cpu_tensor` on `copy_stream` after the work
+  // enqueued on `compute_stream`, and calls `done` once the copy completed.
+  // The streams and `event_mgr` must be the same for all calls.
+  void CopyDeviceToHost(const Tensor& gpu_tensor, Tensor* cpu_tensor,
+                        se::Stream* copy_stream, se::Stream* compute_stream,
+                        EventMgr* event_mgr, StatusCallback done);
+
+ private:
+  struct Copy {
+    // Keeps the source alive until it has been copied.
+    TensorReference src_ref;
+    const void* src;
+    void* dst;
+    int64 num_bytes;
+    // Whether the copy waits for the work enqueued on the compute stream.
+    bool wait_for_compute;
+    StatusCallback done;
+  };
+
+  // The copies of one direction.
+  struct Queue {
+    explicit Queue(bool host_to_device) : host_to_device(host_to_device) {}
+
+    const bool host_to_device;
+    se::Stream* copy_stream = nullptr;
+    se::Stream* compute_stream = nullptr;
+    EventMgr* event_mgr = nullptr;
+    mutex mu;
+    bool in_flight TF_GUARDED_BY(mu) = false;
+    std::vector<Copy> pending TF_GUARDED_BY(mu);
+  };
+
+  void Enqueue(Queue* queue, Copy copy, se::Stream* copy_stream,
+               se::Stream* compute_stream, EventMgr* event_mgr);
+  // Issues `batch`, and the copies enqueued meanwhile once it completed.
+  void Issue(Queue* queue, std::vector<Copy> batch);
+  // Issues the copies enqueued while `batch` was in flight, then calls the
+  // done callbacks of `batch` with `status`.
+  void Finish(Queue* queue, const std::vector<Copy>& batch,
+              const Status& status);
+
+  Allocator* const staging_allocator_ = nullptr;
+  Queue host_to_device_{/*host_to_device=*/true};
+  Queue device_to_host_{/*host_to_device=*/false};
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_COPY_BATCHER_H_
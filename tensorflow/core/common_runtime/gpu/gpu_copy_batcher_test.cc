@@ -0,0 +1,200 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include "tensorflow/core/common_runtime/gpu/gpu_copy_batcher.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device/device_event_mgr.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_device.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu_device_context.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+// Fails every allocation.
+class FailingAllocator : public Allocator {
+ public:
+  string Name() override { return "failing"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return nullptr;
+  }
+  void DeallocateRaw(void* ptr) override {}
+};
+
+class GpuCopyBatcherTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SessionOptions options;
+    (*options.config.mutable_device_count())["GPU"] = 1;
+    std::vector<std::unique_ptr<Device>> devices;
+    TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+        options, "/job:localhost/replica:0/task:0", &devices));
+    ASSERT_FALSE(devices.empty());
+    device_ = std::move(devices[0]);
+    const DeviceBase::GpuDeviceInfo* info =
+        device_->tensorflow_gpu_device_info();
+    context_ = static_cast<GPUDeviceContext*>(info->default_context);
+    event_mgr_ = info->event_mgr;
+  }
+
+  void TearDown() override {
+    device_.reset();
+    BaseGPUDevice::TestOnlyReset();
+    GPUProcessState::singleton()->TestOnlyReset();
+  }
+
+  Tensor GpuTensor(int num_elements) {
+    return Tensor(device_->GetAllocator(AllocatorAttributes()), DT_FLOAT,
+                  TensorShape({num_elements}));
+  }
+
+  // Copies every tensor of `cpu_tensors` into the matching one of
+  // `gpu_tensors` and waits for all copies.
+  void CopyToDevice(GpuCopyBatcher* batcher,
+                    const std::vector<Tensor>& cpu_tensors,
+                    std::vector<Tensor>* gpu_tensors) {
+    BlockingCounter counter(cpu_tensors.size());
+    for (int i = 0; i < cpu_tensors.size(); ++i) {
+      batcher->CopyHostToDevice(
+          cpu_tensors[i], &(*gpu_tensors)[i], context_->host_to_device_stream(),
+          context_->stream(), /*sync_dst_compute=*/true, event_mgr_,
+          [&counter](const Status& s) {
+            TF_EXPECT_OK(s);
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+  }
+
+  void CopyToHost(GpuCopyBatcher* batcher,
+                  const std::vector<Tensor>& gpu_tensors,
+                  std::vector<Tensor>* cpu_tensors) {
+    BlockingCounter counter(gpu_tensors.size());
+    for (int i = 0; i < gpu_tensors.size(); ++i) {
+      batcher->CopyDeviceToHost(
+          gpu_tensors[i], &(*cpu_tensors)[i], context_->device_to_host_stream(),
+          context_->stream(), event_mgr_, [&counter](const Status& s) {
+            TF_EXPECT_OK(s);
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+  }
+
+  std::unique_ptr<Device> device_;
+  GPUDeviceContext* context_ = nullptr;
+  EventMgr* event_mgr_ = nullptr;
+};
+
+TEST_F(GpuCopyBatcherTest, RoundTrip) {
+  GpuCopyBatcher batcher;
+  std::vector<Tensor> inputs;
+  std::vector<Tensor> gpu_tensors;
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < 3; ++i) {
+    inputs.push_back(test::AsTensor<float>({1.0f * i, 2.0f * i, 3.0f}));
+    gpu_tensors.push_back(GpuTensor(3));
+    outputs.emplace_back(DT_FLOAT, TensorShape({3}));
+  }
+  CopyToDevice(&batcher, inputs, &gpu_tensors);
+  CopyToHost(&batcher, gpu_tensors, &outputs);
+  for (int i = 0; i < 3; ++i) {
+    test::ExpectTensorEqual<float>(inputs[i], outputs[i]);
+  }
+}
+
+TEST_F(GpuCopyBatcherTest, CopiesEnqueuedWhileInFlight) {
+  GpuCopyBatcher batcher;
+  constexpr int kNumCopies = 32;
+  std::vector<Tensor> inputs;
+  std::vector<Tensor> gpu_tensors;
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < kNumCopies; ++i) {
+    inputs.push_back(test::AsTensor<float>({1.0f * i}));
+    gpu_tensors.push_back(GpuTensor(1));
+    outputs.emplace_back(DT_FLOAT, TensorShape({1}));
+  }
+
+  // Blocks the copy stream so that the first copy stays in flight while the
+  // others are enqueued.
+  Notification unblock;
+  context_->host_to_device_stream()->ThenDoHostCallback(
+      [&unblock]() { unblock.WaitForNotification(); });
+  BlockingCounter counter(kNumCopies);
+  for (int i = 0; i < kNumCopies; ++i) {
+    batcher.CopyHostToDevice(
+        inputs[i], &gpu_tensors[i], context_->host_to_device_stream(),
+        context_->stream(), /*sync_dst_compute=*/false, event_mgr_,
+        [&counter](const Status& s) {
+          TF_EXPECT_OK(s);
+          counter.DecrementCount();
+        });
+  }
+  unblock.Notify();
+  counter.Wait();
+
+  CopyToHost(&batcher, gpu_tensors, &outputs);
+  for (int i = 0; i < kNumCopies; ++i) {
+    test::ExpectTensorEqual<float>(inputs[i], outputs[i]);
+  }
+}
+
+TEST_F(GpuCopyBatcherTest, StagingAllocationFailure) {
+  FailingAllocator allocator;
+  GpuCopyBatcher batcher(&allocator);
+  Tensor input = test::AsTensor<float>({1.0f, 2.0f});
+  Tensor gpu_tensor = GpuTensor(2);
+  Notification done;
+  Status status;
+  batcher.CopyHostToDevice(input, &gpu_tensor,
+                           context_->host_to_device_stream(),
+                           context_->stream(), /*sync_dst_compute=*/true,
+                           event_mgr_, [&](const Status& s) {
+                             status = s;
+                             done.Notify();
+                           });
+  done.WaitForNotification();
+  EXPECT_EQ(status.code(), error::RESOURCE_EXHAUSTED);
+
+  // The batcher is usable again after the failure.
+  Notification done_again;
+  batcher.CopyHostToDevice(input, &gpu_tensor,
+                           context_->host_to_device_stream(),
+                           context_->stream(), /*sync_dst_compute=*/true,
+                           event_mgr_, [&](const Status& s) {
+                             status = s;
+                             done_again.Notify();
+                           });
+  done_again.WaitForNotification();
+  EXPECT_EQ(status.code(), error::RESOURCE_EXHAUSTED);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -19,12 +19,14 @@ limitations under the License.
 #include "tensorflow/stream_executor/cuda/cuda_activation.h"
 #endif  // GOOGLE_CUDA
 
+#include "absl/algorithm/container.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/common_runtime/device/device_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_cudamallocasync_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/util/env_var.h"
 
@@ -41,11 +43,34 @@ static std::string GetCudaErrorMessage(CUresult result) {
 }
 #endif  // GOOGLE_CUDA
 
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+namespace {
+
+// The pools of all the allocators of the process.
+struct PoolRegistry {
+  struct Entry {
+    CUmemoryPool* pool;  // Not owned.
+    PlatformDeviceId platform_device_id;
+  };
+
+  mutex mu;
+  std::vector<Entry> entries TF_GUARDED_BY(mu);
+};
+
+PoolRegistry* GetPoolRegistry() {
+  static PoolRegistry* registry = new PoolRegistry;
+  return registry;
+}
+
+}  // namespace
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+
 GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
     PlatformDeviceId platform_device_id, size_t pool_size, bool reserve_memory,
     bool compute_stats)
     : name_(absl::StrCat("gpu_async_", platform_device_id.value())) {
 #if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  platform_device_id_ = platform_device_id;
   stream_exec_ = DeviceIdUtil::ExecutorForPlatformDeviceId(GPUMachineManager(),
                                                            platform_device_id)
                      .ValueOrDie();
@@ -80,17 +105,55 @@ GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
         << " Possible causes: device not supported, driver too old, "
         << " OS not supported, CUDA version too old.";
 
-  if (auto status =
-          cuDeviceGetDefaultMemPool(&pool_, platform_device_id.value()))
+  // Virtual devices of a GPU each have their own compute stream. Give each
+  // one its own pool, so that memory freed on one stream isn't reused on
+  // another one, which makes the driver add cross-stream dependencies.
+  PoolRegistry* registry = GetPoolRegistry();
+  bool gpu_has_pool;
+  {
+    mutex_lock lock(registry->mu);
+    gpu_has_pool =
+        absl::c_any_of(registry->entries, [&](const PoolRegistry::Entry& e) {
+          return e.platform_device_id == platform_device_id;
+        });
+  }
+  if (gpu_has_pool) {
+    CUmemPoolProps pool_props = {};
+    pool_props.allocType = CU_MEM_ALLOCATION_TYPE_PINNED;
+    pool_props.handleTypes = CU_MEM_HANDLE_TYPE_NONE;
+    pool_props.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    pool_props.location.id = platform_device_id.value();
+    if (auto status = cuMemPoolCreate(&pool_, &pool_props))
+      LOG(FATAL) <<  // Crash OK.
+          "Failed to create CUDA pool: " << GetCudaErrorMessage(status);
+    owns_pool_ = true;
+  } else if (auto status = cuDeviceGetDefaultMemPool(
+                 &pool_, platform_device_id.value())) {
     LOG(FATAL) <<  // Crash OK.
         "Failed to get default CUDA pool: " << GetCudaErrorMessage(status);
+  }
 
+  // Memory freed to the pool is kept cached up to the release threshold, and
+  // the excess is returned to the driver at the next synchronization. A
+  // threshold below the pool size leaves more memory to other processes
+  // sharing the GPU, e.g. several model servers.
+  int64 release_threshold = pool_size;
+  Status env_status = ReadInt64FromEnvVar(
+      "TF_CUDA_MALLOC_ASYNC_RELEASE_THRESHOLD", pool_size, &release_threshold);
+  if (!env_status.ok() || release_threshold < 0) {
+    LOG(ERROR) << "Invalid TF_CUDA_MALLOC_ASYNC_RELEASE_THRESHOLD, using the "
+               << "pool size of " << pool_size
+               << " bytes instead: " << env_status;
+    release_threshold = pool_size;
+  }
   VLOG(1) << Name() << " CudaMallocAsync initialized on platform: "
           << platform_device_id.value() << " with pool size of: " << pool_size
+          << ", release threshold of: " << release_threshold
+          << (owns_pool_ ? ", dedicated pool" : ", default pool")
           << " this ptr: " << this;
-  uint64_t pool_size_64 = pool_size;
+  uint64_t release_threshold_64 = release_threshold;
   if (auto status = cuMemPoolSetAttribute(
-          pool_, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &pool_size_64))
+          pool_, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD, &release_threshold_64))
     LOG(FATAL) <<  // Crash OK.
         "Failed to set CUDA pool attribute: " << GetCudaErrorMessage(status);
 
@@ -114,58 +177,62 @@ GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
   }
 
   // Set read/write access to all GPUs.
-  static auto* all_pools_ = new std::vector<CUmemoryPool*>();
-  static auto* all_ids_ = new std::vector<PlatformDeviceId>();
-  DCHECK(all_pools_->size() == all_ids_->size());
-  for (int i = 0; i < all_pools_->size(); ++i) {
-    // Set the current pool access to the previous GPUs.
-    CUmemAccessDesc map;
-    map.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
-    map.location.id = (*all_ids_)[i].value();
-
-    map.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
-    VLOG(2) << "Setting access of the current pool to "
-            << " location id: " << map.location.id;
-    int canAccessPeer;
-    if (auto status = cuDeviceCanAccessPeer(
-            &canAccessPeer, platform_device_id.value(), map.location.id)) {
-      pool_ = nullptr;
-      LOG(FATAL)  // Crash OK.
-          << "cuDeviceCanAccessPeer failed: " << GetCudaErrorMessage(status);
-    }
-    if (canAccessPeer == 1) {
-      if (auto status = cuMemPoolSetAccess(pool_, &map, 1)) {
+  {
+    mutex_lock lock(registry->mu);
+    for (int i = 0; i < registry->entries.size(); ++i) {
+      const PoolRegistry::Entry& entry = registry->entries[i];
+      // Pools are always accessible from their own GPU.
+      if (entry.platform_device_id == platform_device_id) continue;
+      // Set the current pool access to the previous GPUs.
+      CUmemAccessDesc map;
+      map.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
+      map.location.id = entry.platform_device_id.value();
+
+      map.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+      VLOG(2) << "Setting access of the current pool to "
+              << " location id: " << map.location.id;
+      int canAccessPeer;
+      if (auto status = cuDeviceCanAccessPeer(
+              &canAccessPeer, platform_device_id.value(), map.location.id)) {
         pool_ = nullptr;
         LOG(FATAL)  // Crash OK.
-            << "Error when setting access to the pool id: " << i
-            << " location id: " << map.location.id
-            << " error: " << GetCudaErrorMessage(status);
+            << "cuDeviceCanAccessPeer failed: " << GetCudaErrorMessage(status);
+      }
+      if (canAccessPeer == 1) {
+        if (auto status = cuMemPoolSetAccess(pool_, &map, 1)) {
+          pool_ = nullptr;
+          LOG(FATAL)  // Crash OK.
+              << "Error when setting access to the pool id: " << i
+              << " location id: " << map.location.id
+              << " error: " << GetCudaErrorMessage(status);
+        }
       }
-    }
 
-    // Set the previous pools access to the current GPU.
-    map.location.id = platform_device_id.value();
+      // Set the previous pools access to the current GPU.
+      map.location.id = platform_device_id.value();
 
-    VLOG(2) << "Set access to the pool id: " << i
-            << " location id: " << map.location.id;
-    if (auto status = cuDeviceCanAccessPeer(&canAccessPeer, i,
-                                            platform_device_id.value())) {
-      pool_ = nullptr;
-      LOG(FATAL)  // Crash OK.
-          << "cuDeviceCanAccessPeer failed: " << GetCudaErrorMessage(status);
-    }
-    if (canAccessPeer == 1) {
-      if (auto status = cuMemPoolSetAccess(*(*all_pools_)[i], &map, 1)) {
+      VLOG(2) << "Set access to the pool id: " << i
+              << " location id: " << map.location.id;
+      if (auto status =
+              cuDeviceCanAccessPeer(&canAccessPeer,
+                                    entry.platform_device_id.value(),
+                                    platform_device_id.value())) {
         pool_ = nullptr;
         LOG(FATAL)  // Crash OK.
-            << "Error when setting access to the pool id: " << i
-            << " location id: " << map.location.id
-            << " error: " << GetCudaErrorMessage(status);
+            << "cuDeviceCanAccessPeer failed: " << GetCudaErrorMessage(status);
+      }
+      if (canAccessPeer == 1) {
+        if (auto status = cuMemPoolSetAccess(*entry.pool, &map, 1)) {
+          pool_ = nullptr;
+          LOG(FATAL)  // Crash OK.
+              << "Error when setting access to the pool id: " << i
+              << " location id: " << map.location.id
+              << " error: " << GetCudaErrorMessage(status);
+        }
       }
     }
+    registry->entries.push_back({&pool_, platform_device_id});
   }
-  all_pools_->push_back(&pool_);
-  all_ids_->push_back(platform_device_id);
 
   VLOG(2) << Name() << " GpuCudaMallocAsyncAllocator PoolSize " << pool_size;
   int64 prealloc_size = 0;
@@ -192,7 +259,47 @@ GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
 #endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
 }
 
-GpuCudaMallocAsyncAllocator::~GpuCudaMallocAsyncAllocator() {}
+GpuCudaMallocAsyncAllocator::~GpuCudaMallocAsyncAllocator() {
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  PoolRegistry* registry = GetPoolRegistry();
+  mutex_lock lock(registry->mu);
+  auto it = absl::c_find_if(registry->entries,
+                            [this](const PoolRegistry::Entry& e) {
+                              return e.pool == &pool_;
+                            });
+  if (it != registry->entries.end()) registry->entries.erase(it);
+  if (owns_pool_ && pool_ != nullptr) {
+    se::cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+    cuMemPoolDestroy(pool_);
+  }
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+bool GpuCudaMallocAsyncAllocator::ReleaseCachedMemory() {
+  // Memory freed on the stream is only returned to the pool once the frees
+  // completed. The other pools of the GPU release what their own streams
+  // already freed.
+  if (auto result = cuStreamSynchronize(cuda_stream_)) {
+    LOG(ERROR) << Name() << " cuStreamSynchronize failed: "
+               << GetCudaErrorMessage(result);
+    return false;
+  }
+  PoolRegistry* registry = GetPoolRegistry();
+  mutex_lock lock(registry->mu);
+  bool trimmed = false;
+  for (const PoolRegistry::Entry& entry : registry->entries) {
+    if (entry.platform_device_id != platform_device_id_) continue;
+    if (auto result = cuMemPoolTrimTo(*entry.pool, 0)) {
+      LOG(ERROR) << Name() << " cuMemPoolTrimTo failed: "
+                 << GetCudaErrorMessage(result);
+    } else {
+      trimmed = true;
+    }
+  }
+  return trimmed;
+}
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
 
 void* GpuCudaMallocAsyncAllocator::AllocateRaw(size_t alignment,
                                                size_t num_bytes) {
@@ -206,9 +313,17 @@ void* GpuCudaMallocAsyncAllocator::AllocateRaw(size_t alignment,
   }
   se::cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
   void* ptr = nullptr;
-  if (auto result =
-          cuMemAllocFromPoolAsync(reinterpret_cast<CUdeviceptr*>(&ptr),
-                                  num_bytes, pool_, cuda_stream_)) {
+  CUresult result = cuMemAllocFromPoolAsync(
+      reinterpret_cast<CUdeviceptr*>(&ptr), num_bytes, pool_, cuda_stream_);
+  // The other pools of the GPU may cache memory freed below their release
+  // threshold. Return it all to the driver and try again.
+  if (result == CUDA_ERROR_OUT_OF_MEMORY && ReleaseCachedMemory()) {
+    VLOG(1) << Name() << " Retrying the allocation of " << num_bytes
+            << " bytes after releasing the cached memory of the GPU pools";
+    result = cuMemAllocFromPoolAsync(reinterpret_cast<CUdeviceptr*>(&ptr),
+                                     num_bytes, pool_, cuda_stream_);
+  }
+  if (result) {
     size_t free, total;
     cuMemGetInfo(&free, &total);
     LOG(ERROR) << Name() << " cuMemAllocAsync failed to allocate " << num_bytes
@@ -289,7 +404,23 @@ size_t GpuCudaMallocAsyncAllocator::AllocatedSize(const void* ptr) const {
 absl::optional<AllocatorStats> GpuCudaMallocAsyncAllocator::GetStats() {
   if (!stats_) return absl::nullopt;
   mutex_lock l(lock_);
-  return *stats_;
+  AllocatorStats stats = *stats_;
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED && CUDA_VERSION >= 11030
+  // Like for the BFC allocator, the reserved bytes are those held by the pool,
+  // whether in use or cached.
+  cuuint64_t reserved = 0;
+  cuuint64_t peak_reserved = 0;
+  if (pool_ != nullptr &&
+      !cuMemPoolGetAttribute(pool_, CU_MEMPOOL_ATTR_RESERVED_MEM_CURRENT,
+                             &reserved) &&
+      !cuMemPoolGetAttribute(pool_, CU_MEMPOOL_ATTR_RESERVED_MEM_HIGH,
+                             &peak_reserved)) {
+    stats.bytes_reserved = reserved;
+    stats.peak_bytes_reserved = peak_reserved;
+    stats.heap_bytes = reserved;
+  }
+#endif
+  return stats;
 }
 
 bool GpuCudaMallocAsyncAllocator::ClearStats() {
@@ -298,6 +429,13 @@ bool GpuCudaMallocAsyncAllocator::ClearStats() {
   stats_->num_allocs = 0;
   stats_->peak_bytes_in_use = stats_->bytes_in_use;
   stats_->largest_alloc_size = 0;
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED && CUDA_VERSION >= 11030
+  // Zero is the only value the high watermark can be reset to.
+  cuuint64_t zero = 0;
+  if (pool_ != nullptr) {
+    cuMemPoolSetAttribute(pool_, CU_MEMPOOL_ATTR_RESERVED_MEM_HIGH, &zero);
+  }
+#endif
   return true;
 }
 
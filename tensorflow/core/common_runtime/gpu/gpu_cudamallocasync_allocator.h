@@ -61,7 +61,15 @@ namespace tensorflow {
 //
 // Here, the pool_size isn't the absolute max as for [Gpu]BFCAllocator.
 // The pool can grow above that up to the total GPU memory.  But the
-// driver can return the excess memory to other processes.
+// driver can return the excess memory to other processes. The memory kept
+// can be lowered with `TF_CUDA_MALLOC_ASYNC_RELEASE_THRESHOLD=nb_bytes`,
+// e.g. when several processes share a GPU.
+//
+// The first allocator of a GPU uses the default pool of the GPU. The
+// allocators of other virtual devices on the same GPU, which have their own
+// compute stream, each use a dedicated pool. When an allocation fails, the
+// memory cached by all the pools of the GPU is released at once before
+// retrying.
 class GpuCudaMallocAsyncAllocator : public Allocator {
  public:
   explicit GpuCudaMallocAsyncAllocator(PlatformDeviceId platform_device_id,
@@ -104,6 +112,16 @@ class GpuCudaMallocAsyncAllocator : public Allocator {
   // If null, then the instanciation failed and the first allocation
   // will return an error.
   CUmemoryPool pool_;
+  // Whether pool_ was created by this allocator rather than being the
+  // default pool of the GPU.
+  bool owns_pool_ = false;
+
+  PlatformDeviceId platform_device_id_;
+
+  // Waits for the pending work on cuda_stream_ and releases the memory cached
+  // by all the pools of the GPU to the driver. Returns true if any memory may
+  // have been released.
+  bool ReleaseCachedMemory();
 #endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
 
   string name_;
@@ -0,0 +1,116 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "tensorflow/core/common_runtime/gpu/gpu_cudamallocasync_allocator.h"
+
+#include <stdlib.h>
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/device/device_id_utils.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_id.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
+
+#if TF_CUDA_MALLOC_ASYNC_SUPPORTED
+
+namespace tensorflow {
+namespace {
+
+constexpr int64 kPoolSize = 1 << 20;
+
+// Returns a new stream on GPU 0.
+std::unique_ptr<se::Stream> NewStream() {
+  se::StreamExecutor* executor =
+      DeviceIdUtil::ExecutorForPlatformDeviceId(GPUMachineManager(),
+                                                PlatformDeviceId(0))
+          .ValueOrDie();
+  auto stream = std::make_unique<se::Stream>(executor);
+  stream->Init();
+  return stream;
+}
+
+void SetStream(GpuCudaMallocAsyncAllocator* allocator, se::Stream* stream) {
+  allocator->SetStream(se::gpu::AsGpuStreamValue(stream));
+}
+
+TEST(GpuCudaMallocAsyncAllocatorTest, NoStatsByDefault) {
+  GpuCudaMallocAsyncAllocator allocator(PlatformDeviceId(0), kPoolSize);
+  EXPECT_FALSE(allocator.TracksAllocationSizes());
+  EXPECT_FALSE(allocator.GetStats().has_value());
+}
+
+TEST(GpuCudaMallocAsyncAllocatorTest, ComputesStatsWhenAsked) {
+  std::unique_ptr<se::Stream> stream = NewStream();
+  GpuCudaMallocAsyncAllocator allocator(PlatformDeviceId(0), kPoolSize,
+                                        /*reserve_memory=*/false,
+                                        /*compute_stats=*/true);
+  SetStream(&allocator, stream.get());
+
+  void* ptr = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  ASSERT_NE(ptr, nullptr);
+  absl::optional<AllocatorStats> stats = allocator.GetStats();
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->num_allocs, 1);
+  EXPECT_EQ(stats->bytes_in_use, 1024);
+  EXPECT_EQ(*stats->bytes_limit, kPoolSize);
+
+  allocator.DeallocateRaw(ptr);
+  EXPECT_EQ(allocator.GetStats()->bytes_in_use, 0);
+  EXPECT_EQ(allocator.GetStats()->peak_bytes_in_use, 1024);
+  EXPECT_TRUE(allocator.ClearStats());
+  EXPECT_EQ(allocator.GetStats()->peak_bytes_in_use, 0);
+}
+
+TEST(GpuCudaMallocAsyncAllocatorTest, InvalidReleaseThreshold) {
+  setenv("TF_CUDA_MALLOC_ASYNC_RELEASE_THRESHOLD", "not a number", 1);
+  std::unique_ptr<se::Stream> stream = NewStream();
+  // Falls back to the pool size rather than crashing.
+  GpuCudaMallocAsyncAllocator allocator(PlatformDeviceId(0), kPoolSize);
+  unsetenv("TF_CUDA_MALLOC_ASYNC_RELEASE_THRESHOLD");
+  SetStream(&allocator, stream.get());
+
+  void* ptr = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  EXPECT_NE(ptr, nullptr);
+  allocator.DeallocateRaw(ptr);
+}
+
+TEST(GpuCudaMallocAsyncAllocatorTest, VirtualDevicesOfOneGpu) {
+  // Like two virtual devices of GPU 0, each with its own stream and pool.
+  std::unique_ptr<se::Stream> stream0 = NewStream();
+  std::unique_ptr<se::Stream> stream1 = NewStream();
+  GpuCudaMallocAsyncAllocator allocator0(PlatformDeviceId(0), kPoolSize);
+  GpuCudaMallocAsyncAllocator allocator1(PlatformDeviceId(0), kPoolSize);
+  SetStream(&allocator0, stream0.get());
+  SetStream(&allocator1, stream1.get());
+
+  void* ptr0 = allocator0.AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  void* ptr1 = allocator1.AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  ASSERT_NE(ptr0, nullptr);
+  ASSERT_NE(ptr1, nullptr);
+  EXPECT_NE(ptr0, ptr1);
+  allocator0.DeallocateRaw(ptr0);
+  allocator1.DeallocateRaw(ptr1);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+#endif  // GOOGLE_CUDA
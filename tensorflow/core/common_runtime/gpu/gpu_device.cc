@@ -44,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_assignment.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -708,6 +709,21 @@ Status BaseGPUDevice::Sync() {
   return stream_->compute->BlockHostUntilDone();
 }
 
+Status BaseGPUDevice::MaybeRewriteGraph(std::unique_ptr<Graph>* graph) {
+  // All kernels of a device run on its single compute stream. Report how
+  // much of the graph could overlap on more streams, which tells whether
+  // splitting independent branches over virtual devices may help.
+  constexpr int kMaxReportedStreams = 4;
+  if (VLOG_IS_ON(1)) {
+    GpuStreamAssignment assignment;
+    TF_RETURN_IF_ERROR(
+        AssignGpuStreams(**graph, kMaxReportedStreams, &assignment));
+    VLOG(1) << "The graph on " << name() << " could run on "
+            << assignment.DebugString();
+  }
+  return Status::OK();
+}
+
 void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
                                  OpKernelContext* context,
                                  AsyncOpKernel::DoneCallback done) {
@@ -1133,6 +1149,7 @@ Allocator* BaseGPUDevice::GetScopedAllocator(AllocatorAttributes attr,
 
 const int BaseGPUDeviceFactory::InterconnectMap::kSameDeviceStrength = 1000;
 const int BaseGPUDeviceFactory::InterconnectMap::kStreamExecutorStrength = 1;
+const int BaseGPUDeviceFactory::InterconnectMap::kNVLinkStrength = 200;
 
 Status BaseGPUDeviceFactory::CacheDeviceIds() {
   if (!cached_device_ids_.empty()) {
@@ -1533,6 +1550,24 @@ GetPeerAccessMap(se::Platform* platform,
   return map;
 }
 
+#if GOOGLE_CUDA
+// Returns whether the peer link from `from` to `to` is NVLink. Native atomics
+// between peers are only supported over NVLink, so they tell it apart from
+// PCIe.
+bool IsNVLinkPeer(PlatformDeviceId from, PlatformDeviceId to) {
+  int atomics_supported = 0;
+  cudaError_t err = cudaDeviceGetP2PAttribute(
+      &atomics_supported, cudaDevP2PAttrNativeAtomicSupported, from.value(),
+      to.value());
+  if (err != cudaSuccess) {
+    VLOG(1) << "cudaDeviceGetP2PAttribute() from GPU " << from << " to GPU "
+            << to << " failed. Status: " << cudaGetErrorString(err);
+    return false;
+  }
+  return atomics_supported != 0;
+}
+#endif  // GOOGLE_CUDA
+
 }  // namespace
 
 Status BaseGPUDeviceFactory::GetInterconnectMaps(
@@ -1552,6 +1587,24 @@ Status BaseGPUDeviceFactory::GetInterconnectMaps(
       }
     }
   }
+#if GOOGLE_CUDA
+  // Peers connected over NVLink get an additional, stronger link, so that
+  // consumers of DeviceLocality, e.g. the ring order of collectives, prefer
+  // them over peers only reachable over PCIe.
+  InterconnectMap nvlink_map;
+  nvlink_map.name = "NVLink";
+  nvlink_map.strength = InterconnectMap::kNVLinkStrength;
+  for (const auto& link : maps->at(0).directed_links) {
+    if (IsNVLinkPeer(link.first, link.second)) {
+      nvlink_map.directed_links.insert(link);
+    }
+  }
+  if (!nvlink_map.directed_links.empty()) {
+    VLOG(1) << "Found " << nvlink_map.directed_links.size()
+            << " directed NVLink connections between GPUs";
+    maps->push_back(std::move(nvlink_map));
+  }
+#endif  // GOOGLE_CUDA
   return Status::OK();
 }
 
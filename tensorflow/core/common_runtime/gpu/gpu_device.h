@@ -67,6 +67,10 @@ class BaseGPUDevice : public LocalDevice {
 
   Status Sync() override;
 
+  // Does not rewrite the graph. With --v=1, logs how the graph would be
+  // spread over compute streams, see AssignGpuStreams.
+  Status MaybeRewriteGraph(std::unique_ptr<Graph>* graph) override;
+
   void ComputeAsync(AsyncOpKernel* op_kernel, OpKernelContext* context,
                     AsyncOpKernel::DoneCallback done) override;
 
@@ -335,6 +339,8 @@ class BaseGPUDeviceFactory : public DeviceFactory {
     int32 strength;
     static const int kSameDeviceStrength;
     static const int kStreamExecutorStrength;
+    // Roughly the bandwidth of one NVLink link.
+    static const int kNVLinkStrength;
     std::set<std::pair<PlatformDeviceId, PlatformDeviceId>> directed_links;
   };
 
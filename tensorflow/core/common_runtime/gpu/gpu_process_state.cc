@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 
+#include <atomic>
 #include <cstring>
+#include <memory>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
@@ -33,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/shared_counter.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/log_memory.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -334,9 +337,20 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
     while (gpu_host_free_visitors_.size() <= numa_node) {
       gpu_host_free_visitors_.push_back({});
     }
+    // Export the pinned memory the allocator holds, which grows on demand.
+    std::vector<SubAllocator::Visitor> alloc_visitors =
+        gpu_host_alloc_visitors_[numa_node];
+    std::vector<SubAllocator::Visitor> free_visitors =
+        gpu_host_free_visitors_[numa_node];
+    auto pinned_bytes = std::make_shared<std::atomic<int64>>(0);
+    alloc_visitors.push_back([pinned_bytes](void*, int index, size_t bytes) {
+      metrics::UpdateGpuHostPinnedBytes(index, *pinned_bytes += bytes);
+    });
+    free_visitors.push_back([pinned_bytes](void*, int index, size_t bytes) {
+      metrics::UpdateGpuHostPinnedBytes(index, *pinned_bytes -= bytes);
+    });
     SubAllocator* sub_allocator = new DeviceHostAllocator(
-        se, numa_node, gpu_host_alloc_visitors_[numa_node],
-        gpu_host_free_visitors_[numa_node]);
+        se, numa_node, alloc_visitors, free_visitors);
     // TODO(zheng-xq): evaluate whether 64GB by default is the best choice.
     int64 gpu_host_mem_limit_in_mb = -1;
     Status status = ReadInt64FromEnvVar("TF_GPU_HOST_MEM_LIMIT_IN_MB",
@@ -346,10 +360,19 @@ Allocator* GPUProcessState::GetGpuHostAllocator(int numa_node) {
       LOG(ERROR) << "GetGpuHostAllocator: " << status.error_message();
     }
     int64 gpu_host_mem_limit = gpu_host_mem_limit_in_mb * (1LL << 20);
+    int64 small_alloc_cache_stripes = 0;
+    status = ReadInt64FromEnvVar("TF_GPU_HOST_SMALL_ALLOC_CACHE_STRIPES",
+                                 0 /*disabled by default*/,
+                                 &small_alloc_cache_stripes);
+    if (!status.ok()) {
+      LOG(ERROR) << "GetGpuHostAllocator: " << status.error_message();
+    }
 
-    Allocator* allocator =
+    BFCAllocator* bfc_allocator =
         new BFCAllocator(sub_allocator, gpu_host_mem_limit,
                          /*allow_growth=*/true, /*name=*/"gpu_host_bfc");
+    bfc_allocator->EnableSmallChunkCache(small_alloc_cache_stripes);
+    Allocator* allocator = bfc_allocator;
 
     if (LogMemory::IsEnabled() && !allocator->TracksAllocationSizes()) {
       // Wrap the allocator to track allocation ids for better logging
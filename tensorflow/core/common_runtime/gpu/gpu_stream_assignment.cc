@@ -0,0 +1,173 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_assignment.h"
+
+#include <algorithm>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace {
+
+bool IsBackEdge(const Edge& edge) { return edge.src()->IsNextIteration(); }
+
+// Answers whether a node is an ancestor of another by a reverse search that
+// stops at nodes ordered before the candidate ancestor.
+class AncestorChecker {
+ public:
+  AncestorChecker(const Graph& graph, const std::vector<int>& position)
+      : position_(position), visited_(graph.num_node_ids(), 0) {}
+
+  bool IsAncestor(const Node* ancestor, const Node* node) {
+    const int min_position = position_[ancestor->id()];
+    ++generation_;
+    stack_.clear();
+    stack_.push_back(node);
+    while (!stack_.empty()) {
+      const Node* current = stack_.back();
+      stack_.pop_back();
+      for (const Edge* edge : current->in_edges()) {
+        if (IsBackEdge(*edge)) continue;
+        const Node* src = edge->src();
+        if (src == ancestor) return true;
+        if (position_[src->id()] <= min_position ||
+            visited_[src->id()] == generation_) {
+          continue;
+        }
+        visited_[src->id()] = generation_;
+        stack_.push_back(src);
+      }
+    }
+    return false;
+  }
+
+ private:
+  const std::vector<int>& position_;
+  std::vector<int> visited_;
+  int generation_ = 0;
+  std::vector<const Node*> stack_;
+};
+
+}  // namespace
+
+std::string GpuStreamAssignment::DebugString() const {
+  std::vector<int> ops_per_stream(num_streams, 0);
+  for (int stream : node_to_stream) {
+    if (stream >= 0) ++ops_per_stream[stream];
+  }
+  return absl::StrCat(num_streams, " streams with [",
+                      absl::StrJoin(ops_per_stream, ", "), "] ops, ",
+                      cross_stream_waits.size(), " cross-stream waits");
+}
+
+Status AssignGpuStreams(const Graph& graph, int max_streams,
+                        GpuStreamAssignment* assignment) {
+  if (max_streams < 1) {
+    return errors::InvalidArgument("max_streams must be positive, got ",
+                                   max_streams);
+  }
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order, NodeComparatorID(),
+                      [](const Edge& edge) { return !IsBackEdge(edge); });
+  // Roots, e.g. constants and arguments, are cheap and go first on the first
+  // stream, so that no branch waits for another one to get its roots.
+  auto is_root = [](const Node* node) {
+    for (const Edge* edge : node->in_edges()) {
+      if (!IsBackEdge(*edge) && edge->src()->IsOp()) return false;
+    }
+    return node->IsOp();
+  };
+  std::stable_partition(order.begin(), order.end(), [&](const Node* node) {
+    return node->IsSource() || is_root(node);
+  });
+  std::vector<int> position(graph.num_node_ids(), -1);
+  for (int i = 0, end = order.size(); i < end; ++i) {
+    position[order[i]->id()] = i;
+  }
+
+  assignment->num_streams = 0;
+  assignment->node_to_stream.assign(graph.num_node_ids(), -1);
+  assignment->cross_stream_waits.clear();
+  // The op assigned last to each stream, ignoring roots.
+  std::vector<const Node*> last_op;
+  AncestorChecker checker(graph, position);
+  // A stream is free for an op if the op already depends on everything
+  // assigned to the stream so far.
+  auto is_free = [&](int stream, const Node* node) {
+    return last_op[stream] == nullptr ||
+           checker.IsAncestor(last_op[stream], node);
+  };
+
+  std::vector<const Node*> inputs;
+  for (const Node* node : order) {
+    if (!node->IsOp()) continue;
+    inputs.clear();
+    for (const Edge* edge : node->in_edges()) {
+      if (!IsBackEdge(*edge) && edge->src()->IsOp()) {
+        inputs.push_back(edge->src());
+      }
+    }
+    // Latest inputs first: waiting on them would be the most expensive.
+    std::sort(inputs.begin(), inputs.end(),
+              [&](const Node* a, const Node* b) {
+                return position[a->id()] > position[b->id()];
+              });
+
+    int stream = inputs.empty() ? 0 : -1;
+    for (const Node* input : inputs) {
+      if (stream != -1) break;
+      const int input_stream = assignment->node_to_stream[input->id()];
+      if (is_free(input_stream, node)) stream = input_stream;
+    }
+    for (int s = 0; stream == -1 && s < assignment->num_streams; ++s) {
+      if (is_free(s, node)) stream = s;
+    }
+    if (stream == -1 && assignment->num_streams < max_streams) {
+      stream = assignment->num_streams;
+    }
+    if (stream == -1) {
+      stream = assignment->node_to_stream[inputs.front()->id()];
+    }
+    if (stream >= assignment->num_streams) {
+      assignment->num_streams = stream + 1;
+      last_op.resize(assignment->num_streams, nullptr);
+    }
+
+    // One wait per input stream suffices: events recorded on a stream
+    // complete in order, so waiting for the latest input covers the others.
+    absl::flat_hash_map<int, const Node*> waited_streams;
+    for (const Node* input : inputs) {
+      const int input_stream = assignment->node_to_stream[input->id()];
+      if (input_stream != stream) waited_streams.emplace(input_stream, input);
+    }
+    for (const auto& waited : waited_streams) {
+      assignment->cross_stream_waits.emplace_back(waited.second->id(),
+                                                  node->id());
+    }
+
+    assignment->node_to_stream[node->id()] = stream;
+    if (!inputs.empty()) last_op[stream] = node;
+  }
+  std::sort(assignment->cross_stream_waits.begin(),
+            assignment->cross_stream_waits.end());
+  return Status::OK();
+}
+
+}  // namespace tensorflow
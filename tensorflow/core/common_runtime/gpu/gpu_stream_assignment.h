@@ -0,0 +1,57 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_ASSIGNMENT_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_ASSIGNMENT_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// Assignment of the ops of a GPU graph to compute streams, such that
+// independent branches of the graph (e.g. towers or parallel heads) can run
+// concurrently.
+struct GpuStreamAssignment {
+  int num_streams = 0;
+  // Stream of each node, indexed by node id. -1 for the source and sink nodes.
+  std::vector<int> node_to_stream;
+  // Edges (by node ids) whose destination must wait for an event recorded on
+  // the stream of the source after the source ran. Waits implied by an
+  // earlier wait of the same destination on the same stream are omitted.
+  std::vector<std::pair<int, int>> cross_stream_waits;
+
+  // Human readable summary, e.g. for logging.
+  std::string DebugString() const;
+};
+
+// Assigns the ops of `graph` to at most `max_streams` streams. Like XLA's GPU
+// stream assignment, an op goes to a stream whose previous op is one of its
+// ancestors, so it does not serialize independent work, preferring the stream
+// of one of its inputs to avoid a cross-stream wait. When no stream is free,
+// a new one is used if `max_streams` allows, and otherwise the stream of the
+// input that was assigned last. Ops without inputs, e.g. constants and
+// arguments, go first on stream 0 and never keep it busy. Back edges of loops
+// are ignored.
+Status AssignGpuStreams(const Graph& graph, int max_streams,
+                        GpuStreamAssignment* assignment);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_ASSIGNMENT_H_
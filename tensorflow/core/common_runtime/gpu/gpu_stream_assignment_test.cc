@@ -0,0 +1,103 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_assignment.h"
+
+#include <utility>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class GpuStreamAssignmentTest : public ::testing::Test {
+ protected:
+  GpuStreamAssignmentTest() : graph_(OpRegistry::Global()) {}
+
+  int StreamOf(const Node* node) const {
+    return assignment_.node_to_stream[node->id()];
+  }
+
+  bool Waits(const Node* src, const Node* dst) const {
+    for (const auto& wait : assignment_.cross_stream_waits) {
+      if (wait == std::make_pair(src->id(), dst->id())) return true;
+    }
+    return false;
+  }
+
+  Graph graph_;
+  GpuStreamAssignment assignment_;
+};
+
+TEST_F(GpuStreamAssignmentTest, IndependentBranches) {
+  Node* input = test::graph::Constant(&graph_, Tensor(1.0f));
+  Node* a1 = test::graph::Unary(&graph_, "Neg", input);
+  Node* a2 = test::graph::Unary(&graph_, "Neg", a1);
+  Node* b1 = test::graph::Unary(&graph_, "Neg", input);
+  Node* b2 = test::graph::Unary(&graph_, "Neg", b1);
+  Node* sum = test::graph::Binary(&graph_, "Add", a2, b2);
+
+  TF_ASSERT_OK(AssignGpuStreams(graph_, /*max_streams=*/4, &assignment_));
+
+  EXPECT_EQ(assignment_.num_streams, 2);
+  EXPECT_EQ(StreamOf(input), 0);
+  EXPECT_EQ(StreamOf(a1), StreamOf(a2));
+  EXPECT_EQ(StreamOf(b1), StreamOf(b2));
+  EXPECT_NE(StreamOf(a1), StreamOf(b1));
+  // The sum continues one branch and waits for the other one.
+  if (StreamOf(sum) == StreamOf(a2)) {
+    EXPECT_TRUE(Waits(b2, sum));
+  } else {
+    EXPECT_EQ(StreamOf(sum), StreamOf(b2));
+    EXPECT_TRUE(Waits(a2, sum));
+  }
+  EXPECT_EQ(StreamOf(graph_.source_node()), -1);
+  EXPECT_EQ(StreamOf(graph_.sink_node()), -1);
+}
+
+TEST_F(GpuStreamAssignmentTest, ChainUsesOneStream) {
+  Node* node = test::graph::Constant(&graph_, Tensor(1.0f));
+  for (int i = 0; i < 5; ++i) {
+    node = test::graph::Unary(&graph_, "Neg", node);
+  }
+
+  TF_ASSERT_OK(AssignGpuStreams(graph_, /*max_streams=*/4, &assignment_));
+
+  EXPECT_EQ(assignment_.num_streams, 1);
+  EXPECT_TRUE(assignment_.cross_stream_waits.empty());
+}
+
+TEST_F(GpuStreamAssignmentTest, MaxStreams) {
+  Node* input = test::graph::Constant(&graph_, Tensor(1.0f));
+  for (int i = 0; i < 4; ++i) {
+    test::graph::Unary(&graph_, "Neg", input);
+  }
+
+  TF_ASSERT_OK(AssignGpuStreams(graph_, /*max_streams=*/1, &assignment_));
+  EXPECT_EQ(assignment_.num_streams, 1);
+  EXPECT_TRUE(assignment_.cross_stream_waits.empty());
+
+  TF_ASSERT_OK(AssignGpuStreams(graph_, /*max_streams=*/4, &assignment_));
+  EXPECT_EQ(assignment_.num_streams, 4);
+
+  EXPECT_FALSE(AssignGpuStreams(graph_, /*max_streams=*/0, &assignment_).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
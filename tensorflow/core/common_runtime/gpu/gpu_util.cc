@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_copy_batcher.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -272,6 +273,13 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
     done(errors::Internal("No send gpu copy-out-stream is available."));
     return;
   }
+  if (GpuCopyBatcher::ShouldBatch(*gpu_tensor)) {
+    static_cast<const GPUDeviceContext*>(device_context)
+        ->copy_batcher()
+        ->CopyDeviceToHost(*gpu_tensor, cpu_tensor, send_device_to_host_stream,
+                           send_stream, dev_info->event_mgr, std::move(done));
+    return;
+  }
   // Wait for the sender's main stream to make sure the data are available.
   send_device_to_host_stream->ThenWaitFor(send_stream);
 
@@ -317,6 +325,14 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
     done(errors::Internal("No send gpu copy-out-stream is available."));
     return;
   }
+  if (GpuCopyBatcher::ShouldBatch(*cpu_tensor)) {
+    static_cast<const GPUDeviceContext*>(device_context)
+        ->copy_batcher()
+        ->CopyHostToDevice(*cpu_tensor, gpu_tensor, recv_host_to_device_stream,
+                           recv_stream, sync_dst_compute, dev_info->event_mgr,
+                           std::move(done));
+    return;
+  }
   // Wait for the recv-stream to make sure the buffer is truly available.
   if (sync_dst_compute) {
     recv_host_to_device_stream->ThenWaitFor(recv_stream);
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 
+#include <algorithm>
+
 #include "absl/strings/str_format.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/stream_executor/lib/status.h"
@@ -147,25 +149,14 @@ void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
     return nullptr;
   }
 
-  // Create physical memory backing allocation.
-  auto maybe_handle =
-      GpuDriver::CreateMemoryHandle(&gpu_context_, padded_bytes);
-  if (!maybe_handle.ok()) {
-    LOG(ERROR) << maybe_handle.status();
-    return nullptr;
-  }
-  GpuDriver::GenericMemoryHandle handle = std::move(maybe_handle).ValueOrDie();
-
-  // Map VAs for this physical memory.
-  auto status =
-      GpuDriver::MapMemory(&gpu_context_, next_va, handle, access_gpu_handles_);
-  if (!status.ok()) {
-    LOG(ERROR) << status;
-    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
+  // Create and map the physical memory backing the allocation.
+  std::vector<Mapping> new_mappings;
+  if (!MapPages(next_va, padded_bytes, &new_mappings)) {
+    UnmapPages(new_mappings.begin(), new_mappings.end());
     return nullptr;
   }
-  next_alloc_offset_ += handle.bytes;
-  mappings_.push_back({next_va, std::move(handle)});
+  next_alloc_offset_ += padded_bytes;
+  mappings_.insert(mappings_.end(), new_mappings.begin(), new_mappings.end());
   VisitAlloc(reinterpret_cast<void*>(next_va), gpu_id_.value(), padded_bytes);
   *bytes_received = padded_bytes;
   return reinterpret_cast<void*>(next_va);
@@ -174,46 +165,120 @@ void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
 void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
   if (ptr == nullptr) return;
 
-  auto mapping_it =
-      std::lower_bound(mappings_.begin(), mappings_.end(), ptr,
-                       [](const Mapping& mapping, const void* ptr) {
-                         return reinterpret_cast<const void*>(mapping.va) < ptr;
-                       });
-  if (mapping_it == mappings_.end() ||
-      (reinterpret_cast<void*>(mapping_it->va) != ptr)) {
-    LOG(ERROR) << "Could not find GPU vmem mapping for address at "
-               << reinterpret_cast<uintptr_t>(ptr);
+  const GpuDevicePtr va = reinterpret_cast<GpuDevicePtr>(ptr);
+  if (va < vmem_.base || va + num_bytes > vmem_.base + next_alloc_offset_) {
+    LOG(ERROR) << "Invalid range requested for freeing GPU vmem mappings at "
+               << va << " of "
+               << strings::HumanReadableNumBytes(num_bytes);
     return;
   }
 
-  int num_mappings_to_free = 0;
-  int total_bytes = 0;
-  for (auto it = mapping_it; it != mappings_.end() && total_bytes < num_bytes;
-       ++it) {
-    ++num_mappings_to_free;
-    total_bytes += it->physical.bytes;
+  // Pages whose physical memory was released have no mapping anymore.
+  auto begin = FirstMappingAtOrAfter(va);
+  auto end = FirstMappingAtOrAfter(va + num_bytes);
+  VLOG(1) << "Freeing " << (end - begin) << " mappings for a total of "
+          << num_bytes << " bytes";
+  UnmapPages(begin, end);
+  mappings_.erase(begin, end);
+
+  // Move back the next_alloc_offset_ if this free was at the end.
+  if (va + num_bytes == vmem_.base + next_alloc_offset_) {
+    next_alloc_offset_ = va - vmem_.base;
   }
-  if (total_bytes != num_bytes) {
-    LOG(ERROR) << "Invalid size requested for freeing GPU vmem mapping. Got "
-               << strings::HumanReadableNumBytes(num_bytes) << " but expected "
-               << strings::HumanReadableNumBytes(mapping_it->physical.bytes);
-    return;
+
+  VisitFree(ptr, gpu_id_.value(), num_bytes);
+}
+
+size_t GpuVirtualMemAllocator::ReleasePhysical(void* ptr, size_t num_bytes) {
+  const GpuDevicePtr va = reinterpret_cast<GpuDevicePtr>(ptr);
+  auto begin = FirstMappingAtOrAfter(AlignUp(va, granularity_));
+  auto end = begin;
+  size_t released_bytes = 0;
+  while (end != mappings_.end() &&
+         end->va + end->physical.bytes <= va + num_bytes) {
+    released_bytes += end->physical.bytes;
+    ++end;
   }
+  if (released_bytes == 0) return 0;
 
-  VLOG(1) << "Freeing " << num_mappings_to_free << " mappings for a total of "
-          << total_bytes << " bytes";
-  for (auto it = mapping_it; it < mapping_it + num_mappings_to_free; ++it) {
-    GpuDriver::UnmapMemory(&gpu_context_, it->va, it->physical.bytes);
-    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(it->physical));
+  if (!GpuDriver::SynchronizeContext(&gpu_context_)) {
+    LOG(ERROR) << "Could not synchronize the GPU before releasing memory";
+    return 0;
   }
+  VLOG(1) << "Releasing " << (end - begin) << " mappings for a total of "
+          << strings::HumanReadableNumBytes(released_bytes);
+  UnmapPages(begin, end);
+  mappings_.erase(begin, end);
+  return released_bytes;
+}
 
-  // Move back the next_alloc_offset_ if this free was at the end.
-  if (mapping_it + num_mappings_to_free == mappings_.end()) {
-    next_alloc_offset_ = mapping_it->va - vmem_.base;
+bool GpuVirtualMemAllocator::RestorePhysical(void* ptr, size_t num_bytes) {
+  const GpuDevicePtr va = reinterpret_cast<GpuDevicePtr>(ptr);
+  const GpuDevicePtr end =
+      std::min<GpuDevicePtr>(va + num_bytes, vmem_.base + next_alloc_offset_);
+  std::vector<Mapping> new_mappings;
+  bool ok = true;
+  auto it = FirstMappingAtOrAfter(AlignUp(va, granularity_));
+  for (GpuDevicePtr page = AlignUp(va, granularity_);
+       ok && page + granularity_ <= end; page += granularity_) {
+    if (it != mappings_.end() && it->va == page) {
+      ++it;
+      continue;
+    }
+    ok = MapPages(page, granularity_, &new_mappings);
+  }
+  if (!new_mappings.empty()) {
+    VLOG(1) << "Restored " << new_mappings.size() << " mappings";
   }
 
-  mappings_.erase(mapping_it, mapping_it + num_mappings_to_free);
-  VisitFree(ptr, gpu_id_.value(), num_bytes);
+  // Keep the pages mapped even on failure, they are tracked like the others.
+  const size_t num_old_mappings = mappings_.size();
+  mappings_.insert(mappings_.end(), new_mappings.begin(), new_mappings.end());
+  std::inplace_merge(mappings_.begin(), mappings_.begin() + num_old_mappings,
+                     mappings_.end(), [](const Mapping& a, const Mapping& b) {
+                       return a.va < b.va;
+                     });
+  return ok;
+}
+
+std::vector<GpuVirtualMemAllocator::Mapping>::iterator
+GpuVirtualMemAllocator::FirstMappingAtOrAfter(GpuDevicePtr va) {
+  return std::lower_bound(
+      mappings_.begin(), mappings_.end(), va,
+      [](const Mapping& mapping, GpuDevicePtr va) { return mapping.va < va; });
+}
+
+bool GpuVirtualMemAllocator::MapPages(GpuDevicePtr va, size_t num_bytes,
+                                      std::vector<Mapping>* mappings) {
+  for (size_t offset = 0; offset < num_bytes; offset += granularity_) {
+    auto maybe_handle =
+        GpuDriver::CreateMemoryHandle(&gpu_context_, granularity_);
+    if (!maybe_handle.ok()) {
+      LOG(ERROR) << maybe_handle.status();
+      return false;
+    }
+    GpuDriver::GenericMemoryHandle handle =
+        std::move(maybe_handle).ValueOrDie();
+
+    // Map VAs for this physical memory.
+    auto status = GpuDriver::MapMemory(&gpu_context_, va + offset, handle,
+                                       access_gpu_handles_);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
+      return false;
+    }
+    mappings->push_back({va + offset, std::move(handle)});
+  }
+  return true;
+}
+
+void GpuVirtualMemAllocator::UnmapPages(std::vector<Mapping>::iterator begin,
+                                        std::vector<Mapping>::iterator end) {
+  for (auto it = begin; it != end; ++it) {
+    GpuDriver::UnmapMemory(&gpu_context_, it->va, it->physical.bytes);
+    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(it->physical));
+  }
 }
 
 }  // namespace tensorflow
@@ -37,6 +37,12 @@ namespace tensorflow {
 // reserving a large chunk of virtual addresses at construction and then mapping
 // physical memory pages to this virtual address range as requested.
 //
+// Each page of the allocation granularity is mapped separately, so that the
+// physical memory behind any page-aligned part of an allocation can be
+// released and restored later, see ReleasePhysical(). This lets the BFC
+// allocator return the memory behind its free chunks and map it again at the
+// end of the address range, where it forms a contiguous chunk.
+//
 // This class is not thread-safe.
 class GpuVirtualMemAllocator : public SubAllocator {
  public:
@@ -70,6 +76,13 @@ class GpuVirtualMemAllocator : public SubAllocator {
 
   bool SupportsCoalescing() const override { return true; }
 
+  // Waits for the work pending on the GPU, which may still access the
+  // released memory, then unmaps the pages lying entirely within the range.
+  // Alloc and free visitors are not notified.
+  size_t ReleasePhysical(void* ptr, size_t num_bytes) override;
+
+  bool RestorePhysical(void* ptr, size_t num_bytes) override;
+
  private:
   GpuVirtualMemAllocator(
       const std::vector<Visitor>& alloc_visitors,
@@ -101,9 +114,24 @@ class GpuVirtualMemAllocator : public SubAllocator {
     stream_executor::gpu::GpuDevicePtr va;
     stream_executor::gpu::GpuDriver::GenericMemoryHandle physical;
   };
-  // List of mappings, sorted by va.
+  // List of mappings, sorted by va. Each maps a single page of granularity_
+  // bytes.
   std::vector<Mapping> mappings_;
 
+  // Returns the first mapping at or after `va`.
+  std::vector<Mapping>::iterator FirstMappingAtOrAfter(
+      stream_executor::gpu::GpuDevicePtr va);
+
+  // Maps new physical pages to [va, va + num_bytes) and appends them to
+  // `mappings`. Returns false on failure, in which case the pages mapped so
+  // far are still appended.
+  bool MapPages(stream_executor::gpu::GpuDevicePtr va, size_t num_bytes,
+                std::vector<Mapping>* mappings);
+
+  // Unmaps and releases the physical memory of [begin, end).
+  void UnmapPages(std::vector<Mapping>::iterator begin,
+                  std::vector<Mapping>::iterator end);
+
   TF_DISALLOW_COPY_AND_ASSIGN(GpuVirtualMemAllocator);
 };
 
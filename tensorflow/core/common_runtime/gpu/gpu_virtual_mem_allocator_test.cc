@@ -179,6 +179,28 @@ TEST(GpuVirtualMemAllocatorTest, FreeRange) {
   ASSERT_EQ(re_alloc, first_alloc);
 }
 
+TEST(GpuVirtualMemAllocatorTest, ReleaseAndRestorePhysical) {
+  auto allocator = CreateAllocator();
+  size_t bytes_received;  // Ignored in this test.
+  void* alloc = allocator->Alloc(/*alignment=*/0, /*num_bytes=*/3 * k2MiB,
+                                 &bytes_received);
+  ASSERT_NE(alloc, nullptr);
+  char* base = static_cast<char*>(alloc);
+
+  // Only the middle page lies entirely within the range.
+  EXPECT_EQ(allocator->ReleasePhysical(base + 1, 3 * k2MiB - 2), k2MiB);
+  EXPECT_EQ(allocator->ReleasePhysical(base + k2MiB, k2MiB), 0);
+
+  EXPECT_TRUE(allocator->RestorePhysical(base + 1, 3 * k2MiB - 2));
+  EXPECT_EQ(allocator->ReleasePhysical(base, 3 * k2MiB), 3 * k2MiB);
+
+  // Freeing the range works with released pages.
+  allocator->Free(alloc, 3 * k2MiB);
+  void* re_alloc =
+      allocator->Alloc(/*alignment=*/0, /*num_bytes=*/k2MiB, &bytes_received);
+  ASSERT_EQ(re_alloc, alloc);
+}
+
 }  // namespace
 }  // namespace tensorflow
 
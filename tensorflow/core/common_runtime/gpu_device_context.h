@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_copy_batcher.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 
@@ -58,6 +59,8 @@ class GPUDeviceContext : public DeviceContext {
     return device_to_device_stream_[index % device_to_device_stream_.size()];
   }
   int stream_id() const { return stream_id_; }
+  // Batches the small copies between the host and the device.
+  GpuCopyBatcher* copy_batcher() const { return &copy_batcher_; }
 
   void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
                              Tensor* device_tensor, StatusCallback done,
@@ -92,6 +95,7 @@ class GPUDeviceContext : public DeviceContext {
   se::Stream* device_to_host_stream_;
   // Streams to use for copying data between GPUs.
   gtl::InlinedVector<se::Stream*, 4> device_to_device_stream_;
+  mutable GpuCopyBatcher copy_batcher_;
 };
 
 }  // namespace tensorflow
@@ -35,6 +35,15 @@ class Node;
 class OpKernel;
 class Tensor;
 
+// Name of the optional int attr that sets the scheduling priority of a node.
+// When several nodes become ready together, the executor runs those with a
+// higher priority first. Priorities are only honored in graphs where at least
+// one node sets the attr, e.g. a user or a Grappler pass. There, the default
+// priority is 0, except for _Send nodes, which default to kSendNodePriority so
+// that transfers to other devices are not held up by unrelated compute.
+constexpr char kExecutorPriorityAttr[] = "_priority";
+constexpr int16 kSendNodePriority = 1;
+
 // Represents a single data edge in a `NodeItem`.
 struct EdgeInfo {
   // The node ID of the destination in the containing `GraphView`.
@@ -86,6 +95,15 @@ struct NodeItem {
   bool is_distributed_communication : 1;  // True iff the op is registered to
                                           // use distributed communication.
 
+  // Scheduling priority, see `kExecutorPriorityAttr`.
+  int16 priority = 0;
+
+  // If non-null, the only consumer of this node's only output, which has no
+  // other inputs. When that consumer is inexpensive, the executor runs it on
+  // the same thread right after this node and hands it the output directly,
+  // without propagating it through the ready queue.
+  const NodeItem* chain_successor = nullptr;
+
   // The kernel for this node.
   OpKernel* kernel = nullptr;
 
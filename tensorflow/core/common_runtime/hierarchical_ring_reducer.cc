@@ -0,0 +1,361 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <functional>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/ring_reducer.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+// Computes the number of devices per task of `group`, failing unless all tasks
+// have the same number of devices and the devices of each task are adjacent.
+Status GetDevicesPerTask(const CollGroupParams& group, int* local_size) {
+  if (group.num_tasks < 2 || group.group_size % group.num_tasks != 0) {
+    return errors::InvalidArgument(
+        "HierarchicalRingReduce requires a group spanning several tasks with ",
+        "the same number of devices each, got ", group.group_size,
+        " devices in ", group.num_tasks, " tasks");
+  }
+  *local_size = group.group_size / group.num_tasks;
+  for (int rank = 0; rank < group.group_size; ++rank) {
+    const string& first_task = group.task_names[rank - rank % *local_size];
+    if (group.task_names[rank] != first_task) {
+      return errors::InvalidArgument(
+          "HierarchicalRingReduce requires the devices of each task to be ",
+          "adjacent in the group, but device ", group.device_names[rank],
+          " at rank ", rank, " does not belong to task ", first_task);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+HierarchicalRingReducer::HierarchicalRingReducer()
+    : col_ctx_(nullptr),
+      col_params_(nullptr),
+      num_tasks_(-1),
+      local_size_(-1),
+      task_index_(-1),
+      local_rank_(-1) {}
+
+HierarchicalRingReducer::~HierarchicalRingReducer() {}
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("HierarchicalRingReduce expects a reduction, got ",
+                            "collective type ", col_params->instance.type);
+  }
+  int local_size;
+  return GetDevicesPerTask(col_params->group, &local_size);
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params;
+  TF_RETURN_IF_ERROR(GetDevicesPerTask(col_params_->group, &local_size_));
+  num_tasks_ = col_params_->group.num_tasks;
+  task_index_ = col_params_->default_rank / local_size_;
+  local_rank_ = col_params_->default_rank % local_size_;
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  VLOG(1) << "HierarchicalRingReducer::Run for device "
+          << col_ctx_->device_name << " default_rank "
+          << col_params_->default_rank << " task " << task_index_
+          << " local rank " << local_rank_ << " of " << local_size_;
+
+  Status s = CopyInputToOutput();
+  if (s.ok() && col_ctx_->output->NumElements() == 0) {
+    // Nothing to reduce.
+    col_ctx_->col_exec->UnblockDependencies(*col_params_);
+    done(s);
+    return;
+  }
+  if (s.ok()) {
+    AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+    ca_.reset(MakeCollectiveAdapter(col_ctx_->output, local_size_,
+                                    col_ctx_->device->GetAllocator(attr)));
+    chunks_.reserve(local_size_);
+    for (int j = 0; j < local_size_; ++j) {
+      chunks_.push_back(ca_->ChunkAlias(j));
+    }
+    s = ReduceScatterWithinTask();
+  }
+  if (s.ok()) {
+    s = ReduceAcrossTasks();
+  } else {
+    // `ReduceAcrossTasks` unblocks dependent collectives once this device
+    // starts talking to other tasks; do it now since it won't get there.
+    col_ctx_->col_exec->UnblockDependencies(*col_params_);
+  }
+  if (s.ok()) {
+    s = ApplyFinalOp();
+  }
+  if (s.ok()) {
+    s = AllGatherWithinTask();
+  }
+  chunks_.clear();  // Give up Refs on output tensor.
+  if (ca_ != nullptr) {
+    // Recover the output from the adaptor.
+    ca_->ConsumeFinalValue(col_ctx_->output);
+    ca_.reset();
+  }
+  done(s);
+}
+
+Status HierarchicalRingReducer::CopyInputToOutput() {
+  if ((col_ctx_->input == col_ctx_->output) ||
+      (DMAHelper::base(col_ctx_->input) == DMAHelper::base(col_ctx_->output))) {
+    return Status::OK();
+  }
+  // We are running in a blockable thread and the callback can't block so
+  // just wait here on the copy.
+  Notification note;
+  Status status;
+  profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->op_device_context(), col_ctx_->device, col_ctx_->device,
+      col_ctx_->op_ctx->input_alloc_attr(0),
+      col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input, col_ctx_->output,
+      0 /*dev_to_dev_stream_index*/, [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+Status HierarchicalRingReducer::ExchangeWithinTask(
+    const string& phase, const std::function<Tensor*(int)>& send_chunk,
+    const std::function<Tensor*(int)>& recv_chunk) {
+  profiler::TraceMe activity(
+      [&] { return strings::StrCat("ExchangeWithinTask:", phase); },
+      profiler::TraceMeLevel::kInfo);
+  CollectiveRemoteAccess* remote_access = col_ctx_->col_exec->remote_access();
+  const int rank = col_params_->default_rank;
+  // Chunks have the same sizes on every device, hence a pair of devices agrees
+  // on which transfers are empty and can be skipped.
+  std::vector<std::pair<int, Tensor*>> sends;
+  std::vector<std::pair<int, Tensor*>> recvs;
+  for (int j = 0; j < local_size_; ++j) {
+    if (j == local_rank_) continue;
+    Tensor* send = send_chunk(j);
+    if (send->NumElements() > 0) sends.emplace_back(LocalPeerRank(j), send);
+    Tensor* recv = recv_chunk(j);
+    if (recv->NumElements() > 0) recvs.emplace_back(LocalPeerRank(j), recv);
+  }
+
+  mutex mu;
+  Status status;
+  BlockingCounter counter(sends.size() + recvs.size());
+  auto done = [&mu, &status, &counter](const Status& s) {
+    {
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    counter.DecrementCount();
+  };
+  for (const auto& send : sends) {
+    const int peer = send.first;
+    remote_access->PostToPeer(
+        col_params_->group.device_names[peer],
+        col_params_->group.task_names[peer],
+        strings::StrCat(col_ctx_->exec_key, ":", phase, ":", rank, ":", peer),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), send.second,
+        col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+        done);
+  }
+  for (const auto& recv : recvs) {
+    const int peer = recv.first;
+    remote_access->RecvFromPeer(
+        col_params_->group.device_names[peer],
+        col_params_->group.task_names[peer], col_params_->task.is_local[peer],
+        strings::StrCat(col_ctx_->exec_key, ":", phase, ":", peer, ":", rank),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), recv.second,
+        col_ctx_->device_locality, 0 /*dev_to_dev_stream_index*/,
+        col_ctx_->op_ctx->cancellation_manager(), done);
+  }
+  counter.Wait();
+  mutex_lock l(mu);
+  return status;
+}
+
+Status HierarchicalRingReducer::ReduceScatterWithinTask() {
+  Tensor& own_chunk = chunks_[local_rank_];
+  std::vector<Tensor> tmp_chunks(local_size_);
+  if (own_chunk.NumElements() > 0) {
+    for (int j = 0; j < local_size_; ++j) {
+      if (j != local_rank_) tmp_chunks[j] = ca_->TempChunk(local_rank_);
+    }
+    const DeviceBase::GpuDeviceInfo* gpu_info =
+        col_ctx_->device->tensorflow_gpu_device_info();
+    if (gpu_info) {
+      // As in RingReducer, wait for the events queued on the compute stream,
+      // which make the temp buffers allocated above valid for remote writes.
+      Notification note;
+      TF_RETURN_IF_ERROR(gpu_info->default_context->ThenExecute(
+          col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); }));
+      note.WaitForNotification();
+    }
+  }
+  TF_RETURN_IF_ERROR(ExchangeWithinTask(
+      "hrs", [this](int j) { return &chunks_[j]; },
+      [&tmp_chunks](int j) { return &tmp_chunks[j]; }));
+  if (own_chunk.NumElements() == 0) return Status::OK();
+  for (int j = 0; j < local_size_; ++j) {
+    if (j == local_rank_) continue;
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, &own_chunk, &tmp_chunks[j]));
+  }
+  return Status::OK();
+}
+
+Status HierarchicalRingReducer::ReduceAcrossTasks() {
+  Tensor& own_chunk = chunks_[local_rank_];
+  if (own_chunk.NumElements() == 0) {
+    // The devices owning this chunk in the other tasks skip it as well.
+    col_ctx_->col_exec->UnblockDependencies(*col_params_);
+    return Status::OK();
+  }
+  profiler::TraceMe activity("ReduceAcrossTasks",
+                             profiler::TraceMeLevel::kInfo);
+  // Build a group of the devices with local rank `local_rank_`, one per task,
+  // and run a flat ring over it.
+  core::RefCountPtr<CollectiveParams> ring_params(new CollectiveParams());
+  ring_params->name = col_params_->name;
+  ring_params->group = col_params_->group;
+  ring_params->group.group_size = num_tasks_;
+  ring_params->group.device_names.clear();
+  ring_params->group.task_names.clear();
+  for (int t = 0; t < num_tasks_; ++t) {
+    const int rank = t * local_size_ + local_rank_;
+    ring_params->group.device_names.push_back(
+        col_params_->group.device_names[rank]);
+    ring_params->group.task_names.push_back(
+        col_params_->group.task_names[rank]);
+    ring_params->task.is_local.push_back(col_params_->task.is_local[rank]);
+  }
+  // `num_devices_per_task` keeps the device counts of the full group: the
+  // RingReducer unblocks the instances that depend on this one, and it runs
+  // once on every device of the task.
+  ring_params->instance = col_params_->instance;
+  ring_params->instance.shape = TensorShape({own_chunk.NumElements()});
+  ring_params->instance.impl_details.collective_name = "RingReduce";
+  ring_params->instance.impl_details.subdiv_permutations.clear();
+  ring_params->instance.impl_details.subdiv_offsets.clear();
+  ring_params->default_rank = task_index_;
+  ring_params->merge_op = col_params_->merge_op;
+  // Only the values that cross tasks are cast for transfer.
+  ring_params->wire_encode_op = col_params_->wire_encode_op;
+  ring_params->wire_decode_op = col_params_->wire_decode_op;
+  // The final op is applied to the whole group in ApplyFinalOp.
+  ring_params->final_op = nullptr;
+
+  core::RefCountPtr<RingReducer> ring(new RingReducer());
+  Status s = ring->InitializeCollectiveParams(ring_params.get());
+  auto ring_ctx = std::make_shared<CollectiveContext>(
+      col_ctx_->col_exec, col_ctx_->nccl_communicator, col_ctx_->dev_mgr,
+      col_ctx_->op_ctx, col_ctx_->op_params, ring_params.get(),
+      strings::StrCat(col_ctx_->exec_key, ":hxr"), col_ctx_->step_id,
+      &own_chunk, &own_chunk);
+  if (s.ok()) {
+    s = ring->InitializeCollectiveContext(ring_ctx);
+  }
+  if (!s.ok()) {
+    col_ctx_->col_exec->UnblockDependencies(*col_params_);
+    ring->group_size_tensor_ready_.Notify();  // To unblock destructor.
+    return s;
+  }
+  Notification note;
+  ring->Run([&s, &note](const Status& ring_status) {
+    s = ring_status;
+    note.Notify();
+  });
+  note.WaitForNotification();
+  return s;
+}
+
+Status HierarchicalRingReducer::ApplyFinalOp() {
+  Tensor& own_chunk = chunks_[local_rank_];
+  if (col_params_->final_op == nullptr || own_chunk.NumElements() == 0) {
+    return Status::OK();
+  }
+  Tensor group_size_val = ca_->Scalar(col_params_->group.group_size);
+  Tensor group_size_tensor = group_size_val;
+  if (col_params_->group.device_type != "CPU") {
+    group_size_tensor = ca_->Scalar(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+        AllocationAttributes());
+    Notification note;
+    Status status;
+    col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+        &group_size_val, col_ctx_->device, &group_size_tensor,
+        [&note, &status](const Status& s) {
+          status = s;
+          note.Notify();
+        });
+    note.WaitForNotification();
+    TF_RETURN_IF_ERROR(status);
+  }
+  return collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->final_op, &own_chunk, &group_size_tensor);
+}
+
+Status HierarchicalRingReducer::AllGatherWithinTask() {
+  return ExchangeWithinTask(
+      "hag", [this](int j) { return &chunks_[local_rank_]; },
+      [this](int j) { return &chunks_[j]; });
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
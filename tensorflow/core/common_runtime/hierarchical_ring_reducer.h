@@ -0,0 +1,99 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+class Device;
+
+// Two-level implementation of collective all-reduce for groups that span
+// several tasks, each of which contributes the same number of devices.
+//
+// With T tasks of L devices each, the tensor is split into L chunks and the
+// l-th device of every task owns chunk l:
+//  1. Within each task, every device sends chunk j to the j-th local device,
+//     which reduces the L copies of its chunk (reduce-scatter).
+//  2. The T owners of chunk l, one per task, all-reduce it over a ring that
+//     crosses tasks (see RingReducer).
+//  3. Within each task, every device sends its chunk to all other local
+//     devices (all-gather).
+// Each task still sends about twice the tensor to other tasks, but it is split
+// over L concurrent rings of T steps, where a flat ring over all T * L devices
+// pushes it through a single link between each pair of neighbouring tasks and
+// takes 2 * (T * L - 1) sequential steps.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer();
+  ~HierarchicalRingReducer() override;
+
+  // Verifies that the devices of the group form T >= 2 tasks with the same
+  // number of devices each, and that the devices of each task are adjacent in
+  // the default rank order.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Executes the three phases of the algorithm.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  Status CopyInputToOutput();
+  // Exchanges the chunks of the output within the task of this device, so
+  // that this device ends up holding the task-wide reduction of its chunk.
+  Status ReduceScatterWithinTask();
+  // All-reduces the chunk of this device with the devices that own the same
+  // chunk in the other tasks.
+  Status ReduceAcrossTasks();
+  Status ApplyFinalOp();
+  // Distributes the fully reduced chunk of this device to the other devices of
+  // its task, and collects theirs.
+  Status AllGatherWithinTask();
+
+  // Exchanges chunks with the other devices of this task.  Sends
+  // `send_chunk(j)` to and receives `recv_chunk(j)` from the j-th local
+  // device, for every local device j other than this one.  `phase` is used to
+  // build unique rendezvous keys.
+  Status ExchangeWithinTask(const string& phase,
+                            const std::function<Tensor*(int)>& send_chunk,
+                            const std::function<Tensor*(int)>& recv_chunk);
+
+  // Returns the rank within the full group of the j-th device of this task.
+  int LocalPeerRank(int j) const { return task_index_ * local_size_ + j; }
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  int num_tasks_;
+  int local_size_;  // Devices per task.
+  int task_index_;  // Index of the task of this device.
+  int local_rank_;  // Index of this device within its task.
+  std::unique_ptr<CollectiveAdapter> ca_;
+  // Chunks of the output; chunk `local_rank_` is owned by this device.
+  std::vector<Tensor> chunks_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
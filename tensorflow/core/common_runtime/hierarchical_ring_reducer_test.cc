@@ -0,0 +1,180 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <atomic>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   const DeviceType& device_type,
+                                   DeviceBase* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(strings::StrCat(op, "_node"), op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalRingReducerTest : public ::testing::Test {
+ protected:
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, DataType dtype, const TensorShape& shape,
+                   CollectiveTestEnv* test_env)
+        : test_env_(test_env), tensor_(dtype, shape) {
+      col_params_ =
+          CreateCollectiveParams(*test_env_, rank, "HierarchicalRingReduce",
+                                 REDUCTION_COLLECTIVE, dtype, shape);
+      string dev_name = col_params_->group.device_names[rank];
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(dev_name, &device_));
+      merge_op_ = GetBinOp("Add", dtype, test_env_->device_type, device_);
+      final_op_ = GetBinOp("Div", dtype, test_env_->device_type, device_);
+      col_params_->merge_op = merge_op_.get();
+      col_params_->final_op = final_op_.get();
+    }
+
+    void DoReduce() {
+      status_ = RunCollective(test_env_, col_params_.get(), device_, &tensor_,
+                              &tensor_);
+    }
+
+    CollectiveTestEnv* test_env_;
+    Tensor tensor_;
+    Device* device_;
+    core::RefCountPtr<CollectiveParams> col_params_;
+    std::unique_ptr<OpKernel> merge_op_;
+    std::unique_ptr<OpKernel> final_op_;
+    Status status_;
+  };
+
+  template <typename T>
+  void RunTest(DataType dtype, int num_workers, int num_devices,
+               int tensor_len) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    std::vector<T> expected(tensor_len);
+    for (int rank = 0; rank < num_workers * num_devices; ++rank) {
+      instances_.push_back(absl::make_unique<DeviceInstance>(
+          rank, dtype, TensorShape({tensor_len}), test_env_.get()));
+      auto flat = instances_.back()->tensor_.flat<T>();
+      for (int i = 0; i < tensor_len; ++i) {
+        T value = static_cast<T>(rank * 10 + i);
+        flat(i) = value;
+        expected[i] += value;
+      }
+    }
+    std::atomic<int> done(0);
+    for (auto& di : instances_) {
+      SchedClosure([&di, &done] {
+        di->DoReduce();
+        ++done;
+      });
+    }
+    while (done < static_cast<int>(instances_.size())) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] /= static_cast<T>(num_workers * num_devices);
+    }
+    for (const auto& di : instances_) {
+      TF_EXPECT_OK(di->status_);
+      test::ExpectTensorEqual<T>(test::AsTensor<T>(expected), di->tensor_);
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceInstance>> instances_;
+};
+
+TEST_F(HierarchicalRingReducerTest, Float_2Workers_4Devices) {
+  RunTest<float>(DT_FLOAT, 2, 4, 1001);
+}
+
+TEST_F(HierarchicalRingReducerTest, Double_3Workers_2Devices) {
+  RunTest<double>(DT_DOUBLE, 3, 2, 4096);
+}
+
+TEST_F(HierarchicalRingReducerTest, Int64_4Workers_8Devices) {
+  RunTest<int64>(DT_INT64, 4, 8, 10000);
+}
+
+// Fewer elements than devices per worker leaves some chunks empty.
+TEST_F(HierarchicalRingReducerTest, Float_2Workers_8Devices_TinyTensor) {
+  RunTest<float>(DT_FLOAT, 2, 8, 3);
+}
+
+TEST(HierarchicalRingReducerInitParamsTest, RejectsInterleavedTasks) {
+  auto test_env = CreateCollectiveTestEnv(/*num_workers=*/2,
+                                          /*num_devices_per_worker=*/2,
+                                          DEVICE_CPU);
+  auto cp = CreateCollectiveParams(*test_env, /*rank=*/0,
+                                   "HierarchicalRingReduce",
+                                   REDUCTION_COLLECTIVE, DT_FLOAT,
+                                   TensorShape({8}));
+  core::RefCountPtr<HierarchicalRingReducer> reducer(
+      new HierarchicalRingReducer());
+  TF_EXPECT_OK(reducer->InitializeCollectiveParams(cp.get()));
+
+  std::swap(cp->group.device_names[1], cp->group.device_names[2]);
+  std::swap(cp->group.task_names[1], cp->group.task_names[2]);
+  Status s = reducer->InitializeCollectiveParams(cp.get());
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST(HierarchicalRingReducerInitParamsTest, RejectsSingleTask) {
+  auto test_env = CreateCollectiveTestEnv(/*num_workers=*/1,
+                                          /*num_devices_per_worker=*/4,
+                                          DEVICE_CPU);
+  auto cp = CreateCollectiveParams(*test_env, /*rank=*/0,
+                                   "HierarchicalRingReduce",
+                                   REDUCTION_COLLECTIVE, DT_FLOAT,
+                                   TensorShape({8}));
+  core::RefCountPtr<HierarchicalRingReducer> reducer(
+      new HierarchicalRingReducer());
+  Status s = reducer->InitializeCollectiveParams(cp.get());
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
+#include <algorithm>
+
 #include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
@@ -31,6 +35,17 @@ namespace {
 bool IsInitializationOp(const Node* node) {
   return node->op_def().allows_uninitialized_input();
 }
+
+// Returns true if `item` is a synchronous kernel that the executor may run
+// back to back with its producer or consumer, without any control flow,
+// transfer or reference semantics between them.
+bool CanRunInChain(const NodeItem& item) {
+  return !item.kernel_is_async && !item.is_merge &&
+         !item.is_enter_exit_or_next_iter && !item.is_control_trigger &&
+         !item.is_source && !item.is_transfer_node && !item.is_recv_or_switch &&
+         !item.is_noop && !item.is_distributed_communication &&
+         !item.is_any_input_ref_typed && item.const_tensor == nullptr;
+}
 }  // namespace
 
 ImmutableExecutorState::~ImmutableExecutorState() {
@@ -196,6 +211,12 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     item->is_next_iteration = IsNextIteration(n);
     item->is_distributed_communication = IsDistributedCommunication(n);
 
+    int32 priority = IsSend(n) ? kSendNodePriority : 0;
+    has_priorities_ |=
+        TryGetNodeAttr(n->attrs(), kExecutorPriorityAttr, &priority);
+    item->priority = static_cast<int16>(
+        std::min<int32>(std::max<int32>(priority, kint16min), kint16max));
+
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
     // that frame's pending counts data structure that has enough
@@ -255,6 +276,27 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     }
   }
 
+  // Find the linear chains of CPU nodes, in which a node's only output feeds
+  // a node that has no other inputs, so that the executor can run each chain
+  // without propagating its intermediate outputs.
+  if (params_.device->device_type() == DEVICE_CPU) {
+    for (const Node* n : graph.nodes()) {
+      if (IsSink(n) || n->num_outputs() != 1 || n->out_edges().size() != 1) {
+        continue;
+      }
+      const Edge* e = *n->out_edges().begin();
+      const Node* dst = e->dst();
+      if (e->IsControlEdge() || IsSink(dst) || dst->in_edges().size() != 1) {
+        continue;
+      }
+      NodeItem* item = gview_.node(n->id());
+      NodeItem* dst_item = gview_.node(dst->id());
+      if (CanRunInChain(*item) && CanRunInChain(*dst_item)) {
+        item->chain_successor = dst_item;
+      }
+    }
+  }
+
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
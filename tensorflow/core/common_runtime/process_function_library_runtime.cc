@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 
+#include <deque>
 #include <iterator>
+#include <map>
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
@@ -47,9 +49,12 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/reffed_status_callback.h"
 #if !defined(IS_MOBILE_PLATFORM)
@@ -627,6 +632,137 @@ Status ValidateMultiDeviceOptions(
   return Status::OK();
 }
 
+// A multi-device function graph after all optimization passes, placement
+// and partitioning, in a form that other runtimes can instantiate.
+struct OptimizedFunctionGraph {
+  // The function library after running the optimization passes.
+  FunctionDefLibrary library;
+  // Partitioned graphs, keyed by device name.
+  std::unordered_map<string, GraphDef> partitions;
+  std::unordered_map<string, string> node_name_to_control_ret;
+};
+
+// Process-wide cache of OptimizedFunctionGraphs. Every EagerContext and
+// DirectSession owns its own ProcessFunctionLibraryRuntime, so without it the
+// same function is optimized and partitioned again by each of them.
+class OptimizedFunctionGraphCache {
+ public:
+  static OptimizedFunctionGraphCache* Global() {
+    static OptimizedFunctionGraphCache* cache =
+        new OptimizedFunctionGraphCache;
+    return cache;
+  }
+
+  std::shared_ptr<const OptimizedFunctionGraph> Lookup(const Fprint128& key) {
+    tf_shared_lock l(mu_);
+    auto it = graphs_.find(key);
+    return it == graphs_.end() ? nullptr : it->second;
+  }
+
+  // Evicts the oldest entry once kMaxEntries graphs are cached.
+  void Insert(const Fprint128& key,
+              std::shared_ptr<const OptimizedFunctionGraph> graph) {
+    mutex_lock l(mu_);
+    if (!graphs_.emplace(key, std::move(graph)).second) return;
+    insertion_order_.push_back(key);
+    if (insertion_order_.size() > kMaxEntries) {
+      graphs_.erase(insertion_order_.front());
+      insertion_order_.pop_front();
+    }
+  }
+
+ private:
+  static constexpr size_t kMaxEntries = 1024;
+
+  mutex mu_;
+  std::unordered_map<Fprint128, std::shared_ptr<const OptimizedFunctionGraph>,
+                     Fprint128Hasher>
+      graphs_ TF_GUARDED_BY(mu_);
+  std::deque<Fprint128> insertion_order_ TF_GUARDED_BY(mu_);
+};
+
+bool ShareFunctionGraphsAcrossRuntimes() {
+  bool share = false;
+  Status s = ReadBoolFromEnvVar("TF_SHARE_FUNCTION_GRAPHS_ACROSS_RUNTIMES",
+                                false, &share);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return false;
+  }
+  return share;
+}
+
+// Fingerprints everything the optimized graph of a multi-device function
+// depends on. Unlike the function key, it identifies the function library by
+// its contents rather than by address, so it matches across runtimes.
+Fprint128 OptimizedFunctionGraphCacheKey(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const FunctionLibraryDefinition& reachable_lib_def,
+    const DeviceSet& dev_set,
+    const std::vector<CompositeDevice*>& composite_devices) {
+  FunctionLibraryRuntime::InstantiateOptions key_options = options;
+  key_options.lib_def = nullptr;
+  key_options.state_handle.clear();
+  string key = Canonicalize(function_name, attrs, key_options);
+  strings::StrAppend(&key, "|", options.is_component_function, ",",
+                     options.default_device_to_target, ",",
+                     options.optimize_graph_fn != nullptr);
+  const std::map<string, const std::vector<string>*> input_composite_devices(
+      options.composite_devices.begin(), options.composite_devices.end());
+  for (const auto& it : input_composite_devices) {
+    strings::StrAppend(&key, "|", it.first, "=",
+                       absl::StrJoin(*it.second, ","));
+  }
+  std::vector<string> devices;
+  for (const Device* d : dev_set.devices()) {
+    devices.push_back(strings::StrCat(d->name(), ":", d->device_type()));
+  }
+  std::sort(devices.begin(), devices.end());
+  strings::StrAppend(&key, "|", absl::StrJoin(devices, ","));
+  for (const CompositeDevice* d : composite_devices) {
+    strings::StrAppend(&key, "|", d->name(), "=",
+                       absl::StrJoin(*d->underlying_devices(), ","));
+  }
+  string serialized_lib;
+  SerializeToStringDeterministic(reachable_lib_def.ToProto(), &serialized_lib);
+  return FingerprintCat128(Fingerprint128(key), Fingerprint128(serialized_lib));
+}
+
+// Converts the cached partitions back to graphs for this runtime.
+Status RestoreFunctionGraphPartitions(
+    const OptimizedFunctionGraph& cached, const DeviceSet& dev_set,
+    const FunctionLibraryDefinition* lib_def,
+    std::unordered_map<string, std::unique_ptr<Graph>>* subgraphs) {
+  for (const auto& partition : cached.partitions) {
+    GraphDef graph_def = partition.second;
+    // Send/Recv pairs across partitions name the incarnation of the sending
+    // device, which is specific to the runtime that owns it.
+    for (NodeDef& node : *graph_def.mutable_node()) {
+      auto incarnation = node.mutable_attr()->find("send_device_incarnation");
+      const AttrValue* send_device_name =
+          gtl::FindOrNull(node.attr(), "send_device");
+      if (incarnation == node.mutable_attr()->end() ||
+          send_device_name == nullptr) {
+        continue;
+      }
+      const Device* send_device =
+          dev_set.FindDeviceByName(send_device_name->s());
+      if (send_device != nullptr) {
+        incarnation->second.set_i(send_device->attributes().incarnation());
+      }
+    }
+    std::unique_ptr<Graph> subgraph(new Graph(lib_def));
+    GraphConstructorOptions opts;
+    opts.allow_internal_ops = true;
+    opts.expect_device_spec = true;
+    TF_RETURN_IF_ERROR(
+        ConvertGraphDefToGraph(opts, std::move(graph_def), subgraph.get()));
+    subgraphs->emplace(partition.first, std::move(subgraph));
+  }
+  return Status::OK();
+}
+
 }  // anonymous namespace
 
 Status GetGraphAndArgRets(
@@ -665,97 +801,21 @@ Status GetGraphAndArgRets(
   return Status::OK();
 }
 
-Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
-    const string& function_name, AttrSlice attrs,
+Status ProcessFunctionLibraryRuntime::OptimizeAndPartitionFunctionGraph(
+    const string& function_name, const FunctionDef& fdef,
+    const FunctionLibraryDefinition& lib_def,
     const FunctionLibraryRuntime::InstantiateOptions& options,
-    FunctionLibraryRuntime::Handle* handle) {
-  // Check if this function has already been instantiated.
-  const string& function_key = Canonicalize(function_name, attrs, options);
-
-  {
-    mutex_lock l(mu_);
-    const auto& it = table_.find(function_key);
-    if (it != table_.end()) {
-      *handle = it->second;
-      ++mdevice_data_[*handle]->instantiation_counter_;
-      return Status::OK();
-    }
-  }
-
-  VLOG(1) << "Instantiating MultiDevice function \"" << function_name
-          << "\" on default device \"" << options.target << "\"";
-  if (VLOG_IS_ON(3)) {
-    int index = 0;
-    VLOG(3) << "Requested input devices:";
-    for (const string& device : options.input_devices) {
-      VLOG(3) << "    [input " << index++ << "] " << device;
-    }
-    index = 0;
-    VLOG(3) << "Requested output devices:";
-    for (const string& device : options.output_devices) {
-      VLOG(3) << "    [output " << index++ << "] " << device;
-    }
-  }
-
-  const FunctionLibraryDefinition* lib_def =
-      options.lib_def == nullptr ? lib_def_ : options.lib_def;
-
-  const FunctionDef* fdef = lib_def->Find(function_name);
-  if (fdef == nullptr) {
-    return errors::InvalidArgument("Failed to find function \"", function_name,
-                                   "\" in function library: ", lib_def);
-  }
-
-  TF_RETURN_IF_ERROR(ValidateMultiDeviceOptions(*fdef, options));
-
-  std::unique_ptr<Graph> graph;
-  std::vector<Node*> arg_nodes, ret_nodes;
-  std::vector<string> ret_node_names;
-  DataTypeVector ret_types;
-  std::vector<string> control_ret_node_names;
-
-  TF_RETURN_IF_ERROR(GetGraphAndArgRets(
-      function_name, attrs, fdef, lib_def, &graph, &arg_nodes, &ret_nodes,
-      &ret_node_names, &ret_types, &control_ret_node_names));
-
-  if (options.graph_collector != nullptr) {
-    GraphDef def;
-    graph->ToGraphDef(&def);
-    *def.mutable_library() = lib_def->ReachableDefinitions(def).ToProto();
-    options.graph_collector->CollectRawGraph(def);
-  }
-
-  Device* default_device = nullptr;
-  if (options.default_device_to_target && !options.target.empty()) {
-    // Make the `target` device the default device if nothing else is hard
-    // coded. This allows the same function definition to be specialized to
-    // different devices depending on the `PartitionedCallOp` device.
-    FunctionLibraryRuntime* flr = GetFLR(options.target);
-    if (flr == nullptr) {
-      return errors::InvalidArgument(
-          "Cannot instantiate multi-device function with target device ",
-          options.target);
-    }
-    default_device = flr->device();
-  }
-  const std::shared_ptr<DeviceSet> dev_set = device_set();
-
-  TF_RETURN_IF_ERROR(
-      SetArgShape(options.input_resource_dtypes_and_shapes, arg_nodes));
-  TF_RETURN_IF_ERROR(PinArgsAndRets(
-      options.input_devices, options.output_devices, *dev_set, arg_nodes,
-      ret_nodes, lib_def_,
-      options.config_proto.allow_soft_placement() ? default_device : nullptr));
-
-  auto data = absl::make_unique<MultiDeviceFunctionData>(
-      function_name, function_key, ret_node_names.size(),
-      lib_def->ReachableDefinitions(*fdef), std::move(ret_types));
-
+    const DeviceSet& dev_set, Device* default_device,
+    std::vector<string> ret_node_names,
+    std::vector<string> control_ret_node_names, std::unique_ptr<Graph> graph,
+    FunctionLibraryDefinition* data_lib_def,
+    std::unordered_map<string, string>* node_name_to_control_ret,
+    std::unordered_map<string, std::unique_ptr<Graph>>* subgraphs) {
   // The runtime shouldn't depend on duplication between the function library
   // owned by the graph and the one owned by the runtime. To ensure this, for
   // now we ensure that the graph function library is empty and the runtime
   // library receives the query from LookUps on the graph function library.
-  graph->mutable_flib_def()->set_default_registry(&data->lib_def_);
+  graph->mutable_flib_def()->set_default_registry(data_lib_def);
   graph->mutable_flib_def()->Clear();
 
   // Do not run function/graph optimization passes for component functions,
@@ -767,13 +827,10 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
             << function_name;
   }
 
-  // Mapping from a function body node name to the control output name.
-  std::unordered_map<string, string> node_name_to_control_ret;
-
   bool control_rets_updated = false;
   if (should_run_optimization_passes) {
     TF_RETURN_IF_ERROR(FunctionOptimizationPassRegistry::Global().Run(
-        *dev_set, options.config_proto, &graph, &data->lib_def_,
+        dev_set, options.config_proto, &graph, data_lib_def,
         &control_ret_node_names, &control_rets_updated));
   }
 
@@ -781,11 +838,11 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     // Function graph pass may have resulted in different nodes/node names for
     // control rets.
     for (const auto& control_ret : control_ret_node_names) {
-      node_name_to_control_ret.emplace(control_ret, control_ret);
+      node_name_to_control_ret->emplace(control_ret, control_ret);
     }
   } else {
-    for (const auto& control_ret : fdef->control_ret()) {
-      node_name_to_control_ret.emplace(control_ret.second, control_ret.first);
+    for (const auto& control_ret : fdef.control_ret()) {
+      node_name_to_control_ret->emplace(control_ret.second, control_ret.first);
     }
   }
 
@@ -796,8 +853,8 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   session_options.config = options.config_proto;
   optimization_options.session_options = &session_options;
   optimization_options.graph = &graph;
-  optimization_options.flib_def = &data->lib_def_;
-  optimization_options.device_set = dev_set.get();
+  optimization_options.flib_def = data_lib_def;
+  optimization_options.device_set = &dev_set;
   optimization_options.is_function_graph = true;
   std::vector<CompositeDevice*> composite_devices;
   {
@@ -806,7 +863,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   }
   optimization_options.composite_devices = &composite_devices;
   optimization_options.default_function_device = default_device;
-  optimization_options.function_def = fdef;
+  optimization_options.function_def = &fdef;
 
   DumpGraph("Before running PRE_PLACEMENT passes", graph.get());
   if (should_run_optimization_passes) {
@@ -818,7 +875,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   // exceptions/warnings in case where nested function call options are ignored.
   DumpGraph("Before calling Placer", graph.get());
   Placer placer(graph.get(), function_name, optimization_options.flib_def,
-                dev_set.get(), default_device,
+                &dev_set, default_device,
                 options.config_proto.allow_soft_placement(),
                 options.config_proto.log_device_placement());
   TF_RETURN_IF_ERROR(placer.Run());
@@ -836,7 +893,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     DumpGraph("Before running graph optimization fn", graph.get());
     Status status = options.optimize_graph_fn(
         std::move(ret_node_names), std::move(control_ret_node_names),
-        &data->lib_def_, *dev_set, cpu_device, &graph);
+        data_lib_def, dev_set, cpu_device, &graph);
     if (!status.ok()) {
       LOG(WARNING) << "Ignoring multi-device function optimization failure: "
                    << status.ToString();
@@ -861,25 +918,24 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   if (options.graph_collector != nullptr) {
     GraphDef def;
     graph->ToGraphDef(&def);
-    *def.mutable_library() = lib_def->ReachableDefinitions(def).ToProto();
+    *def.mutable_library() = lib_def.ReachableDefinitions(def).ToProto();
     options.graph_collector->CollectOptimizedGraph(def);
   }
 
   VLOG(4) << "Main function graph to be partitioned:";
   VLOG(4) << DebugString(graph->ToGraphDefDebug());
 
-  std::unordered_map<string, std::unique_ptr<Graph>> subgraphs;
   TF_RETURN_IF_ERROR(
-      PartitionFunctionGraph(*dev_set, std::move(graph), &subgraphs));
+      PartitionFunctionGraph(dev_set, std::move(graph), subgraphs));
 
-  for (const auto& pair : subgraphs) {
+  for (const auto& pair : *subgraphs) {
     DumpGraph(strings::StrCat("Before running POST_PARTITIONING passes (",
                               pair.first, ")"),
               pair.second.get());
   }
   optimization_options.graph = nullptr;
   optimization_options.device_set = nullptr;
-  optimization_options.partition_graphs = &subgraphs;
+  optimization_options.partition_graphs = subgraphs;
   // Normally POST_PARTITIONING passes are run by distributed workers.
   // Distributed workers are currently not supported in this code path, so we
   // run the passes here.
@@ -887,7 +943,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
         OptimizationPassRegistry::POST_PARTITIONING, optimization_options));
   }
-  for (const auto& pair : subgraphs) {
+  for (const auto& pair : *subgraphs) {
     const auto* optimized_subgraph = pair.second.get();
     DumpGraph(
         strings::StrCat("After all optimization passes (", pair.first, ")"),
@@ -902,14 +958,156 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   }
 
   if (options.graph_collector != nullptr) {
-    for (const auto& pair : subgraphs) {
+    for (const auto& pair : *subgraphs) {
       GraphDef def;
       pair.second->ToGraphDef(&def);
-      *def.mutable_library() = lib_def->ReachableDefinitions(def).ToProto();
+      *def.mutable_library() = lib_def.ReachableDefinitions(def).ToProto();
       options.graph_collector->CollectPartitionedGraph(def);
     }
   }
 
+  return Status::OK();
+}
+
+Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    FunctionLibraryRuntime::Handle* handle) {
+  // Check if this function has already been instantiated.
+  const string& function_key = Canonicalize(function_name, attrs, options);
+
+  {
+    mutex_lock l(mu_);
+    const auto& it = table_.find(function_key);
+    if (it != table_.end()) {
+      *handle = it->second;
+      ++mdevice_data_[*handle]->instantiation_counter_;
+      return Status::OK();
+    }
+  }
+
+  VLOG(1) << "Instantiating MultiDevice function \"" << function_name
+          << "\" on default device \"" << options.target << "\"";
+  if (VLOG_IS_ON(3)) {
+    int index = 0;
+    VLOG(3) << "Requested input devices:";
+    for (const string& device : options.input_devices) {
+      VLOG(3) << "    [input " << index++ << "] " << device;
+    }
+    index = 0;
+    VLOG(3) << "Requested output devices:";
+    for (const string& device : options.output_devices) {
+      VLOG(3) << "    [output " << index++ << "] " << device;
+    }
+  }
+
+  const FunctionLibraryDefinition* lib_def =
+      options.lib_def == nullptr ? lib_def_ : options.lib_def;
+
+  const FunctionDef* fdef = lib_def->Find(function_name);
+  if (fdef == nullptr) {
+    return errors::InvalidArgument("Failed to find function \"", function_name,
+                                   "\" in function library: ", lib_def);
+  }
+
+  TF_RETURN_IF_ERROR(ValidateMultiDeviceOptions(*fdef, options));
+
+  std::unique_ptr<Graph> graph;
+  std::vector<Node*> arg_nodes, ret_nodes;
+  std::vector<string> ret_node_names;
+  DataTypeVector ret_types;
+  std::vector<string> control_ret_node_names;
+
+  TF_RETURN_IF_ERROR(GetGraphAndArgRets(
+      function_name, attrs, fdef, lib_def, &graph, &arg_nodes, &ret_nodes,
+      &ret_node_names, &ret_types, &control_ret_node_names));
+
+  if (options.graph_collector != nullptr) {
+    GraphDef def;
+    graph->ToGraphDef(&def);
+    *def.mutable_library() = lib_def->ReachableDefinitions(def).ToProto();
+    options.graph_collector->CollectRawGraph(def);
+  }
+
+  Device* default_device = nullptr;
+  if (options.default_device_to_target && !options.target.empty()) {
+    // Make the `target` device the default device if nothing else is hard
+    // coded. This allows the same function definition to be specialized to
+    // different devices depending on the `PartitionedCallOp` device.
+    FunctionLibraryRuntime* flr = GetFLR(options.target);
+    if (flr == nullptr) {
+      return errors::InvalidArgument(
+          "Cannot instantiate multi-device function with target device ",
+          options.target);
+    }
+    default_device = flr->device();
+  }
+  const std::shared_ptr<DeviceSet> dev_set = device_set();
+
+  TF_RETURN_IF_ERROR(
+      SetArgShape(options.input_resource_dtypes_and_shapes, arg_nodes));
+  TF_RETURN_IF_ERROR(PinArgsAndRets(
+      options.input_devices, options.output_devices, *dev_set, arg_nodes,
+      ret_nodes, lib_def_,
+      options.config_proto.allow_soft_placement() ? default_device : nullptr));
+
+  FunctionLibraryDefinition reachable_lib_def =
+      lib_def->ReachableDefinitions(*fdef);
+
+  // Optimized and partitioned function graphs may be shared with other
+  // runtimes in this process, see OptimizedFunctionGraphCache.
+  std::shared_ptr<const OptimizedFunctionGraph> cached_graph;
+  Fprint128 cache_key = {0, 0};
+  const bool use_graph_cache = options.graph_collector == nullptr &&
+                               ShareFunctionGraphsAcrossRuntimes();
+  if (use_graph_cache) {
+    std::vector<CompositeDevice*> composite_devices;
+    {
+      tf_shared_lock l(mu_);
+      composite_devices = composite_devices_;
+    }
+    cache_key = OptimizedFunctionGraphCacheKey(function_name, attrs, options,
+                                               reachable_lib_def, *dev_set,
+                                               composite_devices);
+    cached_graph = OptimizedFunctionGraphCache::Global()->Lookup(cache_key);
+  }
+
+  std::unique_ptr<MultiDeviceFunctionData> data;
+  // Mapping from a function body node name to the control output name.
+  std::unordered_map<string, string> node_name_to_control_ret;
+  std::unordered_map<string, std::unique_ptr<Graph>> subgraphs;
+  if (cached_graph != nullptr) {
+    VLOG(1) << "Reusing optimized graph of multi-device function \""
+            << function_name << "\"";
+    data = absl::make_unique<MultiDeviceFunctionData>(
+        function_name, function_key, ret_node_names.size(),
+        FunctionLibraryDefinition(reachable_lib_def.default_registry(),
+                                  cached_graph->library),
+        std::move(ret_types));
+    node_name_to_control_ret = cached_graph->node_name_to_control_ret;
+    TF_RETURN_IF_ERROR(RestoreFunctionGraphPartitions(
+        *cached_graph, *dev_set, &data->lib_def_, &subgraphs));
+  } else {
+    data = absl::make_unique<MultiDeviceFunctionData>(
+        function_name, function_key, ret_node_names.size(),
+        std::move(reachable_lib_def), std::move(ret_types));
+    TF_RETURN_IF_ERROR(OptimizeAndPartitionFunctionGraph(
+        function_name, *fdef, *lib_def, options, *dev_set, default_device,
+        std::move(ret_node_names), std::move(control_ret_node_names),
+        std::move(graph), &data->lib_def_, &node_name_to_control_ret,
+        &subgraphs));
+    if (use_graph_cache) {
+      auto optimized = std::make_shared<OptimizedFunctionGraph>();
+      optimized->library = data->lib_def_.ToProto();
+      for (const auto& pair : subgraphs) {
+        pair.second->ToGraphDef(&optimized->partitions[pair.first]);
+      }
+      optimized->node_name_to_control_ret = node_name_to_control_ret;
+      OptimizedFunctionGraphCache::Global()->Insert(cache_key,
+                                                    std::move(optimized));
+    }
+  }
+
   // We must preserve control returns in each of the function components,
   // otherwise after function inlining we might prune side-effectful nodes.
   const auto control_ret =
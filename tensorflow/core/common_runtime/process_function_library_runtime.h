@@ -379,6 +379,20 @@ class ProcessFunctionLibraryRuntime {
       const FunctionLibraryRuntime::InstantiateOptions& options,
       FunctionLibraryRuntime::Handle* handle);
 
+  // Runs the function and graph optimization passes and the placer on the
+  // body `graph` of a multi-device function, then partitions it by device
+  // into `subgraphs`. Functions added by the passes go to `data_lib_def`.
+  Status OptimizeAndPartitionFunctionGraph(
+      const string& function_name, const FunctionDef& fdef,
+      const FunctionLibraryDefinition& lib_def,
+      const FunctionLibraryRuntime::InstantiateOptions& options,
+      const DeviceSet& dev_set, Device* default_device,
+      std::vector<string> ret_node_names,
+      std::vector<string> control_ret_node_names, std::unique_ptr<Graph> graph,
+      FunctionLibraryDefinition* data_lib_def,
+      std::unordered_map<string, string>* node_name_to_control_ret,
+      std::unordered_map<string, std::unique_ptr<Graph>>* subgraphs);
+
   void InstantiateRemote(
       const string& function_name, AttrSlice attrs,
       const FunctionLibraryRuntime::InstantiateOptions& options,
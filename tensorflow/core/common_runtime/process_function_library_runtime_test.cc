@@ -803,6 +803,23 @@ FunctionDef AddVarAcrossDevices() {
 }
 
 // An implementation of FunctionArgsInterface for packed inputs.
+TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_SharedFunctionGraphs) {
+  setenv("TF_SHARE_FUNCTION_GRAPHS_ACROSS_RUNTIMES", "true", 1);
+  // The second runtime reuses the graph optimized and partitioned by the
+  // first one, including the Send/Recv pair between the two CPUs.
+  const auto inst_opts = MakeOptions("CPU:0", {"CPU:0"}, {"CPU:1"});
+  for (int i = 0; i < 2; ++i) {
+    Init({test::function::XTimesTwo()});
+    FunctionLibraryRuntime::Options opts;
+    Tensor x = test::AsTensor<float>({1, 2, 3, 4});
+    Tensor y;
+    TF_CHECK_OK(
+        Run("XTimesTwo", opts, {{"T", DT_FLOAT}}, inst_opts, {x}, {&y}));
+    test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+  }
+  unsetenv("TF_SHARE_FUNCTION_GRAPHS_ACROSS_RUNTIMES");
+}
+
 class TestFunctionPackedArgs : public FunctionArgsInterface {
  public:
   TestFunctionPackedArgs(const int index,
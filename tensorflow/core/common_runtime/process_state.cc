@@ -76,9 +76,12 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     // depending on env var setting.
     const bool alloc_visitors_defined =
         (!cpu_alloc_visitors_.empty() || !cpu_free_visitors_.empty());
+    // NUMA-specific allocators default to BFC so that freed node-local memory
+    // is reused on the same node instead of being returned to the system.
     bool use_bfc_allocator = false;
-    Status status = ReadBoolFromEnvVar(
-        "TF_CPU_ALLOCATOR_USE_BFC", alloc_visitors_defined, &use_bfc_allocator);
+    Status status = ReadBoolFromEnvVar("TF_CPU_ALLOCATOR_USE_BFC",
+                                       alloc_visitors_defined || numa_enabled_,
+                                       &use_bfc_allocator);
     if (!status.ok()) {
       LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
     }
@@ -100,9 +103,20 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
       }
       int64 cpu_mem_limit = cpu_mem_limit_in_mb * (1LL << 20);
       DCHECK(sub_allocator);
-      allocator =
-          new BFCAllocator(sub_allocator, cpu_mem_limit, /*allow_growth=*/true,
-                           /*name=*/"bfc_cpu_allocator_for_gpu");
+      int64 small_alloc_cache_stripes = 0;
+      status = ReadInt64FromEnvVar("TF_CPU_BFC_SMALL_ALLOC_CACHE_STRIPES",
+                                   0 /*disabled by default*/,
+                                   &small_alloc_cache_stripes);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
+      }
+      BFCAllocator* bfc_allocator = new BFCAllocator(
+          sub_allocator, cpu_mem_limit, /*allow_growth=*/true,
+          /*name=*/numa_enabled_
+              ? strings::StrCat("bfc_cpu_allocator_numa_", numa_node)
+              : "bfc_cpu_allocator_for_gpu");
+      bfc_allocator->EnableSmallChunkCache(small_alloc_cache_stripes);
+      allocator = bfc_allocator;
       VLOG(2) << "Using BFCAllocator with memory limit of "
               << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator";
     } else if (sub_allocator) {
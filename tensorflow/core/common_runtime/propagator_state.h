@@ -87,6 +87,13 @@ class PropagatorState {
     TaggedNodeReadyQueue() : front_index_(0) {}
 
     void push_back(const TaggedNode& node) { ready_.push_back(node); }
+    void push_front(const TaggedNode& node) {
+      if (front_index_ > 0) {
+        ready_[--front_index_] = node;
+      } else {
+        ready_.insert(ready_.begin(), node);
+      }
+    }
     TaggedNode front() const {
       DCHECK_LT(front_index_, ready_.size());
       return ready_[front_index_];
@@ -445,6 +452,18 @@ class PropagatorState {
            tagged_node.node_item->input_start;
   }
 
+  // Moves `*output`, the only output of `*tagged_node`, to the input of its
+  // `NodeItem::chain_successor`, and makes `*tagged_node` refer to the
+  // successor. The successor is in the same frame and iteration, and is not
+  // activated, so the caller must run it in place of the completed node.
+  void ForwardToChainSuccessor(TaggedNode* tagged_node, Entry* output) const
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    const NodeItem* successor = tagged_node->node_item->chain_successor;
+    tagged_node->input_iter->input_tensors[successor->input_start] =
+        std::move(*output);
+    tagged_node->node_item = successor;
+  }
+
   FrameAndIter GetFrameAndIter(const TaggedNode& tagged_node) const {
     return {tagged_node.input_frame->frame_id,
             tagged_node.input_iter->iter_num};
@@ -29,10 +29,14 @@ namespace tensorflow {
 // session.
 class RenamedDevice : public Device {
  public:
+  // If `allocator` is not null, it serves requests with default allocator
+  // attributes instead of the underlying device's allocator. It is not owned
+  // and must outlive the returned device.
   static std::unique_ptr<Device> NewRenamedDevice(
       const string& new_base, Device* underlying, bool owns_underlying,
       bool isolate_session_state,
-      thread::ThreadPoolInterface* underlying_threadpool = nullptr);
+      thread::ThreadPoolInterface* underlying_threadpool = nullptr,
+      Allocator* allocator = nullptr);
 
   ~RenamedDevice() override;
 
@@ -55,6 +59,9 @@ class RenamedDevice : public Device {
   }
 
   Allocator* GetAllocator(AllocatorAttributes attr) override {
+    if (allocator_ != nullptr && attr.value == 0) {
+      return allocator_;
+    }
     return underlying_device_->GetAllocator(attr);
   }
 
@@ -156,8 +163,10 @@ class RenamedDevice : public Device {
  private:
   RenamedDevice(Device* underlying, const DeviceAttributes& attributes,
                 bool owns_underlying, bool isolate_session_state,
-                thread::ThreadPoolInterface* underlying_threadpool);
+                thread::ThreadPoolInterface* underlying_threadpool,
+                Allocator* allocator);
   Device* const underlying_device_;
+  Allocator* const allocator_;  // Not owned. May be null.
   const bool owns_underlying_device_;
   const bool isolate_session_state_;
 
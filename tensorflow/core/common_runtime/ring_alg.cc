@@ -404,11 +404,13 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  const Tensor* src_tensor =
+      col_params_->wire_encode_op ? &rf->wire_chunk : &rf->chunk;
   col_ctx_->col_exec->remote_access()->PostToPeer(
       col_params_->group.device_names[send_to_dev_idx],
       col_params_->group.task_names[send_to_dev_idx], send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), src_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
       done);
 }
@@ -424,6 +426,9 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  if (col_params_->wire_encode_op) {
+    dst_tensor = &rf->wire_chunk;
+  }
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.device_names[rf->recv_dev_idx],
       col_params_->group.task_names[rf->recv_dev_idx],
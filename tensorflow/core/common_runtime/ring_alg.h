@@ -75,6 +75,7 @@ class RingAlg : public CollectiveImplementationInterface {
     bool is_final = false;  // is the last field in the pass for this rank
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
+    Tensor wire_chunk;  // chunk in the wire data type, if it differs
     Status status;
     string DebugString() const;
   };
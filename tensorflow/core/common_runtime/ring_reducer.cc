@@ -164,11 +164,67 @@ void RingReducer::ContinueAfterInputCopy() {
 void RingReducer::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
                                 int field_idx) {
   RingAlg::InitRingField(rf, chunk_idx, subdiv_idx, field_idx);
-  if (rf->do_recv) {
+  if (col_params_->wire_encode_op) {
+    // Values are received in the wire data type, and decoded into a new
+    // tensor before being reduced.
+    if (rf->do_send || rf->do_recv) {
+      rf->wire_chunk = Tensor(
+          col_ctx_->device->GetAllocator(
+              col_ctx_->op_ctx->output_alloc_attr(0)),
+          col_params_->wire_encode_op->output_type(0),
+          TensorShape({rf->chunk.NumElements()}));
+    }
+  } else if (rf->do_recv) {
     rf->tmp_chunk = ca_->TempChunk(rf->sc_idx);
   }
 }
 
+Status RingReducer::EncodeChunk(RingField* rf) {
+  if (!col_params_->wire_encode_op) {
+    return Status::OK();
+  }
+  TF_RETURN_IF_ERROR(collective_util::ComputeUnaryOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->wire_encode_op, &rf->chunk, &rf->wire_chunk));
+  if (rf->second_pass) {
+    return DecodeIntoChunk(rf);
+  }
+  return Status::OK();
+}
+
+Status RingReducer::DecodeChunk(RingField* rf) {
+  if (!col_params_->wire_encode_op) {
+    return Status::OK();
+  }
+  if (rf->second_pass) {
+    return DecodeIntoChunk(rf);
+  }
+  return collective_util::ComputeUnaryOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->wire_decode_op, &rf->wire_chunk, &rf->tmp_chunk);
+}
+
+Status RingReducer::DecodeIntoChunk(RingField* rf) {
+  Tensor decoded;
+  TF_RETURN_IF_ERROR(collective_util::ComputeUnaryOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->wire_decode_op, &rf->wire_chunk, &decoded));
+  // `rf->chunk` aliases the output, so copy the decoded value into it.
+  Notification note;
+  Status status;
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->op_device_context(), col_ctx_->device, col_ctx_->device,
+      col_ctx_->op_ctx->output_alloc_attr(0),
+      col_ctx_->op_ctx->output_alloc_attr(0), &decoded, &rf->chunk,
+      0 /*dev_to_dev_stream_index*/, [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
 // At the beginning of the algorithm initialize a RingField struct for
 // every independent field of the tensor.
 bool RingReducer::RunAsyncParts() {
@@ -254,15 +310,24 @@ bool RingReducer::RunAsyncParts() {
             --recv_pending_count;
             if (!rf->second_pass) {
               rf->action = RF_REDUCE;
-              Status s = collective_util::ComputeBinOp(
-                  col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
-                  col_params_->merge_op, &rf->chunk, &rf->tmp_chunk);
+              Status s = DecodeChunk(rf);
+              if (s.ok()) {
+                s = collective_util::ComputeBinOp(
+                    col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+                    col_params_->merge_op, &rf->chunk, &rf->tmp_chunk);
+              }
               if (!s.ok()) {
                 aborted = true;
                 StartAbort(s);
               }
             } else {
               rf->action = RF_SEND_READY;
+              // The received wire chunk is forwarded as is, if it is sent on.
+              Status s = DecodeChunk(rf);
+              if (!s.ok()) {
+                aborted = true;
+                StartAbort(s);
+              }
             }
             break;
           case RF_REDUCE:
@@ -285,6 +350,14 @@ bool RingReducer::RunAsyncParts() {
             break;
           case RF_SEND_READY:
             if (rf->do_send) {
+              if (!rf->second_pass || !rf->do_recv) {
+                Status s = EncodeChunk(rf);
+                if (!s.ok()) {
+                  aborted = true;
+                  StartAbort(s);
+                  break;
+                }
+              }
               rf->action = RF_SEND;
               auto send_complete = [this, rf, &ready_queue,
                                     &aborted](Status s) {
@@ -49,9 +49,21 @@ class RingReducer : public RingAlg {
   void ContinueAfterInputCopy();
   bool RunAsyncParts();
 
+  // If the values are cast for transfer, sets `rf->wire_chunk` to the value of
+  // `rf->chunk` in the wire data type.  In the second pass, also replaces the
+  // value of `rf->chunk` with the value the other devices receive, so that all
+  // devices end up with the same result.
+  Status EncodeChunk(RingField* rf);
+  // Casts `rf->wire_chunk` back to the data type of the reduction into
+  // `rf->tmp_chunk` in the first pass and into `rf->chunk` in the second.
+  Status DecodeChunk(RingField* rf);
+  // Overwrites `rf->chunk` with the decoded value of `rf->wire_chunk`.
+  Status DecodeIntoChunk(RingField* rf);
+
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
 
+  friend class HierarchicalRingReducer;
   friend class RingReducerTest;
   friend class RingReducerInitParamsTest;
 };
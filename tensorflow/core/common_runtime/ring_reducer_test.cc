@@ -79,6 +79,18 @@ std::unique_ptr<OpKernel> GetDiv(DataType dtype, const DeviceType& device_type,
   return GetKernel(node_def, device_type, device);
 }
 
+std::unique_ptr<OpKernel> GetCast(DataType src_type, DataType dst_type,
+                                  const DeviceType& device_type,
+                                  DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder("cast_node", "Cast");
+  TF_CHECK_OK(builder.Attr("SrcT", src_type)
+                  .Attr("DstT", dst_type)
+                  .Input(FakeInput(src_type))
+                  .Finalize(&node_def));
+  return GetKernel(node_def, device_type, device);
+}
+
 class RingReducerTest : public ::testing::Test {
  protected:
   void Init(int num_workers, int num_devices, DataType dtype,
@@ -182,6 +194,17 @@ class RingReducerTest : public ::testing::Test {
       init_f(&tensor_);
     }
 
+    // Casts values to `wire_type` for transfer.
+    void SetWireType(DataType wire_type) {
+      DataType dtype = col_params_->instance.data_type;
+      wire_encode_op_ =
+          GetCast(dtype, wire_type, test_env_->device_type, device_);
+      wire_decode_op_ =
+          GetCast(wire_type, dtype, test_env_->device_type, device_);
+      col_params_->wire_encode_op = wire_encode_op_.get();
+      col_params_->wire_decode_op = wire_decode_op_.get();
+    }
+
     void DoReduce() {
       status_ = RunCollective(test_env_, col_params_.get(), device_, &tensor_,
                               &tensor_);
@@ -195,6 +218,8 @@ class RingReducerTest : public ::testing::Test {
     core::RefCountPtr<CollectiveParams> col_params_;
     std::unique_ptr<OpKernel> merge_op_;
     std::unique_ptr<OpKernel> final_op_;
+    std::unique_ptr<OpKernel> wire_encode_op_;
+    std::unique_ptr<OpKernel> wire_decode_op_;
     Status status_;
   };
 
@@ -428,6 +453,64 @@ DEF_TEST(INT64, CPU, 2, 8, 3, 4095, 0)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 1)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 7)
 DEF_TEST(FLOAT, CPU, 2, 8, 2, 9408, 11)
+
+TEST_F(RingReducerTest, FloatWithBfloat16WireType) {
+  const int kNumWorkers = 2;
+  const int kNumDevices = 4;
+  const int kTensorLen = 1001;
+  Init(kNumWorkers, kNumDevices, DT_FLOAT, TensorShape({kTensorLen}),
+       DEVICE_CPU, /*num_subdivs=*/2, /*fail_after=*/0);
+  std::vector<float> expected(kTensorLen);
+  for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+    instances_[di]->SetWireType(DT_BFLOAT16);
+    instances_[di]->InitTensor([&expected, di](Tensor* t) {
+      for (int i = 0; i < kTensorLen; ++i) {
+        // Small integers, and their partial sums, are exact in bfloat16.
+        float value = (di + i) % 16;
+        t->flat<float>()(i) = value;
+        expected[i] += value;
+      }
+    });
+  }
+  Reduce(/*fail_after=*/0);
+  for (int i = 0; i < kTensorLen; ++i) {
+    expected[i] /= kNumWorkers * kNumDevices;
+  }
+  for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+    TF_EXPECT_OK(instances_[di]->status_);
+    test::ExpectTensorEqual<float>(test::AsTensor<float>(expected),
+                                   instances_[di]->tensor());
+  }
+}
+
+TEST_F(RingReducerTest, FloatWithFloat16WireTypeRoundsEveryDeviceAlike) {
+  const int kNumWorkers = 1;
+  const int kNumDevices = 3;
+  const int kTensorLen = 64;
+  Init(kNumWorkers, kNumDevices, DT_FLOAT, TensorShape({kTensorLen}),
+       DEVICE_CPU, /*num_subdivs=*/1, /*fail_after=*/0);
+  std::vector<float> expected(kTensorLen);
+  for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+    instances_[di]->SetWireType(DT_HALF);
+    instances_[di]->InitTensor([&expected, di](Tensor* t) {
+      for (int i = 0; i < kTensorLen; ++i) {
+        float value = 1.0f / (3 + di + i);
+        t->flat<float>()(i) = value;
+        expected[i] += value / kNumDevices;
+      }
+    });
+  }
+  Reduce(/*fail_after=*/0);
+  for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+    TF_EXPECT_OK(instances_[di]->status_);
+    // Values are rounded on the wire, but every device, including the one that
+    // computed the final value of a chunk, ends up with the same result.
+    test::ExpectTensorNear<float>(test::AsTensor<float>(expected),
+                                  instances_[di]->tensor(), 1e-3);
+    test::ExpectTensorEqual<float>(instances_[0]->tensor(),
+                                   instances_[di]->tensor());
+  }
+}
 #endif
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -22,8 +22,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eval_const_tensor.h"
 #include "tensorflow/core/common_runtime/function_utils.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -31,6 +33,8 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
@@ -60,6 +64,123 @@ namespace {
 constexpr char kArgOp[] = "_Arg";
 constexpr char kRetvalOp[] = "_Retval";
 
+// Maximum number of entries of the shape function cache. The cache is cleared
+// when it is full.
+constexpr int kMaxShapeFnCacheEntries = 1 << 16;
+
+// Appends the rank and dimensions of the fully defined shape `s` to `dims`.
+void AppendDims(InferenceContext* c, ShapeHandle s, std::vector<int64>* dims) {
+  dims->push_back(c->Rank(s));
+  for (int i = 0; i < c->Rank(s); ++i) {
+    dims->push_back(c->Value(c->Dim(s, i)));
+  }
+}
+
+// Cache of the output shapes inferred by shape functions, shared by all
+// ShapeRefiners of the process so that nodes repeated across graphs and
+// function instantiations are only inferred once. Only results determined by
+// the op, its attributes and its input shapes are cached: all input and output
+// shapes must be fully defined, no input or output may have handle data, and
+// the shape function must not have requested the value of an input.
+class ShapeFnCache {
+ public:
+  static ShapeFnCache* Global() {
+    static ShapeFnCache* cache = new ShapeFnCache;
+    return cache;
+  }
+
+  // Computes the cache key of the node inferred by `c` and the dimensions of
+  // its inputs. Returns false if the result of the node cannot be cached.
+  static bool MakeKey(const Node* node, const OpRegistrationData* op_reg_data,
+                      int graph_def_version, InferenceContext* c, uint64* key,
+                      std::vector<int64>* input_dims) {
+    // Nodes without inputs have trivial shape functions, and hashing their
+    // attributes, e.g. the value of a constant, may cost more than inferring.
+    if (c->num_inputs() == 0) return false;
+    for (int i = 0; i < c->num_inputs(); ++i) {
+      if (!c->input(i).IsSet() || !c->FullyDefined(c->input(i)) ||
+          c->input_handle_shapes_and_types(i) != nullptr) {
+        return false;
+      }
+      AppendDims(c, c->input(i), input_dims);
+    }
+    *key = Hash64Combine(reinterpret_cast<uintptr_t>(op_reg_data),
+                         graph_def_version);
+    uint64 attrs_hash = 0;
+    for (const auto& attr : node->def().attr()) {
+      if (attr.second.value_case() == AttrValue::kTensor) return false;
+      attrs_hash = Hash64CombineUnordered(
+          attrs_hash,
+          Hash64Combine(Hash64(attr.first), FastAttrValueHash(attr.second)));
+    }
+    *key = Hash64Combine(*key, attrs_hash);
+    for (int64 dim : *input_dims) {
+      *key = Hash64Combine(*key, dim);
+    }
+    return true;
+  }
+
+  // Sets the outputs of `c` and returns true if a result is cached for `key`
+  // and `input_dims`.
+  bool Lookup(uint64 key, const std::vector<int64>& input_dims,
+              InferenceContext* c) {
+    std::vector<std::vector<int64>> output_shapes;
+    {
+      tf_shared_lock l(mu_);
+      auto it = entries_.find(key);
+      if (it == entries_.end() || it->second.input_dims != input_dims) {
+        return false;
+      }
+      output_shapes = it->second.output_shapes;
+    }
+    const int num_outputs = output_shapes.size();
+    if (num_outputs != c->num_outputs()) return false;
+    for (int i = 0; i < c->num_outputs(); ++i) {
+      std::vector<DimensionHandle> dims;
+      dims.reserve(output_shapes[i].size());
+      for (int64 dim : output_shapes[i]) {
+        dims.push_back(c->MakeDim(dim));
+      }
+      c->set_output(i, c->MakeShape(dims));
+    }
+    return true;
+  }
+
+  // Caches the outputs of `c` for `key` and `input_dims` if they are fully
+  // defined and have no handle data.
+  void Insert(uint64 key, std::vector<int64> input_dims, InferenceContext* c) {
+    std::vector<std::vector<int64>> output_shapes(c->num_outputs());
+    for (int i = 0; i < c->num_outputs(); ++i) {
+      ShapeHandle output = c->output(i);
+      if (!output.IsSet() || !c->FullyDefined(output) ||
+          c->output_handle_shapes_and_types(i) != nullptr) {
+        return;
+      }
+      for (int j = 0; j < c->Rank(output); ++j) {
+        output_shapes[i].push_back(c->Value(c->Dim(output, j)));
+      }
+    }
+    mutex_lock l(mu_);
+    if (entries_.size() >= kMaxShapeFnCacheEntries) {
+      entries_.clear();
+    }
+    Entry& entry = entries_[key];
+    entry.input_dims = std::move(input_dims);
+    entry.output_shapes = std::move(output_shapes);
+  }
+
+ private:
+  struct Entry {
+    // The ranks and dimensions of the inputs, to rule out key collisions
+    // between input shapes.
+    std::vector<int64> input_dims;
+    std::vector<std::vector<int64>> output_shapes;
+  };
+
+  mutex mu_;
+  absl::flat_hash_map<uint64, Entry> entries_ TF_GUARDED_BY(mu_);
+};
+
 }  // namespace
 
 // Runs shape inference for the given node using the given ShapeRefiner.
@@ -660,10 +781,25 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
   c->set_input_tensors(input_tensors);
   c->set_input_tensors_as_shapes(input_tensors_as_shapes);
 
+  const bool is_function_call =
+      function_library_ && IsFunctionCall(*function_library_, *node);
+  uint64 cache_key;
+  std::vector<int64> cache_input_dims;
+  const bool cacheable =
+      !is_function_call &&
+      ShapeFnCache::MakeKey(node, op_reg_data, graph_def_version_, c,
+                            &cache_key, &cache_input_dims);
+  if (cacheable) {
+    const bool hit =
+        ShapeFnCache::Global()->Lookup(cache_key, cache_input_dims, c);
+    metrics::RecordShapeInferenceCacheLookup(hit);
+    if (hit) return Status::OK();
+  }
+
   // Run the shape inference function, and return if there was an error.
   // Capture as lambda, because we might need to re-run inference later on.
   auto run_inference_lambda = [&]() {
-    if (function_library_ && IsFunctionCall(*function_library_, *node)) {
+    if (is_function_call) {
       bool disable_shape_inference;
       if (!GetNodeAttr(AttrSlice(node->def()), "_disable_call_shape_inference",
                        &disable_shape_inference)
@@ -698,6 +834,18 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
   };
   TF_RETURN_IF_ERROR(run_inference_lambda());
 
+  if (cacheable) {
+    bool requested_input = false;
+    for (int i = 0; i < c->num_inputs(); ++i) {
+      requested_input |= c->requested_input_tensor(i) ||
+                         c->requested_input_tensor_as_partial_shape(i);
+    }
+    if (!requested_input) {
+      ShapeFnCache::Global()->Insert(cache_key, std::move(cache_input_dims),
+                                     c);
+    }
+  }
+
   // We must run the shape function repeatedly, in case users write
   // shape functions where they only conditionally call input_tensor()
   // based on the values of another input tensor.
@@ -149,6 +149,50 @@ TEST_F(ShapeRefinerTest, MatMul) {
   EXPECT_SHAPE("[2,2]", m, mm, 0);
 }
 
+namespace {
+
+int num_counting_shape_fn_calls = 0;
+
+REGISTER_OP("CountingShapeFn")
+    .Input("a: float")
+    .Output("o: float")
+    .Attr("n: int")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      ++num_counting_shape_fn_calls;
+      return shape_inference::UnchangedShape(c);
+    });
+
+}  // namespace
+
+TEST_F(ShapeRefinerTest, CachesShapeFnResults) {
+  Graph graph(OpRegistry::Global());
+  auto add_counting_node = [&graph](int n, const TensorShape& input_shape) {
+    ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
+    Node* input = test::graph::Constant(&graph, Tensor(DT_FLOAT, input_shape));
+    Node* node;
+    TF_CHECK_OK(NodeBuilder(graph.NewName("counting"), "CountingShapeFn")
+                    .Input(input)
+                    .Attr("n", n)
+                    .Finalize(&graph, &node));
+    TF_CHECK_OK(m.AddNode(input));
+    TF_CHECK_OK(m.AddNode(node));
+    shape_inference::InferenceContext* ctx = m.GetContext(node);
+    return ctx->DebugString(ctx->output(0));
+  };
+  num_counting_shape_fn_calls = 0;
+
+  EXPECT_EQ("[2,3]", add_counting_node(0, TensorShape({2, 3})));
+  EXPECT_EQ(num_counting_shape_fn_calls, 1);
+  // Identical nodes reuse the result, even across ShapeRefiners.
+  EXPECT_EQ("[2,3]", add_counting_node(0, TensorShape({2, 3})));
+  EXPECT_EQ(num_counting_shape_fn_calls, 1);
+  // Different attributes or input shapes run the shape function.
+  EXPECT_EQ("[2,3]", add_counting_node(1, TensorShape({2, 3})));
+  EXPECT_EQ(num_counting_shape_fn_calls, 2);
+  EXPECT_EQ("[3,2]", add_counting_node(0, TensorShape({3, 2})));
+  EXPECT_EQ(num_counting_shape_fn_calls, 3);
+}
+
 TEST_F(ShapeRefinerTest, BadShapes) {
   ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
   Scope root = Scope::NewRootScope();
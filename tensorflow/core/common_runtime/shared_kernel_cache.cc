@@ -0,0 +1,126 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/shared_kernel_cache.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+
+// static
+SharedKernelCache* SharedKernelCache::Global() {
+  static SharedKernelCache* cache = new SharedKernelCache;
+  return cache;
+}
+
+SharedKernelCache::~SharedKernelCache() {
+  for (auto& key_and_entry : entries_) {
+    delete key_and_entry.second.kernel;
+  }
+}
+
+// static
+bool SharedKernelCache::IsShareable(const std::string& op) {
+  // These kernels don't change after construction, and their outputs are
+  // never forwarded or modified in place: the executor pins constant tensors.
+  return op == "Const" || op == "HostConst" || op == "ImmutableConst";
+}
+
+// static
+std::string SharedKernelCache::Key(const std::string& device_name,
+                                   const NodeDef& node_def) {
+  std::vector<std::pair<std::string, const AttrValue*>> attrs;
+  attrs.reserve(node_def.attr_size());
+  for (const auto& name_and_value : node_def.attr()) {
+    attrs.emplace_back(name_and_value.first, &name_and_value.second);
+  }
+  std::sort(attrs.begin(), attrs.end());
+  std::string key =
+      strings::StrCat(device_name, "|", node_def.name(), "|", node_def.op());
+  std::string serialized;
+  for (const auto& attr : attrs) {
+    serialized.clear();
+    SerializeToStringDeterministic(*attr.second, &serialized);
+    const Fprint128 fp = Fingerprint128(serialized);
+    strings::StrAppend(&key, "|", attr.first, "=", fp.low64, ":", fp.high64);
+  }
+  return key;
+}
+
+Status SharedKernelCache::FindOrCreate(const std::string& device_name,
+                                       const NodeDef& node_def,
+                                       const CreateKernelFn& create_fn,
+                                       OpKernel** kernel) {
+  DCHECK(IsShareable(node_def.op()));
+  const std::string key = Key(device_name, node_def);
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      ++it->second.num_refs;
+      *kernel = it->second.kernel;
+      return Status::OK();
+    }
+  }
+
+  // Create the kernel without holding the lock, since constants may be large.
+  OpKernel* created = nullptr;
+  TF_RETURN_IF_ERROR(create_fn(&created));
+  mutex_lock l(mu_);
+  Entry& entry = entries_[key];
+  if (entry.kernel == nullptr) {
+    entry.kernel = created;
+    keys_[created] = key;
+  } else {
+    // Another session created the same kernel concurrently.
+    delete created;
+  }
+  ++entry.num_refs;
+  *kernel = entry.kernel;
+  return Status::OK();
+}
+
+bool SharedKernelCache::Release(OpKernel* kernel) {
+  OpKernel* to_delete = nullptr;
+  {
+    mutex_lock l(mu_);
+    auto key_it = keys_.find(kernel);
+    if (key_it == keys_.end()) return false;
+    auto it = entries_.find(key_it->second);
+    DCHECK(it != entries_.end());
+    if (--it->second.num_refs == 0) {
+      to_delete = it->second.kernel;
+      entries_.erase(it);
+      keys_.erase(key_it);
+    }
+  }
+  delete to_delete;
+  return true;
+}
+
+int SharedKernelCache::num_kernels() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,92 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SHARED_KERNEL_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SHARED_KERNEL_CACHE_H_
+
+#include <functional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A process-wide cache of immutable kernels, shared by all the sessions that
+// load the same model. Kernels are keyed by the device name, the node name
+// and a fingerprint of the node's op and attrs, so the same node of two
+// copies of a model shares one kernel. Nodes with different names never
+// share a kernel, since the kernel's name appears in step stats and errors.
+//
+// Only kernels in an allow-list of ops whose state is fixed at construction
+// (e.g. `Const`, which holds its tensor) are cached. Sharing them
+// means that each model's constants are held in memory once, however many
+// sessions serve it.
+//
+// Kernels are reference-counted: every successful FindOrCreate() must be
+// matched by a Release(), and a kernel is deleted when its last user releases
+// it.
+class SharedKernelCache {
+ public:
+  typedef std::function<Status(OpKernel**)> CreateKernelFn;
+
+  // Returns the process-wide cache.
+  static SharedKernelCache* Global();
+
+  SharedKernelCache() = default;
+  ~SharedKernelCache();
+
+  // Returns true if kernels for `op` may be shared across sessions.
+  static bool IsShareable(const std::string& op);
+
+  // Returns in `*kernel` the cached kernel for `node_def` on `device_name`,
+  // calling `create_fn` to create it on a cache miss. The cache keeps
+  // ownership of the returned kernel.
+  //
+  // REQUIRES: IsShareable(node_def.op()).
+  Status FindOrCreate(const std::string& device_name, const NodeDef& node_def,
+                      const CreateKernelFn& create_fn, OpKernel** kernel);
+
+  // Drops one reference to `kernel` and returns true if it was obtained from
+  // FindOrCreate(). Returns false, and does nothing, otherwise.
+  bool Release(OpKernel* kernel);
+
+  // Returns the number of distinct kernels in the cache.
+  int num_kernels() const;
+
+ private:
+  struct Entry {
+    OpKernel* kernel = nullptr;
+    int num_refs = 0;
+  };
+
+  static std::string Key(const std::string& device_name,
+                         const NodeDef& node_def);
+
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, Entry> entries_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<const OpKernel*, std::string> keys_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedKernelCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SHARED_KERNEL_CACHE_H_
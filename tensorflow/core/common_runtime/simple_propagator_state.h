@@ -74,6 +74,13 @@ class SimplePropagatorState {
     TaggedNodeReadyQueue() : front_index_(0) {}
 
     void push_back(const TaggedNode& node) { ready_.push_back(node); }
+    void push_front(const TaggedNode& node) {
+      if (front_index_ > 0) {
+        ready_[--front_index_] = node;
+      } else {
+        ready_.insert(ready_.begin(), node);
+      }
+    }
     TaggedNode front() const {
       DCHECK_LT(front_index_, ready_.size());
       return ready_[front_index_];
@@ -129,6 +136,20 @@ class SimplePropagatorState {
     return input_tensors_.data() + tagged_node.node_item->input_start;
   }
 
+  // Moves `*output`, the only output of `*tagged_node`, to the input of its
+  // `NodeItem::chain_successor`, and makes `*tagged_node` refer to the
+  // successor. The successor is not activated, so the caller must run it in
+  // place of the completed node.
+  void ForwardToChainSuccessor(TaggedNode* tagged_node, Entry* output) {
+    const NodeItem* successor = tagged_node->node_item->chain_successor;
+    input_tensors_[successor->input_start] = std::move(*output);
+#if defined(THREAD_SANITIZER) || defined(DEBUG)
+    // Keeps the check in `GetInputTensors()` valid for the successor.
+    pending_[successor->node_id].store(0, std::memory_order_relaxed);
+#endif  // defined(THREAD_SANITIZER) || defined(DEBUG)
+    tagged_node->node_item = successor;
+  }
+
   FrameAndIter GetFrameAndIter(const TaggedNode& tagged_node) const {
     return {0, 0};
   }
@@ -0,0 +1,306 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+
+StaticMemoryPlanAllocator::StaticMemoryPlanAllocator(Allocator* base,
+                                                     int num_recorded_steps)
+    : base_(base), num_recorded_steps_(std::max(num_recorded_steps, 1)) {}
+
+StaticMemoryPlanAllocator::~StaticMemoryPlanAllocator() {
+  mutex_lock l(mu_);
+  if (!live_arena_ptrs_.empty()) {
+    LOG(WARNING) << Name() << " destroyed while " << live_arena_ptrs_.size()
+                 << " arena blocks are still in use.";
+  }
+  if (arena_ != nullptr) {
+    base_->DeallocateRaw(arena_);
+  }
+}
+
+std::string StaticMemoryPlanAllocator::Name() {
+  return strings::StrCat("static_plan_", base_->Name());
+}
+
+// static
+size_t StaticMemoryPlanAllocator::RoundedBytes(size_t num_bytes) {
+  return (num_bytes + kAllocatorAlignment - 1) / kAllocatorAlignment *
+         kAllocatorAlignment;
+}
+
+void StaticMemoryPlanAllocator::BeginStep() {
+  mutex_lock l(mu_);
+  ++num_active_steps_;
+  if (num_active_steps_ > 1) {
+    // Allocations of concurrent steps can't be told apart.
+    step_disqualified_ = true;
+    if (plan_valid_) {
+      VLOG(1) << Name() << ": discarding plan because of concurrent steps.";
+      InvalidatePlanLocked();
+    }
+    return;
+  }
+  step_disqualified_ = false;
+  clock_ = 0;
+  next_block_ = 0;
+  current_step_.clear();
+  recorded_ptrs_.clear();
+}
+
+void StaticMemoryPlanAllocator::EndStep() {
+  mutex_lock l(mu_);
+  DCHECK_GT(num_active_steps_, 0);
+  --num_active_steps_;
+  if (step_disqualified_) {
+    ResetRecordingLocked();
+    return;
+  }
+  if (plan_valid_) {
+    if (next_block_ != static_cast<int>(blocks_.size())) {
+      VLOG(1) << Name() << ": discarding plan because the step made "
+              << next_block_ << " allocations instead of " << blocks_.size();
+      InvalidatePlanLocked();
+    }
+    return;
+  }
+
+  bool same_pattern = current_step_.size() == stable_steps_.size();
+  for (int i = 0; same_pattern && i < current_step_.size(); ++i) {
+    same_pattern = current_step_[i].size == stable_steps_[i].size &&
+                   (current_step_[i].free_time < 0) ==
+                       (stable_steps_[i].free_time < 0);
+  }
+  if (same_pattern && num_stable_steps_ > 0) {
+    for (int i = 0; i < current_step_.size(); ++i) {
+      RecordedAllocation& merged = stable_steps_[i];
+      merged.alloc_time =
+          std::min(merged.alloc_time, current_step_[i].alloc_time);
+      merged.free_time = std::max(merged.free_time, current_step_[i].free_time);
+    }
+    ++num_stable_steps_;
+  } else {
+    stable_steps_ = std::move(current_step_);
+    num_stable_steps_ = 1;
+  }
+  current_step_.clear();
+  recorded_ptrs_.clear();
+
+  if (num_stable_steps_ >= num_recorded_steps_ && live_arena_ptrs_.empty()) {
+    ComputePlanLocked();
+  }
+}
+
+void* StaticMemoryPlanAllocator::AllocateRaw(size_t alignment,
+                                             size_t num_bytes) {
+  return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+}
+
+void* StaticMemoryPlanAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  if (num_bytes > 0 && alignment <= kAllocatorAlignment) {
+    mutex_lock l(mu_);
+    if (num_active_steps_ == 1 && !step_disqualified_) {
+      const size_t rounded_bytes = RoundedBytes(num_bytes);
+      if (plan_valid_) {
+        void* ptr = AllocateFromPlanLocked(rounded_bytes);
+        if (ptr != nullptr) return ptr;
+      } else {
+        void* ptr = base_->AllocateRaw(alignment, num_bytes, allocation_attr);
+        if (ptr != nullptr) {
+          recorded_ptrs_[ptr] = current_step_.size();
+          RecordedAllocation allocation;
+          allocation.size = rounded_bytes;
+          allocation.alloc_time = clock_++;
+          current_step_.push_back(allocation);
+        }
+        return ptr;
+      }
+    }
+  }
+  return base_->AllocateRaw(alignment, num_bytes, allocation_attr);
+}
+
+void StaticMemoryPlanAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  {
+    mutex_lock l(mu_);
+    if (ArenaContains(ptr)) {
+      auto it = live_arena_ptrs_.find(ptr);
+      DCHECK(it != live_arena_ptrs_.end());
+      block_live_[it->second] = false;
+      live_arena_ptrs_.erase(it);
+      MaybeReleaseArenaLocked();
+      return;
+    }
+    auto it = recorded_ptrs_.find(ptr);
+    if (it != recorded_ptrs_.end()) {
+      current_step_[it->second].free_time = clock_++;
+      recorded_ptrs_.erase(it);
+    }
+  }
+  base_->DeallocateRaw(ptr);
+}
+
+absl::optional<AllocatorStats> StaticMemoryPlanAllocator::GetStats() {
+  return base_->GetStats();
+}
+
+bool StaticMemoryPlanAllocator::has_plan() const {
+  mutex_lock l(mu_);
+  return plan_valid_;
+}
+
+size_t StaticMemoryPlanAllocator::arena_size() const {
+  mutex_lock l(mu_);
+  return arena_size_;
+}
+
+bool StaticMemoryPlanAllocator::ArenaContains(const void* ptr) const {
+  return arena_ != nullptr && ptr >= arena_ && ptr < arena_ + arena_size_;
+}
+
+void* StaticMemoryPlanAllocator::AllocateFromPlanLocked(size_t rounded_bytes) {
+  const int index = next_block_++;
+  if (index >= blocks_.size() || blocks_[index].size != rounded_bytes) {
+    VLOG(1) << Name() << ": discarding plan because allocation " << index
+            << " doesn't match the recorded pattern.";
+    InvalidatePlanLocked();
+    step_disqualified_ = true;
+    return nullptr;
+  }
+  const PlannedBlock& block = blocks_[index];
+  if (block.escapes) return nullptr;
+  bool conflict = block_live_[index];
+  for (int other : block.overlapping_blocks) {
+    conflict = conflict || block_live_[other];
+  }
+  if (conflict) {
+    VLOG(1) << Name() << ": discarding plan because allocation " << index
+            << " overlaps a block that is still in use.";
+    InvalidatePlanLocked();
+    step_disqualified_ = true;
+    return nullptr;
+  }
+  void* ptr = arena_ + block.offset;
+  block_live_[index] = true;
+  live_arena_ptrs_[ptr] = index;
+  return ptr;
+}
+
+void StaticMemoryPlanAllocator::ComputePlanLocked() {
+  DCHECK(live_arena_ptrs_.empty());
+  MaybeReleaseArenaLocked();
+
+  const int num_blocks = stable_steps_.size();
+  blocks_.assign(num_blocks, PlannedBlock());
+  std::vector<int> order;
+  for (int i = 0; i < num_blocks; ++i) {
+    blocks_[i].size = stable_steps_[i].size;
+    blocks_[i].escapes = stable_steps_[i].free_time < 0;
+    if (!blocks_[i].escapes) order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+    return blocks_[a].size > blocks_[b].size;
+  });
+
+  auto lifetimes_intersect = [this](int a, int b) {
+    return stable_steps_[a].alloc_time <= stable_steps_[b].free_time &&
+           stable_steps_[b].alloc_time <= stable_steps_[a].free_time;
+  };
+  auto ranges_intersect = [this](int a, int b) {
+    return blocks_[a].offset < blocks_[b].offset + blocks_[b].size &&
+           blocks_[b].offset < blocks_[a].offset + blocks_[a].size;
+  };
+
+  size_t arena_size = 0;
+  std::vector<int> placed;
+  for (int i : order) {
+    std::vector<int> neighbors;
+    for (int j : placed) {
+      if (lifetimes_intersect(i, j)) neighbors.push_back(j);
+    }
+    std::sort(neighbors.begin(), neighbors.end(), [this](int a, int b) {
+      return blocks_[a].offset < blocks_[b].offset;
+    });
+    size_t offset = 0;
+    for (int j : neighbors) {
+      if (offset + blocks_[i].size <= blocks_[j].offset) break;
+      offset = std::max(offset, blocks_[j].offset + blocks_[j].size);
+    }
+    blocks_[i].offset = offset;
+    arena_size = std::max(arena_size, offset + blocks_[i].size);
+    placed.push_back(i);
+  }
+  for (int a = 0; a < placed.size(); ++a) {
+    for (int b = a + 1; b < placed.size(); ++b) {
+      if (ranges_intersect(placed[a], placed[b])) {
+        blocks_[placed[a]].overlapping_blocks.push_back(placed[b]);
+        blocks_[placed[b]].overlapping_blocks.push_back(placed[a]);
+      }
+    }
+  }
+
+  if (arena_size == 0) {
+    blocks_.clear();
+    return;
+  }
+  arena_ = static_cast<char*>(
+      base_->AllocateRaw(kAllocatorAlignment, arena_size));
+  if (arena_ == nullptr) {
+    LOG(WARNING) << Name() << ": failed to reserve an arena of " << arena_size
+                 << " bytes; not using a static memory plan.";
+    blocks_.clear();
+    ResetRecordingLocked();
+    return;
+  }
+  arena_size_ = arena_size;
+  block_live_.assign(num_blocks, false);
+  next_block_ = 0;
+  plan_valid_ = true;
+  VLOG(1) << Name() << ": planned " << placed.size() << " of " << num_blocks
+          << " allocations in an arena of " << arena_size << " bytes.";
+}
+
+void StaticMemoryPlanAllocator::InvalidatePlanLocked() {
+  plan_valid_ = false;
+  ResetRecordingLocked();
+  MaybeReleaseArenaLocked();
+}
+
+void StaticMemoryPlanAllocator::MaybeReleaseArenaLocked() {
+  if (plan_valid_ || !live_arena_ptrs_.empty() || arena_ == nullptr) return;
+  base_->DeallocateRaw(arena_);
+  arena_ = nullptr;
+  arena_size_ = 0;
+  blocks_.clear();
+  block_live_.clear();
+}
+
+void StaticMemoryPlanAllocator::ResetRecordingLocked() {
+  current_step_.clear();
+  recorded_ptrs_.clear();
+  stable_steps_.clear();
+  num_stable_steps_ = 0;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,141 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_ALLOCATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that learns the allocation pattern of repeated executions of
+// the same graph. Once the pattern has been stable for a number of steps, it
+// serves each step's allocations from one arena reserved up front, at offsets
+// computed ahead of time. Steady-state steps then make no calls into the
+// underlying allocator.
+//
+// Callers bracket every execution with BeginStep() and EndStep(). These
+// allocations are forwarded to the underlying allocator:
+//   * allocations made outside a step, or while more than one step is in
+//     flight;
+//   * allocations that don't match the recorded pattern;
+//   * allocations that were still live at the end of a recorded step (e.g.
+//     fetched outputs).
+//
+// Before handing out an arena block, the allocator checks that every block
+// sharing its address range has been freed. If the actual lifetimes deviate
+// from the recorded ones, the allocation falls back to the underlying
+// allocator rather than overwriting a live tensor. The plan is then discarded
+// and recording starts over.
+//
+// As in TFLite's ArenaPlanner, blocks are placed greedily in order of
+// decreasing size, each at the lowest offset that doesn't overlap a block
+// with an intersecting lifetime.
+class StaticMemoryPlanAllocator : public Allocator {
+ public:
+  // Does not take ownership of `base`, which must outlive this allocator. A
+  // plan is computed after `num_recorded_steps` consecutive steps with the same
+  // sequence of allocation sizes.
+  StaticMemoryPlanAllocator(Allocator* base, int num_recorded_steps);
+  ~StaticMemoryPlanAllocator() override;
+
+  // Marks the beginning and the end of one execution of the graph.
+  void BeginStep();
+  void EndStep();
+
+  std::string Name() override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  absl::optional<AllocatorStats> GetStats() override;
+
+  // Returns true if steps are currently served from the arena.
+  bool has_plan() const;
+
+  // Returns the size in bytes of the reserved arena, or 0 if there is none.
+  size_t arena_size() const;
+
+ private:
+  // One allocation of a recorded step. Times are positions in the sequence of
+  // allocation and deallocation events of the step.
+  struct RecordedAllocation {
+    size_t size = 0;
+    int64 alloc_time = 0;
+    int64 free_time = -1;  // -1 if the allocation outlived the step.
+  };
+
+  // One block of the plan, corresponding to the allocation with the same index
+  // in every step.
+  struct PlannedBlock {
+    size_t size = 0;
+    size_t offset = 0;
+    // If true, the allocation is served by the underlying allocator.
+    bool escapes = false;
+    // Indices of the blocks whose address range intersects this one.
+    std::vector<int> overlapping_blocks;
+  };
+
+  static size_t RoundedBytes(size_t num_bytes);
+
+  bool ArenaContains(const void* ptr) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void* AllocateFromPlanLocked(size_t rounded_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void ComputePlanLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void InvalidatePlanLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void MaybeReleaseArenaLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void ResetRecordingLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_;  // Not owned.
+  const int num_recorded_steps_;
+
+  mutable mutex mu_;
+  int num_active_steps_ TF_GUARDED_BY(mu_) = 0;
+  // True if the running step must not be recorded or served from the plan.
+  bool step_disqualified_ TF_GUARDED_BY(mu_) = false;
+  int64 clock_ TF_GUARDED_BY(mu_) = 0;
+
+  // Recording state.
+  std::vector<RecordedAllocation> current_step_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<void*, int> recorded_ptrs_ TF_GUARDED_BY(mu_);
+  // The union of the lifetimes observed over the last `num_stable_steps_`
+  // steps with the same allocation sizes.
+  std::vector<RecordedAllocation> stable_steps_ TF_GUARDED_BY(mu_);
+  int num_stable_steps_ TF_GUARDED_BY(mu_) = 0;
+
+  // Plan state. The arena and the blocks outlive an invalidated plan until
+  // every live arena block has been freed.
+  bool plan_valid_ TF_GUARDED_BY(mu_) = false;
+  std::vector<PlannedBlock> blocks_ TF_GUARDED_BY(mu_);
+  std::vector<bool> block_live_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<void*, int> live_arena_ptrs_ TF_GUARDED_BY(mu_);
+  int next_block_ TF_GUARDED_BY(mu_) = 0;
+  char* arena_ TF_GUARDED_BY(mu_) = nullptr;
+  size_t arena_size_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticMemoryPlanAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_ALLOCATOR_H_
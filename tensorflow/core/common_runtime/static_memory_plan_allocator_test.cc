@@ -0,0 +1,126 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan_allocator.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Runs one step that allocates a (100 bytes) and b (200 bytes), frees a,
+// allocates c (100 bytes) and frees b and c. Returns a and c.
+std::pair<void*, void*> RunStep(StaticMemoryPlanAllocator* allocator) {
+  allocator->BeginStep();
+  void* a = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  void* b = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 200);
+  allocator->DeallocateRaw(a);
+  void* c = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  allocator->DeallocateRaw(b);
+  allocator->DeallocateRaw(c);
+  allocator->EndStep();
+  return {a, c};
+}
+
+TEST(StaticMemoryPlanAllocatorTest, PlansAfterRecordedSteps) {
+  StaticMemoryPlanAllocator allocator(cpu_allocator(), 2);
+  RunStep(&allocator);
+  EXPECT_FALSE(allocator.has_plan());
+  RunStep(&allocator);
+  ASSERT_TRUE(allocator.has_plan());
+  // b (256 bytes after rounding) is placed first; a and c have disjoint
+  // lifetimes and share the 128 bytes that follow it.
+  EXPECT_EQ(384, allocator.arena_size());
+
+  auto planned = RunStep(&allocator);
+  EXPECT_EQ(planned.first, planned.second);
+  EXPECT_TRUE(allocator.has_plan());
+  auto replanned = RunStep(&allocator);
+  EXPECT_EQ(planned, replanned);
+}
+
+TEST(StaticMemoryPlanAllocatorTest, EscapingAllocationsAreNotPlanned) {
+  StaticMemoryPlanAllocator allocator(cpu_allocator(), 1);
+  allocator.BeginStep();
+  void* output = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  void* temp = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  allocator.DeallocateRaw(temp);
+  allocator.EndStep();
+  ASSERT_TRUE(allocator.has_plan());
+  EXPECT_EQ(64, allocator.arena_size());
+  allocator.DeallocateRaw(output);
+
+  allocator.BeginStep();
+  output = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  void* planned_temp =
+      allocator.AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  EXPECT_NE(output, planned_temp);
+  allocator.DeallocateRaw(planned_temp);
+  allocator.EndStep();
+  EXPECT_TRUE(allocator.has_plan());
+  allocator.DeallocateRaw(output);
+}
+
+TEST(StaticMemoryPlanAllocatorTest, ShapeChangeInvalidatesPlan) {
+  StaticMemoryPlanAllocator allocator(cpu_allocator(), 1);
+  RunStep(&allocator);
+  ASSERT_TRUE(allocator.has_plan());
+
+  allocator.BeginStep();
+  void* p = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 4096);
+  EXPECT_FALSE(allocator.has_plan());
+  allocator.DeallocateRaw(p);
+  allocator.EndStep();
+  EXPECT_FALSE(allocator.has_plan());
+  EXPECT_EQ(0, allocator.arena_size());
+
+  // The allocator records the new pattern and plans again.
+  RunStep(&allocator);
+  EXPECT_TRUE(allocator.has_plan());
+}
+
+TEST(StaticMemoryPlanAllocatorTest, LongerLifetimeFallsBack) {
+  StaticMemoryPlanAllocator allocator(cpu_allocator(), 1);
+  RunStep(&allocator);
+  ASSERT_TRUE(allocator.has_plan());
+
+  // Keep a alive past its recorded lifetime: c must not reuse its memory.
+  allocator.BeginStep();
+  void* a = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  void* b = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 200);
+  void* c = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  EXPECT_NE(a, c);
+  EXPECT_FALSE(allocator.has_plan());
+  allocator.DeallocateRaw(a);
+  allocator.DeallocateRaw(b);
+  allocator.DeallocateRaw(c);
+  allocator.EndStep();
+  EXPECT_EQ(0, allocator.arena_size());
+}
+
+TEST(StaticMemoryPlanAllocatorTest, ConcurrentStepsAreNotPlanned) {
+  StaticMemoryPlanAllocator allocator(cpu_allocator(), 1);
+  allocator.BeginStep();
+  allocator.BeginStep();
+  void* p = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  allocator.DeallocateRaw(p);
+  allocator.EndStep();
+  allocator.EndStep();
+  EXPECT_FALSE(allocator.has_plan());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -26,9 +26,13 @@ info. It does not have any negative impact on performance. */
 #endif
 #endif  // ENABLE_ONEDNN_OPENMP && ENABLE_MKL &&_OPENMP
 
+#include <algorithm>
+
 #include "absl/base/call_once.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "tensorflow/core/common_runtime/local_device.h"
+#include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/scoped_allocator.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
 #include "tensorflow/core/common_runtime/threadpool_device.h"
@@ -40,7 +44,9 @@ info. It does not have any negative impact on performance. */
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
@@ -61,6 +67,24 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                name, DEVICE_CPU, memory_limit, locality)),
       allocator_(allocator),
       scoped_allocator_mgr_(new ScopedAllocatorMgr(name)) {
+  const int num_numa_nodes = port::NUMANumNodes();
+  const int numa_node = locality.numa_node();
+  if (options.config.experimental().use_numa_affinity() &&
+      num_numa_nodes > 1 && numa_node >= 0 && numa_node < num_numa_nodes) {
+    // Run the executor's inter-op closures on threads of the same node as the
+    // intra-op pool and the allocator of this device, so that kernels don't
+    // touch memory on a remote node.
+    ThreadOptions thread_opts;
+    thread_opts.numa_node = numa_node;
+    const int32 num_threads = std::max<int32>(
+        1, NumInterOpThreadsFromSessionOptions(options) / num_numa_nodes);
+    numa_inter_op_thread_pool_ = absl::make_unique<thread::ThreadPool>(
+        options.env, thread_opts,
+        strings::StrCat("numa_", numa_node, "_Compute"), num_threads,
+        !options.config.experimental().disable_thread_spinning(),
+        /*allocator=*/nullptr);
+    set_tensorflow_device_thread_pool(numa_inter_op_thread_pool_.get());
+  }
 #if defined(ENABLE_ONEDNN_OPENMP) && defined(INTEL_MKL)
   // Early return when MKL is disabled
   if (!IsMKLEnabled()) return;
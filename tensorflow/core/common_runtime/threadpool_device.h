@@ -54,6 +54,9 @@ class ThreadPoolDevice : public LocalDevice {
 
   Allocator* allocator_;  // Not owned
   std::unique_ptr<ScopedAllocatorMgr> scoped_allocator_mgr_;
+  // Inter-op threads pinned to the NUMA node of this device. Only created
+  // when NUMA affinity is requested and the system has several nodes.
+  std::unique_ptr<thread::ThreadPool> numa_inter_op_thread_pool_;
 };
 
 }  // namespace tensorflow
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/threadpool_device.h"
 
+#include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -68,5 +70,21 @@ TEST(ThreadPoolDeviceTest, CopyTensor) {
   device_context->Unref();
 }
 
+TEST(ThreadPoolDeviceTest, OneDevicePerNUMANode) {
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory(DEVICE_CPU)->CreateDevices(
+      options, "/job:localhost/replica:0/task:0", &devices));
+  const int num_numa_nodes = port::NUMANumNodes();
+  ASSERT_EQ(num_numa_nodes, devices.size());
+  for (int i = 0; i < num_numa_nodes; ++i) {
+    EXPECT_EQ(i, devices[i]->attributes().locality().numa_node());
+    // Inter-op threads are only pinned when there is more than one node.
+    EXPECT_EQ(num_numa_nodes > 1,
+              devices[i]->tensorflow_device_thread_pool() != nullptr);
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
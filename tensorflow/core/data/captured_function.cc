@@ -339,6 +339,26 @@ class OwnedArgsCallFrame : public CallFrameBase {
   const std::vector<Tensor>* const captured_inputs_;  // Not owned.
 };
 
+// Per-call state of `InstantiatedCapturedFunction::RunAsync()` that must
+// outlive the call. Grouping it in one object means an asynchronous
+// invocation makes a single heap allocation rather than one per member.
+struct RunAsyncState {
+  RunAsyncState(std::vector<Tensor>&& args,
+                const std::vector<Tensor>* captured_inputs,
+                DataTypeSlice ret_types, int64 step_id,
+                ResourceMgr* resource_mgr, CancellationManager* parent)
+      : frame(std::move(args), captured_inputs, ret_types),
+        step_container(step_id,
+                       [resource_mgr](const string& name) {
+                         resource_mgr->Cleanup(name).IgnoreError();
+                       }),
+        cancellation_manager(parent) {}
+
+  OwnedArgsCallFrame frame;
+  ScopedStepContainer step_container;
+  CancellationManager cancellation_manager;
+};
+
 class BorrowedArgsCallFrame : public CallFrameBase {
  public:
   BorrowedArgsCallFrame(const std::vector<Tensor>& args,
@@ -941,21 +961,16 @@ void InstantiatedCapturedFunction::RunAsync(
   // NOTE(mrry): This method does not transfer ownership of `ctx`, and it may
   // be deleted before `done` is called. Take care not to capture `ctx` in any
   // code that may execute asynchronously in this function.
-  OwnedArgsCallFrame* frame = new OwnedArgsCallFrame(
-      std::move(args), &captured_func_->captured_inputs(), ret_types_);
-
   FunctionLibraryRuntime::Options f_opts;
-  ResourceMgr* resource_mgr = lib_->device()->resource_manager();
-  ScopedStepContainer* step_container = new ScopedStepContainer(
-      f_opts.step_id, [resource_mgr](const string& name) {
-        resource_mgr->Cleanup(name).IgnoreError();
-      });
-  f_opts.step_container = step_container;
+  auto state = absl::make_unique<RunAsyncState>(
+      std::move(args), &captured_func_->captured_inputs(), ret_types_,
+      f_opts.step_id, lib_->device()->resource_manager(),
+      ctx->cancellation_manager());
+  OwnedArgsCallFrame* frame = &state->frame;
+  f_opts.step_container = &state->step_container;
   f_opts.runner = ctx->runner();
   f_opts.create_rendezvous = ShouldCreateRendezvous();
-  auto cancellation_manager =
-      absl::make_unique<CancellationManager>(ctx->cancellation_manager());
-  f_opts.cancellation_manager = cancellation_manager.get();
+  f_opts.cancellation_manager = &state->cancellation_manager;
 
   std::shared_ptr<SimpleStepStatsCollector> stats_collector;
   if (node || ctx->stats_aggregator()) {
@@ -965,23 +980,19 @@ void InstantiatedCapturedFunction::RunAsync(
       node && ctx->model() && ctx->model()->collect_resource_usage();
   f_opts.stats_collector = stats_collector.get();
 
-  // Transfer ownership of the cancellation manager to `callback`.
-  CancellationManager* raw_cancellation_manager =
-      cancellation_manager.release();
+  // Transfer ownership of the per-call state to `callback`.
+  RunAsyncState* raw_state = state.release();
   auto callback = std::bind(
-      [this, rets, step_container, raw_cancellation_manager, frame, node,
-       collect_usage](
+      [this, rets, raw_state, node, collect_usage](
           const FunctionLibraryRuntime::DoneCallback& done,
           IteratorContext* ctx,
           const std::shared_ptr<SimpleStepStatsCollector>& stats_collector,
           // Begin unbound arguments.
           Status s) {
-        delete step_container;
-        delete raw_cancellation_manager;
         if (s.ok()) {
-          s = frame->ConsumeRetvals(rets);
+          s = raw_state->frame.ConsumeRetvals(rets);
         }
-        delete frame;
+        delete raw_state;
         if (node) {
           // TODO(b/129085499) Utilize the `node_name` which would be unique
           // than the prefix for the function execution time statistics.
@@ -16,8 +16,11 @@ limitations under the License.
 
 #include <limits>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -26,6 +29,17 @@ namespace data {
 
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out) {
+  return CompressElement(element, io::compression::kSnappy, out);
+}
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       const std::string& compression_type,
+                       CompressedElement* out) {
+  if (compression_type != io::compression::kSnappy &&
+      compression_type != io::compression::kZstd) {
+    return errors::InvalidArgument("Unsupported compression type: ",
+                                   compression_type);
+  }
   // Step 1: Determine the total uncompressed size. This requires serializing
   // non-memcopyable tensors, which we save to use again later.
   std::vector<TensorProto> non_memcpy_components;
@@ -74,8 +88,12 @@ Status CompressElement(const std::vector<Tensor>& element,
   }
   DCHECK_EQ(position, uncompressed.mdata() + total_size);
 
-  if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
-                             out->mutable_data())) {
+  if (compression_type == io::compression::kZstd) {
+    out->set_compression_type(CompressedElement::ZSTD);
+    TF_RETURN_IF_ERROR(io::ZstdCompress(
+        uncompressed, io::ZstdCompressionOptions(), out->mutable_data()));
+  } else if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
+                                    out->mutable_data())) {
     return errors::Internal("Failed to compress using snappy.");
   }
   VLOG(3) << "Compressed element from " << total_size << " bytes to "
@@ -83,6 +101,32 @@ Status CompressElement(const std::vector<Tensor>& element,
   return Status::OK();
 }
 
+namespace {
+
+Status UncompressSnappy(const std::string& compressed_data, int64 total_size,
+                        const std::vector<struct iovec>& iov) {
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(
+          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
+    return errors::Internal(
+        "Could not get snappy uncompressed length. Compressed data size: ",
+        compressed_data.size());
+  }
+  if (uncompressed_size != static_cast<size_t>(total_size)) {
+    return errors::Internal(
+        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+        " whereas the tensor metadata suggests ", total_size);
+  }
+  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
+                                      compressed_data.size(), iov.data(),
+                                      iov.size())) {
+    return errors::Internal("Failed to perform snappy decompression.");
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out) {
   int num_components = compressed.component_metadata_size();
@@ -126,22 +170,17 @@ Status UncompressElement(const CompressedElement& compressed,
 
   // Step 2: Uncompress into the iovec.
   const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size());
-  }
-  if (uncompressed_size != static_cast<size_t>(total_size)) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", total_size);
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.data(),
-                                      num_components)) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  if (compressed.compression_type() == CompressedElement::ZSTD) {
+    std::vector<absl::Span<char>> outputs;
+    outputs.reserve(num_components);
+    for (const struct iovec& component : iov) {
+      outputs.emplace_back(static_cast<char*>(component.iov_base),
+                           component.iov_len);
+    }
+    TF_RETURN_IF_ERROR(io::ZstdUncompress(
+        compressed_data, io::ZstdCompressionOptions(), outputs));
+  } else {
+    TF_RETURN_IF_ERROR(UncompressSnappy(compressed_data, total_size, iov));
   }
 
   // Step 3: Deserialize tensor proto strings to tensors.
@@ -31,6 +31,12 @@ namespace data {
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
+// Like the above, but compresses with `compression_type`, which must be
+// `io::compression::kSnappy` or `io::compression::kZstd`.
+Status CompressElement(const std::vector<Tensor>& element,
+                       const std::string& compression_type,
+                       CompressedElement* out);
+
 // Uncompresses a `CompressedElement` into a vector of tensor components.
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out);
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -35,6 +37,20 @@ TEST_P(ParameterizedCompressionUtilsTest, RoundTrip) {
       ExpectEqual(element, round_trip_element, /*compare_order=*/true));
 }
 
+TEST_P(ParameterizedCompressionUtilsTest, ZstdRoundTrip) {
+  if (!io::IsZstdSupported()) {
+    GTEST_SKIP() << "Built without zstd support";
+  }
+  std::vector<Tensor> element = GetParam();
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, io::compression::kZstd, &compressed));
+  EXPECT_EQ(compressed.compression_type(), CompressedElement::ZSTD);
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
 std::vector<std::vector<Tensor>> TestCases() {
   return {
       CreateTensors<int64>(TensorShape{1}, {{1}}),             // int64
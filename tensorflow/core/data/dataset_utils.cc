@@ -752,7 +752,11 @@ Status CopyBatch(bool parallel_copy, IteratorContext* ctx,
     // is moved into the output batch.
     TensorShape first_element_shape(first_element.shape());
     batch_component_shape.AppendShape(first_element_shape);
-    out_tensors->emplace_back(ctx->allocator({}), first_element.dtype(),
+    // Batches are often copied to a GPU next, e.g. by `prefetch_to_device`,
+    // so allocate them from pinned memory when there is a GPU.
+    AllocatorAttributes attr;
+    attr.set_gpu_compatible(true);
+    out_tensors->emplace_back(ctx->allocator(attr), first_element.dtype(),
                               batch_component_shape);
     if (!out_tensors->back().IsInitialized()) {
       return errors::ResourceExhausted(
@@ -892,6 +896,9 @@ absl::flat_hash_map<string, int64> DatasetExperimentRegistry::Experiments() {
 namespace {
 
 REGISTER_DATASET_EXPERIMENT("enable_gradient_descent", 0);
+REGISTER_DATASET_EXPERIMENT("autotune_tail_latency", 0);
+REGISTER_DATASET_EXPERIMENT("jpeg_decode_resize_fusion", 0);
+REGISTER_DATASET_EXPERIMENT("map_vectorization", 0);
 REGISTER_DATASET_EXPERIMENT("parallelize_batch_copy", 100);
 REGISTER_DATASET_EXPERIMENT("max_parallelism", 20);
 }  // namespace
@@ -241,6 +241,10 @@ Status CopyBatch(bool parallel_copy, IteratorContext* ctx,
                  const std::vector<std::vector<Tensor>>& batch_elements,
                  std::vector<Tensor>* out_tensors);
 
+// The element latency quantile that autotuning provisions for under the
+// `autotune_tail_latency` experiment, see `model::Model::set_latency_quantile`.
+constexpr double kAutotuneTailLatencyQuantile = 0.9;
+
 // Computes the set of experiments to apply based on the job name, rollout
 // percentage of registered experiments, and the TF_DATA_EXPERIMENT_OPT_IN and
 // TF_DATA_EXPERIMENT_OPT_OUT environment variables.
@@ -15,10 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/data/root_dataset.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/common_runtime/pool_allocator.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
+#include "tensorflow/core/data/unbounded_thread_pool.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stringprintf.h"
 
 namespace tensorflow {
@@ -33,15 +39,35 @@ constexpr char kHillClimb[] = "hill_climb";
 constexpr char kGradientDescent[] = "gradient_descent";
 constexpr char kIntraOpParallelism[] = "intra_op_parallelism";
 constexpr char kPrivateThreadpoolSize[] = "threadpool_size";
+constexpr char kNumaNode[] = "numa_node";
 
 // Default share of available RAM that can be used by model's internal buffers.
 constexpr double kRamBudgetShare = 0.5;
 
+// Memory limit of the allocators of NUMA-bound datasets.
+constexpr int64 kNumaAllocatorMemoryLimit = 1LL << 36;
+
 // If value `x` matches `y`, returns default value `z`. Otherwise, return `x`.
 inline int64 value_or_default(int64 x, int64 y, int64 z) {
   return x == y ? z : x;
 }
 
+// Returns the process-wide allocator whose memory is bound to `numa_node`.
+Allocator* GetNumaAllocator(int numa_node) {
+  static mutex* mu = new mutex();
+  static auto* allocators = new absl::flat_hash_map<int, Allocator*>();
+  mutex_lock l(*mu);
+  Allocator*& allocator = (*allocators)[numa_node];
+  if (allocator == nullptr) {
+    allocator = new BFCAllocator(
+        new BasicCPUAllocator(numa_node, /*alloc_visitors=*/{},
+                              /*free_visitors=*/{}),
+        kNumaAllocatorMemoryLimit, /*allow_growth=*/true,
+        strings::StrCat("tf_data_numa_", numa_node));
+  }
+  return allocator;
+}
+
 }  // namespace
 
 // static
@@ -56,6 +82,16 @@ Status RootDataset::FromOptions(DatasetBase* input, DatasetBase** output) {
     params.private_threadpool_size =
         options.threading_options().private_threadpool_size();
   }
+  if (options.threading_options().optional_numa_node_case() ==
+      ThreadingOptions::kNumaNode) {
+    const int numa_node = options.threading_options().numa_node();
+    if (numa_node < 0 || numa_node >= port::NUMANumNodes()) {
+      return errors::InvalidArgument("`numa_node` must be in [0, ",
+                                     port::NUMANumNodes(), "), got ",
+                                     numa_node, ".");
+    }
+    params.numa_node = numa_node;
+  }
   params.autotune = ShouldUseAutotuning(options);
   if (params.autotune) {
     params.autotune_algorithm = model::AutotuneAlgorithm::HILL_CLIMB;
@@ -79,20 +115,34 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       : DatasetIterator<RootDataset>(params) {
     if (dataset()->params_.autotune) {
       model_ = std::make_shared<model::Model>();
+      if (GetExperiments().contains("autotune_tail_latency")) {
+        model_->set_latency_quantile(kAutotuneTailLatencyQuantile);
+      }
     }
     if (dataset()->params_.max_intra_op_parallelism >= 0) {
       max_intra_op_parallelism_ =
           value_or_default(dataset()->params_.max_intra_op_parallelism, 0,
                            port::MaxParallelism());
     }
+    const int numa_node = dataset()->params_.numa_node;
+    ThreadOptions thread_options;
+    thread_options.numa_node = numa_node;
     if (dataset()->params_.private_threadpool_size >= 0) {
-      threadpool_size_ =
-          value_or_default(dataset()->params_.private_threadpool_size, 0,
-                           port::MaxParallelism());
+      threadpool_size_ = value_or_default(
+          dataset()->params_.private_threadpool_size, 0,
+          numa_node == port::kNUMANoAffinity ? port::MaxParallelism()
+                                             : port::MaxParallelism(numa_node));
       thread_pool_ = absl::make_unique<thread::ThreadPool>(
-          Env::Default(), ThreadOptions{}, "data_private_threadpool",
+          Env::Default(), thread_options, "data_private_threadpool",
           threadpool_size_);
     }
+    if (numa_node != port::kNUMANoAffinity) {
+      // Background threads started by the iterators, e.g. those of
+      // `prefetch`, are bound to the node too.
+      unbounded_thread_pool_ = absl::make_unique<UnboundedThreadPool>(
+          Env::Default(), "tf_data_numa_thread", thread_options);
+      allocator_ = GetNumaAllocator(numa_node);
+    }
     cancellation_manager_ = absl::make_unique<CancellationManager>();
   }
 
@@ -151,6 +201,18 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       params.runner =
           RunnerWithMaxParallelism(params.runner, max_intra_op_parallelism_);
     }
+    if (dataset()->params_.numa_node != port::kNUMANoAffinity) {
+      params.thread_factory = unbounded_thread_pool_->get_thread_factory();
+      params.allocator_getter = [allocator = allocator_,
+                                 allocator_getter = params.allocator_getter](
+                                    AllocatorAttributes attrs) {
+        // Memory that devices need to access keeps coming from the device.
+        if (attrs.gpu_compatible()) {
+          return allocator_getter(attrs);
+        }
+        return allocator;
+      };
+    }
     return params;
   }
 
@@ -180,6 +242,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   int64 max_intra_op_parallelism_;
   int64 threadpool_size_;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
+  std::unique_ptr<UnboundedThreadPool> unbounded_thread_pool_;
+  // Allocates the buffers of the elements of a NUMA-bound dataset.
+  Allocator* allocator_ = nullptr;
 
   // Must be ordered last as its execution may depend on other members.
   std::unique_ptr<IteratorBase> input_impl_;
@@ -217,6 +282,10 @@ RootDataset::RootDataset(const DatasetBase* input, Params params)
                                     params_.private_threadpool_size, 0,
                                     port::MaxParallelism())))));
   }
+  if (params_.numa_node != port::kNUMANoAffinity) {
+    traceme_metadata_.push_back(std::make_pair(
+        kNumaNode, strings::Printf("%d", params_.numa_node)));
+  }
   input_->Ref();
 }
 
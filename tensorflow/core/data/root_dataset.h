@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/model.pb.h"
+#include "tensorflow/core/platform/numa.h"
 
 namespace tensorflow {
 namespace data {
@@ -33,6 +34,9 @@ class RootDataset : public DatasetBase {
     int64 autotune_ram_budget = 0;
     int64 max_intra_op_parallelism = 1;
     int64 private_threadpool_size = 0;
+    // The NUMA node that the threads and element buffers of the dataset are
+    // bound to.
+    int numa_node = port::kNUMANoAffinity;
   };
 
   static Status FromOptions(DatasetBase* input, DatasetBase** output);
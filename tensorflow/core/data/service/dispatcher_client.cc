@@ -44,8 +44,8 @@ namespace data {
 
 Status DataServiceDispatcherClient::WorkerHeartbeat(
     const std::string& worker_address, const std::string& transfer_address,
-    const std::vector<int64>& current_tasks, std::vector<TaskDef>& new_tasks,
-    std::vector<int64>& tasks_to_delete) {
+    const std::vector<int64>& current_tasks, int64 outstanding_requests,
+    std::vector<TaskDef>& new_tasks, std::vector<int64>& tasks_to_delete) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   WorkerHeartbeatRequest req;
   req.set_worker_address(worker_address);
@@ -53,6 +53,7 @@ Status DataServiceDispatcherClient::WorkerHeartbeat(
   for (int64 task : current_tasks) {
     req.add_current_tasks(task);
   }
+  req.set_outstanding_requests(outstanding_requests);
   WorkerHeartbeatResponse resp;
   grpc::ClientContext client_ctx;
   grpc::Status status = stub_->WorkerHeartbeat(&client_ctx, req, &resp);
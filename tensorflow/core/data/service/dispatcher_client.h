@@ -45,10 +45,12 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   // registered with the dispatcher, this will register the worker. The
   // dispatcher will report which new tasks the worker should run, and which
   // tasks it should delete. This is stored into `new_tasks` and
-  // `tasks_to_delete`.
+  // `tasks_to_delete`. `outstanding_requests` is the number of element
+  // requests the worker is currently serving.
   Status WorkerHeartbeat(const std::string& worker_address,
                          const std::string& transfer_address,
                          const std::vector<int64>& current_tasks,
+                         int64 outstanding_requests,
                          std::vector<TaskDef>& new_tasks,
                          std::vector<int64>& tasks_to_delete);
 
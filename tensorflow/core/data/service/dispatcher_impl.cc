@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/dispatcher_impl.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -40,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher_state.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/journal.h"
+#include "tensorflow/core/data/service/straggler_detector.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -133,6 +135,10 @@ DataServiceDispatcherImpl::DataServiceDispatcherImpl(
     dataset_store_ = absl::make_unique<FileSystemDatasetStore>(
         DatasetsDir(config_.work_dir()));
   }
+  if (config_.straggler_latency_percentile() > 0) {
+    straggler_detector_.emplace(
+        std::min(config_.straggler_latency_percentile(), 100.0));
+  }
 }
 
 DataServiceDispatcherImpl::~DataServiceDispatcherImpl() {
@@ -289,6 +295,10 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
     TF_RETURN_IF_ERROR(CreateTasksForWorker(worker_address));
     TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, assigned_tasks));
   }
+  if (straggler_detector_.has_value()) {
+    straggler_detector_->RecordOutstandingRequests(
+        worker_address, request->outstanding_requests());
+  }
   absl::flat_hash_set<int64> current_tasks;
   current_tasks.insert(request->current_tasks().cbegin(),
                        request->current_tasks().cend());
@@ -842,12 +852,46 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
     task_info->set_job_id(job->job_id);
     task_info->set_starting_round(task->starting_round);
   }
+  if (straggler_detector_.has_value()) {
+    AddTaskReadHints(*request, tasks, response);
+  }
   response->set_job_finished(job->finished);
   VLOG(4) << "Found " << response->task_info_size()
           << " tasks for job client id " << request->job_client_id();
   return Status::OK();
 }
 
+void DataServiceDispatcherImpl::AddTaskReadHints(
+    const ClientHeartbeatRequest& request,
+    const std::vector<std::shared_ptr<const Task>>& tasks,
+    ClientHeartbeatResponse* response) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  for (const auto& latency : request.task_latencies()) {
+    std::shared_ptr<const Task> task;
+    if (!state_.TaskFromId(latency.task_id(), task).ok()) {
+      continue;
+    }
+    straggler_detector_->RecordLatency(task->worker_address,
+                                       latency.mean_latency_us(),
+                                       latency.num_reads());
+  }
+  absl::flat_hash_map<std::string, StragglerDetector::Hint> hints =
+      straggler_detector_->GetHints();
+  for (const auto& task : tasks) {
+    auto it = hints.find(task->worker_address);
+    if (it == hints.end()) {
+      continue;
+    }
+    TaskReadHint* hint = response->add_task_read_hints();
+    hint->set_task_id(task->task_id);
+    hint->set_relative_latency(it->second.relative_latency);
+    hint->set_straggler(it->second.straggler);
+    if (it->second.straggler) {
+      VLOG(2) << "Worker " << task->worker_address << " is a straggler, with "
+              << it->second.relative_latency << "x the median latency";
+    }
+  }
+}
+
 Status DataServiceDispatcherImpl::GetWorkers(const GetWorkersRequest* request,
                                              GetWorkersResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
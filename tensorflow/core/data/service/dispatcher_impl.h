@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/dataset_store.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/dispatcher_state.h"
+#include "tensorflow/core/data/service/straggler_detector.h"
 #include "tensorflow/core/data/service/task_remover.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -207,6 +208,12 @@ class DataServiceDispatcherImpl {
       const absl::flat_hash_set<int64>& current_tasks,
       std::vector<std::shared_ptr<const DispatcherState::Task>>& assigned_tasks,
       WorkerHeartbeatResponse* response);
+  // Records the read latencies reported in a client heartbeat, and adds read
+  // hints for `tasks` to the heartbeat response.
+  void AddTaskReadHints(
+      const ClientHeartbeatRequest& request,
+      const std::vector<std::shared_ptr<const DispatcherState::Task>>& tasks,
+      ClientHeartbeatResponse* response);
   // Acquires a job client id to read from the given job and sets
   // `job_client_id`.
   Status AcquireJobClientId(
@@ -301,6 +308,10 @@ class DataServiceDispatcherImpl {
   // Map from task id to a TaskRemover which determines when to remove the task.
   absl::flat_hash_map<int64, std::shared_ptr<TaskRemover>> remove_task_requests_
       TF_GUARDED_BY(mu_);
+  // Tracks worker read latencies to find stragglers. Like
+  // `round_robin_rounds_`, this is based on heartbeats and is not journaled.
+  // Unset if straggler detection is disabled.
+  absl::optional<StragglerDetector> straggler_detector_ TF_GUARDED_BY(mu_);
 
   absl::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
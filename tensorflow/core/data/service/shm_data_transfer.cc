@@ -0,0 +1,616 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include "tensorflow/core/platform/platform.h"
+
+#if defined(PLATFORM_POSIX) || defined(PLATFORM_GOOGLE)
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/error.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Each tensor in a region is preceded by a header of this many bytes, and its
+// content is aligned to this many bytes.
+constexpr uint64 kSlotAlignment = Allocator::kAllocatorAlignment;
+
+// The header of a tensor in a region.
+struct SlotHeader {
+  // Set by the client once it no longer uses the tensor.
+  std::atomic<uint32> released;
+};
+static_assert(sizeof(SlotHeader) <= kSlotAlignment,
+              "SlotHeader does not fit in front of the tensor content.");
+
+uint64 RoundUp(uint64 n) {
+  return (n + kSlotAlignment - 1) / kSlotAlignment * kSlotAlignment;
+}
+
+// A mapping of a shared memory region, which is unmapped when the object is
+// destroyed.
+class ShmRegion {
+ public:
+  // Creates the region `name` of `size` bytes and maps it.
+  static Status Create(const std::string& name, uint64 size,
+                       std::shared_ptr<ShmRegion>* out) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+      return IOError(absl::StrCat("Failed to create shared memory ", name),
+                     errno);
+    }
+    if (ftruncate(fd, size) != 0) {
+      Status s = IOError(absl::StrCat("Failed to resize shared memory ", name),
+                         errno);
+      close(fd);
+      shm_unlink(name.c_str());
+      return s;
+    }
+    Status s = Map(name, fd, size, out);
+    if (!s.ok()) {
+      shm_unlink(name.c_str());
+    }
+    return s;
+  }
+
+  // Maps the existing region `name` of `size` bytes.
+  static Status Open(const std::string& name, uint64 size,
+                     std::shared_ptr<ShmRegion>* out) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+      return IOError(absl::StrCat("Failed to open shared memory ", name),
+                     errno);
+    }
+    return Map(name, fd, size, out);
+  }
+
+  ~ShmRegion() { munmap(data_, size_); }
+
+  char* data() const { return data_; }
+  uint64 size() const { return size_; }
+
+  SlotHeader* slot_header(uint64 offset) const {
+    return reinterpret_cast<SlotHeader*>(data_ + offset - kSlotAlignment);
+  }
+
+ private:
+  ShmRegion(char* data, uint64 size) : data_(data), size_(size) {}
+
+  // Maps `fd` and closes it.
+  static Status Map(const std::string& name, int fd, uint64 size,
+                    std::shared_ptr<ShmRegion>* out) {
+    void* data =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int mmap_errno = errno;
+    close(fd);
+    if (data == MAP_FAILED) {
+      return IOError(absl::StrCat("Failed to map shared memory ", name),
+                     mmap_errno);
+    }
+    out->reset(new ShmRegion(static_cast<char*>(data), size));
+    return Status::OK();
+  }
+
+  char* const data_;
+  const uint64 size_;
+};
+
+// Allocates the tensors sent to one client in its region. The memory of a
+// tensor is reused once the client has released it and all tensors allocated
+// before it.
+class ShmRing {
+ public:
+  explicit ShmRing(std::shared_ptr<ShmRegion> region)
+      : region_(std::move(region)) {}
+
+  // Returns the offset of the content of a new tensor of `num_bytes` bytes,
+  // or -1 if the free part of the ring is too small.
+  int64 Allocate(uint64 num_bytes) {
+    Reclaim();
+    const uint64 size = kSlotAlignment + RoundUp(num_bytes);
+    uint64 start;
+    if (slots_.empty()) {
+      start = 0;
+      if (size > region_->size()) return -1;
+    } else {
+      const uint64 first = slots_.front().start;
+      const uint64 end = slots_.back().start + slots_.back().size;
+      if (slots_.back().start >= first) {
+        // The live slots are contiguous: tries after them, then before them.
+        if (end + size <= region_->size()) {
+          start = end;
+        } else if (size <= first) {
+          start = 0;
+        } else {
+          return -1;
+        }
+      } else {
+        // The live slots wrap around: tries between the last and the first.
+        if (end + size > first) return -1;
+        start = end;
+      }
+    }
+    slots_.push_back({start, size});
+    const uint64 offset = start + kSlotAlignment;
+    region_->slot_header(offset)->released.store(0, std::memory_order_relaxed);
+    return offset;
+  }
+
+ private:
+  struct Slot {
+    uint64 start;
+    uint64 size;
+  };
+
+  void Reclaim() {
+    while (!slots_.empty() &&
+           region_->slot_header(slots_.front().start + kSlotAlignment)
+               ->released.load(std::memory_order_acquire)) {
+      slots_.pop_front();
+    }
+  }
+
+  const std::shared_ptr<ShmRegion> region_;
+  // The slots that may still be in use, in allocation order.
+  std::deque<Slot> slots_;
+};
+
+// A tensor buffer in the region of a client, which is released to the server
+// when the buffer is destroyed.
+class ShmTensorBuffer : public TensorBuffer {
+ public:
+  ShmTensorBuffer(std::shared_ptr<ShmRegion> region, uint64 offset,
+                  uint64 num_bytes)
+      : TensorBuffer(region->data() + offset),
+        region_(std::move(region)),
+        offset_(offset),
+        num_bytes_(num_bytes) {}
+
+  ~ShmTensorBuffer() override {
+    region_->slot_header(offset_)->released.store(1,
+                                                  std::memory_order_release);
+  }
+
+  size_t size() const override { return num_bytes_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(num_bytes_);
+    proto->set_allocator_name("shm_data_transfer");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ShmRegion> region_;
+  const uint64 offset_;
+  const uint64 num_bytes_;
+};
+
+Status WriteAll(int fd, const char* data, size_t n) {
+  while (n > 0) {
+    ssize_t written = send(fd, data, n, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return errors::Unavailable("Failed to send to the shm transfer peer: ",
+                                 strerror(errno));
+    }
+    data += written;
+    n -= written;
+  }
+  return Status::OK();
+}
+
+Status ReadAll(int fd, char* data, size_t n) {
+  while (n > 0) {
+    ssize_t read = recv(fd, data, n, 0);
+    if (read < 0 && errno == EINTR) continue;
+    if (read <= 0) {
+      return errors::Unavailable(
+          "Failed to receive from the shm transfer peer: ",
+          read == 0 ? "connection closed" : strerror(errno));
+    }
+    data += read;
+    n -= read;
+  }
+  return Status::OK();
+}
+
+// Messages are sent as their fixed64 encoded size followed by their bytes.
+Status WriteMessage(int fd, const protobuf::MessageLite& message) {
+  std::string data;
+  core::PutFixed64(&data, message.ByteSizeLong());
+  if (!message.AppendToString(&data)) {
+    return errors::Internal("Failed to serialize ", message.GetTypeName());
+  }
+  return WriteAll(fd, data.data(), data.size());
+}
+
+Status ReadMessage(int fd, protobuf::MessageLite* message) {
+  char size_buffer[sizeof(uint64)];
+  TF_RETURN_IF_ERROR(ReadAll(fd, size_buffer, sizeof(size_buffer)));
+  std::string data(core::DecodeFixed64(size_buffer), '\0');
+  TF_RETURN_IF_ERROR(ReadAll(fd, &data[0], data.size()));
+  if (!message->ParseFromString(data)) {
+    return errors::Internal("Failed to parse ", message->GetTypeName());
+  }
+  return Status::OK();
+}
+
+Status ErrorStatus(int32 code, const std::string& message) {
+  return Status(static_cast<error::Code>(code), message);
+}
+
+class ShmDataTransferServer : public DataTransferServer {
+ public:
+  explicit ShmDataTransferServer(GetElementT get_element)
+      : get_element_(std::move(get_element)) {}
+
+  ~ShmDataTransferServer() override {
+    std::vector<std::unique_ptr<Thread>> client_threads;
+    {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      for (int fd : client_fds_) {
+        shutdown(fd, SHUT_RDWR);
+      }
+      client_threads = std::move(client_threads_);
+    }
+    if (listen_fd_ >= 0) {
+      shutdown(listen_fd_, SHUT_RDWR);
+    }
+    // Joins the threads.
+    accept_thread_.reset();
+    client_threads.clear();
+    if (listen_fd_ >= 0) {
+      close(listen_fd_);
+    }
+  }
+
+  Status Start() override {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+      return IOError("Failed to create shm transfer socket", errno);
+    }
+    // Only local clients can map the regions, so the server only listens on
+    // the loopback interface.
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addr_len = sizeof(addr);
+    if (bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr),
+             sizeof(addr)) != 0 ||
+        listen(listen_fd_, SOMAXCONN) != 0 ||
+        getsockname(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr),
+                    &addr_len) != 0) {
+      return IOError("Failed to listen for shm transfer clients", errno);
+    }
+    port_ = ntohs(addr.sin_port);
+    accept_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_shm_transfer_accept", [this]() { AcceptLoop(); }));
+    return Status::OK();
+  }
+
+  int get_port() override { return port_; }
+
+ private:
+  void AcceptLoop() {
+    while (true) {
+      int fd = accept(listen_fd_, nullptr, nullptr);
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        if (fd >= 0) close(fd);
+        return;
+      }
+      if (fd < 0) {
+        if (errno == EINTR || errno == ECONNABORTED) continue;
+        LOG(WARNING) << "Failed to accept shm transfer client: "
+                     << strerror(errno);
+        return;
+      }
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      client_fds_.insert(fd);
+      const std::string region_name =
+          absl::StrCat("/tf_data_shm_", getpid(), "_", port_, "_",
+                       next_region_id_++);
+      client_threads_.push_back(absl::WrapUnique(Env::Default()->StartThread(
+          {}, "tf_data_shm_transfer_client",
+          [this, fd, region_name]() { ServeClient(fd, region_name); })));
+    }
+  }
+
+  void ServeClient(int fd, const std::string& region_name) {
+    std::shared_ptr<ShmRegion> region;
+    Status s =
+        ShmRegion::Create(region_name, kShmTransferRegionBytes, &region);
+    ShmTransferHandshake handshake;
+    handshake.set_region_name(region_name);
+    handshake.set_region_size(kShmTransferRegionBytes);
+    handshake.set_error_code(s.code());
+    handshake.set_error_message(s.error_message());
+    if (WriteMessage(fd, handshake).ok() && s.ok()) {
+      ServeRequests(fd, region_name, region);
+    }
+    if (s.ok()) {
+      // A no-op unless the client disconnected before its first request.
+      shm_unlink(region_name.c_str());
+    }
+    mutex_lock l(mu_);
+    client_fds_.erase(fd);
+    close(fd);
+  }
+
+  void ServeRequests(int fd, const std::string& region_name,
+                     std::shared_ptr<ShmRegion> region) {
+    ShmRing ring(region);
+    bool unlinked = false;
+    while (true) {
+      GetElementRequest request;
+      if (!ReadMessage(fd, &request).ok()) return;
+      if (!unlinked) {
+        // The client maps the region before sending its first request, so
+        // the name is no longer needed. The memory is freed once both sides
+        // have unmapped it.
+        shm_unlink(region_name.c_str());
+        unlinked = true;
+      }
+      ShmGetElementResponse response;
+      Status s = GetElement(request, *region, ring, &response);
+      if (!s.ok()) {
+        response.Clear();
+        response.set_error_code(s.code());
+        response.set_error_message(s.error_message());
+      }
+      if (!WriteMessage(fd, response).ok()) return;
+    }
+  }
+
+  Status GetElement(const GetElementRequest& request, const ShmRegion& region,
+                    ShmRing& ring, ShmGetElementResponse* response) {
+    GetElementResult result;
+    TF_RETURN_IF_ERROR(get_element_(&request, &result));
+    response->set_element_index(result.element_index);
+    response->set_end_of_sequence(result.end_of_sequence);
+    response->set_skip_task(result.skip);
+    if (result.end_of_sequence || result.skip) {
+      return Status::OK();
+    }
+    if (result.components.size() == 1 &&
+        result.components[0].dtype() == DT_VARIANT &&
+        TensorShapeUtils::IsScalar(result.components[0].shape())) {
+      const CompressedElement* compressed =
+          result.components[0].scalar<Variant>()().get<CompressedElement>();
+      if (compressed != nullptr) {
+        *response->mutable_compressed() = *compressed;
+        return Status::OK();
+      }
+    }
+    for (const Tensor& component : result.components) {
+      ShmGetElementResponse::Component* response_component =
+          response->add_components();
+      TensorProto* tensor = response_component->mutable_tensor();
+      const StringPiece data = DataTypeCanUseMemcpy(component.dtype())
+                                   ? component.tensor_data()
+                                   : StringPiece();
+      const int64 offset = data.empty() ? -1 : ring.Allocate(data.size());
+      if (offset < 0) {
+        component.AsProtoTensorContent(tensor);
+        continue;
+      }
+      std::memcpy(region.data() + offset, data.data(), data.size());
+      tensor->set_dtype(component.dtype());
+      component.shape().AsProto(tensor->mutable_tensor_shape());
+      response_component->set_in_shared_memory(true);
+      response_component->set_offset(offset);
+    }
+    return Status::OK();
+  }
+
+  const GetElementT get_element_;
+  int listen_fd_ = -1;
+  int port_ = 0;
+  std::unique_ptr<Thread> accept_thread_;
+
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  int64 next_region_id_ TF_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_set<int> client_fds_ TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<Thread>> client_threads_ TF_GUARDED_BY(mu_);
+};
+
+class ShmDataTransferClient : public DataTransferClient {
+ public:
+  // Connects to the server at `address`, whose host must be local.
+  static Status Connect(const std::string& address,
+                        std::unique_ptr<DataTransferClient>* out) {
+    std::vector<std::string> host_and_port =
+        absl::StrSplit(address, absl::MaxSplits(':', 1));
+    int port;
+    if (host_and_port.size() != 2 ||
+        !absl::SimpleAtoi(host_and_port[1], &port)) {
+      return errors::InvalidArgument("Invalid shm transfer address ", address);
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+      return IOError("Failed to create shm transfer socket", errno);
+    }
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr),
+                sizeof(addr)) != 0) {
+      Status s = IOError(
+          absl::StrCat("Failed to connect to shm transfer server ", address),
+          errno);
+      close(fd);
+      return errors::Unavailable(s.error_message());
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    ShmTransferHandshake handshake;
+    std::shared_ptr<ShmRegion> region;
+    Status s = ReadMessage(fd, &handshake);
+    if (s.ok()) {
+      s = ErrorStatus(handshake.error_code(), handshake.error_message());
+    }
+    if (s.ok()) {
+      s = ShmRegion::Open(handshake.region_name(), handshake.region_size(),
+                          &region);
+    }
+    if (!s.ok()) {
+      close(fd);
+      return s;
+    }
+    out->reset(new ShmDataTransferClient(fd, std::move(region)));
+    return Status::OK();
+  }
+
+  ~ShmDataTransferClient() override { close(fd_); }
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    VLOG(3) << "GetElement for task " << req.task_id()
+            << " from shm transfer server.";
+    {
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+    }
+    ShmGetElementResponse resp;
+    {
+      mutex_lock l(socket_mu_);
+      TF_RETURN_IF_ERROR(WriteMessage(fd_, req));
+      TF_RETURN_IF_ERROR(ReadMessage(fd_, &resp));
+    }
+    TF_RETURN_IF_ERROR(ErrorStatus(resp.error_code(), resp.error_message()));
+    result.element_index = resp.element_index();
+    result.end_of_sequence = resp.end_of_sequence();
+    result.skip = resp.skip_task();
+    if (resp.has_compressed()) {
+      Tensor tensor(DT_VARIANT, TensorShape{});
+      tensor.scalar<Variant>()() = std::move(*resp.mutable_compressed());
+      result.components.push_back(tensor);
+      return Status::OK();
+    }
+    for (const auto& component : resp.components()) {
+      if (!component.in_shared_memory()) {
+        result.components.emplace_back();
+        if (!result.components.back().FromProto(component.tensor())) {
+          return errors::Internal("Failed to parse tensor.");
+        }
+        continue;
+      }
+      const DataType dtype = component.tensor().dtype();
+      TensorShape shape;
+      TF_RETURN_IF_ERROR(TensorShape::BuildTensorShapeBase(
+          component.tensor().tensor_shape(), &shape));
+      const uint64 num_bytes = shape.num_elements() * DataTypeSize(dtype);
+      if (component.offset() < kSlotAlignment ||
+          component.offset() + num_bytes > region_->size()) {
+        return errors::Internal("Tensor of ", num_bytes, " bytes at offset ",
+                                component.offset(),
+                                " is outside the shared memory region.");
+      }
+      auto* buffer = new ShmTensorBuffer(region_, component.offset(),
+                                         num_bytes);
+      result.components.emplace_back(dtype, shape, buffer);
+      buffer->Unref();
+    }
+    return Status::OK();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel ShmDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    shutdown(fd_, SHUT_RDWR);
+  }
+
+ private:
+  ShmDataTransferClient(int fd, std::shared_ptr<ShmRegion> region)
+      : fd_(fd), region_(std::move(region)) {}
+
+  const int fd_;
+  const std::shared_ptr<ShmRegion> region_;
+  // Serializes requests, which share the socket.
+  mutex socket_mu_;
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+};
+
+class ShmTransferRegistrar {
+ public:
+  ShmTransferRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol,
+        [](DataTransferServer::GetElementT get_element) {
+          return std::make_shared<ShmDataTransferServer>(
+              std::move(get_element));
+        });
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* out) {
+          return ShmDataTransferClient::Connect(config.address, out);
+        });
+  }
+};
+static ShmTransferRegistrar shm_transfer_registrar;
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // defined(PLATFORM_POSIX) || defined(PLATFORM_GOOGLE)
@@ -0,0 +1,48 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// The "shm" data transfer protocol moves elements from a tf.data service
+// worker to clients in other processes on the same host without serializing
+// them.
+//
+// The server listens for clients on a loopback port. When a client connects,
+// the server creates a shared memory region for it, and copies the tensors of
+// the elements requested by the client into that region. The client maps the
+// region and wraps its tensors around the mapped memory. Requests and the
+// metadata of responses are sent over the socket.
+//
+// The region is used as a ring: the server reuses the memory of a tensor once
+// the client has released it and all tensors sent before it. Components that
+// cannot be copied bytewise (e.g. strings), and components that do not fit
+// into the free part of the ring, are sent over the socket instead.
+//
+// The protocol is selected by setting `data_transfer_protocol` to "shm" in
+// both the worker config and the dataset.
+constexpr const char kShmTransferProtocol[] = "shm";
+
+// The size of the shared memory region of each client.
+constexpr uint64 kShmTransferRegionBytes = 256 << 20;
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
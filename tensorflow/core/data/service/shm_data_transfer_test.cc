@@ -0,0 +1,169 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Returns whether `tensor` was received through the shared memory region.
+bool InSharedMemory(const Tensor& tensor) {
+  TensorDescription description;
+  tensor.FillDescription(&description);
+  return description.allocation_description().allocator_name() ==
+         "shm_data_transfer";
+}
+
+class ShmDataTransferTest : public ::testing::Test {
+ protected:
+  // Starts a server that returns the results of `get_element`, and connects a
+  // client to it.
+  void Start(DataTransferServer::GetElementT get_element) {
+    TF_ASSERT_OK(DataTransferServer::Build(kShmTransferProtocol,
+                                           std::move(get_element), &server_));
+    TF_ASSERT_OK(server_->Start());
+    DataTransferClient::Config config;
+    config.protocol = kShmTransferProtocol;
+    config.address = absl::StrCat("localhost:", server_->get_port());
+    TF_ASSERT_OK(DataTransferClient::Build(kShmTransferProtocol, config,
+                                           &client_));
+  }
+
+  Status GetElement(GetElementResult& result) {
+    GetElementRequest request;
+    request.set_task_id(1);
+    return client_->GetElement(request, result);
+  }
+
+  std::shared_ptr<DataTransferServer> server_;
+  std::unique_ptr<DataTransferClient> client_;
+};
+
+TEST_F(ShmDataTransferTest, TransfersTensorsThroughSharedMemory) {
+  Start([](const GetElementRequest* request, GetElementResult* result) {
+    result->components.push_back(
+        test::AsTensor<float>({1.0, 2.0, 3.0, 4.0}, TensorShape({2, 2})));
+    result->components.push_back(test::AsScalar<tstring>("element"));
+    result->element_index = 7;
+    result->end_of_sequence = false;
+    result->skip = false;
+    return Status::OK();
+  });
+
+  GetElementResult result;
+  TF_ASSERT_OK(GetElement(result));
+  EXPECT_EQ(result.element_index, 7);
+  EXPECT_FALSE(result.end_of_sequence);
+  EXPECT_FALSE(result.skip);
+  ASSERT_EQ(result.components.size(), 2);
+  test::ExpectEqual(
+      result.components[0],
+      test::AsTensor<float>({1.0, 2.0, 3.0, 4.0}, TensorShape({2, 2})));
+  EXPECT_TRUE(InSharedMemory(result.components[0]));
+  // Strings cannot be copied bytewise, so they are sent over the socket.
+  test::ExpectEqual(result.components[1], test::AsScalar<tstring>("element"));
+  EXPECT_FALSE(InSharedMemory(result.components[1]));
+}
+
+TEST_F(ShmDataTransferTest, EndOfSequence) {
+  Start([](const GetElementRequest* request, GetElementResult* result) {
+    result->end_of_sequence = true;
+    result->skip = false;
+    return Status::OK();
+  });
+
+  GetElementResult result;
+  TF_ASSERT_OK(GetElement(result));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST_F(ShmDataTransferTest, PropagatesErrors) {
+  Start([](const GetElementRequest* request, GetElementResult* result) {
+    return errors::FailedPrecondition("Task ", request->task_id(),
+                                      " is not ready.");
+  });
+
+  GetElementResult result;
+  Status s = GetElement(result);
+  EXPECT_TRUE(errors::IsFailedPrecondition(s)) << s;
+  EXPECT_EQ(s.error_message(), "Task 1 is not ready.");
+}
+
+TEST_F(ShmDataTransferTest, ReusesReleasedMemory) {
+  // Each element is 1/8 of the region, so the region is reused several times.
+  const int64 num_elements = kShmTransferRegionBytes / 8 / sizeof(float);
+  Start([num_elements](const GetElementRequest* request,
+                       GetElementResult* result) {
+    Tensor tensor(DT_FLOAT, TensorShape({num_elements}));
+    tensor.flat<float>().setConstant(1.0);
+    result->components.push_back(tensor);
+    result->end_of_sequence = false;
+    result->skip = false;
+    return Status::OK();
+  });
+
+  for (int i = 0; i < 32; ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(GetElement(result));
+    ASSERT_EQ(result.components.size(), 1);
+    EXPECT_TRUE(InSharedMemory(result.components[0]));
+    EXPECT_EQ(result.components[0].flat<float>()(num_elements - 1), 1.0);
+  }
+}
+
+TEST_F(ShmDataTransferTest, FallsBackToSocketWhenRegionIsFull) {
+  const int64 num_elements = kShmTransferRegionBytes / 8 / sizeof(float);
+  Start([num_elements](const GetElementRequest* request,
+                       GetElementResult* result) {
+    Tensor tensor(DT_FLOAT, TensorShape({num_elements}));
+    tensor.flat<float>().setConstant(1.0);
+    result->components.push_back(tensor);
+    result->end_of_sequence = false;
+    result->skip = false;
+    return Status::OK();
+  });
+
+  // Holds on to the received tensors, so their memory cannot be reused.
+  std::vector<Tensor> tensors;
+  for (int i = 0; i < 8; ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(GetElement(result));
+    ASSERT_EQ(result.components.size(), 1);
+    tensors.push_back(result.components[0]);
+  }
+  EXPECT_TRUE(InSharedMemory(tensors.front()));
+  EXPECT_FALSE(InSharedMemory(tensors.back()));
+  EXPECT_EQ(tensors.back().flat<float>()(num_elements - 1), 1.0);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,97 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/straggler_detector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+// The weight of a new latency report in the moving average of a worker's
+// latency.
+constexpr double kLatencySmoothing = 0.2;
+}  // namespace
+
+constexpr double StragglerDetector::kMinStragglerRelativeLatency;
+
+StragglerDetector::StragglerDetector(double straggler_latency_percentile)
+    : straggler_latency_percentile_(straggler_latency_percentile) {
+  DCHECK_GT(straggler_latency_percentile, 0.0);
+  DCHECK_LE(straggler_latency_percentile, 100.0);
+}
+
+void StragglerDetector::RecordLatency(const std::string& worker_address,
+                                      int64 mean_latency_us, int64 num_reads) {
+  if (num_reads <= 0 || mean_latency_us < 0) {
+    return;
+  }
+  WorkerStats& stats = workers_[worker_address];
+  if (stats.latency_us < 0) {
+    stats.latency_us = mean_latency_us;
+  } else {
+    stats.latency_us = (1.0 - kLatencySmoothing) * stats.latency_us +
+                       kLatencySmoothing * mean_latency_us;
+  }
+}
+
+void StragglerDetector::RecordOutstandingRequests(
+    const std::string& worker_address, int64 outstanding_requests) {
+  workers_[worker_address].outstanding_requests =
+      std::max<int64>(outstanding_requests, 0);
+}
+
+absl::flat_hash_map<std::string, StragglerDetector::Hint>
+StragglerDetector::GetHints() const {
+  absl::flat_hash_map<std::string, double> expected_latencies;
+  std::vector<double> sorted_latencies;
+  for (const auto& worker : workers_) {
+    const WorkerStats& stats = worker.second;
+    if (stats.latency_us < 0) {
+      continue;
+    }
+    // Requests queued on the worker are served before new ones.
+    const double expected_latency =
+        stats.latency_us * (stats.outstanding_requests + 1);
+    expected_latencies[worker.first] = expected_latency;
+    sorted_latencies.push_back(expected_latency);
+  }
+  absl::flat_hash_map<std::string, Hint> hints;
+  if (sorted_latencies.empty()) {
+    return hints;
+  }
+  std::sort(sorted_latencies.begin(), sorted_latencies.end());
+  const double median = sorted_latencies[(sorted_latencies.size() - 1) / 2];
+  const int64 percentile_rank = static_cast<int64>(std::ceil(
+      straggler_latency_percentile_ / 100.0 * sorted_latencies.size()));
+  const double percentile = sorted_latencies[std::min<int64>(
+      std::max<int64>(percentile_rank - 1, 0), sorted_latencies.size() - 1)];
+  for (const auto& worker : expected_latencies) {
+    Hint& hint = hints[worker.first];
+    hint.relative_latency = median > 0 ? worker.second / median : 1.0;
+    hint.straggler = worker.second > percentile &&
+                     hint.relative_latency >= kMinStragglerRelativeLatency;
+  }
+  return hints;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,79 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_STRAGGLER_DETECTOR_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_STRAGGLER_DETECTOR_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// A `StragglerDetector` tracks the read latency and load of tf.data service
+// workers, as reported by clients and workers, and finds the workers which are
+// much slower than the others.
+//
+// The expected latency of a worker is its smoothed latency reported by
+// clients, scaled by the number of requests the worker is currently serving. A
+// worker is a straggler if its expected latency is above the configured
+// percentile of the expected latencies of all workers, and at least
+// `kMinStragglerRelativeLatency` times their median.
+//
+// This class is thread-compatible.
+class StragglerDetector {
+ public:
+  // The minimum expected latency of a straggler, relative to the median.
+  static constexpr double kMinStragglerRelativeLatency = 1.5;
+
+  struct Hint {
+    // The expected latency of the worker relative to the median.
+    double relative_latency = 1.0;
+    bool straggler = false;
+  };
+
+  // `straggler_latency_percentile` must be in (0, 100].
+  explicit StragglerDetector(double straggler_latency_percentile);
+
+  // Records that `num_reads` requests to `worker_address` took
+  // `mean_latency_us` on average.
+  void RecordLatency(const std::string& worker_address, int64 mean_latency_us,
+                     int64 num_reads);
+
+  // Records that `worker_address` is serving `outstanding_requests` requests.
+  void RecordOutstandingRequests(const std::string& worker_address,
+                                 int64 outstanding_requests);
+
+  // Returns hints for the workers that clients have reported latencies for,
+  // keyed by worker address.
+  absl::flat_hash_map<std::string, Hint> GetHints() const;
+
+ private:
+  struct WorkerStats {
+    // Exponential moving average of the latencies reported for the worker, or
+    // a negative value if no latency has been reported.
+    double latency_us = -1.0;
+    int64 outstanding_requests = 0;
+  };
+
+  const double straggler_latency_percentile_;
+  absl::flat_hash_map<std::string, WorkerStats> workers_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_STRAGGLER_DETECTOR_H_
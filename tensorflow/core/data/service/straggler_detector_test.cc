@@ -0,0 +1,90 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/straggler_detector.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(StragglerDetectorTest, NoReportedLatencies) {
+  StragglerDetector detector(/*straggler_latency_percentile=*/90);
+  detector.RecordOutstandingRequests("worker", 10);
+  EXPECT_TRUE(detector.GetHints().empty());
+}
+
+TEST(StragglerDetectorTest, SingleWorkerIsNotStraggler) {
+  StragglerDetector detector(/*straggler_latency_percentile=*/90);
+  detector.RecordLatency("worker", /*mean_latency_us=*/1000, /*num_reads=*/4);
+  auto hints = detector.GetHints();
+  ASSERT_EQ(hints.size(), 1);
+  EXPECT_DOUBLE_EQ(hints["worker"].relative_latency, 1.0);
+  EXPECT_FALSE(hints["worker"].straggler);
+}
+
+TEST(StragglerDetectorTest, FindsSlowWorker) {
+  StragglerDetector detector(/*straggler_latency_percentile=*/90);
+  for (int i = 0; i < 9; ++i) {
+    detector.RecordLatency(absl::StrCat("worker_", i), 1000, 4);
+  }
+  detector.RecordLatency("slow_worker", 5000, 4);
+  auto hints = detector.GetHints();
+  ASSERT_EQ(hints.size(), 10);
+  EXPECT_DOUBLE_EQ(hints["slow_worker"].relative_latency, 5.0);
+  EXPECT_TRUE(hints["slow_worker"].straggler);
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_FALSE(hints[absl::StrCat("worker_", i)].straggler);
+  }
+}
+
+TEST(StragglerDetectorTest, IgnoresSmallDifferences) {
+  StragglerDetector detector(/*straggler_latency_percentile=*/50);
+  detector.RecordLatency("worker_0", 1000, 4);
+  detector.RecordLatency("worker_1", 1000, 4);
+  detector.RecordLatency("worker_2", 1200, 4);
+  EXPECT_FALSE(detector.GetHints()["worker_2"].straggler);
+}
+
+TEST(StragglerDetectorTest, AccountsForOutstandingRequests) {
+  StragglerDetector detector(/*straggler_latency_percentile=*/50);
+  detector.RecordLatency("worker_0", 1000, 4);
+  detector.RecordLatency("worker_1", 1000, 4);
+  detector.RecordLatency("worker_2", 1000, 4);
+  detector.RecordOutstandingRequests("worker_2", 3);
+  auto hints = detector.GetHints();
+  EXPECT_DOUBLE_EQ(hints["worker_2"].relative_latency, 4.0);
+  EXPECT_TRUE(hints["worker_2"].straggler);
+}
+
+TEST(StragglerDetectorTest, SmoothsLatencies) {
+  StragglerDetector detector(/*straggler_latency_percentile=*/50);
+  detector.RecordLatency("worker_0", 1000, 4);
+  detector.RecordLatency("worker_1", 1000, 4);
+  // A single slow report is not enough to make a worker a straggler.
+  detector.RecordLatency("worker_1", 3000, 4);
+  EXPECT_FALSE(detector.GetHints()["worker_1"].straggler);
+  for (int i = 0; i < 10; ++i) {
+    detector.RecordLatency("worker_1", 3000, 4);
+  }
+  EXPECT_TRUE(detector.GetHints()["worker_1"].straggler);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
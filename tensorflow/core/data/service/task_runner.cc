@@ -202,6 +202,9 @@ Status RoundRobinTaskRunner::PrepareRound(const GetElementRequest& req) {
     int64 wait_us = kWaitBeforeSkipUs;
     if (!req.allow_skip()) {
       wait_us = -1;
+    } else if (req.straggler()) {
+      // Don't hold up the consumers for the data of a straggling worker.
+      wait_us = 0;
     }
     TF_RETURN_IF_ERROR(PrepareFullRound(wait_us));
   }
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -75,6 +76,25 @@ class TestErrorIterator : public TaskIterator {
   const Status status_;
 };
 
+// Produces the elements of `dataset` once `ready` is notified.
+class BlockingTaskIterator : public TaskIterator {
+ public:
+  BlockingTaskIterator(const std::vector<std::vector<Tensor>>& elements,
+                       Notification& ready)
+      : iterator_(elements, /*repeat=*/false), ready_(ready) {}
+
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override {
+    ready_.WaitForNotification();
+    return iterator_.GetNext(element, end_of_sequence);
+  }
+
+  int64 Cardinality() const override { return kInfiniteCardinality; }
+
+ private:
+  TestTaskIterator iterator_;
+  Notification& ready_;
+};
+
 std::vector<std::vector<Tensor>> GetRangeDataset(const size_t range) {
   std::vector<std::vector<Tensor>> dataset;
   for (int64 i = 0; i < range; ++i) {
@@ -270,5 +290,32 @@ TEST(RoundRobinTaskRunner, ConsumeParallelPartialRound) {
               expected_consumer_results[consumer]);
   }
 }
+
+TEST(RoundRobinTaskRunner, StragglerSkipsRoundWithoutWaiting) {
+  std::vector<std::vector<Tensor>> elements = GetRangeDataset(10);
+  Notification ready;
+  RoundRobinTaskRunner runner(
+      absl::make_unique<BlockingTaskIterator>(elements, ready),
+      /*num_consumers=*/1,
+      /*worker_address=*/"test_worker_address");
+  GetElementRequest request;
+  request.set_round_index(0);
+  request.set_consumer_index(0);
+  request.set_allow_skip(true);
+  request.set_straggler(true);
+  GetElementResult result;
+  TF_ASSERT_OK(runner.GetNext(request, result));
+  EXPECT_TRUE(result.skip);
+
+  // The skipped round's data is returned in the next round.
+  ready.Notify();
+  request.set_round_index(1);
+  request.set_skipped_previous_round(true);
+  request.set_allow_skip(false);
+  TF_ASSERT_OK(runner.GetNext(request, result));
+  EXPECT_FALSE(result.skip);
+  ASSERT_EQ(result.components.size(), 1);
+  test::ExpectEqual(result.components[0], elements[0][0]);
+}
 }  // namespace data
 }  // namespace tensorflow
@@ -425,17 +425,19 @@ void DataServiceWorkerImpl::HeartbeatThread() TF_LOCKS_EXCLUDED(mu_) {
 
 Status DataServiceWorkerImpl::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
   std::vector<int64> current_tasks;
+  int64 outstanding_requests = 0;
   {
     mutex_lock l(mu_);
     for (const auto& task : tasks_) {
       current_tasks.push_back(task.first);
+      outstanding_requests += task.second->outstanding_requests;
     }
   }
   std::vector<TaskDef> new_tasks;
   std::vector<int64> task_ids_to_delete;
   TF_RETURN_IF_ERROR(dispatcher_->WorkerHeartbeat(
-      worker_address_, transfer_address_, current_tasks, new_tasks,
-      task_ids_to_delete));
+      worker_address_, transfer_address_, current_tasks, outstanding_requests,
+      new_tasks, task_ids_to_delete));
   std::vector<std::shared_ptr<Task>> tasks_to_delete;
   {
     mutex_lock l(mu_);
@@ -35,6 +35,9 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/core/lib/io/zstd/zstd_inputstream.h"
+#include "tensorflow/core/lib/io/zstd/zstd_outputbuffer.h"
 #include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system.h"
@@ -95,6 +98,28 @@ std::string GetCheckpointFileName(const std::string& shard_directory,
                       static_cast<unsigned long long>(checkpoint_id)));
 }
 
+Status WriteChunkDoneFile(Env* env, const std::string& checkpoint_filename) {
+  return WriteStringToFile(
+      env, absl::StrCat(checkpoint_filename, kChunkDoneSuffix), "");
+}
+
+Status ListCompletedChunks(Env* env, const std::string& run_directory,
+                           std::vector<std::string>* checkpoint_filenames) {
+  std::vector<std::string> done_files;
+  TF_RETURN_IF_ERROR(env->GetMatchingPaths(
+      io::JoinPath(run_directory, absl::StrCat("*", kShardDirectorySuffix),
+                   absl::StrCat("*.snapshot", kChunkDoneSuffix)),
+      &done_files));
+  checkpoint_filenames->clear();
+  checkpoint_filenames->reserve(done_files.size());
+  for (const std::string& done_file : done_files) {
+    checkpoint_filenames->push_back(
+        done_file.substr(0, done_file.size() - strlen(kChunkDoneSuffix)));
+  }
+  std::sort(checkpoint_filenames->begin(), checkpoint_filenames->end());
+  return Status::OK();
+}
+
 Status Writer::Create(Env* env, const std::string& filename,
                       const std::string& compression_type, int version,
                       const DataTypeVector& dtypes,
@@ -198,6 +223,12 @@ Status CustomWriter::Initialize(tensorflow::Env* env) {
         zlib_options.output_buffer_size, zlib_options);
     TF_CHECK_OK(zlib_output_buffer->Init());
     dest_.reset(zlib_output_buffer);
+  } else if (compression_type_ == io::compression::kZstd) {
+    zlib_underlying_dest_.swap(dest_);
+    auto zstd_output_buffer = absl::make_unique<io::ZstdOutputBuffer>(
+        zlib_underlying_dest_.get(), io::ZstdCompressionOptions());
+    TF_RETURN_IF_ERROR(zstd_output_buffer->Init());
+    dest_ = std::move(zstd_output_buffer);
   }
 #endif  // IS_SLIM_BUILD
   simple_tensor_mask_.reserve(dtypes_.size());
@@ -767,6 +798,9 @@ Status CustomReader::Initialize(Env* env) {
     input_stream_ = absl::make_unique<io::ZlibInputStream>(
         input_stream_.release(), zlib_options.input_buffer_size,
         zlib_options.output_buffer_size, zlib_options, true);
+  } else if (compression_type_ == io::compression::kZstd) {
+    input_stream_ = absl::make_unique<io::ZstdInputStream>(
+        input_stream_.release(), io::ZstdCompressionOptions(), true);
   } else if (compression_type_ == io::compression::kSnappy) {
     if (version_ == 0) {
       input_stream_ = absl::make_unique<io::SnappyInputBuffer>(
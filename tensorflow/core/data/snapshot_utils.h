@@ -51,8 +51,9 @@ constexpr char kModeWrite[] = "write";
 constexpr char kModeRead[] = "read";
 constexpr char kModePassthrough[] = "passthrough";
 constexpr char kShardDirectorySuffix[] = ".shard";
+constexpr char kChunkDoneSuffix[] = ".done";
 
-enum Mode { READER = 0, WRITER = 1, PASSTHROUGH = 2 };
+enum Mode { READER = 0, WRITER = 1, PASSTHROUGH = 2, STREAMING_READER = 3 };
 
 // Returns the name of the "hash" directory for the given base path and hash ID.
 std::string HashDirectory(const std::string& path, uint64 hash);
@@ -70,6 +71,15 @@ std::string ShardDirectory(const std::string& run_directory, int64 shard_id);
 std::string GetCheckpointFileName(const std::string& shard_directory,
                                   const uint64 checkpoint_id);
 
+// Marks the checkpoint file `checkpoint_filename` as completely written, so
+// that it can be read before the snapshot is finalized.
+Status WriteChunkDoneFile(Env* env, const std::string& checkpoint_filename);
+
+// Returns the sorted names of the checkpoint files in the shard directories of
+// `run_directory` which have been marked as completely written.
+Status ListCompletedChunks(Env* env, const std::string& run_directory,
+                           std::vector<std::string>* checkpoint_filenames);
+
 // This is a interface class that exposes snapshot writing functionality.
 class Writer {
  public:
@@ -155,9 +165,9 @@ class CustomWriter : public Writer {
   const std::string filename_;
   const std::string compression_type_;
   const DataTypeVector dtypes_;
-  // We hold zlib_dest_ because we may create a ZlibOutputBuffer and put that
-  // in dest_ if we want compression. ZlibOutputBuffer doesn't own the original
-  // dest_ and so we need somewhere to store the original one.
+  // We hold zlib_dest_ because we may create a ZlibOutputBuffer (or a
+  // ZstdOutputBuffer) and put that in dest_ if we want compression. Neither
+  // owns the original dest_ and so we need somewhere to store the original one.
   std::unique_ptr<WritableFile> zlib_underlying_dest_;
   std::vector<bool> simple_tensor_mask_;  // true for simple, false for complex.
   int num_simple_ = 0;
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -91,6 +92,33 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kSnappy, 2);
 }
 
+TEST(SnapshotUtilTest, ListCompletedChunks) {
+  Env* env = Env::Default();
+  std::string run_dir = io::JoinPath(testing::TmpDir(), "completed_chunks");
+  std::string shard_0 = ShardDirectory(run_dir, 0);
+  std::string shard_1 = ShardDirectory(run_dir, 1);
+  TF_ASSERT_OK(env->RecursivelyCreateDir(shard_0));
+  TF_ASSERT_OK(env->RecursivelyCreateDir(shard_1));
+  // Chunks are only listed once they have been marked as done.
+  for (const std::string& chunk :
+       {GetCheckpointFileName(shard_0, 0), GetCheckpointFileName(shard_0, 1),
+        GetCheckpointFileName(shard_1, 0)}) {
+    TF_ASSERT_OK(WriteStringToFile(env, chunk, "chunk"));
+  }
+  TF_ASSERT_OK(WriteChunkDoneFile(env, GetCheckpointFileName(shard_1, 0)));
+  TF_ASSERT_OK(WriteChunkDoneFile(env, GetCheckpointFileName(shard_0, 0)));
+
+  std::vector<std::string> chunks;
+  TF_ASSERT_OK(ListCompletedChunks(env, run_dir, &chunks));
+  EXPECT_EQ(chunks,
+            std::vector<std::string>({GetCheckpointFileName(shard_0, 0),
+                                      GetCheckpointFileName(shard_1, 0)}));
+
+  int64 undeleted_files, undeleted_dirs;
+  TF_ASSERT_OK(
+      env->DeleteRecursively(run_dir, &undeleted_files, &undeleted_dirs));
+}
+
 void SnapshotReaderBenchmarkLoop(::testing::benchmark::State& state,
                                  std::string compression_type, int version) {
   tensorflow::DataTypeVector dtypes;
@@ -0,0 +1,247 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Per-element benchmarks of core tf.data transformations, run through the
+// standalone API so that only the C++ iterators are measured.
+//
+// Each benchmark takes (number of threads, element size in floats). The
+// pipeline is `TensorDataset(element).repeat(kEpochSize)`, followed by the
+// transformation under test and an infinite repeat, and every benchmark
+// iteration is one GetNext call. Run with
+// `--benchmarks=all` and TEST_REPORT_FILE_PREFIX set to also write the results
+// as BenchmarkEntries protos for trend tracking.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace data {
+namespace standalone {
+namespace {
+
+using test::function::GDef;
+using test::function::NDef;
+using FDH = FunctionDefHelper;
+
+// Number of elements in one epoch of the input.
+constexpr int64 kEpochSize = 1024;
+constexpr int64 kBatchSize = 32;
+constexpr int64 kBufferSize = 16;
+
+enum class Transformation {
+  kNone,
+  kMap,
+  kParallelMap,
+  kInterleave,
+  kBatch,
+  kShuffle,
+  kPrefetch,
+  kCache,
+};
+
+NodeDef Int64Const(const string& name, int64 value) {
+  return NDef(name, "Const", {},
+              {{"dtype", DT_INT64}, {"value", Tensor(value)}});
+}
+
+// Builds the graph of the benchmarked pipeline. Elements are float vectors of
+// `element_size` values.
+GraphDef PipelineGraph(Transformation transformation, int num_threads,
+                       int element_size) {
+  const TensorShape element_shape({element_size});
+  Tensor element(DT_FLOAT, element_shape);
+  element.flat<float>().setZero();
+  const DataTypeVector float_types = {DT_FLOAT};
+  const std::vector<TensorShape> element_shapes = {element_shape};
+  const std::vector<TensorShape> batch_shapes = {
+      TensorShape({kBatchSize, element_size})};
+  const std::vector<std::pair<string, FDH::AttrValueWrapper>> dataset_attrs = {
+      {"output_types", float_types}, {"output_shapes", element_shapes}};
+  auto map_attrs = dataset_attrs;
+  map_attrs.push_back({"f", FDH::FunctionRef("IdentityFn")});
+  map_attrs.push_back({"Targuments", DataTypeSlice{}});
+  auto interleave_attrs = dataset_attrs;
+  interleave_attrs.push_back({"f", FDH::FunctionRef("MakeTensorDataset")});
+  interleave_attrs.push_back({"Targuments", DataTypeSlice{}});
+
+  std::vector<NodeDef> nodes = {
+      NDef("element", "Const", {}, {{"dtype", DT_FLOAT}, {"value", element}}),
+      NDef("tensor", "TensorDataset", {"element"},
+           {{"Toutput_types", float_types}, {"output_shapes", element_shapes}}),
+      Int64Const("epoch_size", kEpochSize),
+      NDef("input", "RepeatDataset", {"tensor", "epoch_size"}, dataset_attrs),
+      Int64Const("num_threads", num_threads),
+      Int64Const("batch_size", kBatchSize),
+      Int64Const("buffer_size", kBufferSize),
+      Int64Const("one", 1),
+      Int64Const("seed", 42),
+      Int64Const("infinite", -1),
+      NDef("drop_remainder", "Const", {},
+           {{"dtype", DT_BOOL}, {"value", Tensor(true)}}),
+      NDef("filename", "Const", {},
+           {{"dtype", DT_STRING}, {"value", Tensor(tstring(""))}}),
+  };
+  std::vector<std::pair<string, FDH::AttrValueWrapper>> repeat_attrs =
+      dataset_attrs;
+  switch (transformation) {
+    case Transformation::kNone:
+      nodes.push_back(
+          NDef("transformed", "Identity", {"input"}, {{"T", DT_VARIANT}}));
+      break;
+    case Transformation::kMap:
+      nodes.push_back(NDef("transformed", "MapDataset", {"input"}, map_attrs));
+      break;
+    case Transformation::kParallelMap:
+      nodes.push_back(NDef("transformed", "ParallelMapDatasetV2",
+                           {"input", "num_threads"}, map_attrs));
+      break;
+    case Transformation::kInterleave:
+      nodes.push_back(NDef("transformed", "InterleaveDataset",
+                           {"input", "num_threads", "one"}, interleave_attrs));
+      break;
+    case Transformation::kBatch:
+      nodes.push_back(NDef("transformed", "BatchDatasetV2",
+                           {"input", "batch_size", "drop_remainder"},
+                           {{"output_types", float_types},
+                            {"output_shapes", batch_shapes}}));
+      repeat_attrs = {{"output_types", float_types},
+                      {"output_shapes", batch_shapes}};
+      break;
+    case Transformation::kShuffle:
+      nodes.push_back(NDef("transformed", "ShuffleDataset",
+                           {"input", "epoch_size", "seed", "seed"},
+                           dataset_attrs));
+      break;
+    case Transformation::kPrefetch:
+      nodes.push_back(NDef("transformed", "PrefetchDataset",
+                           {"input", "buffer_size"}, dataset_attrs));
+      break;
+    case Transformation::kCache:
+      nodes.push_back(NDef("transformed", "CacheDataset",
+                           {"input", "filename"}, dataset_attrs));
+      break;
+  }
+  nodes.push_back(NDef("repeated", "RepeatDataset",
+                       {"transformed", "infinite"}, repeat_attrs));
+  nodes.push_back(NDef("dataset", "_Retval", {"repeated"},
+                       {{"T", DT_VARIANT}, {"index", 0}}));
+
+  const FunctionDef identity = FDH::Create(
+      "IdentityFn", {"x: float"}, {"y: float"}, {},
+      {{{"y_identity"}, "Identity", {"x"}, {{"T", DT_FLOAT}}}},
+      {{"y", "y_identity:output:0"}});
+  const FunctionDef make_tensor_dataset = FDH::Create(
+      "MakeTensorDataset", {"x: float"}, {"y: variant"}, {},
+      {{{"dataset"},
+        "TensorDataset",
+        {"x"},
+        {{"Toutput_types", float_types}, {"output_shapes", element_shapes}}}},
+      {{"y", "dataset:handle:0"}});
+  return GDef(nodes, {identity, make_tensor_dataset});
+}
+
+void RunPipeline(::testing::benchmark::State& state,
+                 Transformation transformation) {
+  const int num_threads = state.range(0);
+  const int element_size = state.range(1);
+  Dataset::Params params;
+  params.session_options.config.set_inter_op_parallelism_threads(num_threads);
+  std::unique_ptr<Dataset> dataset;
+  TF_CHECK_OK(Dataset::FromGraph(
+      params, PipelineGraph(transformation, num_threads, element_size),
+      &dataset));
+  std::unique_ptr<Iterator> iterator;
+  TF_CHECK_OK(dataset->MakeIterator(&iterator));
+
+  const int64 elements_per_call =
+      transformation == Transformation::kBatch ? kBatchSize : 1;
+  std::vector<Tensor> outputs;
+  bool end_of_input = false;
+  for (auto s : state) {
+    outputs.clear();
+    TF_CHECK_OK(iterator->GetNext(&outputs, &end_of_input));
+    CHECK(!end_of_input);
+  }
+  state.SetItemsProcessed(static_cast<int64>(state.iterations()) *
+                          elements_per_call);
+  state.SetBytesProcessed(static_cast<int64>(state.iterations()) *
+                          elements_per_call * element_size * sizeof(float));
+}
+
+#define BM_TRANSFORMATION(name, transformation)                     \
+  void BM_##name(::testing::benchmark::State& state) {              \
+    RunPipeline(state, transformation);                             \
+  }                                                                 \
+  BENCHMARK(BM_##name)                                              \
+      ->ArgPair(1, 1)                                               \
+      ->ArgPair(1, 1 << 14)                                         \
+      ->ArgPair(4, 1)                                               \
+      ->ArgPair(4, 1 << 14)                                         \
+      ->ArgPair(16, 1)                                              \
+      ->ArgPair(16, 1 << 14);
+
+// The baseline pipeline without a transformation. Subtract its time per
+// element from the others to get the overhead of the transformation.
+BM_TRANSFORMATION(Baseline, Transformation::kNone);
+BM_TRANSFORMATION(Map, Transformation::kMap);
+BM_TRANSFORMATION(ParallelMap, Transformation::kParallelMap);
+BM_TRANSFORMATION(Interleave, Transformation::kInterleave);
+BM_TRANSFORMATION(Batch, Transformation::kBatch);
+BM_TRANSFORMATION(Shuffle, Transformation::kShuffle);
+BM_TRANSFORMATION(Prefetch, Transformation::kPrefetch);
+BM_TRANSFORMATION(Cache, Transformation::kCache);
+
+#undef BM_TRANSFORMATION
+
+TEST(StandaloneBenchmarkTest, PipelinesProduceElements) {
+  for (Transformation transformation :
+       {Transformation::kNone, Transformation::kMap,
+        Transformation::kParallelMap, Transformation::kInterleave,
+        Transformation::kBatch, Transformation::kShuffle,
+        Transformation::kPrefetch, Transformation::kCache}) {
+    std::unique_ptr<Dataset> dataset;
+    TF_ASSERT_OK(Dataset::FromGraph(
+        {}, PipelineGraph(transformation, /*num_threads=*/2,
+                          /*element_size=*/3),
+        &dataset));
+    std::unique_ptr<Iterator> iterator;
+    TF_ASSERT_OK(dataset->MakeIterator(&iterator));
+    std::vector<Tensor> outputs;
+    bool end_of_input = false;
+    TF_ASSERT_OK(iterator->GetNext(&outputs, &end_of_input));
+    ASSERT_FALSE(end_of_input);
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_EQ(outputs[0].NumElements(),
+              transformation == Transformation::kBatch ? kBatchSize * 3 : 3);
+  }
+}
+
+}  // namespace
+}  // namespace standalone
+}  // namespace data
+}  // namespace tensorflow
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
 
+#include <algorithm>
+
 #include "absl/strings/escaping.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -98,7 +100,9 @@ CollectiveParamResolverDistributed::CollectiveParamResolverDistributed(
       worker_cache_(worker_cache),
       group_leader_(task_name == config.experimental().collective_group_leader()
                         ? ""
-                        : config.experimental().collective_group_leader()) {
+                        : config.experimental().collective_group_leader()),
+      resolve_instances_locally_(
+          config.experimental().collective_resolve_instances_locally()) {
   VLOG(1) << "CompleteParamResolverDistributed ctor task={" << task_name
           << "} config.collective_group_leader={"
           << config.experimental().collective_group_leader() << "}"
@@ -260,7 +264,7 @@ Status CollectiveParamResolverDistributed::UpdateGroupCache(
   GroupRec* previous_gr = nullptr;
   {
     // Group membership should never change. Once a record is in group_table_
-    // it never gets removed.
+    // it only gets removed by RemoveTasks, when one of its tasks goes away.
     mutex_lock l(group_mu_);
     auto it = group_table_.find(resp.group_key());
     if (it == group_table_.end()) {
@@ -386,6 +390,11 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
     return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
   } else if (InstanceIsCached(cp->group.group_key, cp->instance.instance_key)) {
     return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
+  } else if (resolve_instances_locally_ &&
+             cp->instance.type != BROADCAST_COLLECTIVE) {
+    // The group is already resolved, and only broadcasts need the leader to
+    // agree on instance data, namely the source rank.
+    return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
   } else {
     CompleteInstanceCall* call = new CompleteInstanceCall(
         cp->group, cp->instance, cp->name, device, cp->is_source, cancel_mgr,
@@ -415,6 +424,62 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
   }
 }
 
+void CollectiveParamResolverDistributed::InheritGroups(
+    CollectiveParamResolverDistributed* other) {
+  std::vector<std::unique_ptr<GroupRec>> groups;
+  {
+    mutex_lock l(other->group_mu_);
+    for (const auto& it : other->group_table_) {
+      const GroupRec* other_gr = it.second.get();
+      mutex_lock grl(other_gr->mu);
+      if (!other_gr->status.ok() ||
+          other_gr->devices.size() !=
+              static_cast<size_t>(other_gr->group.group_size)) {
+        continue;
+      }
+      std::unique_ptr<GroupRec> gr(new GroupRec);
+      mutex_lock new_grl(gr->mu);
+      gr->group = other_gr->group;
+      gr->devices = other_gr->devices;
+      groups.push_back(std::move(gr));
+    }
+  }
+  mutex_lock l(group_mu_);
+  for (std::unique_ptr<GroupRec>& gr : groups) {
+    const int32 group_key = gr->group.group_key;
+    if (group_table_.find(group_key) == group_table_.end()) {
+      group_table_[group_key] = std::move(gr);
+    }
+  }
+}
+
+void CollectiveParamResolverDistributed::RemoveTasks(
+    const std::vector<string>& tasks) {
+  std::vector<int32> removed_group_keys;
+  {
+    mutex_lock l(group_mu_);
+    for (const auto& it : group_table_) {
+      const GroupRec* gr = it.second.get();
+      mutex_lock grl(gr->mu);
+      for (const string& task : tasks) {
+        if (std::find(gr->group.task_names.begin(), gr->group.task_names.end(),
+                      task) != gr->group.task_names.end()) {
+          removed_group_keys.push_back(it.first);
+          break;
+        }
+      }
+    }
+    for (int32 group_key : removed_group_keys) {
+      VLOG(1) << "Dropping cached group " << group_key;
+      group_table_.erase(group_key);
+    }
+  }
+  mutex_lock l(instance_mu_);
+  for (int32 group_key : removed_group_keys) {
+    instance_table_.erase(group_key);
+  }
+}
+
 void CollectiveParamResolverDistributed::StartAbort(const Status& s) {
   {
     mutex_lock l(status_mu_);
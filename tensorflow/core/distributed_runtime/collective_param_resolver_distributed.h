@@ -50,6 +50,20 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
 
   void StartAbort(const Status& s) override;
 
+  // Copies the groups that `other` has completed successfully and this
+  // resolver does not know yet.  Used to carry the group cache over to a new
+  // resolver when the cluster changes, so that the groups of unchanged tasks
+  // are not resolved again.
+  void InheritGroups(CollectiveParamResolverDistributed* other)
+      TF_LOCKS_EXCLUDED(group_mu_);
+
+  // Drops the cached groups that have a member on any of `tasks`, together
+  // with their instances, e.g. because these tasks have been removed or
+  // replaced by new processes.  The groups are resolved again when they are
+  // next used.
+  void RemoveTasks(const std::vector<string>& tasks)
+      TF_LOCKS_EXCLUDED(group_mu_, instance_mu_);
+
  protected:
   // Returns the cached group iff there's an entry for this group_key in the
   // local group_table_; returns nullptr otherwise.
@@ -90,6 +104,8 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
 
   WorkerCacheInterface* worker_cache_;  // Not owned
   const string group_leader_;
+  // Whether non-broadcast instances are resolved without the group leader.
+  const bool resolve_instances_locally_;
   CancellationManager abortion_cancel_mgr_;
 };
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
 
+#include <atomic>
+
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/distributed_runtime/device_resolver_distributed.h"
@@ -75,10 +77,16 @@ class FakeWorker : public TestWorkerInterface {
                              const CompleteInstanceRequest* request,
                              CompleteInstanceResponse* response,
                              StatusCallback done) override {
+    ++num_complete_instance_calls_;
     param_resolver_->CompleteInstanceAsync(request, response, &cm_, done);
   }
 
+  int num_complete_instance_calls() const {
+    return num_complete_instance_calls_;
+  }
+
  private:
+  std::atomic<int> num_complete_instance_calls_{0};
   string name_;
   DeviceMgr* device_mgr_;
   CancellationManager cm_;
@@ -162,6 +170,8 @@ class DeviceResDistTest : public ::testing::Test {
     config.mutable_experimental()->set_collective_group_leader(
         "/job:worker/replica:0/task:0");
     config.mutable_experimental()->set_collective_nccl(nccl);
+    config.mutable_experimental()->set_collective_resolve_instances_locally(
+        resolve_instances_locally_);
 
     std::vector<std::unique_ptr<Device>> devices;
     for (int i = 0; i < num_devices; ++i) {
@@ -326,6 +336,7 @@ class DeviceResDistTest : public ::testing::Test {
     }
   }
 
+  bool resolve_instances_locally_ = false;
   FakeCache wc_;
   FakeNcclCommunicator nccl_communicator_;
   CancellationManager cm_;
@@ -377,6 +388,56 @@ TEST_F(DeviceResDistTest, DifferentIncarnation) {
   EXPECT_TRUE(errors::IsFailedPrecondition(status_[device_name]));
 }
 
+TEST_F(DeviceResDistTest, RemoveTasksAfterRestart) {
+  const int num_workers = 2;
+  const int num_devices = 1;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+  RestartWorker(1, num_workers, num_devices, "CPU", /*nccl*/ false);
+  // Once the leader forgets the restarted task, the group can be resolved
+  // again with the new incarnations.
+  const string leader = "/job:worker/replica:0/task:0";
+  const std::vector<string> restarted_tasks = {"/job:worker/replica:0/task:1"};
+  cp_resolvers_[leader]->RemoveTasks(restarted_tasks);
+  dev_resolvers_[leader]->RemoveTasks(restarted_tasks);
+  for (auto& name_param : cp_) {
+    name_param.second->Unref();
+  }
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+}
+
+TEST_F(DeviceResDistTest, ResolveInstancesLocally) {
+  const int num_workers = 2;
+  const int num_devices = 2;
+  resolve_instances_locally_ = true;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+  EXPECT_EQ(
+      workers_["/job:worker/replica:0/task:0"]->num_complete_instance_calls(),
+      0);
+}
+
+TEST_F(DeviceResDistTest, ResolveInstancesLocallyBroadcast) {
+  const int num_workers = 2;
+  const int num_devices = 2;
+  resolve_instances_locally_ = true;
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU", BROADCAST_COLLECTIVE,
+                         /*source_rank=*/3);
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+  // The source rank of a broadcast is still agreed on by the leader.
+  EXPECT_GT(
+      workers_["/job:worker/replica:0/task:0"]->num_complete_instance_calls(),
+      0);
+}
+
 TEST_F(DeviceResDistTest, BroadcastSourceRank0) {
   const int num_workers = 2;
   const int num_devices = 2;
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/distributed_runtime/collective_rma_distributed.h"
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/base_collective_executor.h"
 #include "tensorflow/core/common_runtime/copy_tensor.h"
@@ -27,6 +29,8 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf_internal.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
@@ -77,6 +81,23 @@ void PopulateTensorFromExtra(const RecvBufRespExtra& extra,
   }
 }
 
+Status UnpackExtraFromResponse(const RecvBufResponse& response,
+                               const Tensor& cpu_tensor,
+                               RecvBufRespExtra* extra) {
+  const int64 total_bytes = cpu_tensor.TotalBytes();
+  int64 num_bytes = 0;
+  response.transport_options().UnpackTo(extra);
+  for (const auto& chunk : extra->tensor_content()) {
+    num_bytes += chunk.size();
+  }
+
+  if (num_bytes != total_bytes) {
+    return errors::Internal("Tensor Size Mismatch: RecvBufResponse returned ",
+                            num_bytes, " bytes, expected: ", total_bytes);
+  }
+  return Status::OK();
+}
+
 Status PopulateTensorFromResponse(const RecvBufResponse& response,
                                   Tensor* cpu_tensor) {
   const bool has_transport_options = response.has_transport_options();
@@ -85,23 +106,160 @@ Status PopulateTensorFromResponse(const RecvBufResponse& response,
   // copied into request.buf_ptr.
   if (!has_transport_options) return Status::OK();
 
-  const int64 total_bytes = cpu_tensor->TotalBytes();
-  int64 num_bytes = 0;
   RecvBufRespExtra extra;
-  response.transport_options().UnpackTo(&extra);
-  for (const auto& chunk : extra.tensor_content()) {
-    num_bytes += chunk.size();
-  }
-
-  if (num_bytes != total_bytes) {
-    return errors::Internal("Tensor Size Mismatch: RecvBufResponse returned ",
-                            num_bytes,
-                            " bytes, expected: ", cpu_tensor->TotalBytes());
-  }
+  TF_RETURN_IF_ERROR(UnpackExtraFromResponse(response, *cpu_tensor, &extra));
   PopulateTensorFromExtra(extra, cpu_tensor);
   return Status::OK();
 }
 
+// Tensors bound for a GPU that are larger than this are unpacked from the
+// RecvBufResponse and copied to the device in sub-chunks of about this size.
+constexpr int64 kRecvBufSubChunkBytes = 4LL << 20;
+// Maximum number of sub-chunk copies to the device outstanding at once.
+constexpr int kMaxRecvBufSubChunksInFlight = 4;
+
+// Copies bytes [offset, offset + num_bytes) of the tensor content carried by
+// `extra` to `dst`.
+void CopyRangeFromExtra(const RecvBufRespExtra& extra, int64 offset,
+                        int64 num_bytes, char* dst) {
+  for (const auto& tensor_content_chunk : extra.tensor_content()) {
+    if (num_bytes == 0) break;
+    const int64 chunk_size = tensor_content_chunk.size();
+    if (offset >= chunk_size) {
+      offset -= chunk_size;
+      continue;
+    }
+    const int64 bytes = std::min(chunk_size - offset, num_bytes);
+    memcpy(dst, tensor_content_chunk.data() + offset, bytes);
+    dst += bytes;
+    num_bytes -= bytes;
+    offset = 0;
+  }
+}
+
+// Returns a 1-D view of elements [begin, end) of `t`.
+Tensor FlatSlice(const Tensor& t, int64 begin, int64 end) {
+  Tensor flat;
+  CHECK(flat.CopyFrom(t, TensorShape({t.NumElements()})));
+  return flat.Slice(begin, end);
+}
+
+// Unpacks the tensor content of a RecvBufResponse into the GPU-registered host
+// tensor `cpu_tensor` and copies it to `to_tensor` on a GPU one sub-chunk at a
+// time, so that unpacking sub-chunk i + 1 overlaps the DMA of sub-chunk i.  At
+// most kMaxRecvBufSubChunksInFlight copies are outstanding at once.  Calls
+// `done` on `work_queue` once every copy has finished, then deletes itself.
+class SubChunkedCopyToDevice {
+ public:
+  SubChunkedCopyToDevice(RecvBufRespExtra extra, Tensor* cpu_tensor,
+                         Device* cpu_dev, Device* to_device,
+                         DeviceContext* to_device_ctx,
+                         const AllocatorAttributes& to_alloc_attr,
+                         Tensor* to_tensor, int dev_to_dev_stream_index,
+                         UnboundedWorkQueue* work_queue, StatusCallback done)
+      : extra_(std::move(extra)),
+        cpu_dev_(cpu_dev),
+        to_device_(to_device),
+        to_device_ctx_(to_device_ctx),
+        to_alloc_attr_(to_alloc_attr),
+        dev_to_dev_stream_index_(dev_to_dev_stream_index),
+        work_queue_(work_queue),
+        done_(std::move(done)) {
+    const int64 num_elements = to_tensor->NumElements();
+    const int64 element_size = DataTypeSize(to_tensor->dtype());
+    const int64 elements_per_sub_chunk =
+        std::max<int64>(1, kRecvBufSubChunkBytes / element_size);
+    for (int64 begin = 0; begin < num_elements;
+         begin += elements_per_sub_chunk) {
+      const int64 end = std::min(num_elements, begin + elements_per_sub_chunk);
+      byte_offsets_.push_back(begin * element_size);
+      cpu_slices_.push_back(FlatSlice(*cpu_tensor, begin, end));
+      device_slices_.push_back(FlatSlice(*to_tensor, begin, end));
+    }
+  }
+
+  void Start() {
+    std::vector<int> sub_chunks;
+    {
+      mutex_lock l(mu_);
+      while (next_ < static_cast<int>(cpu_slices_.size()) &&
+             pending_ <= kMaxRecvBufSubChunksInFlight) {
+        sub_chunks.push_back(next_++);
+        ++pending_;
+      }
+    }
+    for (int i : sub_chunks) CopySubChunk(i);
+    // Release the reference held by Start itself.
+    Unref(Status::OK(), /*copy_finished=*/false);
+  }
+
+ private:
+  void CopySubChunk(int i) {
+    Tensor* cpu_slice = &cpu_slices_[i];
+    CopyRangeFromExtra(extra_, byte_offsets_[i], cpu_slice->TotalBytes(),
+                       reinterpret_cast<char*>(DMAHelper::base(cpu_slice)));
+    AllocatorAttributes cpu_attr;
+    cpu_attr.set_gpu_compatible(true);
+    CopyTensor::ViaDMA("",  // edge name (non-existent)
+                       nullptr /*send_dev_ctx*/, to_device_ctx_, cpu_dev_,
+                       to_device_, cpu_attr, to_alloc_attr_, cpu_slice,
+                       &device_slices_[i], dev_to_dev_stream_index_,
+                       [this](const Status& s) {
+                         Unref(s, /*copy_finished=*/true);
+                       });
+  }
+
+  // Drops one reference.  If a copy just finished and sub-chunks remain, the
+  // next one is unpacked and copied on `work_queue_`, since DMA callbacks must
+  // not block.
+  void Unref(const Status& s, bool copy_finished) {
+    int next = -1;
+    bool finished = false;
+    Status status;
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+      --pending_;
+      if (copy_finished && status_.ok() &&
+          next_ < static_cast<int>(cpu_slices_.size())) {
+        next = next_++;
+        ++pending_;
+      }
+      finished = pending_ == 0;
+      status = status_;
+    }
+    if (next >= 0) {
+      work_queue_->Schedule([this, next] { CopySubChunk(next); });
+    } else if (finished) {
+      UnboundedWorkQueue* work_queue = work_queue_;
+      StatusCallback done = std::move(done_);
+      delete this;
+      // This callback must not block, so execute done in another thread.
+      work_queue->Schedule([status, done] { done(status); });
+    }
+  }
+
+  const RecvBufRespExtra extra_;
+  Device* const cpu_dev_;
+  Device* const to_device_;
+  DeviceContext* const to_device_ctx_;
+  const AllocatorAttributes to_alloc_attr_;
+  const int dev_to_dev_stream_index_;
+  UnboundedWorkQueue* const work_queue_;
+  StatusCallback done_;
+  // Views of the sub-chunks of the host and device tensors, and the offset of
+  // each sub-chunk in the tensor content.
+  std::vector<Tensor> cpu_slices_;
+  std::vector<Tensor> device_slices_;
+  std::vector<int64> byte_offsets_;
+
+  mutex mu_;
+  int next_ TF_GUARDED_BY(mu_) = 0;  // Next sub-chunk to copy.
+  // Outstanding copies, plus one for Start while it is issuing them.
+  int pending_ TF_GUARDED_BY(mu_) = 1;
+  Status status_ TF_GUARDED_BY(mu_);
+};
+
 }  // namespace
 
 void CollectiveRemoteAccessDistributed::RecvFromPeer(
@@ -181,6 +339,33 @@ void CollectiveRemoteAccessDistributed::RecvFromPeer(
           // (NOP in 2nd case) In case the final to_tensor is on GPU, buf_ptr
           // points to a tmp CPU buffer and needs to be copied over to
           // to_tensor.
+          //
+          // Large tensors bound for a GPU in the 1st case are unpacked and
+          // copied in sub-chunks, overlapping the two.
+          if (to_device->tensorflow_gpu_device_info() &&
+              state->call->resp_.has_transport_options() &&
+              dst_tensor->TotalBytes() > kRecvBufSubChunkBytes) {
+            RecvBufRespExtra extra;
+            Status status = UnpackExtraFromResponse(state->call->resp_,
+                                                    *dst_tensor, &extra);
+            if (!status.ok()) {
+              done(status);
+              delete state;
+              return;
+            }
+            // The response is no longer needed once unpacked.
+            state->call->resp_.Clear();
+            auto* copy = new SubChunkedCopyToDevice(
+                std::move(extra), dst_tensor, cpu_dev, to_device,
+                to_device_ctx, to_alloc_attr, to_tensor,
+                dev_to_dev_stream_index, work_queue_.get(),
+                [state, done](const Status& s) {
+                  delete state;
+                  done(s);
+                });
+            copy->Start();
+            return;
+          }
           Status status =
               PopulateTensorFromResponse(state->call->resp_, dst_tensor);
           if (!status.ok()) {
@@ -73,4 +73,39 @@ Status DeviceResolverDistributed::UpdateDeviceAttributes(
   return Status::OK();
 }
 
+void DeviceResolverDistributed::InheritAttributes(
+    DeviceResolverDistributed* other) {
+  std::vector<DeviceAttributes> attributes;
+  {
+    mutex_lock l(other->mu_);
+    attributes.reserve(other->attr_table_.size());
+    for (const auto& it : other->attr_table_) {
+      attributes.push_back(it.second);
+    }
+  }
+  mutex_lock l(mu_);
+  for (const DeviceAttributes& attr : attributes) {
+    attr_table_.insert({attr.name(), attr});
+  }
+}
+
+void DeviceResolverDistributed::RemoveTasks(const std::vector<string>& tasks) {
+  mutex_lock l(mu_);
+  for (auto it = attr_table_.begin(); it != attr_table_.end();) {
+    const string& device_name = it->first;
+    bool remove = false;
+    for (const string& task : tasks) {
+      if (DeviceNameUtils::IsSameAddressSpace(task, device_name)) {
+        remove = true;
+        break;
+      }
+    }
+    if (remove) {
+      attr_table_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
 }  // namespace tensorflow
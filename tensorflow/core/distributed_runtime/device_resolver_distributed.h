@@ -40,6 +40,16 @@ class DeviceResolverDistributed : public DeviceResolverInterface {
   Status UpdateDeviceAttributes(
       const std::vector<DeviceAttributes>& attributes) override;
 
+  // Adds the attributes cached by `other` for the devices that are not in this
+  // cache yet.  Used to carry the cache over to a new resolver when the
+  // cluster changes, so that the devices of unchanged tasks are not resolved
+  // again.
+  void InheritAttributes(DeviceResolverDistributed* other);
+
+  // Drops the cached attributes of all devices of `tasks`, e.g. because these
+  // tasks have been removed or replaced by new processes.
+  void RemoveTasks(const std::vector<string>& tasks);
+
  protected:
   const string task_name_;
   mutex mu_;
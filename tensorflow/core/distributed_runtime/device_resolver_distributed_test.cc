@@ -161,5 +161,33 @@ TEST_F(DeviceResDistTest, UpdateDeviceAttributesDifferentIncarnation) {
       dev_resolver_->UpdateDeviceAttributes(attributes)));
 }
 
+TEST_F(DeviceResDistTest, InheritAttributes) {
+  DeviceResolverDistributed new_resolver(dev_mgr_.get());
+  new_resolver.InheritAttributes(dev_resolver_.get());
+  DeviceAttributes attributes;
+  TF_ASSERT_OK(new_resolver.GetDeviceAttributes(
+      "/job:worker/replica:0/task:1/device:CPU:0", &attributes));
+  DeviceAttributes expected;
+  TF_ASSERT_OK(dev_resolver_->GetDeviceAttributes(
+      "/job:worker/replica:0/task:1/device:CPU:0", &expected));
+  EXPECT_EQ(attributes.incarnation(), expected.incarnation());
+}
+
+TEST_F(DeviceResDistTest, RemoveTasks) {
+  dev_resolver_->RemoveTasks({"/job:worker/replica:0/task:1"});
+  std::vector<DeviceAttributes> attributes;
+  EXPECT_TRUE(errors::IsNotFound(dev_resolver_->GetAllDeviceAttributes(
+      "/job:worker/replica:0/task:1", &attributes)));
+  TF_ASSERT_OK(dev_resolver_->GetAllDeviceAttributes(
+      "/job:worker/replica:0/task:0", &attributes));
+  EXPECT_EQ(attributes.size(), 2);
+  // The replaced task can now join with new incarnations.
+  attributes.clear();
+  attributes.push_back(
+      NewDevice("CPU", "/job:worker/replica:0/task:1/device:CPU:0")
+          ->attributes());
+  TF_ASSERT_OK(dev_resolver_->UpdateDeviceAttributes(attributes));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -511,10 +511,22 @@ Status EagerServiceImpl::ExecuteOp(CallOptions* call_opts,
                                    EagerContext* eager_context,
                                    EagerExecutor* eager_executor,
                                    QueueResponse* queue_response) {
+  Operation expanded_operation;
+  const Operation* full_operation = &operation;
+  if (operation.template_id() != 0) {
+    if (operation.name().empty()) {
+      TF_RETURN_IF_ERROR(eager_context->RemoteMgr()->ExpandOpTemplate(
+          operation, &expanded_operation));
+      full_operation = &expanded_operation;
+    } else {
+      eager_context->RemoteMgr()->RegisterOpTemplate(operation);
+    }
+  }
+
   tensorflow::EagerOperation op(eager_context);
   int num_retvals = 0;
   TF_RETURN_IF_ERROR(GetEagerOperationAndNumRetvals(
-      operation, eager_context, eager_executor, &op, &num_retvals));
+      *full_operation, eager_context, eager_executor, &op, &num_retvals));
 
   auto cm = std::make_shared<CancellationManager>();
   if (call_opts) {
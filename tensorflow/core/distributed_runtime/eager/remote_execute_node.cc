@@ -19,6 +19,8 @@ limitations under the License.
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/core/distributed_runtime/eager/remote_mgr.h"
+#include "tensorflow/core/util/device_name_utils.h"
 
 namespace tensorflow {
 namespace eager {
@@ -73,14 +75,28 @@ void RemoteExecuteNode::RunAsync(StatusCallback done) {
     handle->Ref();
   }
 
+  // Set if this request registers an operation template on the remote task.
+  int64 new_template_id = 0;
+  const Operation& operation = request_->queue(0).operation();
+  if (operation.template_id() != 0 && !operation.name().empty()) {
+    new_template_id = operation.template_id();
+  }
+
   eager_client_->StreamingEnqueueAsync(
       call_opts.get(), request_.get(), response.get(),
       [inputs, retvals, call_opts, response, device,
        context_view_id = context_view_id_, rpc_description, cm, token,
+       new_template_id, eager_context = eager_context_,
        done](const Status& status) {
         if (cm != nullptr) {
           cm->TryDeregisterCallback(token);
         }
+        string remote_task;
+        if (status.ok() && new_template_id != 0 &&
+            DeviceNameUtils::GetTaskName(device->parsed_name(), &remote_task)) {
+          eager_context->RemoteMgr()->ConfirmOpTemplate(remote_task,
+                                                        new_template_id);
+        }
         for (auto handle : inputs) {
           handle->Unref();
         }
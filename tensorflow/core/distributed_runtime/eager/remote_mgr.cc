@@ -20,10 +20,32 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/eager/remote_tensor_handle.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace eager {
 
+namespace {
+
+int64 MaxOpTemplatesPerTask() {
+  int64 max_op_templates_per_task;
+  Status s = ReadInt64FromEnvVar("TF_EAGER_REMOTE_OP_TEMPLATES_PER_TASK",
+                                 1024, &max_op_templates_per_task);
+  if (!s.ok()) {
+    LOG(ERROR) << "Failed to parse TF_EAGER_REMOTE_OP_TEMPLATES_PER_TASK: "
+               << s;
+    return 1024;
+  }
+  return max_op_templates_per_task;
+}
+
+}  // namespace
+
+RemoteMgr::RemoteMgr(bool is_master, EagerContext* ctx)
+    : is_master_(is_master),
+      parent_(ctx),
+      max_op_templates_per_task_(is_master ? MaxOpTemplatesPerTask() : 0) {}
+
 void RemoteMgr::AddOperationOutputs(
     const gtl::ArraySlice<tensorflow::TensorHandle*> handles,
     int64 operation_id) {
@@ -215,5 +237,73 @@ void RemoteMgr::DeleteExecutorForStream(uint64 stream_id) {
   executor_map_.erase(it);
 }
 
+void RemoteMgr::ApplyOpTemplate(const string& remote_task,
+                                const Fprint128& key, Operation* op) {
+  if (max_op_templates_per_task_ <= 0) return;
+  mutex_lock l(op_template_mu_);
+  OpTemplateMap& templates = op_templates_[remote_task];
+  auto it = templates.find(key);
+  if (it == templates.end()) {
+    if (templates.size() >= static_cast<size_t>(max_op_templates_per_task_)) {
+      return;
+    }
+    it = templates.emplace(key, OpTemplate{next_op_template_id_++, false})
+             .first;
+  }
+  op->set_template_id(it->second.id);
+  if (it->second.confirmed) {
+    op->clear_name();
+    op->clear_attrs();
+    op->clear_device();
+    op->clear_is_function();
+  }
+}
+
+void RemoteMgr::ConfirmOpTemplate(const string& remote_task,
+                                  int64 template_id) {
+  mutex_lock l(op_template_mu_);
+  auto task_it = op_templates_.find(remote_task);
+  if (task_it == op_templates_.end()) return;
+  // Templates are only confirmed once per task, so a linear scan is fine.
+  for (auto& it : task_it->second) {
+    if (it.second.id == template_id) {
+      it.second.confirmed = true;
+      return;
+    }
+  }
+}
+
+void RemoteMgr::ClearOpTemplates() {
+  mutex_lock l(op_template_mu_);
+  op_templates_.clear();
+}
+
+void RemoteMgr::RegisterOpTemplate(const Operation& op) {
+  Operation op_template;
+  op_template.set_name(op.name());
+  *op_template.mutable_attrs() = op.attrs();
+  op_template.set_device(op.device());
+  op_template.set_is_function(op.is_function());
+  mutex_lock l(op_template_mu_);
+  registered_op_templates_[op.template_id()] = std::move(op_template);
+}
+
+Status RemoteMgr::ExpandOpTemplate(const Operation& op, Operation* expanded) {
+  {
+    tf_shared_lock l(op_template_mu_);
+    auto it = registered_op_templates_.find(op.template_id());
+    if (it == registered_op_templates_.end()) {
+      return errors::InvalidArgument("Unknown template ", op.template_id(),
+                                     " for operation ", op.id());
+    }
+    *expanded = it->second;
+  }
+  expanded->set_id(op.id());
+  *expanded->mutable_op_inputs() = op.op_inputs();
+  *expanded->mutable_control_op_ids() = op.control_op_ids();
+  expanded->set_template_id(op.template_id());
+  return Status::OK();
+}
+
 }  // namespace eager
 }  // namespace tensorflow
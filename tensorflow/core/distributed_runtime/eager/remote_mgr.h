@@ -18,10 +18,13 @@ limitations under the License.
 
 #include <unordered_map>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/distributed_runtime/eager/remote_tensor_handle.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
 
 namespace tensorflow {
 namespace eager {
@@ -32,8 +35,7 @@ const int64 kInvalidRemoteOpId = -1;
 // TODO(fishx): Move remote state from context to this class.
 class RemoteMgr {
  public:
-  RemoteMgr(bool is_master, EagerContext* ctx)
-      : is_master_(is_master), parent_(ctx) {}
+  RemoteMgr(bool is_master, EagerContext* ctx);
 
   ~RemoteMgr() {
     for (const auto& entry : remote_tensor_handle_map_) {
@@ -80,6 +82,33 @@ class RemoteMgr {
 
   void DeleteExecutorForStream(uint64 stream_id);
 
+  // Operation templates let the operations sent to a remote task omit the
+  // name, attrs and device that they share with an earlier operation.
+
+  // Applies the template identified by `key` for `remote_task` to `op`, which
+  // must be fully populated.  Until `remote_task` has confirmed the template
+  // with ConfirmOpTemplate, `op` is kept whole so that it registers the
+  // template; afterwards its name, attrs and device are cleared.  Leaves `op`
+  // alone once the template cache of `remote_task` is full, or if templates
+  // are disabled by setting TF_EAGER_REMOTE_OP_TEMPLATES_PER_TASK to 0.
+  void ApplyOpTemplate(const string& remote_task, const Fprint128& key,
+                       Operation* op);
+
+  // Records that `remote_task` has registered template `template_id`.
+  void ConfirmOpTemplate(const string& remote_task, int64 template_id);
+
+  // Forgets all the templates of remote tasks, e.g. after some of them have
+  // been replaced by new processes.
+  void ClearOpTemplates();
+
+  // Registers the name, attrs, device and is_function of `op` as template
+  // `op.template_id()`, received from the master.
+  void RegisterOpTemplate(const Operation& op);
+
+  // Sets `expanded` to `op` completed with its template, which must have been
+  // registered with RegisterOpTemplate.
+  Status ExpandOpTemplate(const Operation& op, Operation* expanded);
+
  protected:
   mutex next_id_mutex_;
   uint64 next_op_id_ TF_GUARDED_BY(next_id_mutex_) = 1;
@@ -129,6 +158,25 @@ class RemoteMgr {
   mutex executor_map_mu_;
   std::unordered_map<uint64, EagerExecutor> executor_map_
       TF_GUARDED_BY(executor_map_mu_);
+
+  struct OpTemplate {
+    int64 id;
+    // Whether the remote task has registered the template.
+    bool confirmed;
+  };
+  using OpTemplateMap =
+      absl::flat_hash_map<Fprint128, OpTemplate, Fprint128Hasher>;
+
+  // Maximum number of templates per remote task; 0 disables templates.
+  const int64 max_op_templates_per_task_;
+  mutex op_template_mu_;
+  int64 next_op_template_id_ TF_GUARDED_BY(op_template_mu_) = 1;
+  // Templates used by the master, keyed by remote task.
+  absl::flat_hash_map<string, OpTemplateMap> op_templates_
+      TF_GUARDED_BY(op_template_mu_);
+  // Templates registered by the master, keyed by template id.
+  absl::flat_hash_map<int64, Operation> registered_op_templates_
+      TF_GUARDED_BY(op_template_mu_);
 };
 
 }  // namespace eager
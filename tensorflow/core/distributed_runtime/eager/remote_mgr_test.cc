@@ -151,6 +151,67 @@ TEST_F(RemoteMgrTest, SetRemoteShapeWithClusterUpdate) {
   handle->Unref();
 }
 
+Operation MakeOperation(int64 id) {
+  Operation op;
+  op.set_id(id);
+  op.set_name("Add");
+  (*op.mutable_attrs())["T"].set_type(DT_FLOAT);
+  op.set_device("/job:worker/replica:0/task:0/device:CPU:0");
+  op.add_op_inputs()->mutable_remote_handle()->set_op_id(id - 1);
+  return op;
+}
+
+TEST_F(RemoteMgrTest, OpTemplateRoundTrip) {
+  RemoteMgr master_mgr(true, ctx_);
+  RemoteMgr worker_mgr(false, ctx_);
+  const string remote_task = "/job:worker/replica:0/task:0";
+  const Fprint128 key = Fingerprint128("Add");
+
+  // The template is sent whole until the remote task confirms it.
+  Operation op = MakeOperation(2);
+  master_mgr.ApplyOpTemplate(remote_task, key, &op);
+  ASSERT_NE(op.template_id(), 0);
+  EXPECT_EQ(op.name(), "Add");
+  worker_mgr.RegisterOpTemplate(op);
+  master_mgr.ConfirmOpTemplate(remote_task, op.template_id());
+
+  Operation compact_op = MakeOperation(4);
+  master_mgr.ApplyOpTemplate(remote_task, key, &compact_op);
+  EXPECT_EQ(compact_op.template_id(), op.template_id());
+  EXPECT_TRUE(compact_op.name().empty());
+  EXPECT_TRUE(compact_op.attrs().empty());
+  EXPECT_TRUE(compact_op.device().empty());
+
+  Operation expanded;
+  TF_ASSERT_OK(worker_mgr.ExpandOpTemplate(compact_op, &expanded));
+  EXPECT_EQ(expanded.id(), 4);
+  EXPECT_EQ(expanded.name(), "Add");
+  EXPECT_EQ(expanded.device(), "/job:worker/replica:0/task:0/device:CPU:0");
+  EXPECT_EQ(expanded.attrs().at("T").type(), DT_FLOAT);
+  ASSERT_EQ(expanded.op_inputs_size(), 1);
+  EXPECT_EQ(expanded.op_inputs(0).remote_handle().op_id(), 3);
+
+  // Templates are per task, and are sent whole again once cleared.
+  Operation other_task_op = MakeOperation(6);
+  master_mgr.ApplyOpTemplate("/job:worker/replica:0/task:1", key,
+                             &other_task_op);
+  EXPECT_EQ(other_task_op.name(), "Add");
+  master_mgr.ClearOpTemplates();
+  Operation cleared_op = MakeOperation(8);
+  master_mgr.ApplyOpTemplate(remote_task, key, &cleared_op);
+  EXPECT_EQ(cleared_op.name(), "Add");
+}
+
+TEST_F(RemoteMgrTest, ExpandUnknownOpTemplate) {
+  RemoteMgr worker_mgr(false, ctx_);
+  Operation op;
+  op.set_id(1);
+  op.set_template_id(7);
+  Operation expanded;
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(worker_mgr.ExpandOpTemplate(op, &expanded)));
+}
+
 }  // namespace
 }  // namespace eager
 }  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/master_session.h"
 
+#include <algorithm>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -711,6 +712,11 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
         }
       }
     } else {
+      // The graph may have been registered for a superset of the requested
+      // fetches, in which case only the requested ones are received.
+      const bool fetch_all =
+          fetches.size() ==
+          static_cast<size_t>(bg_opts_.callable_options.fetch_size());
       for (const auto& feed_key : part.feed_key) {
         const string& feed = feed_key.first;
         const string& key = feed_key.second;
@@ -723,6 +729,10 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
             AddSendFromClientRequest(req, c->req.get(), feed_index, key));
       }
       for (const auto& key_fetch : part.key_fetch) {
+        if (!fetch_all && std::find(fetches.begin(), fetches.end(),
+                                    key_fetch.second) == fetches.end()) {
+          continue;
+        }
         const string& key = key_fetch.first;
         c->req->add_recv_key(key);
       }
@@ -1198,6 +1208,27 @@ uint64 HashBuildGraphOptions(const BuildGraphOptions& opts) {
   return h;
 }
 
+// Returns true if a graph built for `registered` computes everything requested
+// by `opts`: both have the same feeds, targets and debug options, and the
+// fetches of `registered` are a superset of those of `opts`.  The names in
+// both are sorted by BuildBuildGraphOptions.
+bool HasSupersetFetches(const BuildGraphOptions& registered,
+                        const BuildGraphOptions& opts) {
+  const CallableOptions& r = registered.callable_options;
+  const CallableOptions& o = opts.callable_options;
+  auto same = [](const protobuf::RepeatedPtrField<string>& a,
+                 const protobuf::RepeatedPtrField<string>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+  };
+  return registered.collective_graph_key == opts.collective_graph_key &&
+         registered.collective_order == opts.collective_order &&
+         same(r.feed(), o.feed()) && same(r.target(), o.target()) &&
+         r.run_options().debug_options().SerializeAsString() ==
+             o.run_options().debug_options().SerializeAsString() &&
+         std::includes(r.fetch().begin(), r.fetch().end(), o.fetch().begin(),
+                       o.fetch().end());
+}
+
 string BuildGraphOptionsString(const BuildGraphOptions& opts) {
   string buf;
   for (const string& name : opts.callable_options.feed()) {
@@ -1517,6 +1548,9 @@ WorkerCacheInterface* MasterSession::get_worker_cache() const {
 Status MasterSession::StartStep(const BuildGraphOptions& opts, bool is_partial,
                                 ReffedClientGraph** out_rcg, int64* out_count) {
   const uint64 hash = HashBuildGraphOptions(opts);
+  const ConfigProto::Experimental& experimental =
+      session_opts_.config.experimental();
+  std::vector<ReffedClientGraph*> to_unref;
   {
     mutex_lock l(mu_);
     // TODO(suharshs): We cache partial run graphs and run graphs separately
@@ -1524,6 +1558,16 @@ Status MasterSession::StartStep(const BuildGraphOptions& opts, bool is_partial,
     // run calls.
     RCGMap* m = is_partial ? &partial_run_graphs_ : &run_graphs_;
     auto iter = m->find(hash);
+    if (iter == m->end() && !is_partial &&
+        experimental.reuse_run_graphs_with_superset_fetches()) {
+      ReffedClientGraph* superset = FindRunGraphWithSupersetFetches(opts);
+      if (superset != nullptr) {
+        VLOG(1) << "Reusing a registered graph with superset fetches for "
+                << BuildGraphOptionsString(opts);
+        superset->Ref();
+        iter = m->insert({hash, superset}).first;
+      }
+    }
     if (iter == m->end()) {
       // We have not seen this subgraph before. Build the subgraph and
       // cache it.
@@ -1537,16 +1581,64 @@ Status MasterSession::StartStep(const BuildGraphOptions& opts, bool is_partial,
           handle_, opts, std::move(client_graph), session_opts_,
           stats_publisher_factory_, is_partial, worker_cache,
           !should_delete_worker_sessions_);
+      if (!is_partial) MaybeEvictRunGraph(&to_unref);
       iter = m->insert({hash, entry}).first;
       VLOG(1) << "Preparing to execute new graph";
     }
     *out_rcg = iter->second;
     (*out_rcg)->Ref();
     *out_count = (*out_rcg)->get_and_increment_execution_count();
+    if (!is_partial && experimental.max_cached_run_graphs() > 0) {
+      run_graph_last_use_[hash] = ++run_graph_clock_;
+    }
   }
+  for (ReffedClientGraph* rcg : to_unref) rcg->Unref();
   return Status::OK();
 }
 
+MasterSession::ReffedClientGraph*
+MasterSession::FindRunGraphWithSupersetFetches(const BuildGraphOptions& opts) {
+  for (const auto& p : run_graphs_) {
+    if (HasSupersetFetches(p.second->build_graph_options(), opts)) {
+      return p.second;
+    }
+  }
+  return nullptr;
+}
+
+void MasterSession::MaybeEvictRunGraph(
+    std::vector<ReffedClientGraph*>* to_unref) {
+  const int max_graphs = session_opts_.config.experimental()
+                             .max_cached_run_graphs();
+  if (max_graphs <= 0) return;
+  // The last use of a graph is the latest use of any entry sharing it.
+  std::unordered_map<ReffedClientGraph*, int64> last_use;
+  for (const auto& p : run_graphs_) {
+    int64& t = last_use[p.second];
+    t = std::max(t, run_graph_last_use_[p.first]);
+  }
+  if (last_use.size() < static_cast<size_t>(max_graphs)) return;
+  ReffedClientGraph* victim = nullptr;
+  int64 victim_last_use = 0;
+  for (const auto& p : last_use) {
+    if (victim == nullptr || p.second < victim_last_use) {
+      victim = p.first;
+      victim_last_use = p.second;
+    }
+  }
+  VLOG(1) << "Evicting the least recently used of " << last_use.size()
+          << " registered graphs";
+  for (auto it = run_graphs_.begin(); it != run_graphs_.end();) {
+    if (it->second == victim) {
+      to_unref->push_back(it->second);
+      run_graph_last_use_.erase(it->first);
+      it = run_graphs_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 void MasterSession::ClearRunsTable(std::vector<ReffedClientGraph*>* to_unref,
                                    RCGMap* rcg_map) {
   VLOG(1) << "Discarding all reffed graphs";
@@ -2112,6 +2204,7 @@ Status MasterSession::Close() {
       num_running_is_zero_.wait(l);
     }
     ClearRunsTable(&to_unref, &run_graphs_);
+    run_graph_last_use_.clear();
     ClearRunsTable(&to_unref, &partial_run_graphs_);
     ClearRunsTable(&to_unref, &callables_);
   }
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_MASTER_SESSION_H_
 
 #include <atomic>
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
@@ -154,6 +155,11 @@ class MasterSession : public core::RefCounted {
   typedef std::unordered_map<uint64, ReffedClientGraph*> RCGMap;
   RCGMap run_graphs_ TF_GUARDED_BY(mu_);
   RCGMap partial_run_graphs_ TF_GUARDED_BY(mu_);
+  // When `max_cached_run_graphs` is set, the logical time at which each entry
+  // of `run_graphs_` was last used.  Several entries may share one
+  // ReffedClientGraph when `reuse_run_graphs_with_superset_fetches` is set.
+  std::unordered_map<uint64, int64> run_graph_last_use_ TF_GUARDED_BY(mu_);
+  int64 run_graph_clock_ TF_GUARDED_BY(mu_) = 0;
   int64 next_callable_handle_ TF_GUARDED_BY(mu_) = 0;
   RCGMap callables_ TF_GUARDED_BY(mu_);
 
@@ -226,6 +232,16 @@ class MasterSession : public core::RefCounted {
                    ReffedClientGraph** out_rcg, int64* out_count);
   void ClearRunsTable(std::vector<ReffedClientGraph*>* to_unref,
                       RCGMap* rcg_map) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns a graph in `run_graphs_` that can run `opts` because it has the
+  // same feeds and targets and a superset of its fetches, or nullptr.
+  ReffedClientGraph* FindRunGraphWithSupersetFetches(
+      const BuildGraphOptions& opts) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Removes the least recently used graph from `run_graphs_`, together with
+  // all entries sharing it, if `run_graphs_` holds `max_cached_run_graphs`
+  // distinct graphs or more.  The references of the removed entries are
+  // appended to `to_unref`.
+  void MaybeEvictRunGraph(std::vector<ReffedClientGraph*>* to_unref)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   void FillPerStepState(MasterSession::ReffedClientGraph* rcg,
                         const RunOptions& run_options, uint64 step_id,
                         int64 count, PerStepState* out_pss,
@@ -0,0 +1,141 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/recv_tensor_batcher.h"
+
+#include <utility>
+
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+RecvTensorBatcher::RecvTensorBatcher(
+    WorkerInterface* wi, std::function<void(WorkerInterface*)> release_worker,
+    int64 window_usecs, int max_batch_size, Env* env)
+    : wi_(wi),
+      release_worker_(std::move(release_worker)),
+      window_usecs_(window_usecs),
+      max_batch_size_(max_batch_size),
+      env_(env) {}
+
+RecvTensorBatcher::~RecvTensorBatcher() { release_worker_(wi_); }
+
+void RecvTensorBatcher::RecvTensorAsync(CallOptions* opts,
+                                        const RecvTensorRequest* request,
+                                        TensorResponse* response,
+                                        StatusCallback done) {
+  std::vector<PendingRecv> batch;
+  int64 flush_batch_id = -1;
+  bool batching_supported;
+  {
+    mutex_lock l(mu_);
+    batching_supported = batching_supported_;
+    if (batching_supported) {
+      pending_.push_back({opts, request, response, std::move(done)});
+      if (pending_.size() >= static_cast<size_t>(max_batch_size_)) {
+        batch.swap(pending_);
+        ++batch_id_;
+      } else if (pending_.size() == 1) {
+        flush_batch_id = batch_id_;
+      }
+    }
+  }
+  if (!batching_supported) {
+    wi_->RecvTensorAsync(opts, request, response, std::move(done));
+    return;
+  }
+  if (!batch.empty()) {
+    IssueBatch(std::move(batch));
+  } else if (flush_batch_id >= 0) {
+    // The closure keeps the batcher alive until the window has passed.
+    std::shared_ptr<RecvTensorBatcher> self = shared_from_this();
+    env_->SchedClosureAfter(window_usecs_, [self, flush_batch_id]() {
+      self->MaybeFlush(flush_batch_id);
+    });
+  }
+}
+
+void RecvTensorBatcher::MaybeFlush(int64 batch_id) {
+  std::vector<PendingRecv> batch;
+  {
+    mutex_lock l(mu_);
+    // The batch may have been sent already because it filled up.
+    if (batch_id != batch_id_) return;
+    batch.swap(pending_);
+    ++batch_id_;
+  }
+  IssueBatch(std::move(batch));
+}
+
+void RecvTensorBatcher::IssueBatch(std::vector<PendingRecv> batch) {
+  if (batch.size() == 1) {
+    IssueUnbatched(std::move(batch));
+    return;
+  }
+  struct BatchCall {
+    CallOptions opts;
+    RecvTensorBatchRequest request;
+    RecvTensorBatchResponse response;
+    std::vector<PendingRecv> recvs;
+  };
+  std::shared_ptr<RecvTensorBatcher> self = shared_from_this();
+  BatchCall* call = new BatchCall;
+  call->recvs = std::move(batch);
+  for (PendingRecv& recv : call->recvs) {
+    *call->request.add_request() = *recv.request;
+    recv.opts->SetCancelCallback([call]() { call->opts.StartCancel(); });
+  }
+  VLOG(2) << "Sending a batch of " << call->recvs.size() << " RecvTensor calls";
+  wi_->RecvTensorBatchAsync(
+      &call->opts, &call->request, &call->response,
+      [self, call](const Status& s) {
+        for (PendingRecv& recv : call->recvs) {
+          recv.opts->ClearCancelCallback();
+        }
+        if (errors::IsUnimplemented(s)) {
+          {
+            mutex_lock l(self->mu_);
+            self->batching_supported_ = false;
+          }
+          self->IssueUnbatched(std::move(call->recvs));
+        } else if (!s.ok()) {
+          for (PendingRecv& recv : call->recvs) recv.done(s);
+        } else if (call->response.response_size() !=
+                   static_cast<int>(call->recvs.size())) {
+          Status status = errors::Internal(
+              "RecvTensorBatch returned ", call->response.response_size(),
+              " tensors, expected ", call->recvs.size());
+          for (PendingRecv& recv : call->recvs) recv.done(status);
+        } else {
+          for (size_t i = 0; i < call->recvs.size(); ++i) {
+            PendingRecv& recv = call->recvs[i];
+            recv.done(recv.response->InitFrom(
+                call->response.mutable_response(i)));
+          }
+        }
+        delete call;
+      });
+}
+
+void RecvTensorBatcher::IssueUnbatched(std::vector<PendingRecv> batch) {
+  for (PendingRecv& recv : batch) {
+    wi_->RecvTensorAsync(recv.opts, recv.request, recv.response,
+                         std::move(recv.done));
+  }
+}
+
+}  // namespace tensorflow
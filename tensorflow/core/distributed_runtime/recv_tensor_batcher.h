@@ -0,0 +1,93 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSOR_BATCHER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSOR_BATCHER_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+class TensorResponse;
+
+// Coalesces the RecvTensor calls to one remote worker into RecvTensorBatch
+// calls.  A call waits at most `window_usecs` for others to join its batch,
+// and a batch is sent as soon as it holds `max_batch_size` calls.
+//
+// This trades a little latency for far fewer RPCs, and is meant for workers
+// that exchange many small tensors per step.  A batch completes only once all
+// of its tensors are available, and cancelling any call of a batch cancels the
+// whole batch.  If the remote worker does not implement RecvTensorBatch, the
+// batcher falls back to issuing one RecvTensor call per tensor.
+//
+// Instances are shared by the WorkerInterface objects for the same target, and
+// must be held by a std::shared_ptr.
+class RecvTensorBatcher
+    : public std::enable_shared_from_this<RecvTensorBatcher> {
+ public:
+  // `wi` is the worker that calls are issued on; it is released through
+  // `release_worker` when the batcher is destroyed.
+  RecvTensorBatcher(WorkerInterface* wi,
+                    std::function<void(WorkerInterface*)> release_worker,
+                    int64 window_usecs, int max_batch_size,
+                    Env* env = Env::Default());
+  ~RecvTensorBatcher();
+
+  // Same contract as WorkerInterface::RecvTensorAsync.  `response` must have
+  // been initialized with TensorResponse::InitAlloc.
+  void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                       TensorResponse* response, StatusCallback done);
+
+ private:
+  struct PendingRecv {
+    CallOptions* opts;
+    const RecvTensorRequest* request;
+    TensorResponse* response;
+    StatusCallback done;
+  };
+
+  // Sends the pending calls if they still form batch `batch_id`.
+  void MaybeFlush(int64 batch_id);
+  void IssueBatch(std::vector<PendingRecv> batch);
+  void IssueUnbatched(std::vector<PendingRecv> batch);
+
+  WorkerInterface* const wi_;
+  const std::function<void(WorkerInterface*)> release_worker_;
+  const int64 window_usecs_;
+  const int max_batch_size_;
+  Env* const env_;
+
+  mutex mu_;
+  std::vector<PendingRecv> pending_ TF_GUARDED_BY(mu_);
+  // Identifies the batch that `pending_` will be sent as.
+  int64 batch_id_ TF_GUARDED_BY(mu_) = 0;
+  // Cleared once the remote worker is found not to implement RecvTensorBatch.
+  bool batching_supported_ TF_GUARDED_BY(mu_) = true;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RecvTensorBatcher);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSOR_BATCHER_H_
@@ -0,0 +1,188 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/recv_tensor_batcher.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/test_utils.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class DummyDevice : public DeviceBase {
+ public:
+  explicit DummyDevice(Env* env) : DeviceBase(env) {
+    attr_.set_device_type("CPU");
+  }
+
+  const DeviceAttributes& attributes() const override { return attr_; }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+ private:
+  DeviceAttributes attr_;
+};
+
+// Answers every request for key "k<i>" with the scalar i.
+class FakeWorker : public TestWorkerInterface {
+ public:
+  explicit FakeWorker(bool supports_batch) : supports_batch_(supports_batch) {}
+
+  void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                       TensorResponse* response, StatusCallback done) override {
+    {
+      mutex_lock l(mu_);
+      ++num_recv_calls_;
+    }
+    RecvTensorResponse proto;
+    Fill(*request, &proto);
+    done(response->InitFrom(&proto));
+  }
+
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    {
+      mutex_lock l(mu_);
+      ++num_batch_calls_;
+      batch_sizes_.push_back(request->request_size());
+    }
+    if (!supports_batch_) {
+      done(errors::Unimplemented("RecvTensorBatchAsync"));
+      return;
+    }
+    for (const RecvTensorRequest& r : request->request()) {
+      Fill(r, response->add_response());
+    }
+    done(Status::OK());
+  }
+
+  int num_recv_calls() {
+    mutex_lock l(mu_);
+    return num_recv_calls_;
+  }
+  int num_batch_calls() {
+    mutex_lock l(mu_);
+    return num_batch_calls_;
+  }
+  std::vector<int> batch_sizes() {
+    mutex_lock l(mu_);
+    return batch_sizes_;
+  }
+
+ private:
+  static void Fill(const RecvTensorRequest& request,
+                   RecvTensorResponse* response) {
+    float value = std::stof(request.rendezvous_key().substr(1));
+    test::AsScalar<float>(value).AsProtoTensorContent(
+        response->mutable_tensor());
+  }
+
+  const bool supports_batch_;
+  mutex mu_;
+  int num_recv_calls_ TF_GUARDED_BY(mu_) = 0;
+  int num_batch_calls_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<int> batch_sizes_ TF_GUARDED_BY(mu_);
+};
+
+class RecvTensorBatcherTest : public ::testing::Test {
+ protected:
+  RecvTensorBatcherTest() : device_(Env::Default()) {}
+
+  void Init(bool supports_batch, int64 window_usecs, int max_batch_size) {
+    worker_ = new FakeWorker(supports_batch);
+    batcher_ = std::make_shared<RecvTensorBatcher>(
+        worker_,
+        [](WorkerInterface* wi) { delete static_cast<FakeWorker*>(wi); },
+        window_usecs, max_batch_size);
+  }
+
+  // Issues `n` calls and waits for all of them, checking their results.
+  void RecvAll(int n) {
+    std::vector<CallOptions> opts(n);
+    std::vector<RecvTensorRequest> requests(n);
+    std::vector<TensorResponse> responses(n);
+    std::vector<Status> statuses(n);
+    std::vector<Notification> notes(n);
+    for (int i = 0; i < n; ++i) {
+      requests[i].set_rendezvous_key(strings::StrCat("k", i));
+      responses[i].InitAlloc(&device_, AllocatorAttributes());
+      batcher_->RecvTensorAsync(&opts[i], &requests[i], &responses[i],
+                                [&statuses, &notes, i](const Status& s) {
+                                  statuses[i] = s;
+                                  notes[i].Notify();
+                                });
+    }
+    for (int i = 0; i < n; ++i) {
+      notes[i].WaitForNotification();
+      TF_EXPECT_OK(statuses[i]);
+      test::ExpectTensorEqual<float>(test::AsScalar<float>(i),
+                                     responses[i].tensor());
+    }
+  }
+
+  DummyDevice device_;
+  FakeWorker* worker_ = nullptr;  // Owned by batcher_.
+  std::shared_ptr<RecvTensorBatcher> batcher_;
+};
+
+TEST_F(RecvTensorBatcherTest, FullBatchesAreSentImmediately) {
+  // The window is long enough that only full batches are sent in time.
+  Init(/*supports_batch=*/true, /*window_usecs=*/60 * 1000 * 1000,
+       /*max_batch_size=*/4);
+  RecvAll(8);
+  EXPECT_EQ(worker_->num_batch_calls(), 2);
+  EXPECT_EQ(worker_->batch_sizes(), std::vector<int>({4, 4}));
+  EXPECT_EQ(worker_->num_recv_calls(), 0);
+}
+
+TEST_F(RecvTensorBatcherTest, PartialBatchIsSentAfterWindow) {
+  Init(/*supports_batch=*/true, /*window_usecs=*/1000, /*max_batch_size=*/16);
+  RecvAll(5);
+  EXPECT_EQ(worker_->num_batch_calls(), 1);
+  EXPECT_EQ(worker_->batch_sizes(), std::vector<int>({5}));
+  EXPECT_EQ(worker_->num_recv_calls(), 0);
+}
+
+TEST_F(RecvTensorBatcherTest, FallsBackWhenBatchingIsUnimplemented) {
+  Init(/*supports_batch=*/false, /*window_usecs=*/60 * 1000 * 1000,
+       /*max_batch_size=*/3);
+  RecvAll(3);
+  EXPECT_EQ(worker_->num_batch_calls(), 1);
+  EXPECT_EQ(worker_->num_recv_calls(), 3);
+  // Later calls go straight to RecvTensor.
+  RecvAll(3);
+  EXPECT_EQ(worker_->num_batch_calls(), 1);
+  EXPECT_EQ(worker_->num_recv_calls(), 6);
+}
+
+}  // namespace
+}  // namespace tensorflow
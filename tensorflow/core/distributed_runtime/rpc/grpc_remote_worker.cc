@@ -21,6 +21,7 @@ limitations under the License.
 #include "grpcpp/grpcpp.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/recv_tensor_batcher.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
@@ -45,7 +46,9 @@ class GrpcRemoteWorker : public WorkerInterface {
   explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
                             ::grpc::CompletionQueue* completion_queue,
                             thread::ThreadPool* callback_threadpool,
-                            WorkerCacheLogger* logger, const string& target)
+                            WorkerCacheLogger* logger, const string& target,
+                            std::shared_ptr<RecvTensorBatcher>
+                                recv_tensor_batcher = nullptr)
       : channel_(std::move(channel)),
         stub_(channel_),
         cq_(completion_queue),
@@ -66,8 +69,10 @@ class GrpcRemoteWorker : public WorkerInterface {
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
+        recvtensorbatch_(Method(GrpcWorkerMethod::kRecvTensorBatch)),
         logger_(logger),
-        target_(target) {}
+        target_(target),
+        recv_tensor_batcher_(std::move(recv_tensor_batcher)) {}
 
   ~GrpcRemoteWorker() override {}
 
@@ -200,9 +205,11 @@ class GrpcRemoteWorker : public WorkerInterface {
     int64 start_usec = Env::Default()->NowMicros();
     // Type-specialized logging for this method.
     bool logging_active = logger_->LoggingActive() || VLOG_IS_ON(2);
+    // Batched calls are acknowledged by the worker of the batcher.
+    const bool ack = recv_tensor_batcher_ == nullptr;
 
-    auto callback = [this, request, response, done, start_usec,
-                     logging_active](Status s) {
+    auto callback = [this, request, response, done, start_usec, logging_active,
+                     ack](Status s) {
       if (logging_active) {
         if (logger_->LoggingActive()) {
           int64 end_usec = Env::Default()->NowMicros();
@@ -246,15 +253,40 @@ class GrpcRemoteWorker : public WorkerInterface {
 
       // Note done() can delete this worker object, so we need to call done()
       // last.
-      if (response->metadata().require_ack()) {
+      if (ack && response->metadata().require_ack()) {
         IssueMarkRecvFinishedRequest(request->request_id());
       }
       done(s);
     };
 
+    if (recv_tensor_batcher_ != nullptr) {
+      recv_tensor_batcher_->RecvTensorAsync(call_opts, request, response,
+                                            std::move(callback));
+      return;
+    }
     IssueRequest(request, response, recvtensor_, callback, call_opts);
   }
 
+  void RecvTensorBatchAsync(CallOptions* call_opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    VLOG(1) << "RecvTensorBatchAsync with " << request->request_size()
+            << " requests";
+    auto callback = [this, request, response, done](const Status& s) {
+      if (s.ok()) {
+        for (int i = 0; i < response->response_size(); ++i) {
+          if (response->response(i).require_ack()) {
+            IssueMarkRecvFinishedRequest(request->request(i).request_id());
+          }
+        }
+      }
+      done(s);
+    };
+    IssueRequest(request, response, recvtensorbatch_, std::move(callback),
+                 call_opts);
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -328,11 +360,16 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
   const ::grpc::string markrecvfinished_;
+  const ::grpc::string recvtensorbatch_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
   const string target_;
 
+  // If set, RecvTensor calls are coalesced with those of the other workers for
+  // the same target.
+  std::shared_ptr<RecvTensorBatcher> recv_tensor_batcher_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcRemoteWorker);
 };
 
@@ -340,9 +377,25 @@ WorkerInterface* NewGrpcRemoteWorker(SharedGrpcChannelPtr channel,
                                      ::grpc::CompletionQueue* completion_queue,
                                      thread::ThreadPool* callback_threadpool,
                                      WorkerCacheLogger* logger,
-                                     const string& target) {
+                                     const string& target,
+                                     std::shared_ptr<RecvTensorBatcher>
+                                         recv_tensor_batcher) {
   return new GrpcRemoteWorker(std::move(channel), completion_queue,
-                              callback_threadpool, logger, target);
+                              callback_threadpool, logger, target,
+                              std::move(recv_tensor_batcher));
+}
+
+std::shared_ptr<RecvTensorBatcher> NewGrpcRecvTensorBatcher(
+    SharedGrpcChannelPtr channel, ::grpc::CompletionQueue* completion_queue,
+    thread::ThreadPool* callback_threadpool, WorkerCacheLogger* logger,
+    const string& target, int64 window_usecs, int max_batch_size) {
+  GrpcRemoteWorker* worker =
+      new GrpcRemoteWorker(std::move(channel), completion_queue,
+                           callback_threadpool, logger, target);
+  return std::make_shared<RecvTensorBatcher>(
+      worker,
+      [](WorkerInterface* wi) { delete static_cast<GrpcRemoteWorker*>(wi); },
+      window_usecs, max_batch_size);
 }
 
 }  // namespace tensorflow
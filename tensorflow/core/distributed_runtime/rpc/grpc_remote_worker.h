@@ -23,14 +23,23 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 
 namespace tensorflow {
+class RecvTensorBatcher;
 class WorkerCacheLogger;
 class WorkerInterface;
 
-WorkerInterface* NewGrpcRemoteWorker(SharedGrpcChannelPtr channel,
-                                     ::grpc::CompletionQueue* completion_queue,
-                                     thread::ThreadPool* callback_threadpool,
-                                     WorkerCacheLogger* logger,
-                                     const string& target);
+// If `recv_tensor_batcher` is set, the RecvTensor calls of the returned worker
+// are sent through it.
+WorkerInterface* NewGrpcRemoteWorker(
+    SharedGrpcChannelPtr channel, ::grpc::CompletionQueue* completion_queue,
+    thread::ThreadPool* callback_threadpool, WorkerCacheLogger* logger,
+    const string& target,
+    std::shared_ptr<RecvTensorBatcher> recv_tensor_batcher = nullptr);
+
+// Returns a RecvTensorBatcher that sends its batches to `target`.
+std::shared_ptr<RecvTensorBatcher> NewGrpcRecvTensorBatcher(
+    SharedGrpcChannelPtr channel, ::grpc::CompletionQueue* completion_queue,
+    thread::ThreadPool* callback_threadpool, WorkerCacheLogger* logger,
+    const string& target, int64 window_usecs, int max_batch_size);
 
 }  // namespace tensorflow
 
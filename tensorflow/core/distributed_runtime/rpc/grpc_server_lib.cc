@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstring>
 #include <limits>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "grpcpp/grpcpp.h"
@@ -89,6 +90,31 @@ RendezvousMgrInterface* NewRpcRendezvousMgr(const WorkerEnv* env) {
   return new RpcRendezvousMgr(env);
 }
 
+// Returns the names of the tasks of `old_cluster` that are missing from
+// `new_cluster` or have a different address in it.
+std::vector<string> ChangedTasks(const ClusterDef& old_cluster,
+                                 const ClusterDef& new_cluster) {
+  std::unordered_map<string, string> new_addresses;
+  for (const JobDef& job : new_cluster.job()) {
+    for (const auto& task : job.tasks()) {
+      new_addresses[strings::StrCat("/job:", job.name(), "/replica:0/task:",
+                                    task.first)] = task.second;
+    }
+  }
+  std::vector<string> changed_tasks;
+  for (const JobDef& job : old_cluster.job()) {
+    for (const auto& task : job.tasks()) {
+      string task_name = strings::StrCat("/job:", job.name(),
+                                         "/replica:0/task:", task.first);
+      auto it = new_addresses.find(task_name);
+      if (it == new_addresses.end() || it->second != task.second) {
+        changed_tasks.push_back(std::move(task_name));
+      }
+    }
+  }
+  return changed_tasks;
+}
+
 }  // namespace
 
 GrpcServer::GrpcServer(const ServerDef& server_def, Env* env)
@@ -446,6 +472,8 @@ Status GrpcServer::AddMasterEagerContextToEagerService(
 
 Status GrpcServer::UpdateServerDef(const ServerDef& server_def) {
   mutex_lock l(mu_);
+  const std::vector<string> changed_tasks =
+      ChangedTasks(server_def_.cluster(), server_def.cluster());
   server_def_ = server_def;
   WorkerCacheInterface* worker_cache;
   WorkerCacheFactoryOptions worker_cache_factory_options(server_def_);
@@ -464,10 +492,22 @@ Status GrpcServer::UpdateServerDef(const ServerDef& server_def) {
                                         &default_worker_name, &unused)) {
     return errors::Internal("Could not parse worker name.");
   }
-  worker_env_.collective_executor_mgr = CreateProdRpcCollectiveExecutorMgr(
-      server_def_.default_session_config(), worker_env_.device_mgr,
-      MaybeCreateNcclCommunicator(server_def_.default_session_config()),
-      worker_cache, default_worker_name);
+  std::unique_ptr<RpcCollectiveExecutorMgr> collective_executor_mgr =
+      CreateProdRpcCollectiveExecutorMgr(
+          server_def_.default_session_config(), worker_env_.device_mgr,
+          MaybeCreateNcclCommunicator(server_def_.default_session_config()),
+          worker_cache, default_worker_name);
+  // Keep the devices and collective groups resolved for the tasks that did
+  // not change, so that they need not be resolved again.
+  auto* previous_collective_executor_mgr =
+      dynamic_cast<RpcCollectiveExecutorMgr*>(
+          worker_env_.collective_executor_mgr.get());
+  if (previous_collective_executor_mgr != nullptr) {
+    collective_executor_mgr->InheritResolvedState(
+        previous_collective_executor_mgr);
+    collective_executor_mgr->RemoveTasks(changed_tasks);
+  }
+  worker_env_.collective_executor_mgr = std::move(collective_executor_mgr);
 
   master_env_.worker_cache = worker_cache;
   master_env_.collective_executor_mgr =
@@ -475,6 +515,16 @@ Status GrpcServer::UpdateServerDef(const ServerDef& server_def) {
   return Status::OK();
 }
 
+void GrpcServer::RemoveTasksFromCollectiveState(
+    const std::vector<string>& tasks) {
+  mutex_lock l(mu_);
+  auto* collective_executor_mgr = dynamic_cast<RpcCollectiveExecutorMgr*>(
+      worker_env_.collective_executor_mgr.get());
+  if (collective_executor_mgr != nullptr) {
+    collective_executor_mgr->RemoveTasks(tasks);
+  }
+}
+
 Status GrpcServer::Stop() {
   mutex_lock l(mu_);
   switch (state_) {
@@ -19,6 +19,8 @@ limitations under the License.
 // GrpcServer manages the lifecycle of an Eager, Worker and Master service.
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/security/credentials.h"
@@ -111,8 +113,13 @@ class GrpcServer : public ServerInterface {
   // requests from remote workers.
   Status AddMasterEagerContextToEagerService(
       const tensorflow::uint64 context_id, tensorflow::EagerContext* context);
-  // Update the set of workers that can be reached by the GRPC server
+  // Update the set of workers that can be reached by the GRPC server.  The
+  // devices and collective groups already resolved are kept, except for those
+  // of the tasks that were removed or moved to a different address.
   Status UpdateServerDef(const ServerDef& server_def);
+  // Drops the devices and collective groups resolved for `tasks`, e.g. because
+  // they were replaced by new processes at the same address.
+  void RemoveTasksFromCollectiveState(const std::vector<string>& tasks);
 
  protected:
   virtual Status GetHostAndPort(const ServerDef& server_def, string* host_name,
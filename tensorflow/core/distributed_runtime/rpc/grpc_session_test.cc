@@ -321,6 +321,89 @@ TEST(GrpcSessionTest, DisableOutputPartitionGraphs) {
   TF_CHECK_OK(session->Close());
 }
 
+// Returns true if any of the partition graphs in `metadata` has a node named
+// `name`.
+static bool HasPartitionNode(const RunMetadata& metadata, const string& name) {
+  for (const GraphDef& partition : metadata.partition_graphs()) {
+    for (const NodeDef& node : partition.node()) {
+      if (node.name() == name) return true;
+    }
+  }
+  return false;
+}
+
+TEST(GrpcSessionTest, ReuseRunGraphsWithSupersetFetches) {
+  GraphDef graph;
+  string node_names[3];
+  // c = a * b
+  CreateGraphDef(&graph, node_names);
+
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 2, &cluster));
+
+  SessionOptions options = Options(cluster->targets()[0], 1);
+  options.config.mutable_experimental()
+      ->set_reuse_run_graphs_with_superset_fetches(true);
+  std::unique_ptr<Session> session(NewRemote(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_CHECK_OK(session->Create(graph));
+
+  RunOptions run_options;
+  run_options.set_output_partition_graphs(true);
+  const string a = node_names[0] + ":0";
+  const string c = node_names[2] + ":0";
+  {
+    RunMetadata run_metadata;
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session->Run(run_options, {}, {a, c}, {}, &outputs,
+                             &run_metadata));
+    ASSERT_EQ(2, outputs.size());
+    IsSingleFloatValue(outputs[1], 4.0);
+  }
+  {
+    // Fetching only `a` runs on the graph registered above, which still
+    // contains the MatMul producing `c`.
+    RunMetadata run_metadata;
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(
+        session->Run(run_options, {}, {a}, {}, &outputs, &run_metadata));
+    ASSERT_EQ(1, outputs.size());
+    test::ExpectTensorEqual<float>(
+        test::AsTensor<float>({1, 2}, TensorShape({1, 2})), outputs[0]);
+    EXPECT_TRUE(HasPartitionNode(run_metadata, node_names[2]));
+  }
+  TF_CHECK_OK(session->Close());
+}
+
+TEST(GrpcSessionTest, MaxCachedRunGraphs) {
+  GraphDef graph;
+  string node_names[3];
+  // c = a * b
+  CreateGraphDef(&graph, node_names);
+
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_CHECK_OK(test::TestCluster::MakeTestCluster(Devices(1, 0), 2, &cluster));
+
+  SessionOptions options = Options(cluster->targets()[0], 1);
+  options.config.mutable_experimental()->set_max_cached_run_graphs(1);
+  std::unique_ptr<Session> session(NewRemote(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_CHECK_OK(session->Create(graph));
+
+  // Alternating between two signatures evicts and re-registers each graph.
+  for (int iters = 0; iters < 4; ++iters) {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session->Run({}, {node_names[2] + ":0"}, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    IsSingleFloatValue(outputs[0], 4.0);
+    TF_CHECK_OK(session->Run({}, {node_names[1] + ":0"}, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    test::ExpectTensorEqual<float>(
+        test::AsTensor<float>({2, 1}, TensorShape({2, 1})), outputs[0]);
+  }
+  TF_CHECK_OK(session->Close());
+}
+
 // A = [3 2; -1 0]; x = rand(2, 1); We want to compute the largest
 // eigenvalue for A, which is 2.0. Iteratively, we do
 //   repeat x = y / y.norm(); y = A * x; end
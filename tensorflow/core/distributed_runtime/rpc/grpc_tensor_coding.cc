@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/io/proto_encode_helper.h"
+#include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
@@ -249,5 +250,26 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
 }
 
+void EncodeRecvTensorBatchToByteBuffer(
+    std::vector<::grpc::ByteBuffer>* responses, ::grpc::ByteBuffer* result) {
+  std::vector<::grpc::Slice> slices;
+  for (::grpc::ByteBuffer& response : *responses) {
+    // The tag and length of each RecvTensorBatchResponse.response field,
+    // followed by the encoded response itself.
+    char header[core::kMaxVarint32Bytes * 2];
+    io::ProtoEncodeHelper e(header, sizeof(header));
+    e.WriteVarlengthBeginning(RecvTensorBatchResponse::kResponseFieldNumber,
+                              response.Length());
+    slices.emplace_back(e.data(), e.size());
+    std::vector<::grpc::Slice> response_slices;
+    CHECK(response.Dump(&response_slices).ok());
+    for (::grpc::Slice& slice : response_slices) {
+      slices.push_back(std::move(slice));
+    }
+  }
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  result->Swap(&tmp);
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
+#include <vector>
+
 #include "grpcpp/impl/codegen/byte_buffer.h"
 
 namespace tensorflow {
@@ -49,6 +51,14 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result);
 
+// Concatenate byte buffers that each hold an encoded RecvTensorResponse into a
+// byte buffer that is parseable as a RecvTensorBatchResponse holding them in
+// order.  The slices of "responses" are shared, not copied.
+//
+// Discards original contents of *result.
+void EncodeRecvTensorBatchToByteBuffer(
+    std::vector<::grpc::ByteBuffer>* responses, ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_cache.h"
 
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/core/distributed_runtime/recv_tensor_batcher.h"
 #include "tensorflow/core/distributed_runtime/rpc/coordination/grpc_coordination_client.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
@@ -30,6 +34,25 @@ namespace tensorflow {
 
 namespace {
 
+// Reads the RecvTensor batching options from the environment.  Batching is
+// disabled unless TF_GRPC_RECV_TENSOR_BATCH_WINDOW_USECS is positive.
+void ReadRecvTensorBatchOptions(int64* window_usecs, int64* max_batch_size) {
+  Status status = ReadInt64FromEnvVar("TF_GRPC_RECV_TENSOR_BATCH_WINDOW_USECS",
+                                      0, window_usecs);
+  if (!status.ok()) {
+    LOG(ERROR) << "Error parsing TF_GRPC_RECV_TENSOR_BATCH_WINDOW_USECS: "
+               << status;
+    *window_usecs = 0;
+  }
+  status = ReadInt64FromEnvVar("TF_GRPC_RECV_TENSOR_MAX_BATCH_SIZE", 128,
+                               max_batch_size);
+  if (!status.ok()) {
+    LOG(ERROR) << "Error parsing TF_GRPC_RECV_TENSOR_MAX_BATCH_SIZE: "
+               << status;
+    *max_batch_size = 128;
+  }
+}
+
 class GrpcWorkerCache : public WorkerCachePartial {
  public:
   explicit GrpcWorkerCache(std::shared_ptr<GrpcChannelCache> channel_cache,
@@ -40,7 +63,10 @@ class GrpcWorkerCache : public WorkerCachePartial {
         local_worker_(local_worker),
         channel_cache_(channel_cache),
         worker_env_(worker_env),
-        next_round_robin_assignment_(0) {}
+        next_round_robin_assignment_(0) {
+    ReadRecvTensorBatchOptions(&recv_tensor_batch_window_usecs_,
+                               &recv_tensor_max_batch_size_);
+  }
 
   void ListWorkers(std::vector<string>* workers) const override {
     channel_cache_->ListWorkers(workers);
@@ -62,7 +88,8 @@ class GrpcWorkerCache : public WorkerCachePartial {
       size_t index = AssignWorkerToThread(target);
       return NewGrpcRemoteWorker(
           channel, worker_env_->GetCompletionQueue(index),
-          worker_env_->GetThreadPool(), &logger_, target);
+          worker_env_->GetThreadPool(), &logger_, target,
+          GetRecvTensorBatcher(target, channel, index));
     }
   }
 
@@ -117,6 +144,23 @@ class GrpcWorkerCache : public WorkerCachePartial {
     return it->second;
   }
 
+  // Returns the batcher shared by all workers for `target`, or nullptr if
+  // RecvTensor batching is disabled.
+  std::shared_ptr<RecvTensorBatcher> GetRecvTensorBatcher(
+      const string& target, const SharedGrpcChannelPtr& channel,
+      size_t index) {
+    if (recv_tensor_batch_window_usecs_ <= 0) return nullptr;
+    mutex_lock lock(batchers_mu_);
+    std::shared_ptr<RecvTensorBatcher>& batcher = batchers_[target];
+    if (batcher == nullptr) {
+      batcher = NewGrpcRecvTensorBatcher(
+          channel, worker_env_->GetCompletionQueue(index),
+          worker_env_->GetThreadPool(), &logger_, target,
+          recv_tensor_batch_window_usecs_, recv_tensor_max_batch_size_);
+    }
+    return batcher;
+  }
+
   const string local_target_;
   WorkerInterface* const local_worker_;  // Not owned.
   std::shared_ptr<GrpcChannelCache> channel_cache_;
@@ -127,6 +171,12 @@ class GrpcWorkerCache : public WorkerCachePartial {
   std::unordered_map<std::string, size_t> target_assignments_
       TF_GUARDED_BY(assignment_mu_);
   size_t next_round_robin_assignment_ TF_GUARDED_BY(assignment_mu_);
+
+  int64 recv_tensor_batch_window_usecs_;
+  int64 recv_tensor_max_batch_size_;
+  mutex batchers_mu_;
+  std::unordered_map<string, std::shared_ptr<RecvTensorBatcher>> batchers_
+      TF_GUARDED_BY(batchers_mu_);
 };
 
 }  // namespace
@@ -157,6 +157,13 @@ class GrpcWorkerServiceThread {
          ++i) {
       EnqueueRecvTensorRequestRaw();
     }
+    for (int i = 0;
+         i < gtl::FindWithDefault(
+                 queue_depth_,
+                 static_cast<int>(GrpcWorkerMethod::kRecvTensorBatch), 100);
+         ++i) {
+      EnqueueRecvTensorBatchRequestRaw();
+    }
 
     void* tag;
     bool ok;
@@ -283,6 +290,26 @@ class GrpcWorkerServiceThread {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void RecvTensorBatchHandlerRaw(
+      WorkerCall<RecvTensorBatchRequest, ::grpc::ByteBuffer>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+
+      worker_->GrpcRecvTensorBatchAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from RecvTensorBatch:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    EnqueueRecvTensorBatchRequestRaw();
+  }
+
   void RecvBufHandler(WorkerCall<RecvBufRequest, RecvBufResponse>* call) {
     Schedule([this, call]() {
       CallOptions* call_opts = new CallOptions;
@@ -352,6 +379,19 @@ class GrpcWorkerServiceThread {
     }
   }
 
+  void EnqueueRecvTensorBatchRequestRaw() {
+    mutex_lock l(shutdown_mu_);
+    if (!is_shutdown_) {
+      Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,
+           RecvTensorBatchRequest, ::grpc::ByteBuffer>::
+          EnqueueRequestForMethod(
+              worker_service_, cq_.get(),
+              static_cast<int>(GrpcWorkerMethod::kRecvTensorBatch),
+              &GrpcWorkerServiceThread::RecvTensorBatchHandlerRaw,
+              true /* supports cancel*/);
+    }
+  }
+
   GrpcWorker* const worker_ = nullptr;  // Not owned.
   std::unique_ptr<::grpc::ServerCompletionQueue> cq_;
   std::unique_ptr<Thread> thread_;
@@ -555,6 +595,52 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+void GrpcWorker::GrpcRecvTensorBatchAsync(CallOptions* opts,
+                                          const RecvTensorBatchRequest* request,
+                                          ::grpc::ByteBuffer* response,
+                                          StatusCallback done) {
+  const int num_requests = request->request_size();
+  VLOG(3) << "GrpcRecvTensorBatchAsync with " << num_requests << " requests";
+  if (num_requests == 0) {
+    done(Status::OK());
+    return;
+  }
+  // The tensors are received independently, and the batch responds once the
+  // last of them is available.
+  struct BatchState {
+    explicit BatchState(int n) : opts(n), responses(n), pending(n) {}
+    std::vector<CallOptions> opts;
+    std::vector<::grpc::ByteBuffer> responses;
+    mutex mu;
+    Status status TF_GUARDED_BY(mu);
+    int pending TF_GUARDED_BY(mu);
+  };
+  BatchState* state = new BatchState(num_requests);
+  opts->SetCancelCallback([state]() {
+    for (CallOptions& sub_opts : state->opts) sub_opts.StartCancel();
+  });
+  for (int i = 0; i < num_requests; ++i) {
+    GrpcRecvTensorAsync(
+        &state->opts[i], &request->request(i), &state->responses[i],
+        [opts, response, done, state](const Status& s) {
+          Status status;
+          {
+            mutex_lock l(state->mu);
+            state->status.Update(s);
+            if (--state->pending > 0) return;
+            status = state->status;
+          }
+          opts->ClearCancelCallback();
+          if (status.ok()) {
+            grpc::EncodeRecvTensorBatchToByteBuffer(&state->responses,
+                                                    response);
+          }
+          delete state;
+          done(status);
+        });
+  }
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
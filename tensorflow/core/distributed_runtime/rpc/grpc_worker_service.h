@@ -46,6 +46,14 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Receives the tensors of all requests in `request` like
+  // GrpcRecvTensorAsync, and encodes them into `response` as a
+  // RecvTensorBatchResponse once all of them are available.
+  void GrpcRecvTensorBatchAsync(CallOptions* opts,
+                                const RecvTensorBatchRequest* request,
+                                ::grpc::ByteBuffer* response,
+                                StatusCallback done);
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -0,0 +1,656 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/rdma/rdma_memory_manager.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <rdma/rdma_cma.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/process_state.h"
+#include "tensorflow/core/distributed_runtime/rpc/rdma/tensor_buffer_registry.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#if GOOGLE_CUDA
+#include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#endif  // GOOGLE_CUDA
+
+namespace tensorflow {
+
+namespace {
+
+// Bounds the work requests outstanding on each queue pair.  Reads beyond
+// kMaxSendWorkRequests wait in a queue of their endpoint.
+constexpr int kMaxSendWorkRequests = 1024;
+constexpr int kMaxRecvWorkRequests = 256;
+constexpr int kMaxCompletionQueueDepth = 1 << 16;
+constexpr int kMaxCompletionsPerPoll = 64;
+constexpr int kPollTimeoutMs = 100;
+// A single read request is limited in size, so larger buffers are read in
+// several requests.
+constexpr size_t kMaxReadBytes = 1 << 30;
+constexpr int kNumCallbackThreads = 8;
+
+// Set in the wr_id of receive work requests, which carry the rdma_cm_id of
+// their queue pair.  The wr_id of send work requests is a WorkRequest.
+constexpr uintptr_t kRecvWorkRequestTag = 1;
+
+Status ErrnoStatus(const char* what) {
+  return errors::Unavailable(what, " failed: ", strerror(errno));
+}
+
+const char* EndAddress(const ibv_mr* mr) {
+  return static_cast<const char*>(mr->addr) + mr->length;
+}
+
+bool ComesBefore(const void* addr, const ibv_mr* mr) {
+  return addr < EndAddress(mr);
+}
+
+class RdmaMemoryManager : public RemoteMemoryManager {
+ public:
+  RdmaMemoryManager(const string& host, const string& port)
+      : host_(host), port_(port) {}
+  ~RdmaMemoryManager() override;
+
+  Status Init() override;
+  void Run() override;
+  void Stop() override { stopped_ = true; }
+
+  Status TransportOptionsFromTensor(
+      ::google::protobuf::Any* mutable_transport_options, const Tensor& tensor,
+      int64 step_id) override;
+
+  void ReleaseStep(int64 step_id) override {
+    const int num_released = tensor_buffers_.ReleaseStep(step_id);
+    if (num_released > 0) {
+      VLOG(1) << "Released " << num_released << " buffers of step " << step_id
+              << " that their receivers did not release";
+    }
+  }
+
+  void ReleaseAll() override { tensor_buffers_.ReleaseAll(); }
+
+  void TensorFromTransportOptions(
+      Tensor* tensor, const ::google::protobuf::Any& transport_options,
+      StatusCallback done) override;
+
+ private:
+  struct WorkRequest;
+
+  // A connection to a worker that this worker reads from.
+  struct Endpoint {
+    rdma_cm_id* id = nullptr;
+    int num_in_flight = 0;
+    std::deque<WorkRequest*> queued;
+    // Set once a work request failed; the next read reconnects.
+    bool broken = false;
+  };
+
+  // A send work request, and what to do once it has completed.
+  struct WorkRequest {
+    explicit WorkRequest(Endpoint* endpoint) : endpoint(endpoint) {
+      memset(&sge, 0, sizeof(sge));
+      memset(&wr, 0, sizeof(wr));
+      wr.wr_id = reinterpret_cast<uintptr_t>(this);
+      wr.send_flags = IBV_SEND_SIGNALED;
+    }
+    Endpoint* const endpoint;
+    ibv_sge sge;
+    ibv_send_wr wr;
+    std::function<void(const Status&)> done;
+  };
+
+  ibv_qp_init_attr QueuePairAttributes() const;
+  Status GetEndpoint(const string& host, const string& port,
+                     Endpoint** endpoint);
+  void PostSend(WorkRequest* request);
+  void PostRecv(rdma_cm_id* id);
+  void Complete(WorkRequest* request, const Status& status);
+  void ReleaseTensorBuffer(uint32 tensor_key);
+
+  void HandleConnectionEvents();
+  void HandleCompletions();
+  void HandleCompletion(const ibv_wc& wc);
+
+  // Returns a registered region that contains [addr, addr + length), or
+  // nullptr.
+  ibv_mr* FindMemoryRegion(const void* addr, size_t length);
+  void InsertMemoryRegion(void* addr, size_t length);
+  void EvictMemoryRegion(void* addr, size_t length);
+
+  const string host_;
+  const string port_;
+  rdma_event_channel* event_channel_ = nullptr;
+  rdma_cm_id* listening_ = nullptr;
+  ibv_pd* pd_ = nullptr;
+  ibv_comp_channel* comp_channel_ = nullptr;
+  ibv_cq* cq_ = nullptr;
+  int max_qp_rd_atom_ = 0;
+  std::atomic<bool> stopped_{false};
+  // Runs the callbacks of reads, off the polling thread.
+  std::unique_ptr<thread::ThreadPool> callback_pool_;
+
+  mutex regions_mu_;
+  // Registered allocator regions, sorted by address.
+  std::vector<ibv_mr*> regions_ TF_GUARDED_BY(regions_mu_);
+
+  // Buffers that remote workers have not released yet.
+  TensorBufferRegistry tensor_buffers_;
+
+  // Serializes connection setup, so that each target is connected once.
+  mutex connect_mu_;
+  mutex mu_;
+  std::map<string, Endpoint*> endpoints_ TF_GUARDED_BY(mu_);
+  // Every endpoint created, including broken ones.
+  std::vector<std::unique_ptr<Endpoint>> all_endpoints_ TF_GUARDED_BY(mu_);
+
+  // Connections accepted from workers that read from this one.  Only accessed
+  // by the thread that calls Run().
+  std::vector<rdma_cm_id*> accepted_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RdmaMemoryManager);
+};
+
+RdmaMemoryManager::~RdmaMemoryManager() {
+  Stop();
+  for (auto& endpoint : all_endpoints_) {
+    for (WorkRequest* request : endpoint->queued) delete request;
+    rdma_destroy_ep(endpoint->id);
+  }
+  for (rdma_cm_id* id : accepted_) {
+    rdma_destroy_qp(id);
+    rdma_destroy_id(id);
+  }
+  tensor_buffers_.ReleaseAll();
+  for (ibv_mr* mr : regions_) ibv_dereg_mr(mr);
+  if (cq_ != nullptr) ibv_destroy_cq(cq_);
+  if (comp_channel_ != nullptr) ibv_destroy_comp_channel(comp_channel_);
+  if (pd_ != nullptr) ibv_dealloc_pd(pd_);
+  if (listening_ != nullptr) rdma_destroy_id(listening_);
+  if (event_channel_ != nullptr) rdma_destroy_event_channel(event_channel_);
+}
+
+Status RdmaMemoryManager::Init() {
+  event_channel_ = rdma_create_event_channel();
+  if (event_channel_ == nullptr) {
+    return ErrnoStatus("rdma_create_event_channel");
+  }
+  if (rdma_create_id(event_channel_, &listening_, nullptr, RDMA_PS_TCP)) {
+    return ErrnoStatus("rdma_create_id");
+  }
+  rdma_addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_port_space = RDMA_PS_TCP;
+  hints.ai_flags = RAI_PASSIVE;
+  rdma_addrinfo* addrinfo;
+  if (rdma_getaddrinfo(host_.c_str(), port_.c_str(), &hints, &addrinfo)) {
+    return errors::Unavailable("Cannot resolve RDMA address ", host_, ":",
+                               port_, ": ", strerror(errno));
+  }
+  const int ret = rdma_bind_addr(listening_, addrinfo->ai_src_addr);
+  rdma_freeaddrinfo(addrinfo);
+  if (ret) {
+    return ErrnoStatus("rdma_bind_addr");
+  }
+  if (listening_->verbs == nullptr) {
+    return errors::Unavailable("No RDMA device is bound to ", host_);
+  }
+  if (rdma_listen(listening_, /*backlog=*/128)) {
+    return ErrnoStatus("rdma_listen");
+  }
+
+  ibv_device_attr device_attr;
+  if (ibv_query_device(listening_->verbs, &device_attr)) {
+    return ErrnoStatus("ibv_query_device");
+  }
+  max_qp_rd_atom_ = device_attr.max_qp_rd_atom;
+  pd_ = ibv_alloc_pd(listening_->verbs);
+  if (pd_ == nullptr) {
+    return ErrnoStatus("ibv_alloc_pd");
+  }
+  comp_channel_ = ibv_create_comp_channel(listening_->verbs);
+  if (comp_channel_ == nullptr) {
+    return ErrnoStatus("ibv_create_comp_channel");
+  }
+  cq_ = ibv_create_cq(listening_->verbs,
+                      std::min(device_attr.max_cqe, kMaxCompletionQueueDepth),
+                      nullptr, comp_channel_, 0);
+  if (cq_ == nullptr) {
+    return ErrnoStatus("ibv_create_cq");
+  }
+  if (ibv_req_notify_cq(cq_, 0)) {
+    return ErrnoStatus("ibv_req_notify_cq");
+  }
+  for (int fd : {event_channel_->fd, comp_channel_->fd}) {
+    const int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+      return ErrnoStatus("fcntl");
+    }
+  }
+  callback_pool_ = absl::make_unique<thread::ThreadPool>(
+      Env::Default(), "rdma_callbacks", kNumCallbackThreads);
+
+  SubAllocator::Visitor alloc_visitor = [this](void* ptr, int numa_node,
+                                               size_t num_bytes) {
+    InsertMemoryRegion(ptr, num_bytes);
+  };
+  SubAllocator::Visitor free_visitor = [this](void* ptr, int numa_node,
+                                              size_t num_bytes) {
+    EvictMemoryRegion(ptr, num_bytes);
+  };
+  ProcessState::singleton()->AddCPUAllocVisitor(alloc_visitor);
+  ProcessState::singleton()->AddCPUFreeVisitor(free_visitor);
+#if GOOGLE_CUDA
+  for (int numa_node = 0; numa_node < port::NUMANumNodes(); ++numa_node) {
+    GPUProcessState::singleton()->AddGpuHostAllocVisitor(numa_node,
+                                                         alloc_visitor);
+    GPUProcessState::singleton()->AddGpuHostFreeVisitor(numa_node,
+                                                        free_visitor);
+  }
+#endif  // GOOGLE_CUDA
+
+  LOG(INFO) << "RDMA memory manager listening on " << host_ << ":" << port_;
+  return Status::OK();
+}
+
+void RdmaMemoryManager::Run() {
+  pollfd fds[2];
+  fds[0].fd = event_channel_->fd;
+  fds[0].events = POLLIN;
+  fds[1].fd = comp_channel_->fd;
+  fds[1].events = POLLIN;
+  while (!stopped_) {
+    if (poll(fds, 2, kPollTimeoutMs) < 0) {
+      if (errno != EINTR) {
+        LOG(ERROR) << "poll failed: " << strerror(errno);
+      }
+      continue;
+    }
+    if (fds[0].revents & POLLIN) HandleConnectionEvents();
+    if (fds[1].revents & POLLIN) HandleCompletions();
+  }
+}
+
+ibv_qp_init_attr RdmaMemoryManager::QueuePairAttributes() const {
+  ibv_qp_init_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.send_cq = cq_;
+  attr.recv_cq = cq_;
+  attr.qp_type = IBV_QPT_RC;
+  attr.cap.max_send_wr = kMaxSendWorkRequests;
+  attr.cap.max_recv_wr = kMaxRecvWorkRequests;
+  attr.cap.max_send_sge = 1;
+  attr.cap.max_recv_sge = 1;
+  return attr;
+}
+
+void RdmaMemoryManager::HandleConnectionEvents() {
+  rdma_cm_event* event;
+  while (rdma_get_cm_event(event_channel_, &event) == 0) {
+    rdma_cm_id* id = event->id;
+    const rdma_cm_event_type type = event->event;
+    rdma_conn_param param;
+    memset(&param, 0, sizeof(param));
+    if (type == RDMA_CM_EVENT_CONNECT_REQUEST) {
+      param.responder_resources =
+          std::min<int>(event->param.conn.initiator_depth, max_qp_rd_atom_);
+      param.initiator_depth =
+          std::min<int>(event->param.conn.responder_resources, max_qp_rd_atom_);
+    }
+    rdma_ack_cm_event(event);
+
+    if (type == RDMA_CM_EVENT_CONNECT_REQUEST) {
+      ibv_qp_init_attr attr = QueuePairAttributes();
+      if (rdma_create_qp(id, pd_, &attr)) {
+        LOG(ERROR) << ErrnoStatus("rdma_create_qp");
+        rdma_reject(id, nullptr, 0);
+        rdma_destroy_id(id);
+        continue;
+      }
+      for (int i = 0; i < kMaxRecvWorkRequests; ++i) PostRecv(id);
+      if (rdma_accept(id, &param)) {
+        LOG(ERROR) << ErrnoStatus("rdma_accept");
+        rdma_destroy_qp(id);
+        rdma_destroy_id(id);
+        continue;
+      }
+      accepted_.push_back(id);
+    } else if (type == RDMA_CM_EVENT_DISCONNECTED) {
+      auto it = std::find(accepted_.begin(), accepted_.end(), id);
+      if (it == accepted_.end()) continue;
+      // Drains the completions that may still refer to `id`.
+      HandleCompletions();
+      accepted_.erase(it);
+      rdma_destroy_qp(id);
+      rdma_destroy_id(id);
+    }
+  }
+}
+
+void RdmaMemoryManager::HandleCompletions() {
+  ibv_cq* cq;
+  void* cq_context;
+  if (ibv_get_cq_event(comp_channel_, &cq, &cq_context) == 0) {
+    ibv_ack_cq_events(cq, 1);
+    if (ibv_req_notify_cq(cq, 0)) {
+      LOG(ERROR) << ErrnoStatus("ibv_req_notify_cq");
+    }
+  }
+  ibv_wc wcs[kMaxCompletionsPerPoll];
+  int n;
+  while ((n = ibv_poll_cq(cq_, kMaxCompletionsPerPoll, wcs)) > 0) {
+    for (int i = 0; i < n; ++i) HandleCompletion(wcs[i]);
+  }
+  if (n < 0) {
+    LOG(ERROR) << "ibv_poll_cq failed";
+  }
+}
+
+void RdmaMemoryManager::HandleCompletion(const ibv_wc& wc) {
+  if (wc.wr_id & kRecvWorkRequestTag) {
+    // Receives are flushed with an error when their connection goes away.
+    if (wc.status != IBV_WC_SUCCESS) return;
+    ReleaseTensorBuffer(ntohl(wc.imm_data));
+    PostRecv(reinterpret_cast<rdma_cm_id*>(wc.wr_id & ~kRecvWorkRequestTag));
+    return;
+  }
+  WorkRequest* request = reinterpret_cast<WorkRequest*>(wc.wr_id);
+  Endpoint* endpoint = request->endpoint;
+  WorkRequest* next = nullptr;
+  {
+    mutex_lock l(mu_);
+    --endpoint->num_in_flight;
+    if (wc.status != IBV_WC_SUCCESS) endpoint->broken = true;
+    if (!endpoint->queued.empty()) {
+      next = endpoint->queued.front();
+      endpoint->queued.pop_front();
+    }
+  }
+  Status s;
+  if (wc.status != IBV_WC_SUCCESS) {
+    s = errors::Unavailable("RDMA work request failed: ",
+                            ibv_wc_status_str(wc.status));
+  }
+  Complete(request, s);
+  if (next != nullptr) PostSend(next);
+}
+
+Status RdmaMemoryManager::GetEndpoint(const string& host, const string& port,
+                                      Endpoint** endpoint) {
+  const string target = strings::StrCat(host, ":", port);
+  auto find_endpoint = [this, &target, endpoint]() {
+    mutex_lock l(mu_);
+    auto it = endpoints_.find(target);
+    if (it == endpoints_.end() || it->second->broken) return false;
+    *endpoint = it->second;
+    return true;
+  };
+  if (find_endpoint()) return Status::OK();
+  mutex_lock connect_lock(connect_mu_);
+  if (find_endpoint()) return Status::OK();
+
+  rdma_addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_port_space = RDMA_PS_TCP;
+  rdma_addrinfo* addrinfo;
+  if (rdma_getaddrinfo(host.c_str(), port.c_str(), &hints, &addrinfo)) {
+    return errors::Unavailable("Cannot resolve RDMA address ", target, ": ",
+                               strerror(errno));
+  }
+  ibv_qp_init_attr attr = QueuePairAttributes();
+  rdma_cm_id* id;
+  const int ret = rdma_create_ep(&id, addrinfo, pd_, &attr);
+  rdma_freeaddrinfo(addrinfo);
+  if (ret) {
+    return ErrnoStatus("rdma_create_ep");
+  }
+  rdma_conn_param param;
+  memset(&param, 0, sizeof(param));
+  param.initiator_depth = max_qp_rd_atom_;
+  param.responder_resources = max_qp_rd_atom_;
+  param.retry_count = 7;
+  param.rnr_retry_count = 7;
+  if (rdma_connect(id, &param)) {
+    Status s = errors::Unavailable("Cannot connect to ", target,
+                                   " over RDMA: ", strerror(errno));
+    rdma_destroy_ep(id);
+    return s;
+  }
+  VLOG(1) << "Connected to " << target << " over RDMA";
+
+  auto new_endpoint = absl::make_unique<Endpoint>();
+  new_endpoint->id = id;
+  mutex_lock l(mu_);
+  *endpoint = new_endpoint.get();
+  endpoints_[target] = new_endpoint.get();
+  all_endpoints_.push_back(std::move(new_endpoint));
+  return Status::OK();
+}
+
+void RdmaMemoryManager::PostSend(WorkRequest* request) {
+  Endpoint* endpoint = request->endpoint;
+  {
+    mutex_lock l(mu_);
+    if (endpoint->num_in_flight >= kMaxSendWorkRequests) {
+      endpoint->queued.push_back(request);
+      return;
+    }
+    ++endpoint->num_in_flight;
+  }
+  ibv_send_wr* bad_wr;
+  const int ret = ibv_post_send(endpoint->id->qp, &request->wr, &bad_wr);
+  if (ret) {
+    {
+      mutex_lock l(mu_);
+      --endpoint->num_in_flight;
+      endpoint->broken = true;
+    }
+    Complete(request, errors::Unavailable("ibv_post_send failed: ",
+                                          strerror(ret)));
+  }
+}
+
+void RdmaMemoryManager::PostRecv(rdma_cm_id* id) {
+  ibv_recv_wr wr;
+  memset(&wr, 0, sizeof(wr));
+  wr.wr_id = reinterpret_cast<uintptr_t>(id) | kRecvWorkRequestTag;
+  ibv_recv_wr* bad_wr;
+  const int ret = ibv_post_recv(id->qp, &wr, &bad_wr);
+  if (ret) {
+    LOG(ERROR) << "ibv_post_recv failed: " << strerror(ret);
+  }
+}
+
+void RdmaMemoryManager::Complete(WorkRequest* request, const Status& status) {
+  if (request->done) request->done(status);
+  delete request;
+}
+
+Status RdmaMemoryManager::TransportOptionsFromTensor(
+    ::google::protobuf::Any* mutable_transport_options, const Tensor& tensor,
+    int64 step_id) {
+  void* addr = const_cast<void*>(DMAHelper::base(&tensor));
+  const size_t length = tensor.TotalBytes();
+  ibv_mr* mr = FindMemoryRegion(addr, length);
+  ibv_mr* own_mr = nullptr;
+  if (mr == nullptr) {
+    VLOG(2) << "Registering a buffer of " << length
+            << " bytes outside of the allocator regions";
+    own_mr = mr = ibv_reg_mr(pd_, addr, length, IBV_ACCESS_REMOTE_READ);
+    if (mr == nullptr) {
+      return ErrnoStatus("ibv_reg_mr");
+    }
+  }
+  // Deregisters the buffer before it is freed with `tensor`.
+  const uint32 tensor_key =
+      tensor_buffers_.Register(step_id, tensor, [own_mr]() {
+        if (own_mr != nullptr) ibv_dereg_mr(own_mr);
+      });
+  RemoteMemoryRegion region;
+  region.set_host(host_);
+  region.set_port(port_);
+  region.set_addr(reinterpret_cast<uintptr_t>(addr));
+  region.set_rkey(mr->rkey);
+  region.set_tensor_key(tensor_key);
+  mutable_transport_options->PackFrom(region);
+  return Status::OK();
+}
+
+void RdmaMemoryManager::ReleaseTensorBuffer(uint32 tensor_key) {
+  // The buffer is gone if its step was cleaned up before the receiver
+  // released it.
+  if (!tensor_buffers_.Release(tensor_key)) {
+    VLOG(1) << "Released an unknown tensor buffer " << tensor_key;
+  }
+}
+
+void RdmaMemoryManager::TensorFromTransportOptions(
+    Tensor* tensor, const ::google::protobuf::Any& transport_options,
+    StatusCallback done) {
+  RemoteMemoryRegion region;
+  if (!transport_options.UnpackTo(&region)) {
+    done(errors::Internal("Transport options are not a RemoteMemoryRegion"));
+    return;
+  }
+  Endpoint* endpoint;
+  Status s = GetEndpoint(region.host(), region.port(), &endpoint);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+  char* addr = static_cast<char*>(DMAHelper::base(tensor));
+  const size_t length = tensor->TotalBytes();
+  ibv_mr* mr = FindMemoryRegion(addr, length);
+  ibv_mr* own_mr = nullptr;
+  if (mr == nullptr) {
+    own_mr = mr = ibv_reg_mr(pd_, addr, length, IBV_ACCESS_LOCAL_WRITE);
+    if (mr == nullptr) {
+      done(ErrnoStatus("ibv_reg_mr"));
+      return;
+    }
+  }
+
+  struct ReadState {
+    mutex mu;
+    int pending TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+  };
+  const int num_reads =
+      std::max<size_t>(1, (length + kMaxReadBytes - 1) / kMaxReadBytes);
+  ReadState* state = new ReadState;
+  state->pending = num_reads;
+  const uint32 tensor_key = region.tensor_key();
+  auto read_done = [this, state, endpoint, own_mr, tensor_key,
+                    done](const Status& s) {
+    Status status;
+    {
+      mutex_lock l(state->mu);
+      state->status.Update(s);
+      if (--state->pending > 0) return;
+      status = state->status;
+    }
+    delete state;
+    if (own_mr != nullptr) ibv_dereg_mr(own_mr);
+    // Lets the owner free its buffer.
+    WorkRequest* release = new WorkRequest(endpoint);
+    release->wr.opcode = IBV_WR_SEND_WITH_IMM;
+    release->wr.imm_data = htonl(tensor_key);
+    PostSend(release);
+    callback_pool_->Schedule([done, status]() { done(status); });
+  };
+  for (int i = 0; i < num_reads; ++i) {
+    const size_t offset = i * kMaxReadBytes;
+    WorkRequest* read = new WorkRequest(endpoint);
+    read->sge.addr = reinterpret_cast<uintptr_t>(addr + offset);
+    read->sge.length = std::min(kMaxReadBytes, length - offset);
+    read->sge.lkey = mr->lkey;
+    read->wr.opcode = IBV_WR_RDMA_READ;
+    read->wr.sg_list = &read->sge;
+    read->wr.num_sge = 1;
+    read->wr.wr.rdma.remote_addr = region.addr() + offset;
+    read->wr.wr.rdma.rkey = region.rkey();
+    read->done = read_done;
+    PostSend(read);
+  }
+}
+
+ibv_mr* RdmaMemoryManager::FindMemoryRegion(const void* addr, size_t length) {
+  mutex_lock l(regions_mu_);
+  auto it = std::upper_bound(regions_.begin(), regions_.end(), addr,
+                             &ComesBefore);
+  if (it == regions_.end() || (*it)->addr > addr ||
+      static_cast<const char*>(addr) + length > EndAddress(*it)) {
+    return nullptr;
+  }
+  return *it;
+}
+
+void RdmaMemoryManager::InsertMemoryRegion(void* addr, size_t length) {
+  if (length == 0) return;
+  ibv_mr* mr = ibv_reg_mr(pd_, addr, length,
+                          IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ);
+  if (mr == nullptr) {
+    LOG(WARNING) << "Cannot register " << length << " bytes at " << addr
+                 << " for RDMA: " << strerror(errno);
+    return;
+  }
+  mutex_lock l(regions_mu_);
+  auto it = std::upper_bound(regions_.begin(), regions_.end(), addr,
+                             &ComesBefore);
+  regions_.insert(it, mr);
+}
+
+void RdmaMemoryManager::EvictMemoryRegion(void* addr, size_t length) {
+  if (length == 0) return;
+  mutex_lock l(regions_mu_);
+  auto it = std::upper_bound(regions_.begin(), regions_.end(), addr,
+                             &ComesBefore);
+  if (it == regions_.end() || (*it)->addr != addr) {
+    LOG(WARNING) << "Evicting an unregistered region at " << addr;
+    return;
+  }
+  ibv_dereg_mr(*it);
+  regions_.erase(it);
+}
+
+}  // namespace
+
+RemoteMemoryManager* CreateRemoteMemoryManager(const string& host,
+                                               const string& port) {
+  return new RdmaMemoryManager(host, port);
+}
+
+}  // namespace tensorflow
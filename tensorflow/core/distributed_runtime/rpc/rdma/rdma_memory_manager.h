@@ -0,0 +1,78 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RDMA_RDMA_MEMORY_MANAGER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RDMA_RDMA_MEMORY_MANAGER_H_
+
+#include <string>
+
+#include "google/protobuf/any.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Moves the contents of host tensors between workers with one-sided RDMA
+// reads.  The owner of a tensor describes its buffer in the transport options
+// of a RecvTensorResponse, and the receiver reads the buffer into its own
+// tensor, without involving the CPU of the owner.
+//
+// The memory regions of the CPU and GPU host allocators are registered with
+// the RDMA device as they are allocated, so that most tensors can be read
+// without registering their buffers first.
+class RemoteMemoryManager {
+ public:
+  virtual ~RemoteMemoryManager() {}
+
+  // Starts listening for connections, and registers the allocator visitors.
+  // Must be called before the first memory allocation of any local device.
+  virtual Status Init() = 0;
+
+  // Handles connections and completions until Stop() is called.  Runs in a
+  // dedicated thread.
+  virtual void Run() = 0;
+  virtual void Stop() = 0;
+
+  // Describes the buffer of `tensor` in `mutable_transport_options`.  The
+  // buffer, which must be host memory, is kept alive until the receiver has
+  // read it, or until step `step_id` is released.
+  virtual Status TransportOptionsFromTensor(
+      ::google::protobuf::Any* mutable_transport_options, const Tensor& tensor,
+      int64 step_id) = 0;
+
+  // Releases the buffers of step `step_id` that their receivers did not
+  // release, once the step is cleaned up.
+  virtual void ReleaseStep(int64 step_id) = 0;
+
+  // Releases all buffers that their receivers did not release.
+  virtual void ReleaseAll() = 0;
+
+  // Reads the buffer described by `transport_options` into `tensor`, which
+  // must be allocated in host memory with the dtype and shape of the remote
+  // tensor.  Calls `done` once the read has completed.
+  virtual void TensorFromTransportOptions(
+      Tensor* tensor, const ::google::protobuf::Any& transport_options,
+      StatusCallback done) = 0;
+};
+
+// Creates a RemoteMemoryManager that listens for RDMA connections on
+// `host`:`port`.
+RemoteMemoryManager* CreateRemoteMemoryManager(const std::string& host,
+                                               const std::string& port);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RDMA_RDMA_MEMORY_MANAGER_H_
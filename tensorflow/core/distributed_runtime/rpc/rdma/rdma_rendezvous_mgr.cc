@@ -0,0 +1,282 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/rdma/rdma_rendezvous_mgr.h"
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/distributed_runtime/request_id.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/worker_cache.h"
+#include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/distributed_runtime/worker_session.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+
+namespace {
+
+class RdmaRemoteRendezvous : public BaseRemoteRendezvous {
+ public:
+  RdmaRemoteRendezvous(const WorkerEnv* env, int64 step_id,
+                       RemoteMemoryManager* remote_memory_manager)
+      : BaseRemoteRendezvous(env, step_id),
+        remote_memory_manager_(remote_memory_manager) {}
+
+ protected:
+  void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
+                           const Rendezvous::Args& recv_args,
+                           DoneCallback done) override;
+
+ private:
+  ~RdmaRemoteRendezvous() override {}
+
+  RemoteMemoryManager* const remote_memory_manager_;  // Not owned.
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RdmaRemoteRendezvous);
+};
+
+// Used only to retrieve tensors from remote processes.
+class RdmaRecvTensorCall : public BaseRecvTensorCall {
+ public:
+  RdmaRecvTensorCall(WorkerInterface* wi, Device* dst_device,
+                     RemoteMemoryManager* remote_memory_manager,
+                     const Rendezvous::Args& recv_args, int64 step_id,
+                     StringPiece key)
+      : wi_(wi),
+        dst_device_(dst_device),
+        remote_memory_manager_(remote_memory_manager),
+        recv_args_(recv_args) {
+    req_.set_step_id(step_id);
+    req_.set_rendezvous_key(key.data(), key.size());
+    req_.set_request_id(GetUniqueRequestId());
+    // Asks the sender to respond with the location of the tensor buffer.
+    req_.mutable_transport_options()->PackFrom(RemoteMemoryRegion());
+  }
+
+  void Start(std::function<void()> recv_done) override {
+    // RDMA reads go to host memory, so tensors for GPUs are staged in pinned
+    // host memory.
+    AllocatorAttributes alloc_attrs = recv_args_.alloc_attrs;
+    staged_on_host_ = !alloc_attrs.on_host() &&
+                      dst_device_->device_type() != DEVICE_CPU &&
+                      dst_device_->tensorflow_gpu_device_info() != nullptr;
+    if (staged_on_host_) {
+      alloc_attrs = AllocatorAttributes();
+      alloc_attrs.set_on_host(true);
+      alloc_attrs.set_gpu_compatible(true);
+    }
+    resp_.InitAlloc(dst_device_, alloc_attrs);
+
+    auto abort_checked = std::make_shared<Notification>();
+    auto cb = [this, abort_checked,
+               recv_done = std::move(recv_done)](const Status& s) {
+      // Make sure the Rendezvous abort checking is finished before running the
+      // callback, which might destroy the current call object.
+      abort_checked->WaitForNotification();
+      if (!s.ok()) {
+        UpdateStatus(s);
+        recv_done();
+        return;
+      }
+      tensor_ = resp_.tensor();
+      const auto& transport_options = resp_.metadata().transport_options();
+      if (!transport_options.Is<RemoteMemoryRegion>()) {
+        recv_done();
+        return;
+      }
+      // `tensor_` was allocated from the metadata in the response, and its
+      // contents are read from the sender.
+      remote_memory_manager_->TensorFromTransportOptions(
+          &tensor_, transport_options, [this, recv_done](const Status& s) {
+            if (!s.ok()) UpdateStatus(s);
+            recv_done();
+          });
+    };
+    wi_->RecvTensorAsync(&opts_, &req_, &resp_, std::move(cb));
+
+    // See RpcRecvTensorCall: `StartAbort` could have been called before the
+    // RPC registered its cancellation with `opts_`.
+    if (!status().ok()) {
+      opts_.StartCancel();
+    }
+    abort_checked->Notify();
+  }
+
+  void StartAbort(const Status& s) override {
+    UpdateStatus(s);
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  const Tensor& tensor() const { return tensor_; }
+  bool is_dead() const { return resp_.metadata().is_dead(); }
+  // Whether `tensor()` is in pinned host memory and still has to be copied to
+  // `dst_device()`.
+  bool staged_on_host() const { return staged_on_host_; }
+  Device* dst_device() const { return dst_device_; }
+  const Rendezvous::Args& recv_args() const { return recv_args_; }
+
+ private:
+  void UpdateStatus(const Status& s) {
+    mutex_lock l(mu_);
+    status_.Update(s);
+  }
+
+  WorkerInterface* const wi_;  // Not owned.
+  Device* const dst_device_;
+  RemoteMemoryManager* const remote_memory_manager_;  // Not owned.
+  const Rendezvous::Args recv_args_;
+  bool staged_on_host_ = false;
+  CallOptions opts_;
+  RecvTensorRequest req_;
+  TensorResponse resp_;
+  Tensor tensor_;
+
+  mutable mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RdmaRecvTensorCall);
+};
+
+// Copies `host_tensor`, which was received into pinned host memory, to the
+// memory of `dst_device` described by `recv_args`.
+void CopyStagedTensorToDevice(
+    const Tensor& host_tensor, Device* dst_device,
+    const Rendezvous::Args& recv_args,
+    std::function<void(const Status&, const Tensor&)> done) {
+  if (!DataTypeCanUseMemcpy(host_tensor.dtype())) {
+    // Types like variants are converted by the device itself.
+    TensorProto proto;
+    host_tensor.AsProtoField(&proto);
+    Tensor device_tensor;
+    Status s = dst_device->MakeTensorFromProto(proto, recv_args.alloc_attrs,
+                                               &device_tensor);
+    done(s, device_tensor);
+    return;
+  }
+  DeviceContext* device_context = recv_args.device_context;
+  if (device_context == nullptr) {
+    device_context = dst_device->tensorflow_gpu_device_info()->default_context;
+  }
+  auto* source = new Tensor(host_tensor);
+  auto* device_tensor =
+      new Tensor(dst_device->GetAllocator(recv_args.alloc_attrs),
+                 host_tensor.dtype(), host_tensor.shape());
+  device_context->CopyCPUTensorToDevice(
+      source, dst_device, device_tensor,
+      [source, device_tensor, done = std::move(done)](const Status& s) {
+        done(s, *device_tensor);
+        delete source;
+        delete device_tensor;
+      });
+}
+
+void RdmaRemoteRendezvous::RecvFromRemoteAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
+  CHECK(is_initialized());
+
+  // key.src_device identifies a remote device.
+  string src_worker;
+  string src_rel_device;
+  if (!DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                        &src_rel_device)) {
+    done(errors::Internal(parsed.src_device,
+                          " is invalid remote source device."),
+         Args(), recv_args, Tensor(), false);
+    return;
+  }
+  WorkerSession* sess = session();
+  std::shared_ptr<WorkerCacheInterface> worker_cache =
+      sess->GetSharedWorkerCache();
+  WorkerInterface* rwi = worker_cache->GetOrCreateWorker(src_worker);
+  if (rwi == nullptr) {
+    done(errors::Internal("No worker known as ", src_worker), Args(),
+         recv_args, Tensor(), false);
+    return;
+  }
+  Device* dst_device;
+  Status s = sess->device_mgr()->LookupDevice(parsed.dst_device, &dst_device);
+  if (!s.ok()) {
+    worker_cache->ReleaseWorker(src_worker, rwi);
+    done(s, Args(), recv_args, Tensor(), false);
+    return;
+  }
+
+  RdmaRecvTensorCall* call =
+      new RdmaRecvTensorCall(rwi, dst_device, remote_memory_manager_,
+                             recv_args, step_id_, parsed.FullKey());
+
+  // Record "call" in active_ so that it can be aborted cleanly.
+  RegisterCall(call, recv_args);
+
+  // RendezvousMgr already aborted, shouldn't send RPC call any more
+  if (!call->status().ok()) {
+    DeregisterCall(call);
+    worker_cache->ReleaseWorker(src_worker, rwi);
+    done(call->status(), Args(), Args(), Tensor(), false);
+    delete call;
+    return;
+  }
+
+  // Start "call".
+  Ref();
+  call->Start([this, call, src_worker, rwi, worker_cache, done]() {
+    // Removes "call" from active_. Prevent StartAbort().
+    DeregisterCall(call);
+    // If StartAbort was called prior to DeregisterCall, then the
+    // current status should be bad.
+    Status s = call->status();
+    worker_cache->ReleaseWorker(src_worker, rwi);
+    if (s.ok() && call->staged_on_host() && !call->is_dead()) {
+      CopyStagedTensorToDevice(
+          call->tensor(), call->dst_device(), call->recv_args(),
+          [this, call, done](const Status& s, const Tensor& tensor) {
+            done(s, Args(), call->recv_args(), tensor, /*is_dead=*/false);
+            delete call;
+            Unref();
+          });
+      return;
+    }
+    done(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
+    delete call;
+    Unref();
+  });
+}
+
+}  // namespace
+
+RdmaRendezvousMgr::RdmaRendezvousMgr(const WorkerEnv* env,
+                                     RemoteMemoryManager* remote_memory_manager)
+    : BaseRendezvousMgr(env), remote_memory_manager_(remote_memory_manager) {}
+
+BaseRemoteRendezvous* RdmaRendezvousMgr::Create(int64 step_id,
+                                                const WorkerEnv* worker_env) {
+  return new RdmaRemoteRendezvous(worker_env, step_id, remote_memory_manager_);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,219 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/rdma/rdma_rendezvous_mgr.h"
+
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/test_utils.h"
+#include "tensorflow/core/distributed_runtime/worker_session.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr uint32 kTensorKey = 7;
+
+// Reads the "remote" buffer by filling the tensor with its tensor key.
+class FakeRemoteMemoryManager : public RemoteMemoryManager {
+ public:
+  Status Init() override { return Status::OK(); }
+  void Run() override {}
+  void Stop() override {}
+
+  Status TransportOptionsFromTensor(
+      ::google::protobuf::Any* mutable_transport_options, const Tensor& tensor,
+      int64 step_id) override {
+    return errors::Unimplemented("TransportOptionsFromTensor");
+  }
+  void ReleaseStep(int64 step_id) override {}
+  void ReleaseAll() override {}
+
+  void TensorFromTransportOptions(
+      Tensor* tensor, const ::google::protobuf::Any& transport_options,
+      StatusCallback done) override {
+    ++num_reads;
+    RemoteMemoryRegion region;
+    if (!transport_options.UnpackTo(&region)) {
+      done(errors::Internal("Not a RemoteMemoryRegion"));
+      return;
+    }
+    if (!read_status.ok()) {
+      done(read_status);
+      return;
+    }
+    tensor->flat<float>().setConstant(region.tensor_key());
+    done(Status::OK());
+  }
+
+  int num_reads = 0;
+  Status read_status;
+};
+
+// Answers RecvTensor requests either with the tensor in the response, like a
+// worker without RDMA support, or with the location of its buffer.
+class FakeWorker : public TestWorkerInterface {
+ public:
+  void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                       TensorResponse* response, StatusCallback done) override {
+    asked_for_remote_memory =
+        request->transport_options().Is<RemoteMemoryRegion>();
+    RecvTensorResponse proto;
+    Tensor val = test::AsTensor<float>({1.0f, 2.0f, 3.0f});
+    if (supports_rdma) {
+      proto.mutable_tensor()->set_dtype(val.dtype());
+      val.shape().AsProto(proto.mutable_tensor()->mutable_tensor_shape());
+      RemoteMemoryRegion region;
+      region.set_tensor_key(kTensorKey);
+      proto.mutable_transport_options()->PackFrom(region);
+    } else {
+      val.AsProtoTensorContent(proto.mutable_tensor());
+    }
+    Status s = response->InitFrom(&proto);
+    SchedClosure([s, done = std::move(done)]() { done(s); });
+  }
+
+  bool supports_rdma = false;
+  bool asked_for_remote_memory = false;
+};
+
+class FakeWorkerCache : public WorkerCacheInterface {
+ public:
+  void ListWorkers(std::vector<string>* workers) const override {}
+  void ListWorkersInJob(const string& job_name,
+                        std::vector<string>* workers) const override {}
+  WorkerInterface* GetOrCreateWorker(const string& target) override {
+    return &worker_;
+  }
+  // The worker is owned by the cache.
+  void ReleaseWorker(const string& target, WorkerInterface* worker) override {}
+  Status GetEagerClientCache(
+      std::unique_ptr<eager::EagerClientCache>* eager_client_cache) override {
+    return errors::Unimplemented("Unimplemented.");
+  }
+  Status GetCoordinationClientCache(
+      std::unique_ptr<CoordinationClientCache>* coord_client_cache) override {
+    return errors::Unimplemented("Unimplemented.");
+  }
+  bool GetDeviceLocalityNonBlocking(const string& device,
+                                    DeviceLocality* locality) override {
+    return false;
+  }
+  void GetDeviceLocalityAsync(const string& device, DeviceLocality* locality,
+                              StatusCallback done) override {}
+
+  FakeWorker* worker() { return &worker_; }
+
+ private:
+  FakeWorker worker_;
+};
+
+Device* CreateCpuDevice(const char* name) {
+  class FakeDevice : public Device {
+   public:
+    explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
+    Status Sync() override { return Status::OK(); }
+    Allocator* GetAllocator(AllocatorAttributes) override {
+      return cpu_allocator();
+    }
+  };
+  DeviceAttributes attr;
+  attr.set_name(name);
+  attr.set_device_type(DEVICE_CPU);
+  return new FakeDevice(attr);
+}
+
+DeviceMgr* CreateDeviceMgr() {
+  std::vector<std::unique_ptr<Device>> devices;
+  devices.emplace_back(CreateCpuDevice("/job:mnist/replica:1/task:2/cpu:1"));
+  return new StaticDeviceMgr(std::move(devices));
+}
+
+Rendezvous::ParsedKey RemoteKey() {
+  Rendezvous::ParsedKey key;
+  TF_CHECK_OK(Rendezvous::ParseKey(
+      Rendezvous::CreateKey("/job:worker/replica:1/task:2/cpu:0", 7890,
+                            "/job:mnist/replica:1/task:2/cpu:1", "foo",
+                            FrameAndIter(0, 0)),
+      &key));
+  return key;
+}
+
+class RdmaRendezvousMgrTest : public ::testing::Test {
+ protected:
+  RdmaRendezvousMgrTest()
+      : cache_(new FakeWorkerCache),
+        worker_session_("rdma_session", "/job:mnist/replica:1/task:2",
+                        std::unique_ptr<WorkerCacheInterface>(cache_),
+                        std::unique_ptr<DeviceMgr>(CreateDeviceMgr()),
+                        std::unique_ptr<GraphMgr>(), nullptr),
+        rmgr_(&env_, &remote_memory_manager_) {
+    env_.env = Env::Default();
+  }
+
+  // Receives the tensor of RemoteKey() in step `step_id`.
+  Status RecvRemote(int64 step_id, Tensor* val) {
+    RemoteRendezvous* rendez = rmgr_.Find(step_id);
+    core::ScopedUnref unref(rendez);
+    TF_RETURN_IF_ERROR(rendez->Initialize(&worker_session_));
+    bool is_dead = false;
+    Status s = rendez->Recv(RemoteKey(), Rendezvous::Args(), val, &is_dead);
+    EXPECT_FALSE(is_dead);
+    rmgr_.Cleanup(step_id);
+    return s;
+  }
+
+  FakeWorkerCache* cache_;  // Owned by worker_session_.
+  WorkerEnv env_;
+  WorkerSession worker_session_;
+  FakeRemoteMemoryManager remote_memory_manager_;
+  RdmaRendezvousMgr rmgr_;
+};
+
+TEST_F(RdmaRendezvousMgrTest, FallsBackToTensorInResponse) {
+  Tensor val;
+  TF_ASSERT_OK(RecvRemote(/*step_id=*/123, &val));
+  EXPECT_TRUE(cache_->worker()->asked_for_remote_memory);
+  EXPECT_EQ(remote_memory_manager_.num_reads, 0);
+  test::ExpectTensorEqual<float>(val,
+                                 test::AsTensor<float>({1.0f, 2.0f, 3.0f}));
+}
+
+TEST_F(RdmaRendezvousMgrTest, ReadsRemoteMemory) {
+  cache_->worker()->supports_rdma = true;
+  Tensor val;
+  TF_ASSERT_OK(RecvRemote(/*step_id=*/123, &val));
+  EXPECT_EQ(remote_memory_manager_.num_reads, 1);
+  const float expected = kTensorKey;
+  test::ExpectTensorEqual<float>(
+      val, test::AsTensor<float>({expected, expected, expected}));
+}
+
+TEST_F(RdmaRendezvousMgrTest, ReadFailure) {
+  cache_->worker()->supports_rdma = true;
+  remote_memory_manager_.read_status = errors::Unavailable("read failed");
+  Tensor val;
+  EXPECT_TRUE(errors::IsUnavailable(RecvRemote(/*step_id=*/123, &val)));
+  EXPECT_EQ(remote_memory_manager_.num_reads, 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
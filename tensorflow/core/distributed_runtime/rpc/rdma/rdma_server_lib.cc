@@ -0,0 +1,120 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/rdma/rdma_server_lib.h"
+
+#include "tensorflow/core/distributed_runtime/rpc/rdma/rdma_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/rpc/rdma/rdma_worker.h"
+#include "tensorflow/core/distributed_runtime/server_lib.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+RdmaServer::RdmaServer(const ServerDef& server_def, Env* env)
+    : GrpcServer(server_def, env), env_(env) {}
+
+RdmaServer::~RdmaServer() {
+  if (remote_memory_manager_ != nullptr) {
+    remote_memory_manager_->Stop();
+  }
+  mutex_lock l(mu_);
+  remote_memory_manager_thread_.reset();
+}
+
+Status RdmaServer::Init() {
+  string host;
+  int port;
+  TF_RETURN_IF_ERROR(GetHostAndPort(server_def(), &host, &port));
+  remote_memory_manager_.reset(
+      CreateRemoteMemoryManager(host, strings::StrCat(port)));
+  // Registers the allocator visitors before the devices are created.
+  TF_RETURN_IF_ERROR(remote_memory_manager_->Init());
+
+  GrpcServerOptions opts;
+  opts.rendezvous_mgr_func = [this](const WorkerEnv* env) {
+    return new RdmaRendezvousMgr(env, remote_memory_manager_.get());
+  };
+  opts.worker_func = [this](WorkerEnv* env, const ConfigProto& config) {
+    return std::unique_ptr<GrpcWorker>(
+        new RdmaWorker(env, config, remote_memory_manager_.get()));
+  };
+  return GrpcServer::Init(opts);
+}
+
+Status RdmaServer::Start() {
+  {
+    mutex_lock l(mu_);
+    if (remote_memory_manager_thread_ == nullptr) {
+      remote_memory_manager_thread_.reset(
+          env_->StartThread(ThreadOptions(), "TF_rdma_memory_manager",
+                            [this] { remote_memory_manager_->Run(); }));
+    }
+  }
+  return GrpcServer::Start();
+}
+
+Status RdmaServer::Stop() {
+  TF_RETURN_IF_ERROR(GrpcServer::Stop());
+  remote_memory_manager_->Stop();
+  return Status::OK();
+}
+
+Status RdmaServer::Join() {
+  TF_RETURN_IF_ERROR(GrpcServer::Join());
+  mutex_lock l(mu_);
+  remote_memory_manager_thread_.reset();
+  return Status::OK();
+}
+
+/* static */
+Status RdmaServer::Create(const ServerDef& server_def, Env* env,
+                          std::unique_ptr<ServerInterface>* out_server) {
+  std::unique_ptr<RdmaServer> ret(
+      new RdmaServer(server_def, env == nullptr ? Env::Default() : env));
+  Status s = ret->Init();
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return s;
+  }
+  *out_server = std::move(ret);
+  return Status::OK();
+}
+
+namespace {
+
+class RdmaServerFactory : public ServerFactory {
+ public:
+  bool AcceptsOptions(const ServerDef& server_def) override {
+    return server_def.protocol() == "grpc+rdma";
+  }
+
+  Status NewServer(const ServerDef& server_def, const Options& options,
+                   std::unique_ptr<ServerInterface>* out_server) override {
+    return RdmaServer::Create(server_def, Env::Default(), out_server);
+  }
+};
+
+// Registers a `ServerFactory` for `RdmaServer` instances.
+class RdmaServerRegistrar {
+ public:
+  RdmaServerRegistrar() {
+    ServerFactory::Register("RDMA_SERVER", new RdmaServerFactory());
+  }
+};
+static RdmaServerRegistrar registrar;
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,62 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RDMA_RDMA_SERVER_LIB_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RDMA_RDMA_SERVER_LIB_H_
+
+#include <memory>
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_server_lib.h"
+#include "tensorflow/core/distributed_runtime/rpc/rdma/rdma_memory_manager.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A GrpcServer whose workers read the contents of remote tensors with
+// one-sided RDMA reads.  All control messages, and the RecvTensor calls that
+// locate the tensors, still go over gRPC.
+//
+// Servers of this kind are created for the "grpc+rdma" protocol.  The RDMA
+// connection manager listens on the same host and port as the gRPC server.
+class RdmaServer : public GrpcServer {
+ protected:
+  RdmaServer(const ServerDef& server_def, Env* env);
+
+ public:
+  static Status Create(const ServerDef& server_def, Env* env,
+                       std::unique_ptr<ServerInterface>* out_server);
+
+  ~RdmaServer() override;
+
+  Status Start() override;
+  Status Stop() override;
+  Status Join() override;
+
+ protected:
+  Status Init();
+
+ private:
+  Env* const env_;
+  std::unique_ptr<RemoteMemoryManager> remote_memory_manager_;
+
+  mutex mu_;
+  std::unique_ptr<Thread> remote_memory_manager_thread_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RDMA_RDMA_SERVER_LIB_H_
@@ -0,0 +1,139 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/rdma/rdma_worker.h"
+
+#include "tensorflow/core/common_runtime/copy_tensor.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+RdmaWorker::RdmaWorker(WorkerEnv* env, const ConfigProto& config,
+                       RemoteMemoryManager* remote_memory_manager)
+    : GrpcWorker(env, config), remote_memory_manager_(remote_memory_manager) {}
+
+void RdmaWorker::GrpcRecvTensorAsync(CallOptions* opts,
+                                     const RecvTensorRequest* request,
+                                     ::grpc::ByteBuffer* response,
+                                     StatusCallback done) {
+  // Clients that cannot read over RDMA get the tensor in the response.
+  if (!request->transport_options().Is<RemoteMemoryRegion>()) {
+    GrpcWorker::GrpcRecvTensorAsync(opts, request, response, std::move(done));
+    return;
+  }
+  const int64 step_id = request->step_id();
+  const string& key = request->rendezvous_key();
+  TRACEPRINTF("RecvTensor: %lld %s", step_id, key.c_str());
+  Rendezvous::ParsedKey parsed;
+  Status s = Rendezvous::ParseKey(key, &parsed);
+  Device* src_dev = nullptr;
+  if (s.ok()) {
+    s = PrepareRecvTensor(parsed, &src_dev);
+  }
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+
+  // Like GrpcWorker, logs the cancellation but does not abort the step.
+  opts->SetCancelCallback(
+      [step_id]() { LOG(WARNING) << "RecvTensor cancelled for " << step_id; });
+  env_->rendezvous_mgr->RecvLocalAsync(
+      step_id, parsed,
+      [this, opts, response, done, src_dev, key, step_id](
+          const Status& status, const Rendezvous::Args& send_args,
+          const Rendezvous::Args& recv_args, const Tensor& val,
+          const bool is_dead) {
+        opts->ClearCancelCallback();
+        if (!status.ok()) {
+          done(status);
+          return;
+        }
+        // Dead, empty, and non memcpy-able tensors are sent in the response.
+        if (is_dead || val.TotalBytes() == 0 ||
+            !DataTypeCanUseMemcpy(val.dtype())) {
+          grpc::EncodeTensorToByteBuffer(is_dead, val, /*require_ack=*/false,
+                                         response);
+          done(Status::OK());
+          return;
+        }
+        const bool on_host = send_args.alloc_attrs.on_host();
+        if (src_dev->tensorflow_gpu_device_info() != nullptr && !on_host) {
+          // The buffer is read from pinned host memory.
+          AllocatorAttributes alloc_attrs;
+          alloc_attrs.set_gpu_compatible(true);
+          alloc_attrs.set_on_host(true);
+          Allocator* alloc = src_dev->GetAllocator(alloc_attrs);
+          Tensor* copy = new Tensor(alloc, val.dtype(), val.shape());
+          CopyDeviceToHost(&val, alloc, alloc, key, src_dev, copy,
+                           send_args.device_context,
+                           [this, copy, step_id, response,
+                            done](const Status& s) {
+                             if (s.ok()) {
+                               RespondWithRemoteMemory(*copy, step_id,
+                                                       response, done);
+                             } else {
+                               done(s);
+                             }
+                             delete copy;
+                           });
+          return;
+        }
+        RespondWithRemoteMemory(val, step_id, response, done);
+      });
+}
+
+void RdmaWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
+                                   CleanupGraphResponse* response,
+                                   StatusCallback done) {
+  remote_memory_manager_->ReleaseStep(request->step_id());
+  GrpcWorker::CleanupGraphAsync(request, response, std::move(done));
+}
+
+void RdmaWorker::CleanupAllAsync(const CleanupAllRequest* request,
+                                 CleanupAllResponse* response,
+                                 StatusCallback done) {
+  remote_memory_manager_->ReleaseAll();
+  GrpcWorker::CleanupAllAsync(request, response, std::move(done));
+}
+
+void RdmaWorker::RespondWithRemoteMemory(const Tensor& val, int64 step_id,
+                                         ::grpc::ByteBuffer* response,
+                                         StatusCallback done) {
+  RecvTensorResponse proto;
+  proto.mutable_tensor()->set_dtype(val.dtype());
+  val.shape().AsProto(proto.mutable_tensor()->mutable_tensor_shape());
+  Status s = remote_memory_manager_->TransportOptionsFromTensor(
+      proto.mutable_transport_options(), val, step_id);
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+  proto.set_send_start_micros(env_->env->NowMicros());
+  grpc::EncodeRecvTensorResponseToByteBuffer(proto, response);
+  done(Status::OK());
+}
+
+}  // namespace tensorflow
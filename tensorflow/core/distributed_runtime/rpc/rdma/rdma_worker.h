@@ -0,0 +1,56 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RDMA_RDMA_WORKER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RDMA_RDMA_WORKER_H_
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
+#include "tensorflow/core/distributed_runtime/rpc/rdma/rdma_memory_manager.h"
+
+namespace tensorflow {
+
+// A GrpcWorker that answers RecvTensor requests from RDMA capable clients
+// with the location of the tensor buffer, for the client to read it with an
+// RDMA read.  Other requests are handled like GrpcWorker does.
+class RdmaWorker : public GrpcWorker {
+ public:
+  RdmaWorker(WorkerEnv* env, const ConfigProto& config,
+             RemoteMemoryManager* remote_memory_manager);
+
+  void GrpcRecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                           ::grpc::ByteBuffer* response,
+                           StatusCallback done) override;
+
+  // Also release the buffers that receivers did not release.
+  void CleanupGraphAsync(const CleanupGraphRequest* request,
+                         CleanupGraphResponse* response,
+                         StatusCallback done) override;
+  void CleanupAllAsync(const CleanupAllRequest* request,
+                       CleanupAllResponse* response,
+                       StatusCallback done) override;
+
+ private:
+  // Encodes the metadata of host tensor `val` of step `step_id` into
+  // `response`, with transport options that describe its buffer.
+  void RespondWithRemoteMemory(const Tensor& val, int64 step_id,
+                               ::grpc::ByteBuffer* response,
+                               StatusCallback done);
+
+  RemoteMemoryManager* const remote_memory_manager_;  // Not owned.
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RDMA_RDMA_WORKER_H_
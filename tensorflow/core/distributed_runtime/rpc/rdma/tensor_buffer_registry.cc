@@ -0,0 +1,92 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/rdma/tensor_buffer_registry.h"
+
+#include <utility>
+#include <vector>
+
+namespace tensorflow {
+
+namespace {
+
+// Runs the release callbacks of `buffers`, and returns their number.
+template <typename Buffers>
+int RunReleaseCallbacks(Buffers* buffers) {
+  const int num_released = buffers->size();
+  for (auto& buffer : *buffers) {
+    if (buffer.on_release) buffer.on_release();
+  }
+  // Unreferences the tensors only after all callbacks ran.
+  buffers->clear();
+  return num_released;
+}
+
+}  // namespace
+
+uint32 TensorBufferRegistry::Register(int64 step_id, const Tensor& tensor,
+                                      ReleaseCallback on_release) {
+  mutex_lock l(mu_);
+  const uint32 key = next_key_++;
+  buffers_.emplace(key, Buffer{step_id, tensor, std::move(on_release)});
+  return key;
+}
+
+bool TensorBufferRegistry::Release(uint32 key) {
+  std::vector<Buffer> released;
+  {
+    mutex_lock l(mu_);
+    auto it = buffers_.find(key);
+    if (it == buffers_.end()) return false;
+    released.push_back(std::move(it->second));
+    buffers_.erase(it);
+  }
+  RunReleaseCallbacks(&released);
+  return true;
+}
+
+int TensorBufferRegistry::ReleaseStep(int64 step_id) {
+  std::vector<Buffer> released;
+  {
+    mutex_lock l(mu_);
+    for (auto it = buffers_.begin(); it != buffers_.end();) {
+      if (it->second.step_id == step_id) {
+        released.push_back(std::move(it->second));
+        it = buffers_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  return RunReleaseCallbacks(&released);
+}
+
+int TensorBufferRegistry::ReleaseAll() {
+  std::vector<Buffer> released;
+  {
+    mutex_lock l(mu_);
+    released.reserve(buffers_.size());
+    for (auto& it : buffers_) released.push_back(std::move(it.second));
+    buffers_.clear();
+  }
+  return RunReleaseCallbacks(&released);
+}
+
+size_t TensorBufferRegistry::size() const {
+  mutex_lock l(mu_);
+  return buffers_.size();
+}
+
+}  // namespace tensorflow
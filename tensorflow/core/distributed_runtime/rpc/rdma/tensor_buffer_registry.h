@@ -0,0 +1,77 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RDMA_TENSOR_BUFFER_REGISTRY_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RDMA_TENSOR_BUFFER_REGISTRY_H_
+
+#include <functional>
+#include <unordered_map>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Keeps the buffers of tensors alive while remote workers read them.
+//
+// A buffer is normally released by its reader once the read has completed.
+// Buffers whose reader never gets to release them, e.g. because the
+// RecvTensor response was lost, are released when their step is cleaned up.
+class TensorBufferRegistry {
+ public:
+  // Called when a buffer is released, before the tensor is unreferenced.
+  using ReleaseCallback = std::function<void()>;
+
+  TensorBufferRegistry() {}
+  ~TensorBufferRegistry() { ReleaseAll(); }
+
+  // Keeps the buffer of `tensor` alive until it is released, and returns the
+  // key that releases it.  `on_release` may be empty.
+  uint32 Register(int64 step_id, const Tensor& tensor,
+                  ReleaseCallback on_release);
+
+  // Releases the buffer registered with `key`.  Returns false if there is no
+  // such buffer, e.g. because its step was already cleaned up.
+  bool Release(uint32 key);
+
+  // Releases the buffers registered for `step_id`, and returns their number.
+  int ReleaseStep(int64 step_id);
+
+  // Releases all buffers, and returns their number.
+  int ReleaseAll();
+
+  // The number of buffers not released yet.
+  size_t size() const;
+
+ private:
+  struct Buffer {
+    int64 step_id;
+    Tensor tensor;
+    ReleaseCallback on_release;
+  };
+
+  mutable mutex mu_;
+  uint32 next_key_ TF_GUARDED_BY(mu_) = 0;
+  std::unordered_map<uint32, Buffer> buffers_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(TensorBufferRegistry);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RDMA_TENSOR_BUFFER_REGISTRY_H_
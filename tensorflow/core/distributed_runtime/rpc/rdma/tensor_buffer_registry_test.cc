@@ -0,0 +1,115 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/rdma/tensor_buffer_registry.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(TensorBufferRegistryTest, ReleaseByKey) {
+  TensorBufferRegistry registry;
+  Tensor t = test::AsTensor<float>({1.0f, 2.0f});
+  int num_released = 0;
+  const uint32 key =
+      registry.Register(/*step_id=*/1, t, [&]() { ++num_released; });
+  // The registry holds a reference to the buffer.
+  EXPECT_FALSE(t.RefCountIsOne());
+  EXPECT_EQ(registry.size(), 1);
+
+  EXPECT_TRUE(registry.Release(key));
+  EXPECT_EQ(num_released, 1);
+  EXPECT_TRUE(t.RefCountIsOne());
+  EXPECT_EQ(registry.size(), 0);
+
+  // A buffer is released once.
+  EXPECT_FALSE(registry.Release(key));
+  EXPECT_EQ(num_released, 1);
+}
+
+TEST(TensorBufferRegistryTest, KeysAreUnique) {
+  TensorBufferRegistry registry;
+  Tensor t = test::AsTensor<float>({1.0f});
+  const uint32 key0 = registry.Register(/*step_id=*/1, t, nullptr);
+  const uint32 key1 = registry.Register(/*step_id=*/1, t, nullptr);
+  EXPECT_NE(key0, key1);
+  EXPECT_TRUE(registry.Release(key0));
+  EXPECT_EQ(registry.size(), 1);
+  EXPECT_TRUE(registry.Release(key1));
+}
+
+TEST(TensorBufferRegistryTest, ReleaseStep) {
+  TensorBufferRegistry registry;
+  Tensor t1 = test::AsTensor<float>({1.0f});
+  Tensor t2 = test::AsTensor<float>({2.0f});
+  int num_released = 0;
+  auto on_release = [&]() { ++num_released; };
+  const uint32 key1 = registry.Register(/*step_id=*/1, t1, on_release);
+  registry.Register(/*step_id=*/1, t1, on_release);
+  const uint32 key2 = registry.Register(/*step_id=*/2, t2, on_release);
+
+  EXPECT_EQ(registry.ReleaseStep(1), 2);
+  EXPECT_EQ(num_released, 2);
+  EXPECT_TRUE(t1.RefCountIsOne());
+  EXPECT_FALSE(t2.RefCountIsOne());
+  // A receiver that releases its buffer after the step was cleaned up finds
+  // nothing to release.
+  EXPECT_FALSE(registry.Release(key1));
+
+  EXPECT_EQ(registry.ReleaseStep(1), 0);
+  EXPECT_EQ(registry.ReleaseStep(3), 0);
+  EXPECT_TRUE(registry.Release(key2));
+  EXPECT_EQ(num_released, 3);
+}
+
+TEST(TensorBufferRegistryTest, ReleaseAll) {
+  TensorBufferRegistry registry;
+  Tensor t = test::AsTensor<float>({1.0f});
+  int num_released = 0;
+  for (int step_id = 0; step_id < 10; ++step_id) {
+    registry.Register(step_id, t, [&]() { ++num_released; });
+  }
+  EXPECT_EQ(registry.ReleaseAll(), 10);
+  EXPECT_EQ(num_released, 10);
+  EXPECT_TRUE(t.RefCountIsOne());
+  EXPECT_EQ(registry.size(), 0);
+}
+
+TEST(TensorBufferRegistryTest, ReleasesOnDestruction) {
+  Tensor t = test::AsTensor<float>({1.0f});
+  int num_released = 0;
+  {
+    TensorBufferRegistry registry;
+    registry.Register(/*step_id=*/1, t, [&]() { ++num_released; });
+  }
+  EXPECT_EQ(num_released, 1);
+  EXPECT_TRUE(t.RefCountIsOne());
+}
+
+TEST(TensorBufferRegistryTest, CallbackRunsBeforeUnref) {
+  TensorBufferRegistry registry;
+  Tensor t = test::AsTensor<float>({1.0f});
+  bool referenced_in_callback = false;
+  const uint32 key = registry.Register(/*step_id=*/1, t, [&]() {
+    referenced_in_callback = !t.RefCountIsOne();
+  });
+  EXPECT_TRUE(registry.Release(key));
+  EXPECT_TRUE(referenced_in_callback);
+}
+
+}  // namespace
+}  // namespace tensorflow
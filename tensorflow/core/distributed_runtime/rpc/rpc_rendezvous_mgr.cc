@@ -25,6 +25,8 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -80,6 +82,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
     alloc_attrs_ = AllocatorAttributes();
     dst_device_ = nullptr;
+    staged_on_host_ = false;
     // We don't clear opts_ and assume that Init will set up the state for
     // opts_ appropriately.
     req_.Clear();
@@ -127,6 +130,10 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
   bool is_dead() const { return resp_.metadata().is_dead(); }
 
+  // Whether `tensor()` is in pinned host memory and still has to be copied to
+  // `dst_device()`.
+  bool staged_on_host() const { return staged_on_host_; }
+
   Device* dst_device() const { return dst_device_; }
   const Rendezvous::Args& recv_args() const { return recv_args_; }
   const Rendezvous::DoneCallback& done() const { return done_; }
@@ -136,7 +143,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
   // Start the main RecvTensor call, checking for an async abort.
   void StartRTCall(std::function<void()> recv_done) {
-    resp_.InitAlloc(dst_device_, alloc_attrs_);
+    resp_.InitAlloc(dst_device_, ResponseAllocAttrs());
     auto abort_checked = std::make_shared<Notification>();
     auto cb = [this, abort_checked,
                recv_done = std::move(recv_done)](const Status& s) {
@@ -168,10 +175,31 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     abort_checked->Notify();
   }
 
+  // Returns the attributes of the memory that the response is decoded into.
+  //
+  // Tensors for GPU memory are decoded into pinned host memory, and copied to
+  // the device from there. Otherwise the response would be parsed into a
+  // TensorProto first, and converted into a host tensor again by the device.
+  // The pinned memory comes from the device's host allocator, which reuses it
+  // across steps.
+  AllocatorAttributes ResponseAllocAttrs() {
+    staged_on_host_ = !alloc_attrs_.on_host() &&
+                      dst_device_->device_type() != DEVICE_CPU &&
+                      dst_device_->tensorflow_gpu_device_info() != nullptr;
+    if (!staged_on_host_) {
+      return alloc_attrs_;
+    }
+    AllocatorAttributes host_attrs;
+    host_attrs.set_on_host(true);
+    host_attrs.set_gpu_compatible(true);
+    return host_attrs;
+  }
+
   string src_worker_;
   string src_rel_device_;
   WorkerInterface* wi_;  // Not owned.
   AllocatorAttributes alloc_attrs_;
+  bool staged_on_host_ = false;
   Device* dst_device_;
   CallOptions opts_;
   RecvTensorRequest req_;
@@ -230,6 +258,39 @@ static RpcRecvTensorFreeList* get_call_freelist() {
   return call_freelist;
 }
 
+// Copies `host_tensor`, which was received into pinned host memory, to the
+// memory of `dst_device` described by `recv_args`.
+void CopyStagedTensorToDevice(
+    const Tensor& host_tensor, Device* dst_device,
+    const Rendezvous::Args& recv_args,
+    std::function<void(const Status&, const Tensor&)> done) {
+  if (!DataTypeCanUseMemcpy(host_tensor.dtype())) {
+    // Types like variants are converted by the device itself.
+    TensorProto proto;
+    host_tensor.AsProtoField(&proto);
+    Tensor device_tensor;
+    Status s = dst_device->MakeTensorFromProto(proto, recv_args.alloc_attrs,
+                                               &device_tensor);
+    done(s, device_tensor);
+    return;
+  }
+  DeviceContext* device_context = recv_args.device_context;
+  if (device_context == nullptr) {
+    device_context = dst_device->tensorflow_gpu_device_info()->default_context;
+  }
+  auto* source = new Tensor(host_tensor);
+  auto* device_tensor =
+      new Tensor(dst_device->GetAllocator(recv_args.alloc_attrs),
+                 host_tensor.dtype(), host_tensor.shape());
+  device_context->CopyCPUTensorToDevice(
+      source, dst_device, device_tensor,
+      [source, device_tensor, done = std::move(done)](const Status& s) {
+        done(s, *device_tensor);
+        delete source;
+        delete device_tensor;
+      });
+}
+
 void RpcRemoteRendezvous::RecvFromRemoteAsync(
     const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
     DoneCallback done) {
@@ -299,6 +360,17 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     // `call->done()(...)`, so we must release the worker before calling the
     // callback.
     call->ReleaseWorker(session()->worker_cache());
+    if (s.ok() && call->staged_on_host() && !call->is_dead()) {
+      CopyStagedTensorToDevice(
+          call->tensor(), call->dst_device(), call->recv_args(),
+          [this, call](const Status& s, const Tensor& tensor) {
+            call->done()(s, Args(), call->recv_args(), tensor,
+                         /*is_dead=*/false);
+            get_call_freelist()->Release(call);
+            Unref();
+          });
+      return;
+    }
     call->done()(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
     get_call_freelist()->Release(call);
     Unref();
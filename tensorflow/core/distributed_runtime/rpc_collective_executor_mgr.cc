@@ -55,6 +55,24 @@ CollectiveExecutor* RpcCollectiveExecutorMgr::Create(int64 step_id) {
   return new BaseCollectiveExecutor(this, rma, step_id, dev_mgr_, work_queue_);
 }
 
+void RpcCollectiveExecutorMgr::InheritResolvedState(
+    RpcCollectiveExecutorMgr* other) {
+  // Both resolvers are always created as the distributed implementations.
+  static_cast<DeviceResolverDistributed*>(dev_resolver_.get())
+      ->InheritAttributes(
+          static_cast<DeviceResolverDistributed*>(other->dev_resolver_.get()));
+  static_cast<CollectiveParamResolverDistributed*>(param_resolver_.get())
+      ->InheritGroups(static_cast<CollectiveParamResolverDistributed*>(
+          other->param_resolver_.get()));
+}
+
+void RpcCollectiveExecutorMgr::RemoveTasks(const std::vector<string>& tasks) {
+  static_cast<DeviceResolverDistributed*>(dev_resolver_.get())
+      ->RemoveTasks(tasks);
+  static_cast<CollectiveParamResolverDistributed*>(param_resolver_.get())
+      ->RemoveTasks(tasks);
+}
+
 namespace {
 // StepId must leave the most-significant 7 bits empty for future use.
 static const int64 kStepIdMask = (((1uLL << 56) - 1) | (1uLL << 56));
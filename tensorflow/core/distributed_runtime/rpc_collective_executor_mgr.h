@@ -56,6 +56,15 @@ class RpcCollectiveExecutorMgr : public CollectiveExecutorMgr {
 
   void RetireStepId(int64 graph_key, int64 step_id) override;
 
+  // Copies the device attributes and completed collective groups cached by
+  // `other`, typically the manager that this one replaces after a cluster
+  // update, so that they need not be resolved again.
+  void InheritResolvedState(RpcCollectiveExecutorMgr* other);
+
+  // Drops the cached device attributes of `tasks` and the cached collective
+  // groups that have a member on any of them.
+  void RemoveTasks(const std::vector<string>& tasks);
+
  protected:
   virtual CollectiveExecutor* Create(int64 step_id) override;
 
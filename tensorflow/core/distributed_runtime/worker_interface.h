@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/message_wrappers.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
@@ -106,6 +107,15 @@ class WorkerInterface {
                                TensorResponse* response,
                                StatusCallback done) = 0;
 
+  // Receives several tensors from this worker with a single call.  Returns
+  // Unimplemented unless the worker supports it.
+  virtual void RecvTensorBatchAsync(CallOptions* opts,
+                                    const RecvTensorBatchRequest* request,
+                                    RecvTensorBatchResponse* response,
+                                    StatusCallback done) {
+    done(errors::Unimplemented("RecvTensorBatchAsync"));
+  }
+
   virtual void LoggingAsync(const LoggingRequest* request,
                             LoggingResponse* response, StatusCallback done) = 0;
 
@@ -163,6 +163,12 @@ struct AllocatorStats {
   absl::optional<int64> bytes_reservable_limit;
 
   int64 largest_free_block_bytes;  // Largest free block's size in heap.
+  int64 heap_bytes;                // Size of the heap, in use or free.
+
+  // Stats for allocators that keep a cache of freed allocations in front of
+  // their main heap. Zero if the allocator has no such cache.
+  int64 cache_hits;    // Allocations served from the cache.
+  int64 cache_misses;  // Cacheable allocations served from the main heap.
 
   AllocatorStats()
       : num_allocs(0),
@@ -171,7 +177,10 @@ struct AllocatorStats {
         largest_alloc_size(0),
         bytes_reserved(0),
         peak_bytes_reserved(0),
-        largest_free_block_bytes(0) {}
+        largest_free_block_bytes(0),
+        heap_bytes(0),
+        cache_hits(0),
+        cache_misses(0) {}
 
   std::string DebugString() const;
 };
@@ -458,6 +467,17 @@ class SubAllocator {
   // returned by this allocator.
   virtual bool SupportsCoalescing() const = 0;
 
+  // Releases the physical memory behind the pages lying entirely within
+  // [ptr, ptr + num_bytes), which is part of memory returned by Alloc(), while
+  // keeping the addresses reserved. The range must not be accessed until
+  // RestorePhysical() is called on it. Returns the number of bytes released.
+  // Only allocators backed by virtual memory can release memory this way.
+  virtual size_t ReleasePhysical(void* ptr, size_t num_bytes) { return 0; }
+
+  // Backs the released pages within [ptr, ptr + num_bytes) with physical
+  // memory again. Returns false if there isn't enough physical memory.
+  virtual bool RestorePhysical(void* ptr, size_t num_bytes) { return true; }
+
  protected:
   // Implementation of Alloc() method must call this on newly allocated
   // value.
@@ -150,6 +150,10 @@ struct CollectiveParams : public core::RefCounted {
   std::vector<int> subdiv_rank;
   OpKernel* merge_op = nullptr;  // reduction only
   OpKernel* final_op = nullptr;  // reduction only
+  // If set, reductions cast the values they transfer between devices to a
+  // narrower type with `wire_encode_op` and back with `wire_decode_op`.
+  OpKernel* wire_encode_op = nullptr;  // reduction only
+  OpKernel* wire_decode_op = nullptr;  // reduction only
   string ToString() const;
 };
 
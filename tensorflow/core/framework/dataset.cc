@@ -663,6 +663,16 @@ Status DatasetBase::InputDatasets(
                                type_string());
 }
 
+Status DatasetBase::RandomIndexingCompatible() const {
+  return errors::Unimplemented("Random access is not supported for dataset "
+                               "of type ", type_string(), ".");
+}
+
+Status DatasetBase::Get(IteratorContext* ctx, int64 index,
+                        std::vector<Tensor>* out_tensors) const {
+  return errors::Unimplemented("Get is not implemented for ", type_string());
+}
+
 Status DatasetBase::DatasetGraphDefBuilder::AddInputDataset(
     SerializationContext* ctx, const DatasetBase* dataset, Node** output) {
   Status status = dataset->AsGraphDefInternal(ctx, this, output);
@@ -795,6 +805,7 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
                              profiler::TraceMeLevel::kInfo);
   DVLOG(3) << prefix() << " GetNext enter";
   auto model = ctx->model();
+  int64 start_nanos = 0;
   if (model && model->collect_resource_usage() && node_) {
     int64 now_nanos = EnvTime::NowNanos();
     auto output = node_->output();
@@ -802,6 +813,7 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
       output->record_stop(now_nanos);
     }
     node_->record_start(now_nanos);
+    start_nanos = now_nanos;
   }
   Status s = GetNextInternal(ctx, out_tensors, end_of_sequence);
   if (TF_PREDICT_TRUE(s.ok() && !*end_of_sequence)) {
@@ -810,6 +822,9 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
   }
   if (model && model->collect_resource_usage() && node_) {
     int64 now_nanos = EnvTime::NowNanos();
+    if (start_nanos > 0 && s.ok() && !*end_of_sequence) {
+      node_->record_element_latency(now_nanos - start_nanos);
+    }
     node_->record_stop(now_nanos);
     auto output = node_->output();
     if (output) {
@@ -969,6 +969,18 @@ class DatasetBase : public core::RefCounted {
   // state. Otherwise, the method returns `Status::OK()`.
   virtual Status CheckExternalState() const = 0;
 
+  // Indicates whether the dataset supports random access through `Get`, i.e.
+  // whether it can produce any of its elements without iterating over the
+  // elements that precede it. If not, the method returns
+  // `errors::Unimplemented`. Otherwise, the method returns `Status::OK()`.
+  virtual Status RandomIndexingCompatible() const;
+
+  // Stores the element at `index` in `*out_tensors`, for datasets whose
+  // `RandomIndexingCompatible` returns `Status::OK()`. `index` must be in
+  // `[0, Cardinality())`.
+  virtual Status Get(IteratorContext* ctx, int64 index,
+                     std::vector<Tensor>* out_tensors) const;
+
   // Wrapper around a GraphDefBuilder which provides support for serializing
   // Datasets as GraphDefs.
   class DatasetGraphDefBuilder : public GraphDefBuilderWrapper {
@@ -1155,6 +1167,7 @@ class DatasetBaseIterator : public IteratorBase {
     if (node_) {
       int64 num_bytes = GetAllocatedBytes(*out_tensors);
       node_->record_element();
+      node_->record_element_bytes(num_bytes);
       node_->record_bytes_produced(num_bytes);
       if (node_->output()) {
         node_->output()->record_bytes_consumed(num_bytes);
@@ -18,6 +18,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/lib/monitoring/collection_registry.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
 
 namespace tensorflow {
@@ -39,6 +40,18 @@ auto* graph_optimization_usecs =
                                 "optimization pass in microseconds.",
                                 "kind", "name");
 
+auto* grappler_pass_nodes = monitoring::Counter<2>::New(
+    "/tensorflow/core/grappler_pass_nodes",
+    "The total number of nodes in the graphs before and after each Grappler "
+    "pass.",
+    "name", "stage");
+
+auto* grappler_skipped_passes = monitoring::Counter<1>::New(
+    "/tensorflow/core/grappler_skipped_passes",
+    "The number of times a Grappler pass was skipped on a function body that "
+    "it did not change in previous runs.",
+    "name");
+
 auto* graph_run_time_usecs_histogram = monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_time_usecs_histogram",
      "The wall-clock time spent on executing graphs in microseconds."},
@@ -118,6 +131,10 @@ auto* tf_data_iterator_lifetime_counter = monitoring::Counter<0>::New(
 auto* tf_data_optimization_counter = monitoring::Counter<1>::New(
     "/tensorflow/data/optimization", "tf.data optimization", "name");
 
+auto* tf_data_vectorization_counter = monitoring::Counter<1>::New(
+    "/tensorflow/data/vectorization",
+    "The outcome of vectorizing a tf.data map function.", "outcome");
+
 auto* tf_data_service_workers_created_counter =
     monitoring::Counter<0>::New("/tensorflow/data/service/workers_created",
                                 "Number of tf.data service workers created");
@@ -159,6 +176,12 @@ auto* build_graph_time_usecs = monitoring::Counter<0>::New(
     "spent optimizing the graph with Grappler, and time spent pruning the "
     "sub-graph.");
 
+auto* shape_inference_cache_lookups = monitoring::Counter<1>::New(
+    "/tensorflow/core/shape_inference_cache_lookups",
+    "The number of lookups in the shape inference cache, by result: 'hit' if "
+    "the output shapes of an identical node were cached, 'miss' otherwise.",
+    "result");
+
 auto* xla_compilations = monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilations",
     "The number of XLA compilations used to collect "
@@ -168,6 +191,39 @@ auto* xla_compilation_time_usecs = monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilation_time_usecs",
     "The total time spent on compiling XLA graphs in microseconds.");
 
+auto* xla_cluster_compilations = monitoring::Counter<1>::New(
+    "/tensorflow/core/xla_cluster/compilations",
+    "The number of XLA compilations of a cluster. A cluster that keeps "
+    "getting compiled sees too many different input shapes.",
+    "cluster");
+
+auto* xla_cluster_compile_time_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/xla_cluster/compile_time_usecs",
+     "The time spent compiling a cluster in microseconds.", "cluster"},
+    // Power of 2 with bucket count 30 (~18 minutes)
+    {monitoring::Buckets::Exponential(1, 2, 30)});
+
+auto* xla_cluster_cache_lookups = monitoring::Counter<2>::New(
+    "/tensorflow/core/xla_cluster/cache_lookups",
+    "The number of lookups of a cluster in the XLA compilation cache, by "
+    "result: 'hit' if an executable was available, 'miss' otherwise.",
+    "cluster", "result");
+
+auto* xla_cluster_execution_time_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/xla_cluster/execution_time_usecs",
+     "The time spent running the executable of a cluster in microseconds. On "
+     "devices that execute asynchronously, such as GPUs, this is the time to "
+     "enqueue the computation.",
+     "cluster"},
+    // Power of 2 with bucket count 30 (~18 minutes)
+    {monitoring::Buckets::Exponential(1, 2, 30)});
+
+auto* xla_cluster_transferred_bytes = monitoring::Counter<2>::New(
+    "/tensorflow/core/xla_cluster/transferred_bytes",
+    "The bytes of the tensors passed to ('input') and produced by ('output') "
+    "the executables of a cluster, including resource variables.",
+    "cluster", "direction");
+
 auto* xla_tpu_spmd_cores_per_replica = monitoring::Counter<1>::New(
     "/tensorflow/tpu/xla_spmd_cores_per_replica",
     "The number of cores used by XLA SPMD-replicated models.", "cores");
@@ -177,6 +233,44 @@ auto* bfc_allocator_delay =
                                 "The total time spent running each graph "
                                 "optimization pass in microseconds.");
 
+auto* bfc_allocator_free_chunks = monitoring::Gauge<int64, 2>::New(
+    "/tensorflow/core/bfc_allocator/free_chunks",
+    "The number of free chunks in a bin of a BFC allocator. Bins are labeled "
+    "with the smallest chunk size they hold.",
+    "allocator", "bin");
+
+auto* bfc_allocator_free_bytes = monitoring::Gauge<int64, 2>::New(
+    "/tensorflow/core/bfc_allocator/free_bytes",
+    "The bytes of the free chunks in a bin of a BFC allocator. Bins are "
+    "labeled with the smallest chunk size they hold.",
+    "allocator", "bin");
+
+auto* bfc_allocator_largest_free_chunk_bytes = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/core/bfc_allocator/largest_free_chunk_bytes",
+    "The size of the largest free chunk of a BFC allocator, i.e. the largest "
+    "allocation it can serve without growing.",
+    "allocator");
+
+auto* bfc_allocator_regions = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/core/bfc_allocator/regions",
+    "The number of memory regions a BFC allocator obtained from its "
+    "sub-allocator.",
+    "allocator");
+
+auto* bfc_allocation_lifetime_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/bfc_allocator/allocation_lifetime_usecs",
+     "The time between allocating and freeing a chunk of a BFC allocator in "
+     "microseconds.",
+     "allocator"},
+    // Power of 2 with bucket count 30 (~18 minutes)
+    {monitoring::Buckets::Exponential(1, 2, 30)});
+
+auto* gpu_host_pinned_bytes = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/core/gpu_host_allocator/pinned_bytes",
+    "The bytes of pinned host memory held by the allocator used for host "
+    "tensors that are copied to or from GPUs.",
+    "numa_node");
+
 auto* tpu_variable_distribution_time_usecs = monitoring::Counter<0>::New(
     "/tensorflow/tpu/variable_distribution_time",
     "Time spent sending variables from primary task to other worker tasks "
@@ -239,6 +333,10 @@ void RecordTFDataOptimization(const string& name, int64 num_changes) {
   tf_data_optimization_counter->GetCell(name)->IncrementBy(num_changes);
 }
 
+void RecordTFDataVectorization(const string& outcome) {
+  tf_data_vectorization_counter->GetCell(outcome)->IncrementBy(1);
+}
+
 void RecordTFDataServiceWorkerCreated() {
   tf_data_service_workers_created_counter->GetCell()->IncrementBy(1);
 }
@@ -343,6 +441,19 @@ void UpdateGrapplerPassTime(const string& pass_name,
   }
 }
 
+void UpdateGrapplerPassNodeCounts(const string& pass_name,
+                                  const int64 num_nodes_before,
+                                  const int64 num_nodes_after) {
+  grappler_pass_nodes->GetCell(pass_name, "before")
+      ->IncrementBy(num_nodes_before);
+  grappler_pass_nodes->GetCell(pass_name, "after")
+      ->IncrementBy(num_nodes_after);
+}
+
+void RecordGrapplerPassSkipped(const string& pass_name) {
+  grappler_skipped_passes->GetCell(pass_name)->IncrementBy(1);
+}
+
 void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     static auto* build_graph_calls_cell = build_graph_calls->GetCell();
@@ -360,6 +471,10 @@ void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs) {
   }
 }
 
+void RecordShapeInferenceCacheLookup(bool hit) {
+  shape_inference_cache_lookups->GetCell(hit ? "hit" : "miss")->IncrementBy(1);
+}
+
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   if (compilation_time_usecs > 0) {
     static auto* xla_compilations_cell = xla_compilations->GetCell();
@@ -370,6 +485,28 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void UpdateXlaClusterCompilation(const string& cluster,
+                                 uint64 compile_time_usecs) {
+  xla_cluster_compilations->GetCell(cluster)->IncrementBy(1);
+  xla_cluster_compile_time_usecs->GetCell(cluster)->Add(compile_time_usecs);
+}
+
+void RecordXlaClusterCacheLookup(const string& cluster, bool hit) {
+  xla_cluster_cache_lookups->GetCell(cluster, hit ? "hit" : "miss")
+      ->IncrementBy(1);
+}
+
+void RecordXlaClusterExecution(const string& cluster,
+                               uint64 execution_time_usecs, int64 input_bytes,
+                               int64 output_bytes) {
+  xla_cluster_execution_time_usecs->GetCell(cluster)->Add(
+      execution_time_usecs);
+  xla_cluster_transferred_bytes->GetCell(cluster, "input")
+      ->IncrementBy(input_bytes);
+  xla_cluster_transferred_bytes->GetCell(cluster, "output")
+      ->IncrementBy(output_bytes);
+}
+
 void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs) {
   static auto* bfc_allocator_delay_cell = bfc_allocator_delay->GetCell();
   if (delay_usecs > 0) {
@@ -377,6 +514,30 @@ void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs) {
   }
 }
 
+void UpdateBfcAllocatorBinFreeChunks(const string& allocator, int64 bin_size,
+                                     int64 num_chunks, int64 bytes) {
+  const string bin = absl::StrCat(bin_size);
+  bfc_allocator_free_chunks->GetCell(allocator, bin)->Set(num_chunks);
+  bfc_allocator_free_bytes->GetCell(allocator, bin)->Set(bytes);
+}
+
+void UpdateBfcAllocatorRegions(const string& allocator,
+                               int64 largest_free_chunk_bytes,
+                               int64 num_regions) {
+  bfc_allocator_largest_free_chunk_bytes->GetCell(allocator)->Set(
+      largest_free_chunk_bytes);
+  bfc_allocator_regions->GetCell(allocator)->Set(num_regions);
+}
+
+void RecordBfcAllocationLifetime(const string& allocator,
+                                 uint64 lifetime_usecs) {
+  bfc_allocation_lifetime_usecs->GetCell(allocator)->Add(lifetime_usecs);
+}
+
+void UpdateGpuHostPinnedBytes(int numa_node, int64 pinned_bytes) {
+  gpu_host_pinned_bytes->GetCell(absl::StrCat(numa_node))->Set(pinned_bytes);
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
@@ -86,6 +86,13 @@ void RecordTFDataIteratorLifetime(uint64 duration_us);
 // The `name` argument identifies the optimization (e.g. "noop_elimination").
 void RecordTFDataOptimization(const string& name, int64 num_changes);
 
+// Records the outcome of checking whether a tf.data map function can be
+// vectorized.
+//
+// The `outcome` argument is either "vectorized" or the reason why the function
+// was not vectorized (e.g. "unsupported_op").
+void RecordTFDataVectorization(const string& outcome);
+
 // Records that a tf.data service worker has been created.
 void RecordTFDataServiceWorkerCreated();
 
@@ -142,6 +149,17 @@ void UpdateGraphOptimizationPassTime(const string& pass_name,
                                      const uint64 running_time_usecs);
 void UpdateGrapplerPassTime(const string& pass_name,
                             const uint64 running_time_usecs);
+// Records the size of the graph before and after a Grappler pass; their
+// difference is the number of nodes the pass removed.
+void UpdateGrapplerPassNodeCounts(const string& pass_name,
+                                  const int64 num_nodes_before,
+                                  const int64 num_nodes_after);
+// Records that a Grappler pass was skipped because it was unproductive.
+void RecordGrapplerPassSkipped(const string& pass_name);
+
+// Records a lookup in the process-wide cache of shape inference results. It is
+// a hit if the output shapes of an identical node were already inferred.
+void RecordShapeInferenceCacheLookup(bool hit);
 
 // Updates metrics for time to distribute variables to all TPU hosts.
 void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
@@ -149,9 +167,43 @@ void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
+// Records a compilation of XLA cluster `cluster`.
+void UpdateXlaClusterCompilation(const string& cluster,
+                                 uint64 compile_time_usecs);
+
+// Records a lookup of XLA cluster `cluster` in the compilation cache. It is a
+// hit if an executable was already available.
+void RecordXlaClusterCacheLookup(const string& cluster, bool hit);
+
+// Records a run of the executable of XLA cluster `cluster`, and the bytes of
+// its input and output tensors.
+void RecordXlaClusterExecution(const string& cluster,
+                               uint64 execution_time_usecs, int64 input_bytes,
+                               int64 output_bytes);
+
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64 delay_usecs);
 
+// Updates the free chunks of the bin of BFC allocator `allocator` that holds
+// chunks of at least `bin_size` bytes.
+void UpdateBfcAllocatorBinFreeChunks(const string& allocator, int64 bin_size,
+                                     int64 num_chunks, int64 bytes);
+
+// Updates the largest free chunk and the number of memory regions of BFC
+// allocator `allocator`.
+void UpdateBfcAllocatorRegions(const string& allocator,
+                               int64 largest_free_chunk_bytes,
+                               int64 num_regions);
+
+// Records the time between allocating and freeing a chunk of BFC allocator
+// `allocator`.
+void RecordBfcAllocationLifetime(const string& allocator,
+                                 uint64 lifetime_usecs);
+
+// Updates the bytes of pinned host memory that the GPU host allocator of
+// `numa_node` obtained from the driver.
+void UpdateGpuHostPinnedBytes(int numa_node, int64 pinned_bytes);
+
 }  // namespace metrics
 }  // namespace tensorflow
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/model.h"
 
+#include <cmath>
+#include <limits>
 #include <memory>
 
 #include "absl/time/clock.h"
@@ -26,6 +28,7 @@ namespace tensorflow {
 namespace data {
 namespace model {
 
+constexpr int ElementHistogram::kNumBuckets;
 constexpr int64 Model::kOptimizationPeriodMinMs;
 constexpr int64 Model::kOptimizationPeriodMaxMs;
 
@@ -65,7 +68,10 @@ inline void CollectParameters(std::shared_ptr<Node> node,
     if (pair.second->name == kParallelism &&
         processing_times[pair.first] > kEssentialRate * uniform_share) {
       parallelism_parameters->push_back(pair);
-    } else if (pair.second->name == kBufferSize) {
+    } else if (pair.second->name == kBufferSize ||
+               pair.second->name == kCycleLength) {
+      // Like buffer sizes, cycle lengths trade memory for throughput and keep
+      // being tuned once the CPU budget is reached.
       buffer_size_parameters->push_back(pair);
     }
   }
@@ -330,7 +336,8 @@ class AsyncInterleaveMany : public Node {
   // interleave "cycle" divided by `parallelism`, `consumer_time` is the
   // `input_time` specified through `input_times` divided by `num_inputs() - 1`,
   // and if the node has parallelism parameter, then `buffer_size` is derived
-  // from `parallelism`.
+  // from `parallelism`. If the node has a cycle length parameter, it caps the
+  // parallelism, as each open input is processed by at most one worker.
   void OutputTimeLocked(const NodeValues& input_times,
                         ParameterGradients* gradients, NodeValues* output_times,
                         NodeValues* output_time_gradients) const override
@@ -354,6 +361,10 @@ class AsyncInterleaveMany : public Node {
     if (parameter) {
       parallelism = std::min(parallelism, (*parameter)->value);
     }
+    auto* cycle_length_parameter = gtl::FindOrNull(parameters_, kCycleLength);
+    if (cycle_length_parameter) {
+      parallelism = std::min(parallelism, (*cycle_length_parameter)->value);
+    }
     double output_time_for_inputs =
         OutputTimeForInputs(*output_times) -
         (*output_times)[inputs_.front()->long_name()];
@@ -388,10 +399,23 @@ class AsyncInterleaveMany : public Node {
       for (auto& pair : inputs_.front()->CollectTunableParameters()) {
         (*gradients)[std::make_pair(pair.first, pair.second->name)] = 0.0L;
       }
-      // Add derivative w.r.t. own parallelism parameter.
-      if (parameter && (*parameter)->state->tunable) {
-        (*gradients)[std::make_pair(long_name(), (*parameter)->name)] =
-            buffer_size_der - producer_time_der * producer_time / parallelism;
+      // Add derivatives w.r.t. own parallelism and cycle length parameters.
+      // If both are present, only the smaller one affects the output time.
+      const double parallelism_der =
+          buffer_size_der - producer_time_der * producer_time / parallelism;
+      double parameters_bound = std::numeric_limits<double>::max();
+      for (auto* own_parameter : {parameter, cycle_length_parameter}) {
+        if (own_parameter) {
+          parameters_bound =
+              std::min(parameters_bound, (*own_parameter)->value);
+        }
+      }
+      for (auto* own_parameter : {parameter, cycle_length_parameter}) {
+        if (own_parameter && (*own_parameter)->state->tunable) {
+          (*gradients)[std::make_pair(long_name(), (*own_parameter)->name)] =
+              (*own_parameter)->value <= parameters_bound ? parallelism_der
+                                                          : 0.0L;
+        }
       }
     } else {
       wait_time = ComputeWaitTime(producer_time, consumer_time, parallelism,
@@ -428,7 +452,16 @@ class AsyncInterleaveMany : public Node {
     double result = 0;
     auto* parameter = gtl::FindOrNull(parameters_, kParallelism);
     if (parameter) {
-      result += (*parameter)->value * AverageBufferedElementSize();
+      // Results are buffered by the open inputs, of which there are at least
+      // as many as workers.
+      double num_buffering_inputs = (*parameter)->value;
+      auto* cycle_length_parameter =
+          gtl::FindOrNull(parameters_, kCycleLength);
+      if (cycle_length_parameter) {
+        num_buffering_inputs =
+            std::max(num_buffering_inputs, (*cycle_length_parameter)->value);
+      }
+      result += num_buffering_inputs * AverageBufferedElementSize();
     }
     return result;
   }
@@ -934,6 +967,105 @@ std::shared_ptr<Parameter> MakeParameter(const string& name,
   return std::make_shared<Parameter>(name, state, min, max);
 }
 
+ElementHistogram::ElementHistogram() : count_(0), sum_(0), max_(0) {
+  for (auto& bucket : buckets_) {
+    bucket = 0;
+  }
+}
+
+int ElementHistogram::BucketIndex(int64 value) {
+  if (value <= 0) {
+    return 0;
+  }
+  return std::min(kNumBuckets - 1,
+                  1 + static_cast<int>(4 * std::log2(value)));
+}
+
+void ElementHistogram::Add(int64 value) {
+  value = std::max<int64>(value, 0);
+  buckets_[BucketIndex(value)]++;
+  count_++;
+  sum_ += value;
+  int64 max = max_;
+  while (value > max && !max_.compare_exchange_weak(max, value)) {
+  }
+}
+
+void ElementHistogram::CopyFrom(const ElementHistogram& other) {
+  count_.store(other.count_);
+  sum_.store(other.sum_);
+  max_.store(other.max_);
+  for (int i = 0; i < kNumBuckets; ++i) {
+    buckets_[i].store(other.buckets_[i]);
+  }
+}
+
+double ElementHistogram::Mean() const {
+  const int64 count = count_;
+  if (count == 0) {
+    return 0;
+  }
+  return static_cast<double>(sum_) / count;
+}
+
+double ElementHistogram::Quantile(double quantile) const {
+  // Values may be recorded concurrently, so the total is computed from the
+  // same bucket counts as the quantile.
+  int64 buckets[kNumBuckets];
+  int64 total = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    buckets[i] = buckets_[i];
+    total += buckets[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  const double target = std::min(std::max(quantile, 0.0), 1.0) * total;
+  double cumulative = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    if (buckets[i] == 0 || cumulative + buckets[i] < target) {
+      cumulative += buckets[i];
+      continue;
+    }
+    if (i == 0) {
+      return 0;
+    }
+    // Interpolates linearly inside the bucket.
+    const double lower = std::exp2((i - 1) / 4.0);
+    const double upper = std::exp2(i / 4.0);
+    const double fraction = (target - cumulative) / buckets[i];
+    return std::min(lower + fraction * (upper - lower),
+                    static_cast<double>(max_));
+  }
+  return max_;
+}
+
+void ElementHistogram::ToProto(ModelProto::Histogram* histogram_proto) const {
+  histogram_proto->set_count(count_);
+  histogram_proto->set_sum(sum_);
+  histogram_proto->set_max(max_);
+  histogram_proto->clear_buckets();
+  // Trailing empty buckets are omitted.
+  int num_buckets = kNumBuckets;
+  while (num_buckets > 0 && buckets_[num_buckets - 1] == 0) {
+    --num_buckets;
+  }
+  for (int i = 0; i < num_buckets; ++i) {
+    histogram_proto->add_buckets(buckets_[i]);
+  }
+}
+
+void ElementHistogram::FromProto(const ModelProto::Histogram& histogram_proto) {
+  count_.store(histogram_proto.count());
+  sum_.store(histogram_proto.sum());
+  max_.store(histogram_proto.max());
+  for (int i = 0; i < kNumBuckets; ++i) {
+    buckets_[i].store(i < histogram_proto.buckets_size()
+                          ? histogram_proto.buckets(i)
+                          : 0);
+  }
+}
+
 std::shared_ptr<Node> MakeInterleaveManyNode(Node::Args args) {
   return std::make_shared<InterleaveMany>(std::move(args));
 }
@@ -1200,6 +1332,22 @@ std::shared_ptr<Node> Node::Snapshot() const {
   return result;
 }
 
+void Node::ScaleProcessingTimeToLatencyQuantile(double quantile) {
+  auto scale = [quantile](Node* node) {
+    const double mean = node->element_latency_.Mean();
+    const double tail = node->element_latency_.Quantile(quantile);
+    if (mean > 0 && tail > mean) {
+      node->processing_time_.store(
+          static_cast<int64>(node->processing_time_ * (tail / mean)));
+    }
+  };
+  tf_shared_lock l(mu_);
+  scale(this);
+  for (const auto& node : CollectNodes(TraversalOrder::BFS, IsAnyNode)) {
+    scale(node.get());
+  }
+}
+
 double Node::SelfProcessingTime() const {
   tf_shared_lock l(mu_);
   return SelfProcessingTimeLocked();
@@ -1416,6 +1564,15 @@ void Node::DebugStringHelper(absl::flat_hash_map<string, string>* debug_strings)
   strings::StrAppend(&result, "  processing_time=", processing_time_.load(),
                      "\n");
   strings::StrAppend(&result, "  num_elements=", num_elements_.load(), "\n");
+  strings::StrAppend(&result, "  element_latency={mean=",
+                     element_latency_.Mean(),
+                     ",p50=", element_latency_.Quantile(0.5),
+                     ",p90=", element_latency_.Quantile(0.9),
+                     ",p99=", element_latency_.Quantile(0.99), "}\n");
+  strings::StrAppend(&result, "  element_bytes={mean=", element_bytes_.Mean(),
+                     ",p50=", element_bytes_.Quantile(0.5),
+                     ",p90=", element_bytes_.Quantile(0.9),
+                     ",p99=", element_bytes_.Quantile(0.99), "}\n");
   string inputs;
   for (auto& input : inputs_) {
     strings::StrAppend(&inputs, input->long_name(), ",");
@@ -1444,6 +1601,8 @@ std::shared_ptr<Node> Node::SnapshotHelper(
     cloned_current->num_elements_.store(num_elements_);
     cloned_current->record_metrics_.store(false);
     cloned_current->processing_time_.store(processing_time_);
+    cloned_current->element_bytes_.CopyFrom(element_bytes_);
+    cloned_current->element_latency_.CopyFrom(element_latency_);
     mutex_lock l2(cloned_current->mu_);
     cloned_current->parameters_ = parameters_;
   }
@@ -1505,6 +1664,8 @@ Status Node::ToProto(ModelProto::Node* node_proto) const {
   node_proto->set_num_elements(num_elements_);
   node_proto->set_processing_time(processing_time_);
   node_proto->set_record_metrics(record_metrics_);
+  element_latency_.ToProto(node_proto->mutable_element_latency());
+  element_bytes_.ToProto(node_proto->mutable_element_bytes());
 
   // Produce protos for all parameters.
   for (auto const& parameter : parameters_) {
@@ -1535,6 +1696,8 @@ Status Node::FromProtoHelper(ModelProto::Node node_proto,
   node->num_elements_.store(node_proto.num_elements());
   node->processing_time_.store(node_proto.processing_time());
   node->record_metrics_.store(node_proto.record_metrics());
+  node->element_latency_.FromProto(node_proto.element_latency());
+  node->element_bytes_.FromProto(node_proto.element_bytes());
 
   // Restore parameters.
   int64 num_parameters = node_proto.parameters_size();
@@ -1646,6 +1809,10 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
   optimization_params.set_cpu_budget(cpu_budget);
   optimization_params.set_ram_budget(ram_budget);
   optimization_params.set_model_input_time(model_input_time);
+  if (latency_quantile_ > 0) {
+    optimization_params.set_latency_quantile(latency_quantile_);
+    snapshot->ScaleProcessingTimeToLatencyQuantile(latency_quantile_);
+  }
   switch (algorithm) {
     case AutotuneAlgorithm::HILL_CLIMB:
       OptimizeHillClimb(snapshot, optimization_params, cancellation_manager);
@@ -668,6 +668,69 @@ TEST(AsyncInterleaveManyGradientTest, Model) {
       (new_output_time - output_time) / kParameterStep, kComparisonPrecision);
 }
 
+TEST(AsyncInterleaveManyGradientTest, CycleLength) {
+  const double input_time = 100;
+  std::shared_ptr<Parameter> parallelism_parameter =
+      model::MakeParameter("parallelism",
+                           std::make_shared<SharedState>(
+                               /*value=*/model::kAutotune, nullptr, nullptr),
+                           /*min=*/1, /*max=*/4);
+  std::shared_ptr<Parameter> cycle_length_parameter =
+      model::MakeParameter("cycle_length",
+                           std::make_shared<SharedState>(
+                               /*value=*/model::kAutotune, nullptr, nullptr),
+                           /*min=*/1, /*max=*/4);
+  std::shared_ptr<Node> async_interleave_many =
+      model::MakeAsyncInterleaveManyNode(
+          {0, "async_interleave_many", nullptr},
+          {parallelism_parameter, cycle_length_parameter});
+  std::shared_ptr<Node> meta_source =
+      model::MakeSourceNode({1, "meta_source", async_interleave_many});
+  async_interleave_many->add_input(meta_source);
+  std::vector<std::shared_ptr<Node>> sources;
+  for (int i = 0; i < 4; ++i) {
+    sources.push_back(
+        model::MakeSourceNode({i + 2, "source", async_interleave_many}));
+    async_interleave_many->add_input(sources.back());
+    sources.back()->record_element();
+    sources.back()->add_processing_time(300);
+  }
+  auto cleanup = gtl::MakeCleanup([async_interleave_many, meta_source,
+                                   &sources]() {
+    async_interleave_many->remove_input(meta_source);
+    for (auto& source : sources) {
+      async_interleave_many->remove_input(source);
+    }
+  });
+  Model::NodeValues input_times;
+  input_times[kModelInputTimeKey] = input_time;
+  async_interleave_many->record_element();
+  async_interleave_many->add_processing_time(100);
+
+  // The cycle length bounds the parallelism.
+  parallelism_parameter->value = 3;
+  cycle_length_parameter->value = 2;
+  const double output_time =
+      async_interleave_many->OutputTime(&input_times, nullptr);
+  parallelism_parameter->value = 2;
+  EXPECT_NEAR(async_interleave_many->OutputTime(&input_times, nullptr),
+              output_time, kComparisonPrecision);
+  parallelism_parameter->value = 3;
+
+  Model::ParameterGradients gradients;
+  async_interleave_many->OutputTime(&input_times, &gradients);
+  EXPECT_EQ(gradients[std::make_pair(async_interleave_many->long_name(),
+                                     parallelism_parameter->name)],
+            0.0);
+  cycle_length_parameter->value += kParameterStep;
+  const double new_output_time =
+      async_interleave_many->OutputTime(&input_times, nullptr);
+  EXPECT_NEAR(gradients[std::make_pair(async_interleave_many->long_name(),
+                                       cycle_length_parameter->name)],
+              (new_output_time - output_time) / kParameterStep,
+              kComparisonPrecision);
+}
+
 class AsyncKnownRatioGradientTest : public ::testing::TestWithParam<string> {};
 
 TEST_P(AsyncKnownRatioGradientTest, Model) {
@@ -1170,6 +1233,64 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
                          ::testing::Values(0, 1));
 
+TEST(ElementHistogramTest, Quantiles) {
+  ElementHistogram histogram;
+  EXPECT_EQ(0, histogram.count());
+  EXPECT_EQ(0, histogram.Quantile(0.5));
+  for (int64 i = 1; i <= 100; ++i) {
+    histogram.Add(i);
+  }
+  EXPECT_EQ(100, histogram.count());
+  EXPECT_DOUBLE_EQ(50.5, histogram.Mean());
+  // Buckets are a quarter of a power of two wide, so estimates are within 20%
+  // of the exact quantiles.
+  EXPECT_NEAR(50, histogram.Quantile(0.5), 10);
+  EXPECT_NEAR(90, histogram.Quantile(0.9), 18);
+  EXPECT_LE(histogram.Quantile(1.0), 100);
+  EXPECT_LE(histogram.Quantile(0.5), histogram.Quantile(0.9));
+}
+
+TEST(ElementHistogramTest, SaveAndLoad) {
+  ElementHistogram histogram;
+  for (int64 value : {0, 3, 3, 70, 5000}) {
+    histogram.Add(value);
+  }
+  ModelProto::Histogram histogram_proto;
+  histogram.ToProto(&histogram_proto);
+  EXPECT_EQ(5, histogram_proto.count());
+  EXPECT_EQ(5076, histogram_proto.sum());
+  EXPECT_EQ(5000, histogram_proto.max());
+
+  ElementHistogram loaded;
+  loaded.FromProto(histogram_proto);
+  EXPECT_EQ(histogram.count(), loaded.count());
+  EXPECT_DOUBLE_EQ(histogram.Mean(), loaded.Mean());
+  for (double quantile : {0.1, 0.5, 0.9, 0.99}) {
+    EXPECT_DOUBLE_EQ(histogram.Quantile(quantile), loaded.Quantile(quantile));
+  }
+}
+
+TEST(ElementHistogramTest, ScaleProcessingTimeToTailLatency) {
+  std::shared_ptr<Node> skewed = model::MakeSourceNode({0, "skewed", nullptr});
+  std::shared_ptr<Node> uniform =
+      model::MakeSourceNode({1, "uniform", nullptr});
+  skewed->add_processing_time(1000);
+  uniform->add_processing_time(1000);
+  for (int i = 0; i < 9; ++i) {
+    skewed->record_element_latency(100);
+    uniform->record_element_latency(100);
+  }
+  skewed->record_element_latency(10000);
+  uniform->record_element_latency(100);
+
+  skewed->ScaleProcessingTimeToLatencyQuantile(0.95);
+  uniform->ScaleProcessingTimeToLatencyQuantile(0.95);
+  // The mean latency of `skewed` is 1090 and its tail latency is close to
+  // 10000.
+  EXPECT_GT(skewed->processing_time(), 8000);
+  EXPECT_EQ(1000, uniform->processing_time());
+}
+
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
   EXPECT_FALSE(source->is_recording());
@@ -94,9 +94,17 @@ class Var : public ResourceBase {
   // so desired.
   std::atomic<bool> copy_on_read_mode{false};
 
+  // Locks that keep sparse writes done under a shared 'mu()' from interleaving
+  // with each other, without serializing writes to disjoint rows. Stripe 's'
+  // covers the 's'-th of 'kNumRowStripes' equal ranges of rows. When locking
+  // several stripes, they must be acquired in increasing order.
+  static constexpr int kNumRowStripes = 16;
+  mutex* row_stripe_mu(int stripe) { return &row_stripe_mu_[stripe]; }
+
  private:
   mutex mu_;
   Tensor tensor_;
+  mutex row_stripe_mu_[kNumRowStripes];
 
   ~Var() override {}
   TF_DISALLOW_COPY_AND_ASSIGN(Var);
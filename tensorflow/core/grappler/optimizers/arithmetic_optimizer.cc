@@ -3573,10 +3573,14 @@ class UnaryOpsComposition : public ArithmeticOptimizerStage {
                       {"Ceil",       {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Cos",        {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Cosh",       {DT_FLOAT,          DT_DOUBLE}},
+                      {"Digamma",    {DT_FLOAT,          DT_DOUBLE}},
+                      {"Erf",        {DT_FLOAT, DT_HALF, DT_DOUBLE}},
+                      {"Erfc",       {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Expm1",      {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Exp",        {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Floor",      {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Inv",        {DT_FLOAT, DT_HALF, DT_DOUBLE}},
+                      {"Lgamma",     {DT_FLOAT,          DT_DOUBLE}},
                       {"Log",        {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Log1p",      {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Neg",        {DT_FLOAT, DT_HALF, DT_DOUBLE}},
@@ -3585,6 +3589,7 @@ class UnaryOpsComposition : public ArithmeticOptimizerStage {
                       {"Round",      {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Rsqrt",      {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Sigmoid",    {DT_FLOAT, DT_HALF, DT_DOUBLE}},
+                      {"Sign",       {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Sin",        {DT_FLOAT, DT_HALF, DT_DOUBLE}},
                       {"Sinh",       {DT_FLOAT,          DT_DOUBLE}},
                       {"Sqrt",       {DT_FLOAT, DT_HALF, DT_DOUBLE}},
@@ -4104,6 +4109,20 @@ class RemoveStackSliceSameAxis : public ArithmeticOptimizerStage {
 //     segment_ids = sparse_ids.indices[:, 0]
 //     result = tf.sparse.segment_<combiner>(
 //          embeddings, sparse_ids.values, segment_ids)
+//
+// More generally, the rows gathered by any tf.gather() on the 0th axis that
+// only feeds the reduction are read from the embeddings directly, by gathering
+// the (much smaller) ids instead:
+//
+//     gathered_rows = tf.gather(embeddings, ids)
+//     result = tf.sparse.segment_<combiner>(gathered_rows, idx, segment_ids)
+//
+// becomes
+//
+//     result = tf.sparse.segment_<combiner>(
+//          embeddings, tf.gather(ids, idx), segment_ids)
+//
+// so that the [num_ids, embedding_dim] intermediate is never materialized.
 class SimplifyEmbeddingLookupStage : public ArithmeticOptimizerStage {
  public:
   explicit SimplifyEmbeddingLookupStage(
@@ -4131,33 +4150,64 @@ class SimplifyEmbeddingLookupStage : public ArithmeticOptimizerStage {
     if (gather_node->op() == "GatherV2" && !IsAxis0(*gather_node, 2))
       return Status::OK();
 
-    // Input 1 (indices) of the gather node must be a tf.unique() on the 0th
-    // axis.
+    // If input 1 (indices) of the gather node is a tf.unique() on the 0th axis
+    // and input 1 (indices) of the reduction node is output 1 of the unique
+    // node, the reduction can index the params with input 0 (x) of the unique
+    // node.
     NodeDef* unique_node = nullptr;
     TF_RETURN_IF_ERROR(GetInputNode(gather_node->input(1), &unique_node));
-    if (!IsUnique(*unique_node) || IsInPreserveSet(*unique_node) ||
-        unique_node->device() != gather_node->device())
-      return Status::OK();
-    if (unique_node->op() == "UniqueV2" && !IsAxis0(*unique_node, 1))
-      return Status::OK();
-
-    DataType unique_element_type;
-    TF_RETURN_IF_ERROR(GetNodeAttr(*unique_node, "T", &unique_element_type));
-
-    // Input 1 (indices) of the reduction node must be output 1 of the unique
-    // node.
-    const TensorId idx_tensor = ParseTensorName(reduction_node->input(1));
-    if (idx_tensor != TensorId(unique_node->name(), 1)) return Status::OK();
-
-    // Input 1 (indices) of the reduction node becomes input 0 (x) of the unique
-    // node.
-    reduction_node->set_input(1, unique_node->input(0));
-    ctx().node_map->UpdateInput(reduction_node->name(),
-                                reduction_node->input(1),
-                                unique_node->input(0));
-    SetDataTypeToAttr(unique_element_type, "Tidx", reduction_node);
+    const bool is_unique_lookup =
+        IsUnique(*unique_node) && !IsInPreserveSet(*unique_node) &&
+        unique_node->device() == gather_node->device() &&
+        (unique_node->op() != "UniqueV2" || IsAxis0(*unique_node, 1)) &&
+        ParseTensorName(reduction_node->input(1)) ==
+            TensorId(unique_node->name(), 1);
+
+    if (is_unique_lookup) {
+      DataType unique_element_type;
+      TF_RETURN_IF_ERROR(GetNodeAttr(*unique_node, "T", &unique_element_type));
+
+      // Input 1 (indices) of the reduction node becomes input 0 (x) of the
+      // unique node.
+      reduction_node->set_input(1, unique_node->input(0));
+      ctx().node_map->UpdateInput(reduction_node->name(),
+                                  reduction_node->input(1),
+                                  unique_node->input(0));
+      SetDataTypeToAttr(unique_element_type, "Tidx", reduction_node);
+    } else {
+      // Otherwise the ids are gathered instead of the rows. This is only a win
+      // if the gathered rows aren't needed by anything else.
+      if (NumNonControlOutputs(*gather_node, *ctx().node_map) != 1)
+        return Status::OK();
+      DataType ids_type;
+      DataType idx_type;
+      TF_RETURN_IF_ERROR(GetNodeAttr(*gather_node, "Tindices", &ids_type));
+      TF_RETURN_IF_ERROR(GetNodeAttr(*reduction_node, "Tidx", &idx_type));
+
+      NodeDef* ids_gather_node = ctx().optimized_graph->add_node();
+      ids_gather_node->set_name(OptimizedNodeName(
+          ParseNodeScopeAndName(reduction_node->name()), "Ids"));
+      ids_gather_node->set_op("Gather");
+      ids_gather_node->set_device(reduction_node->device());
+      ids_gather_node->add_input(gather_node->input(1));
+      ids_gather_node->add_input(reduction_node->input(1));
+      SetDataTypeToAttr(ids_type, "Tparams", ids_gather_node);
+      SetDataTypeToAttr(idx_type, "Tindices", ids_gather_node);
+      ctx().node_map->AddNode(ids_gather_node->name(), ids_gather_node);
+      ctx().node_map->AddOutput(NodeName(gather_node->input(1)),
+                                ids_gather_node->name());
+      ctx().node_map->AddOutput(NodeName(reduction_node->input(1)),
+                                ids_gather_node->name());
+
+      // Input 1 (indices) of the reduction node becomes the gathered ids.
+      ctx().node_map->UpdateInput(reduction_node->name(),
+                                  reduction_node->input(1),
+                                  ids_gather_node->name());
+      reduction_node->set_input(1, ids_gather_node->name());
+      SetDataTypeToAttr(ids_type, "Tidx", reduction_node);
+    }
 
-    // Input 0 (data) of the reduction node becomes input 1 (params) of the
+    // Input 0 (data) of the reduction node becomes input 0 (params) of the
     // gather node.
     const OpInfo::TensorProperties* gather_input_properties;
     TF_RETURN_IF_ERROR(
@@ -4670,6 +4670,89 @@ TEST_F(ArithmeticOptimizerTest, SimplifyEmbeddingLookup) {
   }
 }
 
+TEST_F(ArithmeticOptimizerTest, SimplifyEmbeddingLookupWithoutUnique) {
+  for (DataType ids_type : {DT_INT32, DT_INT64}) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    Output embeddings =
+        ops::Const(s.WithOpName("embeddings"),
+                   {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f}, {3, 2});
+    Output segment_ids =
+        ops::Const(s.WithOpName("segment_ids"), {0, 1, 1, 2, 2, 2, 2});
+    Output ids = ops::Cast(s.WithOpName("ids"),
+                           ops::Const(s.WithOpName("ids_values"), {2, 0, 1}),
+                           ids_type);
+    Output idx = ops::Const(s.WithOpName("idx"), {0, 0, 1, 2, 1, 0, 1});
+    Output gathered_rows =
+        ops::Gather(s.WithOpName("gathered_rows"), embeddings, ids);
+    Output result = ops::SparseSegmentMean(s.WithOpName("result"),
+                                           gathered_rows, idx, segment_ids);
+    Output id = ops::Identity(s.WithOpName("id"), result);
+
+    GrapplerItem item;
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    item.fetch = {"id"};
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+    ASSERT_EQ(tensors_expected.size(), 1);
+
+    GraphDef output;
+    ArithmeticOptimizer optimizer;
+    EnableOnlySimplifyEmbeddingLookup(&optimizer);
+    OptimizeAndPrune(&optimizer, &item, &output);
+
+    const string ids_gather_name =
+        "ArithmeticOptimizer/SimplifyEmbeddingLookupStage_Ids_result";
+    bool ids_gather_found = false;
+    for (const auto& node : output.node()) {
+      if (node.name() == "result") {
+        EXPECT_EQ(node.input(0), "embeddings");
+        EXPECT_EQ(node.input(1), ids_gather_name);
+        EXPECT_EQ(node.attr().at("Tidx").type(), ids_type);
+      } else if (node.name() == ids_gather_name) {
+        ids_gather_found = true;
+        EXPECT_EQ(node.input(0), "ids");
+        EXPECT_EQ(node.input(1), "idx");
+      }
+      EXPECT_NE(node.name(), "gathered_rows");
+    }
+    EXPECT_TRUE(ids_gather_found);
+
+    auto tensors = EvaluateNodes(output, item.fetch);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+  }
+}
+
+TEST_F(ArithmeticOptimizerTest, SimplifyEmbeddingLookupKeepsSharedGather) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output embeddings = ops::Const(s.WithOpName("embeddings"),
+                                 {1.0f, 2.0f, 3.0f, 4.0f}, {2, 2});
+  Output segment_ids = ops::Const(s.WithOpName("segment_ids"), {0, 0, 1});
+  Output ids = ops::Const(s.WithOpName("ids"), {1, 0});
+  Output idx = ops::Const(s.WithOpName("idx"), {0, 1, 1});
+  Output gathered_rows =
+      ops::Gather(s.WithOpName("gathered_rows"), embeddings, ids);
+  Output result = ops::SparseSegmentSum(s.WithOpName("result"), gathered_rows,
+                                        idx, segment_ids);
+  Output id = ops::Identity(s.WithOpName("id"), result);
+  Output rows = ops::Identity(s.WithOpName("rows"), gathered_rows);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"id", "rows"};
+
+  GraphDef output;
+  ArithmeticOptimizer optimizer;
+  EnableOnlySimplifyEmbeddingLookup(&optimizer);
+  OptimizeAndPrune(&optimizer, &item, &output);
+
+  for (const auto& node : output.node()) {
+    if (node.name() == "result") {
+      EXPECT_EQ(node.input(0), "gathered_rows");
+      EXPECT_EQ(node.input(1), "idx");
+    }
+  }
+}
+
 TEST_F(ArithmeticOptimizerTest, SimplifyResourceEmbeddingLookup) {
   for (DataType unique_idx_type : {DT_INT32, DT_INT64}) {
     tensorflow::Scope s = tensorflow::Scope::NewRootScope();
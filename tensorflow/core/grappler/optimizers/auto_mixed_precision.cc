@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/env_var.h"
 
@@ -998,6 +999,8 @@ class AutoMixedPrecisionImpl {
                                                              cudnn_version_);
       case AutoMixedPrecisionMode::MKL:
         return std::make_unique<AutoMixedPrecisionListsMkl>();
+      case AutoMixedPrecisionMode::CPU:
+        return std::make_unique<AutoMixedPrecisionListsCpu>();
     }
   }
   Status PrintDebugLogs(bool preop, size_t timestamp);
@@ -1268,18 +1271,27 @@ bool ShouldIgnorePerformance() {
   return is_enabled;
 }
 
+// Returns true if the CPU has native bfloat16 instructions, which the standard
+// CPU kernels need to run faster in bfloat16 than in float32.
+bool HasNativeCpuBfloat16() {
+  return port::TestCPUFeature(port::CPUFeature::AVX512_BF16) ||
+         port::TestCPUFeature(port::CPUFeature::AMX_BF16);
+}
+
 Status AutoMixedPrecisionImpl::Optimize() {
   string optimization_level;
   TF_RETURN_IF_ERROR(ReadStringFromEnvVar(
       "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL", "", &optimization_level));
   optimization_level = absl::AsciiStrToUpper(optimization_level);
   force_all_fp16_ = optimization_level == "UNSAFE_FORCE_ALL";
-  if (force_all_fp16_ && mode_ == AutoMixedPrecisionMode::MKL) {
+  if (force_all_fp16_ && mode_ != AutoMixedPrecisionMode::CUDA) {
     // Many ops do not support bfloat16 on the CPU so we disallowing forcing to
     // bfloat16.
     return errors::InvalidArgument(
         "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL cannot be set to "
-        "UNSAFE_FORCE_ALL when MKL is used");
+        "UNSAFE_FORCE_ALL when ",
+        mode_ == AutoMixedPrecisionMode::MKL ? "MKL" : "bfloat16 on CPU",
+        " is used");
   }
 
   std::unique_ptr<AutoMixedPrecisionLists> mp_lists =
@@ -1304,6 +1316,7 @@ Status AutoMixedPrecisionImpl::Optimize() {
             (ShouldIgnorePerformance() || IsOnSuitableGPUArch(node));
         break;
       case AutoMixedPrecisionMode::MKL:
+      case AutoMixedPrecisionMode::CPU:
         should_process = !MustPreserve(node) && IsOnDevice(node, DEVICE_CPU);
         break;
     }
@@ -2026,6 +2039,14 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
                  << " graph optimizer";
     return Status::OK();
   }
+  if (mode_ == AutoMixedPrecisionMode::CPU && !ShouldIgnorePerformance() &&
+      !HasNativeCpuBfloat16()) {
+    // Without native instructions, bfloat16 is emulated and slower than
+    // float32.
+    LOG(WARNING) << "No CPU support for bfloat16 (AVX512-BF16 or AMX) "
+                 << "detected, skipping " << name() << " graph optimizer";
+    return Status::OK();
+  }
 
   // Optimize the output graph in-place.
   AutoMixedPrecisionImpl optimizer(cluster, item.NodesToPreserve(), output,
@@ -447,6 +447,107 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
   }
 };
 
+class AutoMixedPrecisionListsCpu : public AutoMixedPrecisionLists {
+ public:
+  AutoMixedPrecisionListsCpu() {}
+
+  // Tuned for the standard (Eigen) CPU kernels on CPUs with native bfloat16
+  // instructions, where only the matrix multiplications run notably faster in
+  // bfloat16.  Ops without a CPU kernel for bfloat16 are never converted, so
+  // the infer list and clear list may be broader than the registered kernels.
+  gtl::FlatSet<string> AllowList() override {
+    auto list = gtl::FlatSet<string>{
+        "BatchMatMul",
+        "BatchMatMulV2",
+        "MatMul",
+    };
+    UpdateList("ALLOWLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> InferList() override {
+        "Add",
+        "AddN",
+        "AddV2",
+        "BiasAdd",
+        "BiasAddV1",
+        "Elu",
+        "Erf",
+        "LeakyRelu",
+        "Mul",
+        "Sigmoid",
+        "Square",
+        "Sub",
+        "Tanh",
+    };
+    UpdateList("INFERLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> DenyList() override {
+    auto list = gtl::FlatSet<string>{
+        "Exp",
+        "Expm1",
+        "L2Loss",
+        "Log",
+        "Log1p",
+        "LogSoftmax",
+        "Mean",
+        "Pow",
+        "SaveV2",
+        "Softmax",
+        "SoftmaxCrossEntropyWithLogits",
+        "SparseSoftmaxCrossEntropyWithLogits",
+        "Sum",
+    };
+    UpdateList("DENYLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> ClearList() override {
+        "Concat",
+        "ConcatV2",
+        "EnsureShape",
+        "Enter",
+        "Equal",
+        "Exit",
+        "ExpandDims",
+        "Gather",
+        "GatherV2",
+        "Identity",
+        "IdentityN",
+        "MaxPool",
+        "Maximum",
+        "Merge",
+        "Minimum",
+        "NextIteration",
+        "Pack",
+        "PreventGradient",
+        "Relu",
+        "Relu6",
+        "Reshape",
+        "Select",
+        "SelectV2",
+        "Shape",
+        "ShapeN",
+        "Slice",
+        "Split",
+        "SplitV",
+        "Squeeze",
+        "StopGradient",
+        "StridedSlice",
+        "Switch",
+        "Tile",
+        "Transpose",
+        "Unpack",
+        "ZerosLike",
+    };
+    AddTensorListOps(&list);
+    UpdateList("CLEARLIST", &list);
+    return list;
+  }
+};
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/common_subgraph_elimination.h"
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -24,6 +25,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/graph/tensor_id.h"
@@ -36,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/traversal.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/hash.h"
 #include "tensorflow/core/platform/status.h"
@@ -289,5 +292,121 @@ Status CommonSubgraphElimination::Optimize(Cluster* /*cluster*/,
   return DedupComputations(optimized_graph);
 }
 
+namespace {
+
+// Bounds the number of dedup rounds over the library. Each round can make the
+// callers of the functions it dedups identical, up to nesting depth.
+constexpr int kMaxFunctionDedupRounds = 8;
+
+// A function with its name cleared, so that functions that are identical up to
+// their names compare equal.
+struct CanonicalFunction {
+  explicit CanonicalFunction(const FunctionDef& func)
+      : name(func.signature().name()), function(func) {
+    function.mutable_signature()->clear_name();
+    // FunctionDefsEqual ignores the argument attributes, so compare them
+    // separately.
+    FunctionDef arg_attrs;
+    *arg_attrs.mutable_arg_attr() = func.arg_attr();
+    *arg_attrs.mutable_resource_arg_unique_id() =
+        func.resource_arg_unique_id();
+    SerializeToStringDeterministic(arg_attrs, &serialized_arg_attrs);
+    hash = Hash64Combine(FunctionDefHash(function),
+                         Hash64(serialized_arg_attrs));
+  }
+
+  bool operator==(const CanonicalFunction& other) const {
+    return hash == other.hash &&
+           serialized_arg_attrs == other.serialized_arg_attrs &&
+           FunctionDefsEqual(function, other.function);
+  }
+
+  string name;
+  FunctionDef function;
+  string serialized_arg_attrs;
+  uint64 hash;
+};
+
+void RenameFunctions(const absl::flat_hash_map<string, string>& renames,
+                     NameAttrList* func) {
+  auto it = renames.find(func->name());
+  if (it != renames.end()) func->set_name(it->second);
+  for (auto& attr : *func->mutable_attr()) {
+    if (attr.second.has_func()) {
+      RenameFunctions(renames, attr.second.mutable_func());
+    }
+    if (attr.second.has_list()) {
+      for (NameAttrList& f : *attr.second.mutable_list()->mutable_func()) {
+        RenameFunctions(renames, &f);
+      }
+    }
+  }
+}
+
+// Rewrites the function calls of `nodes`, i.e. the nodes whose op is a function
+// and the function attributes, according to `renames`.
+void RenameFunctionCalls(const absl::flat_hash_map<string, string>& renames,
+                         protobuf::RepeatedPtrField<NodeDef>* nodes) {
+  for (NodeDef& node : *nodes) {
+    auto it = renames.find(node.op());
+    if (it != renames.end()) node.set_op(it->second);
+    for (auto& attr : *node.mutable_attr()) {
+      if (attr.second.has_func()) {
+        RenameFunctions(renames, attr.second.mutable_func());
+      }
+      if (attr.second.has_list()) {
+        for (NameAttrList& f : *attr.second.mutable_list()->mutable_func()) {
+          RenameFunctions(renames, &f);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+int DedupFunctionLibrary(GraphDef* graph) {
+  FunctionDefLibrary* library = graph->mutable_library();
+  absl::flat_hash_set<string> with_gradient;
+  for (const GradientDef& gradient : library->gradient()) {
+    with_gradient.insert(gradient.function_name());
+    with_gradient.insert(gradient.gradient_func());
+  }
+
+  int num_removed = 0;
+  for (int round = 0; round < kMaxFunctionDedupRounds; ++round) {
+    // Maps the name of each duplicate function to the name of the function
+    // that replaces it, which is the first of its copies in the library.
+    absl::flat_hash_map<string, string> renames;
+    absl::flat_hash_map<uint64, std::vector<CanonicalFunction>> kept;
+    for (const FunctionDef& func : library->function()) {
+      const string& name = func.signature().name();
+      if (with_gradient.contains(name)) continue;
+      CanonicalFunction canonical(func);
+      std::vector<CanonicalFunction>& candidates = kept[canonical.hash];
+      auto it = std::find(candidates.begin(), candidates.end(), canonical);
+      if (it != candidates.end()) {
+        renames[name] = it->name;
+      } else {
+        candidates.push_back(std::move(canonical));
+      }
+    }
+    if (renames.empty()) break;
+
+    VLOG(2) << "Dedupping " << renames.size() << " functions in round "
+            << round;
+    RenameFunctionCalls(renames, graph->mutable_node());
+    protobuf::RepeatedPtrField<FunctionDef> functions;
+    functions.Swap(library->mutable_function());
+    for (FunctionDef& func : functions) {
+      if (renames.contains(func.signature().name())) continue;
+      RenameFunctionCalls(renames, func.mutable_node_def());
+      library->add_function()->Swap(&func);
+    }
+    num_removed += renames.size();
+  }
+  return num_removed;
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
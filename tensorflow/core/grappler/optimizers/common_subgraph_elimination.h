@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <unordered_set>
 
+#include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
@@ -64,6 +65,12 @@ class CommonSubgraphElimination : public GraphOptimizer {
   std::unordered_set<string> nodes_to_preserve_;
 };
 
+// Dedups the functions of `graph` library that are identical up to their
+// names, and rewrites their callers in `graph` and in the library to call the
+// one that is kept.  Functions that have a gradient registered in the library
+// are kept.  Returns the number of functions removed from the library.
+int DedupFunctionLibrary(GraphDef* graph);
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 
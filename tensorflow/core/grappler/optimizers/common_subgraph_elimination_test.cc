@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -174,5 +175,54 @@ TEST_F(CommonSubgraphEliminationTest, OpDedupCommutative) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+TEST_F(CommonSubgraphEliminationTest, DedupFunctionLibrary) {
+  using test::function::NDef;
+  const auto neg_func = [](const string& name) {
+    return FunctionDefHelper::Create(
+        name, {"x:float"}, {"y:float"}, {},
+        {{{"neg"}, "Neg", {"x"}, {{"T", DT_FLOAT}}}},
+        /*ret_def=*/{{"y", "neg:y:0"}});
+  };
+  const auto caller_func = [](const string& name, const string& callee) {
+    return FunctionDefHelper::Create(
+        name, {"x:float"}, {"y:float"}, {},
+        {{{"call"}, callee, {"x"}, {}}},
+        /*ret_def=*/{{"y", "call:y:0"}});
+  };
+
+  // NegB, NegC and NegCGrad are copies of NegA, but the last two are a
+  // function and its gradient. CallB becomes a copy of CallA once NegB is
+  // replaced by NegA.
+  GraphDef graph = test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("a", "CallA", {"x"}, {}),
+       NDef("b", "PartitionedCall", {"x"},
+            {{"Tin", DataTypeSlice{DT_FLOAT}},
+             {"Tout", DataTypeSlice{DT_FLOAT}},
+             {"f", FunctionDefHelper::FunctionRef("CallB", {})}}),
+       NDef("c", "NegC", {"x"}, {})},
+      {neg_func("NegA"), neg_func("NegB"), neg_func("NegC"),
+       neg_func("NegCGrad"), caller_func("CallA", "NegA"),
+       caller_func("CallB", "NegB")});
+  GradientDef* gradient = graph.mutable_library()->add_gradient();
+  gradient->set_function_name("NegC");
+  gradient->set_gradient_func("NegCGrad");
+
+  EXPECT_EQ(DedupFunctionLibrary(&graph), 2);
+
+  std::vector<string> functions;
+  for (const FunctionDef& func : graph.library().function()) {
+    functions.push_back(func.signature().name());
+  }
+  EXPECT_EQ(functions,
+            std::vector<string>({"NegA", "NegC", "NegCGrad", "CallA"}));
+  EXPECT_EQ(graph.node(1).op(), "CallA");
+  EXPECT_EQ(graph.node(2).attr().at("f").func().name(), "CallA");
+  EXPECT_EQ(graph.node(3).op(), "NegC");
+
+  // Nothing is left to dedup.
+  EXPECT_EQ(DedupFunctionLibrary(&graph), 0);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -65,6 +65,7 @@ const ConfigList& DefaultPluginConfigs() {
                       {"shape_optimization", RewriterConfig::ON},
                       {"auto_mixed_precision", RewriterConfig::ON},
                       {"auto_mixed_precision_mkl", RewriterConfig::ON},
+                      {"auto_mixed_precision_cpu", RewriterConfig::ON},
                       {"pin_to_host_optimization", RewriterConfig::ON},
                       {"layout_optimizer", RewriterConfig::ON},
                       {"remapping", RewriterConfig::ON},
@@ -72,7 +73,8 @@ const ConfigList& DefaultPluginConfigs() {
                       {"dependency_optimization", RewriterConfig::ON},
                       {"auto_parallel", RewriterConfig::ON},
                       {"memory_optimization", RewriterConfig::ON},
-                      {"scoped_allocator_optimization", RewriterConfig::ON}});
+                      {"scoped_allocator_optimization", RewriterConfig::ON},
+                      {"multi_tensor_apply", RewriterConfig::ON}});
   return *default_plugin_configs;
 }
 
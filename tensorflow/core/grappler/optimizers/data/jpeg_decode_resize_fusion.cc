@@ -0,0 +1,206 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/jpeg_decode_resize_fusion.h"
+
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDecodeJpeg[] = "DecodeJpeg";
+constexpr char kDecodeAndResizeJpeg[] = "DecodeAndResizeJpeg";
+constexpr char kExpandDims[] = "ExpandDims";
+constexpr char kResizeBilinear[] = "ResizeBilinear";
+constexpr char kFusedFunctionPrefix[] = "fused_jpeg_decode_resize_";
+constexpr std::array<const char*, 4> kMapOps = {
+    "MapDataset", "ParallelMapDataset", "ParallelMapDatasetV2",
+    "MapAndBatchDataset"};
+
+bool IsMapOp(const NodeDef& node) {
+  for (const char* op : kMapOps) {
+    if (node.op() == op) return true;
+  }
+  return false;
+}
+
+bool IsScalarZero(const NodeDef& node) {
+  auto it = node.attr().find("value");
+  Tensor value;
+  if (node.op() != "Const" || it == node.attr().end() ||
+      !value.FromProto(it->second.tensor()) || value.NumElements() != 1) {
+    return false;
+  }
+  if (value.dtype() == DT_INT32) return value.flat<int32>()(0) == 0;
+  if (value.dtype() == DT_INT64) return value.flat<int64>()(0) == 0;
+  return false;
+}
+
+// Returns the name of the node of a function that produces the data input
+// `input`, which is either a function argument or "node:output_arg:index".
+string FunctionNodeName(const string& input) {
+  return input.substr(0, input.find(':'));
+}
+
+// Replaces the input at `index` of `node` with `inputs`.
+void SpliceInputs(int index, const std::vector<string>& inputs,
+                  NodeDef* node) {
+  std::vector<string> node_inputs(node->input().begin(), node->input().end());
+  node_inputs.erase(node_inputs.begin() + index);
+  node_inputs.insert(node_inputs.begin() + index, inputs.begin(),
+                     inputs.end());
+  node->clear_input();
+  for (string& input : node_inputs) node->add_input(std::move(input));
+}
+
+}  // namespace
+
+int FuseJpegDecodeAndResize(FunctionDef* function) {
+  absl::flat_hash_map<string, NodeDef*> nodes;
+  // How many times each tensor is a data input or a result.
+  absl::flat_hash_map<string, int> num_uses;
+  for (NodeDef& node : *function->mutable_node_def()) {
+    nodes[node.name()] = &node;
+    for (const string& input : node.input()) {
+      if (!IsControlInput(input)) ++num_uses[input];
+    }
+  }
+  for (const auto& ret : function->ret()) ++num_uses[ret.second];
+  absl::flat_hash_set<string> args;
+  for (const auto& arg : function->signature().input_arg()) {
+    args.insert(arg.name());
+  }
+  // Returns the node with op `op` of which the data input `input` is the
+  // output `output_arg`, if it is the only use of that output, or nullptr.
+  auto find_producer = [&](const string& input, StringPiece op,
+                           StringPiece output_arg) -> NodeDef* {
+    if (IsControlInput(input)) return nullptr;
+    auto it = nodes.find(FunctionNodeName(input));
+    if (it == nodes.end() || it->second->op() != op ||
+        input != strings::StrCat(it->first, ":", output_arg, ":0") ||
+        num_uses[input] != 1) {
+      return nullptr;
+    }
+    return it->second;
+  };
+
+  std::vector<std::pair<string, string>> references;
+  for (NodeDef& resize : *function->mutable_node_def()) {
+    DataType dtype;
+    if (resize.op() != kResizeBilinear || resize.input_size() < 2 ||
+        !TryGetNodeAttr(resize, "T", &dtype) || dtype != DT_UINT8) {
+      continue;
+    }
+    NodeDef* expand_dims =
+        find_producer(resize.input(0), kExpandDims, "output");
+    if (expand_dims == nullptr || expand_dims->input_size() < 2) continue;
+    auto dim = nodes.find(FunctionNodeName(expand_dims->input(1)));
+    if (dim == nodes.end() || !IsScalarZero(*dim->second)) continue;
+    NodeDef* decode =
+        find_producer(expand_dims->input(0), kDecodeJpeg, "image");
+    int ratio = 1;
+    if (decode == nullptr || decode->input_size() < 1 ||
+        (TryGetNodeAttr(*decode, "ratio", &ratio) && ratio != 1)) {
+      continue;
+    }
+    // The size must not depend on the decoded image, which would make the
+    // fused graph cyclic.
+    const string size = resize.input(1);
+    auto size_node = nodes.find(FunctionNodeName(size));
+    if (!args.contains(size) &&
+        (size_node == nodes.end() || size_node->second->op() != "Const")) {
+      continue;
+    }
+
+    // The decoding resizes the image, which the resize passes through.
+    VLOG(2) << "Fusing " << decode->name() << " and " << resize.name();
+    decode->set_op(kDecodeAndResizeJpeg);
+    decode->mutable_attr()->erase("ratio");
+    SpliceInputs(0, {decode->input(0), size}, decode);
+    for (const char* attr : {"align_corners", "half_pixel_centers"}) {
+      graph_utils::CopyAttribute(attr, resize, decode);
+    }
+    (*expand_dims->mutable_attr())["T"].set_type(DT_FLOAT);
+    resize.set_op("Identity");
+    SpliceInputs(1, {}, &resize);
+    resize.mutable_attr()->erase("align_corners");
+    resize.mutable_attr()->erase("half_pixel_centers");
+    (*resize.mutable_attr())["T"].set_type(DT_FLOAT);
+    references.emplace_back(
+        strings::StrCat(resize.name(), ":resized_images:0"),
+        strings::StrCat(resize.name(), ":output:0"));
+  }
+  for (const auto& reference : references) {
+    function_utils::ReplaceReferences(reference.first, reference.second,
+                                      function);
+  }
+  return references.size();
+}
+
+Status JpegDecodeResizeFusion::OptimizeAndCollectStats(
+    Cluster* cluster, const GrapplerItem& item, GraphDef* output,
+    OptimizationStats* stats) {
+  *output = item.graph;
+  // The fused function of each function, or "" if it has nothing to fuse.
+  absl::flat_hash_map<string, string> fused_functions;
+  for (NodeDef& node : *output->mutable_node()) {
+    if (!IsMapOp(node) || node.attr().count("f") == 0) continue;
+    const string function_name = node.attr().at("f").func().name();
+    auto fused = fused_functions.find(function_name);
+    if (fused == fused_functions.end()) {
+      string fused_name;
+      const int index = graph_utils::FindGraphFunctionWithName(
+          function_name, output->library());
+      if (index != -1) {
+        FunctionDef function = output->library().function(index);
+        if (FuseJpegDecodeAndResize(&function) > 0) {
+          graph_utils::SetUniqueGraphFunctionName(
+              strings::StrCat(kFusedFunctionPrefix, function_name),
+              output->mutable_library(), &function);
+          fused_name = function.signature().name();
+          *output->mutable_library()->add_function() = std::move(function);
+        }
+      }
+      fused = fused_functions.emplace(function_name, fused_name).first;
+    }
+    if (fused->second.empty()) continue;
+    (*node.mutable_attr())["f"].mutable_func()->set_name(fused->second);
+    stats->num_changes++;
+  }
+  return Status::OK();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(JpegDecodeResizeFusion,
+                            "jpeg_decode_resize_fusion");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,58 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_JPEG_DECODE_RESIZE_FUSION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_JPEG_DECODE_RESIZE_FUSION_H_
+
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Replaces each `ResizeBilinear(ExpandDims(DecodeJpeg(contents), 0), size)`
+// in `function`, where `size` is a constant or an argument, with
+// `ExpandDims(DecodeAndResizeJpeg(contents, size), 0)`. Returns the number of
+// replaced resizes.
+int FuseJpegDecodeAndResize(FunctionDef* function);
+
+// This optimization fuses the decoding and the bilinear resizing of JPEG
+// images in the functions of map datasets (see `FuseJpegDecodeAndResize()`).
+// The fused op decodes large images at a fraction of their size, which is
+// much faster but gives slightly different results, so the optimization is
+// only applied when it is opted into.
+class JpegDecodeResizeFusion : public TFDataOptimizerBase {
+ public:
+  JpegDecodeResizeFusion() = default;
+  ~JpegDecodeResizeFusion() override = default;
+
+  string name() const override { return "jpeg_decode_resize_fusion"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return Status::OK();
+  }
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_JPEG_DECODE_RESIZE_FUSION_H_
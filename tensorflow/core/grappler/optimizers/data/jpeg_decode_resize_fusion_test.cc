@@ -0,0 +1,148 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/jpeg_decode_resize_fusion.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeMapNode;
+using test::function::NDef;
+using FDH = FunctionDefHelper;
+
+// Returns a function that decodes a JPEG image with `ratio`, resizes it to
+// 8x8 as `tf.image.resize` does.
+FunctionDef DecodeAndResize(const string& name, int ratio) {
+  return FDH::Create(
+      name, {"contents: string"}, {"image: float"}, {},
+      {{{"size"},
+        "Const",
+        {},
+        {{"value", test::AsTensor<int32>({8, 8})}, {"dtype", DT_INT32}}},
+       {{"dim"}, "Const", {}, {{"value", 0}, {"dtype", DT_INT32}}},
+       {{"decode"},
+        "DecodeJpeg",
+        {"contents"},
+        {{"channels", 3}, {"ratio", ratio}}},
+       {{"expand_dims"},
+        "ExpandDims",
+        {"decode:image:0", "dim:output:0"},
+        {{"T", DT_UINT8}, {"Tdim", DT_INT32}}},
+       {{"resize"},
+        "ResizeBilinear",
+        {"expand_dims:output:0", "size:output:0"},
+        {{"T", DT_UINT8}, {"half_pixel_centers", true}}},
+       {{"squeeze"},
+        "Squeeze",
+        {"resize:resized_images:0"},
+        {{"T", DT_FLOAT}, {"squeeze_dims", gtl::ArraySlice<int>{0}}}}},
+      {{"image", "squeeze:output:0"}});
+}
+
+TEST(JpegDecodeResizeFusionTest, FusesDecodeAndResize) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("files", "Const", {}, {{"value", "a.jpg"}, {"dtype", DT_STRING}}),
+       NDef("dataset", "TensorSliceDataset", {"files"}, {}),
+       MakeMapNode("map", "dataset", "DecodeAndResize"),
+       MakeMapNode("map_2", "map", "DecodeAndResize")},
+      {DecodeAndResize("DecodeAndResize", /*ratio=*/1)});
+
+  JpegDecodeResizeFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  const string& function_name =
+      output.node(graph_utils::FindGraphNodeWithName("map", output))
+          .attr()
+          .at("f")
+          .func()
+          .name();
+  EXPECT_EQ("fused_jpeg_decode_resize_DecodeAndResize", function_name);
+  // The function is fused once.
+  EXPECT_EQ(
+      function_name,
+      output.node(graph_utils::FindGraphNodeWithName("map_2", output))
+          .attr()
+          .at("f")
+          .func()
+          .name());
+  ASSERT_EQ(2, output.library().function_size());
+  ASSERT_TRUE(graph_utils::ContainsGraphFunctionWithName("DecodeAndResize",
+                                                         output.library()));
+  const FunctionDef& function = output.library().function(
+      graph_utils::FindGraphFunctionWithName(function_name, output.library()));
+
+  const NodeDef& decode = function.node_def(
+      function_utils::FindFunctionNodeWithName("decode", function));
+  EXPECT_EQ("DecodeAndResizeJpeg", decode.op());
+  ASSERT_EQ(2, decode.input_size());
+  EXPECT_EQ("contents", decode.input(0));
+  EXPECT_EQ("size:output:0", decode.input(1));
+  EXPECT_EQ(0, decode.attr().count("ratio"));
+  EXPECT_EQ(3, decode.attr().at("channels").i());
+  EXPECT_TRUE(decode.attr().at("half_pixel_centers").b());
+
+  const NodeDef& expand_dims = function.node_def(
+      function_utils::FindFunctionNodeWithName("expand_dims", function));
+  EXPECT_EQ(DT_FLOAT, expand_dims.attr().at("T").type());
+  const NodeDef& resize = function.node_def(
+      function_utils::FindFunctionNodeWithName("resize", function));
+  EXPECT_EQ("Identity", resize.op());
+  ASSERT_EQ(1, resize.input_size());
+  EXPECT_EQ("expand_dims:output:0", resize.input(0));
+  EXPECT_EQ(0, resize.attr().count("half_pixel_centers"));
+  const NodeDef& squeeze = function.node_def(
+      function_utils::FindFunctionNodeWithName("squeeze", function));
+  EXPECT_EQ("resize:output:0", squeeze.input(0));
+}
+
+TEST(JpegDecodeResizeFusionTest, DoesNotFuseScaledDecoding) {
+  FunctionDef function = DecodeAndResize("DecodeAndResize", /*ratio=*/2);
+  EXPECT_EQ(0, FuseJpegDecodeAndResize(&function));
+}
+
+TEST(JpegDecodeResizeFusionTest, DoesNotFuseOtherUsesOfTheImage) {
+  FunctionDef function = DecodeAndResize("DecodeAndResize", /*ratio=*/1);
+  *function.add_node_def() =
+      NDef("shape", "Shape", {"decode:image:0"}, {{"T", DT_UINT8}});
+  EXPECT_EQ(0, FuseJpegDecodeAndResize(&function));
+}
+
+TEST(JpegDecodeResizeFusionTest, DoesNotFuseComputedSizes) {
+  FunctionDef function = DecodeAndResize("DecodeAndResize", /*ratio=*/1);
+  // A computed size could depend on the decoded image.
+  for (NodeDef& node : *function.mutable_node_def()) {
+    if (node.name() == "resize") node.set_input(1, "shape:output:0");
+  }
+  *function.add_node_def() =
+      NDef("shape", "Shape", {"size:output:0"}, {{"T", DT_INT32}});
+  EXPECT_EQ(0, FuseJpegDecodeAndResize(&function));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,565 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <algorithm>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kBatchDataset[] = "BatchDataset";
+constexpr char kBatchDatasetV2[] = "BatchDatasetV2";
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDatasetV2[] = "ParallelMapDatasetV2";
+constexpr char kOutputShapes[] = "output_shapes";
+constexpr char kOutputTypes[] = "output_types";
+constexpr char kShapesAttr[] = "_output_shapes";
+
+// Vectorization saves the overhead of all but one function invocation per
+// batch, and it moves the work of the function after the batching. For
+// batches of a single element, this only adds the cost of rewriting the
+// function.
+constexpr int64 kMinBatchSizeToVectorize = 2;
+
+// Ops whose outputs are computed elementwise from their inputs, which are
+// broadcast against each other.
+const auto* kElementwiseOps = new absl::flat_hash_set<string>({
+    "Abs",
+    "Acos",
+    "Add",
+    "AddV2",
+    "AsString",
+    "Asin",
+    "Atan",
+    "BitwiseAnd",
+    "BitwiseOr",
+    "BitwiseXor",
+    "Cast",
+    "Ceil",
+    "Cos",
+    "DecodeBase64",
+    "Div",
+    "DivNoNan",
+    "EncodeBase64",
+    "Equal",
+    "Erf",
+    "Exp",
+    "Expm1",
+    "Floor",
+    "FloorDiv",
+    "FloorMod",
+    "Greater",
+    "GreaterEqual",
+    "Identity",
+    "IsFinite",
+    "IsInf",
+    "IsNan",
+    "Less",
+    "LessEqual",
+    "Log",
+    "Log1p",
+    "LogicalAnd",
+    "LogicalNot",
+    "LogicalOr",
+    "Maximum",
+    "Minimum",
+    "Mod",
+    "Mul",
+    "Neg",
+    "NotEqual",
+    "Pow",
+    "RealDiv",
+    "Reciprocal",
+    "Relu",
+    "Relu6",
+    "Round",
+    "Rsqrt",
+    "SelectV2",
+    "Sigmoid",
+    "Sign",
+    "Sin",
+    "Sqrt",
+    "Square",
+    "SquaredDifference",
+    "StaticRegexFullMatch",
+    "StaticRegexReplace",
+    "StringLength",
+    "StringLower",
+    "StringStrip",
+    "StringToHashBucket",
+    "StringToHashBucketFast",
+    "StringToHashBucketStrong",
+    "StringToNumber",
+    "StringUpper",
+    "Sub",
+    "Tan",
+    "Tanh",
+    "TruncateDiv",
+    "TruncateMod",
+    "UnicodeScript",
+});
+
+// Ops that are elementwise in their first input, and whose other inputs are
+// scalars that must be the same for all elements.
+const auto* kElementwiseInFirstInputOps = new absl::flat_hash_set<string>({
+    "RegexFullMatch",
+    "RegexReplace",
+});
+
+// The rank of a tensor computed by the function, and whether it differs
+// between the elements of a batch.
+struct TensorInfo {
+  bool batched = false;
+  // -1 if unknown.
+  int rank = -1;
+  // -1 if unknown.
+  int64 num_elements = -1;
+};
+
+TensorInfo BatchedTensor(int rank) {
+  TensorInfo info;
+  info.batched = true;
+  info.rank = rank;
+  return info;
+}
+
+TensorInfo ConstTensor(const TensorShapeProto& shape) {
+  TensorInfo info;
+  if (shape.unknown_rank()) return info;
+  info.rank = shape.dim_size();
+  info.num_elements = 1;
+  for (const auto& dim : shape.dim()) {
+    info.num_elements *= dim.size();
+  }
+  return info;
+}
+
+// Returns the output of an op that broadcasts `inputs` against each other.
+//
+// Broadcasting aligns the trailing dimensions of its inputs, so the batch
+// dimensions of batched inputs only line up if all batched inputs have the
+// same rank and the inputs that are the same for all elements have at most
+// that rank.
+Status Broadcast(const NodeDef& node, const std::vector<TensorInfo>& inputs,
+                 TensorInfo* output) {
+  int batched_rank = -1;
+  for (const TensorInfo& input : inputs) {
+    if (!input.batched) continue;
+    if (input.rank < 0) {
+      return errors::InvalidArgument("The rank of an input of ", node.name(),
+                                     " is unknown");
+    }
+    if (batched_rank >= 0 && input.rank != batched_rank) {
+      return errors::InvalidArgument("The inputs of ", node.name(),
+                                     " have ranks ", batched_rank, " and ",
+                                     input.rank);
+    }
+    batched_rank = input.rank;
+  }
+  for (const TensorInfo& input : inputs) {
+    if (input.batched) continue;
+    if (input.rank < 0 || input.rank > batched_rank) {
+      return errors::InvalidArgument(
+          "An input of ", node.name(), " that is the same for all elements "
+          "has an unknown rank or a higher rank than its batched inputs");
+    }
+  }
+  *output = BatchedTensor(batched_rank);
+  return Status::OK();
+}
+
+// Computes the outputs of `node`, at least one of whose `inputs` is batched.
+// Outputs are keyed by their `<output arg>:<index>` suffix.
+Status VectorizeNode(const NodeDef& node, const std::vector<TensorInfo>& inputs,
+                     const FunctionLibraryDefinition& library,
+                     absl::flat_hash_map<string, TensorInfo>* outputs) {
+  const string& op = node.op();
+  if (kElementwiseOps->contains(op)) {
+    const OpDef* op_def;
+    TF_RETURN_IF_ERROR(library.LookUpOpDef(op, &op_def));
+    TensorInfo output;
+    TF_RETURN_IF_ERROR(Broadcast(node, inputs, &output));
+    (*outputs)[strings::StrCat(op_def->output_arg(0).name(), ":0")] = output;
+    return Status::OK();
+  }
+  if (kElementwiseInFirstInputOps->contains(op)) {
+    for (int i = 1; i < inputs.size(); ++i) {
+      if (inputs[i].batched) {
+        return errors::Unimplemented("Input ", i, " of ", node.name(),
+                                     " differs between elements");
+      }
+    }
+    (*outputs)["output:0"] = inputs[0];
+    return Status::OK();
+  }
+  if (op == "StringJoin") {
+    // Unlike broadcasting, the inputs must have the same shape or be scalars.
+    int batched_rank = -1;
+    for (const TensorInfo& input : inputs) {
+      if (input.batched) {
+        if (input.rank < 0 ||
+            (batched_rank >= 0 && input.rank != batched_rank)) {
+          return errors::InvalidArgument(
+              "The batched inputs of ", node.name(),
+              " have different or unknown ranks");
+        }
+        batched_rank = input.rank;
+      } else if (input.rank != 0) {
+        return errors::InvalidArgument(
+            "An input of ", node.name(), " that is the same for all elements "
+            "is not a scalar");
+      }
+    }
+    (*outputs)["output:0"] = BatchedTensor(batched_rank);
+    return Status::OK();
+  }
+  if (op == "DecodeRaw") {
+    if (inputs[0].rank < 0) {
+      return errors::InvalidArgument("The rank of the input of ", node.name(),
+                                     " is unknown");
+    }
+    (*outputs)["output:0"] = BatchedTensor(inputs[0].rank + 1);
+    return Status::OK();
+  }
+  if (op == "ParseExampleV2") {
+    // Inputs are `serialized`, `names`, `sparse_keys`, `dense_keys`,
+    // `ragged_keys` and `dense_defaults`. Sparse and ragged features would
+    // need their indices and splits to be merged across the batch.
+    if (node.attr().at("num_sparse").i() > 0 ||
+        node.attr().at("ragged_value_types").list().type_size() > 0) {
+      return errors::Unimplemented(node.name(),
+                                   " parses sparse or ragged features");
+    }
+    for (int i = 1; i < inputs.size(); ++i) {
+      if (inputs[i].batched) {
+        return errors::Unimplemented("Input ", i, " of ", node.name(),
+                                     " differs between elements");
+      }
+    }
+    if (inputs[0].rank < 0 || inputs[1].num_elements != 0) {
+      return errors::InvalidArgument(
+          node.name(), " has example names or inputs of unknown rank");
+    }
+    const auto& dense_shapes = node.attr().at("dense_shapes").list().shape();
+    for (int i = 0; i < dense_shapes.size(); ++i) {
+      // Dense features of unknown length are padded to the longest feature
+      // in the batch, which would turn the batching of mismatched elements
+      // into padding.
+      if (!PartialTensorShape(dense_shapes[i]).IsFullyDefined()) {
+        return errors::InvalidArgument(
+            "Dense feature ", i, " of ", node.name(), " has shape ",
+            PartialTensorShape(dense_shapes[i]).DebugString());
+      }
+      (*outputs)[strings::StrCat("dense_values:", i)] =
+          BatchedTensor(inputs[0].rank + dense_shapes[i].dim_size());
+    }
+    return Status::OK();
+  }
+  return errors::Unimplemented(node.name(), " uses op ", op,
+                               ", which cannot be vectorized");
+}
+
+// Returns the metrics label of the outcome of vectorizing a function.
+string VectorizationOutcome(const Status& status) {
+  switch (status.code()) {
+    case error::OK:
+      return "vectorized";
+    case error::UNIMPLEMENTED:
+      return "unsupported_op";
+    case error::INVALID_ARGUMENT:
+      return "incompatible_shapes";
+    case error::FAILED_PRECONDITION:
+      return "same_for_all_elements";
+    default:
+      return "error";
+  }
+}
+
+// Sets `*ranks` to the ranks of the elements produced by `input_node`, which
+// must all have the same shape for batching to commute with the function.
+Status GetElementRanks(const NodeDef& input_node, std::vector<int>* ranks) {
+  const AttrValue* shapes = gtl::FindOrNull(input_node.attr(), kOutputShapes);
+  if (!shapes) {
+    return errors::InvalidArgument("The input ", input_node.name(),
+                                   " has no output shapes");
+  }
+  for (const auto& shape : shapes->list().shape()) {
+    PartialTensorShape element_shape(shape);
+    if (!element_shape.IsFullyDefined()) {
+      return errors::InvalidArgument(
+          "The input ", input_node.name(), " produces elements of shape ",
+          element_shape.DebugString(), ", which may differ between elements");
+    }
+    ranks->push_back(element_shape.dims());
+  }
+  return Status::OK();
+}
+
+// Cost model: vectorizes unless the batch size is known to be too small to
+// amortize the function invocation.
+bool ShouldVectorize(const NodeDef& batch_node, const MutableGraphView& graph) {
+  NodeDef* batch_size_node = graph_utils::GetInputNode(batch_node, graph, 1);
+  int64 batch_size;
+  if (batch_size_node->op() == "Const" &&
+      graph_utils::GetScalarConstNodeValue(*batch_size_node, &batch_size)
+          .ok()) {
+    return batch_size >= kMinBatchSizeToVectorize;
+  }
+  return true;
+}
+
+// Returns a copy of `function` without the element shapes recorded in its
+// attributes, which do not hold for batches.
+FunctionDef MakeVectorizedFunction(const FunctionDef& function,
+                                   FunctionDefLibrary* library) {
+  FunctionDef vectorized = function;
+  graph_utils::SetUniqueGraphFunctionName(
+      strings::StrCat("vectorized_", function.signature().name()), library,
+      &vectorized);
+  for (auto& arg_attr : *vectorized.mutable_arg_attr()) {
+    arg_attr.second.mutable_attr()->erase(kShapesAttr);
+  }
+  for (auto& node : *vectorized.mutable_node_def()) {
+    node.mutable_attr()->erase(kShapesAttr);
+  }
+  return vectorized;
+}
+
+}  // namespace
+
+Status CheckVectorizable(const FunctionDef& function,
+                         const FunctionLibraryDefinition& library,
+                         const std::vector<int>& element_ranks) {
+  const auto& input_args = function.signature().input_arg();
+  if (input_args.size() < element_ranks.size()) {
+    return errors::InvalidArgument("Function ", function.signature().name(),
+                                   " takes ", input_args.size(),
+                                   " arguments, expected at least ",
+                                   element_ranks.size());
+  }
+  // Tensors computed so far, keyed by how the function refers to them.
+  absl::flat_hash_map<string, TensorInfo> tensors;
+  for (int i = 0; i < input_args.size(); ++i) {
+    tensors[input_args[i].name()] = i < element_ranks.size()
+                                        ? BatchedTensor(element_ranks[i])
+                                        : TensorInfo();
+  }
+  // Nodes by name, mapped to whether all their outputs are the same for all
+  // elements.
+  absl::flat_hash_map<string, bool> visited;
+
+  // Looks up the tensor `name`. Returns NOT_FOUND if the node that computes it
+  // has not been visited yet.
+  auto lookup = [&](const string& name, TensorInfo* info) -> Status {
+    auto it = tensors.find(name);
+    if (it != tensors.end()) {
+      *info = it->second;
+      return Status::OK();
+    }
+    auto node_it = visited.find(name.substr(0, name.find(':')));
+    if (node_it == visited.end()) {
+      return errors::NotFound(name);
+    }
+    if (!node_it->second) {
+      return errors::Unimplemented("Output ", name, " cannot be vectorized");
+    }
+    *info = TensorInfo();
+    return Status::OK();
+  };
+
+  // Visits the nodes in topological order, which the function body need not
+  // be in.
+  int num_visited;
+  do {
+    num_visited = visited.size();
+    for (const NodeDef& node : function.node_def()) {
+      if (visited.contains(node.name())) continue;
+      std::vector<TensorInfo> inputs;
+      bool ready = true;
+      for (const string& input : node.input()) {
+        if (IsControlInput(input)) continue;
+        TensorInfo info;
+        Status s = lookup(input, &info);
+        if (errors::IsNotFound(s)) {
+          ready = false;
+          break;
+        }
+        TF_RETURN_IF_ERROR(s);
+        inputs.push_back(info);
+      }
+      if (!ready) continue;
+
+      const bool batched = std::any_of(
+          inputs.begin(), inputs.end(),
+          [](const TensorInfo& input) { return input.batched; });
+      if (!batched) {
+        // The node computes the same values for all elements, which is only
+        // correct once per batch if it is deterministic.
+        const OpDef* op_def;
+        TF_RETURN_IF_ERROR(library.LookUpOpDef(node.op(), &op_def));
+        if (op_def->is_stateful()) {
+          return errors::Unimplemented(node.name(), " uses stateful op ",
+                                       node.op());
+        }
+        if (node.op() == "Const") {
+          tensors[strings::StrCat(node.name(), ":output:0")] =
+              ConstTensor(node.attr().at("value").tensor().tensor_shape());
+        }
+        visited[node.name()] = true;
+        continue;
+      }
+      absl::flat_hash_map<string, TensorInfo> outputs;
+      TF_RETURN_IF_ERROR(VectorizeNode(node, inputs, library, &outputs));
+      for (auto& output : outputs) {
+        tensors[strings::StrCat(node.name(), ":", output.first)] =
+            output.second;
+      }
+      visited[node.name()] = false;
+    }
+  } while (visited.size() > num_visited);
+  if (visited.size() < function.node_def_size()) {
+    return errors::InvalidArgument("Function ", function.signature().name(),
+                                   " has nodes with unknown inputs");
+  }
+
+  for (const auto& ret : function.ret()) {
+    TensorInfo info;
+    TF_RETURN_IF_ERROR(lookup(ret.second, &info));
+    if (!info.batched) {
+      return errors::FailedPrecondition(
+          "Output ", ret.first, " is the same for all elements");
+    }
+  }
+  return Status::OK();
+}
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != kBatchDataset && node.op() != kBatchDatasetV2) {
+      continue;
+    }
+    // Use a more descriptive variable name now that we know the node type.
+    const NodeDef& batch_node = node;
+    NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node->op() != kMapDataset &&
+        map_node->op() != kParallelMapDatasetV2) {
+      continue;
+    }
+    if (graph.GetFanouts(*map_node, /*include_controlled_nodes=*/true).size() !=
+            1 ||
+        !ShouldVectorize(batch_node, graph)) {
+      continue;
+    }
+    const NodeDef* input_node = graph_utils::GetInputNode(*map_node, graph);
+    const auto& function_name = map_node->attr().at("f").func().name();
+    const FunctionDef* function = function_library.Find(function_name);
+    if (!function) continue;
+
+    std::vector<int> element_ranks;
+    Status s = GetElementRanks(*input_node, &element_ranks);
+    if (s.ok()) {
+      s = CheckVectorizable(*function, function_library, element_ranks);
+    }
+    metrics::RecordTFDataVectorization(VectorizationOutcome(s));
+    if (!s.ok()) {
+      VLOG(1) << "Function " << function_name << " is not vectorized: "
+              << s.error_message();
+      continue;
+    }
+
+    const FunctionDef vectorized_function =
+        MakeVectorizedFunction(*function, output->mutable_library());
+    *output->mutable_library()->add_function() = vectorized_function;
+
+    // Batches the inputs of the map instead of its outputs.
+    NodeDef new_batch_node = batch_node;
+    graph_utils::SetUniqueGraphNodeName(batch_node.op(), graph.graph(),
+                                        &new_batch_node);
+    new_batch_node.set_input(0, map_node->input(0));
+    graph_utils::CopyAttribute(kOutputTypes, *input_node, &new_batch_node);
+    TensorShapeProto::Dim batch_dim;
+    batch_dim.set_size(-1);
+    const auto& output_shapes = batch_node.attr().at(kOutputShapes).list();
+    if (output_shapes.shape_size() > 0 &&
+        output_shapes.shape(0).dim_size() > 0) {
+      batch_dim = output_shapes.shape(0).dim(0);
+    }
+    auto* batch_shapes =
+        (*new_batch_node.mutable_attr())[kOutputShapes].mutable_list();
+    batch_shapes->clear_shape();
+    for (const auto& shape :
+         input_node->attr().at(kOutputShapes).list().shape()) {
+      TensorShapeProto* batched_shape = batch_shapes->add_shape();
+      *batched_shape->add_dim() = batch_dim;
+      for (const auto& dim : shape.dim()) {
+        *batched_shape->add_dim() = dim;
+      }
+    }
+
+    NodeDef new_map_node = *map_node;
+    graph_utils::SetUniqueGraphNodeName(map_node->op(), graph.graph(),
+                                        &new_map_node);
+    new_map_node.set_input(0, new_batch_node.name());
+    (*new_map_node.mutable_attr())["f"].mutable_func()->set_name(
+        vectorized_function.signature().name());
+    for (auto key : {kOutputShapes, kOutputTypes}) {
+      graph_utils::CopyAttribute(key, batch_node, &new_map_node);
+    }
+
+    // Adding nodes may invalidate `map_node` and `input_node`.
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    graph.AddNode(std::move(new_batch_node));
+    NodeDef* vectorized_map_node = graph.AddNode(std::move(new_map_node));
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(batch_node.name(), vectorized_map_node->name()));
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return Status::OK();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,68 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_VECTORIZATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_VECTORIZATION_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Returns OK if `function` computes a batch of its results when each of its
+// first `element_ranks.size()` arguments, whose per-element ranks are
+// `element_ranks`, is replaced by a batch of such arguments. The remaining
+// arguments are captured inputs, which are the same for all elements.
+//
+// This holds if every op that depends on a batched argument treats the batch
+// dimension like any other leading dimension: elementwise and broadcasting
+// ops, string ops, `DecodeRaw` and `ParseExampleV2` with dense features only.
+// Otherwise, returns UNIMPLEMENTED for ops that cannot be vectorized,
+// INVALID_ARGUMENT for inputs whose shapes would broadcast differently once
+// batched and FAILED_PRECONDITION for results that are the same for all
+// elements.
+Status CheckVectorizable(const FunctionDef& function,
+                         const FunctionLibraryDefinition& library,
+                         const std::vector<int>& element_ranks);
+
+// This optimization rewrites `map(f).batch(n)` into `batch(n).map(f)` when
+// `f` can be applied to a whole batch at once (see `CheckVectorizable()`),
+// which invokes `f` once per batch instead of once per element.
+class MapVectorization : public TFDataOptimizerBase {
+ public:
+  MapVectorization() = default;
+  ~MapVectorization() override = default;
+
+  string name() const override { return "map_vectorization"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return Status::OK();
+  }
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_VECTORIZATION_H_
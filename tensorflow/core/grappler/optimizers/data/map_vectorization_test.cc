@@ -0,0 +1,180 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeBatchV2Node;
+using graph_tests_utils::MakeMapNode;
+using test::function::NDef;
+using FDH = FunctionDefHelper;
+
+// Returns a graph that maps `function_name` over a range whose elements have
+// shape `element_shape` and batches the results by `batch_size`.
+GraphDef MakeMapThenBatchGraph(const string& function_name,
+                               const PartialTensorShape& element_shape,
+                               int64 batch_size) {
+  return test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT32}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT32}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT32}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"},
+            {{"output_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                   element_shape}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}}),
+       MakeMapNode("map", "range", function_name),
+       NDef("batch_size", "Const", {},
+            {{"value", batch_size}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", false}, {"dtype", DT_BOOL}}),
+       MakeBatchV2Node("batch", "map", "batch_size", "drop_remainder",
+                       /*parallel_copy=*/false)},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+          test::function::XTimesFour(),
+      });
+}
+
+TEST(MapVectorizationTest, VectorizesElementwiseFunction) {
+  GrapplerItem item;
+  item.graph = MakeMapThenBatchGraph("XTimesTwo", PartialTensorShape({}),
+                                     /*batch_size=*/4);
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+
+  const NodeDef& batch_node =
+      output.node(graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  EXPECT_EQ("range", batch_node.input(0));
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithOp("MapDataset", output));
+  EXPECT_EQ(batch_node.name(), map_node.input(0));
+  const string& function_name = map_node.attr().at("f").func().name();
+  EXPECT_EQ("vectorized_XTimesTwo", function_name);
+  EXPECT_TRUE(graph_utils::ContainsGraphFunctionWithName(function_name,
+                                                         output.library()));
+
+  const auto& batch_shapes = batch_node.attr().at("output_shapes").list();
+  ASSERT_EQ(1, batch_shapes.shape_size());
+  EXPECT_EQ("[?]", PartialTensorShape(batch_shapes.shape(0)).DebugString());
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeFunctionCalls) {
+  GrapplerItem item;
+  item.graph = MakeMapThenBatchGraph("XTimesFour", PartialTensorShape({}),
+                                     /*batch_size=*/4);
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeElementsOfUnknownShape) {
+  GrapplerItem item;
+  item.graph = MakeMapThenBatchGraph("XTimesTwo", PartialTensorShape({-1}),
+                                     /*batch_size=*/4);
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeBatchesOfOneElement) {
+  GrapplerItem item;
+  item.graph = MakeMapThenBatchGraph("XTimesTwo", PartialTensorShape({}),
+                                     /*batch_size=*/1);
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+}
+
+class CheckVectorizableTest : public ::testing::Test {
+ protected:
+  Status Check(const FunctionDef& function,
+               const std::vector<int>& element_ranks) {
+    return CheckVectorizable(function, library_, element_ranks);
+  }
+
+  FunctionLibraryDefinition library_{OpRegistry::Global(),
+                                     FunctionDefLibrary()};
+};
+
+TEST_F(CheckVectorizableTest, BroadcastsInputsOfEqualRank) {
+  const FunctionDef add = FDH::Define(
+      "AddXY", {"x: float", "y: float"}, {"z: float"}, {},
+      {{{"z"}, "Add", {"x", "y"}, {{"T", DT_FLOAT}}}});
+  TF_EXPECT_OK(Check(add, {1, 1}));
+  // The batch dimension of `y` would line up with the last dimension of `x`.
+  EXPECT_TRUE(errors::IsInvalidArgument(Check(add, {1, 0})));
+  // `y` is a captured input of unknown rank.
+  EXPECT_TRUE(errors::IsInvalidArgument(Check(add, {0})));
+}
+
+TEST_F(CheckVectorizableTest, VectorizesStringOps) {
+  const FunctionDef decode = FDH::Define(
+      "Decode", {"x: string"}, {"y: float"}, {},
+      {{{"lower"}, "StringLower", {"x"}, {}},
+       {{"y"},
+        "DecodeRaw",
+        {"lower"},
+        {{"out_type", DT_FLOAT}, {"little_endian", true}}}});
+  TF_EXPECT_OK(Check(decode, {0}));
+}
+
+TEST_F(CheckVectorizableTest, RejectsStatefulOps) {
+  const FunctionDef add_noise = FDH::Define(
+      "AddNoise", {"x: float"}, {"y: float"}, {},
+      {{{"shape"},
+        "Const",
+        {},
+        {{"value", test::AsScalar<int32>(0)}, {"dtype", DT_INT32}}},
+       {{"noise"},
+        "RandomUniform",
+        {"shape"},
+        {{"T", DT_INT32}, {"dtype", DT_FLOAT}}},
+       {{"y"}, "Add", {"x", "noise"}, {{"T", DT_FLOAT}}}});
+  EXPECT_TRUE(errors::IsUnimplemented(Check(add_noise, {0})));
+}
+
+TEST_F(CheckVectorizableTest, RejectsOutputsThatDoNotDependOnElements) {
+  const FunctionDef one = FDH::Define(
+      "One", {"x: float"}, {"y: float"}, {},
+      {{{"y"},
+        "Const",
+        {},
+        {{"value", test::AsScalar<float>(1.0)}, {"dtype", DT_FLOAT}}}});
+  EXPECT_TRUE(errors::IsFailedPrecondition(Check(one, {0})));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -35,7 +35,7 @@ using ConfigMap =
     std::map<string, tensorflow::RewriterConfig_CustomGraphOptimizer>;
 
 // tf.data optimizations, in the order we want to perform them.
-constexpr std::array<const char*, 16> kTFDataOptimizations = {
+constexpr std::array<const char*, 18> kTFDataOptimizations = {
     "noop_elimination",
     "disable_intra_op_parallelism",
     "use_private_thread_pool",
@@ -43,6 +43,8 @@ constexpr std::array<const char*, 16> kTFDataOptimizations = {
     "map_fusion",
     "filter_fusion",
     "map_and_filter_fusion",
+    "jpeg_decode_resize_fusion",
+    "map_vectorization",
     "map_parallelization",
     "map_and_batch_fusion",
     "batch_parallelization",
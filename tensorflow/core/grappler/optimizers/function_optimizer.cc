@@ -47,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_node_util.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/grappler/graph_view.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/utils.h"
@@ -66,6 +67,14 @@ constexpr const char* const kNoSpecializeAttr = "_nospecialize";
 constexpr const char* const kGrapplerSpecializedFuncAttr =
     "_GrapplerSpecializedFunc";
 
+// Shapes of the function arguments, used by the shape inference of `_Arg`.
+constexpr const char* const kOutputShapesAttr = "_output_shapes";
+
+// Maximum number of input shapes a function is specialized for. Calls with
+// other shapes are specialized without their shapes, so that functions called
+// with many different shapes do not bloat the function library.
+constexpr int kMaxShapeSpecializationsPerFunction = 8;
+
 // There are two ways of calling a Tensorflow function:
 //
 // 1. Direct function call: node.op() is the name of the function.
@@ -151,8 +160,8 @@ bool MarkedNoSpecialize(const FunctionDef& fdef) {
   return TryGetNodeAttr(attr, kNoSpecializeAttr, &nospecialize) && nospecialize;
 }
 
-// Specialized function instantiation type parameters, body parameters, and
-// const inputs.
+// Specialized function instantiation type parameters, body parameters, const
+// inputs, and fully defined input shapes.
 struct FunctionSpecializationSignature {
   // Currently we do not support functions with tensor lists as inputs or
   // outputs, so caller node input/output ports always match function
@@ -166,13 +175,15 @@ struct FunctionSpecializationSignature {
   absl::flat_hash_map<string, DataType> type_parameters;
   absl::flat_hash_map<string, AttrValue> body_parameters;
   absl::flat_hash_map<InputPort, string> const_inputs;
+  absl::flat_hash_map<InputPort, std::vector<int64>> input_shapes;
 
   bool operator==(const FunctionSpecializationSignature& other) const {
     bool equals = func_name == other.func_name &&
                   is_in_fetch_set == other.is_in_fetch_set &&
                   active_outputs == other.active_outputs &&
                   type_parameters == other.type_parameters &&
-                  const_inputs == other.const_inputs;
+                  const_inputs == other.const_inputs &&
+                  input_shapes == other.input_shapes;
 
     if (!equals) return false;
 
@@ -201,7 +212,8 @@ struct FunctionSpecializationSignature {
     hashes.reserve(s.active_outputs.size()         //
                    + s.type_parameters.size() * 2  //
                    + s.body_parameters.size() * 2  //
-                   + s.const_inputs.size() * 2);
+                   + s.const_inputs.size() * 2     //
+                   + s.input_shapes.size() * 2);
 
     absl::c_transform(s.active_outputs, std::back_inserter(hashes),
                       hash<OutputPort>());
@@ -226,6 +238,12 @@ struct FunctionSpecializationSignature {
       hashes.push_back(Hash64(const_input.second));
     });
 
+    using InputShape = std::pair<const InputPort, std::vector<int64>>;
+    absl::c_for_each(s.input_shapes, [&hashes](const InputShape& input_shape) {
+      hashes.push_back(hash<InputPort>()(input_shape.first));
+      hashes.push_back(absl::Hash<std::vector<int64>>()(input_shape.second));
+    });
+
     // Combine all pre-computed hashes in a deterministic order.
     absl::c_sort(hashes);
     return H::combine_contiguous(std::move(base), hashes.data(), hashes.size());
@@ -258,12 +276,15 @@ class FunctionOptimizerContext {
  public:
   explicit FunctionOptimizerContext(const GrapplerItem& item,
                                     RewriterConfig::Toggle opt_level,
+                                    bool specialize_input_shapes,
                                     const GraphDef& graph)
       : item_(&item),
         opt_level_(opt_level),
         function_library_(OpRegistry::Global(), graph.library()),
         truly_const_nodes_(InferTrulyConstNodes(item, graph)),
-        graph_view_(&graph) {}
+        graph_view_(&graph) {
+    if (specialize_input_shapes) InferInputShapes(graph);
+  }
 
   const GrapplerItem& item() const { return *item_; }
 
@@ -304,6 +325,21 @@ class FunctionOptimizerContext {
     return gtl::FindWithDefault(truly_const_nodes_, name, nullptr);
   }
 
+  // Returns the statically inferred properties of the inputs of `node`, or
+  // nullptr if input shapes are not specialized or could not be inferred.
+  const std::vector<OpInfo::TensorProperties>* InputProperties(
+      const NodeDef& node) const {
+    if (graph_properties_ == nullptr ||
+        !graph_properties_->HasInputProperties(node.name())) {
+      return nullptr;
+    }
+    return &graph_properties_->GetInputProperties(node.name());
+  }
+
+  int NumShapeSpecializations(const string& func_name) const {
+    return gtl::FindWithDefault(num_shape_specializations_, func_name, 0);
+  }
+
   const FunctionSpecialization* FindFunctionSpecialization(
       const FunctionSpecializationSignature& sig) const {
     return gtl::FindOrNull(specialized_functions_, sig);
@@ -312,6 +348,7 @@ class FunctionOptimizerContext {
   void AddSpecializedFunction(const FunctionSpecializationSignature& sig,
                               const FunctionSpecialization& specialized_func) {
     specialized_functions_.emplace(sig, specialized_func);
+    if (!sig.input_shapes.empty()) ++num_shape_specializations_[sig.func_name];
   }
 
   void AddTensorMapping(const SafeTensorId& from, const SafeTensorId& to) {
@@ -340,6 +377,21 @@ class FunctionOptimizerContext {
   }
 
  private:
+  void InferInputShapes(const GraphDef& graph) {
+    shape_inference_item_ =
+        absl::make_unique<GrapplerItem>(item_->WithGraph(GraphDef(graph)));
+    graph_properties_ =
+        absl::make_unique<GraphProperties>(*shape_inference_item_);
+    Status status = graph_properties_->InferStatically(
+        /*assume_valid_feeds=*/false,
+        /*aggressive_shape_inference=*/false,
+        /*include_tensor_values=*/false);
+    if (!status.ok()) {
+      VLOG(2) << "Skip input shape specialization: " << status.error_message();
+      graph_properties_.reset();
+    }
+  }
+
   static absl::flat_hash_map<string, const NodeDef*> InferTrulyConstNodes(
       const GrapplerItem& item, const GraphDef& graph) {
     absl::flat_hash_set<absl::string_view> feed_nodes;
@@ -382,6 +434,13 @@ class FunctionOptimizerContext {
   // Use graph view to find active outputs of the function caller nodes.
   GraphView graph_view_;
 
+  // Shapes inferred in the graph, if function calls are specialized for their
+  // input shapes. The properties refer to the item.
+  std::unique_ptr<GrapplerItem> shape_inference_item_;
+  std::unique_ptr<GraphProperties> graph_properties_;
+  // Number of input shapes each function was specialized for.
+  absl::flat_hash_map<string, int> num_shape_specializations_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(FunctionOptimizerContext);
 };
 
@@ -433,6 +492,45 @@ bool HasTrulyConstInputs(const NodeDef& node,
   return absl::c_any_of(node.input(), is_truly_const);
 }
 
+// Returns true if the function argument `index` already has a fully defined
+// shape.
+bool HasFullyDefinedArgShape(const FunctionDef& func, int index) {
+  const auto it = func.arg_attr().find(index);
+  if (it == func.arg_attr().end()) return false;
+  const auto shapes = it->second.attr().find(kOutputShapesAttr);
+  return shapes != it->second.attr().end() &&
+         shapes->second.list().shape_size() == 1 &&
+         PartialTensorShape(shapes->second.list().shape(0)).IsFullyDefined();
+}
+
+// Returns the fully defined shapes of the non-const inputs of `func_node`, that
+// the function does not already know.
+absl::flat_hash_map<int, std::vector<int64>> GetSpecializableInputShapes(
+    const NodeDef& func_node, const FunctionDef& func,
+    const FunctionOptimizerContext& ctx) {
+  absl::flat_hash_map<int, std::vector<int64>> input_shapes;
+  const std::vector<OpInfo::TensorProperties>* props =
+      ctx.InputProperties(func_node);
+  if (props == nullptr) return input_shapes;
+
+  for (int i = 0; i < func_node.input_size(); ++i) {
+    const string& input = func_node.input(i);
+    if (IsControlInput(input)) break;
+    if (i >= static_cast<int>(props->size()) || ctx.IsTrulyConst(input)) {
+      continue;
+    }
+
+    const OpInfo::TensorProperties& prop = (*props)[i];
+    if (prop.dtype() == DT_RESOURCE || prop.dtype() == DT_VARIANT) continue;
+    const PartialTensorShape shape(prop.shape());
+    if (!shape.IsFullyDefined() || HasFullyDefinedArgShape(func, i)) continue;
+
+    const auto dims = shape.dim_sizes();
+    input_shapes[i].assign(dims.begin(), dims.end());
+  }
+  return input_shapes;
+}
+
 bool HasUnusedOutputs(const NodeDef& func_node, const FunctionDef& func,
                       const FunctionOptimizerContext& ctx) {
   // Functions with tensor list outputs are not supported right now, so the
@@ -664,9 +762,31 @@ Status InitializeFunctionSpecializationSignature(
     }
   }
 
+  sig->input_shapes = GetSpecializableInputShapes(func_node, func, ctx);
+
   return Status::OK();
 }
 
+// Sets the shapes of the function arguments that were specialized for the
+// shapes of the caller inputs. Arguments for the const inputs pushed down into
+// the function body are already removed from `specialized_func`.
+void PushDownInputShapes(const FunctionSpecializationSignature& signature,
+                         FunctionDef* specialized_func) {
+  for (const auto& input_shape : signature.input_shapes) {
+    const int input_port = input_shape.first;
+    int arg_index = input_port;
+    for (const auto& const_input : signature.const_inputs) {
+      if (const_input.first < input_port) --arg_index;
+    }
+
+    AttrValue shapes;
+    TensorShapeProto* shape = shapes.mutable_list()->add_shape();
+    for (int64 dim : input_shape.second) shape->add_dim()->set_size(dim);
+    (*(*specialized_func->mutable_arg_attr())[arg_index]
+          .mutable_attr())[kOutputShapesAttr] = std::move(shapes);
+  }
+}
+
 // Create a name for the function specialization. The name of the function, name
 // of the node instantiating it, and a Grappler item id should generate unique
 // function name. Meta optimizer might create multiple Grappler items for the
@@ -692,6 +812,17 @@ Status SpecializeFunction(const NodeDef& func_node, const FunctionDef& func,
   TF_RETURN_IF_ERROR(InitializeFunctionSpecializationSignature(
       func_node, func, func_instantiation_attr, *ctx, &signature));
 
+  // Past the limit, new input shapes are not specialized for.
+  if (!signature.input_shapes.empty() &&
+      ctx->FindFunctionSpecialization(signature) == nullptr &&
+      ctx->NumShapeSpecializations(signature.func_name) >=
+          kMaxShapeSpecializationsPerFunction) {
+    VLOG(2) << "Skip input shape specialization of " << signature.func_name
+            << ": already specialized for "
+            << kMaxShapeSpecializationsPerFunction << " shapes";
+    signature.input_shapes.clear();
+  }
+
   // Check if function was already specialized for identical context.
   const FunctionSpecialization* already_specialized =
       ctx->FindFunctionSpecialization(signature);
@@ -743,10 +874,13 @@ Status SpecializeFunction(const NodeDef& func_node, const FunctionDef& func,
     TF_RETURN_IF_ERROR(RemoveFunctionOutputs(remove, &item, &output_mapping));
   }
 
-  // TODO(ezhulenev): Push down known input shapes.
   FunctionDef specialized_func;
   TF_RETURN_IF_ERROR(MakeFunctionDef(item, flib, &specialized_func));
 
+  // Push down fully defined input shapes, so that the shape computations of
+  // the function body can be folded when it is optimized.
+  PushDownInputShapes(signature, &specialized_func);
+
   // Find a name for specialized function.
   const string specialized_func_name =
       SpecializedFunctionName(*ctx, func, func_node);
@@ -1441,7 +1575,8 @@ Status FunctionOptimizer::RunFunctionOptimizerPass(
                                          &graph_after_inlining));
 
   // Specialize function calls that we could not inline.
-  FunctionOptimizerContext ctx(item, opt_level_, graph_after_inlining);
+  FunctionOptimizerContext ctx(item, opt_level_, specialize_input_shapes_,
+                               graph_after_inlining);
 
   for (const NodeDef& node : graph_after_inlining.node()) {
     // Function specialization can modify optimized graph only by adding new
@@ -1467,9 +1602,10 @@ Status FunctionOptimizer::RunFunctionOptimizerPass(
 
     // Specialize it to its instantiation context if it has something worth
     // specializing.
-    const bool specialization_worthy = IsParametrized(*func) ||
-                                       HasTrulyConstInputs(node, ctx) ||
-                                       HasUnusedOutputs(node, *func, ctx);
+    const bool specialization_worthy =
+        IsParametrized(*func) || HasTrulyConstInputs(node, ctx) ||
+        HasUnusedOutputs(node, *func, ctx) ||
+        !GetSpecializableInputShapes(node, *func, ctx).empty();
 
     // Do not specialize if function has custom gradient or marked nospecialize.
     const string grad_func = ctx.function_library().FindGradient(func_name);
@@ -1478,7 +1614,6 @@ Status FunctionOptimizer::RunFunctionOptimizerPass(
         MarkedNoSpecialize(*func) || MarkedForXlaCompilation(node);
 
     if (specialization_worthy && !no_specialize) {
-      // TODO(ezhulenev): Specialize function call if input has a known shape.
       // Specialize function body for its instantiation attributes and inputs.
       Status status = SpecializeFunction(node, *func, &ctx, optimized_graph);
       if (!status.ok() && is_graph_modified()) {
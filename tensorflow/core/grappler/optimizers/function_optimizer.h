@@ -26,9 +26,14 @@ namespace grappler {
 // operations to make the overall graph more efficient.
 class FunctionOptimizer : public GraphOptimizer {
  public:
+  // If `specialize_input_shapes` is true, function calls are also specialized
+  // for the fully defined shapes of their inputs.
   explicit FunctionOptimizer(RewriterConfig::Toggle opt_level,
-                             bool lower_control_flow)
-      : opt_level_(opt_level), lower_control_flow_(lower_control_flow) {}
+                             bool lower_control_flow,
+                             bool specialize_input_shapes = false)
+      : opt_level_(opt_level),
+        lower_control_flow_(lower_control_flow),
+        specialize_input_shapes_(specialize_input_shapes) {}
   ~FunctionOptimizer() override = default;
 
   string name() const override { return "function_optimizer"; };
@@ -51,6 +56,7 @@ class FunctionOptimizer : public GraphOptimizer {
 
   RewriterConfig::Toggle opt_level_;
   bool lower_control_flow_;
+  bool specialize_input_shapes_;
 };
 
 }  // end namespace grappler
@@ -1601,6 +1601,120 @@ TEST_F(FunctionOptimizerTest, SpecializeFunctionPushDownConstInput) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(FunctionOptimizerTest, SpecializeFunctionForInputShapes) {
+  using test::function::NDef;
+
+  FunctionOptimizer optimizer(RewriterConfig::DEFAULT, true,
+                              /*specialize_input_shapes=*/true);
+
+  FunctionDef square_func = FunctionDefHelper::Create(
+      "MySquare", {"x:float"}, {"z:float"}, {},
+      {{{"output"}, "Mul", {"x", "x"}, {{"T", DT_FLOAT}}}},
+      /* Mapping between function returns and function node outputs. */
+      {{"z", "output:z:0"}});
+
+  // Mark MySquare as noinline.
+  (*square_func.mutable_attr())["_noinline"].set_b(true);
+  std::vector<FunctionDef> function_library = {square_func};
+
+  // 'y1' and 'y2' read inputs of the same known shape, and 'y3' an input of
+  // unknown shape.
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("x1", "Placeholder", {},
+            {{"dtype", DT_FLOAT}, {"shape", TensorShape({2, 3})}}, kDevice),
+       NDef("x2", "Placeholder", {},
+            {{"dtype", DT_FLOAT}, {"shape", TensorShape({2, 3})}}, kDevice),
+       NDef("x3", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("y1", "MySquare", {"x1"}, {}, kDevice),
+       NDef("y2", "MySquare", {"x2"}, {}, kDevice),
+       NDef("y3", "MySquare", {"x3"}, {}, kDevice),
+       NDef("z1", "Identity", {"y1"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("z2", "Identity", {"y2"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("z3", "Identity", {"y3"}, {{"T", DT_FLOAT}}, kDevice)},
+      function_library);
+
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The function is specialized once for the known shape, and the original
+  // function is kept for the input of unknown shape.
+  ASSERT_EQ(2, output.library().function_size());
+  const FunctionDef* specialized = nullptr;
+  for (const FunctionDef& func : output.library().function()) {
+    if (func.signature().name() == "MySquare_specialized_for_y1_at_tf_graph") {
+      specialized = &func;
+    } else {
+      EXPECT_EQ("MySquare", func.signature().name());
+    }
+  }
+  ASSERT_NE(specialized, nullptr);
+  ASSERT_EQ(1, specialized->arg_attr().count(0));
+  const AttrValue& shapes =
+      specialized->arg_attr().at(0).attr().at("_output_shapes");
+  ASSERT_EQ(1, shapes.list().shape_size());
+  EXPECT_EQ(TensorShape({2, 3}), TensorShape(shapes.list().shape(0)));
+
+  int count = 0;
+  for (const NodeDef& node : output.node()) {
+    if ((node.name() == "y1" || node.name() == "y2") && ++count) {
+      EXPECT_EQ("MySquare_specialized_for_y1_at_tf_graph", node.op());
+    } else if (node.name() == "y3" && ++count) {
+      EXPECT_EQ("MySquare", node.op());
+    }
+  }
+  EXPECT_EQ(3, count);
+
+  // And that graph evaluation yields the same result.
+  item.fetch = {"z1", "z2", "z3"};
+  item.feed.emplace_back("x1", test::AsTensor<float>({1, 2, 3, 4, 5, 6},
+                                                     TensorShape({2, 3})));
+  item.feed.emplace_back("x2", test::AsTensor<float>({6, 5, 4, 3, 2, 1},
+                                                     TensorShape({2, 3})));
+  item.feed.emplace_back("x3", test::AsTensor<float>({1, 2, 3, 4}));
+
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  ASSERT_EQ(tensors_expected.size(), tensors.size());
+  for (int i = 0; i < tensors.size(); ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+}
+
+TEST_F(FunctionOptimizerTest, SpecializeFunctionForInputShapesIsOffByDefault) {
+  using test::function::NDef;
+
+  FunctionOptimizer optimizer(RewriterConfig::DEFAULT, true);
+
+  FunctionDef square_func = FunctionDefHelper::Create(
+      "MySquare", {"x:float"}, {"z:float"}, {},
+      {{{"output"}, "Mul", {"x", "x"}, {{"T", DT_FLOAT}}}},
+      /* Mapping between function returns and function node outputs. */
+      {{"z", "output:z:0"}});
+
+  // Mark MySquare as noinline.
+  (*square_func.mutable_attr())["_noinline"].set_b(true);
+  std::vector<FunctionDef> function_library = {square_func};
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("x", "Placeholder", {},
+            {{"dtype", DT_FLOAT}, {"shape", TensorShape({2, 3})}}, kDevice),
+       NDef("y", "MySquare", {"x"}, {}, kDevice),
+       NDef("z", "Identity", {"y"}, {{"T", DT_FLOAT}}, kDevice)},
+      function_library);
+
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  ASSERT_EQ(1, output.library().function_size());
+  EXPECT_EQ("MySquare", output.library().function(0).signature().name());
+  EXPECT_EQ(0, output.library().function(0).arg_attr_size());
+}
+
 TEST_F(FunctionOptimizerTest, SpecializeIndirectFunctionPushDownConstInput) {
   using test::function::NDef;
   using FDH = FunctionDefHelper;
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
 
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
@@ -24,11 +26,16 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/measuring_cost_estimator.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer_factory.h"
+#include "tensorflow/core/grappler/optimizers/optimized_function_cache.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -39,6 +46,7 @@ constexpr char kNHWC[] = "NHWC";
 constexpr char kNCHW[] = "NCHW";
 constexpr float kVoltaGPURatioThreshold = 0.5;
 constexpr float kConvGPUFP16Threshold = 0.5;
+constexpr int kAutotuneMeasurementSteps = 10;
 
 struct MutableNodeViewFormatter {
   void operator()(std::string* out, utils::MutableNodeView* node_view) const {
@@ -394,8 +402,96 @@ Status EraseOutputShapeAttrs(TransposeContext* context) {
   return Status::OK();
 }
 
+// Expands the nodes of `context` to its assigned layout, and stores the result
+// in `output`.
+Status ConvertLayout(TransposeContext* context, bool is_aggressive,
+                     GraphDef* output) {
+  TransposerFactory transposer_factory;
+  TF_RETURN_IF_ERROR(ExpandLayoutSensitiveOp(context, &transposer_factory));
+  if (context->graph.node_size() > context->num_nodes || is_aggressive) {
+    TF_RETURN_IF_ERROR(ExpandLayoutAgnosticOp(context, &transposer_factory));
+    TF_RETURN_IF_ERROR(EraseCancellableNodes(context));
+    TF_RETURN_IF_ERROR(EraseCancellableNodesAroundPad(context));
+    // TODO(lyandy): Remove sorting once other optimizers are migrated to using
+    // `utils::GraphView`.
+    TF_RETURN_IF_ERROR(
+        context->graph_view->SortTopologically(/*ignore_cycles=*/false, {}));
+  }
+  TF_RETURN_IF_ERROR(EraseOutputShapeAttrs(context));
+
+  *output = context->graph;
+  return Status::OK();
+}
+
+uint64 FingerprintProto(const protobuf::MessageLite& proto) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  return Fingerprint64(serialized);
+}
+
+// Returns the key of the autotuned layout of `item` in the
+// OptimizedFunctionCache.
+uint64 LayoutAutotuneKey(const GrapplerItem& item, const Cluster& cluster,
+                         bool is_aggressive) {
+  uint64 key = FingerprintCat64(FingerprintProto(item.graph),
+                                is_aggressive ? 1 : 0);
+  for (const string& fetch : item.fetch) {
+    key = FingerprintCat64(key, Fingerprint64(fetch));
+  }
+  const std::unordered_map<string, DeviceProperties>& devices =
+      cluster.GetDevices();
+  std::vector<string> device_names;
+  device_names.reserve(devices.size());
+  for (const auto& device : devices) device_names.push_back(device.first);
+  std::sort(device_names.begin(), device_names.end());
+  for (const string& name : device_names) {
+    key = FingerprintCat64(key, Fingerprint64(name));
+    key = FingerprintCat64(key, FingerprintProto(devices.at(name)));
+  }
+  return key;
+}
+
 }  // namespace
 
+Status GenericLayoutOptimizer::AutotuneGPULayout(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output) {
+  const bool is_aggressive = opt_level_ == RewriterConfig::AGGRESSIVE;
+  const uint64 key = LayoutAutotuneKey(item, *cluster, is_aggressive);
+  OptimizedFunctionCache* cache = OptimizedFunctionCache::Global();
+  if (cache->Lookup(autotune_dir_, key, output)) {
+    VLOG(2) << "Reusing the autotuned layout of " << item.id;
+    return Status::OK();
+  }
+
+  MeasuringCostEstimator estimator(cluster, kAutotuneMeasurementSteps,
+                                   /*measurement_threads=*/0);
+  TF_RETURN_IF_ERROR(estimator.Initialize(item));
+  const std::pair<const char*, const char*> candidates[] = {{kNHWC, kNCHW},
+                                                            {kNCHW, kNHWC}};
+  Costs::Duration best_time = Costs::Duration::max();
+  for (const auto& formats : candidates) {
+    TransposeContext context;
+    TF_RETURN_IF_ERROR(
+        TransposeContext::InitializeTransposeContext(item, cluster, &context));
+    context.AssignDeviceAndDataFormats(kGPU, formats.first, formats.second);
+    GraphDef candidate;
+    TF_RETURN_IF_ERROR(ConvertLayout(&context, is_aggressive, &candidate));
+    Costs costs;
+    TF_RETURN_IF_ERROR(
+        estimator.PredictCosts(candidate, /*run_metadata=*/nullptr, &costs));
+    VLOG(1) << "Layout conversion " << formats.first << " to "
+            << formats.second << " of " << item.id << " runs in "
+            << costs.execution_time.count() << "ns";
+    if (costs.execution_time < best_time) {
+      best_time = costs.execution_time;
+      output->Swap(&candidate);
+    }
+  }
+  cache->Insert(autotune_dir_, key, *output);
+  return Status::OK();
+}
+
 // When there is a GPU, the computation graph is converted to NCHW format.
 // When there is only CPU, there will be no conversion by default, unless user
 // chose to convert the graph to a desired format. Currently, NCHW -> NHWC
@@ -413,6 +509,13 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
 
   const bool is_aggressive = opt_level_ == RewriterConfig::AGGRESSIVE;
 
+  if (num_gpus > 0 && !autotune_dir_.empty()) {
+    const Status status = AutotuneGPULayout(cluster, item, output);
+    if (status.ok()) return Status::OK();
+    VLOG(1) << "Failed to autotune the layout of " << item.id
+            << ", falling back to heuristics: " << status;
+  }
+
   TransposeContext context;
   if (num_gpus > 0) {
     TF_RETURN_IF_ERROR(
@@ -442,21 +545,7 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
     }
   }
 
-  TransposerFactory transposer_factory;
-  TF_RETURN_IF_ERROR(ExpandLayoutSensitiveOp(&context, &transposer_factory));
-  if (context.graph.node_size() > context.num_nodes || is_aggressive) {
-    TF_RETURN_IF_ERROR(ExpandLayoutAgnosticOp(&context, &transposer_factory));
-    TF_RETURN_IF_ERROR(EraseCancellableNodes(&context));
-    TF_RETURN_IF_ERROR(EraseCancellableNodesAroundPad(&context));
-    // TODO(lyandy): Remove sorting once other optimizers are migrated to using
-    // `utils::GraphView`.
-    TF_RETURN_IF_ERROR(
-        context.graph_view->SortTopologically(/*ignore_cycles=*/false, {}));
-  }
-  TF_RETURN_IF_ERROR(EraseOutputShapeAttrs(&context));
-
-  *output = context.graph;
-  return Status::OK();
+  return ConvertLayout(&context, is_aggressive, output);
 }
 
 }  // end namespace grappler
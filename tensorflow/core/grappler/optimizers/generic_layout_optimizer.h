@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GENERIC_LAYOUT_OPTIMIZER_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_GENERIC_LAYOUT_OPTIMIZER_H_
 
+#include <string>
+
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
@@ -34,6 +36,14 @@ class GenericLayoutOptimizer : public GraphOptimizer {
   explicit GenericLayoutOptimizer(RewriterConfig::Toggle opt_level,
                                   RewriterConfig::CpuLayout layout_conversion)
       : opt_level_(opt_level), cpu_layout_conversion_(layout_conversion) {}
+  // If `autotune_dir` is non-empty, the layout of graphs placed on GPUs is
+  // chosen by measurement, see RewriterConfig.layout_optimizer_autotune_dir.
+  explicit GenericLayoutOptimizer(RewriterConfig::Toggle opt_level,
+                                  RewriterConfig::CpuLayout layout_conversion,
+                                  const std::string& autotune_dir)
+      : opt_level_(opt_level),
+        cpu_layout_conversion_(layout_conversion),
+        autotune_dir_(autotune_dir) {}
   ~GenericLayoutOptimizer() override = default;
 
   string name() const override { return "layout"; };
@@ -44,8 +54,14 @@ class GenericLayoutOptimizer : public GraphOptimizer {
                   GraphDef* output) override;
 
  private:
+  // Converts `item` to the faster of the two GPU layouts, as measured on
+  // `cluster` or found in the cache of previous measurements.
+  Status AutotuneGPULayout(Cluster* cluster, const GrapplerItem& item,
+                           GraphDef* output);
+
   RewriterConfig::Toggle opt_level_;
   RewriterConfig::CpuLayout cpu_layout_conversion_;
+  std::string autotune_dir_;
 };
 
 }  // namespace grappler
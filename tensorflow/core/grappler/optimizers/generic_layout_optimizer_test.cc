@@ -32,6 +32,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/graph_view.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -334,6 +336,50 @@ TEST_F(GenericLayoutOptimizerTest, GPUDevice) {
   VerifyDataFormatAttributeMatch(conv_node, "NCHW");
 }
 
+TEST_F(GenericLayoutOptimizerTest, AutotuneGPULayout) {
+#if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  GTEST_SKIP() << "Neither CUDA nor ROCm is enabled";
+#endif  // !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto conv =
+      SimpleConv2D(&s, 4, 2, "VALID", "/job:w/replica:0/task:0/device:GPU:0");
+  Output fetch = ops::Identity(s.WithOpName("Fetch"), {conv});
+  GrapplerItem item;
+  item.fetch.push_back("Fetch");
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  const string autotune_dir =
+      io::JoinPath(testing::TmpDir(), "layout_autotune");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(autotune_dir));
+  GenericLayoutOptimizer optimizer(RewriterConfig::DEFAULT,
+                                   RewriterConfig::NO_CONVERSION_ON_CPU,
+                                   autotune_dir);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  auto* conv_node = graph_view.GetNode("Conv2D");
+  ASSERT_NE(conv_node, nullptr);
+  const auto* data_format = conv_node->GetAttr("data_format");
+  ASSERT_NE(data_format, nullptr);
+  EXPECT_TRUE(data_format->s() == "NCHW" || data_format->s() == "NHWC");
+
+  // The winner is persisted, and reused by later optimizations.
+  std::vector<string> entries;
+  TF_ASSERT_OK(Env::Default()->GetChildren(autotune_dir, &entries));
+  EXPECT_EQ(entries.size(), 1);
+
+  GenericLayoutOptimizer other_optimizer(RewriterConfig::DEFAULT,
+                                         RewriterConfig::NO_CONVERSION_ON_CPU,
+                                         autotune_dir);
+  GraphDef other_output;
+  TF_ASSERT_OK(
+      other_optimizer.Optimize(virtual_cluster_.get(), item, &other_output));
+  CompareGraphs(output, other_output);
+}
+
 TEST_F(GenericLayoutOptimizerTest, CPUDevice) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   auto conv = SimpleConv2D(&s, 4, 2, "VALID", "/CPU:0");
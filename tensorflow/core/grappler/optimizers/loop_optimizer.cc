@@ -22,13 +22,19 @@ limitations under the License.
 #include <unordered_set>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
@@ -714,6 +720,722 @@ Status CheckForDeadFanout(const MutableGraphView& view,
   return Status::OK();
 }
 
+// A reference to a tensor in a function body: either an input argument ("arg")
+// or an output of a body node ("node:output:index").
+struct FunctionTensor {
+  string node;
+  string output;
+  int index = 0;
+
+  bool is_arg() const { return output.empty(); }
+};
+
+// Returns false for control inputs and malformed references.
+bool ParseFunctionTensor(const string& input, FunctionTensor* tensor) {
+  if (input.empty() || IsControlInput(input)) return false;
+  std::vector<string> parts = absl::StrSplit(input, ':');
+  if (parts.size() == 1) {
+    tensor->node = parts[0];
+    tensor->output.clear();
+    tensor->index = 0;
+    return true;
+  }
+  if (parts.size() != 3 || parts[1].empty()) return false;
+  tensor->node = parts[0];
+  tensor->output = parts[1];
+  return absl::SimpleAtoi(parts[2], &tensor->index);
+}
+
+// Returns the node name of a tensor or control reference in a function body.
+string FunctionNodeName(const string& input) {
+  const size_t begin = IsControlInput(input) ? 1 : 0;
+  return input.substr(begin, input.find(':') - begin);
+}
+
+// Finds the position and type of `tensor` among the outputs of `node`, which
+// must be a node of a function body.
+Status GetFlatOutput(const NodeDef& node, const FunctionTensor& tensor,
+                     int* position, DataType* type) {
+  const OpDef* op_def = nullptr;
+  TF_RETURN_IF_ERROR(OpRegistry::Global()->LookUpOpDef(node.op(), &op_def));
+  NameRangeMap outputs;
+  TF_RETURN_IF_ERROR(NameRangesForNode(node, *op_def, nullptr, &outputs));
+  auto it = outputs.find(tensor.output);
+  if (it == outputs.end() ||
+      tensor.index >= it->second.second - it->second.first) {
+    return errors::InvalidArgument("Node ", node.name(), " has no output ",
+                                   tensor.output, ":", tensor.index);
+  }
+  DataTypeVector output_types;
+  TF_RETURN_IF_ERROR(OutputTypesForNode(node, *op_def, &output_types));
+  *position = it->second.first + tensor.index;
+  *type = output_types[*position];
+  return Status::OK();
+}
+
+const NodeDef* FindFunctionNode(const FunctionDef& func, const string& name) {
+  for (const NodeDef& node : func.node_def()) {
+    if (node.name() == name) return &node;
+  }
+  return nullptr;
+}
+
+// Returns the tensor that `func` returns as its `i`-th output, or nullptr.
+const string* FindFunctionReturn(const FunctionDef& func, int i) {
+  const auto it = func.ret().find(func.signature().output_arg(i).name());
+  return it == func.ret().end() ? nullptr : &it->second;
+}
+
+// True if `func` is monomorphic and has the given number of inputs and
+// outputs, as the body and condition functions of While nodes have after
+// instantiation.
+bool HasSimpleSignature(const FunctionDef& func, int num_inputs,
+                        int num_outputs) {
+  const OpDef& signature = func.signature();
+  if (signature.attr_size() > 0 || signature.input_arg_size() != num_inputs ||
+      signature.output_arg_size() != num_outputs) {
+    return false;
+  }
+  for (const OpDef::ArgDef& arg : signature.input_arg()) {
+    if (arg.type() == DT_INVALID || IsRefType(arg.type())) return false;
+  }
+  for (const OpDef::ArgDef& arg : signature.output_arg()) {
+    if (arg.type() == DT_INVALID || IsRefType(arg.type())) return false;
+  }
+  return true;
+}
+
+bool GetScalarConstValue(const NodeDef& node, int64* value) {
+  if (!IsConstant(node)) return false;
+  const auto it = node.attr().find("value");
+  if (it == node.attr().end()) return false;
+  Tensor tensor;
+  if (!tensor.FromProto(it->second.tensor()) || tensor.NumElements() != 1) {
+    return false;
+  }
+  if (tensor.dtype() == DT_INT32) {
+    *value = tensor.flat<int32>()(0);
+    return true;
+  }
+  if (tensor.dtype() == DT_INT64) {
+    *value = tensor.flat<int64>()(0);
+    return true;
+  }
+  return false;
+}
+
+// Ops that read a TensorList without appending to it.
+bool IsTensorListReader(const NodeDef& node) {
+  static const auto* const kReaders = new absl::flat_hash_set<string>{
+      "TensorListConcatV2",     "TensorListElementShape",
+      "TensorListGather",       "TensorListGetItem",
+      "TensorListLength",       "TensorListStack"};
+  return kReaders->contains(node.op());
+}
+
+// Loop invariant code motion and TensorList preallocation for functional While
+// loops. Unlike LoopInvariantNodeMotionOptimizer, which works on the frames of
+// v1 control flow, this rewrites the body functions of While nodes in the
+// function library of the graph.
+class FunctionalLoopOptimizer {
+ public:
+  FunctionalLoopOptimizer(const std::unordered_set<string>& nodes_to_preserve,
+                          const absl::flat_hash_set<string>& feed_nodes,
+                          GraphDef* graph)
+      : nodes_to_preserve_(nodes_to_preserve),
+        feed_nodes_(feed_nodes),
+        graph_(graph),
+        node_map_(graph) {}
+
+  Status Optimize();
+
+ private:
+  // Moves the stateless computation of the loop body that only depends on loop
+  // invariants out of the loop, and passes its results to the body as extra
+  // loop variables instead.
+  Status HoistLoopInvariants(NodeDef* while_node);
+  // Bounds the size of the TensorLists the loop appends one element to per
+  // iteration by the trip count of the loop, so that EmptyTensorList can
+  // allocate room for all of the elements up front.
+  Status BoundTensorLists(NodeDef* while_node);
+
+  // Computes an upper bound of the trip count of a loop whose condition is
+  // `i < n`, or a conjunction of such terms, with constant `n` and a counter
+  // `i` that starts at a constant and grows by a constant step.
+  bool GetTripCountBound(const NodeDef& while_node, const FunctionDef& cond,
+                         const FunctionDef& body, const string& cond_tensor,
+                         int depth, int64* bound) const;
+  // Evaluates `tensor` of the loop condition if it is a constant, or a loop
+  // invariant initialized by a constant.
+  bool GetLoopConstValue(const NodeDef& while_node, const FunctionDef& cond,
+                         const FunctionDef& body, const string& tensor,
+                         int64* value) const;
+  bool GetOuterConstValue(const string& input, int64* value) const;
+
+  const FunctionDef* FindFunction(const NodeDef& while_node,
+                                  const string& attr) const;
+  FunctionDef* AddFunction(const FunctionDef& func, const string& prefix);
+  string UniqueNodeName(const string& prefix);
+
+  const std::unordered_set<string>& nodes_to_preserve_;
+  const absl::flat_hash_set<string>& feed_nodes_;
+  GraphDef* graph_;
+  NodeMap node_map_;
+  absl::flat_hash_map<string, int> function_index_;
+  absl::flat_hash_set<string> new_node_names_;
+};
+
+Status FunctionalLoopOptimizer::Optimize() {
+  for (int i = 0; i < graph_->library().function_size(); ++i) {
+    function_index_[graph_->library().function(i).signature().name()] = i;
+  }
+  std::vector<NodeDef*> while_nodes;
+  for (NodeDef& node : *graph_->mutable_node()) {
+    if (IsWhile(node)) while_nodes.push_back(&node);
+  }
+  for (NodeDef* while_node : while_nodes) {
+    TF_RETURN_IF_ERROR(HoistLoopInvariants(while_node));
+    TF_RETURN_IF_ERROR(BoundTensorLists(while_node));
+  }
+  return Status::OK();
+}
+
+const FunctionDef* FunctionalLoopOptimizer::FindFunction(
+    const NodeDef& while_node, const string& attr) const {
+  const auto attr_it = while_node.attr().find(attr);
+  if (attr_it == while_node.attr().end()) return nullptr;
+  const auto it = function_index_.find(attr_it->second.func().name());
+  if (it == function_index_.end()) return nullptr;
+  return &graph_->library().function(it->second);
+}
+
+FunctionDef* FunctionalLoopOptimizer::AddFunction(const FunctionDef& func,
+                                                  const string& prefix) {
+  string name = prefix;
+  for (int i = 1; function_index_.contains(name); ++i) {
+    name = StrCat(prefix, "_", i);
+  }
+  function_index_[name] = graph_->library().function_size();
+  FunctionDef* new_func = graph_->mutable_library()->add_function();
+  *new_func = func;
+  new_func->mutable_signature()->set_name(name);
+  return new_func;
+}
+
+string FunctionalLoopOptimizer::UniqueNodeName(const string& prefix) {
+  string name = prefix;
+  for (int i = 1;
+       node_map_.NodeExists(name) || new_node_names_.contains(name); ++i) {
+    name = StrCat(prefix, "_", i);
+  }
+  new_node_names_.insert(name);
+  return name;
+}
+
+Status FunctionalLoopOptimizer::HoistLoopInvariants(NodeDef* while_node) {
+  const FunctionDef* body = FindFunction(*while_node, "body");
+  const FunctionDef* cond = FindFunction(*while_node, "cond");
+  if (body == nullptr || cond == nullptr) return Status::OK();
+  const int num_vars = while_node->attr().at("T").list().type_size();
+  if (!HasSimpleSignature(*body, num_vars, num_vars) ||
+      !HasSimpleSignature(*cond, num_vars, 1) ||
+      NumNonControlInputs(*while_node) != num_vars) {
+    return Status::OK();
+  }
+
+  // Loop variables that the body returns unchanged. Resources are excluded
+  // since the values they refer to may change in the loop.
+  absl::flat_hash_map<string, int> invariant_args;
+  for (int i = 0; i < num_vars; ++i) {
+    const OpDef::ArgDef& arg = body->signature().input_arg(i);
+    const string* ret = FindFunctionReturn(*body, i);
+    if (ret != nullptr && *ret == arg.name() && arg.type() != DT_RESOURCE) {
+      invariant_args.emplace(arg.name(), i);
+    }
+  }
+  if (invariant_args.empty()) return Status::OK();
+
+  absl::flat_hash_map<string, const NodeDef*> body_nodes;
+  for (const NodeDef& node : body->node_def()) {
+    body_nodes.emplace(node.name(), &node);
+  }
+  absl::flat_hash_set<string> control_outputs;
+  for (const auto& control_ret : body->control_ret()) {
+    control_outputs.insert(control_ret.second);
+  }
+
+  // A node is loop invariant if it is free of side effects and all of its
+  // inputs are loop invariant. Nodes with control inputs are left alone.
+  absl::flat_hash_set<string> invariant_nodes;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const NodeDef& node : body->node_def()) {
+      if (invariant_nodes.contains(node.name()) ||
+          control_outputs.contains(node.name()) ||
+          (node.input_size() == 0 && !IsConstant(node)) ||
+          !IsFreeOfSideEffect(node)) {
+        continue;
+      }
+      bool invariant = true;
+      for (const string& input : node.input()) {
+        FunctionTensor tensor;
+        if (!ParseFunctionTensor(input, &tensor) ||
+            !(tensor.is_arg() ? invariant_args.contains(tensor.node)
+                              : invariant_nodes.contains(tensor.node))) {
+          invariant = false;
+          break;
+        }
+      }
+      if (invariant) {
+        invariant_nodes.insert(node.name());
+        changed = true;
+      }
+    }
+  }
+
+  // Constants, and identities of loop invariants, are not worth passing around
+  // as loop variables.
+  auto is_trivial = [&](const NodeDef* node) {
+    while (IsIdentity(*node)) {
+      FunctionTensor tensor;
+      if (!ParseFunctionTensor(node->input(0), &tensor)) return false;
+      if (tensor.is_arg()) return true;
+      node = body_nodes.at(tensor.node);
+    }
+    return IsConstant(*node);
+  };
+
+  // The invariant tensors used by the rest of the body become the new loop
+  // variables.
+  std::vector<string> hoisted_tensors;
+  absl::flat_hash_set<string> hoisted_tensor_set;
+  auto maybe_hoist = [&](const string& input) {
+    FunctionTensor tensor;
+    if (!ParseFunctionTensor(input, &tensor) || tensor.is_arg() ||
+        !invariant_nodes.contains(tensor.node) ||
+        is_trivial(body_nodes.at(tensor.node))) {
+      return;
+    }
+    if (hoisted_tensor_set.insert(input).second) {
+      hoisted_tensors.push_back(input);
+    }
+  };
+  for (const NodeDef& node : body->node_def()) {
+    if (invariant_nodes.contains(node.name())) continue;
+    for (const string& input : node.input()) maybe_hoist(input);
+  }
+  for (int i = 0; i < num_vars; ++i) {
+    const string* ret = FindFunctionReturn(*body, i);
+    if (ret != nullptr) maybe_hoist(*ret);
+  }
+  if (hoisted_tensors.empty()) return Status::OK();
+  const int num_hoisted = hoisted_tensors.size();
+
+  // Nodes to copy out of the body, i.e. the invariant nodes the new loop
+  // variables depend on.
+  absl::flat_hash_set<string> hoisted_nodes;
+  std::vector<string> stack;
+  for (const string& input : hoisted_tensors) {
+    stack.push_back(FunctionNodeName(input));
+  }
+  while (!stack.empty()) {
+    const string name = stack.back();
+    stack.pop_back();
+    if (!hoisted_nodes.insert(name).second) continue;
+    for (const string& input : body_nodes.at(name)->input()) {
+      FunctionTensor tensor;
+      if (ParseFunctionTensor(input, &tensor) && !tensor.is_arg()) {
+        stack.push_back(tensor.node);
+      }
+    }
+  }
+
+  // Resolve the outputs used by the hoisted nodes and the types of the new
+  // loop variables before touching the graph.
+  absl::flat_hash_map<string, int> output_positions;
+  std::vector<DataType> hoisted_types;
+  for (const string& name : hoisted_nodes) {
+    for (const string& input : body_nodes.at(name)->input()) {
+      FunctionTensor tensor;
+      ParseFunctionTensor(input, &tensor);
+      if (tensor.is_arg()) continue;
+      int position;
+      DataType type;
+      if (!GetFlatOutput(*body_nodes.at(tensor.node), tensor, &position, &type)
+               .ok()) {
+        return Status::OK();
+      }
+      output_positions[input] = position;
+    }
+  }
+  for (const string& input : hoisted_tensors) {
+    FunctionTensor tensor;
+    ParseFunctionTensor(input, &tensor);
+    int position;
+    DataType type;
+    if (!GetFlatOutput(*body_nodes.at(tensor.node), tensor, &position, &type)
+             .ok() ||
+        IsRefType(type)) {
+      return Status::OK();
+    }
+    output_positions[input] = position;
+    hoisted_types.push_back(type);
+  }
+
+  VLOG(2) << "Hoisting " << hoisted_nodes.size()
+          << " loop invariant nodes out of the body of " << while_node->name();
+
+  // Copy the hoisted nodes in front of the loop.
+  absl::flat_hash_map<string, string> outer_names;
+  for (const NodeDef& node : body->node_def()) {
+    if (hoisted_nodes.contains(node.name())) {
+      outer_names[node.name()] =
+          UniqueNodeName(StrCat(while_node->name(), "/", node.name()));
+    }
+  }
+  auto outer_tensor = [&](const string& input) {
+    FunctionTensor tensor;
+    ParseFunctionTensor(input, &tensor);
+    if (tensor.is_arg()) {
+      return while_node->input(invariant_args.at(tensor.node));
+    }
+    return TensorIdToString(
+        {outer_names.at(tensor.node), output_positions.at(input)});
+  };
+  // Constants get a control dependency on a loop input to stay in the same
+  // frame as the loop.
+  int frame_input = num_vars;
+  for (const auto& arg : invariant_args) {
+    frame_input = std::min(frame_input, arg.second);
+  }
+  const string frame_dependency =
+      AsControlDependency(NodeName(while_node->input(frame_input)));
+  for (const NodeDef& node : body->node_def()) {
+    if (!hoisted_nodes.contains(node.name())) continue;
+    NodeDef* outer_node = graph_->add_node();
+    *outer_node = node;
+    outer_node->set_name(outer_names.at(node.name()));
+    outer_node->clear_input();
+    for (const string& input : node.input()) {
+      outer_node->add_input(outer_tensor(input));
+    }
+    if (node.input_size() == 0) outer_node->add_input(frame_dependency);
+    if (outer_node->device().empty()) {
+      outer_node->set_device(while_node->device());
+    }
+    node_map_.AddNode(outer_node->name(), outer_node);
+    for (const string& input : outer_node->input()) {
+      node_map_.AddOutput(NodeName(input), outer_node->name());
+    }
+  }
+
+  // Pass the hoisted tensors to new copies of the body and condition, which
+  // return them unchanged.
+  FunctionDef* new_body = AddFunction(*body, StrCat(body->signature().name(),
+                                                    "_licm"));
+  FunctionDef* new_cond = AddFunction(*cond, StrCat(cond->signature().name(),
+                                                    "_licm"));
+  absl::flat_hash_set<string> used_names;
+  for (const OpDef::ArgDef& arg : new_body->signature().input_arg()) {
+    used_names.insert(arg.name());
+  }
+  for (const OpDef::ArgDef& arg : new_body->signature().output_arg()) {
+    used_names.insert(arg.name());
+  }
+  for (const OpDef::ArgDef& arg : new_cond->signature().input_arg()) {
+    used_names.insert(arg.name());
+  }
+  for (const NodeDef& node : new_body->node_def()) {
+    used_names.insert(node.name());
+  }
+  for (const NodeDef& node : new_cond->node_def()) {
+    used_names.insert(node.name());
+  }
+  absl::flat_hash_map<string, string> hoisted_args;
+  for (int i = 0; i < num_hoisted; ++i) {
+    string name = "licm_input";
+    for (int j = 1; used_names.contains(name); ++j) {
+      name = StrCat("licm_input_", j);
+    }
+    used_names.insert(name);
+    hoisted_args[hoisted_tensors[i]] = name;
+    for (OpDef* signature :
+         {new_body->mutable_signature(), new_cond->mutable_signature()}) {
+      OpDef::ArgDef* arg = signature->add_input_arg();
+      arg->set_name(name);
+      arg->set_type(hoisted_types[i]);
+    }
+    OpDef::ArgDef* output = new_body->mutable_signature()->add_output_arg();
+    output->set_name(name);
+    output->set_type(hoisted_types[i]);
+    (*new_body->mutable_ret())[name] = name;
+  }
+  for (NodeDef& node : *new_body->mutable_node_def()) {
+    if (hoisted_nodes.contains(node.name())) continue;
+    for (int i = 0; i < node.input_size(); ++i) {
+      const auto it = hoisted_args.find(node.input(i));
+      if (it != hoisted_args.end()) node.set_input(i, it->second);
+    }
+  }
+  for (auto& ret : *new_body->mutable_ret()) {
+    const auto it = hoisted_args.find(ret.second);
+    if (it != hoisted_args.end()) ret.second = it->second;
+  }
+
+  // Drop the hoisted nodes that the body no longer uses.
+  absl::flat_hash_set<string> used_nodes;
+  for (const NodeDef& node : new_body->node_def()) {
+    if (hoisted_nodes.contains(node.name())) continue;
+    for (const string& input : node.input()) {
+      stack.push_back(FunctionNodeName(input));
+    }
+  }
+  for (const auto& ret : new_body->ret()) {
+    stack.push_back(FunctionNodeName(ret.second));
+  }
+  while (!stack.empty()) {
+    const string name = stack.back();
+    stack.pop_back();
+    if (!hoisted_nodes.contains(name) || !used_nodes.insert(name).second) {
+      continue;
+    }
+    for (const string& input : body_nodes.at(name)->input()) {
+      stack.push_back(FunctionNodeName(input));
+    }
+  }
+  auto* body_node_defs = new_body->mutable_node_def();
+  body_node_defs->erase(
+      std::remove_if(body_node_defs->begin(), body_node_defs->end(),
+                     [&](const NodeDef& node) {
+                       return hoisted_nodes.contains(node.name()) &&
+                              !used_nodes.contains(node.name());
+                     }),
+      body_node_defs->end());
+
+  // Finally make the loop carry the hoisted tensors.
+  auto* attr = while_node->mutable_attr();
+  (*attr)["body"].mutable_func()->set_name(new_body->signature().name());
+  (*attr)["cond"].mutable_func()->set_name(new_cond->signature().name());
+  for (const char* shapes_attr : {"output_shapes", "_output_shapes"}) {
+    const auto it = attr->find(shapes_attr);
+    if (it == attr->end() || it->second.list().shape_size() != num_vars) {
+      continue;
+    }
+    for (int i = 0; i < num_hoisted; ++i) {
+      it->second.mutable_list()->add_shape()->set_unknown_rank(true);
+    }
+  }
+  std::vector<string> inputs(while_node->input().begin(),
+                             while_node->input().end());
+  while_node->clear_input();
+  for (int i = 0; i < num_vars; ++i) {
+    while_node->add_input(inputs[i]);
+  }
+  for (int i = 0; i < num_hoisted; ++i) {
+    (*attr)["T"].mutable_list()->add_type(hoisted_types[i]);
+    const string input = outer_tensor(hoisted_tensors[i]);
+    while_node->add_input(input);
+    node_map_.AddOutput(NodeName(input), while_node->name());
+  }
+  for (int i = num_vars, end = inputs.size(); i < end; ++i) {
+    while_node->add_input(inputs[i]);
+  }
+  return Status::OK();
+}
+
+bool FunctionalLoopOptimizer::GetOuterConstValue(const string& input,
+                                                 int64* value) const {
+  const NodeDef* node = node_map_.GetNode(input);
+  return node != nullptr && IsReallyConstant(*node, feed_nodes_) &&
+         GetScalarConstValue(*node, value);
+}
+
+bool FunctionalLoopOptimizer::GetLoopConstValue(const NodeDef& while_node,
+                                                const FunctionDef& cond,
+                                                const FunctionDef& body,
+                                                const string& tensor_name,
+                                                int64* value) const {
+  FunctionTensor tensor;
+  if (!ParseFunctionTensor(tensor_name, &tensor)) return false;
+  if (!tensor.is_arg()) {
+    const NodeDef* node = FindFunctionNode(cond, tensor.node);
+    return node != nullptr && GetScalarConstValue(*node, value);
+  }
+  for (int i = 0; i < cond.signature().input_arg_size(); ++i) {
+    if (cond.signature().input_arg(i).name() != tensor.node) continue;
+    const string* ret = FindFunctionReturn(body, i);
+    return ret != nullptr && *ret == body.signature().input_arg(i).name() &&
+           GetOuterConstValue(while_node.input(i), value);
+  }
+  return false;
+}
+
+bool FunctionalLoopOptimizer::GetTripCountBound(const NodeDef& while_node,
+                                                const FunctionDef& cond,
+                                                const FunctionDef& body,
+                                                const string& cond_tensor,
+                                                int depth,
+                                                int64* bound) const {
+  constexpr int kMaxDepth = 8;
+  FunctionTensor tensor;
+  if (depth > kMaxDepth || !ParseFunctionTensor(cond_tensor, &tensor) ||
+      tensor.is_arg()) {
+    return false;
+  }
+  const NodeDef* node = FindFunctionNode(cond, tensor.node);
+  if (node == nullptr) return false;
+  if (IsIdentity(*node)) {
+    return GetTripCountBound(while_node, cond, body, node->input(0), depth + 1,
+                             bound);
+  }
+  if (IsLogicalAnd(*node)) {
+    int64 bound_0, bound_1;
+    const bool has_bound_0 = GetTripCountBound(
+        while_node, cond, body, node->input(0), depth + 1, &bound_0);
+    const bool has_bound_1 = GetTripCountBound(
+        while_node, cond, body, node->input(1), depth + 1, &bound_1);
+    if (has_bound_0 && has_bound_1) {
+      *bound = std::min(bound_0, bound_1);
+    } else if (has_bound_0 || has_bound_1) {
+      *bound = has_bound_0 ? bound_0 : bound_1;
+    }
+    return has_bound_0 || has_bound_1;
+  }
+  if (!IsLess(*node)) return false;
+
+  // The counter must be a loop variable that the body increments by a
+  // positive constant.
+  FunctionTensor counter;
+  if (!ParseFunctionTensor(node->input(0), &counter) || !counter.is_arg()) {
+    return false;
+  }
+  int counter_index = -1;
+  for (int i = 0; i < cond.signature().input_arg_size(); ++i) {
+    if (cond.signature().input_arg(i).name() == counter.node) {
+      counter_index = i;
+    }
+  }
+  if (counter_index < 0) return false;
+  const string* next = FindFunctionReturn(body, counter_index);
+  FunctionTensor next_tensor;
+  if (next == nullptr || !ParseFunctionTensor(*next, &next_tensor) ||
+      next_tensor.is_arg()) {
+    return false;
+  }
+  const NodeDef* increment = FindFunctionNode(body, next_tensor.node);
+  if (increment == nullptr || !IsAdd(*increment) ||
+      increment->input_size() != 2) {
+    return false;
+  }
+  const string& counter_arg = body.signature().input_arg(counter_index).name();
+  const int step_input = increment->input(0) == counter_arg ? 1 : 0;
+  if (increment->input(1 - step_input) != counter_arg) return false;
+  FunctionTensor step_tensor;
+  if (!ParseFunctionTensor(increment->input(step_input), &step_tensor) ||
+      step_tensor.is_arg()) {
+    return false;
+  }
+  const NodeDef* step_node = FindFunctionNode(body, step_tensor.node);
+  int64 step, start, limit;
+  if (step_node == nullptr || !GetScalarConstValue(*step_node, &step) ||
+      step <= 0 ||
+      !GetOuterConstValue(while_node.input(counter_index), &start) ||
+      !GetLoopConstValue(while_node, cond, body, node->input(1), &limit)) {
+    return false;
+  }
+  *bound = limit <= start ? 0 : (limit - start + step - 1) / step;
+  return true;
+}
+
+Status FunctionalLoopOptimizer::BoundTensorLists(NodeDef* while_node) {
+  if (nodes_to_preserve_.find(while_node->name()) != nodes_to_preserve_.end()) {
+    return Status::OK();
+  }
+  const FunctionDef* body = FindFunction(*while_node, "body");
+  const FunctionDef* cond = FindFunction(*while_node, "cond");
+  if (body == nullptr || cond == nullptr) return Status::OK();
+  const AttrValue::ListValue& types = while_node->attr().at("T").list();
+  const int num_vars = types.type_size();
+  if (!HasSimpleSignature(*body, num_vars, num_vars) ||
+      !HasSimpleSignature(*cond, num_vars, 1) ||
+      NumNonControlInputs(*while_node) != num_vars) {
+    return Status::OK();
+  }
+  const string* cond_output = FindFunctionReturn(*cond, 0);
+  int64 trip_count_bound;
+  if (cond_output == nullptr ||
+      !GetTripCountBound(*while_node, *cond, *body, *cond_output, 0,
+                         &trip_count_bound)) {
+    return Status::OK();
+  }
+
+  for (int i = 0; i < num_vars; ++i) {
+    if (types.type(i) != DT_VARIANT) continue;
+    // The list must be created empty and unbounded for this loop only...
+    NodeDef* list = node_map_.GetNode(while_node->input(i));
+    if (list == nullptr || list->op() != "EmptyTensorList" ||
+        node_map_.GetOutputs(list->name()).size() != 1 ||
+        std::count_if(while_node->input().begin(), while_node->input().end(),
+                      [&](const string& input) {
+                        return NodeName(input) == list->name();
+                      }) != 1) {
+      continue;
+    }
+    int64 max_num_elements;
+    if (!GetOuterConstValue(list->input(1), &max_num_elements) ||
+        max_num_elements != -1) {
+      continue;
+    }
+    // ...the body must push a single element to it...
+    const string* ret = FindFunctionReturn(*body, i);
+    const NodeDef* push = nullptr;
+    FunctionTensor tensor;
+    while (ret != nullptr && ParseFunctionTensor(*ret, &tensor) &&
+           !tensor.is_arg()) {
+      push = FindFunctionNode(*body, tensor.node);
+      if (push == nullptr || !IsIdentity(*push)) break;
+      ret = &push->input(0);
+    }
+    if (push == nullptr || push->op() != "TensorListPushBack" ||
+        push->input(0) != body->signature().input_arg(i).name()) {
+      continue;
+    }
+    // ...and it must only be read after the loop.
+    bool read_only = true;
+    for (const NodeDef* fanout : node_map_.GetOutputs(while_node->name())) {
+      for (const string& input : fanout->input()) {
+        const TensorId tensor = ParseTensorName(input);
+        if (tensor.node() == while_node->name() && tensor.index() == i &&
+            !IsTensorListReader(*fanout)) {
+          read_only = false;
+        }
+      }
+    }
+    if (!read_only) continue;
+
+    VLOG(2) << "Bounding " << list->name() << " by the " << trip_count_bound
+            << " iterations of " << while_node->name();
+    const string max_num_elements_input = NodeName(list->input(1));
+    NodeDef* bound = graph_->add_node();
+    bound->set_name(UniqueNodeName(StrCat(list->name(), "/max_num_elements")));
+    bound->set_op("Const");
+    bound->set_device(list->device());
+    bound->add_input(AsControlDependency(max_num_elements_input));
+    (*bound->mutable_attr())["dtype"].set_type(DT_INT32);
+    Tensor value(DT_INT32, TensorShape({}));
+    value.scalar<int32>()() = static_cast<int32>(std::min<int64>(
+        trip_count_bound, std::numeric_limits<int32>::max()));
+    value.AsProtoTensorContent(
+        (*bound->mutable_attr())["value"].mutable_tensor());
+    node_map_.AddNode(bound->name(), bound);
+    node_map_.AddOutput(max_num_elements_input, bound->name());
+    node_map_.UpdateInput(list->name(), list->input(1), bound->name());
+    list->set_input(1, bound->name());
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 LoopOptimizer::LoopOptimizer()
@@ -725,32 +1447,38 @@ LoopOptimizer::LoopOptimizer(RewriterConfig::Toggle opt_level,
                              DeviceBase* cpu_device)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
-      options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {
+      options_(LoopOptimizerOptions::Default(opt_level)) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
 Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
   if (!options_.enable_loop_invariant_node_motion &&
+      !options_.enable_functional_loop_optimization &&
       !options_.enable_stack_push_removal &&
       !options_.enable_dead_branch_removal) {
     return errors::Aborted("Nothing to do.");
   }
   *optimized_graph = item.graph;
+  absl::flat_hash_set<string> feed_nodes;
+  for (const auto& feed : item.feed) {
+    feed_nodes.insert(NodeName(feed.first));
+  }
   // Set up helper data structures.
   if (options_.enable_loop_invariant_node_motion) {
     LoopInvariantNodeMotionOptimizer linm_optimizer(optimized_graph);
     TF_RETURN_IF_ERROR(linm_optimizer.Optimize());
   }
+  if (options_.enable_functional_loop_optimization) {
+    FunctionalLoopOptimizer functional_loop_optimizer(
+        item.NodesToPreserve(), feed_nodes, optimized_graph);
+    TF_RETURN_IF_ERROR(functional_loop_optimizer.Optimize());
+  }
   if (options_.enable_stack_push_removal) {
     TF_RETURN_IF_ERROR(RemoveStackOps(item.NodesToPreserve(), optimized_graph));
   }
   if (options_.enable_dead_branch_removal) {
     NodeMap node_map(optimized_graph);
-    absl::flat_hash_set<string> feed_nodes;
-    for (const auto& feed : item.feed) {
-      feed_nodes.insert(NodeName(feed.first));
-    }
     TF_RETURN_IF_ERROR(RemoveDeadBranches(item.NodesToPreserve(), node_map,
                                           feed_nodes, optimized_graph));
   }
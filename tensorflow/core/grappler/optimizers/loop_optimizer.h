@@ -40,7 +40,9 @@ class LoopOptimizer : public GraphOptimizer {
 
   string name() const override { return "loop_optimizer"; };
 
-  bool UsesFunctionLibrary() const override { return false; }
+  bool UsesFunctionLibrary() const override {
+    return options_.enable_functional_loop_optimization;
+  }
 
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override;
@@ -51,11 +53,17 @@ class LoopOptimizer : public GraphOptimizer {
   // Granular control for loop optimizer stages.
   struct LoopOptimizerOptions {
     bool enable_loop_invariant_node_motion = false;
+    // Hoists loop invariants out of the body functions of While nodes, and
+    // bounds the TensorLists they fill by their trip count. Hoisted nodes run
+    // even if the loop does not, hence this is only on in AGGRESSIVE mode.
+    bool enable_functional_loop_optimization = false;
     bool enable_stack_push_removal = true;
     bool enable_dead_branch_removal = true;
 
     static LoopOptimizerOptions Default(RewriterConfig::Toggle opt_level) {
       LoopOptimizerOptions options;
+      options.enable_functional_loop_optimization =
+          opt_level == RewriterConfig::AGGRESSIVE;
       return options;
     }
   };
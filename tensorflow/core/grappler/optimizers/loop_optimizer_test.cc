@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -70,10 +71,17 @@ class LoopOptimizerTest : public GrapplerTest {
     optimizer->options_.enable_stack_push_removal = true;
   }
 
+  void EnableOnlyFunctionalLoopOptimization(LoopOptimizer* optimizer) {
+    DisableAllStages(optimizer);
+    optimizer->options_.enable_dead_branch_removal = false;
+    optimizer->options_.enable_functional_loop_optimization = true;
+  }
+
  private:
   void DisableAllStages(LoopOptimizer* optimizer) {
     LoopOptimizer::LoopOptimizerOptions options;
     options.enable_loop_invariant_node_motion = false;
+    options.enable_functional_loop_optimization = false;
     options.enable_stack_push_removal = false;
     optimizer->options_ = options;
   }
@@ -1773,5 +1781,157 @@ versions {
   EXPECT_TRUE(found);
 }
 
+TEST_F(LoopOptimizerTest, HoistLoopInvariantsOutOfWhileBody) {
+  using test::function::NDef;
+  using FDH = FunctionDefHelper;
+
+  // Computes x * w^2 in every iteration, although w never changes.
+  FunctionDef body = FDH::Create(
+      "Body", {"i: int32", "x: float", "w: float"},
+      {"i_next: int32", "x_next: float", "w_next: float"}, {},
+      {{{"one"},
+        "Const",
+        {},
+        {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(1)}}},
+       {{"add"}, "AddV2", {"i", "one:output:0"}, {{"T", DT_INT32}}},
+       {{"square"}, "Square", {"w"}, {{"T", DT_FLOAT}}},
+       {{"mul"}, "Mul", {"x", "square:y:0"}, {{"T", DT_FLOAT}}}},
+      {{"i_next", "add:z:0"}, {"x_next", "mul:z:0"}, {"w_next", "w"}});
+  FunctionDef cond = FDH::Create(
+      "Cond", {"i: int32", "x: float", "w: float"}, {"cond: bool"}, {},
+      {{{"n"},
+        "Const",
+        {},
+        {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(3)}}},
+       {{"less"}, "Less", {"i", "n:output:0"}, {{"T", DT_INT32}}}},
+      {{"cond", "less:z:0"}});
+
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("i", "Const", {},
+            {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(0)}}),
+       NDef("x", "Const", {},
+            {{"dtype", DT_FLOAT}, {"value", test::AsScalar<float>(1.0f)}}),
+       NDef("w", "Const", {},
+            {{"dtype", DT_FLOAT}, {"value", test::AsScalar<float>(2.0f)}}),
+       NDef("while", "While", {"i", "x", "w"},
+            {{"T", DataTypeSlice{DT_INT32, DT_FLOAT, DT_FLOAT}},
+             {"body", FDH::FunctionRef("Body")},
+             {"cond", FDH::FunctionRef("Cond")}}),
+       NDef("out", "Identity", {"while:1"}, {{"T", DT_FLOAT}})},
+      {body, cond});
+  item.fetch = {"out"};
+
+  LoopOptimizer optimizer(RewriterConfig::AGGRESSIVE, nullptr);
+  EnableOnlyFunctionalLoopOptimization(&optimizer);
+  EXPECT_TRUE(optimizer.UsesFunctionLibrary());
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* hoisted = nullptr;
+  const NodeDef* while_node = nullptr;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "while/square") hoisted = &node;
+    if (node.name() == "while") while_node = &node;
+  }
+  ASSERT_NE(hoisted, nullptr);
+  EXPECT_EQ(hoisted->op(), "Square");
+  ASSERT_EQ(hoisted->input_size(), 1);
+  EXPECT_EQ(hoisted->input(0), "w");
+
+  ASSERT_NE(while_node, nullptr);
+  ASSERT_EQ(while_node->input_size(), 4);
+  EXPECT_EQ(while_node->input(3), "while/square");
+  EXPECT_EQ(while_node->attr().at("T").list().type_size(), 4);
+  const string& body_name = while_node->attr().at("body").func().name();
+  EXPECT_NE(body_name, "Body");
+  const FunctionDef* new_body = nullptr;
+  for (const FunctionDef& func : output.library().function()) {
+    if (func.signature().name() == body_name) new_body = &func;
+  }
+  ASSERT_NE(new_body, nullptr);
+  EXPECT_EQ(new_body->signature().input_arg_size(), 4);
+  EXPECT_EQ(new_body->signature().output_arg_size(), 4);
+  for (const NodeDef& node : new_body->node_def()) {
+    EXPECT_NE(node.op(), "Square");
+    if (node.name() == "mul") EXPECT_EQ(node.input(1), "licm_input");
+  }
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+}
+
+TEST_F(LoopOptimizerTest, BoundTensorListsByTripCount) {
+  using test::function::NDef;
+  using FDH = FunctionDefHelper;
+
+  // Appends the loop counter to the list in each of the 5 iterations.
+  FunctionDef body = FDH::Create(
+      "Body", {"i: int32", "list: variant"},
+      {"i_next: int32", "list_next: variant"}, {},
+      {{{"one"},
+        "Const",
+        {},
+        {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(1)}}},
+       {{"add"}, "AddV2", {"i", "one:output:0"}, {{"T", DT_INT32}}},
+       {{"push"},
+        "TensorListPushBack",
+        {"list", "i"},
+        {{"element_dtype", DT_INT32}}}},
+      {{"i_next", "add:z:0"}, {"list_next", "push:output_handle:0"}});
+  FunctionDef cond = FDH::Create(
+      "Cond", {"i: int32", "list: variant"}, {"cond: bool"}, {},
+      {{{"n"},
+        "Const",
+        {},
+        {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(5)}}},
+       {{"less"}, "Less", {"i", "n:output:0"}, {{"T", DT_INT32}}}},
+      {{"cond", "less:z:0"}});
+
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("i", "Const", {},
+            {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(0)}}),
+       NDef("element_shape", "Const", {},
+            {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(-1)}}),
+       NDef("max_num_elements", "Const", {},
+            {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(-1)}}),
+       NDef("list", "EmptyTensorList", {"element_shape", "max_num_elements"},
+            {{"element_dtype", DT_INT32}, {"shape_type", DT_INT32}}),
+       NDef("while", "While", {"i", "list"},
+            {{"T", DataTypeSlice{DT_INT32, DT_VARIANT}},
+             {"body", FDH::FunctionRef("Body")},
+             {"cond", FDH::FunctionRef("Cond")}}),
+       NDef("stack", "TensorListStack", {"while:1", "element_shape"},
+            {{"element_dtype", DT_INT32}})},
+      {body, cond});
+  item.fetch = {"stack"};
+
+  LoopOptimizer optimizer(RewriterConfig::AGGRESSIVE, nullptr);
+  EnableOnlyFunctionalLoopOptimization(&optimizer);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* list = node_map.GetNode("list");
+  ASSERT_NE(list, nullptr);
+  ASSERT_EQ(list->input_size(), 2);
+  const NodeDef* bound = node_map.GetNode(list->input(1));
+  ASSERT_NE(bound, nullptr);
+  EXPECT_EQ(bound->op(), "Const");
+  Tensor bound_value;
+  ASSERT_TRUE(bound_value.FromProto(bound->attr().at("value").tensor()));
+  test::ExpectTensorEqual<int32>(bound_value, test::AsScalar<int32>(5));
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<int32>(tensors[0], tensors_expected[0]);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
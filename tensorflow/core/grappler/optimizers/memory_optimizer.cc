@@ -55,6 +55,9 @@ const char* kRecomputeTriggerNodePrefix = "RecomputeTrigger";
 // Attribute which may be added to nodes to manually allow them to be
 // recomputed.
 const char* kRecomputeHint = "_recompute_hint";
+// Bandwidth assumed for swapping tensors between a GPU and the host, in bytes
+// per nanosecond (i.e. PCIe running at 16 GBps).
+constexpr int64 kSwapBytesPerNanosecond = 16;
 
 // Ops which we wouldn't mind recomputing to save memory.
 // TODO(allenl): Replace this list with a cost model.
@@ -440,6 +443,16 @@ void RecomputeSubgraph(
   }
 }
 
+// Returns true for the nodes whose inputs we may want to recompute. This
+// matches node names that contain recomputation_targets_name_scope as a name
+// scope, meaning it either begins with or contains the name scope.
+bool IsRecomputationTarget(const NodeDef& node,
+                           const string& recomputation_targets_name_scope) {
+  return absl::StartsWith(node.name(), recomputation_targets_name_scope) ||
+         static_cast<int>(
+             node.name().find("/" + recomputation_targets_name_scope)) != -1;
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
                                 GraphDef* graph, const GrapplerItem& item) {
@@ -461,15 +474,9 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
   }
   std::function<bool(const NodeDef&)> is_target =
       [&recomputation_targets_name_scope](const NodeDef& node) {
-        // Nodes whose inputs we may want to recompute. This matches node names
-        // that contain recomputation_targets_name_scope as a name scope,
-        // meaning it either begins with or contains the name scope.
         // Defaults to "gradients/" which will match any node names that begins
         // with "gradients/" or contains "/gradients/".
-        return absl::StartsWith(node.name(),
-                                recomputation_targets_name_scope) ||
-               static_cast<int>(node.name().find(
-                   "/" + recomputation_targets_name_scope)) != -1;
+        return IsRecomputationTarget(node, recomputation_targets_name_scope);
       };
 
   if (optimization_level == RewriterConfig::RECOMPUTATION_HEURISTICS ||
@@ -968,6 +975,49 @@ static bool IsSwappable(MutableGraphView::InputPort input) {
   return !IsRefType(dtype);
 }
 
+// Times of a node in a simulated run of the graph.
+struct SimulatedNodeTimes {
+  // Time at which the node completes, from the start of the step.
+  Costs::NanoSeconds completion_time;
+  // Time spent running the node.
+  Costs::NanoSeconds compute_time;
+};
+
+// Simulates a run of `item` on the devices of `cluster` and returns the times
+// of each node that was run, keyed by node name.
+static bool SimulateNodeTimes(
+    Cluster* cluster, const GrapplerItem& item,
+    std::unordered_map<string, SimulatedNodeTimes>* node_times) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  if (!vcluster.Provision().ok()) {
+    return false;
+  }
+  if (!vcluster.Initialize(item).ok()) {
+    return false;
+  }
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return false;
+  }
+
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      SimulatedNodeTimes times;
+      times.completion_time =
+          Costs::NanoSeconds(1) +
+          Costs::MicroSeconds(node_stats.all_start_micros() +
+                              node_stats.op_end_rel_micros());
+      times.compute_time =
+          Costs::NanoSeconds(1) +
+          Costs::MicroSeconds(node_stats.op_end_rel_micros() -
+                              node_stats.op_start_rel_micros());
+      node_times->emplace(node_stats.node_name(), times);
+    }
+  }
+  return true;
+}
+
 struct MemInfo {
   MutableGraphView::OutputPort port;
   int64 memory_used;
@@ -1011,30 +1061,9 @@ static bool IdentifySwappingCandidates(
     }
     int64 required_savings = mem_usage.used_memory - prop.memory_size();
 
-    std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
-    {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
-      RunMetadata metadata;
-      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
-        return false;
-      }
-
-      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
-        for (const auto& node_stats : dev_stats.node_stats()) {
-          Costs::NanoSeconds exec_time =
-              Costs::NanoSeconds(1) +
-              Costs::MicroSeconds(node_stats.all_start_micros() +
-                                  node_stats.op_end_rel_micros());
-          op_completion_times.emplace(node_stats.node_name(), exec_time);
-        }
-      }
+    std::unordered_map<string, SimulatedNodeTimes> node_times;
+    if (!SimulateNodeTimes(cluster, *item, &node_times)) {
+      return false;
     }
 
     Costs::Duration peak_time = -1;
@@ -1075,12 +1104,12 @@ static bool IdentifySwappingCandidates(
       bool valid = true;
       for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
         // Get execution time.
-        auto it = op_completion_times.find(input.node->name());
-        if (it == op_completion_times.end()) {
+        auto it = node_times.find(input.node->name());
+        if (it == node_times.end()) {
           valid = false;
           break;
         }
-        if (it->second <= peak_time) {
+        if (it->second.completion_time <= peak_time) {
           continue;
         }
 
@@ -1101,7 +1130,7 @@ static bool IdentifySwappingCandidates(
 
         // Set earliest use time that's after peak.
         mem_info.uses_left.emplace_back(input);
-        earliest_use = std::min(earliest_use, it->second);
+        earliest_use = std::min(earliest_use, it->second.completion_time);
       }
       if (valid && !mem_info.uses_left.empty()) {
         // Compute the fitness: we need the tensor to be generated way away of
@@ -1270,6 +1299,248 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   return updated_graph;
 }
 
+// A decision of CostBasedMemoryPass for a tensor alive at the peak memory
+// usage of a device.
+struct MemoryDecision {
+  enum Kind { kKeep, kRecompute, kSwap };
+
+  const GraphMemory::LiveTensor* tensor;
+  Kind kind = kKeep;
+  // Estimated slowdown of the step caused by the decision.
+  Costs::Duration cost = Costs::Duration::max();
+  // The uses of the tensor to swap in, if kind is kSwap.
+  std::vector<MutableGraphView::InputPort> uses_to_swap;
+};
+
+// Returns true if recomputing `node` for its fanouts in the recomputation
+// target scope frees its outputs. The inputs of `node` need to stay alive until
+// the recomputation, so we only recompute nodes whose inputs are persistent or
+// alive at the peak anyway.
+static bool IsCheapToKeepInputsForRecomputation(
+    const NodeDef& node, const MutableGraphView& graph,
+    const std::unordered_set<string>& live_tensors) {
+  for (const string& input : node.input()) {
+    if (IsControlInput(input)) {
+      continue;
+    }
+    const TensorId tensor_id = ParseTensorName(input);
+    const NodeDef* fanin = graph.GetNode(tensor_id.node());
+    if (fanin == nullptr) {
+      return false;
+    }
+    if (!IsPersistent(*fanin) &&
+        live_tensors.count(strings::StrCat(tensor_id.node(), ":",
+                                           tensor_id.index())) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Decides whether `tensor`, alive at `peak_time`, is better recomputed, swapped
+// to the host or kept resident, and estimates the cost of the decision.
+static MemoryDecision DecideForTensor(
+    const GraphMemory::LiveTensor& tensor, Costs::Duration peak_time,
+    const MutableGraphView& graph,
+    const std::unordered_map<string, SimulatedNodeTimes>& node_times,
+    const std::unordered_set<string>& live_tensors,
+    const std::unordered_set<string>& feeds,
+    const string& recomputation_targets_name_scope) {
+  MemoryDecision decision;
+  decision.tensor = &tensor;
+  NodeDef* node = graph.GetNode(tensor.node);
+  auto node_time = node_times.find(tensor.node);
+  if (node == nullptr || node_time == node_times.end()) {
+    return decision;
+  }
+
+  // Recomputing the tensor costs running its node a second time.
+  if (!IsRecomputationTarget(*node, recomputation_targets_name_scope) &&
+      feeds.count(node->name()) == 0 &&
+      node->attr().count(kRecomputeHint) == 0 && IsFreeOfSideEffect(*node) &&
+      IsCheapToKeepInputsForRecomputation(*node, graph, live_tensors)) {
+    bool has_target_fanout = false;
+    for (const auto& fanout : graph.GetFanouts(*node, false)) {
+      if (IsRecomputationTarget(*fanout.node,
+                                recomputation_targets_name_scope)) {
+        has_target_fanout = true;
+        break;
+      }
+    }
+    if (has_target_fanout) {
+      decision.kind = MemoryDecision::kRecompute;
+      decision.cost = node_time->second.compute_time;
+    }
+  }
+
+  // Swapping the tensor costs the part of the transfers that can't overlap with
+  // the computation, i.e. that doesn't fit between its allocation and the peak
+  // for the swap out, or between the peak and its next use for the swap in.
+  MutableGraphView::OutputPort port =
+      graph.GetOutputPort(tensor.node, tensor.output_id);
+  if (!IsSwappable(graph, port)) {
+    return decision;
+  }
+  std::vector<MutableGraphView::InputPort> uses_to_swap;
+  Costs::Duration earliest_use(Costs::Duration::infinity());
+  for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
+    auto it = node_times.find(input.node->name());
+    if (it == node_times.end()) {
+      return decision;
+    }
+    if (it->second.completion_time <= peak_time) {
+      continue;
+    }
+    if (!IsSwappable(input)) {
+      return decision;
+    }
+    uses_to_swap.push_back(input);
+    earliest_use = std::min(earliest_use, it->second.completion_time);
+  }
+  if (uses_to_swap.empty()) {
+    return decision;
+  }
+  const Costs::Duration transfer_time(
+      static_cast<int64>(tensor.memory_used) / kSwapBytesPerNanosecond);
+  const Costs::Duration swap_out_slack = peak_time - tensor.allocation_time;
+  const Costs::Duration swap_in_slack = earliest_use - peak_time;
+  const Costs::Duration swap_cost =
+      std::max(Costs::Duration(0),
+               Costs::Duration(transfer_time - swap_out_slack)) +
+      std::max(Costs::Duration(0),
+               Costs::Duration(transfer_time - swap_in_slack));
+  if (swap_cost < decision.cost) {
+    decision.kind = MemoryDecision::kSwap;
+    decision.cost = swap_cost;
+    decision.uses_to_swap = std::move(uses_to_swap);
+  }
+  return decision;
+}
+
+// Brings the simulated peak memory usage of each GPU under
+// `memory_budget_bytes`, or under its memory size if `memory_budget_bytes` is
+// not positive. The tensors alive at the peak are freed in order of increasing
+// cost per byte, by annotating them for recomputation (kRecomputeHint) or
+// swapping (_swap_to_host), until enough memory is saved. The rewrites
+// themselves are left to RecomputationRewritingPass and SwappingPass.
+// Describes the decisions in `report`, and returns true if the peak memory
+// usage of any GPU exceeds its budget.
+bool CostBasedMemoryPass(Cluster* cluster, int64 memory_budget_bytes,
+                         const string& recomputation_targets_name_scope,
+                         GrapplerItem* item, string* report) {
+  GraphMemory memory(*item);
+  Status s = memory.InferStatically(cluster->GetDevices());
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+    return false;
+  }
+  std::unordered_map<string, SimulatedNodeTimes> node_times;
+  if (!SimulateNodeTimes(cluster, *item, &node_times)) {
+    return false;
+  }
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+
+  std::vector<string> device_names;
+  for (const auto& device : cluster->GetDevices()) {
+    device_names.push_back(device.first);
+  }
+  std::sort(device_names.begin(), device_names.end());
+
+  MutableGraphView graph(&item->graph);
+  bool over_budget = false;
+  for (const string& name : device_names) {
+    const DeviceProperties& prop = cluster->GetDevices().at(name);
+    if (prop.type() != "GPU") {
+      continue;
+    }
+    const int64 budget =
+        memory_budget_bytes > 0 ? memory_budget_bytes : prop.memory_size();
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (budget <= 0 || mem_usage.used_memory < 0) {
+      VLOG(1) << "Peak memory usage or budget unknown for device " << name;
+      continue;
+    }
+    absl::StrAppend(report, name, ": peak memory usage ",
+                    mem_usage.used_memory, " bytes, budget ", budget,
+                    " bytes\n");
+    if (mem_usage.used_memory <= budget) {
+      continue;
+    }
+    over_budget = true;
+
+    Costs::Duration peak_time = -1;
+    std::unordered_set<string> live_tensors;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      peak_time = std::max(peak_time, live_tensor.allocation_time);
+      live_tensors.insert(
+          strings::StrCat(live_tensor.node, ":", live_tensor.output_id));
+    }
+
+    std::vector<MemoryDecision> decisions;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      decisions.push_back(DecideForTensor(live_tensor, peak_time, graph,
+                                          node_times, live_tensors, feeds,
+                                          recomputation_targets_name_scope));
+    }
+    // Free the tensors that are cheapest per byte first.
+    std::sort(decisions.begin(), decisions.end(),
+              [](const MemoryDecision& a, const MemoryDecision& b) {
+                if (a.kind == MemoryDecision::kKeep ||
+                    b.kind == MemoryDecision::kKeep) {
+                  return b.kind == MemoryDecision::kKeep &&
+                         a.kind != MemoryDecision::kKeep;
+                }
+                return static_cast<double>(a.cost.count()) /
+                           a.tensor->memory_used <
+                       static_cast<double>(b.cost.count()) /
+                           b.tensor->memory_used;
+              });
+
+    int64 required_savings = mem_usage.used_memory - budget;
+    for (MemoryDecision& decision : decisions) {
+      const GraphMemory::LiveTensor& tensor = *decision.tensor;
+      if (required_savings <= 0) {
+        decision.kind = MemoryDecision::kKeep;
+      }
+      string action = "keep";
+      if (decision.kind == MemoryDecision::kRecompute) {
+        NodeDef* node = graph.GetNode(tensor.node);
+        (*node->mutable_attr())[kRecomputeHint].set_i(0);
+        action = "recompute";
+      } else if (decision.kind == MemoryDecision::kSwap) {
+        for (const MutableGraphView::InputPort& use : decision.uses_to_swap) {
+          AttrValue& val = (*use.node->mutable_attr())["_swap_to_host"];
+          if (val.value_case() == AttrValue::kI) {
+            const int64 input_id = val.i();
+            val.mutable_list()->add_i(input_id);
+          }
+          val.mutable_list()->add_i(use.port_id);
+        }
+        action = "swap to host";
+      }
+      if (decision.kind != MemoryDecision::kKeep) {
+        required_savings -= tensor.memory_used;
+        absl::StrAppend(&action, ", estimated cost ", decision.cost.count(),
+                        "ns");
+      }
+      absl::StrAppend(report, "  ", tensor.node, ":", tensor.output_id, " (",
+                      tensor.memory_used, " bytes): ", action, "\n");
+    }
+    if (required_savings > 0) {
+      absl::StrAppend(report, "  ", required_savings,
+                      " bytes remain over budget\n");
+    }
+  }
+  return over_budget;
+}
+
 bool CrossesTaskOrCpuGpuBoundary(const NodeDef& node1, const NodeDef& node2) {
   string task1;
   string device1;
@@ -1383,10 +1654,11 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   std::set<int> nodes_to_relax;
   TF_RETURN_IF_ERROR(FindAssignNodesToRelax(item.graph, &nodes_to_relax));
 
+  const bool cost_based = optimization_level_ == RewriterConfig::COST_BASED;
   bool run_recomputation_pass =
       (optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
        optimization_level_ == RewriterConfig::HEURISTICS ||
-       optimization_level_ == RewriterConfig::MANUAL);
+       optimization_level_ == RewriterConfig::MANUAL || cost_based);
   if (!run_recomputation_pass && nodes_to_relax.empty() && item.fetch.empty()) {
     return errors::Aborted("Nothing to do.");
   }
@@ -1394,10 +1666,22 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   GrapplerItem optimized_item(item);
   RelaxAssignNodes(nodes_to_relax, &optimized_item.graph);
 
+  cost_based_report_.clear();
+  if (cost_based && !item.fetch.empty() && cluster != nullptr) {
+    // Annotates the graph with the decisions, which the passes below apply
+    // like manual annotations.
+    const bool over_budget = CostBasedMemoryPass(
+        cluster, memory_budget_bytes_, recomputation_targets_name_scope_,
+        &optimized_item, &cost_based_report_);
+    VLOG(1) << "Memory optimizer decisions for " << item.id
+            << (over_budget ? " (over budget)" : "") << ":\n"
+            << cost_based_report_;
+  }
+
   if (run_recomputation_pass) {
-    RecomputationRewritingPass(optimization_level_,
-                               recomputation_targets_name_scope_,
-                               &optimized_item.graph, item);
+    RecomputationRewritingPass(
+        cost_based ? RewriterConfig::MANUAL : optimization_level_,
+        recomputation_targets_name_scope_, &optimized_item.graph, item);
   }
 
   std::unordered_set<string> skip_list;
@@ -1426,7 +1710,7 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
-           optimization_level_ == RewriterConfig::MANUAL) &&
+           optimization_level_ == RewriterConfig::MANUAL || cost_based) &&
           cluster != nullptr) {
         if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
                          &skip_list)) {
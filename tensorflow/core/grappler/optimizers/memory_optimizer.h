@@ -33,11 +33,15 @@ class MemoryOptimizer : public GraphOptimizer {
   // recomputation_targets_name_scope: Name scope for potential outputs of
   //   recomputations. See
   //   RewriterConfig::memory_optimizer_target_node_name_scope.
+  // memory_budget_bytes: Memory budget of each GPU for the COST_BASED
+  //   optimization level. See RewriterConfig::memory_optimizer_budget_bytes.
   explicit MemoryOptimizer(
       RewriterConfig::MemOptType optimization_level,
-      const string& recomputation_targets_name_scope = "gradients/")
+      const string& recomputation_targets_name_scope = "gradients/",
+      int64 memory_budget_bytes = 0)
       : optimization_level_(optimization_level),
-        recomputation_targets_name_scope_(recomputation_targets_name_scope) {}
+        recomputation_targets_name_scope_(recomputation_targets_name_scope),
+        memory_budget_bytes_(memory_budget_bytes) {}
   ~MemoryOptimizer() override {}
 
   string name() const override { return "memory_optimizer"; };
@@ -47,9 +51,15 @@ class MemoryOptimizer : public GraphOptimizer {
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* pruned_graph) override;
 
+  // Describes the decisions made by the last call to Optimize with the
+  // COST_BASED optimization level.
+  const string& cost_based_report() const { return cost_based_report_; }
+
  private:
   RewriterConfig::MemOptType optimization_level_;
   string recomputation_targets_name_scope_;
+  int64 memory_budget_bytes_;
+  string cost_based_report_;
 };
 
 }  // end namespace grappler
@@ -20,6 +20,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -346,6 +347,89 @@ TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
 #endif
 }
 
+class CostBasedMemoryOptimizerTest : public MemoryOptimizerTest {
+ protected:
+  // Builds the graph of the SwappingHeuristics test.
+  static GrapplerItem CreateItem() {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                             {128, 128, 8}, DT_FLOAT);
+    Output a = ops::Identity(s.WithOpName("a").WithDevice("/gpu:0"), v);
+    Output b = ops::Square(s.WithOpName("b").WithDevice("/gpu:0"), v);
+    Output c = ops::Sqrt(s.WithOpName("c").WithDevice("/gpu:0"), a);
+    Output d = ops::Identity(s.WithOpName("d").WithDevice("/gpu:0"), b);
+    Output axis = ops::Const(s.WithOpName("axis"), 0);
+    Output e =
+        ops::Concat(s.WithOpName("e").WithDevice("/gpu:0"), {a, b, c, d}, axis);
+    Output f = ops::Square(s.WithOpName("f").WithDevice("/gpu:0"), a);
+    Output g = ops::Sqrt(s.WithOpName("g").WithDevice("/gpu:0"), b);
+    Output h = ops::Exp(s.WithOpName("h").WithDevice("/gpu:0"), c);
+    Output i = ops::Log(s.WithOpName("i").WithDevice("/gpu:0"), d);
+
+    Output constant =
+        ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 8});
+    Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+    GrapplerItem item;
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    item.fetch = {"e", "f", "g", "h", "i"};
+    item.init_ops = {init.name()};
+    return item;
+  }
+
+  static int NumRewrittenNodes(const GraphDef& graph) {
+    int count = 0;
+    for (const auto& node : graph.node()) {
+      if (absl::StartsWith(node.name(), "swap_in_") ||
+          absl::StartsWith(node.name(), "Recomputed/")) {
+        ++count;
+      }
+    }
+    return count;
+  }
+};
+
+TEST_F(CostBasedMemoryOptimizerTest, WithinBudget) {
+  GrapplerItem item = CreateItem();
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  MemoryOptimizer optimizer(RewriterConfig::COST_BASED, "gradients/",
+                            /*memory_budget_bytes=*/int64{1} << 30);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  EXPECT_EQ(0, NumRewrittenNodes(output));
+  EXPECT_NE(optimizer.cost_based_report().find("budget 1073741824 bytes"),
+            string::npos)
+      << optimizer.cost_based_report();
+}
+
+TEST_F(CostBasedMemoryOptimizerTest, OverBudget) {
+  GrapplerItem item = CreateItem();
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  MemoryOptimizer optimizer(RewriterConfig::COST_BASED, "gradients/",
+                            /*memory_budget_bytes=*/1024);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  // None of the nodes is in the recomputation target scope, so the tensors
+  // alive at the peak can only be swapped.
+  EXPECT_GT(NumRewrittenNodes(output), 0);
+  const string& report = optimizer.cost_based_report();
+  EXPECT_NE(report.find("swap to host"), string::npos) << report;
+  EXPECT_EQ(report.find("recompute"), string::npos) << report;
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+#endif
+}
+
 TEST_F(MemoryOptimizerTest, UnswappableInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
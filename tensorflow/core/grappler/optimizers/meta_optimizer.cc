@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
+#include <algorithm>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
@@ -41,6 +45,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/optimized_function_cache.h"
+#include "tensorflow/core/grappler/optimizers/multi_tensor_apply_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
@@ -53,6 +59,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/util.h"
@@ -65,6 +74,11 @@ namespace {
 
 constexpr int kDefaultNumberOfIterations = 2;
 constexpr int kDefaultMinGraphNodes = 4;
+// A skippable optimizer is skipped on a function body after this many
+// consecutive runs that did not change its size.
+constexpr int kMinUnproductiveRuns = 2;
+// Bounds the number of (function, optimizer) pairs remembered by the process.
+constexpr size_t kMaxFunctionPassHistoryEntries = 1 << 16;
 
 int64 NumEdges(const GraphDef& graph) {
   int64 num_edges = 0;
@@ -91,9 +105,56 @@ int NumIterations(const RewriterConfig& cfg) {
 bool IsRunOnceOptimizer(const string& name) {
   return name == "layout" || name == "memory_optimizer" ||
          name == "loop_optimizer" || name == "auto_mixed_precision" ||
-         name == "auto_mixed_precision_mkl";
+         name == "auto_mixed_precision_mkl" ||
+         name == "auto_mixed_precision_cpu";
+}
+
+// Check if optimizer is expensive, and may be skipped on function bodies that
+// it does not simplify (see RewriterConfig.skip_unproductive_function_passes).
+bool IsSkippableFunctionOptimizer(const string& name) {
+  return name == "arithmetic_optimizer" || name == "constant_folding" ||
+         name == "dependency_optimizer" ||
+         name == "common_subgraph_elimination" || name == "loop_optimizer" ||
+         name == "remapper";
 }
 
+// Remembers how often each skippable optimizer ran on each function body, and
+// how often that changed the number of nodes. It is shared by all
+// MetaOptimizer instances, so that functions that are instantiated or traced
+// repeatedly benefit from earlier runs.
+class FunctionPassHistory {
+ public:
+  static FunctionPassHistory* Global() {
+    static FunctionPassHistory* history = new FunctionPassHistory();
+    return history;
+  }
+
+  // Returns true if none of the last kMinUnproductiveRuns runs of `optimizer`
+  // on `function` changed its size.
+  bool IsUnproductive(const string& function, const string& optimizer) const {
+    mutex_lock l(mu_);
+    auto it = runs_.find(std::make_pair(function, optimizer));
+    return it != runs_.end() && it->second >= kMinUnproductiveRuns;
+  }
+
+  void Record(const string& function, const string& optimizer,
+              bool productive) {
+    mutex_lock l(mu_);
+    auto key = std::make_pair(function, optimizer);
+    if (productive) {
+      runs_.erase(key);
+    } else if (runs_.size() < kMaxFunctionPassHistoryEntries ||
+               runs_.contains(key)) {
+      ++runs_[key];
+    }
+  }
+
+ private:
+  mutable mutex mu_;
+  // Number of consecutive unproductive runs of each optimizer on each function.
+  absl::flat_hash_map<std::pair<string, string>, int> runs_ TF_GUARDED_BY(mu_);
+};
+
 // Creates a function library stub from a real function library: copy only
 // signatures and attributes of all the function defined in fdef_lib. This stub
 // can be swapped with real function library in a graph, before passing it to
@@ -170,6 +231,48 @@ Status GetGraphDevice(const GraphDef& g_def, std::set<std::string>* devices) {
   return Status::OK();
 }
 
+uint64 FingerprintProto(const protobuf::MessageLite& proto) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  return Fingerprint64(serialized);
+}
+
+// Returns the key of the result of optimizing `func_item`, made from `func`,
+// in the OptimizedFunctionCache. `func_item.graph` holds the function body and
+// all the functions it can call.
+uint64 OptimizedFunctionCacheKey(const FunctionDef& func,
+                                 const GrapplerFunctionItem& func_item,
+                                 const ConfigProto& config,
+                                 const Cluster* cluster, bool has_cpu_device) {
+  ConfigProto keyed_config = config;
+  // The location of the cache does not change the result.
+  keyed_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->clear_function_optimization_cache_dir();
+  uint64 key = FingerprintCat64(FingerprintProto(func),
+                                FingerprintProto(func_item.graph));
+  key = FingerprintCat64(key, FingerprintProto(keyed_config));
+  const GrapplerItem::OptimizationOptions& options =
+      func_item.optimization_options();
+  key = FingerprintCat64(
+      key, (options.allow_non_differentiable_rewrites ? 1 : 0) |
+               (options.allow_pruning_stateful_and_dataset_ops ? 2 : 0) |
+               (has_cpu_device ? 4 : 0));
+  if (cluster != nullptr) {
+    const std::unordered_map<string, DeviceProperties>& devices =
+        cluster->GetDevices();
+    std::vector<string> device_names;
+    device_names.reserve(devices.size());
+    for (const auto& device : devices) device_names.push_back(device.first);
+    std::sort(device_names.begin(), device_names.end());
+    for (const string& name : device_names) {
+      key = FingerprintCat64(key, Fingerprint64(name));
+      key = FingerprintCat64(key, FingerprintProto(devices.at(name)));
+    }
+  }
+  return key;
+}
+
 }  // namespace
 
 #define MK_OPT(NAME, CONFIG, VALUE)                                    \
@@ -196,8 +299,11 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   if (optimizer == "pruning" && !plugin_configs.disable_model_pruning)
     return std::unique_ptr<GraphOptimizer>(new ModelPruner());
   MK_OPT("function", "function_optimization",
-         new FunctionOptimizer(cfg_.function_optimization(),
-                               /*lower_control_flow=*/LowerControlFlow()));
+         new FunctionOptimizer(
+             cfg_.function_optimization(),
+             /*lower_control_flow=*/LowerControlFlow(),
+             /*specialize_input_shapes=*/
+             cfg_.function_shape_specialization() == RewriterConfig::ON));
   MK_OPT("constfold", "constant_folding",
          new ConstantFolding(
              cpu_device_,
@@ -209,7 +315,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("layout", "layout_optimizer",
          new GenericLayoutOptimizer(
              /*optimization level*/ cfg_.layout_optimizer(),
-             /*CPU layout conversion*/ cfg_.cpu_layout_conversion()));
+             /*CPU layout conversion*/ cfg_.cpu_layout_conversion(),
+             /*autotune directory*/ cfg_.layout_optimizer_autotune_dir()));
   MK_OPT("auto_mixed_precision", "auto_mixed_precision",
          new AutoMixedPrecision(AutoMixedPrecisionMode::CUDA));
 #ifdef INTEL_MKL
@@ -218,6 +325,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
            new AutoMixedPrecision(AutoMixedPrecisionMode::MKL));
   }
 #endif
+  MK_OPT("auto_mixed_precision_cpu", "auto_mixed_precision_cpu",
+         new AutoMixedPrecision(AutoMixedPrecisionMode::CPU));
   MK_OPT("memory", "memory_optimization",
          new MemoryOptimizer(RewriterConfig::MANUAL));
   MK_OPT("common_subgraph_elimination", "common_subgraph_elimination",
@@ -236,6 +345,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
                                       cfg_.scoped_allocator_opts()));
   MK_OPT("pin_to_host", "pin_to_host_optimization",
          new PinToHostOptimizer(cfg_.pin_to_host_optimization()));
+  MK_OPT("multi_tensor_apply", "multi_tensor_apply",
+         new MultiTensorApplyOptimizer());
 
   return std::unique_ptr<GraphOptimizer>();
 }
@@ -280,7 +391,9 @@ Status MetaOptimizer::InitializeOptimizers(
   if (BOTH_NOT_OFF(function_optimization)) {
     optimizers->push_back(MakeUnique<FunctionOptimizer>(
         cfg_.function_optimization(),
-        /*lower_control_flow=*/LowerControlFlow()));
+        /*lower_control_flow=*/LowerControlFlow(),
+        /*specialize_input_shapes=*/
+        cfg_.function_shape_specialization() == RewriterConfig::ON));
   }
   if (BOTH_NOT_OFF(common_subgraph_elimination) &&
       BOTH_NOT_OFF(arithmetic_optimization)) {
@@ -314,6 +427,12 @@ Status MetaOptimizer::InitializeOptimizers(
         MakeUnique<AutoMixedPrecision>(AutoMixedPrecisionMode::MKL));
   }
 #endif
+  if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu()) &&
+      AutoMixedPrecisionEnabled(
+          plugin_configs.toggle_config["auto_mixed_precision_cpu"])) {
+    optimizers->push_back(
+        MakeUnique<AutoMixedPrecision>(AutoMixedPrecisionMode::CPU));
+  }
   if (BOTH_ARE_ON(pin_to_host_optimization)) {
     optimizers->push_back(MakeUnique<PinToHostOptimizer>());
   }
@@ -344,11 +463,13 @@ Status MetaOptimizer::InitializeOptimizers(
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
       optimizers->push_back(
           // Use the default target node name prefix "gradients/"
-          MakeUnique<MemoryOptimizer>(cfg_.memory_optimization()));
+          MakeUnique<MemoryOptimizer>(cfg_.memory_optimization(), "gradients/",
+                                      cfg_.memory_optimizer_budget_bytes()));
     } else {
       optimizers->push_back(MakeUnique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_optimizer_budget_bytes()));
     }
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
@@ -356,6 +477,10 @@ Status MetaOptimizer::InitializeOptimizers(
         MakeUnique<AutoParallel>(cfg_.auto_parallel().num_replicas()));
   }
 
+  if (BOTH_ARE_ON(multi_tensor_apply)) {
+    optimizers->push_back(MakeUnique<MultiTensorApplyOptimizer>());
+  }
+
 #ifndef ENABLE_MKL
   if (BOTH_ARE_ON(scoped_allocator_optimization)) {
     optimizers->push_back(MakeUnique<ScopedAllocatorOptimizer>(
@@ -503,6 +628,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     PRINT_CFG(loop_optimization)
     PRINT_CFG(dependency_optimization)
     PRINT_CFG(scoped_allocator_optimization)
+    PRINT_CFG(multi_tensor_apply)
 #undef PRINT_CFG
     user_cfg.toggle_config["auto_mixed_precision"] =
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision())
@@ -512,6 +638,10 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_mkl())
             ? RewriterConfig::ON
             : RewriterConfig::OFF;
+    user_cfg.toggle_config["auto_mixed_precision_cpu"] =
+        AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu())
+            ? RewriterConfig::ON
+            : RewriterConfig::OFF;
     user_cfg.toggle_config["memory_optimization"] =
         MemoryOptimizerEnabled(cfg_.memory_optimization(),
                                config_proto_.graph_options()
@@ -539,6 +669,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("shape", "shape_optimization")
       PRINT_CFG("auto_mixed_precision", "auto_mixed_precision")
       PRINT_CFG("auto_mixed_precision_mkl", "auto_mixed_precision_mkl")
+      PRINT_CFG("auto_mixed_precision_cpu", "auto_mixed_precision_cpu")
       PRINT_CFG("pin_to_host", "pin_to_host_optimization")
       PRINT_CFG("layout", "layout_optimizer")
       PRINT_CFG("remap", "remapping")
@@ -547,6 +678,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("memory", "memory_optimization")
       PRINT_CFG("autoparallel", "auto_parallel")
       PRINT_CFG("scoped_allocator", "scoped_allocator_optimization")
+      PRINT_CFG("multi_tensor_apply", "multi_tensor_apply")
 #undef PRINT_CFG
     }
   }
@@ -578,8 +710,10 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     if (pair.first == "debug_stripper" ||
         pair.first == "auto_mixed_precision" ||
         pair.first == "auto_mixed_precision_mkl" ||
+        pair.first == "auto_mixed_precision_cpu" ||
         pair.first == "pin_to_host_optimization" ||
-        pair.first == "scoped_allocator_optimization") {
+        pair.first == "scoped_allocator_optimization" ||
+        pair.first == "multi_tensor_apply") {
       // These optimizers are turned off by default.
       strings::StrAppend(
           &logs, pair.first, string(32 - pair.first.size(), ' '),
@@ -600,7 +734,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
 }
 
 Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
-                                    GraphDef* optimized_graph) {
+                                    GraphDef* optimized_graph,
+                                    bool is_function_body) {
   int min_graph_nodes = cfg_.min_graph_nodes() == 0 ? kDefaultMinGraphNodes
                                                     : cfg_.min_graph_nodes();
   if (item.graph.node_size() < min_graph_nodes) {
@@ -656,6 +791,8 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
 
   GraphOptimizationResult optimization_result(item.id);
   GraphOptimizer* sa_optimizer = nullptr;
+  const bool skip_unproductive_passes =
+      is_function_body && cfg_.skip_unproductive_function_passes();
 
   // Constants in the graph are normally compressed after model_pruner.
   // Do it here if model pruner is disabled.
@@ -692,9 +829,27 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
       }
 #endif
 
+      const bool is_skippable = skip_unproductive_passes &&
+                                IsSkippableFunctionOptimizer(optimizer->name());
+      if (is_skippable && FunctionPassHistory::Global()->IsUnproductive(
+                              item.id, optimizer->name())) {
+        VLOG(2) << "Skipping " << optimizer->name() << " on function "
+                << item.id << ", it did not change it in previous runs";
+        metrics::RecordGrapplerPassSkipped(optimizer->name());
+        continue;
+      }
+
       TF_RETURN_IF_ERROR(RunOptimizer(optimizer.get(), cluster, &item,
                                       optimized_graph, &optimization_result));
 
+      if (is_skippable) {
+        const OptimizerResult& result = optimization_result.results.back();
+        FunctionPassHistory::Global()->Record(
+            item.id, optimizer->name(),
+            /*productive=*/result.status.ok() &&
+                result.num_nodes_after != result.num_nodes_before);
+      }
+
       if (iteration == 0 && optimizer->name() == "model_pruner") {
         CompressConstants(optimized_graph);
       }
@@ -781,6 +936,11 @@ Status MetaOptimizer::RunOptimizer(
   const uint64 end_us = Env::Default()->NowMicros();
   const float duration_ms = (end_us - start_us) / 1000.0f;
   metrics::UpdateGrapplerPassTime(optimizer->name(), end_us - start_us);
+  const int num_nodes_before = optimized_item->graph.node_size();
+  const int num_nodes_after =
+      status.ok() ? optimized_graph->node_size() : num_nodes_before;
+  metrics::UpdateGrapplerPassNodeCounts(optimizer->name(), num_nodes_before,
+                                        num_nodes_after);
 
   string message;
   if (!status.ok()) {
@@ -813,6 +973,9 @@ Status MetaOptimizer::RunOptimizer(
   }
 
   OptimizerResult optimizer_result{optimizer->name(), message, status};
+  optimizer_result.duration_us = end_us - start_us;
+  optimizer_result.num_nodes_before = num_nodes_before;
+  optimizer_result.num_nodes_after = num_nodes_after;
   optimization_result->results.push_back(optimizer_result);
 
   if (!status.ok() && cfg_.fail_on_optimizer_errors()) return status;
@@ -906,6 +1069,17 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       "Deleted $0 unreachable functions from the graph (library size = $1)",
       old_library_size - new_library_size, new_library_size);
 
+  // Functions that are identical up to their names, e.g. the ones traced for
+  // each call of the same Python function, are optimized and instantiated once
+  // if their callers share one of them.
+  if (cfg_.common_subgraph_elimination() != RewriterConfig::OFF &&
+      !IsTPUGraphDef(item.graph)) {
+    const int num_deduped = DedupFunctionLibrary(&item.graph);
+    VLOG(1) << "Deduplicated " << num_deduped
+            << " functions (library size = "
+            << item.graph.library().function_size() << ")";
+  }
+
   // Save a few small fields from item before we move it.
   bool optimize_function_library =
       item.optimization_options().optimize_function_library;
@@ -1075,9 +1249,27 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
         TF_RETURN_IF_ERROR(implementation_selector.Optimize(
             cluster, func_item, &optimized_func_graph));
       } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+        const string& cache_dir = cfg_.function_optimization_cache_dir();
+        uint64 cache_key = 0;
+        if (!cache_dir.empty()) {
+          cache_key =
+              OptimizedFunctionCacheKey(func, func_item, config_proto_,
+                                        cluster, cpu_device_ != nullptr);
+        }
+        if (!cache_dir.empty() &&
+            OptimizedFunctionCache::Global()->Lookup(cache_dir, cache_key,
+                                                     &optimized_func_graph)) {
+          VLOG(2) << "Reusing cached optimized function: " << func_name;
+        } else {
+          GrapplerFunctionItem func_item_copy = func_item;
+          TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
+                                           &optimized_func_graph,
+                                           /*is_function_body=*/true));
+          if (!cache_dir.empty()) {
+            OptimizedFunctionCache::Global()->Insert(cache_dir, cache_key,
+                                                     optimized_func_graph);
+          }
+        }
       }
 
       // Function body optimization might have created new specialized
@@ -1158,8 +1350,10 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
 #endif
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
+         rewrite_cfg.multi_tensor_apply() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_mkl()) ||
+         AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_cpu()) ||
          !rewrite_cfg.optimizers().empty() ||
          !rewrite_cfg.custom_optimizers().empty();
 }
@@ -50,8 +50,31 @@ class MetaOptimizer : public GraphOptimizer {
   Status OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
                              GraphDef* optimized_graph);
 
+  // The outcome of running one optimizer on one graph.
+  struct OptimizerResult {
+    string optimizer_name;
+    string message;
+    Status status;
+    uint64 duration_us = 0;
+    int num_nodes_before = 0;
+    int num_nodes_after = 0;
+  };
+
+  // The outcomes of all optimizers run on one grappler item, i.e. on the main
+  // graph or on the body of one function.
+  struct GraphOptimizationResult {
+    explicit GraphOptimizationResult(const string& id) : id(id) {}
+    string id;
+    std::vector<OptimizerResult> results;
+  };
+
   string GetResultString() const;
 
+  // Returns the results of the last OptimizeConsumeItem call.
+  const std::vector<GraphOptimizationResult>& optimization_results() const {
+    return optimization_results_;
+  }
+
   void PrintResult();
 
  private:
@@ -92,25 +115,14 @@ class MetaOptimizer : public GraphOptimizer {
   // Run optimization pass over a single GrapplerItem. Meta optimizer might run
   // multiple such passes: 1) for the main graph 2) for the function library
   Status OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
-                       GraphDef* optimized_graph);
+                       GraphDef* optimized_graph,
+                       bool is_function_body = false);
 
   DeviceBase* const cpu_device_;  // may be NULL
   ConfigProto config_proto_;
   RewriterConfig& cfg_;
   bool xla_auto_clustering_on_;
 
-  struct OptimizerResult {
-    string optimizer_name;
-    string message;
-    Status status;
-  };
-
-  struct GraphOptimizationResult {
-    explicit GraphOptimizationResult(const string& id) : id(id) {}
-    string id;
-    std::vector<OptimizerResult> results;
-  };
-
   Status RunOptimizer(GraphOptimizer* optimizer, Cluster* cluster,
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
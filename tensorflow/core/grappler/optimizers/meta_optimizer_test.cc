@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -617,6 +618,116 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneFunctionBody) {
   test::ExpectTensorEqual<float>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryWithCache) {
+  using test::function::NDef;
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("pruning");
+  rewriter_config.set_min_graph_nodes(-1);
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "optimized_function_cache");
+  rewriter_config.set_function_optimization_cache_dir(cache_dir);
+
+  // MyFunc has an Identity node that pruning removes.
+  FunctionDef my_func = FunctionDefHelper::Create(
+      "MyFunc", {"x:float"}, {"z:float"}, {},
+      {{{"id"}, "Identity", {"x"}, {{"T", DT_FLOAT}}},
+       {{"neg"}, "Neg", {"id:output:0"}, {{"T", DT_FLOAT}}}},
+      /*ret_def=*/{{"z", "neg:y:0"}});
+  (*my_func.mutable_attr())["_noinline"].set_b(true);
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("fn", "MyFunc", {"a"}, {}, kDevice),
+       NDef("out", "Identity", {"fn"}, {{"T", DT_FLOAT}}, kDevice)},
+      /*funcs=*/{my_func});
+  item.fetch = {"out"};
+
+  GraphDef output;
+  {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  }
+  std::vector<string> entries;
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &entries));
+  EXPECT_FALSE(entries.empty());
+
+  // Optimizing the same graph again reuses the cached function body.
+  GraphDef cached_output;
+  {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &cached_output));
+  }
+  std::vector<string> entries_after_reuse;
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &entries_after_reuse));
+  EXPECT_EQ(entries.size(), entries_after_reuse.size());
+  CompareGraphs(output, cached_output);
+  ASSERT_EQ(output.library().function_size(), 1);
+  ASSERT_EQ(cached_output.library().function_size(), 1);
+  CompareFunctions(output.library().function(0),
+                   cached_output.library().function(0));
+}
+
+TEST_F(MetaOptimizerTest, SkipUnproductiveFunctionPasses) {
+  using test::function::NDef;
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("constfold");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_skip_unproductive_function_passes(true);
+
+  // There is nothing to fold in UnproductiveFunc.
+  FunctionDef my_func = FunctionDefHelper::Create(
+      "UnproductiveFunc", {"x:float"}, {"z:float"}, {},
+      {{{"neg"}, "Neg", {"x"}, {{"T", DT_FLOAT}}}},
+      /*ret_def=*/{{"z", "neg:y:0"}});
+  (*my_func.mutable_attr())["_noinline"].set_b(true);
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("fn", "UnproductiveFunc", {"a"}, {}, kDevice),
+       NDef("out", "Identity", {"fn"}, {{"T", DT_FLOAT}}, kDevice)},
+      /*funcs=*/{my_func});
+  item.fetch = {"out"};
+
+  const auto num_constant_folding_runs =
+      [](const MetaOptimizer& optimizer, const string& id) {
+        int num_runs = 0;
+        for (const auto& graph_result : optimizer.optimization_results()) {
+          if (graph_result.id != id) continue;
+          for (const auto& result : graph_result.results) {
+            if (result.optimizer_name == "constant_folding") ++num_runs;
+          }
+        }
+        return num_runs;
+      };
+
+  // Both iterations of the first run optimize the function body.
+  GraphDef output;
+  {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+    EXPECT_EQ(num_constant_folding_runs(optimizer, "UnproductiveFunc"), 2);
+  }
+
+  // The next run skips constant folding on the function body, but not on the
+  // main graph.
+  {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+    EXPECT_EQ(num_constant_folding_runs(optimizer, "UnproductiveFunc"), 0);
+    EXPECT_EQ(num_constant_folding_runs(optimizer, "tf_graph"), 2);
+  }
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryWithRestrictions) {
   using test::function::NDef;
   using FDH = FunctionDefHelper;
@@ -0,0 +1,261 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/multi_tensor_apply_optimizer.h"
+
+#include <deque>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// The inputs of an update op that the Multi op takes as lists: the variables
+// and the gradient. The Multi op takes the same inputs in the same order.
+struct MultiApplyOp {
+  const char* op;
+  const char* multi_op;
+  int num_inputs;
+  int num_var_inputs;  // The variable and its slots come first.
+  int grad_input;
+};
+
+constexpr MultiApplyOp kMultiApplyOps[] = {
+    {"ResourceApplyAdam", "ResourceApplyAdamMulti", 10, 3, 9},
+    {"ResourceApplyMomentum", "ResourceApplyMomentumMulti", 5, 2, 3},
+};
+
+const MultiApplyOp* FindMultiApplyOp(const NodeDef& node) {
+  for (const MultiApplyOp& op : kMultiApplyOps) {
+    if (node.op() == op.op) return &op;
+  }
+  return nullptr;
+}
+
+bool IsListInput(const MultiApplyOp& op, int input) {
+  return input < op.num_var_inputs || input == op.grad_input;
+}
+
+// Returns whether the update `node` can be part of a Multi op.
+bool CanGroup(const MultiApplyOp& op, const NodeDef& node) {
+  if (node.input_size() < op.num_inputs) return false;
+  for (int i = 0; i < op.num_inputs; ++i) {
+    if (IsControlInput(node.input(i))) return false;
+  }
+  // The Multi ops only have CPU and GPU kernels.
+  DeviceNameUtils::ParsedName parsed;
+  if (!DeviceNameUtils::ParseFullName(node.device(), &parsed) ||
+      !parsed.has_type ||
+      (parsed.type != DEVICE_CPU && parsed.type != DEVICE_GPU)) {
+    return false;
+  }
+  // The Multi op only keeps the attributes of the op and the colocation
+  // constraints, which have been enforced by the placement.
+  for (const auto& attr : node.attr()) {
+    if (attr.first != "T" && attr.first != "use_locking" &&
+        attr.first != "use_nesterov" && attr.first != kColocationAttrName) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the key of the Multi op that the update `node` can be part of.
+string GroupKey(const MultiApplyOp& op, const NodeDef& node) {
+  DataType dtype = DT_INVALID;
+  bool use_locking = false;
+  bool use_nesterov = false;
+  TryGetNodeAttr(node, "T", &dtype);
+  TryGetNodeAttr(node, "use_locking", &use_locking);
+  TryGetNodeAttr(node, "use_nesterov", &use_nesterov);
+  std::vector<string> scalar_inputs;
+  for (int i = 0; i < op.num_inputs; ++i) {
+    if (!IsListInput(op, i)) scalar_inputs.push_back(node.input(i));
+  }
+  return strings::StrCat(op.op, ";", node.device(), ";", DataTypeString(dtype),
+                         ";", use_locking, ";", use_nesterov, ";",
+                         absl::StrJoin(scalar_inputs, ";"));
+}
+
+// Returns the Multi op that does the updates of `nodes`.
+NodeDef MakeMultiApplyNode(const MultiApplyOp& op,
+                           const std::vector<const NodeDef*>& nodes) {
+  const NodeDef& first = *nodes.front();
+  NodeDef multi;
+  multi.set_name(AddPrefixToNodeName(first.name(), "MultiTensorApply"));
+  multi.set_op(op.multi_op);
+  multi.set_device(first.device());
+  for (int i = 0; i < op.num_inputs; ++i) {
+    if (!IsListInput(op, i)) {
+      multi.add_input(first.input(i));
+      continue;
+    }
+    for (const NodeDef* node : nodes) multi.add_input(node->input(i));
+  }
+  std::set<string> control_inputs;
+  for (const NodeDef* node : nodes) {
+    for (int i = op.num_inputs; i < node->input_size(); ++i) {
+      if (control_inputs.insert(node->input(i)).second) {
+        multi.add_input(node->input(i));
+      }
+    }
+  }
+  for (const char* attr : {"T", "use_locking", "use_nesterov"}) {
+    auto it = first.attr().find(attr);
+    if (it != first.attr().end()) (*multi.mutable_attr())[attr] = it->second;
+  }
+  (*multi.mutable_attr())["N"].set_i(nodes.size());
+  return multi;
+}
+
+}  // namespace
+
+Status MultiTensorApplyOptimizer::Optimize(Cluster* /*cluster*/,
+                                           const GrapplerItem& item,
+                                           GraphDef* output) {
+  const GraphDef& graph = item.graph;
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  std::unordered_map<string, int> node_index;
+  std::vector<const MultiApplyOp*> update_op(graph.node_size(), nullptr);
+  int num_updates = 0;
+  for (int i = 0; i < graph.node_size(); ++i) {
+    const NodeDef& node = graph.node(i);
+    // Only the nodes of one frame, and that all run, can be grouped.
+    if (IsSwitch(node) || IsEnter(node)) {
+      return errors::Aborted("Nothing to do.");
+    }
+    node_index[node.name()] = i;
+    update_op[i] = FindMultiApplyOp(node);
+    if (update_op[i] != nullptr) ++num_updates;
+  }
+  if (num_updates < 2) {
+    return errors::Aborted("Nothing to do.");
+  }
+
+  // Find the updates that other updates reach, with one traversal from all of
+  // them.
+  std::vector<std::vector<int>> fanouts(graph.node_size());
+  for (int i = 0; i < graph.node_size(); ++i) {
+    for (const string& input : graph.node(i).input()) {
+      auto it = node_index.find(NodeName(input));
+      if (it != node_index.end()) fanouts[it->second].push_back(i);
+    }
+  }
+  std::vector<bool> reached(graph.node_size(), false);
+  std::deque<int> queue;
+  for (int i = 0; i < graph.node_size(); ++i) {
+    if (update_op[i] == nullptr) continue;
+    for (int fanout : fanouts[i]) {
+      if (!reached[fanout]) {
+        reached[fanout] = true;
+        queue.push_back(fanout);
+      }
+    }
+  }
+  while (!queue.empty()) {
+    const int node = queue.front();
+    queue.pop_front();
+    for (int fanout : fanouts[node]) {
+      if (!reached[fanout]) {
+        reached[fanout] = true;
+        queue.push_back(fanout);
+      }
+    }
+  }
+
+  // Group the updates of distinct variables by the Multi op they can share, in
+  // the order of the graph.
+  std::map<string, std::vector<int>> groups;
+  std::set<string> grouped_vars;
+  for (int i = 0; i < graph.node_size(); ++i) {
+    const NodeDef& node = graph.node(i);
+    if (update_op[i] == nullptr || reached[i] ||
+        nodes_to_preserve.count(node.name()) > 0 ||
+        !CanGroup(*update_op[i], node)) {
+      continue;
+    }
+    const string key = GroupKey(*update_op[i], node);
+    if (!grouped_vars.insert(strings::StrCat(key, ";", node.input(0))).second) {
+      continue;
+    }
+    groups[key].push_back(i);
+  }
+
+  *output = graph;
+  std::unordered_map<string, string> multi_node_names;
+  std::set<int> nodes_to_delete;
+  for (const auto& group : groups) {
+    if (group.second.size() < 2) continue;
+    std::vector<const NodeDef*> nodes;
+    for (int i : group.second) nodes.push_back(&graph.node(i));
+    const MultiApplyOp& op = *update_op[group.second.front()];
+    NodeDef multi = MakeMultiApplyNode(op, nodes);
+    if (node_index.count(multi.name()) > 0 ||
+        !IsKernelRegisteredForNode(multi).ok()) {
+      continue;
+    }
+    VLOG(2) << "Updating " << nodes.size() << " variables with "
+            << multi.name();
+    for (int i : group.second) {
+      multi_node_names[graph.node(i).name()] = multi.name();
+      nodes_to_delete.insert(i);
+    }
+    *output->add_node() = std::move(multi);
+  }
+  if (nodes_to_delete.empty()) {
+    return errors::Aborted("Nothing to do.");
+  }
+
+  // The updates have no outputs, so only control dependencies on them move to
+  // the Multi ops.
+  for (NodeDef& node : *output->mutable_node()) {
+    std::set<string> control_inputs;
+    int num_inputs = 0;
+    for (int i = 0; i < node.input_size(); ++i) {
+      string input = node.input(i);
+      if (IsControlInput(input)) {
+        auto it = multi_node_names.find(NodeName(input));
+        if (it != multi_node_names.end()) {
+          input = AsControlDependency(it->second);
+        }
+        if (!control_inputs.insert(input).second) continue;
+      }
+      *node.mutable_input(num_inputs++) = input;
+    }
+    node.mutable_input()->DeleteSubrange(num_inputs,
+                                         node.input_size() - num_inputs);
+  }
+  EraseNodesFromGraph(nodes_to_delete, output);
+  return Status::OK();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
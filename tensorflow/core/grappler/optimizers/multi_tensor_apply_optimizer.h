@@ -0,0 +1,49 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MULTI_TENSOR_APPLY_OPTIMIZER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MULTI_TENSOR_APPLY_OPTIMIZER_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// MultiTensorApplyOptimizer replaces the ResourceApplyAdam and
+// ResourceApplyMomentum nodes that update different variables on the same
+// device, with the same hyperparameters, by one ResourceApplyAdamMulti or
+// ResourceApplyMomentumMulti node, which updates all the variables in one
+// kernel launch on GPU.
+//
+// A node is only grouped if no other update node reaches it, so that waiting
+// for the inputs of all the nodes of a group can't create a cycle. Graphs with
+// v1 control flow are left alone.
+class MultiTensorApplyOptimizer : public GraphOptimizer {
+ public:
+  MultiTensorApplyOptimizer() {}
+  ~MultiTensorApplyOptimizer() override {}
+
+  string name() const override { return "multi_tensor_apply"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MULTI_TENSOR_APPLY_OPTIMIZER_H_
@@ -0,0 +1,217 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/multi_tensor_apply_optimizer.h"
+
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+constexpr char kDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+class MultiTensorApplyOptimizerTest : public GrapplerTest {
+ protected:
+  // Adds the variables of an update of `var`, and its gradient.
+  void AddVariable(const string& var, int num_slots, GraphDef* graph) {
+    *graph->add_node() =
+        NDef(var, "VarHandleOp", {}, {{"dtype", DT_FLOAT}}, kDevice);
+    for (int i = 0; i < num_slots; ++i) {
+      *graph->add_node() = NDef(absl::StrCat(var, "_slot", i), "VarHandleOp",
+                                {}, {{"dtype", DT_FLOAT}}, kDevice);
+    }
+    *graph->add_node() = NDef(absl::StrCat(var, "_grad"), "Placeholder", {},
+                              {{"dtype", DT_FLOAT}}, kDevice);
+  }
+
+  // Adds a ResourceApplyAdam of `var`, with the hyperparameters in `lr`.
+  NodeDef* AddAdam(const string& name, const string& var, const string& lr,
+                   GraphDef* graph) {
+    AddVariable(var, /*num_slots=*/2, graph);
+    NodeDef* node = graph->add_node();
+    *node = NDef(name, "ResourceApplyAdam",
+                 {var, absl::StrCat(var, "_slot0"), absl::StrCat(var, "_slot1"),
+                  lr, lr, lr, lr, lr, lr, absl::StrCat(var, "_grad")},
+                 {{"T", DT_FLOAT}, {"use_locking", false},
+                  {"use_nesterov", false}},
+                 kDevice);
+    return node;
+  }
+
+  NodeDef* AddMomentum(const string& name, const string& var,
+                       bool use_nesterov, GraphDef* graph) {
+    AddVariable(var, /*num_slots=*/1, graph);
+    NodeDef* node = graph->add_node();
+    *node = NDef(name, "ResourceApplyMomentum",
+                 {var, absl::StrCat(var, "_slot0"), "lr",
+                  absl::StrCat(var, "_grad"), "lr"},
+                 {{"T", DT_FLOAT},
+                  {"use_locking", false},
+                  {"use_nesterov", use_nesterov}},
+                 kDevice);
+    return node;
+  }
+
+  void AddScalar(const string& name, GraphDef* graph) {
+    *graph->add_node() =
+        NDef(name, "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice);
+  }
+
+  void AddTrain(const std::vector<string>& updates, GraphDef* graph,
+                GrapplerItem* item) {
+    std::vector<string> inputs;
+    for (const string& update : updates) {
+      inputs.push_back(AsControlDependency(update));
+    }
+    *graph->add_node() = NDef("train", "NoOp", inputs, {}, kDevice);
+    item->fetch = {"train"};
+  }
+};
+
+TEST_F(MultiTensorApplyOptimizerTest, GroupsAdamUpdates) {
+  GrapplerItem item;
+  GraphDef& graph = item.graph;
+  AddScalar("lr", &graph);
+  AddAdam("adam_0", "var_0", "lr", &graph);
+  AddAdam("adam_1", "var_1", "lr", &graph);
+  AddAdam("adam_2", "var_2", "lr", &graph)->add_input("^lr");
+  AddTrain({"adam_0", "adam_1", "adam_2"}, &graph, &item);
+
+  MultiTensorApplyOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  EXPECT_EQ(node_map.GetNode("adam_0"), nullptr);
+  EXPECT_EQ(node_map.GetNode("adam_1"), nullptr);
+  EXPECT_EQ(node_map.GetNode("adam_2"), nullptr);
+  const NodeDef* multi = node_map.GetNode("MultiTensorApply/adam_0");
+  ASSERT_NE(multi, nullptr);
+  EXPECT_EQ(multi->op(), "ResourceApplyAdamMulti");
+  EXPECT_EQ(multi->device(), kDevice);
+  EXPECT_EQ(multi->attr().at("N").i(), 3);
+  EXPECT_EQ(multi->attr().at("T").type(), DT_FLOAT);
+  const std::vector<string> expected_inputs = {
+      "var_0",       "var_1",       "var_2",       "var_0_slot0", "var_1_slot0",
+      "var_2_slot0", "var_0_slot1", "var_1_slot1", "var_2_slot1", "lr",
+      "lr",          "lr",          "lr",          "lr",          "lr",
+      "var_0_grad",  "var_1_grad",  "var_2_grad",  "^lr"};
+  ASSERT_EQ(multi->input_size(), expected_inputs.size());
+  for (int i = 0; i < expected_inputs.size(); ++i) {
+    EXPECT_EQ(multi->input(i), expected_inputs[i]);
+  }
+
+  const NodeDef* train = node_map.GetNode("train");
+  ASSERT_EQ(train->input_size(), 1);
+  EXPECT_EQ(train->input(0), "^MultiTensorApply/adam_0");
+}
+
+TEST_F(MultiTensorApplyOptimizerTest, GroupsByHyperparameters) {
+  GrapplerItem item;
+  GraphDef& graph = item.graph;
+  AddScalar("lr", &graph);
+  AddMomentum("momentum_0", "var_0", /*use_nesterov=*/false, &graph);
+  AddMomentum("momentum_1", "var_1", /*use_nesterov=*/true, &graph);
+  AddMomentum("momentum_2", "var_2", /*use_nesterov=*/false, &graph);
+  AddMomentum("momentum_3", "var_3", /*use_nesterov=*/true, &graph);
+  AddAdam("adam_0", "var_4", "lr", &graph);
+  AddTrain({"momentum_0", "momentum_1", "momentum_2", "momentum_3", "adam_0"},
+           &graph, &item);
+
+  MultiTensorApplyOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* momentum = node_map.GetNode("MultiTensorApply/momentum_0");
+  ASSERT_NE(momentum, nullptr);
+  EXPECT_EQ(momentum->op(), "ResourceApplyMomentumMulti");
+  EXPECT_FALSE(momentum->attr().at("use_nesterov").b());
+  EXPECT_EQ(momentum->input(0), "var_0");
+  EXPECT_EQ(momentum->input(1), "var_2");
+  EXPECT_EQ(momentum->input(4), "lr");
+  EXPECT_EQ(momentum->input(5), "var_0_grad");
+  EXPECT_EQ(momentum->input(6), "var_2_grad");
+  EXPECT_EQ(momentum->input(7), "lr");
+  const NodeDef* nesterov = node_map.GetNode("MultiTensorApply/momentum_1");
+  ASSERT_NE(nesterov, nullptr);
+  EXPECT_TRUE(nesterov->attr().at("use_nesterov").b());
+  // There is no other Adam update to group with.
+  EXPECT_NE(node_map.GetNode("adam_0"), nullptr);
+
+  const NodeDef* train = node_map.GetNode("train");
+  ASSERT_EQ(train->input_size(), 3);
+  EXPECT_EQ(train->input(0), "^MultiTensorApply/momentum_0");
+  EXPECT_EQ(train->input(1), "^MultiTensorApply/momentum_1");
+  EXPECT_EQ(train->input(2), "^adam_0");
+}
+
+TEST_F(MultiTensorApplyOptimizerTest, KeepsUpdatesThatOtherUpdatesReach) {
+  GrapplerItem item;
+  GraphDef& graph = item.graph;
+  AddScalar("lr", &graph);
+  AddAdam("adam_0", "var_0", "lr", &graph);
+  AddAdam("adam_1", "var_1", "lr", &graph);
+  // The gradient of var_2 is computed after var_0 is updated.
+  AddAdam("adam_2", "var_2", "lr", &graph);
+  graph.mutable_node(graph.node_size() - 2)->add_input("^adam_0");
+  AddTrain({"adam_0", "adam_1", "adam_2"}, &graph, &item);
+
+  MultiTensorApplyOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* multi = node_map.GetNode("MultiTensorApply/adam_0");
+  ASSERT_NE(multi, nullptr);
+  EXPECT_EQ(multi->attr().at("N").i(), 2);
+  ASSERT_NE(node_map.GetNode("adam_2"), nullptr);
+  const NodeDef* grad = node_map.GetNode("var_2_grad");
+  ASSERT_EQ(grad->input_size(), 1);
+  EXPECT_EQ(grad->input(0), "^MultiTensorApply/adam_0");
+}
+
+TEST_F(MultiTensorApplyOptimizerTest, NothingToGroup) {
+  GrapplerItem item;
+  GraphDef& graph = item.graph;
+  AddScalar("lr_0", &graph);
+  AddScalar("lr_1", &graph);
+  AddAdam("adam_0", "var_0", "lr_0", &graph);
+  AddAdam("adam_1", "var_1", "lr_1", &graph);
+  // The same variable can't be updated twice by one op.
+  *graph.add_node() = graph.node(graph.node_size() - 6);
+  graph.mutable_node(graph.node_size() - 1)->set_name("adam_2");
+  AddTrain({"adam_0", "adam_1", "adam_2"}, &graph, &item);
+
+  MultiTensorApplyOptimizer optimizer;
+  GraphDef output;
+  EXPECT_TRUE(errors::IsAborted(optimizer.Optimize(nullptr, item, &output)));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,77 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_function_cache.h"
+
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/stringprintf.h"
+
+namespace tensorflow {
+namespace grappler {
+
+OptimizedFunctionCache* OptimizedFunctionCache::Global() {
+  static OptimizedFunctionCache* cache = new OptimizedFunctionCache();
+  return cache;
+}
+
+string OptimizedFunctionCache::EntryPath(const string& dir, uint64 key) const {
+  return io::JoinPath(
+      dir,
+      strings::Printf("%016llx.pb", static_cast<unsigned long long>(key)));
+}
+
+bool OptimizedFunctionCache::Lookup(const string& dir, uint64 key,
+                                    GraphDef* optimized_body) {
+  const string path = EntryPath(dir, key);
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(path);
+    if (it != entries_.end()) {
+      *optimized_body = it->second;
+      return true;
+    }
+  }
+  if (!env_->FileExists(path).ok()) return false;
+  Status s = ReadBinaryProto(env_, path, optimized_body);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring unreadable optimized function " << path << ": "
+                 << s;
+    return false;
+  }
+  VLOG(2) << "Loaded optimized function from " << path;
+  mutex_lock l(mu_);
+  entries_.emplace(path, *optimized_body);
+  return true;
+}
+
+void OptimizedFunctionCache::Insert(const string& dir, uint64 key,
+                                    const GraphDef& optimized_body) {
+  const string path = EntryPath(dir, key);
+  {
+    mutex_lock l(mu_);
+    entries_[path] = optimized_body;
+  }
+  // Concurrent readers never see a partially written entry.
+  Status s = env_->RecursivelyCreateDir(dir);
+  if (s.ok()) s = AtomicWriteBinaryProto(env_, path, optimized_body);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to store optimized function " << path << ": "
+                 << s;
+  }
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
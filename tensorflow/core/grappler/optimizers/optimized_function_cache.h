@@ -0,0 +1,67 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_FUNCTION_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_FUNCTION_CACHE_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Caches the function bodies optimized by the MetaOptimizer, keyed by a
+// fingerprint of everything the optimization depends on.  The layout optimizer
+// also uses it to store the graphs converted to their autotuned layout.
+//
+// Entries are kept in memory for the lifetime of the process, and are also
+// written to a directory so that later processes optimizing the same functions
+// can reuse them.  Several processes may share the directory.
+class OptimizedFunctionCache {
+ public:
+  explicit OptimizedFunctionCache(Env* env = Env::Default()) : env_(env) {}
+
+  // Returns the cache shared by all MetaOptimizers of this process.
+  static OptimizedFunctionCache* Global();
+
+  // Returns true and sets `*optimized_body` if an entry exists for `key`,
+  // either in memory or in `dir`.
+  bool Lookup(const string& dir, uint64 key, GraphDef* optimized_body);
+
+  // Stores `optimized_body` as the entry for `key`, in memory and in `dir`.
+  // Failing to write the entry to `dir` is logged but not an error.
+  void Insert(const string& dir, uint64 key, const GraphDef& optimized_body);
+
+ private:
+  string EntryPath(const string& dir, uint64 key) const;
+
+  Env* const env_;
+  mutex mu_;
+  // Keyed by the path of the entry, so that directories don't mix.
+  absl::flat_hash_map<string, GraphDef> entries_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(OptimizedFunctionCache);
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_FUNCTION_CACHE_H_
@@ -0,0 +1,88 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_function_cache.h"
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+GraphDef GraphWithNode(const string& name) {
+  GraphDef graph;
+  graph.add_node()->set_name(name);
+  return graph;
+}
+
+string CacheDir(const string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+TEST(OptimizedFunctionCacheTest, LookupMissing) {
+  OptimizedFunctionCache cache;
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup(CacheDir("missing"), 1, &graph));
+}
+
+TEST(OptimizedFunctionCacheTest, LookupInserted) {
+  OptimizedFunctionCache cache;
+  const string dir = CacheDir("inserted");
+  cache.Insert(dir, 1, GraphWithNode("a"));
+  cache.Insert(dir, 2, GraphWithNode("b"));
+  GraphDef graph;
+  ASSERT_TRUE(cache.Lookup(dir, 1, &graph));
+  EXPECT_EQ(graph.node(0).name(), "a");
+  ASSERT_TRUE(cache.Lookup(dir, 2, &graph));
+  EXPECT_EQ(graph.node(0).name(), "b");
+  EXPECT_FALSE(cache.Lookup(CacheDir("other"), 1, &graph));
+}
+
+TEST(OptimizedFunctionCacheTest, EntriesPersistAcrossCaches) {
+  const string dir = CacheDir("persisted");
+  {
+    OptimizedFunctionCache cache;
+    cache.Insert(dir, 42, GraphWithNode("persisted"));
+  }
+  // A new cache, as in a new process, finds the entry in the directory.
+  OptimizedFunctionCache cache;
+  GraphDef graph;
+  ASSERT_TRUE(cache.Lookup(dir, 42, &graph));
+  EXPECT_EQ(graph.node(0).name(), "persisted");
+}
+
+TEST(OptimizedFunctionCacheTest, CorruptEntryIsAMiss) {
+  const string dir = CacheDir("corrupt");
+  {
+    OptimizedFunctionCache cache;
+    cache.Insert(dir, 7, GraphWithNode("a"));
+  }
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(dir, &children));
+  ASSERT_EQ(children.size(), 1);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(),
+                                 io::JoinPath(dir, children[0]), "garbage"));
+  OptimizedFunctionCache cache;
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup(dir, 7, &graph));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
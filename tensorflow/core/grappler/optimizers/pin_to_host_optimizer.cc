@@ -15,18 +15,27 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 
+#include <map>
+
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/grappler/costs/virtual_placer.h"
 #include "tensorflow/core/grappler/graph_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/core/util/device_name_utils.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -36,6 +45,16 @@ namespace internal {
 // dynamically determined.
 constexpr int64 kTensorMaxSize = 64;
 
+// Rough model of a copy between host and device memory, used by the cost-based
+// refinement: a fixed launch and synchronization latency plus the bytes over
+// the bandwidth of a PCIe link.
+constexpr double kTransferLatencyNs = 10000.0;
+constexpr double kTransferBytesPerNs = 10.0;
+
+// The cost-based refinement stops once a pass over the graph moves no node, or
+// after this many passes.
+constexpr int kMaxCostRefinementPasses = 4;
+
 // All the nodes that should be denylisted and not swapped.
 bool IsDenylisted(const NodeDef& node) {
   return
@@ -294,8 +313,259 @@ string TryFindHostDevice(const gtl::FlatSet<string>& devices,
   // We couldn't find an appropriate Host device, return no device.
   return "";
 }
+
+// Returns the type of `device`, e.g. "GPU" for "/job:a/device:GPU:0", or an
+// empty string if it can't be parsed.
+string GetDeviceType(const string& device) {
+  DeviceNameUtils::ParsedName parsed;
+  if (!DeviceNameUtils::ParseFullName(device, &parsed) || !parsed.has_type) {
+    return "";
+  }
+  return parsed.type;
+}
+
+// Checks if the `port_id`-th input (or output, if `is_input` is false) of
+// `node` is in host memory when `node` runs on `device`.
+bool IsPortInHostMemory(const NodeDef& node, const string& device, int port_id,
+                        bool is_input) {
+  const string device_type = GetDeviceType(device);
+  if (device_type.empty() || device_type == DEVICE_CPU) {
+    return true;
+  }
+  const OpDef* op = nullptr;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op).ok()) {
+    return false;
+  }
+  const int arg_id = is_input ? OpInputPortIdToArgId(node, *op, port_id)
+                              : OpOutputPortIdToArgId(node, *op, port_id);
+  if (arg_id < 0) {
+    return false;
+  }
+  const KernelDef* kernel = nullptr;
+  if (!FindKernelDef(DeviceType(device_type), node, &kernel, nullptr).ok()) {
+    return false;
+  }
+  const string& arg_name =
+      is_input ? op->input_arg(arg_id).name() : op->output_arg(arg_id).name();
+  for (const string& host_memory_arg : kernel->host_memory_arg()) {
+    if (host_memory_arg == arg_name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns a name for the memory space that a tensor lives in: the host memory
+// of the task of `device`, or the memory of `device` itself.
+string GetMemorySpace(const string& device, bool in_host_memory) {
+  DeviceNameUtils::ParsedName parsed;
+  if (!in_host_memory || !DeviceNameUtils::ParseFullName(device, &parsed)) {
+    return device;
+  }
+  parsed.type = DEVICE_CPU;
+  parsed.has_type = true;
+  parsed.id = 0;
+  parsed.has_id = true;
+  return DeviceNameUtils::ParsedNameToString(parsed);
+}
+
+// Returns the size in bytes of the tensor described by `props[index]`, or -1 if
+// it isn't statically known.
+int64 GetTensorBytes(const std::vector<OpInfo::TensorProperties>& props,
+                     int index) {
+  if (index < 0 || index >= static_cast<int>(props.size()) ||
+      NumCoefficients(props[index].shape()) < 0) {
+    return -1;
+  }
+  return CalculateTensorSize(props[index]);
+}
+
+// Estimates the time in nanoseconds to run `node` on `device`, plus the time to
+// copy its data inputs and outputs between memory spaces, given the current
+// placement of its producers and consumers. Returns a negative value if the
+// size of some of these tensors isn't statically known.
+double EstimatePlacementCost(const GraphView& graph,
+                             const GraphProperties& properties,
+                             const OpLevelCostEstimator& estimator,
+                             const VirtualPlacer& placer, const NodeDef& node,
+                             const string& device) {
+  const std::vector<OpInfo::TensorProperties>& inputs =
+      properties.GetInputProperties(node.name());
+  const std::vector<OpInfo::TensorProperties>& outputs =
+      properties.GetOutputProperties(node.name());
+
+  OpContext op_context;
+  op_context.op_info.set_op(node.op());
+  *op_context.op_info.mutable_attr() = node.attr();
+  for (const auto& input : inputs) {
+    *op_context.op_info.add_inputs() = input;
+  }
+  for (const auto& output : outputs) {
+    *op_context.op_info.add_outputs() = output;
+  }
+  NodeDef placed_node;
+  placed_node.set_device(device);
+  *op_context.op_info.mutable_device() = placer.get_device(placed_node);
+  double cost = estimator.PredictCosts(op_context).execution_time.count();
+
+  for (int i = 0; i < node.input_size(); ++i) {
+    if (IsControlInput(node.input(i))) {
+      break;
+    }
+    const TensorId tensor = ParseTensorName(node.input(i));
+    const NodeDef* producer = graph.GetNode(tensor.node());
+    if (producer == nullptr) {
+      continue;
+    }
+    const int64 bytes = GetTensorBytes(inputs, i);
+    if (bytes < 0) {
+      return -1.0;
+    }
+    const string src = GetMemorySpace(
+        producer->device(), IsPortInHostMemory(*producer, producer->device(),
+                                               tensor.index(),
+                                               /*is_input=*/false));
+    const string dst = GetMemorySpace(
+        device, IsPortInHostMemory(node, device, i, /*is_input=*/true));
+    if (src != dst) {
+      cost += kTransferLatencyNs + bytes / kTransferBytesPerNs;
+    }
+  }
+
+  for (const GraphView::InputPort& fanout :
+       graph.GetFanouts(node, /*include_controlled_nodes=*/false)) {
+    const NodeDef* consumer = fanout.node;
+    const int port_id =
+        ParseTensorName(consumer->input(fanout.port_id)).index();
+    const int64 bytes = GetTensorBytes(outputs, port_id);
+    if (bytes < 0) {
+      return -1.0;
+    }
+    const string src = GetMemorySpace(
+        device, IsPortInHostMemory(node, device, port_id, /*is_input=*/false));
+    const string dst = GetMemorySpace(
+        consumer->device(),
+        IsPortInHostMemory(*consumer, consumer->device(), fanout.port_id,
+                           /*is_input=*/true));
+    if (src != dst) {
+      cost += kTransferLatencyNs + bytes / kTransferBytesPerNs;
+    }
+  }
+  return cost;
+}
+
+// Checks if the cost-based refinement may move `node` to another device.
+bool IsNodeMovableByCost(const NodeDef& node) {
+  if (node.device().empty() || IsDenylisted(node) || IsPlaceholder(node) ||
+      IsArg(node) || IsRetval(node) ||
+      node.attr().count(kColocationAttrName) > 0) {
+    return false;
+  }
+  const OpDef* op = nullptr;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op).ok() ||
+      op->is_stateful()) {
+    return false;
+  }
+  DataTypeVector input_types;
+  DataTypeVector output_types;
+  if (!InOutTypesForNode(node, *op, &input_types, &output_types).ok()) {
+    return false;
+  }
+  for (const DataTypeVector* types : {&input_types, &output_types}) {
+    for (DataType type : *types) {
+      if (type == DT_RESOURCE || IsRefType(type)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Returns the device that the cost-based refinement considers for `node` in
+// place of its current one: the host for a node on a GPU, and for a node on the
+// host the non-host device most of its data neighbours are on. Returns an
+// empty string if there is no such device with a kernel for `node`.
+string FindAlternativeDevice(const GraphView& graph,
+                             const gtl::FlatSet<string>& devices,
+                             bool has_device_cpu, const NodeDef& node) {
+  string device;
+  if (GetDeviceType(node.device()) != DEVICE_CPU) {
+    device = TryFindHostDevice(devices, has_device_cpu, node.device());
+  } else {
+    std::map<string, int> neighbour_devices;
+    for (const GraphView::OutputPort& fanin :
+         graph.GetFanins(node, /*include_controlling_nodes=*/false)) {
+      ++neighbour_devices[fanin.node->device()];
+    }
+    for (const GraphView::InputPort& fanout :
+         graph.GetFanouts(node, /*include_controlled_nodes=*/false)) {
+      ++neighbour_devices[fanout.node->device()];
+    }
+    int max_count = 0;
+    for (const auto& it : neighbour_devices) {
+      const string device_type = GetDeviceType(it.first);
+      if (!device_type.empty() && device_type != DEVICE_CPU &&
+          devices.find(it.first) != devices.end() && it.second > max_count) {
+        device = it.first;
+        max_count = it.second;
+      }
+    }
+  }
+  if (device.empty() ||
+      !FindKernelDef(DeviceType(GetDeviceType(device)), node, nullptr, nullptr)
+           .ok()) {
+    return "";
+  }
+  return device;
+}
+
 }  // end namespace internal
 
+// Every move strictly lowers the estimated time summed over the whole graph, so
+// the passes in topological order can't cycle.
+Status PinToHostOptimizer::RefinePlacementByCost(
+    Cluster* cluster, const gtl::FlatSet<string>& devices, bool has_device_cpu,
+    const GraphView& graph, GraphProperties* properties,
+    GraphDef* optimized_graph) {
+  if (!properties->has_properties()) {
+    TF_RETURN_IF_ERROR(properties->InferStatically(
+        /*assume_valid_feeds=*/false, /*aggressive_shape_inference=*/false,
+        /*include_tensor_values=*/false));
+  }
+  const VirtualPlacer placer(cluster->GetDevices());
+  const OpLevelCostEstimator estimator;
+
+  for (int pass = 0; pass < internal::kMaxCostRefinementPasses; ++pass) {
+    bool changed = false;
+    for (auto& node : *optimized_graph->mutable_node()) {
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      if (!internal::IsNodeMovableByCost(node)) {
+        continue;
+      }
+      string device = internal::FindAlternativeDevice(graph, devices,
+                                                      has_device_cpu, node);
+      if (device.empty()) {
+        continue;
+      }
+      const double current_cost = internal::EstimatePlacementCost(
+          graph, *properties, estimator, placer, node, node.device());
+      const double new_cost = internal::EstimatePlacementCost(
+          graph, *properties, estimator, placer, node, device);
+      if (current_cost < 0 || new_cost < 0 || new_cost >= current_cost) {
+        continue;
+      }
+      VLOG(2) << "Moving node " << node.name() << " to device " << device
+              << ", estimated cost " << current_cost << "ns -> " << new_cost
+              << "ns";
+      *node.mutable_device() = std::move(device);
+      changed = true;
+    }
+    if (!changed) {
+      break;
+    }
+  }
+  return Status::OK();
+}
 Status PinToHostOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                     GraphDef* optimized_graph) {
   *optimized_graph = item.graph;
@@ -365,6 +635,11 @@ Status PinToHostOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       }
     }
   }
+
+  if (opt_level_ == RewriterConfig::AGGRESSIVE && cluster != nullptr) {
+    TF_RETURN_IF_ERROR(RefinePlacementByCost(
+        cluster, devices, has_device_cpu, graph, &properties, optimized_graph));
+  }
   return Status::OK();
 }
 
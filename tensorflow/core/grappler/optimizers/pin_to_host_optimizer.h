@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <unordered_set>
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/graph_view.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
@@ -36,10 +37,16 @@ string TryFindHostDevice(const gtl::FlatSet<string>& devices,
 // TODO(williamchan): The current heuristic will swap any small integer Const to
 // CPU. This may cause a problem cpu->cpu->gpu wherein the original behaviour of
 // gpu->gpu->gpu may have been better/faster. We should probably fix this.
+//
+// With opt_level AGGRESSIVE and a cluster, the heuristic placement is then
+// refined using op cost estimates: a node is moved between the host and a
+// device whenever that lowers its estimated compute time plus the time spent
+// copying its inputs and outputs across memory spaces.
 class PinToHostOptimizer : public GraphOptimizer {
  public:
-  PinToHostOptimizer() {}
-  explicit PinToHostOptimizer(RewriterConfig::Toggle opt_level) {}
+  PinToHostOptimizer() : opt_level_(RewriterConfig::DEFAULT) {}
+  explicit PinToHostOptimizer(RewriterConfig::Toggle opt_level)
+      : opt_level_(opt_level) {}
 
   ~PinToHostOptimizer() override {}
 
@@ -49,6 +56,17 @@ class PinToHostOptimizer : public GraphOptimizer {
 
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override;
+
+ private:
+  // Moves nodes between the host and the devices, one at a time, whenever that
+  // lowers the estimated sum of their compute and cross-device copy times.
+  Status RefinePlacementByCost(Cluster* cluster,
+                               const gtl::FlatSet<string>& devices,
+                               bool has_device_cpu, const GraphView& graph,
+                               GraphProperties* properties,
+                               GraphDef* optimized_graph);
+
+  RewriterConfig::Toggle opt_level_;
 };
 
 }  // end namespace grappler
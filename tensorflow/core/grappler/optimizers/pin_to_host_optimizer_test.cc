@@ -17,10 +17,12 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -264,6 +266,58 @@ TEST_F(PinToHostOptimizerTest, PortIdToArgId) {
   EXPECT_EQ(found, 2);
 }
 
+std::unordered_map<string, DeviceProperties> CpuAndGpuDevices() {
+  DeviceProperties cpu;
+  cpu.set_type("CPU");
+  cpu.set_frequency(2000);
+  cpu.set_num_cores(8);
+  cpu.set_bandwidth(32 * 1024 * 1024);
+  DeviceProperties gpu;
+  gpu.set_type("GPU");
+  gpu.set_frequency(1000);
+  gpu.set_num_cores(60);
+  gpu.set_bandwidth(256 * 1024 * 1024);
+  return {{"/device:CPU:0", cpu}, {"/device:GPU:0", gpu}};
+}
+
+TEST_F(PinToHostOptimizerTest, RefinePlacementByCost) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Placeholder(
+      s.WithOpName("a").WithDevice("/device:CPU:0"), DT_FLOAT,
+      ops::Placeholder::Shape({1024, 1024}));
+  // Computing `b` on the GPU costs more than copying its input to the GPU and
+  // its output back to the host.
+  Output b = ops::Neg(s.WithOpName("b").WithDevice("/device:GPU:0"), a);
+  Output c = ops::Sqrt(s.WithOpName("c").WithDevice("/device:CPU:0"), b);
+
+  GrapplerItem item;
+  item.fetch = {"c"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  VirtualCluster cluster(CpuAndGpuDevices());
+  TF_CHECK_OK(cluster.Provision());
+
+  GraphDef output;
+  PinToHostOptimizer optimizer(RewriterConfig::ON);
+  TF_EXPECT_OK(optimizer.Optimize(&cluster, item, &output));
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "b") {
+      EXPECT_EQ(node.device(), "/device:GPU:0");
+    }
+  }
+
+  PinToHostOptimizer aggressive_optimizer(RewriterConfig::AGGRESSIVE);
+  TF_EXPECT_OK(aggressive_optimizer.Optimize(&cluster, item, &output));
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "a" || node.name() == "b" || node.name() == "c") {
+      EXPECT_EQ(node.device(), "/device:CPU:0");
+      ++found;
+    }
+  }
+  EXPECT_EQ(found, 3);
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/graph_view.h"
+#include "tensorflow/core/grappler/utils/pattern_utils.h"
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -55,6 +56,13 @@ namespace grappler {
 //   (1) FusedBatchNorm + <Activation>
 //   (2) FusedBatchNorm + SideInput + <Activation>
 //
+// Transformer building blocks written with primitive ops:
+//   (1) Layer normalization over the last dimension -> _FusedLayerNorm
+//   (2) Exact (Erf) or approximate (Tanh) GELU -> _FusedGelu
+//   (3) Softmax(logits * scale + mask) -> _FusedScaledMaskedSoftmax
+//   (4) BatchMatMul(Softmax(BatchMatMul(query, key^T) * scale + mask), value)
+//       -> _FusedAttention
+//
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
 // Both Conv2D and MatMul implemented as Tensor contraction (on CPU), so all the
@@ -66,6 +74,10 @@ constexpr char kFusedMatMul[] = "_FusedMatMul";
 constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kFusedLayerNorm[] = "_FusedLayerNorm";
+constexpr char kFusedGelu[] = "_FusedGelu";
+constexpr char kFusedScaledMaskedSoftmax[] = "_FusedScaledMaskedSoftmax";
+constexpr char kFusedAttention[] = "_FusedAttention";
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
 
@@ -122,6 +134,54 @@ struct TensorToHashBucket {
   int as_string = kMissingIndex;
   int string_to_hash_bucket = kMissingIndex;
 };
+
+// Layer normalization of `input` over its last dimension, followed by a
+// per-channel `scale` and `offset`.
+struct LayerNorm {
+  LayerNorm() = default;
+
+  int output = kMissingIndex;
+  string input;
+  string scale;
+  string offset;
+  float epsilon = 0.0f;
+  std::set<int> nodes_to_remove;
+};
+
+// GELU activation of `input`, computed with Erf or with its Tanh approximation.
+struct Gelu {
+  Gelu() = default;
+
+  int output = kMissingIndex;
+  string input;
+  bool approximate = false;
+  std::set<int> nodes_to_remove;
+};
+
+// Softmax over the last dimension of `logits * scale + mask`.
+struct ScaledMaskedSoftmax {
+  ScaledMaskedSoftmax() = default;
+
+  int output = kMissingIndex;
+  string logits;
+  string mask;
+  float scale = 1.0f;
+  std::set<int> nodes_to_remove;
+};
+// Product of `softmax(query * key^T * scale + mask)` and `value`, where the
+// scale and the mask are optional.
+struct Attention {
+  Attention() = default;
+
+  int output = kMissingIndex;
+  string query;
+  string key;
+  string value;
+  string mask;
+  float scale = 1.0f;
+  std::set<int> nodes_to_remove;
+};
+
 // Contraction node followed by a BiasAdd.
 struct ContractionWithBiasAdd {
   ContractionWithBiasAdd() = default;
@@ -1011,6 +1071,796 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+// Returns true if the transformer fusions can replace `node`: the fused kernels
+// are implemented with Eigen for float, half and bfloat16 on CPU, and for float
+// and half on GPU.
+bool IsTransformerFusionCompatible(const RemapperContext& ctx,
+                                   const NodeDef& node) {
+  // XLA fuses these patterns itself and does not know the fused ops.
+  if (ctx.xla_auto_clustering_on) return false;
+
+  const DataType dtype = GetDataTypeFromAttr(node, "T");
+  if (NodeIsOnCpu(&node)) {
+    return dtype == DT_FLOAT || dtype == DT_HALF || dtype == DT_BFLOAT16;
+  }
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  if (NodeIsOnGpu(&node)) return dtype == DT_FLOAT || dtype == DT_HALF;
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  return false;
+}
+
+// Reads the value of a floating point scalar Const node.
+bool GetScalarConstValue(const NodeDef& node, float* value) {
+  if (!IsConstant(node) || !HasNodeAttr(node, "value")) return false;
+  Tensor tensor;
+  if (!tensor.FromProto(node.attr().at("value").tensor()) ||
+      tensor.NumElements() != 1) {
+    return false;
+  }
+  switch (tensor.dtype()) {
+    case DT_FLOAT:
+      *value = tensor.flat<float>()(0);
+      return true;
+    case DT_DOUBLE:
+      *value = static_cast<float>(tensor.flat<double>()(0));
+      return true;
+    case DT_HALF:
+      *value = static_cast<float>(tensor.flat<Eigen::half>()(0));
+      return true;
+    case DT_BFLOAT16:
+      *value = static_cast<float>(tensor.flat<bfloat16>()(0));
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns true if `node` is a scalar constant close to `expected`. Constants
+// are compared loosely, because the models write them with various precisions
+// and may store them as half or bfloat16.
+bool IsScalarConstNear(const NodeDef& node, float expected) {
+  float value;
+  return GetScalarConstValue(node, &value) &&
+         std::abs(value - expected) <=
+             1e-3f * std::max(1.0f, std::abs(expected));
+}
+
+// Returns true if `mean` reduces the last dimension of its rank `rank` input,
+// and keeps it.
+bool IsLastDimMean(const NodeDef& mean, const NodeDef& axes, int rank) {
+  bool keep_dims = false;
+  if (!TryGetNodeAttr(mean, "keep_dims", &keep_dims) || !keep_dims) {
+    return false;
+  }
+  if (!IsConstant(axes) || !HasNodeAttr(axes, "value")) return false;
+  Tensor tensor;
+  if (!tensor.FromProto(axes.attr().at("value").tensor()) ||
+      tensor.NumElements() != 1) {
+    return false;
+  }
+  int64 axis;
+  if (tensor.dtype() == DT_INT32) {
+    axis = tensor.flat<int32>()(0);
+  } else if (tensor.dtype() == DT_INT64) {
+    axis = tensor.flat<int64>()(0);
+  } else {
+    return false;
+  }
+  return axis == -1 || axis == rank - 1;
+}
+
+// Returns the inferred shape of the input `port` of `node`, or nullptr if it is
+// not known.
+const TensorShapeProto* GetInputShape(const RemapperContext& ctx,
+                                      const NodeDef& node, int port) {
+  if (!ctx.graph_properties.HasInputProperties(node.name())) return nullptr;
+  const std::vector<OpInfo::TensorProperties>& props =
+      ctx.graph_properties.GetInputProperties(node.name());
+  if (port >= static_cast<int>(props.size())) return nullptr;
+  return &props[port].shape();
+}
+
+// Returns true if both dimensions are known, or symbolically known, to be the
+// same.
+bool DimsEqual(const TensorShapeProto::Dim& lhs,
+               const TensorShapeProto::Dim& rhs) {
+  return !IsUnknown(lhs) && lhs.size() == rhs.size();
+}
+
+// Matches `pattern` rooted at `node_index`. On success, fills the node index of
+// every label and the nodes to remove, none of which may be preserved.
+bool MatchTransformerPattern(RemapperContext* ctx, int node_index,
+                             const utils::OpTypePattern& pattern,
+                             std::map<string, int>* matched_nodes,
+                             std::set<int>* nodes_to_remove) {
+  // The matcher keeps its bookkeeping after a failed match, so each attempt
+  // uses its own.
+  utils::SubGraphMatcher<utils::MatchingDirection::kFollowInputs> matcher(
+      &ctx->graph_view);
+  matched_nodes->clear();
+  nodes_to_remove->clear();
+  if (!matcher.GetMatchedNodes(pattern, ctx->graph_view.GetNode(node_index),
+                               matched_nodes, nodes_to_remove)) {
+    return false;
+  }
+  const GraphDef* graph = ctx->graph_view.graph();
+  for (int index : *nodes_to_remove) {
+    if (IsInPreserveSet(*ctx, &graph->node(index))) return false;
+  }
+  return true;
+}
+
+// Returns in `fanin` the input `port` of the node labeled `label`, after
+// checking that all the listed (label, port) pairs read the same tensor. The
+// matcher only checks that they read the same node.
+bool GetCommonFanin(const RemapperContext& ctx,
+                    const std::map<string, int>& matched_nodes,
+                    const std::vector<std::pair<string, int>>& uses,
+                    string* fanin) {
+  const GraphDef* graph = ctx.graph_view.graph();
+  fanin->clear();
+  for (const auto& use : uses) {
+    const NodeDef& node = graph->node(matched_nodes.at(use.first));
+    if (use.second >= node.input_size()) return false;
+    const string& input = node.input(use.second);
+    if (fanin->empty()) {
+      *fanin = input;
+    } else if (*fanin != input) {
+      return false;
+    }
+  }
+  return !fanin->empty();
+}
+
+bool FindLayerNorm(RemapperContext* ctx, int node_index, LayerNorm* matched) {
+  using utils::NodeStatus;
+  using utils::OpTypePattern;
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsAdd(*node_def) || !IsTransformerFusionCompatible(*ctx, *node_def)) {
+    return false;
+  }
+
+  // tf.nn.batch_normalization applied to tf.nn.moments over the last axis:
+  //   inv = Rsqrt(variance + epsilon) * scale
+  //   output = input * inv + (offset - mean * inv)
+  // where the variance may read the mean through a StopGradient.
+  // clang-format off
+  const auto moments_pattern = [](bool stop_gradient) -> OpTypePattern {
+    OpTypePattern mean_use =
+        stop_gradient
+            ? OpTypePattern{"StopGradient", "stop_gradient",
+                            NodeStatus::kRemove,
+                            {{"Mean", "mean", NodeStatus::kRemove}}}
+            : OpTypePattern{"Mean", "mean", NodeStatus::kRemove};
+    OpTypePattern inv = {"Mul", "mul_scale", NodeStatus::kRemove,
+      {
+        {"Rsqrt", "rsqrt", NodeStatus::kRemove,
+          {
+            {"AddV2|Add", "add_epsilon", NodeStatus::kRemove,
+              {
+                {"Mean", "variance", NodeStatus::kRemove,
+                  {
+                    {"SquaredDifference", "squared_difference",
+                     NodeStatus::kRemove,
+                      {
+                        {"*", "input", NodeStatus::kRemain},
+                        mean_use
+                      }
+                    },
+                    {"Const", "variance_axes", NodeStatus::kRemain}
+                  }
+                },
+                {"Const", "epsilon", NodeStatus::kRemain}
+              }
+            }
+          }
+        },
+        {"*", "scale", NodeStatus::kRemain}
+      }
+    };
+    return {"AddV2|Add", "output", NodeStatus::kReplace,
+      {
+        {"Mul", "mul_input", NodeStatus::kRemove,
+          {
+            {"*", "input", NodeStatus::kRemain},
+            inv
+          }
+        },
+        {"Sub", "sub_offset", NodeStatus::kRemove,
+          {
+            {"*", "offset", NodeStatus::kRemain},
+            {"Mul", "mul_mean", NodeStatus::kRemove,
+              {
+                {"Mean", "mean", NodeStatus::kRemove,
+                  {
+                    {"*", "input", NodeStatus::kRemain},
+                    {"Const", "mean_axes", NodeStatus::kRemain}
+                  }
+                },
+                {"Mul", "mul_scale", NodeStatus::kRemove}
+              }
+            }
+          }
+        }
+      }
+    };
+  };
+
+  // The direct formulation:
+  //   centered = input - Mean(input)
+  //   output = centered * Rsqrt(Mean(Square(centered)) + epsilon) * scale
+  //            + offset
+  const OpTypePattern direct_pattern = {"AddV2|Add", "output",
+                                        NodeStatus::kReplace,
+    {
+      {"Mul", "mul_scale", NodeStatus::kRemove,
+        {
+          {"Mul", "mul_rsqrt", NodeStatus::kRemove,
+            {
+              {"Sub", "centered", NodeStatus::kRemove,
+                {
+                  {"*", "input", NodeStatus::kRemain},
+                  {"Mean", "mean", NodeStatus::kRemove,
+                    {
+                      {"*", "input", NodeStatus::kRemain},
+                      {"Const", "mean_axes", NodeStatus::kRemain}
+                    }
+                  }
+                }
+              },
+              {"Rsqrt", "rsqrt", NodeStatus::kRemove,
+                {
+                  {"AddV2|Add", "add_epsilon", NodeStatus::kRemove,
+                    {
+                      {"Mean", "variance", NodeStatus::kRemove,
+                        {
+                          {"Square", "square", NodeStatus::kRemove,
+                            {
+                              {"Sub", "centered", NodeStatus::kRemove}
+                            }
+                          },
+                          {"Const", "variance_axes", NodeStatus::kRemain}
+                        }
+                      },
+                      {"Const", "epsilon", NodeStatus::kRemain}
+                    }
+                  }
+                }
+              }
+            }
+          },
+          {"*", "scale", NodeStatus::kRemain}
+        }
+      },
+      {"*", "offset", NodeStatus::kRemain}
+    }
+  };  // clang-format on
+
+  std::map<string, int> matched_nodes;
+  std::set<int> nodes_to_remove;
+  LayerNorm pattern;
+  if (MatchTransformerPattern(ctx, node_index, moments_pattern(true),
+                              &matched_nodes, &nodes_to_remove) ||
+      MatchTransformerPattern(ctx, node_index, moments_pattern(false),
+                              &matched_nodes, &nodes_to_remove)) {
+    if (!GetCommonFanin(*ctx, matched_nodes,
+                        {{"mul_input", 0}, {"squared_difference", 0},
+                         {"mean", 0}},
+                        &pattern.input) ||
+        !GetCommonFanin(*ctx, matched_nodes, {{"mul_scale", 1}},
+                        &pattern.scale) ||
+        !GetCommonFanin(*ctx, matched_nodes, {{"sub_offset", 0}},
+                        &pattern.offset)) {
+      return false;
+    }
+  } else if (MatchTransformerPattern(ctx, node_index, direct_pattern,
+                                     &matched_nodes, &nodes_to_remove)) {
+    if (!GetCommonFanin(*ctx, matched_nodes, {{"centered", 0}, {"mean", 0}},
+                        &pattern.input) ||
+        !GetCommonFanin(*ctx, matched_nodes, {{"mul_scale", 1}},
+                        &pattern.scale) ||
+        !GetCommonFanin(*ctx, matched_nodes, {{"output", 1}},
+                        &pattern.offset)) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+
+  const GraphDef* graph = ctx->graph_view.graph();
+  const auto node = [&](const string& label) -> const NodeDef& {
+    return graph->node(matched_nodes.at(label));
+  };
+
+  // The kernel normalizes over the last dimension, and takes rank 1 scale and
+  // offset of that size.
+  const TensorShapeProto* input_shape = GetInputShape(*ctx, node("mean"), 0);
+  const TensorShapeProto* scale_shape =
+      GetInputShape(*ctx, node("mul_scale"), 1);
+  const TensorShapeProto* offset_shape =
+      matched_nodes.count("sub_offset")
+          ? GetInputShape(*ctx, node("sub_offset"), 0)
+          : GetInputShape(*ctx, node("output"), 1);
+  if (input_shape == nullptr || scale_shape == nullptr ||
+      offset_shape == nullptr) {
+    return false;
+  }
+  const int rank = Rank(*input_shape);
+  if (rank < 1 || Rank(*scale_shape) != 1 || Rank(*offset_shape) != 1 ||
+      !DimsEqual(input_shape->dim(rank - 1), scale_shape->dim(0)) ||
+      !DimsEqual(input_shape->dim(rank - 1), offset_shape->dim(0))) {
+    return false;
+  }
+
+  if (!IsLastDimMean(node("mean"), node("mean_axes"), rank) ||
+      !IsLastDimMean(node("variance"), node("variance_axes"), rank) ||
+      !GetScalarConstValue(node("epsilon"), &pattern.epsilon) ||
+      pattern.epsilon <= 0.0f) {
+    return false;
+  }
+
+  pattern.output = node_index;
+  pattern.nodes_to_remove = std::move(nodes_to_remove);
+  *matched = std::move(pattern);
+  return true;
+}
+
+bool FindGelu(RemapperContext* ctx, int node_index, Gelu* matched) {
+  using utils::NodeStatus;
+  using utils::OpTypePattern;
+  constexpr float kSqrtTwo = 1.41421356f;
+  constexpr float kRsqrtTwo = 0.70710678f;
+  constexpr float kSqrtTwoOverPi = 0.79788456f;
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsMul(*node_def) || !IsTransformerFusionCompatible(*ctx, *node_def)) {
+    return false;
+  }
+
+  // 1 + Erf(input / sqrt(2)), or 1 + Erf(input * (1 / sqrt(2))).
+  // clang-format off
+  const OpTypePattern erf_cdf = {"AddV2|Add", "add_one", NodeStatus::kRemove,
+    {
+      {"Const", "one", NodeStatus::kRemain},
+      {"Erf", "erf", NodeStatus::kRemove,
+        {
+          {"RealDiv|Mul", "erf_input", NodeStatus::kRemove,
+            {
+              {"*", "input", NodeStatus::kRemain},
+              {"Const", "erf_scale", NodeStatus::kRemain}
+            }
+          }
+        }
+      }
+    }
+  };
+  // 1 + Tanh(sqrt(2 / pi) * (input + 0.044715 * Pow(input, 3))).
+  const OpTypePattern tanh_cdf = {"AddV2|Add", "add_one", NodeStatus::kRemove,
+    {
+      {"Const", "one", NodeStatus::kRemain},
+      {"Tanh", "tanh", NodeStatus::kRemove,
+        {
+          {"Mul", "tanh_input", NodeStatus::kRemove,
+            {
+              {"Const", "tanh_scale", NodeStatus::kRemain},
+              {"AddV2|Add", "add_cube", NodeStatus::kRemove,
+                {
+                  {"*", "input", NodeStatus::kRemain},
+                  {"Mul", "mul_cube", NodeStatus::kRemove,
+                    {
+                      {"Const", "cube_scale", NodeStatus::kRemain},
+                      {"Pow", "pow", NodeStatus::kRemove,
+                        {
+                          {"*", "input", NodeStatus::kRemain},
+                          {"Const", "exponent", NodeStatus::kRemain}
+                        }
+                      }
+                    }
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  };
+  // (0.5 * input) * cdf, as written by tf.nn.gelu.
+  const auto half_input_times = [](const OpTypePattern& cdf) {
+    return OpTypePattern{"Mul", "output", NodeStatus::kReplace,
+      {
+        {"Mul", "mul_half", NodeStatus::kRemove,
+          {
+            {"Const", "half", NodeStatus::kRemain},
+            {"*", "input", NodeStatus::kRemain}
+          }
+        },
+        cdf
+      }
+    };
+  };
+  // input * (0.5 * cdf), as written by BERT.
+  const auto input_times_half = [](const OpTypePattern& cdf) {
+    return OpTypePattern{"Mul", "output", NodeStatus::kReplace,
+      {
+        {"*", "input", NodeStatus::kRemain},
+        {"Mul", "mul_half", NodeStatus::kRemove,
+          {
+            {"Const", "half", NodeStatus::kRemain},
+            cdf
+          }
+        }
+      }
+    };
+  };  // clang-format on
+
+  struct Candidate {
+    OpTypePattern pattern;
+    bool approximate;
+    // The use of the input outside of the cdf.
+    std::pair<string, int> input_use;
+  };
+  const std::vector<Candidate> candidates = {
+      {half_input_times(erf_cdf), false, {"mul_half", 1}},
+      {half_input_times(tanh_cdf), true, {"mul_half", 1}},
+      {input_times_half(erf_cdf), false, {"output", 0}},
+      {input_times_half(tanh_cdf), true, {"output", 0}}};
+
+  std::map<string, int> matched_nodes;
+  std::set<int> nodes_to_remove;
+  Gelu pattern;
+  const Candidate* found = nullptr;
+  for (const Candidate& candidate : candidates) {
+    if (MatchTransformerPattern(ctx, node_index, candidate.pattern,
+                                &matched_nodes, &nodes_to_remove)) {
+      found = &candidate;
+      break;
+    }
+  }
+  if (found == nullptr) return false;
+  pattern.approximate = found->approximate;
+
+  std::vector<std::pair<string, int>> input_uses = {found->input_use};
+  if (pattern.approximate) {
+    input_uses.push_back({"add_cube", 0});
+    input_uses.push_back({"pow", 0});
+  } else {
+    input_uses.push_back({"erf_input", 0});
+  }
+  if (!GetCommonFanin(*ctx, matched_nodes, input_uses, &pattern.input)) {
+    return false;
+  }
+
+  const GraphDef* graph = ctx->graph_view.graph();
+  const auto node = [&](const string& label) -> const NodeDef& {
+    return graph->node(matched_nodes.at(label));
+  };
+  if (!IsScalarConstNear(node("half"), 0.5f) ||
+      !IsScalarConstNear(node("one"), 1.0f)) {
+    return false;
+  }
+  if (pattern.approximate) {
+    if (!IsScalarConstNear(node("tanh_scale"), kSqrtTwoOverPi) ||
+        !IsScalarConstNear(node("cube_scale"), 0.044715f) ||
+        !IsScalarConstNear(node("exponent"), 3.0f)) {
+      return false;
+    }
+  } else {
+    const float erf_scale = IsMul(node("erf_input")) ? kRsqrtTwo : kSqrtTwo;
+    if (!IsScalarConstNear(node("erf_scale"), erf_scale)) return false;
+  }
+
+  pattern.output = node_index;
+  pattern.nodes_to_remove = std::move(nodes_to_remove);
+  *matched = std::move(pattern);
+  return true;
+}
+
+// Returns true if the kernel of _FusedScaledMaskedSoftmax supports `mask` for
+// `logits`: padded with leading dimensions of size 1 to the rank of `logits`,
+// `mask` must match `logits` on some leading dimensions and on the last one,
+// and have size 1 in between.
+bool IsSupportedSoftmaxMask(const TensorShapeProto& logits,
+                            const TensorShapeProto& mask) {
+  const int rank = Rank(logits);
+  const int mask_rank = Rank(mask);
+  if (rank < 1 || mask_rank < 0 || mask_rank > rank) return false;
+  const int mask_offset = rank - mask_rank;
+  const auto is_one = [&](int i) {
+    return i < mask_offset || mask.dim(i - mask_offset).size() == 1;
+  };
+  const auto matches_logits = [&](int i) {
+    return i < mask_offset
+               ? logits.dim(i).size() == 1
+               : DimsEqual(mask.dim(i - mask_offset), logits.dim(i));
+  };
+  int i = 0;
+  while (i < rank - 1 && matches_logits(i)) ++i;
+  for (; i < rank - 1; ++i) {
+    if (!is_one(i)) return false;
+  }
+  return mask_offset < rank &&
+         DimsEqual(mask.dim(rank - 1 - mask_offset), logits.dim(rank - 1));
+}
+
+bool FindScaledMaskedSoftmax(RemapperContext* ctx, int node_index,
+                             ScaledMaskedSoftmax* matched) {
+  using utils::NodeStatus;
+  using utils::OpTypePattern;
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsSoftmax(*node_def) ||
+      !IsTransformerFusionCompatible(*ctx, *node_def)) {
+    return false;
+  }
+
+  // clang-format off
+  const auto softmax_of = [](const OpTypePattern& logits) {
+    return OpTypePattern{"Softmax", "output", NodeStatus::kReplace,
+      {
+        {"AddV2|Add", "add_mask", NodeStatus::kRemove,
+          {
+            logits,
+            {"*", "mask", NodeStatus::kRemain}
+          }
+        }
+      }
+    };
+  };
+  const OpTypePattern logits_times_scale = {"Mul", "mul_scale",
+                                            NodeStatus::kRemove,
+    {
+      {"*", "logits", NodeStatus::kRemain},
+      {"Const", "scale", NodeStatus::kRemain}
+    }
+  };
+  const OpTypePattern scale_times_logits = {"Mul", "mul_scale",
+                                            NodeStatus::kRemove,
+    {
+      {"Const", "scale", NodeStatus::kRemain},
+      {"*", "logits", NodeStatus::kRemain}
+    }
+  };
+  const OpTypePattern unscaled_logits = {"*", "logits", NodeStatus::kRemain};
+  // clang-format on
+
+  std::map<string, int> matched_nodes;
+  std::set<int> nodes_to_remove;
+  ScaledMaskedSoftmax pattern;
+  if (MatchTransformerPattern(ctx, node_index, softmax_of(logits_times_scale),
+                              &matched_nodes, &nodes_to_remove)) {
+    if (!GetCommonFanin(*ctx, matched_nodes, {{"mul_scale", 0}},
+                        &pattern.logits)) {
+      return false;
+    }
+  } else if (MatchTransformerPattern(ctx, node_index,
+                                     softmax_of(scale_times_logits),
+                                     &matched_nodes, &nodes_to_remove)) {
+    if (!GetCommonFanin(*ctx, matched_nodes, {{"mul_scale", 1}},
+                        &pattern.logits)) {
+      return false;
+    }
+  } else if (MatchTransformerPattern(ctx, node_index,
+                                     softmax_of(unscaled_logits),
+                                     &matched_nodes, &nodes_to_remove)) {
+    if (!GetCommonFanin(*ctx, matched_nodes, {{"add_mask", 0}},
+                        &pattern.logits)) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  if (!GetCommonFanin(*ctx, matched_nodes, {{"add_mask", 1}}, &pattern.mask)) {
+    return false;
+  }
+
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& add_mask = graph->node(matched_nodes.at("add_mask"));
+  if (matched_nodes.count("scale") &&
+      !GetScalarConstValue(graph->node(matched_nodes.at("scale")),
+                           &pattern.scale)) {
+    return false;
+  }
+
+  // The scaled logits must not be broadcast by the mask.
+  const TensorShapeProto* logits_shape = GetInputShape(*ctx, add_mask, 0);
+  const TensorShapeProto* mask_shape = GetInputShape(*ctx, add_mask, 1);
+  if (logits_shape == nullptr || mask_shape == nullptr ||
+      !IsSupportedSoftmaxMask(*logits_shape, *mask_shape)) {
+    return false;
+  }
+
+  pattern.output = node_index;
+  pattern.nodes_to_remove = std::move(nodes_to_remove);
+  *matched = std::move(pattern);
+  return true;
+}
+
+// Returns true if the kernel of _FusedAttention supports `mask` for `scores`:
+// padded with leading dimensions of size 1 to the rank of `scores`, `mask`
+// must match `scores` on some leading batch dimensions and have size 1 in the
+// remaining ones, and must have size 1 or the size of `scores` in the last two
+// dimensions.
+bool IsSupportedAttentionMask(const TensorShapeProto& scores,
+                              const TensorShapeProto& mask) {
+  const int rank = Rank(scores);
+  const int mask_rank = Rank(mask);
+  if (rank < 2 || mask_rank < 0 || mask_rank > rank) return false;
+  const int mask_offset = rank - mask_rank;
+  const auto is_one = [&](int i) {
+    return i < mask_offset || mask.dim(i - mask_offset).size() == 1;
+  };
+  const auto matches_scores = [&](int i) {
+    return i < mask_offset
+               ? scores.dim(i).size() == 1
+               : DimsEqual(mask.dim(i - mask_offset), scores.dim(i));
+  };
+  int i = 0;
+  while (i < rank - 2 && matches_scores(i)) ++i;
+  for (; i < rank - 2; ++i) {
+    if (!is_one(i)) return false;
+  }
+  for (i = rank - 2; i < rank; ++i) {
+    if (!is_one(i) && !matches_scores(i)) return false;
+  }
+  return true;
+}
+
+// Returns true if the query, key and value of _FusedAttention have supported
+// shapes: the same known rank and batch dimensions, and on GPU, head sizes
+// that the kernel supports.
+bool IsSupportedAttentionInputs(const NodeDef& node,
+                                const TensorShapeProto& query,
+                                const TensorShapeProto& key,
+                                const TensorShapeProto& value) {
+  const int rank = Rank(query);
+  if (rank < 2 || Rank(key) != rank || Rank(value) != rank) return false;
+  for (int i = 0; i < rank - 2; ++i) {
+    if (!DimsEqual(query.dim(i), key.dim(i)) ||
+        !DimsEqual(query.dim(i), value.dim(i))) {
+      return false;
+    }
+  }
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  // Keep in sync with kFusedAttentionMaxGpuHeadSize.
+  constexpr int64 kMaxGpuHeadSize = 128;
+  if (NodeIsOnGpu(&node)) {
+    const int64 head_size = query.dim(rank - 1).size();
+    const int64 value_head_size = value.dim(rank - 1).size();
+    if (head_size < 0 || head_size > kMaxGpuHeadSize ||
+        value_head_size < 0 || value_head_size > kMaxGpuHeadSize) {
+      return false;
+    }
+  }
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  return true;
+}
+
+// Returns true if `node` is a BatchMatMul with the given adjoint attributes.
+bool IsBatchMatMulWithAdjoints(const NodeDef& node, bool adj_x, bool adj_y) {
+  bool node_adj_x = false;
+  bool node_adj_y = false;
+  TryGetNodeAttr(node, "adj_x", &node_adj_x);
+  TryGetNodeAttr(node, "adj_y", &node_adj_y);
+  return node_adj_x == adj_x && node_adj_y == adj_y;
+}
+
+bool FindAttention(RemapperContext* ctx, int node_index, Attention* matched) {
+  using utils::NodeStatus;
+  using utils::OpTypePattern;
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if ((node_def->op() != "BatchMatMulV2" && node_def->op() != "BatchMatMul") ||
+      !IsBatchMatMulWithAdjoints(*node_def, false, false) ||
+      !IsTransformerFusionCompatible(*ctx, *node_def)) {
+    return false;
+  }
+
+  // clang-format off
+  const OpTypePattern scores = {"BatchMatMulV2|BatchMatMul", "scores",
+                                NodeStatus::kRemove,
+    {
+      {"*", "query", NodeStatus::kRemain},
+      {"*", "key", NodeStatus::kRemain}
+    }
+  };
+  const OpTypePattern scores_times_scale = {"Mul", "mul_scale",
+                                            NodeStatus::kRemove,
+    {
+      scores,
+      {"Const", "scale", NodeStatus::kRemain}
+    }
+  };
+  const OpTypePattern scale_times_scores = {"Mul", "mul_scale",
+                                            NodeStatus::kRemove,
+    {
+      {"Const", "scale", NodeStatus::kRemain},
+      scores
+    }
+  };
+  const auto masked = [](const OpTypePattern& logits) {
+    return OpTypePattern{"AddV2|Add", "add_mask", NodeStatus::kRemove,
+      {
+        logits,
+        {"*", "mask", NodeStatus::kRemain}
+      }
+    };
+  };
+  const auto attention_of = [](const OpTypePattern& logits) {
+    return OpTypePattern{"BatchMatMulV2|BatchMatMul", "output",
+                         NodeStatus::kReplace,
+      {
+        {"Softmax", "softmax", NodeStatus::kRemove, {logits}},
+        {"*", "value", NodeStatus::kRemain}
+      }
+    };
+  };
+  // clang-format on
+
+  std::map<string, int> matched_nodes;
+  std::set<int> nodes_to_remove;
+  bool found = false;
+  for (const OpTypePattern& logits :
+       {masked(scores_times_scale), masked(scale_times_scores), masked(scores),
+        scores_times_scale, scale_times_scores, scores}) {
+    if (MatchTransformerPattern(ctx, node_index, attention_of(logits),
+                                &matched_nodes, &nodes_to_remove)) {
+      found = true;
+      break;
+    }
+  }
+  if (!found) return false;
+
+  Attention pattern;
+  if (!GetCommonFanin(*ctx, matched_nodes, {{"scores", 0}}, &pattern.query) ||
+      !GetCommonFanin(*ctx, matched_nodes, {{"scores", 1}}, &pattern.key) ||
+      !GetCommonFanin(*ctx, matched_nodes, {{"output", 1}}, &pattern.value)) {
+    return false;
+  }
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& scores_node = graph->node(matched_nodes.at("scores"));
+  if (!IsBatchMatMulWithAdjoints(scores_node, false, true) ||
+      !HaveSameDataType(node_def, &scores_node)) {
+    return false;
+  }
+  if (matched_nodes.count("scale") &&
+      !GetScalarConstValue(graph->node(matched_nodes.at("scale")),
+                           &pattern.scale)) {
+    return false;
+  }
+
+  // The attention must not broadcast the query, key and value, nor the scores
+  // to the mask.
+  const TensorShapeProto* query_shape = GetInputShape(*ctx, scores_node, 0);
+  const TensorShapeProto* key_shape = GetInputShape(*ctx, scores_node, 1);
+  const TensorShapeProto* value_shape = GetInputShape(*ctx, *node_def, 1);
+  if (query_shape == nullptr || key_shape == nullptr ||
+      value_shape == nullptr ||
+      !IsSupportedAttentionInputs(*node_def, *query_shape, *key_shape,
+                                  *value_shape)) {
+    return false;
+  }
+  if (matched_nodes.count("add_mask")) {
+    if (!GetCommonFanin(*ctx, matched_nodes, {{"add_mask", 1}},
+                        &pattern.mask)) {
+      return false;
+    }
+    const NodeDef& add_mask = graph->node(matched_nodes.at("add_mask"));
+    const TensorShapeProto* scores_shape = GetInputShape(*ctx, add_mask, 0);
+    const TensorShapeProto* mask_shape = GetInputShape(*ctx, add_mask, 1);
+    if (scores_shape == nullptr || mask_shape == nullptr ||
+        !IsSupportedAttentionMask(*scores_shape, *mask_shape)) {
+      return false;
+    }
+  }
+
+  pattern.output = node_index;
+  pattern.nodes_to_remove = std::move(nodes_to_remove);
+  *matched = std::move(pattern);
+  return true;
+}
+
 void CopyConv2DAttributes(const NodeDef& conv2d, NodeDef* fused_conv2d,
                           const NodeDef* activation = nullptr) {
   DCHECK(IsConv2D(conv2d)) << "Input node must be a Conv2D";
@@ -1720,6 +2570,116 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return Status::OK();
 }
 
+// Replaces the root of a matched transformer pattern with `fused_op`, which
+// takes its name, and deletes the other nodes of the pattern.
+Status AddFusedTransformerNode(RemapperContext* ctx, NodeDef&& fused_op,
+                               int output,
+                               const std::set<int>& nodes_to_remove,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const NodeDef& output_node = ctx->graph_view.graph()->node(output);
+  fused_op.set_name(output_node.name());
+  fused_op.set_device(output_node.device());
+  (*fused_op.mutable_attr())["T"] = output_node.attr().at("T");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[output] = true;
+  for (int index : nodes_to_remove) {
+    (*nodes_to_delete)[index] = true;
+  }
+
+  return Status::OK();
+}
+
+Status AddLayerNormNode(RemapperContext* ctx, const LayerNorm& matched,
+                        std::vector<bool>* invalidated_nodes,
+                        std::vector<bool>* nodes_to_delete) {
+  VLOG(2) << "Fuse layer normalization:"
+          << " output=" << ctx->graph_view.graph()->node(matched.output).name()
+          << " input=" << matched.input << " epsilon=" << matched.epsilon;
+
+  NodeDef fused_op;
+  fused_op.set_op(kFusedLayerNorm);
+  fused_op.add_input(matched.input);   // 0: x
+  fused_op.add_input(matched.scale);   // 1: scale
+  fused_op.add_input(matched.offset);  // 2: offset
+  SetAttrValue(matched.epsilon, &(*fused_op.mutable_attr())["epsilon"]);
+
+  return AddFusedTransformerNode(ctx, std::move(fused_op), matched.output,
+                                 matched.nodes_to_remove, invalidated_nodes,
+                                 nodes_to_delete);
+}
+
+Status AddGeluNode(RemapperContext* ctx, const Gelu& matched,
+                   std::vector<bool>* invalidated_nodes,
+                   std::vector<bool>* nodes_to_delete) {
+  VLOG(2) << "Fuse " << (matched.approximate ? "approximate" : "exact")
+          << " GELU:"
+          << " output=" << ctx->graph_view.graph()->node(matched.output).name()
+          << " input=" << matched.input;
+
+  NodeDef fused_op;
+  fused_op.set_op(kFusedGelu);
+  fused_op.add_input(matched.input);  // 0: x
+  SetAttrValue(matched.approximate,
+               &(*fused_op.mutable_attr())["approximate"]);
+
+  return AddFusedTransformerNode(ctx, std::move(fused_op), matched.output,
+                                 matched.nodes_to_remove, invalidated_nodes,
+                                 nodes_to_delete);
+}
+
+Status AddScaledMaskedSoftmaxNode(RemapperContext* ctx,
+                                  const ScaledMaskedSoftmax& matched,
+                                  std::vector<bool>* invalidated_nodes,
+                                  std::vector<bool>* nodes_to_delete) {
+  VLOG(2) << "Fuse scaled and masked Softmax:"
+          << " output=" << ctx->graph_view.graph()->node(matched.output).name()
+          << " logits=" << matched.logits << " mask=" << matched.mask
+          << " scale=" << matched.scale;
+
+  NodeDef fused_op;
+  fused_op.set_op(kFusedScaledMaskedSoftmax);
+  fused_op.add_input(matched.logits);  // 0: logits
+  fused_op.add_input(matched.mask);    // 1: mask
+  SetAttrValue(matched.scale, &(*fused_op.mutable_attr())["scale"]);
+
+  return AddFusedTransformerNode(ctx, std::move(fused_op), matched.output,
+                                 matched.nodes_to_remove, invalidated_nodes,
+                                 nodes_to_delete);
+}
+
+Status AddAttentionNode(RemapperContext* ctx, const Attention& matched,
+                        std::vector<bool>* invalidated_nodes,
+                        std::vector<bool>* nodes_to_delete) {
+  VLOG(2) << "Fuse attention:"
+          << " output=" << ctx->graph_view.graph()->node(matched.output).name()
+          << " query=" << matched.query << " key=" << matched.key
+          << " value=" << matched.value << " mask=" << matched.mask
+          << " scale=" << matched.scale;
+
+  NodeDef fused_op;
+  fused_op.set_op(kFusedAttention);
+  fused_op.add_input(matched.query);  // 0: query
+  fused_op.add_input(matched.key);    // 1: key
+  fused_op.add_input(matched.value);  // 2: value
+  if (!matched.mask.empty()) {
+    fused_op.add_input(matched.mask);  // 3: args
+  }
+  auto* attr = fused_op.mutable_attr();
+  SetAttrValue(matched.mask.empty() ? 0 : 1, &(*attr)["num_args"]);
+  SetAttrValue(matched.scale, &(*attr)["scale"]);
+
+  return AddFusedTransformerNode(ctx, std::move(fused_op), matched.output,
+                                 matched.nodes_to_remove, invalidated_nodes,
+                                 nodes_to_delete);
+}
+
 bool IsConv2DOrMatMul(const NodeDef& node) {
   return IsConv2D(node) || IsMatMul(node);
 }
@@ -1770,6 +2730,7 @@ bool IsContractionWithAdd(const RemapperContext& ctx, int node_index) {
 //   (2) Fusing side input and/or activation into FusedBatchNorm.
 //   (3) Fusing Conv2D biasadd and relu on GPU
 //   (4) INTEL_MKL specific: Conv2D -> Add or Conv2D -> BiasAdd -> Add.
+//   (5) Fusing layer normalization or masked Softmax.
 bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
   // Candidate for a FusedBatchNorm splitting.
   const auto* node_view = ctx.graph_view.GetNode(node_index);
@@ -1840,6 +2801,23 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
     return false;
   };
 
+  // Candidate for a layer normalization, masked Softmax or attention fusion.
+  const auto is_transformer_fusion_candidate = [&]() -> bool {
+    const bool is_batch_matmul =
+        node_def->op() == "BatchMatMulV2" || node_def->op() == "BatchMatMul";
+    if (!IsAdd(*node_def) && !IsSoftmax(*node_def) && !is_batch_matmul) {
+      return false;
+    }
+    if (node_view->NumRegularFanins() < 1) return false;
+    const auto* fanin_0_node_def = node_view->GetRegularFanin(0).node_view()
+                                       ->node();
+    if (is_batch_matmul) return IsSoftmax(*fanin_0_node_def);
+    if (IsSoftmax(*node_def)) return IsAdd(*fanin_0_node_def);
+    return IsMul(*fanin_0_node_def) && node_view->NumRegularFanins() == 2;
+  };
+
+  if (is_transformer_fusion_candidate()) return true;
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
            IsContractionWithAdd(ctx, node_index);
@@ -1998,6 +2976,38 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap the primitive ops of transformer blocks into their fused kernels.
+    LayerNorm layer_norm;
+    if (allow_non_differentiable_rewrites &&
+        FindLayerNorm(&ctx, i, &layer_norm)) {
+      TF_RETURN_IF_ERROR(AddLayerNormNode(&ctx, layer_norm, &invalidated_nodes,
+                                          &nodes_to_delete));
+      continue;
+    }
+
+    Gelu gelu;
+    if (allow_non_differentiable_rewrites && FindGelu(&ctx, i, &gelu)) {
+      TF_RETURN_IF_ERROR(
+          AddGeluNode(&ctx, gelu, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    Attention attention;
+    if (allow_non_differentiable_rewrites &&
+        FindAttention(&ctx, i, &attention)) {
+      TF_RETURN_IF_ERROR(AddAttentionNode(&ctx, attention, &invalidated_nodes,
+                                          &nodes_to_delete));
+      continue;
+    }
+
+    ScaledMaskedSoftmax scaled_masked_softmax;
+    if (allow_non_differentiable_rewrites &&
+        FindScaledMaskedSoftmax(&ctx, i, &scaled_masked_softmax)) {
+      TF_RETURN_IF_ERROR(AddScaledMaskedSoftmaxNode(
+          &ctx, scaled_masked_softmax, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
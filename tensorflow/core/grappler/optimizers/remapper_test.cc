@@ -1071,5 +1071,372 @@ TEST_F(RemapperTest, FuseConv2DWithSqueezeAndBias) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+class RemapperFuseLayerNormTest : public RemapperTest {
+ public:
+  // Builds the layer normalization the way tf.nn.moments and
+  // tf.nn.batch_normalization do if `use_moments`, and directly otherwise.
+  void RunTest(bool use_moments) {
+    using ::tensorflow::ops::Placeholder;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto input = Placeholder(s.WithOpName("input"), DT_FLOAT,
+                             ops::Placeholder::Shape({4, 16, 32}));
+    auto scale = Placeholder(s.WithOpName("scale"), DT_FLOAT,
+                             ops::Placeholder::Shape({32}));
+    auto offset = Placeholder(s.WithOpName("offset"), DT_FLOAT,
+                              ops::Placeholder::Shape({32}));
+    auto epsilon = ops::Const(s.WithOpName("epsilon"), 0.001f);
+    auto axes = ops::Const(s.WithOpName("axes"), {-1});
+    auto keep_dims = ops::Mean::KeepDims(true);
+
+    auto mean = ops::Mean(s.WithOpName("mean"), input, axes, keep_dims);
+    Output output;
+    if (use_moments) {
+      auto stop_gradient = ops::StopGradient(s.WithOpName("stop"), mean);
+      auto squared_difference = ops::SquaredDifference(
+          s.WithOpName("squared_difference"), input, stop_gradient);
+      auto variance = ops::Mean(s.WithOpName("variance"), squared_difference,
+                                axes, keep_dims);
+      auto add_epsilon = ops::AddV2(s.WithOpName("add"), variance, epsilon);
+      auto rsqrt = ops::Rsqrt(s.WithOpName("rsqrt"), add_epsilon);
+      auto inv = ops::Mul(s.WithOpName("inv"), rsqrt, scale);
+      auto mul_input = ops::Mul(s.WithOpName("mul_input"), input, inv);
+      auto mul_mean = ops::Mul(s.WithOpName("mul_mean"), mean, inv);
+      auto sub = ops::Sub(s.WithOpName("sub"), offset, mul_mean);
+      output = ops::AddV2(s.WithOpName("layer_norm"), mul_input, sub);
+    } else {
+      auto centered = ops::Sub(s.WithOpName("centered"), input, mean);
+      auto square = ops::Square(s.WithOpName("square"), centered);
+      auto variance =
+          ops::Mean(s.WithOpName("variance"), square, axes, keep_dims);
+      auto add_epsilon = ops::AddV2(s.WithOpName("add"), variance, epsilon);
+      auto rsqrt = ops::Rsqrt(s.WithOpName("rsqrt"), add_epsilon);
+      auto normalized = ops::Mul(s.WithOpName("normalized"), centered, rsqrt);
+      auto scaled = ops::Mul(s.WithOpName("scaled"), normalized, scale);
+      output = ops::AddV2(s.WithOpName("layer_norm"), scaled, offset);
+    }
+    auto fetch = ops::Identity(s.WithOpName("fetch"), output);
+
+    auto input_t = GenerateRandomTensor<DT_FLOAT>({4, 16, 32});
+    auto scale_t = GenerateRandomTensor<DT_FLOAT>({32});
+    auto offset_t = GenerateRandomTensor<DT_FLOAT>({32});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"input", input_t}, {"scale", scale_t}, {"offset", offset_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output_graph;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output_graph));
+
+    int found = 0;
+    for (const NodeDef& node : output_graph.node()) {
+      if (node.name() == "layer_norm") {
+        EXPECT_EQ(node.op(), "_FusedLayerNorm");
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "input");
+        EXPECT_EQ(node.input(1), "scale");
+        EXPECT_EQ(node.input(2), "offset");
+        EXPECT_FLOAT_EQ(node.attr().at("epsilon").f(), 0.001f);
+        found++;
+      }
+      EXPECT_NE(node.name(), "mean");
+      EXPECT_NE(node.name(), "rsqrt");
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output_graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+  }
+};
+
+TEST_F(RemapperFuseLayerNormTest, Moments) { RunTest(/*use_moments=*/true); }
+
+TEST_F(RemapperFuseLayerNormTest, Direct) { RunTest(/*use_moments=*/false); }
+
+class RemapperFuseGeluTest : public RemapperTest {
+ public:
+  // Builds the GELU the way tf.nn.gelu does.
+  void RunTest(bool approximate) {
+    using ::tensorflow::ops::Placeholder;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto input = Placeholder(s.WithOpName("input"), DT_FLOAT,
+                             ops::Placeholder::Shape({8, 64}));
+    auto half = ops::Const(s.WithOpName("half"), 0.5f);
+    auto one = ops::Const(s.WithOpName("one"), 1.0f);
+    auto mul_half = ops::Mul(s.WithOpName("mul_half"), half, input);
+    Output cdf;
+    if (approximate) {
+      auto three = ops::Const(s.WithOpName("three"), 3.0f);
+      auto pow = ops::Pow(s.WithOpName("pow"), input, three);
+      auto cube_scale = ops::Const(s.WithOpName("cube_scale"), 0.044715f);
+      auto mul_cube = ops::Mul(s.WithOpName("mul_cube"), cube_scale, pow);
+      auto add_cube = ops::AddV2(s.WithOpName("add_cube"), input, mul_cube);
+      auto tanh_scale =
+          ops::Const(s.WithOpName("tanh_scale"), 0.7978845608028654f);
+      auto tanh_input =
+          ops::Mul(s.WithOpName("tanh_input"), tanh_scale, add_cube);
+      auto tanh = ops::Tanh(s.WithOpName("tanh"), tanh_input);
+      cdf = ops::AddV2(s.WithOpName("cdf"), one, tanh);
+    } else {
+      auto sqrt_two = ops::Const(s.WithOpName("sqrt_two"), 1.4142135623730951f);
+      auto erf_input = ops::RealDiv(s.WithOpName("erf_input"), input, sqrt_two);
+      auto erf = ops::Erf(s.WithOpName("erf"), erf_input);
+      cdf = ops::AddV2(s.WithOpName("cdf"), one, erf);
+    }
+    auto gelu = ops::Mul(s.WithOpName("gelu"), mul_half, cdf);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), gelu);
+
+    auto input_t = GenerateRandomTensor<DT_FLOAT>({8, 64});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"input", input_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      if (node.name() == "gelu") {
+        EXPECT_EQ(node.op(), "_FusedGelu");
+        ASSERT_EQ(node.input_size(), 1);
+        EXPECT_EQ(node.input(0), "input");
+        EXPECT_EQ(node.attr().at("approximate").b(), approximate);
+        found++;
+      }
+      EXPECT_NE(node.name(), "cdf");
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+  }
+};
+
+TEST_F(RemapperFuseGeluTest, Exact) { RunTest(/*approximate=*/false); }
+
+TEST_F(RemapperFuseGeluTest, Approximate) { RunTest(/*approximate=*/true); }
+
+TEST_F(RemapperTest, FuseScaledMaskedSoftmax) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // Attention scores of shape [batch, heads, queries, keys], and a mask that
+  // is broadcast over the heads and queries.
+  auto logits = Placeholder(s.WithOpName("logits"), DT_FLOAT,
+                            ops::Placeholder::Shape({2, 4, 8, 8}));
+  auto mask = Placeholder(s.WithOpName("mask"), DT_FLOAT,
+                          ops::Placeholder::Shape({2, 1, 1, 8}));
+  auto scale = ops::Const(s.WithOpName("scale"), 0.125f);
+  auto scaled = ops::Mul(s.WithOpName("scaled"), logits, scale);
+  auto masked = ops::AddV2(s.WithOpName("masked"), scaled, mask);
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), masked);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), softmax);
+
+  auto logits_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 8, 8});
+  auto mask_t = GenerateRandomTensor<DT_FLOAT>({2, 1, 1, 8});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"logits", logits_t}, {"mask", mask_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "softmax") {
+      EXPECT_EQ(node.op(), "_FusedScaledMaskedSoftmax");
+      ASSERT_EQ(node.input_size(), 2);
+      EXPECT_EQ(node.input(0), "logits");
+      EXPECT_EQ(node.input(1), "mask");
+      EXPECT_FLOAT_EQ(node.attr().at("scale").f(), 0.125f);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, DoNotFuseSoftmaxWithBroadcastLogits) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // The mask has more dimensions than the logits, so the addition broadcasts
+  // the logits, which the fused kernel does not support.
+  auto logits = Placeholder(s.WithOpName("logits"), DT_FLOAT,
+                            ops::Placeholder::Shape({8, 8}));
+  auto mask = Placeholder(s.WithOpName("mask"), DT_FLOAT,
+                          ops::Placeholder::Shape({2, 8, 8}));
+  auto masked = ops::AddV2(s.WithOpName("masked"), logits, mask);
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), masked);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), softmax);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "softmax") EXPECT_EQ(node.op(), "Softmax");
+  }
+}
+
+TEST_F(RemapperTest, FuseAttention) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // Attention of shape [batch, heads, queries, head size], with a padding mask
+  // that is broadcast over the heads and queries.
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 4, 8, 16}));
+  auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                         ops::Placeholder::Shape({2, 4, 12, 16}));
+  auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 4, 12, 8}));
+  auto mask = Placeholder(s.WithOpName("mask"), DT_FLOAT,
+                          ops::Placeholder::Shape({2, 1, 1, 12}));
+  auto scores =
+      ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                         ops::BatchMatMulV2::Attrs().AdjX(false).AdjY(true));
+  auto scale = ops::Const(s.WithOpName("scale"), 0.25f);
+  auto scaled = ops::Mul(s.WithOpName("scaled"), scores, scale);
+  auto masked = ops::AddV2(s.WithOpName("masked"), scaled, mask);
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), masked);
+  auto attention =
+      ops::BatchMatMulV2(s.WithOpName("attention"), softmax, value);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  auto query_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 8, 16});
+  auto key_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 12, 16});
+  auto value_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 12, 8});
+  auto mask_t = GenerateRandomTensor<DT_FLOAT>({2, 1, 1, 12});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"query", query_t},
+               {"key", key_t},
+               {"value", value_t},
+               {"mask", mask_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "Softmax");
+    if (node.name() == "attention") {
+      EXPECT_EQ(node.op(), "_FusedAttention");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "query");
+      EXPECT_EQ(node.input(1), "key");
+      EXPECT_EQ(node.input(2), "value");
+      EXPECT_EQ(node.input(3), "mask");
+      EXPECT_EQ(node.attr().at("num_args").i(), 1);
+      EXPECT_FLOAT_EQ(node.attr().at("scale").f(), 0.25f);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+}
+
+TEST_F(RemapperTest, DoNotFuseAttentionWithUsedScores) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 8, 16}));
+  auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                         ops::Placeholder::Shape({2, 12, 16}));
+  auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 12, 8}));
+  auto scores =
+      ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                         ops::BatchMatMulV2::Attrs().AdjX(false).AdjY(true));
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), scores);
+  auto attention =
+      ops::BatchMatMulV2(s.WithOpName("attention"), softmax, value);
+  // The attention weights are also fetched, so they must be computed anyway.
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+  auto fetch_weights = ops::Identity(s.WithOpName("fetch_weights"), softmax);
+
+  GrapplerItem item;
+  item.fetch = {"fetch", "fetch_weights"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "attention") EXPECT_EQ(node.op(), "BatchMatMulV2");
+  }
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -73,6 +73,7 @@ void SetAllOptimizers(RewriterConfig* cfg, RewriterConfig::Toggle value) {
   cfg->set_arithmetic_optimization(value);
   cfg->set_auto_mixed_precision(value);
   cfg->set_auto_mixed_precision_mkl(value);
+  cfg->set_auto_mixed_precision_cpu(value);
   cfg->set_common_subgraph_elimination(value);
   cfg->set_constant_folding(value);
   cfg->set_debug_stripper(value);
@@ -0,0 +1,164 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCH_FINGERPRINT_H_
+#define TENSORFLOW_CORE_KERNELS_BATCH_FINGERPRINT_H_
+
+#include <cstring>
+
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+namespace batch_fingerprint_internal {
+
+// The steps of Farmhash, which implements Fingerprint64(), for strings of at
+// most 16 bytes.
+constexpr uint64 kK0 = 0xc3a5c85c97cb3127ULL;
+constexpr uint64 kK2 = 0x9ae16a3b2f90404fULL;
+
+inline uint64 Fetch64(const char* p) {
+  uint64 result;
+  std::memcpy(&result, p, sizeof(result));
+  return result;
+}
+
+inline uint64 Fetch32(const char* p) {
+  uint32 result;
+  std::memcpy(&result, p, sizeof(result));
+  return result;
+}
+
+inline uint64 Rotate(uint64 val, int shift) {
+  return (val >> shift) | (val << (64 - shift));
+}
+
+inline uint64 HashLen16(uint64 u, uint64 v, uint64 mul) {
+  uint64 a = (u ^ v) * mul;
+  a ^= (a >> 47);
+  uint64 b = (v ^ a) * mul;
+  b ^= (b >> 47);
+  b *= mul;
+  return b;
+}
+
+// Returns Fingerprint64() of the `len` bytes at `s`, with 8 <= len <= 16.
+inline uint64 HashLen8to16(const char* s, uint64 len) {
+  const uint64 mul = kK2 + len * 2;
+  const uint64 a = Fetch64(s) + kK2;
+  const uint64 b = Fetch64(s + len - 8);
+  const uint64 c = Rotate(b, 37) * mul + a;
+  const uint64 d = (Rotate(a, 25) + b) * mul;
+  return HashLen16(c, d, mul);
+}
+
+// Returns Fingerprint64() of the `len` bytes at `s`, with len <= 16.
+inline uint64 HashLen0to16(const char* s, uint64 len) {
+  if (len >= 8) {
+    return HashLen8to16(s, len);
+  }
+  if (len >= 4) {
+    const uint64 mul = kK2 + len * 2;
+    const uint64 a = Fetch32(s);
+    return HashLen16(len + (a << 3), Fetch32(s + len - 4), mul);
+  }
+  if (len > 0) {
+    const uint8 a = s[0];
+    const uint8 b = s[len >> 1];
+    const uint8 c = s[len - 1];
+    const uint32 y = static_cast<uint32>(a) + (static_cast<uint32>(b) << 8);
+    const uint32 z = len + (static_cast<uint32>(c) << 2);
+    return internal::ShiftMix(y * kK2 ^ z * kK0) * kK2;
+  }
+  return kK2;
+}
+
+inline uint64 Fingerprint64(const char* s, uint64 len) {
+  // Farmhash reads the bytes as little endian words.
+  if (port::kLittleEndian && len <= 16) {
+    return HashLen0to16(s, len);
+  }
+  return ::tensorflow::Fingerprint64(StringPiece(s, len));
+}
+
+}  // namespace batch_fingerprint_internal
+
+// The number of strings BatchFingerprint64() hashes together.
+constexpr int kBatchFingerprintLanes = 8;
+
+// Sets `fingerprints[i]` to Fingerprint64(strings[i]) for i in [0, n).
+//
+// Most feature strings are no longer than 16 bytes, and hashing them is
+// dominated by the dispatch on their length that Fingerprint64() does. The
+// strings are hashed kBatchFingerprintLanes at a time instead: when they all
+// have 8 to 16 bytes, the lanes run the same branch-free steps, which the
+// compiler can vectorize and otherwise interleaves. Other strings of at most 16
+// bytes are still hashed inline, and only longer ones call Fingerprint64().
+inline void BatchFingerprint64(const tstring* strings, int64 n,
+                               uint64* fingerprints) {
+  using batch_fingerprint_internal::Fetch64;
+  using batch_fingerprint_internal::kK2;
+  using batch_fingerprint_internal::Rotate;
+  constexpr int kLanes = kBatchFingerprintLanes;
+  int64 i = 0;
+  if (port::kLittleEndian) {
+    for (; i + kLanes <= n; i += kLanes) {
+      const char* data[kLanes];
+      uint64 len[kLanes];
+      bool all_8_to_16 = true;
+      for (int l = 0; l < kLanes; ++l) {
+        data[l] = strings[i + l].data();
+        len[l] = strings[i + l].size();
+        all_8_to_16 &= len[l] >= 8 && len[l] <= 16;
+      }
+      if (!all_8_to_16) {
+        for (int l = 0; l < kLanes; ++l) {
+          fingerprints[i + l] =
+              batch_fingerprint_internal::Fingerprint64(data[l], len[l]);
+        }
+        continue;
+      }
+      // The steps of HashLen8to16() for all the lanes.
+      uint64 mul[kLanes];
+      uint64 a[kLanes];
+      uint64 b[kLanes];
+      for (int l = 0; l < kLanes; ++l) {
+        mul[l] = kK2 + len[l] * 2;
+        a[l] = Fetch64(data[l]) + kK2;
+        b[l] = Fetch64(data[l] + len[l] - 8);
+      }
+      for (int l = 0; l < kLanes; ++l) {
+        const uint64 c = Rotate(b[l], 37) * mul[l] + a[l];
+        const uint64 d = (Rotate(a[l], 25) + b[l]) * mul[l];
+        uint64 x = (c ^ d) * mul[l];
+        x ^= (x >> 47);
+        uint64 y = (d ^ x) * mul[l];
+        y ^= (y >> 47);
+        fingerprints[i + l] = y * mul[l];
+      }
+    }
+  }
+  for (; i < n; ++i) {
+    fingerprints[i] = batch_fingerprint_internal::Fingerprint64(
+        strings[i].data(), strings[i].size());
+  }
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCH_FINGERPRINT_H_
@@ -0,0 +1,77 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batch_fingerprint.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+std::vector<tstring> RandomStrings(int n, int min_len, int max_len,
+                                   random::SimplePhilox* rnd) {
+  std::vector<tstring> strings(n);
+  for (tstring& s : strings) {
+    std::string str(min_len + rnd->Uniform(max_len - min_len + 1), ' ');
+    for (char& c : str) c = static_cast<char>(rnd->Uniform(256));
+    s = str;
+  }
+  return strings;
+}
+
+void ExpectSameAsFingerprint64(const std::vector<tstring>& strings) {
+  std::vector<uint64> fingerprints(strings.size());
+  BatchFingerprint64(strings.data(), strings.size(), fingerprints.data());
+  for (size_t i = 0; i < strings.size(); ++i) {
+    EXPECT_EQ(fingerprints[i], Fingerprint64(strings[i]))
+        << "for a string of " << strings[i].size() << " bytes";
+  }
+}
+
+TEST(BatchFingerprint64Test, IsForeverFrozen) {
+  const std::vector<tstring> strings = {"a", "Hello", "World",
+                                        "batch1-FC1-F1"};
+  std::vector<uint64> fingerprints(strings.size());
+  BatchFingerprint64(strings.data(), strings.size(), fingerprints.data());
+  EXPECT_EQ(12917804110809363939ULL, fingerprints[0]);
+  EXPECT_EQ(15404698994557526151ULL, fingerprints[1]);
+  EXPECT_EQ(18308117990299812472ULL, fingerprints[2]);
+  EXPECT_EQ(9500645273450923559ULL, fingerprints[3]);
+}
+
+TEST(BatchFingerprint64Test, ShortStrings) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  ExpectSameAsFingerprint64(RandomStrings(1000, 8, 16, &rnd));
+  ExpectSameAsFingerprint64(RandomStrings(1000, 0, 16, &rnd));
+}
+
+TEST(BatchFingerprint64Test, AnyStrings) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  ExpectSameAsFingerprint64(RandomStrings(1000, 0, 100, &rnd));
+  for (int n = 0; n <= 2 * kBatchFingerprintLanes + 1; ++n) {
+    ExpectSameAsFingerprint64(RandomStrings(n, 8, 16, &rnd));
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -230,6 +230,13 @@ class BatchFunctionKernel : public AsyncOpKernel {
       has_attribute_enable_large_batch_splitting_ = false;
     }
 
+    if (c->HasAttr("bucketing_dimension")) {
+      OP_REQUIRES_OK(c, c->GetAttr("bucketing_dimension",
+                                   &bucketing_options_.dimension));
+      OP_REQUIRES_OK(
+          c, c->GetAttr("max_buckets", &bucketing_options_.max_buckets));
+    }
+
     // Helper function `SetAdaptiveBatchSchedulerOptions` calls
     // `OP_REQUIRES_OK`, which exits the current function upon error.
     // So validate status of `op-kernel-construction`.
@@ -329,8 +336,8 @@ class BatchFunctionKernel : public AsyncOpKernel {
                          c->resource_manager()->LookupOrCreate(
                              container_, shared_name_, &br, creator),
                          done);
-    const Status status =
-        br->RegisterInput(random::New64(), c, batcher_queue_, done);
+    const Status status = br->RegisterInput(random::New64(), c, batcher_queue_,
+                                            done, bucketing_options_);
     br->Unref();
     OP_REQUIRES_OK_ASYNC(c, status, done);
     // Assume br calls done, so nothing to do here.
@@ -499,6 +506,7 @@ class BatchFunctionKernel : public AsyncOpKernel {
   FunctionLibraryRuntime* flib_;
   bool enable_large_batch_splitting_;
   bool has_attribute_enable_large_batch_splitting_;
+  serving::BatchResourceBase::BucketingOptions bucketing_options_;
   bool enable_adaptive_batch_threads_ = false;
   mutex mu_;
 
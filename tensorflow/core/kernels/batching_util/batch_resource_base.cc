@@ -92,6 +92,34 @@ void RecordBatchDelayUs(int64 batch_delay_us, const string& model_name,
   cell->GetCell(model_name, op_name)->Add(static_cast<double>(batch_delay_us));
 }
 
+void RecordBatchProcessingUs(int64 batch_processing_us,
+                             const string& model_name, const string& op_name) {
+  static auto* cell = monitoring::PercentileSampler<2>::New(
+      {"/tensorflow/serving/batching/batch_processing_us",
+       "Tracks the time (in microseconds) to run the batch function on a "
+       "batch by model_name (if available).",
+       "model_name", "op_name"},
+      /*percentiles=*/{25.0, 50.0, 75.0, 90.0, 95.0, 99.0},
+      /*max_samples=*/1024, monitoring::UnitOfMeasure::kTime);
+  cell->GetCell(model_name, op_name)
+      ->Add(static_cast<double>(batch_processing_us));
+}
+
+void RecordTaskProcessingShareUs(int64 task_processing_share_us,
+                                 const string& model_name,
+                                 const string& op_name) {
+  static auto* cell = monitoring::PercentileSampler<2>::New(
+      {"/tensorflow/serving/batching/task_processing_share_us",
+       "Tracks the share of the batch processing time (in microseconds) "
+       "attributed to each input, in proportion to its size in the padded "
+       "batch, by model_name (if available).",
+       "model_name", "op_name"},
+      /*percentiles=*/{25.0, 50.0, 75.0, 90.0, 95.0, 99.0},
+      /*max_samples=*/1024, monitoring::UnitOfMeasure::kTime);
+  cell->GetCell(model_name, op_name)
+      ->Add(static_cast<double>(task_processing_share_us));
+}
+
 void RecordBatchParamBatchTimeoutMicros(int64 batch_timeout_micros,
                                         const string& model_name,
                                         const string& op_name) {
@@ -166,7 +194,8 @@ using TensorMatrix = std::vector<std::vector<Tensor>>;
 
 Status BatchResourceBase::RegisterInput(
     int64 guid, OpKernelContext* context, const string& batcher_queue_name,
-    AsyncOpKernel::DoneCallback done_callback) {
+    AsyncOpKernel::DoneCallback done_callback,
+    const BucketingOptions& bucketing_options) {
   std::unique_ptr<BatchTask> batch_components;
   TF_RETURN_IF_ERROR(CreateBatchTask(context, &batch_components));
   batch_components->start_time = EnvTime::NowNanos();
@@ -231,11 +260,31 @@ Status BatchResourceBase::RegisterInput(
   batch_components->status = std::make_shared<ThreadSafeStatus>();
 
   BatcherQueueT* batcher_queue;
-  TF_RETURN_IF_ERROR(
-      LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+  if (bucketing_options.dimension > 0) {
+    TF_RETURN_IF_ERROR(LookupOrCreateBucketQueue(
+        batcher_queue_name,
+        BucketQueueName(batcher_queue_name, bucketing_options.dimension,
+                        batch_components->inputs),
+        bucketing_options.max_buckets, &batcher_queue));
+  } else {
+    TF_RETURN_IF_ERROR(
+        LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+  }
   return batcher_queue->Schedule(&batch_components);
 }
 
+/*static*/ string BatchResourceBase::BucketQueueName(
+    const string& batcher_queue_name, int64 bucketing_dimension,
+    absl::Span<const Tensor> inputs) {
+  string queue_name = batcher_queue_name;
+  for (const Tensor& input : inputs) {
+    if (input.dims() > bucketing_dimension) {
+      absl::StrAppend(&queue_name, "/", input.dim_size(bucketing_dimension));
+    }
+  }
+  return queue_name;
+}
+
 /*static*/ BatchResourceBase::BatcherT::QueueOptions
 BatchResourceBase::GetBatcherQueueOptions(
     int32 num_batch_threads, int32 max_batch_size, int32 batch_timeout_micros,
@@ -461,29 +510,25 @@ Status BatchResourceBase::ConcatInputTensors(
   // Splits each input tensor according to `output_task_sizes`, and
   // initializes input of `output_tasks` with split results.
   for (int i = 0; i < num_input_tensors; ++i) {
-    std::vector<Tensor> split_tensors;
     const Tensor& input_tensor = input_task.inputs[i];
-    // TODO(b/154140947):
-    // Figure out the optimal implementation of Split, by using
-    // 'Tensor::Slice' and eliminating unnecessary memcpy as much as possible.
-    const Status split_status = Split(input_task.context, input_tensor,
-                                      output_task_sizes, &split_tensors);
-    if (!split_status.ok()) {
+    if (input_tensor.dims() == 0 ||
+        input_tensor.dim_size(0) != input_task_size) {
       return errors::Internal(
-          "When splitting input, Tensor split operation failed: ",
-          split_status.ToString());
-    }
-    if (split_tensors.size() != output_task_sizes.size()) {
-      return errors::Internal(
-          "When splitting input, tensor split operation did not work as "
-          "expected; got ",
-          split_tensors.size(), " splits; expected ", output_task_sizes.size());
+          "When splitting input, expected a tensor with 0th dimension ",
+          input_task_size, "; got shape ", input_tensor.shape().DebugString());
     }
+    // The subtasks' inputs alias slices of the input; they are only read when
+    // the batch is concatenated. Misaligned slices are copied, since Eigen
+    // requires aligned buffers.
+    int64 start = 0;
     for (int j = 0; j < output_tasks->size(); ++j) {
-      BatchTask& output_task = *((*output_tasks)[j]);
-      auto moved_tensor_iter = std::next(split_tensors.begin(), j);
-      std::move(moved_tensor_iter, moved_tensor_iter + 1,
-                std::back_inserter(output_task.inputs));
+      const int64 limit = start + output_task_sizes[j];
+      Tensor split_tensor = input_tensor.Slice(start, limit);
+      if (!split_tensor.IsAligned()) {
+        split_tensor = tensor::DeepCopy(split_tensor);
+      }
+      start = limit;
+      (*output_tasks)[j]->inputs.push_back(std::move(split_tensor));
     }
   }
   return Status::OK();
@@ -531,30 +576,24 @@ Status BatchResourceBase::SplitOutputTensors(
           "the 0th dimension sizes of the input tensors");
     }
 
-    std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
-    DCHECK(split_status.ok()) << split_status.ToString();
-    if (!split_status.ok()) {
-      return errors::Internal("Tensor split operation failed: ",
-                              split_status.ToString());
-    }
-    DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
-    if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
-      return errors::Internal(
-          "Tensor split operation did not work as expected; got ",
-          split_tensor.size(), " splits; expected ",
-          task_sizes_plus_optional_padding.size());
-    }
-
-    // Ignore a possible final split_tensors entry containing the padding.
+    // Hand each task a slice that aliases the batched output rather than a
+    // copy of it. Slices that are not suitably aligned for Eigen are copied.
+    // The padding at the end of the batch, if any, is ignored.
+    int64 start = 0;
     for (int j = 0; j < batch->num_tasks(); ++j) {
+      const int64 limit = start + task_sizes_plus_optional_padding[j];
+      Tensor split_tensor = output_tensor.Slice(start, limit);
+      if (!split_tensor.IsAligned()) {
+        split_tensor = tensor::DeepCopy(split_tensor);
+      }
+      start = limit;
+
       BatchTask& task = *(batch->mutable_task(j));
       if (task.is_partial) {
         std::vector<Tensor>& tensor_vector = (*task.output)[task.split_index];
-        tensor_vector[i] = std::move(split_tensor[j]);
+        tensor_vector[i] = std::move(split_tensor);
       } else {
-        task.context->set_output(i, split_tensor[j]);
+        task.context->set_output(i, split_tensor);
       }
     }
   }
@@ -639,6 +678,9 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
           // queue rather than the end.
           cleanup_fn(final_status);
         });
+        RecordTaskCosts(*batch, model_name,
+                        string(last_task_context->op_kernel().name_view()),
+                        current_time);
         final_status = run_status;
         if (!final_status.ok()) {
           return;
@@ -647,6 +689,33 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
       });
 }
 
+void BatchResourceBase::RecordTaskCosts(const BatchT& batch,
+                                        const string& model_name,
+                                        const string& op_name,
+                                        uint64 processing_start_time) const {
+  const int64 processing_us =
+      (EnvTime::NowNanos() - processing_start_time) / 1000;
+  const int padded_batch_size = RoundToLowestAllowedBatchSize(batch.size());
+  RecordBatchProcessingUs(processing_us, model_name, op_name);
+
+  // The padding is paid for by the tasks in proportion to their sizes.
+  for (int i = 0; i < batch.num_tasks(); ++i) {
+    const BatchTask& task = batch.task(i);
+    const int64 queueing_us = (processing_start_time - task.start_time) / 1000;
+    const int64 share_us = processing_us * task.size() / batch.size();
+    RecordTaskProcessingShareUs(share_us, model_name, op_name);
+    profiler::TraceMe::InstantActivity([&] {
+      return profiler::TraceMeEncode(
+          "BatchTaskCost", {{"guid", task.guid},
+                            {"queueing_us", queueing_us},
+                            {"processing_share_us", share_us},
+                            {"task_size", task.size()},
+                            {"batch_size", batch.size()},
+                            {"batch_size_after_padding", padded_batch_size}});
+    });
+  }
+}
+
 // Processes a batch of one or more BatchTask entries.
 void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
   if (batch->empty()) {
@@ -741,7 +810,37 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
 Status BatchResourceBase::LookupOrCreateBatcherQueue(const string& queue_name,
                                                      BatcherQueueT** queue) {
   mutex_lock l(batcher_queues_mu_);
+  return LookupOrCreateBatcherQueueLocked(queue_name, queue);
+}
+
+Status BatchResourceBase::LookupOrCreateBucketQueue(
+    const string& batcher_queue_name, const string& bucket_queue_name,
+    int64 max_buckets, BatcherQueueT** queue) {
+  mutex_lock l(batcher_queues_mu_);
+  auto it = batcher_queues_.find(bucket_queue_name);
+  if (it != batcher_queues_.end()) {
+    *queue = it->second.get();
+    return Status::OK();
+  }
+  int64& num_buckets = num_buckets_[batcher_queue_name];
+  if (num_buckets >= max_buckets) {
+    // Rather than rejecting valid requests, batch the sizes beyond the
+    // maximum together in the queue used without bucketing.
+    LOG_EVERY_N(WARNING, 1000)
+        << "Batching queue '" << batcher_queue_name << "' already has "
+        << num_buckets << " buckets, the maximum, and batches the inputs of "
+        << "bucket '" << bucket_queue_name << "' without bucketing. Raise "
+        << "max_buckets of the op to allow more distinct input sizes.";
+    return LookupOrCreateBatcherQueueLocked(batcher_queue_name, queue);
+  }
+  TF_RETURN_IF_ERROR(
+      LookupOrCreateBatcherQueueLocked(bucket_queue_name, queue));
+  ++num_buckets;
+  return Status::OK();
+}
 
+Status BatchResourceBase::LookupOrCreateBatcherQueueLocked(
+    const string& queue_name, BatcherQueueT** queue) {
   auto it = batcher_queues_.find(queue_name);
   if (it != batcher_queues_.end()) {
     *queue = it->second.get();
@@ -19,6 +19,7 @@ limitations under the License.
 #include <map>
 
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -44,11 +45,32 @@ class BatchResourceBase : public ResourceBase {
   // concatenating tensors along the 2nd dimension gives a output tensor.
   typedef std::vector<std::vector<Tensor>> TensorMatrix;
 
+  // Options for submitting tasks to separate batcher queues, "buckets", by the
+  // size of their inputs along one dimension. Every batch is then formed from
+  // tasks whose inputs can be concatenated. All buckets share the resource's
+  // batch threads.
+  struct BucketingOptions {
+    // The input dimension to bucket on, or 0 to disable bucketing.
+    int64 dimension = 0;
+    // The maximum number of buckets of one batcher queue. Tasks that would
+    // need another bucket go to the batcher queue itself, as without
+    // bucketing.
+    int64 max_buckets = 0;
+  };
+
   // Ingests data from one invocation of the batch op. The data is enqueued to
   // be combined with others into a batch, asynchronously.
   Status RegisterInput(int64 guid, OpKernelContext* context,
                        const string& batcher_queue_name,
-                       AsyncOpKernel::DoneCallback done_callback);
+                       AsyncOpKernel::DoneCallback done_callback,
+                       const BucketingOptions& bucketing_options = {});
+
+  // Returns the name of the bucket of `batcher_queue_name` for a task with
+  // `inputs`, which encodes the sizes of the inputs along
+  // `bucketing_dimension`.
+  static string BucketQueueName(const string& batcher_queue_name,
+                                int64 bucketing_dimension,
+                                absl::Span<const Tensor> inputs);
 
  public:
   // One task to be batched, corresponds to a `slice` of input from one batch-op
@@ -143,6 +165,50 @@ class BatchResourceBase : public ResourceBase {
       int32 max_enqueued_batches, bool enable_large_batch_splitting,
       const std::vector<int32>& allowed_batch_sizes);
 
+ protected:
+  // Looks up the batcher queue for 'queue_name'. If it did't previously exist,
+  // creates it.
+  Status LookupOrCreateBatcherQueue(const string& queue_name,
+                                    BatcherQueueT** queue);
+
+  // Like LookupOrCreateBatcherQueue for 'bucket_queue_name', a bucket of
+  // 'batcher_queue_name'. If the bucket does not exist yet and
+  // 'batcher_queue_name' already has 'max_buckets' buckets, returns the queue
+  // of 'batcher_queue_name' instead.
+  Status LookupOrCreateBucketQueue(const string& batcher_queue_name,
+                                   const string& bucket_queue_name,
+                                   int64 max_buckets, BatcherQueueT** queue);
+
+  // Split 'input' of 'input_task_ptr' along 0th dimension, into a list of
+  // 'output_tasks'.
+  // Task sizes are determined by
+  // 1) open_batch_remaining_slot
+  // 2) max_batch_size
+  // 3) size-of-input-task
+  // in a way that
+  // 1) Task sizes add up to `size-of-input-task`.
+  // 2) Task sizes from left to right are like
+  //    [open_batch_remaining_slot, max_batch_size, max_batch_size, ...,
+  //    `size-of-input-task` - `sum-of-previous-elements`].
+  //
+  // The inputs of 'output_tasks' alias the input tensors wherever the slices
+  // are aligned, and are copied otherwise.
+  //
+  // REQUIRES:
+  // Caller should make sure size-of-input-task is greater than
+  // open_batch_remaining_slot.
+  static Status SplitInputTask(
+      std::unique_ptr<BatchTask>* input_task_ptr, int open_batch_remaining_slot,
+      int max_batch_size,
+      std::vector<std::unique_ptr<BatchTask>>* output_tasks);
+
+  // Attributes the time since 'processing_start_time' (in nanoseconds) spent
+  // processing 'batch' to its tasks, and records it along with each task's
+  // queueing delay in metrics and as profiler events.
+  void RecordTaskCosts(const BatchT& batch, const string& model_name,
+                       const string& op_name,
+                       uint64 processing_start_time) const;
+
  private:
   // Implementation of calling the process batch function.
   virtual void ProcessFuncBatchImpl(
@@ -167,26 +233,6 @@ class BatchResourceBase : public ResourceBase {
   Status ConcatInputTensors(const BatchT& batch, OpKernelContext* context,
                             std::vector<Tensor>* concatenated_tensors) const;
 
-  // Split 'input' of 'input_task_ptr' along 0th dimension, into a list of
-  // 'output_tasks'.
-  // Task sizes are determined by
-  // 1) open_batch_remaining_slot
-  // 2) max_batch_size
-  // 3) size-of-input-task
-  // in a way that
-  // 1) Task sizes add up to `size-of-input-task`.
-  // 2) Task sizes from left to right are like
-  //    [open_batch_remaining_slot, max_batch_size, max_batch_size, ...,
-  //    `size-of-input-task` - `sum-of-previous-elements`].
-  //
-  // REQUIRES:
-  // Caller should make sure size-of-input-task is greater than
-  // open_batch_remaining_slot.
-  static Status SplitInputTask(
-      std::unique_ptr<BatchTask>* input_task_ptr, int open_batch_remaining_slot,
-      int max_batch_size,
-      std::vector<std::unique_ptr<BatchTask>>* output_tasks);
-
   Status SplitOutputTensors(const std::vector<Tensor>& combined_outputs,
                             BatchT* batch) const;
 
@@ -205,10 +251,9 @@ class BatchResourceBase : public ResourceBase {
   static Status EmitIndexTensor(OpKernelContext* context, const BatchT& batch,
                                 int output_index);
 
-  // Looks up the batcher queue for 'queue_name'. If it did't previously exist,
-  // creates it.
-  Status LookupOrCreateBatcherQueue(const string& queue_name,
-                                    BatcherQueueT** queue);
+  Status LookupOrCreateBatcherQueueLocked(const string& queue_name,
+                                          BatcherQueueT** queue)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(batcher_queues_mu_);
 
   // True if user specified a batch processing function for this resource.
   const bool has_process_batch_function_;
@@ -226,6 +271,8 @@ class BatchResourceBase : public ResourceBase {
   mutable mutex batcher_queues_mu_;
   std::map<string, std::unique_ptr<BatcherQueueT>> batcher_queues_
       TF_GUARDED_BY(batcher_queues_mu_);
+  // The number of buckets of each batcher queue that buckets its tasks.
+  std::map<string, int64> num_buckets_ TF_GUARDED_BY(batcher_queues_mu_);
 
   std::vector<int32> allowed_batch_sizes_;
   // A concatenated string of <allowed_batch_sizes_>, separated by ",". This is
@@ -0,0 +1,306 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/collected_metrics.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+class TestBatchResource : public BatchResourceBase {
+ public:
+  static Status Create(TestBatchResource** resource) {
+    BatcherT::Options batcher_options;
+    batcher_options.num_batch_threads = 1;
+    std::shared_ptr<BatcherT> batcher;
+    TF_RETURN_IF_ERROR(BatcherT::Create(batcher_options, &batcher));
+    *resource = new TestBatchResource(
+        std::move(batcher),
+        GetBatcherQueueOptions(
+            /*num_batch_threads=*/1, /*max_batch_size=*/4,
+            /*batch_timeout_micros=*/1000, /*max_enqueued_batches=*/10,
+            /*allowed_batch_sizes=*/{},
+            /*enable_large_batch_splitting=*/false));
+    return Status::OK();
+  }
+
+  string DebugString() const final { return "TestBatchResource"; }
+
+  using BatchResourceBase::LookupOrCreateBatcherQueue;
+  using BatchResourceBase::LookupOrCreateBucketQueue;
+  using BatchResourceBase::RecordTaskCosts;
+  using BatchResourceBase::SplitInputTask;
+
+ private:
+  TestBatchResource(std::shared_ptr<BatcherT> batcher,
+                    const BatcherT::QueueOptions& batcher_queue_options)
+      : BatchResourceBase(/*has_process_batch_function=*/true,
+                          std::move(batcher), batcher_queue_options,
+                          /*allowed_batch_sizes=*/{}) {}
+
+  void ProcessFuncBatchImpl(
+      const BatchTask& last_task, absl::Span<const Tensor> inputs,
+      std::vector<Tensor>* combined_outputs,
+      std::function<void(const Status&)> done) const override {
+    done(errors::Unimplemented("ProcessFuncBatchImpl"));
+  }
+};
+
+TEST(BatchResourceBaseTest, BucketQueueName) {
+  const std::vector<Tensor> inputs = {Tensor(DT_FLOAT, TensorShape({2, 3})),
+                                      Tensor(DT_FLOAT, TensorShape({2})),
+                                      Tensor(DT_INT32, TensorShape({2, 5, 7}))};
+  EXPECT_EQ(BatchResourceBase::BucketQueueName("q", 1, inputs), "q/3/5");
+  EXPECT_EQ(BatchResourceBase::BucketQueueName("q", 2, inputs), "q/7");
+  EXPECT_EQ(BatchResourceBase::BucketQueueName("q", 3, inputs), "q");
+}
+
+TEST(BatchResourceBaseTest, BucketQueuesAreReused) {
+  TestBatchResource* resource;
+  TF_ASSERT_OK(TestBatchResource::Create(&resource));
+  core::ScopedUnref unref(resource);
+
+  BatchResourceBase::BatcherQueueT* queue_3;
+  TF_ASSERT_OK(resource->LookupOrCreateBucketQueue("q", "q/3", 2, &queue_3));
+  BatchResourceBase::BatcherQueueT* queue;
+  TF_ASSERT_OK(resource->LookupOrCreateBucketQueue("q", "q/3", 2, &queue));
+  EXPECT_EQ(queue, queue_3);
+
+  BatchResourceBase::BatcherQueueT* queue_5;
+  TF_ASSERT_OK(resource->LookupOrCreateBucketQueue("q", "q/5", 2, &queue_5));
+  EXPECT_NE(queue_5, queue_3);
+}
+
+TEST(BatchResourceBaseTest, BucketsBeyondTheMaximumShareOneQueue) {
+  TestBatchResource* resource;
+  TF_ASSERT_OK(TestBatchResource::Create(&resource));
+  core::ScopedUnref unref(resource);
+
+  BatchResourceBase::BatcherQueueT* queue_3;
+  BatchResourceBase::BatcherQueueT* queue_5;
+  TF_ASSERT_OK(resource->LookupOrCreateBucketQueue("q", "q/3", 2, &queue_3));
+  TF_ASSERT_OK(resource->LookupOrCreateBucketQueue("q", "q/5", 2, &queue_5));
+
+  // Sizes beyond the maximum share the queue used without bucketing.
+  BatchResourceBase::BatcherQueueT* shared_queue;
+  TF_ASSERT_OK(resource->LookupOrCreateBatcherQueue("q", &shared_queue));
+  BatchResourceBase::BatcherQueueT* queue;
+  TF_ASSERT_OK(resource->LookupOrCreateBucketQueue("q", "q/7", 2, &queue));
+  EXPECT_EQ(queue, shared_queue);
+  TF_ASSERT_OK(resource->LookupOrCreateBucketQueue("q", "q/9", 2, &queue));
+  EXPECT_EQ(queue, shared_queue);
+
+  // Existing buckets are still served.
+  TF_ASSERT_OK(resource->LookupOrCreateBucketQueue("q", "q/5", 2, &queue));
+  EXPECT_EQ(queue, queue_5);
+  // Buckets are counted per batcher queue.
+  TF_ASSERT_OK(resource->LookupOrCreateBucketQueue("r", "r/7", 2, &queue));
+  EXPECT_NE(queue, shared_queue);
+}
+
+TEST(BatchResourceBaseTest, OverflowCreatesTheSharedQueue) {
+  TestBatchResource* resource;
+  TF_ASSERT_OK(TestBatchResource::Create(&resource));
+  core::ScopedUnref unref(resource);
+
+  BatchResourceBase::BatcherQueueT* queue_3;
+  BatchResourceBase::BatcherQueueT* overflow_queue;
+  TF_ASSERT_OK(resource->LookupOrCreateBucketQueue("q", "q/3", 1, &queue_3));
+  TF_ASSERT_OK(
+      resource->LookupOrCreateBucketQueue("q", "q/5", 1, &overflow_queue));
+  EXPECT_NE(overflow_queue, queue_3);
+
+  // The overflow queue is the one used without bucketing, created on demand.
+  BatchResourceBase::BatcherQueueT* shared_queue;
+  TF_ASSERT_OK(resource->LookupOrCreateBatcherQueue("q", &shared_queue));
+  EXPECT_EQ(overflow_queue, shared_queue);
+}
+
+// Returns a task for 'inputs' whose split tasks complete by setting 'done'.
+std::unique_ptr<BatchResourceBase::BatchTask> NewTask(
+    OpKernelContext* context, std::vector<Tensor> inputs, bool* done) {
+  auto task = std::make_unique<BatchResourceBase::BatchTask>();
+  task->inputs = std::move(inputs);
+  task->context = context;
+  task->done_callback = [done]() { *done = true; };
+  task->output = std::make_shared<BatchResourceBase::TensorMatrix>();
+  task->status = std::make_shared<ThreadSafeStatus>();
+  return task;
+}
+
+void RunSplitTasks(
+    const std::vector<std::unique_ptr<BatchResourceBase::BatchTask>>& tasks) {
+  for (const auto& task : tasks) {
+    task->done_callback();
+  }
+}
+
+TEST(BatchResourceBaseTest, SplitInputTaskAliasesAlignedSlices) {
+  DeviceBase device(Env::Default());
+  OpKernelContext::Params params;
+  params.device = &device;
+  OpKernelContext context(&params, /*num_outputs=*/0);
+
+  // Rows of 64 bytes keep every slice aligned.
+  Tensor input(DT_FLOAT, TensorShape({5, 16}));
+  auto input_flat = input.flat<float>();
+  for (int i = 0; i < input_flat.size(); ++i) input_flat(i) = i;
+
+  bool done = false;
+  std::unique_ptr<BatchResourceBase::BatchTask> task =
+      NewTask(&context, {input}, &done);
+  std::vector<std::unique_ptr<BatchResourceBase::BatchTask>> split_tasks;
+  TF_ASSERT_OK(TestBatchResource::SplitInputTask(
+      &task, /*open_batch_remaining_slot=*/2, /*max_batch_size=*/2,
+      &split_tasks));
+
+  ASSERT_EQ(split_tasks.size(), 3);
+  const std::vector<int> split_sizes = {2, 2, 1};
+  int start = 0;
+  for (int i = 0; i < split_tasks.size(); ++i) {
+    ASSERT_EQ(split_tasks[i]->inputs.size(), 1);
+    const Tensor& split = split_tasks[i]->inputs[0];
+    EXPECT_EQ(split.shape(), TensorShape({split_sizes[i], 16}));
+    EXPECT_EQ(split_tasks[i]->split_index, i);
+    EXPECT_TRUE(split_tasks[i]->is_partial);
+    EXPECT_EQ(split.tensor_data().data(),
+              input.tensor_data().data() + start * 16 * sizeof(float));
+    start += split_sizes[i];
+  }
+
+  RunSplitTasks(split_tasks);
+  EXPECT_TRUE(done);
+}
+
+TEST(BatchResourceBaseTest, SplitInputTaskCopiesMisalignedSlices) {
+  DeviceBase device(Env::Default());
+  OpKernelContext::Params params;
+  params.device = &device;
+  OpKernelContext context(&params, /*num_outputs=*/0);
+
+  Tensor input(DT_FLOAT, TensorShape({5}));
+  auto input_flat = input.flat<float>();
+  for (int i = 0; i < input_flat.size(); ++i) input_flat(i) = i;
+
+  bool done = false;
+  std::unique_ptr<BatchResourceBase::BatchTask> task =
+      NewTask(&context, {input}, &done);
+  std::vector<std::unique_ptr<BatchResourceBase::BatchTask>> split_tasks;
+  TF_ASSERT_OK(TestBatchResource::SplitInputTask(
+      &task, /*open_batch_remaining_slot=*/3, /*max_batch_size=*/3,
+      &split_tasks));
+
+  ASSERT_EQ(split_tasks.size(), 2);
+  const Tensor& head = split_tasks[0]->inputs[0];
+  const Tensor& tail = split_tasks[1]->inputs[0];
+  EXPECT_TRUE(head.IsAligned());
+  EXPECT_TRUE(tail.IsAligned());
+  ASSERT_EQ(head.NumElements(), 3);
+  ASSERT_EQ(tail.NumElements(), 2);
+  for (int i = 0; i < 3; ++i) EXPECT_EQ(head.flat<float>()(i), i);
+  for (int i = 0; i < 2; ++i) EXPECT_EQ(tail.flat<float>()(i), 3 + i);
+
+  RunSplitTasks(split_tasks);
+  EXPECT_TRUE(done);
+}
+
+TEST(BatchResourceBaseTest, SplitInputTaskRejectsMismatchedInputs) {
+  DeviceBase device(Env::Default());
+  OpKernelContext::Params params;
+  params.device = &device;
+  OpKernelContext context(&params, /*num_outputs=*/0);
+
+  bool done = false;
+  // The second input has fewer rows than the first.
+  std::unique_ptr<BatchResourceBase::BatchTask> task =
+      NewTask(&context,
+              {Tensor(DT_FLOAT, TensorShape({4, 2})),
+               Tensor(DT_FLOAT, TensorShape({3}))},
+              &done);
+  std::vector<std::unique_ptr<BatchResourceBase::BatchTask>> split_tasks;
+  Status status = TestBatchResource::SplitInputTask(
+      &task, /*open_batch_remaining_slot=*/1, /*max_batch_size=*/2,
+      &split_tasks);
+  EXPECT_TRUE(errors::IsInternal(status)) << status;
+
+  RunSplitTasks(split_tasks);
+  EXPECT_TRUE(done);
+}
+
+// Returns the samples of the percentile sampler 'metric_name' for 'model_name'.
+monitoring::Percentiles GetPercentiles(const string& metric_name,
+                                       const string& model_name) {
+  std::unique_ptr<monitoring::CollectedMetrics> collected =
+      monitoring::CollectionRegistry::Default()->CollectMetrics({});
+  auto it = collected->point_set_map.find(metric_name);
+  if (it != collected->point_set_map.end()) {
+    for (const auto& point : it->second->points) {
+      if (!point->labels.empty() && point->labels[0].value == model_name) {
+        return point->percentiles_value;
+      }
+    }
+  }
+  return monitoring::Percentiles();
+}
+
+TEST(BatchResourceBaseTest, TaskCostsAreSharedBySize) {
+  TestBatchResource* resource;
+  TF_ASSERT_OK(TestBatchResource::Create(&resource));
+  core::ScopedUnref unref(resource);
+
+  const uint64 processing_start_time = EnvTime::NowNanos() - 4000000;
+  BatchResourceBase::BatchT batch;
+  for (int size : {1, 3}) {
+    auto task = std::make_unique<BatchResourceBase::BatchTask>();
+    task->inputs.push_back(Tensor(DT_FLOAT, TensorShape({size})));
+    task->start_time = processing_start_time - 1000000;
+    batch.AddTask(std::move(task));
+  }
+  batch.Close();
+  resource->RecordTaskCosts(batch, "task_costs_model", "op",
+                            processing_start_time);
+
+  const monitoring::Percentiles batch_us = GetPercentiles(
+      "/tensorflow/serving/batching/batch_processing_us", "task_costs_model");
+  const monitoring::Percentiles share_us =
+      GetPercentiles("/tensorflow/serving/batching/task_processing_share_us",
+                     "task_costs_model");
+  ASSERT_EQ(batch_us.total_samples, 1);
+  ASSERT_EQ(share_us.total_samples, 2);
+  EXPECT_GE(batch_us.max_value, 4000);
+  // The tasks pay a quarter and three quarters of the batch, rounded down.
+  EXPECT_NEAR(share_us.min_value, batch_us.max_value / 4, 1);
+  EXPECT_NEAR(share_us.max_value, batch_us.max_value * 3 / 4, 1);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -18,8 +18,10 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
 #include <string>
@@ -31,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
@@ -77,9 +80,17 @@ namespace serving {
 // down over the lifetime of a server.
 //
 // The batch thread pool round-robins through the queues, running one batch
-// from a queue and then moving to the next queue. Each queue behaves like a
-// BasicBatchScheduler instance, in the sense that it has maximum batch size and
-// timeout parameters, which govern when a batch is eligible to be processed.
+// from a queue (or 'weight' batches, see QueueOptions) and then moving to the
+// next queue. Each queue behaves like a BasicBatchScheduler instance, in the
+// sense that it has maximum batch size and timeout parameters, which govern
+// when a batch is eligible to be processed.
+//
+// Queues may also be given a priority. While a queue has a batch ready to be
+// processed, queues of lower priority are skipped, even if their own batches
+// were formed earlier; the round-robin only applies among the queues of the
+// highest priority with work ready. So that low priority traffic cannot starve,
+// a queue that has been passed over 'max_priority_bypasses' times in a row is
+// served regardless of its priority.
 //
 // Each queue is independently configured with a maximum size (in terms of the
 // maximum number of batches worth of enqueued tasks). For online serving, it is
@@ -97,11 +108,6 @@ namespace serving {
 // For bulk processing jobs and throughput-oriented benchmarks, you may want to
 // set the maximum queue size to a large value.
 //
-// TODO(b/26539183): Support queue servicing policies other than round-robin.
-// E.g. let each queue specify a "share" (an int >= 1), so e.g. with queues A
-// and B having shares 1 and 2 respectively, the servicing pattern is ABBABB...
-//
-//
 // PERFORMANCE TUNING: See README.md.
 //
 template <typename TaskType>
@@ -117,6 +123,12 @@ class SharedBatchScheduler
     // Must be >= 1, and should be tuned carefully.
     int num_batch_threads = port::MaxParallelism();
 
+    // The number of times in a row a queue with a batch ready to be processed
+    // may be passed over in favor of queues with a higher 'priority'. Once the
+    // limit is reached, the queue's next batch is processed ahead of
+    // higher-priority work. Must be >= 0; 0 effectively disables priorities.
+    int max_priority_bypasses = 16;
+
     // The environment to use.
     // (Typically only overridden by test code.)
     Env* env = Env::Default();
@@ -157,6 +169,13 @@ class SharedBatchScheduler
     // avoid latency spikes.
     int64 batch_timeout_micros = 0;
 
+    // If positive, the queue adapts its batch timeout to this latency target
+    // instead of always using `batch_timeout_micros`: after each batch it sets
+    // the timeout to the target minus a moving average of the batch processing
+    // time, so a task waits only as long as the target allows. A positive
+    // `batch_timeout_micros` then caps the adapted timeout.
+    int64 target_latency_micros = 0;
+
     // The maximum allowable number of enqueued (accepted by Schedule() but
     // not yet being processed on a batch thread) tasks in terms of batches.
     // If this limit is reached, Schedule() will return an UNAVAILABLE error.
@@ -195,6 +214,17 @@ class SharedBatchScheduler
     // submit batches whose size is in a small set of allowed sizes, that can be
     // done by adding padding in the process-batch callback.
     size_t max_execution_batch_size = 1000;
+
+    // Queues with a higher priority are served first: while any of them has a
+    // batch ready to be processed, batches of lower-priority queues are left
+    // waiting (subject to 'Options::max_priority_bypasses').
+    int priority = 0;
+
+    // The number of consecutive batches the batch threads take from this
+    // queue, when it has them ready, before moving on to the next queue of the
+    // same priority. E.g. with queues A and B having weights 1 and 2
+    // respectively, the servicing pattern is ABBABB... Must be >= 1.
+    int weight = 1;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -206,18 +236,34 @@ class SharedBatchScheduler
 
   // The code executed in 'batch_threads_'. Obtains a batch to process from the
   // queue pointed to by 'next_queue_to_schedule_', and processes it. If that
-  // queue declines to provide a batch to process, moves onto the next queue. If
-  // no queues provide a batch to process, just sleeps briefly and exits.
+  // queue declines to provide a batch to process, or has a lower priority than
+  // another queue with a batch ready, moves onto the next queue. If no queues
+  // provide a batch to process, just sleeps briefly and exits.
   void ThreadLogic();
 
+  // Returns the lowest priority a queue needs for ThreadLogic() to take a
+  // batch from it now, i.e. the highest priority of the queues that have a
+  // batch ready. Queues at their bypass limit are eligible regardless.
+  int MinEligiblePriority() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const Options options_;
 
   mutex mu_;
 
+  // A queue, along with the scheduler's bookkeeping for it.
+  struct ScheduledQueue {
+    std::unique_ptr<internal::Queue<TaskType>> queue;
+    // The number of further batches to take from 'queue' before moving on.
+    int remaining_turns = 0;
+    // The number of times in a row 'queue' had a batch ready but was passed
+    // over in favor of a higher-priority queue.
+    int num_bypasses = 0;
+  };
+
   // A list of queues. (We use std::list instead of std::vector to ensure that
   // iterators are not invalidated by adding/removing elements. It also offers
   // efficient removal of elements from the middle.)
-  using QueueList = std::list<std::unique_ptr<internal::Queue<TaskType>>>;
+  using QueueList = std::list<ScheduledQueue>;
 
   // All "active" queues, i.e. ones that either:
   //  - have not been removed, or
@@ -328,6 +374,12 @@ class Queue {
 
   bool closed() const TF_NO_THREAD_SAFETY_ANALYSIS { return closed_.load(); }
 
+  // Determines whether ScheduleBatch() would currently return a batch.
+  bool HasSchedulableBatch() const;
+
+  int priority() const { return options_.priority; }
+  int weight() const { return options_.weight; }
+
  private:
   // Same as IsEmpty(), but assumes the caller already holds a lock on 'mu_'.
   bool IsEmptyInternal() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -346,6 +398,11 @@ class Queue {
   // currently schedulable.
   bool IsOpenBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Folds the processing time of a batch into the moving average and, if the
+  // queue has a latency target, recomputes 'batch_timeout_micros_'.
+  void UpdateBatchTimeout(int64 processing_micros)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -376,6 +433,14 @@ class Queue {
   // in 'batches_'. Valid iff that batch contains at least one task.
   uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
 
+  // The batch timeout currently in effect. Equal to
+  // 'options_.batch_timeout_micros' unless the queue has a latency target.
+  int64 batch_timeout_micros_ TF_GUARDED_BY(mu_);
+
+  // Moving average of the time spent in 'process_batch_callback_', or -1
+  // before the first batch is processed.
+  int64 batch_processing_micros_ TF_GUARDED_BY(mu_) = -1;
+
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
@@ -430,6 +495,11 @@ Status SharedBatchScheduler<TaskType>::Create(
     return errors::InvalidArgument("num_batch_threads must be positive; was ",
                                    options.num_batch_threads);
   }
+  if (options.max_priority_bypasses < 0) {
+    return errors::InvalidArgument(
+        "max_priority_bypasses must be non-negative; was ",
+        options.max_priority_bypasses);
+  }
   scheduler->reset(new SharedBatchScheduler<TaskType>(options));
   return Status::OK();
 }
@@ -469,11 +539,20 @@ Status SharedBatchScheduler<TaskType>::AddQueue(
         "batch_timeout_micros must be non-negative; was ",
         options.batch_timeout_micros);
   }
+  if (options.target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_latency_micros must be non-negative; was ",
+        options.target_latency_micros);
+  }
   if (options.max_enqueued_batches < 0) {
     return errors::InvalidArgument(
         "max_enqueued_batches must be non-negative; was ",
         options.max_enqueued_batches);
   }
+  if (options.weight < 1) {
+    return errors::InvalidArgument("weight must be positive; was ",
+                                   options.weight);
+  }
 
   if (options.enable_large_batch_splitting &&
       options.split_input_task_func == nullptr) {
@@ -506,7 +585,7 @@ Status SharedBatchScheduler<TaskType>::AddQueue(
                                           internal_queue.get()));
   {
     mutex_lock l(mu_);
-    queues_.push_back(std::move(internal_queue));
+    queues_.push_back({std::move(internal_queue)});
     if (next_queue_to_schedule_ == queues_.end()) {
       next_queue_to_schedule_ = queues_.begin();
     }
@@ -540,30 +619,46 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
     mutex_lock l(mu_);
 
     const int num_queues = queues_.size();
+    const int min_priority = queues_.empty() ? 0 : MinEligiblePriority();
     for (int num_queues_tried = 0;
          batch_to_process == nullptr && num_queues_tried < num_queues;
          ++num_queues_tried) {
       DCHECK(next_queue_to_schedule_ != queues_.end());
+      ScheduledQueue& scheduled = *next_queue_to_schedule_;
+      internal::Queue<TaskType>* queue = scheduled.queue.get();
 
       // If a closed queue responds to ScheduleBatch() with nullptr, the queue
       // will never yield any further batches so we can drop it. To avoid a
       // race, we take a snapshot of the queue's closedness state *before*
       // calling ScheduleBatch().
-      const bool queue_closed = (*next_queue_to_schedule_)->closed();
-
-      // Ask '*next_queue_to_schedule_' if it wants us to process a batch.
-      batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch();
+      const bool queue_closed = queue->closed();
+
+      // Ask 'queue' if it wants us to process a batch, unless higher-priority
+      // work is waiting and 'queue' has not yet been passed over too often.
+      if (queue->priority() >= min_priority ||
+          scheduled.num_bypasses >= options_.max_priority_bypasses) {
+        batch_to_process = queue->ScheduleBatch();
+      } else if (queue->HasSchedulableBatch()) {
+        ++scheduled.num_bypasses;
+      }
+      bool take_another_turn = false;
       if (batch_to_process != nullptr) {
-        queue_for_batch = next_queue_to_schedule_->get();
+        queue_for_batch = queue;
+        scheduled.num_bypasses = 0;
+        if (scheduled.remaining_turns == 0) {
+          scheduled.remaining_turns = queue->weight();
+        }
+        take_another_turn = --scheduled.remaining_turns > 0;
+      } else {
+        scheduled.remaining_turns = 0;
       }
 
-      // Advance 'next_queue_to_schedule_'.
-      if (queue_closed && (*next_queue_to_schedule_)->IsEmpty() &&
-          batch_to_process == nullptr) {
+      // Advance 'next_queue_to_schedule_', unless 'queue' has turns left.
+      if (queue_closed && queue->IsEmpty() && batch_to_process == nullptr) {
         // We've encountered a closed queue with no work to do. Drop it.
-        DCHECK_NE(queue_for_batch, next_queue_to_schedule_->get());
+        DCHECK_NE(queue_for_batch, queue);
         next_queue_to_schedule_ = queues_.erase(next_queue_to_schedule_);
-      } else {
+      } else if (!take_another_turn) {
         ++next_queue_to_schedule_;
       }
       if (next_queue_to_schedule_ == queues_.end() && !queues_.empty()) {
@@ -584,6 +679,34 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
   queue_for_batch->ProcessBatch(std::move(batch_to_process));
 }
 
+template <typename TaskType>
+int SharedBatchScheduler<TaskType>::MinEligiblePriority() {
+  // Only look for ready batches, which takes each queue's lock, if the queues
+  // do not all share the same priority.
+  const int first_priority = queues_.front().queue->priority();
+  bool uniform_priority = true;
+  for (const ScheduledQueue& scheduled : queues_) {
+    if (scheduled.queue->priority() != first_priority) {
+      uniform_priority = false;
+      break;
+    }
+  }
+  if (uniform_priority) {
+    return first_priority;
+  }
+
+  int min_priority = std::numeric_limits<int>::min();
+  for (const ScheduledQueue& scheduled : queues_) {
+    const int priority = scheduled.queue->priority();
+    if (priority > min_priority &&
+        scheduled.num_bypasses < options_.max_priority_bypasses &&
+        scheduled.queue->HasSchedulableBatch()) {
+      min_priority = priority;
+    }
+  }
+  return min_priority;
+}
+
 namespace internal {
 
 template <typename TaskType>
@@ -594,7 +717,13 @@ Queue<TaskType>::Queue(
     : options_(options),
       env_(env),
       process_batch_callback_(process_batch_callback),
-      schedulable_batch_callback_(schedulable_batch_callback) {
+      schedulable_batch_callback_(schedulable_batch_callback),
+      batch_timeout_micros_(options.batch_timeout_micros) {
+  if (options_.target_latency_micros > 0 &&
+      (batch_timeout_micros_ == 0 ||
+       options_.target_latency_micros < batch_timeout_micros_)) {
+    batch_timeout_micros_ = options_.target_latency_micros;
+  }
   // Set the higher 32 bits of traceme_context_id_counter_ to be the creation
   // time of the queue. This prevents the batches in different queues to have
   // the same traceme_context_id_counter_.
@@ -820,10 +949,13 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
       },
       profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
+  const uint64 start_time_micros = env_->NowMicros();
   process_batch_callback_(std::move(batch));
+  const int64 processing_micros = env_->NowMicros() - start_time_micros;
 
   {
     mutex_lock l(mu_);
+    UpdateBatchTimeout(processing_micros);
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -831,6 +963,12 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
   }
 }
 
+template <typename TaskType>
+bool Queue<TaskType>::HasSchedulableBatch() const {
+  mutex_lock l(mu_);
+  return batches_.size() >= 2 || IsOpenBatchSchedulable();
+}
+
 template <typename TaskType>
 bool Queue<TaskType>::IsEmpty() const {
   mutex_lock l(mu_);
@@ -884,7 +1022,30 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros_;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::UpdateBatchTimeout(int64 processing_micros) {
+  if (options_.target_latency_micros == 0) return;
+  static auto* adapted_timeout_sampler = monitoring::Sampler<0>::New(
+      {"/tensorflow/serving/batching/adapted_batch_timeout_micros",
+       "Batch timeouts chosen by queues with a latency target."},
+      monitoring::Buckets::Exponential(1, 2, 30));
+
+  // Weighs the latest batch by 1/8, which smooths out single slow batches but
+  // follows shifts in load within tens of batches.
+  batch_processing_micros_ =
+      batch_processing_micros_ < 0
+          ? processing_micros
+          : (7 * batch_processing_micros_ + processing_micros) / 8;
+  int64 timeout_micros = std::max(
+      int64{0}, options_.target_latency_micros - batch_processing_micros_);
+  if (options_.batch_timeout_micros > 0) {
+    timeout_micros = std::min(timeout_micros, options_.batch_timeout_micros);
+  }
+  batch_timeout_micros_ = timeout_micros;
+  adapted_timeout_sampler->GetCell()->Add(timeout_micros);
 }
 
 template <typename TaskType>
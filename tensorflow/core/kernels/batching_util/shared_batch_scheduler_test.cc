@@ -254,6 +254,59 @@ TEST(SharedBatchSchedulerTest, ObeysTimeout) {
   stop_teardown.Notify();
 }
 
+TEST(SharedBatchSchedulerTest, AdaptsTimeoutToLatencyTarget) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification first_batch_processed, second_batch_processed;
+    auto callback = [&env, &first_batch_processed, &second_batch_processed](
+                        std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      if (!first_batch_processed.HasBeenNotified()) {
+        // Each batch takes 60us to process.
+        env.AdvanceByMicroseconds(60);
+        first_batch_processed.Notify();
+      } else {
+        second_batch_processed.Notify();
+      }
+    };
+
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.input_batch_size_limit = 4;
+    queue_options.batch_timeout_micros = 1000;
+    queue_options.target_latency_micros = 100;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // Before any batch was processed the whole target is used for batching.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(99);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(first_batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(1);
+    first_batch_processed.WaitForNotification();
+
+    // The 60us processing time leaves 40us of the target for batching.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(39);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(second_batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(1);
+    second_batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 TEST(SharedBatchSchedulerTest, ObeysTimeoutWithRealClock) {
   Notification first_batch_processed, second_batch_processed;
   auto callback = [&first_batch_processed, &second_batch_processed](
@@ -407,6 +460,97 @@ TEST(SharedBatchSchedulerTest, Fairness) {
   stop_teardown.Notify();
 }
 
+// Runs 'num_low' and 'num_high' batch-filling tasks through queues with the
+// given options, after a first low queue batch that occupies the only batch
+// thread until all of them are enqueued. Returns the order in which the
+// batches were processed, as a string of 'L's and 'H's.
+string ProcessingOrder(
+    const SharedBatchScheduler<FakeTask>::Options& options,
+    const SharedBatchScheduler<FakeTask>::QueueOptions& low_queue_options,
+    const SharedBatchScheduler<FakeTask>::QueueOptions& high_queue_options,
+    int num_low, int num_high) {
+  mutex mu;
+  string order;
+  Notification first_batch_scheduled, first_batch_proceed;
+  auto callback = [&](char name) {
+    return [&, name](std::unique_ptr<Batch<FakeTask>> batch) {
+      if (!first_batch_scheduled.HasBeenNotified()) {
+        first_batch_scheduled.Notify();
+        first_batch_proceed.WaitForNotification();
+      }
+      mutex_lock l(mu);
+      order.push_back(name);
+    };
+  };
+
+  std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+  TF_CHECK_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+  std::unique_ptr<BatchScheduler<FakeTask>> low_queue, high_queue;
+  TF_CHECK_OK(
+      scheduler->AddQueue(low_queue_options, callback('L'), &low_queue));
+  TF_CHECK_OK(
+      scheduler->AddQueue(high_queue_options, callback('H'), &high_queue));
+
+  TF_CHECK_OK(ScheduleTask(10, low_queue.get()));
+  first_batch_scheduled.WaitForNotification();
+  for (int i = 0; i < num_high; ++i) {
+    TF_CHECK_OK(ScheduleTask(10, high_queue.get()));
+  }
+  for (int i = 0; i < num_low; ++i) {
+    TF_CHECK_OK(ScheduleTask(10, low_queue.get()));
+  }
+  first_batch_proceed.Notify();
+  // Destroying the queues waits until all of their batches are processed.
+  low_queue.reset();
+  high_queue.reset();
+  mutex_lock l(mu);
+  return order;
+}
+
+TEST(SharedBatchSchedulerTest, Priorities) {
+  SharedBatchScheduler<FakeTask>::Options options;
+  options.num_batch_threads = 1;
+  options.max_priority_bypasses = 2;
+  SharedBatchScheduler<FakeTask>::QueueOptions low_queue_options;
+  low_queue_options.input_batch_size_limit = 10;
+  low_queue_options.max_enqueued_batches = 10;
+  SharedBatchScheduler<FakeTask>::QueueOptions high_queue_options =
+      low_queue_options;
+  high_queue_options.priority = 1;
+
+  // High priority batches go first, but the low priority queue is skipped at
+  // most twice in a row once it has a batch ready.
+  EXPECT_EQ("LHHHLHHLL",
+            ProcessingOrder(options, low_queue_options, high_queue_options,
+                            /*num_low=*/3, /*num_high=*/5));
+
+  options.max_priority_bypasses = 0;
+  EXPECT_EQ("LHLHL", ProcessingOrder(options, low_queue_options,
+                                     high_queue_options, 2, 2));
+}
+
+TEST(SharedBatchSchedulerTest, Weights) {
+  SharedBatchScheduler<FakeTask>::Options options;
+  options.num_batch_threads = 1;
+  SharedBatchScheduler<FakeTask>::QueueOptions low_queue_options;
+  low_queue_options.input_batch_size_limit = 10;
+  low_queue_options.max_enqueued_batches = 10;
+  SharedBatchScheduler<FakeTask>::QueueOptions high_queue_options =
+      low_queue_options;
+  high_queue_options.weight = 2;
+
+  EXPECT_EQ("LHHLHLL", ProcessingOrder(options, low_queue_options,
+                                       high_queue_options, 3, 3));
+
+  high_queue_options.weight = 0;
+  std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  EXPECT_EQ(error::INVALID_ARGUMENT,
+            scheduler->AddQueue(high_queue_options, callback, &queue).code());
+}
+
 TEST(SharedBatchSchedulerTest, ConstMethods) {
   for (const int max_enqueued_batches : {1, 2, 5}) {
     Notification processing, proceed;
@@ -72,14 +72,46 @@ void NcclReducer::Run(StatusCallback done) {
           group_size_status = s;
           copy_note->Notify();
         });
+  }
+
+  // If the values are cast for transfer, NCCL reduces the encoded values, so
+  // the reduction itself runs in the wire data type.
+  Tensor wire_tensor;
+  std::shared_ptr<CollectiveContext> nccl_ctx = col_ctx_;
+  if (col_params_->wire_encode_op) {
+    Status s;
+    if (col_params_->wire_encode_op->output_type(0) != DT_HALF) {
+      s = errors::Unimplemented(
+          "NCCL reductions only support float16 compression, got ",
+          DataTypeString(col_params_->wire_encode_op->output_type(0)));
+    } else {
+      s = collective_util::ComputeUnaryOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->wire_encode_op, const_cast<Tensor*>(col_ctx_->input),
+          &wire_tensor);
+    }
+    if (!s.ok()) {
+      if (group_size_ready) group_size_ready->WaitForNotification();
+      done(s);
+      return;
+    }
+    nccl_ctx = std::make_shared<CollectiveContext>(
+        col_ctx_->col_exec, col_ctx_->nccl_communicator, col_ctx_->dev_mgr,
+        col_ctx_->op_ctx, col_ctx_->op_params, col_params_, col_ctx_->exec_key,
+        col_ctx_->step_id, &wire_tensor, &wire_tensor);
+    nccl_ctx->device = col_ctx_->device;
+    nccl_ctx->device_locality = col_ctx_->device_locality;
+  }
+  if (col_params_->final_op || col_params_->wire_encode_op) {
     nccl_done = absl::make_unique<Notification>();
   }
 
   Status nccl_status;
-  // If no final_op, then the NCCL callback is just `done`.  Otherwise we notify
-  // `nccl_done` so that we can then perform `final_op`.
+  // If no final_op and no wire data type, then the NCCL callback is just
+  // `done`.  Otherwise we notify `nccl_done` so that we can then decode the
+  // result and perform `final_op`.
   StatusCallback done_callback;
-  if (col_params_->final_op) {
+  if (nccl_done) {
     Notification* nccl_note = nccl_done.get();
     done_callback = [nccl_note, &nccl_status](const Status& s) {
       nccl_status = s;
@@ -91,10 +123,10 @@ void NcclReducer::Run(StatusCallback done) {
   // Hold a ref to col_params for the rest of this function.
   col_params_->Ref();
   core::ScopedUnref unref(col_params_);
-  col_ctx_->nccl_communicator->Enqueue(col_ctx_, std::move(done_callback));
+  col_ctx_->nccl_communicator->Enqueue(nccl_ctx, std::move(done_callback));
 
-  // If no final_op, then this OpKernel is non-blocking.
-  if (!col_params_->final_op) {
+  // If no final_op and no wire data type, then this OpKernel is non-blocking.
+  if (!nccl_done) {
     return;
   }
 
@@ -107,13 +139,29 @@ void NcclReducer::Run(StatusCallback done) {
     profiler::TraceMe activity("Nccl", profiler::TraceMeLevel::kInfo);
     nccl_done->WaitForNotification();
   }
-  {
+  if (group_size_ready) {
     profiler::TraceMe activity("GroupSizeCopy", profiler::TraceMeLevel::kInfo);
     group_size_ready->WaitForNotification();
   }
   Status final_status =
       group_size_status.ok() ? nccl_status : group_size_status;
-  if (final_status.ok()) {
+  if (final_status.ok() && col_params_->wire_encode_op) {
+    Tensor decoded;
+    final_status = collective_util::ComputeUnaryOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->wire_decode_op, &wire_tensor, &decoded);
+    if (final_status.ok()) {
+      Notification copy_done;
+      col_ctx_->op_ctx->op_device_context()->CopyTensorInSameDevice(
+          &decoded, col_ctx_->device, col_ctx_->output,
+          [&copy_done, &final_status](const Status& s) {
+            final_status = s;
+            copy_done.Notify();
+          });
+      copy_done.WaitForNotification();
+    }
+  }
+  if (final_status.ok() && col_params_->final_op) {
     final_status = collective_util::ComputeBinOp(
         col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
         col_params_->final_op, col_ctx_->output, &group_size);
@@ -596,6 +596,24 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
     SetAttrValue(data_type_, &(*sub_node.mutable_attr())["T"]);
     merge_op_ = BuildOpKernel(c, merge_op_name, &sub_node);
     final_op_ = BuildOpKernel(c, final_op_name, &sub_node);
+    string compression = "none";
+    if (c->HasAttr("compression")) {
+      OP_REQUIRES_OK(c, c->GetAttr("compression", &compression));
+    }
+    if (compression != "none") {
+      DataType wire_type;
+      OP_REQUIRES(c, DataTypeFromString(compression, &wire_type),
+                  errors::InvalidArgument("Unknown compression ", compression));
+      if (wire_type != data_type_) {
+        OP_REQUIRES(c, data_type_ == DT_FLOAT || data_type_ == DT_DOUBLE,
+                    errors::InvalidArgument(
+                        "compression ", compression,
+                        " requires a float32 or float64 input, got ",
+                        DataTypeString(data_type_)));
+        wire_encode_op_ = BuildCastKernel(c, data_type_, wire_type);
+        wire_decode_op_ = BuildCastKernel(c, wire_type, data_type_);
+      }
+    }
     name_ = strings::StrCat(c->def().name(), ": ReduceV2(", merge_op_name, ",",
                             final_op_name, ")");
     VLOG(2) << "CollectiveReduceV2 " << this << " name " << name_
@@ -617,6 +635,8 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
     col_params->instance.shape = c->input(0).shape();
     col_params->merge_op = merge_op_.get();
     col_params->final_op = final_op_.get();
+    col_params->wire_encode_op = wire_encode_op_.get();
+    col_params->wire_decode_op = wire_decode_op_.get();
     VLOG(1) << "CollectiveReduceV2 group_size " << col_params->group.group_size
             << " group_key " << col_params->group.group_key << " instance_key "
             << col_params->instance.instance_key;
@@ -630,9 +650,38 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
   }
 
  private:
+  // Builds a Cast from `src_type` to `dst_type`, used to convert the values
+  // reduced by this op to and from the data type they are transferred in.
+  static std::unique_ptr<OpKernel> BuildCastKernel(OpKernelConstruction* c,
+                                                   DataType src_type,
+                                                   DataType dst_type) {
+    NodeDef cast_node;
+    cast_node.set_name(strings::StrCat(c->def().name(), "/Cast",
+                                       DataTypeString(dst_type)));
+    cast_node.set_op("Cast");
+    cast_node.add_input(c->def().input(0));
+    cast_node.set_device(c->def().device());
+    SetAttrValue(src_type, &(*cast_node.mutable_attr())["SrcT"]);
+    SetAttrValue(dst_type, &(*cast_node.mutable_attr())["DstT"]);
+    SetAttrValue(false, &(*cast_node.mutable_attr())["Truncate"]);
+    Status status;
+    std::unique_ptr<OpKernel> k = CreateOpKernel(
+        c->device_type(), c->device(),
+        c->device()->GetAllocator(AllocatorAttributes()), cast_node,
+        c->graph_def_version(), &status);
+    if (!status.ok()) {
+      c->CtxFailureWithWarning(errors::Internal(
+          "Failed to build Cast OpKernel from ", DataTypeString(src_type),
+          " to ", DataTypeString(dst_type), " : ", status.error_message()));
+    }
+    return k;
+  }
+
   int max_subdivs_per_device_;
   std::unique_ptr<OpKernel> merge_op_;
   std::unique_ptr<OpKernel> final_op_;
+  std::unique_ptr<OpKernel> wire_encode_op_;
+  std::unique_ptr<OpKernel> wire_decode_op_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("CollectiveReduceV2").Device(DEVICE_CPU),
@@ -39,6 +39,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/macros.h"
 
+#if defined(TENSORFLOW_USE_CUSTOM_CONTRACTION_KERNEL)
+#include "tensorflow/core/kernels/eigen_contraction_kernel.h"
+#endif
+
 namespace tensorflow {
 
 namespace {
@@ -81,6 +85,16 @@ ConstantOp::ConstantOp(OpKernelConstruction* ctx)
       errors::InvalidArgument("Type mismatch between value (",
                               DataTypeString(tensor_.dtype()), ") and dtype (",
                               DataTypeString(ctx->output_type(0)), ")"));
+#if defined(TENSORFLOW_USE_CUSTOM_CONTRACTION_KERNEL)
+  // Matrices and filters may be the weights of MatMul and Conv2D, let their
+  // contractions read them in place rather than pack them on every run.
+  if (ctx->device_type() == DEVICE_CPU && tensor_.dims() >= 2 &&
+      DataTypeCanUseMemcpy(tensor_.dtype())) {
+    Eigen::internal::RegisterConstantContractionInput(tensor_.data(),
+                                                      tensor_.TotalBytes());
+    registered_contraction_input_ = true;
+  }
+#endif
 }
 
 void ConstantOp::Compute(OpKernelContext* ctx) {
@@ -90,7 +104,13 @@ void ConstantOp::Compute(OpKernelContext* ctx) {
   }
 }
 
-ConstantOp::~ConstantOp() {}
+ConstantOp::~ConstantOp() {
+#if defined(TENSORFLOW_USE_CUSTOM_CONTRACTION_KERNEL)
+  if (registered_contraction_input_) {
+    Eigen::internal::UnregisterConstantContractionInput(tensor_.data());
+  }
+#endif
+}
 
 REGISTER_KERNEL_BUILDER(Name("Const").Device(DEVICE_CPU), ConstantOp);
 REGISTER_KERNEL_BUILDER(Name("Const").Device(DEVICE_TPU_SYSTEM), ConstantOp);
@@ -34,6 +34,9 @@ class ConstantOp : public OpKernel {
 
  private:
   Tensor tensor_;
+  // Whether `tensor_` is registered as a constant input of the Eigen
+  // contractions.
+  bool registered_contraction_input_ = false;
   TF_DISALLOW_COPY_AND_ASSIGN(ConstantOp);
 };
 
@@ -315,6 +315,8 @@ class FusedConvParameters : public ConvParameters {
     return absl::StrCat(ConvParameters::ToString(), ", ", activation_mode_);
   }
 
+  se::dnn::ActivationMode activation_mode() const { return activation_mode_; }
+
  private:
   friend bool operator==(const FusedConvParameters& lhs,
                          const FusedConvParameters& rhs);
@@ -387,8 +389,9 @@ Status FindBestConvolveAlgorithm(
              ->GetFusedConvolveExecutionPlans(
                  se::dnn::ConvolutionKind::FORWARD,
                  se::dnn::ToDataType<T>::value, conv_input_scale,
-                 side_input_scale, stream, input_desc, filter_desc, bias_desc,
-                 output_desc, conv_desc, &plans)
+                 side_input_scale, params.activation_mode(), stream,
+                 input_desc, filter_desc, bias_desc, output_desc, conv_desc,
+                 &plans)
              .ok()) {
       return errors::Unknown(
           "Failed to get convolution plans. This is probably because cuDNN "
@@ -14,9 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include <deque>
 #include <string>
 #include <utility>
 
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
@@ -25,6 +28,10 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
@@ -41,6 +48,8 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const CacheDatasetOp::kMemoryBudgetBytes;
+/* static */ constexpr const char* const CacheDatasetOp::kCompressInMemory;
 
 namespace {
 
@@ -59,6 +68,15 @@ constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
+constexpr char kHybridDatasetPrefix[] = "Hybrid";
+constexpr char kSpillFileSuffix[] = ".spill";
+// The number of spilled elements a `HybridReaderIterator` reads ahead of the
+// element it produces.
+constexpr size_t kSpillReadAheadElements = 32;
+constexpr char kSpillCheckpointErrorMessage[] =
+    "Checkpointing is not supported for a cache that spills to disk, i.e. a "
+    "cache with a filename and a non-negative memory budget, since the spill "
+    "file only lives as long as the dataset.";
 constexpr char kIncompleteCacheErrorMessage[] =
     "The calling iterator did not fully read the dataset being cached. In "
     "order to avoid unexpected truncation of the dataset, the partially cached "
@@ -66,6 +84,179 @@ constexpr char kIncompleteCacheErrorMessage[] =
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
 
+// A thread-safe data structure for caching dataset elements that keeps the
+// first elements in memory, up to a byte budget, and spills the remaining
+// elements to a file as they are added.
+//
+// Once an element has been spilled, all following elements are spilled too, so
+// the memory holds a prefix of the dataset and the spill file the rest of it,
+// as one record per serialized `CompressedElement`. The expected use is that a
+// single `HybridWriterIterator` populates the cache. Once all elements are
+// cached, the cache can be used by one or more `HybridReaderIterator`s.
+class SpillingCache {
+ public:
+  SpillingCache(Env* env, string spill_filename, int64 memory_budget_bytes,
+                bool compress_in_memory)
+      : env_(env),
+        spill_filename_(std::move(spill_filename)),
+        memory_budget_bytes_(memory_budget_bytes),
+        compress_in_memory_(compress_in_memory) {}
+
+  ~SpillingCache() { Reset(); }
+
+  // Claims the cache for the calling writer. Returns an error if another writer
+  // is populating the cache.
+  Status StartWriting() {
+    mutex_lock l(mu_);
+    if (writing_) {
+      return errors::FailedPrecondition(
+          "There appears to be a concurrent caching iterator running: another "
+          "iterator is already populating the cache spilled to ",
+          spill_filename_,
+          ". If you are creating more than one iterator over the cached "
+          "dataset, make sure the first one reaches the end of the dataset "
+          "before the others are created.");
+    }
+    writing_ = true;
+    return Status::OK();
+  }
+
+  // Adds `element` to the cache, and sets `*in_memory` to whether it was kept
+  // in memory.
+  Status Append(const std::vector<Tensor>& element, bool* in_memory) {
+    mutex_lock l(mu_);
+    DCHECK(writing_ && !completed_);
+    *in_memory = false;
+    CompressedElement compressed;
+    bool is_compressed = false;
+    if (spill_writer_ == nullptr) {
+      int64 bytes;
+      if (compress_in_memory_) {
+        TF_RETURN_IF_ERROR(CompressElement(element, &compressed));
+        is_compressed = true;
+        bytes = compressed.ByteSizeLong();
+      } else {
+        bytes = GetTotalBytes(element);
+      }
+      if (memory_bytes_ + bytes <= memory_budget_bytes_) {
+        memory_bytes_ += bytes;
+        if (compress_in_memory_) {
+          compressed_elements_.push_back(std::move(compressed));
+        } else {
+          elements_.push_back(element);
+        }
+        *in_memory = true;
+        return Status::OK();
+      }
+      VLOG(2) << "Spilling the cache to " << spill_filename_ << " after "
+              << num_in_memory_locked() << " elements (" << memory_bytes_
+              << " bytes) have been cached in memory.";
+      const string dir(io::Dirname(spill_filename_));
+      if (!dir.empty()) {
+        TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(dir));
+      }
+      TF_RETURN_IF_ERROR(env_->NewWritableFile(spill_filename_, &spill_file_));
+      spill_writer_ = absl::make_unique<io::RecordWriter>(spill_file_.get());
+    }
+    if (!is_compressed) {
+      TF_RETURN_IF_ERROR(CompressElement(element, &compressed));
+    }
+    TF_RETURN_IF_ERROR(
+        spill_writer_->WriteRecord(compressed.SerializeAsString()));
+    num_spilled_++;
+    return Status::OK();
+  }
+
+  // Closes the spill file and marks the cache as completed.
+  Status Complete() {
+    mutex_lock l(mu_);
+    if (completed_) return Status::OK();
+    if (spill_writer_ != nullptr) {
+      TF_RETURN_IF_ERROR(spill_writer_->Close());
+      TF_RETURN_IF_ERROR(spill_file_->Close());
+      spill_writer_.reset();
+      spill_file_.reset();
+    }
+    completed_ = true;
+    writing_ = false;
+    return Status::OK();
+  }
+
+  // Returns whether the cache is completed.
+  bool IsCompleted() {
+    tf_shared_lock l(mu_);
+    return completed_;
+  }
+
+  // Discards the cached elements and deletes the spill file.
+  void Reset() {
+    mutex_lock l(mu_);
+    spill_writer_.reset();
+    spill_file_.reset();
+    if (env_->FileExists(spill_filename_).ok()) {
+      Status s = env_->DeleteFile(spill_filename_);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to delete " << spill_filename_ << ": " << s;
+      }
+    }
+    elements_.clear();
+    compressed_elements_.clear();
+    memory_bytes_ = 0;
+    num_spilled_ = 0;
+    completed_ = false;
+    writing_ = false;
+  }
+
+  // Returns the number of elements kept in memory.
+  size_t num_in_memory() {
+    tf_shared_lock l(mu_);
+    return num_in_memory_locked();
+  }
+
+  // Returns the number of elements spilled to the spill file.
+  size_t num_spilled() {
+    tf_shared_lock l(mu_);
+    return num_spilled_;
+  }
+
+  // Stores the in-memory element at the given index in `out`.
+  Status GetInMemory(size_t index, std::vector<Tensor>* out) {
+    tf_shared_lock l(mu_);
+    DCHECK(index < num_in_memory_locked());
+    if (compress_in_memory_) {
+      return UncompressElement(compressed_elements_[index], out);
+    }
+    *out = elements_[index];
+    return Status::OK();
+  }
+
+  const string& spill_filename() const { return spill_filename_; }
+
+ private:
+  size_t num_in_memory_locked() TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return compress_in_memory_ ? compressed_elements_.size() : elements_.size();
+  }
+
+  Env* const env_;
+  const string spill_filename_;
+  const int64 memory_budget_bytes_;
+  const bool compress_in_memory_;
+
+  mutex mu_;
+  bool writing_ TF_GUARDED_BY(mu_) = false;
+  bool completed_ TF_GUARDED_BY(mu_) = false;
+  // The bytes of the elements kept in memory, after compression if
+  // `compress_in_memory_` is set.
+  int64 memory_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // Only one of them is used, depending on `compress_in_memory_`.
+  std::vector<std::vector<Tensor>> elements_ TF_GUARDED_BY(mu_);
+  std::vector<CompressedElement> compressed_elements_ TF_GUARDED_BY(mu_);
+  size_t num_spilled_ TF_GUARDED_BY(mu_) = 0;
+  // Set while the cache is being spilled.
+  std::unique_ptr<WritableFile> spill_file_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<io::RecordWriter> spill_writer_ TF_GUARDED_BY(mu_);
+};
+
 }  // namespace
 
 class CacheDatasetOp::FileDatasetBase : public DatasetBase {
@@ -1020,9 +1211,367 @@ class CacheDatasetOp::MemoryDatasetV2
   ResourceMgr* const resource_mgr_;  // Not owned.
 };
 
+// This version of the cache keeps the first elements of its input in memory,
+// up to a byte budget, and spills the others to a file as the input is read.
+// Once the cache is completed, its readers read the spilled elements back on a
+// background thread while they produce the in-memory elements. Like
+// `MemoryDataset`, it supports sharing of the cache across different
+// iterations of the `repeat` transformation but not across different
+// iterators.
+class CacheDatasetOp::HybridDataset : public DatasetBase {
+ public:
+  HybridDataset(OpKernelContext* ctx, const DatasetBase* input,
+                string filename, Env* env, int64 memory_budget_bytes,
+                bool compress_in_memory, const Tensor& resource_handle)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        filename_(std::move(filename)),
+        env_(env),
+        memory_budget_bytes_(memory_budget_bytes),
+        compress_in_memory_(compress_in_memory),
+        resource_handle_(resource_handle),
+        cache_(absl::make_unique<SpillingCache>(
+            env,
+            strings::StrCat(filename_, kSpillFileSuffix, "_", random::New64()),
+            memory_budget_bytes, compress_in_memory)) {
+    input_->Ref();
+  }
+
+  ~HybridDataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    name_utils::IteratorPrefixParams params;
+    params.dataset_prefix = kHybridDatasetPrefix;
+    return absl::make_unique<HybridIterator>(HybridIterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix, params)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.dataset_prefix = kHybridDatasetPrefix;
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64 Cardinality() const override { return input_->Cardinality(); }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
+    Node* filename_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
+    Node* resource_handle_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddTensor(resource_handle_, &resource_handle_node));
+    AttrValue memory_budget_bytes;
+    b->BuildAttrValue(memory_budget_bytes_, &memory_budget_bytes);
+    AttrValue compress_in_memory;
+    b->BuildAttrValue(compress_in_memory_, &compress_in_memory);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_node, filename_node, resource_handle_node},
+        {{kMemoryBudgetBytes, memory_budget_bytes},
+         {kCompressInMemory, compress_in_memory}},
+        output));
+    return Status::OK();
+  }
+
+ private:
+  class HybridIterator : public DatasetIterator<HybridDataset> {
+   public:
+    explicit HybridIterator(const Params& params)
+        : DatasetIterator<HybridDataset>(params) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      if (dataset()->cache_->IsCompleted()) {
+        iterator_ = absl::make_unique<HybridReaderIterator>(
+            HybridReaderIterator::Params{dataset(),
+                                         strings::StrCat(prefix(), kImpl)});
+      } else {
+        iterator_ = absl::make_unique<HybridWriterIterator>(
+            HybridWriterIterator::Params{dataset(),
+                                         strings::StrCat(prefix(), kImpl)});
+      }
+      TF_RETURN_IF_ERROR(iterator_->InitializeBase(ctx, this));
+      return iterator_->Initialize(ctx);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      return iterator_->GetNext(ctx, out_tensors, end_of_sequence);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      return errors::Unimplemented(kSpillCheckpointErrorMessage);
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      return errors::Unimplemented(kSpillCheckpointErrorMessage);
+    }
+
+   private:
+    class HybridWriterIterator : public DatasetIterator<HybridDataset> {
+     public:
+      explicit HybridWriterIterator(const Params& params)
+          : DatasetIterator<HybridDataset>(params) {}
+
+      ~HybridWriterIterator() override {
+        mutex_lock l(mu_);
+        if (writing_ && !cache()->IsCompleted()) {
+          LOG(WARNING) << kIncompleteCacheErrorMessage;
+          cache()->Reset();
+        }
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(cache()->StartWriting());
+        writing_ = true;
+        return dataset()->input_->MakeIterator(ctx, this, prefix(),
+                                               &input_impl_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+        if (*end_of_sequence) {
+          if (!cache()->IsCompleted()) {
+            VLOG(2) << "Finalizing the cache because EOF has been reached.";
+            TF_RETURN_IF_ERROR(cache()->Complete());
+          }
+          return Status::OK();
+        }
+        bool in_memory;
+        TF_RETURN_IF_ERROR(cache()->Append(*out_tensors, &in_memory));
+        if (in_memory) {
+          RecordBufferEnqueue(ctx, *out_tensors);
+        }
+        num_elements_++;
+        if (num_elements_ == dataset()->input_->Cardinality()) {
+          VLOG(2) << "Finalizing the cache because its size matches the "
+                     "expected input cardinality.";
+          TF_RETURN_IF_ERROR(cache()->Complete());
+        }
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        return errors::Unimplemented(kSpillCheckpointErrorMessage);
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented(kSpillCheckpointErrorMessage);
+      }
+
+     private:
+      SpillingCache* cache() const { return dataset()->cache_.get(); }
+
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+      // Whether this iterator has claimed the cache.
+      bool writing_ TF_GUARDED_BY(mu_) = false;
+      int64 num_elements_ TF_GUARDED_BY(mu_) = 0;
+    };  // HybridWriterIterator
+
+    class HybridReaderIterator : public DatasetIterator<HybridDataset> {
+     public:
+      explicit HybridReaderIterator(const Params& params)
+          : DatasetIterator<HybridDataset>(params) {}
+
+      ~HybridReaderIterator() override {
+        std::unique_ptr<Thread> spill_thread;
+        {
+          mutex_lock l(mu_);
+          cancelled_ = true;
+          cond_var_.notify_all();
+          spill_thread = std::move(spill_thread_);
+        }
+        // Joins the thread.
+        spill_thread.reset();
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        if (cache()->num_spilled() > 0) {
+          // Reads the spill file while the in-memory elements are produced.
+          spill_thread_ = ctx->StartThread(
+              "tf_data_cache_spill_reader", [this]() { ReadSpillFile(); });
+        }
+        return Status::OK();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (index_ < cache()->num_in_memory()) {
+          TF_RETURN_IF_ERROR(cache()->GetInMemory(index_, out_tensors));
+          index_++;
+          *end_of_sequence = false;
+          return Status::OK();
+        }
+        if (index_ >= cache()->num_in_memory() + cache()->num_spilled()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        while (read_ahead_.empty() && spill_status_.ok() && !end_of_spill_) {
+          cond_var_.wait(l);
+        }
+        TF_RETURN_IF_ERROR(spill_status_);
+        if (read_ahead_.empty()) {
+          return errors::DataLoss("The cache spill file ",
+                                  cache()->spill_filename(),
+                                  " has fewer elements than expected.");
+        }
+        *out_tensors = std::move(read_ahead_.front());
+        read_ahead_.pop_front();
+        cond_var_.notify_all();
+        index_++;
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        return errors::Unimplemented(kSpillCheckpointErrorMessage);
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented(kSpillCheckpointErrorMessage);
+      }
+
+     private:
+      SpillingCache* cache() const { return dataset()->cache_.get(); }
+
+      // Reads the spilled elements into `read_ahead_` until the end of the
+      // spill file or until the iterator is destroyed.
+      void ReadSpillFile() {
+        std::unique_ptr<RandomAccessFile> file;
+        Status s = dataset()->env_->NewRandomAccessFile(
+            cache()->spill_filename(), &file);
+        std::unique_ptr<io::SequentialRecordReader> reader;
+        if (s.ok()) {
+          reader = absl::make_unique<io::SequentialRecordReader>(file.get());
+        }
+        while (s.ok()) {
+          {
+            mutex_lock l(mu_);
+            while (!cancelled_ &&
+                   read_ahead_.size() >= kSpillReadAheadElements) {
+              cond_var_.wait(l);
+            }
+            if (cancelled_) return;
+          }
+          tstring record;
+          s = reader->ReadRecord(&record);
+          if (errors::IsOutOfRange(s)) {
+            s = Status::OK();
+            break;
+          }
+          if (!s.ok()) break;
+          CompressedElement compressed;
+          if (!compressed.ParseFromArray(record.data(), record.size())) {
+            s = errors::DataLoss("Failed to parse an element of the cache "
+                                 "spill file ",
+                                 cache()->spill_filename());
+            break;
+          }
+          std::vector<Tensor> element;
+          s = UncompressElement(compressed, &element);
+          if (!s.ok()) break;
+          mutex_lock l(mu_);
+          read_ahead_.push_back(std::move(element));
+          cond_var_.notify_all();
+        }
+        mutex_lock l(mu_);
+        spill_status_ = s;
+        end_of_spill_ = true;
+        cond_var_.notify_all();
+      }
+
+      mutex mu_;
+      condition_variable cond_var_;
+      // The index of the next element to produce.
+      size_t index_ TF_GUARDED_BY(mu_) = 0;
+      std::deque<std::vector<Tensor>> read_ahead_ TF_GUARDED_BY(mu_);
+      Status spill_status_ TF_GUARDED_BY(mu_);
+      bool end_of_spill_ TF_GUARDED_BY(mu_) = false;
+      bool cancelled_ TF_GUARDED_BY(mu_) = false;
+      std::unique_ptr<Thread> spill_thread_ TF_GUARDED_BY(mu_);
+    };  // HybridReaderIterator
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> iterator_ TF_GUARDED_BY(mu_);
+  };  // HybridIterator
+
+  const DatasetBase* const input_;
+  const tstring filename_;
+  Env* const env_;
+  const int64 memory_budget_bytes_;
+  const bool compress_in_memory_;
+  const Tensor resource_handle_;
+  const std::unique_ptr<SpillingCache> cache_;
+};  // HybridDataset
+
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {
+  if (op_version_ == 2) {
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr(kMemoryBudgetBytes, &memory_budget_bytes_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompressInMemory, &compress_in_memory_));
+  }
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
@@ -1070,7 +1619,11 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       *output = new MemoryDataset(ctx, input, manager, std::move(handle));
     }
   } else {
-    if (op_version_ == 2) {
+    if (op_version_ == 2 && memory_budget_bytes_ >= 0) {
+      *output = new HybridDataset(ctx, input, filename, ctx->env(),
+                                  memory_budget_bytes_, compress_in_memory_,
+                                  ctx->input(2));
+    } else if (op_version_ == 2) {
       *output =
           new FileDatasetV2(ctx, input, filename, ctx->env(), ctx->input(2));
     } else {
@@ -30,6 +30,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kFileName = "filename";
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kMemoryBudgetBytes =
+      "memory_budget_bytes";
+  static constexpr const char* const kCompressInMemory = "compress_in_memory";
 
   explicit CacheDatasetOp(OpKernelConstruction* ctx);
 
@@ -40,10 +43,16 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
  private:
   class FileDataset;
   class FileDatasetV2;
+  class HybridDataset;
   class MemoryDataset;
   class MemoryDatasetV2;
 
   const int op_version_;
+  // Only set for `CacheDatasetV2`. A cache with a filename keeps up to
+  // `memory_budget_bytes_` of elements in memory and spills the rest to the
+  // file, unless the budget is negative.
+  int64 memory_budget_bytes_ = -1;
+  bool compress_in_memory_ = false;
 };
 
 }  // namespace data
@@ -12,6 +12,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
 #include <string>
+#include <tuple>
 #include <utility>
 
 #include "tensorflow/core/data/dataset_test_base.h"
@@ -68,6 +69,51 @@ class CacheDatasetParams : public DatasetParams {
   string filename_;
 };
 
+// Parameters of a `CacheDatasetV2` that keeps up to `memory_budget_bytes` of
+// elements in memory and spills the others to a file prefixed with
+// `filename`.
+class HybridCacheDatasetParams : public CacheDatasetParams {
+ public:
+  template <typename T>
+  HybridCacheDatasetParams(T input_dataset_params, string filename,
+                           int64 memory_budget_bytes, bool compress_in_memory,
+                           DataTypeVector output_dtypes,
+                           std::vector<PartialTensorShape> output_shapes,
+                           string node_name)
+      : CacheDatasetParams(std::move(input_dataset_params), std::move(filename),
+                           std::move(output_dtypes), std::move(output_shapes),
+                           std::move(node_name)),
+        memory_budget_bytes_(memory_budget_bytes),
+        compress_in_memory_(compress_in_memory) {
+    op_version_ = 2;
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors = CacheDatasetParams::GetInputTensors();
+    // A cache with a filename doesn't use the memory cache resource.
+    input_tensors.emplace_back(DT_RESOURCE, TensorShape({}));
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {CacheDatasetOp::kInputDataset, CacheDatasetOp::kFileName,
+                    "cache"};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{CacheDatasetOp::kOutputTypes, output_dtypes_},
+                    {CacheDatasetOp::kOutputShapes, output_shapes_},
+                    {CacheDatasetOp::kMemoryBudgetBytes, memory_budget_bytes_},
+                    {CacheDatasetOp::kCompressInMemory, compress_in_memory_}};
+    return Status::OK();
+  }
+
+ private:
+  int64 memory_budget_bytes_;
+  bool compress_in_memory_;
+};
+
 class CacheDatasetOpTest : public DatasetOpsTestBase {
  public:
   Status Initialize(const DatasetParams& dataset_params) {
@@ -369,6 +415,75 @@ INSTANTIATE_TEST_CASE_P(CacheDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+// Caches 10 scalars, of which at most `memory_budget_bytes` are kept in
+// memory.
+HybridCacheDatasetParams HybridCacheParams(int64 memory_budget_bytes,
+                                           bool compress_in_memory) {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{10},
+                                          {0, 1, 2, 3, 4, 5, 6, 7, 8, 9})},
+      /*node_name=*/"tensor_slice");
+  return HybridCacheDatasetParams(
+      std::move(tensor_slice_dataset_params),
+      /*filename=*/io::JoinPath(testing::TmpDir(), "hybrid_cache_data"),
+      memory_budget_bytes, compress_in_memory,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})}, kNodeName);
+}
+
+class ParameterizedHybridCacheTest
+    : public CacheDatasetOpTest,
+      public ::testing::WithParamInterface<std::tuple<int64, bool>> {};
+
+TEST_P(ParameterizedHybridCacheTest, ReadsBothTiers) {
+  const int64 memory_budget_bytes = std::get<0>(GetParam());
+  const bool compress_in_memory = std::get<1>(GetParam());
+  TF_ASSERT_OK(Initialize(
+      HybridCacheParams(memory_budget_bytes, compress_in_memory)));
+  const std::vector<Tensor> expected_outputs = CreateTensors<int64>(
+      TensorShape({}), {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}});
+
+  // Test the write mode.
+  TF_ASSERT_OK(CheckIteratorGetNext(expected_outputs, /*compare_order=*/true));
+  std::vector<string> spill_files;
+  TF_ASSERT_OK(device_->env()->GetMatchingPaths(
+      strings::StrCat(cache_filename_, ".spill*"), &spill_files));
+  // Each element takes 8 bytes uncompressed, and more when compressed.
+  EXPECT_EQ(memory_budget_bytes < 80 ? 1 : 0, spill_files.size());
+
+  // Test the read mode, twice.
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                        "Iterator", &iterator_));
+    TF_ASSERT_OK(
+        CheckIteratorGetNext(expected_outputs, /*compare_order=*/true));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    CacheDatasetOpTest, ParameterizedHybridCacheTest,
+    ::testing::Combine(::testing::Values(0, 24, 1 << 20),
+                       ::testing::Bool()));
+
+TEST_F(CacheDatasetOpTest, HybridCacheHasSingleWriter) {
+  TF_ASSERT_OK(Initialize(HybridCacheParams(
+      /*memory_budget_bytes=*/24, /*compress_in_memory=*/false)));
+  std::unique_ptr<IteratorBase> second_iterator;
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                             "Iterator", &second_iterator)));
+}
+
+TEST_F(CacheDatasetOpTest, HybridCacheDoesNotSupportCheckpointing) {
+  TF_ASSERT_OK(Initialize(HybridCacheParams(
+      /*memory_budget_bytes=*/24, /*compress_in_memory=*/false)));
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+  VariantTensorDataWriter writer;
+  EXPECT_TRUE(errors::IsUnimplemented(
+      iterator_->Save(serialization_ctx.get(), &writer)));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -26,6 +26,10 @@ class CompressElementOp : public OpKernel {
   explicit CompressElementOp(OpKernelConstruction* ctx);
 
   void Compute(OpKernelContext* ctx) override;
+
+ private:
+  // Either "SNAPPY" (the default) or "ZSTD".
+  std::string compression_type_;
 };
 
 class UncompressElementOp : public OpKernel {
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/experimental/data_service_dataset_op.h"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <map>
 #include <memory>
@@ -406,6 +408,17 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       bool in_use TF_GUARDED_BY(&Iterator::mu_) = false;
       // Indicates whether the worker has returned end_of_sequence for the task.
       bool end_of_sequence TF_GUARDED_BY(&Iterator::mu_) = false;
+      // The total latency and number of the element requests to the task since
+      // the last heartbeat, reported to the dispatcher.
+      int64 read_latency_us TF_GUARDED_BY(&Iterator::mu_) = 0;
+      int64 num_reads TF_GUARDED_BY(&Iterator::mu_) = 0;
+      // The dispatcher's hints about the read latency of the task.
+      double relative_latency TF_GUARDED_BY(&Iterator::mu_) = 1.0;
+      bool straggler TF_GUARDED_BY(&Iterator::mu_) = false;
+      // How many more times to pass over the task when searching for a task
+      // to process. Slower tasks are passed over more often, so that
+      // independent reads favor fast tasks.
+      int64 visits_to_skip TF_GUARDED_BY(&Iterator::mu_) = 0;
     };
 
     struct Result {
@@ -558,12 +571,15 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     void Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
       ClientHeartbeatRequest req;
       req.set_job_client_id(job_client_id_);
-      if (StrictRoundRobin()) {
+      {
         mutex_lock l(mu_);
-        req.set_current_round(current_round_);
-        if (round_robin_round_limit_.has_value()) {
-          req.set_blocked_round(round_robin_round_limit_.value());
+        if (StrictRoundRobin()) {
+          req.set_current_round(current_round_);
+          if (round_robin_round_limit_.has_value()) {
+            req.set_blocked_round(round_robin_round_limit_.value());
+          }
         }
+        AddTaskLatencies(req);
       }
       ClientHeartbeatResponse resp;
       Status s = dispatcher_->ClientHeartbeat(req, resp);
@@ -591,6 +607,46 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         worker_thread_cv_.notify_all();
       }
       UpdateTasks(resp);
+      UpdateTaskReadHints(resp);
+    }
+
+    // Reports the latencies of the element requests since the last heartbeat.
+    void AddTaskLatencies(ClientHeartbeatRequest& req)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (const auto& task : tasks_) {
+        if (task->num_reads == 0) {
+          continue;
+        }
+        TaskReadLatency* latency = req.add_task_latencies();
+        latency->set_task_id(task->info.task_id());
+        latency->set_mean_latency_us(task->read_latency_us / task->num_reads);
+        latency->set_num_reads(task->num_reads);
+        task->read_latency_us = 0;
+        task->num_reads = 0;
+      }
+    }
+
+    void UpdateTaskReadHints(const ClientHeartbeatResponse& resp)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      absl::flat_hash_map<int64, const TaskReadHint*> hints;
+      for (const auto& hint : resp.task_read_hints()) {
+        hints[hint.task_id()] = &hint;
+      }
+      for (auto& task : tasks_) {
+        auto it = hints.find(task->info.task_id());
+        if (it == hints.end()) {
+          task->relative_latency = 1.0;
+          task->straggler = false;
+          continue;
+        }
+        if (it->second->straggler() && !task->straggler) {
+          VLOG(1) << "Worker " << task->info.worker_address()
+                  << " is straggling, with " << it->second->relative_latency()
+                  << "x the median latency";
+        }
+        task->relative_latency = it->second->relative_latency();
+        task->straggler = it->second->straggler();
+      }
     }
 
     void UpdateTasks(const ClientHeartbeatResponse& resp)
@@ -685,6 +741,9 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     // Searches for a task to process, returning nullptr if none is found.
     std::shared_ptr<Task> GetTaskToProcess() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       VLOG(4) << "Searching for task to process";
+      // The first slow task passed over, which is processed if there is no
+      // other task to process.
+      std::shared_ptr<Task> skipped_task;
       for (int i = 0; i < tasks_.size(); ++i) {
         std::shared_ptr<Task>& task = tasks_[next_task_index_];
         if (StrictRoundRobin() &&
@@ -708,13 +767,38 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
           AdvanceTaskIndex();
           continue;
         }
-        task->round = current_round_;
+        if (!StrictRoundRobin() && task->visits_to_skip > 0) {
+          VLOG(3) << "Passing over slow task " << next_task_index_
+                  << ". relative latency: " << task->relative_latency;
+          task->visits_to_skip--;
+          if (!skipped_task) {
+            skipped_task = task;
+          }
+          AdvanceTaskIndex();
+          continue;
+        }
+        std::shared_ptr<Task> result = StartProcessingTask(task);
         AdvanceTaskIndex();
-        return task;
+        return result;
+      }
+      if (skipped_task) {
+        return StartProcessingTask(std::move(skipped_task));
       }
       return nullptr;
     }
 
+    std::shared_ptr<Task> StartProcessingTask(std::shared_ptr<Task> task)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      task->round = current_round_;
+      if (!StrictRoundRobin()) {
+        // A task that is `n` times slower than the median is read from
+        // roughly `n` times less often.
+        task->visits_to_skip =
+            std::max<int64>(std::lround(task->relative_latency) - 1, 0);
+      }
+      return task;
+    }
+
     void RunWorkerThread(std::function<void()> done) {
       auto cleanup = gtl::MakeCleanup([done = std::move(done)]() {
         done();
@@ -791,18 +875,23 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         req.set_consumer_index(dataset()->consumer_index_.value());
         req.set_round_index(task.round);
         req.set_allow_skip(true);
+        mutex_lock l(mu_);
+        req.set_straggler(task.straggler);
       }
       return task.worker->GetElement(req, result);
     }
 
     void ProcessGetElementResponse(bool enqueue_result,
                                    GetElementResult& get_element_result,
-                                   Result& result, Task& task) {
+                                   int64 latency_us, Result& result,
+                                   Task& task) {
       mutex_lock l(mu_);
       result.ready = true;
       result.end_of_sequence = get_element_result.end_of_sequence;
       result.skip = get_element_result.skip;
       if (!get_element_result.end_of_sequence && !get_element_result.skip) {
+        task.read_latency_us += latency_us;
+        task.num_reads++;
         task.skipped_previous_round = false;
         result.element = std::move(get_element_result.components);
         result.element_index = get_element_result.element_index;
@@ -827,7 +916,8 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
           "GetDataServiceElement", tensorflow::profiler::TraceMeLevel::kInfo);
       activity.AppendMetadata([&]() {
         return profiler::TraceMeEncode(
-            {{"address", task->info.worker_address()}});
+            {{"address", task->info.worker_address()},
+             {"task_id", task->info.task_id()}});
       });
       if (StrictRoundRobin()) {
         VLOG(3) << "Requesting element from consumer index "
@@ -878,8 +968,11 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     Status GetElement(Task* task, int64 deadline_micros, bool enqueue_result,
                       Result& result) TF_LOCKS_EXCLUDED(mu_) {
       GetElementResult get_element_result;
+      int64 latency_us;
       for (int num_retries = 0;; ++num_retries) {
+        const int64 start_micros = Env::Default()->NowMicros();
         Status s = TryGetElement(*task, get_element_result);
+        latency_us = Env::Default()->NowMicros() - start_micros;
         if (s.ok()) break;
         // Retry all errors that could indicate preemption.
         if (!errors::IsUnavailable(s) && !errors::IsCancelled(s) &&
@@ -912,8 +1005,8 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
                 << " microseconds";
         Env::Default()->SleepForMicroseconds(backoff_until - now_micros);
       }
-      ProcessGetElementResponse(enqueue_result, get_element_result, result,
-                                *task);
+      ProcessGetElementResponse(enqueue_result, get_element_result, latency_us,
+                                result, *task);
       return Status::OK();
     }
 
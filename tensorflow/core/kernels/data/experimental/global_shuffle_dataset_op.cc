@@ -0,0 +1,266 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include <atomic>
+
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/hash.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in global_shuffle_dataset_op.h and used both here and in
+// test cases.
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kDatasetType;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kInputDataset;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed2;
+/* static */ constexpr const char* const
+    GlobalShuffleDatasetOp::kReshuffleEachIteration;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kIndex[] = "index";
+constexpr char kKey[] = "key";
+constexpr int kNumFeistelRounds = 6;
+
+// A pseudo-random permutation of `[0, size)` keyed by `key`, which maps an
+// index to its position in constant time and memory.
+//
+// The permutation is a balanced Feistel network over the smallest domain of
+// `4^k >= size` indices. Indices mapped outside of `[0, size)` are mapped
+// again ("cycle walking") until they fall in it, which takes at most four
+// passes through the network on average since the domain is at most four
+// times `size`.
+class IndexPermutation {
+ public:
+  IndexPermutation(int64 size, uint64 key) : size_(size), key_(key) {
+    while ((int64{1} << (2 * half_bits_)) < size_) {
+      ++half_bits_;
+    }
+  }
+
+  int64 operator()(int64 index) const {
+    DCHECK(index >= 0 && index < size_);
+    uint64 x = index;
+    do {
+      x = Encrypt(x);
+    } while (x >= static_cast<uint64>(size_));
+    return x;
+  }
+
+ private:
+  uint64 Encrypt(uint64 x) const {
+    const uint64 mask = (uint64{1} << half_bits_) - 1;
+    uint64 left = x >> half_bits_;
+    uint64 right = x & mask;
+    for (int round = 0; round < kNumFeistelRounds; ++round) {
+      const uint64 next =
+          left ^ (Mix(right ^ Hash64Combine(key_, round)) & mask);
+      left = right;
+      right = next;
+    }
+    return (left << half_bits_) | right;
+  }
+
+  // The finalizer of SplitMix64.
+  static uint64 Mix(uint64 x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  int64 size_;
+  uint64 key_;
+  int half_bits_ = 1;
+};
+
+}  // namespace
+
+class GlobalShuffleDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 seed,
+          int64 seed2, bool reshuffle_each_iteration)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        input_seeds_(seed, seed2),
+        seeds_(MaybeOverrideSeeds(input_seeds_)),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64 Cardinality() const override { return input_->Cardinality(); }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* seed = nullptr;
+    Node* seed2 = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(input_seeds_.first, &seed));
+    TF_RETURN_IF_ERROR(b->AddScalar(input_seeds_.second, &seed2));
+    AttrValue reshuffle_each_iteration;
+    b->BuildAttrValue(reshuffle_each_iteration_, &reshuffle_each_iteration);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_graph_node, seed, seed2},
+        {{kReshuffleEachIteration, reshuffle_each_iteration}}, output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          key_(dataset()->NextEpochKey()),
+          permutation_(dataset()->Cardinality(), key_) {}
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      int64 index;
+      {
+        mutex_lock l(mu_);
+        if (index_ >= dataset()->Cardinality()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        index = permutation_(index_++);
+      }
+      *end_of_sequence = false;
+      return dataset()->input_->Get(ctx, index, out_tensors);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kIndex), index_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kKey), static_cast<int64>(key_)));
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kIndex), &index_));
+      int64 key;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kKey), &key));
+      key_ = static_cast<uint64>(key);
+      permutation_ = IndexPermutation(dataset()->Cardinality(), key_);
+      return Status::OK();
+    }
+
+   private:
+    mutex mu_;
+    // The key of the permutation of the current epoch.
+    uint64 key_ TF_GUARDED_BY(mu_);
+    IndexPermutation permutation_ TF_GUARDED_BY(mu_);
+    // The position in the permutation of the next element to produce.
+    int64 index_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  // Returns the key of the permutation for a new iterator. Each iterator over
+  // the dataset, e.g. each epoch of a `repeat`, gets a different permutation
+  // if `reshuffle_each_iteration_` is set.
+  uint64 NextEpochKey() const {
+    const int64 epoch = reshuffle_each_iteration_ ? epoch_.fetch_add(1) : 0;
+    return Hash64Combine(Hash64Combine(seeds_.first, seeds_.second), epoch);
+  }
+
+  const DatasetBase* const input_;
+  const std::pair<int64, int64> input_seeds_;
+  const std::pair<int64, int64> seeds_;
+  const bool reshuffle_each_iteration_;
+  mutable std::atomic<int64> epoch_{0};
+};
+
+GlobalShuffleDatasetOp::GlobalShuffleDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kReshuffleEachIteration,
+                                   &reshuffle_each_iteration_));
+}
+
+void GlobalShuffleDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                         DatasetBase* input,
+                                         DatasetBase** output) {
+  int64 seed;
+  int64 seed2;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kSeed, &seed));
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kSeed2, &seed2));
+  OP_REQUIRES_OK(ctx, input->RandomIndexingCompatible());
+  OP_REQUIRES(ctx, input->Cardinality() >= 0,
+              errors::InvalidArgument(
+                  "Global shuffling requires an input dataset of known, finite "
+                  "cardinality, but the cardinality of ",
+                  input->DebugString(), " is ", input->Cardinality(), "."));
+
+  *output = new Dataset(ctx, input, seed, seed2, reshuffle_each_iteration_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("GlobalShuffleDataset").Device(DEVICE_CPU),
+                        GlobalShuffleDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
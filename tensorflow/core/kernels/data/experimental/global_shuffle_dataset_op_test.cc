@@ -0,0 +1,208 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "global_shuffle_dataset";
+constexpr int64 kRandomSeed = 42;
+constexpr int64 kRandomSeed2 = 7;
+
+class GlobalShuffleDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  GlobalShuffleDatasetParams(T input_dataset_params,
+                             bool reshuffle_each_iteration,
+                             DataTypeVector output_dtypes,
+                             std::vector<PartialTensorShape> output_shapes,
+                             string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    Tensor seed_tensor = CreateTensor<int64>(TensorShape({}), {kRandomSeed});
+    Tensor seed2_tensor = CreateTensor<int64>(TensorShape({}), {kRandomSeed2});
+    return {seed_tensor, seed2_tensor};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {GlobalShuffleDatasetOp::kInputDataset,
+                    GlobalShuffleDatasetOp::kSeed,
+                    GlobalShuffleDatasetOp::kSeed2};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{GlobalShuffleDatasetOp::kReshuffleEachIteration,
+                     reshuffle_each_iteration_},
+                    {GlobalShuffleDatasetOp::kOutputTypes, output_dtypes_},
+                    {GlobalShuffleDatasetOp::kOutputShapes, output_shapes_}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return GlobalShuffleDatasetOp::kDatasetType;
+  }
+
+ private:
+  bool reshuffle_each_iteration_;
+};
+
+class GlobalShuffleDatasetOpTest : public DatasetOpsTestBase {
+ protected:
+  // Returns the elements produced by a new iterator over `dataset_`.
+  Status GetAllElements(std::vector<Tensor>* elements) {
+    std::unique_ptr<IteratorBase> iterator;
+    TF_RETURN_IF_ERROR(dataset_->MakeIterator(
+        iterator_ctx_.get(), /*parent=*/nullptr, "Iterator", &iterator));
+    bool end_of_sequence = false;
+    while (!end_of_sequence) {
+      std::vector<Tensor> next;
+      TF_RETURN_IF_ERROR(
+          iterator->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      elements->insert(elements->end(), next.begin(), next.end());
+    }
+    return Status::OK();
+  }
+};
+
+GlobalShuffleDatasetParams RangeShuffleParams(int64 stop,
+                                              bool reshuffle_each_iteration) {
+  return GlobalShuffleDatasetParams(RangeDatasetParams(0, stop, 1),
+                                    reshuffle_each_iteration,
+                                    /*output_dtypes=*/{DT_INT64},
+                                    /*output_shapes=*/{PartialTensorShape({})},
+                                    /*node_name=*/kNodeName);
+}
+
+GlobalShuffleDatasetParams TensorSliceShuffleParams() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64>(TensorShape{5, 2},
+                                          {0, 1, 2, 3, 4, 5, 6, 7, 8, 9})},
+      /*node_name=*/"tensor_slice");
+  return GlobalShuffleDatasetParams(std::move(tensor_slice_dataset_params),
+                                    /*reshuffle_each_iteration=*/true,
+                                    /*output_dtypes=*/{DT_INT64},
+                                    /*output_shapes=*/
+                                    {PartialTensorShape({2})},
+                                    /*node_name=*/kNodeName);
+}
+
+std::vector<Tensor> RangeOutputs(int64 stop) {
+  std::vector<Tensor> outputs;
+  for (int64 i = 0; i < stop; ++i) {
+    outputs.push_back(CreateTensor<int64>(TensorShape({}), {i}));
+  }
+  return outputs;
+}
+
+std::vector<GetNextTestCase<GlobalShuffleDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/RangeShuffleParams(
+               /*stop=*/0, /*reshuffle_each_iteration=*/true),
+           /*expected_outputs=*/{}, /*compare_order=*/false},
+          {/*dataset_params=*/RangeShuffleParams(
+               /*stop=*/1, /*reshuffle_each_iteration=*/true),
+           /*expected_outputs=*/RangeOutputs(1), /*compare_order=*/false},
+          {/*dataset_params=*/RangeShuffleParams(
+               /*stop=*/100, /*reshuffle_each_iteration=*/true),
+           /*expected_outputs=*/RangeOutputs(100), /*compare_order=*/false},
+          {/*dataset_params=*/TensorSliceShuffleParams(),
+           /*expected_outputs=*/
+           CreateTensors<int64>(TensorShape({2}),
+                                {{0, 1}, {2, 3}, {4, 5}, {6, 7}, {8, 9}}),
+           /*compare_order=*/false}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(GlobalShuffleDatasetOpTest, GlobalShuffleDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(GlobalShuffleDatasetOpTest, ShufflesGlobally) {
+  TF_ASSERT_OK(Initialize(
+      RangeShuffleParams(/*stop=*/100, /*reshuffle_each_iteration=*/true)));
+  std::vector<Tensor> elements;
+  TF_ASSERT_OK(GetAllElements(&elements));
+  EXPECT_FALSE(
+      ExpectEqual(elements, RangeOutputs(100), /*compare_order=*/true).ok());
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, ReshufflesEachIteration) {
+  TF_ASSERT_OK(Initialize(
+      RangeShuffleParams(/*stop=*/100, /*reshuffle_each_iteration=*/true)));
+  std::vector<Tensor> first_epoch;
+  TF_ASSERT_OK(GetAllElements(&first_epoch));
+  std::vector<Tensor> second_epoch;
+  TF_ASSERT_OK(GetAllElements(&second_epoch));
+  EXPECT_FALSE(
+      ExpectEqual(first_epoch, second_epoch, /*compare_order=*/true).ok());
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, KeepsPermutationAcrossIterations) {
+  TF_ASSERT_OK(Initialize(
+      RangeShuffleParams(/*stop=*/100, /*reshuffle_each_iteration=*/false)));
+  std::vector<Tensor> first_epoch;
+  TF_ASSERT_OK(GetAllElements(&first_epoch));
+  std::vector<Tensor> second_epoch;
+  TF_ASSERT_OK(GetAllElements(&second_epoch));
+  TF_EXPECT_OK(ExpectEqual(first_epoch, second_epoch, /*compare_order=*/true));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, RequiresRandomAccess) {
+  auto dataset_params = GlobalShuffleDatasetParams(
+      TakeDatasetParams(RangeDatasetParams(0, 10, 1), /*count=*/5,
+                        /*output_dtypes=*/{DT_INT64},
+                        /*output_shapes=*/{PartialTensorShape({})},
+                        /*node_name=*/"take_dataset"),
+      /*reshuffle_each_iteration=*/true,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+  EXPECT_TRUE(errors::IsUnimplemented(Initialize(dataset_params)));
+}
+
+std::vector<CardinalityTestCase<GlobalShuffleDatasetParams>>
+CardinalityTestCases() {
+  return {{/*dataset_params=*/RangeShuffleParams(
+               /*stop=*/100, /*reshuffle_each_iteration=*/true),
+           /*expected_cardinality=*/100}};
+}
+
+DATASET_CARDINALITY_TEST_P(GlobalShuffleDatasetOpTest,
+                           GlobalShuffleDatasetParams, CardinalityTestCases())
+
+std::vector<IteratorSaveAndRestoreTestCase<GlobalShuffleDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/RangeShuffleParams(
+               /*stop=*/10, /*reshuffle_each_iteration=*/true),
+           /*breakpoints=*/{0, 4, 11},
+           /*expected_outputs=*/RangeOutputs(10),
+           /*compare_order=*/false}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(GlobalShuffleDatasetOpTest,
+                                 GlobalShuffleDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
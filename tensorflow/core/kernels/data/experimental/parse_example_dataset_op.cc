@@ -15,6 +15,7 @@ limitations under the License.
 #include <deque>
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
@@ -42,6 +43,52 @@ constexpr char kErrorMessage[] = ".error_message";
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
+// The buffer of a string tensor whose elements are views into serialized
+// examples. It holds a reference to the tensors of those examples, so that they
+// outlive the views.
+class ViewTensorBuffer : public TensorBuffer {
+ public:
+  ViewTensorBuffer(const TensorBuffer* views, std::vector<Tensor> serialized)
+      : TensorBuffer(views->data()),
+        views_(views),
+        serialized_(std::move(serialized)) {
+    views_->Ref();
+  }
+
+  ~ViewTensorBuffer() override { views_->Unref(); }
+
+  size_t size() const override { return views_->size(); }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    views_->FillAllocationDescription(proto);
+  }
+  bool OwnsMemory() const override { return views_->OwnsMemory(); }
+
+ private:
+  const TensorBuffer* const views_;
+  const std::vector<Tensor> serialized_;
+};
+
+// Returns a tensor with the contents of `tensor` that keeps `serialized` alive
+// if `tensor` may contain views into them.
+Tensor KeepAlive(const Tensor& tensor, const std::vector<Tensor>& serialized) {
+  const TensorBuffer* buffer = DMAHelper::buffer(&tensor);
+  if (tensor.dtype() != DT_STRING || buffer == nullptr) {
+    return tensor;
+  }
+  auto* view_buffer = new ViewTensorBuffer(buffer, serialized);
+  Tensor result(DT_STRING, tensor.shape(), view_buffer);
+  view_buffer->Unref();
+  return result;
+}
+
+// Returns a copy of `config` that collects feature statistics.
+example::FastParseExampleConfig WithFeatureStats(
+    example::FastParseExampleConfig config) {
+  config.collect_feature_stats = true;
+  return config;
+}
+
 class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
  public:
   static constexpr const char* const kDatasetType = "ParseExample";
@@ -83,6 +130,9 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
       OP_REQUIRES_OK(ctx,
                      ctx->GetAttr("ragged_split_types", &ragged_split_types_));
     }
+    if (ctx->HasAttr("bytes_as_views")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("bytes_as_views", &bytes_as_views_));
+    }
     for (int i = 0; i < dense_shapes_.size(); ++i) {
       bool shape_ok = true;
       if (dense_shapes_[i].dims() == -1) {
@@ -167,6 +217,7 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
     }
 
     example::FastParseExampleConfig config;
+    config.bytes_as_views = bytes_as_views_;
     std::map<string, int> key_to_output_index;
     for (int d = 0; d < dense_keys_.size(); ++d) {
       config.dense.push_back({dense_keys_[d], dense_types_[d], dense_shapes_[d],
@@ -231,6 +282,7 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
           ragged_keys_(std::move(ragged_keys)),
           key_to_output_index_(std::move(key_to_output_index)),
           config_(std::move(config)),
+          config_with_stats_(WithFeatureStats(config_)),
           num_parallel_calls_(num_parallel_calls),
           sparse_types_(sparse_types),
           dense_types_(dense_types),
@@ -332,6 +384,10 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
         AttrValue deterministic_attr;
         b->BuildAttrValue(deterministic_.String(), &deterministic_attr);
         attrs.emplace_back("deterministic", deterministic_attr);
+
+        AttrValue bytes_as_views_attr;
+        b->BuildAttrValue(config_.bytes_as_views, &bytes_as_views_attr);
+        attrs.emplace_back("bytes_as_views", bytes_as_views_attr);
       }
 
       if (has_ragged_keys_) {
@@ -648,23 +704,33 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
                           std::vector<Tensor>* output) {
         thread::ThreadPool* device_threadpool =
             ctx->flr()->device()->tensorflow_cpu_worker_threads()->workers;
+        // Refers to the serialized examples without copying them.
         std::vector<tstring> slice_vec;
         for (const Tensor& t : input) {
           auto serialized_t = t.flat<tstring>();
-          gtl::ArraySlice<tstring> slice(serialized_t.data(),
-                                         serialized_t.size());
-          for (auto it = slice.begin(); it != slice.end(); it++)
-            slice_vec.push_back(*it);
+          for (int64 i = 0; i < serialized_t.size(); ++i) {
+            slice_vec.emplace_back();
+            slice_vec.back().assign_as_view(serialized_t(i));
+          }
         }
-        example::FastParseExampleConfig config = dataset()->config_;
-        // local copy of config_ for modification.
         auto stats_aggregator = ctx->stats_aggregator();
-        if (stats_aggregator) {
-          config.collect_feature_stats = true;
-        }
+        const example::FastParseExampleConfig& config =
+            stats_aggregator ? dataset()->config_with_stats_
+                             : dataset()->config_;
         example::Result example_result;
         TF_RETURN_IF_ERROR(FastParseExample(
             config, slice_vec, {}, device_threadpool, &example_result));
+        if (config.bytes_as_views) {
+          for (Tensor& t : example_result.dense_values) {
+            t = KeepAlive(t, input);
+          }
+          for (Tensor& t : example_result.sparse_values) {
+            t = KeepAlive(t, input);
+          }
+          for (Tensor& t : example_result.ragged_values) {
+            t = KeepAlive(t, input);
+          }
+        }
         (*output).resize(dataset()->key_to_output_index_.size());
         for (int d = 0; d < dataset()->dense_keys_.size(); ++d) {
           int output_index =
@@ -921,6 +987,7 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
     const std::vector<string> ragged_keys_;
     const std::map<string, int> key_to_output_index_;
     const example::FastParseExampleConfig config_;
+    const example::FastParseExampleConfig config_with_stats_;
     const int64 num_parallel_calls_;
     const DataTypeVector sparse_types_;
     const DataTypeVector dense_types_;
@@ -949,6 +1016,7 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
   std::vector<bool> variable_length_;
   std::vector<std::size_t> elements_per_stride_;
   bool has_ragged_keys_;
+  bool bytes_as_views_ = false;
   const int op_version_;
 };
 
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include <random>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
 #include "absl/time/clock.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/data/dataset_utils.h"
@@ -82,6 +84,9 @@ namespace experimental {
     SnapshotDatasetV2Op::kReaderFuncTarguments;
 /* static */ constexpr const char* const
     SnapshotDatasetV2Op::kShardFuncTarguments;
+/* static */ constexpr const char* const SnapshotDatasetV2Op::kReadWhileWriting;
+/* static */ constexpr const char* const SnapshotDatasetV2Op::kNumWriters;
+/* static */ constexpr const char* const SnapshotDatasetV2Op::kWriterIndex;
 /* static */ constexpr const int SnapshotDatasetV2Op::kFileFormatVersion;
 
 // ==== Snapshot Implementation ====
@@ -112,15 +117,45 @@ namespace experimental {
  *       ...
  *     - graphhash3/
  *       ...
+ *
+ * Once a checkpoint file has been completely written, an empty
+ * `<checkpoint file>.done` file is written next to it, so that readers can
+ * start reading a snapshot before the snapshot is finalized.
+ *
+ * When the snapshot is written by `num_writers` > 1 writers, they all write to
+ * a run whose id is derived from the graph hash. Writer `writer_index` writes
+ * shard `i` to the shard directory `i * num_writers + writer_index`, so the
+ * writers' shards are disjoint. Each writer writes a `writer_<index>.done`
+ * file into the run directory when it is done, and the writer which finds all
+ * of these files finalizes the snapshot.
  */
 
+namespace {
+
+// How often a streaming reader checks for newly completed checkpoint files.
+constexpr int64 kStreamingReadPollIntervalUs = 1000 * 1000;  // 1 second.
+// How long a streaming reader waits for a new checkpoint file before giving
+// up on the writer.
+constexpr int64 kStreamingReadTimeoutUs = 30 * 60 * 1000 * 1000LL;  // 30 min.
+
+std::string WriterDoneFileName(const std::string& run_directory,
+                               int64 writer_index) {
+  return io::JoinPath(
+      run_directory,
+      strings::Printf("writer_%08lld%s", static_cast<long long>(writer_index),
+                      snapshot_util::kChunkDoneSuffix));
+}
+
+}  // namespace
+
 class SnapshotDatasetV2Op::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, uint64 hash,
           const std::string& path, const std::string& compression,
           const std::string& reader_prefix, const std::string& writer_prefix,
           std::unique_ptr<CapturedFunction> reader_func,
-          std::unique_ptr<CapturedFunction> shard_func)
+          std::unique_ptr<CapturedFunction> shard_func, bool read_while_writing,
+          int64 num_writers, int64 writer_index)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         hash_(hash),
@@ -129,7 +164,10 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
         reader_prefix_(reader_prefix),
         writer_prefix_(writer_prefix),
         reader_func_(std::move(reader_func)),
-        shard_func_(std::move(shard_func)) {
+        shard_func_(std::move(shard_func)),
+        read_while_writing_(read_while_writing),
+        num_writers_(num_writers),
+        writer_index_(writer_index) {
     input_->Ref();
   }
 
@@ -213,6 +251,15 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
     b->BuildAttrValue(shard_func_other_args_types,
                       &shard_func_arguments_types_attr);
 
+    AttrValue read_while_writing_attr;
+    b->BuildAttrValue(read_while_writing_, &read_while_writing_attr);
+
+    AttrValue num_writers_attr;
+    b->BuildAttrValue(num_writers_, &num_writers_attr);
+
+    AttrValue writer_index_attr;
+    b->BuildAttrValue(writer_index_, &writer_index_attr);
+
     return b->AddDataset(
         this,
         /*inputs=*/
@@ -229,11 +276,17 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
          {kReaderFunc, reader_func_attr},
          {kShardFunc, shard_func_attr},
          {kReaderFuncTarguments, reader_func_arguments_types_attr},
-         {kShardFuncTarguments, shard_func_arguments_types_attr}},
+         {kShardFuncTarguments, shard_func_arguments_types_attr},
+         {kReadWhileWriting, read_while_writing_attr},
+         {kNumWriters, num_writers_attr},
+         {kWriterIndex, writer_index_attr}},
         output);
   }
 
  private:
+  // Whether the snapshot is written by several writers.
+  bool distributed() const { return num_writers_ > 1; }
+
   const DatasetBase* input_;
   const uint64 hash_;
   const tstring path_;
@@ -243,6 +296,9 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
 
   std::unique_ptr<CapturedFunction> reader_func_;
   std::unique_ptr<CapturedFunction> shard_func_;
+  const bool read_while_writing_;
+  const int64 num_writers_;
+  const int64 writer_index_;
 
   class Reader : public DatasetIterator<Dataset> {
    public:
@@ -336,6 +392,189 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
         TF_GUARDED_BY(mu_);
   };
 
+  // Reads the checkpoint files of a snapshot that is still being written, as
+  // they are completed. Unlike `Reader`, this reads the files one at a time in
+  // the order of their names, without applying `reader_func`.
+  class StreamingReader : public DatasetIterator<Dataset> {
+   public:
+    static constexpr const char* const kIteratorName = "StreamingReader";
+    static constexpr const char* const kNumConsumedChunks =
+        "num_consumed_chunks";
+    static constexpr const char* const kConsumedChunk = "consumed_chunk";
+    static constexpr const char* const kCurrentChunk = "current_chunk";
+    static constexpr const char* const kNumReadInChunk = "num_read_in_chunk";
+
+    explicit StreamingReader(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      hash_dir_ = snapshot_util::HashDirectory(
+          io::JoinPath(dataset()->reader_prefix_, dataset()->path_),
+          dataset()->hash_);
+      experimental::SnapshotMetadataRecord metadata;
+      bool metadata_file_exists;
+      TF_RETURN_IF_ERROR(snapshot_util::ReadMetadataFile(
+          ctx->env(), hash_dir_, &metadata, &metadata_file_exists));
+      if (!metadata_file_exists) {
+        return errors::NotFound("Snapshot metadata file in ", hash_dir_,
+                                " does not exist.");
+      }
+      run_id_ = metadata.run_id();
+      run_dir_ = snapshot_util::RunDirectory(hash_dir_, run_id_);
+      version_ = metadata.version();
+      last_progress_us_ = ctx->env()->NowMicros();
+      return Status::OK();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      while (true) {
+        if (current_reader_ != nullptr) {
+          Status s = current_reader_->ReadTensors(out_tensors);
+          if (s.ok()) {
+            ++num_read_in_chunk_;
+            *end_of_sequence = false;
+            return Status::OK();
+          }
+          if (!errors::IsOutOfRange(s)) {
+            return s;
+          }
+          consumed_chunks_.insert(current_chunk_);
+          current_reader_.reset();
+          current_chunk_.clear();
+          num_read_in_chunk_ = 0;
+          continue;
+        }
+        // Checks whether the snapshot is finalized before listing its chunks,
+        // so that no chunk completed before finalization is missed.
+        bool finalized;
+        TF_RETURN_IF_ERROR(IsFinalized(ctx->env(), &finalized));
+        std::vector<std::string> chunks;
+        TF_RETURN_IF_ERROR(
+            snapshot_util::ListCompletedChunks(ctx->env(), run_dir_, &chunks));
+        for (const std::string& chunk : chunks) {
+          if (!consumed_chunks_.contains(chunk)) {
+            TF_RETURN_IF_ERROR(OpenChunk(ctx->env(), chunk));
+            break;
+          }
+        }
+        if (current_reader_ != nullptr) {
+          continue;
+        }
+        if (finalized) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        if (ctx->env()->NowMicros() - last_progress_us_ >
+            kStreamingReadTimeoutUs) {
+          return errors::DeadlineExceeded(
+              "Timed out waiting for the writer of snapshot run ", run_dir_,
+              " to complete a checkpoint file.");
+        }
+        if (ctx->cancellation_manager() != nullptr &&
+            ctx->cancellation_manager()->IsCancelled()) {
+          return errors::Cancelled("Snapshot streaming reader was cancelled.");
+        }
+        VLOG(2) << "Waiting for the next checkpoint file in " << run_dir_;
+        ctx->env()->SleepForMicroseconds(kStreamingReadPollIntervalUs);
+      }
+    }
+
+   protected:
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          full_name(kNumConsumedChunks),
+          static_cast<int64>(consumed_chunks_.size())));
+      int64 i = 0;
+      for (const std::string& chunk : consumed_chunks_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(absl::StrCat(kConsumedChunk, "[", i++, "]")), chunk));
+      }
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kCurrentChunk), current_chunk_));
+      return writer->WriteScalar(full_name(kNumReadInChunk),
+                                 num_read_in_chunk_);
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64 num_consumed_chunks;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kNumConsumedChunks),
+                                            &num_consumed_chunks));
+      consumed_chunks_.clear();
+      for (int64 i = 0; i < num_consumed_chunks; ++i) {
+        tstring chunk;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            full_name(absl::StrCat(kConsumedChunk, "[", i, "]")), &chunk));
+        consumed_chunks_.insert(chunk);
+      }
+      tstring current_chunk;
+      int64 num_read_in_chunk;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kCurrentChunk), &current_chunk));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNumReadInChunk), &num_read_in_chunk));
+      current_reader_.reset();
+      current_chunk_.clear();
+      num_read_in_chunk_ = 0;
+      if (current_chunk.empty()) {
+        return Status::OK();
+      }
+      TF_RETURN_IF_ERROR(OpenChunk(ctx->env(), current_chunk));
+      for (; num_read_in_chunk_ < num_read_in_chunk; ++num_read_in_chunk_) {
+        std::vector<Tensor> unused;
+        TF_RETURN_IF_ERROR(current_reader_->ReadTensors(&unused));
+      }
+      return Status::OK();
+    }
+
+   private:
+    Status IsFinalized(Env* env, bool* finalized)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      experimental::SnapshotMetadataRecord metadata;
+      bool metadata_file_exists;
+      TF_RETURN_IF_ERROR(snapshot_util::ReadMetadataFile(
+          env, hash_dir_, &metadata, &metadata_file_exists));
+      // Another writer may have started a new run since, in which case this
+      // reader keeps waiting for its own run to be finalized.
+      *finalized = metadata_file_exists && metadata.finalized() &&
+                   metadata.run_id() == run_id_;
+      return Status::OK();
+    }
+
+    Status OpenChunk(Env* env, const std::string& chunk)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      VLOG(2) << "Reading snapshot checkpoint file " << chunk;
+      TF_RETURN_IF_ERROR(snapshot_util::Reader::Create(
+          env, chunk, dataset()->compression_, version_,
+          dataset()->output_dtypes(), &current_reader_));
+      current_chunk_ = chunk;
+      num_read_in_chunk_ = 0;
+      last_progress_us_ = env->NowMicros();
+      return Status::OK();
+    }
+
+    mutex mu_;
+    std::string hash_dir_ TF_GUARDED_BY(mu_);
+    std::string run_id_ TF_GUARDED_BY(mu_);
+    std::string run_dir_ TF_GUARDED_BY(mu_);
+    int64 version_ TF_GUARDED_BY(mu_) = 0;
+    // The checkpoint files that have been read completely.
+    absl::flat_hash_set<std::string> consumed_chunks_ TF_GUARDED_BY(mu_);
+    // The checkpoint file being read, and the number of elements read from it.
+    std::string current_chunk_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<snapshot_util::Reader> current_reader_ TF_GUARDED_BY(mu_);
+    int64 num_read_in_chunk_ TF_GUARDED_BY(mu_) = 0;
+    // The last time a checkpoint file was opened.
+    int64 last_progress_us_ TF_GUARDED_BY(mu_) = 0;
+  };
+
   class Writer : public DatasetIterator<Dataset> {
    public:
     static constexpr const char* const kIteratorName = "Writer";
@@ -380,17 +619,7 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
         // overwrite an existing metadata file or not before `RestoreInternal`
         // is potentially called.
         if (run_dir_.empty()) {
-          run_id_ = random::New64();
-
-          // Creates the run directory.
-          run_dir_ = snapshot_util::RunDirectory(
-              snapshot_util::HashDirectory(
-                  io::JoinPath(dataset()->writer_prefix_, dataset()->path_),
-                  dataset()->hash_),
-              run_id_);
-          TF_RETURN_IF_ERROR(ctx->env()->RecursivelyCreateDir(run_dir_));
-          TF_RETURN_IF_ERROR(
-              WriteMetadataFile(ctx->env(), /*finalized=*/false));
+          TF_RETURN_IF_ERROR(InitializeRun(ctx->env()));
         }
 
         // Writers have either encountered an error or are closed.
@@ -412,7 +641,7 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
             mutex_lock wsl(writer_status_mu_);
             TF_RETURN_IF_ERROR(writer_status_);
           }
-          return WriteMetadataFile(ctx->env(), /*finalized=*/true);
+          return FinalizeRun(ctx->env());
         }
 
         int64 shard_index = 0;
@@ -421,7 +650,7 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
         // If the index does not exist, we will start a new thread.
         if (writers_.count(shard_index) == 0) {
           auto snapshot_shard_directory =
-              snapshot_util::ShardDirectory(run_dir_, shard_index);
+              snapshot_util::ShardDirectory(run_dir_, ShardId(shard_index));
           auto writer = std::make_unique<snapshot_util::AsyncWriter>(
               ctx->env(), shard_index, snapshot_shard_directory,
               current_checkpoint_id_, dataset()->compression_,
@@ -478,6 +707,87 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
     }
 
    private:
+    // Creates the run directory and the metadata file of a new run.
+    Status InitializeRun(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      // All writers of a distributed snapshot share one run.
+      run_id_ = dataset()->distributed() ? dataset()->hash_ : random::New64();
+      run_dir_ = snapshot_util::RunDirectory(
+          snapshot_util::HashDirectory(
+              io::JoinPath(dataset()->writer_prefix_, dataset()->path_),
+              dataset()->hash_),
+          run_id_);
+      TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(run_dir_));
+      if (!dataset()->distributed()) {
+        return WriteMetadataFile(env, /*finalized=*/false);
+      }
+      TF_RETURN_IF_ERROR(DeleteShardsOfPreviousAttempt(env));
+      experimental::SnapshotMetadataRecord metadata;
+      bool metadata_file_exists;
+      TF_RETURN_IF_ERROR(snapshot_util::ReadMetadataFile(
+          env,
+          io::JoinPath(dataset()->writer_prefix_,
+                       snapshot_util::HashDirectory(dataset()->path_,
+                                                    dataset()->hash_)),
+          &metadata, &metadata_file_exists));
+      if (metadata_file_exists &&
+          metadata.run_id() == strings::StrCat(run_id_)) {
+        // Another writer has already started the run.
+        return Status::OK();
+      }
+      return WriteMetadataFile(env, /*finalized=*/false);
+    }
+
+    // Deletes the shards that this writer wrote before it was restarted from
+    // scratch, which would otherwise duplicate the elements it writes again.
+    Status DeleteShardsOfPreviousAttempt(Env* env)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Status s = env->DeleteFile(
+          WriterDoneFileName(run_dir_, dataset()->writer_index_));
+      if (!s.ok() && !errors::IsNotFound(s)) {
+        return s;
+      }
+      std::vector<std::string> shard_dirs;
+      TF_RETURN_IF_ERROR(env->GetMatchingPaths(
+          io::JoinPath(run_dir_,
+                       absl::StrCat("*", snapshot_util::kShardDirectorySuffix)),
+          &shard_dirs));
+      for (const std::string& shard_dir : shard_dirs) {
+        absl::string_view name = io::Basename(shard_dir);
+        name.remove_suffix(strlen(snapshot_util::kShardDirectorySuffix));
+        int64 shard_id;
+        if (!absl::SimpleAtoi(name, &shard_id) ||
+            shard_id % dataset()->num_writers_ != dataset()->writer_index_) {
+          continue;
+        }
+        int64 undeleted_files, undeleted_dirs;
+        TF_RETURN_IF_ERROR(env->DeleteRecursively(shard_dir, &undeleted_files,
+                                                  &undeleted_dirs));
+      }
+      return Status::OK();
+    }
+
+    // Finalizes the run once all of its writers are done.
+    Status FinalizeRun(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!dataset()->distributed()) {
+        return WriteMetadataFile(env, /*finalized=*/true);
+      }
+      TF_RETURN_IF_ERROR(WriteStringToFile(
+          env, WriterDoneFileName(run_dir_, dataset()->writer_index_), ""));
+      for (int64 i = 0; i < dataset()->num_writers_; ++i) {
+        if (!env->FileExists(WriterDoneFileName(run_dir_, i)).ok()) {
+          VLOG(1) << "Not finalizing snapshot run " << run_dir_
+                  << " because writer " << i << " is not done yet.";
+          return Status::OK();
+        }
+      }
+      return WriteMetadataFile(env, /*finalized=*/true);
+    }
+
+    // Returns the id of the shard directory that `shard_index` is written to.
+    int64 ShardId(int64 shard_index) const {
+      return shard_index * dataset()->num_writers_ + dataset()->writer_index_;
+    }
+
     Status GetShardIndex(IteratorContext* ctx,
                          const std::vector<Tensor>& tensors, int64* shard_index)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -523,12 +833,33 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
       if (!writers_closed_) {
         // Push the end of sequence signal to each of the threads to close
         // files.
+        std::vector<int64> shard_indices;
         for (auto& writer : writers_) {
           writer.second->SignalEOF();
+          shard_indices.push_back(writer.first);
         }
 
+        // Destroying the writers waits for them to close their files.
         writers_.clear();
         writers_closed_ = mark_closed;
+        MarkChunksDone(shard_indices);
+      }
+    }
+
+    // Marks the checkpoint files that were just closed as done, so that
+    // streaming readers can read them.
+    void MarkChunksDone(const std::vector<int64>& shard_indices)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      mutex_lock l(writer_status_mu_);
+      for (int64 shard_index : shard_indices) {
+        if (!writer_status_.ok()) {
+          return;
+        }
+        writer_status_ = snapshot_util::WriteChunkDoneFile(
+            Env::Default(), snapshot_util::GetCheckpointFileName(
+                                snapshot_util::ShardDirectory(
+                                    run_dir_, ShardId(shard_index)),
+                                current_checkpoint_id_));
       }
     }
 
@@ -690,6 +1021,13 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(snapshot_util::DetermineOpState(
             /*mode_string=*/"", file_exists, &metadata,
             /*pending_snapshot_expiry_seconds=*/0, &mode_));
+        // Writers of a distributed snapshot join the unfinalized run, and
+        // other iterators may read it while it is being written.
+        if (mode_ == snapshot_util::WRITER && file_exists &&
+            !metadata.finalized() && !dataset()->distributed() &&
+            dataset()->read_while_writing_) {
+          mode_ = snapshot_util::STREAMING_READER;
+        }
       }
 
       switch (mode_) {
@@ -707,6 +1045,12 @@ class SnapshotDatasetV2Op::Dataset : public DatasetBase {
           iterator_ = absl::make_unique<Passthrough>(Passthrough::Params{
               dataset(), absl::StrCat(prefix(), Passthrough::kIteratorName)});
           break;
+        case snapshot_util::STREAMING_READER:
+          iterator_ = absl::make_unique<StreamingReader>(
+              StreamingReader::Params{
+                  dataset(),
+                  absl::StrCat(prefix(), StreamingReader::kIteratorName)});
+          break;
       }
       TF_RETURN_IF_ERROR(iterator_->InitializeBase(ctx, this));
       return iterator_->Initialize(ctx);
@@ -741,6 +1085,22 @@ SnapshotDatasetV2Op::SnapshotDatasetV2Op(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kHash, &hash));
   hash_ = static_cast<uint64>(hash);
 
+  if (ctx->HasAttr(kReadWhileWriting)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kReadWhileWriting, &read_while_writing_));
+  }
+  if (ctx->HasAttr(kNumWriters)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kNumWriters, &num_writers_));
+  }
+  if (ctx->HasAttr(kWriterIndex)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kWriterIndex, &writer_index_));
+  }
+  OP_REQUIRES(ctx, num_writers_ >= 1,
+              errors::InvalidArgument("`num_writers` must be at least 1, got ",
+                                      num_writers_));
+  OP_REQUIRES(ctx, writer_index_ >= 0 && writer_index_ < num_writers_,
+              errors::InvalidArgument("`writer_index` must be in [0, ",
+                                      num_writers_, "), got ", writer_index_));
+
   OP_REQUIRES_OK(ctx, FunctionMetadata::Create(ctx, kReaderFunc, reader_params,
                                                &reader_func_metadata_));
   OP_REQUIRES_OK(ctx, FunctionMetadata::Create(ctx, kShardFunc, shard_params,
@@ -784,7 +1144,8 @@ void SnapshotDatasetV2Op::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
 
   *output = new SnapshotDatasetV2Op::Dataset(
       ctx, input, hash, path, compression, reader_prefix_, writer_prefix_,
-      std::move(reader_func), std::move(shard_func));
+      std::move(reader_func), std::move(shard_func), read_while_writing_,
+      num_writers_, writer_index_);
 }
 
 namespace {
@@ -885,9 +1246,10 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         ctx,
         compression_ == io::compression::kNone ||
             compression_ == io::compression::kGzip ||
-            compression_ == io::compression::kSnappy,
-        errors::InvalidArgument("compression must be either '', 'GZIP' or "
-                                "'SNAPPY'."));
+            compression_ == io::compression::kSnappy ||
+            compression_ == io::compression::kZstd,
+        errors::InvalidArgument("compression must be either '', 'GZIP', "
+                                "'SNAPPY' or 'ZSTD'."));
 
     OP_REQUIRES(
         ctx, pending_snapshot_expiry_seconds_ >= 1,
@@ -1218,6 +1580,9 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
                 SnapshotPassthroughIterator::Params{
                     dataset(), absl::StrCat(prefix(), "PassthroughImpl")});
             break;
+          case snapshot_util::STREAMING_READER:
+            return errors::Internal(
+                "Streaming reads are not supported by the legacy snapshot.");
         }
         TF_RETURN_IF_ERROR(iterator_->InitializeBase(ctx, this));
         return iterator_->Initialize(ctx);
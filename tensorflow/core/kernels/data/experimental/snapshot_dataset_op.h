@@ -60,6 +60,9 @@ class SnapshotDatasetV2Op : public UnaryDatasetOpKernel {
   static constexpr const char* const kReaderFuncTarguments =
       "Treader_func_args";
   static constexpr const char* const kShardFuncTarguments = "Tshard_func_args";
+  static constexpr const char* const kReadWhileWriting = "read_while_writing";
+  static constexpr const char* const kNumWriters = "num_writers";
+  static constexpr const char* const kWriterIndex = "writer_index";
   // Note: If a new constant is declared here, it *must* be defined in
   // snapshot_dataset_op.cc, otherwise it will not compile in debug mode.
 
@@ -83,6 +86,9 @@ class SnapshotDatasetV2Op : public UnaryDatasetOpKernel {
   std::string writer_prefix_;
   bool hash_valid_;
   uint64 hash_;
+  bool read_while_writing_ = false;
+  int64 num_writers_ = 1;
+  int64 writer_index_ = 0;
 
   std::shared_ptr<FunctionMetadata> reader_func_metadata_;
   std::shared_ptr<FunctionMetadata> shard_func_metadata_;
@@ -20,6 +20,7 @@ limitations under the License.
 // dependencies are available there. The op is replaced with a no-op.
 #if !defined(IS_MOBILE_PLATFORM)
 #include "absl/memory/memory.h"
+#include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.h"
@@ -135,6 +136,9 @@ class ModelDatasetOp::Dataset : public DatasetBase {
                           : dataset()->ram_budget_) {
       cancellation_manager_ = absl::make_unique<CancellationManager>();
       model_ = std::make_shared<model::Model>();
+      if (GetExperiments().contains("autotune_tail_latency")) {
+        model_->set_latency_quantile(kAutotuneTailLatencyQuantile);
+      }
     }
 
     ~Iterator() override { cancellation_manager_->StartCancel(); }
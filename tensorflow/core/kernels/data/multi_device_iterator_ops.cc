@@ -599,9 +599,7 @@ REGISTER_KERNEL_BUILDER(Name("MultiDeviceIteratorInit").Device(DEVICE_CPU),
 class MultiDeviceIteratorGetNextFromShardOp : public AsyncOpKernel {
  public:
   explicit MultiDeviceIteratorGetNextFromShardOp(OpKernelConstruction* ctx)
-      : AsyncOpKernel(ctx),
-        background_worker_(ctx->env(),
-                           "tf_data_multi_device_iterator_get_next") {}
+      : AsyncOpKernel(ctx) {}
 
   void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
     const Tensor* tensor_shard_num;
@@ -616,43 +614,36 @@ class MultiDeviceIteratorGetNextFromShardOp : public AsyncOpKernel {
     MultiDeviceIterator* iterator;
     OP_REQUIRES_OK_ASYNC(
         ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &iterator), done);
-
-    background_worker_.Schedule(std::bind(
-        [ctx, iterator, shard_num, incarnation_id](DoneCallback done) {
-          Notification n;
-          MultiDeviceIteratorCallback callback = std::bind(
-              [ctx, &n](const HostBufferElement& elem) {
-                Status s = elem.status;
-                if (!s.ok()) {
-                  ctx->SetStatus(s);
-                } else if (elem.end_of_sequence) {
-                  ctx->SetStatus(errors::OutOfRange("End of sequence"));
-                } else {
-                  for (int i = 0; i < elem.value.size(); ++i) {
-                    ctx->set_output(i, elem.value[i]);
-                  }
-                }
-                n.Notify();
-              },
-              std::placeholders::_1);
-
-          Status s = iterator->GetNextFromShard(ctx, shard_num, incarnation_id,
-                                                std::move(callback));
+    core::ScopedUnref unref_iterator(iterator);
+
+    // The callback runs once the shard has an element, without blocking a
+    // thread in the meantime. `done` is run on the op runner so that the
+    // downstream work, e.g. copying the element to its device, neither holds
+    // the iterator lock nor delays the requests of other shards or further
+    // requests of this shard, which are otherwise served one at a time.
+    MultiDeviceIteratorCallback callback = std::bind(
+        [ctx](const HostBufferElement& elem, DoneCallback done) {
+          Status s = elem.status;
           if (!s.ok()) {
             ctx->SetStatus(s);
-            iterator->Unref();
-            done();
-            return;
+          } else if (elem.end_of_sequence) {
+            ctx->SetStatus(errors::OutOfRange("End of sequence"));
+          } else {
+            for (int i = 0; i < elem.value.size(); ++i) {
+              ctx->set_output(i, elem.value[i]);
+            }
           }
-          iterator->Unref();
-          n.WaitForNotification();
-          done();
+          (*ctx->runner())(std::move(done));
         },
-        std::move(done)));
-  }
+        std::placeholders::_1, done);
 
- private:
-  BackgroundWorker background_worker_;
+    Status s = iterator->GetNextFromShard(ctx, shard_num, incarnation_id,
+                                          std::move(callback));
+    if (!s.ok()) {
+      ctx->SetStatus(s);
+      done();
+    }
+  }
 };
 
 REGISTER_KERNEL_BUILDER(
@@ -333,7 +333,9 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
 
         // 2. Copy each batch element to the appropriate location in
         // the output component tensor.
-        out_tensors->emplace_back(ctx->allocator({}),
+        AllocatorAttributes attr;
+        attr.set_gpu_compatible(true);
+        out_tensors->emplace_back(ctx->allocator(attr),
                                   output_dtypes()[component_index],
                                   batch_component_shape);
         Tensor& batch_component = out_tensors->back();
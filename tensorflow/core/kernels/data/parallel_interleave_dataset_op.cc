@@ -158,14 +158,16 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input,
           std::unique_ptr<CapturedFunction> captured_func, int64 cycle_length,
-          int64 block_length, int64 buffer_output_elements,
-          int64 prefetch_input_elements, int64 num_parallel_calls,
-          DeterminismPolicy deterministic, const DataTypeVector& output_types,
+          bool autotune_cycle_length, int64 block_length,
+          int64 buffer_output_elements, int64 prefetch_input_elements,
+          int64 num_parallel_calls, DeterminismPolicy deterministic,
+          const DataTypeVector& output_types,
           const std::vector<PartialTensorShape>& output_shapes, int op_version)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         captured_func_(std::move(captured_func)),
         cycle_length_(cycle_length),
+        autotune_cycle_length_(autotune_cycle_length),
         block_length_(block_length),
         buffer_output_elements_(
             ComputeBufferOutputElements(buffer_output_elements, block_length)),
@@ -254,7 +256,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     list_inputs.emplace_back(input_index++, other_arguments);
 
     Node* cycle_length_node;
-    TF_RETURN_IF_ERROR(b->AddScalar(cycle_length_, &cycle_length_node));
+    TF_RETURN_IF_ERROR(b->AddScalar(
+        autotune_cycle_length_ ? model::kAutotune : cycle_length_,
+        &cycle_length_node));
     inputs.emplace_back(input_index++, cycle_length_node);
 
     Node* block_length_node;
@@ -312,6 +316,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           num_parallel_calls_(std::make_shared<model::SharedState>(
               params.dataset->num_parallel_calls_, mu_,
               num_parallel_calls_cond_var_)),
+          autotune_cycle_length_(params.dataset->autotune_cycle_length_ &&
+                                 !deterministic),
+          active_cycle_length_(std::make_shared<model::SharedState>(
+              autotune_cycle_length_ ? model::kAutotune
+                                     : params.dataset->cycle_length_,
+              mu_, num_parallel_calls_cond_var_)),
           deterministic_(deterministic),
           current_elements_(params.dataset->cycle_length_) {}
 
@@ -343,6 +353,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       if (num_parallel_calls_->value == model::kAutotune) {
         num_parallel_calls_->value = dataset()->cycle_length_;
       }
+      if (active_cycle_length_->value == model::kAutotune) {
+        active_cycle_length_->value = dataset()->cycle_length_;
+      }
       ctx_ = std::make_unique<IteratorContext>(*ctx);
       cancellation_manager_ = absl::make_unique<CancellationManager>();
       IteratorContext::Params params(ctx);
@@ -395,10 +408,16 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
-      return model::MakeAsyncInterleaveManyNode(
-          std::move(args),
-          {model::MakeParameter(kParallelism, num_parallel_calls_, /*min=*/1,
-                                /*max=*/dataset()->cycle_length_)});
+      std::vector<std::shared_ptr<model::Parameter>> parameters = {
+          model::MakeParameter(kParallelism, num_parallel_calls_, /*min=*/1,
+                               /*max=*/dataset()->cycle_length_)};
+      if (autotune_cycle_length_) {
+        parameters.push_back(model::MakeParameter(
+            model::kCycleLength, active_cycle_length_, /*min=*/1,
+            /*max=*/dataset()->cycle_length_));
+      }
+      return model::MakeAsyncInterleaveManyNode(std::move(args),
+                                                std::move(parameters));
     }
 
     // TODO(aaudibert): Refactor the implementations to avoid the need for
@@ -606,7 +625,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
 
     void EnsureInitialElementsCreated() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!initial_elements_created_) {
-        for (int i = 0; i < dataset()->cycle_length_; ++i) {
+        for (int i = 0; i < active_cycle_length_->value; ++i) {
           current_elements_[i] = MakeElement();
           if (!current_elements_[i]) {
             break;
@@ -655,6 +674,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       if (deterministic_) {
         return ConsumeHelper(result);
       }
+      if (autotune_cycle_length_) {
+        FillCycle();
+      }
       // If we are allowed to be nondeterministic (i.e. return results out of
       // order), try to find an element in the cycle that has a result
       // available.
@@ -704,38 +726,20 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           // The element is still producing results, so we wait.
           return false;
         }
-        // We've consumed all results from the element. Get a new element from
-        // future_elements, or create a new element if no future elements are
-        // available.
-        if (!future_elements_.empty()) {
-          std::shared_ptr<Element> future_element =
-              std::move(future_elements_.front());
-          future_elements_.pop_front();
-          if (future_element->iterator) {
-            EnableAutotune(ctx_.get(), future_element->iterator.get());
-          }
-          future_element->cycle_index = cycle_index_;
-          current_elements_[cycle_index_] = std::move(future_element);
-          future_workers_cond_var_.notify_one();
-          if (!current_elements_[cycle_index_]->active) {
-            current_workers_cond_var_.notify_one();
-          }
+        // We've consumed all results from the element. Replace it with a new
+        // element, unless autotuning shrank the cycle below its position.
+        if (cycle_index_ < active_cycle_length_->value) {
+          FillCycleElement(cycle_index_);
         } else {
-          current_elements_[cycle_index_] = MakeElement();
-          if (current_elements_[cycle_index_]) {
-            current_elements_[cycle_index_]->cycle_index = cycle_index_;
-            elements_to_process_.push_back(cycle_index_);
-            element->cycle_index = cycle_index_;
-            current_workers_cond_var_.notify_one();
-          }
-          while (last_valid_current_element_ >= 0 &&
-                 !current_elements_[last_valid_current_element_]) {
-            last_valid_current_element_--;
-            if (cycle_index_ > last_valid_current_element_) {
-              // We are about to move the cycle index below in
-              // AdvanceToNextInCycle().
-              cycle_index_ = last_valid_current_element_;
-            }
+          current_elements_[cycle_index_].reset();
+        }
+        while (last_valid_current_element_ >= 0 &&
+               !current_elements_[last_valid_current_element_]) {
+          last_valid_current_element_--;
+          if (cycle_index_ > last_valid_current_element_) {
+            // We are about to move the cycle index below in
+            // AdvanceToNextInCycle().
+            cycle_index_ = last_valid_current_element_;
           }
         }
         if (last_valid_current_element_ != -1) {
@@ -744,6 +748,51 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Puts a new element at position `index` of the interleave cycle. The
+    // element is taken from `future_elements_`, or created if no future
+    // elements are available. The position is left empty at end of input.
+    void FillCycleElement(int64 index) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!future_elements_.empty()) {
+        std::shared_ptr<Element> future_element =
+            std::move(future_elements_.front());
+        future_elements_.pop_front();
+        if (future_element->iterator) {
+          EnableAutotune(ctx_.get(), future_element->iterator.get());
+        }
+        future_element->cycle_index = index;
+        current_elements_[index] = std::move(future_element);
+        future_workers_cond_var_.notify_one();
+        if (!current_elements_[index]->active) {
+          current_workers_cond_var_.notify_one();
+        }
+      } else {
+        current_elements_[index] = MakeElement();
+        if (current_elements_[index]) {
+          current_elements_[index]->cycle_index = index;
+          elements_to_process_.push_back(index);
+          current_workers_cond_var_.notify_one();
+        }
+      }
+    }
+
+    // Fills the empty positions among the first `active_cycle_length_`
+    // positions of the interleave cycle, which appear when autotuning grows
+    // the cycle length.
+    void FillCycle() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (int64 i = 0; i < active_cycle_length_->value; ++i) {
+        if (current_elements_[i]) {
+          continue;
+        }
+        FillCycleElement(i);
+        if (!current_elements_[i]) {
+          // Reached end of input.
+          break;
+        }
+        last_valid_current_element_ =
+            std::max(last_valid_current_element_, i);
+      }
+    }
+
     // Creates a new element.
     std::shared_ptr<Element> MakeElement() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (end_of_input_) {
@@ -1522,6 +1571,17 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // element thread. Only used when `deterministic` is false.
     condition_variable any_element_available_cond_var_;
 
+    // Whether the cycle length is autotuned. This is only the case if the
+    // dataset cycle length is `kAutotune` and outputs may be produced in
+    // nondeterministic order, as the order depends on the cycle length.
+    const bool autotune_cycle_length_;
+
+    // Identifies the number of positions of the interleave cycle that are
+    // refilled when their element is exhausted, up to the dataset cycle
+    // length. Shares the condition variable of `num_parallel_calls_`, as a
+    // change takes effect the next time a result is consumed.
+    const std::shared_ptr<model::SharedState> active_cycle_length_;
+
     // Determines whether outputs can be produced in deterministic order.
     const bool deterministic_;
 
@@ -1581,6 +1641,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const DatasetBase* const input_;
   const std::unique_ptr<CapturedFunction> captured_func_;
   const int64 cycle_length_;
+  const bool autotune_cycle_length_;
   const int64 block_length_;
   const int64 buffer_output_elements_;
   const int64 prefetch_input_elements_;
@@ -1656,7 +1717,10 @@ void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
       errors::InvalidArgument("num_parallel_calls must be greater than zero."));
   int64 cycle_length = 0;
   OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kCycleLength, &cycle_length));
-  if (cycle_length == model::kAutotune) {
+  // An autotuned cycle length is resolved to its maximum value here and tuned
+  // at runtime by the iterator.
+  const bool autotune_cycle_length = cycle_length == model::kAutotune;
+  if (autotune_cycle_length) {
     if (num_parallel_calls != model::kAutotune) {
       cycle_length = std::min(num_parallel_calls,
                               static_cast<int64>(port::MaxParallelism()));
@@ -1686,10 +1750,11 @@ void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
     metrics::RecordTFDataAutotune(kDatasetType);
   }
 
-  *output = new Dataset(
-      ctx, input, std::move(captured_func), cycle_length, block_length,
-      buffer_output_elements, prefetch_input_elements, num_parallel_calls,
-      deterministic_, output_types_, output_shapes_, op_version_);
+  *output = new Dataset(ctx, input, std::move(captured_func), cycle_length,
+                        autotune_cycle_length, block_length,
+                        buffer_output_elements, prefetch_input_elements,
+                        num_parallel_calls, deterministic_, output_types_,
+                        output_shapes_, op_version_);
 }
 
 namespace {
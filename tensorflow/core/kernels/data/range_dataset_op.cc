@@ -45,6 +45,25 @@ constexpr char kHasSplitProvider[] = "has_split_provider";
 constexpr char kSlash[] = "/";
 constexpr char kSplitProvider[] = "split_provider";
 
+// Stores `value`, converted to `output_dtypes[0]`, in `*out_tensors`.
+Status ConvertOutputTypes(const DataTypeVector& output_dtypes, int64 value,
+                          std::vector<Tensor>* out_tensors) {
+  out_tensors->reserve(1);
+  switch (output_dtypes[0]) {
+#define HANDLE_TYPE(type)                                \
+  case DataTypeToEnum<type>::value: {                    \
+    out_tensors->emplace_back(static_cast<type>(value)); \
+    break;                                               \
+  }
+    TF_CALL_NUMBER_TYPES(HANDLE_TYPE);
+#undef HANDLE_TYPE
+    default:
+      return errors::InvalidArgument("Unsupported data type: ",
+                                     DataTypeString(output_dtypes[0]));
+  }
+  return Status::OK();
+}
+
 // Class which produces the elements of `range(start, stop, step)`. Threadsafe.
 class RangeCounter {
  public:
@@ -185,6 +204,18 @@ class RangeDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return Status::OK(); }
 
+  Status RandomIndexingCompatible() const override { return Status::OK(); }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    if (index < 0 || index >= Cardinality()) {
+      return errors::OutOfRange("Index out of range [0, ", Cardinality(),
+                                "): ", index);
+    }
+    return ConvertOutputTypes(output_dtypes_, start_ + index * step_,
+                              out_tensors);
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -233,21 +264,7 @@ class RangeDatasetOp::Dataset : public DatasetBase {
           return Status::OK();
         }
       }
-      out_tensors->reserve(1);
-      switch (dataset()->output_dtypes()[0]) {
-#define HANDLE_TYPE(type)                                \
-  case DataTypeToEnum<type>::value: {                    \
-    out_tensors->emplace_back(static_cast<type>(value)); \
-    break;                                               \
-  }
-        TF_CALL_NUMBER_TYPES(HANDLE_TYPE);
-#undef HANDLE_TYPE
-        default:
-          return errors::InvalidArgument(
-              "Unsupported data type: ",
-              DataTypeString(dataset()->output_dtypes()[0]));
-      }
-      return Status::OK();
+      return ConvertOutputTypes(dataset()->output_dtypes(), value, out_tensors);
     }
 
    protected:
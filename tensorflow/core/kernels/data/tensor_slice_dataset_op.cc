@@ -85,6 +85,27 @@ class TensorSliceDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return Status::OK(); }
 
+  Status RandomIndexingCompatible() const override { return Status::OK(); }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    if (index < 0 || index >= Cardinality()) {
+      return errors::OutOfRange("Index out of range [0, ", Cardinality(),
+                                "): ", index);
+    }
+    out_tensors->clear();
+    out_tensors->reserve(tensors_.size());
+    for (const Tensor& t : tensors_) {
+      Tensor slice = t.SubSlice(index);
+      if (slice.IsAligned()) {
+        out_tensors->push_back(std::move(slice));
+      } else {
+        out_tensors->push_back(tensor::DeepCopy(std::move(slice)));
+      }
+    }
+    return Status::OK();
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -135,18 +156,8 @@ class TensorSliceDatasetOp::Dataset : public DatasetBase {
         return Status::OK();
       }
       int64 index = split.scalar<int64>()();
-      out_tensors->clear();
-      out_tensors->reserve(dataset()->tensors_.size());
-      for (size_t i = 0; i < dataset()->tensors_.size(); ++i) {
-        Tensor slice = dataset()->tensors_[i].SubSlice(index);
-        if (slice.IsAligned()) {
-          out_tensors->push_back(std::move(slice));
-        } else {
-          out_tensors->push_back(tensor::DeepCopy(std::move(slice)));
-        }
-      }
       *end_of_sequence = false;
-      return Status::OK();
+      return dataset()->Get(ctx, index, out_tensors);
     }
 
    protected:
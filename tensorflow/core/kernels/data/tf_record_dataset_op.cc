@@ -14,13 +14,17 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/split_utils.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/record_offset_index.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
@@ -35,9 +39,12 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kFileNames;
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
+/* static */ constexpr const char* const TFRecordDatasetOp::kUseOffsetIndex;
 
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
+constexpr char kCurrentRecord[] = "current_record";
+constexpr char kEndRecord[] = "end_record";
 constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64 kCloudTpuBlockSize = 127LL << 20;  // 127MB.
@@ -53,16 +60,29 @@ bool is_cloud_tpu_gcs_fs() {
 
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
+  // If `offset_indices` is not empty, it holds the offset index of each file.
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64 buffer_size)
+                   const string& compression_type, int64 buffer_size,
+                   std::vector<io::RecordOffsetIndex> offset_indices)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
-            compression_type)) {
+            compression_type)),
+        offset_indices_(std::move(offset_indices)) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    if (use_offset_index()) {
+      record_starts_.reserve(offset_indices_.size() + 1);
+      block_starts_.reserve(offset_indices_.size() + 1);
+      record_starts_.push_back(0);
+      block_starts_.push_back(0);
+      for (const io::RecordOffsetIndex& index : offset_indices_) {
+        record_starts_.push_back(record_starts_.back() + index.num_records());
+        block_starts_.push_back(block_starts_.back() + index.num_blocks());
+      }
+    }
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
@@ -86,12 +106,60 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     return name_utils::DatasetDebugString(kDatasetType);
   }
 
+  int64 Cardinality() const override {
+    return use_offset_index() ? record_starts_.back() : kUnknownCardinality;
+  }
+
+  // Each split is the global index of a block of records, see
+  // `io::RecordOffsetIndex`.
+  Status MakeSplitProviders(std::vector<std::unique_ptr<SplitProvider>>*
+                                split_providers) const override {
+    if (!use_offset_index()) {
+      return DatasetBase::MakeSplitProviders(split_providers);
+    }
+    split_providers->push_back(
+        absl::make_unique<IndexSplitProvider>(block_starts_.back()));
+    return Status::OK();
+  }
+
   Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
     return Status::OK();
   }
 
   Status CheckExternalState() const override { return Status::OK(); }
 
+  Status RandomIndexingCompatible() const override {
+    if (!use_offset_index()) {
+      return DatasetBase::RandomIndexingCompatible();
+    }
+    return Status::OK();
+  }
+
+  // Opens the file of the record for every call, so random access is only
+  // cheap relative to the size of the records.
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    if (!use_offset_index()) {
+      return DatasetBase::Get(ctx, index, out_tensors);
+    }
+    if (index < 0 || index >= Cardinality()) {
+      return errors::OutOfRange("Index out of range [0, ", Cardinality(),
+                                "): ", index);
+    }
+    const size_t file_index =
+        std::upper_bound(record_starts_.begin(), record_starts_.end(), index) -
+        record_starts_.begin() - 1;
+    std::unique_ptr<RandomAccessFile> file;
+    TF_RETURN_IF_ERROR(
+        ctx->env()->NewRandomAccessFile(filenames_[file_index], &file));
+    io::SequentialRecordReader reader(file.get(), options_);
+    TF_RETURN_IF_ERROR(reader.SeekToRecord(offset_indices_[file_index],
+                                           index - record_starts_[file_index]));
+    out_tensors->clear();
+    out_tensors->emplace_back(ctx->allocator({}), DT_STRING, TensorShape({}));
+    return reader.ReadRecord(&out_tensors->back().scalar<tstring>()());
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -102,8 +170,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+    AttrValue use_offset_index;
+    b->BuildAttrValue(this->use_offset_index(), &use_offset_index);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {filenames, compression_type, buffer_size},
+                      {{kUseOffsetIndex, use_offset_index}}, output));
     return Status::OK();
   }
 
@@ -113,11 +184,22 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     explicit Iterator(const Params& params)
         : DatasetIterator<Dataset>(params) {}
 
+    Status Initialize(IteratorContext* ctx) override {
+      if (dataset()->use_offset_index() && !ctx->split_providers().empty()) {
+        TF_ASSIGN_OR_RETURN(split_provider_,
+                            GetSingleSplitProvider(ctx, dataset()));
+      }
+      return Status::OK();
+    }
+
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
       out_tensors->reserve(1);
       mutex_lock l(mu_);
+      if (dataset()->use_offset_index()) {
+        return GetNextIndexedLocked(ctx, out_tensors, end_of_sequence);
+      }
       do {
         // We are currently processing a file, so try to read the next record.
         if (reader_) {
@@ -163,6 +245,10 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
                         bool* end_of_sequence, int* num_skipped) override {
       *num_skipped = 0;
       mutex_lock l(mu_);
+      if (dataset()->use_offset_index()) {
+        return SkipIndexedLocked(ctx, num_to_skip, end_of_sequence,
+                                 num_skipped);
+      }
       do {
         // We are currently processing a file, so try to skip reading
         // the next (num_to_skip - *num_skipped) record.
@@ -212,6 +298,20 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentFileIndex),
                                              current_file_index_));
 
+      if (dataset()->use_offset_index()) {
+        if (split_provider_) {
+          TF_RETURN_IF_ERROR(split_provider_->Save(
+              [this](const std::string& key) { return full_name(key); },
+              writer));
+        }
+        if (reader_) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentRecord),
+                                                 current_record_));
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name(kEndRecord), end_record_));
+        }
+        return Status::OK();
+      }
       if (reader_) {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(full_name(kOffset), reader_->TellOffset()));
@@ -227,6 +327,25 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurrentFileIndex),
                                             &current_file_index));
       current_file_index_ = size_t(current_file_index);
+      if (dataset()->use_offset_index()) {
+        if (split_provider_) {
+          TF_RETURN_IF_ERROR(split_provider_->Restore(
+              [this](const std::string& key) { return full_name(key); },
+              reader));
+        }
+        current_record_ = 0;
+        if (reader->Contains(full_name(kCurrentRecord))) {
+          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurrentRecord),
+                                                &current_record_));
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name(kEndRecord), &end_record_));
+          TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+          TF_RETURN_IF_ERROR(reader_->SeekToRecord(
+              dataset()->offset_indices_[current_file_index_],
+              current_record_));
+        }
+        return Status::OK();
+      }
       if (reader->Contains(full_name(kOffset))) {
         int64 offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kOffset), &offset));
@@ -259,8 +378,114 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       file_.reset();
     }
 
+    // With an offset index, the iterator reads the records in
+    // [`current_record_`, `end_record_`) of the file at
+    // `current_file_index_`, which is either the whole file or the block of
+    // the current split.
+    Status GetNextIndexedLocked(IteratorContext* ctx,
+                                std::vector<Tensor>* out_tensors,
+                                bool* end_of_sequence)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      do {
+        if (reader_ && current_record_ < end_record_) {
+          out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                    TensorShape({}));
+          Status s =
+              reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+          if (s.ok()) {
+            static monitoring::CounterCell* bytes_counter =
+                metrics::GetTFDataBytesReadCounter(kDatasetType);
+            bytes_counter->IncrementBy(
+                out_tensors->back().scalar<tstring>()().size());
+            ++current_record_;
+            *end_of_sequence = false;
+            return Status::OK();
+          }
+          out_tensors->pop_back();
+          // Move on to the next range, so that it works with ignore_errors.
+          current_record_ = end_record_;
+          if (errors::IsOutOfRange(s)) {
+            return errors::DataLoss(
+                "The offset index of ",
+                dataset()->filenames_[current_file_index_],
+                " has more records than the file");
+          }
+          return s;
+        }
+        TF_RETURN_IF_ERROR(NextRangeLocked(ctx, end_of_sequence));
+      } while (!*end_of_sequence);
+      return Status::OK();
+    }
+
+    // Seeks past the skipped records using the offset index, so skipping
+    // never reads more than one block of records per range.
+    Status SkipIndexedLocked(IteratorContext* ctx, int num_to_skip,
+                             bool* end_of_sequence, int* num_skipped)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      *end_of_sequence = false;
+      while (*num_skipped < num_to_skip) {
+        if (reader_ && current_record_ < end_record_) {
+          const int64 n = std::min<int64>(num_to_skip - *num_skipped,
+                                          end_record_ - current_record_);
+          current_record_ += n;
+          *num_skipped += n;
+          TF_RETURN_IF_ERROR(reader_->SeekToRecord(
+              dataset()->offset_indices_[current_file_index_],
+              current_record_));
+          continue;
+        }
+        TF_RETURN_IF_ERROR(NextRangeLocked(ctx, end_of_sequence));
+        if (*end_of_sequence) break;
+      }
+      return Status::OK();
+    }
+
+    // Moves on to the next file, or to the block of the next split, and seeks
+    // to its first record.
+    Status NextRangeLocked(IteratorContext* ctx, bool* end_of_sequence)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (split_provider_) {
+        ResetStreamsLocked();
+        Tensor split;
+        TF_RETURN_IF_ERROR(split_provider_->GetNext(&split, end_of_sequence));
+        if (*end_of_sequence) return Status::OK();
+        const int64 block = split.scalar<int64>()();
+        const std::vector<int64>& block_starts = dataset()->block_starts_;
+        current_file_index_ =
+            std::upper_bound(block_starts.begin(), block_starts.end(), block) -
+            block_starts.begin() - 1;
+        const io::RecordOffsetIndex& index =
+            dataset()->offset_indices_[current_file_index_];
+        current_record_ =
+            (block - block_starts[current_file_index_]) * index.stride();
+        end_record_ =
+            std::min(current_record_ + index.stride(), index.num_records());
+      } else {
+        if (reader_) {
+          // We have reached the end of the current file.
+          ResetStreamsLocked();
+          ++current_file_index_;
+          current_record_ = 0;
+        }
+        if (current_file_index_ == dataset()->filenames_.size()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        end_record_ =
+            dataset()->offset_indices_[current_file_index_].num_records();
+      }
+      *end_of_sequence = false;
+      TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+      return reader_->SeekToRecord(
+          dataset()->offset_indices_[current_file_index_], current_record_);
+    }
+
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
+    // Only used with an offset index.
+    std::shared_ptr<SplitProvider> split_provider_;
+    int64 current_record_ TF_GUARDED_BY(mu_) = 0;
+    int64 end_record_ TF_GUARDED_BY(mu_) = 0;
 
     // `reader_` will borrow the object that `file_` points to, so
     // we must destroy `reader_` before `file_`.
@@ -268,13 +493,22 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
   };
 
+  bool use_offset_index() const { return !offset_indices_.empty(); }
+
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
+  const std::vector<io::RecordOffsetIndex> offset_indices_;
+  // The global index of the first record and of the first block of each file,
+  // followed by the total number of records and blocks.
+  std::vector<int64> record_starts_;
+  std::vector<int64> block_starts_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kUseOffsetIndex, &use_offset_index_));
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -322,8 +556,26 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  std::vector<io::RecordOffsetIndex> offset_indices;
+  if (use_offset_index_) {
+    OP_REQUIRES(ctx,
+                io::RecordReaderOptions::CreateRecordReaderOptions(
+                    compression_type)
+                        .compression_type == io::RecordReaderOptions::NONE,
+                errors::InvalidArgument(
+                    "`use_offset_index` requires uncompressed files, got "
+                    "compression_type ",
+                    compression_type));
+    offset_indices.resize(filenames.size());
+    for (size_t i = 0; i < filenames.size(); ++i) {
+      OP_REQUIRES_OK(ctx, offset_indices[i].ReadFromFile(
+                              ctx->env(), io::RecordOffsetIndex::FilenameFor(
+                                              filenames[i])));
+    }
+  }
+
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, std::move(offset_indices));
 }
 
 namespace {
@@ -12,6 +12,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
 #include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/lib/io/record_offset_index.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace data {
@@ -23,12 +26,13 @@ class TFRecordDatasetParams : public DatasetParams {
  public:
   TFRecordDatasetParams(std::vector<tstring> filenames,
                         CompressionType compression_type, int64 buffer_size,
-                        string node_name)
+                        string node_name, bool use_offset_index = false)
       : DatasetParams({DT_STRING}, {PartialTensorShape({})},
                       std::move(node_name)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
-        buffer_size_(buffer_size) {}
+        buffer_size_(buffer_size),
+        use_offset_index_(use_offset_index) {}
 
   std::vector<Tensor> GetInputTensors() const override {
     int num_files = filenames_.size();
@@ -49,7 +53,7 @@ class TFRecordDatasetParams : public DatasetParams {
   }
 
   Status GetAttributes(AttributeVector* attr_vector) const override {
-    *attr_vector = {};
+    *attr_vector = {{TFRecordDatasetOp::kUseOffsetIndex, use_offset_index_}};
     return Status::OK();
   }
 
@@ -61,6 +65,7 @@ class TFRecordDatasetParams : public DatasetParams {
   std::vector<tstring> filenames_;
   CompressionType compression_type_;
   int64 buffer_size_;
+  bool use_offset_index_;
 };
 
 class TFRecordDatasetOpTest : public DatasetOpsTestBase {};
@@ -83,6 +88,29 @@ Status CreateTestFiles(const std::vector<tstring>& filenames,
   return Status::OK();
 }
 
+// Writes uncompressed files and their offset indices, with a stride of
+// `stride` records.
+Status CreateIndexedTestFiles(const std::vector<tstring>& filenames,
+                              const std::vector<std::vector<string>>& contents,
+                              int64 stride) {
+  Env* env = Env::Default();
+  io::RecordWriterOptions options;
+  options.offset_index_stride = stride;
+  for (int i = 0; i < filenames.size(); ++i) {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(filenames[i], &file));
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : contents[i]) {
+      TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Close());
+    TF_RETURN_IF_ERROR(writer.offset_index()->WriteToFile(
+        env, io::RecordOffsetIndex::FilenameFor(filenames[i])));
+  }
+  return Status::OK();
+}
+
 // Test case 1: multiple text files with ZLIB compression.
 TFRecordDatasetParams TFRecordDatasetParams1() {
   std::vector<tstring> filenames = {
@@ -137,6 +165,25 @@ TFRecordDatasetParams TFRecordDatasetParams3() {
                                /*node_name=*/kNodeName);
 }
 
+// Test case 4: multiple text files with offset indices.
+TFRecordDatasetParams TFRecordDatasetParams4() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc", "dddd"}};
+  if (!CreateIndexedTestFiles(filenames, contents, /*stride=*/2).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/
+                               CompressionType::UNCOMPRESSED,
+                               /*buffer_size=*/10,
+                               /*node_name=*/kNodeName,
+                               /*use_offset_index=*/true);
+}
+
 std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
   return {
       {/*dataset_params=*/TFRecordDatasetParams1(),
@@ -148,7 +195,15 @@ std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
       {/*dataset_params=*/TFRecordDatasetParams3(),
        CreateTensors<tstring>(
-           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams4(),
+       CreateTensors<tstring>(TensorShape({}), {{"1"},
+                                                {"22"},
+                                                {"333"},
+                                                {"a"},
+                                                {"bb"},
+                                                {"ccc"},
+                                                {"dddd"}})}};
 }
 
 ITERATOR_GET_NEXT_TEST_P(TFRecordDatasetOpTest, TFRecordDatasetParams,
@@ -186,7 +241,18 @@ std::vector<SkipTestCase<TFRecordDatasetParams>> SkipTestCases() {
            /*expected_outputs=*/
            CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
           {/*dataset_params=*/TFRecordDatasetParams3(),
-           /*num_to_skip*/ 7, /*expected_num_skipped*/ 6}};
+           /*num_to_skip*/ 7, /*expected_num_skipped*/ 6},
+
+          {/*dataset_params=*/TFRecordDatasetParams4(),
+           /*num_to_skip*/ 2, /*expected_num_skipped*/ 2, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"333"}})},
+          {/*dataset_params=*/TFRecordDatasetParams4(),
+           /*num_to_skip*/ 5, /*expected_num_skipped*/ 5, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"ccc"}})},
+          {/*dataset_params=*/TFRecordDatasetParams4(),
+           /*num_to_skip*/ 8, /*expected_num_skipped*/ 7}};
 }
 
 ITERATOR_SKIP_TEST_P(TFRecordDatasetOpTest, TFRecordDatasetParams,
@@ -223,6 +289,57 @@ TEST_F(TFRecordDatasetOpTest, Cardinality) {
   TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
 }
 
+TEST_F(TFRecordDatasetOpTest, IndexedCardinality) {
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(7));
+}
+
+TEST_F(TFRecordDatasetOpTest, IndexedRandomAccess) {
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(dataset_->RandomIndexingCompatible());
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(dataset_->Get(iterator_ctx_.get(), 5, &out_tensors));
+  test::ExpectEqual(CreateTensor<tstring>(TensorShape({}), {"ccc"}),
+                    out_tensors[0]);
+  TF_ASSERT_OK(dataset_->Get(iterator_ctx_.get(), 1, &out_tensors));
+  test::ExpectEqual(CreateTensor<tstring>(TensorShape({}), {"22"}),
+                    out_tensors[0]);
+  EXPECT_TRUE(errors::IsOutOfRange(
+      dataset_->Get(iterator_ctx_.get(), 7, &out_tensors)));
+}
+
+TEST_F(TFRecordDatasetOpTest, IndexedSplitProvider) {
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_EXPECT_OK(CheckSplitProviderFullIteration(
+      dataset_params,
+      CreateTensors<tstring>(TensorShape({}), {{"1"},
+                                               {"22"},
+                                               {"333"},
+                                               {"a"},
+                                               {"bb"},
+                                               {"ccc"},
+                                               {"dddd"}})));
+  // Each split is a block of two records.
+  TF_EXPECT_OK(CheckSplitProviderShardedIteration(
+      dataset_params, /*num_shards=*/2, /*shard_index=*/1,
+      CreateTensors<tstring>(TensorShape({}),
+                             {{"333"}, {"ccc"}, {"dddd"}})));
+}
+
+TEST_F(TFRecordDatasetOpTest, IndexRequired) {
+  // Writes the files without offset indices.
+  TFRecordDatasetParams3();
+  auto dataset_params = TFRecordDatasetParams(
+      {absl::StrCat(testing::TmpDir(), "/tf_record_UNCOMPRESSED_1")},
+      /*compression_type=*/CompressionType::UNCOMPRESSED,
+      /*buffer_size=*/10,
+      /*node_name=*/kNodeName,
+      /*use_offset_index=*/true);
+  EXPECT_TRUE(errors::IsNotFound(Initialize(dataset_params)));
+}
+
 TEST_F(TFRecordDatasetOpTest, IteratorOutputDtypes) {
   auto dataset_params = TFRecordDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -257,7 +374,16 @@ IteratorSaveAndRestoreTestCases() {
       {/*dataset_params=*/TFRecordDatasetParams3(),
        /*breakpoints=*/{0, 2, 7},
        CreateTensors<tstring>(
-           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams4(),
+       /*breakpoints=*/{0, 3, 5, 8},
+       CreateTensors<tstring>(TensorShape({}), {{"1"},
+                                                {"22"},
+                                                {"333"},
+                                                {"a"},
+                                                {"bb"},
+                                                {"ccc"},
+                                                {"dddd"}})}};
 }
 
 ITERATOR_SAVE_AND_RESTORE_TEST_P(TFRecordDatasetOpTest, TFRecordDatasetParams,
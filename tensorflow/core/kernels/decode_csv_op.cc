@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 // See docs in ../ops/parsing_ops.cc.
+#include <deque>
 #include <vector>
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -81,10 +82,17 @@ class DecodeCSVOp : public OpKernel {
       OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
     }
 
+    // Fields point into the records, or into `unescaped_fields` for quoted
+    // fields with escaped quotes, so that each string field is copied once,
+    // into the output.
+    std::vector<StringPiece> fields;
+    std::deque<string> unescaped_fields;
     for (int64 i = 0; i < records_size; ++i) {
       const StringPiece record(records_t(i));
-      std::vector<string> fields;
-      ExtractFields(ctx, record, &fields);
+      fields.clear();
+      unescaped_fields.clear();
+      ExtractFields(ctx, record, &fields, &unescaped_fields);
+      if (!ctx->status().ok()) return;
       OP_REQUIRES(ctx, fields.size() == out_type_.size(),
                   errors::InvalidArgument("Expect ", out_type_.size(),
                                           " fields but have ", fields.size(),
@@ -184,7 +192,8 @@ class DecodeCSVOp : public OpKernel {
               output[f]->flat<tstring>()(i) =
                   record_defaults[f].flat<tstring>()(0);
             } else {
-              output[f]->flat<tstring>()(i) = std::move(fields[f]);
+              output[f]->flat<tstring>()(i).assign(fields[f].data(),
+                                                   fields[f].size());
             }
             break;
           }
@@ -205,8 +214,12 @@ class DecodeCSVOp : public OpKernel {
   bool select_all_cols_;
   string na_value_;
 
+  // Appends the selected fields of `input` to `result`. Fields with escaped
+  // quotes are unescaped into `unescaped_fields`, the others point into
+  // `input`.
   void ExtractFields(OpKernelContext* ctx, StringPiece input,
-                     std::vector<string>* result) {
+                     std::vector<StringPiece>* result,
+                     std::deque<string>* unescaped_fields) {
     int64 current_idx = 0;
     int64 num_fields_parsed = 0;
     int64 selector_idx = 0;  // Keep track of index into select_cols
@@ -229,7 +242,8 @@ class DecodeCSVOp : public OpKernel {
         }
 
         // This is the body of the field;
-        string field;
+        StringPiece field;
+        const int64 field_start = current_idx;
         if (!quoted) {
           while (static_cast<size_t>(current_idx) < input.size() &&
                  input[current_idx] != delim_) {
@@ -239,29 +253,41 @@ class DecodeCSVOp : public OpKernel {
                             input[current_idx] != '\r',
                         errors::InvalidArgument(
                             "Unquoted fields cannot have quotes/CRLFs inside"));
-            if (include) field += input[current_idx];
             current_idx++;
           }
+          field = input.substr(field_start, current_idx - field_start);
 
           // Go to next field or the end
           current_idx++;
         } else if (use_quote_delim_) {
           // Quoted field needs to be ended with '"' and delim or end
+          bool has_escaped_quotes = false;
           while (
               (static_cast<size_t>(current_idx) < input.size() - 1) &&
               (input[current_idx] != '"' || input[current_idx + 1] != delim_)) {
             if (input[current_idx] != '"') {
-              if (include) field += input[current_idx];
               current_idx++;
             } else {
               OP_REQUIRES(
                   ctx, input[current_idx + 1] == '"',
                   errors::InvalidArgument("Quote inside a string has to be "
                                           "escaped by another quote"));
-              if (include) field += '"';
+              has_escaped_quotes = true;
               current_idx += 2;
             }
           }
+          field = input.substr(field_start, current_idx - field_start);
+          if (include && has_escaped_quotes) {
+            string unescaped;
+            unescaped.reserve(field.size());
+            for (size_t j = 0; j < field.size(); ++j) {
+              unescaped += field[j];
+              // Quotes within the field always come in pairs.
+              if (field[j] == '"') ++j;
+            }
+            unescaped_fields->push_back(std::move(unescaped));
+            field = unescaped_fields->back();
+          }
 
           OP_REQUIRES(
               ctx,
@@ -288,7 +314,7 @@ class DecodeCSVOp : public OpKernel {
                                    static_cast<size_t>(num_fields_parsed));
       // Check if the last field is missing
       if (include && input[input.size() - 1] == delim_)
-        result->push_back(string());
+        result->push_back(StringPiece());
     }
   }
 };
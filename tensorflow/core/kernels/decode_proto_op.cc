@@ -27,6 +27,8 @@ limitations under the License.
 // are available at runtime but should be competitive in speed with approaches
 // that compile in the proto definitions.
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -44,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/util/proto/descriptors.h"
 #include "tensorflow/core/util/proto/proto_utils.h"
 #include "tensorflow/core/util/ptr_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -60,6 +63,14 @@ using ::tensorflow::protobuf::io::CodedInputStream;
 
 const bool kFailOnDecodeError = true;
 
+// Largest requested field number for which fields are looked up by a table
+// indexed by field number rather than by a search of the sorted fields.
+const int kMaxFieldNumberForLookupTable = 4096;
+
+// Rough cost of decoding a byte of a serialized message, used to shard the
+// decoding of a batch over the intra-op threads.
+const int64 kDecodeCostPerByte = 20;
+
 // Used to store the default value of a protocol message field, casted to the
 // type of the output tensor.
 //
@@ -703,6 +714,19 @@ class DecodeProtoOp : public OpKernel {
           MakeUnique<FieldInfo>(field_descriptor, output_index, default_value));
     }
 
+    // Messages are decoded with a jump table from field number to field, as
+    // long as the requested field numbers are small, which is usual.
+    if (!fields_.empty() &&
+        fields_.back()->number <= kMaxFieldNumberForLookupTable) {
+      field_index_by_number_.assign(fields_.back()->number + 1, -1);
+      for (int fi = 0; fi < fields_.size(); ++fi) {
+        // If a field is requested twice, only its first output is decoded,
+        // as with the search of the sorted fields.
+        int& index = field_index_by_number_[fields_[fi]->number];
+        if (index == -1) index = fi;
+      }
+    }
+
     message_prototype_ = message_factory_.GetPrototype(message_desc);
     OP_REQUIRES(context, message_prototype_ != nullptr,
                 errors::InvalidArgument("Couldn't get prototype message: ",
@@ -775,11 +799,21 @@ class DecodeProtoOp : public OpKernel {
     // conditional when handling the output data. The caller can distinguish
     // between real data and defaults using the repeat count matrix that is
     // returned by decode_proto.
+    std::vector<Status> statuses(message_count);
+    ForEachMessage(ctx, bufs, [&](int64 start, int64 limit) {
+      for (int64 mi = start; mi < limit; ++mi) {
+        statuses[mi] = CountFields(mi, *bufs[mi], sizes_tensor);
+      }
+    });
+    for (const Status& status : statuses) {
+      OP_REQUIRES_OK(ctx, status);
+    }
     std::vector<int32> max_sizes(field_count, 1);
+    auto sizes = sizes_tensor->flat_inner_dims<int32>();
     for (int mi = 0; mi < message_count; ++mi) {
-      CountFields(ctx, mi, *bufs[mi], sizes_tensor, &max_sizes);
-      if (!ctx->status().ok()) {
-        return;
+      for (int fi = 0; fi < field_count; ++fi) {
+        max_sizes[fi] =
+            std::max(max_sizes[fi], sizes(mi, fields_[fi]->output_index));
       }
     }
 
@@ -830,9 +864,27 @@ class DecodeProtoOp : public OpKernel {
                 errors::DataLoss("Unable to reserialize text proto as binary"));
   }
 
-  // Count the number of occurrences of each requested field in a message batch.
-  void CountFields(OpKernelContext* ctx, int message_index, const tstring& buf,
-                   Tensor* sizes_tensor, std::vector<int32>* max_sizes) {
+  // Runs `fn` on ranges of message indices, in parallel on the intra-op
+  // threads. Messages are independent, and the decoding of each writes only to
+  // its own rows of the outputs.
+  void ForEachMessage(OpKernelContext* ctx,
+                      const std::vector<const tstring*>& bufs,
+                      const std::function<void(int64, int64)>& fn) {
+    int64 total_bytes = 0;
+    for (const tstring* buf : bufs) {
+      total_bytes += buf->size();
+    }
+    const int64 cost_per_message =
+        kDecodeCostPerByte * (total_bytes / bufs.size() + 1);
+    auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, bufs.size(),
+          cost_per_message, fn);
+  }
+
+  // Count the number of occurrences of each requested field in a message, and
+  // write them to the row of the message in the sizes tensor.
+  Status CountFields(int message_index, const tstring& buf,
+                     Tensor* sizes_tensor) {
     int field_count = fields_.size();
 
     CodedInputStream input(reinterpret_cast<const uint8*>(buf.c_str()),
@@ -850,7 +902,7 @@ class DecodeProtoOp : public OpKernel {
       st = errors::DataLoss("CountFields: Failed to consume entire buffer");
     }
     if (kFailOnDecodeError) {
-      OP_REQUIRES_OK(ctx, st);  // NOLINT
+      TF_RETURN_IF_ERROR(st);  // NOLINT
     }
     if (!st.ok()) {
       // This code suppresses the corrupt proto, treating it as empty
@@ -861,19 +913,14 @@ class DecodeProtoOp : public OpKernel {
       for (int fi = 0; fi < field_count; fi++) {
         field_sizes[fi] = 0;
       }
-      // Finished decoding this message.
-      return;
     }
 
-    // Update the size tensor and max repeat size for each field.
+    // Update the size tensor for each field.
     auto sizes = sizes_tensor->flat_inner_dims<int32>();
     for (int fi = 0; fi < field_count; fi++) {
-      int32 size = field_sizes[fi];
-      sizes(message_index, fields_[fi]->output_index) = size;
-      if ((*max_sizes)[fi] < size) {
-        (*max_sizes)[fi] = size;
-      }
+      sizes(message_index, fields_[fi]->output_index) = field_sizes[fi];
     }
+    return Status::OK();
   }
 
   // Parse fields from a serialized message into preallocated tensors.
@@ -917,7 +964,7 @@ class DecodeProtoOp : public OpKernel {
       tensors.emplace_back(outputs[fi]);
     }
 
-    for (int message_index = 0; message_index < bufs.size(); ++message_index) {
+    auto accumulate_message = [&](int message_index) -> Status {
       const tstring& buf = *bufs[message_index];
 
       std::vector<DenseCollector> collectors;
@@ -940,7 +987,7 @@ class DecodeProtoOp : public OpKernel {
             "AccumulateFields: Failed to consume entire buffer");
       }
       if (kFailOnDecodeError) {
-        OP_REQUIRES_OK(ctx, st);  // NOLINT
+        TF_RETURN_IF_ERROR(st);  // NOLINT
       }
       if (!st.ok()) {
         // This code suppresses the corrupt proto, treating it as empty
@@ -951,8 +998,19 @@ class DecodeProtoOp : public OpKernel {
 
       // Fill the remainder of the dense outputs with default values.
       for (auto& collector : collectors) {
-        OP_REQUIRES_OK(ctx, collector.FillWithDefaults());
+        TF_RETURN_IF_ERROR(collector.FillWithDefaults());
+      }
+      return Status::OK();
+    };
+
+    std::vector<Status> statuses(bufs.size());
+    ForEachMessage(ctx, bufs, [&](int64 start, int64 limit) {
+      for (int64 mi = start; mi < limit; ++mi) {
+        statuses[mi] = accumulate_message(mi);
       }
+    });
+    for (const Status& status : statuses) {
+      OP_REQUIRES_OK(ctx, status);
     }
   }
 
@@ -983,6 +1041,25 @@ class DecodeProtoOp : public OpKernel {
 
       // The field wire number.
       const int field_number = WireFormatLite::GetTagFieldNumber(tag);
+
+      if (!field_index_by_number_.empty()) {
+        const int field_index =
+            field_number < field_index_by_number_.size()
+                ? field_index_by_number_[field_number]
+                : -1;
+        if (field_index == -1) {
+          // Unknown and unrequested fields are skipped.
+          if (!WireFormatLite::SkipField(input, tag)) {
+            return errors::DataLoss("Failed skipping unrequested field");
+          }
+          continue;
+        }
+        TF_RETURN_IF_ERROR(CollectField(*fields_[field_index],
+                                        WireFormatLite::GetTagWireType(tag),
+                                        input, &collectors[field_index]));
+        continue;
+      }
+
       // The field info associated with the field wire number.
       const FieldInfo* field_info = nullptr;
 
@@ -1084,6 +1161,10 @@ class DecodeProtoOp : public OpKernel {
   // general the order given by the user-specified field_names and output_types
   // Op attributes.
   std::vector<std::unique_ptr<const FieldInfo>> fields_;
+  // Index in fields_ of the field with each number, or -1 for fields that are
+  // not requested. Empty if the requested field numbers are too large for a
+  // table, in which case fields_ is searched instead.
+  std::vector<int> field_index_by_number_;
 
   // Owned_desc_pool_ is null when using descriptor_source=local.
   std::unique_ptr<DescriptorPool> owned_desc_pool_;
@@ -15,7 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/eigen_contraction_kernel.h"
 
+#include <algorithm>
+#include <atomic>
 #include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
 
 #include "absl/base/call_once.h"
 
@@ -62,6 +66,124 @@ EIGEN_DEVICE_FUNC EIGEN_DONT_INLINE bool UseCustomContractionKernels() {
   return use_custom_contraction_kernel;
 }
 
+namespace {
+
+// Blocks of constant inputs used by at most this many gemm kernels are passed
+// in place. The packed copy of a block is contiguous, and each kernel that
+// reads a block in place pays for its strided access again, so packing wins
+// once a block is shared by enough kernels even though it is redone on every
+// contraction.
+constexpr int64_t kMaxKernelsForInPlaceConstantBlocks = 4;
+
+// Address ranges of the registered constant contraction inputs, sorted by
+// their start address.
+using ConstantRanges = std::vector<std::pair<const char*, size_t>>;
+
+// Readers load an immutable snapshot of the ranges without locking. Updates
+// publish a new snapshot, and free old ones once no reader is active.
+struct ConstantContractionInputs {
+  // Current snapshot, or nullptr when no input is registered.
+  std::atomic<const ConstantRanges*> ranges{nullptr};
+  // Number of readers that may still hold a snapshot.
+  std::atomic<int> readers{0};
+
+  // Serializes updates.
+  std::mutex mu;
+  // Replaced snapshots that may still be read.
+  std::vector<const ConstantRanges*> retired;
+};
+
+ConstantContractionInputs* GetConstantContractionInputs() {
+  static ConstantContractionInputs* inputs = new ConstantContractionInputs();
+  return inputs;
+}
+
+// Replaces the snapshot of `inputs` with `ranges`. Requires `inputs->mu`.
+void PublishConstantRanges(ConstantContractionInputs* inputs,
+                           ConstantRanges ranges) {
+  const ConstantRanges* snapshot =
+      ranges.empty() ? nullptr : new ConstantRanges(std::move(ranges));
+  const ConstantRanges* old = inputs->ranges.exchange(snapshot);
+  if (old != nullptr) inputs->retired.push_back(old);
+  // Readers that start after the exchange see the new snapshot, so with no
+  // active readers nobody holds a retired one.
+  if (inputs->readers.load() == 0) {
+    for (const ConstantRanges* retired : inputs->retired) delete retired;
+    inputs->retired.clear();
+  }
+}
+
+// Number of blocks passed in place by the calling thread because they belong
+// to a constant input.
+thread_local int64_t num_in_place_constant_blocks = 0;
+
+}  // namespace
+
+void RegisterConstantContractionInput(const void* data, size_t size) {
+  if (data == nullptr || size == 0) return;
+  const char* begin = static_cast<const char*>(data);
+  ConstantContractionInputs* inputs = GetConstantContractionInputs();
+  std::lock_guard<std::mutex> lock(inputs->mu);
+  const ConstantRanges* current = inputs->ranges.load();
+  ConstantRanges ranges = current ? *current : ConstantRanges();
+  auto it = std::lower_bound(ranges.begin(), ranges.end(),
+                             std::make_pair(begin, size_t{0}));
+  if (it != ranges.end() && it->first == begin) {
+    it->second = size;
+  } else {
+    ranges.insert(it, {begin, size});
+  }
+  PublishConstantRanges(inputs, std::move(ranges));
+}
+
+void UnregisterConstantContractionInput(const void* data) {
+  const char* begin = static_cast<const char*>(data);
+  ConstantContractionInputs* inputs = GetConstantContractionInputs();
+  std::lock_guard<std::mutex> lock(inputs->mu);
+  const ConstantRanges* current = inputs->ranges.load();
+  if (current == nullptr) return;
+  ConstantRanges ranges = *current;
+  auto it = std::lower_bound(ranges.begin(), ranges.end(),
+                             std::make_pair(begin, size_t{0}));
+  if (it == ranges.end() || it->first != begin) return;
+  ranges.erase(it);
+  PublishConstantRanges(inputs, std::move(ranges));
+}
+
+EIGEN_DEVICE_FUNC EIGEN_DONT_INLINE bool IsConstantContractionInput(
+    const void* data) {
+  ConstantContractionInputs* inputs = GetConstantContractionInputs();
+  if (inputs->ranges.load(std::memory_order_relaxed) == nullptr) return false;
+
+  const char* ptr = static_cast<const char*>(data);
+  inputs->readers.fetch_add(1);
+  const ConstantRanges* ranges = inputs->ranges.load();
+  bool found = false;
+  if (ranges != nullptr) {
+    auto it = std::upper_bound(
+        ranges->begin(), ranges->end(), ptr,
+        [](const char* p, const std::pair<const char*, size_t>& range) {
+          return p < range.first;
+        });
+    if (it != ranges->begin()) {
+      --it;
+      found = ptr < it->first + it->second;
+    }
+  }
+  inputs->readers.fetch_sub(1, std::memory_order_release);
+  return found;
+}
+
+EIGEN_DEVICE_FUNC EIGEN_DONT_INLINE bool UseInPlaceConstantBlock(
+    const void* data, int64_t num_kernels) {
+  if (num_kernels > kMaxKernelsForInPlaceConstantBlocks) return false;
+  if (!IsConstantContractionInput(data)) return false;
+  ++num_in_place_constant_blocks;
+  return true;
+}
+
+int64_t NumInPlaceConstantBlocks() { return num_in_place_constant_blocks; }
+
 }  // namespace internal
 }  // namespace Eigen
 #endif
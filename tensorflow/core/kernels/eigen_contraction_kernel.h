@@ -53,6 +53,28 @@ namespace internal {
 // check, that uses environment variables.
 EIGEN_DEVICE_FUNC EIGEN_DONT_INLINE bool UseCustomContractionKernels();
 
+// Registers `size` bytes at `data` as a contraction input that does not change
+// between contractions, e.g. the weights of a constant. Blocks of registered
+// inputs are passed to the gemm kernel in place instead of being packed again
+// on every contraction. Must be unregistered before the memory is freed.
+void RegisterConstantContractionInput(const void* data, size_t size);
+void UnregisterConstantContractionInput(const void* data);
+
+// Returns `true` iff `data` points into a registered constant input. The
+// lookup does not lock.
+EIGEN_DEVICE_FUNC EIGEN_DONT_INLINE bool IsConstantContractionInput(
+    const void* data);
+
+// Returns `true` iff a block at `data`, that will be used by `num_kernels` gemm
+// kernels, should be passed in place because it belongs to a registered
+// constant input. Blocks used by many kernels are still packed.
+EIGEN_DEVICE_FUNC EIGEN_DONT_INLINE bool UseInPlaceConstantBlock(
+    const void* data, int64_t num_kernels);
+
+// Returns the number of blocks for which UseInPlaceConstantBlock returned
+// `true` on the calling thread. For tests.
+int64_t NumInPlaceConstantBlocks();
+
 // Pack a 2D block of a Tensor expression into contiguous block of memory with
 // col-major storage order. We do not have access to the underlying Tensor
 // expression, we only have a DataMapper (TensorContractionInputMapper for
@@ -410,6 +432,8 @@ struct DirectColMajorAccess {
 // skip packing if:
 //   (1) Packing is a no-op.
 //   (2) Packed block will be used just once.
+//   (3) The input is a registered constant, that would otherwise be packed
+//       again by every contraction, and the block is used by a few kernels.
 //
 // If a packed block is used many times, it's more efficient to pack it into
 // contiguous block of memory to reduce pressure on TLB.
@@ -450,7 +474,8 @@ struct DirectColMajorAccess {
       const bool use_direct_access =                                           \
           is_no_op_packing || num_kernels == 1 /* used once */ ||              \
           ((num_kernels == 2) &&                                               \
-           (addressable_mem < (256 << 10) /* 256 kb */));                      \
+           (addressable_mem < (256 << 10) /* 256 kb */)) ||                    \
+          UseInPlaceConstantBlock(data, num_kernels);                          \
                                                                                \
       if (use_direct_access) {                                                 \
         block->is_direct_access = true;                                        \
@@ -214,5 +214,68 @@ TEST(EigenMkldnnTest, MkldnnGemmQInt8xQUInt8) {
   }
 }
 
+TEST(EigenMkldnnTest, ConstantContractionInput) {
+  using Tensor2d = Tensor<Scalar, 2, ColMajor, Index>;
+
+  Tensor2d weights(300, 200);
+  weights.setRandom();
+  Tensor2d input(4, 300);
+
+  const size_t size = weights.size() * sizeof(Scalar);
+  RegisterConstantContractionInput(weights.data(), size);
+  EXPECT_TRUE(IsConstantContractionInput(weights.data()));
+  EXPECT_TRUE(IsConstantContractionInput(weights.data() + 1000));
+  EXPECT_FALSE(IsConstantContractionInput(weights.data() + weights.size()));
+  EXPECT_FALSE(IsConstantContractionInput(input.data()));
+
+  // Blocks shared by many kernels are still packed.
+  EXPECT_TRUE(UseInPlaceConstantBlock(weights.data(), 2));
+  EXPECT_FALSE(UseInPlaceConstantBlock(weights.data(), 64));
+  EXPECT_FALSE(UseInPlaceConstantBlock(input.data(), 2));
+
+  UnregisterConstantContractionInput(weights.data());
+  EXPECT_FALSE(IsConstantContractionInput(weights.data()));
+  EXPECT_FALSE(UseInPlaceConstantBlock(weights.data(), 2));
+}
+
+TEST(EigenMkldnnTest, ConstantContractionInputIsReadInPlace) {
+  using Tensor2d = Tensor<Scalar, 2, ColMajor, Index>;
+
+  // Pick sizes for which each block of the weights is a strided view used by
+  // two kernels, so that only the constant input rule reads it in place.
+  const Index k = 2048;
+  const Index n = 256;
+  TensorContractionBlocking<Scalar, Scalar, Scalar, Index, ShardByCol>
+      large_m(k, 4096, n, /*num_threads=*/1);
+  const Index m = 2 * large_m.mc();
+  TensorContractionBlocking<Scalar, Scalar, Scalar, Index, ShardByCol>
+      blocking(k, m, n, /*num_threads=*/1);
+  ASSERT_LT(blocking.kc(), k);
+  ASSERT_EQ(divup(m, blocking.mc()), 2);
+
+  Tensor2d input(m, k);
+  input.setRandom();
+  Tensor2d weights(k, n);
+  weights.setRandom();
+
+  Eigen::array<Eigen::IndexPair<Index>, 1> contract_dims;
+  contract_dims[0] = Eigen::IndexPair<Index>(1, 0);
+  Tensor2d expected = input.contract(weights, contract_dims);
+
+  const int64_t num_blocks = NumInPlaceConstantBlocks();
+  RegisterConstantContractionInput(weights.data(),
+                                   weights.size() * sizeof(Scalar));
+  Tensor2d result = input.contract(weights, contract_dims);
+  UnregisterConstantContractionInput(weights.data());
+  EXPECT_GT(NumInPlaceConstantBlocks(), num_blocks);
+
+  // Reading the weights in place gives the same results as packing them.
+  for (Index i = 0; i < result.dimension(0); ++i) {
+    for (Index j = 0; j < result.dimension(1); ++j) {
+      EXPECT_NEAR(result(i, j), expected(i, j), 1e-2);
+    }
+  }
+}
+
 }  // namespace internal
 }  // namespace Eigen
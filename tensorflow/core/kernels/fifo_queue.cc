@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <deque>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -107,6 +108,23 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     return;
   }
 
+  // Split the batch into elements before taking the lock, so that other
+  // enqueuers and dequeuers are not held up by the copies.
+  auto elements = std::make_shared<std::vector<Tuple>>(batch_size);
+  for (int64 index = 0; index < batch_size; ++index) {
+    Tuple& element = (*elements)[index];
+    element.resize(num_components());
+    for (int i = 0; i < num_components(); ++i) {
+      Status s =
+          GetElementComponentFromBatch(tuple, index, i, ctx, &element[i]);
+      if (!s.ok()) {
+        ctx->SetStatus(s);
+        callback();
+        return;
+      }
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -117,7 +135,7 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     if (!already_cancelled) {
       enqueue_attempts_.emplace_back(
           batch_size, callback, ctx, cm, token,
-          [tuple, this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          [elements, this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
             if (closed_) {
               attempt->context->SetStatus(
                   errors::Cancelled("FIFOQueue '", name_, "' is closed."));
@@ -127,13 +145,10 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
             while (queues_[0].size() < static_cast<size_t>(capacity_)) {
               result = kProgress;
               const int64 index =
-                  tuple[0].dim_size(0) - attempt->elements_requested;
+                  elements->size() - attempt->elements_requested;
+              Tuple& element = (*elements)[index];
               for (int i = 0; i < num_components(); ++i) {
-                Tensor element;
-                attempt->context->SetStatus(GetElementComponentFromBatch(
-                    tuple, index, i, attempt->context, &element));
-                if (!attempt->context->status().ok()) return kComplete;
-                queues_[i].push_back(element);
+                queues_[i].push_back(std::move(element[i]));
               }
               --attempt->elements_requested;
               if (attempt->elements_requested == 0) {
@@ -252,41 +267,29 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
     already_cancelled = !cm->RegisterCallback(
         token, [this, cm, token]() { Cancel(kDequeue, cm, token); });
     if (!already_cancelled) {
+      // The elements taken off the queue so far. They are only copied into
+      // the output batch once the attempt completes, outside the lock.
+      auto dequeued = std::make_shared<std::vector<Tuple>>();
       // TODO(josh11b): This makes two copies of callback, avoid this if possible.
       dequeue_attempts_.emplace_back(
           num_elements, [callback]() { callback(Tuple()); }, ctx, cm, token,
-          [callback, allow_small_batch,
+          [callback, allow_small_batch, dequeued,
            this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
             int64 queue_size = queues_[0].size();
 
             if (closed_ && queue_size < attempt->elements_requested) {
-              // If we don't have enough for a full dequeue, we have
-              // to reset the attempt tuple.
-              if (!attempt->tuple.empty()) {
-                // Restore already-dequeued elements to the front of the
-                // queue.
-                for (int64 i = attempt->tuple[0].dim_size(0) -
-                               attempt->elements_requested - 1;
-                     i >= 0; --i) {
-                  for (int j = 0; j < num_components(); ++j) {
-                    Tensor element;
-                    Status s = GetElementComponentFromBatch(
-                        attempt->tuple, i, j, attempt->context, &element);
-                    if (!s.ok()) {
-                      attempt->context->SetStatus(
-                          errors::DataLoss("Failed to restore element from "
-                                           "partially-dequeued batch "
-                                           "to FIFOQueue: ",
-                                           s.error_message()));
-                    }
-                    queues_[j].push_front(element);
-                  }
+              // If we don't have enough for a full dequeue, restore the
+              // already-dequeued elements to the front of the queue.
+              for (auto it = dequeued->rbegin(); it != dequeued->rend(); ++it) {
+                for (int j = 0; j < num_components(); ++j) {
+                  queues_[j].push_front(std::move((*it)[j]));
                 }
               }
-              if (allow_small_batch && !queues_[0].empty()) {
+              attempt->elements_requested += dequeued->size();
+              dequeued->clear();
+              queue_size = queues_[0].size();
+              if (allow_small_batch && queue_size > 0) {
                 // Request all remaining elements in the queue.
-                queue_size = queues_[0].size();
-                attempt->tuple.clear();
                 attempt->elements_requested = queue_size;
               } else {
                 if (allow_small_batch) {
@@ -308,36 +311,19 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
 
             RunResult result = kNoProgress;
             for (; queue_size > 0; --queue_size) {
-              if (attempt->tuple.empty()) {
-                // Only allocate tuple when we have something to dequeue
-                // so we don't use excessive memory when there are many
-                // blocked dequeue attempts waiting.
-                attempt->tuple.reserve(num_components());
-                for (int i = 0; i < num_components(); ++i) {
-                  const TensorShape shape =
-                      ManyOutShape(i, attempt->elements_requested);
-                  Tensor element;
-                  attempt->context->SetStatus(attempt->context->allocate_temp(
-                      component_dtypes_[i], shape, &element));
-                  if (!attempt->context->status().ok()) return kComplete;
-                  attempt->tuple.emplace_back(element);
-                }
-              }
               result = kProgress;
-              Tuple tuple;
-              DequeueLocked(attempt->context, &tuple);
-              const int64 index =
-                  attempt->tuple[0].dim_size(0) - attempt->elements_requested;
-              for (int i = 0; i < num_components(); ++i) {
-                attempt->context->SetStatus(batch_util::CopyElementToSlice(
-                    std::move(tuple[i]), &attempt->tuple[i], index));
-                if (!attempt->context->status().ok()) return kComplete;
-              }
-              tuple.clear();
+              dequeued->emplace_back();
+              DequeueLocked(attempt->context, &dequeued->back());
               --attempt->elements_requested;
               if (attempt->elements_requested == 0) {
-                tuple = attempt->tuple;
-                attempt->done_callback = [callback, tuple]() {
+                OpKernelContext* ctx = attempt->context;
+                attempt->done_callback = [callback, dequeued, ctx, this]() {
+                  Tuple tuple;
+                  Status s = BatchElements(ctx, dequeued.get(), &tuple);
+                  if (!s.ok()) {
+                    ctx->SetStatus(s);
+                    tuple.clear();
+                  }
                   callback(tuple);
                 };
                 return kComplete;
@@ -355,6 +341,23 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
   }
 }
 
+Status FIFOQueue::BatchElements(OpKernelContext* ctx,
+                                std::vector<Tuple>* elements, Tuple* batch) {
+  const int64 batch_size = elements->size();
+  batch->reserve(num_components());
+  for (int i = 0; i < num_components(); ++i) {
+    Tensor component;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        component_dtypes_[i], ManyOutShape(i, batch_size), &component));
+    for (int64 index = 0; index < batch_size; ++index) {
+      TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+          std::move((*elements)[index][i]), &component, index));
+    }
+    batch->push_back(std::move(component));
+  }
+  return Status::OK();
+}
+
 Status FIFOQueue::MatchesNodeDef(const NodeDef& node_def) {
   if (!MatchesNodeDefOp(node_def, "FIFOQueue").ok() &&
       !MatchesNodeDefOp(node_def, "FIFOQueueV2").ok()) {
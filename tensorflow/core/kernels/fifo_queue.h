@@ -67,6 +67,11 @@ class FIFOQueue : public TypedQueue<std::deque<Tensor> > {
                                              Tensor* out_tensor);
 
  private:
+  // Stacks the dequeued 'elements' into one tensor per component in 'batch'.
+  // Moves from 'elements'.
+  Status BatchElements(OpKernelContext* ctx, std::vector<Tuple>* elements,
+                       Tuple* batch);
+
   TF_DISALLOW_COPY_AND_ASSIGN(FIFOQueue);
 };
 
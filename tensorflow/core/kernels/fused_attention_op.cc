@@ -0,0 +1,332 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/fused_attention_op.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace functor {
+namespace {
+
+// The numbers of queries and keys of the blocks of scores that the CPU kernel
+// computes at once, which stay in the L2 cache for the usual head sizes.
+constexpr int64 kQueryBlockSize = 32;
+constexpr int64 kKeyBlockSize = 128;
+
+typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+    FloatMatrix;
+
+// Copies the `rows` x `cols` row-major matrix at `src` into `dst`.
+template <typename T>
+void LoadBlock(const T* src, int64 rows, int64 cols, FloatMatrix* dst) {
+  dst->resize(rows, cols);
+  float* data = dst->data();
+  for (int64 i = 0; i < rows * cols; ++i) {
+    data[i] = static_cast<float>(src[i]);
+  }
+}
+
+}  // namespace
+
+template <typename T>
+struct FusedAttention<CPUDevice, T> {
+  void operator()(const CPUDevice& d, const FusedAttentionParams& params,
+                  const T* query, const T* key, const T* value, const T* bias,
+                  T* output) {
+    const int64 query_length = params.query_length;
+    const int64 key_length = params.key_length;
+    const int64 head_size = params.head_size;
+    const int64 value_head_size = params.value_head_size;
+    const int64 num_query_blocks =
+        (query_length + kQueryBlockSize - 1) / kQueryBlockSize;
+    const Eigen::TensorOpCost cost(
+        sizeof(T) * (kQueryBlockSize * head_size +
+                     key_length * (head_size + value_head_size)),
+        sizeof(T) * kQueryBlockSize * value_head_size,
+        2.0 * kQueryBlockSize * key_length * (head_size + value_head_size));
+
+    // Each unit of work computes the output of a block of queries.
+    d.parallelFor(
+        params.batch * num_query_blocks, cost,
+        [&](Eigen::Index first, Eigen::Index last) {
+          FloatMatrix q, k, v, scores, acc;
+          Eigen::VectorXf max_score, sum;
+          for (Eigen::Index unit = first; unit < last; ++unit) {
+            const int64 b = unit / num_query_blocks;
+            const int64 q_begin = (unit % num_query_blocks) * kQueryBlockSize;
+            const int64 q_size =
+                std::min(kQueryBlockSize, query_length - q_begin);
+            const T* bias_b =
+                bias == nullptr ? nullptr
+                                : bias + (b / params.bias_batch_divisor) *
+                                             params.bias_batch_stride;
+
+            LoadBlock(query + (b * query_length + q_begin) * head_size,
+                      q_size, head_size, &q);
+            q *= params.scale;
+            acc.setZero(q_size, value_head_size);
+            max_score.setConstant(q_size,
+                                  -std::numeric_limits<float>::infinity());
+            sum.setZero(q_size);
+            for (int64 k_begin = 0; k_begin < key_length;
+                 k_begin += kKeyBlockSize) {
+              const int64 k_size =
+                  std::min(kKeyBlockSize, key_length - k_begin);
+              LoadBlock(key + (b * key_length + k_begin) * head_size, k_size,
+                        head_size, &k);
+              LoadBlock(value + (b * key_length + k_begin) * value_head_size,
+                        k_size, value_head_size, &v);
+              scores.noalias() = q * k.transpose();
+              if (bias_b != nullptr) {
+                for (int64 i = 0; i < q_size; ++i) {
+                  const T* bias_row =
+                      bias_b + (q_begin + i) * params.bias_query_stride +
+                      k_begin * params.bias_key_stride;
+                  for (int64 j = 0; j < k_size; ++j) {
+                    scores(i, j) += static_cast<float>(
+                        bias_row[j * params.bias_key_stride]);
+                  }
+                }
+              }
+              // Rescale the sums and outputs of the previous blocks to the
+              // new maximum scores.
+              for (int64 i = 0; i < q_size; ++i) {
+                const float new_max =
+                    std::max(max_score(i), scores.row(i).maxCoeff());
+                if (new_max == -std::numeric_limits<float>::infinity()) {
+                  // All the keys so far are masked out.
+                  scores.row(i).setZero();
+                  continue;
+                }
+                const float correction = std::exp(max_score(i) - new_max);
+                scores.row(i) = (scores.row(i).array() - new_max).exp();
+                sum(i) = sum(i) * correction + scores.row(i).sum();
+                acc.row(i) *= correction;
+                max_score(i) = new_max;
+              }
+              acc.noalias() += scores * v;
+            }
+
+            T* output_block =
+                output + (b * query_length + q_begin) * value_head_size;
+            for (int64 i = 0; i < q_size; ++i) {
+              for (int64 j = 0; j < value_head_size; ++j) {
+                output_block[i * value_head_size + j] =
+                    static_cast<T>(acc(i, j) / sum(i));
+              }
+            }
+          }
+        });
+  }
+};
+
+}  // namespace functor
+
+template <typename Device, typename T>
+class FusedAttentionOp : public OpKernel {
+ public:
+  explicit FusedAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale_));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    OP_REQUIRES(context, num_args <= 1,
+                errors::InvalidArgument(
+                    "_FusedAttention takes at most one bias, got ", num_args));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+    const int rank = query.dims();
+    OP_REQUIRES(context, rank >= 2,
+                errors::InvalidArgument(
+                    "query must have at least 2 dimensions: ",
+                    query.shape().DebugString()));
+    OP_REQUIRES(context, key.dims() == rank && value.dims() == rank,
+                errors::InvalidArgument(
+                    "query, key and value must have the same rank: ",
+                    query.shape().DebugString(), " vs. ",
+                    key.shape().DebugString(), " vs. ",
+                    value.shape().DebugString()));
+    FusedAttentionParams params;
+    params.batch = 1;
+    for (int i = 0; i < rank - 2; ++i) {
+      OP_REQUIRES(context,
+                  key.dim_size(i) == query.dim_size(i) &&
+                      value.dim_size(i) == query.dim_size(i),
+                  errors::InvalidArgument(
+                      "query, key and value must have the same batch "
+                      "dimensions: ",
+                      query.shape().DebugString(), " vs. ",
+                      key.shape().DebugString(), " vs. ",
+                      value.shape().DebugString()));
+      params.batch *= query.dim_size(i);
+    }
+    params.query_length = query.dim_size(rank - 2);
+    params.key_length = key.dim_size(rank - 2);
+    params.head_size = query.dim_size(rank - 1);
+    params.value_head_size = value.dim_size(rank - 1);
+    params.scale = scale_;
+    OP_REQUIRES(context, key.dim_size(rank - 1) == params.head_size,
+                errors::InvalidArgument(
+                    "query and key must have the same last dimension: ",
+                    query.shape().DebugString(), " vs. ",
+                    key.shape().DebugString()));
+    OP_REQUIRES(context, value.dim_size(rank - 2) == params.key_length,
+                errors::InvalidArgument(
+                    "key and value must have the same number of keys: ",
+                    key.shape().DebugString(), " vs. ",
+                    value.shape().DebugString()));
+    const T* bias = nullptr;
+    if (context->num_inputs() > 3) {
+      const Tensor& bias_tensor = context->input(3);
+      OP_REQUIRES_OK(context, GetBiasLayout(bias_tensor, query, &params));
+      bias = bias_tensor.flat<T>().data();
+    }
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+    if (std::is_same<Device, GPUDevice>::value) {
+      OP_REQUIRES(context,
+                  params.head_size <= kFusedAttentionMaxGpuHeadSize &&
+                      params.value_head_size <= kFusedAttentionMaxGpuHeadSize,
+                  errors::Unimplemented(
+                      "_FusedAttention supports head sizes of at most ",
+                      kFusedAttentionMaxGpuHeadSize, " on GPU, got ",
+                      params.head_size, " and ", params.value_head_size));
+    }
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+    TensorShape output_shape = query.shape();
+    output_shape.set_dim(rank - 1, params.value_head_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+    const Device& d = context->eigen_device<Device>();
+    if (params.key_length == 0) {
+      // The product of the empty scores and values.
+      functor::SetZeroFunctor<Device, T>()(d, output->flat<T>());
+      return;
+    }
+    functor::FusedAttention<Device, T>()(
+        d, params, query.flat<T>().data(), key.flat<T>().data(),
+        value.flat<T>().data(), bias, output->flat<T>().data());
+  }
+
+ private:
+  // Sets the layout of `bias` in `params`. Padded with leading dimensions of
+  // size 1 to the rank of the scores, `bias` must match the scores on some
+  // leading batch dimensions and have size 1 in the remaining ones, and must
+  // have size 1 or the size of the scores in the last two dimensions.
+  static Status GetBiasLayout(const Tensor& bias, const Tensor& query,
+                              FusedAttentionParams* params) {
+    const int rank = query.dims();
+    const auto error = [&]() {
+      return errors::InvalidArgument(
+          "bias can't be broadcast to the scores of query ",
+          query.shape().DebugString(), " and ", params->key_length,
+          " keys: ", bias.shape().DebugString());
+    };
+    if (bias.dims() > rank) return error();
+    const int offset = rank - bias.dims();
+    const auto bias_dim = [&](int i) -> int64 {
+      return i < offset ? 1 : bias.dim_size(i - offset);
+    };
+    int num_shared_dims = 0;
+    int64 num_bias_batches = 1;
+    while (num_shared_dims < rank - 2 &&
+           bias_dim(num_shared_dims) == query.dim_size(num_shared_dims)) {
+      num_bias_batches *= query.dim_size(num_shared_dims);
+      ++num_shared_dims;
+    }
+    for (int i = num_shared_dims; i < rank - 2; ++i) {
+      if (bias_dim(i) != 1) return error();
+    }
+    const int64 bias_queries = bias_dim(rank - 2);
+    const int64 bias_keys = bias_dim(rank - 1);
+    if ((bias_queries != 1 && bias_queries != params->query_length) ||
+        (bias_keys != 1 && bias_keys != params->key_length)) {
+      return error();
+    }
+    params->bias_batch_divisor =
+        num_bias_batches == 0 ? 1 : params->batch / num_bias_batches;
+    params->bias_batch_stride = bias_queries * bias_keys;
+    params->bias_query_stride = bias_queries == 1 ? 0 : bias_keys;
+    params->bias_key_stride = bias_keys == 1 ? 0 : 1;
+    return Status::OK();
+  }
+
+  float scale_;
+};
+
+#define REGISTER_KERNELS(DEVICE, TYPE)                          \
+  REGISTER_KERNEL_BUILDER(Name("_FusedAttention")               \
+                              .Device(DEVICE_##DEVICE)          \
+                              .TypeConstraint<TYPE>("T"),       \
+                          FusedAttentionOp<DEVICE##Device, TYPE>);
+
+#define REGISTER_CPU_KERNELS(TYPE) REGISTER_KERNELS(CPU, TYPE)
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Forward declarations of the functor specializations for GPU.
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                                   \
+  template <>                                                                 \
+  void FusedAttention<GPUDevice, T>::operator()(                              \
+      const GPUDevice& d, const FusedAttentionParams& params, const T* query, \
+      const T* key, const T* value, const T* bias, T* output);                \
+  extern template struct FusedAttention<GPUDevice, T>;
+
+TF_CALL_float(DECLARE_GPU_SPEC);
+TF_CALL_half(DECLARE_GPU_SPEC);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+#define REGISTER_GPU_KERNELS(TYPE) REGISTER_KERNELS(GPU, TYPE)
+TF_CALL_float(REGISTER_GPU_KERNELS);
+TF_CALL_half(REGISTER_GPU_KERNELS);
+#undef REGISTER_GPU_KERNELS
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#undef REGISTER_KERNELS
+
+}  // namespace tensorflow
@@ -0,0 +1,69 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_ATTENTION_OP_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_ATTENTION_OP_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The shapes of the inputs of _FusedAttention, with all the batch dimensions
+// flattened into one:
+//   query: batch, query_length, head_size.
+//   key: batch, key_length, head_size.
+//   value: batch, key_length, value_head_size.
+//   output: batch, query_length, value_head_size.
+// The bias of the scores of batch b starts at
+//   (b / bias_batch_divisor) * bias_batch_stride
+// and has the bias of query i and key j at
+//   i * bias_query_stride + j * bias_key_stride.
+struct FusedAttentionParams {
+  int64 batch = 0;
+  int64 query_length = 0;
+  int64 key_length = 0;
+  int64 head_size = 0;
+  int64 value_head_size = 0;
+  float scale = 1.0f;
+  int64 bias_batch_divisor = 1;
+  int64 bias_batch_stride = 0;
+  int64 bias_query_stride = 0;
+  int64 bias_key_stride = 0;
+};
+
+namespace functor {
+
+// Computes softmax(query * key^T * scale + bias) * value for each batch, with
+// a softmax that is updated online block by block of keys, so that the scores
+// are never materialized. `bias` is nullptr if there is none. The functor
+// computes in float for all types T, and only rounds its results to T.
+template <typename Device, typename T>
+struct FusedAttention {
+  void operator()(const Device& d, const FusedAttentionParams& params,
+                  const T* query, const T* key, const T* value, const T* bias,
+                  T* output);
+};
+
+}  // namespace functor
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// The largest head size that the GPU kernel supports, as it keeps a row of the
+// query and of the output in registers.
+constexpr int64 kFusedAttentionMaxGpuHeadSize = 128;
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_ATTENTION_OP_H_
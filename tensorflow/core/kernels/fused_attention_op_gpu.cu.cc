@@ -0,0 +1,196 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include <limits>
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/fused_attention_op.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace functor {
+namespace {
+
+constexpr int kWarpSize = 32;
+// Each warp computes the output of one query, and the warps of a block share
+// the tiles of keys and values that they load in shared memory. A tile has a
+// key per lane, so that each lane holds the score of one key.
+constexpr int kWarpsPerBlock = 4;
+constexpr int kKeysPerTile = kWarpSize;
+// The elements of a row of the query or of the output that each lane holds.
+constexpr int kElementsPerLane = kFusedAttentionMaxGpuHeadSize / kWarpSize;
+
+template <typename T>
+__global__ void __launch_bounds__(kWarpsPerBlock * kWarpSize)
+    FusedAttentionKernel(FusedAttentionParams params,
+                         const T* __restrict__ query, const T* __restrict__ key,
+                         const T* __restrict__ value,
+                         const T* __restrict__ bias, T* __restrict__ output) {
+  GPU_DYNAMIC_SHARED_MEM_DECL(sizeof(float), float, key_tile);
+  const int head_size = params.head_size;
+  const int value_head_size = params.value_head_size;
+  float* value_tile = key_tile + kKeysPerTile * head_size;
+
+  const int lane = threadIdx.x % kWarpSize;
+  const int64 num_query_blocks =
+      (params.query_length + kWarpsPerBlock - 1) / kWarpsPerBlock;
+  const int64 b = blockIdx.x / num_query_blocks;
+  const int64 i = (blockIdx.x % num_query_blocks) * kWarpsPerBlock +
+                  threadIdx.x / kWarpSize;
+  const bool active = i < params.query_length;
+  const float kInfinity = std::numeric_limits<float>::infinity();
+
+  float q[kElementsPerLane];
+  float acc[kElementsPerLane];
+#pragma unroll
+  for (int t = 0; t < kElementsPerLane; ++t) {
+    const int c = lane + t * kWarpSize;
+    q[t] = active && c < head_size
+               ? static_cast<float>(ldg(
+                     query + (b * params.query_length + i) * head_size + c)) *
+                     params.scale
+               : 0.0f;
+    acc[t] = 0.0f;
+  }
+  const T* bias_row = bias == nullptr
+                          ? nullptr
+                          : bias +
+                                (b / params.bias_batch_divisor) *
+                                    params.bias_batch_stride +
+                                i * params.bias_query_stride;
+  float max_score = -kInfinity;
+  float sum = 0.0f;
+
+  for (int64 k_begin = 0; k_begin < params.key_length;
+       k_begin += kKeysPerTile) {
+    const int k_size = min(static_cast<int64>(kKeysPerTile),
+                           params.key_length - k_begin);
+    __syncthreads();
+    const T* key_begin = key + (b * params.key_length + k_begin) * head_size;
+    for (int index = threadIdx.x; index < k_size * head_size;
+         index += blockDim.x) {
+      key_tile[index] = static_cast<float>(ldg(key_begin + index));
+    }
+    const T* value_begin =
+        value + (b * params.key_length + k_begin) * value_head_size;
+    for (int index = threadIdx.x; index < k_size * value_head_size;
+         index += blockDim.x) {
+      value_tile[index] = static_cast<float>(ldg(value_begin + index));
+    }
+    __syncthreads();
+    // The whole warp is active or not, and all warps reach the barriers.
+    if (!active) continue;
+
+    // Lane j gets the score of key j of the tile.
+    float score = -kInfinity;
+    for (int j = 0; j < k_size; ++j) {
+      float partial = 0.0f;
+#pragma unroll
+      for (int t = 0; t < kElementsPerLane; ++t) {
+        const int c = lane + t * kWarpSize;
+        if (c < head_size) partial += q[t] * key_tile[j * head_size + c];
+      }
+      for (int delta = kWarpSize / 2; delta > 0; delta /= 2) {
+        partial += GpuShuffleXorSync(kCudaWarpAll, partial, delta);
+      }
+      if (lane == j) score = partial;
+    }
+    if (lane < k_size && bias_row != nullptr) {
+      score += static_cast<float>(
+          ldg(bias_row + (k_begin + lane) * params.bias_key_stride));
+    }
+
+    float new_max = score;
+    for (int delta = kWarpSize / 2; delta > 0; delta /= 2) {
+      new_max = fmaxf(new_max,
+                      GpuShuffleXorSync(kCudaWarpAll, new_max, delta));
+    }
+    new_max = fmaxf(new_max, max_score);
+    if (new_max == -kInfinity) continue;  // All the keys so far are masked.
+    // Rescale the sum and output of the previous tiles to the new maximum.
+    const float correction = expf(max_score - new_max);
+    const float p = lane < k_size ? expf(score - new_max) : 0.0f;
+    float tile_sum = p;
+    for (int delta = kWarpSize / 2; delta > 0; delta /= 2) {
+      tile_sum += GpuShuffleXorSync(kCudaWarpAll, tile_sum, delta);
+    }
+    sum = sum * correction + tile_sum;
+#pragma unroll
+    for (int t = 0; t < kElementsPerLane; ++t) acc[t] *= correction;
+    for (int j = 0; j < k_size; ++j) {
+      const float p_j = GpuShuffleSync(kCudaWarpAll, p, j);
+#pragma unroll
+      for (int t = 0; t < kElementsPerLane; ++t) {
+        const int c = lane + t * kWarpSize;
+        if (c < value_head_size) {
+          acc[t] += p_j * value_tile[j * value_head_size + c];
+        }
+      }
+    }
+    max_score = new_max;
+  }
+
+  if (!active) return;
+  T* output_row = output + (b * params.query_length + i) * value_head_size;
+#pragma unroll
+  for (int t = 0; t < kElementsPerLane; ++t) {
+    const int c = lane + t * kWarpSize;
+    if (c < value_head_size) output_row[c] = static_cast<T>(acc[t] / sum);
+  }
+}
+
+template <typename T>
+void LaunchFusedAttentionKernel(const GPUDevice& d,
+                                const FusedAttentionParams& params,
+                                const T* query, const T* key, const T* value,
+                                const T* bias, T* output) {
+  const int64 num_query_blocks =
+      (params.query_length + kWarpsPerBlock - 1) / kWarpsPerBlock;
+  const int shared_memory_size =
+      kKeysPerTile * (params.head_size + params.value_head_size) *
+      sizeof(float);
+  TF_CHECK_OK(GpuLaunchKernel(FusedAttentionKernel<T>,
+                              params.batch * num_query_blocks,
+                              kWarpsPerBlock * kWarpSize, shared_memory_size,
+                              d.stream(), params, query, key, value, bias,
+                              output));
+}
+
+}  // namespace
+
+#define DEFINE_GPU_SPEC(T)                                                    \
+  template <>                                                                 \
+  void FusedAttention<GPUDevice, T>::operator()(                              \
+      const GPUDevice& d, const FusedAttentionParams& params, const T* query, \
+      const T* key, const T* value, const T* bias, T* output) {               \
+    LaunchFusedAttentionKernel(d, params, query, key, value, bias, output);   \
+  }                                                                           \
+  template struct FusedAttention<GPUDevice, T>;
+
+TF_CALL_float(DEFINE_GPU_SPEC);
+TF_CALL_half(DEFINE_GPU_SPEC);
+#undef DEFINE_GPU_SPEC
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
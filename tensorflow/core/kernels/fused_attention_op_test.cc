@@ -0,0 +1,152 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+class FusedAttentionOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int num_args, float scale) {
+    TF_EXPECT_OK(NodeDefBuilder("attention_op", "_FusedAttention")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(num_args, DT_FLOAT))
+                     .Attr("num_args", num_args)
+                     .Attr("scale", scale)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+};
+
+TEST_F(FusedAttentionOpTest, Attention) {
+  MakeOp(/*num_args=*/0, /*scale=*/0.5);
+  AddInputFromArray<float>(TensorShape({1, 2, 2}), {1, 0, 0, 2});
+  AddInputFromArray<float>(TensorShape({1, 3, 2}), {1, 1, 0, 1, 2, 0});
+  AddInputFromArray<float>(TensorShape({1, 3, 1}), {1, 2, 3});
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 2, 1}));
+  test::FillValues<float>(&expected, {2.1993, 1.7330});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+}
+
+TEST_F(FusedAttentionOpTest, AttentionWithBroadcastMask) {
+  MakeOp(/*num_args=*/1, /*scale=*/0.5);
+  AddInputFromArray<float>(TensorShape({1, 2, 2}), {1, 0, 0, 2});
+  AddInputFromArray<float>(TensorShape({1, 3, 2}), {1, 1, 0, 1, 2, 0});
+  AddInputFromArray<float>(TensorShape({1, 3, 1}), {1, 2, 3});
+  // The mask of the keys is broadcast along the queries.
+  AddInputFromArray<float>(
+      TensorShape({3}), {0, -std::numeric_limits<float>::infinity(), 0});
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 2, 1}));
+  test::FillValues<float>(&expected, {2.2449, 1.5379});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+}
+
+TEST_F(FusedAttentionOpTest, AttentionOverManyBlocks) {
+  // Enough queries and keys for several blocks, and a causal mask.
+  constexpr int kBatch = 2;
+  constexpr int kQueries = 70;
+  constexpr int kKeys = 300;
+  constexpr int kHeadSize = 8;
+  constexpr float kScale = 0.25;
+  random::PhiloxRandom philox(42);
+  random::SimplePhilox rnd(&philox);
+  auto random_values = [&](int size) {
+    std::vector<float> values(size);
+    for (float& value : values) value = rnd.RandFloat() * 2 - 1;
+    return values;
+  };
+  const std::vector<float> query = random_values(kBatch * kQueries * kHeadSize);
+  const std::vector<float> key = random_values(kBatch * kKeys * kHeadSize);
+  const std::vector<float> value = random_values(kBatch * kKeys * kHeadSize);
+  std::vector<float> mask(kQueries * kKeys, 0);
+  for (int i = 0; i < kQueries; ++i) {
+    for (int j = i + 1; j < kKeys; ++j) mask[i * kKeys + j] = -1e9;
+  }
+
+  MakeOp(/*num_args=*/1, kScale);
+  AddInputFromArray<float>(TensorShape({kBatch, kQueries, kHeadSize}), query);
+  AddInputFromArray<float>(TensorShape({kBatch, kKeys, kHeadSize}), key);
+  AddInputFromArray<float>(TensorShape({kBatch, kKeys, kHeadSize}), value);
+  AddInputFromArray<float>(TensorShape({1, kQueries, kKeys}), mask);
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT,
+                  TensorShape({kBatch, kQueries, kHeadSize}));
+  auto expected_values = expected.flat<float>();
+  for (int b = 0; b < kBatch; ++b) {
+    for (int i = 0; i < kQueries; ++i) {
+      std::vector<double> scores(kKeys);
+      double max_score = -std::numeric_limits<double>::infinity();
+      for (int j = 0; j < kKeys; ++j) {
+        double score = 0;
+        for (int c = 0; c < kHeadSize; ++c) {
+          score += query[(b * kQueries + i) * kHeadSize + c] *
+                   key[(b * kKeys + j) * kHeadSize + c];
+        }
+        scores[j] = score * kScale + mask[i * kKeys + j];
+        max_score = std::max(max_score, scores[j]);
+      }
+      double sum = 0;
+      for (double& score : scores) {
+        score = std::exp(score - max_score);
+        sum += score;
+      }
+      for (int c = 0; c < kHeadSize; ++c) {
+        double output = 0;
+        for (int j = 0; j < kKeys; ++j) {
+          output += scores[j] * value[(b * kKeys + j) * kHeadSize + c];
+        }
+        expected_values((b * kQueries + i) * kHeadSize + c) = output / sum;
+      }
+    }
+  }
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedAttentionOpTest, RejectsUnsupportedMask) {
+  MakeOp(/*num_args=*/1, /*scale=*/1.0);
+  AddInputFromArray<float>(TensorShape({2, 2, 2}), {1, 0, 0, 2, 1, 0, 0, 2});
+  AddInputFromArray<float>(TensorShape({2, 3, 2}),
+                           {1, 1, 0, 1, 2, 0, 1, 1, 0, 1, 2, 0});
+  AddInputFromArray<float>(TensorShape({2, 3, 1}), {1, 2, 3, 1, 2, 3});
+  AddInputFromArray<float>(TensorShape({2}), {0, 0});
+
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,227 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/fused_transformer_ops.h"
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+template <typename Device, typename T>
+class FusedLayerNormOp : public OpKernel {
+ public:
+  explicit FusedLayerNormOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("epsilon", &epsilon_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    const Tensor& scale = context->input(1);
+    const Tensor& offset = context->input(2);
+    OP_REQUIRES(context, x.dims() >= 1,
+                errors::InvalidArgument("x must have at least 1 dimension: ",
+                                        x.shape().DebugString()));
+    const int64 depth = x.dim_size(x.dims() - 1);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(scale.shape()) &&
+                    scale.NumElements() == depth,
+                errors::InvalidArgument(
+                    "scale must be a vector of the size of the last dimension "
+                    "of x: ",
+                    scale.shape().DebugString(), " vs. ",
+                    x.shape().DebugString()));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(offset.shape()) &&
+                    offset.NumElements() == depth,
+                errors::InvalidArgument(
+                    "offset must be a vector of the size of the last "
+                    "dimension of x: ",
+                    offset.shape().DebugString(), " vs. ",
+                    x.shape().DebugString()));
+
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &y));
+    if (x.NumElements() == 0) return;
+
+    const int64 rows = x.NumElements() / depth;
+    Tensor mean;
+    OP_REQUIRES_OK(context, context->allocate_temp(
+                                DT_FLOAT, TensorShape({rows}), &mean));
+    Tensor variance;
+    OP_REQUIRES_OK(context, context->allocate_temp(
+                                DT_FLOAT, TensorShape({rows}), &variance));
+    functor::FusedLayerNorm<Device, T>()(
+        context->eigen_device<Device>(), x.flat_inner_dims<T>(),
+        scale.vec<T>(), offset.vec<T>(), epsilon_, mean.vec<float>(),
+        variance.vec<float>(), y->flat_inner_dims<T>());
+  }
+
+ private:
+  float epsilon_;
+};
+
+template <typename Device, typename T>
+class FusedGeluOp : public OpKernel {
+ public:
+  explicit FusedGeluOp(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("approximate", &approximate_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &y));
+    if (x.NumElements() == 0) return;
+    functor::FusedGelu<Device, T>()(context->eigen_device<Device>(),
+                                    x.flat<T>(), approximate_, y->flat<T>());
+  }
+
+ private:
+  bool approximate_;
+};
+
+template <typename Device, typename T>
+class FusedScaledMaskedSoftmaxOp : public OpKernel {
+ public:
+  explicit FusedScaledMaskedSoftmaxOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& logits = context->input(0);
+    const Tensor& mask = context->input(1);
+    OP_REQUIRES(context, logits.dims() >= 1,
+                errors::InvalidArgument(
+                    "logits must have at least 1 dimension: ",
+                    logits.shape().DebugString()));
+    OP_REQUIRES(context, mask.dims() <= logits.dims(),
+                errors::InvalidArgument(
+                    "mask must not have more dimensions than logits: ",
+                    mask.shape().DebugString(), " vs. ",
+                    logits.shape().DebugString()));
+
+    // The mask, padded with leading dimensions of size 1 to the rank of the
+    // logits, must match the logits on some leading dimensions and on the
+    // last one, and have size 1 in between.
+    const int rank = logits.dims();
+    const int mask_offset = rank - mask.dims();
+    auto mask_dim = [&](int i) -> int64 {
+      return i < mask_offset ? 1 : mask.dim_size(i - mask_offset);
+    };
+    int num_outer_dims = 0;
+    while (num_outer_dims < rank - 1 &&
+           mask_dim(num_outer_dims) == logits.dim_size(num_outer_dims)) {
+      ++num_outer_dims;
+    }
+    int64 outer = 1;
+    for (int i = 0; i < num_outer_dims; ++i) outer *= logits.dim_size(i);
+    int64 middle = 1;
+    for (int i = num_outer_dims; i < rank - 1; ++i) {
+      OP_REQUIRES(context, mask_dim(i) == 1,
+                  errors::InvalidArgument(
+                      "mask can only be broadcast along the dimensions of "
+                      "logits that follow the ones it matches: ",
+                      mask.shape().DebugString(), " vs. ",
+                      logits.shape().DebugString()));
+      middle *= logits.dim_size(i);
+    }
+    const int64 depth = logits.dim_size(rank - 1);
+    OP_REQUIRES(context, mask_dim(rank - 1) == depth,
+                errors::InvalidArgument(
+                    "mask must have the last dimension of logits: ",
+                    mask.shape().DebugString(), " vs. ",
+                    logits.shape().DebugString()));
+
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, logits.shape(), &y));
+    if (logits.NumElements() == 0) return;
+
+    Tensor scratch;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(
+                       DT_FLOAT, TensorShape({outer * middle, depth}),
+                       &scratch));
+    functor::FusedScaledMaskedSoftmax<Device, T>()(
+        context->eigen_device<Device>(),
+        logits.shaped<T, 3>({outer, middle, depth}),
+        mask.shaped<T, 3>({outer, 1, depth}), scale_, scratch.matrix<float>(),
+        y->shaped<T, 3>({outer, middle, depth}));
+  }
+
+ private:
+  float scale_;
+};
+
+#define REGISTER_KERNELS(DEVICE, TYPE)                                        \
+  REGISTER_KERNEL_BUILDER(Name("_FusedLayerNorm")                             \
+                              .Device(DEVICE_##DEVICE)                        \
+                              .TypeConstraint<TYPE>("T"),                     \
+                          FusedLayerNormOp<DEVICE##Device, TYPE>);            \
+  REGISTER_KERNEL_BUILDER(Name("_FusedGelu")                                  \
+                              .Device(DEVICE_##DEVICE)                        \
+                              .TypeConstraint<TYPE>("T"),                     \
+                          FusedGeluOp<DEVICE##Device, TYPE>);                 \
+  REGISTER_KERNEL_BUILDER(Name("_FusedScaledMaskedSoftmax")                   \
+                              .Device(DEVICE_##DEVICE)                        \
+                              .TypeConstraint<TYPE>("T"),                     \
+                          FusedScaledMaskedSoftmaxOp<DEVICE##Device, TYPE>);
+
+#define REGISTER_CPU_KERNELS(TYPE) REGISTER_KERNELS(CPU, TYPE)
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Forward declarations of the functor specializations for GPU.
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                     \
+  extern template struct FusedLayerNorm<GPUDevice, T>;          \
+  extern template struct FusedGelu<GPUDevice, T>;               \
+  extern template struct FusedScaledMaskedSoftmax<GPUDevice, T>;
+
+TF_CALL_float(DECLARE_GPU_SPEC);
+TF_CALL_half(DECLARE_GPU_SPEC);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+#define REGISTER_GPU_KERNELS(TYPE) REGISTER_KERNELS(GPU, TYPE)
+TF_CALL_float(REGISTER_GPU_KERNELS);
+TF_CALL_half(REGISTER_GPU_KERNELS);
+#undef REGISTER_GPU_KERNELS
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#undef REGISTER_KERNELS
+
+}  // namespace tensorflow
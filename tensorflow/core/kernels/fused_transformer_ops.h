@@ -0,0 +1,142 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_TRANSFORMER_OPS_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_TRANSFORMER_OPS_H_
+// Functor definitions for the fused transformer ops, must be compilable by
+// nvcc.
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+
+namespace tensorflow {
+namespace functor {
+
+// The functors below compute in float for all types T, and only round their
+// results to T.
+
+// Normalizes each row of `x` to zero mean and unit variance, then scales and
+// offsets it:
+//   y = (x - mean(x)) * rsqrt(variance(x) + epsilon) * scale + offset
+//
+// x, y: dims: rows, depth.
+// scale, offset: dims: depth.
+// mean, variance: dims: rows, used as temporary storage.
+template <typename Device, typename T>
+struct FusedLayerNorm {
+  void operator()(const Device& d, typename TTypes<T>::ConstMatrix x,
+                  typename TTypes<T>::ConstVec scale,
+                  typename TTypes<T>::ConstVec offset, float epsilon,
+                  typename TTypes<float>::Vec mean,
+                  typename TTypes<float>::Vec variance,
+                  typename TTypes<T>::Matrix y) {
+    const int rows = x.dimension(0);
+    const int depth = x.dimension(1);
+    const Eigen::DSizes<int, 1> along_depth(1);
+    const Eigen::DSizes<int, 2> rows_by_one(rows, 1);
+    const Eigen::DSizes<int, 2> one_by_depth(1, depth);
+
+    auto x_float = x.template cast<float>();
+    mean.device(d) = x_float.mean(along_depth);
+    auto centered =
+        x_float - mean.reshape(rows_by_one).broadcast(one_by_depth);
+    variance.device(d) = centered.square().mean(along_depth);
+    variance.device(d) = (variance + epsilon).rsqrt();
+    y.device(d) =
+        (centered * variance.reshape(rows_by_one).broadcast(one_by_depth) *
+             scale.template cast<float>()
+                 .reshape(one_by_depth)
+                 .broadcast(rows_by_one) +
+         offset.template cast<float>()
+             .reshape(one_by_depth)
+             .broadcast(rows_by_one))
+            .template cast<T>();
+  }
+};
+
+// Computes the Gaussian Error Linear Unit of `x`, with the tanh-based
+// approximation if `approximate` is true:
+//   y = 0.5 * x * (1 + erf(x / sqrt(2)))
+//   y = 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+template <typename Device, typename T>
+struct FusedGelu {
+  void operator()(const Device& d, typename TTypes<T>::ConstFlat x,
+                  bool approximate, typename TTypes<T>::Flat y) {
+    auto x_float = x.template cast<float>();
+    if (approximate) {
+      constexpr float kSqrtTwoOverPi = 0.7978845608028654f;
+      constexpr float kCoefficient = 0.044715f;
+      y.device(d) = (0.5f * x_float *
+                     (1.0f + (kSqrtTwoOverPi *
+                              (x_float + kCoefficient * x_float.cube()))
+                                 .tanh()))
+                        .template cast<T>();
+    } else {
+      constexpr float kRsqrtTwo = 0.7071067811865476f;
+      y.device(d) =
+          (0.5f * x_float * (1.0f + (kRsqrtTwo * x_float).erf()))
+              .template cast<T>();
+    }
+  }
+};
+
+// Computes the softmax of the scaled and masked logits along their last
+// dimension:
+//   y = softmax(logits * scale + mask)
+// `mask` is broadcast along the middle dimension of `logits`.
+//
+// logits, y: dims: outer, middle, depth.
+// mask: dims: outer, 1, depth.
+// scratch: dims: outer * middle, depth, used as temporary storage.
+template <typename Device, typename T>
+struct FusedScaledMaskedSoftmax {
+  void operator()(const Device& d, typename TTypes<T, 3>::ConstTensor logits,
+                  typename TTypes<T, 3>::ConstTensor mask, float scale,
+                  typename TTypes<float>::Matrix scratch,
+                  typename TTypes<T, 3>::Tensor y) {
+    const int outer = logits.dimension(0);
+    const int middle = logits.dimension(1);
+    const int depth = logits.dimension(2);
+    const int rows = outer * middle;
+    const Eigen::DSizes<int, 3> mask_broadcast(1, middle, 1);
+    const Eigen::DSizes<int, 2> rows_by_depth(rows, depth);
+    const Eigen::DSizes<int, 1> along_depth(1);
+    const Eigen::DSizes<int, 2> rows_by_one(rows, 1);
+    const Eigen::DSizes<int, 2> one_by_depth(1, depth);
+
+    scratch.device(d) = (logits.template cast<float>() * scale +
+                         mask.template cast<float>().broadcast(mask_broadcast))
+                            .reshape(rows_by_depth);
+    // scratch = exp(scratch - max(scratch along depth));
+    scratch.device(d) = (scratch - scratch.maximum(along_depth)
+                                       .eval()
+                                       .reshape(rows_by_one)
+                                       .broadcast(one_by_depth))
+                            .exp();
+    // y = scratch * (1 / sum(scratch along depth));
+    y.reshape(rows_by_depth).device(d) =
+        (scratch * scratch.sum(along_depth)
+                       .inverse()
+                       .eval()
+                       .reshape(rows_by_one)
+                       .broadcast(one_by_depth))
+            .template cast<T>();
+  }
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_TRANSFORMER_OPS_H_
@@ -0,0 +1,129 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+class FusedTransformerOpsTest : public OpsTestBase {};
+
+TEST_F(FusedTransformerOpsTest, LayerNorm) {
+  TF_EXPECT_OK(NodeDefBuilder("layer_norm_op", "_FusedLayerNorm")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("epsilon", 0.001)
+                   .Finalize(node_def()));
+  TF_EXPECT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({2, 4}), {1, 2, 3, 4, 2, 2, 2, 2});
+  AddInputFromArray<float>(TensorShape({4}), {1, 1, 2, 2});
+  AddInputFromArray<float>(TensorShape({4}), {0, 1, 0, 1});
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 4}));
+  test::FillValues<float>(&expected, {-1.3411, 0.5530, 0.8941, 3.6822, 0.0,
+                                      1.0, 0.0, 1.0});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-3);
+}
+
+TEST_F(FusedTransformerOpsTest, LayerNormRejectsMismatchedScale) {
+  TF_EXPECT_OK(NodeDefBuilder("layer_norm_op", "_FusedLayerNorm")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_EXPECT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({2, 4}), {1, 2, 3, 4, 2, 2, 2, 2});
+  AddInputFromArray<float>(TensorShape({3}), {1, 1, 2});
+  AddInputFromArray<float>(TensorShape({4}), {0, 1, 0, 1});
+
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(FusedTransformerOpsTest, Gelu) {
+  TF_EXPECT_OK(NodeDefBuilder("gelu_op", "_FusedGelu")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("approximate", false)
+                   .Finalize(node_def()));
+  TF_EXPECT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({4}), {-1, 0, 1, 2});
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&expected, {-0.1587, 0.0, 0.8413, 1.9545});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+}
+
+TEST_F(FusedTransformerOpsTest, GeluApproximate) {
+  TF_EXPECT_OK(NodeDefBuilder("gelu_op", "_FusedGelu")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("approximate", true)
+                   .Finalize(node_def()));
+  TF_EXPECT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({4}), {-1, 0, 1, 2});
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&expected, {-0.1588, 0.0, 0.8412, 1.9546});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+}
+
+TEST_F(FusedTransformerOpsTest, ScaledMaskedSoftmax) {
+  TF_EXPECT_OK(NodeDefBuilder("softmax_op", "_FusedScaledMaskedSoftmax")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("scale", 0.5)
+                   .Finalize(node_def()));
+  TF_EXPECT_OK(InitOp());
+  // The mask is broadcast over the second dimension of the logits.
+  AddInputFromArray<float>(TensorShape({2, 2, 3}),
+                           {1, 2, 3, 3, 2, 1, 0, 0, 0, 4, 2, 0});
+  AddInputFromArray<float>(TensorShape({2, 1, 3}),
+                           {0, 0, -10000, 0, -10000, 0});
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2, 3}));
+  test::FillValues<float>(&expected, {0.3775, 0.6225, 0.0, 0.6225, 0.3775, 0.0,
+                                      0.5, 0.0, 0.5, 0.8808, 0.0, 0.1192});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+}
+
+TEST_F(FusedTransformerOpsTest, ScaledMaskedSoftmaxRejectsUnsupportedMask) {
+  TF_EXPECT_OK(NodeDefBuilder("softmax_op", "_FusedScaledMaskedSoftmax")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_EXPECT_OK(InitOp());
+  // A mask that is broadcast over the last dimension is not supported.
+  AddInputFromArray<float>(TensorShape({2, 2, 3}),
+                           {1, 2, 3, 3, 2, 1, 0, 0, 0, 4, 2, 0});
+  AddInputFromArray<float>(TensorShape({2, 2, 1}), {0, 0, 0, 0});
+
+  Status s = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,170 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#define EIGEN_USE_THREADS
+
+#include <limits>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/image/resize_bilinear_op.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/util/image_resizer_state.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// Returns the largest of the scaling denominators that libjpeg supports that
+// decodes an image of `width` x `height` pixels to at least `new_width` x
+// `new_height` pixels.
+int JpegScaleDenominator(int width, int height, int new_width,
+                         int new_height) {
+  for (int ratio : {8, 4, 2}) {
+    // libjpeg rounds the scaled sizes up.
+    if ((width + ratio - 1) / ratio >= new_width &&
+        (height + ratio - 1) / ratio >= new_height) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+}  // namespace
+
+// Decodes a JPEG image and resizes it with bilinear interpolation, decoding it
+// directly at a fraction of its size when it is much larger than the output.
+class DecodeAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &flags_.components));
+    OP_REQUIRES(context,
+                flags_.components == 0 || flags_.components == 1 ||
+                    flags_.components == 3,
+                errors::InvalidArgument("channels must be 0, 1, or 3, got ",
+                                        flags_.components));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("try_recover_truncated",
+                                    &flags_.try_recover_truncated_jpeg));
+    OP_REQUIRES_OK(context, context->GetAttr("acceptable_fraction",
+                                             &flags_.min_acceptable_fraction));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    // Same default as DecodeJpeg.
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+    OP_REQUIRES_OK(context, context->GetAttr("align_corners", &align_corners_));
+    OP_REQUIRES_OK(context, context->GetAttr("half_pixel_centers",
+                                             &half_pixel_centers_));
+    OP_REQUIRES(
+        context, !(align_corners_ && half_pixel_centers_),
+        errors::InvalidArgument("If half_pixel_centers is True, align_corners "
+                                "must be False."));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(contents.shape()),
+                errors::InvalidArgument("contents must be scalar, got shape ",
+                                        contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<tstring>()();
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument("JPEG contents are too large for int: ",
+                                        input.size()));
+    const Tensor& size = context->input(1);
+    OP_REQUIRES(
+        context,
+        TensorShapeUtils::IsVector(size.shape()) && size.dim_size(0) == 2,
+        errors::InvalidArgument("size must be 1-dimensional with 2 elements, "
+                                "got shape ",
+                                size.shape().DebugString()));
+    const int new_height = size.vec<int32>()(0);
+    const int new_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, new_height > 0 && new_width > 0,
+                errors::InvalidArgument("size must be positive, got [",
+                                        new_height, ", ", new_width, "]"));
+
+    int width, height, components;
+    OP_REQUIRES(
+        context,
+        jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                           &components),
+        errors::InvalidArgument("Invalid JPEG data, size ", input.size()));
+
+    // Use local copy of flags to avoid race condition as the class member is
+    // shared among different invocations.
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio = JpegScaleDenominator(width, height, new_width, new_height);
+    Tensor decoded;
+    uint8* buffer = jpeg::Uncompress(
+        input.data(), input.size(), flags, nullptr /* nwarn */,
+        [&](int w, int h, int c) -> uint8* {
+          Status status = context->allocate_temp(
+              DT_UINT8, TensorShape({1, h, w, c}), &decoded);
+          if (!status.ok()) {
+            VLOG(1) << status;
+            context->SetStatus(status);
+            return nullptr;
+          }
+          return decoded.flat<uint8>().data();
+        });
+    OP_REQUIRES(context, buffer,
+                errors::InvalidArgument(
+                    "jpeg::Uncompress failed. Invalid JPEG data."));
+
+    const int64 decoded_height = decoded.dim_size(1);
+    const int64 decoded_width = decoded.dim_size(2);
+    const int64 channels = decoded.dim_size(3);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({new_height, new_width, channels}),
+                       &output));
+    functor::ResizeBilinear<CPUDevice, uint8>()(
+        context->eigen_device<CPUDevice>(),
+        const_cast<const Tensor&>(decoded).tensor<uint8, 4>(),
+        CalculateResizeScale(decoded_height, new_height, align_corners_),
+        CalculateResizeScale(decoded_width, new_width, align_corners_),
+        half_pixel_centers_,
+        output->shaped<float, 4>({1, new_height, new_width, channels}));
+  }
+
+ private:
+  jpeg::UncompressFlags flags_;
+  bool align_corners_;
+  bool half_pixel_centers_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndResizeJpegOp);
+
+}  // namespace tensorflow
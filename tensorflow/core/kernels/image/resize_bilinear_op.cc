@@ -283,51 +283,53 @@ struct CastFloatTo<GPUDevice, T> {
 // Partial specialization of ResizeBilinear functor for a CPUDevice.
 namespace functor {
 template <typename T>
-struct ResizeBilinear<CPUDevice, T> {
-  void operator()(const CPUDevice& d, typename TTypes<T, 4>::ConstTensor images,
-                  const float height_scale, const float width_scale,
-                  bool half_pixel_centers,
-                  typename TTypes<float, 4>::Tensor output) {
-    const int batch_size = images.dimension(0);
-    const int64 in_height = images.dimension(1);
-    const int64 in_width = images.dimension(2);
-    const int channels = images.dimension(3);
-
-    const int64 out_height = output.dimension(1);
-    const int64 out_width = output.dimension(2);
-
-    // Handle no-op resizes efficiently.
-    if (out_height == in_height && out_width == in_width) {
-      output = images.template cast<float>();
-      return;
-    }
+void ResizeBilinear<CPUDevice, T>::operator()(
+    const CPUDevice& d, typename TTypes<T, 4>::ConstTensor images,
+    const float height_scale, const float width_scale, bool half_pixel_centers,
+    typename TTypes<float, 4>::Tensor output) {
+  const int batch_size = images.dimension(0);
+  const int64 in_height = images.dimension(1);
+  const int64 in_width = images.dimension(2);
+  const int channels = images.dimension(3);
+
+  const int64 out_height = output.dimension(1);
+  const int64 out_width = output.dimension(2);
+
+  // Handle no-op resizes efficiently.
+  if (out_height == in_height && out_width == in_width) {
+    output = images.template cast<float>();
+    return;
+  }
 
-    std::vector<CachedInterpolation> ys(out_height + 1);
-    std::vector<CachedInterpolation> xs(out_width + 1);
+  std::vector<CachedInterpolation> ys(out_height + 1);
+  std::vector<CachedInterpolation> xs(out_width + 1);
 
-    // Compute the cached interpolation weights on the x and y dimensions.
-    if (half_pixel_centers) {
-      compute_interpolation_weights(HalfPixelScaler(), out_height, in_height,
-                                    height_scale, ys.data());
-      compute_interpolation_weights(HalfPixelScaler(), out_width, in_width,
-                                    width_scale, xs.data());
+  // Compute the cached interpolation weights on the x and y dimensions.
+  if (half_pixel_centers) {
+    compute_interpolation_weights(HalfPixelScaler(), out_height, in_height,
+                                  height_scale, ys.data());
+    compute_interpolation_weights(HalfPixelScaler(), out_width, in_width,
+                                  width_scale, xs.data());
 
-    } else {
-      compute_interpolation_weights(LegacyScaler(), out_height, in_height,
-                                    height_scale, ys.data());
-      compute_interpolation_weights(LegacyScaler(), out_width, in_width,
-                                    width_scale, xs.data());
-    }
-    // Scale x interpolation weights to avoid a multiplication during iteration.
-    for (int i = 0; i < xs.size(); ++i) {
-      xs[i].lower *= channels;
-      xs[i].upper *= channels;
-    }
-
-    resize_image<T>(images, batch_size, in_height, in_width, out_height,
-                    out_width, channels, xs, ys, output);
+  } else {
+    compute_interpolation_weights(LegacyScaler(), out_height, in_height,
+                                  height_scale, ys.data());
+    compute_interpolation_weights(LegacyScaler(), out_width, in_width,
+                                  width_scale, xs.data());
   }
-};
+  // Scale x interpolation weights to avoid a multiplication during iteration.
+  for (int i = 0; i < xs.size(); ++i) {
+    xs[i].lower *= channels;
+    xs[i].upper *= channels;
+  }
+
+  resize_image<T>(images, batch_size, in_height, in_width, out_height,
+                  out_width, channels, xs, ys, output);
+}
+
+#define DEFINE_CPU_SPEC(T) template struct ResizeBilinear<CPUDevice, T>;
+TF_CALL_REAL_NUMBER_TYPES(DEFINE_CPU_SPEC);
+#undef DEFINE_CPU_SPEC
 }  // namespace functor
 
 template <typename Device, typename T>
@@ -31,6 +31,16 @@ struct ResizeBilinear {
                   typename TTypes<float, 4>::Tensor resized_images);
 };
 
+// The CPU functor, which is defined for the real number types.
+template <typename T>
+struct ResizeBilinear<Eigen::ThreadPoolDevice, T> {
+  void operator()(const Eigen::ThreadPoolDevice& d,
+                  typename TTypes<T, 4>::ConstTensor images,
+                  const float height_scale, const float width_scale,
+                  const bool half_pixel_centers,
+                  typename TTypes<float, 4>::Tensor resized_images);
+};
+
 template <typename Device, typename T>
 struct ResizeBilinearGrad {
   void operator()(const Device& d,
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/list_kernels.h"
 
+#include <algorithm>
 #include <limits>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -126,6 +127,10 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32 input_index,
   return Status::OK();
 }
 
+// Upper limit on the number of elements EmptyTensorList makes room for up
+// front. Bounds are only upper limits, and may be far larger than lists get.
+constexpr int kMaxPreallocatedListElements = 1 << 16;
+
 class EmptyTensorList : public OpKernel {
  public:
   explicit EmptyTensorList(OpKernelConstruction* ctx) : OpKernel(ctx) {
@@ -146,6 +151,13 @@ class EmptyTensorList : public OpKernel {
     TensorList empty;
     empty.element_dtype = element_dtype_;
     empty.max_num_elements = max_num_elements_t.scalar<int32>()();
+    // Bounded lists are typically filled up to their bound, e.g. by the
+    // TensorListPushBack ops of a while loop, so avoid growing them one
+    // element at a time.
+    if (empty.max_num_elements > 0) {
+      empty.tensors().reserve(
+          std::min(empty.max_num_elements, kMaxPreallocatedListElements));
+    }
     PartialTensorShape element_shape;
     OP_REQUIRES_OK(ctx, TensorShapeFromTensor(ctx->input(0), &element_shape));
     empty.element_shape = element_shape;
@@ -364,22 +376,10 @@ class TensorListResize : public OpKernel {
     AllocatorAttributes attr;
     attr.set_on_host(true);
     OP_REQUIRES_OK(c, c->allocate_output(0, TensorShape{}, &result, attr));
-    TensorList output_list;
-    output_list.element_shape = input_list->element_shape;
-    output_list.element_dtype = input_list->element_dtype;
-    output_list.max_num_elements = input_list->max_num_elements;
-    if (size > input_list->tensors().size()) {
-      output_list.tensors().insert(output_list.tensors().begin(),
-                                   input_list->tensors().begin(),
-                                   input_list->tensors().end());
-      // Add DT_INVALID tensors to the end of the list if the requested size
-      // is larger than the list length.
-      output_list.tensors().resize(size, Tensor(DT_INVALID));
-    } else {
-      output_list.tensors().insert(output_list.tensors().begin(),
-                                   input_list->tensors().begin(),
-                                   input_list->tensors().begin() + size);
-    }
+    TensorList output_list = input_list->Copy();
+    // Add DT_INVALID tensors to the end of the list if the requested size is
+    // larger than the list length.
+    output_list.tensors().resize(size, Tensor(DT_INVALID));
     result->scalar<Variant>()() = std::move(output_list);
   }
 };
@@ -423,7 +423,7 @@ class TensorListSetItem : public OpKernel {
                     " list shape: ", l->element_shape.DebugString()));
     TensorList* output_list = nullptr;
     OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
-    output_list->tensors()[index] = value;
+    output_list->tensors().set(index, value);
   }
 
  private:
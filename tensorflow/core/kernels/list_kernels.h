@@ -709,7 +709,7 @@ Status Scatter(OpKernelContext* c, const Tensor& value, const Tensor& indices,
     // many small ones.
     aligned.flat<T>().device(c->eigen_device<Device>()) =
         tmp.unaligned_flat<T>();
-    std::swap(list->tensors()[i], aligned);
+    list->tensors().set(i, std::move(aligned));
   }
   return Status::OK();
 }
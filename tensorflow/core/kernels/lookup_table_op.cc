@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -520,47 +521,68 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_matrix =
         deleted_key_.template shaped<K, 2>({1, key_size});
     const int64 bit_mask = num_buckets_ - 1;
-    // TODO(andreasst): parallelize using work_sharder
-    for (int64 i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
-      if (empty_key_hash_ == key_hash &&
-          IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the empty_key as a table key is not allowed");
-      }
-      if (deleted_key_hash_ == key_hash &&
-          IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the deleted_key as a table key is not allowed");
-      }
-      int64 bucket_index = key_hash & bit_mask;
-      int64 num_probes = 0;
-      while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          for (int64 j = 0; j < value_size; ++j) {
-            // TODO(andreasst): check if we can get rid of SubtleMustCopy
-            // here and elsewhere in this file.
-            value_matrix(i, j) =
-                SubtleMustCopyIfIntegral(value_buckets_matrix(bucket_index, j));
-          }
-          break;
+    auto find_range = [&](int64 begin, int64 end) -> Status {
+      for (int64 i = begin; i < end; ++i) {
+        const uint64 key_hash = HashKey(key_matrix, i);
+        if (empty_key_hash_ == key_hash &&
+            IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
+          return errors::InvalidArgument(
+              "Using the empty_key as a table key is not allowed");
         }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix, 0)) {
-          for (int64 j = 0; j < value_size; ++j) {
-            value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
-          }
-          break;
+        if (deleted_key_hash_ == key_hash &&
+            IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
+          return errors::InvalidArgument(
+              "Using the deleted_key as a table key is not allowed");
         }
-        ++num_probes;
-        bucket_index =
-            (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
-          return errors::Internal(
-              "Internal error in MutableDenseHashTable lookup");
+        int64 bucket_index = key_hash & bit_mask;
+        int64 num_probes = 0;
+        while (true) {
+          if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+            for (int64 j = 0; j < value_size; ++j) {
+              // TODO(andreasst): check if we can get rid of SubtleMustCopy
+              // here and elsewhere in this file.
+              value_matrix(i, j) = SubtleMustCopyIfIntegral(
+                  value_buckets_matrix(bucket_index, j));
+            }
+            break;
+          }
+          if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix,
+                         0)) {
+            for (int64 j = 0; j < value_size; ++j) {
+              value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
+            }
+            break;
+          }
+          ++num_probes;
+          bucket_index =
+              (bucket_index + num_probes) & bit_mask;  // quadratic probing
+          if (num_probes >= num_buckets_) {
+            return errors::Internal(
+                "Internal error in MutableDenseHashTable lookup");
+          }
         }
       }
+      return Status::OK();
+    };
+    if (ctx == nullptr) {
+      return find_range(0, num_elements);
     }
-    return Status::OK();
+
+    // Lookups only read the buckets, so large batches of keys are split
+    // across the intra-op threads while this thread holds the shared lock.
+    mutex status_mu;
+    Status status;
+    auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    const int64 cost_per_key = 50 * (key_size + value_size);
+    Shard(worker_threads->num_threads, worker_threads->workers, num_elements,
+          cost_per_key, [&](int64 begin, int64 end) {
+            Status range_status = find_range(begin, end);
+            if (!range_status.ok()) {
+              mutex_lock l(status_mu);
+              status.Update(range_status);
+            }
+          });
+    return status;
   }
 
   Status Insert(OpKernelContext* ctx, const Tensor& key,
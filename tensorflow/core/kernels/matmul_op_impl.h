@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/matmul_autotune.h"
 #include "tensorflow/core/util/matmul_bcast.h"
 #include "tensorflow/core/util/work_sharder.h"
 
@@ -43,6 +44,8 @@ limitations under the License.
 #endif
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/kernels/gpu_utils.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
@@ -611,6 +614,246 @@ struct LaunchBatchMatMul<GPUDevice, Eigen::half> {
 
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+// Multiplies inputs of types Ta and Tb into an output of type Tout, by casting
+// the inputs to Tout.
+template <typename Device, typename Ta, typename Tb, typename Tout>
+struct LaunchMixedTypeBatchMatMul {
+  static void Launch(OpKernelContext* context, Tensor in_x, Tensor in_y,
+                     bool adj_x, bool adj_y, bool trans_x, bool trans_y,
+                     const MatMulBCast& bcast, Tensor* out) {
+    // Cast tensor to desired type to reuse Eigen.
+    // TODO(b/178749687): remove this cast if Eigen supports this natively.
+    if (!std::is_same<Ta, Tout>::value) {
+      in_x = CastTensor<Ta, Tout>(in_x);
+    }
+    if (!std::is_same<Tb, Tout>::value) {
+      in_y = CastTensor<Tb, Tout>(in_y);
+    }
+    LaunchBatchMatMul<Device, Tout>::Launch(context, in_x, in_y, adj_x, adj_y,
+                                            trans_x, trans_y, bcast, out);
+  }
+
+ private:
+  // Cast `t` from `SrcT` to `DstT`.
+  template <typename SrcT, typename DstT>
+  static Tensor CastTensor(const Tensor& t) {
+    Tensor res = Tensor(DataTypeToEnum<DstT>::v(), t.shape());
+    res.flat<DstT>() = t.flat<SrcT>().template cast<DstT>();
+    return res;
+  }
+};
+
+#if GOOGLE_CUDA
+
+namespace {
+
+// The parameters of a cublasLt matrix multiplication, by which the autotuned
+// algorithm is looked up.
+class BlasLtMatmulParameters {
+ public:
+  BlasLtMatmulParameters(const se::blas::BlasLtMatmulPlanParams& params,
+                         int device_id)
+      : params_(params), device_id_(device_id) {
+    hash_code_ = device_id;
+    for (int64 value : AsVector()) {
+      hash_code_ = Hash64Combine(hash_code_, value);
+    }
+  }
+
+  bool operator==(const BlasLtMatmulParameters& other) const {
+    return device_id_ == other.device_id_ && AsVector() == other.AsVector();
+  }
+  bool operator!=(const BlasLtMatmulParameters& other) const {
+    return !(*this == other);
+  }
+  uint64 hash() const { return hash_code_; }
+
+  string ToString() const {
+    return strings::StrCat(
+        "ab_type: ", se::blas::DataTypeString(params_.ab_type),
+        ", c_type: ", se::blas::DataTypeString(params_.c_type),
+        ", computation_type: ",
+        se::blas::ComputationTypeString(params_.computation_type),
+        ", transa: ", se::blas::TransposeString(params_.transa),
+        ", transb: ", se::blas::TransposeString(params_.transb),
+        ", m: ", params_.m, ", n: ", params_.n, ", k: ", params_.k,
+        ", lda: ", params_.lda, ", ldb: ", params_.ldb, ", ldc: ", params_.ldc,
+        ", batch_count: ", params_.batch_count,
+        ", stride_a: ", params_.stride_a, ", stride_b: ", params_.stride_b,
+        ", stride_c: ", params_.stride_c, ", device_id: ", device_id_);
+  }
+
+ private:
+  std::vector<int64> AsVector() const {
+    return {static_cast<int64>(params_.ab_type),
+            static_cast<int64>(params_.c_type),
+            static_cast<int64>(params_.computation_type),
+            static_cast<int64>(params_.pointer_mode),
+            static_cast<int64>(params_.epilogue),
+            static_cast<int64>(params_.transa),
+            static_cast<int64>(params_.transb),
+            static_cast<int64>(params_.m),
+            static_cast<int64>(params_.n),
+            static_cast<int64>(params_.k),
+            params_.lda,
+            params_.ldb,
+            params_.ldc,
+            params_.batch_count,
+            params_.stride_a,
+            params_.stride_b,
+            params_.stride_c};
+  }
+
+  se::blas::BlasLtMatmulPlanParams params_;
+  int device_id_;
+  uint64 hash_code_;
+};
+
+struct BlasLtMatmulAutoTuneGroup {
+  static string name() { return "BlasLtMatmul"; }
+};
+
+typedef AutoTuneSingleton<BlasLtMatmulAutoTuneGroup, BlasLtMatmulParameters,
+                          se::blas::AlgorithmConfig>
+    AutoTuneBlasLtMatmul;
+
+// The limit of the workspace of the cublasLt algorithms that are considered.
+constexpr size_t kBlasLtMatmulMaxWorkspaceBytes = 1LL << 25;  // 32MB
+// The number of cublasLt algorithms that autotuning tries.
+constexpr int kBlasLtMatmulMaxAlgorithms = 16;
+
+}  // namespace
+
+// Multiplies int8 matrices into int32 ones with cublasLt, which runs them on
+// the integer tensor cores when the shapes allow, instead of casting them to
+// int32 matrices that the GPU can't multiply.
+template <>
+struct LaunchMixedTypeBatchMatMul<GPUDevice, int8, int8, int32> {
+  static void Launch(OpKernelContext* context, const Tensor& in_x,
+                     const Tensor& in_y, bool adj_x, bool adj_y, bool trans_x,
+                     bool trans_y, const MatMulBCast& bcast, Tensor* out) {
+    // The adjoint of an integer matrix is its transpose.
+    trans_x = adj_x || trans_x;
+    trans_y = adj_y || trans_y;
+    const uint64 m = in_x.dim_size(trans_x ? 2 : 1);
+    const uint64 k = in_x.dim_size(trans_x ? 1 : 2);
+    const uint64 n = in_y.dim_size(trans_y ? 1 : 2);
+    const int64 batch_size = bcast.output_batch_size();
+
+    auto* stream = context->op_device_context()->stream();
+    OP_REQUIRES(context, stream, errors::Internal("No GPU stream available."));
+
+    // As in LaunchBatchMatMul, compute C' = B' x A' in column major, with one
+    // strided batch unless the inputs are partially broadcast.
+    const bool use_strided_batched =
+        !bcast.IsBroadcastingRequired() ||
+        std::min(bcast.x_batch_size(), bcast.y_batch_size()) == 1;
+    se::blas::BlasLtMatmulPlanParams plan_params;
+    plan_params.ab_type = se::blas::ToDataType<int8>::value;
+    plan_params.c_type = se::blas::ToDataType<int32>::value;
+    plan_params.computation_type = se::blas::ComputationType::kI32;
+    plan_params.pointer_mode = se::blas::PointerMode::kHost;
+    plan_params.epilogue = se::blas::Epilogue::kDefault;
+    plan_params.transa = trans_y ? se::blas::Transpose::kTranspose
+                                 : se::blas::Transpose::kNoTranspose;
+    plan_params.transb = trans_x ? se::blas::Transpose::kTranspose
+                                 : se::blas::Transpose::kNoTranspose;
+    plan_params.m = n;
+    plan_params.n = m;
+    plan_params.k = k;
+    plan_params.lda = trans_y ? k : n;
+    plan_params.ldb = trans_x ? m : k;
+    plan_params.ldc = n;
+    if (use_strided_batched) {
+      plan_params.batch_count = batch_size;
+      plan_params.stride_a = bcast.y_batch_size() != 1 ? k * n : 0;
+      plan_params.stride_b = bcast.x_batch_size() != 1 ? m * k : 0;
+      plan_params.stride_c = m * n;
+    }
+
+    se::StreamExecutor* executor = stream->parent();
+    auto plan_or = executor->CreateBlasLtMatmulPlan(plan_params);
+    OP_REQUIRES_OK(context, plan_or.status());
+    std::unique_ptr<se::blas::IBlasLtMatmulPlan> plan =
+        plan_or.ConsumeValueOrDie();
+    auto algorithms_or = executor->GetBlasLtMatmulAlgorithms(
+        plan.get(), kBlasLtMatmulMaxWorkspaceBytes, kBlasLtMatmulMaxAlgorithms);
+    OP_REQUIRES_OK(context, algorithms_or.status());
+    std::vector<std::unique_ptr<se::blas::IBlasLtMatmulAlgorithm>> algorithms =
+        algorithms_or.ConsumeValueOrDie();
+    OP_REQUIRES(context, !algorithms.empty(),
+                errors::Unimplemented(
+                    "No cublasLt algorithm for the int8 matrix multiplication "
+                    "of a.shape=",
+                    in_x.shape().DebugString(),
+                    ", b.shape=", in_y.shape().DebugString()));
+
+    const int8* a_base_ptr = in_x.flat<int8>().data();
+    const int8* b_base_ptr = in_y.flat<int8>().data();
+    int32* c_base_ptr = out->flat<int32>().data();
+    // Runs the multiplication of batch `i`, or of all batches when they are
+    // strided.
+    auto launch = [&](int64 i,
+                      const se::blas::IBlasLtMatmulAlgorithm* algorithm,
+                      se::blas::ProfileResult* profile_result) {
+      const int64 x_index =
+          use_strided_batched ? 0 : bcast.x_batch_indices()[i];
+      const int64 y_index =
+          use_strided_batched ? 0 : bcast.y_batch_indices()[i];
+      se::DeviceMemory<int8> a = AsDeviceMemory(b_base_ptr + y_index * k * n);
+      se::DeviceMemory<int8> b = AsDeviceMemory(a_base_ptr + x_index * m * k);
+      se::DeviceMemory<int32> c = AsDeviceMemory(c_base_ptr + i * m * n);
+      BlasScratchAllocator scratch_allocator(context);
+      return stream
+          ->ThenBlasLtMatmul(plan.get(), int32{1}, a, b, int32{0}, &c,
+                             &scratch_allocator, algorithm, {},
+                             profile_result)
+          .ok();
+    };
+
+    const int device_id = executor->device_ordinal();
+    BlasLtMatmulParameters params(plan_params, device_id);
+    se::blas::AlgorithmConfig algorithm_config(0);
+    if (!AutoTuneBlasLtMatmul::GetInstance()->Find(params, &algorithm_config) &&
+        MatmulAutotuneEnable() && algorithms.size() > 1) {
+      se::blas::ProfileResult best_result;
+      for (const auto& algorithm : algorithms) {
+        se::blas::ProfileResult profile_result;
+        // Profiling writes the output, which the selected algorithm then
+        // overwrites.
+        if (launch(0, algorithm.get(), &profile_result) &&
+            profile_result.is_valid() &&
+            profile_result.elapsed_time_in_ms() <
+                best_result.elapsed_time_in_ms()) {
+          best_result = profile_result;
+        }
+      }
+      if (best_result.is_valid()) {
+        algorithm_config.set_algorithm(best_result.algorithm());
+      }
+      AutoTuneBlasLtMatmul::GetInstance()->Insert(params, algorithm_config);
+    }
+    const se::blas::IBlasLtMatmulAlgorithm* algorithm = algorithms[0].get();
+    if (algorithm_config.algorithm() >= 0 &&
+        algorithm_config.algorithm() < algorithms.size()) {
+      algorithm = algorithms[algorithm_config.algorithm()].get();
+    }
+
+    for (int64 i = 0; i < (use_strided_batched ? 1 : batch_size); ++i) {
+      if (!launch(i, algorithm, /*profile_result=*/nullptr)) {
+        context->SetStatus(errors::Internal(
+            "cublasLt int8 matmul launch failed : a.shape=",
+            in_x.shape().DebugString(),
+            ", b.shape=", in_y.shape().DebugString(), ", m=", m, ", n=", n,
+            ", k=", k, ", batch_size=", batch_size));
+        return;
+      }
+    }
+  }
+};
+
+#endif  // GOOGLE_CUDA
+
 template <typename Device, typename Ta, typename Tb, typename Tout>
 class BaseBatchMatMulOp : public OpKernel {
  public:
@@ -719,17 +962,9 @@ class BaseBatchMatMulOp : public OpKernel {
       FloatToBFloat16(out_reshaped_float.flat<float>().data(),
                       out_reshaped.flat<bfloat16>().data(), out->NumElements());
     } else {
-      // Cast tensor to desired type to reuse Eigen.
-      // TODO(b/178749687): remove this cast if Eigen supports this natively.
-      if (!std::is_same<Ta, Tout>::value) {
-        in0_reshaped = CastTensor<Ta, Tout>(in0_reshaped);
-      }
-      if (!std::is_same<Tb, Tout>::value) {
-        in1_reshaped = CastTensor<Tb, Tout>(in1_reshaped);
-      }
-      LaunchBatchMatMul<Device, Tout>::Launch(ctx, in0_reshaped, in1_reshaped,
-                                              adj_x_, adj_y_, trans_x_,
-                                              trans_y_, bcast, &out_reshaped);
+      LaunchMixedTypeBatchMatMul<Device, Ta, Tb, Tout>::Launch(
+          ctx, in0_reshaped, in1_reshaped, adj_x_, adj_y_, trans_x_, trans_y_,
+          bcast, &out_reshaped);
     }
   }
 
@@ -743,14 +978,6 @@ class BaseBatchMatMulOp : public OpKernel {
   bool adj_y_ = false;
   bool trans_x_ = false;
   bool trans_y_ = false;
-
-  // Cast `t` from `SrcT` to `DstT`.
-  template <typename SrcT, typename DstT>
-  Tensor CastTensor(const Tensor& t) {
-    Tensor res = Tensor(DataTypeToEnum<DstT>::v(), t.shape());
-    res.flat<DstT>() = t.flat<SrcT>().template cast<DstT>();
-    return res;
-  }
 };
 
 // BatchMatMul Op implementation which disallows broadcasting.
@@ -49,4 +49,8 @@ REGISTER_BATCH_MATMUL_TOUT_GPU(float, float, float);
 REGISTER_BATCH_MATMUL_TOUT_GPU(double, double, double);
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#if GOOGLE_CUDA
+REGISTER_BATCH_MATMUL_TOUT_GPU(int8, int8, int32);
+#endif  // GOOGLE_CUDA
+
 }  // namespace tensorflow
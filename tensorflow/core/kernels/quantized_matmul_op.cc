@@ -17,6 +17,10 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #define GEMMLOWP_ALLOW_SLOW_SCALAR_FALLBACK
 #include "public/gemmlowp.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -198,4 +202,271 @@ REGISTER_KERNEL_BUILDER(Name("QuantizedMatMul")
                             .TypeConstraint<qint32>("Toutput"),
                         QuantizedMatMulOp<quint8, quint8, qint32>);
 
+// MKL builds register their own kernels for the fused ops below and rewrite
+// them in the graph.
+#ifndef INTEL_MKL
+
+namespace {
+
+// Splits a positive real multiplier into a 31 bit fixed point multiplier and
+// a power of two exponent, as expected by gemmlowp's output stages.
+void QuantizeMultiplier(double multiplier, int32* fixedpoint_multiplier,
+                        int* exponent) {
+  int shift = 0;
+  const double q = std::frexp(multiplier, &shift);
+  int64 q_fixed = static_cast<int64>(std::round(q * (1ll << 31)));
+  if (q_fixed == (1ll << 31)) {
+    q_fixed /= 2;
+    ++shift;
+  }
+  if (shift < -31) {
+    // Too small to be represented, every result rounds to zero.
+    q_fixed = 0;
+    shift = 0;
+  }
+  *fixedpoint_multiplier = static_cast<int32>(q_fixed);
+  *exponent = shift;
+}
+
+template <bool TransposeA, bool TransposeB, typename Tresult,
+          typename OutputPipeline>
+void GemmlowpMultiplyWithOutputPipeline(OpKernelContext* op_context,
+                                        const uint8* a_data,
+                                        const uint8* b_data, Tresult* c_data,
+                                        int m, int n, int k, int offset_b,
+                                        int lda, int ldb,
+                                        const OutputPipeline& pipeline) {
+  static const gemmlowp::MapOrder LhsOrder =
+      !TransposeA ? gemmlowp::MapOrder::RowMajor : gemmlowp::MapOrder::ColMajor;
+  static const gemmlowp::MapOrder RhsOrder =
+      !TransposeB ? gemmlowp::MapOrder::RowMajor : gemmlowp::MapOrder::ColMajor;
+  gemmlowp::MatrixMap<const std::uint8_t, LhsOrder> lhs(a_data, m, k, lda);
+  gemmlowp::MatrixMap<const std::uint8_t, RhsOrder> rhs(b_data, k, n, ldb);
+  gemmlowp::MatrixMap<Tresult, gemmlowp::MapOrder::RowMajor> result(c_data, m,
+                                                                    n, n);
+  auto& worker_threads =
+      *(op_context->device()->tensorflow_cpu_worker_threads());
+  TensorflowGemmContext context(worker_threads.num_threads,
+                                worker_threads.workers);
+  gemmlowp::GemmWithOutputPipeline<std::uint8_t, Tresult,
+                                   gemmlowp::DefaultL8R8BitDepthParams>(
+      &context, lhs, rhs, &result, /*lhs_offset=*/0, -offset_b, pipeline);
+  // Since gemmlowp uses assembly to write to the output, msan won't detect
+  // the output buffer as written to, so we mark it manually.
+  TF_ANNOTATE_MEMORY_IS_INITIALIZED(c_data, m * n * sizeof(Tresult));
+}
+
+template <typename Tresult, typename OutputPipeline>
+void MultiplyWithOutputPipeline(OpKernelContext* op_context, bool transpose_a,
+                                bool transpose_b, const uint8* a_data,
+                                const uint8* b_data, Tresult* c_data, int m,
+                                int n, int k, int offset_b, int lda, int ldb,
+                                const OutputPipeline& pipeline) {
+  if (transpose_a) {
+    if (transpose_b) {
+      GemmlowpMultiplyWithOutputPipeline<true, true>(
+          op_context, a_data, b_data, c_data, m, n, k, offset_b, lda, ldb,
+          pipeline);
+    } else {
+      GemmlowpMultiplyWithOutputPipeline<true, false>(
+          op_context, a_data, b_data, c_data, m, n, k, offset_b, lda, ldb,
+          pipeline);
+    }
+  } else {
+    if (transpose_b) {
+      GemmlowpMultiplyWithOutputPipeline<false, true>(
+          op_context, a_data, b_data, c_data, m, n, k, offset_b, lda, ldb,
+          pipeline);
+    } else {
+      GemmlowpMultiplyWithOutputPipeline<false, false>(
+          op_context, a_data, b_data, c_data, m, n, k, offset_b, lda, ldb,
+          pipeline);
+    }
+  }
+}
+
+}  // namespace
+
+// Portable implementation of QuantizedMatMulWithBiasAndRequantize and
+// QuantizedMatMulWithBiasAndDequantize, with the quantization scheme of the
+// MKL kernels (see mkl/mkl_qmatmul_op.cc): the quint8 activation `a` is
+// quantized in either MIN_FIRST or SCALED mode, the qint8 weights `b` are
+// quantized symmetrically with scale MaxAbs(b) / 127, and a qint32 bias is
+// already scaled to (and compensated in) the accumulator domain.
+//
+// The bias and the MIN_FIRST compensation are folded into one int32 vector
+// that gemmlowp adds in its output pipeline. For a quint8 output, the
+// pipeline also rescales the accumulators to the requested output range
+// [-MaxAbs(freezed), MaxAbs(freezed)] and saturates them, so no int32 matrix
+// and no separate Requantize op are needed.
+template <typename Toutput>
+class QuantizedMatMulWithBiasOp : public OpKernel {
+ public:
+  explicit QuantizedMatMulWithBiasOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+    string input_quant_mode;
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("input_quant_mode", &input_quant_mode));
+    min_first_ = input_quant_mode == "MIN_FIRST";
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& b = context->input(1);
+    const Tensor& bias = context->input(2);
+    const float min_a = context->input(3).flat<float>()(0);
+    const float max_a = context->input(4).flat<float>()(0);
+    const float min_b = context->input(5).flat<float>()(0);
+    const float max_b = context->input(6).flat<float>()(0);
+    const float min_freezed_output = context->input(7).flat<float>()(0);
+    const float max_freezed_output = context->input(8).flat<float>()(0);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("In[0] is not a matrix"));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("In[1] is not a matrix"));
+    const int k = a.dim_size(transpose_a_ ? 0 : 1);
+    OP_REQUIRES(context, k == b.dim_size(transpose_b_ ? 1 : 0),
+                errors::InvalidArgument("Matrix size-incompatible: In[0]: ",
+                                        a.shape().DebugString(),
+                                        ", In[1]: ", b.shape().DebugString()));
+    const int m = a.dim_size(transpose_a_ ? 1 : 0);
+    const int n = b.dim_size(transpose_b_ ? 0 : 1);
+    OP_REQUIRES(context, bias.NumElements() == n,
+                errors::InvalidArgument("Bias has ", bias.NumElements(),
+                                        " elements, expected ", n));
+
+    const float scale_a = (min_first_ ? max_a - min_a : max_a) / 255.0f;
+    const float scale_b = std::max(std::abs(min_b), std::abs(max_b)) / 127.0f;
+    OP_REQUIRES(context, scale_a > 0.0f,
+                errors::InvalidArgument("Invalid range for input a: [", min_a,
+                                        ", ", max_a, "]"));
+    OP_REQUIRES(context, scale_b > 0.0f,
+                errors::InvalidArgument("Invalid range for input b: [", min_b,
+                                        ", ", max_b, "]"));
+    // Scale of the int32 accumulators.
+    const double scale_ab = static_cast<double>(scale_a) * scale_b;
+
+    // gemmlowp multiplies unsigned matrices, so the weights are shifted into
+    // [0, 255] and the shift is undone with the offset of `b`.
+    const int offset_b = 128;
+    Tensor b_shifted;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_UINT8, b.shape(), &b_shifted));
+    const int8* b_data = &(b.flat<qint8>().data()->value);
+    uint8* b_shifted_data = b_shifted.flat<uint8>().data();
+    for (int64 i = 0; i < b.NumElements(); ++i) {
+      b_shifted_data[i] = static_cast<uint8>(b_data[i] + offset_b);
+    }
+
+    // Bias in the accumulator domain. With MIN_FIRST, `a` is stored as
+    // (a - min_a) / scale_a, which is compensated by adding
+    // min_a / scale_a * sum_k(b) to every output column.
+    Tensor bias_int32;
+    OP_REQUIRES_OK(context, context->allocate_temp(DT_INT32, TensorShape({n}),
+                                                   &bias_int32));
+    int32* bias_data = bias_int32.flat<int32>().data();
+    if (bias.dtype() == DT_QINT32) {
+      for (int j = 0; j < n; ++j) bias_data[j] = bias.flat<qint32>()(j).value;
+    } else {
+      const double offset_a = min_first_ ? min_a / scale_a : 0.0;
+      const int64 stride_k = transpose_b_ ? 1 : n;
+      const int64 stride_n = transpose_b_ ? k : 1;
+      for (int j = 0; j < n; ++j) {
+        int64 sum_b = 0;
+        if (offset_a != 0.0) {
+          for (int i = 0; i < k; ++i) {
+            sum_b += b_data[i * stride_k + j * stride_n];
+          }
+        }
+        const double value =
+            bias.flat<float>()(j) / scale_ab + offset_a * sum_b;
+        bias_data[j] = static_cast<int32>(std::round(std::min<double>(
+            std::max<double>(value, std::numeric_limits<int32>::lowest()),
+            std::numeric_limits<int32>::max())));
+      }
+    }
+    gemmlowp::OutputStageBiasAddition<
+        gemmlowp::VectorMap<const int32, gemmlowp::VectorShape::Row>>
+        bias_stage;
+    bias_stage.bias_vector =
+        gemmlowp::VectorMap<const int32, gemmlowp::VectorShape::Row>(bias_data,
+                                                                      n);
+
+    const uint8* a_data = &(a.flat<quint8>().data()->value);
+    const int lda = a.dim_size(1);
+    const int ldb = b.dim_size(1);
+    Tensor* c = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, TensorShape({m, n}), &c));
+    if (std::is_same<Toutput, quint8>::value) {
+      const float scale_c =
+          std::max(std::abs(min_freezed_output), std::abs(max_freezed_output)) /
+          255.0f;
+      OP_REQUIRES(context, scale_c > 0.0f,
+                  errors::InvalidArgument("Invalid output range: [",
+                                          min_freezed_output, ", ",
+                                          max_freezed_output, "]"));
+      gemmlowp::OutputStageScaleInt32ByFixedPointAndExponent scale_stage;
+      QuantizeMultiplier(scale_ab / scale_c,
+                         &scale_stage.result_fixedpoint_multiplier,
+                         &scale_stage.result_exponent);
+      scale_stage.result_offset_after_shift = 0;
+      const auto pipeline =
+          std::make_tuple(bias_stage, scale_stage,
+                          gemmlowp::OutputStageSaturatingCastToUint8());
+      MultiplyWithOutputPipeline(
+          context, transpose_a_, transpose_b_, a_data, b_shifted_data,
+          &(c->flat<quint8>().data()->value), m, n, k, offset_b, lda, ldb,
+          pipeline);
+
+      Tensor* c_min = nullptr;
+      OP_REQUIRES_OK(context, context->allocate_output(1, {}, &c_min));
+      c_min->flat<float>()(0) = min_freezed_output;
+      Tensor* c_max = nullptr;
+      OP_REQUIRES_OK(context, context->allocate_output(2, {}, &c_max));
+      c_max->flat<float>()(0) = max_freezed_output;
+    } else {
+      Tensor c_int32;
+      OP_REQUIRES_OK(context, context->allocate_temp(
+                                  DT_INT32, TensorShape({m, n}), &c_int32));
+      MultiplyWithOutputPipeline(
+          context, transpose_a_, transpose_b_, a_data, b_shifted_data,
+          c_int32.flat<int32>().data(), m, n, k, offset_b, lda, ldb,
+          std::make_tuple(bias_stage));
+      const auto& device = context->eigen_device<Eigen::ThreadPoolDevice>();
+      c->flat<float>().device(device) =
+          c_int32.flat<int32>().cast<float>() * static_cast<float>(scale_ab);
+    }
+  }
+
+ private:
+  bool transpose_a_;
+  bool transpose_b_;
+  bool min_first_;
+};
+
+#define REGISTER_QUANTIZED_MATMUL_WITH_BIAS(name, Tbias, Toutput)  \
+  REGISTER_KERNEL_BUILDER(Name(name)                               \
+                              .Device(DEVICE_CPU)                  \
+                              .TypeConstraint<quint8>("T1")        \
+                              .TypeConstraint<qint8>("T2")         \
+                              .TypeConstraint<Tbias>("Tbias")      \
+                              .TypeConstraint<Toutput>("Toutput"), \
+                          QuantizedMatMulWithBiasOp<Toutput>);
+
+REGISTER_QUANTIZED_MATMUL_WITH_BIAS("QuantizedMatMulWithBiasAndRequantize",
+                                    float, quint8);
+REGISTER_QUANTIZED_MATMUL_WITH_BIAS("QuantizedMatMulWithBiasAndRequantize",
+                                    qint32, quint8);
+REGISTER_QUANTIZED_MATMUL_WITH_BIAS("QuantizedMatMulWithBiasAndDequantize",
+                                    float, float);
+REGISTER_QUANTIZED_MATMUL_WITH_BIAS("QuantizedMatMulWithBiasAndDequantize",
+                                    qint32, float);
+#undef REGISTER_QUANTIZED_MATMUL_WITH_BIAS
+
+#endif  // INTEL_MKL
+
 }  // namespace tensorflow
@@ -355,4 +355,88 @@ TEST_F(QuantizedMatMulTest, Medium_WithParams) {
   test::ExpectTensorNear<float>(expected_float, output_float, 15.0);
 }
 
+#ifndef INTEL_MKL
+TEST_F(QuantizedMatMulTest, WithBiasAndRequantize) {
+  TF_ASSERT_OK(NodeDefBuilder("quantized_mat_mul_op",
+                              "QuantizedMatMulWithBiasAndRequantize")
+                   .Input(FakeInput(DT_QUINT8))
+                   .Input(FakeInput(DT_QINT8))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("Toutput", DataTypeToEnum<quint8>::v())
+                   .Attr("input_quant_mode", "SCALED")
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  // A matrix is:
+  // |  1 |  2 |
+  // |  3 |  4 |
+  AddInputFromArray<quint8>(TensorShape({2, 2}), {1, 2, 3, 4});
+  // B matrix is:
+  // |  1 | -1 |
+  // |  2 |  0 |
+  AddInputFromArray<qint8>(TensorShape({2, 2}), {1, -1, 2, 0});
+  AddInputFromArray<float>(TensorShape({2}), {1.0f, 10.0f});
+  // Both inputs are quantized with a scale of one.
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  AddInputFromArray<float>(TensorShape({}), {255.0f});
+  AddInputFromArray<float>(TensorShape({}), {-127.0f});
+  AddInputFromArray<float>(TensorShape({}), {127.0f});
+  // The output is quantized with a scale of one half.
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  AddInputFromArray<float>(TensorShape({}), {127.5f});
+
+  TF_ASSERT_OK(RunOpKernel());
+  // A * B + bias is:
+  // |  6 |  9 |
+  // | 12 |  7 |
+  Tensor expected(allocator(), DT_QUINT8, TensorShape({2, 2}));
+  test::FillValues<quint8>(&expected, {12, 18, 24, 14});
+  test::ExpectTensorEqual<quint8>(expected, *GetOutput(0));
+  EXPECT_EQ(GetOutput(1)->flat<float>()(0), 0.0f);
+  EXPECT_EQ(GetOutput(2)->flat<float>()(0), 127.5f);
+}
+
+TEST_F(QuantizedMatMulTest, WithBiasAndDequantize_MinFirst) {
+  TF_ASSERT_OK(NodeDefBuilder("quantized_mat_mul_op",
+                              "QuantizedMatMulWithBiasAndDequantize")
+                   .Input(FakeInput(DT_QUINT8))
+                   .Input(FakeInput(DT_QINT8))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("Toutput", DataTypeToEnum<float>::v())
+                   .Attr("transpose_b", true)
+                   .Attr("input_quant_mode", "MIN_FIRST")
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  // With a range of [-10, 245], A is stored as A + 10:
+  // |  1 |  2 |
+  // |  3 |  4 |
+  AddInputFromArray<quint8>(TensorShape({2, 2}), {11, 12, 13, 14});
+  // B is the same as above, stored transposed.
+  AddInputFromArray<qint8>(TensorShape({2, 2}), {1, 2, -1, 0});
+  AddInputFromArray<float>(TensorShape({2}), {1.0f, 10.0f});
+  AddInputFromArray<float>(TensorShape({}), {-10.0f});
+  AddInputFromArray<float>(TensorShape({}), {245.0f});
+  AddInputFromArray<float>(TensorShape({}), {-127.0f});
+  AddInputFromArray<float>(TensorShape({}), {127.0f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {6.0f, 9.0f, 12.0f, 7.0f});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+#endif  // INTEL_MKL
+
 }  // namespace tensorflow
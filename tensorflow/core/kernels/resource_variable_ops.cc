@@ -53,6 +53,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/resource_variable_ops.h"
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -73,10 +74,12 @@ limitations under the License.
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/casts.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
@@ -638,6 +641,24 @@ REGISTER_KERNEL_BUILDER(Name("VarIsInitializedOp")
                             .HostMemory("is_initialized"),
                         IsResourceInitialized<Var>);
 
+namespace {
+
+// Records the rows gathered from resource variables in host memory. When such
+// a variable serves an accelerator, e.g. as an embedding table too large for
+// device memory, these rows are what crosses the host-device link.
+void RecordHostResourceGather(int64 num_rows, int64 num_bytes) {
+  static auto* rows_counter = monitoring::Counter<0>::New(
+      "/tensorflow/core/host_resource_gather_rows",
+      "The number of rows gathered from host-resident resource variables.");
+  static auto* bytes_counter = monitoring::Counter<0>::New(
+      "/tensorflow/core/host_resource_gather_bytes",
+      "The number of bytes gathered from host-resident resource variables.");
+  rows_counter->GetCell()->IncrementBy(num_rows);
+  bytes_counter->GetCell()->IncrementBy(num_bytes);
+}
+
+}  // namespace
+
 template <typename Device, typename T, typename Index>
 class ResourceGatherOp : public OpKernel {
  public:
@@ -729,6 +750,9 @@ class ResourceGatherOp : public OpKernel {
           errors::InvalidArgument(
               "indices", SliceDebugString(indices.shape(), bad_i), " = ",
               indices_flat(bad_i), " is not in [0, ", params.dim_size(0), ")"));
+      if (std::is_same<Device, Eigen::ThreadPoolDevice>::value) {
+        RecordHostResourceGather(N, out->TotalBytes());
+      }
     }
   }
 
@@ -861,6 +885,70 @@ TF_CALL_GPU_NUMBER_TYPES(REGISTER_GATHER_ND_GPU);
 #undef REGISTER_GATHER_ND_ALL_INDICES
 #undef REGISTER_GATHER_ND_FULL
 
+namespace {
+
+// Whether scatters to POD variables on CPU hold the variable's mutex shared
+// plus the row stripes they touch. Without it they hold the mutex shared and
+// may interleave (concurrent adds to one row can lose updates), or hold it
+// exclusively when asked to lock. With it, overlapping scatters serialize and
+// scatters to disjoint row ranges run concurrently; dense reads that overlap
+// a scatter may observe it partially applied. Set through the environment
+// variable TF_RESOURCE_SCATTER_LOCK_STRIPING, read once.
+std::atomic<bool>& ScatterLockStripingEnabled() {
+  static std::atomic<bool>* enabled = [] {
+    bool enabled;
+    Status status = ReadBoolFromEnvVar("TF_RESOURCE_SCATTER_LOCK_STRIPING",
+                                       false, &enabled);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      enabled = false;
+    }
+    return new std::atomic<bool>(enabled);
+  }();
+  return *enabled;
+}
+
+// Holds the row stripe locks of a variable that cover the rows in 'indices'.
+// Requires the variable's mutex to be held, so that its shape is stable.
+template <typename Index>
+class ScopedRowStripeLocks {
+ public:
+  ScopedRowStripeLocks(Var* var, const Tensor& indices)
+      TF_NO_THREAD_SAFETY_ANALYSIS : var_(var) {
+    const Tensor& params = *var->tensor();
+    if (params.dims() == 0 || params.dim_size(0) == 0) return;
+    const int64 num_rows = params.dim_size(0);
+    const auto indices_flat = indices.flat<Index>();
+    for (int64 i = 0; i < indices_flat.size(); ++i) {
+      const int64 row = internal::SubtleMustCopy(indices_flat(i));
+      // Out-of-range indices are reported by the scatter itself.
+      if (row < 0 || row >= num_rows) continue;
+      stripes_ |= uint32{1} << (row * Var::kNumRowStripes / num_rows);
+    }
+    for (int s = 0; s < Var::kNumRowStripes; ++s) {
+      if (stripes_ & (uint32{1} << s)) var_->row_stripe_mu(s)->lock();
+    }
+  }
+
+  ~ScopedRowStripeLocks() TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (int s = Var::kNumRowStripes - 1; s >= 0; --s) {
+      if (stripes_ & (uint32{1} << s)) var_->row_stripe_mu(s)->unlock();
+    }
+  }
+
+ private:
+  Var* const var_;
+  uint32 stripes_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedRowStripeLocks);
+};
+
+}  // namespace
+
+void TestOnlySetResourceScatterLockStriping(bool enabled) {
+  ScatterLockStripingEnabled().store(enabled, std::memory_order_relaxed);
+}
+
 template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 class ResourceScatterUpdateOp : public OpKernel {
  public:
@@ -880,7 +968,17 @@ class ResourceScatterUpdateOp : public OpKernel {
     const bool is_non_pod_dtype = c->input_dtype(0) == DT_RESOURCE ||
                                   c->input_dtype(0) == DT_STRING ||
                                   c->input_dtype(0) == DT_VARIANT;
-    if (is_non_pod_dtype || use_exclusive_lock_) {
+    // Striping only protects work done before the locks are released, which
+    // excludes updates enqueued on an accelerator stream.
+    const bool use_row_stripes =
+        !is_non_pod_dtype &&
+        std::is_same<Device, Eigen::ThreadPoolDevice>::value &&
+        ScatterLockStripingEnabled().load(std::memory_order_relaxed);
+    if (use_row_stripes) {
+      tf_shared_lock ml(*v->mu());
+      ScopedRowStripeLocks<Index> stripes(v.get(), c->input(1));
+      DoCompute(c);
+    } else if (is_non_pod_dtype || use_exclusive_lock_) {
       mutex_lock ml(*v->mu());
       DoCompute(c);
     } else {
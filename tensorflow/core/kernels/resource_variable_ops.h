@@ -87,6 +87,10 @@ class VariableShapeOp : public OpKernel {
   }
 };
 
+// Overrides TF_RESOURCE_SCATTER_LOCK_STRIPING, which is read once per process,
+// for scatters run after the call.
+void TestOnlySetResourceScatterLockStriping(bool enabled);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_RESOURCE_VARIABLE_OPS_H_
@@ -0,0 +1,180 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/resource_variable_ops.h"
+#include "tensorflow/core/kernels/variable_ops.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/collected_metrics.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the value of the counter `metric_name`, or 0 if it has no value yet.
+int64 GetCounter(const string& metric_name) {
+  std::unique_ptr<monitoring::CollectedMetrics> collected =
+      monitoring::CollectionRegistry::Default()->CollectMetrics({});
+  auto it = collected->point_set_map.find(metric_name);
+  if (it == collected->point_set_map.end() || it->second->points.empty()) {
+    return 0;
+  }
+  return it->second->points[0]->int64_value;
+}
+
+class ResourceVariableOpsTest : public OpsTestBase {
+ protected:
+  // Adds a resource input for a variable holding `value`, and returns the
+  // variable, which is owned by the resource manager.
+  Var* AddVariableInput(const Tensor& value) {
+    Var* var = new Var(value.dtype());
+    *var->tensor() = value;
+    var->is_initialized = true;
+    AddResourceInput("", "var", var);
+    return var;
+  }
+
+  void MakeScatterAddOp() {
+    TF_ASSERT_OK(NodeDefBuilder("op", "ResourceScatterAdd")
+                     .Input(FakeInput(DT_RESOURCE))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("dtype", DT_FLOAT)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(ResourceVariableOpsTest, GatherCountsHostRows) {
+  TF_ASSERT_OK(NodeDefBuilder("op", "ResourceGather")
+                   .Input(FakeInput(DT_RESOURCE))
+                   .Input(FakeInput(DT_INT32))
+                   .Attr("dtype", DT_FLOAT)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddVariableInput(
+      test::AsTensor<float>({0, 1, 2, 3, 4, 5, 6, 7}, TensorShape({4, 2})));
+  AddInputFromArray<int32>(TensorShape({3}), {3, 0, 3});
+
+  const int64 rows = GetCounter("/tensorflow/core/host_resource_gather_rows");
+  const int64 bytes = GetCounter("/tensorflow/core/host_resource_gather_bytes");
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({6, 7, 0, 1, 6, 7}, TensorShape({3, 2})));
+  EXPECT_EQ(rows + 3,
+            GetCounter("/tensorflow/core/host_resource_gather_rows"));
+  EXPECT_EQ(bytes + 3 * 2 * sizeof(float),
+            GetCounter("/tensorflow/core/host_resource_gather_bytes"));
+}
+
+// Enables scatter lock striping for the lifetime of the object.
+class ScopedScatterLockStriping {
+ public:
+  ScopedScatterLockStriping() { TestOnlySetResourceScatterLockStriping(true); }
+  ~ScopedScatterLockStriping() {
+    TestOnlySetResourceScatterLockStriping(false);
+  }
+};
+
+// Returns a variable value of `kNumRowStripes` rows of 2 zeros, so that row
+// `i` is covered by stripe `i`.
+Tensor StripedZeros() {
+  Tensor value(DT_FLOAT, TensorShape({Var::kNumRowStripes, 2}));
+  value.flat<float>().setZero();
+  return value;
+}
+
+TEST_F(ResourceVariableOpsTest, StripedScatterAdd) {
+  ScopedScatterLockStriping striping;
+  MakeScatterAddOp();
+  Var* var = AddVariableInput(StripedZeros());
+  AddInputFromArray<int32>(TensorShape({3}), {1, 9, 1});
+  AddInputFromArray<float>(TensorShape({3, 2}), {1, 2, 3, 4, 5, 6});
+
+  TF_ASSERT_OK(RunOpKernel());
+  auto rows = var->tensor()->matrix<float>();
+  EXPECT_EQ(rows(1, 0), 6);
+  EXPECT_EQ(rows(1, 1), 8);
+  EXPECT_EQ(rows(9, 0), 3);
+  EXPECT_EQ(rows(9, 1), 4);
+  EXPECT_EQ(rows(0, 0), 0);
+}
+
+TEST_F(ResourceVariableOpsTest, StripedScatterIgnoresDisjointStripes) {
+  ScopedScatterLockStriping striping;
+  MakeScatterAddOp();
+  Var* var = AddVariableInput(StripedZeros());
+  AddInputFromArray<int32>(TensorShape({1}), {9});
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 2});
+
+  // Holding the stripes of other rows does not block the scatter.
+  mutex_lock stripe_0(*var->row_stripe_mu(0));
+  mutex_lock stripe_10(*var->row_stripe_mu(10));
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(var->tensor()->matrix<float>()(9, 1), 2);
+}
+
+TEST_F(ResourceVariableOpsTest, StripedScatterWaitsForItsStripes) {
+  ScopedScatterLockStriping striping;
+  MakeScatterAddOp();
+  Var* var = AddVariableInput(StripedZeros());
+  AddInputFromArray<int32>(TensorShape({2}), {2, 9});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+
+  var->row_stripe_mu(9)->lock();
+  Notification done;
+  Status status;
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread(ThreadOptions(), "scatter", [&]() {
+        status = RunOpKernel();
+        done.Notify();
+      }));
+  EXPECT_FALSE(WaitForNotificationWithTimeout(&done, 10000));
+  // Row 2 is in a free stripe, but the scatter applies nothing until it holds
+  // all of its stripes.
+  EXPECT_EQ(var->tensor()->matrix<float>()(2, 0), 0);
+
+  var->row_stripe_mu(9)->unlock();
+  done.WaitForNotification();
+  TF_ASSERT_OK(status);
+  EXPECT_EQ(var->tensor()->matrix<float>()(2, 0), 1);
+  EXPECT_EQ(var->tensor()->matrix<float>()(9, 1), 4);
+}
+
+TEST_F(ResourceVariableOpsTest, UnstripedScatterTakesNoStripes) {
+  MakeScatterAddOp();
+  Var* var = AddVariableInput(StripedZeros());
+  AddInputFromArray<int32>(TensorShape({1}), {9});
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 2});
+
+  mutex_lock stripe_9(*var->row_stripe_mu(9));
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(var->tensor()->matrix<float>()(9, 1), 2);
+}
+
+}  // namespace
+}  // namespace tensorflow
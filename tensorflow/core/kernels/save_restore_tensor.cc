@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
+#include <algorithm>
 #include <numeric>
 #include <unordered_map>
 #include <utility>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -239,8 +241,7 @@ const int64 kLargeShapeThreshold = 16 << 20;  // 16M
 
 // A restore operation for a single tensor.  Small tensors may be restored
 // directly from the op thread to improve read locality.  Large tensors can be
-// restored from a thread pool: this requires creating a separate BundleReader
-// for each restore.
+// restored from a thread pool, sharing the op's BundleReader.
 struct RestoreOp {
   RestoreOp& operator=(const RestoreOp&) = delete;
 
@@ -255,17 +256,6 @@ struct RestoreOp {
     return restored_full_shape.num_elements() > kLargeShapeThreshold;
   }
 
-  // Run this restore operation using a new BundleReader.
-  void run_with_new_reader() {
-    BundleReader reader(Env::Default(), reader_prefix);
-    if (!reader.status().ok()) {
-      status = reader.status();
-      return;
-    }
-
-    status = run(&reader);
-  }
-
   Status run(BundleReader* reader) {
     TensorShape restored_full_shape;
     TF_RETURN_IF_ERROR(
@@ -274,7 +264,13 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && map_data_files) {
+      // Lookup the full tensor, possibly as a view of the mapped data file.
+      Tensor mapped;
+      TF_RETURN_IF_ERROR(reader->LookupMapped(tensor_name, &mapped));
+      context->set_output(idx, mapped);
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -326,7 +322,7 @@ struct RestoreOp {
   size_t idx;
   string tensor_name;
   string shape_and_slice;
-  string reader_prefix;
+  bool map_data_files;
 
   ::tensorflow::Status status;
 };
@@ -353,7 +349,34 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   std::vector<std::unique_ptr<RestoreOp> > pool_restore_ops;
   std::vector<std::unique_ptr<RestoreOp> > direct_restore_ops;
 
-  BundleReader default_reader(Env::Default(), prefix_string);
+  // The number of large tensors restored concurrently, and the parallelism and
+  // chunk size of the reads of each of them.
+  int64 num_restore_threads;
+  TF_RETURN_IF_ERROR(
+      ReadInt64FromEnvVar("TF_RESTORE_NUM_THREADS", 8, &num_restore_threads));
+  int64 num_read_threads;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_RESTORE_NUM_READ_THREADS", 1,
+                                         &num_read_threads));
+  int64 read_chunk_size_mb;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_RESTORE_READ_CHUNK_SIZE_IN_MB", 64,
+                                         &read_chunk_size_mb));
+  // Lazy restore: full tensors are returned as views of the memory-mapped
+  // data files, so their pages are only read when kernels first touch them
+  // (or by the background warmup).  On by default for immutable bundles.
+  bool map_data_files;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_RESTORE_MAP_DATA_FILES",
+                                        IsBundleImmutable(prefix_string),
+                                        &map_data_files));
+  bool warm_up_mapped_tensors;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_RESTORE_WARM_UP_MAPPED_TENSORS",
+                                        true, &warm_up_mapped_tensors));
+  BundleReader::Options reader_options;
+  reader_options.num_read_threads = num_read_threads;
+  reader_options.read_chunk_bytes = read_chunk_size_mb << 20;
+  reader_options.map_data_files = map_data_files;
+
+  // The reader is shared by all the restores of this op.
+  BundleReader default_reader(Env::Default(), prefix_string, reader_options);
   TF_RETURN_IF_ERROR(default_reader.status());
 
   std::vector<string> mismatched_errors;
@@ -379,8 +402,8 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
     const string& shape_and_slice = shape_and_slices_flat(i);
-    auto op =
-        new RestoreOp{context, i, tensor_name, shape_and_slice, prefix_string};
+    auto op = new RestoreOp{context, i, tensor_name, shape_and_slice,
+                            map_data_files};
     if (op->should_run_in_pool(&default_reader)) {
       pool_restore_ops.emplace_back(op);
     } else {
@@ -393,10 +416,13 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     // we don't have any expensive operations.
     std::unique_ptr<thread::ThreadPool> reader_pool;
     if (!pool_restore_ops.empty()) {
-      reader_pool.reset(
-          new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
+      reader_pool.reset(new thread::ThreadPool(
+          Env::Default(), "restore_tensors",
+          std::max<int64>(num_restore_threads, 1)));
       for (auto& op : pool_restore_ops) {
-        reader_pool->Schedule([&op]() { op->run_with_new_reader(); });
+        reader_pool->Schedule([&op, &default_reader]() {
+          op->status = op->run(&default_reader);
+        });
       }
     }
 
@@ -410,6 +436,9 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   for (auto& op : pool_restore_ops) {
     TF_RETURN_IF_ERROR(op->status);
   }
+  if (warm_up_mapped_tensors) {
+    default_reader.WarmUpMappedTensors();
+  }
 
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
@@ -15,7 +15,9 @@ limitations under the License.
 
 // See docs in ../ops/io_ops.cc.
 
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
@@ -28,6 +30,8 @@ limitations under the License.
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -87,6 +91,89 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
 
 }  // namespace
 
+namespace {
+
+// Writes "tensors" to a tensor bundle at "prefix", under the names in
+// "tensor_names" and the slice specs in "shape_and_slices".
+Status WriteTensorsV2(const string& prefix_string,
+                      const std::vector<string>& tensor_names,
+                      const std::vector<string>& shape_and_slices,
+                      const std::vector<Tensor>& tensors) {
+  // Aligned tensor data lets restores map the data files instead of reading
+  // them (see BundleReader::LookupMapped()).
+  BundleWriter::Options writer_options;
+  writer_options.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+  BundleWriter writer(Env::Default(), prefix_string, writer_options);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
+
+  for (int i = 0; i < tensors.size(); ++i) {
+    const string& tensor_name = tensor_names[i];
+    const Tensor& tensor = tensors[i];
+    VLOG(2) << "Starting save of " << tensor_name;
+
+    if (!shape_and_slices[i].empty()) {
+      const string& shape_spec = shape_and_slices[i];
+      TensorShape shape;
+      TensorSlice slice(tensor.dims());
+      TensorShape slice_shape;
+
+      TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(shape_spec, &shape,
+                                                        &slice, &slice_shape));
+      if (!slice_shape.IsSameSize(tensor.shape())) {
+        return errors::InvalidArgument(
+            "Slice in shape_and_slice specification does not match the shape "
+            "of the tensor to  save: ",
+            shape_spec, ", tensor: ", tensor.shape().DebugString());
+      }
+
+      TF_RETURN_IF_ERROR(writer.AddSlice(tensor_name, shape, slice, tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(tensor_name, tensor));
+    }
+
+    if (VLOG_IS_ON(5)) {
+      if (tensor.dtype() == DT_FLOAT) {
+        const float* t_data = tensor.flat<float>().data();
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        double avg = 0.0;
+        for (int i = 0; i < tensor.NumElements(); ++i) {
+          if (t_data[i] < min) min = t_data[i];
+          if (t_data[i] > max) max = t_data[i];
+          avg += t_data[i];
+        }
+        VLOG(5) << " min " << min << " max " << max << " avg "
+                << avg / tensor.NumElements() << " total elts "
+                << tensor.NumElements();
+      }
+    }
+
+    VLOG(2) << "Done save of " << tensor_name;
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
+  return Status::OK();
+}
+
+// Collects the names, slice specs and tensors of a SaveV2 or AsyncSaveV2 op.
+void GetTensorsToSave(OpKernelContext* context,
+                      std::vector<string>* tensor_names,
+                      std::vector<string>* shape_and_slices,
+                      std::vector<Tensor>* tensors) {
+  const int kFixedInputs = 3;  // Prefix, tensor names, shape_and_slices.
+  const auto& tensor_names_flat = context->input(1).flat<tstring>();
+  const auto& shape_and_slices_flat = context->input(2).flat<tstring>();
+  const int num_tensors = static_cast<int>(tensor_names_flat.size());
+  for (int i = 0; i < num_tensors; ++i) {
+    tensor_names->emplace_back(tensor_names_flat(i));
+    shape_and_slices->emplace_back(shape_and_slices_flat(i));
+    tensors->push_back(context->input(i + kFixedInputs));
+  }
+}
+
+}  // namespace
+
 // Saves a list of named tensors using the tensor bundle library.
 class SaveV2 : public OpKernel {
  public:
@@ -98,67 +185,153 @@ class SaveV2 : public OpKernel {
     const Tensor& shape_and_slices = context->input(2);
     ValidateInputs(true /* is save op */, context, prefix, tensor_names,
                    shape_and_slices);
+    if (!context->status().ok()) return;
 
-    const int kFixedInputs = 3;  // Prefix, tensor names, shape_and_slices.
-    const int num_tensors = static_cast<int>(tensor_names.NumElements());
-    const string& prefix_string = prefix.scalar<tstring>()();
-    const auto& tensor_names_flat = tensor_names.flat<tstring>();
-    const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
-
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
-    for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
-      const Tensor& tensor = context->input(i + kFixedInputs);
-      VLOG(2) << "Starting save of " << tensor_name;
-
-      if (!shape_and_slices_flat(i).empty()) {
-        const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
-        TensorShape slice_shape;
-
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
-        OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
-                    errors::InvalidArgument("Slice in shape_and_slice "
-                                            "specification does not match the "
-                                            "shape of the tensor to  save: ",
-                                            shape_spec, ", tensor: ",
-                                            tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
-      }
+    std::vector<string> tensor_names_vec;
+    std::vector<string> shape_and_slices_vec;
+    std::vector<Tensor> tensors;
+    GetTensorsToSave(context, &tensor_names_vec, &shape_and_slices_vec,
+                     &tensors);
+    OP_REQUIRES_OK(context,
+                   WriteTensorsV2(prefix.scalar<tstring>()(), tensor_names_vec,
+                                  shape_and_slices_vec, tensors));
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
+
+namespace {
+
+// Writes the checkpoints of the AsyncSaveV2 ops of the process on a background
+// thread, one at a time.
+class AsyncCheckpointWriter {
+ public:
+  static AsyncCheckpointWriter* Global() {
+    static AsyncCheckpointWriter* writer = new AsyncCheckpointWriter;
+    return writer;
+  }
 
-      if (VLOG_IS_ON(5)) {
-        if (tensor.dtype() == DT_FLOAT) {
-          const float* t_data = tensor.flat<float>().data();
-          float min = std::numeric_limits<float>::infinity();
-          float max = -std::numeric_limits<float>::infinity();
-          double avg = 0.0;
-          for (int i = 0; i < tensor.NumElements(); ++i) {
-            if (t_data[i] < min) min = t_data[i];
-            if (t_data[i] > max) max = t_data[i];
-            avg += t_data[i];
-          }
-          VLOG(5) << " min " << min << " max " << max << " avg "
-                  << avg / tensor.NumElements() << " total elts "
-                  << tensor.NumElements();
+  // Waits for the pending save to finish, schedules the save of "tensors" at
+  // "prefix", and returns the status of the finished save.  If "delta" is
+  // true, only the tensors that changed since the last delta save are written.
+  Status Schedule(const string& prefix, std::vector<string> tensor_names,
+                  std::vector<string> shape_and_slices,
+                  std::vector<Tensor> tensors, bool delta) {
+    mutex_lock l(mu_);
+    while (pending_) cv_.wait(l);
+    Status previous_status = status_;
+    status_ = Status::OK();
+
+    if (delta) {
+      // The saved tensors share their buffers with the variables, which copy
+      // their buffers on write while they are shared.  A tensor whose buffer
+      // is still the one of the last save is therefore unchanged.
+      int num_changed = 0;
+      for (int i = 0; i < tensors.size(); ++i) {
+        Tensor& last_saved =
+            last_saved_[std::make_pair(tensor_names[i], shape_and_slices[i])];
+        const bool changed = !last_saved.SharesBufferWith(tensors[i]) ||
+                             last_saved.shape() != tensors[i].shape();
+        last_saved = tensors[i];
+        if (!changed) continue;
+        if (num_changed != i) {
+          tensor_names[num_changed] = std::move(tensor_names[i]);
+          shape_and_slices[num_changed] = std::move(shape_and_slices[i]);
+          tensors[num_changed] = std::move(tensors[i]);
         }
+        ++num_changed;
       }
-
-      VLOG(2) << "Done save of " << tensor_name;
+      tensor_names.resize(num_changed);
+      shape_and_slices.resize(num_changed);
+      tensors.resize(num_changed);
+    } else {
+      last_saved_.clear();
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
+
+    pending_ = true;
+    thread_->Schedule([this, prefix, tensor_names, shape_and_slices,
+                       tensors]() {
+      Status status =
+          WriteTensorsV2(prefix, tensor_names, shape_and_slices, tensors);
+      mutex_lock l(mu_);
+      status_ = status;
+      pending_ = false;
+      cv_.notify_all();
+    });
+    return previous_status;
+  }
+
+  // Waits for the pending save to finish and returns its status.
+  Status Wait() {
+    mutex_lock l(mu_);
+    while (pending_) cv_.wait(l);
+    Status status = status_;
+    status_ = Status::OK();
+    return status;
   }
+
+ private:
+  AsyncCheckpointWriter()
+      : thread_(new thread::ThreadPool(Env::Default(), "async_checkpoint",
+                                       /*num_threads=*/1)) {}
+
+  mutex mu_;
+  condition_variable cv_;
+  // Whether a save is being written.
+  bool pending_ TF_GUARDED_BY(mu_) = false;
+  // The status of the last finished save that has not been reported yet.
+  Status status_ TF_GUARDED_BY(mu_);
+  // The tensors of the last delta save, by name and slice spec.
+  std::map<std::pair<string, string>, Tensor> last_saved_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<thread::ThreadPool> thread_;
 };
-REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
+
+}  // namespace
+
+// Saves a list of named tensors like SaveV2, on a background thread.
+class AsyncSaveV2 : public OpKernel {
+ public:
+  explicit AsyncSaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("delta", &delta_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& prefix = context->input(0);
+    const Tensor& tensor_names = context->input(1);
+    const Tensor& shape_and_slices = context->input(2);
+    ValidateInputs(true /* is save op */, context, prefix, tensor_names,
+                   shape_and_slices);
+    if (!context->status().ok()) return;
+
+    std::vector<string> tensor_names_vec;
+    std::vector<string> shape_and_slices_vec;
+    std::vector<Tensor> tensors;
+    GetTensorsToSave(context, &tensor_names_vec, &shape_and_slices_vec,
+                     &tensors);
+    OP_REQUIRES_OK(context,
+                   AsyncCheckpointWriter::Global()->Schedule(
+                       prefix.scalar<tstring>()(), std::move(tensor_names_vec),
+                       std::move(shape_and_slices_vec), std::move(tensors),
+                       delta_));
+  }
+
+ private:
+  // Whether to write only the tensors that changed since the last delta save.
+  bool delta_;
+};
+REGISTER_KERNEL_BUILDER(Name("AsyncSaveV2").Device(DEVICE_CPU), AsyncSaveV2);
+
+// Waits for the pending AsyncSaveV2 save to finish.
+class WaitForAsyncSaves : public OpKernel {
+ public:
+  explicit WaitForAsyncSaves(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    OP_REQUIRES_OK(context, AsyncCheckpointWriter::Global()->Wait());
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("WaitForAsyncSaves").Device(DEVICE_CPU),
+                        WaitForAsyncSaves);
 
 // Restores a list of named tensors from a tensor bundle (V2 checkpoint format).
 class RestoreV2 : public OpKernel {
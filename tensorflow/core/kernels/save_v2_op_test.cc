@@ -15,11 +15,13 @@ limitations under the License.
 
 #include <complex>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
@@ -340,5 +342,96 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+class AsyncSaveV2OpTest : public OpsTestBase {
+ protected:
+  // Runs an AsyncSaveV2 op that saves "tensors" under "names" at "prefix".
+  Status RunSave(const string& prefix, const std::vector<string>& names,
+                 std::vector<Tensor>* tensors, bool delta) {
+    DataTypeVector dtypes;
+    for (const Tensor& tensor : *tensors) dtypes.push_back(tensor.dtype());
+    TF_RETURN_IF_ERROR(NodeDefBuilder("save", "AsyncSaveV2")
+                           .Input(FakeInput())  // prefix
+                           .Input(FakeInput())  // tensor_names
+                           .Input(FakeInput())  // shape_and_slices
+                           .Input(FakeInput(dtypes))
+                           .Attr("delta", delta)
+                           .Finalize(node_def()));
+    TF_RETURN_IF_ERROR(InitOp());
+    inputs_.clear();
+    AddInput<tstring>(TensorShape({}),
+                      [&prefix](int x) -> tstring { return prefix; });
+    AddInput<tstring>(TensorShape({static_cast<int64>(names.size())}),
+                      [&names](int x) -> tstring { return names[x]; });
+    AddInput<tstring>(TensorShape({static_cast<int64>(names.size())}),
+                      [](int x) -> tstring { return ""; });
+    // The inputs share their buffers with "tensors", like the values of
+    // resource variables.
+    for (Tensor& tensor : *tensors) inputs_.push_back({nullptr, &tensor});
+    return RunOpKernel();
+  }
+
+  // Runs a WaitForAsyncSaves op.
+  Status RunWait() {
+    TF_RETURN_IF_ERROR(
+        NodeDefBuilder("wait", "WaitForAsyncSaves").Finalize(node_def()));
+    TF_RETURN_IF_ERROR(InitOp());
+    inputs_.clear();
+    return RunOpKernel();
+  }
+};
+
+TEST_F(AsyncSaveV2OpTest, Simple) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "async_simple");
+  std::vector<Tensor> tensors = {test::AsTensor<float>({1, 2, 3}),
+                                 test::AsTensor<int64>({4, 5})};
+  TF_ASSERT_OK(RunSave(prefix, {"a", "b"}, &tensors, /*delta=*/false));
+  TF_ASSERT_OK(RunWait());
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("a", &val));
+  test::ExpectTensorEqual<float>(val, tensors[0]);
+  TF_ASSERT_OK(reader.Lookup("b", &val));
+  test::ExpectTensorEqual<int64>(val, tensors[1]);
+}
+
+TEST_F(AsyncSaveV2OpTest, Delta) {
+  const string base = io::JoinPath(testing::TmpDir(), "async_delta_base");
+  const string delta = io::JoinPath(testing::TmpDir(), "async_delta_1");
+  std::vector<Tensor> tensors = {test::AsTensor<float>({1, 2, 3}),
+                                 test::AsTensor<float>({4, 5})};
+  TF_ASSERT_OK(RunSave(base, {"a", "b"}, &tensors, /*delta=*/true));
+
+  // Replaces the buffer of "b", as a copy on write would.
+  tensors[1] = test::AsTensor<float>({6, 7});
+  TF_ASSERT_OK(RunSave(delta, {"a", "b"}, &tensors, /*delta=*/true));
+  TF_ASSERT_OK(RunWait());
+
+  BundleReader base_reader(Env::Default(), base);
+  TF_ASSERT_OK(base_reader.status());
+  EXPECT_TRUE(base_reader.Contains("a"));
+  EXPECT_TRUE(base_reader.Contains("b"));
+
+  BundleReader delta_reader(Env::Default(), delta);
+  TF_ASSERT_OK(delta_reader.status());
+  EXPECT_FALSE(delta_reader.Contains("a"));
+  Tensor val;
+  TF_ASSERT_OK(delta_reader.Lookup("b", &val));
+  test::ExpectTensorEqual<float>(val, tensors[1]);
+}
+
+TEST_F(AsyncSaveV2OpTest, ReportsError) {
+  // The directory of the prefix is a file, so the save fails.
+  const string file = io::JoinPath(testing::TmpDir(), "async_not_a_dir");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), file, "x"));
+  std::vector<Tensor> tensors = {test::AsTensor<float>({1})};
+  TF_ASSERT_OK(RunSave(io::JoinPath(file, "ckpt"), {"a"}, &tensors,
+                       /*delta=*/false));
+  EXPECT_FALSE(RunWait().ok());
+  // The error is reported once.
+  TF_EXPECT_OK(RunWait());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -20,9 +20,14 @@ limitations under the License.
 
 #define EIGEN_USE_GPU
 
+#include <limits>
+#include <type_traits>
+
 #include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/gpu_prim_helpers.h"
 #include "tensorflow/core/kernels/scatter_functor.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/gpu_kernel_helper.h"
 
 namespace tensorflow {
@@ -124,6 +129,104 @@ __global__ void ScatterScalarOpCustomKernel(T* __restrict__ params,
   }
 }
 
+// Applies the updates to params in the order of their sorted indices. Only the
+// thread at the start of each run of equal indices touches params, after
+// summing the updates of the whole run in order, so the result does not depend
+// on the order in which the threads run.
+template <typename T, typename Index, scatter_op::UpdateOp op>
+__global__ void ScatterSortedOpCustomKernel(
+    T* __restrict__ params, const T* __restrict__ updates,
+    const Index* __restrict__ sorted_indices,
+    const Index* __restrict__ sorted_rows, Index first_dim_size,
+    Index update_block, Index indices_size) {
+  // Sum fp16 values using an fp32 accumulator to avoid numerical issues.
+  using Taccum = typename std::conditional<std::is_same<T, Eigen::half>::value,
+                                           float, T>::type;
+  ScatterOpKernelBody<T, op> body;
+  GPU_1D_KERNEL_LOOP(i, indices_size * update_block) {
+    const Index sorted_i = i / update_block;
+    const Index param_first_index = sorted_indices[sorted_i];
+    if (sorted_i > 0 && sorted_indices[sorted_i - 1] == param_first_index) {
+      // Not the start of a run.
+      continue;
+    }
+    if (!(param_first_index >= 0 && param_first_index < first_dim_size)) {
+      // Ignore indices that are out of range.
+      continue;
+    }
+    const Index col = i % update_block;
+    Taccum sum = static_cast<Taccum>(
+        ldg(updates + sorted_rows[sorted_i] * update_block + col));
+    for (Index j = sorted_i + 1;
+         j < indices_size && sorted_indices[j] == param_first_index; ++j) {
+      sum += static_cast<Taccum>(
+          ldg(updates + sorted_rows[j] * update_block + col));
+    }
+    // No other thread writes this element, so the atomic is uncontended.
+    body(&params[static_cast<int64>(param_first_index) * update_block + col],
+         static_cast<T>(sum));
+  }
+}
+
+// Scatter updates without atomic contention, which are deterministic. Only the
+// floating point additions and subtractions need them.
+template <typename T, typename Index, scatter_op::UpdateOp op,
+          bool needed = !std::is_integral<T>::value &&
+                        (op == scatter_op::UpdateOp::ADD ||
+                         op == scatter_op::UpdateOp::SUB)>
+struct DeterministicScatter {
+  static constexpr bool kNeeded = true;
+
+  // Sorts the indices with a stable radix sort and applies the updates of each
+  // index in order.
+  static Status Compute(OpKernelContext* c, const GPUDevice& d, T* params,
+                        const T* updates, const Index* indices,
+                        Index first_dim_size, Index indices_size,
+                        Index updates_size) {
+    if (indices_size > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument(
+          "Deterministic GPU scatter supports at most ",
+          std::numeric_limits<int>::max(), " indices, got ", indices_size);
+    }
+    Tensor sorted_indices;
+    TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                        TensorShape({indices_size}),
+                                        &sorted_indices));
+    Index* sorted_indices_ptr = sorted_indices.flat<Index>().data();
+    Tensor sorted_rows;
+    TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                        TensorShape({indices_size}),
+                                        &sorted_rows));
+    Index* sorted_rows_ptr = sorted_rows.flat<Index>().data();
+    TF_RETURN_IF_ERROR(GpuRadixSort(
+        c, static_cast<int>(indices_size), /*keys_in=*/indices,
+        /*keys_out=*/sorted_indices_ptr,
+        /*indices_in=*/static_cast<Index*>(nullptr),
+        /*indices_out=*/sorted_rows_ptr));
+
+    const Index update_block = updates_size / indices_size;
+    GpuLaunchConfig config = GetGpuLaunchConfig(updates_size, d);
+    return GpuLaunchKernel(ScatterSortedOpCustomKernel<T, Index, op>,
+                           config.block_count, config.thread_per_block, 0,
+                           d.stream(), params, updates, sorted_indices_ptr,
+                           sorted_rows_ptr, first_dim_size, update_block,
+                           indices_size);
+  }
+};
+
+// The atomic kernels of the other updates are deterministic already.
+template <typename T, typename Index, scatter_op::UpdateOp op>
+struct DeterministicScatter<T, Index, op, false> {
+  static constexpr bool kNeeded = false;
+
+  static Status Compute(OpKernelContext* c, const GPUDevice& d, T* params,
+                        const T* updates, const Index* indices,
+                        Index first_dim_size, Index indices_size,
+                        Index updates_size) {
+    return errors::Internal("Not needed.");
+  }
+};
+
 }  // namespace scatter_op_gpu
 
 namespace functor {
@@ -140,6 +243,16 @@ struct ScatterFunctor<GPUDevice, T, Index, op> {
     const Index first_dim_size = params.dimension(0);
     const Index indices_size = indices.size();
     const Index updates_size = updates.size();
+    using DeterministicScatter =
+        scatter_op_gpu::DeterministicScatter<T, Index, op>;
+    if (DeterministicScatter::kNeeded && OpDeterminismRequired() &&
+        indices_size > 0) {
+      Status status = DeterministicScatter::Compute(
+          c, d, params.data(), updates.data(), indices.data(), first_dim_size,
+          indices_size, updates_size);
+      if (!status.ok()) c->SetStatus(status);
+      return -1;
+    }
     GpuLaunchConfig config = GetGpuLaunchConfig(updates_size, d);
     TF_CHECK_OK(GpuLaunchKernel(
         scatter_op_gpu::ScatterOpCustomKernel<T, Index, op>, config.block_count,
@@ -13,10 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#ifndef TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_GPU_CU_H_
+#define TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_GPU_CU_H_
+
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 #define EIGEN_USE_GPU
 
+#include <limits>
+
 // We need to include gpu_kernel_helper.h before segment_reduction_ops.h
 // See comment in segment_reduction_ops.h for more details.
 // clang-format off
@@ -627,6 +632,126 @@ struct ReduceType<gpuprim::Sum, Eigen::half> {
   using type = float;
 };
 
+// Multiplies its arguments the way gpuprim::Sum adds them.
+struct ProdOp {
+  template <typename T>
+  __host__ __device__ T operator()(const T& a, const T& b) const {
+    return a * b;
+  }
+};
+
+// The gpuprim-style reduction that computes the same result as an atomic
+// reduction functor that is not associative, in a deterministic order.
+template <typename AtomicReductionF>
+struct DeterministicReduceOp;
+
+template <typename T>
+struct DeterministicReduceOp<functor::AtomicSumOpGpu<T>> {
+  using type = gpuprim::Sum;
+};
+
+template <typename T>
+struct DeterministicReduceOp<functor::AtomicProdOpGpu<T>> {
+  using type = ProdOp;
+};
+
+template <typename Index>
+__global__ void ClipSegmentIdsKernel(Index size, Index nsegments,
+                                     const Index* __restrict__ segment_ids,
+                                     Index* __restrict__ clipped_ids) {
+  GPU_1D_KERNEL_LOOP(i, size) {
+    const Index id = segment_ids[i];
+    clipped_ids[i] = (id >= 0 && id < nsegments) ? id : nsegments;
+  }
+}
+
+// Segment reductions without atomics, which are deterministic. Only the
+// reductions whose atomic functors are not associative need them.
+template <typename T, typename Index, typename AtomicReductionF,
+          bool needed = !AtomicReductionF::is_associative>
+struct DeterministicSegmentReduction {
+  using ReduceOp = typename DeterministicReduceOp<AtomicReductionF>::type;
+  using Treduce = typename ReduceType<ReduceOp, T>::type;
+
+  // Reduces the rows of `data` by their sorted `segment_ids` into `output`,
+  // including the empty segments.
+  static Status Sorted(OpKernelContext* ctx, Index nouter, Index ninner,
+                       Index nsegments, T initial_value,
+                       const Index* segment_ids, const T* data, T* output) {
+    return SegmentReduceGPU<Treduce>(
+        ctx, /*nouter=*/nouter, /*ninner=*/ninner, /*nsegments=*/nsegments,
+        /*reduce_op=*/ReduceOp(), /*initial_value=*/initial_value,
+        /*empty_segment_value=*/initial_value,
+        /*is_mean=*/false, /*is_sqrtn=*/false, /*input=*/data,
+        /*segment_ids=*/segment_ids, /*indices=*/static_cast<Index*>(nullptr),
+        /*weights=*/static_cast<T*>(nullptr), /*output=*/output);
+  }
+
+  // Reduces the rows of `data` by their unsorted `segment_ids` into `output`:
+  // the segment ids are sorted with a stable radix sort, and each segment is
+  // then reduced in order. Rows with ids outside [0, nsegments), which the
+  // atomic kernel ignores, are sorted after all the others and ignored too.
+  static Status Unsorted(OpKernelContext* ctx, Index nouter, Index ninner,
+                         Index nsegments, T initial_value,
+                         const Index* segment_ids, const T* data, T* output) {
+    if (nouter > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument(
+          "Deterministic GPU segment reduction supports at most ",
+          std::numeric_limits<int>::max(), " segment ids, got ", nouter);
+    }
+    const GPUDevice& d = ctx->eigen_gpu_device();
+    Tensor clipped_ids;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DataTypeToEnum<Index>::value, TensorShape({nouter}), &clipped_ids));
+    Index* clipped_ids_ptr = clipped_ids.flat<Index>().data();
+    GpuLaunchConfig config = GetGpuLaunchConfig(nouter, d);
+    TF_RETURN_IF_ERROR(GpuLaunchKernel(
+        ClipSegmentIdsKernel<Index>, config.block_count,
+        config.thread_per_block, 0, d.stream(), nouter, nsegments,
+        segment_ids, clipped_ids_ptr));
+
+    // The clipped ids are in [0, nsegments], so only their low bits need to
+    // be sorted.
+    Tensor sorted_ids;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DataTypeToEnum<Index>::value, TensorShape({nouter}), &sorted_ids));
+    Index* sorted_ids_ptr = sorted_ids.flat<Index>().data();
+    Tensor sorted_rows;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DataTypeToEnum<Index>::value, TensorShape({nouter}), &sorted_rows));
+    Index* sorted_rows_ptr = sorted_rows.flat<Index>().data();
+    TF_RETURN_IF_ERROR(GpuRadixSort(
+        ctx, static_cast<int>(nouter), /*keys_in=*/clipped_ids_ptr,
+        /*keys_out=*/sorted_ids_ptr,
+        /*indices_in=*/static_cast<Index*>(nullptr),
+        /*indices_out=*/sorted_rows_ptr,
+        /*num_bits=*/Log2Ceiling64(static_cast<int64>(nsegments) + 1)));
+
+    return SegmentReduceGPU<Treduce>(
+        ctx, /*nouter=*/nouter, /*ninner=*/ninner, /*nsegments=*/nsegments,
+        /*reduce_op=*/ReduceOp(), /*initial_value=*/initial_value,
+        /*empty_segment_value=*/initial_value,
+        /*is_mean=*/false, /*is_sqrtn=*/false, /*input=*/data,
+        /*segment_ids=*/sorted_ids_ptr, /*indices=*/sorted_rows_ptr,
+        /*weights=*/static_cast<T*>(nullptr), /*output=*/output);
+  }
+};
+
+// The atomic kernels of associative reductions are deterministic already.
+template <typename T, typename Index, typename AtomicReductionF>
+struct DeterministicSegmentReduction<T, Index, AtomicReductionF, false> {
+  static Status Sorted(OpKernelContext* ctx, Index nouter, Index ninner,
+                       Index nsegments, T initial_value,
+                       const Index* segment_ids, const T* data, T* output) {
+    return errors::Internal("Not needed.");
+  }
+  static Status Unsorted(OpKernelContext* ctx, Index nouter, Index ninner,
+                         Index nsegments, T initial_value,
+                         const Index* segment_ids, const T* data, T* output) {
+    return errors::Internal("Not needed.");
+  }
+};
+
 namespace functor {
 
 template <typename T, typename Index, typename InitialValueF,
@@ -643,9 +768,35 @@ void SegmentReductionFunctor<
     return;
   }
 
+  const T InitialValue = InitialValueF()();
+  const bool deterministic =
+      !atomic_reduction_is_associative && OpDeterminismRequired();
+#if defined(PLATFORM_WINDOWS)
+  // SegmentReduceGPU is not built on Windows, see
+  // segment_reduction_ops_gpu_0.cu.cc.
+  OP_REQUIRES(
+      ctx, !deterministic || DisableSegmentReductionOpDeterminismExceptions(),
+      errors::Unimplemented("Deterministic GPU implementation of sorted "
+                            "segment reduction op not available."));
+#else
+  if (deterministic && data_size > 0 &&
+      segment_ids_shape.num_elements() > 0) {
+    // The segment ids are sorted, so each segment can be reduced in order
+    // without atomics. This also sets the empty segments.
+    const Index input_outer_dim_size = segment_ids.dimension(0);
+    OP_REQUIRES_OK(
+        ctx,
+        (DeterministicSegmentReduction<T, Index, AtomicReductionF>::Sorted(
+            ctx, /*nouter=*/input_outer_dim_size,
+            /*ninner=*/data_size / input_outer_dim_size,
+            /*nsegments=*/output_rows, InitialValue, segment_ids.data(), data,
+            output.data())));
+    return;
+  }
+#endif  // defined(PLATFORM_WINDOWS)
+
   // Set 'output' to initial value.
   GpuLaunchConfig config = GetGpuLaunchConfig(output.size(), d);
-  const T InitialValue = InitialValueF()();
   TF_CHECK_OK(GpuLaunchKernel(SetToValue<T>, config.block_count,
                               config.thread_per_block, 0, d.stream(),
                               output.size(), output.data(), InitialValue));
@@ -691,14 +842,30 @@ struct UnsortedSegmentFunctor<GPUDevice, T, Index, InitialValueF, ReductionF> {
       return;
     }
 
-    bool determinism_requirement_met =
-        ReductionF::is_associative || !OpDeterminismRequired() ||
-        DisableSegmentReductionOpDeterminismExceptions();
+    const bool deterministic =
+        !ReductionF::is_associative && OpDeterminismRequired();
+    const int64 data_size = data.size();
+#if defined(PLATFORM_WINDOWS)
+    // SegmentReduceGPU is not built on Windows, see
+    // segment_reduction_ops_gpu_0.cu.cc.
     OP_REQUIRES(
-        ctx, determinism_requirement_met,
+        ctx,
+        !deterministic || DisableSegmentReductionOpDeterminismExceptions(),
         errors::Unimplemented(
             "Deterministic GPU implementation of unsorted segment reduction op"
             " not available."));
+#else
+    if (deterministic && data_size > 0 &&
+        segment_ids_shape.num_elements() > 0) {
+      OP_REQUIRES_OK(
+          ctx, (DeterministicSegmentReduction<T, Index, ReductionF>::Unsorted(
+                   ctx, /*nouter=*/segment_ids.dimension(0),
+                   /*ninner=*/data.dimension(1),
+                   /*nsegments=*/output.dimension(0), InitialValueF()(),
+                   segment_ids.data(), data.data(), output.data())));
+      return;
+    }
+#endif  // defined(PLATFORM_WINDOWS)
 
     // Set 'output' to initial value.
     GPUDevice d = ctx->template eigen_device<GPUDevice>();
@@ -706,7 +873,6 @@ struct UnsortedSegmentFunctor<GPUDevice, T, Index, InitialValueF, ReductionF> {
     TF_CHECK_OK(GpuLaunchKernel(
         SetToValue<T>, config.block_count, config.thread_per_block, 0,
         d.stream(), output.size(), output.data(), InitialValueF()()));
-    const int64 data_size = data.size();
     if (data_size == 0 || segment_ids_shape.num_elements() == 0) {
       return;
     }
@@ -832,3 +998,5 @@ struct SparseSegmentGradFunctor<GPUDevice, T, Index, SegmentId> {
 }  // namespace tensorflow
 
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#endif  // TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_GPU_CU_H_
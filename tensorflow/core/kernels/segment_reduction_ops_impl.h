@@ -23,6 +23,7 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include <algorithm>
 #include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
@@ -38,7 +39,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
-#include "tensorflow/core/util/determinism.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/util.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -296,20 +297,6 @@ class SegmentReductionGPUOp : public AsyncOpKernel {
       OP_REQUIRES_OK_ASYNC(
           context, context->allocate_output(0, output_shape, &output), done);
 
-      // The determinism check is here, rather than inside the functor (as it is
-      // for the unsorted segment reduction ops) because the done callback
-      // (required for OP_REQUIRES_ASYNC) is not available inside the functor.
-      bool determinism_requirement_met =
-          SegmentReductionFunctor::atomic_reduction_is_associative ||
-          !OpDeterminismRequired() ||
-          DisableSegmentReductionOpDeterminismExceptions();
-      OP_REQUIRES_ASYNC(
-          context, determinism_requirement_met,
-          errors::Unimplemented(
-              "Deterministic GPU implementation of sorted segment reduction op"
-              " not available."),
-          done);
-
       auto output_flat = output->flat_outer_dims<T>();
       auto data_ptr = input.template flat<T>().data();
       auto segment_flat = segment_ids.flat<Index>();
@@ -527,6 +514,8 @@ class SparseSegmentReductionOpBase : public OpKernel {
     // Index from which the output is not initialized.
     SegmentId uninitialized_index = 0;
     SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
+    // Index up to which the input rows have been prefetched.
+    int64 prefetched_end = 0;
 
     while (true) {
       // We initialize next_index to 0 to avoid "warning: 'next_index' may be
@@ -560,6 +549,15 @@ class SparseSegmentReductionOpBase : public OpKernel {
         gap_slice.setConstant(default_value_);
       }
 
+      // The rows are gathered from anywhere in the input, so fetch the ones of
+      // the next few indices while the current segment is reduced.
+      const int64 prefetch_end = std::min(end + kPrefetchRows, num_indices);
+      if (prefetched_end < prefetch_end) {
+        PrefetchRows(input_flat, indices_vec, std::max(prefetched_end, start),
+                     prefetch_end);
+        prefetched_end = prefetch_end;
+      }
+
       auto out = output_flat.template chip<0>(out_index);
       auto temp = temp_flat.template chip<0>(out_index);
       const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
@@ -588,6 +586,31 @@ class SparseSegmentReductionOpBase : public OpKernel {
   }
 
  private:
+  // The number of indices past the current segment whose input rows are
+  // prefetched.
+  static constexpr int64 kPrefetchRows = 16;
+
+  // Prefetches the cache lines of the input rows of indices[begin:end]. Out of
+  // range indices are skipped, they are reported by Reduce().
+  static void PrefetchRows(
+      const typename TTypes<T>::ConstMatrix& input_flat,
+      const typename TTypes<Index>::ConstVec& indices_vec, int64 begin,
+      int64 end) {
+    constexpr int64 kCacheLineSize = 64;
+    const int64 num_rows = input_flat.dimension(0);
+    const int64 row_bytes = input_flat.dimension(1) * sizeof(T);
+    if (row_bytes == 0) return;
+    for (int64 i = begin; i < end; ++i) {
+      const Index row = internal::SubtleMustCopy(indices_vec(i));
+      if (!FastBoundsCheck(row, num_rows)) continue;
+      const char* row_data =
+          reinterpret_cast<const char*>(&input_flat(row, 0));
+      for (int64 offset = 0; offset < row_bytes; offset += kCacheLineSize) {
+        port::prefetch<port::PREFETCH_HINT_T0>(row_data + offset);
+      }
+    }
+  }
+
   template <typename Tin>
   using EnableIfBfloat16OrHalf =
       typename std::enable_if<std::is_same<Tin, bfloat16>::value ||
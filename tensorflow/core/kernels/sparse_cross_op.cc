@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <limits>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/batch_fingerprint.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/fingerprint.h"
@@ -51,6 +53,21 @@ class ColumnInterface {
   virtual ~ColumnInterface() {}
 };
 
+// Returns the fingerprints of the strings of `tensor` for the columns whose
+// features are fingerprints, and an empty vector otherwise. The strings are
+// fingerprinted once for all the crosses they are part of.
+template <typename InternalType>
+std::vector<uint64> FingerprintStrings(const Tensor& tensor) {
+  std::vector<uint64> fingerprints;
+  if (std::is_same<InternalType, int64>::value &&
+      tensor.dtype() == DT_STRING) {
+    fingerprints.resize(tensor.NumElements());
+    BatchFingerprint64(tensor.flat<tstring>().data(), tensor.NumElements(),
+                       fingerprints.data());
+  }
+  return fingerprints;
+}
+
 // A column that is backed by a sparse tensor.
 template <typename InternalType>
 class SparseTensorColumn : public ColumnInterface<InternalType> {
@@ -58,6 +75,7 @@ class SparseTensorColumn : public ColumnInterface<InternalType> {
   SparseTensorColumn(const Tensor& values, std::vector<int64> feature_counts,
                      std::vector<int64> feature_start_indices)
       : values_(values),
+        fingerprints_(FingerprintStrings<InternalType>(values)),
         feature_counts_(std::move(feature_counts)),
         feature_start_indices_(std::move(feature_start_indices)) {
     CHECK_EQ(feature_counts_.size(), feature_start_indices_.size());
@@ -73,6 +91,7 @@ class SparseTensorColumn : public ColumnInterface<InternalType> {
 
  private:
   const Tensor& values_;
+  const std::vector<uint64> fingerprints_;
   std::vector<int64> feature_counts_;
   std::vector<int64> feature_start_indices_;
 };
@@ -112,8 +131,7 @@ template <>
 int64 SparseTensorColumn<int64>::Feature(int64 batch, int64 n,
                                          bool strong_hash) const {
   const int64 start = feature_start_indices_[batch];
-  if (DT_STRING == values_.dtype())
-    return Fingerprint64(values_.vec<tstring>().data()[start + n]);
+  if (DT_STRING == values_.dtype()) return fingerprints_[start + n];
   return values_.vec<int64>().data()[start + n];
 }
 
@@ -173,7 +191,9 @@ StringPiece KeyedSparseTensorColumn<StringPiece>::Feature(
 template <typename InternalType>
 class DenseTensorColumn : public ColumnInterface<InternalType> {
  public:
-  explicit DenseTensorColumn(const Tensor& tensor) : tensor_(tensor) {}
+  explicit DenseTensorColumn(const Tensor& tensor)
+      : tensor_(tensor),
+        fingerprints_(FingerprintStrings<InternalType>(tensor)) {}
 
   int64 FeatureCount(int64 batch) const override { return tensor_.dim_size(1); }
 
@@ -183,6 +203,7 @@ class DenseTensorColumn : public ColumnInterface<InternalType> {
 
  private:
   const Tensor& tensor_;
+  const std::vector<uint64> fingerprints_;
 };
 
 // A column that is backed by a dense tensor.
@@ -210,7 +231,7 @@ template <>
 int64 DenseTensorColumn<int64>::Feature(int64 batch, int64 n,
                                         bool strong_hash) const {
   if (DT_STRING == tensor_.dtype())
-    return Fingerprint64(tensor_.matrix<tstring>()(batch, n));
+    return fingerprints_[batch * tensor_.dim_size(1) + n];
   return tensor_.matrix<int64>()(batch, n);
 }
 
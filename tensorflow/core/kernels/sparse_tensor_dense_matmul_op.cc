@@ -19,17 +19,174 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+Status KOutOfBoundsError(int64 k, std::size_t i, int rhs_index_a,
+                         std::size_t lhs_right) {
+  return errors::InvalidArgument("k (", k, ") from index[", i, ",", rhs_index_a,
+                                 "] out of bounds (>=", lhs_right, ")");
+}
+
+Status MOutOfBoundsError(int64 m, std::size_t i, int lhs_index_a,
+                         int64 out_dim0) {
+  return errors::InvalidArgument("m (", m, ") from index[", i, ",", lhs_index_a,
+                                 "] out of bounds (>=", out_dim0, ")");
+}
+
+// The sparse operand of the product (the adjoint of `a` if adjoint_a is set)
+// in compressed sparse row form, and the `a_indices` it was built from.
+//
+// Models such as graph neural networks multiply the same sparse matrix with
+// many dense ones, so the CPU kernel keeps the last one it built: validating
+// and sorting the indices again costs more than comparing them.
+template <typename Tindices>
+struct SparseTensorDenseMatMulCsr {
+  std::vector<Tindices> a_indices;
+  int64 a_shape[2];
+
+  // The entries of row r of the product's left operand are
+  // [row_ptr[r], row_ptr[r + 1]), in the order of `a_indices`. Entry j is the
+  // value a_values(value_index[j]) in column col[j].
+  std::vector<int64> row_ptr;
+  std::vector<int64> value_index;
+  std::vector<Tindices> col;
+
+  bool Matches(const Tensor& indices, const int64* shape) const {
+    auto data = indices.flat<Tindices>();
+    return a_shape[0] == shape[0] && a_shape[1] == shape[1] &&
+           a_indices.size() == data.size() &&
+           std::equal(a_indices.begin(), a_indices.end(), data.data());
+  }
+};
+
+// Validates `a_indices` and sets `csr` to the left operand of the product,
+// which has `lhs_rows` rows and `lhs_cols` columns.
+template <typename Tindices>
+Status BuildSparseTensorDenseMatMulCsr(
+    const Tensor& a_indices, const int64* a_shape, bool adjoint_a,
+    int64 lhs_rows, int64 lhs_cols, SparseTensorDenseMatMulCsr<Tindices>* csr) {
+  // Work on a copy, so that the indices can't change after they are checked.
+  auto indices_flat = a_indices.flat<Tindices>();
+  csr->a_indices.assign(indices_flat.data(),
+                        indices_flat.data() + indices_flat.size());
+  csr->a_shape[0] = a_shape[0];
+  csr->a_shape[1] = a_shape[1];
+  const Tindices* indices = csr->a_indices.data();
+  const int64 nnz = a_indices.dim_size(0);
+  const int lhs_index_a = adjoint_a ? 1 : 0;
+  const int rhs_index_a = adjoint_a ? 0 : 1;
+
+  csr->row_ptr.assign(lhs_rows + 1, 0);
+  for (int64 i = 0; i < nnz; ++i) {
+    const Tindices m = indices[2 * i + lhs_index_a];
+    const Tindices k = indices[2 * i + rhs_index_a];
+    if (!FastBoundsCheck(k, lhs_cols)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, lhs_cols);
+    }
+    if (!FastBoundsCheck(m, lhs_rows)) {
+      return MOutOfBoundsError(m, i, lhs_index_a, lhs_rows);
+    }
+    ++csr->row_ptr[m + 1];
+  }
+  for (int64 r = 0; r < lhs_rows; ++r) {
+    csr->row_ptr[r + 1] += csr->row_ptr[r];
+  }
+  // A stable counting sort by row, so that each output element sums its terms
+  // in the order of the indices.
+  std::vector<int64> next(csr->row_ptr.begin(), csr->row_ptr.end() - 1);
+  csr->value_index.resize(nnz);
+  csr->col.resize(nnz);
+  for (int64 i = 0; i < nnz; ++i) {
+    const int64 j = next[indices[2 * i + lhs_index_a]]++;
+    csr->value_index[j] = i;
+    csr->col[j] = indices[2 * i + rhs_index_a];
+  }
+  return Status::OK();
+}
+
+// Sets `out` to the product of `csr` and `b`, or of `csr` and the adjoint of
+// `b` if adjoint_b is set, computing the rows of `out` in parallel.
+template <typename T, typename Tindices>
+Status SparseTensorDenseMatMulCsrCompute(
+    OpKernelContext* ctx, const SparseTensorDenseMatMulCsr<Tindices>& csr,
+    bool adjoint_a, bool adjoint_b, typename TTypes<T>::ConstVec a_values,
+    const Tensor& b, typename TTypes<T>::Matrix out) {
+  using Tsum = typename functor::SumType<T>::type;
+  // Vectorize certain operations above this size.
+  static constexpr int64 kNumVectorize = 32;
+
+  const int64 num_rows = out.dimension(0);
+  const int64 rhs_right = out.dimension(1);
+  // The rows of B, or of its adjoint, are read as contiguous vectors.
+  Tensor b_adjoint;
+  if (adjoint_b) {
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DataTypeToEnum<T>::value, TensorShape({b.dim_size(1), b.dim_size(0)}),
+        &b_adjoint));
+    Eigen::array<int, 2> shuffle({1, 0});
+    b_adjoint.matrix<T>().device(ctx->eigen_cpu_device()) =
+        b.matrix<T>().shuffle(shuffle).conjugate();
+  }
+  const T* b_data = adjoint_b ? b_adjoint.flat<T>().data() : b.flat<T>().data();
+
+  auto compute_rows = [&](int64 begin, int64 end) {
+    std::vector<Tsum> sums;
+    if (!std::is_same<T, Tsum>::value) sums.resize(rhs_right);
+    for (int64 r = begin; r < end; ++r) {
+      T* out_row = out.data() + r * rhs_right;
+      Tsum* sum_row = std::is_same<T, Tsum>::value
+                          ? reinterpret_cast<Tsum*>(out_row)
+                          : sums.data();
+      std::fill(sum_row, sum_row + rhs_right, Tsum(0));
+      for (int64 j = csr.row_ptr[r]; j < csr.row_ptr[r + 1]; ++j) {
+        const T a_value = adjoint_a ? functor::MaybeConj(a_values(
+                                          csr.value_index[j]))
+                                    : a_values(csr.value_index[j]);
+        const T* b_row = b_data + static_cast<int64>(csr.col[j]) * rhs_right;
+        if (rhs_right < kNumVectorize) {
+          for (int64 n = 0; n < rhs_right; ++n) {
+            sum_row[n] +=
+                static_cast<Tsum>(a_value) * static_cast<Tsum>(b_row[n]);
+          }
+        } else {
+          typename TTypes<Tsum>::UnalignedVec sum_vec(sum_row, rhs_right);
+          typename TTypes<T>::UnalignedConstVec b_vec(b_row, rhs_right);
+          sum_vec += b_vec.template cast<Tsum>() * static_cast<Tsum>(a_value);
+        }
+      }
+      if (!std::is_same<T, Tsum>::value) {
+        std::transform(sum_row, sum_row + rhs_right, out_row,
+                       [](Tsum v) { return static_cast<T>(v); });
+      }
+    }
+  };
+  const int64 nnz = csr.value_index.size();
+  const int64 cost_per_row = (nnz / num_rows + 1) * rhs_right * 2;
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+        cost_per_row, compute_rows);
+  return Status::OK();
+}
+
+}  // namespace
+
 template <typename Device, typename T, typename Tindices>
 class SparseTensorDenseMatMulOp : public OpKernel {
  public:
@@ -133,12 +290,47 @@ class SparseTensorDenseMatMulOp : public OpKernel {
       return;
     }
 
+    MatMul(ctx, *a_indices, a_values->vec<T>(), a_shape_t.data(), *b,
+           out->matrix<T>(), static_cast<Device*>(nullptr));
+  }
+
+ private:
+  using Csr = SparseTensorDenseMatMulCsr<Tindices>;
+
+  void MatMul(OpKernelContext* ctx, const Tensor& a_indices,
+              typename TTypes<T>::ConstVec a_values, const int64* a_shape,
+              const Tensor& b, typename TTypes<T>::Matrix out,
+              CPUDevice* /*device*/) {
+    std::shared_ptr<const Csr> csr;
+    {
+      mutex_lock l(mu_);
+      csr = csr_;
+    }
+    if (csr == nullptr || !csr->Matches(a_indices, a_shape)) {
+      auto new_csr = std::make_shared<Csr>();
+      OP_REQUIRES_OK(ctx, BuildSparseTensorDenseMatMulCsr(
+                              a_indices, a_shape, adjoint_a_, out.dimension(0),
+                              adjoint_a_ ? a_shape[0] : a_shape[1],
+                              new_csr.get()));
+      csr = std::move(new_csr);
+      mutex_lock l(mu_);
+      csr_ = csr;
+    }
+    OP_REQUIRES_OK(ctx, SparseTensorDenseMatMulCsrCompute<T, Tindices>(
+                            ctx, *csr, adjoint_a_, adjoint_b_, a_values, b,
+                            out));
+  }
+
+  void MatMul(OpKernelContext* ctx, const Tensor& a_indices,
+              typename TTypes<T>::ConstVec a_values, const int64* a_shape,
+              const Tensor& b, typename TTypes<T>::Matrix out,
+              GPUDevice* /*device*/) {
 #define MAYBE_ADJOINT(ADJ_A, ADJ_B)                                           \
   if (adjoint_a_ == ADJ_A && adjoint_b_ == ADJ_B) {                           \
     Status functor_status = functor::SparseTensorDenseMatMulFunctor<          \
         Device, T, Tindices, ADJ_A,                                           \
-        ADJ_B>::Compute(ctx, out->matrix<T>(), a_indices->matrix<Tindices>(), \
-                        a_values->vec<T>(), b->matrix<T>());                  \
+        ADJ_B>::Compute(ctx, out, a_indices.matrix<Tindices>(), a_values,     \
+                        b.matrix<T>());                                       \
     OP_REQUIRES_OK(ctx, functor_status);                                      \
   }
 
@@ -150,9 +342,12 @@ class SparseTensorDenseMatMulOp : public OpKernel {
 #undef MAYBE_ADJOINT
   }
 
- private:
   bool adjoint_a_;
   bool adjoint_b_;
+
+  mutex mu_;
+  // The sparse operand of the last product on CPU.
+  std::shared_ptr<const Csr> csr_ TF_GUARDED_BY(mu_);
 };
 
 #define REGISTER_CPU(TypeT, TypeIndex)           \
@@ -235,126 +430,4 @@ REGISTER_KERNELS_GPU(complex128);
 #undef REGISTER_KERNELS_GPU
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
-namespace functor {
-
-namespace {
-Status KOutOfBoundsError(int64 k, std::size_t i, int rhs_index_a,
-                         std::size_t lhs_right) {
-  return errors::InvalidArgument("k (", k, ") from index[", i, ",", rhs_index_a,
-                                 "] out of bounds (>=", lhs_right, ")");
-}
-
-Status MOutOfBoundsError(int64 m, std::size_t i, int lhs_index_a,
-                         int64 out_dim0) {
-  return errors::InvalidArgument("m (", m, ") from index[", i, ",", lhs_index_a,
-                                 "] out of bounds (>=", out_dim0, ")");
-}
-
-template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
-Status SparseTensorDenseMatMulImpl(
-    typename TTypes<Tsum>::Matrix out,
-    typename TTypes<Tindices>::ConstMatrix a_indices,
-    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
-  // Vectorize certain operations above this size.
-  static constexpr std::size_t kNumVectorize = 32;
-
-  const std::size_t nnz = a_values.size();
-  const std::size_t rhs_right = (ADJ_B ? b.dimension(0) : b.dimension(1));
-  const std::size_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
-  const int lhs_index_a = ADJ_A ? 1 : 0;
-  const int rhs_index_a = ADJ_A ? 0 : 1;
-
-  // TODO(ebrevdo): After many failed experiments, can't find a multi-threaded
-  // approach that achieves the performance of the single threaded
-  // one.  Perhaps Eigen threadpool implementation is just too slow?
-
-  if (rhs_right < kNumVectorize) {
-    // Disable vectorization if the RHS of output is too small
-    auto maybe_adjoint_b = MaybeAdjoint<decltype(b), ADJ_B>(b);
-
-    for (std::size_t i = 0; i < nnz; ++i) {
-      const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
-      const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
-      if (!FastBoundsCheck(k, lhs_right)) {
-        return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
-      }
-      if (!FastBoundsCheck(m, out.dimension(0))) {
-        return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));
-      }
-      const T a_value = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
-      for (std::size_t n = 0; n < rhs_right; ++n) {
-        const T b_value = maybe_adjoint_b(k, n);
-        out(m, n) += static_cast<Tsum>(a_value) * static_cast<Tsum>(b_value);
-      }
-    }
-  } else {
-    // Vectorization via Eigen.
-    const int b_chip_index = ADJ_B ? 1 : 0;
-
-#define LOOP_NNZ(b_passed)                                                  \
-  for (std::size_t i = 0; i < nnz; ++i) {                                   \
-    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a)); \
-    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a)); \
-    const T a_value = (ADJ_A) ? MaybeConj(a_values(i)) : a_values(i);       \
-    if (!FastBoundsCheck(k, lhs_right)) {                                   \
-      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);               \
-    }                                                                       \
-    if (!FastBoundsCheck(m, out.dimension(0))) {                            \
-      return MOutOfBoundsError(m, i, lhs_index_a, out.dimension(0));        \
-    }                                                                       \
-    out.template chip<0>(m) +=                                              \
-        b_passed.template chip<b_chip_index>(k).template cast<Tsum>() *     \
-        static_cast<Tsum>(a_value);                                         \
-  }
-
-    if (ADJ_B) {
-      // Perform transpose and conjugation on B once, since we chip out B's
-      // columns in the nnz loop.
-      Eigen::array<int, 2> shuffle(1, 0);  // preserve dimension order
-      Eigen::Tensor<T, 2, Eigen::ColMajor> col_major_conj_b =
-          b.swap_layout().shuffle(shuffle).conjugate();
-      LOOP_NNZ(col_major_conj_b);
-    } else {
-      LOOP_NNZ(b);
-    }
-#undef LOOP_NNZ
-  }
-  return Status::OK();
-}
-}  // namespace
-
-template <typename T, typename Tindices, bool ADJ_A, bool ADJ_B>
-struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
-  static Status Compute(OpKernelContext* ctx, typename TTypes<T>::Matrix out,
-                        typename TTypes<Tindices>::ConstMatrix a_indices,
-                        typename TTypes<T>::ConstVec a_values,
-                        typename TTypes<T>::ConstMatrix b) {
-    using Tsum = typename SumType<T>::type;
-    Tensor temp_out_t;
-    if (!std::is_same<T, Tsum>::value) {
-      TF_RETURN_IF_ERROR(ctx->allocate_temp(
-          DataTypeToEnum<Tsum>::value,
-          TensorShape({out.dimension(0), out.dimension(1)}), &temp_out_t));
-      auto temp_out = temp_out_t.matrix<Tsum>();
-      temp_out.setZero();
-      TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              temp_out, a_indices, a_values, b));
-      out = temp_out.template cast<T>();
-    } else {
-      out.setZero();
-      // This reinterpret_cast is just to avoid a compilation error. The result
-      // is only used if Tsum == T.
-      auto out_workaround =
-          *reinterpret_cast<typename TTypes<Tsum>::Matrix*>(&out);
-      TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              out_workaround, a_indices, a_values, b));
-    }
-    return Status::OK();
-  }
-};
-
-}  // namespace functor
-
 }  // namespace tensorflow
@@ -61,7 +61,7 @@ static Status TensorListDeviceCopy(
   for (const Tensor& t : from.tensors()) {
     to->tensors().emplace_back(t.dtype());
     if (t.dtype() != DT_INVALID) {
-      TF_RETURN_IF_ERROR(copy(t, &to->tensors().back()));
+      TF_RETURN_IF_ERROR(copy(t, to->tensors().mutable_back()));
     }
   }
   return Status::OK();
@@ -15,7 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_TENSOR_LIST_H_
 #define TENSORFLOW_CORE_KERNELS_TENSOR_LIST_H_
 
+#include <iterator>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/variant.h"
@@ -24,6 +27,178 @@ limitations under the License.
 
 namespace tensorflow {
 
+// A std::vector<Tensor>-like container storing its elements in fixed size
+// chunks that are shared between copies and copied on write. Copying the
+// container only copies the chunk pointers, and mutating an element of a
+// shared chunk first copies that chunk, so that a TensorList which is not
+// uniquely referenced (e.g. because the forward and backward passes of a
+// While loop both hold it) can be grown in amortized O(1) per element rather
+// than by copying all of its elements.
+//
+// Element accessors are read-only, so that reading an element never copies a
+// shared chunk; elements are replaced with set() or mutable_back().
+//
+// Like std::vector, it must not be mutated concurrently with other accesses.
+class ChunkedTensorVector {
+ public:
+  using value_type = Tensor;
+  using size_type = size_t;
+
+  class const_iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = Tensor;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Tensor*;
+    using reference = const Tensor&;
+
+    const_iterator() = default;
+    const_iterator(const ChunkedTensorVector* vector, size_t index)
+        : vector_(vector), index_(index) {}
+
+    reference operator*() const { return (*vector_)[index_]; }
+    pointer operator->() const { return &(*vector_)[index_]; }
+    reference operator[](difference_type n) const {
+      return (*vector_)[index_ + n];
+    }
+
+    const_iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    const_iterator operator++(int) { return {vector_, index_++}; }
+    const_iterator& operator--() {
+      --index_;
+      return *this;
+    }
+    const_iterator operator--(int) { return {vector_, index_--}; }
+    const_iterator& operator+=(difference_type n) {
+      index_ += n;
+      return *this;
+    }
+    const_iterator& operator-=(difference_type n) {
+      index_ -= n;
+      return *this;
+    }
+    const_iterator operator+(difference_type n) const {
+      return {vector_, index_ + n};
+    }
+    const_iterator operator-(difference_type n) const {
+      return {vector_, index_ - n};
+    }
+    difference_type operator-(const const_iterator& other) const {
+      return static_cast<difference_type>(index_) -
+             static_cast<difference_type>(other.index_);
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return index_ != other.index_;
+    }
+    bool operator<(const const_iterator& other) const {
+      return index_ < other.index_;
+    }
+    bool operator>(const const_iterator& other) const {
+      return index_ > other.index_;
+    }
+    bool operator<=(const const_iterator& other) const {
+      return index_ <= other.index_;
+    }
+    bool operator>=(const const_iterator& other) const {
+      return index_ >= other.index_;
+    }
+
+   private:
+    const ChunkedTensorVector* vector_ = nullptr;
+    size_t index_ = 0;
+  };
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const Tensor& operator[](size_t i) const {
+    return (*chunks_[i / kChunkSize])[i % kChunkSize];
+  }
+  const Tensor& at(size_t i) const {
+    CHECK_LT(i, size_);
+    return (*this)[i];
+  }
+  const Tensor& back() const { return (*this)[size_ - 1]; }
+
+  // Replaces the element at index `i`.
+  void set(size_t i, Tensor value) {
+    (*MutableChunk(i / kChunkSize))[i % kChunkSize] = std::move(value);
+  }
+  Tensor* mutable_back() {
+    return &(*MutableChunk((size_ - 1) / kChunkSize))[(size_ - 1) % kChunkSize];
+  }
+
+  const_iterator begin() const { return {this, 0}; }
+  const_iterator end() const { return {this, size_}; }
+
+  void reserve(size_t n) { chunks_.reserve((n + kChunkSize - 1) / kChunkSize); }
+
+  void push_back(const Tensor& value) { emplace_back(value); }
+  void push_back(Tensor&& value) { emplace_back(std::move(value)); }
+
+  template <typename... Args>
+  void emplace_back(Args&&... args) {
+    if (size_ % kChunkSize == 0) {
+      chunks_.push_back(std::make_shared<Chunk>());
+      chunks_.back()->reserve(kChunkSize);
+    }
+    MutableChunk(chunks_.size() - 1)
+        ->emplace_back(std::forward<Args>(args)...);
+    ++size_;
+  }
+
+  void pop_back() {
+    --size_;
+    if (size_ % kChunkSize == 0) {
+      chunks_.pop_back();
+    } else {
+      MutableChunk(chunks_.size() - 1)->pop_back();
+    }
+  }
+
+  void resize(size_t n) { resize(n, Tensor()); }
+  void resize(size_t n, const Tensor& value) {
+    if (n < size_) {
+      chunks_.resize((n + kChunkSize - 1) / kChunkSize);
+      size_ = n;
+      if (n % kChunkSize != 0) {
+        MutableChunk(chunks_.size() - 1)->resize(n % kChunkSize);
+      }
+    }
+    reserve(n);
+    while (size_ < n) push_back(value);
+  }
+
+ private:
+  // Large enough to amortize the pointer copies of a copy of the container,
+  // small enough for a copy on write of a single chunk to be cheap.
+  static constexpr size_t kChunkSize = 64;
+
+  using Chunk = std::vector<Tensor>;
+
+  Chunk* MutableChunk(size_t index) {
+    std::shared_ptr<Chunk>& chunk = chunks_[index];
+    if (chunk.use_count() != 1) {
+      auto copy = std::make_shared<Chunk>();
+      copy->reserve(kChunkSize);
+      copy->insert(copy->end(), chunk->begin(), chunk->end());
+      chunk = std::move(copy);
+    }
+    return chunk.get();
+  }
+
+  // All chunks but the last one hold kChunkSize elements.
+  std::vector<std::shared_ptr<Chunk>> chunks_;
+  size_t size_ = 0;
+};
+
 // Variant compatible type for a list of tensors. This is mutable but instances
 // should never be mutated after stored in a variant tensor.
 //
@@ -43,6 +218,9 @@ namespace tensorflow {
 //    TensorList b = a.Copy();
 //    b.tensors().push_back(t);  // This does not modify a.tensors().
 //
+// The copy shares the chunks of the container with the original until either
+// of them mutates them (see ChunkedTensorVector), so it is cheap.
+//
 // Note that this is not a deep copy: the memory locations of the underlying
 // tensors will still point to the same locations of the corresponding tensors
 // in the original.  To truly perform a deep copy, Device and Type-specific
@@ -123,8 +301,8 @@ class TensorList {
   int max_num_elements = -1;
 
   // Access to the underlying tensor container.
-  std::vector<Tensor>& tensors() { return tensors_->values_; }
-  const std::vector<Tensor>& tensors() const { return tensors_->values_; }
+  ChunkedTensorVector& tensors() { return tensors_->values_; }
+  const ChunkedTensorVector& tensors() const { return tensors_->values_; }
 
   // Get a new TensorList containing a copy of the underlying tensor container.
   TensorList Copy() const {
@@ -132,7 +310,7 @@ class TensorList {
     out.element_shape = element_shape;
     out.element_dtype = element_dtype;
     out.max_num_elements = max_num_elements;
-    // This performs a copy of the std::vector.
+    // This only copies the chunk pointers of the container.
     out.tensors_->values_ = tensors_->values_;
     return out;
   }
@@ -144,7 +322,7 @@ class TensorList {
  private:
   class Tensors : public core::RefCounted {
    public:
-    std::vector<Tensor> values_;
+    ChunkedTensorVector values_;
   };
   Tensors* tensors_;
 };
@@ -0,0 +1,123 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/tensor_list.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Larger than a few chunks of ChunkedTensorVector.
+constexpr int kNumElements = 200;
+
+Tensor Scalar(int value) { return test::AsScalar<int32>(value); }
+
+int Value(const Tensor& t) { return t.scalar<int32>()(); }
+
+// Expects `v` to hold the values [0, size).
+void ExpectRange(const ChunkedTensorVector& v, int size) {
+  ASSERT_EQ(v.size(), size);
+  EXPECT_EQ(v.empty(), size == 0);
+  for (int i = 0; i < size; ++i) {
+    EXPECT_EQ(Value(v[i]), i);
+  }
+}
+
+ChunkedTensorVector MakeRange(int size) {
+  ChunkedTensorVector v;
+  for (int i = 0; i < size; ++i) v.push_back(Scalar(i));
+  return v;
+}
+
+TEST(ChunkedTensorVectorTest, PushAndPopAcrossChunks) {
+  ChunkedTensorVector v = MakeRange(kNumElements);
+  ExpectRange(v, kNumElements);
+  EXPECT_EQ(Value(v.back()), kNumElements - 1);
+  for (int size = kNumElements; size > 0; --size) {
+    ExpectRange(v, size);
+    v.pop_back();
+  }
+  ExpectRange(v, 0);
+  v.emplace_back(Scalar(0));
+  ExpectRange(v, 1);
+}
+
+TEST(ChunkedTensorVectorTest, Resize) {
+  ChunkedTensorVector v = MakeRange(kNumElements);
+  v.resize(65);
+  ExpectRange(v, 65);
+  v.resize(64);
+  ExpectRange(v, 64);
+  v.resize(130, Tensor(DT_INVALID));
+  ASSERT_EQ(v.size(), 130);
+  for (int i = 0; i < 64; ++i) EXPECT_EQ(Value(v[i]), i);
+  for (int i = 64; i < 130; ++i) EXPECT_EQ(v[i].dtype(), DT_INVALID);
+  v.resize(0);
+  ExpectRange(v, 0);
+}
+
+TEST(ChunkedTensorVectorTest, Iterators) {
+  ChunkedTensorVector v = MakeRange(kNumElements);
+  EXPECT_EQ(v.end() - v.begin(), kNumElements);
+  int i = 0;
+  for (const Tensor& t : v) EXPECT_EQ(Value(t), i++);
+  ChunkedTensorVector copy;
+  std::copy(v.begin(), v.end(), std::back_inserter(copy));
+  ExpectRange(copy, kNumElements);
+}
+
+TEST(ChunkedTensorVectorTest, CopiesAreIsolated) {
+  ChunkedTensorVector a = MakeRange(kNumElements);
+  ChunkedTensorVector b = a;
+  b.set(3, Scalar(-1));
+  b.push_back(Scalar(kNumElements));
+  *b.mutable_back() = Scalar(-2);
+  ExpectRange(a, kNumElements);
+  EXPECT_EQ(Value(b[3]), -1);
+  EXPECT_EQ(Value(b.back()), -2);
+
+  ChunkedTensorVector c = a;
+  c.pop_back();
+  c.resize(10);
+  a.set(0, Scalar(-3));
+  ExpectRange(c, 10);
+  EXPECT_EQ(Value(a[0]), -3);
+  EXPECT_EQ(a.size(), kNumElements);
+}
+
+TEST(TensorListTest, CopyIsIsolated) {
+  TensorList list;
+  for (int i = 0; i < kNumElements; ++i) list.tensors().push_back(Scalar(i));
+  TensorList copy = list.Copy();
+  copy.tensors().set(100, Scalar(-1));
+  copy.tensors().push_back(Scalar(kNumElements));
+  list.tensors().pop_back();
+
+  ExpectRange(list.tensors(), kNumElements - 1);
+  ASSERT_EQ(copy.tensors().size(), kNumElements + 1);
+  EXPECT_EQ(Value(copy.tensors()[100]), -1);
+  EXPECT_EQ(Value(copy.tensors()[kNumElements - 1]), kNumElements - 1);
+  EXPECT_EQ(Value(copy.tensors().back()), kNumElements);
+}
+
+}  // namespace
+}  // namespace tensorflow
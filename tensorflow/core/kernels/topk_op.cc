@@ -109,6 +109,19 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+namespace {
+
+// The minimum number of columns of the chunks rows are split into.
+constexpr int64 kMinChunkSize = 32 * 1024;
+// The ratio of num_cols to k up to which the top k are selected instead of
+// filtered through a heap. Past it, most values don't make it into the heap
+// and are skipped cheaply.
+constexpr int64 kMaxColsPerKForSelection = 16;
+// The number of values compared to the bottom of the heap at once.
+constexpr int32 kFilterBlockSize = 16;
+
+}  // namespace
+
 template <typename T>
 struct TopKFunctor<CPUDevice, T> {
   static EIGEN_ALWAYS_INLINE Status
@@ -146,26 +159,28 @@ struct TopKFunctor<CPUDevice, T> {
       return Status::OK();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<int32>() +
+                            Eigen::TensorOpCost::AddCost<T>();
+
+    // With fewer rows than threads, long rows are split into chunks whose top
+    // k are selected in parallel, and then merged, as long as merging the
+    // k candidates of each chunk is cheap compared to scanning the row.
+    const int64 chunks_per_row = std::min(
+        Eigen::divup<int64>(worker_threads.num_threads, num_rows),
+        num_cols / std::max<int64>(kMinChunkSize, 4 * k));
+    if (chunks_per_row > 1) {
+      return ComputeWithSplitRows(context, sorted, k, input, num_rows, num_cols,
+                                  chunks_per_row, values, indices);
+    }
+
     auto SortIndices = [&](int64 start_batch, int64 limit_batch) {
       for (int32 b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
-        const auto stable_comp = [input_data](const int32 a, const int32 b) {
-          if (input_data[b] < input_data[a]) {
-            return true;
-          } else if (input_data[b] > input_data[a]) {
-            return false;
-          } else {
-            return a < b;
-          }
-        };
+        const StableComp stable_comp{input_data};
         const auto comp = [input_data](const int32 a, const int32 b) {
           return input_data[b] < input_data[a];
         };
-        // TODO(ebrevdo): For large k < num_cols, instead of using
-        // TopN, it may be faster to create a temporary vector of
-        // values 0..num_cols - 1 and then use std::partial_sort_copy
-        // of this into indices. Choosing the appropriate minimum k or
-        // ratio of k/num_cols will require some experimentation.
         if (k == num_cols) {
           auto* begin = &indices(b, 0);
           auto* end = &indices(b, k);
@@ -188,27 +203,27 @@ struct TopKFunctor<CPUDevice, T> {
             }
             run_begin = run_end;
           }
+        } else if (k * kMaxColsPerKForSelection >= num_cols &&
+                   std::none_of(input_data, input_data + num_cols,
+                                [](const T& v) {
+                                  return Eigen::numext::isnan(v);
+                                })) {
+          // For a large k, selecting the k-th index in linear time and
+          // sorting the indices before it beats pushing all of them into a
+          // heap of size k. NaNs have no order, which std::nth_element()
+          // needs.
+          std::vector<int32> order(num_cols);
+          std::iota(order.begin(), order.end(), 0);
+          std::nth_element(order.begin(), order.begin() + k - 1, order.end(),
+                           stable_comp);
+          std::sort(order.begin(), order.begin() + k, stable_comp);
+          std::copy(order.begin(), order.begin() + k, &indices(b, 0));
         } else {
           // Use the TopN heap object to sort.
-          gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
+          gtl::TopN<int32, StableComp> filter(k, stable_comp);
           filter.reserve(num_cols);
-          for (int32 c = 0; c < num_cols; ++c) {
-            filter.push(c);
-          }
-
-          int32 i = 0;
-          if (sorted) {
-            std::unique_ptr<std::vector<int32>> top_k(filter.Extract());
-            for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
-                 ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          } else {
-            for (auto top_k_it = filter.unsorted_begin();
-                 top_k_it != filter.unsorted_end(); ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          }
+          PushRange(input_data, 0, num_cols, k, &filter);
+          ExtractTopK(sorted, &filter, &indices(b, 0));
         }
         // Now that the indices are sorted, copy the values over in
         // sorted order.
@@ -219,8 +234,6 @@ struct TopKFunctor<CPUDevice, T> {
 
     // Guesstimate of cost; 4*N*log(K) where N == num_cols.
     // If K == N, assume the cost is N*log(K + 1).
-    const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<int32>() +
-                            Eigen::TensorOpCost::AddCost<T>();
     const double base_cost =
         cmp_cost *
         static_cast<double>(num_cols *
@@ -231,12 +244,123 @@ struct TopKFunctor<CPUDevice, T> {
     const int64 final_cost = (total_cost >= static_cast<double>(kint64max))
                                  ? kint64max
                                  : static_cast<int64>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
     return Status::OK();
   }
+
+ private:
+  // Orders the indices of a row by decreasing value, and then by increasing
+  // index for equal values.
+  struct StableComp {
+    const T* input_data;
+    bool operator()(const int32 a, const int32 b) const {
+      if (input_data[b] < input_data[a]) {
+        return true;
+      } else if (input_data[b] > input_data[a]) {
+        return false;
+      } else {
+        return a < b;
+      }
+    }
+  };
+
+  // Pushes the indices in [begin, end) into `filter`, of size `k`, in
+  // increasing order.
+  //
+  // Once the filter is full, an index only enters it if its value is greater
+  // than the one of the bottom of the filter, whose index is smaller. Most
+  // blocks of values have none, which is checked in a loop without branches
+  // that the compiler vectorizes before pushing any of them.
+  static void PushRange(const T* input_data, int32 begin, int32 end, int k,
+                        gtl::TopN<int32, StableComp>* filter) {
+    int32 c = begin;
+    for (; c < end && c <= begin + k; ++c) {
+      filter->push(c);
+    }
+    while (c < end) {
+      const int32 block_end = std::min(c + kFilterBlockSize, end);
+      const T threshold = input_data[filter->peek_bottom()];
+      bool any_greater = false;
+      for (int32 i = c; i < block_end; ++i) {
+        any_greater |= input_data[i] > threshold;
+      }
+      if (any_greater) {
+        for (int32 i = c; i < block_end; ++i) {
+          filter->push(i);
+        }
+      }
+      c = block_end;
+    }
+  }
+
+  // Writes the k indices of `filter` to `indices`, in decreasing order of
+  // their values if `sorted`.
+  static void ExtractTopK(bool sorted, gtl::TopN<int32, StableComp>* filter,
+                          int32* indices) {
+    if (sorted) {
+      std::unique_ptr<std::vector<int32>> top_k(filter->Extract());
+      std::copy(top_k->begin(), top_k->end(), indices);
+    } else {
+      std::copy(filter->unsorted_begin(), filter->unsorted_end(), indices);
+    }
+  }
+
+  // Computes the top k of each row from the top k of `chunks_per_row`
+  // consecutive chunks of at least k columns of the row, which are selected
+  // in parallel. Since the order of the indices is total, the result is the
+  // same as when the whole row is filtered at once, but for NaNs, which have
+  // no order either way.
+  static Status ComputeWithSplitRows(
+      OpKernelContext* context, bool sorted, int k,
+      const typename TTypes<T, 2>::ConstTensor& input, const int64 num_rows,
+      const int64 num_cols, const int64 chunks_per_row,
+      typename TTypes<T, 2>::Tensor values,
+      typename TTypes<int, 2>::Tensor indices) {
+    const int64 num_chunks = num_rows * chunks_per_row;
+    std::vector<int32> candidates(num_chunks * k);
+    auto SelectChunks = [&](int64 start_chunk, int64 limit_chunk) {
+      for (int64 chunk = start_chunk; chunk < limit_chunk; ++chunk) {
+        const int64 b = chunk / chunks_per_row;
+        const int64 chunk_in_row = chunk % chunks_per_row;
+        const int32 begin = chunk_in_row * num_cols / chunks_per_row;
+        const int32 end = (chunk_in_row + 1) * num_cols / chunks_per_row;
+        const T* input_data = &input(b, 0);
+        gtl::TopN<int32, StableComp> filter(k, StableComp{input_data});
+        filter.reserve(end - begin);
+        PushRange(input_data, begin, end, k, &filter);
+        ExtractTopK(/*sorted=*/false, &filter, &candidates[chunk * k]);
+      }
+    };
+    auto MergeChunks = [&](int64 start_batch, int64 limit_batch) {
+      for (int64 b = start_batch; b < limit_batch; ++b) {
+        gtl::TopN<int32, StableComp> filter(k, StableComp{&input(b, 0)});
+        filter.reserve(chunks_per_row * k);
+        for (int64 i = b * chunks_per_row * k; i < (b + 1) * chunks_per_row * k;
+             ++i) {
+          filter.push(candidates[i]);
+        }
+        ExtractTopK(sorted, &filter, &indices(b, 0));
+        std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                       [b, &input](const int32 loc) { return input(b, loc); });
+      }
+    };
+
+    const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<int32>() +
+                            Eigen::TensorOpCost::AddCost<T>();
+    const double chunk_cost = cmp_cost * num_cols / chunks_per_row;
+    const double merge_cost =
+        cmp_cost * chunks_per_row * k *
+            Eigen::numext::log2(static_cast<float>(k + 1)) +
+        2 * k * Eigen::TensorOpCost::AddCost<T>();
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, num_chunks,
+          static_cast<int64>(chunk_cost), SelectChunks);
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          static_cast<int64>(merge_cost), MergeChunks);
+    return Status::OK();
+  }
 };
 
 }  // namespace functor
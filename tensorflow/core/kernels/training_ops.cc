@@ -17,6 +17,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <initializer_list>
+#include <numeric>
+#include <unordered_set>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -27,6 +31,10 @@ limitations under the License.
 #include "tensorflow/core/platform/bfloat16.h"
 #include "tensorflow/core/util/util.h"
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/kernels/gpu_device_array.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 namespace tensorflow {
 
 using CPUDevice = Eigen::ThreadPoolDevice;
@@ -3161,6 +3169,265 @@ REGISTER_KERNELS(GPU, complex128);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+// Gets the tensors of the variables at inputs [0, num_vars) and checks that
+// they are initialized and distinct, for the Multi ops.
+template <typename Device, typename T>
+Status GetMultiVariableTensors(OpKernelContext* ctx, int num_vars,
+                               bool lock_held, std::vector<Tensor>* vars) {
+  vars->resize(num_vars);
+  std::unordered_set<const void*> buffers;
+  for (int i = 0; i < num_vars; ++i) {
+    Tensor* var = &(*vars)[i];
+    TF_RETURN_IF_ERROR(GetInputTensorFromVariable<Device, T>(
+        ctx, i, lock_held, /*sparse=*/false, var));
+    if (!var->IsInitialized()) {
+      return errors::FailedPrecondition(
+          "Attempting to use uninitialized variables: ",
+          ctx->op_kernel().requested_input(i));
+    }
+    // Updating a variable twice is a race on GPU.
+    if (var->NumElements() > 0 &&
+        !buffers.insert(var->tensor_data().data()).second) {
+      return errors::InvalidArgument(
+          "Variables must be distinct, but ",
+          ctx->op_kernel().requested_input(i), " was already given");
+    }
+  }
+  return Status::OK();
+}
+
+// Updates the variables of the Multi ops with one functor call per variable.
+template <typename Device, typename T>
+struct LaunchMultiApply {
+  static Status Momentum(OpKernelContext* ctx, const std::vector<Tensor>& var,
+                         const std::vector<Tensor>& accum, const Tensor& lr,
+                         const std::vector<Tensor>& grad,
+                         const Tensor& momentum, bool use_nesterov) {
+    const Device& device = ctx->template eigen_device<Device>();
+    for (int i = 0; i < var.size(); ++i) {
+      Tensor var_i = var[i];
+      Tensor accum_i = accum[i];
+      functor::ApplyMomentum<Device, T>()(
+          device, var_i.flat<T>(), accum_i.flat<T>(), lr.scalar<T>(),
+          grad[i].flat<T>(), momentum.scalar<T>(), use_nesterov);
+    }
+    return Status::OK();
+  }
+
+  static Status Adam(OpKernelContext* ctx, const std::vector<Tensor>& var,
+                     const std::vector<Tensor>& m, const std::vector<Tensor>& v,
+                     const Tensor& beta1_power, const Tensor& beta2_power,
+                     const Tensor& lr, const Tensor& beta1, const Tensor& beta2,
+                     const Tensor& epsilon, const std::vector<Tensor>& grad,
+                     bool use_nesterov) {
+    const Device& device = ctx->template eigen_device<Device>();
+    for (int i = 0; i < var.size(); ++i) {
+      Tensor var_i = var[i];
+      Tensor m_i = m[i];
+      Tensor v_i = v[i];
+      functor::ApplyAdam<Device, T>()(
+          device, var_i.flat<T>(), m_i.flat<T>(), v_i.flat<T>(),
+          beta1_power.scalar<T>(), beta2_power.scalar<T>(), lr.scalar<T>(),
+          beta1.scalar<T>(), beta2.scalar<T>(), epsilon.scalar<T>(),
+          grad[i].flat<T>(), use_nesterov);
+    }
+    return Status::OK();
+  }
+};
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// Sets `ptrs` to the buffers of `tensors` and copies them to the GPU.
+template <typename T, typename Ptr>
+Status SetGpuBuffers(const std::vector<Tensor>& tensors,
+                     GpuDeviceArrayOnHost<Ptr>* ptrs) {
+  TF_RETURN_IF_ERROR(ptrs->Init());
+  for (int i = 0; i < tensors.size(); ++i) {
+    ptrs->Set(i, const_cast<T*>(tensors[i].flat<T>().data()));
+  }
+  return ptrs->Finalize();
+}
+
+// Sets `offsets` to the offsets of `tensors` in their concatenation, followed
+// by its size, and copies them to the GPU.
+inline Status SetGpuOffsets(const std::vector<Tensor>& tensors,
+                            GpuDeviceArrayOnHost<int64>* offsets,
+                            int64* num_elements) {
+  TF_RETURN_IF_ERROR(offsets->Init());
+  *num_elements = 0;
+  for (int i = 0; i < tensors.size(); ++i) {
+    offsets->Set(i, *num_elements);
+    *num_elements += tensors[i].NumElements();
+  }
+  offsets->Set(tensors.size(), *num_elements);
+  return offsets->Finalize();
+}
+
+// Updates all the variables of the Multi ops in one kernel launch, which gets
+// the buffers of the variables in device arrays.
+template <typename T>
+struct LaunchMultiApply<GPUDevice, T> {
+  static Status Momentum(OpKernelContext* ctx, const std::vector<Tensor>& var,
+                         const std::vector<Tensor>& accum, const Tensor& lr,
+                         const std::vector<Tensor>& grad,
+                         const Tensor& momentum, bool use_nesterov) {
+    const int num_vars = var.size();
+    GpuDeviceArrayOnHost<T*> var_ptrs(ctx, num_vars);
+    GpuDeviceArrayOnHost<T*> accum_ptrs(ctx, num_vars);
+    GpuDeviceArrayOnHost<const T*> grad_ptrs(ctx, num_vars);
+    GpuDeviceArrayOnHost<int64> offsets(ctx, num_vars + 1);
+    int64 num_elements;
+    TF_RETURN_IF_ERROR(SetGpuBuffers<T>(var, &var_ptrs));
+    TF_RETURN_IF_ERROR(SetGpuBuffers<T>(accum, &accum_ptrs));
+    TF_RETURN_IF_ERROR(SetGpuBuffers<T>(grad, &grad_ptrs));
+    TF_RETURN_IF_ERROR(SetGpuOffsets(var, &offsets, &num_elements));
+    functor::ApplyMomentumMulti<GPUDevice, T>()(
+        ctx->eigen_gpu_device(), var_ptrs.data(), accum_ptrs.data(),
+        lr.scalar<T>(), grad_ptrs.data(), offsets.data(), num_elements,
+        momentum.scalar<T>(), use_nesterov);
+    return Status::OK();
+  }
+
+  static Status Adam(OpKernelContext* ctx, const std::vector<Tensor>& var,
+                     const std::vector<Tensor>& m, const std::vector<Tensor>& v,
+                     const Tensor& beta1_power, const Tensor& beta2_power,
+                     const Tensor& lr, const Tensor& beta1, const Tensor& beta2,
+                     const Tensor& epsilon, const std::vector<Tensor>& grad,
+                     bool use_nesterov) {
+    const int num_vars = var.size();
+    GpuDeviceArrayOnHost<T*> var_ptrs(ctx, num_vars);
+    GpuDeviceArrayOnHost<T*> m_ptrs(ctx, num_vars);
+    GpuDeviceArrayOnHost<T*> v_ptrs(ctx, num_vars);
+    GpuDeviceArrayOnHost<const T*> grad_ptrs(ctx, num_vars);
+    GpuDeviceArrayOnHost<int64> offsets(ctx, num_vars + 1);
+    int64 num_elements;
+    TF_RETURN_IF_ERROR(SetGpuBuffers<T>(var, &var_ptrs));
+    TF_RETURN_IF_ERROR(SetGpuBuffers<T>(m, &m_ptrs));
+    TF_RETURN_IF_ERROR(SetGpuBuffers<T>(v, &v_ptrs));
+    TF_RETURN_IF_ERROR(SetGpuBuffers<T>(grad, &grad_ptrs));
+    TF_RETURN_IF_ERROR(SetGpuOffsets(var, &offsets, &num_elements));
+    functor::ApplyAdamMulti<GPUDevice, T>()(
+        ctx->eigen_gpu_device(), var_ptrs.data(), m_ptrs.data(), v_ptrs.data(),
+        beta1_power.scalar<T>(), beta2_power.scalar<T>(), lr.scalar<T>(),
+        beta1.scalar<T>(), beta2.scalar<T>(), epsilon.scalar<T>(),
+        grad_ptrs.data(), offsets.data(), num_elements, use_nesterov);
+    return Status::OK();
+  }
+};
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Checks that var[i], slots[k][i] and grad[i] have the same shape.
+inline Status CheckMultiShapes(
+    const std::vector<Tensor>& var,
+    std::initializer_list<const std::vector<Tensor>*> slots,
+    const std::vector<Tensor>& grad) {
+  for (int i = 0; i < var.size(); ++i) {
+    for (const std::vector<Tensor>* slot : slots) {
+      if (!var[i].shape().IsSameSize((*slot)[i].shape())) {
+        return errors::InvalidArgument(
+            "var and its slot do not have the same shape",
+            var[i].shape().DebugString(), " ",
+            (*slot)[i].shape().DebugString());
+      }
+    }
+    if (!var[i].shape().IsSameSize(grad[i].shape())) {
+      return errors::InvalidArgument("var and grad do not have the same shape",
+                                     var[i].shape().DebugString(), " ",
+                                     grad[i].shape().DebugString());
+    }
+  }
+  return Status::OK();
+}
+
+// Does what ApplyMomentumOp does for a list of resource variables.
+template <typename Device, typename T>
+class ApplyMomentumMultiOp : public OpKernel {
+ public:
+  explicit ApplyMomentumMultiOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int n = num_vars_;
+    std::vector<int> var_inputs(2 * n);
+    std::iota(var_inputs.begin(), var_inputs.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
+        ctx, use_exclusive_lock_, /*sparse=*/false, var_inputs);
+
+    // The variables, followed by the accumulators.
+    std::vector<Tensor> vars;
+    OP_REQUIRES_OK(ctx, GetMultiVariableTensors<Device, T>(
+                            ctx, 2 * n, use_exclusive_lock_, &vars));
+    const std::vector<Tensor> var(vars.begin(), vars.begin() + n);
+    const std::vector<Tensor> accum(vars.begin() + n, vars.end());
+
+    const Tensor& lr = ctx->input(2 * n);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar: ",
+                                        lr.shape().DebugString()));
+    std::vector<Tensor> grad;
+    for (int i = 0; i < n; ++i) grad.push_back(ctx->input(2 * n + 1 + i));
+    OP_REQUIRES_OK(ctx, CheckMultiShapes(var, {&accum}, grad));
+
+    const Tensor& momentum = ctx->input(3 * n + 1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(momentum.shape()),
+                errors::InvalidArgument("momentum is not a scalar: ",
+                                        momentum.shape().DebugString()));
+
+    OP_REQUIRES_OK(ctx,
+                   LaunchMultiApply<Device, T>::Momentum(
+                       ctx, var, accum, lr, grad, momentum, use_nesterov_));
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+#define REGISTER_KERNELS(D, T)                                   \
+  REGISTER_KERNEL_BUILDER(Name("ResourceApplyMomentumMulti")     \
+                              .Device(DEVICE_##D)                \
+                              .HostMemory("var")                 \
+                              .HostMemory("accum")               \
+                              .TypeConstraint<T>("T"),           \
+                          ApplyMomentumMultiOp<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_FLOAT_TYPES(REGISTER_CPU_KERNELS);
+TF_CALL_COMPLEX_TYPES(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// Forward declarations of the functor specializations for GPU.
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                                  \
+  template <>                                                                \
+  void ApplyMomentumMulti<GPUDevice, T>::operator()(                         \
+      const GPUDevice& d, const GpuDeviceArrayStruct<T*>& var,               \
+      const GpuDeviceArrayStruct<T*>& accum,                                 \
+      typename TTypes<T>::ConstScalar lr,                                    \
+      const GpuDeviceArrayStruct<const T*>& grad,                            \
+      const GpuDeviceArrayStruct<int64>& offsets, int64 num_elements,        \
+      typename TTypes<T>::ConstScalar momentum, bool use_nesterov);          \
+  extern template struct ApplyMomentumMulti<GPUDevice, T>;
+DECLARE_GPU_SPEC(Eigen::half);
+DECLARE_GPU_SPEC(float);
+DECLARE_GPU_SPEC(double);
+DECLARE_GPU_SPEC(complex64);
+DECLARE_GPU_SPEC(complex128);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+REGISTER_KERNELS(GPU, complex64);
+REGISTER_KERNELS(GPU, complex128);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 // Note, this op works on cpu only.
 template <typename T, typename Tindex>
 class SparseApplyMomentumOp : public OpKernel {
@@ -3654,6 +3921,121 @@ REGISTER_KERNELS(GPU, complex128);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+// Does what ApplyAdamOp does for a list of resource variables.
+template <typename Device, typename T>
+class ApplyAdamMultiOp : public OpKernel {
+ public:
+  explicit ApplyAdamMultiOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int n = num_vars_;
+    std::vector<int> var_inputs(3 * n);
+    std::iota(var_inputs.begin(), var_inputs.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
+        ctx, use_exclusive_lock_, /*sparse=*/false, var_inputs);
+
+    // The variables, followed by their m and v.
+    std::vector<Tensor> vars;
+    OP_REQUIRES_OK(ctx, GetMultiVariableTensors<Device, T>(
+                            ctx, 3 * n, use_exclusive_lock_, &vars));
+    const std::vector<Tensor> var(vars.begin(), vars.begin() + n);
+    const std::vector<Tensor> m(vars.begin() + n, vars.begin() + 2 * n);
+    const std::vector<Tensor> v(vars.begin() + 2 * n, vars.end());
+
+    const Tensor& beta1_power = ctx->input(3 * n);
+    const Tensor& beta2_power = ctx->input(3 * n + 1);
+    const Tensor& lr = ctx->input(3 * n + 2);
+    const Tensor& beta1 = ctx->input(3 * n + 3);
+    const Tensor& beta2 = ctx->input(3 * n + 4);
+    const Tensor& epsilon = ctx->input(3 * n + 5);
+
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1_power.shape()),
+                errors::InvalidArgument("beta1_power is not a scalar: ",
+                                        beta1_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2_power.shape()),
+                errors::InvalidArgument("beta2_power is not a scalar: ",
+                                        beta2_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar : ",
+                                        lr.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1.shape()),
+                errors::InvalidArgument("beta1 is not a scalar: ",
+                                        beta1.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2.shape()),
+                errors::InvalidArgument("beta2 is not a scalar: ",
+                                        beta2.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(epsilon.shape()),
+                errors::InvalidArgument("epsilon is not a scalar: ",
+                                        epsilon.shape().DebugString()));
+
+    std::vector<Tensor> grad;
+    for (int i = 0; i < n; ++i) grad.push_back(ctx->input(3 * n + 6 + i));
+    OP_REQUIRES_OK(ctx, CheckMultiShapes(var, {&m, &v}, grad));
+
+    OP_REQUIRES_OK(ctx, LaunchMultiApply<Device, T>::Adam(
+                            ctx, var, m, v, beta1_power, beta2_power, lr,
+                            beta1, beta2, epsilon, grad, use_nesterov_));
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+#define REGISTER_KERNELS(D, T)                               \
+  REGISTER_KERNEL_BUILDER(Name("ResourceApplyAdamMulti")     \
+                              .HostMemory("var")             \
+                              .HostMemory("m")               \
+                              .HostMemory("v")               \
+                              .Device(DEVICE_##D)            \
+                              .TypeConstraint<T>("T"),       \
+                          ApplyAdamMultiOp<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_FLOAT_TYPES(REGISTER_CPU_KERNELS);
+TF_CALL_COMPLEX_TYPES(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// Forward declarations of the functor specializations for GPU.
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                            \
+  template <>                                                          \
+  void ApplyAdamMulti<GPUDevice, T>::operator()(                       \
+      const GPUDevice& d, const GpuDeviceArrayStruct<T*>& var,         \
+      const GpuDeviceArrayStruct<T*>& m,                               \
+      const GpuDeviceArrayStruct<T*>& v,                               \
+      typename TTypes<T>::ConstScalar beta1_power,                     \
+      typename TTypes<T>::ConstScalar beta2_power,                     \
+      typename TTypes<T>::ConstScalar lr,                              \
+      typename TTypes<T>::ConstScalar beta1,                           \
+      typename TTypes<T>::ConstScalar beta2,                           \
+      typename TTypes<T>::ConstScalar epsilon,                         \
+      const GpuDeviceArrayStruct<const T*>& grad,                      \
+      const GpuDeviceArrayStruct<int64>& offsets, int64 num_elements,  \
+      bool use_nesterov);                                              \
+  extern template struct ApplyAdamMulti<GPUDevice, T>;
+DECLARE_GPU_SPEC(Eigen::half);
+DECLARE_GPU_SPEC(float);
+DECLARE_GPU_SPEC(double);
+DECLARE_GPU_SPEC(complex64);
+DECLARE_GPU_SPEC(complex128);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+REGISTER_KERNELS(GPU, complex64);
+REGISTER_KERNELS(GPU, complex128);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 template <typename Device, typename T>
 class ApplyAdamWithAmsgradOp : public OpKernel {
  public:
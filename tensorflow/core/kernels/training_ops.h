@@ -21,6 +21,10 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/kernels/gpu_device_array_gpu.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 namespace tensorflow {
 namespace functor {
 
@@ -211,6 +215,22 @@ struct ApplyMomentum {
                   typename TTypes<T>::ConstScalar momentum, bool use_nesterov);
 };
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// Does ApplyMomentum for `var.size` variables in one kernel launch. Viewing the
+// variables as concatenated, variable i holds the elements in
+// [offsets[i], offsets[i + 1]) of the `num_elements` = `offsets[var.size]`.
+template <typename Device, typename T>
+struct ApplyMomentumMulti {
+  void operator()(const Device& d, const GpuDeviceArrayStruct<T*>& var,
+                  const GpuDeviceArrayStruct<T*>& accum,
+                  typename TTypes<T>::ConstScalar lr,
+                  const GpuDeviceArrayStruct<const T*>& grad,
+                  const GpuDeviceArrayStruct<int64>& offsets,
+                  int64 num_elements, typename TTypes<T>::ConstScalar momentum,
+                  bool use_nesterov);
+};
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 template <typename Device, typename T>
 struct ApplyKerasMomentum {
   void operator()(const Device& d, typename TTypes<T>::Flat var,
@@ -244,6 +264,26 @@ struct ApplyAdam {
                   typename TTypes<T>::ConstFlat grad, bool use_nesterov);
 };
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// Does ApplyAdam for `var.size` variables in one kernel launch, with the
+// variables laid out as for ApplyMomentumMulti.
+template <typename Device, typename T>
+struct ApplyAdamMulti {
+  void operator()(const Device& d, const GpuDeviceArrayStruct<T*>& var,
+                  const GpuDeviceArrayStruct<T*>& m,
+                  const GpuDeviceArrayStruct<T*>& v,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon,
+                  const GpuDeviceArrayStruct<const T*>& grad,
+                  const GpuDeviceArrayStruct<int64>& offsets,
+                  int64 num_elements, bool use_nesterov);
+};
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 template <typename Device, typename T>
 struct ApplyAdamWithAmsgrad {
   void operator()(const Device& d, typename TTypes<T>::Flat var,
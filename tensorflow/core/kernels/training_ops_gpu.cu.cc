@@ -218,6 +218,121 @@ __global__ __launch_bounds__(1024) void ApplyAdamKernel(
   }
 }
 
+// Returns the index of the variable that holds element `i` of the
+// concatenation of `num_vars` variables, whose elements start at `offsets`.
+// The variable is searched for in [first, num_vars).
+static __device__ int FindVariable(const int64* offsets, int first,
+                                   int num_vars, int64 i) {
+  int lo = first;
+  int hi = num_vars - 1;
+  // The last variable that starts at or before `i` holds it: the variables
+  // after it until `i` are empty.
+  while (lo < hi) {
+    const int mid = lo + (hi - lo + 1) / 2;
+    if (offsets[mid] <= i) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return lo;
+}
+
+template <typename T>
+__global__ __launch_bounds__(1024) void ApplyMomentumMultiKernel(
+    GpuDeviceArrayStruct<T*> var_ptrs, GpuDeviceArrayStruct<T*> accum_ptrs,
+    const T* const lr_, GpuDeviceArrayStruct<const T*> grad_ptrs,
+    GpuDeviceArrayStruct<int64> offsets_array, int64 num_elements,
+    const T* const momentum_, bool use_nesterov) {
+  T** vars = GetGpuDeviceArrayOnDevice(&var_ptrs);
+  T** accums = GetGpuDeviceArrayOnDevice(&accum_ptrs);
+  const T** grads = GetGpuDeviceArrayOnDevice(&grad_ptrs);
+  const int64* offsets = GetGpuDeviceArrayOnDevice(&offsets_array);
+  const int num_vars = var_ptrs.size;
+
+  const T lr = (*lr_);
+  const T momentum = (*momentum_);
+  // The elements a thread visits increase, and so do their variables.
+  int var_index = 0;
+  for (int64 i : GpuGridRangeX(num_elements)) {
+    var_index = FindVariable(offsets, var_index, num_vars, i);
+    const int64 j = i - offsets[var_index];
+    T* var = vars[var_index];
+    T* accum = accums[var_index];
+    const T g_i = grads[var_index][j];
+
+    // Avoid += and -= due to std::complex<T> issues on device for MSVC.
+    const T accum_i = accum[j] * momentum + g_i;
+    if (use_nesterov) {
+      var[j] = var[j] - (g_i * lr + accum_i * momentum * lr);
+    } else {
+      var[j] = var[j] - lr * accum_i;
+    }
+    accum[j] = accum_i;
+  }
+}
+
+template <typename T>
+__global__ __launch_bounds__(1024) void ApplyAdamMultiKernel(
+    GpuDeviceArrayStruct<T*> var_ptrs, GpuDeviceArrayStruct<T*> m_ptrs,
+    GpuDeviceArrayStruct<T*> v_ptrs, const T* const beta1_power_,
+    const T* const beta2_power_, const T* const lr_, const T* const beta1_,
+    const T* const beta2_, const T* const epsilon_,
+    GpuDeviceArrayStruct<const T*> grad_ptrs,
+    GpuDeviceArrayStruct<int64> offsets_array, int64 num_elements,
+    bool use_nesterov) {
+  T** vars = GetGpuDeviceArrayOnDevice(&var_ptrs);
+  T** ms = GetGpuDeviceArrayOnDevice(&m_ptrs);
+  T** vs = GetGpuDeviceArrayOnDevice(&v_ptrs);
+  const T** grads = GetGpuDeviceArrayOnDevice(&grad_ptrs);
+  const int64* offsets = GetGpuDeviceArrayOnDevice(&offsets_array);
+  const int num_vars = var_ptrs.size;
+
+  const T mul_factor =
+      (*lr_) * Eigen::numext::sqrt(static_cast<T>(1.0) - (*beta2_power_)) /
+      (static_cast<T>(1.0) - (*beta1_power_));
+  const T epsilon = (*epsilon_);
+  const T beta1 = (*beta1_);
+  const T one_minus_beta1 = static_cast<T>(1.0) - (beta1);
+  const T one_minus_beta2 = static_cast<T>(1.0) - (*beta2_);
+
+  // The elements a thread visits increase, and so do their variables.
+  int var_index = 0;
+  for (int64 i : GpuGridRangeX(num_elements)) {
+    var_index = FindVariable(offsets, var_index, num_vars, i);
+    const int64 j = i - offsets[var_index];
+    T* var = vars[var_index];
+    T* m = ms[var_index];
+    T* v = vs[var_index];
+    auto m_i = m[j];
+    auto g_i = grads[var_index][j];
+    auto v_i = v[j];
+
+    // Avoid += and -= due to std::complex<T> issues on device for MSVC.
+    m_i = m_i + one_minus_beta1 * (g_i - m_i);
+    v_i = v_i + one_minus_beta2 * (g_i * g_i - v_i);
+    if (use_nesterov) {
+      var[j] = var[j] - mul_factor * (m_i * beta1 + one_minus_beta1 * g_i) /
+                            (epsilon + Eigen::numext::sqrt(v_i));
+    } else {
+      var[j] = var[j] - mul_factor * m_i / (epsilon + Eigen::numext::sqrt(v_i));
+    }
+
+    m[j] = m_i;
+    v[j] = v_i;
+  }
+}
+
+// Returns the launch config of the Multi kernels, whose `num_elements` may not
+// fit an int: their threads loop over the elements.
+static GpuLaunchConfig GetMultiLaunchConfig(int64 num_elements,
+                                            const GPUDevice& d) {
+  return GetGpuLaunchConfig(
+      static_cast<int>(std::min<int64>(num_elements,
+                                       std::numeric_limits<int32>::max())),
+      d);
+}
+
 template <typename T, typename Tindex>
 __global__ __launch_bounds__(1024) void SparseApplyKerasMomentumKernel(
     T* var, T* accum, const T* lr, const T* grad, const Tindex* indices,
@@ -753,6 +868,25 @@ struct ApplyMomentum<GPUDevice, T> {
   }
 };
 
+template <typename T>
+struct ApplyMomentumMulti<GPUDevice, T> {
+  void operator()(const GPUDevice& d, const GpuDeviceArrayStruct<T*>& var,
+                  const GpuDeviceArrayStruct<T*>& accum,
+                  typename TTypes<T>::ConstScalar lr,
+                  const GpuDeviceArrayStruct<const T*>& grad,
+                  const GpuDeviceArrayStruct<int64>& offsets,
+                  int64 num_elements, typename TTypes<T>::ConstScalar momentum,
+                  bool use_nesterov) {
+    if (num_elements == 0) return;
+    GpuLaunchConfig config = GetMultiLaunchConfig(num_elements, d);
+    TF_CHECK_OK(GpuLaunchKernel(ApplyMomentumMultiKernel<T>,
+                                config.block_count, config.thread_per_block, 0,
+                                d.stream(), var, accum, lr.data(), grad,
+                                offsets, num_elements, momentum.data(),
+                                use_nesterov));
+  }
+};
+
 template <typename T>
 struct ApplyKerasMomentum<GPUDevice, T> {
   void operator()(const GPUDevice& d, typename TTypes<T>::Flat var,
@@ -887,6 +1021,30 @@ struct ApplyAdam<GPUDevice, T> {
   }
 };
 
+template <typename T>
+struct ApplyAdamMulti<GPUDevice, T> {
+  void operator()(const GPUDevice& d, const GpuDeviceArrayStruct<T*>& var,
+                  const GpuDeviceArrayStruct<T*>& m,
+                  const GpuDeviceArrayStruct<T*>& v,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon,
+                  const GpuDeviceArrayStruct<const T*>& grad,
+                  const GpuDeviceArrayStruct<int64>& offsets,
+                  int64 num_elements, bool use_nesterov) {
+    if (num_elements == 0) return;
+    GpuLaunchConfig config = GetMultiLaunchConfig(num_elements, d);
+    TF_CHECK_OK(GpuLaunchKernel(
+        ApplyAdamMultiKernel<T>, config.block_count, config.thread_per_block, 0,
+        d.stream(), var, m, v, beta1_power.data(), beta2_power.data(),
+        lr.data(), beta1.data(), beta2.data(), epsilon.data(), grad, offsets,
+        num_elements, use_nesterov));
+  }
+};
+
 template <typename T>
 struct ApplyAdamWithAmsgrad<GPUDevice, T> {
   void operator()(const GPUDevice& d, typename TTypes<T>::Flat var,
@@ -1160,6 +1318,12 @@ template struct functor::ApplyMomentum<GPUDevice, double>;
 template struct functor::ApplyMomentum<GPUDevice, complex64>;
 template struct functor::ApplyMomentum<GPUDevice, complex128>;
 
+template struct functor::ApplyMomentumMulti<GPUDevice, Eigen::half>;
+template struct functor::ApplyMomentumMulti<GPUDevice, float>;
+template struct functor::ApplyMomentumMulti<GPUDevice, double>;
+template struct functor::ApplyMomentumMulti<GPUDevice, complex64>;
+template struct functor::ApplyMomentumMulti<GPUDevice, complex128>;
+
 template struct functor::ApplyKerasMomentum<GPUDevice, Eigen::half>;
 template struct functor::ApplyKerasMomentum<GPUDevice, float>;
 template struct functor::ApplyKerasMomentum<GPUDevice, double>;
@@ -1196,6 +1360,12 @@ template struct functor::ApplyAdam<GPUDevice, double>;
 template struct functor::ApplyAdam<GPUDevice, complex64>;
 template struct functor::ApplyAdam<GPUDevice, complex128>;
 
+template struct functor::ApplyAdamMulti<GPUDevice, Eigen::half>;
+template struct functor::ApplyAdamMulti<GPUDevice, float>;
+template struct functor::ApplyAdamMulti<GPUDevice, double>;
+template struct functor::ApplyAdamMulti<GPUDevice, complex64>;
+template struct functor::ApplyAdamMulti<GPUDevice, complex128>;
+
 template struct functor::ApplyAdamWithAmsgrad<GPUDevice, Eigen::half>;
 template struct functor::ApplyAdamWithAmsgrad<GPUDevice, float>;
 template struct functor::ApplyAdamWithAmsgrad<GPUDevice, double>;
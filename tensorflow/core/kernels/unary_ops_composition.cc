@@ -229,10 +229,14 @@ struct UnaryOpsCompositionSupport<float> : UnaryOpsCompositionBase<float> {
     REGISTER_COMPUTE_FN(Ceil);
     REGISTER_COMPUTE_FN(Cos);
     REGISTER_COMPUTE_FN(Cosh);
+    REGISTER_COMPUTE_FN(Digamma);
+    REGISTER_COMPUTE_FN(Erf);
+    REGISTER_COMPUTE_FN(Erfc);
     REGISTER_COMPUTE_FN(Expm1);
     REGISTER_COMPUTE_FN(Exp);
     REGISTER_COMPUTE_FN(Floor);
     REGISTER_COMPUTE_FN(Inv);
+    REGISTER_COMPUTE_FN(Lgamma);
     REGISTER_COMPUTE_FN(Log);
     REGISTER_COMPUTE_FN(Log1p);
     REGISTER_COMPUTE_FN(Neg);
@@ -241,6 +245,7 @@ struct UnaryOpsCompositionSupport<float> : UnaryOpsCompositionBase<float> {
     REGISTER_COMPUTE_FN(Round);
     REGISTER_COMPUTE_FN(Rsqrt);
     REGISTER_COMPUTE_FN(Sigmoid);
+    REGISTER_COMPUTE_FN(Sign);
     REGISTER_COMPUTE_FN(Sin);
     REGISTER_COMPUTE_FN(Sinh);
     REGISTER_COMPUTE_FN(Sqrt);
@@ -268,10 +273,14 @@ struct UnaryOpsCompositionSupport<float> : UnaryOpsCompositionBase<float> {
   REGISTER_COMPUTE_FN_HELPER(Ceil,       functor::ceil<T>);
   REGISTER_COMPUTE_FN_HELPER(Cos,        functor::cos<T>);
   REGISTER_COMPUTE_FN_HELPER(Cosh,       functor::cosh<T>);
+  REGISTER_COMPUTE_FN_HELPER(Digamma,    functor::digamma<T>);
+  REGISTER_COMPUTE_FN_HELPER(Erf,        functor::erf<T>);
+  REGISTER_COMPUTE_FN_HELPER(Erfc,       functor::erfc<T>);
   REGISTER_COMPUTE_FN_HELPER(Expm1,      functor::expm1<T>);
   REGISTER_COMPUTE_FN_HELPER(Exp,        functor::exp<T>);
   REGISTER_COMPUTE_FN_HELPER(Floor,      functor::floor<T>);
   REGISTER_COMPUTE_FN_HELPER(Inv,        functor::inverse<T>);
+  REGISTER_COMPUTE_FN_HELPER(Lgamma,     functor::lgamma<T>);
   REGISTER_COMPUTE_FN_HELPER(Log,        functor::log<T>);
   REGISTER_COMPUTE_FN_HELPER(Log1p,      functor::log1p<T>);
   REGISTER_COMPUTE_FN_HELPER(Neg,        functor::neg<T>);
@@ -280,6 +289,7 @@ struct UnaryOpsCompositionSupport<float> : UnaryOpsCompositionBase<float> {
   REGISTER_COMPUTE_FN_HELPER(Round,      functor::round<T>);
   REGISTER_COMPUTE_FN_HELPER(Rsqrt,      functor::rsqrt<T>);
   REGISTER_COMPUTE_FN_HELPER(Sigmoid,    functor::sigmoid<T>);
+  REGISTER_COMPUTE_FN_HELPER(Sign,       functor::sign<T>);
   REGISTER_COMPUTE_FN_HELPER(Sin,        functor::sin<T>);
   REGISTER_COMPUTE_FN_HELPER(Sinh,       functor::sinh<T>);
   REGISTER_COMPUTE_FN_HELPER(Sqrt,       functor::sqrt<T>);
@@ -298,6 +308,8 @@ struct UnaryOpsCompositionSupport<Eigen::half>
     REGISTER_COMPUTE_FN(Abs);
     REGISTER_COMPUTE_FN(Ceil);
     REGISTER_COMPUTE_FN(Cos);
+    REGISTER_COMPUTE_FN(Erf);
+    REGISTER_COMPUTE_FN(Erfc);
     REGISTER_COMPUTE_FN(Expm1);
     REGISTER_COMPUTE_FN(Exp);
     REGISTER_COMPUTE_FN(Floor);
@@ -309,6 +321,7 @@ struct UnaryOpsCompositionSupport<Eigen::half>
     REGISTER_COMPUTE_FN(Round);
     REGISTER_COMPUTE_FN(Rsqrt);
     REGISTER_COMPUTE_FN(Sigmoid);
+    REGISTER_COMPUTE_FN(Sign);
     REGISTER_COMPUTE_FN(Sin);
     REGISTER_COMPUTE_FN(Sqrt);
     REGISTER_COMPUTE_FN(Square);
@@ -326,6 +339,8 @@ struct UnaryOpsCompositionSupport<Eigen::half>
   REGISTER_COMPUTE_FN_HELPER(Abs,        functor::abs<T>);
   REGISTER_COMPUTE_FN_HELPER(Ceil,       functor::ceil<T>);
   REGISTER_COMPUTE_FN_HELPER(Cos,        functor::cos<T>);
+  REGISTER_COMPUTE_FN_HELPER(Erf,        functor::erf<T>);
+  REGISTER_COMPUTE_FN_HELPER(Erfc,       functor::erfc<T>);
   REGISTER_COMPUTE_FN_HELPER(Expm1,      functor::expm1<T>);
   REGISTER_COMPUTE_FN_HELPER(Exp,        functor::exp<T>);
   REGISTER_COMPUTE_FN_HELPER(Floor,      functor::floor<T>);
@@ -337,6 +352,7 @@ struct UnaryOpsCompositionSupport<Eigen::half>
   REGISTER_COMPUTE_FN_HELPER(Round,      functor::round<T>);
   REGISTER_COMPUTE_FN_HELPER(Rsqrt,      functor::rsqrt<T>);
   REGISTER_COMPUTE_FN_HELPER(Sigmoid,    functor::sigmoid<T>);
+  REGISTER_COMPUTE_FN_HELPER(Sign,       functor::sign<T>);
   REGISTER_COMPUTE_FN_HELPER(Sin,        functor::sin<T>);
   REGISTER_COMPUTE_FN_HELPER(Sqrt,       functor::sqrt<T>);
   REGISTER_COMPUTE_FN_HELPER(Square,     functor::square<T>);
@@ -359,10 +375,14 @@ struct UnaryOpsCompositionSupport<double> : UnaryOpsCompositionBase<double> {
     REGISTER_COMPUTE_FN(Ceil);
     REGISTER_COMPUTE_FN(Cos);
     REGISTER_COMPUTE_FN(Cosh);
+    REGISTER_COMPUTE_FN(Digamma);
+    REGISTER_COMPUTE_FN(Erf);
+    REGISTER_COMPUTE_FN(Erfc);
     REGISTER_COMPUTE_FN(Expm1);
     REGISTER_COMPUTE_FN(Exp);
     REGISTER_COMPUTE_FN(Floor);
     REGISTER_COMPUTE_FN(Inv);
+    REGISTER_COMPUTE_FN(Lgamma);
     REGISTER_COMPUTE_FN(Log);
     REGISTER_COMPUTE_FN(Log1p);
     REGISTER_COMPUTE_FN(Neg);
@@ -371,6 +391,7 @@ struct UnaryOpsCompositionSupport<double> : UnaryOpsCompositionBase<double> {
     REGISTER_COMPUTE_FN(Round);
     REGISTER_COMPUTE_FN(Rsqrt);
     REGISTER_COMPUTE_FN(Sigmoid);
+    REGISTER_COMPUTE_FN(Sign);
     REGISTER_COMPUTE_FN(Sin);
     REGISTER_COMPUTE_FN(Sinh);
     REGISTER_COMPUTE_FN(Sqrt);
@@ -397,10 +418,14 @@ struct UnaryOpsCompositionSupport<double> : UnaryOpsCompositionBase<double> {
   REGISTER_COMPUTE_FN_HELPER(Ceil,       functor::ceil<T>);
   REGISTER_COMPUTE_FN_HELPER(Cos,        functor::cos<T>);
   REGISTER_COMPUTE_FN_HELPER(Cosh,       functor::cosh<T>);
+  REGISTER_COMPUTE_FN_HELPER(Digamma,    functor::digamma<T>);
+  REGISTER_COMPUTE_FN_HELPER(Erf,        functor::erf<T>);
+  REGISTER_COMPUTE_FN_HELPER(Erfc,       functor::erfc<T>);
   REGISTER_COMPUTE_FN_HELPER(Expm1,      functor::expm1<T>);
   REGISTER_COMPUTE_FN_HELPER(Exp,        functor::exp<T>);
   REGISTER_COMPUTE_FN_HELPER(Floor,      functor::floor<T>);
   REGISTER_COMPUTE_FN_HELPER(Inv,        functor::inverse<T>);
+  REGISTER_COMPUTE_FN_HELPER(Lgamma,     functor::lgamma<T>);
   REGISTER_COMPUTE_FN_HELPER(Log,        functor::log<T>);
   REGISTER_COMPUTE_FN_HELPER(Log1p,      functor::log1p<T>);
   REGISTER_COMPUTE_FN_HELPER(Neg,        functor::neg<T>);
@@ -409,6 +434,7 @@ struct UnaryOpsCompositionSupport<double> : UnaryOpsCompositionBase<double> {
   REGISTER_COMPUTE_FN_HELPER(Round,      functor::round<T>);
   REGISTER_COMPUTE_FN_HELPER(Rsqrt,      functor::rsqrt<T>);
   REGISTER_COMPUTE_FN_HELPER(Sigmoid,    functor::sigmoid<T>);
+  REGISTER_COMPUTE_FN_HELPER(Sign,       functor::sign<T>);
   REGISTER_COMPUTE_FN_HELPER(Sin,        functor::sin<T>);
   REGISTER_COMPUTE_FN_HELPER(Sinh,       functor::sinh<T>);
   REGISTER_COMPUTE_FN_HELPER(Sqrt,       functor::sqrt<T>);
@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,12 +28,20 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+// The number of elements from which unique is run over single elements on
+// several threads.
+constexpr int64 kMinParallelSize = 1 << 16;
+// The maximum number of hash partitions of the input of the parallel
+// implementation.
+constexpr int kMaxPartitions = 64;
+
 // `UniqueOpHashMap` defines the map type that is used when elements of type
 // `T` are to be uniquified. By default, we use `absl::flat_hash_map<T, TIndex>`
 // as the map type. Subsequent specializations are provided for
@@ -150,6 +160,14 @@ class UniqueOp : public OpKernel {
       auto Tin = input.flat<T>();
       const int64 N = static_cast<int64>(Tin.size());
 
+      const DeviceBase::CpuWorkerThreads& worker_threads =
+          *context->device()->tensorflow_cpu_worker_threads();
+      if (N >= kMinParallelSize && worker_threads.num_threads > 1) {
+        OP_REQUIRES_OK(context, ComputeInParallel(context, input, axis,
+                                                  idx_vec, &uniq_size));
+        return ComputeCounts(context, idx_vec, uniq_size);
+      }
+
       typename UniqueOpHashMap<T, TIndex>::map_type uniq;
       uniq.reserve(2 * N);
       for (Eigen::Index i = 0, j = 0; i < N; ++i) {
@@ -225,6 +243,14 @@ class UniqueOp : public OpKernel {
       }
     }
 
+    ComputeCounts(context, idx_vec, uniq_size);
+  }
+
+ private:
+  // Outputs the number of occurrences of each unique element for the
+  // UniqueWithCounts ops.
+  void ComputeCounts(OpKernelContext* context,
+                     typename TTypes<TIndex>::Vec idx_vec, int64 uniq_size) {
     if (num_outputs() > 2) {
       Tensor* output = nullptr;
       OP_REQUIRES_OK(context, context->allocate_output(
@@ -237,6 +263,140 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+  // Computes the same outputs as the sequential implementation over single
+  // elements using the intra-op thread pool:
+  //
+  // 1. The positions of the elements are bucketed by the hash of the elements
+  //    into partitions, in increasing order within each partition.
+  // 2. The partitions are uniquified independently, into maps that are a
+  //    fraction of the size of a single one.
+  // 3. A prefix sum over the positions of the first occurrences of the unique
+  //    elements gives their indices in the output, which are in the order of
+  //    their first occurrence as in the sequential implementation.
+  //
+  // The input is split into as many contiguous ranges as there are
+  // partitions, for the steps that scan the whole input.
+  Status ComputeInParallel(OpKernelContext* context, const Tensor& input,
+                           int64 axis, typename TTypes<TIndex>::Vec idx_vec,
+                           int64* uniq_size) {
+    using MapType = typename UniqueOpHashMap<T, TIndex>::map_type;
+    using KeyType = typename MapType::key_type;
+    // The input has fewer than 2^31 elements, so positions fit in an int32.
+    const auto Tin = input.flat<T>();
+    const int64 N = static_cast<int64>(Tin.size());
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int num_partitions =
+        std::min(worker_threads.num_threads, kMaxPartitions);
+    auto range_begin = [N, num_partitions](int64 range) {
+      return range * N / num_partitions;
+    };
+    auto parallel_for = [&worker_threads, num_partitions, N](
+                            const std::function<void(int64)>& fn) {
+      Shard(worker_threads.num_threads, worker_threads.workers,
+            num_partitions, /*cost_per_unit=*/100 * N / num_partitions,
+            [&fn](int64 begin, int64 end) {
+              for (int64 i = begin; i < end; ++i) fn(i);
+            });
+    };
+    // The maps hash the keys too, so the partition is taken from the high bits
+    // of the remixed hash to leave the maps with well distributed hashes.
+    const typename MapType::hasher hasher{};
+    auto partition_of = [&hasher, num_partitions](const KeyType& key) {
+      const uint64 h =
+          static_cast<uint64>(hasher(key)) * uint64{0x9E3779B97F4A7C15};
+      return static_cast<int>(((h >> 32) * num_partitions) >> 32);
+    };
+
+    // Bucket the positions, counting the elements of each range in each
+    // partition first to write the positions of all ranges concurrently.
+    std::vector<uint8> partitions(N);
+    std::vector<int64> range_offsets(num_partitions * num_partitions, 0);
+    parallel_for([&](int64 range) {
+      int64* counts = &range_offsets[range * num_partitions];
+      for (int64 i = range_begin(range); i < range_begin(range + 1); ++i) {
+        const int partition = partition_of(KeyType(Tin(i)));
+        partitions[i] = partition;
+        ++counts[partition];
+      }
+    });
+    std::vector<std::vector<int32>> positions(num_partitions);
+    for (int partition = 0; partition < num_partitions; ++partition) {
+      int64 size = 0;
+      for (int range = 0; range < num_partitions; ++range) {
+        int64& offset = range_offsets[range * num_partitions + partition];
+        const int64 count = offset;
+        offset = size;
+        size += count;
+      }
+      positions[partition].resize(size);
+    }
+    parallel_for([&](int64 range) {
+      int64* offsets = &range_offsets[range * num_partitions];
+      for (int64 i = range_begin(range); i < range_begin(range + 1); ++i) {
+        positions[partitions[i]][offsets[partitions[i]]++] = i;
+      }
+    });
+
+    // Uniquify each partition, first into indices local to the partition.
+    // `ranks` flags the first occurrences, then holds their output indices.
+    std::vector<int32> ranks(N, 0);
+    std::vector<std::vector<int32>> first_positions(num_partitions);
+    parallel_for([&](int64 partition) {
+      MapType uniq;
+      uniq.reserve(2 * positions[partition].size());
+      TIndex j = 0;
+      for (const int32 i : positions[partition]) {
+        auto it = uniq.emplace(Tin(i), j);
+        idx_vec(i) = it.first->second;
+        if (it.second) {
+          ++j;
+          first_positions[partition].push_back(i);
+          ranks[i] = 1;
+        }
+      }
+    });
+
+    std::vector<int32> range_ranks(num_partitions + 1, 0);
+    parallel_for([&](int64 range) {
+      int32 count = 0;
+      for (int64 i = range_begin(range); i < range_begin(range + 1); ++i) {
+        count += ranks[i];
+      }
+      range_ranks[range + 1] = count;
+    });
+    for (int range = 0; range < num_partitions; ++range) {
+      range_ranks[range + 1] += range_ranks[range];
+    }
+    parallel_for([&](int64 range) {
+      int32 rank = range_ranks[range];
+      for (int64 i = range_begin(range); i < range_begin(range + 1); ++i) {
+        if (ranks[i]) ranks[i] = rank++;
+      }
+    });
+
+    *uniq_size = range_ranks[num_partitions];
+    TensorShape output_shape(input.shape());
+    output_shape.set_dim(axis, *uniq_size);
+    Tensor* output = nullptr;
+    TF_RETURN_IF_ERROR(context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+
+    // Map the local indices to the output ones.
+    parallel_for([&](int64 partition) {
+      const std::vector<int32>& firsts = first_positions[partition];
+      std::vector<TIndex> output_indices(firsts.size());
+      for (size_t j = 0; j < firsts.size(); ++j) {
+        output_indices[j] = ranks[firsts[j]];
+        Tout(output_indices[j]) = Tin(firsts[j]);
+      }
+      for (const int32 i : positions[partition]) {
+        idx_vec(i) = output_indices[idx_vec(i)];
+      }
+    });
+    return Status::OK();
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                    \
@@ -15,10 +15,15 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -37,6 +42,49 @@ namespace {
 
 const int kMaxStrLen = 40;
 
+class UniqueOpTest : public OpsTestBase {};
+
+// Inputs this large are uniquified on several threads, which must give the
+// outputs of the sequential implementation.
+TEST_F(UniqueOpTest, LargeInputKeepsOrderOfFirstOccurrence) {
+  TF_ASSERT_OK(NodeDefBuilder("unique", "UniqueWithCounts")
+                   .Input(FakeInput(DT_INT64))
+                   .Attr("out_idx", DT_INT32)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  const int dim = 1 << 18;
+  std::vector<int64> values(dim);
+  for (int i = 0; i < dim; ++i) {
+    values[i] = (std::rand() % 50000) * 1000003;
+  }
+  std::unordered_map<int64, int32> expected_idx_of;
+  std::vector<int64> expected_y;
+  std::vector<int32> expected_idx;
+  std::vector<int32> expected_count;
+  for (int64 value : values) {
+    auto it = expected_idx_of.emplace(value, expected_y.size());
+    if (it.second) {
+      expected_y.push_back(value);
+      expected_count.push_back(0);
+    }
+    expected_idx.push_back(it.first->second);
+    ++expected_count[it.first->second];
+  }
+  AddInputFromArray<int64>(TensorShape({dim}), values);
+  TF_ASSERT_OK(RunOpKernel());
+
+  const int num_unique = expected_y.size();
+  test::ExpectTensorEqual<int64>(
+      *GetOutput(0),
+      test::AsTensor<int64>(expected_y, TensorShape({num_unique})));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(1), test::AsTensor<int32>(expected_idx, TensorShape({dim})));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(2),
+      test::AsTensor<int32>(expected_count, TensorShape({num_unique})));
+}
+
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_INT32);
@@ -149,6 +197,31 @@ void BM_Unique_STRING(::testing::benchmark::State& state) {
                           sizeof(tstring));
 }
 
+// Runs on the intra-op thread pool, which the large inputs are uniquified on.
+void BM_Unique_INT64_MultiThreaded(::testing::benchmark::State& state) {
+  const int dim = state.range(0);
+  const int max_int = state.range(1);
+
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor input(DT_INT64, TensorShape({dim}));
+  auto input_flat = input.flat<int64>();
+  for (int i = 0; i < dim; ++i) {
+    input_flat(i) = std::rand() % max_int;
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Unique")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("T", DT_INT64)
+                  .Finalize(g, &node));
+  FixupSourceAndSinkEdges(g);
+
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetBytesProcessed(static_cast<int64>(state.iterations()) * dim *
+                          sizeof(int64));
+}
+
 BENCHMARK(BM_Unique_INT32)
     ->UseRealTime()
     ->ArgPair(32, 1024 * 1024)
@@ -193,6 +266,15 @@ BENCHMARK(BM_Unique_INT32_Repeat)
     ->ArgPair(64 * 1024, 64 * 1024 * 1024)
     ->ArgPair(1024 * 1024, 64 * 1024 * 1024);
 
+BENCHMARK(BM_Unique_INT64_MultiThreaded)
+    ->UseRealTime()
+    ->ArgPair(64 * 1024, 1024 * 1024)
+    ->ArgPair(1024 * 1024, 1024 * 1024)
+    ->ArgPair(10 * 1024 * 1024, 1024 * 1024)
+    ->ArgPair(64 * 1024, 64 * 1024 * 1024)
+    ->ArgPair(1024 * 1024, 64 * 1024 * 1024)
+    ->ArgPair(10 * 1024 * 1024, 64 * 1024 * 1024);
+
 BENCHMARK(BM_Unique_STRING)
     ->UseRealTime()
     ->Arg(32)
@@ -0,0 +1,149 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_offset_index.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+constexpr uint64 kMagic = 0x7466726f66667831ULL;  // "tfroffx1"
+constexpr size_t kFixedHeaderSize = 4 * sizeof(uint64);
+constexpr char kFileSuffix[] = ".offsets";
+
+}  // namespace
+
+RecordOffsetIndex::RecordOffsetIndex(int64 stride)
+    : stride_(std::max<int64>(stride, 1)) {}
+
+void RecordOffsetIndex::AddRecord(uint64 offset) {
+  if (num_records_ % stride_ == 0) {
+    offsets_.push_back(offset);
+  }
+  ++num_records_;
+}
+
+Status RecordOffsetIndex::Lookup(int64 record, uint64* offset,
+                                 int64* num_to_skip) const {
+  if (record < 0 || record > num_records_) {
+    return errors::OutOfRange("Record ", record, " is outside [0, ",
+                              num_records_, "]");
+  }
+  if (offsets_.empty()) {
+    *offset = 0;
+    *num_to_skip = 0;
+    return Status::OK();
+  }
+  const int64 block = std::min<int64>(record / stride_, offsets_.size() - 1);
+  *offset = offsets_[block];
+  *num_to_skip = record - block * stride_;
+  return Status::OK();
+}
+
+string RecordOffsetIndex::Encode() const {
+  string data;
+  data.reserve(kFixedHeaderSize + offsets_.size() * 2 + sizeof(uint32));
+  core::PutFixed64(&data, kMagic);
+  core::PutFixed64(&data, stride_);
+  core::PutFixed64(&data, num_records_);
+  core::PutFixed64(&data, offsets_.size());
+  uint64 previous = 0;
+  for (uint64 offset : offsets_) {
+    core::PutVarint64(&data, offset - previous);
+    previous = offset;
+  }
+  core::PutFixed32(&data, crc32c::Mask(crc32c::Value(data.data(),
+                                                     data.size())));
+  return data;
+}
+
+Status RecordOffsetIndex::Decode(StringPiece data) {
+  if (data.size() < kFixedHeaderSize + sizeof(uint32)) {
+    return errors::DataLoss("Truncated record offset index of ", data.size(),
+                            " bytes");
+  }
+  const size_t crc_offset = data.size() - sizeof(uint32);
+  const uint32 expected_crc = crc32c::Unmask(
+      core::DecodeFixed32(data.data() + crc_offset));
+  if (crc32c::Value(data.data(), crc_offset) != expected_crc) {
+    return errors::DataLoss("Corrupted record offset index");
+  }
+  if (core::DecodeFixed64(data.data()) != kMagic) {
+    return errors::DataLoss("Not a record offset index");
+  }
+  const int64 stride = core::DecodeFixed64(data.data() + sizeof(uint64));
+  const int64 num_records =
+      core::DecodeFixed64(data.data() + 2 * sizeof(uint64));
+  const uint64 num_offsets =
+      core::DecodeFixed64(data.data() + 3 * sizeof(uint64));
+  if (stride <= 0 || num_records < 0 ||
+      num_offsets != static_cast<uint64>((num_records + stride - 1) / stride)) {
+    return errors::DataLoss("Inconsistent record offset index: stride ",
+                            stride, ", ", num_records, " records and ",
+                            num_offsets, " offsets");
+  }
+
+  StringPiece input(data.data() + kFixedHeaderSize,
+                    crc_offset - kFixedHeaderSize);
+  std::vector<uint64> offsets;
+  offsets.reserve(num_offsets);
+  uint64 offset = 0;
+  for (uint64 i = 0; i < num_offsets; ++i) {
+    uint64 delta;
+    if (!core::GetVarint64(&input, &delta)) {
+      return errors::DataLoss("Truncated record offset index at offset ", i);
+    }
+    offset += delta;
+    offsets.push_back(offset);
+  }
+  if (!input.empty()) {
+    return errors::DataLoss("Record offset index has ", input.size(),
+                            " trailing bytes");
+  }
+  stride_ = stride;
+  num_records_ = num_records;
+  offsets_ = std::move(offsets);
+  return Status::OK();
+}
+
+Status RecordOffsetIndex::WriteToFile(Env* env, const string& filename) const {
+  return WriteStringToFile(env, filename, Encode());
+}
+
+Status RecordOffsetIndex::ReadFromFile(Env* env, const string& filename) {
+  string data;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, filename, &data));
+  Status s = Decode(data);
+  if (!s.ok()) {
+    errors::AppendToMessage(&s, " in ", filename);
+  }
+  return s;
+}
+
+/* static */ string RecordOffsetIndex::FilenameFor(
+    const string& record_filename) {
+  return strings::StrCat(record_filename, kFileSuffix);
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,86 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_RECORD_OFFSET_INDEX_H_
+#define TENSORFLOW_CORE_LIB_IO_RECORD_OFFSET_INDEX_H_
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class Env;
+
+namespace io {
+
+// The byte offsets of every `stride`-th record of an uncompressed TFRecord
+// file, which lets readers seek to any record after skipping at most
+// `stride - 1` records.
+//
+// The records between two indexed offsets form a "block". Blocks can be read
+// independently of each other, so they are also the unit in which a file is
+// split between parallel readers.
+//
+// The index is stored next to the record file, in a file named
+// `FilenameFor(record_filename)`. Its format is:
+//  fixed64   magic
+//  fixed64   stride
+//  fixed64   number of records
+//  fixed64   number of offsets
+//  varint64  offset[0] - 0, offset[1] - offset[0], ...
+//  fixed32   masked crc of the preceding bytes
+class RecordOffsetIndex {
+ public:
+  explicit RecordOffsetIndex(int64 stride = 1);
+
+  // Adds the record that starts at `offset`. Records must be added in order.
+  void AddRecord(uint64 offset);
+
+  int64 stride() const { return stride_; }
+  int64 num_records() const { return num_records_; }
+  int64 num_blocks() const { return offsets_.size(); }
+
+  // The offset of the first record of block `block`.
+  uint64 block_offset(int64 block) const { return offsets_[block]; }
+
+  // Sets `*offset` to the offset of the closest indexed record at or before
+  // `record`, and `*num_to_skip` to the number of records to skip from there
+  // to reach `record`. `record` may be `num_records()`, in which case the
+  // result points at the last block. Returns OUT_OF_RANGE for other records
+  // outside the file.
+  Status Lookup(int64 record, uint64* offset, int64* num_to_skip) const;
+
+  string Encode() const;
+  Status Decode(StringPiece data);
+
+  Status WriteToFile(Env* env, const string& filename) const;
+  Status ReadFromFile(Env* env, const string& filename);
+
+  // Returns the name of the index of the records in `record_filename`.
+  static string FilenameFor(const string& record_filename);
+
+ private:
+  int64 stride_;
+  int64 num_records_ = 0;
+  std::vector<uint64> offsets_;
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_RECORD_OFFSET_INDEX_H_
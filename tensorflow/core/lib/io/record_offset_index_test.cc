@@ -0,0 +1,135 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_offset_index.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+// Writes `num_records` records named "record_<i>" of increasing length to
+// `fname` and returns the index built by the writer.
+RecordOffsetIndex WriteRecords(const string& fname, int num_records,
+                               const RecordWriterOptions& options) {
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(env->NewWritableFile(fname, &file));
+  RecordWriter writer(file.get(), options);
+  for (int i = 0; i < num_records; ++i) {
+    TF_CHECK_OK(writer.WriteRecord(
+        strings::StrCat("record_", i, string(i, 'x'))));
+  }
+  TF_CHECK_OK(writer.Close());
+  TF_CHECK_OK(file->Close());
+  CHECK(writer.offset_index() != nullptr);
+  return *writer.offset_index();
+}
+
+TEST(RecordOffsetIndexTest, LooksUpRecords) {
+  RecordOffsetIndex index(/*stride=*/3);
+  for (uint64 offset = 0; offset < 70; offset += 10) {
+    index.AddRecord(offset);
+  }
+  EXPECT_EQ(7, index.num_records());
+  EXPECT_EQ(3, index.num_blocks());
+  EXPECT_EQ(30, index.block_offset(1));
+
+  uint64 offset;
+  int64 num_to_skip;
+  TF_ASSERT_OK(index.Lookup(5, &offset, &num_to_skip));
+  EXPECT_EQ(30, offset);
+  EXPECT_EQ(2, num_to_skip);
+  TF_ASSERT_OK(index.Lookup(7, &offset, &num_to_skip));
+  EXPECT_EQ(60, offset);
+  EXPECT_EQ(1, num_to_skip);
+  EXPECT_TRUE(errors::IsOutOfRange(index.Lookup(8, &offset, &num_to_skip)));
+  EXPECT_TRUE(errors::IsOutOfRange(index.Lookup(-1, &offset, &num_to_skip)));
+}
+
+TEST(RecordOffsetIndexTest, EncodesAndDecodes) {
+  RecordOffsetIndex index(/*stride=*/2);
+  const std::vector<uint64> offsets = {0, 17, 1000, 1 << 20, 1ULL << 40};
+  for (uint64 offset : offsets) {
+    index.AddRecord(offset);
+  }
+  const string encoded = index.Encode();
+
+  RecordOffsetIndex decoded;
+  TF_ASSERT_OK(decoded.Decode(encoded));
+  EXPECT_EQ(2, decoded.stride());
+  EXPECT_EQ(5, decoded.num_records());
+  ASSERT_EQ(3, decoded.num_blocks());
+  EXPECT_EQ(0, decoded.block_offset(0));
+  EXPECT_EQ(1000, decoded.block_offset(1));
+  EXPECT_EQ(1ULL << 40, decoded.block_offset(2));
+
+  string corrupted = encoded;
+  corrupted[corrupted.size() / 2] ^= 1;
+  EXPECT_TRUE(errors::IsDataLoss(decoded.Decode(corrupted)));
+  EXPECT_TRUE(errors::IsDataLoss(
+      decoded.Decode(StringPiece(encoded.data(), encoded.size() - 1))));
+}
+
+TEST(RecordOffsetIndexTest, WriterIndexesRecords) {
+  Env* env = Env::Default();
+  const string fname = testing::TmpDir() + "/record_offset_index_test";
+  RecordWriterOptions options;
+  options.offset_index_stride = 4;
+  const RecordOffsetIndex index = WriteRecords(fname, 10, options);
+  EXPECT_EQ(10, index.num_records());
+  EXPECT_EQ(3, index.num_blocks());
+
+  const string index_fname = RecordOffsetIndex::FilenameFor(fname);
+  TF_ASSERT_OK(index.WriteToFile(env, index_fname));
+  RecordOffsetIndex read_index;
+  TF_ASSERT_OK(read_index.ReadFromFile(env, index_fname));
+  EXPECT_EQ(index.Encode(), read_index.Encode());
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+  SequentialRecordReader reader(file.get());
+  tstring record;
+  // Seeks forward and backward.
+  for (int i : {9, 2, 4, 0, 7}) {
+    TF_ASSERT_OK(reader.SeekToRecord(read_index, i));
+    TF_ASSERT_OK(reader.ReadRecord(&record));
+    EXPECT_EQ(strings::StrCat("record_", i, string(i, 'x')), record);
+  }
+  TF_ASSERT_OK(reader.SeekToRecord(read_index, 10));
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+}
+
+TEST(RecordOffsetIndexTest, WriterDoesNotIndexByDefault) {
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(env->NewWritableFile(
+      testing::TmpDir() + "/record_offset_index_disabled_test", &file));
+  RecordWriter writer(file.get());
+  EXPECT_EQ(nullptr, writer.offset_index());
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
@@ -46,6 +46,8 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordReaderOptions::ZSTD_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -77,6 +79,10 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(
         new SnappyInputStream(input_stream_.release(),
                               options.snappy_options.output_buffer_size, true));
+  } else if (options.compression_type ==
+             RecordReaderOptions::ZSTD_COMPRESSION) {
+    input_stream_.reset(new ZstdInputStream(input_stream_.release(),
+                                            options.zstd_options, true));
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
   } else {
@@ -245,5 +251,17 @@ SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+Status SequentialRecordReader::SeekToRecord(const RecordOffsetIndex& index,
+                                            int64 record) {
+  uint64 offset;
+  int64 num_to_skip;
+  TF_RETURN_IF_ERROR(index.Lookup(record, &offset, &num_to_skip));
+  int num_skipped;
+  TF_RETURN_IF_ERROR(
+      underlying_.SkipRecords(&offset, num_to_skip, &num_skipped));
+  offset_ = offset;
+  return Status::OK();
+}
+
 }  // namespace io
 }  // namespace tensorflow
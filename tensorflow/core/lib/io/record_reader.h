@@ -19,11 +19,14 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/record_offset_index.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/core/lib/io/snappy/snappy_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/core/lib/io/zstd/zstd_inputstream.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
@@ -38,7 +41,8 @@ struct RecordReaderOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    ZSTD_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
@@ -54,6 +58,7 @@ struct RecordReaderOptions {
   // Options specific to compression.
   ZlibCompressionOptions zlib_options;
   SnappyCompressionOptions snappy_options;
+  ZstdCompressionOptions zstd_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -169,6 +174,12 @@ class SequentialRecordReader {
     return Status::OK();
   }
 
+  // Seek to the `record`-th record of the file, which `index` indexes, after
+  // skipping at most `index.stride() - 1` records. Unlike SeekOffset(), this
+  // can seek backward. Returns OUT_OF_RANGE if `record` is past the end of the
+  // file.
+  Status SeekToRecord(const RecordOffsetIndex& index, int64 record);
+
  private:
   RecordReader underlying_;
   uint64 offset_ = 0;
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/record_writer.h"
 
+#include "absl/memory/memory.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/compression.h"
@@ -30,6 +31,10 @@ bool IsZlibCompressed(const RecordWriterOptions& options) {
 bool IsSnappyCompressed(const RecordWriterOptions& options) {
   return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
 }
+
+bool IsZstdCompressed(const RecordWriterOptions& options) {
+  return options.compression_type == RecordWriterOptions::ZSTD_COMPRESSION;
+}
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
@@ -49,6 +54,8 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordWriterOptions::ZSTD_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -79,12 +86,26 @@ RecordWriter::RecordWriter(WritableFile* dest,
     dest_ =
         new SnappyOutputBuffer(dest, options.snappy_options.input_buffer_size,
                                options.snappy_options.output_buffer_size);
+  } else if (IsZstdCompressed(options)) {
+    ZstdOutputBuffer* zstd_output_buffer =
+        new ZstdOutputBuffer(dest, options.zstd_options);
+    Status s = zstd_output_buffer->Init();
+    if (!s.ok()) {
+      LOG(FATAL) << "Failed to initialize Zstd outputbuffer. Error: "
+                 << s.ToString();
+    }
+    dest_ = zstd_output_buffer;
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
   } else {
     LOG(FATAL) << "Unspecified compression type :" << options.compression_type;
   }
 #endif
+  if (options.offset_index_stride > 0 &&
+      options.compression_type == RecordWriterOptions::NONE) {
+    offset_index_ =
+        absl::make_unique<RecordOffsetIndex>(options.offset_index_stride);
+  }
 }
 
 RecordWriter::~RecordWriter() {
@@ -110,6 +131,7 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   char footer[kFooterSize];
   PopulateHeader(header, data.data(), data.size());
   PopulateFooter(footer, data.data(), data.size());
+  IndexRecord(data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
   return dest_->Append(StringPiece(footer, sizeof(footer)));
@@ -130,6 +152,7 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   char footer[kFooterSize];
   PopulateHeader(header, data);
   PopulateFooter(footer, data);
+  IndexRecord(data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
   return dest_->Append(StringPiece(footer, sizeof(footer)));
@@ -138,7 +161,8 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
 
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return Status::OK();
-  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
+  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_) ||
+      IsZstdCompressed(options_)) {
     Status s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
@@ -147,6 +171,12 @@ Status RecordWriter::Close() {
   return Status::OK();
 }
 
+void RecordWriter::IndexRecord(size_t n) {
+  if (offset_index_ == nullptr) return;
+  offset_index_->AddRecord(offset_);
+  offset_ += kHeaderSize + n + kFooterSize;
+}
+
 Status RecordWriter::Flush() {
   if (dest_ == nullptr) {
     return Status(::tensorflow::error::FAILED_PRECONDITION,
@@ -16,15 +16,20 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_RECORD_WRITER_H_
 #define TENSORFLOW_CORE_LIB_IO_RECORD_WRITER_H_
 
+#include <memory>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_offset_index.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/core/lib/io/snappy/snappy_outputbuffer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/core/lib/io/zstd/zstd_outputbuffer.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/macros.h"
@@ -41,17 +46,24 @@ struct RecordWriterOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    ZSTD_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
+  // If positive, the writer indexes the offset of every
+  // `offset_index_stride`-th record, see `RecordWriter::offset_index()`.
+  // Ignored for compressed files, whose offsets can't be seeked to.
+  int64 offset_index_stride = 0;
+
 #if !defined(IS_SLIM_BUILD)
   // Options specific to compression.
   tensorflow::io::ZlibCompressionOptions zlib_options;
   tensorflow::io::SnappyCompressionOptions snappy_options;
+  tensorflow::io::ZstdCompressionOptions zstd_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -94,6 +106,16 @@ class RecordWriter {
   // are invalid.
   Status Close();
 
+  // Returns the offsets of the records written so far, or nullptr if the
+  // writer doesn't index them. The caller usually writes the index next to
+  // the file once it is complete:
+  //
+  //   TF_RETURN_IF_ERROR(writer.Close());
+  //   TF_RETURN_IF_ERROR(file->Close());
+  //   TF_RETURN_IF_ERROR(writer.offset_index()->WriteToFile(
+  //       env, RecordOffsetIndex::FilenameFor(filename)));
+  const RecordOffsetIndex* offset_index() const { return offset_index_.get(); }
+
   // Utility method to populate TFRecord headers.  Populates record-header in
   // "header[0,kHeaderSize-1]".  The record-header is based on data[0, n-1].
   inline static void PopulateHeader(char* header, const char* data, size_t n);
@@ -109,8 +131,14 @@ class RecordWriter {
 #endif
 
  private:
+  // Adds the record of `n` bytes about to be written to the offset index.
+  void IndexRecord(size_t n);
+
   WritableFile* dest_;
   RecordWriterOptions options_;
+  std::unique_ptr<RecordOffsetIndex> offset_index_;
+  // The number of bytes written to `dest_`, when indexing offsets.
+  uint64 offset_ = 0;
 
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
@@ -0,0 +1,149 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/zstd/zstd_compression.h"
+
+#include <memory>
+
+#if defined(TF_USE_ZSTD)
+#include <zstd.h>
+#endif  // TF_USE_ZSTD
+
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace io {
+
+#if defined(TF_USE_ZSTD)
+
+bool IsZstdSupported() { return true; }
+
+Status ZstdCompress(StringPiece input, const ZstdCompressionOptions& options,
+                    std::string* output) {
+  std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx(ZSTD_createCCtx(),
+                                                           ZSTD_freeCCtx);
+  if (cctx == nullptr) {
+    return errors::ResourceExhausted("Failed to create zstd context");
+  }
+  size_t ret = ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_compressionLevel,
+                                      options.compression_level);
+  if (!ZSTD_isError(ret) && options.num_workers > 0) {
+    ret = ZSTD_CCtx_setParameter(cctx.get(), ZSTD_c_nbWorkers,
+                                 options.num_workers);
+  }
+  if (!ZSTD_isError(ret) && !options.dictionary.empty()) {
+    ret = ZSTD_CCtx_loadDictionary(cctx.get(), options.dictionary.data(),
+                                   options.dictionary.size());
+  }
+  if (ZSTD_isError(ret)) {
+    return errors::InvalidArgument("Failed to configure zstd compression: ",
+                                   ZSTD_getErrorName(ret));
+  }
+  output->resize(ZSTD_compressBound(input.size()));
+  ret = ZSTD_compress2(cctx.get(), &(*output)[0], output->size(), input.data(),
+                       input.size());
+  if (ZSTD_isError(ret)) {
+    return errors::Internal("ZSTD_compress2() failed: ",
+                            ZSTD_getErrorName(ret));
+  }
+  output->resize(ret);
+  return Status::OK();
+}
+
+Status ZstdUncompress(StringPiece input, const ZstdCompressionOptions& options,
+                      absl::Span<const absl::Span<char>> outputs) {
+  std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx(ZSTD_createDCtx(),
+                                                           ZSTD_freeDCtx);
+  if (dctx == nullptr) {
+    return errors::ResourceExhausted("Failed to create zstd context");
+  }
+  if (!options.dictionary.empty()) {
+    const size_t ret = ZSTD_DCtx_loadDictionary(
+        dctx.get(), options.dictionary.data(), options.dictionary.size());
+    if (ZSTD_isError(ret)) {
+      return errors::InvalidArgument("Failed to load zstd dictionary: ",
+                                     ZSTD_getErrorName(ret));
+    }
+  }
+  ZSTD_inBuffer in = {input.data(), input.size(), 0};
+  // Stream straight into the caller's buffers, which saves a copy over
+  // decompressing into one contiguous buffer first.
+  size_t ret = 1;  // Non-zero until the frame is fully decoded.
+  for (absl::Span<char> output : outputs) {
+    ZSTD_outBuffer out = {output.data(), output.size(), 0};
+    while (out.pos < out.size) {
+      const size_t in_pos = in.pos;
+      const size_t out_pos = out.pos;
+      ret = ZSTD_decompressStream(dctx.get(), &out, &in);
+      if (ZSTD_isError(ret)) {
+        return errors::DataLoss("ZSTD_decompressStream() failed: ",
+                                ZSTD_getErrorName(ret));
+      }
+      if (in.pos == in_pos && out.pos == out_pos) {
+        return errors::DataLoss(
+            "zstd data decompresses to fewer bytes than expected");
+      }
+    }
+  }
+  // Consume the end of the frame (e.g. its checksum).
+  char unused;
+  while (ret != 0) {
+    ZSTD_outBuffer out = {&unused, 0, 0};
+    const size_t in_pos = in.pos;
+    ret = ZSTD_decompressStream(dctx.get(), &out, &in);
+    if (ZSTD_isError(ret)) {
+      return errors::DataLoss("ZSTD_decompressStream() failed: ",
+                              ZSTD_getErrorName(ret));
+    }
+    if (ret != 0 && in.pos == in_pos) {
+      return errors::DataLoss(
+          "zstd data is truncated or decompresses to more bytes than "
+          "expected");
+    }
+  }
+  if (in.pos != in.size) {
+    return errors::DataLoss("Unexpected trailing data after zstd frame");
+  }
+  return Status::OK();
+}
+
+#else  // TF_USE_ZSTD
+
+namespace {
+
+Status NoZstdSupport() {
+  return errors::Unimplemented(
+      "ZSTD compression requires TensorFlow built with "
+      "--define=with_zstd_support=true");
+}
+
+}  // namespace
+
+bool IsZstdSupported() { return false; }
+
+Status ZstdCompress(StringPiece input, const ZstdCompressionOptions& options,
+                    std::string* output) {
+  return NoZstdSupport();
+}
+
+Status ZstdUncompress(StringPiece input, const ZstdCompressionOptions& options,
+                      absl::Span<const absl::Span<char>> outputs) {
+  return NoZstdSupport();
+}
+
+#endif  // TF_USE_ZSTD
+
+}  // namespace io
+}  // namespace tensorflow
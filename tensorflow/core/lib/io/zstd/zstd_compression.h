@@ -0,0 +1,48 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_COMPRESSION_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_COMPRESSION_H_
+
+#include <string>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+namespace io {
+
+// Returns whether TensorFlow was built with zstd support
+// (--define=with_zstd_support=true). Without it, all zstd compression and
+// decompression fails with UNIMPLEMENTED.
+bool IsZstdSupported();
+
+// Compresses `input` into a single zstd frame in `*output`, using the level,
+// workers and dictionary from `options`.
+Status ZstdCompress(StringPiece input, const ZstdCompressionOptions& options,
+                    std::string* output);
+
+// Decompresses the zstd frame in `input`, filling the buffers in `outputs` in
+// order. Returns DATA_LOSS if `input` is corrupt or does not decompress to
+// exactly the total size of `outputs`.
+Status ZstdUncompress(StringPiece input, const ZstdCompressionOptions& options,
+                      absl::Span<const absl::Span<char>> outputs);
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_COMPRESSION_H_
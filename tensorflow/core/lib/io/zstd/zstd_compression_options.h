@@ -0,0 +1,52 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
+
+#include <string>
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace io {
+
+struct ZstdCompressionOptions {
+  // Size of the buffer used for caching the data read from source file.
+  int64 input_buffer_size = 256 << 10;
+
+  // Size of the sink buffer where the compressed/decompressed data produced by
+  // zstd is cached.
+  int64 output_buffer_size = 256 << 10;
+
+  // Compression level, from 1 (fastest) to ZSTD_maxCLevel() (currently 22).
+  // Negative levels trade more ratio for speed. 0 selects zstd's default
+  // (currently 3). Ignored when decompressing.
+  int compression_level = 3;
+
+  // Number of background threads zstd compresses with. 0 compresses on the
+  // calling thread. Ignored when decompressing.
+  int num_workers = 0;
+
+  // Contents of a dictionary, e.g. as produced by `zstd --train`, to prime the
+  // (de)compressor with. Small records compress much better with a dictionary
+  // trained on similar data. The same dictionary must be used to decompress.
+  std::string dictionary;
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
@@ -0,0 +1,198 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/zstd/zstd_inputstream.h"
+
+#if defined(TF_USE_ZSTD)
+#include <zstd.h>
+#endif  // TF_USE_ZSTD
+
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace io {
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 const ZstdCompressionOptions& options,
+                                 bool owns_input_stream)
+    : input_stream_(input_stream),
+      options_(options),
+      owns_input_stream_(owns_input_stream),
+      output_buffer_(new char[options.output_buffer_size]),
+      next_out_(output_buffer_.get()) {}
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 const ZstdCompressionOptions& options)
+    : ZstdInputStream(input_stream, options, false) {}
+
+ZstdInputStream::~ZstdInputStream() {
+#if defined(TF_USE_ZSTD)
+  ZSTD_freeDCtx(dctx_);
+#endif  // TF_USE_ZSTD
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status ZstdInputStream::ReadNBytes(int64 bytes_to_read, tstring* result) {
+  result->clear();
+  result->resize_uninitialized(bytes_to_read);
+
+  char* result_ptr = result->mdata();
+
+  // Read as many bytes as possible from the cache.
+  size_t bytes_read = ReadBytesFromCache(bytes_to_read, result_ptr);
+  bytes_to_read -= bytes_read;
+  result_ptr += bytes_read;
+
+  while (bytes_to_read > 0) {
+    DCHECK_EQ(avail_out_, 0);
+
+    // Fill the cache with more data.
+    Status s = Inflate();
+    if (errors::IsOutOfRange(s)) {
+      result->resize(result_ptr - result->data());
+    }
+    TF_RETURN_IF_ERROR(s);
+
+    size_t bytes_read = ReadBytesFromCache(bytes_to_read, result_ptr);
+    bytes_to_read -= bytes_read;
+    result_ptr += bytes_read;
+  }
+
+  return Status::OK();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZstdInputStream::ReadNBytes(int64 bytes_to_read, absl::Cord* result) {
+  tstring buf;
+  Status s = ReadNBytes(bytes_to_read, &buf);
+  result->Clear();
+  result->Append(buf.data());
+  return s;
+}
+#endif
+
+#if defined(TF_USE_ZSTD)
+
+Status ZstdInputStream::InitDecompressor() {
+  if (dctx_ != nullptr) {
+    return Status::OK();
+  }
+  dctx_ = ZSTD_createDCtx();
+  if (dctx_ == nullptr) {
+    return errors::ResourceExhausted("Failed to create zstd context");
+  }
+  if (!options_.dictionary.empty()) {
+    const size_t ret = ZSTD_DCtx_loadDictionary(
+        dctx_, options_.dictionary.data(), options_.dictionary.size());
+    if (ZSTD_isError(ret)) {
+      return errors::InvalidArgument("Failed to load zstd dictionary: ",
+                                     ZSTD_getErrorName(ret));
+    }
+  }
+  return Status::OK();
+}
+
+Status ZstdInputStream::Inflate() {
+  TF_RETURN_IF_ERROR(InitDecompressor());
+  while (true) {
+    if (input_pos_ == input_buffer_.size()) {
+      if (input_eof_) {
+        if (!frame_complete_) {
+          return errors::DataLoss("Truncated zstd stream");
+        }
+        return errors::OutOfRange("End of zstd stream");
+      }
+      Status s =
+          input_stream_->ReadNBytes(options_.input_buffer_size, &input_buffer_);
+      input_pos_ = 0;
+      if (errors::IsOutOfRange(s)) {
+        input_eof_ = true;
+      } else {
+        TF_RETURN_IF_ERROR(s);
+      }
+      continue;
+    }
+
+    ZSTD_inBuffer input = {input_buffer_.data(), input_buffer_.size(),
+                           input_pos_};
+    ZSTD_outBuffer output = {output_buffer_.get(),
+                             static_cast<size_t>(options_.output_buffer_size),
+                             0};
+    const size_t ret = ZSTD_decompressStream(dctx_, &output, &input);
+    if (ZSTD_isError(ret)) {
+      return errors::DataLoss("ZSTD_decompressStream() failed: ",
+                              ZSTD_getErrorName(ret));
+    }
+    input_pos_ = input.pos;
+    frame_complete_ = ret == 0;
+    if (output.pos > 0) {
+      next_out_ = output_buffer_.get();
+      avail_out_ = output.pos;
+      return Status::OK();
+    }
+  }
+}
+
+Status ZstdInputStream::Reset() {
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  if (dctx_ != nullptr) {
+    ZSTD_DCtx_reset(dctx_, ZSTD_reset_session_only);
+  }
+  input_buffer_.clear();
+  input_pos_ = 0;
+  input_eof_ = false;
+  frame_complete_ = true;
+  avail_out_ = 0;
+  bytes_read_ = 0;
+  return Status::OK();
+}
+
+#else  // TF_USE_ZSTD
+
+Status ZstdInputStream::InitDecompressor() {
+  return errors::Unimplemented(
+      "ZSTD decompression requires TensorFlow built with "
+      "--define=with_zstd_support=true");
+}
+
+Status ZstdInputStream::Inflate() { return InitDecompressor(); }
+
+Status ZstdInputStream::Reset() {
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  avail_out_ = 0;
+  bytes_read_ = 0;
+  return Status::OK();
+}
+
+#endif  // TF_USE_ZSTD
+
+size_t ZstdInputStream::ReadBytesFromCache(size_t bytes_to_read,
+                                           char* result) {
+  size_t can_read_bytes = std::min(bytes_to_read, avail_out_);
+  if (can_read_bytes) {
+    memcpy(result, next_out_, can_read_bytes);
+    next_out_ += can_read_bytes;
+    avail_out_ -= can_read_bytes;
+  }
+  bytes_read_ += can_read_bytes;
+  return can_read_bytes;
+}
+
+int64 ZstdInputStream::Tell() const { return bytes_read_; }
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,108 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
+
+#include <memory>
+
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/core/platform/macros.h"
+
+struct ZSTD_DCtx_s;
+
+namespace tensorflow {
+namespace io {
+
+// An ZstdInputStream provides support for reading from a stream compressed
+// using zstd (https://facebook.github.io/zstd/), e.g. by ZstdOutputBuffer.
+// Concatenated zstd frames are decompressed as one stream.
+//
+// A given instance of an ZstdInputStream is NOT safe for concurrent use
+// by multiple threads.
+class ZstdInputStream : public InputStreamInterface {
+ public:
+  // Creates a ZstdInputStream for `input_stream`.
+  //
+  // Takes ownership  of `input_stream` iff `owns_input_stream` is true.
+  ZstdInputStream(InputStreamInterface* input_stream,
+                  const ZstdCompressionOptions& options,
+                  bool owns_input_stream);
+
+  // Equivalent to the previous constructor with owns_input_stream = false.
+  ZstdInputStream(InputStreamInterface* input_stream,
+                  const ZstdCompressionOptions& options);
+
+  ~ZstdInputStream() override;
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:            If successful.
+  // OUT_OF_RANGE:  If there are not enough bytes to read before the end of the
+  //                stream. *result then holds the bytes that were read.
+  // DATA_LOSS:     If the compressed data is corrupt or truncated.
+  // UNIMPLEMENTED: If TensorFlow was built without zstd support.
+  // others:        If reading from stream failed.
+  Status ReadNBytes(int64 bytes_to_read, tstring* result) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status ReadNBytes(int64 bytes_to_read, absl::Cord* result) override;
+#endif
+
+  int64 Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // Creates `dctx_` on first use.
+  Status InitDecompressor();
+
+  // Decompresses the next chunk of input into `output_buffer_`.
+  Status Inflate();
+
+  // Attempt to read `bytes_to_read` from the decompressed data cache. Returns
+  // the actual number of bytes read.
+  size_t ReadBytesFromCache(size_t bytes_to_read, char* result);
+
+  InputStreamInterface* input_stream_;
+  const ZstdCompressionOptions options_;
+  const bool owns_input_stream_;
+
+  ZSTD_DCtx_s* dctx_ = nullptr;
+
+  // Compressed bytes read from `input_stream_` but not yet consumed by zstd.
+  tstring input_buffer_;
+  size_t input_pos_ = 0;
+  bool input_eof_ = false;
+  // Whether the last frame seen was completely decoded.
+  bool frame_complete_ = true;
+
+  // Decompressed data not yet returned to the client.
+  std::unique_ptr<char[]> output_buffer_;
+  char* next_out_;
+  size_t avail_out_ = 0;
+
+  // Specifies the number of decompressed bytes currently read.
+  int64 bytes_read_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
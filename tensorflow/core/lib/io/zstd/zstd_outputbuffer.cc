@@ -0,0 +1,170 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/zstd/zstd_outputbuffer.h"
+
+#if defined(TF_USE_ZSTD)
+#include <zstd.h>
+#endif  // TF_USE_ZSTD
+
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace io {
+
+ZstdOutputBuffer::ZstdOutputBuffer(WritableFile* file,
+                                   const ZstdCompressionOptions& options)
+    : file_(file),
+      options_(options),
+      output_buffer_(new char[options.output_buffer_size]),
+      output_buffer_capacity_(options.output_buffer_size) {}
+
+#if defined(TF_USE_ZSTD)
+
+ZstdOutputBuffer::~ZstdOutputBuffer() {
+  if (cctx_) {
+    LOG(WARNING) << "ZstdOutputBuffer::Close() not called. Possible data loss";
+    ZSTD_freeCCtx(cctx_);
+  }
+}
+
+Status ZstdOutputBuffer::Init() {
+  if (output_buffer_capacity_ == 0) {
+    return errors::InvalidArgument("output_buffer_bytes should be positive");
+  }
+  cctx_ = ZSTD_createCCtx();
+  if (cctx_ == nullptr) {
+    return errors::ResourceExhausted("Failed to create zstd context");
+  }
+  size_t ret = ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel,
+                                      options_.compression_level);
+  if (!ZSTD_isError(ret)) {
+    ret = ZSTD_CCtx_setParameter(cctx_, ZSTD_c_checksumFlag, 1);
+  }
+  if (!ZSTD_isError(ret) && options_.num_workers > 0) {
+    // Fails if libzstd was built without multithreading support.
+    ret = ZSTD_CCtx_setParameter(cctx_, ZSTD_c_nbWorkers,
+                                 options_.num_workers);
+  }
+  if (!ZSTD_isError(ret) && !options_.dictionary.empty()) {
+    ret = ZSTD_CCtx_loadDictionary(cctx_, options_.dictionary.data(),
+                                   options_.dictionary.size());
+  }
+  if (ZSTD_isError(ret)) {
+    ZSTD_freeCCtx(cctx_);
+    cctx_ = nullptr;
+    return errors::InvalidArgument("Failed to configure zstd compression: ",
+                                   ZSTD_getErrorName(ret));
+  }
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Compress(StringPiece data, int end_op) {
+  if (cctx_ == nullptr) {
+    return errors::FailedPrecondition(
+        "ZstdOutputBuffer is not initialized or already closed");
+  }
+  ZSTD_inBuffer input = {data.data(), data.size(), 0};
+  while (true) {
+    ZSTD_outBuffer output = {output_buffer_.get(), output_buffer_capacity_,
+                             output_pos_};
+    const size_t remaining = ZSTD_compressStream2(
+        cctx_, &output, &input, static_cast<ZSTD_EndDirective>(end_op));
+    if (ZSTD_isError(remaining)) {
+      return errors::DataLoss("ZSTD_compressStream2() failed: ",
+                              ZSTD_getErrorName(remaining));
+    }
+    output_pos_ = output.pos;
+    const bool done = end_op == ZSTD_e_continue ? input.pos == input.size
+                                                : remaining == 0;
+    if (done) break;
+    TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  }
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Close() {
+  if (cctx_) {
+    TF_RETURN_IF_ERROR(Compress(StringPiece(), ZSTD_e_end));
+    TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    ZSTD_freeCCtx(cctx_);
+    cctx_ = nullptr;
+  }
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Append(StringPiece data) {
+  return Compress(data, ZSTD_e_continue);
+}
+
+Status ZstdOutputBuffer::Flush() {
+  TF_RETURN_IF_ERROR(Compress(StringPiece(), ZSTD_e_flush));
+  TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  return file_->Flush();
+}
+
+#else  // TF_USE_ZSTD
+
+ZstdOutputBuffer::~ZstdOutputBuffer() {}
+
+Status ZstdOutputBuffer::Init() {
+  return errors::Unimplemented(
+      "ZSTD compression requires TensorFlow built with "
+      "--define=with_zstd_support=true");
+}
+
+Status ZstdOutputBuffer::Close() { return Status::OK(); }
+
+Status ZstdOutputBuffer::Append(StringPiece data) {
+  return errors::FailedPrecondition("ZstdOutputBuffer is not initialized");
+}
+
+Status ZstdOutputBuffer::Flush() {
+  return errors::FailedPrecondition("ZstdOutputBuffer is not initialized");
+}
+
+#endif  // TF_USE_ZSTD
+
+#if defined(TF_CORD_SUPPORT)
+Status ZstdOutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return Status::OK();
+}
+#endif
+
+Status ZstdOutputBuffer::FlushOutputBufferToFile() {
+  if (output_pos_ > 0) {
+    TF_RETURN_IF_ERROR(
+        file_->Append(StringPiece(output_buffer_.get(), output_pos_)));
+    output_pos_ = 0;
+  }
+  return Status::OK();
+}
+
+Status ZstdOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ZstdOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status ZstdOutputBuffer::Tell(int64* position) { return file_->Tell(position); }
+
+}  // namespace io
+}  // namespace tensorflow
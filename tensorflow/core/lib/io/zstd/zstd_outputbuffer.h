@@ -0,0 +1,107 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+#define TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+
+#include <memory>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+struct ZSTD_CCtx_s;
+
+namespace tensorflow {
+namespace io {
+
+// Compresses input data using zstd (https://facebook.github.io/zstd/) and
+// writes it to `file` as a single zstd frame.
+//
+// zstd buffers the input internally; the compressed output is buffered in a
+// buffer of size `options.output_buffer_size` which gets written to file when
+// full.
+//
+// A given instance of an ZstdOutputBuffer is NOT safe for concurrent use
+// by multiple threads.
+class ZstdOutputBuffer : public WritableFile {
+ public:
+  // Does not take ownership of `file`.
+  ZstdOutputBuffer(WritableFile* file, const ZstdCompressionOptions& options);
+
+  // Per convention, the dtor does not call Flush() or Close(). We expect the
+  // caller to call those manually when done.
+  ~ZstdOutputBuffer() override;
+
+  // Initializes the compression context. This call is required before any
+  // other operation on the buffer. Returns UNIMPLEMENTED if TensorFlow was
+  // built without zstd support.
+  Status Init();
+
+  // Adds `data` to the compression pipeline.
+  //
+  // To immediately write contents to file call `Flush()`.
+  Status Append(StringPiece data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses any input buffered by zstd and writes all output to file.
+  Status Flush() override;
+
+  // Ends the zstd frame and writes all output to file. This must be called
+  // before the destructor to avoid any data loss. Does not close `file`.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Flushes all data to file and syncs it.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64* position) override;
+
+ private:
+  // Feeds `data` to zstd with the given ZSTD_EndDirective, writing output to
+  // file whenever `output_buffer_` fills up, until zstd has consumed all of
+  // `data` and (for flush and end directives) fully flushed.
+  Status Compress(StringPiece data, int end_op);
+
+  // Appends contents of `output_buffer_` to `file_`.
+  Status FlushOutputBufferToFile();
+
+  WritableFile* file_;  // Not owned
+  const ZstdCompressionOptions options_;
+
+  std::unique_ptr<char[]> output_buffer_;
+  size_t output_buffer_capacity_;
+  // Number of compressed bytes at the head of `output_buffer_`.
+  size_t output_pos_ = 0;
+
+  ZSTD_CCtx_s* cctx_ = nullptr;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdOutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
@@ -0,0 +1,162 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/zstd/zstd_compression.h"
+#include "tensorflow/core/lib/io/zstd/zstd_inputstream.h"
+#include "tensorflow/core/lib/io/zstd/zstd_outputbuffer.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+string GenTestString(int copies) {
+  string result;
+  for (int i = 0; i < copies; ++i) {
+    strings::StrAppend(&result, "Record ", i,
+                       ": Lorem ipsum dolor sit amet, consectetur adipiscing "
+                       "elit. Fusce vehicula tincidunt libero sit amet.\n");
+  }
+  return result;
+}
+
+Status WriteZstdFile(const string& fname, const ZstdCompressionOptions& options,
+                     const string& data, int num_writes, bool with_flush) {
+  std::unique_ptr<WritableFile> file_writer;
+  TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(fname, &file_writer));
+  ZstdOutputBuffer out(file_writer.get(), options);
+  TF_RETURN_IF_ERROR(out.Init());
+  for (int i = 0; i < num_writes; ++i) {
+    TF_RETURN_IF_ERROR(out.Append(data));
+    if (with_flush) {
+      TF_RETURN_IF_ERROR(out.Flush());
+    }
+  }
+  TF_RETURN_IF_ERROR(out.Close());
+  return file_writer->Close();
+}
+
+void TestRoundTrip(const ZstdCompressionOptions& options, int num_writes,
+                   bool with_flush) {
+  const string fname = testing::TmpDir() + "/zstd_buffers_test";
+  const string data = GenTestString(100);
+  TF_ASSERT_OK(WriteZstdFile(fname, options, data, num_writes, with_flush));
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file_reader));
+  ZstdInputStream in(new RandomAccessInputStream(file_reader.get()), options,
+                     /*owns_input_stream=*/true);
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    for (int i = 0; i < num_writes; ++i) {
+      tstring result;
+      TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+      EXPECT_EQ(result, data);
+    }
+    EXPECT_EQ(in.Tell(), num_writes * data.size());
+    tstring result;
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+    EXPECT_TRUE(result.empty());
+    TF_ASSERT_OK(in.Reset());
+  }
+}
+
+class ZstdTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!IsZstdSupported()) {
+      GTEST_SKIP() << "Built without zstd support";
+    }
+  }
+};
+
+TEST_F(ZstdTest, RoundTrip) {
+  ZstdCompressionOptions options;
+  options.input_buffer_size = 100;
+  options.output_buffer_size = 100;
+  TestRoundTrip(options, /*num_writes=*/3, /*with_flush=*/false);
+  TestRoundTrip(options, /*num_writes=*/3, /*with_flush=*/true);
+}
+
+TEST_F(ZstdTest, RoundTripWithDictionaryAndWorkers) {
+  ZstdCompressionOptions options;
+  options.dictionary = GenTestString(4);
+  options.compression_level = 19;
+  options.num_workers = 2;
+  TestRoundTrip(options, /*num_writes=*/5, /*with_flush=*/false);
+}
+
+TEST_F(ZstdTest, TruncatedFile) {
+  const string fname = testing::TmpDir() + "/zstd_truncated_test";
+  const string data = GenTestString(100);
+  string compressed;
+  TF_ASSERT_OK(ZstdCompress(data, ZstdCompressionOptions(), &compressed));
+  compressed.pop_back();
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), fname, compressed));
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input(file_reader.get());
+  ZstdInputStream in(&input, ZstdCompressionOptions());
+  tstring result;
+  EXPECT_TRUE(errors::IsDataLoss(in.ReadNBytes(data.size() + 1, &result)));
+}
+
+TEST_F(ZstdTest, UncompressIntoBuffers) {
+  const string data = GenTestString(10);
+  ZstdCompressionOptions options;
+  options.dictionary = GenTestString(1);
+  string compressed;
+  TF_ASSERT_OK(ZstdCompress(data, options, &compressed));
+
+  string first(7, '\0');
+  string empty;
+  string second(data.size() - first.size(), '\0');
+  std::vector<absl::Span<char>> outputs = {absl::MakeSpan(first),
+                                           absl::MakeSpan(empty),
+                                           absl::MakeSpan(second)};
+  TF_ASSERT_OK(ZstdUncompress(compressed, options, outputs));
+  EXPECT_EQ(first + second, data);
+
+  // Sizes that disagree with the compressed data are detected.
+  second.pop_back();
+  outputs[2] = absl::MakeSpan(second);
+  EXPECT_TRUE(
+      errors::IsDataLoss(ZstdUncompress(compressed, options, outputs)));
+  second.append(2, '\0');
+  outputs[2] = absl::MakeSpan(second);
+  EXPECT_TRUE(
+      errors::IsDataLoss(ZstdUncompress(compressed, options, outputs)));
+}
+
+TEST(ZstdSupportTest, UnsupportedBuildFailsCleanly) {
+  if (IsZstdSupported()) {
+    GTEST_SKIP() << "Built with zstd support";
+  }
+  string compressed;
+  EXPECT_TRUE(errors::IsUnimplemented(
+      ZstdCompress("data", ZstdCompressionOptions(), &compressed)));
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(
+      testing::TmpDir() + "/zstd_unsupported_test", &file_writer));
+  ZstdOutputBuffer out(file_writer.get(), ZstdCompressionOptions());
+  EXPECT_TRUE(errors::IsUnimplemented(out.Init()));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
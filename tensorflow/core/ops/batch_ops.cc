@@ -54,6 +54,12 @@ REGISTER_OP("BatchFunction")
     // NOTE: Support for `enable_large_batch_splitting == true` is still
     // developed in progress.
     .Attr("enable_large_batch_splitting: bool = false")
+    // If 'bucketing_dimension' is positive, invocations whose inputs differ in
+    // size along that dimension are batched separately, in at most
+    // 'max_buckets' buckets. Further sizes share one queue, as without
+    // bucketing.
+    .Attr("bucketing_dimension: int >= 0 = 0")
+    .Attr("max_buckets: int >= 1 = 8")
     // TODO(apassos): Fix this shape inference function. It requires shape
     // inference of function calls.
     .SetShapeFn(shape_inference::UnknownShape);
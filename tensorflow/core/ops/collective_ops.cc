@@ -122,6 +122,7 @@ REGISTER_OP("CollectiveReduceV2")
     .Attr("timeout_seconds: float = 0")
     .Attr("Nordering_token: int >= 0 = 0")
     .Attr("max_subdivs_per_device: int = -1")
+    .Attr("compression: {'none', 'bfloat16', 'float16'} = 'none'")
     .SetIsStateful()
     .SetIsDistributedCommunication()
     .SetShapeFn(shape_inference::UnchangedShape);
@@ -357,6 +357,22 @@ REGISTER_OP("ExperimentalDirectedInterleaveDataset")
     .Attr("N: int >= 1")
     .SetShapeFn(shape_inference::ScalarShape);
 
+REGISTER_OP("GlobalShuffleDataset")
+    .Input("input_dataset: variant")
+    .Input("seed: int64")
+    .Input("seed2: int64")
+    .Output("handle: variant")
+    .Attr("reshuffle_each_iteration: bool = true")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // seed and seed2 should be scalars.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("GroupByReducerDataset")
     .Input("input_dataset: variant")
     .Input("key_func_other_arguments: Tkey_func_other_arguments")
@@ -704,6 +720,7 @@ REGISTER_OP("ParseExampleDatasetV2")
     .Attr("ragged_keys: list(string) >= 0 = []")
     .Attr("ragged_value_types: list({float,int64,string}) >= 0 = []")
     .Attr("ragged_split_types: list({int32,int64}) >= 0 = []")
+    .Attr("bytes_as_views: bool = false")
     .SetShapeFn(shape_inference::ScalarShape);
 
 REGISTER_OP("ExperimentalParseExampleDataset")
@@ -966,6 +983,9 @@ REGISTER_OP("SnapshotDatasetV2")
     .Attr("shard_func: func")
     .Attr("Treader_func_args: list(type) >= 0")
     .Attr("Tshard_func_args: list(type) >= 0")
+    .Attr("read_while_writing: bool = false")
+    .Attr("num_writers: int = 1")
+    .Attr("writer_index: int = 0")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       shape_inference::ShapeHandle unused;
       // `path` should be a scalar.
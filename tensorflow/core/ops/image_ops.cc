@@ -511,6 +511,43 @@ REGISTER_OP("DecodeAndCropJpeg")
       return Status::OK();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("DecodeAndResizeJpeg")
+    .Input("contents: string")
+    .Input("size: int32")
+    .Attr("channels: int = 0")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("try_recover_truncated: bool = false")
+    .Attr("acceptable_fraction: float = 1.0")
+    .Attr("dct_method: string = ''")
+    .Attr("align_corners: bool = false")
+    .Attr("half_pixel_centers: bool = false")
+    .Output("image: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      DimensionHandle channels_dim = c->UnknownDim();
+      int32 channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels != 0) {
+        if (channels < 0) {
+          return errors::InvalidArgument("channels must be non-negative, got ",
+                                         channels);
+        }
+        channels_dim = c->MakeDim(channels);
+      }
+
+      // The shape of the resized batch of one image, without its batch
+      // dimension.
+      TF_RETURN_IF_ERROR(
+          SetOutputToSizedImage(c, c->MakeDim(1), 1 /* size_input_idx */,
+                                channels_dim));
+      ShapeHandle image;
+      TF_RETURN_IF_ERROR(c->Subshape(c->output(0), 1, &image));
+      c->set_output(0, image);
+      return Status::OK();
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
@@ -248,6 +248,93 @@ Do not invoke this operator directly in Python. A fusion optimization is
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedLayerNorm")
+    .Input("x: T")
+    .Input("scale: T")
+    .Input("offset: T")
+    .Output("y: T")
+    .Attr("T: {half, float, bfloat16}")
+    .Attr("epsilon: float = 0.001")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle x;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &x));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &unused));
+      c->set_output(0, x);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Internal LayerNorm operation: reserved for internal use. Normalizes `x` over
+its last dimension, then multiplies it by `scale` and adds `offset`.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
+REGISTER_OP("_FusedGelu")
+    .Input("x: T")
+    .Output("y: T")
+    .Attr("T: {half, float, bfloat16}")
+    .Attr("approximate: bool = false")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Internal GELU operation: reserved for internal use. Uses the tanh-based
+approximation of the GELU if `approximate` is true, and the erf-based exact
+definition otherwise.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
+REGISTER_OP("_FusedScaledMaskedSoftmax")
+    .Input("logits: T")
+    .Input("mask: T")
+    .Output("y: T")
+    .Attr("T: {half, float, bfloat16}")
+    .Attr("scale: float = 1.0")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Internal Softmax operation: reserved for internal use. Computes the softmax of
+`logits * scale + mask` along the last dimension. The mask must have the last
+dimension of the logits, and can only be broadcast along the dimensions that
+follow the leading dimensions it shares with the logits.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
+REGISTER_OP("_FusedAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Input("args: num_args * T")
+    .Output("output: T")
+    .Attr("T: {half, float, bfloat16}")
+    .Attr("num_args: int >= 0")
+    .Attr("scale: float = 1.0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle query;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 2, &query));
+      ShapeHandle value;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(2), 2, &value));
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->ReplaceDim(query, -1, c->Dim(value, -1), &output));
+      c->set_output(0, output);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Internal attention operation: reserved for internal use. Computes
+`softmax(query * key^T * scale + bias) * value` over the last two dimensions,
+where `bias` is the optional single element of `args`, without materializing
+the scores. The query, key and value must have the same batch dimensions. The
+bias can only be broadcast along the dimensions of the scores that follow the
+leading dimensions it shares with them, and along the query or key dimension.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("FusedBatchNormGrad")
     .Input("y_backprop: T")
     .Input("x: T")
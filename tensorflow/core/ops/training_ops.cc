@@ -675,6 +675,21 @@ REGISTER_OP("ResourceSparseApplyFtrlV2")
     .Attr("multiply_linear_by_lr: bool = false")
     .SetShapeFn(ApplyFtrlShapeFn</*is_sparse=*/true, /*is_resource=*/true>);
 
+// Handles the `n` variables of each of the `num_var_lists` lists of the Multi
+// ops, which start at input 0, and the `n` gradients at <grad_idx>.
+static Status HandleMultiVarAndGradInputs(InferenceContext* c, int n,
+                                          int num_var_lists, int grad_idx) {
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = ShapeOrHandleShape</*is_resource=*/true>(c, i);
+    for (int list = 1; list < num_var_lists; ++list) {
+      TF_RETURN_IF_ERROR(c->Merge(
+          s, ShapeOrHandleShape</*is_resource=*/true>(c, list * n + i), &s));
+    }
+    TF_RETURN_IF_ERROR(c->Merge(s, c->input(grad_idx + i), &s));
+  }
+  return Status::OK();
+}
+
 template <bool is_sparse, bool is_resource>
 static Status ApplyMomentumShapeFn(InferenceContext* c) {
   ShapeHandle unused;
@@ -732,6 +747,27 @@ REGISTER_OP("ResourceApplyMomentum")
     .SetShapeFn(
         ApplyMomentumShapeFn</*is_sparse=*/false, /*is_resource=*/true>);
 
+REGISTER_OP("ResourceApplyMomentumMulti")
+    .Input("var: N * resource")
+    .Input("accum: N * resource")
+    .Input("lr: T")
+    .Input("grad: N * T")
+    .Input("momentum: T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2 * n), 0, &unused));  // lr
+      TF_RETURN_IF_ERROR(
+          c->WithRank(c->input(3 * n + 1), 0, &unused));  // momentum
+      return HandleMultiVarAndGradInputs(c, n, /*num_var_lists=*/2,
+                                         /*grad_idx=*/2 * n + 1);
+    });
+
 REGISTER_OP("ResourceSparseApplyMomentum")
     .Input("var: resource")
     .Input("accum: resource")
@@ -826,6 +862,33 @@ REGISTER_OP("ResourceApplyAdam")
     .Attr("use_nesterov: bool = false")
     .SetShapeFn(ApplyAdamShapeFn</*is_resource=*/true>);
 
+REGISTER_OP("ResourceApplyAdamMulti")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      ShapeHandle unused;
+      // beta1_power, beta2_power, lr, beta1, beta2 and epsilon.
+      for (int i = 3 * n; i < 3 * n + 6; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+      }
+      return HandleMultiVarAndGradInputs(c, n, /*num_var_lists=*/3,
+                                         /*grad_idx=*/3 * n + 6);
+    });
+
 template <bool is_resource>
 static Status ApplyAdamWithAmsgradShapeFn(InferenceContext* c) {
   ShapeHandle unused;
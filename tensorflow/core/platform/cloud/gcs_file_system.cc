@@ -33,6 +33,7 @@ limitations under the License.
 #include "absl/base/macros.h"
 #include "json/json.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cloud/curl_http_request.h"
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/cloud/google_auth_provider.h"
@@ -144,6 +145,8 @@ constexpr char kAppendMode[] = "GCS_APPEND_MODE";
 // default as the multiple API calls required add a risk of stranding temporary
 // objects.
 constexpr char kComposeAppend[] = "compose";
+// The maximum number of source objects of a single GCS compose request.
+constexpr size_t kMaxComposeSources = 32;
 
 Status GetTmpFilename(string* filename) {
   *filename = io::GetTempFilename("");
@@ -298,10 +301,12 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
 
   // Initialize the reader. Provided read_fn should be thread safe.
   BufferedGcsRandomAccessFile(const string& filename, uint64 buffer_size,
-                              ReadFn read_fn)
+                              uint64 max_buffer_size, ReadFn read_fn)
       : filename_(filename),
         read_fn_(std::move(read_fn)),
         buffer_size_(buffer_size),
+        max_buffer_size_(std::max(buffer_size, max_buffer_size)),
+        fill_size_(buffer_size),
         buffer_start_(0),
         buffer_end_is_past_eof_(false) {}
 
@@ -355,10 +360,17 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
  private:
   Status FillBuffer(uint64 start) const
       TF_EXCLUSIVE_LOCKS_REQUIRED(buffer_mutex_) {
+    // Widen the read-ahead window while the file is consumed sequentially and
+    // fall back to the base size on a random access.
+    if (!buffer_.empty() && start == buffer_start_ + buffer_.size()) {
+      fill_size_ = std::min(fill_size_ * 2, max_buffer_size_);
+    } else {
+      fill_size_ = buffer_size_;
+    }
     buffer_start_ = start;
-    buffer_.resize(buffer_size_);
+    buffer_.resize(fill_size_);
     StringPiece str_piece;
-    Status status = read_fn_(filename_, buffer_start_, buffer_size_, &str_piece,
+    Status status = read_fn_(filename_, buffer_start_, fill_size_, &str_piece,
                              &(buffer_[0]));
     buffer_end_is_past_eof_ = status.code() == errors::Code::OUT_OF_RANGE;
     buffer_.resize(str_piece.size());
@@ -374,6 +386,9 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
   // Size of buffer that we read from GCS each time we send a request.
   const uint64 buffer_size_;
 
+  // Size up to which the buffer grows during sequential reads.
+  const uint64 max_buffer_size_;
+
   // Mutex for buffering operations that can be accessed from multiple threads.
   // The following members are mutable in order to provide a const Read.
   mutable mutex buffer_mutex_;
@@ -381,6 +396,9 @@ class BufferedGcsRandomAccessFile : public RandomAccessFile {
   // Offset of buffer from start of the file.
   mutable uint64 buffer_start_ TF_GUARDED_BY(buffer_mutex_);
 
+  // Number of bytes requested by the last buffer fill.
+  mutable uint64 fill_size_ TF_GUARDED_BY(buffer_mutex_);
+
   mutable bool buffer_end_is_past_eof_ TF_GUARDED_BY(buffer_mutex_);
 
   mutable string buffer_ TF_GUARDED_BY(buffer_mutex_);
@@ -411,6 +429,25 @@ typedef std::function<Status(const string& fname, const string& bucket,
                              const string& object, int64* generation)>
     GenerationGetter;
 
+// Function object declaration with params needed to upload a part of a
+// parallel composite upload.
+typedef std::function<Status(const std::string& object, uint64 offset,
+                             uint64 length,
+                             const std::string& tmp_content_filename,
+                             const std::string& file_path)>
+    PartUploader;
+
+// Settings of parallel composite uploads for a writable file.
+struct ParallelUploadOptions {
+  // Files of at least this many bytes are uploaded in parts. 0 disables
+  // parallel uploads.
+  uint64 threshold = 0;
+  uint64 part_size = 0;
+  // The pool the parts are uploaded on, shared with the file system.
+  std::shared_ptr<thread::ThreadPool> pool;
+  PartUploader part_uploader;
+};
+
 /// \brief GCS-based implementation of a writeable file.
 ///
 /// Since GCS objects are immutable, this implementation writes to a local
@@ -424,7 +461,8 @@ class GcsWritableFile : public WritableFile {
                   RetryConfig retry_config, bool compose_append,
                   SessionCreator session_creator,
                   ObjectUploader object_uploader, StatusPoller status_poller,
-                  GenerationGetter generation_getter)
+                  GenerationGetter generation_getter,
+                  ParallelUploadOptions parallel_upload)
       : bucket_(bucket),
         object_(object),
         filesystem_(filesystem),
@@ -437,7 +475,8 @@ class GcsWritableFile : public WritableFile {
         session_creator_(std::move(session_creator)),
         object_uploader_(std::move(object_uploader)),
         status_poller_(std::move(status_poller)),
-        generation_getter_(std::move(generation_getter)) {
+        generation_getter_(std::move(generation_getter)),
+        parallel_upload_(std::move(parallel_upload)) {
     // TODO: to make it safer, outfile_ should be constructed from an FD
     VLOG(3) << "GcsWritableFile: " << GetGcsPath();
     if (GetTmpFilename(&tmp_content_filename_).ok()) {
@@ -458,7 +497,8 @@ class GcsWritableFile : public WritableFile {
                   RetryConfig retry_config, bool compose_append,
                   SessionCreator session_creator,
                   ObjectUploader object_uploader, StatusPoller status_poller,
-                  GenerationGetter generation_getter)
+                  GenerationGetter generation_getter,
+                  ParallelUploadOptions parallel_upload)
       : bucket_(bucket),
         object_(object),
         filesystem_(filesystem),
@@ -471,7 +511,8 @@ class GcsWritableFile : public WritableFile {
         session_creator_(std::move(session_creator)),
         object_uploader_(std::move(object_uploader)),
         status_poller_(std::move(status_poller)),
-        generation_getter_(std::move(generation_getter)) {
+        generation_getter_(std::move(generation_getter)),
+        parallel_upload_(std::move(parallel_upload)) {
     VLOG(3) << "GcsWritableFile: " << GetGcsPath() << "with existing file "
             << tmp_content_filename;
     tmp_content_filename_ = tmp_content_filename;
@@ -566,6 +607,9 @@ class GcsWritableFile : public WritableFile {
                             io::Basename(object_), ".", start_offset_);
       }
     }
+    if (!should_compose && ShouldUploadInParallel()) {
+      return ParallelCompositeUpload();
+    }
     TF_RETURN_IF_ERROR(CreateNewUploadSession(start_offset, object_to_upload,
                                               &session_handle));
     uint64 already_uploaded = 0;
@@ -611,6 +655,75 @@ class GcsWritableFile : public WritableFile {
     return upload_status;
   }
 
+  bool ShouldUploadInParallel() {
+    uint64 file_size;
+    if (parallel_upload_.threshold == 0 || parallel_upload_.pool == nullptr ||
+        !GetCurrentFileSize(&file_size).ok()) {
+      return false;
+    }
+    return file_size >= parallel_upload_.threshold &&
+           file_size > parallel_upload_.part_size;
+  }
+
+  /// Uploads the file as parts on the parallel upload pool and composes them
+  /// into the object. The parts are deleted whether or not the upload
+  /// succeeded.
+  Status ParallelCompositeUpload() {
+    uint64 file_size;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+    const uint64 part_size = parallel_upload_.part_size;
+    std::vector<string> parts;
+    for (uint64 offset = 0; offset < file_size; offset += part_size) {
+      parts.push_back(strings::StrCat(io::Dirname(object_), "/.tmpcompose/",
+                                      io::Basename(object_), ".part.",
+                                      parts.size()));
+    }
+    VLOG(3) << "ParallelCompositeUpload: " << GetGcsPath() << " in "
+            << parts.size() << " parts";
+
+    std::vector<Status> statuses(parts.size());
+    BlockingCounter counter(parts.size());
+    for (size_t i = 0; i < parts.size(); ++i) {
+      parallel_upload_.pool->Schedule([this, &parts, &statuses, &counter,
+                                       file_size, part_size, i]() {
+        const uint64 offset = i * part_size;
+        const uint64 length = std::min(part_size, file_size - offset);
+        statuses[i] = RetryingUtils::CallWithRetries(
+            [this, &parts, offset, length, i]() {
+              return parallel_upload_.part_uploader(
+                  parts[i], offset, length, tmp_content_filename_,
+                  GetGcsPath());
+            },
+            retry_config_);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+
+    Status status;
+    for (const Status& part_status : statuses) {
+      status.Update(part_status);
+    }
+    if (status.ok()) {
+      status = ComposeIntoObject(parts, /*append=*/false);
+    }
+    for (const string& part : parts) {
+      const string part_path = GetGcsPathWithObject(part);
+      RetryingUtils::DeleteWithRetries(
+          [&part_path, this]() {
+            return filesystem_->DeleteFile(part_path, nullptr);
+          },
+          retry_config_)
+          .IgnoreError();
+    }
+    if (status.ok()) {
+      // Erase the file from the file cache on every successful write.
+      file_cache_erase_();
+      TF_RETURN_IF_ERROR(GetCurrentFileSize(&start_offset_));
+    }
+    return status;
+  }
+
   Status CheckWritable() const {
     if (!outfile_.is_open()) {
       return errors::FailedPrecondition(
@@ -645,32 +758,7 @@ class GcsWritableFile : public WritableFile {
     const string append_object_path = GetGcsPathWithObject(append_object);
     VLOG(3) << "AppendObject: " << append_object_path << " to " << GetGcsPath();
 
-    int64 generation = 0;
-    TF_RETURN_IF_ERROR(
-        generation_getter_(GetGcsPath(), bucket_, object_, &generation));
-
-    TF_RETURN_IF_ERROR(RetryingUtils::CallWithRetries(
-        [&append_object, &generation, this]() {
-          std::unique_ptr<HttpRequest> request;
-          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
-
-          request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
-                                          request->EscapeString(object_),
-                                          "/compose"));
-
-          const string request_body = strings::StrCat(
-              "{'sourceObjects': [{'name': '", object_,
-              "','objectPrecondition':{'ifGenerationMatch':", generation,
-              "}},{'name': '", append_object, "'}]}");
-          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
-                               timeouts_->metadata);
-          request->AddHeader("content-type", "application/json");
-          request->SetPostFromBuffer(request_body.c_str(), request_body.size());
-          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(),
-                                          " when composing to ", GetGcsPath());
-          return Status::OK();
-        },
-        retry_config_));
+    TF_RETURN_IF_ERROR(ComposeIntoObject({append_object}, /*append=*/true));
 
     return RetryingUtils::DeleteWithRetries(
         [&append_object_path, this]() {
@@ -679,6 +767,58 @@ class GcsWritableFile : public WritableFile {
         retry_config_);
   }
 
+  /// Composes `sources` into the object, in order. If `append` is true, the
+  /// sources are appended to the current generation of the object. More
+  /// sources than a single compose request takes are appended in batches.
+  Status ComposeIntoObject(const std::vector<string>& sources, bool append) {
+    size_t begin = 0;
+    while (begin < sources.size()) {
+      int64 generation = 0;
+      if (append) {
+        TF_RETURN_IF_ERROR(
+            generation_getter_(GetGcsPath(), bucket_, object_, &generation));
+      }
+      const size_t end = std::min(
+          sources.size(), begin + kMaxComposeSources - (append ? 1 : 0));
+
+      string source_objects;
+      if (append) {
+        strings::StrAppend(&source_objects, "{'name': '", object_,
+                           "','objectPrecondition':{'ifGenerationMatch':",
+                           generation, "}}");
+      }
+      for (size_t i = begin; i < end; ++i) {
+        strings::StrAppend(&source_objects, source_objects.empty() ? "" : ",",
+                           "{'name': '", sources[i], "'}");
+      }
+      const string request_body =
+          strings::StrCat("{'sourceObjects': [", source_objects, "]}");
+
+      TF_RETURN_IF_ERROR(RetryingUtils::CallWithRetries(
+          [&request_body, this]() {
+            std::unique_ptr<HttpRequest> request;
+            TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+
+            request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                            request->EscapeString(object_),
+                                            "/compose"));
+            request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                                 timeouts_->metadata);
+            request->AddHeader("content-type", "application/json");
+            request->SetPostFromBuffer(request_body.c_str(),
+                                       request_body.size());
+            TF_RETURN_WITH_CONTEXT_IF_ERROR(
+                request->Send(), " when composing to ", GetGcsPath());
+            return Status::OK();
+          },
+          retry_config_));
+
+      begin = end;
+      append = true;
+    }
+    return Status::OK();
+  }
+
   /// \brief Requests status of a previously initiated upload session.
   ///
   /// If the upload has already succeeded, sets 'completed' to true.
@@ -731,6 +871,7 @@ class GcsWritableFile : public WritableFile {
   const ObjectUploader object_uploader_;
   const StatusPoller status_poller_;
   const GenerationGetter generation_getter_;
+  const ParallelUploadOptions parallel_upload_;
 };
 
 class GcsReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
@@ -806,6 +947,37 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
           << "block size = " << block_size_ << " ; "
           << "max staleness = " << max_staleness;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
+  // Apply overrides for parallel range reads and the readahead growth, if
+  // provided.
+  size_t read_parallelism = kDefaultReadParallelism;
+  size_t read_min_chunk_size = kDefaultReadMinChunkSize;
+  size_t readahead_max_buffer_size = kDefaultReadaheadMaxBufferSize;
+  if (GetEnvVar(kReadParallelism, strings::safe_strtou64, &value)) {
+    read_parallelism = value;
+  }
+  if (GetEnvVar(kReadMinChunkSize, strings::safe_strtou64, &value)) {
+    read_min_chunk_size = value;
+  }
+  if (GetEnvVar(kReadaheadMaxBufferSize, strings::safe_strtou64, &value)) {
+    readahead_max_buffer_size = value;
+  }
+  ConfigureParallelReads(read_parallelism, read_min_chunk_size,
+                         readahead_max_buffer_size);
+  // Apply overrides for parallel composite uploads, if provided.
+  uint64 parallel_upload_threshold = kDefaultParallelUploadThreshold;
+  uint64 parallel_upload_part_size = kDefaultParallelUploadPartSize;
+  size_t parallel_upload_threads = kDefaultParallelUploadThreads;
+  if (GetEnvVar(kParallelUploadThreshold, strings::safe_strtou64, &value)) {
+    parallel_upload_threshold = value;
+  }
+  if (GetEnvVar(kParallelUploadPartSize, strings::safe_strtou64, &value)) {
+    parallel_upload_part_size = value;
+  }
+  if (GetEnvVar(kParallelUploadThreads, strings::safe_strtou64, &value)) {
+    parallel_upload_threads = value;
+  }
+  ConfigureParallelUploads(parallel_upload_threshold,
+                           parallel_upload_part_size, parallel_upload_threads);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
   size_t stat_cache_max_entries = kStatCacheDefaultMaxEntries;
@@ -992,8 +1164,13 @@ Status GcsFileSystem::NewRandomAccessFile(
       return Status::OK();
     }));
   } else {
+    size_t readahead_max_buffer_size;
+    {
+      tf_shared_lock l(read_config_lock_);
+      readahead_max_buffer_size = readahead_max_buffer_size_;
+    }
     result->reset(new BufferedGcsRandomAccessFile(
-        fname, block_size_,
+        fname, block_size_, readahead_max_buffer_size,
         [this, bucket, object](const string& fname, uint64 offset, size_t n,
                                StringPiece* result, char* scratch) {
           *result = StringPiece();
@@ -1039,6 +1216,37 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
   return file_block_cache;
 }
 
+void GcsFileSystem::ConfigureParallelReads(size_t parallelism,
+                                           size_t min_chunk_bytes,
+                                           size_t readahead_max_bytes) {
+  mutex_lock l(read_config_lock_);
+  read_parallelism_ = std::max<size_t>(parallelism, 1);
+  read_min_chunk_size_ = std::max<size_t>(min_chunk_bytes, 1);
+  readahead_max_buffer_size_ = readahead_max_bytes;
+  // The reading thread sends one of the range requests itself.
+  if (read_parallelism_ > 1) {
+    read_pool_ = std::make_shared<thread::ThreadPool>(
+        Env::Default(), "gcs_parallel_read", read_parallelism_ - 1);
+  } else {
+    read_pool_.reset();
+  }
+}
+
+void GcsFileSystem::ConfigureParallelUploads(uint64 threshold_bytes,
+                                             uint64 part_size_bytes,
+                                             size_t num_threads) {
+  mutex_lock l(upload_config_lock_);
+  parallel_upload_threshold_ = threshold_bytes;
+  parallel_upload_part_size_ = std::max<uint64>(part_size_bytes, 1);
+  parallel_upload_threads_ = std::max<size_t>(num_threads, 1);
+  if (parallel_upload_threshold_ > 0) {
+    upload_pool_ = std::make_shared<thread::ThreadPool>(
+        Env::Default(), "gcs_parallel_upload", parallel_upload_threads_);
+  } else {
+    upload_pool_.reset();
+  }
+}
+
 // A helper function to actually read the data from GCS.
 Status GcsFileSystem::LoadBufferFromGCS(const string& fname, size_t offset,
                                         size_t n, char* buffer,
@@ -1051,24 +1259,70 @@ Status GcsFileSystem::LoadBufferFromGCS(const string& fname, size_t offset,
   profiler::TraceMe activity(
       [fname]() { return absl::StrCat("LoadBufferFromGCS ", fname); });
 
-  std::unique_ptr<HttpRequest> request;
-  TF_RETURN_WITH_CONTEXT_IF_ERROR(CreateHttpRequest(&request),
-                                  "when reading gs://", bucket, "/", object);
+  // Large reads are split into chunks of at least `min_chunk_size` bytes that
+  // are fetched with concurrent range requests.
+  size_t num_chunks = 1;
+  std::shared_ptr<thread::ThreadPool> read_pool;
+  {
+    tf_shared_lock l(read_config_lock_);
+    if (read_pool_ != nullptr) {
+      num_chunks = std::max<size_t>(
+          1, std::min(read_parallelism_, n / read_min_chunk_size_));
+      read_pool = read_pool_;
+    }
+  }
+  const size_t chunk_size = (n + num_chunks - 1) / num_chunks;
 
-  request->SetUri(strings::StrCat("https://", kStorageHost, "/", bucket, "/",
-                                  request->EscapeString(object)));
-  request->SetRange(offset, offset + n - 1);
-  request->SetResultBufferDirect(buffer, n);
-  request->SetTimeouts(timeouts_.connect, timeouts_.idle, timeouts_.read);
+  // The requests are created in order on this thread; only Send() runs
+  // concurrently.
+  std::vector<std::unique_ptr<HttpRequest>> requests;
+  std::vector<size_t> chunk_lengths;
+  size_t chunk_offset = 0;
+  do {
+    const size_t length = std::min(chunk_size, n - chunk_offset);
+    std::unique_ptr<HttpRequest> request;
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(CreateHttpRequest(&request),
+                                    "when reading gs://", bucket, "/", object);
+
+    request->SetUri(strings::StrCat("https://", kStorageHost, "/", bucket, "/",
+                                    request->EscapeString(object)));
+    request->SetRange(offset + chunk_offset,
+                      offset + chunk_offset + length - 1);
+    request->SetResultBufferDirect(buffer + chunk_offset, length);
+    request->SetTimeouts(timeouts_.connect, timeouts_.idle, timeouts_.read);
+    requests.push_back(std::move(request));
+    chunk_lengths.push_back(length);
+    chunk_offset += length;
+  } while (chunk_offset < n);
 
   if (stats_ != nullptr) {
     stats_->RecordBlockLoadRequest(fname, offset);
   }
 
-  TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when reading gs://",
-                                  bucket, "/", object);
+  std::vector<Status> statuses(requests.size());
+  {
+    BlockingCounter counter(requests.size() - 1);
+    for (size_t i = 1; i < requests.size(); ++i) {
+      read_pool->Schedule([&requests, &statuses, &counter, i]() {
+        statuses[i] = requests[i]->Send();
+        counter.DecrementCount();
+      });
+    }
+    statuses[0] = requests[0]->Send();
+    counter.Wait();
+  }
 
-  size_t bytes_read = request->GetResultBufferDirectBytesTransferred();
+  size_t bytes_read = 0;
+  for (size_t i = 0; i < requests.size(); ++i) {
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(statuses[i], " when reading gs://", bucket,
+                                    "/", object);
+    const size_t chunk_bytes =
+        requests[i]->GetResultBufferDirectBytesTransferred();
+    bytes_read += chunk_bytes;
+    // A short chunk ends at the end of the object, so later chunks (which
+    // were requested past it) hold no data.
+    if (chunk_bytes < chunk_lengths[i]) break;
+  }
   *bytes_transferred = bytes_read;
   VLOG(1) << "Successful read of gs://" << bucket << "/" << object << " @ "
           << offset << " of size: " << bytes_read;
@@ -1154,6 +1408,30 @@ Status GcsFileSystem::UploadToSession(const std::string& session_uri,
   return Status::OK();
 }
 
+Status GcsFileSystem::UploadPart(const std::string& bucket,
+                                 const std::string& object,
+                                 const std::string& tmp_content_filename,
+                                 uint64 offset, uint64 length,
+                                 const std::string& file_path) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(
+      Env::Default()->NewRandomAccessFile(tmp_content_filename, &file));
+  std::unique_ptr<char[]> buffer(new char[length]);
+  StringPiece data;
+  TF_RETURN_IF_ERROR(file->Read(offset, length, &data, buffer.get()));
+
+  std::unique_ptr<HttpRequest> request;
+  TF_RETURN_IF_ERROR(CreateHttpRequest(&request));
+  request->SetUri(strings::StrCat(kGcsUploadUriBase, "b/", bucket,
+                                  "/o?uploadType=media&name=",
+                                  request->EscapeString(object)));
+  request->SetTimeouts(timeouts_.connect, timeouts_.idle, timeouts_.write);
+  request->SetPostFromBuffer(data.data(), data.size());
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when uploading part ",
+                                  object, " of ", file_path);
+  return Status::OK();
+}
+
 Status GcsFileSystem::RequestUploadSessionStatus(const string& session_uri,
                                                  uint64 file_size,
                                                  const std::string& gcs_path,
@@ -1295,11 +1573,26 @@ Status GcsFileSystem::NewWritableFile(const string& fname,
     return Status::OK();
   };
 
+  ParallelUploadOptions parallel_upload;
+  {
+    tf_shared_lock l(upload_config_lock_);
+    parallel_upload.threshold = parallel_upload_threshold_;
+    parallel_upload.part_size = parallel_upload_part_size_;
+    parallel_upload.pool = upload_pool_;
+  }
+  parallel_upload.part_uploader =
+      [this, bucket](const std::string& object, uint64 offset, uint64 length,
+                     const std::string& tmp_content_filename,
+                     const std::string& file_path) {
+        return UploadPart(bucket, object, tmp_content_filename, offset, length,
+                          file_path);
+      };
+
   result->reset(new GcsWritableFile(
       bucket, object, this, &timeouts_,
       [this, fname]() { ClearFileCaches(fname); }, retry_config_,
       compose_append_, session_creator, object_uploader, status_poller,
-      generation_getter));
+      generation_getter, std::move(parallel_upload)));
   return Status::OK();
 }
 
@@ -1375,11 +1668,25 @@ Status GcsFileSystem::NewAppendableFile(const string& fname,
   // Create a writable file and pass the old content to it.
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
+  ParallelUploadOptions parallel_upload;
+  {
+    tf_shared_lock l(upload_config_lock_);
+    parallel_upload.threshold = parallel_upload_threshold_;
+    parallel_upload.part_size = parallel_upload_part_size_;
+    parallel_upload.pool = upload_pool_;
+  }
+  parallel_upload.part_uploader =
+      [this, bucket](const std::string& object, uint64 offset, uint64 length,
+                     const std::string& tmp_content_filename,
+                     const std::string& file_path) {
+        return UploadPart(bucket, object, tmp_content_filename, offset, length,
+                          file_path);
+      };
   result->reset(new GcsWritableFile(
       bucket, object, this, old_content_filename, &timeouts_,
       [this, fname]() { ClearFileCaches(fname); }, retry_config_,
       compose_append_, session_creator, object_uploader, status_poller,
-      generation_getter));
+      generation_getter, std::move(parallel_upload)));
   return Status::OK();
 }
 
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/retrying_file_system.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -62,6 +63,36 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that overrides the number of concurrent range
+// requests used to fill a single read buffer. A value of 1 reads every buffer
+// with one request.
+constexpr char kReadParallelism[] = "GCS_READ_PARALLELISM";
+constexpr size_t kDefaultReadParallelism = 1;
+// The environment variable that overrides the smallest range request issued
+// when a buffer fill is split across concurrent requests. Specified in bytes.
+constexpr char kReadMinChunkSize[] = "GCS_READ_MIN_CHUNK_SIZE_BYTES";
+constexpr size_t kDefaultReadMinChunkSize = 8 * 1024 * 1024;
+// The environment variable that overrides the size up to which the read buffer
+// of an uncached file grows while the file is read sequentially. Specified in
+// bytes. A value of 0 keeps the read buffer at the block size.
+constexpr char kReadaheadMaxBufferSize[] =
+    "GCS_READAHEAD_MAX_BUFFER_SIZE_BYTES";
+constexpr size_t kDefaultReadaheadMaxBufferSize = 0;
+// The environment variable that enables parallel composite uploads: files of
+// at least this many bytes are uploaded as parts that are then composed into
+// the destination object. Specified in bytes. A value of 0 disables them.
+constexpr char kParallelUploadThreshold[] =
+    "GCS_PARALLEL_UPLOAD_THRESHOLD_BYTES";
+constexpr uint64 kDefaultParallelUploadThreshold = 0;
+// The environment variable that overrides the size of each part of a parallel
+// composite upload. Specified in bytes.
+constexpr char kParallelUploadPartSize[] =
+    "GCS_PARALLEL_UPLOAD_PART_SIZE_BYTES";
+constexpr uint64 kDefaultParallelUploadPartSize = 32 * 1024 * 1024;
+// The environment variable that overrides the number of parts a file system
+// uploads concurrently.
+constexpr char kParallelUploadThreads[] = "GCS_PARALLEL_UPLOAD_THREADS";
+constexpr size_t kDefaultParallelUploadThreads = 8;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -209,6 +240,30 @@ class GcsFileSystem : public FileSystem {
     tf_shared_lock l(block_cache_lock_);
     return file_block_cache_->max_staleness();
   }
+  size_t read_parallelism() {
+    tf_shared_lock l(read_config_lock_);
+    return read_parallelism_;
+  }
+  size_t read_min_chunk_size() {
+    tf_shared_lock l(read_config_lock_);
+    return read_min_chunk_size_;
+  }
+  size_t readahead_max_buffer_size() {
+    tf_shared_lock l(read_config_lock_);
+    return readahead_max_buffer_size_;
+  }
+  uint64 parallel_upload_threshold() {
+    tf_shared_lock l(upload_config_lock_);
+    return parallel_upload_threshold_;
+  }
+  uint64 parallel_upload_part_size() {
+    tf_shared_lock l(upload_config_lock_);
+    return parallel_upload_part_size_;
+  }
+  size_t parallel_upload_threads() {
+    tf_shared_lock l(upload_config_lock_);
+    return parallel_upload_threads_;
+  }
   TimeoutConfig timeouts() const { return timeouts_; }
   std::unordered_set<string> allowed_locations() const {
     return allowed_locations_;
@@ -284,6 +339,30 @@ class GcsFileSystem : public FileSystem {
   void ResetFileBlockCache(size_t block_size_bytes, size_t max_bytes,
                            uint64 max_staleness_secs);
 
+  /// \brief Configures how large uncached reads are fetched from GCS.
+  ///
+  /// Reads of at least 2 x `min_chunk_bytes` are split into up to
+  /// `parallelism` range requests that are sent concurrently. Files opened
+  /// without the block cache grow their read buffer from the block size up to
+  /// `readahead_max_bytes` (doubling on every sequential refill) and shrink it
+  /// back on a random access.
+  ///
+  /// Only affects files opened after the call.
+  void ConfigureParallelReads(size_t parallelism, size_t min_chunk_bytes,
+                              size_t readahead_max_bytes);
+
+  /// \brief Configures parallel composite uploads.
+  ///
+  /// When a writable file of at least `threshold_bytes` (and more than one
+  /// part) is synced from scratch, it is uploaded as `part_size_bytes` parts,
+  /// at most `num_threads` at a time across the file system, which are then
+  /// composed into the destination object. A `threshold_bytes` of 0 disables
+  /// parallel uploads.
+  ///
+  /// Only affects files opened after the call.
+  void ConfigureParallelUploads(uint64 threshold_bytes, uint64 part_size_bytes,
+                                size_t num_threads);
+
  protected:
   virtual std::unique_ptr<FileBlockCache> MakeFileBlockCache(
       size_t block_size, size_t max_bytes, uint64 max_staleness);
@@ -307,6 +386,14 @@ class GcsFileSystem : public FileSystem {
                                  uint64 file_size,
                                  const std::string& file_path);
 
+  // Uploads `length` bytes of `tmp_content_filename` starting at `offset` as
+  // the object `object` with a single request.
+  virtual Status UploadPart(const std::string& bucket,
+                            const std::string& object,
+                            const std::string& tmp_content_filename,
+                            uint64 offset, uint64 length,
+                            const std::string& file_path);
+
   /// \brief Requests status of a previously initiated upload session.
   ///
   /// If the upload has already succeeded, sets 'completed' to true.
@@ -438,6 +525,31 @@ class GcsFileSystem : public FileSystem {
 
   GcsStatsInterface* stats_ = nullptr;  // Not owned.
 
+  // Parallel range reads, see ConfigureParallelReads(). The pool is shared
+  // with in-flight reads so that reconfiguring does not pull it from under
+  // them.
+  mutex read_config_lock_;
+  size_t read_parallelism_ TF_GUARDED_BY(read_config_lock_) =
+      kDefaultReadParallelism;
+  size_t read_min_chunk_size_ TF_GUARDED_BY(read_config_lock_) =
+      kDefaultReadMinChunkSize;
+  size_t readahead_max_buffer_size_ TF_GUARDED_BY(read_config_lock_) =
+      kDefaultReadaheadMaxBufferSize;
+  std::shared_ptr<thread::ThreadPool> read_pool_
+      TF_GUARDED_BY(read_config_lock_);
+
+  // Parallel composite uploads, see ConfigureParallelUploads(). Writable
+  // files keep the pool they were opened with alive.
+  mutex upload_config_lock_;
+  uint64 parallel_upload_threshold_ TF_GUARDED_BY(upload_config_lock_) =
+      kDefaultParallelUploadThreshold;
+  uint64 parallel_upload_part_size_ TF_GUARDED_BY(upload_config_lock_) =
+      kDefaultParallelUploadPartSize;
+  size_t parallel_upload_threads_ TF_GUARDED_BY(upload_config_lock_) =
+      kDefaultParallelUploadThreads;
+  std::shared_ptr<thread::ThreadPool> upload_pool_
+      TF_GUARDED_BY(upload_config_lock_);
+
   // Additional header material to be transmitted with all GCS requests
   std::unique_ptr<std::pair<const string, const string>> additional_header_;
 
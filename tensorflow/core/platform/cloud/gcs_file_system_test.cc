@@ -155,6 +155,96 @@ TEST(GcsFileSystemTest, NewRandomAccessFile_Buffered) {
   EXPECT_EQ("6789", result);
 }
 
+TEST(GcsFileSystemTest, NewRandomAccessFile_Buffered_ParallelReadahead) {
+  std::vector<HttpRequest*> requests({
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 0-1\n"
+          "Timeouts: 5 1 20\n",
+          "01"),
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 2-3\n"
+          "Timeouts: 5 1 20\n",
+          "23"),
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 4-7\n"
+          "Timeouts: 5 1 20\n",
+          "4567"),
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 8-11\n"
+          "Timeouts: 5 1 20\n",
+          "89ab"),
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 12-15\n"
+          "Timeouts: 5 1 20\n",
+          "cdef"),
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 16-19\n"
+          "Timeouts: 5 1 20\n",
+          ""),
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 0-1\n"
+          "Timeouts: 5 1 20\n",
+          "01"),
+      new FakeHttpRequest(
+          "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+          "Auth Token: fake_token\n"
+          "Range: 2-3\n"
+          "Timeouts: 5 1 20\n",
+          "23"),
+  });
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 4 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  fs.ConfigureParallelReads(2 /* parallelism */, 2 /* min chunk bytes */,
+                            8 /* readahead max bytes */);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("gs://bucket/random_access.txt", nullptr, &file));
+
+  char scratch[4];
+  StringPiece result;
+
+  // The first fill reads one block as two concurrent chunks.
+  TF_EXPECT_OK(file->Read(0, sizeof(scratch), &result, scratch));
+  EXPECT_EQ("0123", result);
+
+  // Sequential reads double the buffer up to the readahead maximum.
+  TF_EXPECT_OK(file->Read(4, sizeof(scratch), &result, scratch));
+  EXPECT_EQ("4567", result);
+  TF_EXPECT_OK(file->Read(8, sizeof(scratch), &result, scratch));
+  EXPECT_EQ("89ab", result);
+
+  // The chunk past the end of the object comes back empty.
+  TF_EXPECT_OK(file->Read(12, sizeof(scratch), &result, scratch));
+  EXPECT_EQ("cdef", result);
+
+  // A random access shrinks the buffer back to the block size.
+  TF_EXPECT_OK(file->Read(0, sizeof(scratch), &result, scratch));
+  EXPECT_EQ("0123", result);
+}
+
 TEST(GcsFileSystemTest, NewRandomAccessFile_Buffered_Errors) {
   std::vector<HttpRequest*> requests({
       new FakeHttpRequest(
@@ -1004,6 +1094,86 @@ TEST(GcsFileSystemTest, NewWritableFile) {
   TF_EXPECT_OK(wfile->Close());
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_ParallelCompositeUpload) {
+  std::vector<HttpRequest*> requests({
+      // Upload the parts.
+      new FakeHttpRequest(
+          "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+          "uploadType=media&name=path%2F.tmpcompose%2Fwriteable.part.0\n"
+          "Auth Token: fake_token\n"
+          "Timeouts: 5 1 30\n"
+          "Post body: content1\n",
+          ""),
+      new FakeHttpRequest(
+          "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+          "uploadType=media&name=path%2F.tmpcompose%2Fwriteable.part.1\n"
+          "Auth Token: fake_token\n"
+          "Timeouts: 5 1 30\n"
+          "Post body: ,content\n",
+          ""),
+      new FakeHttpRequest(
+          "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+          "uploadType=media&name=path%2F.tmpcompose%2Fwriteable.part.2\n"
+          "Auth Token: fake_token\n"
+          "Timeouts: 5 1 30\n"
+          "Post body: 2\n",
+          ""),
+      // Compose the parts into the object.
+      new FakeHttpRequest("Uri: "
+                          "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                          "path%2Fwriteable/compose\n"
+                          "Auth Token: fake_token\n"
+                          "Timeouts: 5 1 10\n"
+                          "Header content-type: application/json\n"
+                          "Post body: {'sourceObjects': [{'name': "
+                          "'path/.tmpcompose/writeable.part.0'},{'name': "
+                          "'path/.tmpcompose/writeable.part.1'},{'name': "
+                          "'path/.tmpcompose/writeable.part.2'}]}\n",
+                          ""),
+      // Delete the parts.
+      new FakeHttpRequest("Uri: "
+                          "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                          "path%2F.tmpcompose%2Fwriteable.part.0\n"
+                          "Auth Token: fake_token\n"
+                          "Timeouts: 5 1 10\n"
+                          "Delete: yes\n",
+                          ""),
+      new FakeHttpRequest("Uri: "
+                          "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                          "path%2F.tmpcompose%2Fwriteable.part.1\n"
+                          "Auth Token: fake_token\n"
+                          "Timeouts: 5 1 10\n"
+                          "Delete: yes\n",
+                          ""),
+      new FakeHttpRequest("Uri: "
+                          "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                          "path%2F.tmpcompose%2Fwriteable.part.2\n"
+                          "Auth Token: fake_token\n"
+                          "Timeouts: 5 1 10\n"
+                          "Delete: yes\n",
+                          "")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 8 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  // A single upload thread keeps the order of the requests deterministic.
+  fs.ConfigureParallelUploads(10 /* threshold bytes */, 8 /* part size bytes */,
+                              1 /* num threads */);
+
+  std::unique_ptr<WritableFile> wfile;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("gs://bucket/path/writeable", nullptr, &wfile));
+  TF_EXPECT_OK(wfile->Append("content1,"));
+  TF_EXPECT_OK(wfile->Append("content2"));
+  TF_EXPECT_OK(wfile->Close());
+}
+
 TEST(GcsFileSystemTest, NewWritableFile_ResumeUploadSucceeds) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
@@ -3694,6 +3864,24 @@ TEST(GcsFileSystemTest, OverrideCacheParameters) {
   EXPECT_EQ(20, fs5.timeouts().metadata);
   EXPECT_EQ(30, fs5.timeouts().read);
   EXPECT_EQ(40, fs5.timeouts().write);
+
+  // Verify parallel read overrides.
+  setenv("GCS_READ_PARALLELISM", "4", 1);
+  setenv("GCS_READ_MIN_CHUNK_SIZE_BYTES", "1048576", 1);
+  setenv("GCS_READAHEAD_MAX_BUFFER_SIZE_BYTES", "268435456", 1);
+  GcsFileSystem fs6;
+  EXPECT_EQ(4, fs6.read_parallelism());
+  EXPECT_EQ(1048576, fs6.read_min_chunk_size());
+  EXPECT_EQ(268435456, fs6.readahead_max_buffer_size());
+
+  // Verify parallel upload overrides.
+  setenv("GCS_PARALLEL_UPLOAD_THRESHOLD_BYTES", "1073741824", 1);
+  setenv("GCS_PARALLEL_UPLOAD_PART_SIZE_BYTES", "16777216", 1);
+  setenv("GCS_PARALLEL_UPLOAD_THREADS", "16", 1);
+  GcsFileSystem fs7;
+  EXPECT_EQ(1073741824, fs7.parallel_upload_threshold());
+  EXPECT_EQ(16777216, fs7.parallel_upload_part_size());
+  EXPECT_EQ(16, fs7.parallel_upload_threads());
 }
 
 TEST(GcsFileSystemTest, CreateHttpRequest) {
@@ -122,6 +122,11 @@ enum CPUFeature {
   AVX512IFMA = 35,     // Integer multiply-add
   AVX512_4VNNIW = 36,  // Integer neural network
   AVX512_4FMAPS = 37,  // Floating point neural network
+  AVX512_BF16 = 38,    // bfloat16 conversions and dot products
+
+  // Advanced Matrix Extensions, in Sapphire Rapids Xeon and later.
+  AMX_TILE = 39,  // Tile registers and loads/stores
+  AMX_BF16 = 40,  // bfloat16 tile matrix multiplication
 };
 
 // Checks whether the current processor supports one of the features above.
@@ -29,6 +29,10 @@ limitations under the License.
 #include <time.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+
 #include "tensorflow/core/platform/default/posix_file_system.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/error.h"
@@ -37,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 
 namespace tensorflow {
@@ -44,6 +49,37 @@ namespace tensorflow {
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
+// The environment variable that overrides how many reads issued through
+// RandomAccessFile::ReadAsync() the process keeps in flight. A value of 0 or
+// 1 issues them one after another on the calling thread.
+constexpr char kAsyncReadQueueDepth[] = "TF_POSIX_ASYNC_READ_QUEUE_DEPTH";
+constexpr int64 kDefaultAsyncReadQueueDepth = 16;
+
+// Returns the pool that serves ReadAsync() batches of all posix files, or
+// nullptr if batched reads are issued sequentially.
+static thread::ThreadPool* AsyncReadPool() {
+  static thread::ThreadPool* pool = []() -> thread::ThreadPool* {
+    int64 queue_depth = kDefaultAsyncReadQueueDepth;
+    const char* env_value = std::getenv(kAsyncReadQueueDepth);
+    if (env_value != nullptr) {
+      char* end = nullptr;
+      const int64 value = std::strtoll(env_value, &end, 10);
+      if (end != env_value && *end == '\0') {
+        queue_depth = value;
+      } else {
+        LOG(WARNING) << "Ignoring invalid " << kAsyncReadQueueDepth << ": "
+                     << env_value;
+      }
+    }
+    if (queue_depth <= 1) {
+      return nullptr;
+    }
+    return new thread::ThreadPool(Env::Default(), "posix_async_read",
+                                  queue_depth);
+  }();
+  return pool;
+}
+
 // pread() based random-access
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
@@ -122,6 +158,39 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 #endif
+
+  // Keeps up to TF_POSIX_ASYNC_READ_QUEUE_DEPTH preads in flight, shared by
+  // all files, so a batch keeps the device busy without a thread per reader.
+  void ReadAsync(std::vector<ReadRequest>* requests,
+                 std::function<void()> done) const override {
+    thread::ThreadPool* pool = AsyncReadPool();
+    if (pool == nullptr || requests->size() <= 1) {
+      RandomAccessFile::ReadAsync(requests, std::move(done));
+      return;
+    }
+    // The last read to complete calls `done`.
+    struct Batch {
+      std::atomic<size_t> pending;
+      std::function<void()> done;
+    };
+    // `requests` may be gone as soon as the last read completes, so the loop
+    // does not touch it after scheduling.
+    ReadRequest* const batch_requests = requests->data();
+    const size_t num_requests = requests->size();
+    auto batch = std::make_shared<Batch>();
+    batch->pending = num_requests;
+    batch->done = std::move(done);
+    for (size_t i = 0; i < num_requests; ++i) {
+      ReadRequest& request = batch_requests[i];
+      pool->Schedule([this, &request, batch]() {
+        request.status =
+            Read(request.offset, request.n, &request.result, request.scratch);
+        if (batch->pending.fetch_sub(1) == 1) {
+          batch->done();
+        }
+      });
+    }
+  }
 };
 
 class PosixWritableFile : public WritableFile {
@@ -497,6 +497,24 @@ Status WriteStringToFile(Env* env, const string& fname,
   return s;
 }
 
+Status AtomicWriteStringToFile(Env* env, const string& fname,
+                               const StringPiece& data) {
+  string tmp_fname = fname;
+  if (!env->CreateUniqueFileName(&tmp_fname, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            fname);
+  }
+  Status s = WriteStringToFile(env, tmp_fname, data);
+  if (s.ok()) {
+    s = env->RenameFile(tmp_fname, fname);
+  }
+  if (!s.ok()) {
+    // The temporary file may not exist if its creation failed.
+    env->DeleteFile(tmp_fname).IgnoreError();
+  }
+  return s;
+}
+
 Status FileSystemCopyFile(FileSystem* src_fs, const string& src,
                           FileSystem* target_fs, const string& target) {
   std::unique_ptr<RandomAccessFile> src_file;
@@ -573,6 +591,13 @@ Status WriteBinaryProto(Env* env, const string& fname,
   return WriteStringToFile(env, fname, serialized);
 }
 
+Status AtomicWriteBinaryProto(Env* env, const string& fname,
+                              const protobuf::MessageLite& proto) {
+  string serialized;
+  proto.AppendToString(&serialized);
+  return AtomicWriteStringToFile(env, fname, serialized);
+}
+
 Status ReadBinaryProto(Env* env, const string& fname,
                        protobuf::MessageLite* proto) {
   std::unique_ptr<RandomAccessFile> file;
@@ -597,6 +622,15 @@ Status WriteTextProto(Env* env, const string& fname,
   return WriteStringToFile(env, fname, serialized);
 }
 
+Status AtomicWriteTextProto(Env* env, const string& fname,
+                            const protobuf::Message& proto) {
+  string serialized;
+  if (!protobuf::TextFormat::PrintToString(proto, &serialized)) {
+    return errors::FailedPrecondition("Unable to convert proto to text.");
+  }
+  return AtomicWriteStringToFile(env, fname, serialized);
+}
+
 Status ReadTextProto(Env* env, const string& fname, protobuf::Message* proto) {
   std::unique_ptr<RandomAccessFile> file;
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(fname, &file));
@@ -607,10 +607,20 @@ Status ReadFileToString(Env* env, const std::string& fname, std::string* data);
 Status WriteStringToFile(Env* env, const std::string& fname,
                          const StringPiece& data);
 
+/// A utility routine: write contents of `data` to a uniquely named temporary
+/// file next to `fname`, then rename it to `fname`, so that concurrent readers
+/// never see a partially written file. The temporary file is deleted on error.
+Status AtomicWriteStringToFile(Env* env, const std::string& fname,
+                               const StringPiece& data);
+
 /// Write binary representation of "proto" to the named file.
 Status WriteBinaryProto(Env* env, const std::string& fname,
                         const protobuf::MessageLite& proto);
 
+/// Like WriteBinaryProto, but writes through AtomicWriteStringToFile.
+Status AtomicWriteBinaryProto(Env* env, const std::string& fname,
+                              const protobuf::MessageLite& proto);
+
 /// Reads contents of named file and parse as binary encoded proto data
 /// and store into `*proto`.
 Status ReadBinaryProto(Env* env, const std::string& fname,
@@ -624,6 +634,15 @@ inline Status WriteTextProto(Env* /* env */, const std::string& /* fname */,
 Status WriteTextProto(Env* env, const std::string& fname,
                       const protobuf::Message& proto);
 
+/// Like WriteTextProto, but writes through AtomicWriteStringToFile.
+inline Status AtomicWriteTextProto(Env* /* env */,
+                                   const std::string& /* fname */,
+                                   const protobuf::MessageLite& /* proto */) {
+  return errors::Unimplemented("Can't write text protos with protolite.");
+}
+Status AtomicWriteTextProto(Env* env, const std::string& fname,
+                            const protobuf::Message& proto);
+
 /// Read contents of named file and parse as text encoded proto data
 /// and store into `*proto`.
 inline Status ReadTextProto(Env* /* env */, const std::string& /* fname */,
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/cord.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/null_file_system.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -90,6 +91,32 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadAsync) {
+  const string filename = io::JoinPath(BaseDir(), "read_async");
+  const string input = CreateTestFile(env_, filename, 100);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  char scratch[4][30];
+  std::vector<RandomAccessFile::ReadRequest> requests(4);
+  for (int i = 0; i < 4; ++i) {
+    requests[i].offset = i * 30;
+    requests[i].n = 30;
+    requests[i].scratch = scratch[i];
+  }
+  Notification done;
+  f->ReadAsync(&requests, [&done]() { done.Notify(); });
+  done.WaitForNotification();
+
+  for (int i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(requests[i].status);
+    EXPECT_EQ(input.substr(i * 30, 30), requests[i].result);
+  }
+  // The last read ends past EOF.
+  EXPECT_EQ(error::OUT_OF_RANGE, requests[3].status.code());
+  EXPECT_EQ(input.substr(90), requests[3].result);
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
@@ -151,6 +178,39 @@ TEST_F(DefaultEnvTest, ReadWriteTextProto) {
   EXPECT_EQ(result2.DebugString(), proto.DebugString());
 }
 
+TEST_F(DefaultEnvTest, AtomicWriteBinaryProto) {
+  const GraphDef proto = CreateTestProto();
+  const string dir = io::JoinPath(BaseDir(), "atomic");
+  TF_EXPECT_OK(env_->CreateDir(dir));
+  const string filename = io::JoinPath(dir, "binary_proto");
+  CreateTestFile(env_, filename, 100);
+
+  // Replaces the existing file.
+  TF_EXPECT_OK(AtomicWriteBinaryProto(env_, filename, proto));
+  GraphDef result;
+  TF_EXPECT_OK(ReadBinaryProto(env_, filename, &result));
+  EXPECT_EQ(result.DebugString(), proto.DebugString());
+
+  // No temporary file is left behind.
+  std::vector<string> children;
+  TF_EXPECT_OK(env_->GetChildren(dir, &children));
+  EXPECT_EQ(children, std::vector<string>({"binary_proto"}));
+}
+
+TEST_F(DefaultEnvTest, AtomicWriteStringToFileDeletesTemporaryFileOnError) {
+  const string dir = io::JoinPath(BaseDir(), "atomic");
+  TF_EXPECT_OK(env_->CreateDir(dir));
+  // A file can't be renamed over a non-empty directory.
+  const string target = io::JoinPath(dir, "target");
+  TF_EXPECT_OK(env_->CreateDir(target));
+  CreateTestFile(env_, io::JoinPath(target, "file"), 100);
+
+  EXPECT_FALSE(AtomicWriteStringToFile(env_, target, "contents").ok());
+  std::vector<string> children;
+  TF_EXPECT_OK(env_->GetChildren(dir, &children));
+  EXPECT_EQ(children, std::vector<string>({"target"}));
+}
+
 TEST_F(DefaultEnvTest, FileToReadonlyMemoryRegion) {
   for (const int length : {1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1}) {
@@ -779,6 +779,33 @@ class RandomAccessFile {
   }
 #endif
 
+  /// \brief One read of a batch passed to `ReadAsync`.
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    /// Holds at least `n` bytes. Not owned.
+    char* scratch = nullptr;
+    /// Set when the read completes, as by `Read(offset, n, &result, scratch)`.
+    StringPiece result;
+    tensorflow::Status status;
+  };
+
+  /// \brief Issues every read of `requests` and calls `done` once all of them
+  /// have completed.
+  ///
+  /// Implementations may keep several of the reads in flight at once and may
+  /// call `done` from another thread, so `requests` and this file must stay
+  /// live until `done` runs. The default implementation issues the reads one
+  /// after another with `Read` and calls `done` before returning.
+  virtual void ReadAsync(std::vector<ReadRequest>* requests,
+                         std::function<void()> done) const {
+    for (ReadRequest& request : *requests) {
+      request.status =
+          Read(request.offset, request.n, &request.result, request.scratch);
+    }
+    done();
+  }
+
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(RandomAccessFile);
 };
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PROFILER_CONVERT_OP_METRICS_TO_RECORD_H_
 #define TENSORFLOW_CORE_PROFILER_CONVERT_OP_METRICS_TO_RECORD_H_
 
+#include <algorithm>
 #include <vector>
 
 #include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
@@ -99,6 +100,27 @@ inline void SetRooflineMetrics(const OpMetrics& metrics,
                            : ((metrics.flops() != 0) ? "Compute" : "Unknown"));
 }
 
+// Must be called after SetRooflineMetrics. The peaks are in GFLOP/s and GB/s,
+// the units of measured_flop_rate and measured_memory_bw. Below the ridge
+// point the roofline is operational_intensity * peak bandwidth, so the
+// efficiency of memory-bound ops is their fraction of the peak bandwidth.
+template <typename Record>
+inline void SetRooflineEfficiency(double peak_giga_flops_per_second,
+                                  double peak_giga_bytes_per_second,
+                                  Record* record) {
+  if (record->bound_by() == "Compute") {
+    record->set_roofline_efficiency(std::min(
+        1.0,
+        SafeDivide(record->measured_flop_rate(), peak_giga_flops_per_second)));
+  } else if (record->bound_by() == "Memory") {
+    record->set_roofline_efficiency(std::min(
+        1.0, SafeDivide(record->measured_memory_bw(),
+                        peak_giga_bytes_per_second)));
+  } else {
+    record->set_roofline_efficiency(0.0);
+  }
+}
+
 }  // namespace profiler
 }  // namespace tensorflow
 
@@ -24,6 +24,10 @@ namespace profiler {
 
 TfStatsDatabase ConvertOpStatsToTfStats(const OpStats& op_stats);
 
+// Ranks the device TF operations by the time they would save if they ran at
+// the roofline of the device described by op_stats.perf_env().
+RooflineModel ConvertOpStatsToRooflineModel(const OpStats& op_stats);
+
 }  // namespace profiler
 }  // namespace tensorflow
 
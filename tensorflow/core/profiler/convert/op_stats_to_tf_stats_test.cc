@@ -159,6 +159,49 @@ occ_pct:100)MULTI";
             record_2.total_self_time_in_us());
 }
 
+TEST(OpStatsToTfStats, RooflineModel) {
+  OpStats op_stats;
+  // 1 TFLOP/s and 100 GB/s, so the ridge point is 10 FLOP/Byte.
+  *op_stats.mutable_perf_env() = MakePerfEnv(1, 100);
+  OpMetricsDb* db = op_stats.mutable_device_op_metrics_db();
+  // Compute bound, 500 GFLOP/s.
+  OpMetrics* matmul = db->add_metrics_db();
+  matmul->set_name("fusion.1");
+  matmul->set_provenance("MatMul:MatMul");
+  matmul->set_occurrences(1);
+  matmul->set_time_ps(1000000);
+  matmul->set_self_time_ps(1000000);
+  matmul->set_flops(500000);
+  matmul->set_bytes_accessed(1000);
+  // Memory bound, 50 GB/s.
+  OpMetrics* add = db->add_metrics_db();
+  add->set_name("fusion.2");
+  add->set_provenance("Add:AddV2");
+  add->set_occurrences(1);
+  add->set_time_ps(2000000);
+  add->set_self_time_ps(2000000);
+  add->set_flops(2000);
+  add->set_bytes_accessed(100000);
+  db->set_total_op_time_ps(3000000);
+  db->set_total_time_ps(3000000);
+
+  const RooflineModel roofline_model = ConvertOpStatsToRooflineModel(op_stats);
+
+  EXPECT_DOUBLE_EQ(10, roofline_model.ridge_point());
+  ASSERT_EQ(2, roofline_model.tf_stats_record_size());
+  // Add has more time to gain (1 us) than MatMul (0.5 us).
+  const TfStatsRecord& add_record = roofline_model.tf_stats_record(0);
+  EXPECT_EQ("Add", add_record.op_name());
+  EXPECT_EQ(1, add_record.rank());
+  EXPECT_EQ("Memory", add_record.bound_by());
+  EXPECT_DOUBLE_EQ(0.5, add_record.roofline_efficiency());
+  const TfStatsRecord& matmul_record = roofline_model.tf_stats_record(1);
+  EXPECT_EQ("MatMul", matmul_record.op_name());
+  EXPECT_EQ(2, matmul_record.rank());
+  EXPECT_EQ("Compute", matmul_record.bound_by());
+  EXPECT_DOUBLE_EQ(0.5, matmul_record.roofline_efficiency());
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -54,6 +54,12 @@ void PostProcessSingleHostXSpace(XSpace* space, uint64 start_time_ns) {
   GroupTfEvents(space, &event_forest);
   // 5. Generated miscellaneous derived time lines for device planes.
   GenerateDerivedTimeLines(event_forest.GetGroupMetadataMap(), space);
+  // 6. Derive the stream occupancy of device planes from their activities and
+  // the kernel launches on the host.
+  const XPlane* host_plane = FindPlaneWithName(*space, kHostThreadsPlaneName);
+  for (XPlane* plane : FindMutablePlanesWithPrefix(space, kGpuPlanePrefix)) {
+    DeriveStreamOccupancyFromTraces(host_plane, plane);
+  }
 }
 
 }  // namespace profiler
@@ -0,0 +1,165 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/step_stats_to_critical_path.h"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/graph_view.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+int64 DurationNs(const NodeExecStats& node_stats) {
+  if (node_stats.all_end_rel_nanos() > 0) {
+    return node_stats.all_end_rel_nanos();
+  }
+  return node_stats.all_end_rel_micros() * 1000;
+}
+
+}  // namespace
+
+Status ConvertStepStatsToCriticalPath(const GraphDef& graph,
+                                      const StepStats& step_stats,
+                                      CriticalPath* critical_path) {
+  const int num_nodes = graph.node_size();
+  absl::flat_hash_map<std::string, int> node_ids;
+  for (int i = 0; i < num_nodes; ++i) {
+    node_ids[graph.node(i).name()] = i;
+  }
+
+  // Nodes may run on several devices or several times per step, e.g. in
+  // loops, so their durations add up.
+  std::vector<int64> durations(num_nodes, 0);
+  for (const DeviceStepStats& dev_stats : step_stats.dev_stats()) {
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      auto it = node_ids.find(node_stats.node_name());
+      if (it != node_ids.end()) durations[it->second] += DurationNs(node_stats);
+    }
+  }
+
+  std::vector<std::vector<int>> inputs(num_nodes);
+  std::vector<std::vector<int>> outputs(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    for (const std::string& input : graph.node(i).input()) {
+      auto it = node_ids.find(ParseTensorName(input).node());
+      if (it == node_ids.end()) {
+        return errors::InvalidArgument("Node ", graph.node(i).name(),
+                                       " has unknown input ", input);
+      }
+      if (graph.node(it->second).op() == "NextIteration") continue;
+      inputs[i].push_back(it->second);
+      outputs[it->second].push_back(i);
+    }
+  }
+
+  // Topological order.
+  std::vector<int> order;
+  order.reserve(num_nodes);
+  std::vector<int> pending(num_nodes);
+  std::deque<int> ready;
+  for (int i = 0; i < num_nodes; ++i) {
+    pending[i] = inputs[i].size();
+    if (pending[i] == 0) ready.push_back(i);
+  }
+  while (!ready.empty()) {
+    const int id = ready.front();
+    ready.pop_front();
+    order.push_back(id);
+    for (int output : outputs[id]) {
+      if (--pending[output] == 0) ready.push_back(output);
+    }
+  }
+  if (order.size() != static_cast<size_t>(num_nodes)) {
+    return errors::InvalidArgument("Graph has a cycle");
+  }
+
+  // Earliest finish times, and the input each node waited for last.
+  std::vector<int64> earliest_finish(num_nodes, 0);
+  std::vector<int> last_input(num_nodes, -1);
+  int last_node = -1;
+  for (int id : order) {
+    int64 earliest_start = 0;
+    for (int input : inputs[id]) {
+      if (earliest_finish[input] > earliest_start || last_input[id] == -1) {
+        earliest_start = std::max(earliest_start, earliest_finish[input]);
+        last_input[id] = input;
+      }
+    }
+    earliest_finish[id] = earliest_start + durations[id];
+    if (last_node == -1 || earliest_finish[id] > earliest_finish[last_node]) {
+      last_node = id;
+    }
+  }
+  const int64 length_ns = last_node == -1 ? 0 : earliest_finish[last_node];
+
+  // Latest finish times that do not delay the step.
+  std::vector<int64> latest_finish(num_nodes, length_ns);
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    for (int output : outputs[*it]) {
+      latest_finish[*it] = std::min(latest_finish[*it],
+                                    latest_finish[output] - durations[output]);
+    }
+  }
+
+  critical_path->length_ns = length_ns;
+  critical_path->path.clear();
+  for (int id = last_node; id != -1; id = last_input[id]) {
+    critical_path->path.push_back(graph.node(id).name());
+  }
+  std::reverse(critical_path->path.begin(), critical_path->path.end());
+  critical_path->nodes.clear();
+  critical_path->nodes.reserve(num_nodes);
+  for (int id : order) {
+    NodeCriticalPathStats stats;
+    stats.node_name = graph.node(id).name();
+    stats.duration_ns = durations[id];
+    stats.earliest_start_ns = earliest_finish[id] - durations[id];
+    stats.slack_ns = latest_finish[id] - earliest_finish[id];
+    stats.is_critical = stats.slack_ns == 0 && stats.duration_ns > 0;
+    critical_path->nodes.push_back(std::move(stats));
+  }
+  return Status::OK();
+}
+
+void SetCriticalPathPriorities(const CriticalPath& critical_path, int priority,
+                               GraphDef* graph) {
+  absl::flat_hash_map<std::string, NodeDef*> nodes;
+  for (NodeDef& node : *graph->mutable_node()) {
+    nodes[node.name()] = &node;
+  }
+  for (const NodeCriticalPathStats& stats : critical_path.nodes) {
+    if (!stats.is_critical) continue;
+    auto it = nodes.find(stats.node_name);
+    if (it == nodes.end()) continue;
+    (*it->second->mutable_attr())[kExecutorPriorityAttr].set_i(priority);
+  }
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
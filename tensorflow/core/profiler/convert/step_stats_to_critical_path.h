@@ -0,0 +1,73 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_CONVERT_STEP_STATS_TO_CRITICAL_PATH_H_
+#define TENSORFLOW_CORE_PROFILER_CONVERT_STEP_STATS_TO_CRITICAL_PATH_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace profiler {
+
+struct NodeCriticalPathStats {
+  std::string node_name;
+  // Total time the node executed during the step.
+  int64 duration_ns = 0;
+  // Earliest time the node can start given its inputs, if every node takes
+  // its measured duration and starts as soon as its inputs are ready.
+  int64 earliest_start_ns = 0;
+  // How much the node can be delayed without delaying the step.
+  int64 slack_ns = 0;
+  // True if the node has no slack and a non-zero duration, i.e. speeding it
+  // up may shrink the step.
+  bool is_critical = false;
+};
+
+struct CriticalPath {
+  // Length of the longest path through the graph.
+  int64 length_ns = 0;
+  // Names of the nodes on one longest path, in execution order.
+  std::vector<std::string> path;
+  // Stats of all nodes of the graph, in topological order.
+  std::vector<NodeCriticalPathStats> nodes;
+};
+
+// Computes the critical path of a step from the dependencies in `graph` and
+// the node durations in `step_stats`. Nodes absent from `step_stats` take no
+// time, and NextIteration back edges are ignored.
+//
+// This uses measured durations on an idealized schedule: it does not model
+// contention for threads or devices, so nodes that only waited for a busy
+// resource appear to have slack.
+Status ConvertStepStatsToCriticalPath(const GraphDef& graph,
+                                      const StepStats& step_stats,
+                                      CriticalPath* critical_path);
+
+// Raises the executor scheduling priority (see kExecutorPriorityAttr) of the
+// critical nodes of `graph` to `priority`, so the executor dispatches them
+// before other nodes that become ready at the same time.
+void SetCriticalPathPriorities(const CriticalPath& critical_path, int priority,
+                               GraphDef* graph);
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_CONVERT_STEP_STATS_TO_CRITICAL_PATH_H_
@@ -0,0 +1,133 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/step_stats_to_critical_path.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/graph_view.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+using ::testing::ElementsAre;
+
+void AddNode(const std::string& name, const std::string& op,
+             const std::vector<std::string>& inputs, GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op(op);
+  for (const std::string& input : inputs) node->add_input(input);
+}
+
+void AddNodeStats(const std::string& name, int64 duration_us,
+                  StepStats* step_stats) {
+  if (step_stats->dev_stats_size() == 0) step_stats->add_dev_stats();
+  NodeExecStats* node_stats =
+      step_stats->mutable_dev_stats(0)->add_node_stats();
+  node_stats->set_node_name(name);
+  node_stats->set_all_end_rel_micros(duration_us);
+}
+
+// a -> b -> d and a -> c -> d, where b is slower than c.
+void BuildDiamond(GraphDef* graph, StepStats* step_stats) {
+  AddNode("a", "Const", {}, graph);
+  AddNode("b", "Foo", {"a"}, graph);
+  AddNode("c", "Foo", {"a:1"}, graph);
+  AddNode("d", "Bar", {"b", "^c"}, graph);
+  AddNodeStats("a", 1, step_stats);
+  AddNodeStats("b", 5, step_stats);
+  AddNodeStats("c", 2, step_stats);
+  AddNodeStats("d", 1, step_stats);
+}
+
+TEST(StepStatsToCriticalPathTest, Diamond) {
+  GraphDef graph;
+  StepStats step_stats;
+  BuildDiamond(&graph, &step_stats);
+
+  CriticalPath critical_path;
+  TF_ASSERT_OK(
+      ConvertStepStatsToCriticalPath(graph, step_stats, &critical_path));
+  EXPECT_EQ(critical_path.length_ns, 7000);
+  EXPECT_THAT(critical_path.path, ElementsAre("a", "b", "d"));
+  ASSERT_EQ(critical_path.nodes.size(), 4);
+  for (const NodeCriticalPathStats& stats : critical_path.nodes) {
+    if (stats.node_name == "c") {
+      EXPECT_EQ(stats.earliest_start_ns, 1000);
+      EXPECT_EQ(stats.slack_ns, 3000);
+      EXPECT_FALSE(stats.is_critical);
+    } else {
+      EXPECT_EQ(stats.slack_ns, 0);
+      EXPECT_TRUE(stats.is_critical);
+    }
+  }
+}
+
+TEST(StepStatsToCriticalPathTest, IgnoresNextIterationBackEdge) {
+  GraphDef graph;
+  AddNode("enter", "Enter", {}, &graph);
+  AddNode("merge", "Merge", {"enter", "next"}, &graph);
+  AddNode("body", "Foo", {"merge"}, &graph);
+  AddNode("next", "NextIteration", {"body"}, &graph);
+  StepStats step_stats;
+  AddNodeStats("body", 3, &step_stats);
+  AddNodeStats("body", 3, &step_stats);
+
+  CriticalPath critical_path;
+  TF_ASSERT_OK(
+      ConvertStepStatsToCriticalPath(graph, step_stats, &critical_path));
+  EXPECT_EQ(critical_path.length_ns, 6000);
+}
+
+TEST(StepStatsToCriticalPathTest, UnknownInput) {
+  GraphDef graph;
+  AddNode("a", "Foo", {"missing"}, &graph);
+  CriticalPath critical_path;
+  EXPECT_FALSE(
+      ConvertStepStatsToCriticalPath(graph, StepStats(), &critical_path).ok());
+}
+
+TEST(StepStatsToCriticalPathTest, SetCriticalPathPriorities) {
+  GraphDef graph;
+  StepStats step_stats;
+  BuildDiamond(&graph, &step_stats);
+  CriticalPath critical_path;
+  TF_ASSERT_OK(
+      ConvertStepStatsToCriticalPath(graph, step_stats, &critical_path));
+
+  SetCriticalPathPriorities(critical_path, /*priority=*/2, &graph);
+  for (const NodeDef& node : graph.node()) {
+    auto it = node.attr().find(kExecutorPriorityAttr);
+    if (node.name() == "c") {
+      EXPECT_TRUE(it == node.attr().end());
+    } else {
+      ASSERT_TRUE(it != node.attr().end());
+      EXPECT_EQ(it->second.i(), 2);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/xplane_to_tf_data_stats.h"
 
+#include <cmath>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/profiler/protobuf/tf_data_stats.pb.h"
@@ -27,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/utils/html_utils.h"
 #include "tensorflow/core/profiler/utils/tf_op_utils.h"
 #include "tensorflow/core/profiler/utils/tf_xplane_visitor.h"
+#include "tensorflow/core/profiler/utils/time_utils.h"
 #include "tensorflow/core/profiler/utils/timespan.h"
 #include "tensorflow/core/profiler/utils/xplane_schema.h"
 #include "tensorflow/core/profiler/utils/xplane_visitor.h"
@@ -202,6 +206,16 @@ void SetBottleneckIteratorId(InputPipelineStat* input_pipeline_stat) {
   input_pipeline_stat->set_bottleneck_iterator_latency_ps(max_self_time);
 }
 
+// Returns the nearest-rank `quantile` of the durations of `events`, which are
+// sorted by decreasing duration.
+int64 LatencyQuantilePs(const std::vector<EventNode*>& events,
+                        double quantile) {
+  if (events.empty()) return 0;
+  const int64 rank = std::ceil(quantile * events.size());
+  const int64 index = events.size() - std::max<int64>(rank, 1);
+  return events[index]->GetEventVisitor().DurationPs();
+}
+
 void ProcessInputPipelines(
     const absl::flat_hash_set<int64>& device_input_pipeline_ids,
     absl::flat_hash_map<int64, std::vector<EventNode*>>*
@@ -250,6 +264,12 @@ void ProcessInputPipelines(
     input_pipeline_stats.set_min_latency_ps(min_latency_ps);
     input_pipeline_stats.set_max_latency_ps(max_latency_ps);
     input_pipeline_stats.set_num_slow_calls(num_slow_calls);
+    input_pipeline_stats.set_p50_latency_ps(
+        LatencyQuantilePs(root_iterator_events, 0.5));
+    input_pipeline_stats.set_p90_latency_ps(
+        LatencyQuantilePs(root_iterator_events, 0.9));
+    input_pipeline_stats.set_p99_latency_ps(
+        LatencyQuantilePs(root_iterator_events, 0.99));
   }
 }
 
@@ -322,7 +342,11 @@ void SetBottleneckAnalysis(CombinedTfDataStats* combined_tf_data_stats) {
   }
 }
 
-std::string GetSuggestion(BottleneckType type) {
+// `data_service_worker_bottleneck` is the slowest input pipeline found on a
+// tf.data service worker, or nullptr if no worker was profiled.
+std::string GetSuggestion(
+    BottleneckType type,
+    const TfDataBottleneckAnalysis* data_service_worker_bottleneck) {
   constexpr absl::string_view kPlaybookLink =
       "https://www.tensorflow.org/guide/data_performance_analysis";
   constexpr absl::string_view kPlaybookSourceDatasetLink =
@@ -356,6 +380,21 @@ std::string GetSuggestion(BottleneckType type) {
           AnchorElement(kPlaybookSourceDatasetLink, "here"),
           AnchorElement(kTfGuideParallelDataExtractionLink, "here"));
     case BottleneckType::kSlowDataService:
+      if (data_service_worker_bottleneck != nullptr) {
+        return absl::StrFormat(
+            "1. Fetching data from tf.data service took a while. The slowest "
+            "tf.data service worker input pipeline in this profile is %s on "
+            "%s (max latency %.1f us), bottlenecked by <code>%s</code>. See "
+            "the suggestion for that input pipeline.<br/>"
+            "2. See %s for more details on tf.data service.<br/>"
+            "3. See %s for other suggestions.",
+            data_service_worker_bottleneck->input_pipeline(),
+            data_service_worker_bottleneck->host(),
+            PicosToMicros(data_service_worker_bottleneck->max_latency_ps()),
+            data_service_worker_bottleneck->iterator_long_name(),
+            AnchorElement(kTfDataServiceLink, "this"),
+            AnchorElement(kPlaybookLink, "this"));
+      }
       return absl::StrFormat(
           "1. Fetching data from tf.data service took a while. Profile the "
           "tf.data service worker to analyze the issue further.<br/>"
@@ -402,11 +441,55 @@ std::string GetSuggestion(BottleneckType type) {
   }
 }
 
+// Returns true if any input pipeline of the host reads from tf.data service.
+bool ReadsFromDataService(const TfDataStats& tf_data_stats) {
+  for (const auto& id_and_metadata : tf_data_stats.iterator_metadata()) {
+    if (GetBottleneckType(id_and_metadata.second.name()) ==
+        BottleneckType::kSlowDataService) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the slowest bottleneck on a host that does not read from tf.data
+// service, if any host does. In a profile captured from both the trainers and
+// the tf.data service workers, such hosts are the workers, so this is where
+// the time spent waiting for tf.data service goes.
+const TfDataBottleneckAnalysis* FindDataServiceWorkerBottleneck(
+    const CombinedTfDataStats& combined_tf_data_stats) {
+  absl::flat_hash_set<absl::string_view> data_service_clients;
+  for (const auto& host_name_and_tf_data_stats :
+       combined_tf_data_stats.tf_data_stats()) {
+    if (ReadsFromDataService(host_name_and_tf_data_stats.second)) {
+      data_service_clients.insert(host_name_and_tf_data_stats.first);
+    }
+  }
+  if (data_service_clients.empty()) return nullptr;
+  // bottleneck_analysis is sorted by decreasing max_latency_ps.
+  for (const TfDataBottleneckAnalysis& bottleneck_analysis :
+       combined_tf_data_stats.bottleneck_analysis()) {
+    if (!data_service_clients.contains(bottleneck_analysis.host())) {
+      return &bottleneck_analysis;
+    }
+  }
+  return nullptr;
+}
+
 void SetSuggestion(CombinedTfDataStats* combined_tf_data_stats) {
+  // Copied, as the suggestions of bottleneck_analysis are modified below.
+  absl::optional<TfDataBottleneckAnalysis> data_service_worker_bottleneck;
+  if (const TfDataBottleneckAnalysis* worker_bottleneck =
+          FindDataServiceWorkerBottleneck(*combined_tf_data_stats)) {
+    data_service_worker_bottleneck = *worker_bottleneck;
+  }
   for (TfDataBottleneckAnalysis& bottleneck_analysis :
        *combined_tf_data_stats->mutable_bottleneck_analysis()) {
-    bottleneck_analysis.set_suggestion(
-        GetSuggestion(GetBottleneckType(bottleneck_analysis.iterator_name())));
+    bottleneck_analysis.set_suggestion(GetSuggestion(
+        GetBottleneckType(bottleneck_analysis.iterator_name()),
+        data_service_worker_bottleneck.has_value()
+            ? &*data_service_worker_bottleneck
+            : nullptr));
   }
 }
 
@@ -118,6 +118,9 @@ TEST(XPlaneToTfDataStatsTest, HostInputPipeline) {
                 min_latency_ps: 20000000
                 max_latency_ps: 100000000
                 num_slow_calls: 1
+                p50_latency_ps: 20000000
+                p90_latency_ps: 100000000
+                p99_latency_ps: 100000000
                 stats {
                   bottleneck_iterator_id: 456
                   bottleneck_iterator_latency_ps: 80000000
@@ -244,6 +247,9 @@ TEST(XPlaneToTfDataStatsTest, DeviceInputPipeline) {
                 min_latency_ps: 30000000
                 max_latency_ps: 100000000
                 num_slow_calls: 1
+                p50_latency_ps: 30000000
+                p90_latency_ps: 100000000
+                p99_latency_ps: 100000000
                 stats {
                   bottleneck_iterator_id: 456
                   bottleneck_iterator_latency_ps: 80000000
@@ -376,6 +382,9 @@ TEST(XPlaneToTfDataStatsTest, MapAndBatch) {
                 min_latency_ps: 100000000
                 max_latency_ps: 100000000
                 num_slow_calls: 1
+                p50_latency_ps: 100000000
+                p90_latency_ps: 100000000
+                p99_latency_ps: 100000000
                 stats {
                   bottleneck_iterator_id: 456
                   bottleneck_iterator_latency_ps: 60000000
@@ -411,6 +420,40 @@ TEST(XPlaneToTfDataStatsTest, MapAndBatch) {
       )pb"));
 }
 
+// Tests a profile of a trainer reading from tf.data service together with the
+// tf.data service worker running the dataset.
+TEST(XPlaneToTfDataStatsTest, DataServiceWorkerBottleneck) {
+  XPlane trainer_plane;
+  XPlaneBuilder trainer_plane_builder(&trainer_plane);
+  XLineBuilder trainer_thread = trainer_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&trainer_plane_builder, &trainer_thread,
+               "Iterator::DataService", 0, 100000000,
+               {{StatType::kStepId, int64{123}}});
+
+  XPlane worker_plane;
+  XPlaneBuilder worker_plane_builder(&worker_plane);
+  XLineBuilder worker_thread = worker_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&worker_plane_builder, &worker_thread, "Iterator::Map", 0,
+               60000000, {{StatType::kStepId, int64{456}}});
+
+  CombinedTfDataStats combined_tf_data_stats;
+  CombinedTfDataStatsBuilder builder(&combined_tf_data_stats);
+  builder.Add("trainer", &trainer_plane);
+  builder.Add("worker", &worker_plane);
+  builder.Finalize();
+  ASSERT_EQ(combined_tf_data_stats.bottleneck_analysis_size(), 2);
+  const TfDataBottleneckAnalysis& trainer_bottleneck =
+      combined_tf_data_stats.bottleneck_analysis(0);
+  EXPECT_EQ(trainer_bottleneck.host(), "trainer");
+  EXPECT_EQ(trainer_bottleneck.iterator_name(), "DataService");
+  EXPECT_THAT(trainer_bottleneck.suggestion(),
+              ::testing::HasSubstr(
+                  "The slowest tf.data service worker input pipeline in this "
+                  "profile is Host:0 on worker (max latency 60.0 us), "
+                  "bottlenecked by <code>Iterator::Map</code>."));
+  EXPECT_EQ(combined_tf_data_stats.bottleneck_analysis(1).host(), "worker");
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -115,6 +115,23 @@ std::pair<std::string, bool> ConvertMultiXSpacesToTfStats(
       ConvertOpStatsToTfStats(combined_op_stats).SerializeAsString(), true);
 }
 
+std::pair<std::string, bool> ConvertMultiXSpacesToRooflineModel(
+    const std::vector<XSpace>& xspaces) {
+  OpStatsOptions options;
+  options.generate_op_metrics_db = true;
+  OpStats combined_op_stats;
+  Status status = ConvertMultiXSpacesToCombinedOpStats(xspaces, options,
+                                                       &combined_op_stats);
+  if (!status.ok()) {
+    LOG(WARNING) << "Could not generate OpStats for roofline model. Error: "
+                 << status.error_message();
+    return std::make_pair("", false);
+  }
+  return std::make_pair(
+      ConvertOpStatsToRooflineModel(combined_op_stats).SerializeAsString(),
+      true);
+}
+
 std::pair<std::string, bool> ConvertMultiXSpacesToKernelStats(
     const std::vector<XSpace>& xspaces) {
   OpStatsOptions options;
@@ -214,6 +231,8 @@ std::pair<std::string, bool> ConvertMultiXSpacesToToolData(
     return ConvertMultiXSpacesToInputPipeline(xspaces);
   } else if (tool_name == "tensorflow_stats") {
     return ConvertMultiXSpacesToTfStats(xspaces);
+  } else if (tool_name == "roofline_model") {
+    return ConvertMultiXSpacesToRooflineModel(xspaces);
   } else if (tool_name == "kernel_stats") {
     return ConvertMultiXSpacesToKernelStats(xspaces);
   } else if (tool_name == "memory_profile") {
@@ -0,0 +1,143 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/internal/cpu/traceme_flight_recorder.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/internal/cpu/host_tracer_utils.h"
+#include "tensorflow/core/profiler/internal/cpu/traceme_recorder.h"
+#include "tensorflow/core/profiler/lib/profiler_lock.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+
+/*static*/ TraceMeFlightRecorder* TraceMeFlightRecorder::Get() {
+  static TraceMeFlightRecorder* singleton = new TraceMeFlightRecorder;
+  return singleton;
+}
+
+Status TraceMeFlightRecorder::Start(const Options& options) {
+  if (options.max_events_per_thread == 0) {
+    return errors::InvalidArgument("max_events_per_thread must be positive");
+  }
+  if (options.flush_interval_ms <= 0) {
+    return errors::InvalidArgument("flush_interval_ms must be positive");
+  }
+  mutex_lock lock(mu_);
+  if (running_) {
+    return errors::AlreadyExists("TraceMe flight recorder already started");
+  }
+  if (!AcquireProfilerLock()) {
+    return errors::Unavailable("Another profiler session is active");
+  }
+  if (!TraceMeRecorder::Start(options.trace_level)) {
+    ReleaseProfilerLock();
+    return errors::Internal("Failed to start TraceMeRecorder");
+  }
+  options_ = options;
+  running_ = true;
+  threads_.clear();
+  flush_thread_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "traceme_flight_recorder", [this] { FlushLoop(); }));
+  return Status::OK();
+}
+
+void TraceMeFlightRecorder::Stop() {
+  std::unique_ptr<Thread> flush_thread;
+  {
+    mutex_lock lock(mu_);
+    if (!running_) return;
+    running_ = false;
+    flush_thread = std::move(flush_thread_);
+    flush_cv_.notify_all();
+  }
+  // Joins the flush thread, which needs mu_ to observe running_.
+  flush_thread.reset();
+  mutex_lock lock(mu_);
+  TraceMeRecorder::Stop();
+  ReleaseProfilerLock();
+  threads_.clear();
+}
+
+bool TraceMeFlightRecorder::IsRunning() {
+  mutex_lock lock(mu_);
+  return running_;
+}
+
+void TraceMeFlightRecorder::FlushLoop() {
+  mutex_lock lock(mu_);
+  while (running_) {
+    flush_cv_.wait_for(lock,
+                       std::chrono::milliseconds(options_.flush_interval_ms));
+    if (running_) Flush();
+  }
+}
+
+void TraceMeFlightRecorder::Flush() {
+  for (auto& thread : TraceMeRecorder::Collect()) {
+    auto& retained = threads_[thread.thread.tid];
+    retained.thread = std::move(thread.thread);
+    auto& events = retained.events;
+    events.insert(events.end(), std::make_move_iterator(thread.events.begin()),
+                  std::make_move_iterator(thread.events.end()));
+    const size_t max_events = options_.max_events_per_thread;
+    if (events.size() > max_events) {
+      events.erase(events.begin(), events.end() - max_events);
+    }
+  }
+}
+
+Status TraceMeFlightRecorder::CollectData(XSpace* space) {
+  TraceMeRecorder::Events events;
+  {
+    mutex_lock lock(mu_);
+    if (!running_) {
+      return errors::FailedPrecondition("TraceMe flight recorder not started");
+    }
+    Flush();
+    events.reserve(threads_.size());
+    for (const auto& tid_and_events : threads_) {
+      events.push_back(tid_and_events.second);
+    }
+  }
+  // Events are sorted by end time, so the earliest start may be anywhere.
+  uint64 start_timestamp_ns = kuint64max;
+  for (const auto& thread : events) {
+    for (const auto& event : thread.events) {
+      if (event.IsComplete()) {
+        start_timestamp_ns =
+            std::min(start_timestamp_ns, static_cast<uint64>(event.start_time));
+      }
+    }
+  }
+  if (start_timestamp_ns == kuint64max) return Status::OK();
+  XPlane* plane = FindOrAddMutablePlaneWithName(space, kHostThreadsPlaneName);
+  ConvertCompleteEventsToXPlane(start_timestamp_ns, std::move(events), plane);
+  return Status::OK();
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,97 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_INTERNAL_CPU_TRACEME_FLIGHT_RECORDER_H_
+#define TENSORFLOW_CORE_PROFILER_INTERNAL_CPU_TRACEME_FLIGHT_RECORDER_H_
+
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/internal/cpu/traceme_recorder.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// TraceMeFlightRecorder keeps TraceMeRecorder running continuously and retains
+// only the most recent events of each thread, so that the moments leading up
+// to an intermittent problem (e.g. a latency spike) can be dumped after the
+// fact instead of having to be reproduced under a ProfilerSession.
+//
+// A background thread drains TraceMeRecorder every flush_interval_ms into
+// per-thread ring buffers holding at most max_events_per_thread events, so
+// memory is bounded by the ring buffers plus one interval worth of events.
+// The recording overhead is that of TraceMe at the chosen trace_level.
+// TraceMe::ActivityStart/ActivityEnd pairs spanning a flush are dropped.
+//
+// While running, the flight recorder holds the profiler lock, so no
+// ProfilerSession can be started concurrently.
+class TraceMeFlightRecorder {
+ public:
+  struct Options {
+    // Only TraceMes with level <= trace_level are recorded.
+    int trace_level = 1;
+    // Number of most recent events retained per thread.
+    size_t max_events_per_thread = 1 << 16;
+    // How often events are moved from TraceMeRecorder to the ring buffers.
+    int64 flush_interval_ms = 100;
+  };
+
+  // Returns the process-wide flight recorder.
+  static TraceMeFlightRecorder* Get();
+
+  // Starts recording. Fails if the flight recorder or another profiler session
+  // is already active.
+  Status Start(const Options& options);
+
+  // Stops recording and discards the retained events.
+  void Stop();
+
+  bool IsRunning();
+
+  // Adds the retained events to the host threads plane of `space`, without
+  // stopping recording.
+  Status CollectData(XSpace* space);
+
+ private:
+  TraceMeFlightRecorder() = default;
+
+  // Body of flush_thread_.
+  void FlushLoop();
+
+  // Moves events from TraceMeRecorder into the ring buffers.
+  void Flush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutex mu_;
+  condition_variable flush_cv_;
+  Options options_ TF_GUARDED_BY(mu_);
+  bool running_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> flush_thread_ TF_GUARDED_BY(mu_);
+  // Ring buffers of the most recent events, keyed by thread id.
+  absl::flat_hash_map<uint32, TraceMeRecorder::ThreadEvents> threads_
+      TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(TraceMeFlightRecorder);
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_INTERNAL_CPU_TRACEME_FLIGHT_RECORDER_H_
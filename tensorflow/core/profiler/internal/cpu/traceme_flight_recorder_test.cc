@@ -0,0 +1,75 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/internal/cpu/traceme_flight_recorder.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/internal/cpu/traceme_recorder.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/time_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+TEST(TraceMeFlightRecorderTest, RetainsMostRecentEvents) {
+  TraceMeFlightRecorder* recorder = TraceMeFlightRecorder::Get();
+  TraceMeFlightRecorder::Options options;
+  options.max_events_per_thread = 2;
+  TF_ASSERT_OK(recorder->Start(options));
+  EXPECT_TRUE(recorder->IsRunning());
+  EXPECT_TRUE(errors::IsAlreadyExists(recorder->Start(options)));
+
+  int64 start_time = GetCurrentTimeNanos();
+  for (int i = 0; i < 5; ++i) {
+    TraceMeRecorder::Record({absl::StrCat("event", i), start_time + i,
+                             start_time + i + 1});
+  }
+
+  XSpace space;
+  TF_ASSERT_OK(recorder->CollectData(&space));
+  // Collecting does not stop recording.
+  EXPECT_TRUE(recorder->IsRunning());
+  recorder->Stop();
+  EXPECT_FALSE(recorder->IsRunning());
+  EXPECT_TRUE(errors::IsFailedPrecondition(recorder->CollectData(&space)));
+
+  ASSERT_EQ(space.planes_size(), 1);
+  const XPlane& plane = space.planes(0);
+  ASSERT_EQ(plane.lines_size(), 1);
+  const XLine& line = plane.lines(0);
+  ASSERT_EQ(line.events_size(), 2);
+  EXPECT_EQ(plane.event_metadata().at(line.events(0).metadata_id()).name(),
+            "event3");
+  EXPECT_EQ(plane.event_metadata().at(line.events(1).metadata_id()).name(),
+            "event4");
+}
+
+TEST(TraceMeFlightRecorderTest, InvalidOptions) {
+  TraceMeFlightRecorder::Options options;
+  options.max_events_per_thread = 0;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      TraceMeFlightRecorder::Get()->Start(options)));
+  EXPECT_FALSE(TraceMeFlightRecorder::Get()->IsRunning());
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -393,6 +393,18 @@ TraceMeRecorder::Events TraceMeRecorder::StopRecording() {
   return events;
 }
 
+TraceMeRecorder::Events TraceMeRecorder::CollectRecording() {
+  TraceMeRecorder::Events events;
+  mutex_lock lock(mutex_);
+  // Consume is safe to call concurrently with Record; events recorded while
+  // it runs are left for the next call.
+  if (internal::g_trace_level.load(std::memory_order_acquire) !=
+      kTracingDisabled) {
+    events = Consume();
+  }
+  return events;
+}
+
 /*static*/ int64 TraceMeRecorder::NewActivityId() {
   // Activity IDs: To avoid contention over a counter, the top 32 bits identify
   // the originating thread, the bottom 32 bits name the event within a thread.
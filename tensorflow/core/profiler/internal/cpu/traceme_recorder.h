@@ -89,6 +89,12 @@ class TraceMeRecorder {
   // Events passed to Record after Stop has started will be dropped.
   static Events Stop() { return Get()->StopRecording(); }
 
+  // Returns events recorded since the previous Start() or Collect(), without
+  // stopping recording. Returns no events if not recording.
+  // TraceMe::ActivityStart/ActivityEnd pairs split across two calls are
+  // dropped, as their start and end are returned by different calls.
+  static Events Collect() { return Get()->CollectRecording(); }
+
   // Returns whether we're currently recording. Racy, but cheap!
   static inline bool Active(int level = 1) {
     return internal::g_trace_level.load(std::memory_order_acquire) >= level;
@@ -119,6 +125,7 @@ class TraceMeRecorder {
 
   bool StartRecording(int level);
   Events StopRecording();
+  Events CollectRecording();
 
   // Clears events from all active threads that were added due to Record
   // racing with StopRecording.
@@ -56,6 +56,23 @@ TEST(RecorderTest, SingleThreaded) {
               ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, CollectWhileRecording) {
+  int64 start_time = GetCurrentTimeNanos();
+  int64 end_time = start_time + SecondsToNanos(1);
+
+  EXPECT_TRUE(TraceMeRecorder::Collect().empty());
+  TraceMeRecorder::Start(/*level=*/1);
+  TraceMeRecorder::Record({"first", start_time, end_time});
+  auto first = TraceMeRecorder::Collect();
+  TraceMeRecorder::Record({"second", start_time, end_time});
+  auto second = TraceMeRecorder::Stop();
+
+  ASSERT_EQ(first.size(), 1);
+  EXPECT_THAT(first[0].events, ElementsAre(Named("first")));
+  ASSERT_EQ(second.size(), 1);
+  EXPECT_THAT(second[0].events, ElementsAre(Named("second")));
+}
+
 // Checks the functional behavior of the recorder, when used from several
 // unsynchronized threads.
 //
@@ -15,22 +15,63 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/rpc/profiler_server.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
 #include "grpcpp/grpcpp.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/internal/cpu/traceme_flight_recorder.h"
 #include "tensorflow/core/profiler/profiler_service.grpc.pb.h"
 #include "tensorflow/core/profiler/rpc/profiler_service_impl.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace profiler {
+namespace {
+
+// Starts the TraceMe flight recorder if TF_PROFILER_FLIGHT_RECORDER_LEVEL is
+// positive. Profile requests are then served from its retained events.
+bool MaybeStartFlightRecorder() {
+  int64 trace_level;
+  Status status = ReadInt64FromEnvVar("TF_PROFILER_FLIGHT_RECORDER_LEVEL", 0,
+                                      &trace_level);
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to parse TF_PROFILER_FLIGHT_RECORDER_LEVEL: "
+               << status;
+    return false;
+  }
+  if (trace_level <= 0) return false;
+  int64 max_events_per_thread;
+  status = ReadInt64FromEnvVar("TF_PROFILER_FLIGHT_RECORDER_EVENTS_PER_THREAD",
+                               1 << 16, &max_events_per_thread);
+  if (!status.ok()) {
+    LOG(ERROR)
+        << "Failed to parse TF_PROFILER_FLIGHT_RECORDER_EVENTS_PER_THREAD: "
+        << status;
+    return false;
+  }
+  TraceMeFlightRecorder::Options options;
+  options.trace_level = trace_level;
+  options.max_events_per_thread = std::max<int64>(0, max_events_per_thread);
+  status = TraceMeFlightRecorder::Get()->Start(options);
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to start TraceMe flight recorder: " << status;
+    return false;
+  }
+  LOG(INFO) << "TraceMe flight recorder started at level " << trace_level;
+  return true;
+}
+
+}  // namespace
 
 void ProfilerServer::StartProfilerServer(int32 port) {
   VLOG(1) << "Starting profiler server.";
   std::string server_address = absl::StrCat("[::]:", port);
+  flight_recorder_started_ = MaybeStartFlightRecorder();
   service_ = CreateProfilerService();
   ::grpc::ServerBuilder builder;
 
@@ -54,6 +95,7 @@ ProfilerServer::~ProfilerServer() {
     server_->Wait();
     LOG(INFO) << "Profiler server was shut down";
   }
+  if (flight_recorder_started_) TraceMeFlightRecorder::Get()->Stop();
 }
 
 }  // namespace profiler
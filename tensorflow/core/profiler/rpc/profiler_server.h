@@ -33,6 +33,8 @@ class ProfilerServer {
  private:
   std::unique_ptr<grpc::ProfilerService::Service> service_;
   std::unique_ptr<::grpc::Server> server_;
+  // Whether StartProfilerServer started the TraceMe flight recorder.
+  bool flight_recorder_started_ = false;
 };
 
 }  // namespace profiler
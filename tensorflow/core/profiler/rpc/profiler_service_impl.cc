@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/profiler/internal/cpu/traceme_flight_recorder.h"
 #include "tensorflow/core/profiler/lib/profiler_session.h"
 #include "tensorflow/core/profiler/profiler_service.grpc.pb.h"
 #include "tensorflow/core/profiler/profiler_service.pb.h"
@@ -43,13 +44,18 @@ const absl::string_view kXPlanePb = "xplane.pb";
 
 // Collects data in XSpace format. The data is saved to a repository
 // unconditionally.
+// If `profiler` is null, the data is read from the TraceMe flight recorder.
 Status CollectDataToRepository(const ProfileRequest& request,
                                ProfilerSession* profiler,
                                ProfileResponse* response) {
   response->set_empty_trace(true);
   // Read the profile data into xspace.
   XSpace xspace;
-  TF_RETURN_IF_ERROR(profiler->CollectData(&xspace));
+  if (profiler != nullptr) {
+    TF_RETURN_IF_ERROR(profiler->CollectData(&xspace));
+  } else {
+    TF_RETURN_IF_ERROR(TraceMeFlightRecorder::Get()->CollectData(&xspace));
+  }
   xspace.add_hostnames(request.host_name());
   VLOG(3) << "Collected XSpace to repository.";
   response->set_empty_trace(IsEmpty(xspace));
@@ -79,12 +85,17 @@ class ProfilerServiceImpl : public grpc::ProfilerService::Service {
   ::grpc::Status Profile(::grpc::ServerContext* ctx, const ProfileRequest* req,
                          ProfileResponse* response) override {
     VLOG(1) << "Received a profile request: " << req->DebugString();
-    std::unique_ptr<ProfilerSession> profiler =
-        ProfilerSession::Create(req->opts());
-    Status status = profiler->Status();
-    if (!status.ok()) {
-      return ::grpc::Status(::grpc::StatusCode::INTERNAL,
-                            status.error_message());
+    // The flight recorder holds the profiler lock and already retains the
+    // most recent host events, which are dumped once the duration elapses.
+    std::unique_ptr<ProfilerSession> profiler;
+    Status status;
+    if (!TraceMeFlightRecorder::Get()->IsRunning()) {
+      profiler = ProfilerSession::Create(req->opts());
+      status = profiler->Status();
+      if (!status.ok()) {
+        return ::grpc::Status(::grpc::StatusCode::INTERNAL,
+                              status.error_message());
+      }
     }
 
     Env* env = Env::Default();
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/utils/derived_timeline.h"
 
 #include <algorithm>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -372,6 +373,169 @@ void DeriveEventsFromHostTrace(const XPlane* host_trace,
   }
 }
 
+void DeriveStreamOccupancyFromTraces(const XPlane* host_trace,
+                                     XPlane* device_trace) {
+  // Gaps shorter than this are counted as idle time but get no event, as
+  // back-to-back kernels are typically separated by a few hundred ns.
+  constexpr uint64 kMinGapEventPs = 1000000;
+
+  // Host spans of the launches, by correlation id.
+  absl::flat_hash_map<int64, Timespan> launches;
+  if (host_trace != nullptr) {
+    XPlaneVisitor host_plane = CreateTfXPlaneVisitor(host_trace);
+    host_plane.ForEachLine([&](const XLineVisitor& line) {
+      if (IsDerivedThreadId(line.Id())) return;
+      line.ForEachEvent([&](const XEventVisitor& event) {
+        if (auto correlation_id = event.GetStat(StatType::kCorrelationId)) {
+          launches[correlation_id->IntValue()] = event.GetTimespan();
+        }
+      });
+    });
+  }
+
+  struct Gap {
+    Timespan span;
+    std::string tf_op;
+    absl::optional<uint64> launch_delay_ps;
+    uint64 launch_bound_ps = 0;
+  };
+  struct Stream {
+    int64 id = 0;
+    std::string name;
+    Timespan span;
+    uint64 busy_ps = 0;
+    uint64 idle_ps = 0;
+    uint64 launch_bound_idle_ps = 0;
+    int64 num_gaps = 0;
+    std::vector<uint64> launch_latencies_ps;
+    absl::flat_hash_map<std::string, uint64> idle_ps_by_op;
+    std::vector<Gap> gaps;
+  };
+  std::vector<Stream> streams;
+  uint64 start_timestamp_ns = kuint64max;
+
+  XPlaneVisitor device_plane = CreateTfXPlaneVisitor(device_trace);
+  device_plane.ForEachLine([&](const XLineVisitor& line) {
+    if (IsDerivedThreadId(line.Id()) || line.NumEvents() == 0) return;
+    start_timestamp_ns =
+        std::min<uint64>(start_timestamp_ns, line.TimestampNs());
+    std::vector<XEventVisitor> events;
+    line.ForEachEvent(
+        [&](const XEventVisitor& event) { events.push_back(event); });
+    absl::c_sort(events);
+
+    Stream stream;
+    stream.id = line.Id();
+    stream.name = std::string(line.DisplayName());
+    uint64 busy_until_ps = events.front().TimestampPs();
+    for (const XEventVisitor& event : events) {
+      const Timespan event_span = event.GetTimespan();
+      const Timespan* launch = nullptr;
+      if (auto correlation_id = event.GetStat(StatType::kCorrelationId)) {
+        launch = gtl::FindOrNull(launches, correlation_id->IntValue());
+      }
+      if (launch != nullptr) {
+        stream.launch_latencies_ps.push_back(
+            event_span.begin_ps() > launch->begin_ps()
+                ? event_span.begin_ps() - launch->begin_ps()
+                : 0);
+      }
+      if (event_span.begin_ps() > busy_until_ps) {
+        Gap gap;
+        gap.span =
+            Timespan::FromEndPoints(busy_until_ps, event_span.begin_ps());
+        if (auto tf_op = event.GetStat(StatType::kTfOp)) {
+          gap.tf_op = std::string(tf_op->StrOrRefValue());
+        } else {
+          gap.tf_op = std::string(event.Name());
+        }
+        if (launch != nullptr) {
+          gap.launch_delay_ps = stream.launch_latencies_ps.back();
+          if (launch->end_ps() > busy_until_ps) {
+            gap.launch_bound_ps = std::min(launch->end_ps() - busy_until_ps,
+                                           gap.span.duration_ps());
+          }
+        }
+        stream.idle_ps += gap.span.duration_ps();
+        stream.launch_bound_idle_ps += gap.launch_bound_ps;
+        stream.idle_ps_by_op[gap.tf_op] += gap.span.duration_ps();
+        ++stream.num_gaps;
+        if (gap.span.duration_ps() >= kMinGapEventPs) {
+          stream.gaps.push_back(std::move(gap));
+        }
+      }
+      // Activities on the same line may overlap, e.g. a memcpy and a kernel,
+      // so only count the time not yet covered.
+      if (event_span.end_ps() > busy_until_ps) {
+        stream.busy_ps +=
+            event_span.end_ps() -
+            std::max<uint64>(event_span.begin_ps(), busy_until_ps);
+        busy_until_ps = event_span.end_ps();
+      }
+    }
+    stream.span =
+        Timespan::FromEndPoints(events.front().TimestampPs(), busy_until_ps);
+    streams.push_back(std::move(stream));
+  });
+  if (streams.empty()) return;
+
+  XPlaneBuilder plane(device_trace);
+  XLineBuilder gap_line = plane.GetOrCreateLine(kThreadIdStreamGaps);
+  gap_line.SetName(kStreamGapsLineName);
+  gap_line.SetTimestampNs(start_timestamp_ns);
+  XLineBuilder occupancy_line = plane.GetOrCreateLine(kThreadIdStreamOccupancy);
+  occupancy_line.SetName(kStreamOccupancyLineName);
+  occupancy_line.SetTimestampNs(start_timestamp_ns);
+  const uint64 start_ps = NanosToPicos(start_timestamp_ns);
+  auto stat = [&plane](absl::string_view name) -> const XStatMetadata& {
+    return *plane.GetOrCreateStatMetadata(name);
+  };
+
+  for (Stream& stream : streams) {
+    for (const Gap& gap : stream.gaps) {
+      XEventBuilder event =
+          gap_line.AddEvent(*plane.GetOrCreateEventMetadata(gap.tf_op));
+      event.SetOffsetPs(gap.span.begin_ps() - start_ps);
+      event.SetDurationPs(gap.span.duration_ps());
+      event.AddStatValue(stat("stream_id"), stream.id);
+      if (gap.launch_delay_ps) {
+        event.AddStatValue(stat("launch_delay_us"),
+                           PicosToMicros(*gap.launch_delay_ps));
+        event.AddStatValue(stat("launch_bound_us"),
+                           PicosToMicros(gap.launch_bound_ps));
+      }
+    }
+
+    XEventBuilder event =
+        occupancy_line.AddEvent(*plane.GetOrCreateEventMetadata(stream.name));
+    event.SetOffsetPs(stream.span.begin_ps() - start_ps);
+    event.SetDurationPs(stream.span.duration_ps());
+    event.AddStatValue(stat("stream_id"), stream.id);
+    event.AddStatValue(stat("busy_us"), PicosToMicros(stream.busy_ps));
+    event.AddStatValue(stat("idle_us"), PicosToMicros(stream.idle_ps));
+    event.AddStatValue(stat("num_gaps"), stream.num_gaps);
+    if (!stream.idle_ps_by_op.empty()) {
+      auto top_idle_op = absl::c_max_element(
+          stream.idle_ps_by_op,
+          [](const auto& a, const auto& b) { return a.second < b.second; });
+      event.AddStatValue(stat("top_idle_op"), top_idle_op->first);
+    }
+    std::vector<uint64>& latencies = stream.launch_latencies_ps;
+    if (!latencies.empty()) {
+      absl::c_sort(latencies);
+      auto percentile = [&latencies](int p) {
+        return PicosToMicros(latencies[(latencies.size() - 1) * p / 100]);
+      };
+      event.AddStatValue(stat("launch_bound_idle_us"),
+                         PicosToMicros(stream.launch_bound_idle_ps));
+      event.AddStatValue(stat("launch_latency_p50_us"), percentile(50));
+      event.AddStatValue(stat("launch_latency_p90_us"), percentile(90));
+      event.AddStatValue(stat("launch_latency_max_us"), percentile(100));
+    }
+  }
+  RemoveEmptyLines(device_trace);
+}
+
 void GenerateDerivedTimeLines(const GroupMetadataMap& group_metadata_map,
                               XSpace* space, bool step_info_only) {
   // TODO(profiler): Once we capture HLO protos for xla/gpu, we should use that
@@ -135,6 +135,23 @@ void DeriveEventsFromHostTrace(const XPlane* host_trace,
                                const GroupMetadataMap& group_metadata_map,
                                std::vector<XPlane*> device_traces);
 
+// Derives "Stream Gaps" and "Stream Occupancy" lines in a GPU device trace,
+// to tell launch-bound steps from compute-bound ones.
+//
+// Every idle gap between consecutive activities of a stream becomes an event
+// on the "Stream Gaps" line named after the TF op of the activity that ended
+// the gap. If the launch of that activity (matched by correlation id) is found
+// in `host_trace`, the gap carries the launch-to-start delay of the activity
+// and the part of the gap during which the launch had not yet returned, i.e.
+// the device waited for the host. Gaps shorter than 1us are only counted.
+//
+// The "Stream Occupancy" line has one event per stream spanning its
+// activities, with the busy and idle time, the launch-bound idle time, the
+// launch latency distribution and the TF op preceded by the most idle time.
+// `host_trace` may be null, in which case no launch statistics are derived.
+void DeriveStreamOccupancyFromTraces(const XPlane* host_trace,
+                                     XPlane* device_trace);
+
 // Loops through XPlanes of input XSpace, if it is "device" XPlane, generating
 // derived timelines for the plane by calling DeriveEventsFromAnnotations.
 void GenerateDerivedTimeLines(const GroupMetadataMap& group_metadata_map,
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/utils/derived_timeline.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/types.h"
@@ -173,6 +174,72 @@ TEST(DerivedTimelineTest, TfOpNameScopeTest) {
   });
 }
 
+// Checks that stream gaps are attributed to the op ending them and that the
+// launch statistics are derived from the host launches.
+TEST(DerivedTimelineTest, StreamOccupancyTest) {
+  XSpace space;
+  XPlane* host_plane = GetOrCreateHostXPlane(&space);
+  XPlaneBuilder host_plane_builder(host_plane);
+  auto host_line_builder = host_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&host_plane_builder, &host_line_builder, "cudaLaunchKernel",
+               /*offset_ps=*/0, /*duration_ps=*/1000000,
+               {{StatType::kCorrelationId, int64{1}}});
+  CreateXEvent(&host_plane_builder, &host_line_builder, "cudaLaunchKernel",
+               /*offset_ps=*/6000000, /*duration_ps=*/3000000,
+               {{StatType::kCorrelationId, int64{2}}});
+  XPlane* device_plane = GetOrCreateGpuXPlane(&space, /*device_ordinal=*/0);
+  XPlaneBuilder device_plane_builder(device_plane);
+  auto device_line_builder = device_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&device_plane_builder, &device_line_builder, "kernel_a",
+               /*offset_ps=*/2000000, /*duration_ps=*/3000000,
+               {{StatType::kCorrelationId, int64{1}},
+                {StatType::kTfOp, "a:A"}});
+  CreateXEvent(&device_plane_builder, &device_line_builder, "kernel_b",
+               /*offset_ps=*/10000000, /*duration_ps=*/2000000,
+               {{StatType::kCorrelationId, int64{2}},
+                {StatType::kTfOp, "b:B"}});
+
+  DeriveStreamOccupancyFromTraces(host_plane, device_plane);
+
+  XPlaneVisitor plane_visitor = CreateTfXPlaneVisitor(device_plane);
+  EXPECT_EQ(plane_visitor.NumLines(), 3);
+  plane_visitor.ForEachLine([&](const XLineVisitor& line_visitor) {
+    if (line_visitor.Id() == 0) return;
+    EXPECT_EQ(line_visitor.NumEvents(), 1);
+    line_visitor.ForEachEvent([&](const XEventVisitor& event_visitor) {
+      absl::flat_hash_map<std::string, double> stats;
+      std::string top_idle_op;
+      event_visitor.ForEachStat([&](const XStatVisitor& stat) {
+        if (stat.Name() == "top_idle_op") {
+          top_idle_op = std::string(stat.StrOrRefValue());
+        } else if (stat.ValueCase() == XStat::kDoubleValue) {
+          stats[std::string(stat.Name())] = stat.DoubleValue();
+        } else {
+          stats[std::string(stat.Name())] = stat.IntValue();
+        }
+      });
+      if (line_visitor.Id() == kThreadIdStreamGaps) {
+        EXPECT_EQ(event_visitor.Name(), "b:B");
+        EXPECT_EQ(event_visitor.OffsetPs(), 5000000);
+        EXPECT_EQ(event_visitor.DurationPs(), 5000000);
+        EXPECT_EQ(stats["launch_delay_us"], 4);
+        EXPECT_EQ(stats["launch_bound_us"], 4);
+      } else {
+        EXPECT_EQ(line_visitor.Id(), kThreadIdStreamOccupancy);
+        EXPECT_EQ(event_visitor.OffsetPs(), 2000000);
+        EXPECT_EQ(event_visitor.DurationPs(), 10000000);
+        EXPECT_EQ(stats["busy_us"], 5);
+        EXPECT_EQ(stats["idle_us"], 5);
+        EXPECT_EQ(stats["num_gaps"], 1);
+        EXPECT_EQ(stats["launch_bound_idle_us"], 4);
+        EXPECT_EQ(stats["launch_latency_p50_us"], 2);
+        EXPECT_EQ(stats["launch_latency_max_us"], 4);
+        EXPECT_EQ(top_idle_op, "b:B");
+      }
+    });
+  });
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -39,7 +39,9 @@ constexpr int kThreadIdHloModule = kThreadIdDerivedMin + 4;
 constexpr int kThreadIdHloOp = kThreadIdDerivedMin + 5;
 constexpr int kThreadIdOverhead = kThreadIdDerivedMin + 6;
 constexpr int kThreadIdSource = kThreadIdDerivedMin + 7;
-constexpr int kThreadIdDerivedMax = kThreadIdSource;
+constexpr int kThreadIdStreamGaps = kThreadIdDerivedMin + 8;
+constexpr int kThreadIdStreamOccupancy = kThreadIdDerivedMin + 9;
+constexpr int kThreadIdDerivedMax = kThreadIdStreamOccupancy;
 
 static inline bool IsDerivedThreadId(int thread_id) {
   return thread_id >= kThreadIdDerivedMin && thread_id <= kThreadIdDerivedMax;
@@ -43,6 +43,8 @@ const absl::string_view kXlaModuleLineName = "XLA Modules";
 const absl::string_view kXlaOpLineName = "XLA Ops";
 const absl::string_view kKernelLaunchLineName = "Launch Stats";
 const absl::string_view kSourceLineName = "Source code";
+const absl::string_view kStreamGapsLineName = "Stream Gaps";
+const absl::string_view kStreamOccupancyLineName = "Stream Occupancy";
 
 namespace {
 
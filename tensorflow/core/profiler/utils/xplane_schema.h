@@ -54,6 +54,8 @@ TF_CONST_INIT extern const absl::string_view kXlaModuleLineName;
 TF_CONST_INIT extern const absl::string_view kXlaOpLineName;
 TF_CONST_INIT extern const absl::string_view kKernelLaunchLineName;
 TF_CONST_INIT extern const absl::string_view kSourceLineName;
+TF_CONST_INIT extern const absl::string_view kStreamGapsLineName;
+TF_CONST_INIT extern const absl::string_view kStreamOccupancyLineName;
 
 // Interesting event types (i.e., TraceMe names).
 enum HostEventType {
@@ -22,13 +22,20 @@ limitations under the License.
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/summary/summary_converter.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/events_writer.h"
 #include "tensorflow/core/util/ptr_util.h"
 
 namespace tensorflow {
 namespace {
 
+// Once this many multiples of `max_queue` events are pending, the background
+// writer has fallen behind and WriteEvent() flushes on the calling thread.
+constexpr int kMaxPendingQueues = 4;
+
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
   SummaryFileWriter(int max_queue, int flush_millis, Env* env)
@@ -54,6 +61,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
     string sep = absl::StartsWith(filename_suffix, ".") ? "" : ".";
     const string uniquified_filename_suffix = absl::StrCat(
         ".", pid, ".", file_id_counter.fetch_add(1), sep, filename_suffix);
+    mutex_lock wl(writer_mu_);
     mutex_lock ml(mu_);
     events_writer_ =
         tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
@@ -62,24 +70,45 @@ class SummaryFileWriter : public SummaryWriterInterface {
         "Could not initialize events writer.");
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+
+    // Writing and flushing the events file happens on a dedicated thread so
+    // that summary ops only pay for queueing their event.
+    bool background_flush;
+    TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_SUMMARY_WRITER_BACKGROUND_FLUSH",
+                                          true, &background_flush));
+    if (background_flush) {
+      flush_thread_.reset(env_->StartThread(ThreadOptions(),
+                                            "summary_file_writer",
+                                            [this]() { FlushLoop(); }));
+    }
     return Status::OK();
   }
 
   Status Flush() override {
-    mutex_lock ml(mu_);
-    if (!is_initialized_) {
-      return errors::FailedPrecondition("Class was not properly initialized.");
+    {
+      mutex_lock ml(mu_);
+      if (!is_initialized_) {
+        return errors::FailedPrecondition(
+            "Class was not properly initialized.");
+      }
     }
-    return InternalFlush();
+    TF_RETURN_IF_ERROR(InternalFlush());
+    return ConsumeBackgroundStatus();
   }
 
   ~SummaryFileWriter() override {
-    (void)Flush();  // Ignore errors.
+    {
+      mutex_lock ml(mu_);
+      stopping_ = true;
+      flush_cv_.notify_one();
+    }
+    flush_thread_.reset();  // Joins the thread.
+    (void)Flush();          // Ignore errors.
   }
 
   Status WriteTensor(int64 global_step, Tensor t, const string& tag,
                      const string& serialized_metadata) override {
-    std::unique_ptr<Event> e{new Event};
+    std::unique_ptr<Event> e = NewEvent();
     e->set_step(global_step);
     e->set_wall_time(GetWallTime());
     Summary::Value* v = e->mutable_summary()->add_value();
@@ -101,7 +130,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   Status WriteScalar(int64 global_step, Tensor t, const string& tag) override {
-    std::unique_ptr<Event> e{new Event};
+    std::unique_ptr<Event> e = NewEvent();
     e->set_step(global_step);
     e->set_wall_time(GetWallTime());
     TF_RETURN_IF_ERROR(
@@ -111,7 +140,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   Status WriteHistogram(int64 global_step, Tensor t,
                         const string& tag) override {
-    std::unique_ptr<Event> e{new Event};
+    std::unique_ptr<Event> e = NewEvent();
     e->set_step(global_step);
     e->set_wall_time(GetWallTime());
     TF_RETURN_IF_ERROR(
@@ -121,7 +150,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   Status WriteImage(int64 global_step, Tensor t, const string& tag,
                     int max_images, Tensor bad_color) override {
-    std::unique_ptr<Event> e{new Event};
+    std::unique_ptr<Event> e = NewEvent();
     e->set_step(global_step);
     e->set_wall_time(GetWallTime());
     TF_RETURN_IF_ERROR(AddTensorAsImageToSummary(t, tag, max_images, bad_color,
@@ -131,7 +160,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   Status WriteAudio(int64 global_step, Tensor t, const string& tag,
                     int max_outputs, float sample_rate) override {
-    std::unique_ptr<Event> e{new Event};
+    std::unique_ptr<Event> e = NewEvent();
     e->set_step(global_step);
     e->set_wall_time(GetWallTime());
     TF_RETURN_IF_ERROR(AddTensorAsAudioToSummary(
@@ -141,7 +170,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   Status WriteGraph(int64 global_step,
                     std::unique_ptr<GraphDef> graph) override {
-    std::unique_ptr<Event> e{new Event};
+    std::unique_ptr<Event> e = NewEvent();
     e->set_step(global_step);
     e->set_wall_time(GetWallTime());
     graph->SerializeToString(e->mutable_graph_def());
@@ -149,13 +178,22 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
-    mutex_lock ml(mu_);
-    queue_.emplace_back(std::move(event));
-    if (queue_.size() > max_queue_ ||
-        env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+    {
+      mutex_lock ml(mu_);
+      queue_.emplace_back(std::move(event));
+      if (queue_.size() <= max_queue_ &&
+          env_->NowMicros() - last_flush_ <= 1000 * flush_millis_) {
+        return Status::OK();
+      }
+      if (flush_thread_ != nullptr &&
+          queue_.size() <= kMaxPendingQueues * (max_queue_ + 1)) {
+        flush_requested_ = true;
+        flush_cv_.notify_one();
+        return Status::OK();
+      }
     }
-    return Status::OK();
+    TF_RETURN_IF_ERROR(InternalFlush());
+    return ConsumeBackgroundStatus();
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
@@ -165,26 +203,96 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+  // Returns a cleared Event, reusing one that has already been written when
+  // possible. Clearing keeps the capacity of the summary value fields, so
+  // steady streams of small summaries do not allocate.
+  std::unique_ptr<Event> NewEvent() TF_LOCKS_EXCLUDED(mu_) {
+    {
+      mutex_lock ml(mu_);
+      if (!free_events_.empty()) {
+        std::unique_ptr<Event> e = std::move(free_events_.back());
+        free_events_.pop_back();
+        return e;
+      }
+    }
+    return std::unique_ptr<Event>(new Event);
+  }
+
+  // Writes all queued events to the events file and flushes it. Events are
+  // taken off the queue under `writer_mu_` so that concurrent flushes from
+  // the background thread and callers keep the events in order, while
+  // WriteEvent() only ever waits for `mu_`.
+  Status InternalFlush() TF_LOCKS_EXCLUDED(mu_, writer_mu_) {
+    mutex_lock wl(writer_mu_);
+    std::vector<std::unique_ptr<Event>> events;
+    {
+      mutex_lock ml(mu_);
+      events.swap(queue_);
+      last_flush_ = env_->NowMicros();
+    }
+    for (const std::unique_ptr<Event>& e : events) {
       events_writer_->WriteEvent(*e);
+      e->Clear();
+    }
+    {
+      mutex_lock ml(mu_);
+      for (std::unique_ptr<Event>& e : events) {
+        if (free_events_.size() > max_queue_) break;
+        free_events_.push_back(std::move(e));
+      }
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return Status::OK();
   }
 
+  // Body of `flush_thread_`: flushes whenever WriteEvent() requests it.
+  void FlushLoop() TF_LOCKS_EXCLUDED(mu_) {
+    while (true) {
+      {
+        mutex_lock ml(mu_);
+        while (!flush_requested_ && !stopping_) {
+          flush_cv_.wait(ml);
+        }
+        if (stopping_) return;
+        flush_requested_ = false;
+      }
+      Status s = InternalFlush();
+      if (!s.ok()) {
+        mutex_lock ml(mu_);
+        background_status_.Update(s);
+      }
+    }
+  }
+
+  // Returns and resets the first error hit by the background thread, so that
+  // it is reported to the next caller of WriteEvent() or Flush().
+  Status ConsumeBackgroundStatus() TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock ml(mu_);
+    Status s = background_status_;
+    background_status_ = Status::OK();
+    return s;
+  }
+
   bool is_initialized_;
   const int max_queue_;
   const int flush_millis_;
-  uint64 last_flush_;
+  uint64 last_flush_ TF_GUARDED_BY(mu_);
   Env* env_;
   mutex mu_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
+  // Written events kept around for reuse by NewEvent().
+  std::vector<std::unique_ptr<Event>> free_events_ TF_GUARDED_BY(mu_);
+  condition_variable flush_cv_;
+  bool flush_requested_ TF_GUARDED_BY(mu_) = false;
+  bool stopping_ TF_GUARDED_BY(mu_) = false;
+  Status background_status_ TF_GUARDED_BY(mu_);
+  // Null if background flushing is disabled.
+  std::unique_ptr<Thread> flush_thread_;
+  // Acquired before `mu_`; serializes writes to the events file.
+  mutex writer_mu_ TF_ACQUIRED_BEFORE(mu_);
   // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(writer_mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
 };
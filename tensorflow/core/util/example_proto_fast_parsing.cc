@@ -177,8 +177,10 @@ class Feature {
     return &bytes_list->emplace_back();
   }
 
+  // If `as_view` is true, the parsed values are VIEW tstrings into the
+  // serialized feature instead of copies.
   template <typename Result>
-  bool ParseBytesList(Result* bytes_list) {
+  bool ParseBytesList(Result* bytes_list, bool as_view = false) {
     DCHECK(bytes_list != nullptr);
 
     protobuf::io::CodedInputStream stream(
@@ -197,6 +199,16 @@ class Feature {
       if (!stream.ReadVarint32(&bytes_length)) return false;
       tstring* bytes = construct_at_end(bytes_list);
       if (bytes == nullptr) return false;
+      if (as_view) {
+        if (bytes_length == 0) continue;
+        const void* data;
+        int size;
+        if (!stream.GetDirectBufferPointer(&data, &size)) return false;
+        if (static_cast<uint32>(size) < bytes_length) return false;
+        bytes->assign_as_view(static_cast<const char*>(data), bytes_length);
+        if (!stream.Skip(bytes_length)) return false;
+        continue;
+      }
       bytes->resize_uninitialized(bytes_length);
       if (!stream.ReadRaw(bytes->data(), bytes_length)) return false;
     }
@@ -700,7 +712,9 @@ Status FastParseSerializedExample(
           case DT_STRING: {
             auto out_p = out.flat<tstring>().data() + offset;
             LimitedArraySlice<tstring> slice(out_p, num_elements);
-            if (!feature.ParseBytesList(&slice)) return parse_error();
+            if (!feature.ParseBytesList(&slice, config.bytes_as_views)) {
+              return parse_error();
+            }
             if (slice.EndDistance() != 0) {
               return shape_error(num_elements - slice.EndDistance(), "bytes");
             }
@@ -756,7 +770,8 @@ Status FastParseSerializedExample(
           }
           case DT_STRING: {
             if (example_dtype != DT_INVALID) {
-              if (!feature.ParseBytesList(&out.bytes_list)) {
+              if (!feature.ParseBytesList(&out.bytes_list,
+                                          config.bytes_as_views)) {
                 return parse_error();
               }
               if (out.bytes_list.size() % num_elements != 0) {
@@ -832,7 +847,8 @@ Status FastParseSerializedExample(
         }
         case DT_STRING: {
           if (example_dtype != DT_INVALID) {
-            if (!feature.ParseBytesList(&out.bytes_list)) {
+            if (!feature.ParseBytesList(&out.bytes_list,
+                                        config.bytes_as_views)) {
               return parse_error();
             }
           }
@@ -1613,7 +1629,9 @@ Status FastParseSingleExample(const Config& config, StringPiece serialized,
         case DT_STRING: {
           auto out_p = out->flat<tstring>().data();
           LimitedArraySlice<tstring> slice(out_p, num_elements);
-          if (!feature.ParseBytesList(&slice)) return parse_error();
+          if (!feature.ParseBytesList(&slice, config.bytes_as_views)) {
+            return parse_error();
+          }
           if (slice.EndDistance() != 0) {
             return parse_error();
           }
@@ -1688,7 +1706,9 @@ Status FastParseSingleExample(const Config& config, StringPiece serialized,
             return parse_error();
           }
           bytes_list.reserve(actual_num_elements);
-          if (!feature.ParseBytesList(&bytes_list)) return parse_error();
+          if (!feature.ParseBytesList(&bytes_list, config.bytes_as_views)) {
+            return parse_error();
+          }
           num_elements = bytes_list.size();
           break;
         }
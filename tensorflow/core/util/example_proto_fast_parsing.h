@@ -95,6 +95,13 @@ struct FastParseExampleConfig {
   // If `true`, `Result::feature_stats` will contain one
   // `PerExampleFeatureStats` for each serialized example in the input.
   bool collect_feature_stats = false;
+
+  // If `true`, the values of string features are VIEW tstrings that point into
+  // the serialized examples instead of copies of them. The caller must keep the
+  // buffers of the serialized examples alive for as long as the result is used.
+  // Default values are still copied. Only `FastParse[Single]Example()` honor
+  // this.
+  bool bytes_as_views = false;
 };
 
 // Statistics about the features in each example passed to
@@ -17,8 +17,10 @@ limitations under the License.
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -321,6 +323,45 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+// Returns whether `value` is a view into `serialized`.
+bool IsViewInto(const tstring& value, const tstring& serialized) {
+  return value.type() == tstring::VIEW && value.data() >= serialized.data() &&
+         value.data() + value.size() <= serialized.data() + serialized.size();
+}
+
+TEST(FastParse, BytesAsViews) {
+  const size_t kNumExamples = 3;
+  std::vector<tstring> serialized(kNumExamples, ExampleWithSomeFeatures());
+
+  FastParseExampleConfig config;
+  AddDenseFeature("bytes_list", DT_STRING, {2}, false, 2, &config);
+  AddDenseFeature("empty_bytes_list", DT_STRING, {-1}, true, 1, &config);
+  AddSparseFeature("bytes_list", DT_STRING, &config);
+  config.bytes_as_views = true;
+
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  auto dense = result.dense_values[0].matrix<tstring>();
+  auto sparse = result.sparse_values[0].vec<tstring>();
+  ASSERT_EQ(sparse.size(), 2 * kNumExamples);
+  for (int i = 0; i < kNumExamples; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      const tstring expected = absl::StrCat("bytes", j + 1);
+      EXPECT_EQ(dense(i, j), expected);
+      EXPECT_TRUE(IsViewInto(dense(i, j), serialized[i]));
+      EXPECT_EQ(sparse(2 * i + j), expected);
+      EXPECT_TRUE(IsViewInto(sparse(2 * i + j), serialized[i]));
+    }
+  }
+  EXPECT_EQ(result.dense_values[1].NumElements(), 0);
+
+  Result single_result;
+  TF_ASSERT_OK(FastParseSingleExample(config, serialized[0], &single_result));
+  auto single_dense = single_result.dense_values[0].vec<tstring>();
+  EXPECT_EQ(single_dense(0), "bytes1");
+  EXPECT_TRUE(IsViewInto(single_dense(0), serialized[0]));
+}
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
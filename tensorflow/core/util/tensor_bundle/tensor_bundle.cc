@@ -16,11 +16,14 @@ limitations under the License.
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <unordered_set>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -31,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/framework/versions.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
@@ -44,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
@@ -409,6 +414,29 @@ Status PadAlignment(FileOutputBuffer* out, int alignment, int64* size) {
   return status;
 }
 
+// A tensor buffer viewing part of a memory-mapped data file.  It does not own
+// its memory, so kernels copy it instead of writing to it in place.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("mapped_tensor_bundle");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
@@ -744,8 +772,13 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 // Interface for reading a tensor bundle.
 
 BundleReader::BundleReader(Env* env, StringPiece prefix)
+    : BundleReader(env, prefix, Options()) {}
+
+BundleReader::BundleReader(Env* env, StringPiece prefix,
+                           const Options& options)
     : env_(env),
       prefix_(prefix),
+      options_(options),
       metadata_(nullptr),
       table_(nullptr),
       index_cache_(nullptr),
@@ -796,9 +829,17 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
   }
   status_ = CheckVersions(header.version(), kTensorBundleVersion,
                           kTensorBundleMinProducer, "Checkpoint", "checkpoint");
+  if (!status_.ok()) return;
+
+  if (options_.num_read_threads > 1) {
+    read_pool_.reset(new thread::ThreadPool(env_, "bundle_reader",
+                                            options_.num_read_threads));
+  }
 }
 
 BundleReader::~BundleReader() {
+  // Joins the read threads before the data files they read are deleted.
+  read_pool_.reset();
   delete metadata_;
   delete iter_;
   delete table_;
@@ -825,6 +866,7 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
                                          BundleEntryProto* entry) {
   entry->Clear();
   TF_CHECK_OK(status_);
+  mutex_lock l(mu_);
   Seek(key);
   if (!iter_->Valid() || iter_->key() != key) {
     return errors::NotFound("Key ", key, " not found in checkpoint");
@@ -842,6 +884,72 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return Status::OK();
 }
 
+Status BundleReader::GetDataFile(int32 shard_id,
+                                 io::InputBuffer** buffered_file) {
+  // Open the data file if it has not been opened.
+  *buffered_file = data_[shard_id];
+  if (*buffered_file == nullptr) {
+    std::unique_ptr<RandomAccessFile> file = nullptr;
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+        DataFilename(prefix_, shard_id, num_shards_), &file));
+    *buffered_file = new io::InputBuffer(file.release(), kBufferSize);
+    // The InputBuffer and RandomAccessFile objects are both released in dtor.
+    data_[shard_id] = *buffered_file;
+  }
+  return Status::OK();
+}
+
+Status BundleReader::ReadChunked(RandomAccessFile* file, uint64 offset,
+                                 uint64 size, char* buffer) {
+  const uint64 chunk_bytes = std::max<int64>(options_.read_chunk_bytes, 1);
+  const uint64 num_chunks = (size + chunk_bytes - 1) / chunk_bytes;
+  auto read_chunk = [=](uint64 chunk) -> Status {
+    const uint64 start = chunk * chunk_bytes;
+    const uint64 length = std::min(chunk_bytes, size - start);
+    StringPiece sp;
+    TF_RETURN_IF_ERROR(file->Read(offset + start, length, &sp, buffer + start));
+    if (sp.data() != buffer + start) {
+      memmove(buffer + start, sp.data(), length);
+    }
+    return Status::OK();
+  };
+  if (num_chunks <= 1) {
+    return read_chunk(0);
+  }
+  if (read_pool_ == nullptr) {
+    std::vector<RandomAccessFile::ReadRequest> requests(num_chunks);
+    for (uint64 chunk = 0; chunk < num_chunks; ++chunk) {
+      const uint64 start = chunk * chunk_bytes;
+      requests[chunk].offset = offset + start;
+      requests[chunk].n = std::min(chunk_bytes, size - start);
+      requests[chunk].scratch = buffer + start;
+    }
+    Notification done;
+    file->ReadAsync(&requests, [&done]() { done.Notify(); });
+    done.WaitForNotification();
+    for (const RandomAccessFile::ReadRequest& request : requests) {
+      TF_RETURN_IF_ERROR(request.status);
+      if (request.result.data() != request.scratch) {
+        memmove(request.scratch, request.result.data(), request.n);
+      }
+    }
+    return Status::OK();
+  }
+  std::vector<Status> statuses(num_chunks);
+  BlockingCounter counter(num_chunks);
+  for (uint64 chunk = 0; chunk < num_chunks; ++chunk) {
+    read_pool_->Schedule([&statuses, &counter, &read_chunk, chunk]() {
+      statuses[chunk] = read_chunk(chunk);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return Status::OK();
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
@@ -849,54 +957,48 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     ret = new Tensor(entry.dtype(), stored_shape);
   }
 
-  // Validates the "size" field.
-  if (entry.dtype() != DT_STRING && entry.dtype() != DT_VARIANT) {
-    if (entry.size() != ret->TotalBytes()) {
-      return errors::DataLoss("Invalid size in bundle entry: key ", key(),
-                              "; stored size ", entry.size(),
-                              "; expected size ", ret->TotalBytes());
-    }
-  } else if (entry.dtype() == DT_STRING) {
-    // Relaxes the check for string tensors as follows:
-    //   entry.size() == bytes(varint lengths) + bytes(data)
-    //                >= NumElems + bytes(data), since size bytes(varint) >= 1.
-    //   TotalBytes() == sizeof(tstring) * NumElems + bytes(data)
-    // Since we don't know bytes(varint lengths), we just check an inequality.
-    const size_t lower_bound = ret->NumElements() + ret->TotalBytes() -
-                               sizeof(tstring) * ret->NumElements();
-    if (entry.size() < lower_bound) {
-      return errors::DataLoss("Invalid size in bundle entry: key ", key(),
-                              "; stored size ", entry.size(),
-                              "; expected size is at least ", lower_bound);
+  io::InputBuffer* buffered_file;
+  {
+    mutex_lock l(mu_);
+    // Validates the "size" field.
+    if (entry.dtype() != DT_STRING && entry.dtype() != DT_VARIANT) {
+      if (entry.size() != ret->TotalBytes()) {
+        return errors::DataLoss("Invalid size in bundle entry: key ", key(),
+                                "; stored size ", entry.size(),
+                                "; expected size ", ret->TotalBytes());
+      }
+    } else if (entry.dtype() == DT_STRING) {
+      // Relaxes the check for string tensors as follows:
+      //   entry.size() == bytes(varint lengths) + bytes(data)
+      //                >= NumElems + bytes(data),
+      //                   since size bytes(varint) >= 1.
+      //   TotalBytes() == sizeof(tstring) * NumElems + bytes(data)
+      // Since we don't know bytes(varint lengths), we just check an inequality.
+      const size_t lower_bound = ret->NumElements() + ret->TotalBytes() -
+                                 sizeof(tstring) * ret->NumElements();
+      if (entry.size() < lower_bound) {
+        return errors::DataLoss("Invalid size in bundle entry: key ", key(),
+                                "; stored size ", entry.size(),
+                                "; expected size is at least ", lower_bound);
+      }
     }
-  }
-
-  // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
-  if (buffered_file == nullptr) {
-    std::unique_ptr<RandomAccessFile> file = nullptr;
-    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
-    buffered_file = new io::InputBuffer(file.release(), kBufferSize);
-    // The InputBuffer and RandomAccessFile objects are both released in dtor.
-    data_[entry.shard_id()] = buffered_file;
+    TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
   }
   CHECK(buffered_file != nullptr);
 
-  TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
   uint32 actual_crc32c = 0;
 
   if (DataTypeCanUseMemcpy(entry.dtype())) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
     size_t unused_bytes_read;
     if (entry.size() > kBufferSize) {
-      StringPiece sp;
-      TF_RETURN_IF_ERROR(buffered_file->file()->Read(
-          entry.offset(), entry.size(), &sp, backing_buffer));
-      if (sp.data() != backing_buffer) {
-        memmove(backing_buffer, sp.data(), entry.size());
-      }
+      // Large reads bypass the shared input buffer, so other lookups can
+      // proceed while this one reads.
+      TF_RETURN_IF_ERROR(ReadChunked(buffered_file->file(), entry.offset(),
+                                     entry.size(), backing_buffer));
     } else {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
       TF_RETURN_IF_ERROR(buffered_file->ReadNBytes(entry.size(), backing_buffer,
                                                    &unused_bytes_read));
     }
@@ -916,11 +1018,15 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
     // Relies on io::InputBuffer's buffering, because we issue many neighboring
     // reads for a single string tensor.
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
     TF_RETURN_IF_ERROR(ReadVariantTensor(buffered_file, ret, entry.offset(),
                                          entry.size(), &actual_crc32c));
   } else {
     // Relies on io::InputBuffer's buffering, because we issue many neighboring
     // reads for a single string tensor.
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
     TF_RETURN_IF_ERROR(ReadStringTensor(
         buffered_file, ret->NumElements(), entry.offset(), entry.size(),
         GetStringBackingBuffer(*ret), &actual_crc32c, need_to_swap_bytes_));
@@ -952,6 +1058,115 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+namespace {
+
+mutex* ImmutableBundlesMutex() {
+  static mutex* mu = new mutex();
+  return mu;
+}
+
+std::unordered_set<string>* ImmutableBundles()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(*ImmutableBundlesMutex()) {
+  static std::unordered_set<string>* prefixes =
+      new std::unordered_set<string>();
+  return prefixes;
+}
+
+}  // namespace
+
+void MarkBundleImmutable(StringPiece prefix) {
+  mutex_lock l(*ImmutableBundlesMutex());
+  ImmutableBundles()->emplace(prefix);
+}
+
+bool IsBundleImmutable(StringPiece prefix) {
+  mutex_lock l(*ImmutableBundlesMutex());
+  return ImmutableBundles()->count(string(prefix)) > 0;
+}
+
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape shape(entry.shape());
+
+  if (options_.map_data_files && entry.slices().empty() &&
+      DataTypeCanUseMemcpy(entry.dtype()) && !need_to_swap_bytes_ &&
+      entry.size() > 0 &&
+      entry.size() == shape.num_elements() * DataTypeSize(entry.dtype())) {
+    mutex_lock l(mu_);
+    std::shared_ptr<ReadOnlyMemoryRegion> region =
+        GetMappedDataFile(entry.shard_id());
+    if (region != nullptr &&
+        entry.offset() + entry.size() <= region->length()) {
+      const char* data =
+          static_cast<const char*>(region->data()) + entry.offset();
+      // Kernels access tensor data with aligned loads.
+      if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES == 0) {
+        MappedTensorBuffer* buffer =
+            new MappedTensorBuffer(region, data, entry.size());
+        *val = Tensor(entry.dtype(), shape, buffer);
+        buffer->Unref();
+        unwarmed_tensors_.push_back(
+            {region, data, entry.size(), entry.crc32c(), string(key)});
+        return Status::OK();
+      }
+    }
+  }
+
+  *val = Tensor(entry.dtype(), shape);
+  if (entry.slices().empty()) {
+    return GetValue(entry, val);
+  }
+  return GetSliceValue(key, entry, TensorSlice(shape.dims()), val);
+}
+
+void BundleReader::WarmUpMappedTensors() {
+  std::vector<MappedTensor> tensors;
+  {
+    mutex_lock l(mu_);
+    tensors.swap(unwarmed_tensors_);
+  }
+  if (tensors.empty()) return;
+  env_->SchedClosure([prefix = prefix_, tensors = std::move(tensors)]() {
+    for (const MappedTensor& tensor : tensors) {
+      const uint32 actual_crc32c = crc32c::Value(tensor.data, tensor.size);
+      if (crc32c::Unmask(tensor.masked_crc32c) != actual_crc32c) {
+        LOG(ERROR) << "TensorBundle at " << prefix << ": checksum of mapped "
+                   << "tensor " << tensor.key << " does not match: stored "
+                   << strings::Printf("%08u",
+                                      crc32c::Unmask(tensor.masked_crc32c))
+                   << " vs. calculated on the mapped bytes "
+                   << strings::Printf("%08u", actual_crc32c);
+      }
+    }
+    VLOG(1) << "Warmed up " << tensors.size() << " mapped tensors of "
+            << prefix;
+  });
+}
+
+std::shared_ptr<ReadOnlyMemoryRegion> BundleReader::GetMappedDataFile(
+    int32 shard_id) {
+  auto it = mapped_data_.find(shard_id);
+  if (it == mapped_data_.end()) {
+    const string fname = DataFilename(prefix_, shard_id, num_shards_);
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    // Remote file systems implement the mapping by reading the whole file,
+    // which would defeat the purpose.
+    StringPiece scheme, host, path;
+    io::ParseURI(fname, &scheme, &host, &path);
+    if (scheme.empty() || scheme == "file") {
+      Status status = env_->NewReadOnlyMemoryRegionFromFile(fname, &region);
+      if (!status.ok()) {
+        VLOG(1) << "Reading " << fname << " instead of mapping it: " << status;
+        region.reset();
+      }
+    }
+    it = mapped_data_.emplace(shard_id, std::move(region)).first;
+  }
+  return it->second;
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1000,33 +1215,37 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
   const TensorShape full_shape(TensorShape(full_tensor_entry.shape()));
   std::vector<std::pair<TensorSlice, string>> details;
   const string full_tensor_key_string(full_tensor_key);
-  const TensorSliceSet* tss =
-      gtl::FindPtrOrNull(tensor_slices_, full_tensor_key_string);
-
-  // Populates the "full tensor key -> TensorSliceSet" cache.
-  if (tss == nullptr) {
-    if (full_tensor_entry.slices().empty()) {
-      // Special case: a writer has saved a tensor fully, but the reader wants
-      // to read in slices.  We therefore register the full slice on-demand here
-      // without further complicating the on-disk bundle format.
-      TF_RETURN_IF_ERROR(RegisterTensorSlice(
-          full_tensor_key_string, full_shape, full_tensor_entry.dtype(),
-          /* tag */ "",
-          /* full slice */ TensorSlice(full_shape.dims()), &tensor_slices_));
+  {
+    mutex_lock l(mu_);
+    const TensorSliceSet* tss =
+        gtl::FindPtrOrNull(tensor_slices_, full_tensor_key_string);
+
+    // Populates the "full tensor key -> TensorSliceSet" cache.
+    if (tss == nullptr) {
+      if (full_tensor_entry.slices().empty()) {
+        // Special case: a writer has saved a tensor fully, but the reader
+        // wants to read in slices.  We therefore register the full slice
+        // on-demand here without further complicating the on-disk bundle
+        // format.
+        TF_RETURN_IF_ERROR(RegisterTensorSlice(
+            full_tensor_key_string, full_shape, full_tensor_entry.dtype(),
+            /* tag */ "",
+            /* full slice */ TensorSlice(full_shape.dims()), &tensor_slices_));
+      }
+      for (const TensorSliceProto& slice : full_tensor_entry.slices()) {
+        TF_RETURN_IF_ERROR(RegisterTensorSlice(
+            full_tensor_key_string, full_shape, full_tensor_entry.dtype(),
+            /* tag */ "", TensorSlice(slice), &tensor_slices_));
+      }
+      tss = gtl::FindPtrOrNull(tensor_slices_, full_tensor_key_string);
+      CHECK_NE(tss, nullptr);
     }
-    for (const TensorSliceProto& slice : full_tensor_entry.slices()) {
-      TF_RETURN_IF_ERROR(RegisterTensorSlice(
-          full_tensor_key_string, full_shape, full_tensor_entry.dtype(),
-          /* tag */ "", TensorSlice(slice), &tensor_slices_));
+    if (!tss->QueryMeta(slice_spec, &details)) {
+      return errors::InvalidArgument(
+          "Does not have sufficient slices for partitioned tensor ",
+          full_tensor_key,
+          " to restore in slice_spec: ", slice_spec.DebugString());
     }
-    tss = gtl::FindPtrOrNull(tensor_slices_, full_tensor_key_string);
-    CHECK_NE(tss, nullptr);
-  }
-  if (!tss->QueryMeta(slice_spec, &details)) {
-    return errors::InvalidArgument(
-        "Does not have sufficient slices for partitioned tensor ",
-        full_tensor_key,
-        " to restore in slice_spec: ", slice_spec.DebugString());
   }
 
   // The union of the slices in "details" covers "slice_spec".  Performs the
@@ -1042,9 +1261,8 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
       const string encoded_stored_slice_name =
           checkpoint::EncodeTensorNameSlice(full_tensor_key_string,
                                             stored_slice);
-      status_ =
-          GetBundleEntryProto(encoded_stored_slice_name, &stored_slice_entry);
-      if (!status_.ok()) return status_;
+      TF_RETURN_IF_ERROR(
+          GetBundleEntryProto(encoded_stored_slice_name, &stored_slice_entry));
     }
 
     // TODO(zongheng): should we take an OpKernelContext, so that we can call
@@ -1064,13 +1282,11 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
       VLOG(1) << "Optimized for common case: directly copying into "
                  "pre-allocated buffer; spec: "
               << slice_spec.DebugString();
-      status_ = GetValue(stored_slice_entry, val);
-      return status_;
+      return GetValue(stored_slice_entry, val);
     }
 
     Tensor stored_slice_tensor(stored_slice_entry.dtype(), stored_slice_shape);
-    status_ = GetValue(stored_slice_entry, &stored_slice_tensor);
-    if (!status_.ok()) return status_;
+    TF_RETURN_IF_ERROR(GetValue(stored_slice_entry, &stored_slice_tensor));
 
     // Copies the intersection over.
     const DataType common_dtype = full_tensor_entry.dtype();
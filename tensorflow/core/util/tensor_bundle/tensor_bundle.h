@@ -62,8 +62,10 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -77,6 +79,9 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
@@ -177,13 +182,41 @@ class BundleWriter {
 Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
                     StringPiece merged_prefix);
 
+// Declares that the files of the bundle at "prefix" do not change for the life
+// of the process, e.g. because they hold the variables of a loaded SavedModel.
+// Restores of such a bundle map its data files (see
+// BundleReader::Options::map_data_files) by default, so that all processes on
+// a host share one page-cache copy of its tensors.
+void MarkBundleImmutable(StringPiece prefix);
+bool IsBundleImmutable(StringPiece prefix);
+
 // On construction, silently attempts to read the metadata associated with
 // "prefix".  If caller intends to call any function afterwards, "status()"
 // must be checked.
 // All threads accessing the same BundleReader must synchronize.
+//
+// The Lookup*() methods may be called concurrently from multiple threads; the
+// reads of large tensors then proceed in parallel.  The iterator methods
+// (Seek(), Next(), Valid(), key(), value(), ReadCurrent()) and Contains() must
+// be externally synchronized.
 class BundleReader {
  public:
+  struct Options {
+    // Number of threads that read the chunks of a single large tensor in
+    // parallel.  If <= 1, the chunks are issued as one
+    // RandomAccessFile::ReadAsync() batch and the file decides how many of
+    // them are in flight.
+    int num_read_threads = 1;
+    // Size of the chunks that tensors larger than the input buffer are read
+    // in.
+    int64 read_chunk_bytes = 64 << 20;
+    // Whether LookupMapped() may return views of memory-mapped local data
+    // files instead of reading the tensors.
+    bool map_data_files = false;
+  };
+
   BundleReader(Env* const env, StringPiece prefix);
+  BundleReader(Env* const env, StringPiece prefix, const Options& options);
   ~BundleReader();
 
   // Is ok() iff the reader construction is successful (completed the read of
@@ -220,6 +253,22 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Looks up the tensor keyed by "key" into a fresh "val".
+  //
+  // If "Options::map_data_files" is set and the tensor is stored unsliced,
+  // suitably aligned and with the host's endianness in a local data file,
+  // "val" becomes a read-only view of a memory mapping of that file: its
+  // pages are read when first accessed, and kernels copy it before modifying
+  // it.  The checksum of a mapped tensor is not validated here but by
+  // WarmUpMappedTensors().  Otherwise behaves like Lookup().
+  // REQUIRES: status().ok()
+  Status LookupMapped(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
+  // Reads every tensor mapped by LookupMapped() so far on a background
+  // thread, validating its checksum, so that their pages are resident before
+  // kernels first use them.  Checksum mismatches are logged.
+  void WarmUpMappedTensors();
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -271,6 +320,21 @@ class BundleReader {
   Status GetBundleEntryProto(StringPiece key,
                              BundleEntryProto* entry) TF_MUST_USE_RESULT;
 
+  // Returns the buffered data file of shard "shard_id", opening it if needed.
+  Status GetDataFile(int32 shard_id, io::InputBuffer** buffered_file)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+
+  // Returns the memory-mapped data file of shard "shard_id", mapping it if
+  // needed, or null if the file cannot be mapped.
+  std::shared_ptr<ReadOnlyMemoryRegion> GetMappedDataFile(int32 shard_id)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Reads "size" bytes at "offset" of "file" into "buffer", in chunks of
+  // "options_.read_chunk_bytes" that are read in parallel on "read_pool_", or
+  // through "file"'s ReadAsync() without one.
+  Status ReadChunked(RandomAccessFile* file, uint64 offset, uint64 size,
+                     char* buffer) TF_MUST_USE_RESULT;
+
   // Reads the tensor value described by the metadata proto "entry".
   // Usage for "val" follows the comment of "Lookup()".
   Status GetValue(const BundleEntryProto& entry,
@@ -286,6 +350,11 @@ class BundleReader {
 
   Env* env_;  // Not owned.
   const string prefix_;
+  const Options options_;
+
+  // Serializes the uses of "iter_" and of the buffered data files by
+  // concurrent lookups.
+  mutex mu_;
 
   Status status_;
   RandomAccessFile* metadata_;  // Owned.
@@ -293,11 +362,32 @@ class BundleReader {
   table::Cache* index_cache_;
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
-  std::unordered_map<int32, io::InputBuffer*> data_;
+  std::unordered_map<int32, io::InputBuffer*> data_ TF_GUARDED_BY(mu_);
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
-  std::unordered_map<string, checkpoint::TensorSliceSet*> tensor_slices_;
+  std::unordered_map<string, checkpoint::TensorSliceSet*> tensor_slices_
+      TF_GUARDED_BY(mu_);
+
+  // Data files mapped by LookupMapped(), shared with the tensors viewing
+  // them.  Null for files that cannot be mapped.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_ TF_GUARDED_BY(mu_);
+
+  // The tensors returned by LookupMapped() that WarmUpMappedTensors() has not
+  // read yet.
+  struct MappedTensor {
+    std::shared_ptr<ReadOnlyMemoryRegion> region;
+    const char* data;
+    uint64 size;
+    uint32 masked_crc32c;
+    string key;
+  };
+  std::vector<MappedTensor> unwarmed_tensors_ TF_GUARDED_BY(mu_);
+
+  // Reads the chunks of large tensors in parallel.  Null if
+  // "options_.num_read_threads" <= 1.
+  std::unique_ptr<thread::ThreadPool> read_pool_;
 
   // Expected number of data file shards in the bundle.  Extracted by reading
   // the header entry in the metadata table.
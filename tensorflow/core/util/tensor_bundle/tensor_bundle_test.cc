@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
@@ -992,6 +993,86 @@ TEST(TensorBundleTest, TruncatedTensorContents) {
   EXPECT_TRUE(errors::IsOutOfRange(reader.Lookup("key", &val)));
 }
 
+TEST(TensorBundleTest, ChunkedReads) {
+  Env* env = Env::Default();
+  // Larger than the input buffer, so it is read in chunks.
+  Tensor large(DT_FLOAT, TensorShape({1 << 19}));
+  large.flat<float>().setRandom();
+  {
+    BundleWriter writer(env, Prefix("chunked"));
+    TF_EXPECT_OK(writer.Add("large", large));
+    TF_EXPECT_OK(writer.Add("small", Constant_2x3<float>(1.0)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader::Options options;
+  options.num_read_threads = 4;
+  options.read_chunk_bytes = 100000;  // Not a divisor of the tensor size.
+  BundleReader reader(env, Prefix("chunked"), options);
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "large", large);
+  Expect<float>(&reader, "small", Constant_2x3<float>(1.0));
+
+  // Concurrent lookups share the reader.
+  {
+    thread::ThreadPool pool(env, "lookups", 4);
+    for (int i = 0; i < 8; ++i) {
+      pool.Schedule([&reader, &large]() {
+        Tensor large_val(DT_FLOAT, large.shape());
+        TF_EXPECT_OK(reader.Lookup("large", &large_val));
+        test::ExpectTensorEqual<float>(large_val, large);
+        Tensor small_val(DT_FLOAT, TensorShape({2, 3}));
+        TF_EXPECT_OK(reader.Lookup("small", &small_val));
+        test::ExpectTensorEqual<float>(small_val, Constant_2x3<float>(1.0));
+      });
+    }
+  }
+}
+
+TEST(TensorBundleTest, MappedLookups) {
+  Env* env = Env::Default();
+  {
+    BundleWriter::Options writer_options;
+    writer_options.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(env, Prefix("mapped"), writer_options);
+    TF_EXPECT_OK(writer.Add("float", Constant_2x3<float>(1.0)));
+    TF_EXPECT_OK(writer.Add("int", Constant_2x3<int32>(7)));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("foo")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader::Options options;
+  options.map_data_files = true;
+  BundleReader reader(env, Prefix("mapped"), options);
+  TF_ASSERT_OK(reader.status());
+
+  Tensor val;
+  TF_ASSERT_OK(reader.LookupMapped("float", &val));
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(1.0));
+  // A view of the mapping never looks exclusively owned, so kernels copy it
+  // before writing.
+  EXPECT_FALSE(val.RefCountIsOne());
+  TF_ASSERT_OK(reader.LookupMapped("int", &val));
+  test::ExpectTensorEqual<int32>(val, Constant_2x3<int32>(7));
+  EXPECT_FALSE(val.RefCountIsOne());
+
+  // Strings are read as usual.
+  TF_ASSERT_OK(reader.LookupMapped("string", &val));
+  test::ExpectTensorEqual<tstring>(val, Constant_2x3<tstring>("foo"));
+  EXPECT_TRUE(val.RefCountIsOne());
+
+  EXPECT_TRUE(errors::IsNotFound(reader.LookupMapped("missing", &val)));
+  reader.WarmUpMappedTensors();
+}
+
+TEST(TensorBundleTest, ImmutableBundles) {
+  const string prefix = Prefix("immutable");
+  EXPECT_FALSE(IsBundleImmutable(prefix));
+  MarkBundleImmutable(prefix);
+  EXPECT_TRUE(IsBundleImmutable(prefix));
+  EXPECT_FALSE(IsBundleImmutable(Prefix("mutable")));
+}
+
 TEST(TensorBundleTest, HeaderEntry) {
   {
     BundleWriter writer(Env::Default(), Prefix("b"));
@@ -15,10 +15,90 @@ limitations under the License.
 
 #include "tensorflow/core/util/work_sharder.h"
 
+#include <atomic>
+#include <typeinfo>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
+namespace {
+
+std::atomic<bool>* AdaptiveShardCostEnabled() {
+  static std::atomic<bool>* enabled = [] {
+    bool value = false;
+    Status s = ReadBoolFromEnvVar("TF_ADAPTIVE_SHARD_COST", false, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      value = false;
+    }
+    return new std::atomic<bool>(value);
+  }();
+  return enabled;
+}
+
+// Learned per-unit costs, keyed by the type of the "work" callable.
+class AdaptiveShardCostTable {
+ public:
+  static AdaptiveShardCostTable* Global() {
+    static AdaptiveShardCostTable* table = new AdaptiveShardCostTable;
+    return table;
+  }
+
+  // Returns the learned cost for `call_site`, or `cost_per_unit` if there is
+  // none yet.
+  int64 CostPerUnit(const std::type_info& call_site, int64 cost_per_unit) {
+    tf_shared_lock l(mu_);
+    auto it = costs_.find(&call_site);
+    if (it == costs_.end()) return cost_per_unit;
+    return it->second.observed_cost_per_unit;
+  }
+
+  void Record(const std::type_info& call_site, int64 static_cost_per_unit,
+              int64 observed_cost_per_unit) {
+    // Bounds the table if callables are generated at run time.
+    static constexpr size_t kMaxCallSites = 4096;
+    observed_cost_per_unit = std::max(int64{1}, observed_cost_per_unit);
+    mutex_lock l(mu_);
+    auto it = costs_.find(&call_site);
+    if (it == costs_.end()) {
+      if (costs_.size() >= kMaxCallSites) return;
+      AdaptiveShardCost cost;
+      cost.call_site = call_site.name();
+      cost.static_cost_per_unit = static_cost_per_unit;
+      cost.observed_cost_per_unit = observed_cost_per_unit;
+      cost.num_samples = 1;
+      costs_.emplace(&call_site, std::move(cost));
+      return;
+    }
+    AdaptiveShardCost& cost = it->second;
+    cost.static_cost_per_unit = static_cost_per_unit;
+    cost.observed_cost_per_unit =
+        (3 * cost.observed_cost_per_unit + observed_cost_per_unit) / 4;
+    ++cost.num_samples;
+  }
+
+  std::vector<AdaptiveShardCost> Get() {
+    tf_shared_lock l(mu_);
+    std::vector<AdaptiveShardCost> result;
+    result.reserve(costs_.size());
+    for (const auto& it : costs_) {
+      result.push_back(it.second);
+    }
+    return result;
+  }
+
+ private:
+  mutex mu_;
+  absl::flat_hash_map<const std::type_info*, AdaptiveShardCost> costs_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
 
 /* ABSL_CONST_INIT */ thread_local int per_thread_max_parallelism = 1000000;
 
@@ -29,6 +109,18 @@ void SetPerThreadMaxParallelism(int max_parallelism) {
 
 int GetPerThreadMaxParallelism() { return per_thread_max_parallelism; }
 
+void SetAdaptiveShardCostEnabled(bool enabled) {
+  AdaptiveShardCostEnabled()->store(enabled, std::memory_order_relaxed);
+}
+
+bool IsAdaptiveShardCostEnabled() {
+  return AdaptiveShardCostEnabled()->load(std::memory_order_relaxed);
+}
+
+std::vector<AdaptiveShardCost> GetAdaptiveShardCosts() {
+  return AdaptiveShardCostTable::Global()->Get();
+}
+
 void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
            int64 cost_per_unit, std::function<void(int64, int64)> work) {
   CHECK_GE(total, 0);
@@ -41,6 +133,29 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
     work(0, total);
     return;
   }
+  if (IsAdaptiveShardCostEnabled() && work) {
+    const std::type_info& call_site = work.target_type();
+    AdaptiveShardCostTable* table = AdaptiveShardCostTable::Global();
+    const int64 static_cost_per_unit = cost_per_unit;
+    cost_per_unit = table->CostPerUnit(call_site, cost_per_unit);
+    // Time the first shard that starts; the others run untimed. The shards
+    // all finish before Shard() returns, so capturing locals is safe.
+    std::atomic<bool> timed(false);
+    std::function<void(int64, int64)> untimed_work = std::move(work);
+    work = [&untimed_work, &timed, &call_site, table, static_cost_per_unit](
+               int64 start, int64 limit) {
+      if (timed.load(std::memory_order_relaxed) ||
+          timed.exchange(true, std::memory_order_relaxed)) {
+        untimed_work(start, limit);
+        return;
+      }
+      const uint64 start_nanos = EnvTime::NowNanos();
+      untimed_work(start, limit);
+      const int64 elapsed_nanos = EnvTime::NowNanos() - start_nanos;
+      table->Record(call_site, static_cost_per_unit,
+                    elapsed_nanos / std::max(int64{1}, limit - start));
+    };
+  }
   if (max_parallelism >= workers->NumThreads()) {
     workers->ParallelFor(total, cost_per_unit, work);
     return;
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_WORK_SHARDER_H_
 
 #include <functional>
+#include <vector>
 
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/types.h"
@@ -84,6 +85,25 @@ class ScopedPerThreadMaxParallelism {
   int previous_ = -1;
 };
 
+// In the adaptive mode, Shard() times one shard of each call and keeps a
+// running estimate of the nanoseconds per unit of work for each call site
+// (identified by the type of its "work" callable). Later calls from the same
+// site shard according to that estimate instead of "cost_per_unit". The mode
+// is off by default; it is initially enabled by setting the environment
+// variable TF_ADAPTIVE_SHARD_COST=true.
+void SetAdaptiveShardCostEnabled(bool enabled);
+bool IsAdaptiveShardCostEnabled();
+
+// Per-call-site statistics gathered by the adaptive mode, for tuning the
+// static "cost_per_unit" estimates of kernels.
+struct AdaptiveShardCost {
+  string call_site;              // Type name of the "work" callable.
+  int64 static_cost_per_unit;    // Estimate passed by the latest call.
+  int64 observed_cost_per_unit;  // Moving average of the measured cost.
+  int64 num_samples;
+};
+std::vector<AdaptiveShardCost> GetAdaptiveShardCosts();
+
 // Implementation details for Shard().
 class Sharder {
  public:
@@ -16,7 +16,9 @@ limitations under the License.
 #include "tensorflow/core/util/work_sharder.h"
 
 #include <atomic>
+#include <typeinfo>
 #include <vector>
+
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -89,6 +91,32 @@ TEST(Shard, OverflowTest) {
   }
 }
 
+TEST(Shard, AdaptiveCost) {
+  thread::ThreadPool threads(Env::Default(), "test", 4);
+  SetAdaptiveShardCostEnabled(true);
+  auto work = [](int64 start, int64 limit) {
+    for (; start < limit; ++start) {
+      Env::Default()->SleepForMicroseconds(10);
+    }
+  };
+  // The static estimate of 1ns per unit is far below the real cost.
+  for (int i = 0; i < 3; ++i) {
+    Shard(4, &threads, 100, /*cost_per_unit=*/1, work);
+  }
+  SetAdaptiveShardCostEnabled(false);
+
+  const std::type_info& call_site = typeid(work);
+  bool found = false;
+  for (const AdaptiveShardCost& cost : GetAdaptiveShardCosts()) {
+    if (cost.call_site != call_site.name()) continue;
+    found = true;
+    EXPECT_EQ(cost.static_cost_per_unit, 1);
+    EXPECT_GE(cost.observed_cost_per_unit, 10000);
+    EXPECT_EQ(cost.num_samples, 3);
+  }
+  EXPECT_TRUE(found);
+}
+
 void BM_Sharding(::testing::benchmark::State& state) {
   const int arg = state.range(0);
 
@@ -22,6 +22,7 @@ limitations under the License.
 #include <cstdint>
 #include <cstdio>
 #include <memory>
+#include <utility>
 
 #include "tensorflow/lite/core/api/error_reporter.h"
 
@@ -104,7 +105,23 @@ MemoryAllocation::MemoryAllocation(const void* ptr, size_t num_bytes,
   buffer_size_bytes_ = num_bytes;
 }
 
-MemoryAllocation::~MemoryAllocation() {}
+MemoryAllocation::MemoryAllocation(const void* ptr, size_t num_bytes,
+                                   Deleter deleter,
+                                   ErrorReporter* error_reporter)
+    : MemoryAllocation(ptr, num_bytes, error_reporter) {
+  if (valid()) {
+    deleter_ = std::move(deleter);
+  } else if (ptr != nullptr && deleter) {
+    // The buffer is rejected, but it is still owned by the allocation.
+    deleter(ptr, num_bytes);
+  }
+}
+
+MemoryAllocation::~MemoryAllocation() {
+  if (deleter_) {
+    deleter_(buffer_, buffer_size_bytes_);
+  }
+}
 
 const void* MemoryAllocation::base() const { return buffer_; }
 
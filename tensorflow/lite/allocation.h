@@ -21,6 +21,7 @@ limitations under the License.
 
 #include <cstdio>
 #include <cstdlib>
+#include <functional>
 #include <memory>
 
 #include "tensorflow/lite/core/api/error_reporter.h"
@@ -57,7 +58,12 @@ class Allocation {
 };
 
 // Note that not all platforms support MMAP-based allocation.
-// Use `IsSupported()` to check.
+// Use `IsSupported()` to check. It is supported on POSIX systems and on
+// Windows, where the file is mapped with CreateFileMapping.
+//
+// The mapping is read-only and shared, so processes that map the same file
+// share its pages. Any file descriptor that can be mapped works, e.g. one from
+// shm_open() or memfd_create() to supply a model from shared memory.
 class MMAPAllocation : public Allocation {
  public:
   // Loads and maps the provided file to a memory region.
@@ -69,7 +75,7 @@ class MMAPAllocation : public Allocation {
   MMAPAllocation(int fd, ErrorReporter* error_reporter);
 
   // Maps the provided file descriptor, with the given offset and length (both
-  // in bytes), to a memory region.
+  // in bytes), to a memory region. The offset needs no particular alignment.
   // Note: The provided file descriptor will be dup'ed for usage; the caller
   // retains ownership of the provided descriptor and should close accordingly.
   MMAPAllocation(int fd, size_t offset, size_t length,
@@ -89,6 +95,9 @@ class MMAPAllocation : public Allocation {
   int mmap_fd_ = -1;  // mmap file descriptor
   const void* mmapped_buffer_;
   size_t buffer_size_bytes_ = 0;
+  // Offset of the requested region in `mmapped_buffer_`, which starts at the
+  // closest offset in the file that the OS can map.
+  size_t offset_in_buffer_ = 0;
 
  private:
   // Assumes ownership of the provided `owned_fd` instance.
@@ -116,11 +125,23 @@ class FileCopyAllocation : public Allocation {
 
 class MemoryAllocation : public Allocation {
  public:
+  // Releases a buffer region handed over to a MemoryAllocation.
+  using Deleter = std::function<void(const void* ptr, size_t num_bytes)>;
+
   // Provides a (read-only) view of the provided buffer region as an allocation.
   // Note: The caller retains ownership of `ptr`, and must ensure it remains
   // valid for the lifetime of the class instance.
   MemoryAllocation(const void* ptr, size_t num_bytes,
                    ErrorReporter* error_reporter);
+
+  // Same as above, but the allocation takes ownership of `ptr` and calls
+  // `deleter` on it when destroyed. This lets the embedding application place
+  // models wherever it manages memory, e.g. in a shared-memory segment, and
+  // tie the lifetime of that memory to the FlatBufferModel built from the
+  // allocation.
+  MemoryAllocation(const void* ptr, size_t num_bytes, Deleter deleter,
+                   ErrorReporter* error_reporter);
+
   virtual ~MemoryAllocation();
   const void* base() const override;
   size_t bytes() const override;
@@ -129,6 +150,7 @@ class MemoryAllocation : public Allocation {
  private:
   const void* buffer_;
   size_t buffer_size_bytes_ = 0;
+  Deleter deleter_;
 };
 
 }  // namespace tflite
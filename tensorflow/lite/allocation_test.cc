@@ -18,7 +18,10 @@ limitations under the License.
 #include <fcntl.h>
 #endif
 
+#include <cstring>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "tensorflow/lite/testing/util.h"
@@ -100,6 +103,52 @@ TEST(MMAPAllocation, TestValidFileDescriptor) {
 
   close(fd);
 }
+
+TEST(MMAPAllocation, TestUnalignedOffset) {
+  if (!MMAPAllocation::IsSupported()) {
+    return;
+  }
+
+  TestErrorReporter error_reporter;
+  MMAPAllocation whole_file(
+      "tensorflow/lite/testdata/empty_model.bin", &error_reporter);
+  ASSERT_TRUE(whole_file.valid());
+  ASSERT_GT(whole_file.bytes(), 3);
+
+  int fd =
+      open("tensorflow/lite/testdata/empty_model.bin", O_RDONLY);
+  ASSERT_GT(fd, 0);
+  MMAPAllocation allocation(fd, /*offset=*/3,
+                            /*length=*/whole_file.bytes() - 3,
+                            &error_reporter);
+  close(fd);
+  ASSERT_TRUE(allocation.valid());
+  EXPECT_EQ(allocation.bytes(), whole_file.bytes() - 3);
+  EXPECT_EQ(memcmp(allocation.base(),
+                   static_cast<const char*>(whole_file.base()) + 3,
+                   allocation.bytes()),
+            0);
+}
 #endif
 
+TEST(MemoryAllocation, TestDeleter) {
+  std::vector<char> buffer(16);
+  std::vector<std::pair<const void*, size_t>> released;
+  {
+    TestErrorReporter error_reporter;
+    MemoryAllocation allocation(
+        buffer.data(), buffer.size(),
+        [&released](const void* ptr, size_t num_bytes) {
+          released.emplace_back(ptr, num_bytes);
+        },
+        &error_reporter);
+    EXPECT_TRUE(allocation.valid());
+    EXPECT_EQ(allocation.base(), buffer.data());
+    EXPECT_TRUE(released.empty());
+  }
+  ASSERT_EQ(released.size(), 1);
+  EXPECT_EQ(released[0].first, buffer.data());
+  EXPECT_EQ(released[0].second, buffer.size());
+}
+
 }  // namespace tflite
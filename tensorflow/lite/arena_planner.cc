@@ -25,6 +25,7 @@ limitations under the License.
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/minimal_logging.h"
 #include "tensorflow/lite/simple_memory_arena.h"
 
 namespace tflite {
@@ -32,6 +33,9 @@ namespace {
 
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 
+// The number of arena plans that are kept for reuse.
+constexpr size_t kMaxCachedArenaPlans = 4;
+
 }  // namespace
 
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
@@ -82,6 +86,7 @@ TfLiteStatus ArenaPlanner::ResetAllocationsAfter(int node) {
 TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   TF_LITE_ENSURE_STATUS(ResetAllocations());
+  cached_arena_plans_.clear();
   // Maybe other verb instead of 'Assigned'
   alloc_node_.assign(graph_info_->num_tensors(), kNodeNotAssigned);
   dealloc_node_.assign(graph_info_->num_tensors(), kNodeNotAssigned);
@@ -159,7 +164,8 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
     TfLiteIntArray* node_outputs = node.outputs;
     for (int j = 0; j < node_outputs->size; ++j) {
       int tensor_index = node_outputs->data[j];
-      TF_LITE_ENSURE_STATUS(allocate(i, tensor_index));
+      TF_LITE_ENSURE_STATUS(
+          allocate(graph_info_->stage_begin(i), tensor_index));
     }
 
     // Then update the ref-counts of the node's inputs, and if necessary queue
@@ -171,7 +177,8 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
         if (tensor_index != kTfLiteOptionalTensor) {
           refcounts[tensor_index]--;
           if (refcounts[tensor_index] == 0) {
-            TF_LITE_ENSURE_STATUS(deallocate(i, tensor_index));
+            TF_LITE_ENSURE_STATUS(
+                deallocate(graph_info_->stage_end(i), tensor_index));
           }
         }
       }
@@ -198,9 +205,9 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int j = 0; j < node_temporaries->size; ++j) {
       int tensor_index = node_temporaries->data[j];
-      alloc_node_[tensor_index] = i;
+      alloc_node_[tensor_index] = graph_info_->stage_begin(i);
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = graph_info_->stage_end(i);
       }
     }
   }
@@ -249,6 +256,31 @@ bool ArenaPlanner::HasNonPersistentMemory() {
   return arena_.GetBufferSize() != 0;
 }
 
+TfLiteStatus ArenaPlanner::GetNodeArenaUsage(int node_index,
+                                             size_t* arena_bytes,
+                                             size_t* temporary_bytes) {
+  const int num_nodes = static_cast<int>(graph_info_->num_execution_nodes());
+  TF_LITE_ENSURE(context_, node_index >= 0 && node_index < num_nodes);
+  *arena_bytes = 0;
+  for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
+    const ArenaAllocWithUsageInterval& alloc = allocs_[i];
+    if (graph_info_->tensor(i)->allocation_type == kTfLiteArenaRw &&
+        alloc.tensor == i && alloc.size != 0 && alloc.first_node <= node_index &&
+        alloc.last_node >= node_index) {
+      *arena_bytes = std::max(*arena_bytes, alloc.offset + alloc.size);
+    }
+  }
+  *temporary_bytes = 0;
+  const TfLiteIntArray* temporaries = graph_info_->node(node_index).temporaries;
+  for (int i = 0; i < temporaries->size; ++i) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(temporaries->data[i]);
+    if (tensor.allocation_type == kTfLiteArenaRw) {
+      *temporary_bytes += tensor.bytes;
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus ArenaPlanner::Commit() {
   TF_LITE_ENSURE_STATUS(arena_.Commit(context_));
   TF_LITE_ENSURE_STATUS(persistent_arena_.Commit(context_));
@@ -297,9 +329,41 @@ std::vector<int32_t> ArenaPlanner::CreateTensorAllocationVector(int first_node,
 }
 
 TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
+  // Only the plans of the whole arena are kept: the arena is then empty once
+  // the tensors of the interval are deallocated.
+  const bool plans_whole_arena =
+      first_node == 0 &&
+      last_node >= static_cast<int>(graph_info_->num_execution_nodes()) - 1;
+  const std::vector<ArenaAllocWithUsageInterval>* cached_plan =
+      plans_whole_arena ? FindCachedArenaPlan(first_node, last_node) : nullptr;
+
   // Indices of tensors in order their allocation offsets will be calculated.
-  const std::vector<int32_t> tensor_order =
-      CreateTensorAllocationVector(first_node, last_node);
+  std::vector<int32_t> tensor_order;
+  if (cached_plan) {
+    for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
+      if (alloc_node_[i] >= first_node && alloc_node_[i] <= last_node) {
+        tensor_order.push_back(i);
+      }
+    }
+  } else {
+    tensor_order = CreateTensorAllocationVector(first_node, last_node);
+  }
+
+  // The offline planned tensors are placed first, so that the others are
+  // allocated in the gaps left between them.
+  bool use_offline_plan = false;
+  if (plans_whole_arena && !cached_plan && !offline_offsets_.empty()) {
+    use_offline_plan = OfflinePlanFits(tensor_order);
+    if (use_offline_plan) {
+      std::stable_partition(
+          tensor_order.begin(), tensor_order.end(),
+          [this](int32_t i) { return HasOfflinePlannedOffset(i); });
+    } else {
+      TFLITE_LOG_PROD_ONCE(TFLITE_LOG_WARNING,
+                           "The offline planned arena offsets don't fit the "
+                           "tensors, planning them at runtime instead.");
+    }
+  }
 
   // Deallocate if the tensor was already allocated.
   for (const auto& tensor_index : tensor_order) {
@@ -313,7 +377,20 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : tensor_order) {
     TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
-    if (tensor.allocation_type == kTfLiteArenaRw) {
+    if (tensor.allocation_type == kTfLiteArenaRw && cached_plan) {
+      allocs_[tensor_index] = (*cached_plan)[tensor_index];
+      TF_LITE_ENSURE_STATUS(
+          arena_.AllocateAtOffset(context_, allocs_[tensor_index]));
+    } else if (tensor.allocation_type == kTfLiteArenaRw && use_offline_plan &&
+               HasOfflinePlannedOffset(tensor_index)) {
+      ArenaAllocWithUsageInterval& alloc = allocs_[tensor_index];
+      alloc.offset = tensor.bytes == 0 ? 0 : offline_offsets_[tensor_index];
+      alloc.size = tensor.bytes;
+      alloc.tensor = tensor_index;
+      alloc.first_node = alloc_node_[tensor_index];
+      alloc.last_node = dealloc_node_[tensor_index];
+      TF_LITE_ENSURE_STATUS(arena_.AllocateAtOffset(context_, alloc));
+    } else if (tensor.allocation_type == kTfLiteArenaRw) {
       TF_LITE_ENSURE_STATUS(
           arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
                           tensor_index, alloc_node_[tensor_index],
@@ -329,9 +406,91 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
           &allocs_[tensor_index]));
     }
   }
+  if (plans_whole_arena && !cached_plan) {
+    CacheArenaPlan();
+  }
   return kTfLiteOk;
 }
 
+const std::vector<ArenaAllocWithUsageInterval>*
+ArenaPlanner::FindCachedArenaPlan(int first_node, int last_node) {
+  const int num_tensors = graph_info_->num_tensors();
+  auto fits = [&](const std::vector<ArenaAllocWithUsageInterval>& plan) {
+    if (plan.size() != static_cast<size_t>(num_tensors)) return false;
+    for (int i = 0; i < num_tensors; ++i) {
+      const TfLiteTensor& tensor = *graph_info_->tensor(i);
+      const ArenaAllocWithUsageInterval& alloc = plan[i];
+      if (tensor.allocation_type != kTfLiteArenaRw ||
+          alloc_node_[i] < first_node || alloc_node_[i] > last_node) {
+        if (alloc.tensor != -1) return false;
+        continue;
+      }
+      // Zero-sized tensors must stay null.
+      if (alloc.tensor != i || alloc.first_node != alloc_node_[i] ||
+          alloc.last_node != dealloc_node_[i] || alloc.size < tensor.bytes ||
+          (alloc.size == 0) != (tensor.bytes == 0)) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (auto it = cached_arena_plans_.begin(); it != cached_arena_plans_.end();
+       ++it) {
+    if (fits(*it)) {
+      cached_arena_plans_.splice(cached_arena_plans_.begin(),
+                                 cached_arena_plans_, it);
+      return &cached_arena_plans_.front();
+    }
+  }
+  return nullptr;
+}
+
+bool ArenaPlanner::OfflinePlanFits(
+    const std::vector<int32_t>& tensor_order) const {
+  std::vector<ArenaAllocWithUsageInterval> allocs;
+  for (int32_t i : tensor_order) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    if (tensor.allocation_type != kTfLiteArenaRw || tensor.bytes == 0 ||
+        !HasOfflinePlannedOffset(i)) {
+      continue;
+    }
+    if (offline_offsets_[i] % tensor_alignment_ != 0) return false;
+    ArenaAllocWithUsageInterval alloc;
+    alloc.offset = offline_offsets_[i];
+    alloc.size = tensor.bytes;
+    alloc.first_node = alloc_node_[i];
+    alloc.last_node = dealloc_node_[i];
+    allocs.push_back(alloc);
+  }
+  std::sort(allocs.begin(), allocs.end());
+  for (size_t i = 0; i < allocs.size(); ++i) {
+    const ArenaAllocWithUsageInterval& alloc = allocs[i];
+    for (size_t j = i + 1;
+         j < allocs.size() && allocs[j].offset < alloc.offset + alloc.size;
+         ++j) {
+      if (allocs[j].first_node <= alloc.last_node &&
+          alloc.first_node <= allocs[j].last_node) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void ArenaPlanner::CacheArenaPlan() {
+  std::vector<ArenaAllocWithUsageInterval> plan(graph_info_->num_tensors());
+  for (int i = 0; i < static_cast<int>(plan.size()); ++i) {
+    if (graph_info_->tensor(i)->allocation_type == kTfLiteArenaRw &&
+        allocs_[i].tensor == i) {
+      plan[i] = allocs_[i];
+    }
+  }
+  cached_arena_plans_.push_front(std::move(plan));
+  if (cached_arena_plans_.size() > kMaxCachedArenaPlans) {
+    cached_arena_plans_.pop_back();
+  }
+}
+
 TfLiteStatus ArenaPlanner::ResolveTensorAllocation(int tensor_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
@@ -16,7 +16,9 @@ limitations under the License.
 #define TENSORFLOW_LITE_ARENA_PLANNER_H_
 
 #include <cstdint>
+#include <list>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/c/common.h"
@@ -43,6 +45,18 @@ struct AllocationInfo;
 // execution. Since dynamic tensors don't have sizes until after the
 // corresponding operation is executed, this class supports incremental
 // planning.
+//
+// The arena offsets assigned to the tensors of the whole plan are kept for the
+// last few tensor sizes, e.g. the batch sizes that the inputs are resized to.
+// An ExecuteAllocations() of the whole plan reuses the offsets of a kept plan
+// whose tensors are all at least as large as the current ones, instead of
+// assigning offsets again.
+//
+// Offsets planned offline, e.g. by a tool that stored them in the model, can
+// be given with SetOfflinePlannedOffsets(). The tensors that have one are
+// placed there when the whole plan is executed, and the others fill the gaps.
+// The offline plan is ignored if its tensors overlap in the current plan,
+// e.g. after they were resized or their lifetimes changed with delegation.
 class ArenaPlanner : public MemoryPlanner {
  public:
   // Ownership of 'context' is not taken and it must remain util the
@@ -62,10 +76,19 @@ class ArenaPlanner : public MemoryPlanner {
   TfLiteStatus ReleaseNonPersistentMemory() override;
   TfLiteStatus AcquireNonPersistentMemory() override;
   bool HasNonPersistentMemory() override;
+  TfLiteStatus GetNodeArenaUsage(int node_index, size_t* arena_bytes,
+                                 size_t* temporary_bytes) override;
 
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Sets the arena offsets of the tensors, indexed by tensor. A negative
+  // offset leaves the tensor to the online planner, as do the tensors past the
+  // end of `offsets`.
+  void SetOfflinePlannedOffsets(std::vector<int32_t> offsets) {
+    offline_offsets_ = std::move(offsets);
+  }
+
  private:
   // Make sure all the arenas have reserved enough memory to store all their
   // tensors.
@@ -85,6 +108,25 @@ class ArenaPlanner : public MemoryPlanner {
   // for all tensors affected by ops in the interval [first_node, last_node].
   TfLiteStatus CalculateAllocations(int first_node, int last_node);
 
+  // Returns a kept plan of the arena in which the current tensors of the
+  // interval [first_node, last_node] fit, or nullptr.
+  const std::vector<ArenaAllocWithUsageInterval>* FindCachedArenaPlan(
+      int first_node, int last_node);
+
+  // Keeps the current plan of the arena.
+  void CacheArenaPlan();
+
+  // Returns whether `tensor_index` has an offline planned offset.
+  bool HasOfflinePlannedOffset(int tensor_index) const {
+    return tensor_index < static_cast<int>(offline_offsets_.size()) &&
+           offline_offsets_[tensor_index] >= 0;
+  }
+
+  // Returns whether the tensors in `tensor_order` that have an offline planned
+  // offset can be placed there: the offsets must be aligned, and tensors whose
+  // usage intervals intersect must not overlap in the arena.
+  bool OfflinePlanFits(const std::vector<int32_t>& tensor_order) const;
+
   // Assign absolute memory location to a tensor, based on its relative
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int tensor_index);
@@ -126,6 +168,15 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
+
+  // The kept plans of the arena, most recently used first. Each plan holds
+  // the allocation of every tensor, which is reset for the tensors that aren't
+  // in the arena.
+  std::list<std::vector<ArenaAllocWithUsageInterval>> cached_arena_plans_;
+
+  // The offline planned arena offsets of the tensors, see
+  // SetOfflinePlannedOffsets().
+  std::vector<int32_t> offline_offsets_;
 };
 
 }  // namespace tflite
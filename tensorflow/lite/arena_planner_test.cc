@@ -114,11 +114,17 @@ class TestGraph {
   const std::vector<int>& inputs() { return inputs_; }
   const std::vector<int>& outputs() { return outputs_; }
   const std::vector<int>& variables() { return variables_; }
+  const std::vector<std::pair<int, int>>& stages() { return stages_; }
 
   void SetVariables(const std::vector<int>& variables) {
     variables_ = variables;
   }
 
+  // Sets the first and the last node of the stage of each node.
+  void SetStages(const std::vector<std::pair<int, int>>& stages) {
+    stages_ = stages;
+  }
+
   void Swap(TestGraph* other) {
     std::swap(nodes_, other->nodes_);
     std::swap(tensors_, other->tensors_);
@@ -133,6 +139,7 @@ class TestGraph {
   std::vector<int> inputs_;
   std::vector<int> outputs_;
   std::vector<int> variables_;
+  std::vector<std::pair<int, int>> stages_;
 };
 
 // The GraphInfo for a TestGraph.
@@ -155,6 +162,12 @@ class TestGraphInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return graph_->variables();
   }
+  size_t stage_begin(size_t index) const override {
+    return graph_->stages().empty() ? index : graph_->stages()[index].first;
+  }
+  size_t stage_end(size_t index) const override {
+    return graph_->stages().empty() ? index : graph_->stages()[index].second;
+  }
 
  private:
   TestGraph* graph_;
@@ -333,6 +346,35 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithTemporary) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, NodeArenaUsage) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},   // First op
+                      {{2, 0}, {4}, {5}},  // Second op, with temporary
+                      {{4}, {3}, {}}       // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  const std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  size_t arena_bytes = 0;
+  size_t temporary_bytes = 0;
+  ASSERT_EQ(planner_->GetNodeArenaUsage(1, &arena_bytes, &temporary_bytes),
+            kTfLiteOk);
+  EXPECT_EQ(arena_bytes, GetOffset(2) + tensors[2].bytes);
+  EXPECT_EQ(temporary_bytes, tensors[5].bytes);
+
+  ASSERT_EQ(planner_->GetNodeArenaUsage(2, &arena_bytes, &temporary_bytes),
+            kTfLiteOk);
+  EXPECT_EQ(arena_bytes, GetOffset(4) + tensors[4].bytes);
+  EXPECT_EQ(temporary_bytes, 0);
+
+  EXPECT_EQ(planner_->GetNodeArenaUsage(3, &arena_bytes, &temporary_bytes),
+            kTfLiteError);
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphWithResetAllocationsAfter) {
   TestGraph graph({0, 1},
                   {
@@ -573,6 +615,105 @@ TEST_F(ArenaPlannerTest, LargerGraphAndStepwiseAllocation) {
   EXPECT_EQ(GetOffset(10), 12);
 }
 
+TEST_F(ArenaPlannerTest, ReusesPlanForSmallerTensors) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+  const std::ptrdiff_t offset3 = GetOffset(3);
+  const std::ptrdiff_t offset4 = GetOffset(4);
+
+  // A new plan would put tensor 4 first, but the tensors still fit in the
+  // memory planned for the larger ones.
+  (*graph.tensors())[5].bytes = 4;
+  ASSERT_EQ(planner_->ResetAllocations(), kTfLiteOk);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(3), offset3);
+  EXPECT_EQ(GetOffset(4), offset4);
+
+  // A larger tensor needs a new plan.
+  (*graph.tensors())[5].bytes = 40;
+  ASSERT_EQ(planner_->ResetAllocations(), kTfLiteOk);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+}
+
+TEST_F(ArenaPlannerTest, OfflinePlannedOffsets) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  planner_->SetOfflinePlannedOffsets({0, 4, -1, -1, 100, 200});
+  Execute(0, 10);
+
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), 4);
+  EXPECT_EQ(GetOffset(4), 100);
+  EXPECT_EQ(GetOffset(5), 200);
+  // The other tensors go to the smallest gap between them that fits.
+  EXPECT_EQ(GetOffset(2), 116);
+  EXPECT_EQ(GetOffset(3), 116);
+}
+
+TEST_F(ArenaPlannerTest, OfflinePlanIgnoredIfTensorsOverlap) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  // Tensors 4 and 5 are both used by the third op.
+  planner_->SetOfflinePlannedOffsets({-1, -1, -1, -1, 100, 104});
+  Execute(0, 10);
+
+  EXPECT_EQ(GetOffset(5), 12);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+}
+
+TEST_F(ArenaPlannerTest, ConcurrentNodesDontShareMemory) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {3}, {}},  // First op
+                      {{3}, {4}, {}},  // Second op
+                      {{0}, {1}, {}}   // Third op
+                  },
+                  {4, 1});
+  SetGraph(&graph);
+  Execute(0, 10);
+  // The output of the third op reuses the memory of the output of the first.
+  EXPECT_EQ(GetOffset(1), GetOffset(3));
+
+  TestGraph staged_graph({0},
+                         {
+                             /* in, out, tmp */
+                             {{0}, {3}, {}},  // First op
+                             {{3}, {4}, {}},  // Second op
+                             {{0}, {1}, {}}   // Third op
+                         },
+                         {4, 1});
+  // The second and the third op run concurrently.
+  staged_graph.SetStages({{0, 0}, {1, 2}, {1, 2}});
+  SetGraph(&staged_graph);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(3));
+}
+
 TEST_F(ArenaPlannerTest, ModifiedGraph) {
   TestGraph graph({0, 1},
                   {
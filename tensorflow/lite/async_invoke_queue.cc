@@ -0,0 +1,66 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/async_invoke_queue.h"
+
+#include <utility>
+
+namespace tflite {
+
+AsyncInvokeQueue::AsyncInvokeQueue()
+    : worker_(&AsyncInvokeQueue::WorkerLoop, this) {}
+
+AsyncInvokeQueue::~AsyncInvokeQueue() {
+  Wait();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  task_available_.notify_one();
+  worker_.join();
+}
+
+void AsyncInvokeQueue::Enqueue(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+    ++num_unfinished_tasks_;
+  }
+  task_available_.notify_one();
+}
+
+void AsyncInvokeQueue::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  tasks_done_.wait(lock, [this] { return num_unfinished_tasks_ == 0; });
+}
+
+void AsyncInvokeQueue::WorkerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_available_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty()) return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--num_unfinished_tasks_ == 0) {
+      tasks_done_.notify_all();
+    }
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,59 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_ASYNC_INVOKE_QUEUE_H_
+#define TENSORFLOW_LITE_ASYNC_INVOKE_QUEUE_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <deque>
+#include <functional>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+
+namespace tflite {
+
+// Runs the tasks it is given one after the other, in order, on a thread of its
+// own. The interpreter uses it to run asynchronous invocations.
+class AsyncInvokeQueue {
+ public:
+  AsyncInvokeQueue();
+
+  // Waits for the enqueued tasks to finish.
+  ~AsyncInvokeQueue();
+
+  // Enqueues `task` and returns without waiting for it to run.
+  void Enqueue(std::function<void()> task);
+
+  // Waits until all the enqueued tasks have finished.
+  void Wait();
+
+ private:
+  void WorkerLoop();
+
+  std::mutex mutex_;
+  std::condition_variable task_available_;
+  std::condition_variable tasks_done_;
+  std::deque<std::function<void()>> tasks_;
+  // The number of tasks enqueued that haven't finished yet.
+  int num_unfinished_tasks_ = 0;
+  bool stop_ = false;
+  std::thread worker_;
+
+  AsyncInvokeQueue(const AsyncInvokeQueue&) = delete;
+  AsyncInvokeQueue& operator=(const AsyncInvokeQueue&) = delete;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_ASYNC_INVOKE_QUEUE_H_
@@ -92,6 +92,14 @@ class Profiler {
                         uint64_t end, int64_t event_metadata1,
                         int64_t event_metadata2) {}
 
+  // Reports the tensor arena memory in use while the operator node
+  // `event_metadata1` runs, once it has been invoked: `arena_bytes` is the
+  // high-water mark of the non-persistent arena at that node and
+  // `temporary_bytes` the part of it held by the node's temporaries.
+  // `event_metadata2` is interpreted as for an OPERATOR_INVOKE_EVENT.
+  virtual void AddArenaUsage(int64_t event_metadata1, int64_t event_metadata2,
+                             uint64_t arena_bytes, uint64_t temporary_bytes) {}
+
  protected:
   friend class ScopedProfile;
 };
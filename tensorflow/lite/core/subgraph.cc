@@ -156,6 +156,17 @@ const char* GetTFLiteOpName(const TfLiteRegistration& op_reg) {
   return tflite::EnumNamesBuiltinOperator()[op_reg.builtin_code];
 }
 
+// Returns the allocation of `bytes` at the first address of `buffer` aligned
+// for tensor data. `buffer` is kDefaultTensorAlignment bytes larger.
+TfLiteCustomAllocation AlignedStateBuffer(const std::unique_ptr<char[]>& buffer,
+                                          size_t bytes) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(buffer.get());
+  const size_t padding =
+      (kDefaultTensorAlignment - address % kDefaultTensorAlignment) %
+      kDefaultTensorAlignment;
+  return {buffer.get() + padding, bytes};
+}
+
 }  // namespace
 
 // A trivial implementation of GraphInfo around the Interpreter.
@@ -191,6 +202,12 @@ class InterpreterInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return subgraph_->variables();
   }
+  size_t stage_begin(size_t index) const override {
+    return subgraph_->stage_begin(index);
+  }
+  size_t stage_end(size_t index) const override {
+    return subgraph_->stage_end(index);
+  }
 
  public:
   Subgraph* subgraph_;
@@ -404,6 +421,7 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 #endif  // __ANDROID__
 
   execution_plan_.clear();
+  execution_plan_stages_.clear();
 
   for (auto& node_subset : node_subsets) {
     // Subsets claimed by the delegate should have a "macro" op created, the
@@ -699,11 +717,32 @@ TfLiteStatus Subgraph::AllocateTensors() {
   next_execution_plan_index_to_prepare_ = 0;
   next_execution_plan_index_to_plan_allocation_ = 0;
   next_original_execution_plan_index_to_prepare_ = 0;
+  TF_LITE_ENSURE_STATUS(ScheduleConcurrentNodes());
   if (memory_planner_) {
     TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
   }
+  TF_LITE_ENSURE_STATUS(AllocateStateTensors());
 
   TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
+  for (const StateTensorBinding& binding : state_tensor_bindings_) {
+    if (tensors_[binding.output_tensor].bytes !=
+        tensors_[binding.input_tensor].bytes) {
+      ReportError("State tensors %d and %d have different sizes.",
+                  binding.input_tensor, binding.output_tensor);
+      return kTfLiteError;
+    }
+  }
+
+  if (has_dynamic_tensors_ && !execution_plan_stages_.empty()) {
+    // Dynamic tensors are allocated while the nodes run, so plan the memory
+    // again for running the nodes one at a time.
+    execution_plan_stages_.clear();
+    next_execution_plan_index_to_prepare_ = 0;
+    next_execution_plan_index_to_plan_allocation_ = 0;
+    next_original_execution_plan_index_to_prepare_ = 0;
+    TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+    TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
+  }
 
   state_ = kStateInvokable;
 
@@ -804,6 +843,7 @@ TfLiteStatus Subgraph::AddNodeWithParameters(
   // Copying of registration is required to support unresolved custom ops.
   node_and_reg.second = *registration;
   execution_plan_.push_back(new_node_index);
+  execution_plan_stages_.clear();
   return kTfLiteOk;
 }
 
@@ -964,9 +1004,11 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
 
 TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   if (!memory_planner_) {
-    memory_planner_.reset(new ArenaPlanner(
+    auto* arena_planner = new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this)),
-        preserve_all_tensors_, kDefaultTensorAlignment));
+        preserve_all_tensors_, kDefaultTensorAlignment);
+    arena_planner->SetOfflinePlannedOffsets(offline_planned_offsets_);
+    memory_planner_.reset(arena_planner);
     memory_planner_->PlanAllocations();
   }
 
@@ -1027,6 +1069,180 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::EnsureNodeInputsHaveData(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+bool Subgraph::CanRunConcurrently(
+    const TfLiteNode& node, const TfLiteRegistration& registration) const {
+  if (node.delegate != nullptr || node.might_have_side_effect ||
+      registration.builtin_code == kTfLiteBuiltinCustom ||
+      registration.builtin_code == kTfLiteBuiltinDelegate ||
+      registration.builtin_code == kTfLiteBuiltinCall ||
+      registration.builtin_code == kTfLiteBuiltinCallOnce ||
+      registration.builtin_code == kTfLiteBuiltinIf ||
+      registration.builtin_code == kTfLiteBuiltinWhile) {
+    return false;
+  }
+  for (const TfLiteIntArray* tensor_indices : {node.inputs, node.outputs}) {
+    for (int i = 0; i < tensor_indices->size; ++i) {
+      int tensor_index = tensor_indices->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) {
+        continue;
+      }
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      if (tensor.is_variable || tensor.type == kTfLiteResource ||
+          tensor.type == kTfLiteVariant) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TfLiteStatus Subgraph::ScheduleConcurrentNodes() {
+  const bool had_stages = !execution_plan_stages_.empty();
+  execution_plan_stages_.clear();
+  if (inter_op_thread_pool_ == nullptr ||
+      inter_op_thread_pool_->num_threads() < 2) {
+    if (had_stages && memory_planner_) {
+      return memory_planner_->PlanAllocations();
+    }
+    return kTfLiteOk;
+  }
+
+  // A node runs one level after the latest of the nodes that produce its
+  // inputs. A node that can't run concurrently with others gets a level of
+  // its own, after the levels of all the nodes before it in the execution
+  // plan and before the levels of all the nodes after it.
+  const int num_nodes = execution_plan_.size();
+  std::vector<int> tensor_levels(tensors_.size(), -1);
+  std::vector<int> node_levels(num_nodes);
+  int min_level = 0;
+  int max_level = -1;
+  for (int i = 0; i < num_nodes; ++i) {
+    const auto& node_and_registration =
+        nodes_and_registration_[execution_plan_[i]];
+    const TfLiteNode& node = node_and_registration.first;
+    int level = min_level;
+    if (CanRunConcurrently(node, node_and_registration.second)) {
+      for (int j = 0; j < node.inputs->size; ++j) {
+        int tensor_index = node.inputs->data[j];
+        if (tensor_index != kTfLiteOptionalTensor) {
+          level = std::max(level, tensor_levels[tensor_index] + 1);
+        }
+      }
+    } else {
+      level = max_level + 1;
+      min_level = level + 1;
+    }
+    for (int j = 0; j < node.outputs->size; ++j) {
+      int tensor_index = node.outputs->data[j];
+      if (tensor_index != kTfLiteOptionalTensor) {
+        tensor_levels[tensor_index] = level;
+      }
+    }
+    node_levels[i] = level;
+    max_level = std::max(max_level, level);
+  }
+
+  std::vector<int> order(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&node_levels](int a, int b) {
+    return node_levels[a] < node_levels[b];
+  });
+  std::vector<int> new_plan(num_nodes);
+  execution_plan_stages_.resize(num_nodes);
+  for (int begin = 0; begin < num_nodes;) {
+    int end = begin;
+    while (end + 1 < num_nodes &&
+           node_levels[order[end + 1]] == node_levels[order[begin]]) {
+      ++end;
+    }
+    for (int i = begin; i <= end; ++i) {
+      new_plan[i] = execution_plan_[order[i]];
+      execution_plan_stages_[i] = {begin, end};
+    }
+    begin = end + 1;
+  }
+  execution_plan_ = std::move(new_plan);
+
+  if (memory_planner_) {
+    return memory_planner_->PlanAllocations();
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::InvokeConcurrentStage(int first_execution_plan_index,
+                                             int last_execution_plan_index) {
+  const int num_nodes =
+      last_execution_plan_index - first_execution_plan_index + 1;
+  for (int i = first_execution_plan_index; i <= last_execution_plan_index;
+       ++i) {
+    const auto& node_and_registration =
+        nodes_and_registration_[execution_plan_[i]];
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsHaveData(
+        node_and_registration.first, node_and_registration.second));
+  }
+
+  if (check_cancelled_func_ != nullptr &&
+      check_cancelled_func_(cancellation_data_)) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+
+  EnsureTensorsVectorCapacity();
+  std::vector<TfLiteStatus> statuses(num_nodes, kTfLiteOk);
+  inter_op_thread_pool_->Run(num_nodes, [&](int i) {
+    auto& node_and_registration =
+        nodes_and_registration_[execution_plan_[first_execution_plan_index +
+                                                i]];
+    statuses[i] =
+        OpInvoke(node_and_registration.second, &node_and_registration.first);
+  });
+  for (int i = 0; i < num_nodes; ++i) {
+    if (statuses[i] != kTfLiteOk) {
+      int node_index = execution_plan_[first_execution_plan_index + i];
+      return ReportOpError(&context_, nodes_and_registration_[node_index].first,
+                           nodes_and_registration_[node_index].second,
+                           node_index, "failed to invoke");
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::Invoke() {
   if (!consistent_) {
     ReportError("Invoke called on model that is not consistent.");
@@ -1042,8 +1258,12 @@ TfLiteStatus Subgraph::Invoke() {
     return kTfLiteError;
   }
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "Invoke");
+  if (state_tensors_swap_pending_) {
+    TF_LITE_ENSURE_STATUS(SwapStateTensors());
+  }
 
-  // Invocations are always done in node order.
+  // Invocations are always done in node order, except that the nodes of a
+  // stage may run concurrently.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
   // called.
@@ -1054,6 +1274,15 @@ TfLiteStatus Subgraph::Invoke() {
       TF_LITE_ENSURE(&context_, next_execution_plan_index_to_prepare_ >=
                                     execution_plan_index);
     }
+    // The profiler records one op at a time, so nodes that may run
+    // concurrently run one at a time while profiling.
+    if (stage_end(execution_plan_index) > execution_plan_index && !profiler_) {
+      const int last_execution_plan_index = stage_end(execution_plan_index);
+      TF_LITE_ENSURE_STATUS(InvokeConcurrentStage(execution_plan_index,
+                                                  last_execution_plan_index));
+      execution_plan_index = last_execution_plan_index;
+      continue;
+    }
     int node_index = execution_plan_[execution_plan_index];
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
@@ -1063,37 +1292,7 @@ TfLiteStatus Subgraph::Invoke() {
     if (profiler_) op_name = GetTFLiteOpName(registration);
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(profiler_.get(), op_name, node_index);
 
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
-    }
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsHaveData(node, registration));
 
     if (check_cancelled_func_ != nullptr &&
         check_cancelled_func_(cancellation_data_)) {
@@ -1107,6 +1306,15 @@ TfLiteStatus Subgraph::Invoke() {
       return ReportOpError(&context_, node, registration, node_index,
                            "failed to invoke");
     }
+    if (profiler_ && memory_planner_) {
+      size_t arena_bytes = 0;
+      size_t temporary_bytes = 0;
+      if (memory_planner_->GetNodeArenaUsage(execution_plan_index, &arena_bytes,
+                                             &temporary_bytes) == kTfLiteOk) {
+        profiler_->AddArenaUsage(node_index, /*event_metadata2=*/0,
+                                 arena_bytes, temporary_bytes);
+      }
+    }
 
     // Force execution prep for downstream ops if the latest op triggered the
     // resize of a dynamic tensor.
@@ -1129,6 +1337,9 @@ TfLiteStatus Subgraph::Invoke() {
     }
   }
 
+  if (status == kTfLiteOk) {
+    state_tensors_swap_pending_ = !state_tensor_bindings_.empty();
+  }
   return status;
 }
 
@@ -1342,6 +1553,7 @@ TfLiteStatus Subgraph::SetExecutionPlan(const std::vector<int>& new_plan) {
                                   node_index < nodes_and_registration_.size());
   }
   execution_plan_ = new_plan;
+  execution_plan_stages_.clear();
   return kTfLiteOk;
 }
 
@@ -1437,6 +1649,7 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
   // Reset execution plan.
   execution_plan_ = pre_delegation_execution_plan_;
   pre_delegation_execution_plan_.clear();
+  execution_plan_stages_.clear();
 
   // Handling FP16 delegation (if applies).
   //
@@ -1691,6 +1904,85 @@ TfLiteStatus Subgraph::SetCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::SetStateTensorBinding(int input_tensor,
+                                             int output_tensor) {
+  const int num_tensors = static_cast<int>(tensors_size());
+  TF_LITE_ENSURE(&context_, input_tensor >= 0 && input_tensor < num_tensors);
+  TF_LITE_ENSURE(&context_, output_tensor >= 0 && output_tensor < num_tensors);
+  if (std::find(inputs_.begin(), inputs_.end(), input_tensor) ==
+          inputs_.end() ||
+      std::find(outputs_.begin(), outputs_.end(), output_tensor) ==
+          outputs_.end()) {
+    ReportError("State tensors must be an input and an output of the graph.");
+    return kTfLiteError;
+  }
+  for (const StateTensorBinding& binding : state_tensor_bindings_) {
+    if (binding.input_tensor == input_tensor ||
+        binding.output_tensor == output_tensor) {
+      ReportError("Tensor %d or %d is already bound to a state tensor.",
+                  input_tensor, output_tensor);
+      return kTfLiteError;
+    }
+  }
+  TF_LITE_ENSURE_TYPES_EQ(&context_, tensors_[input_tensor].type,
+                          tensors_[output_tensor].type);
+
+  StateTensorBinding binding;
+  binding.input_tensor = input_tensor;
+  binding.output_tensor = output_tensor;
+  state_tensor_bindings_.push_back(std::move(binding));
+  // The buffers are allocated with the other tensors.
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::ResetStateTensors() {
+  for (const StateTensorBinding& binding : state_tensor_bindings_) {
+    TfLiteTensor& input = tensors_[binding.input_tensor];
+    if (input.data.raw != nullptr) {
+      memset(input.data.raw, 0, input.bytes);
+    }
+  }
+  state_tensors_swap_pending_ = false;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::AllocateStateTensors() {
+  for (StateTensorBinding& binding : state_tensor_bindings_) {
+    const size_t bytes = tensors_[binding.input_tensor].bytes;
+    if (!binding.buffers[0] || binding.bytes < bytes) {
+      for (std::unique_ptr<char[]>& buffer : binding.buffers) {
+        buffer.reset(new char[bytes + kDefaultTensorAlignment]);
+      }
+      binding.bytes = bytes;
+    }
+    binding.input_buffer = 0;
+    TF_LITE_ENSURE_STATUS(SetCustomAllocationForTensor(
+        binding.input_tensor,
+        AlignedStateBuffer(binding.buffers[0], binding.bytes)));
+    TF_LITE_ENSURE_STATUS(SetCustomAllocationForTensor(
+        binding.output_tensor,
+        AlignedStateBuffer(binding.buffers[1], binding.bytes)));
+  }
+  return ResetStateTensors();
+}
+
+TfLiteStatus Subgraph::SwapStateTensors() {
+  for (StateTensorBinding& binding : state_tensor_bindings_) {
+    binding.input_buffer = 1 - binding.input_buffer;
+    TF_LITE_ENSURE_STATUS(SetCustomAllocationForTensor(
+        binding.input_tensor,
+        AlignedStateBuffer(binding.buffers[binding.input_buffer],
+                           binding.bytes)));
+    TF_LITE_ENSURE_STATUS(SetCustomAllocationForTensor(
+        binding.output_tensor,
+        AlignedStateBuffer(binding.buffers[1 - binding.input_buffer],
+                           binding.bytes)));
+  }
+  state_tensors_swap_pending_ = false;
+  return kTfLiteOk;
+}
+
 void Subgraph::SetName(const char* name) {
   if (name) {
     name_ = name;
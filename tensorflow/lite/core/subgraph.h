@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/inter_op_thread_pool.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/util.h"
 
@@ -270,6 +271,29 @@ class Subgraph {
   // WARNING: This is an experimental API and subject to change.
   void SetCancellationFunction(void* data, bool (*check_cancelled_func)(void*));
 
+  // Runs the nodes that don't depend on each other concurrently on `pool`,
+  // which must outlive the subgraph, or runs the nodes one at a time if `pool`
+  // is null. Takes effect in the next call to AllocateTensors(), which reorders
+  // the execution plan into stages of independent nodes.
+  // WARNING: This is an experimental API and subject to change.
+  void SetInterOpThreadPool(InterOpThreadPool* pool) {
+    inter_op_thread_pool_ = pool;
+    state_ = kStateUninvokable;
+  }
+
+  // Returns the execution plan indices of the first and the last node of the
+  // stage of the node at execution plan index `index`.
+  size_t stage_begin(size_t index) const {
+    return index < execution_plan_stages_.size()
+               ? execution_plan_stages_[index].first
+               : index;
+  }
+  size_t stage_end(size_t index) const {
+    return index < execution_plan_stages_.size()
+               ? execution_plan_stages_[index].second
+               : index;
+  }
+
   // Ensure the data in `tensor.data` is readable. In case delegate is used,
   // it might require to copy the data from delegate buffer to raw memory.
   // WARNING: This is an experimental API and subject to change.
@@ -351,6 +375,34 @@ class Subgraph {
       int tensor_index, const TfLiteCustomAllocation& allocation,
       int64_t flags = kTfLiteCustomAllocationFlagsNone);
 
+  // Binds the output `output_tensor` to the input `input_tensor`, so that a
+  // state streams through successive Invoke() calls without being copied:
+  // each Invoke() reads from `input_tensor` the state that the previous one
+  // wrote to `output_tensor`. The two tensors get custom allocations from a
+  // pair of buffers owned by the subgraph, which trade places at the start of
+  // every Invoke() that follows a successful one. The state written by the
+  // last Invoke() thus stays readable from `output_tensor` until the next.
+  //
+  // The tensors must have the same type and size. The state is zero after
+  // AllocateTensors() and ResetStateTensors(); a different initial state can
+  // be written to `input_tensor` after either call.
+  //
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus SetStateTensorBinding(int input_tensor, int output_tensor);
+
+  // Zeroes the state of the tensors bound by SetStateTensorBinding().
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus ResetStateTensors();
+
+  // Sets arena offsets planned offline for the tensors, indexed by tensor,
+  // e.g. the ones stored in the "OfflineMemoryAllocation" model metadata. A
+  // negative offset leaves the tensor to the runtime planner. Must be called
+  // before the tensors are allocated.
+  // WARNING: This is an experimental interface that is subject to change.
+  void SetOfflinePlannedOffsets(std::vector<int32_t> offsets) {
+    offline_planned_offsets_ = std::move(offsets);
+  }
+
   void SetName(const char* name);
   const std::string& GetName() const;
 
@@ -394,6 +446,14 @@ class Subgraph {
                           subgraph_index_);
     }
 
+    void AddArenaUsage(int64_t event_metadata1, int64_t event_metadata2,
+                       uint64_t arena_bytes,
+                       uint64_t temporary_bytes) override {
+      if (!profiler_) return;
+      profiler_->AddArenaUsage(event_metadata1, subgraph_index_, arena_bytes,
+                               temporary_bytes);
+    }
+
    private:
     // Not own the memory.
     Profiler* const profiler_;
@@ -442,6 +502,31 @@ class Subgraph {
     return op_reg.invoke(&context_, node);
   }
 
+  // Makes sure that the inputs of 'node' have data that the CPU can read.
+  TfLiteStatus EnsureNodeInputsHaveData(const TfLiteNode& node,
+                                        const TfLiteRegistration& registration);
+
+  // Returns whether 'node' may run concurrently with other nodes: it must
+  // neither be delegated, nor be a custom or control flow op, nor use variable
+  // or resource tensors, whose uses the graph doesn't order.
+  bool CanRunConcurrently(const TfLiteNode& node,
+                          const TfLiteRegistration& registration) const;
+
+  // Reorders the execution plan into stages of nodes that don't depend on each
+  // other, if an InterOpThreadPool is set, and plans the memory accordingly.
+  TfLiteStatus ScheduleConcurrentNodes();
+
+  // Gives the tensors bound by SetStateTensorBinding() buffers large enough
+  // for their current size, and zeroes the state.
+  TfLiteStatus AllocateStateTensors();
+
+  // Makes the state written by the last Invoke() the input of the next.
+  TfLiteStatus SwapStateTensors();
+
+  // Invokes the nodes at execution plan indices [first, last] concurrently.
+  TfLiteStatus InvokeConcurrentStage(int first_execution_plan_index,
+                                     int last_execution_plan_index);
+
   // Call OpPrepare() for as many ops as possible, allocating memory for their
   // tensors. If an op containing dynamic tensors is found, preparation will be
   // postponed until this function is called again. This allows the interpreter
@@ -739,6 +824,22 @@ class Subgraph {
   // Contains <tensor idx, custom allocation> pairs for all applicable tensors.
   std::vector<std::pair<int, TfLiteCustomAllocation>> custom_allocations_;
 
+  // An input and an output tensor bound by SetStateTensorBinding(), with the
+  // two buffers they alternate between.
+  struct StateTensorBinding {
+    int input_tensor;
+    int output_tensor;
+    std::unique_ptr<char[]> buffers[2];
+    // The aligned usable size of each of the buffers.
+    size_t bytes = 0;
+    // The index of the buffer that backs `input_tensor`.
+    int input_buffer = 0;
+  };
+  std::vector<StateTensorBinding> state_tensor_bindings_;
+
+  // Whether the state tensors have to be swapped before the next Invoke().
+  bool state_tensors_swap_pending_ = false;
+
   // Tracking bit for whether a tensor was resized in the course of an op
   // invocation. This is a useful hint to ensure that dynamic tensor outputs
   // trigger downstream reallocation after op invocation.
@@ -782,6 +883,17 @@ class Subgraph {
   // Whether memory planner should be instantiated to retain intermediates for
   // debugging.
   bool preserve_all_tensors_ = false;
+
+  // The arena offsets given to SetOfflinePlannedOffsets().
+  std::vector<int32_t> offline_planned_offsets_;
+
+  // The thread pool that runs independent nodes concurrently, or nullptr.
+  // Owned by the interpreter.
+  InterOpThreadPool* inter_op_thread_pool_ = nullptr;
+
+  // The first and the last execution plan index of the stage of each node of
+  // the execution plan, or empty if the nodes run one at a time.
+  std::vector<std::pair<int, int>> execution_plan_stages_;
 };
 
 }  // namespace tflite
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/lite/delegates/gpu/cl/gl_interop.h"
 
+#include <utility>
+
 #include "absl/strings/str_cat.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_errors.h"
 #include "tensorflow/lite/delegates/gpu/gl/gl_call.h"
@@ -39,6 +41,10 @@ using PFNEGLCREATESYNCPROC = EGLSync(EGLAPIENTRYP)(
 
 PFNEGLCREATESYNCPROC g_eglCreateSync = nullptr;
 
+#ifndef EGL_NATIVE_BUFFER_ANDROID
+#define EGL_NATIVE_BUFFER_ANDROID 0x3140
+#endif
+
 }  // namespace
 
 absl::Status CreateEglSyncFromClEvent(cl_event event, EGLDisplay display,
@@ -129,6 +135,88 @@ bool IsGlSharingSupported(const CLDevice& device) {
          device.GetInfo().SupportsExtension("cl_khr_gl_sharing");
 }
 
+#if defined(__ANDROID__) && __ANDROID_API__ >= 26
+absl::Status EglImage::NewFromHardwareBuffer(EGLDisplay display,
+                                             AHardwareBuffer* buffer,
+                                             EglImage* image) {
+  static auto* egl_get_native_client_buffer =
+      reinterpret_cast<PFNEGLGETNATIVECLIENTBUFFERANDROIDPROC>(
+          eglGetProcAddress("eglGetNativeClientBufferANDROID"));
+  static auto* egl_create_image_khr =
+      reinterpret_cast<decltype(&eglCreateImageKHR)>(
+          eglGetProcAddress("eglCreateImageKHR"));
+  if (!egl_get_native_client_buffer || !egl_create_image_khr) {
+    return absl::UnimplementedError(
+        "Not supported: eglGetNativeClientBufferANDROID or "
+        "eglCreateImageKHR.");
+  }
+  EGLClientBuffer client_buffer;
+  RETURN_IF_ERROR(TFLITE_GPU_CALL_EGL(*egl_get_native_client_buffer,
+                                      &client_buffer, buffer));
+  const EGLint attributes[] = {EGL_IMAGE_PRESERVED_KHR, EGL_TRUE, EGL_NONE};
+  EGLImageKHR egl_image;
+  RETURN_IF_ERROR(TFLITE_GPU_CALL_EGL(
+      *egl_create_image_khr, &egl_image, display, EGL_NO_CONTEXT,
+      EGL_NATIVE_BUFFER_ANDROID, client_buffer, attributes));
+  if (egl_image == EGL_NO_IMAGE_KHR) {
+    return absl::InternalError("Returned empty EGL image");
+  }
+  *image = EglImage(display, egl_image);
+  return absl::OkStatus();
+}
+#endif
+
+EglImage::EglImage(EglImage&& image)
+    : display_(image.display_), image_(image.image_) {
+  image.image_ = EGL_NO_IMAGE_KHR;
+}
+
+EglImage& EglImage::operator=(EglImage&& image) {
+  if (this != &image) {
+    Invalidate();
+    std::swap(image_, image.image_);
+    display_ = image.display_;
+  }
+  return *this;
+}
+
+void EglImage::Invalidate() {
+  if (image_ != EGL_NO_IMAGE_KHR) {
+    static auto* egl_destroy_image_khr =
+        reinterpret_cast<decltype(&eglDestroyImageKHR)>(
+            eglGetProcAddress("eglDestroyImageKHR"));
+    if (egl_destroy_image_khr) {
+      (*egl_destroy_image_khr)(display_, image_);
+    }
+    image_ = EGL_NO_IMAGE_KHR;
+  }
+}
+
+absl::Status CreateClMemoryFromEglImage(const EglImage& image,
+                                        AccessType access_type,
+                                        CLContext* context, CLMemory* memory) {
+  if (!image.is_valid()) {
+    return absl::InvalidArgumentError("EGL image is not valid");
+  }
+  cl_int error_code;
+  auto mem = clCreateFromEGLImageKHR(
+      context->context(), image.display(), image.image(),
+      ToClMemFlags(access_type), nullptr, &error_code);
+  if (error_code != CL_SUCCESS) {
+    return absl::InternalError(
+        absl::StrCat("Unable to create CL image from EGL image. ",
+                     CLErrorCodeToString(error_code)));
+  }
+  *memory = CLMemory(mem, true);
+  return absl::OkStatus();
+}
+
+bool IsEglImageSharingSupported(const CLDevice& device) {
+  return clCreateFromEGLImageKHR && clEnqueueAcquireEGLObjectsKHR &&
+         clEnqueueReleaseEGLObjectsKHR &&
+         device.GetInfo().SupportsExtension("cl_khr_egl_image");
+}
+
 AcquiredGlObjects::~AcquiredGlObjects() { Release({}, nullptr).IgnoreError(); }
 
 absl::Status AcquiredGlObjects::Acquire(
@@ -173,6 +261,68 @@ absl::Status AcquiredGlObjects::Release(
   return absl::OkStatus();
 }
 
+AcquiredEglObjects::~AcquiredEglObjects() {
+  Release({}, nullptr).IgnoreError();
+}
+
+AcquiredEglObjects::AcquiredEglObjects(AcquiredEglObjects&& objects)
+    : memory_(std::move(objects.memory_)), queue_(objects.queue_) {
+  objects.queue_ = nullptr;
+}
+
+AcquiredEglObjects& AcquiredEglObjects::operator=(
+    AcquiredEglObjects&& objects) {
+  if (this != &objects) {
+    Release({}, nullptr).IgnoreError();
+    memory_ = std::move(objects.memory_);
+    queue_ = objects.queue_;
+    objects.queue_ = nullptr;
+  }
+  return *this;
+}
+
+absl::Status AcquiredEglObjects::Acquire(
+    const std::vector<cl_mem>& memory, cl_command_queue queue,
+    const std::vector<cl_event>& wait_events, CLEvent* acquire_event,
+    AcquiredEglObjects* objects) {
+  if (!memory.empty()) {
+    cl_event new_event;
+    cl_int error_code = clEnqueueAcquireEGLObjectsKHR(
+        queue, memory.size(), memory.data(), wait_events.size(),
+        wait_events.data(), acquire_event ? &new_event : nullptr);
+    if (error_code != CL_SUCCESS) {
+      return absl::InternalError(absl::StrCat("Unable to acquire EGL object. ",
+                                              CLErrorCodeToString(error_code)));
+    }
+    if (acquire_event) {
+      *acquire_event = CLEvent(new_event);
+    }
+    clFlush(queue);
+  }
+  *objects = AcquiredEglObjects(memory, queue);
+  return absl::OkStatus();
+}
+
+absl::Status AcquiredEglObjects::Release(
+    const std::vector<cl_event>& wait_events, CLEvent* release_event) {
+  if (queue_ && !memory_.empty()) {
+    cl_event new_event;
+    cl_int error_code = clEnqueueReleaseEGLObjectsKHR(
+        queue_, memory_.size(), memory_.data(), wait_events.size(),
+        wait_events.data(), release_event ? &new_event : nullptr);
+    if (error_code != CL_SUCCESS) {
+      return absl::InternalError(absl::StrCat("Unable to release EGL object. ",
+                                              CLErrorCodeToString(error_code)));
+    }
+    if (release_event) {
+      *release_event = CLEvent(new_event);
+    }
+    clFlush(queue_);
+  }
+  queue_ = nullptr;
+  return absl::OkStatus();
+}
+
 GlInteropFabric::GlInteropFabric(EGLDisplay egl_display,
                                  Environment* environment)
     : is_egl_sync_supported_(true),
@@ -19,6 +19,10 @@ limitations under the License.
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
 
+#if defined(__ANDROID__) && __ANDROID_API__ >= 26
+#include <android/hardware_buffer.h>
+#endif
+
 #include <vector>
 
 #include "tensorflow/lite/delegates/gpu/cl/cl_command_queue.h"
@@ -71,6 +75,60 @@ absl::Status CreateClMemoryFromGlTexture(GLenum texture_target,
 // Returns true if GL objects could be shared with OpenCL context.
 bool IsGlSharingSupported(const CLDevice& device);
 
+// RAII wrapper for EGL image. EglImage is moveable but not copyable.
+class EglImage {
+ public:
+#if defined(__ANDROID__) && __ANDROID_API__ >= 26
+  // Wraps the given hardware buffer into an EGL image without copying its
+  // contents. The buffer must outlive the image.
+  //
+  // Depends on EGL_ANDROID_get_native_client_buffer and
+  // EGL_ANDROID_image_native_buffer extensions.
+  static absl::Status NewFromHardwareBuffer(EGLDisplay display,
+                                            AHardwareBuffer* buffer,
+                                            EglImage* image);
+#endif
+
+  // Creates invalid object.
+  EglImage() : EglImage(EGL_NO_DISPLAY, EGL_NO_IMAGE_KHR) {}
+
+  EglImage(EGLDisplay display, EGLImageKHR image)
+      : display_(display), image_(image) {}
+
+  // Move-only
+  EglImage(EglImage&& image);
+  EglImage& operator=(EglImage&& image);
+  EglImage(const EglImage&) = delete;
+  EglImage& operator=(const EglImage&) = delete;
+
+  ~EglImage() { Invalidate(); }
+
+  // Returns the EGLDisplay on which this instance was created.
+  EGLDisplay display() const { return display_; }
+
+  // Returns the EGLImageKHR wrapped by this instance.
+  EGLImageKHR image() const { return image_; }
+
+  // Returns true if this instance wraps a valid EGLImage object.
+  bool is_valid() const { return image_ != EGL_NO_IMAGE_KHR; }
+
+ private:
+  void Invalidate();
+
+  EGLDisplay display_;
+  EGLImageKHR image_;
+};
+
+// Creates new CL image from EGL image. The memory aliases the image, so the
+// image must outlive it. Before use in CL kernels the memory has to be
+// acquired with AcquiredEglObjects.
+absl::Status CreateClMemoryFromEglImage(const EglImage& image,
+                                        AccessType access_type,
+                                        CLContext* context, CLMemory* memory);
+
+// Returns true if EGL images could be shared with OpenCL context.
+bool IsEglImageSharingSupported(const CLDevice& device);
+
 // RAII-wrapper for GL objects acquired into CL context.
 class AcquiredGlObjects {
  public:
@@ -105,6 +163,43 @@ class AcquiredGlObjects {
   cl_command_queue queue_;
 };
 
+// RAII-wrapper for EGL images acquired into CL context.
+class AcquiredEglObjects {
+ public:
+  AcquiredEglObjects() : AcquiredEglObjects({}, nullptr) {}
+
+  // Quitely releases EGL objects. It is recommended to call Release()
+  // explicitly to properly handle potential errors.
+  ~AcquiredEglObjects();
+
+  // Move-only
+  AcquiredEglObjects(AcquiredEglObjects&& objects);
+  AcquiredEglObjects& operator=(AcquiredEglObjects&& objects);
+  AcquiredEglObjects(const AcquiredEglObjects&) = delete;
+  AcquiredEglObjects& operator=(const AcquiredEglObjects&) = delete;
+
+  // Acquires memory created by CreateClMemoryFromEglImage calls. If
+  // 'acquire_event' is not nullptr, it will be signalled once acquisition is
+  // complete.
+  static absl::Status Acquire(const std::vector<cl_mem>& memory,
+                              cl_command_queue queue,
+                              const std::vector<cl_event>& wait_events,
+                              CLEvent* acquire_event /* optional */,
+                              AcquiredEglObjects* objects);
+
+  // Releases OpenCL memory back to EGL. If 'release_event' is not nullptr, it
+  // will be signalled once release is complete.
+  absl::Status Release(const std::vector<cl_event>& wait_events,
+                       CLEvent* release_event /* optional */);
+
+ private:
+  AcquiredEglObjects(const std::vector<cl_mem>& memory, cl_command_queue queue)
+      : memory_(memory), queue_(queue) {}
+
+  std::vector<cl_mem> memory_;
+  cl_command_queue queue_;
+};
+
 // Incapsulates all complicated GL-CL synchronization. It manages life time of
 // all appropriate events to ensure fast synchronization whenever possible.
 class GlInteropFabric {
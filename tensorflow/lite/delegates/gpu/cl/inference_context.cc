@@ -19,6 +19,7 @@ limitations under the License.
 #include <cmath>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
@@ -164,16 +165,6 @@ absl::Status InferenceContext::InitFromGraph(
   if (env->device().GetInfo().IsPowerVR()) {
     need_flush_ = true;
   }
-  CopyInAndOutIds(graph);
-  RETURN_IF_ERROR(ConvertOperations(creation_context.GetGpuInfo(), graph,
-                                    create_info.hints));
-  RETURN_IF_ERROR(Merge());
-  RETURN_IF_ERROR(
-      AllocateMemory(creation_context.GetGpuInfo(), creation_context.context));
-  BindMemoryToOperations();
-  RETURN_IF_ERROR(Compile(creation_context));
-  RETURN_IF_ERROR(UpdateParams());
-
   TuningType tuning_type = TuningType::kExhaustive;
   if (create_info.hints.Check(ModelHints::kFastTuning)) {
     tuning_type = TuningType::kFast;
@@ -186,6 +177,20 @@ absl::Status InferenceContext::InitFromGraph(
       tuning_type = TuningType::kFast;
     }
   }
+
+  CopyInAndOutIds(graph);
+  RETURN_IF_ERROR(ConvertOperations(creation_context.GetGpuInfo(), graph,
+                                    create_info.hints));
+  if (tuning_type == TuningType::kExhaustive) {
+    RETURN_IF_ERROR(
+        SelectFastestOperations(creation_context, env->profiling_queue()));
+  }
+  RETURN_IF_ERROR(Merge());
+  RETURN_IF_ERROR(
+      AllocateMemory(creation_context.GetGpuInfo(), creation_context.context));
+  BindMemoryToOperations();
+  RETURN_IF_ERROR(Compile(creation_context));
+  RETURN_IF_ERROR(UpdateParams());
   RETURN_IF_ERROR(
       Tune(tuning_type, env->device().GetInfo(), env->profiling_queue()));
   InitRecordableQueue(env);
@@ -418,6 +423,7 @@ absl::Status InferenceContext::ConvertOperations(const GpuInfo& gpu_info,
         }
       }
       cl_node.name = op_name;
+      cl_node.create_candidates = std::move(gpu_op.create_candidates);
       nodes_.push_back(std::move(cl_node));
     }
   }
@@ -471,6 +477,75 @@ absl::Status InferenceContext::Merge() {
   return absl::OkStatus();
 }
 
+absl::Status InferenceContext::SelectFastestOperations(
+    const CreationContext& creation_context,
+    ProfilingCommandQueue* profiling_queue) {
+  // Kernels are launched several times to average out the noise of
+  // measurements.
+  const int kNumRuns = 4;
+  for (auto& node : nodes_) {
+    if (!node.create_candidates) {
+      continue;
+    }
+    std::vector<Tensor> src_tensors(node.inputs.size());
+    for (int i = 0; i < node.inputs.size(); ++i) {
+      const auto& t = tensor_reserver_.Get(node.inputs[i]);
+      RETURN_IF_ERROR(CreateTensor(*creation_context.context, t.shape,
+                                   t.descriptor, &src_tensors[i]));
+    }
+    std::vector<Tensor> dst_tensors(node.outputs.size());
+    for (int i = 0; i < node.outputs.size(); ++i) {
+      const auto& t = tensor_reserver_.Get(node.outputs[i]);
+      RETURN_IF_ERROR(CreateTensor(*creation_context.context, t.shape,
+                                   t.descriptor, &dst_tensors[i]));
+    }
+    std::vector<std::unique_ptr<GPUOperation>> candidates =
+        node.create_candidates();
+    absl::flat_hash_set<uint64_t> measured_kernels;
+    int best_index = 0;
+    double best_time_ms = std::numeric_limits<double>::max();
+    for (int i = 0; i < candidates.size(); ++i) {
+      ClOperation operation;
+      operation.Init(std::move(candidates[i]));
+      for (int j = 0; j < src_tensors.size(); ++j) {
+        operation.GetGpuOperation().SetSrc(&src_tensors[j], j);
+      }
+      for (int j = 0; j < dst_tensors.size(); ++j) {
+        operation.GetGpuOperation().SetDst(&dst_tensors[j], j);
+      }
+      // A candidate that can not run on this device is not an error, the
+      // others are still worth measuring.
+      if (!operation.Compile(creation_context).ok() ||
+          !measured_kernels.insert(operation.GetKernelFingerprint()).second ||
+          !operation.UpdateParams().ok() ||
+          !operation
+               .Tune(TuningType::kExhaustive, creation_context.GetGpuInfo(),
+                     profiling_queue)
+               .ok()) {
+        continue;
+      }
+      profiling_queue->ResetMeasurements();
+      for (int run = 0; run < kNumRuns; ++run) {
+        RETURN_IF_ERROR(operation.AddToQueue(profiling_queue));
+      }
+      RETURN_IF_ERROR(profiling_queue->WaitForCompletion());
+      const double time_ms = profiling_queue->GetSumOfEventsTimeMs();
+      if (time_ms < best_time_ms) {
+        best_time_ms = time_ms;
+        best_index = i;
+      }
+    }
+    if (best_index != 0) {
+      // The measured operations are compiled and bound to the temporary
+      // tensors, so the winner is created again.
+      candidates = node.create_candidates();
+      node.cl_operation.Init(std::move(candidates[best_index]));
+    }
+    node.create_candidates = nullptr;
+  }
+  return absl::OkStatus();
+}
+
 void InferenceContext::GetUsages(const std::function<bool(ValueId)>& functor,
                                  std::map<ValueId, int2>* usages) {
   for (ValueId in_id : input_ids_) {
@@ -52,6 +52,11 @@ struct CLNode {
   // Mostly for debug purposes.
   std::string name;
 
+  // Optional. Creates the implementations cl_operation could be replaced with,
+  // see InferenceContext::SelectFastestOperations.
+  std::function<std::vector<std::unique_ptr<GPUOperation>>()>
+      create_candidates;
+
   CLNode() = default;
 
   CLNode(CLNode&& node) = default;
@@ -120,6 +125,11 @@ class InferenceContext {
                                    const GpuInfo& gpu_info,
                                    const GraphFloat32& graph);
   absl::Status Merge();
+  // Measures the candidate implementations of every node that has them on
+  // temporary tensors and keeps the fastest one. Must be called before Merge,
+  // as the candidates don't include the linked operations.
+  absl::Status SelectFastestOperations(const CreationContext& creation_context,
+                                       ProfilingCommandQueue* profiling_queue);
   absl::Status AllocateMemory(const GpuInfo& gpu_info, CLContext* context);
 
   absl::Status AllocateMemoryForConstTensors(CLContext* context);
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_DELEGATES_GPU_COMMON_SELECTORS_CONVOLUTION_SELECTOR_H_
 
 #include <memory>
+#include <vector>
 
 #include "tensorflow/lite/delegates/gpu/common/model_hints.h"
 #include "tensorflow/lite/delegates/gpu/common/operations.h"
@@ -32,6 +33,12 @@ std::unique_ptr<GPUOperation> SelectConvolution(
     const Convolution2DAttributes& attr, const BHWC& dst_shape,
     const GpuInfo& gpu_info, const OperationDef& op_def, ModelHints hints);
 
+// Returns all implementations that can compute the convolution, starting with
+// the one SelectConvolution picks.
+std::vector<std::unique_ptr<GPUOperation>> SelectConvolutionCandidates(
+    const Convolution2DAttributes& attr, const BHWC& dst_shape,
+    const GpuInfo& gpu_info, const OperationDef& op_def, ModelHints hints);
+
 std::unique_ptr<GPUOperation> SelectConvolutionForWinograd(
     const Convolution2DAttributes& attr, const BHWC& dst_shape,
     const GpuInfo& gpu_info, const OperationDef& op_def, ModelHints hints);
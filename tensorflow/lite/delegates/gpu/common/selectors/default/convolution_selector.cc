@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <memory>
+#include <vector>
+
 #include "absl/memory/memory.h"
 #include "tensorflow/lite/delegates/gpu/common/model_hints.h"
 #include "tensorflow/lite/delegates/gpu/common/operations.h"
@@ -156,6 +159,36 @@ std::unique_ptr<GPUOperation> SelectConvolution(
   }
 }
 
+std::vector<std::unique_ptr<GPUOperation>> SelectConvolutionCandidates(
+    const Convolution2DAttributes& attr, const BHWC& dst_shape,
+    const GpuInfo& gpu_info, const OperationDef& op_def,
+    ModelHints hints) {
+  std::vector<std::unique_ptr<GPUOperation>> candidates;
+  candidates.push_back(
+      SelectConvolution(attr, dst_shape, gpu_info, op_def, hints));
+  if (gpu_info.IsApiMetal()) {
+    return candidates;
+  }
+  if (IsConvConstantsSupported(gpu_info, op_def, attr)) {
+    GPUOperation conv = CreateConvConstants(gpu_info, op_def, attr);
+    candidates.push_back(absl::make_unique<GPUOperation>(std::move(conv)));
+  }
+  if (op_def.src_tensors[0].storage_type == TensorStorageType::BUFFER &&
+      IsConvBuffer1x1Supported(op_def, attr)) {
+    ConvBuffer1x1 conv =
+        CreateConvBuffer1x1(gpu_info, op_def, attr, &dst_shape);
+    candidates.push_back(absl::make_unique<ConvBuffer1x1>(std::move(conv)));
+  }
+  // Block sizes of ConvPowerVR depend on whether the destination shape is
+  // known, so both variants are worth measuring.
+  ConvPowerVR conv_shaped =
+      CreateConvPowerVR(gpu_info, op_def, attr, &dst_shape);
+  candidates.push_back(absl::make_unique<ConvPowerVR>(std::move(conv_shaped)));
+  ConvPowerVR conv_generic = CreateConvPowerVR(gpu_info, op_def, attr);
+  candidates.push_back(absl::make_unique<ConvPowerVR>(std::move(conv_generic)));
+  return candidates;
+}
+
 std::unique_ptr<GPUOperation> SelectConvolutionForWinograd(
     const Convolution2DAttributes& attr, const BHWC& dst_shape,
     const GpuInfo& gpu_info, const OperationDef& op_def,
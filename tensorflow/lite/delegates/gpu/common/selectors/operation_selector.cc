@@ -333,6 +333,13 @@ absl::Status GPUOperationFromNode(const GpuInfo& gpu_info,
           gpu_op = InitSingleOpSubgraph(inputs, outputs, gpu_subgraph);
           *gpu_op =
               SelectConvolution(attr, output_shape, gpu_info, op_def, hints);
+          if (!hints.Check(ModelHints::kFastTuning)) {
+            gpu_subgraph->operations[0].create_candidates =
+                [attr, output_shape, gpu_info, op_def, hints]() {
+                  return SelectConvolutionCandidates(
+                      attr, output_shape, gpu_info, op_def, hints);
+                };
+          }
           return absl::OkStatus();
         }
       } else {
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_DELEGATES_GPU_COMMON_SELECTORS_SUBGRAPH_H_
 #define TENSORFLOW_LITE_DELEGATES_GPU_COMMON_SELECTORS_SUBGRAPH_H_
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -34,6 +35,12 @@ struct GPUOperationWithRefs {
   // otherwise, we will use ids for newly allocated tensors
   std::vector<int> input_ids;
   std::vector<int> output_ids;
+
+  // Optional. Creates all implementations that can replace operation, the
+  // first one being the same as operation. Lets the backend measure them on
+  // the device and keep the fastest one.
+  std::function<std::vector<std::unique_ptr<GPUOperation>>()>
+      create_candidates;
 };
 
 struct GPUOperationsSubgraph {
@@ -92,20 +92,28 @@ class Delegate {
     if (options_.max_delegated_partitions <= 0) {
       options_.max_delegated_partitions = 1;
     }
-    if (options->experimental_flags &
-            TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION &&
-        options->model_token && options->serialization_dir) {
+    if (options_.model_token && options_.serialization_dir) {
       SerializationParams params;
-      params.model_token = options->model_token;
-      params.cache_dir = options->serialization_dir;
+      params.model_token = options_.model_token;
+      params.cache_dir = options_.serialization_dir;
       serialization_.reset(new Serialization(params));
     }
+    // The strings are copied by Serialization and must not be used later.
+    options_.model_token = nullptr;
+    options_.serialization_dir = nullptr;
   }
 
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
   Serialization* serialization() { return serialization_.get(); }
   const TfLiteGpuDelegateOptionsV2& options() const { return options_; }
 
+  // Whether failing to save the serialized data fails the delegation. Otherwise
+  // the delegate runs without a cache for this model.
+  bool IsSerializationRequired() const {
+    return options_.experimental_flags &
+           TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION;
+  }
+
   bool IsQuantOpsAllowed() const {
     return options_.experimental_flags &
            TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_QUANT;
@@ -353,8 +361,14 @@ class DelegateKernel {
       RETURN_IF_ERROR(
           cl_environment_->NewInferenceBuilder(serialized_model, builder));
 
-      RETURN_IF_ERROR(SaveSerializedOpenCL(context, delegate_params, &options,
-                                           serialization, serialized_model));
+      absl::Status save_status = SaveSerializedOpenCL(
+          context, delegate_params, &options, serialization, serialized_model);
+      if (!save_status.ok()) {
+        if (delegate_->IsSerializationRequired()) return save_status;
+        TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                        "Could not save the serialized GPU model: %s",
+                        std::string(save_status.message()).c_str());
+      }
     }
 
     TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
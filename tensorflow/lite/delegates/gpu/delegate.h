@@ -56,15 +56,10 @@ enum TfLiteGpuExperimentalFlags {
   // Enforces execution with the provided backend.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY = 1 << 1,
   TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY = 1 << 2,
-  // Enable serialization of GPU kernels & model data. Speeds up initilization
-  // at the cost of space on disk.
-  // Delegate performs serialization the first time it is applied with a new
-  // model or inference params. Later initializations are fast.
-  // ModifyGraphWithDelegate will fail if data cannot be serialized.
-  //
-  // NOTE: User also needs to set serialization_dir & model_token in
-  // TfLiteGpuDelegateOptionsV2.
-  // Currently works only if CL backend is used.
+  // Makes ModifyGraphWithDelegate fail if the GPU kernels & model data cannot
+  // be serialized. Serialization itself is enabled by setting
+  // serialization_dir & model_token in TfLiteGpuDelegateOptionsV2; without
+  // this flag a failure to save is only logged.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
 };
 
@@ -113,8 +108,11 @@ typedef struct {
   int32_t max_delegated_partitions;
 
   // The nul-terminated directory to use for serialization.
-  // Whether serialization actually happens or not is dependent on backend used
-  // and validity of this directory.
+  // When both this and model_token are set, the delegate saves the compiled
+  // GPU programs, tuned work group sizes & model data the first time it is
+  // applied with a new model or inference params, and restores them on later
+  // runs, which makes initialization much faster at the cost of space on
+  // disk. Currently works only if the CL backend is used.
   // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(), which implies the
   // delegate will not try serialization.
   //
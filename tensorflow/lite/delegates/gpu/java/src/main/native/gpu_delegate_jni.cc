@@ -29,7 +29,8 @@ extern "C" {
 
 JNIEXPORT jlong JNICALL Java_org_tensorflow_lite_gpu_GpuDelegate_createDelegate(
     JNIEnv* env, jclass clazz, jboolean precision_loss_allowed,
-    jboolean quantized_models_allowed, jint inference_preference) {
+    jboolean quantized_models_allowed, jint inference_preference,
+    jstring serialization_dir, jstring model_token) {
   TfLiteGpuDelegateOptionsV2 options = TfLiteGpuDelegateOptionsV2Default();
   if (precision_loss_allowed == JNI_TRUE) {
     options.inference_priority1 = TFLITE_GPU_INFERENCE_PRIORITY_MIN_LATENCY;
@@ -42,7 +43,22 @@ JNIEXPORT jlong JNICALL Java_org_tensorflow_lite_gpu_GpuDelegate_createDelegate(
     options.experimental_flags |= TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_QUANT;
   }
   options.inference_preference = static_cast<int32_t>(inference_preference);
-  return reinterpret_cast<jlong>(TfLiteGpuDelegateV2Create(&options));
+  // The delegate copies the strings, so they are released right after.
+  const char* serialization_dir_chars = nullptr;
+  const char* model_token_chars = nullptr;
+  if (serialization_dir && model_token) {
+    serialization_dir_chars =
+        env->GetStringUTFChars(serialization_dir, /*isCopy=*/nullptr);
+    model_token_chars = env->GetStringUTFChars(model_token, /*isCopy=*/nullptr);
+    options.serialization_dir = serialization_dir_chars;
+    options.model_token = model_token_chars;
+  }
+  TfLiteDelegate* delegate = TfLiteGpuDelegateV2Create(&options);
+  if (serialization_dir_chars) {
+    env->ReleaseStringUTFChars(serialization_dir, serialization_dir_chars);
+    env->ReleaseStringUTFChars(model_token, model_token_chars);
+  }
+  return reinterpret_cast<jlong>(delegate);
 }
 
 JNIEXPORT void JNICALL Java_org_tensorflow_lite_gpu_GpuDelegate_deleteDelegate(
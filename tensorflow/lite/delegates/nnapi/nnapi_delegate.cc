@@ -560,6 +560,45 @@ uint64_t GetHash(const TfLiteIntArray* int_array, uint64_t combine_with = 0) {
   return result;
 }
 
+// Combines the hash `value` into `seed`, as GetHash() does for each element.
+uint64_t CombineHash(uint64_t seed, uint64_t value) {
+  constexpr auto kHashConst = 0x9e3779b97f4a7800ULL;
+  return seed ^ (value + kHashConst + (seed << 10) + (seed >> 4));
+}
+
+// Returns a hash of the names and driver versions of `devices` and of the
+// options that the compiled model depends on, combined into `seed`.
+uint64_t GetCompilationHash(const NnApi* nnapi,
+                            const std::vector<ANeuralNetworksDevice*>& devices,
+                            const StatefulNnApiDelegate::Options& options,
+                            uint64_t seed) {
+  uint64_t result = seed;
+  for (const ANeuralNetworksDevice* device : devices) {
+    const char* name = nullptr;
+    if (nnapi->ANeuralNetworksDevice_getName &&
+        nnapi->ANeuralNetworksDevice_getName(device, &name) ==
+            ANEURALNETWORKS_NO_ERROR &&
+        name) {
+      result =
+          CombineHash(result, ::util::Fingerprint64(name, std::strlen(name)));
+    }
+    const char* version = nullptr;
+    if (nnapi->ANeuralNetworksDevice_getVersion &&
+        nnapi->ANeuralNetworksDevice_getVersion(device, &version) ==
+            ANEURALNETWORKS_NO_ERROR &&
+        version) {
+      result = CombineHash(
+          result, ::util::Fingerprint64(version, std::strlen(version)));
+    }
+  }
+  result = CombineHash(result, options.execution_preference);
+  result = CombineHash(result, options.execution_priority);
+  result = CombineHash(result, options.allow_fp16);
+  result = CombineHash(result, options.allow_dynamic_dimensions);
+  result = CombineHash(result, options.disallow_nnapi_cpu);
+  return result;
+}
+
 bool HasZeroes(TfLiteIntArrayView array) {
   for (auto value : array) {
     if (value == 0) {
@@ -3905,6 +3944,11 @@ TfLiteStatus NNAPIDelegateKernel::Init(TfLiteContext* context,
     // guaranteed to be stable across program invocations.
     token_parts[0] =
         ::util::Fingerprint64(model_token, std::strlen(model_token));
+    // Add bits from the target devices and the compilation options, so that
+    // a compilation isn't taken from the cache for other devices, another
+    // driver version or other options.
+    token_parts[0] = GetCompilationHash(nnapi_, nnapi_devices_,
+                                        delegate_options, token_parts[0]);
     // Create bits from params->nodes_to_replace.
     token_parts[1] = GetHash(params->nodes_to_replace);
     // Create bits from params->input_tensors. These include the input tensor
@@ -4441,7 +4485,22 @@ TfLiteStatus NNAPIDelegateKernel::Invoke(TfLiteContext* context,
                                     "waiting for async computation completion",
                                     nnapi_errno);
   } else {
-    // Use Burst mode by default for NNAPI 1.2+.
+    // Repeated invocations run in a burst, which lets the driver keep the
+    // resources of the execution around between them. It is created after
+    // the first invocation, so that a compilation run once doesn't pay for
+    // it, and the plain computation is kept if the driver fails to create it.
+    if (!nn_burst_ && !burst_creation_failed_ && num_invocations_ > 0 &&
+        nnapi_->ANeuralNetworksBurst_create &&
+        nnapi_->ANeuralNetworksExecution_burstCompute) {
+      ANeuralNetworksBurst* burst = nullptr;
+      if (nnapi_->ANeuralNetworksBurst_create(nn_compilation_.get(), &burst) ==
+          ANEURALNETWORKS_NO_ERROR) {
+        nn_burst_.reset(burst);
+      } else {
+        nnapi_->ANeuralNetworksBurst_free(burst);
+        burst_creation_failed_ = true;
+      }
+    }
     if (nn_burst_) {
       RETURN_TFLITE_ERROR_IF_NN_ERROR(
           context,
@@ -4504,6 +4563,7 @@ TfLiteStatus NNAPIDelegateKernel::Invoke(TfLiteContext* context,
     memcpy(dest.data.raw, src.data.raw, src.bytes);
   }
 
+  ++num_invocations_;
   return kTfLiteOk;
 }
 
@@ -74,6 +74,9 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     // clash of the tokens.
     // NOTE: when using compilation caching, it is not recommended to use the
     // same delegate instance for multiple models.
+    // Besides the token, the cache key covers the delegated partition, the
+    // target devices and their driver versions, and the options the
+    // compilation depends on.
     const char* model_token = nullptr;
 
     // Whether to disallow NNAPI CPU usage. Only effective on Android 10 and
@@ -134,7 +137,9 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     // If NNAPI devices are specified and are of NNAPI feature level 5 or
     // higher, NNAPI delegate will automatically enable burst mode for better
     // performance.
-    // Default: Disabled for devices with NNAPI feature level 4 or lower.
+    // Otherwise, on NNAPI 1.2 and newer, burst mode is used from the second
+    // invocation of a delegated partition on, and this option only makes the
+    // first invocation use it too.
     bool use_burst_computation = false;
   };
 
@@ -208,6 +208,83 @@ TEST_F(NnApiDeviceSelectionTest,
   EXPECT_EQ(m.CountOpsExecutedByCpuKernel(), 1);
 }
 
+std::vector<uint8_t>* compilation_cache_token = new std::vector<uint8_t>();
+
+TEST_F(NnApiDeviceSelectionTest, CompilationCacheTokenDependsOnDevice) {
+  nnapi_mock_->StubCompilationSetCachingWith(
+      [](ANeuralNetworksCompilation* compilation, const char* cacheDir,
+         const uint8_t* token) -> int {
+        compilation_cache_token->assign(
+            token, token + 32);
+        return ANEURALNETWORKS_NO_ERROR;
+      });
+
+  auto token_for_device = [this](const char* accelerator_name) {
+    tflite::StatefulNnApiDelegate::Options options;
+    options.cache_dir = "/data/local/tmp";
+    options.model_token = "model";
+    options.accelerator_name = accelerator_name;
+    compilation_cache_token->clear();
+    FloatAddOpModel model;
+    model.Init(nnapi_mock_->GetNnApi(), options,
+               {TensorType_FLOAT32, {1, 2, 2, 1}},
+               {TensorType_FLOAT32, {1, 2, 2, 1}}, {TensorType_FLOAT32, {}},
+               ActivationFunctionType_NONE);
+    EXPECT_EQ(model.GetCompilationStatus(), kTfLiteOk);
+    return *compilation_cache_token;
+  };
+
+  const std::vector<uint8_t> dsp_token = token_for_device("dsp");
+  const std::vector<uint8_t> gpu_token = token_for_device("gpu");
+  ASSERT_FALSE(dsp_token.empty());
+  ASSERT_FALSE(gpu_token.empty());
+  EXPECT_NE(dsp_token, gpu_token);
+  EXPECT_EQ(token_for_device("dsp"), dsp_token);
+}
+
+int burst_compute_count = 0;
+
+TEST_F(NnApiDeviceSelectionTest, UsesBurstFromTheSecondInvocation) {
+  burst_compute_count = 0;
+  nnapi_mock_->BurstCreateReturns<ANEURALNETWORKS_NO_ERROR>();
+  nnapi_mock_->StubExecutionBurstComputeWith(
+      [](ANeuralNetworksExecution* execution,
+         ANeuralNetworksBurst* burst) -> int {
+        ++burst_compute_count;
+        return ANEURALNETWORKS_NO_ERROR;
+      });
+
+  tflite::StatefulNnApiDelegate::Options options;
+  options.accelerator_name = "dsp";
+  InitWithOptions(options);
+  EXPECT_EQ(m.GetCompilationStatus(), kTfLiteOk);
+  EXPECT_EQ(m.InvokeUnchecked(), kTfLiteOk);
+  EXPECT_EQ(burst_compute_count, 0);
+  EXPECT_EQ(m.InvokeUnchecked(), kTfLiteOk);
+  EXPECT_EQ(m.InvokeUnchecked(), kTfLiteOk);
+  EXPECT_EQ(burst_compute_count, 2);
+}
+
+TEST_F(NnApiDeviceSelectionTest, FallsBackToComputeIfBurstCreationFails) {
+  burst_compute_count = 0;
+  nnapi_mock_->BurstCreateReturns<ANEURALNETWORKS_OP_FAILED>();
+  nnapi_mock_->StubExecutionBurstComputeWith(
+      [](ANeuralNetworksExecution* execution,
+         ANeuralNetworksBurst* burst) -> int {
+        ++burst_compute_count;
+        return ANEURALNETWORKS_NO_ERROR;
+      });
+
+  tflite::StatefulNnApiDelegate::Options options;
+  options.accelerator_name = "dsp";
+  InitWithOptions(options);
+  EXPECT_EQ(m.GetCompilationStatus(), kTfLiteOk);
+  EXPECT_EQ(m.InvokeUnchecked(), kTfLiteOk);
+  EXPECT_EQ(m.InvokeUnchecked(), kTfLiteOk);
+  EXPECT_EQ(m.InvokeUnchecked(), kTfLiteOk);
+  EXPECT_EQ(burst_compute_count, 0);
+}
+
 struct UnsupportedOperationOnDeviceTest
     : ::tflite::delegate::nnapi::NnApiDelegateMockTest {};
 
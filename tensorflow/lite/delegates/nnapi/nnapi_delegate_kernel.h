@@ -344,6 +344,10 @@ class NNAPIDelegateKernel {
   std::unique_ptr<ANeuralNetworksCompilation, NNFreeCompilation>
       nn_compilation_;
   std::unique_ptr<ANeuralNetworksBurst, NNFreeBurst> nn_burst_;
+  // Number of successful invocations of the compilation, after the first of
+  // which a burst is created unless creating one failed.
+  int num_invocations_ = 0;
+  bool burst_creation_failed_ = false;
   std::unique_ptr<ANeuralNetworksExecution, NNFreeExecution> nn_execution_;
   // The mappings of tenor id to BufferHandle. Needed to track BufferHandle
   // change and alter nn_reusable_execution_ if necessary.
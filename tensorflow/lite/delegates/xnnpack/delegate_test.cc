@@ -14,13 +14,18 @@ limitations under the License.
 ==============================================================================*/
 
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <memory>
 #include <random>
 
 #include <gtest/gtest.h>
 #include <pthreadpool.h>
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/builtin_op_kernels.h"
 
 namespace tflite {
 namespace xnnpack {
@@ -62,5 +67,56 @@ TEST(Delegate, GetThreadPool) {
   ASSERT_EQ(2, pthreadpool_get_threads_count(threadpool));
 }
 
+TEST(Delegate, ResizeInputsWithRuntimeCache) {
+  TfLiteXNNPackDelegateOptions delegate_options =
+      TfLiteXNNPackDelegateOptionsDefault();
+  delegate_options.max_cached_runtimes = 2;
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(&delegate_options),
+                       TfLiteXNNPackDelegateDelete);
+
+  // Adds the input to itself.
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({1}), kTfLiteOk);
+  TfLiteQuantizationParams quant;
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(0, kTfLiteFloat32, "",
+                                                     {1, 4}, quant),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(1, kTfLiteFloat32, "",
+                                                     {1, 4}, quant),
+            kTfLiteOk);
+  auto* add_params =
+      static_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+  add_params->activation = kTfLiteActNone;
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0, 0}, {1}, nullptr, 0,
+                                              add_params,
+                                              ops::builtin::Register_ADD()),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.ModifyGraphWithDelegate(xnnpack_delegate.get()),
+            kTfLiteOk);
+
+  // Resizing back reuses the runtimes cached for the earlier shapes.
+  for (int size : {4, 8, 4, 8, 16, 4}) {
+    ASSERT_EQ(interpreter.ResizeInputTensor(0, {1, size}), kTfLiteOk);
+    ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+    ASSERT_EQ(interpreter.execution_plan().size(), 1);
+    EXPECT_NE(
+        interpreter.node_and_registration(interpreter.execution_plan()[0])
+            ->first.delegate,
+        nullptr);
+    float* input = interpreter.typed_input_tensor<float>(0);
+    for (int i = 0; i < size; i++) {
+      input[i] = size * 100 + i;
+    }
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    const float* output = interpreter.typed_output_tensor<float>(0);
+    for (int i = 0; i < size; i++) {
+      EXPECT_EQ(output[i], 2.0f * (size * 100 + i)) << size << " " << i;
+    }
+  }
+}
+
 }  // namespace xnnpack
 }  // namespace tflite
@@ -20,6 +20,7 @@ limitations under the License.
 #include <cstdint>
 #include <cstring>
 #include <limits>
+#include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -44,6 +45,19 @@ namespace {
 // Forward declaration.
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate);
 
+using XNNPackRuntimePtr =
+    std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)>;
+
+// An XNNPACK runtime kept for reuse after its delegate kernel was freed.
+struct CachedRuntime {
+  // Identifies the delegated subgraph and the shapes of its tensors.
+  std::vector<int64_t> key;
+  XNNPackRuntimePtr runtime{nullptr, &xnn_delete_runtime};
+  std::unordered_set<int> externals;
+  // Unpacked quasi-static data that the runtime refers to.
+  std::shared_ptr<const std::vector<char>> static_unpacked_data;
+};
+
 class Delegate {
   friend class Subgraph;
 
@@ -73,6 +87,18 @@ class Delegate {
 #endif
   }
 
+  bool runtime_cache_enabled() const {
+    return options_.max_cached_runtimes > 0;
+  }
+
+  // Removes the cached runtime with `key` from the cache and returns it, or
+  // returns an entry without runtime if there is none.
+  CachedRuntime TakeCachedRuntime(const std::vector<int64_t>& key);
+
+  // Keeps `cached_runtime` for reuse, dropping the least recently cached
+  // runtime if the cache is full.
+  void CacheRuntime(CachedRuntime cached_runtime);
+
  private:
   TfLiteDelegate delegate_ = {
       reinterpret_cast<void*>(this),  // .data_
@@ -84,8 +110,10 @@ class Delegate {
   };
 
   // Unpacked data for quasi-static tensors, i.e. tensors produced by
-  // dequantizing or unpacking static buffers.
-  std::vector<char> static_unpacked_data_;
+  // dequantizing or unpacking static buffers. Shared with the runtimes that
+  // refer to it, which may outlive a new delegation.
+  std::shared_ptr<std::vector<char>> static_unpacked_data_ =
+      std::make_shared<std::vector<char>>();
   // Mapping from a tensor index for a quasi-static tensor to the offset to
   // its unpacked data within static_unpacked_data_.
   std::unordered_map<int, size_t> static_unpacked_data_map_;
@@ -103,13 +131,18 @@ class Delegate {
 #endif
 
   TfLiteXNNPackDelegateOptions options_;
+
+  // Runtimes for the shapes the delegated subgraphs had before inputs were
+  // resized, most recently cached first. Declared after the thread pool, which
+  // the runtimes use.
+  std::list<CachedRuntime> cached_runtimes_;
 };
 
 class Subgraph {
  public:
   static Subgraph* Create(TfLiteContext* context,
                           const TfLiteDelegateParams* params,
-                          const Delegate* delegate) {
+                          Delegate* delegate) {
     // Convert subgraph inputs and outputs to hash sets for faster lookup.
     const std::unordered_set<int> inputs(
         &params->input_tensors->data[0],
@@ -130,19 +163,6 @@ class Subgraph {
       return nullptr;
     }
 
-    xnn_subgraph_t subgraph_ptr = nullptr;
-    xnn_status status = xnn_create_subgraph(
-        /*external_value_ids=*/context->tensors_size, /*flags=*/0,
-        &subgraph_ptr);
-    if (status != xnn_status_success) {
-      TF_LITE_KERNEL_LOG(context, "failed to create XNNPACK subgraph");
-      return nullptr;
-    }
-
-    // Smart pointer to automatically release subgraph on exit.
-    std::unique_ptr<xnn_subgraph, decltype(&xnn_delete_subgraph)> subgraph(
-        subgraph_ptr, &xnn_delete_subgraph);
-
     bool has_sparse_weights = false;
     // Detect which tensors are used as inputs or outputs of any subgraph nodes.
     // -1 denotes tensor not used in the subgraph. These indexes will be
@@ -209,6 +229,30 @@ class Subgraph {
                   tensors.end());
     std::sort(tensors.begin(), tensors.end());
 
+    // Reuse the runtime built for the same nodes and shapes before the inputs
+    // were resized, if it was cached.
+    std::vector<int64_t> cache_key;
+    if (delegate->runtime_cache_enabled()) {
+      cache_key = RuntimeCacheKey(context, params, tensors);
+      CachedRuntime cached_runtime = delegate->TakeCachedRuntime(cache_key);
+      if (cached_runtime.runtime != nullptr) {
+        return new Subgraph(delegate, std::move(cached_runtime));
+      }
+    }
+
+    xnn_subgraph_t subgraph_ptr = nullptr;
+    xnn_status status = xnn_create_subgraph(
+        /*external_value_ids=*/context->tensors_size, /*flags=*/0,
+        &subgraph_ptr);
+    if (status != xnn_status_success) {
+      TF_LITE_KERNEL_LOG(context, "failed to create XNNPACK subgraph");
+      return nullptr;
+    }
+
+    // Smart pointer to automatically release subgraph on exit.
+    std::unique_ptr<xnn_subgraph, decltype(&xnn_delete_subgraph)> subgraph(
+        subgraph_ptr, &xnn_delete_subgraph);
+
     // XNNPACK Value IDs for TFLite tensors
     std::vector<uint32_t> xnnpack_tensors(tensors.back() + 1);
     for (int t : tensors) {
@@ -381,7 +425,7 @@ class Subgraph {
         // Check for quasi-static data.
         const auto it = delegate->static_unpacked_data_map_.find(t);
         if (it != delegate->static_unpacked_data_map_.end()) {
-          data = delegate->static_unpacked_data_.data() + it->second;
+          data = delegate->static_unpacked_data_->data() + it->second;
         }
       }
       if (inputs.count(t) != 0) {
@@ -481,23 +525,42 @@ class Subgraph {
       return nullptr;
     }
 
-    return new Subgraph(runtime_ptr, std::move(externals));
+    CachedRuntime runtime;
+    runtime.key = std::move(cache_key);
+    runtime.runtime.reset(runtime_ptr);
+    runtime.externals = std::move(externals);
+    runtime.static_unpacked_data = delegate->static_unpacked_data_;
+    return new Subgraph(delegate, std::move(runtime));
+  }
+
+  ~Subgraph() {
+    if (delegate_->runtime_cache_enabled()) {
+      delegate_->CacheRuntime(std::move(runtime_));
+    }
   }
 
   TfLiteStatus Prepare(TfLiteContext* context) { return kTfLiteOk; }
 
   TfLiteStatus Invoke(TfLiteContext* context) {
-    if (first_run_) {
-      std::vector<xnn_external_value> external_values;
-      for (int t : externals_) {
+    // The runtime is set up again if the inputs or outputs moved since the last
+    // run, e.g. when the interpreter swaps the buffers of state tensors.
+    bool externals_moved = first_run_;
+    for (size_t i = 0; i < external_values_.size() && !externals_moved; i++) {
+      externals_moved = external_values_[i].data !=
+                        context->tensors[external_values_[i].id].data.raw;
+    }
+    if (externals_moved) {
+      external_values_.clear();
+      for (int t : runtime_.externals) {
         xnn_external_value value = {0};
         value.id = static_cast<uint32_t>(t);
         value.data = context->tensors[t].data.raw;
-        external_values.push_back(value);
+        external_values_.push_back(value);
       }
 
-      const xnn_status status = xnn_setup_runtime(
-          runtime_.get(), external_values.size(), external_values.data());
+      const xnn_status status =
+          xnn_setup_runtime(runtime_.runtime.get(), external_values_.size(),
+                            external_values_.data());
       if (status != xnn_status_success) {
         TF_LITE_KERNEL_LOG(context, "failed to setup XNNPACK runtime");
         return kTfLiteError;
@@ -506,7 +569,7 @@ class Subgraph {
       first_run_ = false;
     }
 
-    const xnn_status status = xnn_invoke_runtime(runtime_.get());
+    const xnn_status status = xnn_invoke_runtime(runtime_.runtime.get());
     if (status != xnn_status_success) {
       TF_LITE_KERNEL_LOG(context, "failed to invoke XNNPACK runtime");
       return kTfLiteError;
@@ -3276,23 +3339,70 @@ class Subgraph {
   }
 
  private:
-  Subgraph(xnn_runtime_t runtime, std::unordered_set<int>&& externals)
-      : runtime_(runtime, &xnn_delete_runtime), externals_(externals) {}
-
-  // XNNPACK Runtime (subgraph + workspace) with smart-pointer for lifetime
-  // management.
-  std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)> runtime_{
-      nullptr, &xnn_delete_runtime};
-  // TFLite Tensor IDs == XNNPACK Value IDs of input/output tensors for the
-  // delegated subgraph.
-  std::unordered_set<int> externals_;
+  Subgraph(Delegate* delegate, CachedRuntime&& runtime)
+      : delegate_(delegate), runtime_(std::move(runtime)) {}
+
+  // Returns the key of the runtime cache for the subgraph of `params`, which
+  // uses `tensors`: the nodes, and the inputs, outputs, types and shapes of the
+  // tensors. Static tensors are identified by their data as well, so that the
+  // runtime of another model at the same context is not taken.
+  static std::vector<int64_t> RuntimeCacheKey(
+      TfLiteContext* context, const TfLiteDelegateParams* params,
+      const std::vector<int>& tensors) {
+    std::vector<int64_t> key = {reinterpret_cast<intptr_t>(context)};
+    for (const TfLiteIntArray* array :
+         {params->nodes_to_replace, params->input_tensors,
+          params->output_tensors}) {
+      key.push_back(array->size);
+      key.insert(key.end(), array->data, array->data + array->size);
+    }
+    for (int t : tensors) {
+      const TfLiteTensor& tensor = context->tensors[t];
+      key.push_back(t);
+      key.push_back(tensor.type);
+      key.push_back(tensor.allocation_type == kTfLiteMmapRo
+                        ? reinterpret_cast<intptr_t>(tensor.data.raw_const)
+                        : 0);
+      key.push_back(tensor.dims->size);
+      key.insert(key.end(), tensor.dims->data,
+                 tensor.dims->data + tensor.dims->size);
+    }
+    return key;
+  }
+
+  Delegate* delegate_;
+  // XNNPACK Runtime (subgraph + workspace), and TFLite Tensor IDs == XNNPACK
+  // Value IDs of input/output tensors for the delegated subgraph.
+  CachedRuntime runtime_;
   bool first_run_{true};
+  // The buffers of the inputs and outputs that the runtime was set up with.
+  std::vector<xnn_external_value> external_values_;
 };
 
+CachedRuntime Delegate::TakeCachedRuntime(const std::vector<int64_t>& key) {
+  for (auto it = cached_runtimes_.begin(); it != cached_runtimes_.end(); ++it) {
+    if (it->key == key) {
+      CachedRuntime cached_runtime = std::move(*it);
+      cached_runtimes_.erase(it);
+      return cached_runtime;
+    }
+  }
+  return CachedRuntime();
+}
+
+void Delegate::CacheRuntime(CachedRuntime cached_runtime) {
+  cached_runtimes_.push_front(std::move(cached_runtime));
+  if (cached_runtimes_.size() >
+      static_cast<size_t>(options_.max_cached_runtimes)) {
+    cached_runtimes_.pop_back();
+  }
+}
+
 TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
   // Clear previous data, in case the delegate is reused without re-creation.
+  // Runtimes created before may still refer to the previous unpacked data.
   static_unpacked_data_map_.clear();
-  static_unpacked_data_.clear();
+  static_unpacked_data_ = std::make_shared<std::vector<char>>();
   static_unpack_nodes_.clear();
   static_sparse_weights_.clear();
 
@@ -3512,16 +3622,16 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
     }
 
     // Align to XNN_EXTRA_BYTES bytes
-    while (static_unpacked_data_.size() % XNN_EXTRA_BYTES != 0) {
-      static_unpacked_data_.push_back(0);
+    while (static_unpacked_data_->size() % XNN_EXTRA_BYTES != 0) {
+      static_unpacked_data_->push_back(0);
     }
-    const size_t tensor_offset = static_unpacked_data_.size();
-    static_unpacked_data_.resize(tensor_offset + context->tensors[t].bytes);
+    const size_t tensor_offset = static_unpacked_data_->size();
+    static_unpacked_data_->resize(tensor_offset + context->tensors[t].bytes);
 
-    char* unpacked_data = static_unpacked_data_.data() + tensor_offset;
+    char* unpacked_data = static_unpacked_data_->data() + tensor_offset;
     const char* packed_data =
         static_unpacked_input_it_ != static_unpacked_data_map_.end()
-            ? static_unpacked_data_.data() + static_unpacked_input_it_->second
+            ? static_unpacked_data_->data() + static_unpacked_input_it_->second
             : static_cast<const char*>(input_tensor.data.data);
     switch (registration->builtin_code) {
       case kTfLiteBuiltinDequantize: {
@@ -34,6 +34,16 @@ typedef struct {
   // defining macro ENABLE_TFLITE_XNNPACK_DEQUANTIZED_INT8_WEIGHTS will enable
   // this feature.
   bool enable_int8_weights_unpacking;
+
+  // Maximum number of XNNPACK runtimes to keep after the inputs of the
+  // delegated subgraphs are resized. Resizing an input re-applies the delegate,
+  // and a cached runtime for the same shapes is reused instead of being built
+  // again, which saves repacking the weights when inputs alternate between a
+  // few shapes. 0 disables the cache, which is the default.
+  //
+  // A delegate with a runtime cache must only be applied to one interpreter.
+  // WARNING: This is an experimental API and subject to change.
+  int32_t max_cached_runtimes;
 } TfLiteXNNPackDelegateOptions;
 
 // Returns a structure with the default XNNPack delegate options.
@@ -0,0 +1,378 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/partition_selector.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <utility>
+
+#include "absl/strings/ascii.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace acceleration {
+
+namespace {
+
+// The state of a delegate created by CreateNodeSubsetDelegate().
+struct NodeSubsetDelegateData {
+  delegates::TfLiteDelegatePtr delegate;
+  // Sorted.
+  std::vector<int> node_indices;
+  // The GetExecutionPlan() of the context being prepared, which the wrapped
+  // delegate sees filtered.
+  TfLiteStatus (*get_execution_plan)(TfLiteContext* context,
+                                     TfLiteIntArray** execution_plan) =
+      nullptr;
+  TfLiteIntArray* filtered_execution_plan = nullptr;
+};
+
+// The node subset delegate being prepared on this thread.
+thread_local NodeSubsetDelegateData* preparing_node_subset = nullptr;
+
+TfLiteStatus GetFilteredExecutionPlan(TfLiteContext* context,
+                                      TfLiteIntArray** execution_plan) {
+  NodeSubsetDelegateData* data = preparing_node_subset;
+  TfLiteIntArray* full_execution_plan;
+  TF_LITE_ENSURE_STATUS(
+      data->get_execution_plan(context, &full_execution_plan));
+  std::vector<int> node_indices;
+  for (int i = 0; i < full_execution_plan->size; ++i) {
+    const int node_index = full_execution_plan->data[i];
+    if (std::binary_search(data->node_indices.begin(),
+                           data->node_indices.end(), node_index)) {
+      node_indices.push_back(node_index);
+    }
+  }
+  TfLiteIntArrayFree(data->filtered_execution_plan);
+  data->filtered_execution_plan = ConvertVectorToTfLiteIntArray(node_indices);
+  *execution_plan = data->filtered_execution_plan;
+  return kTfLiteOk;
+}
+
+TfLiteStatus PrepareNodeSubset(TfLiteContext* context,
+                               TfLiteDelegate* delegate) {
+  auto* data = static_cast<NodeSubsetDelegateData*>(delegate->data_);
+  TfLiteDelegate* wrapped = data->delegate.get();
+  data->get_execution_plan = context->GetExecutionPlan;
+  preparing_node_subset = data;
+  context->GetExecutionPlan = GetFilteredExecutionPlan;
+  const TfLiteStatus status = wrapped->Prepare(context, wrapped);
+  context->GetExecutionPlan = data->get_execution_plan;
+  preparing_node_subset = nullptr;
+  return status;
+}
+
+void DeleteNodeSubsetDelegate(TfLiteDelegate* delegate) {
+  auto* data = static_cast<NodeSubsetDelegateData*>(delegate->data_);
+  TfLiteIntArrayFree(data->filtered_execution_plan);
+  delete data;
+  delete delegate;
+}
+
+// Sums up the time spent in each node of the primary subgraph.
+class NodeLatencyProfiler : public Profiler {
+ public:
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      int64_t event_metadata1,
+                      int64_t event_metadata2) override {
+    if (event_type != EventType::OPERATOR_INVOKE_EVENT ||
+        event_metadata2 != 0) {
+      return 0;
+    }
+    events_.push_back({static_cast<int>(event_metadata1),
+                       profiling::time::NowMicros()});
+    return events_.size();
+  }
+
+  void EndEvent(uint32_t event_handle) override {
+    if (event_handle == 0) {
+      return;
+    }
+    const Event& event = events_[event_handle - 1];
+    total_time_us_[event.node_index] +=
+        profiling::time::NowMicros() - event.start_time_us;
+  }
+
+  const std::map<int, uint64_t>& total_time_us() const {
+    return total_time_us_;
+  }
+
+ private:
+  struct Event {
+    int node_index;
+    uint64_t start_time_us;
+  };
+  std::vector<Event> events_;
+  std::map<int, uint64_t> total_time_us_;
+};
+
+// A partition that a candidate delegate runs.
+struct Partition {
+  int candidate;
+  std::vector<int> node_indices;
+  // How much faster the delegate runs the nodes than the CPU kernels.
+  double saved_time_us;
+};
+
+}  // namespace
+
+delegates::TfLiteDelegatePtr CreateNodeSubsetDelegate(
+    delegates::TfLiteDelegatePtr delegate, std::vector<int> node_indices) {
+  auto* data = new NodeSubsetDelegateData{std::move(delegate),
+                                          std::move(node_indices)};
+  std::sort(data->node_indices.begin(), data->node_indices.end());
+  TfLiteDelegate* wrapped = data->delegate.get();
+  auto* node_subset_delegate = new TfLiteDelegate(TfLiteDelegateCreate());
+  node_subset_delegate->data_ = data;
+  node_subset_delegate->flags = wrapped->flags;
+  node_subset_delegate->Prepare = PrepareNodeSubset;
+  // The delegate kernels, and the tensors they handle, refer to the wrapped
+  // delegate for the buffer handles.
+  node_subset_delegate->CopyFromBufferHandle = wrapped->CopyFromBufferHandle;
+  node_subset_delegate->CopyToBufferHandle = wrapped->CopyToBufferHandle;
+  node_subset_delegate->FreeBufferHandle = wrapped->FreeBufferHandle;
+  return delegates::TfLiteDelegatePtr(node_subset_delegate,
+                                      DeleteNodeSubsetDelegate);
+}
+
+std::unique_ptr<delegates::DelegatePluginInterface> CreateDelegatePlugin(
+    const TFLiteSettings& settings) {
+  return delegates::DelegatePluginRegistry::CreateByName(
+      std::string(EnumNameDelegate(settings.delegate())) + "Plugin", settings);
+}
+
+PartitionSelector::PartitionSelector(
+    const FlatBufferModel* model, const OpResolver* resolver,
+    std::vector<std::unique_ptr<delegates::DelegatePluginInterface>>
+        candidates,
+    ErrorReporter* error_reporter)
+    : model_(model),
+      resolver_(resolver),
+      candidates_(std::move(candidates)),
+      error_reporter_(error_reporter) {}
+
+MinibenchmarkStatus PartitionSelector::BuildInterpreter(
+    int candidate, std::unique_ptr<Interpreter>* interpreter) {
+  if (InterpreterBuilder(*model_, *resolver_)(interpreter) != kTfLiteOk) {
+    return kMinibenchmarkInterpreterBuilderFailed;
+  }
+  if (candidate != kCpuNode) {
+    delegates::TfLiteDelegatePtr delegate = candidates_[candidate]->Create();
+    if (!delegate) {
+      return kMinibenchmarkDelegateNotSupported;
+    }
+    if ((*interpreter)->ModifyGraphWithDelegate(std::move(delegate)) !=
+        kTfLiteOk) {
+      return kMinibenchmarkModifyGraphWithDelegateFailed;
+    }
+  }
+  if ((*interpreter)->AllocateTensors() != kTfLiteOk) {
+    return kMinibenchmarkAllocateTensorsFailed;
+  }
+  return kMinibenchmarkSuccess;
+}
+
+MinibenchmarkStatus PartitionSelector::MeasureNodeLatencies(
+    Interpreter* interpreter, std::map<int, double>* node_latency_us) {
+  for (int input : interpreter->inputs()) {
+    TfLiteTensor* tensor = interpreter->tensor(input);
+    if (tensor->data.raw != nullptr) {
+      std::memset(tensor->data.raw, 0, tensor->bytes);
+    }
+  }
+  for (int i = 0; i < num_warmup_runs_; ++i) {
+    if (interpreter->Invoke() != kTfLiteOk) {
+      return kMinibenchmarkInvokeFailed;
+    }
+  }
+  NodeLatencyProfiler profiler;
+  interpreter->SetProfiler(&profiler);
+  MinibenchmarkStatus status = kMinibenchmarkSuccess;
+  for (int i = 0; i < num_runs_ && status == kMinibenchmarkSuccess; ++i) {
+    if (interpreter->Invoke() != kTfLiteOk) {
+      status = kMinibenchmarkInvokeFailed;
+    }
+  }
+  interpreter->SetProfiler(nullptr);
+  if (status != kMinibenchmarkSuccess) {
+    return status;
+  }
+  node_latency_us->clear();
+  for (const auto& node_and_time : profiler.total_time_us()) {
+    (*node_latency_us)[node_and_time.first] =
+        static_cast<double>(node_and_time.second) / std::max(num_runs_, 1);
+  }
+  return kMinibenchmarkSuccess;
+}
+
+MinibenchmarkStatus PartitionSelector::Select(NodeAssignment* assignment) {
+  std::unique_ptr<Interpreter> interpreter;
+  MinibenchmarkStatus status = BuildInterpreter(kCpuNode, &interpreter);
+  if (status != kMinibenchmarkSuccess) {
+    return status;
+  }
+  std::map<int, double> cpu_latency_us;
+  status = MeasureNodeLatencies(interpreter.get(), &cpu_latency_us);
+  if (status != kMinibenchmarkSuccess) {
+    return status;
+  }
+  const int num_nodes = interpreter->nodes_size();
+
+  std::vector<Partition> partitions;
+  const int num_candidates = candidates_.size();
+  for (int candidate = 0; candidate < num_candidates; ++candidate) {
+    status = BuildInterpreter(candidate, &interpreter);
+    std::map<int, double> latency_us;
+    if (status == kMinibenchmarkSuccess) {
+      status = MeasureNodeLatencies(interpreter.get(), &latency_us);
+    }
+    if (status != kMinibenchmarkSuccess) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Leaving out delegate candidate %d (status %d).",
+                           candidate, status);
+      continue;
+    }
+    for (int node_index : interpreter->execution_plan()) {
+      const TfLiteNode& node =
+          interpreter->node_and_registration(node_index)->first;
+      if (node.delegate == nullptr) {
+        continue;
+      }
+      const auto* params =
+          static_cast<const TfLiteDelegateParams*>(node.builtin_data);
+      Partition partition{candidate, {}, -latency_us[node_index]};
+      for (int i = 0; i < params->nodes_to_replace->size; ++i) {
+        const int replaced_node = params->nodes_to_replace->data[i];
+        partition.node_indices.push_back(replaced_node);
+        partition.saved_time_us += cpu_latency_us[replaced_node];
+      }
+      if (partition.saved_time_us > 0) {
+        partitions.push_back(std::move(partition));
+      }
+    }
+  }
+
+  std::stable_sort(partitions.begin(), partitions.end(),
+                   [](const Partition& a, const Partition& b) {
+                     return a.saved_time_us > b.saved_time_us;
+                   });
+  assignment->assign(num_nodes, kCpuNode);
+  for (const Partition& partition : partitions) {
+    if (std::all_of(partition.node_indices.begin(),
+                    partition.node_indices.end(), [&](int node_index) {
+                      return (*assignment)[node_index] == kCpuNode;
+                    })) {
+      for (int node_index : partition.node_indices) {
+        (*assignment)[node_index] = partition.candidate;
+      }
+    }
+  }
+  return kMinibenchmarkSuccess;
+}
+
+MinibenchmarkStatus PartitionSelector::Apply(const NodeAssignment& assignment,
+                                             Interpreter* interpreter) {
+  const int num_nodes = assignment.size();
+  if (num_nodes != static_cast<int>(interpreter->nodes_size())) {
+    return kMinibenchmarkPreconditionNotMet;
+  }
+  const int num_candidates = candidates_.size();
+  for (int candidate = 0; candidate < num_candidates; ++candidate) {
+    std::vector<int> node_indices;
+    for (int node_index = 0; node_index < num_nodes; ++node_index) {
+      if (assignment[node_index] == candidate) {
+        node_indices.push_back(node_index);
+      }
+    }
+    if (node_indices.empty()) {
+      continue;
+    }
+    delegates::TfLiteDelegatePtr delegate = candidates_[candidate]->Create();
+    if (!delegate) {
+      return kMinibenchmarkDelegateNotSupported;
+    }
+    if (interpreter->ModifyGraphWithDelegate(CreateNodeSubsetDelegate(
+            std::move(delegate), std::move(node_indices))) != kTfLiteOk) {
+      return kMinibenchmarkModifyGraphWithDelegateFailed;
+    }
+  }
+  return kMinibenchmarkSuccess;
+}
+
+MinibenchmarkStatus NodeAssignmentStorage::Read() {
+  assignments_.clear();
+  MinibenchmarkStatus status = ReadFileIntoBuffer();
+  if (status != kMinibenchmarkSuccess) {
+    return status;
+  }
+  std::istringstream lines(buffer_);
+  std::string line;
+  while (std::getline(lines, line)) {
+    std::istringstream fields(line);
+    std::string key;
+    NodeAssignment assignment;
+    fields >> key;
+    int delegate_index;
+    while (fields >> delegate_index) {
+      assignment.push_back(delegate_index);
+    }
+    if (key.empty() || !fields.eof()) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Corrupt node assignment file %s", path_.c_str());
+      assignments_.clear();
+      return kMinibenchmarkErrorReadingStorageFile;
+    }
+    assignments_[key] = std::move(assignment);
+  }
+  return kMinibenchmarkSuccess;
+}
+
+bool NodeAssignmentStorage::Lookup(absl::string_view key,
+                                   NodeAssignment* assignment) const {
+  auto it = assignments_.find(std::string(key));
+  if (it == assignments_.end()) {
+    return false;
+  }
+  *assignment = it->second;
+  return true;
+}
+
+MinibenchmarkStatus NodeAssignmentStorage::Append(
+    absl::string_view key, const NodeAssignment& assignment) {
+  if (key.empty() || std::any_of(key.begin(), key.end(), [](char c) {
+        return absl::ascii_isspace(c);
+      })) {
+    return kMinibenchmarkPreconditionNotMet;
+  }
+  std::string line(key);
+  for (int delegate_index : assignment) {
+    line += " " + std::to_string(delegate_index);
+  }
+  line += "\n";
+  MinibenchmarkStatus status = AppendDataToFile(line);
+  if (status != kMinibenchmarkSuccess) {
+    return status;
+  }
+  return Read();
+}
+
+}  // namespace acceleration
+}  // namespace tflite
@@ -0,0 +1,148 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_ACCELERATION_MINI_BENCHMARK_PARTITION_SELECTOR_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_ACCELERATION_MINI_BENCHMARK_PARTITION_SELECTOR_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/experimental/acceleration/configuration/configuration_generated.h"
+#include "tensorflow/lite/experimental/acceleration/configuration/delegate_registry.h"
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/fb_storage.h"
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/status_codes.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/stderr_reporter.h"
+
+namespace tflite {
+namespace acceleration {
+
+// Which delegate runs each node of the primary subgraph of a model:
+// `assignment[node_index]` is the index of a candidate delegate of a
+// PartitionSelector, or kCpuNode for the builtin kernels.
+using NodeAssignment = std::vector<int>;
+constexpr int kCpuNode = -1;
+
+// Returns a delegate that hands `delegate` only the nodes of the execution plan
+// in `node_indices` to pick from, and takes ownership of `delegate`. Applying
+// several of them lets different delegates run different partitions of one
+// graph.
+delegates::TfLiteDelegatePtr CreateNodeSubsetDelegate(
+    delegates::TfLiteDelegatePtr delegate, std::vector<int> node_indices);
+
+// Picks, partition by partition, the delegate that runs a model the fastest on
+// this device.
+//
+// Which nodes a delegate can take only depends on op support, so a delegate
+// that is quick on one device may be slower than the CPU kernels on another.
+// The selector instead measures the model with each candidate delegate: the
+// profiler reports the time of every delegate kernel, that is every partition,
+// and of every node left on the CPU. A partition is assigned to its delegate if
+// it runs faster than the CPU kernels of its nodes, starting with the partition
+// that saves the most time among all candidates. Delegate kernels copy their
+// inputs and outputs from and to CPU memory, so that cost is part of the time
+// measured.
+//
+// The measurements take several invocations of the model per candidate, so the
+// picked assignment is meant to be stored in a NodeAssignmentStorage and reused
+// for the same model on the same device.
+class PartitionSelector {
+ public:
+  // `resolver` should not add default delegates. `candidates` create the
+  // delegates to measure; see CreateDelegatePlugin().
+  PartitionSelector(
+      const FlatBufferModel* model, const OpResolver* resolver,
+      std::vector<std::unique_ptr<delegates::DelegatePluginInterface>>
+          candidates,
+      ErrorReporter* error_reporter = DefaultErrorReporter());
+
+  // Sets how many invocations run before and while the latencies are measured.
+  void SetNumRuns(int num_warmup_runs, int num_runs) {
+    num_warmup_runs_ = num_warmup_runs;
+    num_runs_ = num_runs;
+  }
+
+  // Measures the candidates and stores the fastest assignment. A candidate
+  // that can't be applied to the model is left out.
+  MinibenchmarkStatus Select(NodeAssignment* assignment);
+
+  // Applies the delegates of `assignment` to `interpreter`, which must be
+  // built from the same model and not have delegates applied yet. The
+  // delegates are created by the candidates, which must outlive them.
+  MinibenchmarkStatus Apply(const NodeAssignment& assignment,
+                            Interpreter* interpreter);
+
+ private:
+  // Builds an interpreter for the model, with the delegate of `candidate`
+  // unless it's kCpuNode.
+  MinibenchmarkStatus BuildInterpreter(
+      int candidate, std::unique_ptr<Interpreter>* interpreter);
+
+  // Invokes `interpreter` and stores the mean time spent in each node of its
+  // execution plan, by node index.
+  MinibenchmarkStatus MeasureNodeLatencies(
+      Interpreter* interpreter, std::map<int, double>* node_latency_us);
+
+  const FlatBufferModel* model_;
+  const OpResolver* resolver_;
+  std::vector<std::unique_ptr<delegates::DelegatePluginInterface>>
+      candidates_;
+  ErrorReporter* error_reporter_;
+  int num_warmup_runs_ = 2;
+  int num_runs_ = 10;
+};
+
+// Creates the delegate plugin for `settings`, or returns nullptr if the plugin
+// isn't linked in. `settings` must outlive the plugin.
+std::unique_ptr<delegates::DelegatePluginInterface> CreateDelegatePlugin(
+    const TFLiteSettings& settings);
+
+// Stores the node assignments picked by PartitionSelector in a file. Each is
+// stored under a key that must identify the model, the candidates and the
+// device, such as a hash of the model and the candidate settings; a later
+// assignment for the same key replaces the earlier ones.
+class NodeAssignmentStorage : protected FileStorage {
+ public:
+  explicit NodeAssignmentStorage(
+      absl::string_view path,
+      ErrorReporter* error_reporter = DefaultErrorReporter())
+      : FileStorage(path, error_reporter) {}
+
+  // Reads current contents. Returns an error if file is inaccessible or
+  // contents are corrupt. The file not existing is not an error.
+  MinibenchmarkStatus Read();
+
+  // Returns whether an assignment is stored for `key`, and stores it in
+  // `assignment` if so.
+  bool Lookup(absl::string_view key, NodeAssignment* assignment) const;
+
+  // Stores `assignment` for `key`, which must not be empty or contain
+  // whitespace, and writes it out to disk.
+  MinibenchmarkStatus Append(absl::string_view key,
+                             const NodeAssignment& assignment);
+
+ private:
+  std::map<std::string, NodeAssignment> assignments_;
+};
+
+}  // namespace acceleration
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_ACCELERATION_MINI_BENCHMARK_PARTITION_SELECTOR_H_
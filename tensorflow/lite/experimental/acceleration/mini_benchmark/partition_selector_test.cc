@@ -0,0 +1,202 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/acceleration/mini_benchmark/partition_selector.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/builtin_op_kernels.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/mutable_op_resolver.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace acceleration {
+namespace {
+
+using ::testing::ElementsAre;
+
+// A delegate plugin whose delegates take the nodes in `supported_nodes` that
+// they are offered, and whose kernels only wait for `latency`.
+class FakeDelegatePlugin : public delegates::DelegatePluginInterface {
+ public:
+  FakeDelegatePlugin(std::vector<int> supported_nodes,
+                     std::chrono::milliseconds latency)
+      : supported_nodes_(std::move(supported_nodes)), latency_(latency) {}
+
+  delegates::TfLiteDelegatePtr Create() override {
+    auto* delegate = new TfLiteDelegate(TfLiteDelegateCreate());
+    delegate->data_ = this;
+    delegate->Prepare = [](TfLiteContext* context, TfLiteDelegate* delegate) {
+      auto* plugin = static_cast<FakeDelegatePlugin*>(delegate->data_);
+      TfLiteIntArray* execution_plan;
+      TF_LITE_ENSURE_STATUS(
+          context->GetExecutionPlan(context, &execution_plan));
+      std::vector<int> nodes;
+      for (int i = 0; i < execution_plan->size; ++i) {
+        const int node_index = execution_plan->data[i];
+        if (std::count(plugin->supported_nodes_.begin(),
+                       plugin->supported_nodes_.end(), node_index)) {
+          nodes.push_back(node_index);
+        }
+      }
+      TfLiteRegistration registration{};
+      registration.init = [](TfLiteContext* context, const char* buffer,
+                             size_t length) -> void* {
+        return reinterpret_cast<const TfLiteDelegateParams*>(buffer)
+            ->delegate->data_;
+      };
+      registration.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+        std::this_thread::sleep_for(
+            static_cast<FakeDelegatePlugin*>(node->user_data)->latency_);
+        return kTfLiteOk;
+      };
+      registration.custom_name = "FakeDelegate";
+      TfLiteIntArray* nodes_to_replace = ConvertVectorToTfLiteIntArray(nodes);
+      const TfLiteStatus status =
+          context->ReplaceNodeSubsetsWithDelegateKernels(
+              context, registration, nodes_to_replace, delegate);
+      TfLiteIntArrayFree(nodes_to_replace);
+      return status;
+    };
+    return delegates::TfLiteDelegatePtr(
+        delegate, [](TfLiteDelegate* delegate) { delete delegate; });
+  }
+
+  int GetDelegateErrno(TfLiteDelegate* from_delegate) override { return 0; }
+
+ private:
+  const std::vector<int> supported_nodes_;
+  const std::chrono::milliseconds latency_;
+};
+
+// Returns an ADD kernel that takes 10ms longer than the builtin one.
+TfLiteRegistration* GetSlowAddRegistration() {
+  static TfLiteRegistration registration = []() {
+    TfLiteRegistration slow_add = *ops::builtin::Register_ADD();
+    slow_add.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      return ops::builtin::Register_ADD()->invoke(context, node);
+    };
+    return slow_add;
+  }();
+  return &registration;
+}
+
+class PartitionSelectorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Two ADD nodes, the second one taking the output of the first one.
+    model_ = FlatBufferModel::BuildFromFile("tensorflow/lite/testdata/add.bin");
+    ASSERT_NE(model_, nullptr);
+    resolver_.AddBuiltin(BuiltinOperator_ADD, GetSlowAddRegistration());
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  MutableOpResolver resolver_;
+};
+
+TEST_F(PartitionSelectorTest, AssignsNodesToFasterDelegates) {
+  std::vector<std::unique_ptr<delegates::DelegatePluginInterface>> candidates;
+  // Slower than the CPU kernels of both nodes.
+  candidates.emplace_back(new FakeDelegatePlugin(
+      /*supported_nodes=*/{0, 1}, std::chrono::milliseconds(40)));
+  candidates.emplace_back(new FakeDelegatePlugin(
+      /*supported_nodes=*/{1}, std::chrono::milliseconds(0)));
+  PartitionSelector selector(model_.get(), &resolver_, std::move(candidates));
+  selector.SetNumRuns(/*num_warmup_runs=*/1, /*num_runs=*/3);
+
+  NodeAssignment assignment;
+  ASSERT_EQ(selector.Select(&assignment), kMinibenchmarkSuccess);
+  EXPECT_THAT(assignment, ElementsAre(kCpuNode, 1));
+
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(InterpreterBuilder(*model_, resolver_)(&interpreter), kTfLiteOk);
+  ASSERT_EQ(selector.Apply(assignment, interpreter.get()),
+            kMinibenchmarkSuccess);
+  ASSERT_EQ(interpreter->execution_plan().size(), 2);
+  EXPECT_EQ(interpreter->execution_plan()[0], 0);
+  const TfLiteNode& delegate_node =
+      interpreter->node_and_registration(interpreter->execution_plan()[1])
+          ->first;
+  ASSERT_NE(delegate_node.delegate, nullptr);
+  const TfLiteIntArray* replaced_nodes =
+      static_cast<const TfLiteDelegateParams*>(delegate_node.builtin_data)
+          ->nodes_to_replace;
+  ASSERT_EQ(replaced_nodes->size, 1);
+  EXPECT_EQ(replaced_nodes->data[0], 1);
+  EXPECT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(interpreter->Invoke(), kTfLiteOk);
+}
+
+TEST_F(PartitionSelectorTest, KeepsNodesOnCpuWithoutFasterDelegates) {
+  std::vector<std::unique_ptr<delegates::DelegatePluginInterface>> candidates;
+  candidates.emplace_back(new FakeDelegatePlugin(
+      /*supported_nodes=*/{0, 1}, std::chrono::milliseconds(40)));
+  PartitionSelector selector(model_.get(), &resolver_, std::move(candidates));
+  selector.SetNumRuns(/*num_warmup_runs=*/1, /*num_runs=*/3);
+
+  NodeAssignment assignment;
+  ASSERT_EQ(selector.Select(&assignment), kMinibenchmarkSuccess);
+  EXPECT_THAT(assignment, ElementsAre(kCpuNode, kCpuNode));
+}
+
+std::string GetStoragePath() {
+  std::string path =
+#ifdef __ANDROID__
+      "/data/local/tmp";
+#else
+      getenv("TEST_TMPDIR") ? getenv("TEST_TMPDIR") : getenv("TEMP");
+#endif
+  path += "/node_assignments";
+  unlink(path.c_str());
+  return path;
+}
+
+TEST(NodeAssignmentStorageTest, AppendAndLookup) {
+  std::string path = GetStoragePath();
+  NodeAssignmentStorage storage(path);
+  ASSERT_EQ(storage.Read(), kMinibenchmarkSuccess);
+  NodeAssignment assignment;
+  EXPECT_FALSE(storage.Lookup("model", &assignment));
+
+  EXPECT_EQ(storage.Append("model", {kCpuNode, 1}), kMinibenchmarkSuccess);
+  EXPECT_EQ(storage.Append("other_model", {0}), kMinibenchmarkSuccess);
+  EXPECT_EQ(storage.Append("model", {0, 1}), kMinibenchmarkSuccess);
+  EXPECT_EQ(storage.Append("no whitespace", {0}),
+            kMinibenchmarkPreconditionNotMet);
+
+  NodeAssignmentStorage reread_storage(path);
+  ASSERT_EQ(reread_storage.Read(), kMinibenchmarkSuccess);
+  ASSERT_TRUE(reread_storage.Lookup("model", &assignment));
+  EXPECT_THAT(assignment, ElementsAre(0, 1));
+  ASSERT_TRUE(reread_storage.Lookup("other_model", &assignment));
+  EXPECT_THAT(assignment, ElementsAre(0));
+}
+
+}  // namespace
+}  // namespace acceleration
+}  // namespace tflite
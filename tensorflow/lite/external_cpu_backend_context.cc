@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/external_cpu_backend_context.h"
 
+#include <cstdlib>
+
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/inter_op_thread_pool.h"
 
 namespace tflite {
 namespace {
@@ -22,19 +25,86 @@ namespace {
 TfLiteStatus RefreshExternalCpuBackendContext(TfLiteContext* context) {
   auto* const external_context = static_cast<ExternalCpuBackendContext*>(
       context->GetExternalContext(context, kTfLiteCpuBackendContext));
-  if (external_context && external_context->internal_backend_context() &&
-      context->recommended_num_threads != -1) {
-    external_context->internal_backend_context()->SetMaxNumThreads(
-        context->recommended_num_threads);
+  if (external_context && context->recommended_num_threads != -1) {
+    external_context->SetMaxNumThreads(context->recommended_num_threads);
   }
   return kTfLiteOk;
 }
 }  // namespace
 
+std::shared_ptr<const void> PackedWeightsCache::GetOrPack(
+    const void* source, size_t source_bytes, const std::string& kind,
+    size_t packed_bytes, const PackFunction& pack) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::weak_ptr<const void>& entry =
+      entries_[Key(source, source_bytes, kind)];
+  if (std::shared_ptr<const void> packed = entry.lock()) {
+    return packed;
+  }
+  // The lock is held while packing, so that concurrent interpreters wait for
+  // the weights instead of packing them again.
+  void* packed_data = std::malloc(packed_bytes);
+  pack(packed_data);
+  std::shared_ptr<const void> packed(packed_data, std::free);
+  entry = packed;
+  // Drop the entries whose interpreters are all gone.
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.expired()) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return packed;
+}
+
+int PackedWeightsCache::num_entries() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int num_entries = 0;
+  for (const auto& entry : entries_) {
+    num_entries += !entry.second.expired();
+  }
+  return num_entries;
+}
+
 ExternalCpuBackendContext::ExternalCpuBackendContext()
     : internal_backend_context_(nullptr) {
   this->type = kTfLiteCpuBackendContext;
   this->Refresh = RefreshExternalCpuBackendContext;
 }
 
+void ExternalCpuBackendContext::set_internal_backend_context(
+    std::unique_ptr<TfLiteInternalBackendContext> internal_backend_context) {
+  const int thread_index = InterOpThreadPool::CurrentThreadIndex();
+  if (thread_index == 0) {
+    internal_backend_context_ = std::move(internal_backend_context);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(inter_op_thread_mutex_);
+  inter_op_thread_backend_contexts_[thread_index] =
+      std::move(internal_backend_context);
+}
+
+TfLiteInternalBackendContext*
+ExternalCpuBackendContext::internal_backend_context() const {
+  const int thread_index = InterOpThreadPool::CurrentThreadIndex();
+  if (thread_index == 0) {
+    return internal_backend_context_.get();
+  }
+  std::lock_guard<std::mutex> lock(inter_op_thread_mutex_);
+  auto it = inter_op_thread_backend_contexts_.find(thread_index);
+  return it == inter_op_thread_backend_contexts_.end() ? nullptr
+                                                       : it->second.get();
+}
+
+void ExternalCpuBackendContext::SetMaxNumThreads(int max_num_threads) {
+  if (internal_backend_context_) {
+    internal_backend_context_->SetMaxNumThreads(max_num_threads);
+  }
+  std::lock_guard<std::mutex> lock(inter_op_thread_mutex_);
+  for (auto& thread_and_context : inter_op_thread_backend_contexts_) {
+    thread_and_context.second->SetMaxNumThreads(max_num_threads);
+  }
+}
+
 }  // namespace tflite
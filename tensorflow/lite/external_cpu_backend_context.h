@@ -15,13 +15,61 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
 #define TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
 
+#include <cstddef>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <tuple>
 #include <utility>
 
 #include "tensorflow/lite/c/common.h"
 
 namespace tflite {
 
+// A cache of weights that kernels repack from constant tensors, such as
+// transposed convolution filters, which can be shared by all the interpreters
+// built from the same FlatBufferModel: the constant tensors of such
+// interpreters point into the same model buffer, so the position of a constant
+// tensor in the buffer identifies the packed weights across interpreters.
+//
+// An entry lives as long as an interpreter uses it. The class is thread-safe,
+// so the interpreters can be invoked from different threads.
+//
+//  auto cache = std::make_shared<PackedWeightsCache>();
+//  for (auto& interpreter : interpreters) {
+//    interpreter->SetPackedWeightsCache(cache);
+//  }
+class PackedWeightsCache {
+ public:
+  using PackFunction = std::function<void(void* packed_data)>;
+
+  PackedWeightsCache() = default;
+
+  // Returns the `packed_bytes` bytes that `pack` computes from the constant
+  // tensor data at [`source`, `source` + `source_bytes`). `kind` names the
+  // packing, so that a kernel can pack the same tensor in different ways.
+  // `pack` is only called if no interpreter holds the packed weights yet.
+  std::shared_ptr<const void> GetOrPack(const void* source,
+                                        size_t source_bytes,
+                                        const std::string& kind,
+                                        size_t packed_bytes,
+                                        const PackFunction& pack);
+
+  // Returns the number of packed weights held by some interpreter.
+  int num_entries() const;
+
+ private:
+  using Key = std::tuple<const void*, size_t, std::string>;
+
+  mutable std::mutex mutex_;
+  std::map<Key, std::weak_ptr<const void>> entries_;
+
+  PackedWeightsCache(const PackedWeightsCache&) = delete;
+  PackedWeightsCache& operator=(const PackedWeightsCache&) = delete;
+};
+
 // This is the base class for TF Lite internal backend contexts (like a
 // RUY-based cpu backend context class). A derived internal backend context is
 // generally a collection of utilities (i.e. a thread pool etc.) for TF Lite to
@@ -78,24 +126,49 @@ class TfLiteInternalBackendContext {
 // context if/when the interpreter no longer needs the shared context.
 // See, e.g., TFLiteInterpreter destructor clears caches in the case of a
 // shared ExternalCpuBackendContext.
+//
+// Each thread of an InterOpThreadPool has an internal backend context of its
+// own, so that the nodes that the interpreter runs concurrently don't share
+// one.
 class ExternalCpuBackendContext : public TfLiteExternalContext {
  public:
   ExternalCpuBackendContext();
   ~ExternalCpuBackendContext() {}
 
+  // Sets the internal backend context of the calling thread.
   void set_internal_backend_context(
-      std::unique_ptr<TfLiteInternalBackendContext> internal_backend_context) {
-    internal_backend_context_ = std::move(internal_backend_context);
+      std::unique_ptr<TfLiteInternalBackendContext> internal_backend_context);
+
+  // Returns the internal backend context of the calling thread.
+  TfLiteInternalBackendContext* internal_backend_context() const;
+
+  // Sets the maximum number of threads of the internal backend contexts of
+  // all the threads.
+  void SetMaxNumThreads(int max_num_threads);
+
+  // Lets the kernels share the weights they pack from constant tensors with
+  // the other interpreters that use the same cache, see PackedWeightsCache.
+  // Must be set before the tensors are allocated.
+  void set_packed_weights_cache(std::shared_ptr<PackedWeightsCache> cache) {
+    packed_weights_cache_ = std::move(cache);
   }
 
-  TfLiteInternalBackendContext* internal_backend_context() const {
-    return internal_backend_context_.get();
+  PackedWeightsCache* packed_weights_cache() const {
+    return packed_weights_cache_.get();
   }
 
  private:
   // Note the actual internal backend context object is lazily initialized.
   std::unique_ptr<TfLiteInternalBackendContext> internal_backend_context_;
 
+  // The internal backend contexts of the InterOpThreadPool threads, by thread
+  // index.
+  mutable std::mutex inter_op_thread_mutex_;
+  std::map<int, std::unique_ptr<TfLiteInternalBackendContext>>
+      inter_op_thread_backend_contexts_;
+
+  std::shared_ptr<PackedWeightsCache> packed_weights_cache_;
+
   ExternalCpuBackendContext(const ExternalCpuBackendContext&) = delete;
   ExternalCpuBackendContext& operator=(const ExternalCpuBackendContext&) =
       delete;
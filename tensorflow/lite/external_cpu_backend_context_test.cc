@@ -0,0 +1,75 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+#include <cstring>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+constexpr float kWeights[] = {1.0f, 2.0f, 3.0f, 4.0f};
+
+PackedWeightsCache::PackFunction CountingCopy(int* num_packs) {
+  return [num_packs](void* packed_data) {
+    ++*num_packs;
+    std::memcpy(packed_data, kWeights, sizeof(kWeights));
+  };
+}
+
+TEST(PackedWeightsCacheTest, PacksOncePerKey) {
+  PackedWeightsCache cache;
+  int num_packs = 0;
+  std::shared_ptr<const void> first =
+      cache.GetOrPack(kWeights, sizeof(kWeights), "copy", sizeof(kWeights),
+                      CountingCopy(&num_packs));
+  std::shared_ptr<const void> second =
+      cache.GetOrPack(kWeights, sizeof(kWeights), "copy", sizeof(kWeights),
+                      CountingCopy(&num_packs));
+  EXPECT_EQ(num_packs, 1);
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(static_cast<const float*>(first.get())[3], 4.0f);
+  EXPECT_EQ(cache.num_entries(), 1);
+}
+
+TEST(PackedWeightsCacheTest, PacksEachKindSeparately) {
+  PackedWeightsCache cache;
+  int num_packs = 0;
+  std::shared_ptr<const void> copy =
+      cache.GetOrPack(kWeights, sizeof(kWeights), "copy", sizeof(kWeights),
+                      CountingCopy(&num_packs));
+  std::shared_ptr<const void> other =
+      cache.GetOrPack(kWeights, sizeof(kWeights), "other", sizeof(kWeights),
+                      CountingCopy(&num_packs));
+  EXPECT_EQ(num_packs, 2);
+  EXPECT_NE(copy.get(), other.get());
+  EXPECT_EQ(cache.num_entries(), 2);
+}
+
+TEST(PackedWeightsCacheTest, ReleasesUnusedWeights) {
+  PackedWeightsCache cache;
+  int num_packs = 0;
+  cache.GetOrPack(kWeights, sizeof(kWeights), "copy", sizeof(kWeights),
+                  CountingCopy(&num_packs));
+  EXPECT_EQ(cache.num_entries(), 0);
+  cache.GetOrPack(kWeights, sizeof(kWeights), "copy", sizeof(kWeights),
+                  CountingCopy(&num_packs));
+  EXPECT_EQ(num_packs, 2);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -61,6 +61,13 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the execution plan indices of the first and the last node of the
+  // stage of the node at execution plan index `index`. The nodes of a stage
+  // may run concurrently, so all the tensors they use must be live during
+  // the whole stage. By default, every node is a stage of its own.
+  virtual size_t stage_begin(size_t index) const { return index; }
+  virtual size_t stage_end(size_t index) const { return index; }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
@@ -0,0 +1,97 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/inter_op_thread_pool.h"
+
+namespace tflite {
+namespace {
+
+thread_local int current_thread_index = 0;
+
+}  // namespace
+
+InterOpThreadPool::InterOpThreadPool(int num_threads) {
+  for (int i = 1; i < num_threads; ++i) {
+    workers_.emplace_back(&InterOpThreadPool::WorkerLoop, this, i);
+  }
+}
+
+InterOpThreadPool::~InterOpThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void InterOpThreadPool::Run(int num_tasks,
+                            const std::function<void(int)>& task) {
+  if (workers_.empty() || num_tasks <= 1) {
+    for (int i = 0; i < num_tasks; ++i) {
+      task(i);
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_ = 0;
+    num_unfinished_tasks_ = num_tasks;
+  }
+  work_available_.notify_all();
+  RunTasks();
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this] { return num_unfinished_tasks_ == 0; });
+  task_ = nullptr;
+}
+
+int InterOpThreadPool::CurrentThreadIndex() { return current_thread_index; }
+
+void InterOpThreadPool::RunTasks() {
+  while (true) {
+    int index;
+    const std::function<void(int)>* task;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (task_ == nullptr || next_task_ == num_tasks_) return;
+      index = next_task_++;
+      task = task_;
+    }
+    (*task)(index);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--num_unfinished_tasks_ == 0) {
+      work_done_.notify_all();
+    }
+  }
+}
+
+void InterOpThreadPool::WorkerLoop(int thread_index) {
+  current_thread_index = thread_index;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [this] {
+        return stop_ || (task_ != nullptr && next_task_ < num_tasks_);
+      });
+      if (stop_) return;
+    }
+    RunTasks();
+  }
+}
+
+}  // namespace tflite
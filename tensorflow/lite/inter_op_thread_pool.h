@@ -0,0 +1,69 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
+#define TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <functional>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+
+// A small pool of threads on which the interpreter runs independent nodes of a
+// subgraph concurrently. The thread that calls Run() takes part in the work,
+// so a pool of `num_threads` threads starts `num_threads - 1` threads.
+class InterOpThreadPool {
+ public:
+  explicit InterOpThreadPool(int num_threads);
+  ~InterOpThreadPool();
+
+  int num_threads() const { return workers_.size() + 1; }
+
+  // Runs task(0), ..., task(num_tasks - 1) on the threads of the pool and
+  // returns once they are all done. Must not be called concurrently, nor from
+  // one of the tasks.
+  void Run(int num_tasks, const std::function<void(int)>& task);
+
+  // Returns the index, in [1, num_threads()), of the pool thread that runs the
+  // caller, or 0 if the caller doesn't run on a thread started by a pool.
+  static int CurrentThreadIndex();
+
+ private:
+  // Runs the tasks of the current Run() call until none is left to start.
+  void RunTasks();
+
+  void WorkerLoop(int thread_index);
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  // The tasks of the current Run() call, or nullptr between calls.
+  const std::function<void(int)>* task_ = nullptr;
+  int num_tasks_ = 0;
+  int next_task_ = 0;
+  int num_unfinished_tasks_ = 0;
+  bool stop_ = false;
+
+  std::vector<std::thread> workers_;
+
+  InterOpThreadPool(const InterOpThreadPool&) = delete;
+  InterOpThreadPool& operator=(const InterOpThreadPool&) = delete;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
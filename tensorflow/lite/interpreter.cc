@@ -114,6 +114,9 @@ Interpreter::Interpreter(ErrorReporter* error_reporter)
 }
 
 Interpreter::~Interpreter() {
+  // Let the pending asynchronous invocations finish.
+  async_invoke_queue_.reset();
+
   // The owned external Cpu Backend Context will go out of scope with this
   // interpreter. If we have an external backend context that is not
   // owned, we need to clear the cache for other interpreters that may
@@ -239,6 +242,7 @@ void Interpreter::AddSubgraphs(int subgraphs_to_add,
     Subgraph* subgraph =
         new Subgraph(error_reporter_, external_contexts_, &subgraphs_,
                      &resources_, &resource_ids_, &initialization_status_map_);
+    subgraph->SetInterOpThreadPool(inter_op_thread_pool_.get());
     subgraphs_.emplace_back(subgraph);
   }
 }
@@ -285,6 +289,44 @@ TfLiteStatus Interpreter::Invoke() {
   return kTfLiteOk;
 }
 
+TfLiteStatus Interpreter::InvokeAsync(
+    std::vector<std::pair<int, TfLiteCustomAllocation>> tensor_allocations,
+    std::function<void(TfLiteStatus)> done, int64_t flags) {
+  if (!async_invoke_queue_) {
+    async_invoke_queue_.reset(new AsyncInvokeQueue());
+  }
+  async_invoke_queue_->Enqueue([this, tensor_allocations, done, flags]() {
+    for (const auto& tensor_and_allocation : tensor_allocations) {
+      const int tensor_index = tensor_and_allocation.first;
+      const TfLiteCustomAllocation& allocation = tensor_and_allocation.second;
+      if (tensor_index < 0 || tensor_index >= tensors_size() ||
+          tensor(tensor_index)->allocation_type != kTfLiteCustom ||
+          allocation.bytes < tensor(tensor_index)->bytes) {
+        context_->ReportError(
+            context_,
+            "Tensor %d needs a custom allocation before the tensors are "
+            "allocated, and a buffer large enough for InvokeAsync().",
+            tensor_index);
+        done(kTfLiteError);
+        return;
+      }
+      if (SetCustomAllocationForTensor(tensor_index, allocation, flags) !=
+          kTfLiteOk) {
+        done(kTfLiteError);
+        return;
+      }
+    }
+    done(Invoke());
+  });
+  return kTfLiteOk;
+}
+
+void Interpreter::WaitForAsyncInvokes() {
+  if (async_invoke_queue_) {
+    async_invoke_queue_->Wait();
+  }
+}
+
 TfLiteStatus Interpreter::AddTensors(int tensors_to_add,
                                      int* first_new_tensor_index) {
   return primary_subgraph().AddTensors(tensors_to_add, first_new_tensor_index);
@@ -332,6 +374,28 @@ TfLiteStatus Interpreter::SetExecutionPlan(const std::vector<int>& new_plan) {
   return primary_subgraph().SetExecutionPlan(new_plan);
 }
 
+void Interpreter::SetPackedWeightsCache(
+    std::shared_ptr<PackedWeightsCache> cache) {
+  auto* external_context = static_cast<ExternalCpuBackendContext*>(
+      external_contexts_[kTfLiteCpuBackendContext]);
+  if (external_context) {
+    external_context->set_packed_weights_cache(std::move(cache));
+  }
+}
+
+TfLiteStatus Interpreter::SetNumInterOpThreads(int num_threads) {
+  if (num_threads < 1) {
+    context_->ReportError(context_, "num_threads should be >= 1.");
+    return kTfLiteError;
+  }
+  inter_op_thread_pool_.reset(
+      num_threads > 1 ? new InterOpThreadPool(num_threads) : nullptr);
+  for (auto& subgraph : subgraphs_) {
+    subgraph->SetInterOpThreadPool(inter_op_thread_pool_.get());
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Interpreter::SetNumThreads(int num_threads) {
   if (num_threads < -1) {
     context_->ReportError(context_,
@@ -32,6 +32,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/async_invoke_queue.h"
 #include "tensorflow/lite/c/common.h"  // IWYU pragma: export
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/profiler.h"
@@ -39,6 +40,7 @@ limitations under the License.
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/inter_op_thread_pool.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/portable_type_to_tflitetype.h"
 #include "tensorflow/lite/stderr_reporter.h"
@@ -453,6 +455,33 @@ class Interpreter {
   /// Returns status of success or failure.
   TfLiteStatus Invoke();
 
+  /// Invokes the interpreter on a thread of its own and returns without
+  /// waiting; `done` is called on that thread with the status of the
+  /// invocation once the outputs are readable.
+  ///
+  /// Before the invocation starts, each tensor of `tensor_allocations` is set
+  /// to its buffer as with SetCustomAllocationForTensor(). The tensors must
+  /// have a custom allocation already when the tensors are allocated, and the
+  /// new buffers must be large enough, so that no AllocateTensors() is needed
+  /// in between. This lets the caller double-buffer the inputs and outputs:
+  /// while one invocation runs with a set of buffers, the caller fills the
+  /// inputs of the next invocation in another set.
+  ///
+  /// Invocations run one at a time, in the order of the calls. Until they are
+  /// done, the interpreter must only be used through InvokeAsync() and
+  /// WaitForAsyncInvokes(). Delegates that bind the buffers of the tensors when
+  /// the tensors are allocated keep using the buffers they bound.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus InvokeAsync(
+      std::vector<std::pair<int, TfLiteCustomAllocation>> tensor_allocations,
+      std::function<void(TfLiteStatus)> done,
+      int64_t flags = kTfLiteCustomAllocationFlagsNone);
+
+  /// Waits until the invocations started by InvokeAsync() are done. Must not be
+  /// called from their `done` callbacks.
+  /// WARNING: This is an experimental API and subject to change.
+  void WaitForAsyncInvokes();
+
   /// Set the number of threads available to the interpreter.
   ///
   /// NOTE: num_threads should be >= -1. Setting num_threads to 0 has the effect
@@ -461,6 +490,25 @@ class Interpreter {
   /// implementation-defined and platform-dependent.
   TfLiteStatus SetNumThreads(int num_threads);
 
+  /// Lets the kernels share the weights they repack from constant tensors,
+  /// e.g. transposed convolution filters, with the other interpreters built
+  /// from the same FlatBufferModel that use `cache`. Must be called before
+  /// AllocateTensors(), and again after replacing the kTfLiteCpuBackendContext
+  /// external context.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetPackedWeightsCache(std::shared_ptr<PackedWeightsCache> cache);
+
+  /// Runs up to `num_threads` nodes that don't depend on each other at the
+  /// same time, e.g. the branches of a multi-head model. The default, 1, runs
+  /// the nodes one at a time. Delegated, custom, control flow and stateful
+  /// nodes always run alone, and so do all the nodes of subgraphs with dynamic
+  /// tensors. Each thread runs the kernels with a CPU backend context of its
+  /// own, which uses up to SetNumThreads() threads. The tensors of the nodes
+  /// that run together can't share memory, so the arena may grow. Must be
+  /// followed by AllocateTensors().
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetNumInterOpThreads(int num_threads);
+
   /// Allow float16 precision for FP32 calculation when possible.
   /// Default: not allow.
   ///
@@ -638,6 +686,26 @@ class Interpreter {
       int tensor_index, const TfLiteCustomAllocation& allocation,
       int64_t flags = kTfLiteCustomAllocationFlagsNone);
 
+  // Binds the output tensor `output_index` to the input tensor `input_index`
+  // for running a stateful model step by step, such as an RNN on a stream of
+  // audio frames, without copying its state between steps: each Invoke() takes
+  // as input the state that the previous Invoke() produced. No copy is made;
+  // the tensors alternate between two buffers owned by the interpreter, which
+  // are swapped at the start of the next Invoke(). Delegates must therefore
+  // read the tensors from their data pointers at every invocation.
+  //
+  // The tensors must have the same type and size. AllocateTensors() must be
+  // called after this; it zeroes the state, as does ResetStateTensors(). Any
+  // other initial state may be written to the input tensor after either.
+  //
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus SetStateTensorBinding(int input_index, int output_index);
+
+  // Zeroes the state of the tensors bound with SetStateTensorBinding(), e.g.
+  // to start a new stream.
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus ResetStateTensors();
+
 #ifndef DOXYGEN_SKIP
   /// Adds `subgraphs_to_add` subgraphs, preserving pre-existing Subgraph
   /// entries. The value pointed to by `first_new_subgraph_index` will be set to
@@ -790,6 +858,14 @@ class Interpreter {
   // nullptr if necessary.
   std::unique_ptr<ExternalCpuBackendContext> own_external_cpu_backend_context_;
 
+  // The threads that run independent nodes concurrently, see
+  // SetNumInterOpThreads().
+  std::unique_ptr<InterOpThreadPool> inter_op_thread_pool_;
+
+  // The thread that runs the invocations of InvokeAsync(), created by its first
+  // call.
+  std::unique_ptr<AsyncInvokeQueue> async_invoke_queue_;
+
   // Subgraphs
   std::vector<std::unique_ptr<Subgraph>> subgraphs_;
 
@@ -73,6 +73,15 @@ namespace tflite {
 
 namespace {
 
+// The name of the model metadata holding arena offsets planned offline, in the
+// format of TFLite Micro: the version of the format, the index of the subgraph,
+// the number of offsets, then the offset of each tensor of the subgraph, or -1
+// for the tensors left to the runtime planner.
+constexpr char kOfflineMemoryAllocationMetadataName[] =
+    "OfflineMemoryAllocation";
+constexpr int32_t kOfflineMemoryAllocationVersion = 1;
+constexpr int kOfflineMemoryAllocationHeaderSize = 3;
+
 // Ensure that ErrorReporter is non-null.
 ErrorReporter* ValidateErrorReporter(ErrorReporter* e) {
   return e ? e : DefaultErrorReporter();
@@ -544,6 +553,60 @@ TfLiteStatus InterpreterBuilder::ParseSignatureDefs(
   return kTfLiteOk;
 }
 
+TfLiteStatus InterpreterBuilder::ParseOfflineMemoryAllocation(
+    Interpreter* interpreter) {
+  const auto* metadata_list = model_->metadata();
+  if (metadata_list == nullptr) {
+    return kTfLiteOk;
+  }
+  const auto* buffers = model_->buffers();
+  for (const auto* metadata : *metadata_list) {
+    if (metadata == nullptr || metadata->name() == nullptr ||
+        metadata->name()->str() != kOfflineMemoryAllocationMetadataName) {
+      continue;
+    }
+    const Buffer* buffer = metadata->buffer() < buffers->size()
+                               ? (*buffers)[metadata->buffer()]
+                               : nullptr;
+    if (buffer == nullptr || buffer->data() == nullptr ||
+        buffer->data()->size() % sizeof(int32_t) != 0 ||
+        buffer->data()->size() <
+            kOfflineMemoryAllocationHeaderSize * sizeof(int32_t)) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Invalid offline memory allocation metadata.");
+      return kTfLiteError;
+    }
+    // The buffer isn't necessarily aligned for int32_t.
+    std::vector<int32_t> words(buffer->data()->size() / sizeof(int32_t));
+    memcpy(words.data(), buffer->data()->data(), buffer->data()->size());
+    const int32_t version = words[0];
+    const int32_t subgraph_index = words[1];
+    const int32_t num_offsets = words[2];
+    if (version != kOfflineMemoryAllocationVersion) {
+      TF_LITE_REPORT_ERROR(
+          error_reporter_,
+          "Unsupported version %d of offline memory allocation metadata.",
+          version);
+      return kTfLiteError;
+    }
+    if (subgraph_index < 0 ||
+        subgraph_index >= static_cast<int>(interpreter->subgraphs_size()) ||
+        num_offsets != static_cast<int>(words.size()) -
+                           kOfflineMemoryAllocationHeaderSize ||
+        num_offsets != interpreter->subgraph(subgraph_index)->tensors_size()) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Offline memory allocation metadata doesn't match "
+                           "the tensors of subgraph %d.",
+                           subgraph_index);
+      return kTfLiteError;
+    }
+    interpreter->subgraph(subgraph_index)
+        ->SetOfflinePlannedOffsets(std::vector<int32_t>(
+            words.begin() + kOfflineMemoryAllocationHeaderSize, words.end()));
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus InterpreterBuilder::ParseTensors(
     const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
     const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
@@ -802,6 +865,10 @@ TfLiteStatus InterpreterBuilder::operator()(
     return cleanup_and_error();
   }
 
+  if (ParseOfflineMemoryAllocation(interpreter->get()) != kTfLiteOk) {
+    return cleanup_and_error();
+  }
+
   if (num_fp32_tensors_ > 0) {
     (*interpreter)->lazy_delegate_providers_ =
         op_resolver_.GetDelegates(num_threads_);
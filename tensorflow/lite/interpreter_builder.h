@@ -118,6 +118,7 @@ class InterpreterBuilder {
       const flatbuffers::Vector<flatbuffers::Offset<SignatureDef>>*
           signature_def_list,
       Interpreter* interpreter);
+  TfLiteStatus ParseOfflineMemoryAllocation(Interpreter* interpreter);
 
   const ::tflite::Model* model_;
   const OpResolver& op_resolver_;
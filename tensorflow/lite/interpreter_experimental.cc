@@ -42,6 +42,15 @@ TfLiteStatus Interpreter::SetCustomAllocationForTensor(
                                                          allocation, flags);
 }
 
+TfLiteStatus Interpreter::SetStateTensorBinding(int input_index,
+                                               int output_index) {
+  return primary_subgraph().SetStateTensorBinding(input_index, output_index);
+}
+
+TfLiteStatus Interpreter::ResetStateTensors() {
+  return primary_subgraph().ResetStateTensors();
+}
+
 TfLiteStatus Interpreter::ReleaseNonPersistentMemory() {
   // TODO(b/138790287): We could do this for all subgraphs whose tensors have
   // been allocated. However, AllocateTensors() relies on Control Flow ops to
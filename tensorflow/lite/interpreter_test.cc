@@ -20,10 +20,13 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
 #include <map>
 #include <memory>
 #include <new>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
@@ -52,6 +55,7 @@ TfLiteRegistration* Register_NEG();
 
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::IsEmpty;
 
 // Make an interpreter that has no tensors and no nodes
@@ -737,6 +741,124 @@ TEST(BasicInterpreter, ReleaseNonPersistentMemory) {
 // Forcefully divides tensor allocation in three steps: one before invocation
 // and two more at invocation time. This happens because we use string tensors
 // and their sizes can't be determined until invocation time.
+// The number of nodes that have started a rendezvous, and the number of those
+// that met another node.
+std::atomic<int> rendezvous_started_nodes;
+std::atomic<int> rendezvous_met_nodes;
+
+// Simple op that outputs the sum of its float inputs plus one. If
+// `rendezvous` is true, the node waits, for up to ten seconds, for a second
+// node to start a rendezvous.
+TfLiteRegistration GetAddOneOpRegistration(bool rendezvous) {
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &input));
+    TfLiteTensor* output;
+    TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* output;
+    TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+    output->data.f[0] = 1;
+    for (int i = 0; i < NumInputs(node); ++i) {
+      const TfLiteTensor* input;
+      TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, i, &input));
+      output->data.f[0] += input->data.f[0];
+    }
+    return kTfLiteOk;
+  };
+  if (rendezvous) {
+    reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+      ++rendezvous_started_nodes;
+      const auto deadline =
+          std::chrono::steady_clock::now() + std::chrono::seconds(10);
+      while (rendezvous_started_nodes < 2 &&
+             std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+      }
+      if (rendezvous_started_nodes >= 2) {
+        ++rendezvous_met_nodes;
+      }
+      return GetAddOneOpRegistration(/*rendezvous=*/false)
+          .invoke(context, node);
+    };
+  }
+  return reg;
+}
+
+TEST(BasicInterpreter, RunsIndependentNodesConcurrently) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(4), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({3}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {1}, quantized),
+              kTfLiteOk);
+  }
+  TfLiteRegistration rendezvous_reg =
+      GetAddOneOpRegistration(/*rendezvous=*/true);
+  TfLiteRegistration add_one_reg =
+      GetAddOneOpRegistration(/*rendezvous=*/false);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &rendezvous_reg),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {2}, nullptr, 0, nullptr,
+                                              &rendezvous_reg),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({1, 2}, {3}, nullptr, 0, nullptr,
+                                              &add_one_reg),
+            kTfLiteOk);
+
+  ASSERT_EQ(interpreter.SetNumInterOpThreads(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  // The tensors of the two nodes that run concurrently can't share memory.
+  EXPECT_NE(interpreter.tensor(1)->data.raw, interpreter.tensor(2)->data.raw);
+  interpreter.typed_input_tensor<float>(0)[0] = 1;
+  rendezvous_started_nodes = 0;
+  rendezvous_met_nodes = 0;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(rendezvous_met_nodes, 2);
+  EXPECT_EQ(interpreter.typed_output_tensor<float>(0)[0], 5);
+}
+
+TEST(BasicInterpreter, ReordersExecutionPlanIntoStages) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(4), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2, 3}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {1}, quantized),
+              kTfLiteOk);
+  }
+  TfLiteRegistration reg = GetAddOneOpRegistration(/*rendezvous=*/false);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {3}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+
+  ASSERT_EQ(interpreter.SetNumInterOpThreads(0), kTfLiteError);
+  ASSERT_EQ(interpreter.SetNumInterOpThreads(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  // The first and the third node don't depend on each other.
+  EXPECT_EQ(interpreter.execution_plan(), std::vector<int>({0, 2, 1}));
+  interpreter.typed_input_tensor<float>(0)[0] = 1;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(interpreter.typed_output_tensor<float>(0)[0], 3);
+  EXPECT_EQ(interpreter.typed_output_tensor<float>(1)[0], 2);
+}
+
 TEST(BasicInterpreter, ThreeStepAllocate) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(5), kTfLiteOk);
@@ -1839,6 +1961,119 @@ TEST_F(TestCustomAllocation, ResizeAndAllocateForEveryInvoke) {
   EXPECT_EQ(tensor->data.f[0], expected_output[0]);
 }
 
+TEST_F(TestCustomAllocation, InvokeAsyncSwapsBuffers) {
+  AssignCustomAllocForTensor(interpreter_->inputs()[0],
+                             /*required_alignment=*/kDefaultTensorAlignment);
+  AssignCustomAllocForTensor(interpreter_->inputs()[1],
+                             /*required_alignment=*/kDefaultTensorAlignment);
+  AssignCustomAllocForTensor(interpreter_->outputs()[0],
+                             /*required_alignment=*/kDefaultTensorAlignment);
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+
+  // Two sets of buffers for the inputs and the first output, each with
+  // different inputs.
+  std::vector<std::pair<int, TfLiteCustomAllocation>> buffers[2];
+  for (int set = 0; set < 2; ++set) {
+    for (int tensor_index : {interpreter_->inputs()[0],
+                             interpreter_->inputs()[1],
+                             interpreter_->outputs()[0]}) {
+      buffers[set].emplace_back(
+          tensor_index,
+          NewCustomAlloc(3 * sizeof(float), kDefaultTensorAlignment));
+    }
+    for (int input = 0; input < 2; ++input) {
+      float* data = static_cast<float*>(buffers[set][input].second.data);
+      for (int i = 0; i < 3; ++i) {
+        data[i] = (set + 1) * (i + 1);
+      }
+    }
+  }
+
+  std::vector<TfLiteStatus> statuses;
+  for (int set = 0; set < 2; ++set) {
+    ASSERT_EQ(interpreter_->InvokeAsync(
+                  buffers[set],
+                  [&statuses](TfLiteStatus status) {
+                    statuses.push_back(status);
+                  }),
+              kTfLiteOk);
+  }
+  interpreter_->WaitForAsyncInvokes();
+  EXPECT_THAT(statuses, ElementsAre(kTfLiteOk, kTfLiteOk));
+  for (int set = 0; set < 2; ++set) {
+    const float* output = static_cast<float*>(buffers[set][2].second.data);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(output[i], 2.0f * (set + 1) * (i + 1)) << set << " " << i;
+    }
+  }
+}
+
+TEST_F(TestCustomAllocation, InvokeAsyncNeedsCustomAllocations) {
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+
+  TfLiteStatus invoke_status = kTfLiteOk;
+  ASSERT_EQ(interpreter_->InvokeAsync(
+                {{interpreter_->outputs()[0],
+                  NewCustomAlloc(3 * sizeof(float), kDefaultTensorAlignment)}},
+                [&invoke_status](TfLiteStatus status) {
+                  invoke_status = status;
+                }),
+            kTfLiteOk);
+  interpreter_->WaitForAsyncInvokes();
+  EXPECT_EQ(invoke_status, kTfLiteError);
+}
+
+TEST_F(TestCustomAllocation, StateTensorBinding) {
+  // Output 3 is the input 1 doubled, and becomes the next input 1.
+  const int state_input = interpreter_->inputs()[1];
+  const int state_output = interpreter_->outputs()[0];
+  ASSERT_EQ(interpreter_->SetStateTensorBinding(state_input, state_output),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(interpreter_->typed_tensor<float>(state_input)[i], 0.0f);
+    interpreter_->typed_tensor<float>(state_input)[i] = 1.0f;
+    interpreter_->typed_tensor<float>(0)[i] = 1.0f;
+  }
+  float* first_input_buffer = interpreter_->typed_tensor<float>(state_input);
+  float* first_output_buffer = interpreter_->typed_tensor<float>(state_output);
+  const int other_output = interpreter_->outputs()[1];
+
+  float expected_state = 1.0f;
+  for (int step = 0; step < 3; ++step) {
+    ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+    expected_state *= 2;
+    // The buffers alternate instead of being copied.
+    EXPECT_EQ(interpreter_->typed_tensor<float>(state_output),
+              step % 2 == 0 ? first_output_buffer : first_input_buffer);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(interpreter_->typed_tensor<float>(state_output)[i],
+                expected_state);
+      // The output that doesn't feed back reads the state of this step.
+      EXPECT_EQ(interpreter_->typed_tensor<float>(other_output)[i],
+                2.0f + expected_state / 2);
+    }
+  }
+
+  ASSERT_EQ(interpreter_->ResetStateTensors(), kTfLiteOk);
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(interpreter_->typed_tensor<float>(state_output)[i], 0.0f);
+  }
+}
+
+TEST_F(TestCustomAllocation, StateTensorBindingNeedsInputAndOutput) {
+  EXPECT_EQ(interpreter_->SetStateTensorBinding(interpreter_->outputs()[0],
+                                                interpreter_->inputs()[0]),
+            kTfLiteError);
+  EXPECT_EQ(interpreter_->SetStateTensorBinding(interpreter_->inputs()[0],
+                                                interpreter_->outputs()[0]),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter_->SetStateTensorBinding(interpreter_->inputs()[1],
+                                                interpreter_->outputs()[0]),
+            kTfLiteError);
+}
+
 // Tests related to lazy delegate providers that are primarily used for applying
 // TfLite delegates by default.
 class TestLazyDelegateProvider : public InterpreterTest {
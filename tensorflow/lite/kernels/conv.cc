@@ -17,6 +17,7 @@ limitations under the License.
 #include <stddef.h>
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 // Only use multi-threaded Eigen if ruy is disabled.
@@ -108,6 +109,10 @@ struct OpData {
 
   bool need_hwcn_weights = false;
   bool have_weights_been_transposed = false;
+  // The HWCN weights come from the interpreter's PackedWeightsCache instead of
+  // a temporary tensor.
+  bool share_hwcn_weights = false;
+  std::shared_ptr<const void> shared_hwcn_weights;
   bool need_im2col = false;
   // If it's true, it means im2col is needed but gets disabled because the
   // temporary im2col tensor requires too much memory (i.e.
@@ -152,11 +157,10 @@ void Free(TfLiteContext* context, void* buffer) {
 // Naive implementation of transpose for floats. Could be optimized to be more
 // cache friendly, but for now it's a one-time cost on first run, and we would
 // prefer to remove the need to do this at all eventually.
-void TransposeFloatTensor(const TfLiteTensor* input, TfLiteTensor* output) {
-  const int rows = output->dims->data[1];
-  const int cols = output->dims->data[0];
+// Transposes the filter, seen as a [rows, cols] matrix, into `output_data`.
+void TransposeFloatTensor(const TfLiteTensor* input, int rows, int cols,
+                          float* output_data) {
   const float* input_data = GetTensorData<float>(input);
-  float* output_data = GetTensorData<float>(output);
   for (int i = 0; i < rows; ++i) {
     for (int j = 0; j < cols; ++j) {
       const float in_value = input_data[i * cols + j];
@@ -243,6 +247,9 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(
   // we're running with that data type.
   data->need_hwcn_weights =
       input->type == kTfLiteFloat32 && data->supports_multithreaded_kernel;
+  data->share_hwcn_weights =
+      data->need_hwcn_weights && IsConstantTensor(filter) &&
+      CpuBackendContext::GetPackedWeightsCache(context) != nullptr;
 
   // We don't always need to allocate im2col. It is only used in some versions
   // of the optimized Conv. This test just mimics something that happens inside
@@ -270,7 +277,7 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(
     }
     ++temporaries_count;
   }
-  if (data->need_hwcn_weights) {
+  if (data->need_hwcn_weights && !data->share_hwcn_weights) {
     data->hwcn_weights_index = temporaries_count;
     if (data->hwcn_weights_id == kTensorNotAllocated) {
       context->AddTensors(context, 1, &data->hwcn_weights_id);
@@ -496,7 +503,7 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     if (im2col_status != kTfLiteOk) return im2col_status;
   }
 
-  if (data->need_hwcn_weights) {
+  if (data->need_hwcn_weights && !data->share_hwcn_weights) {
     node->temporaries->data[data->hwcn_weights_index] = data->hwcn_weights_id;
     TfLiteIntArray* hwcn_weights_size = TfLiteIntArrayCreate(2);
 
@@ -857,7 +864,10 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
     case kMultithreadOptimized: {
 #if defined(TFLITE_WITH_MULTITHREADED_EIGEN)
       const float* filter_data;
-      if (data->need_hwcn_weights) {
+      if (data->share_hwcn_weights) {
+        filter_data =
+            static_cast<const float*>(data->shared_hwcn_weights.get());
+      } else if (data->need_hwcn_weights) {
         filter_data = GetTensorData<float>(hwcn_weights);
       } else {
         filter_data = GetTensorData<float>(filter);
@@ -1075,12 +1085,26 @@ TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
           ? &context->tensors[node->temporaries->data[data->im2col_index]]
           : nullptr;
   TfLiteTensor* hwcn_weights =
-      data->need_hwcn_weights
+      data->need_hwcn_weights && !data->share_hwcn_weights
           ? &context->tensors[node->temporaries->data[data->hwcn_weights_index]]
           : nullptr;
 
   if (data->need_hwcn_weights && !data->have_weights_been_transposed) {
-    TransposeFloatTensor(filter, hwcn_weights);
+    // The filter is [channels_out, filter_height, filter_width, input_depth].
+    const int rows = filter->dims->data[0];
+    const int cols = NumElements(filter) / rows;
+    if (data->share_hwcn_weights) {
+      data->shared_hwcn_weights =
+          CpuBackendContext::GetPackedWeightsCache(context)->GetOrPack(
+              filter->data.raw, filter->bytes, "conv_hwcn_weights",
+              filter->bytes, [filter, rows, cols](void* packed_data) {
+                TransposeFloatTensor(filter, rows, cols,
+                                     static_cast<float*>(packed_data));
+              });
+    } else {
+      TransposeFloatTensor(filter, rows, cols,
+                           GetTensorData<float>(hwcn_weights));
+    }
     data->have_weights_been_transposed = true;
   }
 
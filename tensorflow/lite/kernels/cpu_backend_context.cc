@@ -123,6 +123,14 @@ CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
   return cpu_backend_context;
 }
 
+PackedWeightsCache* CpuBackendContext::GetPackedWeightsCache(
+    TfLiteContext* context) {
+  auto* external_context = static_cast<ExternalCpuBackendContext*>(
+      context->GetExternalContext(context, kTfLiteCpuBackendContext));
+  return external_context ? external_context->packed_weights_cache()
+                          : nullptr;
+}
+
 CpuBackendContext::CpuBackendContext()
     : TfLiteInternalBackendContext(),
       ruy_context_(new ruy::Context),
@@ -34,6 +34,10 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
  public:
   static CpuBackendContext* GetFromContext(TfLiteContext* context);
 
+  // Returns the cache of packed weights that the interpreter of `context`
+  // shares with other interpreters, or nullptr if it doesn't share them.
+  static PackedWeightsCache* GetPackedWeightsCache(TfLiteContext* context);
+
   CpuBackendContext();
   ~CpuBackendContext() override;
 
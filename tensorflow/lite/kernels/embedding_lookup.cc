@@ -31,9 +31,9 @@ limitations under the License.
 
 #include <stdint.h>
 
-#include <cstring>
-
 #include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/internal/optimized/gather.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 
@@ -67,6 +67,21 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   return context->ResizeTensor(context, output, outputSize);
 }
 
+TfLiteStatus CheckLookups(TfLiteContext* context, const int32_t* lookup_data,
+                          int num_lookups, int row_size) {
+  for (int i = 0; i < num_lookups; i++) {
+    const int idx = lookup_data[i];
+    if (idx >= row_size || idx < 0) {
+      context->ReportError(context,
+                           "Embedding Lookup: index out of bounds. "
+                           "Got %d, and bounds are [0, %d]",
+                           idx, row_size - 1);
+      return kTfLiteError;
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus EvalSimple(TfLiteContext* context, TfLiteNode* node,
                         const TfLiteTensor* lookup, const TfLiteTensor* value,
                         TfLiteTensor* output) {
@@ -77,22 +92,13 @@ TfLiteStatus EvalSimple(TfLiteContext* context, TfLiteNode* node,
   }
   const int row_bytes = value->bytes / row_size;
 
-  char* output_raw = GetTensorData<char>(output);
-  const char* value_raw = GetTensorData<char>(value);
   const int32_t* lookup_data = GetTensorData<int32_t>(lookup);
-  for (int i = 0; i < SizeOfDimension(lookup, 0); i++) {
-    int idx = lookup_data[i];
-    if (idx >= row_size || idx < 0) {
-      context->ReportError(context,
-                           "Embedding Lookup: index out of bounds. "
-                           "Got %d, and bounds are [0, %d]",
-                           idx, row_size - 1);
-      return kTfLiteError;
-    } else {
-      std::memcpy(output_raw + i * row_bytes, value_raw + idx * row_bytes,
-                  row_bytes);
-    }
-  }
+  const int num_lookups = SizeOfDimension(lookup, 0);
+  TF_LITE_ENSURE_STATUS(
+      CheckLookups(context, lookup_data, num_lookups, row_size));
+  optimized_ops::GatherRows(GetTensorData<char>(value), lookup_data,
+                            num_lookups, row_bytes, GetTensorData<char>(output),
+                            CpuBackendContext::GetFromContext(context));
 
   return kTfLiteOk;
 }
@@ -101,7 +107,9 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
                         const TfLiteTensor* lookup, const TfLiteTensor* value,
                         TfLiteTensor* output) {
   const int row_size = SizeOfDimension(value, 0);
-  const double scaling_factor = value->params.scale;
+  // The product of an int8 and a float scale is exact in double, so
+  // multiplying in float rounds it identically and lets the loop vectorize.
+  const float scaling_factor = value->params.scale;
 
   // col_size after we flatten tensor into 2D.
   int col_size = 1;
@@ -113,22 +121,20 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
   const int8_t* value_ptr = GetTensorData<int8_t>(value);
   const int32_t* lookup_data = GetTensorData<int32_t>(lookup);
 
-  for (int i = 0; i < SizeOfDimension(lookup, 0); i++) {
-    int idx = lookup_data[i];
-    if (idx >= row_size || idx < 0) {
-      context->ReportError(context,
-                           "Embedding Lookup: index out of bounds. "
-                           "Got %d, and bounds are [0, %d]",
-                           idx, row_size - 1);
-      return kTfLiteError;
-    } else {
-      // Dequantize embedding values.
-      // TODO(alanchiao): refactor scalar multiply into separate function
-      // for ease of adding a neon equivalent if ever necessary.
-      for (int j = 0; j < col_size; j++) {
-        output_ptr[j + i * col_size] =
-            value_ptr[j + idx * col_size] * scaling_factor;
-      }
+  const int num_lookups = SizeOfDimension(lookup, 0);
+  TF_LITE_ENSURE_STATUS(
+      CheckLookups(context, lookup_data, num_lookups, row_size));
+  for (int i = 0; i < num_lookups; i++) {
+    const int ahead = i + optimized_ops::gather::kPrefetchDistance;
+    if (ahead < num_lookups) {
+      optimized_ops::gather::PrefetchRow(
+          value_ptr + lookup_data[ahead] * col_size, col_size);
+    }
+    // Dequantize embedding values.
+    const int8_t* row = value_ptr + lookup_data[i] * col_size;
+    float* output_row = output_ptr + i * col_size;
+    for (int j = 0; j < col_size; j++) {
+      output_row[j] = row[j] * scaling_factor;
     }
   }
 
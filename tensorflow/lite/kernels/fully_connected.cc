@@ -250,6 +250,22 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node) {
     TF_LITE_ENSURE_EQ(context, output->params.zero_point, 0);
   }
 
+  // Integer models with sparse weights run the int8 block sparse kernel, which
+  // relies on the weights that are not stored being zero.
+  if (filter->sparsity != nullptr && input->type != kTfLiteFloat32) {
+    TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteInt8);
+    TF_LITE_ENSURE_TYPES_EQ(context, filter->type, kTfLiteInt8);
+    TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteInt8);
+    TF_LITE_ENSURE_EQ(context, filter->params.zero_point, 0);
+    int block_rows, block_cols;
+    if (!optimized_ops::GetSparseWeightBlockSize(*filter->sparsity,
+                                                 &block_rows, &block_cols)) {
+      TF_LITE_KERNEL_LOG(context,
+                         "Unsupported sparse fully-connected weight format.");
+      return kTfLiteError;
+    }
+  }
+
   // If we have to perform on-the-fly quantization (with quantized weights and
   // float inputs) first we need to quantize the inputs. Allocate a temporary
   // buffer to store the intermediate quantized values.
@@ -698,7 +714,23 @@ void FullyConnectedInt8(const OpData* data, const TfLiteTensor* input,
   op_params.quantized_activation_max = data->output_activation_max;
   op_params.lhs_cacheable = IsConstantTensor(filter);
   op_params.rhs_cacheable = IsConstantTensor(input);
-  if (kernel_type == kReference) {
+  if (filter->sparsity != nullptr) {
+    if (kernel_type == kReference) {
+      reference_ops::FullyConnectedSparseWeight(
+          *filter->sparsity, op_params, GetTensorShape(input),
+          GetTensorData<int8_t>(input), GetTensorShape(filter),
+          GetTensorData<int8_t>(filter), GetTensorShape(bias),
+          GetTensorData<int32_t>(bias), GetTensorShape(output),
+          GetTensorData<int8_t>(output));
+    } else {
+      optimized_ops::FullyConnectedSparseWeightBlock(
+          *filter->sparsity, op_params, GetTensorShape(input),
+          GetTensorData<int8_t>(input), GetTensorShape(filter),
+          GetTensorData<int8_t>(filter), GetTensorShape(bias),
+          GetTensorData<int32_t>(bias), GetTensorShape(output),
+          GetTensorData<int8_t>(output), cpu_backend_context);
+    }
+  } else if (kernel_type == kReference) {
     reference_integer_ops::FullyConnected(
         op_params, GetTensorShape(input), GetTensorData<int8_t>(input),
         GetTensorShape(filter), GetTensorData<int8_t>(filter),
@@ -726,11 +758,19 @@ void FullyConnectedInt16(const OpData* data, const TfLiteTensor* input,
   op_params.output_shift = data->output_shift;
   op_params.quantized_activation_min = data->output_activation_min;
   op_params.quantized_activation_max = data->output_activation_max;
-  reference_integer_ops::FullyConnected(
-      op_params, GetTensorShape(input), GetTensorData<int16_t>(input),
-      GetTensorShape(filter), GetTensorData<int8_t>(filter),
-      GetTensorShape(bias), GetTensorData<int64_t>(bias),
-      GetTensorShape(output), GetTensorData<int16_t>(output));
+  if (kernel_type == kReference) {
+    reference_integer_ops::FullyConnected(
+        op_params, GetTensorShape(input), GetTensorData<int16_t>(input),
+        GetTensorShape(filter), GetTensorData<int8_t>(filter),
+        GetTensorShape(bias), GetTensorData<int64_t>(bias),
+        GetTensorShape(output), GetTensorData<int16_t>(output));
+  } else {
+    optimized_integer_ops::FullyConnected(
+        op_params, GetTensorShape(input), GetTensorData<int16_t>(input),
+        GetTensorShape(filter), GetTensorData<int8_t>(filter),
+        GetTensorShape(bias), GetTensorData<int64_t>(bias),
+        GetTensorShape(output), GetTensorData<int16_t>(output));
+  }
 }
 }  // namespace
 
@@ -919,6 +959,7 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
         return kTfLiteError;
       }
 
+      int block_rows, block_cols;
       if (sparsity.dim_metadata_size == kDimMetadataSizeRandomSparse) {
         // Random sparse.
         optimized_ops::FullyConnectedSparseWeight(
@@ -937,6 +978,16 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             GetTensorData<float>(bias), GetTensorShape(output),
             GetTensorData<float>(output),
             CpuBackendContext::GetFromContext(context));
+      } else if (optimized_ops::GetSparseWeightBlockSize(
+                     sparsity, &block_rows, &block_cols)) {
+        // Block sparse with any other block size.
+        optimized_ops::FullyConnectedSparseWeightBlock(
+            sparsity, op_params, GetTensorShape(input),
+            GetTensorData<float>(input), GetTensorShape(filter),
+            GetTensorData<float>(filter), GetTensorShape(bias),
+            GetTensorData<float>(bias), GetTensorShape(output),
+            GetTensorData<float>(output),
+            CpuBackendContext::GetFromContext(context));
       } else {
         TF_LITE_KERNEL_LOG(context,
                            "Unsupported sparse fully-connected weight format.");
@@ -606,6 +606,28 @@ TEST_P(QuantizedFullyConnectedOpTest, SimpleTestQuantizedInt16) {
               ElementsAre(12288, 12800, 13312, 29696, 30208, 30720));
 }
 
+TEST_P(QuantizedFullyConnectedOpTest, QuantizedInt16DeepAccumulation) {
+  // Deep enough for the optimized kernel to sum in several int32 runs.
+  const int depth = 300;
+  const float input_scale = 1.0 / 256;
+  const float output_scale = 128.0 / 32768;
+  QuantizedFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/2, /*batches*/ 1,
+      /*input=*/{TensorType_INT16, {1, depth}, 0, 0, input_scale, 0},
+      /*output=*/{TensorType_INT16, {}, 0, 0, output_scale, 0});
+
+  std::vector<float> weights(2 * depth, 1);
+  std::fill(weights.begin() + depth, weights.end(), -1);
+  m.SetWeights<int8_t>(weights);
+  m.SetBias64({0, 0});
+  m.SetInput<int16_t>(std::vector<float>(depth, 0.25));
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetDequantizedOutput<int16_t>(),
+              ElementsAreArray(ArrayFloatNear({75, -75}, output_scale)));
+}
+
 TEST_P(QuantizedFullyConnectedOpTest, SimpleTestQuantizedInt8NoBias) {
   QuantizedFullyConnectedOpModel m(
       GetRegistration(), /*units=*/3, /*batches*/ 2,
@@ -1618,6 +1640,155 @@ TEST_P(SparseFullyConnectedOpTest, SparseHybrid1x16TestMultiThreaded) {
                     1e-3)));
   }
 }
+
+// Runs weights made of `block_rows` x `block_cols` blocks, a third of which
+// are zero, through the sparse kernel and checks it against the dense kernel.
+void TestBlockSparseMatchesDense(TfLiteRegistration* registration,
+                                 int block_rows, int block_cols,
+                                 int num_threads) {
+  const int units = 64;
+  const int input_size = 32;
+  const int batches = 2;
+  std::vector<float> weight_data(units * input_size);
+  for (int o = 0; o < units; ++o) {
+    for (int i = 0; i < input_size; ++i) {
+      const bool zero_block = (o / block_rows + i / block_cols) % 3 == 0;
+      weight_data[o * input_size + i] =
+          zero_block ? 0.f : ((o * 7 + i * 3) % 11 - 5) * 0.1f;
+    }
+  }
+  std::vector<float> input_data(batches * input_size);
+  for (int i = 0; i < batches * input_size; ++i) {
+    input_data[i] = (i % 7 - 3) * 0.25f;
+  }
+  std::vector<float> bias_data(units);
+  for (int o = 0; o < units; ++o) {
+    bias_data[o] = (o % 5 - 2) * 0.5f;
+  }
+
+  FloatFullyConnectedOpModel dense(registration, units, batches,
+                                   {TensorType_FLOAT32, {batches, input_size}});
+  dense.SetWeights(weight_data);
+  dense.SetBias(bias_data);
+  dense.SetInput(input_data);
+  dense.Invoke();
+
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {units, input_size};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  if (block_rows == 1) {
+    weight.traversal_order = {0, 1, 2};
+    weight.block_map = {1};
+    weight.block_size = {block_cols};
+  } else {
+    weight.traversal_order = {0, 1, 2, 3};
+    weight.block_map = {0, 1};
+    weight.block_size = {block_rows, block_cols};
+  }
+  SparseFullyConnectedOpModel<float> sparse(
+      registration, units, batches, {TensorType_FLOAT32, {batches, input_size}},
+      weight, weight_data, /*bias_tensor_optional=*/false, num_threads);
+  sparse.SetBias(bias_data);
+  sparse.SetInput(input_data);
+  sparse.Invoke();
+
+  EXPECT_THAT(sparse.GetOutputShape(), ElementsAre(batches, units));
+  EXPECT_THAT(sparse.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(dense.GetOutput(), 1e-5)));
+}
+
+TEST_P(SparseFullyConnectedOpTest, Block1x8MatchesDense) {
+  for (int num_threads = 1; num_threads <= 4; num_threads++) {
+    TestBlockSparseMatchesDense(GetRegistration(), 1, 8, num_threads);
+  }
+}
+
+TEST_P(SparseFullyConnectedOpTest, Block4x4MatchesDense) {
+  for (int num_threads = 1; num_threads <= 4; num_threads++) {
+    TestBlockSparseMatchesDense(GetRegistration(), 4, 4, num_threads);
+  }
+}
+
+TEST_P(SparseFullyConnectedOpTest, Block8x1MatchesDense) {
+  for (int num_threads = 1; num_threads <= 4; num_threads++) {
+    TestBlockSparseMatchesDense(GetRegistration(), 8, 1, num_threads);
+  }
+}
+
+class SparseQuantizedFullyConnectedOpModel : public SingleOpModel {
+ public:
+  SparseQuantizedFullyConnectedOpModel(TfLiteRegistration* registration,
+                                       int units, const TensorData& input,
+                                       const TensorData& weights,
+                                       const std::vector<int8_t>& weights_data,
+                                       const TensorData& output) {
+    input_ = AddInput(input);
+    weights_ = AddConstSparseInput(weights, weights_data);
+    bias_ = AddInput({TensorType_INT32, {units}, 0, 0,
+                      GetScale(input_) * GetScale(weights_)});
+    output_ = AddOutput(output);
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)});
+  }
+  void SetBias(const std::vector<float>& data) {
+    QuantizeAndPopulate<int32_t>(bias_, data);
+  }
+  void SetInput(const std::vector<float>& data) {
+    QuantizeAndPopulate<int8_t>(input_, data);
+  }
+  std::vector<int8_t> GetOutput() { return ExtractVector<int8_t>(output_); }
+
+ private:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+};
+
+TEST_P(SparseFullyConnectedOpTest, SimpleInt8Block4x4Test) {
+  // The off-diagonal 4x4 blocks are zero.
+  std::vector<int8_t> weight_data = {
+      1,  2,  3,  4, 0,  0,  0, 0,  // u = 0
+      -1, 1,  -1, 1, 0,  0,  0, 0,  // u = 1
+      2,  0,  2,  0, 0,  0,  0, 0,  // u = 2
+      0,  -3, 0,  3, 0,  0,  0, 0,  // u = 3
+      0,  0,  0,  0, 1,  1,  1, 1,  // u = 4
+      0,  0,  0,  0, 4,  3,  2, 1,  // u = 5
+      0,  0,  0,  0, -2, -2, 2, 2,  // u = 6
+      0,  0,  0,  0, 0,  1,  2, 3,  // u = 7
+  };
+  TensorData weight = {};
+  weight.type = TensorType_INT8;
+  weight.shape = {8, 8};
+  weight.scale = 1.0f;
+  weight.traversal_order = {0, 1, 2, 3};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {0, 1};
+  weight.block_size = {4, 4};
+  SparseQuantizedFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/8,
+      /*input=*/{TensorType_INT8, {2, 8}, -63.5, 64}, weight, weight_data,
+      /*output=*/{TensorType_INT8, {}, -127, 128});
+  m.SetBias({1, 2, 3, 4, 5, 6, 7, 8});
+  m.SetInput({
+      1,  2,  3,  4,  5, 6, 7, 8,  // b = 0
+      -1, -2, -3, -4, 1, 2, 3, 4,  // b = 1
+  });
+
+  m.Invoke();
+
+  // The output scale is 1 and the zero point -1.
+  EXPECT_THAT(m.GetOutput(), ElementsAre(30, 3, 10, 9, 30, 65, 14, 51,  // b = 0
+                                         -1, -1, -1, -1, 14, 25, 14, 27));
+}
+
 // TODO(b/148391360): Add tests for unsupported sparsity format.
 // TEST_P(SparseFullyConnectedOpTest, TestUnsupportedSparsityFormat)
 
@@ -33,13 +33,15 @@ using ::testing::ElementsAreArray;
 class GatherOpModel : public SingleOpModel {
  public:
   GatherOpModel(const TensorData& input, const TensorData& positions,
-                int axis = 0, int batch_dims = 0) {
+                int axis = 0, int batch_dims = 0, int num_threads = -1) {
     input_ = AddInput(input);
     positions_ = AddInput(positions);
     output_ = AddOutput(input.type);
     SetBuiltinOp(BuiltinOperator_GATHER, BuiltinOptions_GatherOptions,
                  CreateGatherOptions(builder_, axis, batch_dims).Union());
-    BuildInterpreter({GetShape(input_), GetShape(positions_)});
+    BuildInterpreter({GetShape(input_), GetShape(positions_)}, num_threads,
+                     /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/true);
   }
 
   template <typename T>
@@ -47,6 +49,11 @@ class GatherOpModel : public SingleOpModel {
     PopulateTensor<T>(input_, data);
   }
 
+  template <typename T>
+  void SetInput(const std::vector<T>& data) {
+    PopulateTensor<T>(input_, data);
+  }
+
   void SetStringInput(std::initializer_list<string> data) {
     PopulateStringTensor(input_, data);
   }
@@ -56,6 +63,11 @@ class GatherOpModel : public SingleOpModel {
     PopulateTensor<T>(positions_, data);
   }
 
+  template <typename T>
+  void SetPositions(const std::vector<T>& data) {
+    PopulateTensor<T>(positions_, data);
+  }
+
   template <typename T>
   std::vector<T> GetOutput() {
     return ExtractVector<T>(output_);
@@ -408,5 +420,34 @@ TEST(TypesGatherOpTest, BatchDimsEqualIndiceDims) {
               ElementsAreArray({1, 5, 10, 16, 21, 25, 30, 36}));
 }
 
+// Gathers enough rows from a large table to be split across threads.
+TEST(GatherOpTest, LargeTableMultiThreaded) {
+  const int rows = 1000;
+  const int cols = 256;
+  const int num_positions = 300;
+  std::vector<float> input(rows * cols);
+  for (int i = 0; i < rows * cols; ++i) {
+    input[i] = i;
+  }
+  std::vector<int32_t> positions(num_positions);
+  std::vector<float> expected;
+  for (int i = 0; i < num_positions; ++i) {
+    positions[i] = (i * 7919) % rows;
+    expected.insert(expected.end(), input.begin() + positions[i] * cols,
+                    input.begin() + (positions[i] + 1) * cols);
+  }
+  for (int num_threads = 1; num_threads <= 4; ++num_threads) {
+    GatherOpModel m({TensorType_FLOAT32, {rows, cols}},
+                    {TensorType_INT32, {num_positions}}, /*axis=*/0,
+                    /*batch_dims=*/0, num_threads);
+    m.SetInput<float>(input);
+    m.SetPositions<int32_t>(positions);
+    m.Invoke();
+
+    ASSERT_THAT(m.GetOutputShape(), ElementsAreArray({num_positions, cols}));
+    EXPECT_THAT(m.GetOutput<float>(), ElementsAreArray(expected));
+  }
+}
+
 }  // namespace
 }  // namespace tflite
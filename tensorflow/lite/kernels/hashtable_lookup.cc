@@ -18,7 +18,9 @@ limitations under the License.
 // Input:
 //     Tensor[0]: Hash key to lookup, dim.size == 1, int32
 //     Tensor[1]: Key of hashtable, dim.size == 1, int32
-//                *MUST* be sorted in ascending order.
+//                *MUST* be sorted in ascending order. Constant keys are
+//                indexed by a hash map at Prepare, other keys are binary
+//                searched.
 //     Tensor[2]: Value of hashtable, dim.size >= 1
 //                Tensor[1].Dim[0] == Tensor[2].Dim[0]
 //
@@ -35,6 +37,7 @@ limitations under the License.
 
 #include <cstdlib>
 #include <cstring>
+#include <unordered_map>
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
@@ -51,6 +54,36 @@ int greater(const void* a, const void* b) {
   return *static_cast<const int*>(a) - *static_cast<const int*>(b);
 }
 
+struct OpData {
+  // Maps each key to its row, when the keys are constant.
+  std::unordered_map<int32_t, int> key_to_row;
+  bool has_key_to_row = false;
+};
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  return new OpData;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+// Returns the row of `lookup`, or -1 if it is not in the table.
+int FindRow(const OpData& data, const TfLiteTensor* key, int num_rows,
+            int32_t lookup) {
+  if (data.has_key_to_row) {
+    const auto it = data.key_to_row.find(lookup);
+    return it == data.key_to_row.end() ? -1 : it->second;
+  }
+  const void* pointer =
+      bsearch(&lookup, key->data.i32, num_rows, sizeof(int32_t), greater);
+  if (pointer == nullptr) {
+    return -1;
+  }
+  return (reinterpret_cast<const char*>(pointer) - key->data.raw) /
+         sizeof(int32_t);
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 3);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 2);
@@ -96,6 +129,20 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   if (context->ResizeTensor(context, hits, hitSize) != kTfLiteOk) {
     status = kTfLiteError;
   }
+
+  // Replaces the binary search with a hash lookup per key. The keys are only
+  // known this early when they are constant.
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
+  data->key_to_row.clear();
+  data->has_key_to_row = IsConstantTensor(key);
+  if (data->has_key_to_row) {
+    const int num_keys = SizeOfDimension(key, 0);
+    data->key_to_row.reserve(num_keys);
+    for (int i = 0; i < num_keys; ++i) {
+      // Keeps the first row of a duplicated key.
+      data->key_to_row.emplace(key->data.i32[i], i);
+    }
+  }
   return status;
 }
 
@@ -111,20 +158,14 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* value;
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 2, &value));
 
+  const OpData* data = reinterpret_cast<const OpData*>(node->user_data);
   const int num_rows = SizeOfDimension(value, 0);
   TF_LITE_ENSURE(context, num_rows != 0);
   const int row_bytes = value->bytes / num_rows;
-  void* pointer = nullptr;
   DynamicBuffer buf;
 
   for (int i = 0; i < SizeOfDimension(lookup, 0); i++) {
-    int idx = -1;
-    pointer = bsearch(&(lookup->data.i32[i]), key->data.i32, num_rows,
-                      sizeof(int32_t), greater);
-    if (pointer != nullptr) {
-      idx = (reinterpret_cast<char*>(pointer) - (key->data.raw)) /
-            sizeof(int32_t);
-    }
+    const int idx = FindRow(*data, key, num_rows, lookup->data.i32[i]);
 
     if (idx >= num_rows || idx < 0) {
       if (output->type == kTfLiteString) {
@@ -152,7 +193,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace
 
 TfLiteRegistration* Register_HASHTABLE_LOOKUP() {
-  static TfLiteRegistration r = {nullptr, nullptr, Prepare, Eval};
+  static TfLiteRegistration r = {Init, Free, Prepare, Eval};
   return &r;
 }
 
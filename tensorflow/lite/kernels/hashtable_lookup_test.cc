@@ -51,6 +51,21 @@ class HashtableLookupOpModel : public SingleOpModel {
     BuildInterpreter({lookup_shape, key_shape, value_shape});
   }
 
+  // Builds the model with constant hashtable keys.
+  HashtableLookupOpModel(std::initializer_list<int> lookup_shape,
+                         std::initializer_list<int> keys,
+                         std::initializer_list<int> value_shape) {
+    lookup_ = AddInput(TensorType_INT32);
+    key_ = AddConstInput(TensorType_INT32, keys,
+                         {static_cast<int>(keys.size())});
+    value_ = AddInput(TensorType_FLOAT32);
+    output_ = AddOutput(TensorType_FLOAT32);
+    hit_ = AddOutput(TensorType_UINT8);
+    SetBuiltinOp(BuiltinOperator_HASHTABLE_LOOKUP, BuiltinOptions_NONE, 0);
+    BuildInterpreter({lookup_shape, {static_cast<int>(keys.size())},
+                      value_shape});
+  }
+
   void SetLookup(std::initializer_list<int> data) {
     PopulateTensor<int>(lookup_, data);
   }
@@ -129,6 +144,23 @@ TEST(HashtableLookupOpTest, Test2DInput) {
                           }));
 }
 
+TEST(HashtableLookupOpTest, TestConstantKeys) {
+  HashtableLookupOpModel m({4}, /*keys=*/{-11, 0, 1234}, {3, 2});
+
+  m.SetLookup({1234, -292, -11, 0});
+  m.SetHashtableValue([](int i, int j) { return i + j / 10.0f; });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 2.0, 2.1,  // 2-nd item
+                                 0, 0,      // Not found
+                                 0.0, 0.1,  // 0-th item
+                                 1.0, 1.1,  // 1-st item
+                             })));
+  EXPECT_THAT(m.GetHit(), ElementsAreArray({1, 0, 1, 1}));
+}
+
 TEST(HashtableLookupOpTest, Test1DInput) {
   HashtableLookupOpModel m({4}, {3}, {3}, TensorType_FLOAT32);
 
@@ -0,0 +1,195 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_GATHER_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_GATHER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "ruy/profiler/instrumentation.h"  // from @ruy
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_ops {
+namespace gather {
+
+// Lookups into a large table mostly miss the cache, so the rows this many
+// lookups ahead are prefetched while the current one is copied.
+constexpr int kPrefetchDistance = 4;
+// Only the first bytes of each row are prefetched; the hardware prefetcher
+// picks up the rest of a long row once its first lines are read.
+constexpr int kPrefetchBytesPerRow = 256;
+constexpr int kCacheLineSize = 64;
+// Below this many bytes per thread, copying is cheaper than the dispatch.
+constexpr int kMinBytesPerThread = 64 * 1024;
+
+template <typename T>
+inline void PrefetchRow(const T* row, int row_size) {
+  const int bytes =
+      std::min<int>(row_size * sizeof(T), kPrefetchBytesPerRow);
+  const char* ptr = reinterpret_cast<const char*>(row);
+  for (int offset = 0; offset < bytes; offset += kCacheLineSize) {
+    optimized_ops_preload_l1_keep(ptr + offset);
+  }
+}
+
+template <typename T, typename IndexT>
+inline void GatherRowsImpl(const T* input_data, const IndexT* indices,
+                           int row_size, int start, int end, T* output_data) {
+  for (int i = start; i < std::min(end, start + kPrefetchDistance); ++i) {
+    PrefetchRow(input_data + indices[i] * row_size, row_size);
+  }
+  for (int i = start; i < end; ++i) {
+    if (i + kPrefetchDistance < end) {
+      PrefetchRow(input_data + indices[i + kPrefetchDistance] * row_size,
+                  row_size);
+    }
+    std::memcpy(output_data + i * row_size, input_data + indices[i] * row_size,
+                row_size * sizeof(T));
+  }
+}
+
+template <typename T, typename IndexT>
+struct GatherRowsTask : cpu_backend_threadpool::Task {
+  GatherRowsTask(const T* input_data, const IndexT* indices, int row_size,
+                 int start, int end, T* output_data)
+      : input_data(input_data),
+        indices(indices),
+        row_size(row_size),
+        start(start),
+        end(end),
+        output_data(output_data) {}
+
+  void Run() override {
+    GatherRowsImpl(input_data, indices, row_size, start, end, output_data);
+  }
+
+ private:
+  const T* input_data;
+  const IndexT* indices;
+  int row_size;
+  int start;
+  int end;
+  T* output_data;
+};
+
+}  // namespace gather
+
+// Copies row `indices[i]` of `input_data` to row i of `output_data` for the
+// `num_indices` indices, with rows of `row_size` elements. The indices must be
+// in range. Large gathers are split across the threads of
+// `cpu_backend_context`, which may be null to run on the calling thread.
+template <typename T, typename IndexT>
+inline void GatherRows(const T* input_data, const IndexT* indices,
+                       int num_indices, int row_size, T* output_data,
+                       CpuBackendContext* cpu_backend_context) {
+  const int64_t total_bytes =
+      static_cast<int64_t>(num_indices) * row_size * sizeof(T);
+  int thread_count = 1;
+  if (cpu_backend_context != nullptr) {
+    thread_count = static_cast<int>(std::min<int64_t>(
+        std::min(cpu_backend_context->max_num_threads(), num_indices),
+        total_bytes / gather::kMinBytesPerThread));
+    thread_count = std::max(thread_count, 1);
+  }
+  if (thread_count == 1) {
+    gather::GatherRowsImpl(input_data, indices, row_size, 0, num_indices,
+                           output_data);
+    return;
+  }
+  std::vector<gather::GatherRowsTask<T, IndexT>> tasks;
+  tasks.reserve(thread_count);
+  int start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int end = start + num_indices / thread_count;
+    if (i < num_indices % thread_count) end++;
+    tasks.emplace_back(input_data, indices, row_size, start, end, output_data);
+    start = end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
+// Same as reference_ops::Gather, with the rows copied by GatherRows.
+template <typename T, typename CoordsT = int32>
+inline void Gather(const tflite::GatherParams& op_params,
+                   const RuntimeShape& input_shape, const T* input_data,
+                   const RuntimeShape& coords_shape, const CoordsT* coords_data,
+                   const RuntimeShape& output_shape, T* output_data,
+                   CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("Gather");
+  int axis = op_params.axis;
+  if (axis < 0) {
+    axis += input_shape.DimensionsCount();
+  }
+  TFLITE_DCHECK_GE(axis, 0);
+  TFLITE_DCHECK_LT(axis, input_shape.DimensionsCount());
+
+  int batch_dims = op_params.batch_dims;
+  if (batch_dims < 0) {
+    batch_dims += coords_shape.DimensionsCount();
+  }
+  TFLITE_DCHECK_GE(batch_dims, 0);
+  TFLITE_DCHECK_LT(batch_dims, input_shape.DimensionsCount());
+  TFLITE_DCHECK_LE(batch_dims, coords_shape.DimensionsCount());
+  TFLITE_DCHECK_GE(axis, batch_dims);
+  for (int i = 0; i < batch_dims; ++i) {
+    TFLITE_DCHECK_EQ(input_shape.Dims(i), coords_shape.Dims(i));
+  }
+
+  const int axis_size = input_shape.Dims(axis);
+
+  int batch_size = 1;
+  for (int i = 0; i < batch_dims; ++i) {
+    batch_size *= input_shape.Dims(i);
+  }
+
+  int outer_size = 1;
+  for (int i = batch_dims; i < axis; ++i) {
+    outer_size *= input_shape.Dims(i);
+  }
+
+  int inner_size = 1;
+  for (int i = axis + 1; i < input_shape.DimensionsCount(); ++i) {
+    inner_size *= input_shape.Dims(i);
+  }
+
+  int coord_size = 1;
+  for (int i = batch_dims; i < coords_shape.DimensionsCount(); ++i) {
+    coord_size *= coords_shape.Dims(i);
+  }
+
+  for (int batch = 0; batch < batch_size; ++batch) {
+    const CoordsT* batch_coords = coords_data + batch * coord_size;
+    for (int outer = 0; outer < outer_size; ++outer) {
+      const int slice = batch * outer_size + outer;
+      GatherRows(input_data + slice * axis_size * inner_size, batch_coords,
+                 coord_size, inner_size,
+                 output_data + slice * coord_size * inner_size,
+                 cpu_backend_context);
+    }
+  }
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_GATHER_H_
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_FULLY_CONNECTED_H_
 #define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_FULLY_CONNECTED_H_
 
+#include <algorithm>
+
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm.h"
@@ -87,6 +89,59 @@ inline void FullyConnected(
                          cpu_backend_context);
 }
 
+// 16x8 fully connected: int16 activations, int8 weights and int64 bias. The
+// gemm backend only takes 8-bit operands, so this computes the products
+// directly. Each product of an activation and an offset weight fits in 24
+// bits, so runs of them are summed in int32, which the compiler vectorizes,
+// before being added to the int64 accumulator. The result is exactly the one
+// of the reference kernel.
+inline void FullyConnected(
+    const FullyConnectedParams& params, const RuntimeShape& input_shape,
+    const int16* input_data, const RuntimeShape& filter_shape,
+    const int8* filter_data, const RuntimeShape& bias_shape,
+    const int64_t* bias_data, const RuntimeShape& output_shape,
+    int16* output_data) {
+  ruy::profiler::ScopeLabel label("FullyConnectedInt16/8bit");
+
+  const int32 filter_offset = params.weights_offset;
+  const int32 output_multiplier = params.output_multiplier;
+  const int output_shift = params.output_shift;
+  const int32 output_activation_min = params.quantized_activation_min;
+  const int32 output_activation_max = params.quantized_activation_max;
+  TFLITE_DCHECK_GE(filter_shape.DimensionsCount(), 2);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 2);
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+
+  const int filter_dim_count = filter_shape.DimensionsCount();
+  const int batches = output_shape.Dims(0);
+  const int output_depth = output_shape.Dims(1);
+  TFLITE_DCHECK_LE(output_depth, filter_shape.Dims(filter_dim_count - 2));
+  const int accum_depth = filter_shape.Dims(filter_dim_count - 1);
+  // At most 2^7 products of at most 2^23 in magnitude don't overflow int32.
+  constexpr int kInt32AccumDepth = 128;
+  for (int b = 0; b < batches; ++b) {
+    const int16* input_row = input_data + b * accum_depth;
+    for (int out_c = 0; out_c < output_depth; ++out_c) {
+      const int8* filter_row = filter_data + out_c * accum_depth;
+      int64_t acc = bias_data ? bias_data[out_c] : 0;
+      for (int d_start = 0; d_start < accum_depth;
+           d_start += kInt32AccumDepth) {
+        const int d_end = std::min(d_start + kInt32AccumDepth, accum_depth);
+        int32 partial_acc = 0;
+        for (int d = d_start; d < d_end; ++d) {
+          partial_acc += (filter_row[d] + filter_offset) * input_row[d];
+        }
+        acc += partial_acc;
+      }
+      int32 acc_scaled =
+          MultiplyByQuantizedMultiplier(acc, output_multiplier, output_shift);
+      acc_scaled = std::max(acc_scaled, output_activation_min);
+      acc_scaled = std::min(acc_scaled, output_activation_max);
+      output_data[out_c + output_depth * b] = static_cast<int16>(acc_scaled);
+    }
+  }
+}
+
 }  // namespace optimized_integer_ops
 }  // namespace tflite
 
@@ -15,6 +15,9 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
 #define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
 
+#include <algorithm>
+#include <vector>
+
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
@@ -201,6 +204,210 @@ inline void FullyConnectedSparseWeight1x4(
                                   cpu_backend_context);
 }
 
+// Returns the block size of weights encoded with `sparsity`, or false if the
+// encoding is not a row-major block sparse matrix. Supported encodings are
+//   random sparse: dim_metadata {dense rows, CSR cols},
+//   1 x C blocks:  dim_metadata {dense rows, CSR cols / C, dense C},
+//   R x C blocks:  dim_metadata {dense rows / R, CSR cols / C, dense R,
+//                                dense C},
+// all with the identity traversal order.
+inline bool GetSparseWeightBlockSize(const TfLiteSparsity& sparsity,
+                                     int* block_rows, int* block_cols) {
+  const int num_dims = sparsity.dim_metadata_size;
+  if (num_dims < 2 || num_dims > 4 || sparsity.traversal_order == nullptr ||
+      sparsity.traversal_order->size != num_dims) {
+    return false;
+  }
+  for (int i = 0; i < num_dims; ++i) {
+    if (sparsity.traversal_order->data[i] != i) return false;
+    const TfLiteDimensionType expected_format =
+        i == 1 ? kTfLiteDimSparseCSR : kTfLiteDimDense;
+    if (sparsity.dim_metadata[i].format != expected_format) return false;
+  }
+  const int num_block_dims = num_dims - 2;
+  const int block_map_size =
+      sparsity.block_map == nullptr ? 0 : sparsity.block_map->size;
+  if (block_map_size != num_block_dims) return false;
+  // The block dims follow the original dims they are mapped to.
+  const int first_block_dim = 2 - num_block_dims;
+  for (int i = 0; i < num_block_dims; ++i) {
+    if (sparsity.block_map->data[i] != first_block_dim + i) return false;
+  }
+  *block_rows = num_dims == 4 ? sparsity.dim_metadata[2].dense_size : 1;
+  *block_cols =
+      num_dims > 2 ? sparsity.dim_metadata[num_dims - 1].dense_size : 1;
+  return true;
+}
+
+template <typename Function>
+struct SparseWeightBlockRowsTask : cpu_backend_threadpool::Task {
+  SparseWeightBlockRowsTask(const Function& function, int block_row_start,
+                            int block_row_end)
+      : function(function),
+        block_row_start(block_row_start),
+        block_row_end(block_row_end) {}
+
+  void Run() override { function(block_row_start, block_row_end); }
+
+ private:
+  const Function& function;
+  int block_row_start;
+  int block_row_end;
+};
+
+// Runs `function(block_row_start, block_row_end)` over slices of the block
+// rows of the weights. Slicing the rows rather than the batches keeps all
+// threads busy for the batch-1 inference that sparse models are usually
+// pruned for.
+template <typename Function>
+inline void ParallelizeOverSparseBlockRows(
+    int num_block_rows, CpuBackendContext* cpu_backend_context,
+    const Function& function) {
+  // Fewer rows than this per thread do not pay for the thread dispatch.
+  constexpr int kMinBlockRowsPerThread = 8;
+  const int thread_count =
+      std::max(1, std::min(cpu_backend_context->max_num_threads(),
+                           num_block_rows / kMinBlockRowsPerThread));
+  if (thread_count == 1) {
+    function(0, num_block_rows);
+    return;
+  }
+  std::vector<SparseWeightBlockRowsTask<Function>> tasks;
+  tasks.reserve(thread_count);
+  int block_row_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int block_row_end = block_row_start + num_block_rows / thread_count;
+    if (i < num_block_rows % thread_count) block_row_end++;
+    tasks.emplace_back(function, block_row_start, block_row_end);
+    block_row_start = block_row_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
+// Fully connected with weights in any of the encodings accepted by
+// GetSparseWeightBlockSize. Only the stored blocks are read; each one is a
+// dense block_rows x block_cols tile in row-major order.
+inline void FullyConnectedSparseWeightBlock(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const float* input_data,
+    const RuntimeShape& weights_shape, const float* weights_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("Block Sparse");
+  // The caller checks that the encoding is supported.
+  int block_rows = 1, block_cols = 1;
+  GetSparseWeightBlockSize(sparsity, &block_rows, &block_cols);
+  const float output_activation_min = params.float_activation_min;
+  const float output_activation_max = params.float_activation_max;
+
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int weights_dims_count = weights_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
+                                       output_shape, output_dims_count - 1);
+  const int accum_depth = weights_shape.Dims(weights_dims_count - 1);
+  const int num_block_rows = sparsity.dim_metadata[0].dense_size;
+  TFLITE_DCHECK_EQ(num_block_rows * block_rows, output_depth);
+  const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
+  const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
+  const int block_size = block_rows * block_cols;
+
+  auto compute = [&](int block_row_start, int block_row_end) {
+    for (int b = 0; b < batches; ++b) {
+      const float* input_ptr = input_data + b * accum_depth;
+      float* output_ptr = output_data + b * output_depth;
+      for (int i = block_row_start; i < block_row_end; ++i) {
+        for (int r = 0; r < block_rows; ++r) {
+          float total = 0.f;
+          for (int pw1 = w1_segments[i]; pw1 < w1_segments[i + 1]; ++pw1) {
+            const float* weights_ptr =
+                weights_data + pw1 * block_size + r * block_cols;
+            const float* input_block = input_ptr + w1_indices[pw1] * block_cols;
+            for (int c = 0; c < block_cols; ++c) {
+              total += weights_ptr[c] * input_block[c];
+            }
+          }
+          const int out_c = i * block_rows + r;
+          const float bias_value = bias_data ? bias_data[out_c] : 0;
+          output_ptr[out_c] = ActivationFunctionWithMinMax(
+              total + bias_value, output_activation_min, output_activation_max);
+        }
+      }
+    }
+  };
+  ParallelizeOverSparseBlockRows(num_block_rows, cpu_backend_context, compute);
+}
+
+// Integer version of the above for int8 inputs and outputs and symmetric int8
+// weights, for which the blocks that are not stored are exactly zero.
+inline void FullyConnectedSparseWeightBlock(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const RuntimeShape& weights_shape, const int8_t* weights_data,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("FullyConnectedInt8");
+  ruy::profiler::ScopeLabel inner_label("Block Sparse");
+  // The caller checks that the encoding is supported.
+  int block_rows = 1, block_cols = 1;
+  GetSparseWeightBlockSize(sparsity, &block_rows, &block_cols);
+  TFLITE_DCHECK_EQ(params.weights_offset, 0);
+  const int32_t input_offset = params.input_offset;
+  const int32_t output_offset = params.output_offset;
+  const int32_t output_multiplier = params.output_multiplier;
+  const int output_shift = params.output_shift;
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int weights_dims_count = weights_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
+                                       output_shape, output_dims_count - 1);
+  const int accum_depth = weights_shape.Dims(weights_dims_count - 1);
+  const int num_block_rows = sparsity.dim_metadata[0].dense_size;
+  TFLITE_DCHECK_EQ(num_block_rows * block_rows, output_depth);
+  const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
+  const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
+  const int block_size = block_rows * block_cols;
+
+  auto compute = [&](int block_row_start, int block_row_end) {
+    for (int b = 0; b < batches; ++b) {
+      const int8_t* input_ptr = input_data + b * accum_depth;
+      int8_t* output_ptr = output_data + b * output_depth;
+      for (int i = block_row_start; i < block_row_end; ++i) {
+        for (int r = 0; r < block_rows; ++r) {
+          int32_t acc = 0;
+          for (int pw1 = w1_segments[i]; pw1 < w1_segments[i + 1]; ++pw1) {
+            const int8_t* weights_ptr =
+                weights_data + pw1 * block_size + r * block_cols;
+            const int8_t* input_block =
+                input_ptr + w1_indices[pw1] * block_cols;
+            for (int c = 0; c < block_cols; ++c) {
+              acc += weights_ptr[c] * (input_block[c] + input_offset);
+            }
+          }
+          const int out_c = i * block_rows + r;
+          if (bias_data) {
+            acc += bias_data[out_c];
+          }
+          acc = MultiplyByQuantizedMultiplier(acc, output_multiplier,
+                                              output_shift);
+          acc += output_offset;
+          acc = std::max(acc, output_activation_min);
+          acc = std::min(acc, output_activation_max);
+          output_ptr[out_c] = static_cast<int8_t>(acc);
+        }
+      }
+    }
+  };
+  ParallelizeOverSparseBlockRows(num_block_rows, cpu_backend_context, compute);
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 #endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
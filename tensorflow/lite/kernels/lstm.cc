@@ -59,6 +59,11 @@ struct OpData {
   // Only used for sparse hybrid lstm kernels.
   int ledger_index;
   bool ledger_initialized;
+
+  // Only used for float lstm kernels, when the gate weights are packed into a
+  // single matrix by lstm_eval::PackGateWeightsFloat.
+  bool use_packed_gate_weights;
+  bool packed_gate_weights_initialized;
 };
 
 namespace full {
@@ -81,6 +86,10 @@ enum HybridTemporaryTensor {
   kNumHybridTemporaryTensors = 12,
 };
 
+// The float kernel only uses the scratch buffer and the packed gate weights,
+// which take the slot of the quantized input.
+constexpr int kPackedGateWeights = 1;
+
 constexpr int kLedgersToAdd = 9;
 constexpr int kInputToInputWeightsLedgerOffset = 0;
 constexpr int kInputToForgetWeightsLedgerOffset = 1;
@@ -833,6 +842,24 @@ TfLiteStatus PopulateQuantizedLstmParams8x8_8(
   return kTfLiteOk;
 }
 
+// Returns whether lstm_eval::PackGateWeightsFloat can be run once for all
+// invocations of the float kernel.
+bool CanPackGateWeights(TfLiteContext* context, TfLiteNode* node) {
+  return lstm_eval::CanPackGateWeightsFloat(
+      GetOptionalInputTensor(context, node, kInputToInputWeightsTensor),
+      GetOptionalInputTensor(context, node, kInputToForgetWeightsTensor),
+      GetOptionalInputTensor(context, node, kInputToCellWeightsTensor),
+      GetOptionalInputTensor(context, node, kInputToOutputWeightsTensor),
+      GetOptionalInputTensor(context, node, kRecurrentToInputWeightsTensor),
+      GetOptionalInputTensor(context, node, kRecurrentToForgetWeightsTensor),
+      GetOptionalInputTensor(context, node, kRecurrentToCellWeightsTensor),
+      GetOptionalInputTensor(context, node, kRecurrentToOutputWeightsTensor),
+      GetOptionalInputTensor(context, node, kInputGateBiasTensor),
+      GetOptionalInputTensor(context, node, kForgetGateBiasTensor),
+      GetOptionalInputTensor(context, node, kCellGateBiasTensor),
+      GetOptionalInputTensor(context, node, kOutputGateBiasTensor));
+}
+
 }  // namespace
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -1382,6 +1409,9 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // output and the 16 bit matmul output version.
   const bool is_8x8_16 = num_intermediate_tensors == 5;
 
+  op_data->use_packed_gate_weights =
+      !is_hybrid_op && !is_integer && CanPackGateWeights(context, node);
+
   TfLiteIntArrayFree(node->temporaries);
   if (is_hybrid_op) {
     if (is_sparse_op) {
@@ -1396,6 +1426,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     } else {
       node->temporaries = TfLiteIntArrayCreate(8);
     }
+  } else if (op_data->use_packed_gate_weights) {
+    node->temporaries = TfLiteIntArrayCreate(2);
   } else {
     node->temporaries = TfLiteIntArrayCreate(1);
   }
@@ -1424,6 +1456,27 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       // Reserving space for Input, Cell, Forget, Output gates
       scratch_buffer_size->data[1] = n_cell * 4;
     }
+    if (op_data->use_packed_gate_weights) {
+      // Reserving space for the input and the output of the packed gates GEMM.
+      scratch_buffer_size->data[1] *= 2;
+      scratch_buffer_size->data[1] += n_input + n_output;
+
+      node->temporaries->data[kPackedGateWeights] =
+          op_data->scratch_tensor_index + kPackedGateWeights;
+      TfLiteTensor* packed_gate_weights;
+      TF_LITE_ENSURE_OK(context,
+                        GetTemporarySafe(context, node, kPackedGateWeights,
+                                         &packed_gate_weights));
+      packed_gate_weights->type = kTfLiteFloat32;
+      packed_gate_weights->allocation_type = kTfLiteArenaRwPersistent;
+      TfLiteIntArray* packed_gate_weights_size = TfLiteIntArrayCreate(1);
+      packed_gate_weights_size->data[0] = lstm_eval::PackedGateWeightsSizeFloat(
+          use_cifg, n_cell, n_input, n_output);
+      TF_LITE_ENSURE_OK(context,
+                        context->ResizeTensor(context, packed_gate_weights,
+                                              packed_gate_weights_size));
+      op_data->packed_gate_weights_initialized = false;
+    }
     TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                      scratch_buffer_size));
   }
@@ -1908,6 +1961,24 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       TfLiteTensor* scratch_buffer;
       TF_LITE_ENSURE_OK(context,
                         GetTemporarySafe(context, node, 0, &scratch_buffer));
+      const float* packed_gate_weights_ptr = nullptr;
+      if (op_data->use_packed_gate_weights) {
+        TfLiteTensor* packed_gate_weights;
+        TF_LITE_ENSURE_OK(context,
+                          GetTemporarySafe(context, node, kPackedGateWeights,
+                                           &packed_gate_weights));
+        if (!op_data->packed_gate_weights_initialized) {
+          lstm_eval::PackGateWeightsFloat(
+              input_to_input_weights, input_to_forget_weights,
+              input_to_cell_weights, input_to_output_weights,
+              recurrent_to_input_weights, recurrent_to_forget_weights,
+              recurrent_to_cell_weights, recurrent_to_output_weights,
+              input_gate_bias, forget_gate_bias, cell_gate_bias,
+              output_gate_bias, GetTensorData<float>(packed_gate_weights));
+          op_data->packed_gate_weights_initialized = true;
+        }
+        packed_gate_weights_ptr = GetTensorData<float>(packed_gate_weights);
+      }
       return lstm_eval::EvalFloat(
           input, input_to_input_weights, input_to_forget_weights,
           input_to_cell_weights, input_to_output_weights,
@@ -1926,7 +1997,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*forward_sequence=*/true,
           /*time_major=*/true,
           /*output_offset=*/0, scratch_buffer, output_state, cell_state,
-          output);
+          output, packed_gate_weights_ptr,
+          CpuBackendContext::GetFromContext(context));
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
@@ -26,6 +26,8 @@ limitations under the License.
 #include "tensorflow/lite/c/builtin_op_data.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/kernel_utils.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
@@ -1681,8 +1683,218 @@ inline void LstmStepInteger8x8_8(
   std::copy_n(output_state_ptr, n_batch * n_output, output_ptr);
 }
 
+// Applies the peephole, the layer normalization and the activation to a gate
+// of LstmStepFloatPacked, like the end of CalculateLstmGateFloat. Without
+// layer normalization the gate bias was already added by the GEMM.
+inline void FinishLstmGateFloat(const float* cell_state,
+                                const float* cell_to_gate_weights,
+                                const float* layer_norm_coefficients,
+                                const float* gate_bias, const int n_batch,
+                                const int n_cell,
+                                const TfLiteFusedActivation activation,
+                                float* gate) {
+  if (cell_to_gate_weights != nullptr) {
+    tensor_utils::VectorBatchVectorCwiseProductAccumulate(
+        cell_to_gate_weights, n_cell, cell_state, n_batch, gate);
+  }
+  if (layer_norm_coefficients != nullptr) {
+    tensor_utils::MeanStddevNormalization(gate, gate, n_cell, n_batch);
+    tensor_utils::VectorBatchVectorCwiseProduct(layer_norm_coefficients, n_cell,
+                                                gate, n_batch, gate);
+    tensor_utils::VectorBatchVectorAdd(gate_bias, n_cell, n_batch, gate);
+  }
+  tensor_utils::ApplyActivationToVector(gate, n_batch * n_cell, activation,
+                                        gate);
+}
+
+// Same as LstmStepFloat without auxiliary input, but the input and recurrent
+// contributions to all gates come from a single GEMM with the weights packed by
+// PackGateWeightsFloat. The input and output state of each batch are
+// concatenated into gemm_input_scratch, of size n_batch * (n_input + n_output),
+// and the GEMM writes the gates to gemm_output_scratch, of size
+// n_batch * num_gates * n_cell, from where they are copied to the gate scratch
+// buffers.
+inline void LstmStepFloatPacked(
+    const float* input_ptr, const float* packed_gate_weights_ptr,
+    const float* cell_to_input_weights_ptr,
+    const float* cell_to_forget_weights_ptr,
+    const float* cell_to_output_weights_ptr,
+    const float* input_layer_norm_coefficients_ptr,
+    const float* forget_layer_norm_coefficients_ptr,
+    const float* cell_layer_norm_coefficients_ptr,
+    const float* output_layer_norm_coefficients_ptr,
+    const float* input_gate_bias_ptr, const float* forget_gate_bias_ptr,
+    const float* cell_gate_bias_ptr, const float* output_gate_bias_ptr,
+    const float* projection_weights_ptr, const float* projection_bias_ptr,
+    const TfLiteLSTMParams* params, bool use_cifg, int n_batch, int n_cell,
+    int n_input, int n_output, int output_batch_leading_dim,
+    float* output_state_ptr, float* cell_state_ptr, float* scratch0,
+    float* scratch1, float* scratch2, float* scratch3,
+    float* gemm_input_scratch, float* gemm_output_scratch, float* output_ptr,
+    CpuBackendContext* context) {
+  ruy::profiler::ScopeLabel label("LstmStepFloatPacked");
+  const int num_gates = use_cifg ? 3 : 4;
+  const int n_gate_rows = num_gates * n_cell;
+  const int n_gemm_input = n_input + n_output;
+  const bool use_layer_norm = (forget_layer_norm_coefficients_ptr != nullptr);
+
+  // Make named scratch buffers.
+  float* input_gate_scratch = scratch0;
+  float* forget_gate_scratch = scratch1;
+  float* cell_gate_scratch = scratch2;
+  float* output_gate_scratch = scratch3;
+
+  for (int b = 0; b < n_batch; b++) {
+    float* gemm_input = gemm_input_scratch + b * n_gemm_input;
+    std::copy_n(input_ptr + b * n_input, n_input, gemm_input);
+    std::copy_n(output_state_ptr + b * n_output, n_output,
+                gemm_input + n_input);
+  }
+
+  cpu_backend_gemm::MatrixParams<float> lhs_params;
+  lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.rows = n_gate_rows;
+  lhs_params.cols = n_gemm_input;
+  lhs_params.cache_policy = cpu_backend_gemm::DefaultCachePolicy(true);
+  cpu_backend_gemm::MatrixParams<float> rhs_params;
+  rhs_params.rows = n_gemm_input;
+  rhs_params.cols = n_batch;
+  cpu_backend_gemm::MatrixParams<float> dst_params;
+  dst_params.rows = n_gate_rows;
+  dst_params.cols = n_batch;
+  cpu_backend_gemm::GemmParams<float, float> gemm_params;
+  // With layer norm, the bias is added after the normalization.
+  if (!use_layer_norm) {
+    gemm_params.bias = packed_gate_weights_ptr + n_gate_rows * n_gemm_input;
+  }
+  cpu_backend_gemm::Gemm(lhs_params, packed_gate_weights_ptr, rhs_params,
+                         gemm_input_scratch, dst_params, gemm_output_scratch,
+                         gemm_params, context);
+
+  // Scatter the gates in the order they were packed.
+  float* gates[] = {input_gate_scratch, cell_gate_scratch, forget_gate_scratch,
+                    output_gate_scratch};
+  float* const* packed_gates = use_cifg ? gates + 1 : gates;
+  for (int b = 0; b < n_batch; b++) {
+    for (int g = 0; g < num_gates; g++) {
+      std::copy_n(gemm_output_scratch + b * n_gate_rows + g * n_cell, n_cell,
+                  packed_gates[g] + b * n_cell);
+    }
+  }
+
+  if (!use_cifg) {
+    FinishLstmGateFloat(cell_state_ptr, cell_to_input_weights_ptr,
+                        input_layer_norm_coefficients_ptr, input_gate_bias_ptr,
+                        n_batch, n_cell, kTfLiteActSigmoid, input_gate_scratch);
+  }
+  FinishLstmGateFloat(cell_state_ptr, cell_to_forget_weights_ptr,
+                      forget_layer_norm_coefficients_ptr, forget_gate_bias_ptr,
+                      n_batch, n_cell, kTfLiteActSigmoid, forget_gate_scratch);
+  FinishLstmGateFloat(/*cell_state=*/nullptr, /*cell_to_gate_weights=*/nullptr,
+                      cell_layer_norm_coefficients_ptr, cell_gate_bias_ptr,
+                      n_batch, n_cell, params->activation, cell_gate_scratch);
+  UpdateLstmCellFloat(n_batch, n_cell, cell_state_ptr, input_gate_scratch,
+                      forget_gate_scratch, cell_gate_scratch, use_cifg,
+                      params->cell_clip);
+  // The output gate peephole reads the updated cell state.
+  FinishLstmGateFloat(cell_state_ptr, cell_to_output_weights_ptr,
+                      output_layer_norm_coefficients_ptr, output_gate_bias_ptr,
+                      n_batch, n_cell, kTfLiteActSigmoid, output_gate_scratch);
+  CalculateLstmOutputFloat(n_batch, n_cell, n_output, cell_state_ptr,
+                           output_gate_scratch, params->activation,
+                           projection_weights_ptr, projection_bias_ptr,
+                           params->proj_clip, output_state_ptr, scratch2);
+  for (int b = 0; b < n_batch; b++) {
+    std::copy_n(output_state_ptr + b * n_output, n_output,
+                output_ptr + b * output_batch_leading_dim);
+  }
+}
+
 }  // namespace
 
+bool CanPackGateWeightsFloat(const TfLiteTensor* input_to_input_weights,
+                             const TfLiteTensor* input_to_forget_weights,
+                             const TfLiteTensor* input_to_cell_weights,
+                             const TfLiteTensor* input_to_output_weights,
+                             const TfLiteTensor* recurrent_to_input_weights,
+                             const TfLiteTensor* recurrent_to_forget_weights,
+                             const TfLiteTensor* recurrent_to_cell_weights,
+                             const TfLiteTensor* recurrent_to_output_weights,
+                             const TfLiteTensor* input_gate_bias,
+                             const TfLiteTensor* forget_gate_bias,
+                             const TfLiteTensor* cell_gate_bias,
+                             const TfLiteTensor* output_gate_bias) {
+  const bool use_cifg = (input_to_input_weights == nullptr);
+  const TfLiteTensor* tensors[] = {
+      input_to_input_weights,      input_to_forget_weights,
+      input_to_cell_weights,       input_to_output_weights,
+      recurrent_to_input_weights,  recurrent_to_forget_weights,
+      recurrent_to_cell_weights,   recurrent_to_output_weights,
+      input_gate_bias,             forget_gate_bias,
+      cell_gate_bias,              output_gate_bias};
+  for (const TfLiteTensor* tensor : tensors) {
+    if (tensor == nullptr) {
+      // Only the input gate tensors are optional, with CIFG.
+      if (use_cifg) continue;
+      return false;
+    }
+    if (tensor->type != kTfLiteFloat32 || tensor->sparsity != nullptr ||
+        (tensor->allocation_type != kTfLiteMmapRo &&
+         tensor->allocation_type != kTfLiteArenaRwPersistent)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int PackedGateWeightsSizeFloat(bool use_cifg, int n_cell, int n_input,
+                               int n_output) {
+  const int num_gates = use_cifg ? 3 : 4;
+  return num_gates * n_cell * (n_input + n_output + 1);
+}
+
+void PackGateWeightsFloat(const TfLiteTensor* input_to_input_weights,
+                          const TfLiteTensor* input_to_forget_weights,
+                          const TfLiteTensor* input_to_cell_weights,
+                          const TfLiteTensor* input_to_output_weights,
+                          const TfLiteTensor* recurrent_to_input_weights,
+                          const TfLiteTensor* recurrent_to_forget_weights,
+                          const TfLiteTensor* recurrent_to_cell_weights,
+                          const TfLiteTensor* recurrent_to_output_weights,
+                          const TfLiteTensor* input_gate_bias,
+                          const TfLiteTensor* forget_gate_bias,
+                          const TfLiteTensor* cell_gate_bias,
+                          const TfLiteTensor* output_gate_bias,
+                          float* packed_gate_weights) {
+  const int n_cell = input_to_output_weights->dims->data[0];
+  const int n_input = input_to_output_weights->dims->data[1];
+  const int n_output = recurrent_to_output_weights->dims->data[1];
+  const TfLiteTensor* input_weights[] = {
+      input_to_input_weights, input_to_cell_weights, input_to_forget_weights,
+      input_to_output_weights};
+  const TfLiteTensor* recurrent_weights[] = {
+      recurrent_to_input_weights, recurrent_to_cell_weights,
+      recurrent_to_forget_weights, recurrent_to_output_weights};
+  const TfLiteTensor* biases[] = {input_gate_bias, cell_gate_bias,
+                                  forget_gate_bias, output_gate_bias};
+  const int first_gate = (input_to_input_weights == nullptr) ? 1 : 0;
+
+  float* packed = packed_gate_weights;
+  for (int g = first_gate; g < 4; g++) {
+    const float* input_weights_ptr = GetTensorData<float>(input_weights[g]);
+    const float* recurrent_weights_ptr =
+        GetTensorData<float>(recurrent_weights[g]);
+    for (int c = 0; c < n_cell; c++) {
+      packed = std::copy_n(input_weights_ptr + c * n_input, n_input, packed);
+      packed =
+          std::copy_n(recurrent_weights_ptr + c * n_output, n_output, packed);
+    }
+  }
+  for (int g = first_gate; g < 4; g++) {
+    packed = std::copy_n(GetTensorData<float>(biases[g]), n_cell, packed);
+  }
+}
+
 // LINT.IfChange
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
@@ -1710,7 +1922,8 @@ TfLiteStatus EvalFloat(
     const TfLiteTensor* projection_weights, const TfLiteTensor* projection_bias,
     const TfLiteLSTMParams* params, bool forward_sequence, bool time_major,
     int output_offset, TfLiteTensor* scratch_buffer, TfLiteTensor* output_state,
-    TfLiteTensor* cell_state, TfLiteTensor* output) {
+    TfLiteTensor* cell_state, TfLiteTensor* output,
+    const float* packed_gate_weights, CpuBackendContext* context) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
   int max_time, n_batch;
   if (input->dims->size == 3) {
@@ -1749,6 +1962,17 @@ TfLiteStatus EvalFloat(
     output_gate_scratch = scratch_buffer_ptr + 3 * n_cell * n_batch;
   }
 
+  // The GEMM buffers of the packed gates follow the gate scratch buffers.
+  const bool use_packed_gate_weights = (packed_gate_weights != nullptr);
+  float* gemm_input_scratch = nullptr;
+  float* gemm_output_scratch = nullptr;
+  if (use_packed_gate_weights) {
+    TF_LITE_ASSERT(aux_input == nullptr);
+    const int num_gates = use_cifg ? 3 : 4;
+    gemm_input_scratch = scratch_buffer_ptr + num_gates * n_cell * n_batch;
+    gemm_output_scratch = gemm_input_scratch + (n_input + n_output) * n_batch;
+  }
+
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
   if (time_major) {
@@ -1767,6 +1991,29 @@ TfLiteStatus EvalFloat(
       float* output_ptr =
           GetTensorData<float>(output) + t_rel * output_step + output_offset;
 
+      if (use_packed_gate_weights) {
+        LstmStepFloatPacked(
+            input_ptr, packed_gate_weights,
+            GetTensorData<float>(cell_to_input_weights),
+            GetTensorData<float>(cell_to_forget_weights),
+            GetTensorData<float>(cell_to_output_weights),
+            GetTensorData<float>(input_layer_norm_coefficients),
+            GetTensorData<float>(forget_layer_norm_coefficients),
+            GetTensorData<float>(cell_layer_norm_coefficients),
+            GetTensorData<float>(output_layer_norm_coefficients),
+            GetTensorData<float>(input_gate_bias),
+            GetTensorData<float>(forget_gate_bias),
+            GetTensorData<float>(cell_gate_bias),
+            GetTensorData<float>(output_gate_bias),
+            GetTensorData<float>(projection_weights),
+            GetTensorData<float>(projection_bias), params, use_cifg, n_batch,
+            n_cell, n_input, n_output, output_batch_leading_dim,
+            GetTensorData<float>(output_state),
+            GetTensorData<float>(cell_state), input_gate_scratch,
+            forget_gate_scratch, cell_gate_scratch, output_gate_scratch,
+            gemm_input_scratch, gemm_output_scratch, output_ptr, context);
+        continue;
+      }
       LstmStepFloat(
           input_ptr, GetTensorData<float>(input_to_input_weights),
           GetTensorData<float>(input_to_forget_weights),
@@ -1828,6 +2075,29 @@ TfLiteStatus EvalFloat(
         float* cell_gate_scratch_ptr = cell_gate_scratch + b * n_cell;
         float* output_gate_scratch_ptr = output_gate_scratch + b * n_cell;
 
+        if (use_packed_gate_weights) {
+          LstmStepFloatPacked(
+              input_ptr, packed_gate_weights,
+              GetTensorData<float>(cell_to_input_weights),
+              GetTensorData<float>(cell_to_forget_weights),
+              GetTensorData<float>(cell_to_output_weights),
+              GetTensorData<float>(input_layer_norm_coefficients),
+              GetTensorData<float>(forget_layer_norm_coefficients),
+              GetTensorData<float>(cell_layer_norm_coefficients),
+              GetTensorData<float>(output_layer_norm_coefficients),
+              GetTensorData<float>(input_gate_bias),
+              GetTensorData<float>(forget_gate_bias),
+              GetTensorData<float>(cell_gate_bias),
+              GetTensorData<float>(output_gate_bias),
+              GetTensorData<float>(projection_weights),
+              GetTensorData<float>(projection_bias), params, use_cifg,
+              /*n_batch=*/1, n_cell, n_input, n_output,
+              output_batch_leading_dim, output_state_ptr, cell_state_ptr,
+              input_gate_scratch_ptr, forget_gate_scratch_ptr,
+              cell_gate_scratch_ptr, output_gate_scratch_ptr,
+              gemm_input_scratch, gemm_output_scratch, output_ptr, context);
+          continue;
+        }
         LstmStepFloat(
             input_ptr, GetTensorData<float>(input_to_input_weights),
             GetTensorData<float>(input_to_forget_weights),
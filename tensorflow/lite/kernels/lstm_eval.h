@@ -95,6 +95,53 @@ struct IntegerLstmParameter {
   int32_t intermediate_zp[12];
 };
 
+// Returns whether the input and recurrent weights and the gate biases of a
+// float LSTM can be packed by PackGateWeightsFloat. They must be dense float
+// tensors whose data does not change once the graph is prepared: constants, or
+// persistent tensors such as those the Dequantize op fills from constant fp16
+// weights.
+bool CanPackGateWeightsFloat(const TfLiteTensor* input_to_input_weights,
+                             const TfLiteTensor* input_to_forget_weights,
+                             const TfLiteTensor* input_to_cell_weights,
+                             const TfLiteTensor* input_to_output_weights,
+                             const TfLiteTensor* recurrent_to_input_weights,
+                             const TfLiteTensor* recurrent_to_forget_weights,
+                             const TfLiteTensor* recurrent_to_cell_weights,
+                             const TfLiteTensor* recurrent_to_output_weights,
+                             const TfLiteTensor* input_gate_bias,
+                             const TfLiteTensor* forget_gate_bias,
+                             const TfLiteTensor* cell_gate_bias,
+                             const TfLiteTensor* output_gate_bias);
+
+// Returns the number of floats written by PackGateWeightsFloat.
+int PackedGateWeightsSizeFloat(bool use_cifg, int n_cell, int n_input,
+                               int n_output);
+
+// Packs the weights of all gates into a single row-major matrix of shape
+// {num_gates * n_cell, n_input + n_output}, where row i holds the input and
+// then the recurrent weights of a gate cell, followed by the num_gates * n_cell
+// gate biases. The gates are ordered input (unless CIFG), cell, forget and
+// output.
+void PackGateWeightsFloat(const TfLiteTensor* input_to_input_weights,
+                          const TfLiteTensor* input_to_forget_weights,
+                          const TfLiteTensor* input_to_cell_weights,
+                          const TfLiteTensor* input_to_output_weights,
+                          const TfLiteTensor* recurrent_to_input_weights,
+                          const TfLiteTensor* recurrent_to_forget_weights,
+                          const TfLiteTensor* recurrent_to_cell_weights,
+                          const TfLiteTensor* recurrent_to_output_weights,
+                          const TfLiteTensor* input_gate_bias,
+                          const TfLiteTensor* forget_gate_bias,
+                          const TfLiteTensor* cell_gate_bias,
+                          const TfLiteTensor* output_gate_bias,
+                          float* packed_gate_weights);
+
+// If `packed_gate_weights` is not null, it holds the output of
+// PackGateWeightsFloat for the weights and biases passed in, and every step
+// computes all gates with a single GEMM on `context` instead of one
+// matrix-vector product per gate and weight matrix. This requires no auxiliary
+// input and n_batch * (n_input + n_output + num_gates * n_cell) floats in the
+// scratch buffer after the gate scratch buffers.
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -121,7 +168,9 @@ TfLiteStatus EvalFloat(
     const TfLiteTensor* projection_weights, const TfLiteTensor* projection_bias,
     const TfLiteLSTMParams* params, bool forward_sequence, bool time_major,
     int output_offset, TfLiteTensor* scratch_buffer, TfLiteTensor* output_state,
-    TfLiteTensor* cell_state, TfLiteTensor* output);
+    TfLiteTensor* cell_state, TfLiteTensor* output,
+    const float* packed_gate_weights = nullptr,
+    CpuBackendContext* context = nullptr);
 
 TfLiteStatus EvalHybrid(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
@@ -965,5 +965,146 @@ TEST(TestOneHybridAsymmLSTM, TestOneHybridAsymmLSTM) {
   TestOneHybridAsymmLSTM();
 }
 
+// Float tensor filled with a deterministic pattern scaled by `scale`.
+class FloatTensor {
+ public:
+  FloatTensor(const std::vector<int>& dims, float scale, int seed) {
+    int size = 1;
+    for (int dim : dims) size *= dim;
+    for (int i = 0; i < size; ++i) {
+      data_.push_back(scale * ((i * 7 + seed * 13) % 17 - 8) / 8.0f);
+    }
+    tensor_.type = kTfLiteFloat32;
+    tensor_.allocation_type = kTfLiteMmapRo;
+    tensor_.dims = TfLiteIntArrayCreate(dims.size());
+    for (int i = 0; i < static_cast<int>(dims.size()); ++i) {
+      tensor_.dims->data[i] = dims[i];
+    }
+    tensor_.data.f = data_.data();
+  }
+  ~FloatTensor() { TfLiteIntArrayFree(tensor_.dims); }
+
+  TfLiteTensor* get() { return &tensor_; }
+  const std::vector<float>& data() const { return data_; }
+
+ private:
+  std::vector<float> data_;
+  TfLiteTensor tensor_ = {};
+};
+
+// Checks that evaluating a float LSTM with packed gate weights gives the same
+// result as evaluating it gate by gate.
+void TestPackedGateWeightsFloat(bool use_cifg, bool use_layer_norm) {
+  const int max_time = 3;
+  const int n_batch = 2;
+  const int n_input = 5;
+  const int n_cell = 4;
+  const int n_output = 3;
+  const int num_gates = use_cifg ? 3 : 4;
+
+  FloatTensor input({max_time, n_batch, n_input}, 1.0f, 1);
+  // The gates are indexed input, forget, cell, output.
+  std::vector<std::unique_ptr<FloatTensor>> input_weights;
+  std::vector<std::unique_ptr<FloatTensor>> recurrent_weights;
+  std::vector<std::unique_ptr<FloatTensor>> peephole_weights;
+  std::vector<std::unique_ptr<FloatTensor>> layer_norm_coefficients;
+  std::vector<std::unique_ptr<FloatTensor>> biases;
+  for (int g = 0; g < 4; ++g) {
+    input_weights.emplace_back(new FloatTensor({n_cell, n_input}, 0.5f, g));
+    recurrent_weights.emplace_back(
+        new FloatTensor({n_cell, n_output}, 0.5f, g + 4));
+    peephole_weights.emplace_back(new FloatTensor({n_cell}, 0.3f, g + 8));
+    layer_norm_coefficients.emplace_back(
+        new FloatTensor({n_cell}, 1.0f, g + 12));
+    biases.emplace_back(new FloatTensor({n_cell}, 0.2f, g + 16));
+  }
+  FloatTensor projection_weights({n_output, n_cell}, 0.5f, 20);
+  FloatTensor projection_bias({n_output}, 0.1f, 21);
+  auto get = [&](std::vector<std::unique_ptr<FloatTensor>>& tensors, int g,
+                 bool present) -> TfLiteTensor* {
+    return present && !(use_cifg && g == 0) ? tensors[g]->get() : nullptr;
+  };
+  const TfLiteLSTMParams params = {kTfLiteActTanh, /*cell_clip=*/0.0f,
+                                   /*proj_clip=*/0.0f, kTfLiteLSTMFullKernel,
+                                   false};
+
+  std::vector<float> outputs[2];
+  std::vector<float> cell_states[2];
+  for (int packed = 0; packed < 2; ++packed) {
+    FloatTensor output_state({n_batch, n_output}, 0.0f, 0);
+    FloatTensor cell_state({n_batch, n_cell}, 0.0f, 0);
+    FloatTensor output({max_time, n_batch, n_output}, 0.0f, 0);
+    FloatTensor scratch_buffer(
+        {n_batch, 2 * num_gates * n_cell + n_input + n_output}, 0.0f, 0);
+    std::vector<float> packed_gate_weights;
+    if (packed) {
+      ASSERT_TRUE(ops::builtin::lstm_eval::CanPackGateWeightsFloat(
+          get(input_weights, 0, true), get(input_weights, 1, true),
+          get(input_weights, 2, true), get(input_weights, 3, true),
+          get(recurrent_weights, 0, true), get(recurrent_weights, 1, true),
+          get(recurrent_weights, 2, true), get(recurrent_weights, 3, true),
+          get(biases, 0, true), get(biases, 1, true), get(biases, 2, true),
+          get(biases, 3, true)));
+      packed_gate_weights.resize(
+          ops::builtin::lstm_eval::PackedGateWeightsSizeFloat(
+              use_cifg, n_cell, n_input, n_output));
+      ops::builtin::lstm_eval::PackGateWeightsFloat(
+          get(input_weights, 0, true), get(input_weights, 1, true),
+          get(input_weights, 2, true), get(input_weights, 3, true),
+          get(recurrent_weights, 0, true), get(recurrent_weights, 1, true),
+          get(recurrent_weights, 2, true), get(recurrent_weights, 3, true),
+          get(biases, 0, true), get(biases, 1, true), get(biases, 2, true),
+          get(biases, 3, true), packed_gate_weights.data());
+    }
+    CpuBackendContext context;
+    ASSERT_EQ(
+        ops::builtin::lstm_eval::EvalFloat(
+            input.get(), get(input_weights, 0, true),
+            get(input_weights, 1, true), get(input_weights, 2, true),
+            get(input_weights, 3, true), get(recurrent_weights, 0, true),
+            get(recurrent_weights, 1, true), get(recurrent_weights, 2, true),
+            get(recurrent_weights, 3, true), get(peephole_weights, 0, true),
+            get(peephole_weights, 1, true), get(peephole_weights, 3, true),
+            get(layer_norm_coefficients, 0, use_layer_norm),
+            get(layer_norm_coefficients, 1, use_layer_norm),
+            get(layer_norm_coefficients, 2, use_layer_norm),
+            get(layer_norm_coefficients, 3, use_layer_norm),
+            /*aux_input=*/nullptr,
+            /*aux_input_to_input_weights=*/nullptr,
+            /*aux_input_to_forget_weights=*/nullptr,
+            /*aux_input_to_cell_weights=*/nullptr,
+            /*aux_input_to_output_weights=*/nullptr, get(biases, 0, true),
+            get(biases, 1, true), get(biases, 2, true), get(biases, 3, true),
+            projection_weights.get(), projection_bias.get(), &params,
+            /*forward_sequence=*/true, /*time_major=*/true,
+            /*output_offset=*/0, scratch_buffer.get(), output_state.get(),
+            cell_state.get(), output.get(),
+            packed ? packed_gate_weights.data() : nullptr, &context),
+        kTfLiteOk);
+    outputs[packed] = output.data();
+    cell_states[packed] = cell_state.data();
+  }
+  EXPECT_TRUE(ArrayFloatNear(outputs[1].data(), outputs[0].data(),
+                             outputs[0].size(), 1e-5));
+  EXPECT_TRUE(ArrayFloatNear(cell_states[1].data(), cell_states[0].data(),
+                             cell_states[0].size(), 1e-5));
+}
+
+TEST(TestPackedGateWeightsFloat, NoCifg) {
+  TestPackedGateWeightsFloat(/*use_cifg=*/false, /*use_layer_norm=*/false);
+}
+
+TEST(TestPackedGateWeightsFloat, Cifg) {
+  TestPackedGateWeightsFloat(/*use_cifg=*/true, /*use_layer_norm=*/false);
+}
+
+TEST(TestPackedGateWeightsFloat, NoCifgLayerNorm) {
+  TestPackedGateWeightsFloat(/*use_cifg=*/false, /*use_layer_norm=*/true);
+}
+
+TEST(TestPackedGateWeightsFloat, CifgLayerNorm) {
+  TestPackedGateWeightsFloat(/*use_cifg=*/true, /*use_layer_norm=*/true);
+}
+
 }  // namespace
 }  // namespace tflite
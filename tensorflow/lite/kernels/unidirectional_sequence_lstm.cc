@@ -43,6 +43,11 @@ struct OpData {
   bool compute_row_sums = false;
 
   lstm_eval::IntegerLstmParameter integer_lstm_param;
+
+  // Only used for float kernels, when the gate weights are packed into a
+  // single matrix by lstm_eval::PackGateWeightsFloat.
+  bool use_packed_gate_weights = false;
+  bool packed_gate_weights_initialized = false;
 };
 
 TfLiteStatus PopulateQuantizedLstmParams8x8_16(
@@ -394,6 +399,10 @@ enum TemporaryTensor {
   kNumTemporaryTensors = 12,
 };
 
+// The float kernel only uses the scratch buffer and the packed gate weights,
+// which take the slot of the quantized input.
+constexpr int kPackedGateWeights = 1;
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   auto* op_data = new OpData();
   context->AddTensors(context, kNumTemporaryTensors,
@@ -405,6 +414,33 @@ void Free(TfLiteContext* context, void* buffer) {
   delete reinterpret_cast<OpData*>(buffer);
 }
 
+// Returns whether lstm_eval::PackGateWeightsFloat can be run once for all
+// invocations of the float kernel.
+bool CanPackGateWeights(TfLiteContext* context, TfLiteNode* node) {
+  return lstm_eval::CanPackGateWeightsFloat(
+      GetOptionalInputTensor(context, node,
+                             lstm::full::kInputToInputWeightsTensor),
+      GetOptionalInputTensor(context, node,
+                             lstm::full::kInputToForgetWeightsTensor),
+      GetOptionalInputTensor(context, node,
+                             lstm::full::kInputToCellWeightsTensor),
+      GetOptionalInputTensor(context, node,
+                             lstm::full::kInputToOutputWeightsTensor),
+      GetOptionalInputTensor(context, node,
+                             lstm::full::kRecurrentToInputWeightsTensor),
+      GetOptionalInputTensor(context, node,
+                             lstm::full::kRecurrentToForgetWeightsTensor),
+      GetOptionalInputTensor(context, node,
+                             lstm::full::kRecurrentToCellWeightsTensor),
+      GetOptionalInputTensor(context, node,
+                             lstm::full::kRecurrentToOutputWeightsTensor),
+      GetOptionalInputTensor(context, node, lstm::full::kInputGateBiasTensor),
+      GetOptionalInputTensor(context, node, lstm::full::kForgetGateBiasTensor),
+      GetOptionalInputTensor(context, node, lstm::full::kCellGateBiasTensor),
+      GetOptionalInputTensor(context, node,
+                             lstm::full::kOutputGateBiasTensor));
+}
+
 // Check that input tensor dimensions matches with each other.
 TfLiteStatus CheckInputTensorDimensions(TfLiteContext* context,
                                         TfLiteNode* node, int n_input,
@@ -938,11 +974,17 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     TF_LITE_ENSURE(context, num_intermediate_tensors == 5);
   }
 
+  op_data->use_packed_gate_weights =
+      !IsHybridOp(input, input_to_output_weights) && !is_integer &&
+      CanPackGateWeights(context, node);
+
   TfLiteIntArrayFree(node->temporaries);
   if (IsHybridOp(input, input_to_output_weights)) {
     node->temporaries = TfLiteIntArrayCreate(kNumTemporaryTensors);
   } else if (is_integer) {
     node->temporaries = TfLiteIntArrayCreate(6);
+  } else if (op_data->use_packed_gate_weights) {
+    node->temporaries = TfLiteIntArrayCreate(2);
   } else {
     node->temporaries = TfLiteIntArrayCreate(1);
   }
@@ -968,6 +1010,27 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     // Reserving space for Input, Cell, Forget, Output gates
     scratch_buffer_size->data[1] = n_cell * 4;
   }
+  if (op_data->use_packed_gate_weights) {
+    // Reserving space for the input and the output of the packed gates GEMM.
+    scratch_buffer_size->data[1] *= 2;
+    scratch_buffer_size->data[1] += n_input + n_output;
+
+    node->temporaries->data[kPackedGateWeights] =
+        scratch_tensor_index + kPackedGateWeights;
+    TfLiteTensor* packed_gate_weights;
+    TF_LITE_ENSURE_OK(context,
+                      GetTemporarySafe(context, node, kPackedGateWeights,
+                                       &packed_gate_weights));
+    packed_gate_weights->type = kTfLiteFloat32;
+    packed_gate_weights->allocation_type = kTfLiteArenaRwPersistent;
+    TfLiteIntArray* packed_gate_weights_size = TfLiteIntArrayCreate(1);
+    packed_gate_weights_size->data[0] = lstm_eval::PackedGateWeightsSizeFloat(
+        use_cifg, n_cell, n_input, n_output);
+    TF_LITE_ENSURE_OK(context,
+                      context->ResizeTensor(context, packed_gate_weights,
+                                            packed_gate_weights_size));
+    op_data->packed_gate_weights_initialized = false;
+  }
   TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                    scratch_buffer_size));
 
@@ -1206,7 +1269,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const auto* params =
       reinterpret_cast<TfLiteUnidirectionalSequenceLSTMParams*>(
           node->builtin_data);
-  const OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
   const bool use_layer_norm = op_data->use_layer_norm;
   const bool time_major = params->time_major;
   const TfLiteTensor* input;
@@ -1317,6 +1380,24 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       TfLiteTensor* scratch_buffer;
       TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, kScratchBuffer,
                                                   &scratch_buffer));
+      const float* packed_gate_weights_ptr = nullptr;
+      if (op_data->use_packed_gate_weights) {
+        TfLiteTensor* packed_gate_weights;
+        TF_LITE_ENSURE_OK(context,
+                          GetTemporarySafe(context, node, kPackedGateWeights,
+                                           &packed_gate_weights));
+        if (!op_data->packed_gate_weights_initialized) {
+          lstm_eval::PackGateWeightsFloat(
+              input_to_input_weights, input_to_forget_weights,
+              input_to_cell_weights, input_to_output_weights,
+              recurrent_to_input_weights, recurrent_to_forget_weights,
+              recurrent_to_cell_weights, recurrent_to_output_weights,
+              input_gate_bias, forget_gate_bias, cell_gate_bias,
+              output_gate_bias, GetTensorData<float>(packed_gate_weights));
+          op_data->packed_gate_weights_initialized = true;
+        }
+        packed_gate_weights_ptr = GetTensorData<float>(packed_gate_weights);
+      }
       return lstm_eval::EvalFloat(
           input, input_to_input_weights, input_to_forget_weights,
           input_to_cell_weights, input_to_output_weights,
@@ -1334,7 +1415,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           projection_weights, projection_bias, &lstm_params,
           /*forward_sequence=*/true, time_major,
           /*output_offset=*/0, scratch_buffer, output_state, cell_state,
-          output);
+          output, packed_gate_weights_ptr,
+          CpuBackendContext::GetFromContext(context));
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
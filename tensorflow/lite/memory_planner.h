@@ -59,6 +59,15 @@ class MemoryPlanner {
 
   // Returns true if the non-persistent memory is available.
   virtual bool HasNonPersistentMemory() = 0;
+
+  // Retrieves the non-persistent memory in use while executing 'node_index':
+  // 'arena_bytes' is the end of the furthest allocation live at that node, and
+  // 'temporary_bytes' the size of the node's own temporaries. Returns an error
+  // if the planner doesn't track it.
+  virtual TfLiteStatus GetNodeArenaUsage(int node_index, size_t* arena_bytes,
+                                         size_t* temporary_bytes) {
+    return kTfLiteError;
+  }
 };
 
 }  // namespace tflite
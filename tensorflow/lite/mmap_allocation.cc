@@ -78,24 +78,40 @@ MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
   if (owned_fd < 0) {
     return;
   }
+  const size_t file_size = GetFdSizeBytes(owned_fd);
+  if (offset > file_size || length > file_size - offset) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Region of %zu bytes at offset %zu exceeds the %zu "
+                         "bytes of '%d'.",
+                         length, offset, file_size, mmap_fd_);
+    return;
+  }
+  // mmap requires the offset to be a multiple of the page size.
+  const size_t page_size = sysconf(_SC_PAGE_SIZE);
+  offset_in_buffer_ = offset % page_size;
   mmapped_buffer_ =
-      mmap(nullptr, length, PROT_READ, MAP_SHARED, mmap_fd_, offset);
+      mmap(nullptr, offset_in_buffer_ + length, PROT_READ, MAP_SHARED,
+           mmap_fd_, offset - offset_in_buffer_);
   if (mmapped_buffer_ == MAP_FAILED) {
     TF_LITE_REPORT_ERROR(error_reporter, "Mmap of '%d' failed.", mmap_fd_);
+    offset_in_buffer_ = 0;
     return;
   }
 }
 
 MMAPAllocation::~MMAPAllocation() {
   if (valid()) {
-    munmap(const_cast<void*>(mmapped_buffer_), buffer_size_bytes_);
+    munmap(const_cast<void*>(mmapped_buffer_),
+           offset_in_buffer_ + buffer_size_bytes_);
   }
   if (mmap_fd_ >= 0) {
     close(mmap_fd_);
   }
 }
 
-const void* MMAPAllocation::base() const { return mmapped_buffer_; }
+const void* MMAPAllocation::base() const {
+  return static_cast<const char*>(mmapped_buffer_) + offset_in_buffer_;
+}
 
 size_t MMAPAllocation::bytes() const { return buffer_size_bytes_; }
 
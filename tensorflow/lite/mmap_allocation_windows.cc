@@ -0,0 +1,140 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <fcntl.h>
+#include <io.h>
+#include <stddef.h>
+#include <sys/stat.h>
+#include <windows.h>
+
+#include <cstdint>
+
+#include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+
+namespace tflite {
+namespace {
+
+size_t GetFdSizeBytes(int fd) {
+  if (fd < 0) {
+    return 0;
+  }
+
+  struct _stat64 fd_stat;
+  if (_fstat64(fd, &fd_stat) != 0) {
+    return 0;
+  }
+
+  return fd_stat.st_size;
+}
+
+}  // namespace
+
+MMAPAllocation::MMAPAllocation(const char* filename,
+                               ErrorReporter* error_reporter)
+    : MMAPAllocation(error_reporter, _open(filename, _O_RDONLY | _O_BINARY)) {
+  if (mmap_fd_ == -1) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Could not open '%s'.", filename);
+  }
+}
+
+MMAPAllocation::MMAPAllocation(int fd, ErrorReporter* error_reporter)
+    : MMAPAllocation(error_reporter, _dup(fd)) {
+  if (mmap_fd_ == -1) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Failed to dup '%d' file descriptor.",
+                         fd);
+  }
+}
+
+MMAPAllocation::MMAPAllocation(int fd, size_t offset, size_t length,
+                               ErrorReporter* error_reporter)
+    : MMAPAllocation(error_reporter, _dup(fd), offset, length) {
+  if (mmap_fd_ == -1) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Failed to dup '%d' file descriptor.",
+                         fd);
+  }
+}
+
+MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd)
+    : MMAPAllocation(error_reporter, owned_fd, /*offset=*/0,
+                     /*length=*/GetFdSizeBytes(owned_fd)) {}
+
+MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
+                               size_t offset, size_t length)
+    : Allocation(error_reporter, Allocation::Type::kMMap),
+      mmap_fd_(owned_fd),
+      mmapped_buffer_(nullptr),
+      buffer_size_bytes_(length) {
+  if (owned_fd < 0) {
+    return;
+  }
+  const size_t file_size = GetFdSizeBytes(owned_fd);
+  if (length == 0 || offset > file_size || length > file_size - offset) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Region of %zu bytes at offset %zu exceeds the %zu "
+                         "bytes of '%d'.",
+                         length, offset, file_size, mmap_fd_);
+    return;
+  }
+  HANDLE file = reinterpret_cast<HANDLE>(_get_osfhandle(owned_fd));
+  HANDLE mapping =
+      CreateFileMappingA(file, /*lpFileMappingAttributes=*/nullptr,
+                         PAGE_READONLY, /*dwMaximumSizeHigh=*/0,
+                         /*dwMaximumSizeLow=*/0, /*lpName=*/nullptr);
+  if (mapping == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "CreateFileMapping of '%d' failed with error %lu.",
+                         mmap_fd_, GetLastError());
+    return;
+  }
+  // Views must start at a multiple of the allocation granularity.
+  SYSTEM_INFO system_info;
+  GetSystemInfo(&system_info);
+  offset_in_buffer_ = offset % system_info.dwAllocationGranularity;
+  const uint64_t view_offset = offset - offset_in_buffer_;
+  mmapped_buffer_ = MapViewOfFile(
+      mapping, FILE_MAP_READ, static_cast<DWORD>(view_offset >> 32),
+      static_cast<DWORD>(view_offset), offset_in_buffer_ + length);
+  // The view keeps the mapping alive.
+  CloseHandle(mapping);
+  if (mmapped_buffer_ == nullptr) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "MapViewOfFile of '%d' failed with error %lu.",
+                         mmap_fd_, GetLastError());
+    offset_in_buffer_ = 0;
+    return;
+  }
+}
+
+MMAPAllocation::~MMAPAllocation() {
+  if (valid()) {
+    UnmapViewOfFile(mmapped_buffer_);
+  }
+  if (mmap_fd_ >= 0) {
+    _close(mmap_fd_);
+  }
+}
+
+const void* MMAPAllocation::base() const {
+  return static_cast<const char*>(mmapped_buffer_) + offset_in_buffer_;
+}
+
+size_t MMAPAllocation::bytes() const { return buffer_size_bytes_; }
+
+bool MMAPAllocation::valid() const { return mmapped_buffer_ != nullptr; }
+
+bool MMAPAllocation::IsSupported() { return true; }
+
+}  // namespace tflite
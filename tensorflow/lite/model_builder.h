@@ -95,6 +95,9 @@ class FlatBufferModel {
   /// Returns a nullptr in case of failure.
   /// NOTE: this does NOT validate the buffer so it should NOT be called on
   /// invalid/untrusted input. Use VerifyAndBuildFromBuffer in that case
+  /// To hand the buffer over to the model instead, e.g. one that lives in a
+  /// shared-memory segment, use BuildFromAllocation with a MemoryAllocation
+  /// that has a deleter.
   static std::unique_ptr<FlatBufferModel> BuildFromBuffer(
       const char* caller_owned_buffer, size_t buffer_size,
       ErrorReporter* error_reporter = DefaultErrorReporter());
@@ -257,6 +257,29 @@ class NnApiHandler {
     nnapi_->ANeuralNetworksModel_getSupportedOperationsForDevices = stub;
   }
 
+  void StubCompilationSetCachingWith(
+      int(stub)(ANeuralNetworksCompilation* compilation, const char* cacheDir,
+                const uint8_t* token)) {
+    nnapi_->ANeuralNetworksCompilation_setCaching = stub;
+  }
+
+  template <int Value>
+  void BurstCreateReturns() {
+    nnapi_->ANeuralNetworksBurst_create =
+        [](ANeuralNetworksCompilation* compilation,
+           ANeuralNetworksBurst** burst) {
+          *burst = reinterpret_cast<ANeuralNetworksBurst*>(5);
+          return Value;
+        };
+    nnapi_->ANeuralNetworksBurst_free = [](ANeuralNetworksBurst* burst) {};
+  }
+
+  void StubExecutionBurstComputeWith(
+      int(stub)(ANeuralNetworksExecution* execution,
+                ANeuralNetworksBurst* burst)) {
+    nnapi_->ANeuralNetworksExecution_burstCompute = stub;
+  }
+
   template <int Value>
   void ExecutionStartComputeReturns() {
     nnapi_->ANeuralNetworksExecution_startCompute =
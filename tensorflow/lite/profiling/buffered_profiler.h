@@ -105,6 +105,12 @@ class BufferedProfiler : public tflite::Profiler {
                      event_metadata2);
   }
 
+  void AddArenaUsage(int64_t event_metadata1, int64_t event_metadata2,
+                     uint64_t arena_bytes, uint64_t temporary_bytes) override {
+    buffer_.AddArenaUsage(event_metadata1, event_metadata2, arena_bytes,
+                          temporary_bytes);
+  }
+
   void StartProfiling() { buffer_.SetEnabled(true); }
   void StopProfiling() { buffer_.SetEnabled(false); }
   void Reset() { buffer_.Reset(); }
@@ -56,6 +56,12 @@ struct ProfileEvent {
   // Note: if this is an OPERATOR_INVOKE_EVENT, 'extra_event_metadata' will
   // represent the index of the subgraph that this event comes from.
   int64_t extra_event_metadata;
+
+  // For an OPERATOR_INVOKE_EVENT, the bytes of the tensor arena in use while
+  // the operator ran, and how many of them its temporaries took. Zero if not
+  // reported.
+  uint64_t arena_bytes;
+  uint64_t temporary_arena_bytes;
 };
 
 // A ring buffer of profile events.
@@ -86,6 +92,8 @@ class ProfileBuffer {
     event_buffer_[index].extra_event_metadata = event_metadata2;
     event_buffer_[index].begin_timestamp_us = timestamp;
     event_buffer_[index].end_timestamp_us = 0;
+    event_buffer_[index].arena_bytes = 0;
+    event_buffer_[index].temporary_arena_bytes = 0;
     if (event_type != Profiler::EventType::OPERATOR_INVOKE_EVENT) {
       event_buffer_[index].begin_mem_usage = memory::GetMemoryUsage();
     }
@@ -143,9 +151,33 @@ class ProfileBuffer {
     event_buffer_[index].extra_event_metadata = event_metadata2;
     event_buffer_[index].begin_timestamp_us = start;
     event_buffer_[index].end_timestamp_us = end;
+    event_buffer_[index].arena_bytes = 0;
+    event_buffer_[index].temporary_arena_bytes = 0;
     current_index_++;
   }
 
+  // Sets the arena usage of the latest OPERATOR_INVOKE_EVENT of node
+  // 'event_metadata1' in subgraph 'event_metadata2'. If the buffer is disabled
+  // or the event has been overwritten this operation has no effect.
+  void AddArenaUsage(int64_t event_metadata1, int64_t event_metadata2,
+                     uint64_t arena_bytes, uint64_t temporary_bytes) {
+    if (!enabled_) {
+      return;
+    }
+    const uint32_t max_size = event_buffer_.size();
+    for (uint32_t i = current_index_; i > 0 && current_index_ - i < max_size;
+         --i) {
+      ProfileEvent& event = event_buffer_[(i - 1) % max_size];
+      if (event.event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT &&
+          event.event_metadata == event_metadata1 &&
+          event.extra_event_metadata == event_metadata2) {
+        event.arena_bytes = arena_bytes;
+        event.temporary_arena_bytes = temporary_bytes;
+        return;
+      }
+    }
+  }
+
   // Returns the size of the buffer.
   size_t Size() const {
     return (current_index_ >= event_buffer_.size()) ? event_buffer_.size()
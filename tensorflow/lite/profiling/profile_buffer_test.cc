@@ -82,6 +82,30 @@ TEST(ProfileBufferTest, EndEventWithMetadata) {
   EXPECT_GE(event->end_timestamp_us, event->begin_timestamp_us);
 }
 
+TEST(ProfileBufferTest, AddArenaUsage) {
+  ProfileBuffer buffer(/*max_size*/ 10, /*enabled*/ true);
+  auto op_handle = buffer.BeginEvent(
+      "op", ProfileEvent::EventType::OPERATOR_INVOKE_EVENT,
+      /*event_metadata1*/ 3, /*event_metadata2*/ 1);
+  auto delegate_op_handle = buffer.BeginEvent(
+      "delegate_op", ProfileEvent::EventType::DELEGATE_OPERATOR_INVOKE_EVENT,
+      /*event_metadata1*/ 3, /*event_metadata2*/ 1);
+  buffer.EndEvent(delegate_op_handle);
+  buffer.AddArenaUsage(/*event_metadata1*/ 3, /*event_metadata2*/ 1,
+                       /*arena_bytes*/ 1024, /*temporary_bytes*/ 256);
+  // No event of this node in this subgraph.
+  buffer.AddArenaUsage(/*event_metadata1*/ 3, /*event_metadata2*/ 0,
+                       /*arena_bytes*/ 1, /*temporary_bytes*/ 1);
+  buffer.EndEvent(op_handle);
+
+  auto events = GetProfileEvents(buffer);
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ(events[0]->arena_bytes, 1024);
+  EXPECT_EQ(events[0]->temporary_arena_bytes, 256);
+  EXPECT_EQ(events[1]->arena_bytes, 0);
+  EXPECT_EQ(events[1]->temporary_arena_bytes, 0);
+}
+
 TEST(ProfileBufferTest, OverFlow) {
   const int max_size = 4;
   ProfileBuffer buffer{max_size, true};
@@ -153,9 +153,10 @@ void ProfileSummarizer::ProcessProfiles(
       const auto node_name_in_stats =
           node_name + ":" + std::to_string(node_index);
 
+      // The memory of an op is the tensor arena in use while it ran.
       stats_calculator->AddNodeStats(node_name_in_stats, type_in_stats,
                                      node_num, start_us, node_exec_time,
-                                     0 /*memory */);
+                                     event->arena_bytes);
     } else if (event->event_type ==
                Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
       const std::string node_name(event->tag);
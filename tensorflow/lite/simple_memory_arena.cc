@@ -89,6 +89,18 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::AllocateAtOffset(
+    TfLiteContext* context, const ArenaAllocWithUsageInterval& alloc) {
+  if (alloc.size == 0) {
+    return kTfLiteOk;
+  }
+  high_water_mark_ = std::max(high_water_mark_, alloc.offset + alloc.size);
+  auto insertion_it =
+      std::upper_bound(ordered_allocs_.begin(), ordered_allocs_.end(), alloc);
+  ordered_allocs_.insert(insertion_it, alloc);
+  return kTfLiteOk;
+}
+
 TfLiteStatus SimpleMemoryArena::Deallocate(
     TfLiteContext* context, const ArenaAllocWithUsageInterval& alloc) {
   if (alloc.size == 0) {
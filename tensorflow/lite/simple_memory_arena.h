@@ -75,6 +75,12 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Schedules an allocation that Allocate() made for an earlier plan, at the
+  // same offset. The caller must make sure that it doesn't overlap with the
+  // allocations of the current plan.
+  TfLiteStatus AllocateAtOffset(TfLiteContext* context,
+                                const ArenaAllocWithUsageInterval& alloc);
+
   TfLiteStatus Deallocate(TfLiteContext* context,
                           const ArenaAllocWithUsageInterval& alloc);
 
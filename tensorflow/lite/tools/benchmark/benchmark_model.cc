@@ -15,8 +15,12 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/time.h"
@@ -34,6 +38,7 @@ BenchmarkParams BenchmarkModel::DefaultParams() {
   params.AddParam("max_secs", BenchmarkParam::Create<float>(150.0f));
   params.AddParam("run_delay", BenchmarkParam::Create<float>(-1.0f));
   params.AddParam("run_frequency", BenchmarkParam::Create<float>(-1.0f));
+  params.AddParam("request_rate", BenchmarkParam::Create<float>(-1.0f));
   params.AddParam("num_threads", BenchmarkParam::Create<int32_t>(-1));
   params.AddParam("use_caching", BenchmarkParam::Create<bool>(false));
   params.AddParam("benchmark_name", BenchmarkParam::Create<std::string>(""));
@@ -42,11 +47,24 @@ BenchmarkParams BenchmarkModel::DefaultParams() {
   params.AddParam("warmup_min_secs", BenchmarkParam::Create<float>(0.5f));
   params.AddParam("verbose", BenchmarkParam::Create<bool>(false));
   params.AddParam("dry_run", BenchmarkParam::Create<bool>(false));
+  params.AddParam("sustained_secs", BenchmarkParam::Create<float>(-1.0f));
+  params.AddParam("thermal_sampling_secs", BenchmarkParam::Create<float>(5.0f));
   return params;
 }
 
 BenchmarkModel::BenchmarkModel() : params_(DefaultParams()) {}
 
+int64_t BenchmarkResults::inference_time_percentile_us(
+    double percentile) const {
+  if (sorted_inference_times_us_.empty()) return -1;
+  // Nearest-rank percentile.
+  const int64_t num_runs = sorted_inference_times_us_.size();
+  const int64_t rank =
+      static_cast<int64_t>(std::ceil(percentile / 100.0 * num_runs));
+  const int64_t index = std::min(std::max<int64_t>(rank, 1), num_runs) - 1;
+  return sorted_inference_times_us_[index];
+}
+
 void BenchmarkLoggingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
   auto inference_us = results.inference_time_us();
   auto init_us = results.startup_latency_us();
@@ -58,6 +76,14 @@ void BenchmarkLoggingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
                    << "First inference: " << warmup_us.first() << ", "
                    << "Warmup (avg): " << warmup_us.avg() << ", "
                    << "Inference (avg): " << inference_us.avg();
+  if (results.inference_time_percentile_us(50) >= 0) {
+    TFLITE_LOG(INFO) << "Inference latency percentiles in us: "
+                     << "p50: " << results.inference_time_percentile_us(50)
+                     << ", p90: " << results.inference_time_percentile_us(90)
+                     << ", p99: " << results.inference_time_percentile_us(99)
+                     << ", p99.9: "
+                     << results.inference_time_percentile_us(99.9);
+  }
 
   if (!init_mem_usage.IsSupported()) return;
   TFLITE_LOG(INFO)
@@ -91,6 +117,12 @@ std::vector<Flag> BenchmarkModel::GetFlags() {
           "Note if the targeted rate per second cannot be reached, the "
           "benchmark would start the next run immediately, trying its best to "
           "catch up. If set, this will override run_delay."),
+      CreateFlag<float>(
+          "request_rate", &params_,
+          "Issue runs open-loop at this number of requests per second: each "
+          "run is due at a fixed time regardless of when the previous one "
+          "finished, and its latency includes the time it waited to start. If "
+          "set, this will override run_delay and run_frequency."),
       CreateFlag<int32_t>("num_threads", &params_, "number of threads"),
       CreateFlag<bool>(
           "use_caching", &params_,
@@ -117,6 +149,16 @@ std::vector<Flag> BenchmarkModel::GetFlags() {
                        "Whether to run the tool just with simply loading the "
                        "model, allocating tensors etc. but without actually "
                        "invoking any op kernels."),
+      CreateFlag<float>(
+          "sustained_secs", &params_,
+          "If positive, run the regular runs for exactly this number of "
+          "seconds, overriding min_secs and max_secs, and report the latency "
+          "over time next to the device temperature and CPU frequency to "
+          "detect thermal throttling."),
+      CreateFlag<float>(
+          "thermal_sampling_secs", &params_,
+          "interval in seconds at which latency and thermal state are sampled "
+          "when sustained_secs is set"),
   };
 }
 
@@ -132,6 +174,8 @@ void BenchmarkModel::LogParams() {
   LOG_BENCHMARK_PARAM(float, "run_delay", "Inter-run delay (seconds)", verbose);
   LOG_BENCHMARK_PARAM(float, "run_frequency",
                       "Number of prorated runs per second", verbose);
+  LOG_BENCHMARK_PARAM(float, "request_rate",
+                      "Open-loop requests per second", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "num_threads", "Num threads", verbose);
   LOG_BENCHMARK_PARAM(bool, "use_caching", "Use caching", verbose);
   LOG_BENCHMARK_PARAM(std::string, "benchmark_name", "Benchmark name", verbose);
@@ -140,6 +184,10 @@ void BenchmarkModel::LogParams() {
   LOG_BENCHMARK_PARAM(float, "warmup_min_secs",
                       "Min warmup runs duration (seconds)", verbose);
   LOG_BENCHMARK_PARAM(bool, "dry_run", "Run w/o invoking kernels", verbose);
+  LOG_BENCHMARK_PARAM(float, "sustained_secs",
+                      "Sustained runs duration (seconds)", verbose);
+  LOG_BENCHMARK_PARAM(float, "thermal_sampling_secs",
+                      "Thermal sampling interval (seconds)", verbose);
 }
 
 TfLiteStatus BenchmarkModel::PrepareInputData() { return kTfLiteOk; }
@@ -148,7 +196,8 @@ TfLiteStatus BenchmarkModel::ResetInputsAndOutputs() { return kTfLiteOk; }
 
 Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
                                   float max_secs, RunType run_type,
-                                  TfLiteStatus* invoke_status) {
+                                  TfLiteStatus* invoke_status,
+                                  std::vector<int64_t>* run_times_us) {
   Stat<int64_t> run_stats;
   TFLITE_LOG(INFO) << "Running benchmark for at least " << min_num_times
                    << " iterations and at least " << min_secs << " seconds but"
@@ -163,9 +212,21 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
   double manual_inter_run_gap = 1.0 / run_frequency;
   // float doesn't have sufficient precision for storing this number
   double next_run_finish_time = now_us * 1e-6 + manual_inter_run_gap;
+  const auto request_rate = params_.Get<float>("request_rate");
+  const double request_interval_us = 1e6 / request_rate;
+  const int64_t first_request_us = now_us;
   for (int run = 0; (run < min_num_times || now_us < min_finish_us) &&
                     now_us <= max_finish_us;
        run++) {
+    int64_t request_us = 0;
+    if (request_rate > 0) {
+      // A run that is late because the previous ones took too long starts
+      // right away, and the delay counts towards its latency.
+      request_us =
+          first_request_us + static_cast<int64_t>(run * request_interval_us);
+      util::SleepForSeconds((request_us - profiling::time::NowMicros()) *
+                            1e-6);
+    }
     ResetInputsAndOutputs();
     listeners_.OnSingleRunStart(run_type);
     int64_t start_us = profiling::time::NowMicros();
@@ -173,15 +234,22 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
     int64_t end_us = profiling::time::NowMicros();
     listeners_.OnSingleRunEnd();
 
-    run_stats.UpdateStat(end_us - start_us);
-    if (run_frequency > 0) {
-      inter_run_sleep_time =
-          next_run_finish_time - profiling::time::NowMicros() * 1e-6;
-      next_run_finish_time += manual_inter_run_gap;
+    const int64_t latency_us =
+        end_us - (request_rate > 0 ? request_us : start_us);
+    run_stats.UpdateStat(latency_us);
+    if (run_times_us) {
+      run_times_us->push_back(latency_us);
+    }
+    if (request_rate <= 0) {
+      if (run_frequency > 0) {
+        inter_run_sleep_time =
+            next_run_finish_time - profiling::time::NowMicros() * 1e-6;
+        next_run_finish_time += manual_inter_run_gap;
+      }
+      // Note when "inter_run_sleep_time" is negative or 0.0,
+      // the function will return immediately.
+      util::SleepForSeconds(inter_run_sleep_time);
     }
-    // Note when "inter_run_sleep_time" is negative or 0.0,
-    // the function will return immediately.
-    util::SleepForSeconds(inter_run_sleep_time);
     now_us = profiling::time::NowMicros();
 
     if (status != kTfLiteOk) {
@@ -236,24 +304,32 @@ TfLiteStatus BenchmarkModel::Run() {
     params_.Set("min_secs", -1.0f);
   }
 
+  const float sustained_secs = params_.Get<float>("sustained_secs");
+  if (sustained_secs > 0) {
+    params_.Set("min_secs", sustained_secs);
+    params_.Set("max_secs", sustained_secs);
+  }
+
   listeners_.OnBenchmarkStart(params_);
   Stat<int64_t> warmup_time_us =
       Run(params_.Get<int32_t>("warmup_runs"),
           params_.Get<float>("warmup_min_secs"), params_.Get<float>("max_secs"),
-          WARMUP, &status);
+          WARMUP, &status, /*run_times_us=*/nullptr);
   if (status != kTfLiteOk) {
     return status;
   }
 
+  std::vector<int64_t> inference_times_us;
   Stat<int64_t> inference_time_us =
       Run(params_.Get<int32_t>("num_runs"), params_.Get<float>("min_secs"),
-          params_.Get<float>("max_secs"), REGULAR, &status);
+          params_.Get<float>("max_secs"), REGULAR, &status,
+          &inference_times_us);
   const auto overall_mem_usage =
       profiling::memory::GetMemoryUsage() - start_mem_usage;
 
   listeners_.OnBenchmarkEnd({model_size_mb, startup_latency_us, input_bytes,
                              warmup_time_us, inference_time_us, init_mem_usage,
-                             overall_mem_usage});
+                             overall_mem_usage, std::move(inference_times_us)});
   return status;
 }
 
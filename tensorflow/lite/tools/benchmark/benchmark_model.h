@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MODEL_H_
 #define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MODEL_H_
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <limits>
@@ -46,20 +47,28 @@ class BenchmarkResults {
                    tensorflow::Stat<int64_t> warmup_time_us,
                    tensorflow::Stat<int64_t> inference_time_us,
                    const profiling::memory::MemoryUsage& init_mem_usage,
-                   const profiling::memory::MemoryUsage& overall_mem_usage)
+                   const profiling::memory::MemoryUsage& overall_mem_usage,
+                   std::vector<int64_t> inference_times_us = {})
       : model_size_mb_(model_size_mb),
         startup_latency_us_(startup_latency_us),
         input_bytes_(input_bytes),
         warmup_time_us_(warmup_time_us),
         inference_time_us_(inference_time_us),
         init_mem_usage_(init_mem_usage),
-        overall_mem_usage_(overall_mem_usage) {}
+        overall_mem_usage_(overall_mem_usage),
+        sorted_inference_times_us_(std::move(inference_times_us)) {
+    std::sort(sorted_inference_times_us_.begin(),
+              sorted_inference_times_us_.end());
+  }
 
   const double model_size_mb() const { return model_size_mb_; }
   tensorflow::Stat<int64_t> inference_time_us() const {
     return inference_time_us_;
   }
   tensorflow::Stat<int64_t> warmup_time_us() const { return warmup_time_us_; }
+  // Returns the latency in microseconds that 'percentile' percent of the
+  // inference runs did not exceed, or -1 if the runs were not recorded.
+  int64_t inference_time_percentile_us(double percentile) const;
   int64_t startup_latency_us() const { return startup_latency_us_; }
   uint64_t input_bytes() const { return input_bytes_; }
   double throughput_MB_per_second() const {
@@ -83,6 +92,7 @@ class BenchmarkResults {
   tensorflow::Stat<int64_t> inference_time_us_;
   profiling::memory::MemoryUsage init_mem_usage_;
   profiling::memory::MemoryUsage overall_mem_usage_;
+  std::vector<int64_t> sorted_inference_times_us_;
 };
 
 class BenchmarkListener {
@@ -206,9 +216,12 @@ class BenchmarkModel {
   // Get the model file size if it's available.
   virtual int64_t MayGetModelFileSize() { return -1; }
   virtual uint64_t ComputeInputBytes() = 0;
+  // Latencies of the individual runs are appended to 'run_times_us' if it is
+  // not null.
   virtual tensorflow::Stat<int64_t> Run(int min_num_times, float min_secs,
                                         float max_secs, RunType run_type,
-                                        TfLiteStatus* invoke_status);
+                                        TfLiteStatus* invoke_status,
+                                        std::vector<int64_t>* run_times_us);
   // Prepares input data for benchmark. This can be used to initialize input
   // data that has non-trivial cost.
   virtual TfLiteStatus PrepareInputData();
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_params.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/benchmark/thermal_listener.h"
 #include "tensorflow/lite/tools/command_line_flags.h"
 #include "tensorflow/lite/tools/logging.h"
 
@@ -131,6 +132,7 @@ BenchmarkParams BenchmarkPerformanceOptions::DefaultParams() {
                   BenchmarkParam::Create<float>(-1.0f));
   params.AddParam("random_shuffle_benchmark_runs",
                   BenchmarkParam::Create<bool>(true));
+  params.AddParam("option_cooldown_temp", BenchmarkParam::Create<float>(-1.0f));
   return params;
 }
 
@@ -149,6 +151,12 @@ std::vector<Flag> BenchmarkPerformanceOptions::GetFlags() {
           "random_shuffle_benchmark_runs", &params_,
           "Whether to perform all benchmark runs, each of which has different "
           "performance options, in a random order. It is enabled by default."),
+      CreateFlag<float>(
+          "option_cooldown_temp", &params_,
+          "If positive, wait before each run of a performance option until "
+          "the device cooled down to this temperature in degrees Celsius, so "
+          "that a run does not start on a device heated by the previous ones. "
+          "This is most useful together with --sustained_secs."),
   };
 }
 
@@ -347,6 +355,7 @@ void BenchmarkPerformanceOptions::Run() {
       single_option_run_params_->Set(run_params);
     }
     util::SleepForSeconds(params_.Get<float>("option_benchmark_run_delay"));
+    WaitForCooldown();
 
     // Clear internally created listeners before each run but keep externally
     // created ones.
@@ -359,6 +368,28 @@ void BenchmarkPerformanceOptions::Run() {
   all_run_stats_->OutputStats();
 }
 
+void BenchmarkPerformanceOptions::WaitForCooldown() {
+  // Gives up eventually, in case the temperature can't get that low, e.g.
+  // because of the ambient temperature.
+  constexpr float kMaxCooldownSecs = 600.0f;
+  constexpr float kPollingSecs = 1.0f;
+  const float max_temp = params_.Get<float>("option_cooldown_temp");
+  if (max_temp <= 0) return;
+  float temp = ReadThermalState().max_temp_celsius;
+  if (temp < 0) return;
+  float waited_secs = 0;
+  while (temp > max_temp && waited_secs < kMaxCooldownSecs) {
+    util::SleepForSeconds(kPollingSecs);
+    waited_secs += kPollingSecs;
+    temp = ReadThermalState().max_temp_celsius;
+  }
+  if (waited_secs > 0) {
+    TFLITE_LOG(INFO) << "Waited " << waited_secs
+                     << " seconds for the device to cool down to " << temp
+                     << " C.";
+  }
+}
+
 void BenchmarkPerformanceOptions::Run(int argc, char** argv) {
   // Parse flags that are supported by this particular binary first.
   if (!ParseFlags(&argc, argv)) return;
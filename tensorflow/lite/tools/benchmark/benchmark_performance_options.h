@@ -107,6 +107,9 @@ class BenchmarkPerformanceOptions {
   virtual void ResetPerformanceOptions();
   virtual void CreatePerformanceOptions();
 
+  // Blocks until the device is not hotter than --option_cooldown_temp.
+  void WaitForCooldown();
+
   BenchmarkParams params_;
   std::vector<std::string> perf_options_;
 
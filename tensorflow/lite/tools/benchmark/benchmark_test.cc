@@ -392,6 +392,36 @@ TEST(BenchmarkTest, MaxDurationWorks) {
   benchmark.Run();
 }
 
+class PercentilesTestListener : public BenchmarkListener {
+ public:
+  void OnBenchmarkEnd(const BenchmarkResults& results) override {
+    const auto inference_us = results.inference_time_us();
+    EXPECT_EQ(results.inference_time_percentile_us(0), inference_us.min());
+    EXPECT_LE(results.inference_time_percentile_us(50),
+              results.inference_time_percentile_us(99));
+    EXPECT_EQ(results.inference_time_percentile_us(100), inference_us.max());
+    called_ = true;
+  }
+  bool called_ = false;
+};
+
+TEST(BenchmarkTest, ReportsLatencyPercentiles) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  TestBenchmark benchmark(CreateFp32Params());
+  PercentilesTestListener listener;
+  benchmark.AddListener(&listener);
+  ScopedCommandlineArgs scoped_argv({"--request_rate=1000"});
+  EXPECT_EQ(kTfLiteOk, benchmark.Run(scoped_argv.argc(), scoped_argv.argv()));
+  EXPECT_TRUE(listener.called_);
+}
+
+TEST(BenchmarkTest, DoesntCrashWithConcurrentInterpreters) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  TestBenchmark benchmark(CreateFp32Params());
+  ScopedCommandlineArgs scoped_argv({"--num_concurrent_interpreters=3"});
+  EXPECT_EQ(kTfLiteOk, benchmark.Run(scoped_argv.argc(), scoped_argv.argv()));
+}
+
 TEST(BenchmarkTest, ParametersArePopulatedWhenInputShapeIsNotSpecified) {
   ASSERT_THAT(g_fp32_model_path, testing::NotNull());
 
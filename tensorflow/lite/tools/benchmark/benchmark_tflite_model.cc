@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
 
+#include <atomic>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdlib>
@@ -23,6 +24,7 @@ limitations under the License.
 #include <memory>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_set>
 #include <vector>
 
@@ -40,6 +42,7 @@ limitations under the License.
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
+#include "tensorflow/lite/tools/benchmark/thermal_listener.h"
 #include "tensorflow/lite/tools/delegates/delegate_provider.h"
 #include "tensorflow/lite/tools/logging.h"
 
@@ -280,6 +283,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
   default_params.AddParam("allow_fp16", BenchmarkParam::Create<bool>(false));
   default_params.AddParam("require_full_delegation",
                           BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("num_concurrent_interpreters",
+                          BenchmarkParam::Create<int32_t>(1));
   default_params.AddParam(
       "enable_op_profiling",
       BenchmarkParam::Create<bool>(kOpProfilingEnabledDefault));
@@ -313,8 +318,9 @@ void BenchmarkTfLiteModel::CleanUp() {
 BenchmarkTfLiteModel::~BenchmarkTfLiteModel() {
   CleanUp();
 
-  // Destory the owned interpreter earlier than other objects (specially
+  // Destory the owned interpreters earlier than other objects (specially
   // 'owned_delegates_').
+  concurrent_interpreters_.clear();
   interpreter_.reset();
 }
 
@@ -344,6 +350,11 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
       CreateFlag<bool>("allow_fp16", &params_, "allow fp16"),
       CreateFlag<bool>("require_full_delegation", &params_,
                        "require delegate to run the entire graph"),
+      CreateFlag<int32_t>(
+          "num_concurrent_interpreters", &params_,
+          "number of interpreters of the model to run concurrently. Only the "
+          "first one is measured, the others are invoked back-to-back in "
+          "background threads to measure the interference between them."),
       CreateFlag<bool>("enable_op_profiling", &params_, "enable op profiling"),
       CreateFlag<int32_t>("max_profiling_buffer_entries", &params_,
                           "max profiling buffer entries"),
@@ -385,6 +396,8 @@ void BenchmarkTfLiteModel::LogParams() {
   LOG_BENCHMARK_PARAM(bool, "allow_fp16", "Allow fp16", verbose);
   LOG_BENCHMARK_PARAM(bool, "require_full_delegation",
                       "Require full delegation", verbose);
+  LOG_BENCHMARK_PARAM(int32_t, "num_concurrent_interpreters",
+                      "Num concurrent interpreters", verbose);
   LOG_BENCHMARK_PARAM(bool, "enable_op_profiling", "Enable op profiling",
                       verbose);
   LOG_BENCHMARK_PARAM(int32_t, "max_profiling_buffer_entries",
@@ -605,11 +618,16 @@ TfLiteStatus BenchmarkTfLiteModel::PrepareInputData() {
 }
 
 TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
-  auto interpreter_inputs = interpreter_->inputs();
+  FillInputTensors(interpreter_.get());
+  return kTfLiteOk;
+}
+
+void BenchmarkTfLiteModel::FillInputTensors(tflite::Interpreter* interpreter) {
+  auto interpreter_inputs = interpreter->inputs();
   // Set the values of the input tensors from inputs_data_.
   for (int j = 0; j < interpreter_inputs.size(); ++j) {
     int i = interpreter_inputs[j];
-    TfLiteTensor* t = interpreter_->tensor(i);
+    TfLiteTensor* t = interpreter->tensor(i);
     if (t->type == kTfLiteString) {
       if (inputs_data_[j].data) {
         static_cast<DynamicBuffer*>(inputs_data_[j].data.get())
@@ -627,8 +645,39 @@ TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
                   inputs_data_[j].bytes);
     }
   }
+}
 
-  return kTfLiteOk;
+tensorflow::Stat<int64_t> BenchmarkTfLiteModel::Run(
+    int min_num_times, float min_secs, float max_secs, RunType run_type,
+    TfLiteStatus* invoke_status, std::vector<int64_t>* run_times_us) {
+  if (concurrent_interpreters_.empty()) {
+    return BenchmarkModel::Run(min_num_times, min_secs, max_secs, run_type,
+                               invoke_status, run_times_us);
+  }
+  std::atomic<bool> done(false);
+  std::atomic<int64_t> num_concurrent_runs(0);
+  std::vector<std::thread> threads;
+  for (auto& interpreter : concurrent_interpreters_) {
+    FillInputTensors(interpreter.get());
+    tflite::Interpreter* concurrent_interpreter = interpreter.get();
+    threads.emplace_back([concurrent_interpreter, &done,
+                          &num_concurrent_runs]() {
+      while (!done && concurrent_interpreter->Invoke() == kTfLiteOk) {
+        ++num_concurrent_runs;
+      }
+    });
+  }
+  tensorflow::Stat<int64_t> run_stats =
+      BenchmarkModel::Run(min_num_times, min_secs, max_secs, run_type,
+                          invoke_status, run_times_us);
+  done = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  TFLITE_LOG(INFO) << "The " << concurrent_interpreters_.size()
+                   << " concurrent interpreters ran " << num_concurrent_runs
+                   << " times meanwhile.";
+  return run_stats;
 }
 
 TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
@@ -678,6 +727,12 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
   profiling_listener_ = MayCreateProfilingListener();
   if (profiling_listener_) AddListener(profiling_listener_.get());
 
+  if (params_.Get<float>("sustained_secs") > 0) {
+    thermal_listener_.reset(
+        new ThermalListener(params_.Get<float>("thermal_sampling_secs")));
+    AddListener(thermal_listener_.get());
+  }
+
   interpreter_state_printer_ = std::unique_ptr<BenchmarkListener>(
       new InterpreterStatePrinter(interpreter_.get()));
   AddListener(interpreter_state_printer_.get());
@@ -793,12 +848,65 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
     return kTfLiteError;
   }
 
+  TF_LITE_ENSURE_STATUS(InitConcurrentInterpreters());
+
   ruy_profiling_listener_.reset(new RuyProfileListener());
   AddListener(ruy_profiling_listener_.get());
 
   return kTfLiteOk;
 }
 
+TfLiteStatus BenchmarkTfLiteModel::InitConcurrentInterpreters() {
+  concurrent_interpreters_.clear();
+  concurrent_delegates_.clear();
+  const int32_t num_interpreters =
+      params_.Get<int32_t>("num_concurrent_interpreters");
+  if (num_interpreters <= 1) return kTfLiteOk;
+
+  auto resolver = GetOpResolver();
+  const int32_t num_threads = params_.Get<int32_t>("num_threads");
+  for (int i = 1; i < num_interpreters; ++i) {
+    std::unique_ptr<tflite::Interpreter> interpreter;
+    tflite::InterpreterBuilder(*model_, *resolver)(&interpreter, num_threads);
+    if (!interpreter) {
+      TFLITE_LOG(ERROR) << "Failed to initialize concurrent interpreter #" << i;
+      return kTfLiteError;
+    }
+    interpreter->SetAllowFp16PrecisionForFp32(
+        params_.Get<bool>("allow_fp16"));
+
+    tools::ProvidedDelegateList delegate_providers(&params_);
+    for (auto& created_delegate :
+         delegate_providers.CreateAllRankedDelegates()) {
+      if (interpreter->ModifyGraphWithDelegate(
+              created_delegate.delegate.get()) != kTfLiteOk) {
+        TFLITE_LOG(ERROR) << "Failed to apply "
+                          << created_delegate.provider->GetName()
+                          << " delegate to concurrent interpreter #" << i;
+        return kTfLiteError;
+      }
+      concurrent_delegates_.emplace_back(std::move(created_delegate.delegate));
+    }
+
+    // Use the same input shapes as interpreter_.
+    for (int j = 0; j < interpreter->inputs().size(); ++j) {
+      const TfLiteTensor* t = interpreter_->input_tensor(j);
+      if (t->type != kTfLiteString) {
+        interpreter->ResizeInputTensor(
+            interpreter->inputs()[j],
+            std::vector<int>(t->dims->data, t->dims->data + t->dims->size));
+      }
+    }
+    if (interpreter->AllocateTensors() != kTfLiteOk) {
+      TFLITE_LOG(ERROR)
+          << "Failed to allocate tensors of concurrent interpreter #" << i;
+      return kTfLiteError;
+    }
+    concurrent_interpreters_.push_back(std::move(interpreter));
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus BenchmarkTfLiteModel::LoadModel() {
   std::string graph = params_.Get<std::string>("graph");
   model_ = tflite::FlatBufferModel::BuildFromFile(graph.c_str());
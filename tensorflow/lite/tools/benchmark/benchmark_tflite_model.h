@@ -63,9 +63,16 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   TfLiteStatus RunImpl() override;
   static BenchmarkParams DefaultParams();
 
+  using BenchmarkModel::Run;
+
  protected:
   TfLiteStatus PrepareInputData() override;
   TfLiteStatus ResetInputsAndOutputs() override;
+  // Keeps the concurrent interpreters, if any, busy during the runs.
+  tensorflow::Stat<int64_t> Run(int min_num_times, float min_secs,
+                                float max_secs, RunType run_type,
+                                TfLiteStatus* invoke_status,
+                                std::vector<int64_t>* run_times_us) override;
 
   int64_t MayGetModelFileSize() override;
 
@@ -118,13 +125,25 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   InputTensorData LoadInputTensorData(const TfLiteTensor& t,
                                       const std::string& input_file_path);
 
+  // Copies inputs_data_ into the input tensors of 'interpreter'.
+  void FillInputTensors(tflite::Interpreter* interpreter);
+
+  // Creates the interpreters that run alongside interpreter_, as requested by
+  // --num_concurrent_interpreters.
+  TfLiteStatus InitConcurrentInterpreters();
+
   std::vector<InputLayerInfo> inputs_;
   std::vector<InputTensorData> inputs_data_;
   std::unique_ptr<BenchmarkListener> profiling_listener_ = nullptr;
   std::unique_ptr<BenchmarkListener> ruy_profiling_listener_ = nullptr;
   std::unique_ptr<BenchmarkListener> interpreter_state_printer_ = nullptr;
+  std::unique_ptr<BenchmarkListener> thermal_listener_ = nullptr;
   std::mt19937 random_engine_;
   std::vector<Interpreter::TfLiteDelegatePtr> owned_delegates_;
+  // Interpreters of the same model, each with its own delegates, that are
+  // invoked back-to-back in background threads while interpreter_ is measured.
+  std::vector<Interpreter::TfLiteDelegatePtr> concurrent_delegates_;
+  std::vector<std::unique_ptr<tflite::Interpreter>> concurrent_interpreters_;
   // Always TFLITE_LOG the benchmark result.
   BenchmarkLoggingListener log_output_;
 };
@@ -0,0 +1,174 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/thermal_listener.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Upper bound of the thermal zone and CPU indices probed in sysfs. Indices
+// may have holes, e.g. for offline CPUs, so probing does not stop at the
+// first missing one.
+constexpr int kMaxSysfsIndex = 64;
+
+// A CPU frequency below this fraction of its peak means the device throttled.
+constexpr double kThrottledFreqRatio = 0.9;
+// A steady state latency above this multiple of the first window's latency
+// means the device throttled.
+constexpr double kThrottledSlowdown = 1.1;
+
+bool ReadInt64FromFile(const std::string& path, int64_t* value) {
+  std::ifstream file(path);
+  return static_cast<bool>(file >> *value);
+}
+
+}  // namespace
+
+ThermalState ReadThermalState() {
+  ThermalState state;
+  for (int i = 0; i < kMaxSysfsIndex; ++i) {
+    int64_t temp;
+    if (!ReadInt64FromFile(
+            "/sys/class/thermal/thermal_zone" + std::to_string(i) + "/temp",
+            &temp)) {
+      continue;
+    }
+    // Most zones report millidegrees, but some report degrees.
+    const float temp_celsius = temp > 1000 ? temp / 1000.0f : temp;
+    state.max_temp_celsius = std::max(state.max_temp_celsius, temp_celsius);
+  }
+  for (int i = 0; i < kMaxSysfsIndex; ++i) {
+    int64_t freq_khz;
+    if (ReadInt64FromFile("/sys/devices/system/cpu/cpu" + std::to_string(i) +
+                              "/cpufreq/scaling_cur_freq",
+                          &freq_khz)) {
+      state.max_cpu_freq_khz = std::max(state.max_cpu_freq_khz, freq_khz);
+    }
+  }
+  return state;
+}
+
+ThermalListener::ThermalListener(float sampling_secs,
+                                 std::function<ThermalState()> read_state)
+    : sampling_us_(static_cast<int64_t>(sampling_secs * 1e6)),
+      read_state_(std::move(read_state)) {}
+
+void ThermalListener::OnBenchmarkStart(const BenchmarkParams& params) {
+  initial_state_ = read_state_();
+  windows_.clear();
+  current_ = Window();
+  first_run_us_ = -1;
+  run_start_us_ = -1;
+}
+
+void ThermalListener::OnSingleRunStart(RunType run_type) {
+  if (run_type != REGULAR) return;
+  run_start_us_ = profiling::time::NowMicros();
+  if (first_run_us_ < 0) first_run_us_ = run_start_us_;
+}
+
+void ThermalListener::OnSingleRunEnd() {
+  if (run_start_us_ < 0) return;
+  const int64_t now_us = profiling::time::NowMicros();
+  ++current_.num_runs;
+  current_.total_latency_us += now_us - run_start_us_;
+  run_start_us_ = -1;
+  if (now_us - first_run_us_ - current_.start_us >= sampling_us_) {
+    CloseWindow(now_us);
+  }
+}
+
+void ThermalListener::CloseWindow(int64_t now_us) {
+  current_.state = read_state_();
+  windows_.push_back(current_);
+  current_ = Window();
+  current_.start_us = now_us - first_run_us_;
+}
+
+int ThermalListener::FirstSteadyStateWindow() const {
+  const int num_windows = windows_.size();
+  return num_windows - std::max(1, num_windows / 4);
+}
+
+double ThermalListener::steady_state_latency_us() const {
+  if (windows_.empty()) return 0.0;
+  int64_t num_runs = 0;
+  int64_t total_latency_us = 0;
+  const int num_windows = windows_.size();
+  for (int i = FirstSteadyStateWindow(); i < num_windows; ++i) {
+    num_runs += windows_[i].num_runs;
+    total_latency_us += windows_[i].total_latency_us;
+  }
+  return num_runs > 0 ? static_cast<double>(total_latency_us) / num_runs : 0.0;
+}
+
+bool ThermalListener::throttled() const {
+  if (windows_.empty()) return false;
+  int64_t peak_freq_khz = initial_state_.max_cpu_freq_khz;
+  for (const Window& window : windows_) {
+    peak_freq_khz = std::max(peak_freq_khz, window.state.max_cpu_freq_khz);
+  }
+  const int64_t final_freq_khz = windows_.back().state.max_cpu_freq_khz;
+  if (peak_freq_khz > 0 && final_freq_khz >= 0 &&
+      final_freq_khz < kThrottledFreqRatio * peak_freq_khz) {
+    return true;
+  }
+  const double first_latency_us = windows_.front().avg_latency_us();
+  return windows_.size() > 1 && first_latency_us > 0 &&
+         steady_state_latency_us() > kThrottledSlowdown * first_latency_us;
+}
+
+void ThermalListener::OnBenchmarkEnd(const BenchmarkResults& results) {
+  if (current_.num_runs > 0) CloseWindow(profiling::time::NowMicros());
+  if (windows_.empty()) return;
+
+  TFLITE_LOG(INFO) << "Latency and thermal state over time (initial: "
+                   << initial_state_.max_temp_celsius << " C, "
+                   << initial_state_.max_cpu_freq_khz / 1000 << " MHz):";
+  for (const Window& window : windows_) {
+    TFLITE_LOG(INFO) << "  t=" << window.start_us / 1e6
+                     << "s runs=" << window.num_runs
+                     << " avg=" << window.avg_latency_us() << "us"
+                     << " temp=" << window.state.max_temp_celsius << "C"
+                     << " cpu_freq=" << window.state.max_cpu_freq_khz / 1000
+                     << "MHz";
+  }
+  const double first_latency_us = windows_.front().avg_latency_us();
+  const double steady_latency_us = steady_state_latency_us();
+  TFLITE_LOG(INFO) << "Sustained latency in us: first window avg: "
+                   << first_latency_us
+                   << ", steady state avg: " << steady_latency_us << " ("
+                   << (first_latency_us > 0
+                           ? steady_latency_us / first_latency_us
+                           : 0.0)
+                   << "x)";
+  if (throttled()) {
+    TFLITE_LOG(WARN) << "Thermal throttling detected, use the steady state "
+                        "latency rather than the average for sustained "
+                        "workloads.";
+  }
+}
+
+}  // namespace benchmark
+}  // namespace tflite
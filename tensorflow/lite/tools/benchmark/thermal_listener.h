@@ -0,0 +1,99 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_THERMAL_LISTENER_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_THERMAL_LISTENER_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+
+namespace tflite {
+namespace benchmark {
+
+// Thermal state of the device as read from sysfs. Values are negative if they
+// are not available, e.g. on platforms other than Linux and Android.
+struct ThermalState {
+  // Highest temperature over all thermal zones, in degrees Celsius.
+  float max_temp_celsius = -1.0f;
+  // Highest current frequency over all online CPUs, in kHz.
+  int64_t max_cpu_freq_khz = -1;
+};
+
+ThermalState ReadThermalState();
+
+// Records the latency of regular runs over time next to the thermal state of
+// the device, and reports whether the device throttled during the benchmark.
+// On phones the latency of a sustained workload is often much higher than
+// the latency of the first minute, so this is meant for long runs, see
+// --sustained_secs.
+class ThermalListener : public BenchmarkListener {
+ public:
+  // The latency and thermal state are sampled every 'sampling_secs' seconds.
+  explicit ThermalListener(
+      float sampling_secs,
+      std::function<ThermalState()> read_state = ReadThermalState);
+
+  void OnBenchmarkStart(const BenchmarkParams& params) override;
+
+  void OnSingleRunStart(RunType run_type) override;
+
+  void OnSingleRunEnd() override;
+
+  void OnBenchmarkEnd(const BenchmarkResults& results) override;
+
+  struct Window {
+    // Start of the window, relative to the first regular run.
+    int64_t start_us = 0;
+    int64_t num_runs = 0;
+    int64_t total_latency_us = 0;
+    // Thermal state at the end of the window.
+    ThermalState state;
+
+    double avg_latency_us() const {
+      return num_runs > 0 ? static_cast<double>(total_latency_us) / num_runs
+                          : 0.0;
+    }
+  };
+  const std::vector<Window>& windows() const { return windows_; }
+
+  // Average latency over the last quarter of the windows, when the device
+  // has settled into its sustained (possibly throttled) performance.
+  double steady_state_latency_us() const;
+
+  // True if the CPU frequency at the end of the run dropped noticeably below
+  // its peak, or if the steady state latency is noticeably higher than the
+  // latency of the first window.
+  bool throttled() const;
+
+ private:
+  void CloseWindow(int64_t now_us);
+  int FirstSteadyStateWindow() const;
+
+  const int64_t sampling_us_;
+  const std::function<ThermalState()> read_state_;
+  ThermalState initial_state_;
+  std::vector<Window> windows_;
+  Window current_;
+  int64_t first_run_us_ = -1;
+  int64_t run_start_us_ = -1;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_THERMAL_LISTENER_H_
@@ -0,0 +1,81 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/thermal_listener.h"
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Runs 'num_runs' regular runs with one window per run.
+void RunBenchmark(ThermalListener* listener, int num_runs) {
+  listener->OnBenchmarkStart(BenchmarkParams());
+  listener->OnSingleRunStart(WARMUP);
+  listener->OnSingleRunEnd();
+  for (int i = 0; i < num_runs; ++i) {
+    listener->OnSingleRunStart(REGULAR);
+    listener->OnSingleRunEnd();
+  }
+  listener->OnBenchmarkEnd(BenchmarkResults());
+}
+
+TEST(ThermalListenerTest, RecordsWindows) {
+  int num_reads = 0;
+  ThermalListener listener(/*sampling_secs=*/0.0f, [&num_reads]() {
+    ++num_reads;
+    return ThermalState();
+  });
+  RunBenchmark(&listener, 8);
+
+  // Warmup runs are not recorded.
+  ASSERT_EQ(listener.windows().size(), 8);
+  for (const auto& window : listener.windows()) {
+    EXPECT_EQ(window.num_runs, 1);
+  }
+  // Once at the start and once per window.
+  EXPECT_EQ(num_reads, 9);
+}
+
+TEST(ThermalListenerTest, DetectsFrequencyDrop) {
+  int64_t freq_khz = 2000000;
+  ThermalListener listener(/*sampling_secs=*/0.0f, [&freq_khz]() {
+    ThermalState state;
+    state.max_temp_celsius = 40.0f;
+    state.max_cpu_freq_khz = freq_khz;
+    freq_khz -= 100000;
+    return state;
+  });
+  RunBenchmark(&listener, 8);
+
+  ASSERT_EQ(listener.windows().size(), 8);
+  EXPECT_EQ(listener.windows().back().state.max_cpu_freq_khz, 1200000);
+  EXPECT_TRUE(listener.throttled());
+}
+
+TEST(ThermalListenerTest, NoRegularRuns) {
+  ThermalListener listener(/*sampling_secs=*/1.0f);
+  RunBenchmark(&listener, 0);
+
+  EXPECT_TRUE(listener.windows().empty());
+  EXPECT_EQ(listener.steady_state_latency_us(), 0.0);
+  EXPECT_FALSE(listener.throttled());
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,80 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Binary that writes a copy of a TFLite model with arena offsets planned
+// offline for its tensors, which the interpreter then uses instead of planning
+// them at runtime.
+#include <fstream>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/stderr_reporter.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/offline_memory_planner/offline_memory_planner.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+
+constexpr char kInputFlatbufferFlag[] = "input_flatbuffer";
+constexpr char kOutputFlatbufferFlag[] = "output_flatbuffer";
+constexpr char kAlignmentFlag[] = "alignment";
+
+int Main(int argc, char* argv[]) {
+  std::string input_flatbuffer_path;
+  std::string output_flatbuffer_path;
+  int32_t alignment = kDefaultTensorAlignment;
+
+  std::vector<Flag> flag_list = {
+      tflite::Flag::CreateFlag(kInputFlatbufferFlag, &input_flatbuffer_path,
+                               "Path to input TFLite flatbuffer."),
+      tflite::Flag::CreateFlag(kOutputFlatbufferFlag, &output_flatbuffer_path,
+                               "Path to output TFLite flatbuffer."),
+      tflite::Flag::CreateFlag(kAlignmentFlag, &alignment,
+                               "Alignment of the planned offsets, which must "
+                               "be a multiple of the tensor alignment of the "
+                               "interpreter."),
+  };
+  if (!Flags::Parse(&argc, const_cast<const char**>(argv), flag_list) ||
+      input_flatbuffer_path.empty() || output_flatbuffer_path.empty() ||
+      alignment <= 0) {
+    LOG(ERROR) << Flags::Usage(argv[0], flag_list);
+    return 1;
+  }
+
+  auto input_model =
+      FlatBufferModel::BuildFromFile(input_flatbuffer_path.c_str());
+  if (!input_model) {
+    LOG(ERROR) << "Could not read " << input_flatbuffer_path;
+    return 1;
+  }
+
+  std::string output_model_content;
+  if (AddOfflineMemoryPlan(input_model->GetModel(), alignment,
+                           DefaultErrorReporter(),
+                           &output_model_content) != kTfLiteOk) {
+    return 1;
+  }
+
+  std::ofstream output_file_stream(output_flatbuffer_path);
+  output_file_stream << output_model_content;
+  output_file_stream.close();
+  return 0;
+}
+
+}  // namespace tflite
+
+int main(int argc, char* argv[]) { return tflite::Main(argc, argv); }
@@ -0,0 +1,338 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/offline_memory_planner/offline_memory_planner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/core/api/flatbuffer_conversions.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+
+namespace {
+
+// Must match the name, version and header of the metadata read by the
+// InterpreterBuilder.
+constexpr char kOfflineMemoryAllocationMetadataName[] =
+    "OfflineMemoryAllocation";
+constexpr int32_t kOfflineMemoryAllocationVersion = 1;
+constexpr int kOfflineMemoryAllocationHeaderSize = 3;
+
+// The last op of the buffers that are never deallocated.
+constexpr int kEndOfInference = std::numeric_limits<int>::max();
+
+// The number of buffer pairs that the search may compare for overlaps, over
+// all the placements it tries.
+constexpr int64_t kSearchBudget = int64_t{1} << 28;
+
+size_t AlignTo(size_t alignment, size_t offset) {
+  return offset % alignment == 0 ? offset
+                                 : offset + (alignment - offset % alignment);
+}
+
+// Places `buffers` in `order`, each in the smallest gap that fits between the
+// buffers placed before it whose usage interval intersects its own. Returns
+// the size of the arena.
+size_t PlaceBuffers(const std::vector<BufferRequirement>& buffers,
+                    const std::vector<int>& order, size_t alignment,
+                    std::vector<size_t>* offsets) {
+  offsets->assign(buffers.size(), 0);
+  // The buffers placed so far, ordered by offset.
+  std::vector<int> placed;
+  placed.reserve(buffers.size());
+  size_t arena_size = 0;
+  for (int i : order) {
+    const BufferRequirement& buffer = buffers[i];
+    if (buffer.size == 0) continue;
+    const size_t kOffsetNotAssigned = std::numeric_limits<size_t>::max();
+    size_t best_offset = kOffsetNotAssigned;
+    size_t best_offset_fit = kOffsetNotAssigned;
+    size_t current_offset = 0;
+    for (int j : placed) {
+      const BufferRequirement& other = buffers[j];
+      if (other.last_op < buffer.first_op || other.first_op > buffer.last_op) {
+        continue;
+      }
+      const size_t aligned_current_offset = AlignTo(alignment, current_offset);
+      if (aligned_current_offset + buffer.size <= (*offsets)[j] &&
+          (*offsets)[j] - aligned_current_offset < best_offset_fit) {
+        best_offset = aligned_current_offset;
+        best_offset_fit = (*offsets)[j] - aligned_current_offset;
+      }
+      current_offset = std::max(current_offset, (*offsets)[j] + other.size);
+    }
+    if (best_offset == kOffsetNotAssigned) {
+      best_offset = AlignTo(alignment, current_offset);
+    }
+    (*offsets)[i] = best_offset;
+    arena_size = std::max(arena_size, best_offset + buffer.size);
+    placed.insert(std::upper_bound(placed.begin(), placed.end(), best_offset,
+                                   [offsets](size_t offset, int j) {
+                                     return offset < (*offsets)[j];
+                                   }),
+                  i);
+  }
+  return arena_size;
+}
+
+// Returns the byte size and usage interval of each tensor of `subgraph` that
+// the arena holds. The other tensors get a `first_op` of -1.
+std::vector<BufferRequirement> GetTensorRequirements(
+    const Model* model, const SubGraph* subgraph,
+    ErrorReporter* error_reporter) {
+  const int num_tensors = subgraph->tensors()->size();
+  const int num_ops = subgraph->operators() ? subgraph->operators()->size() : 0;
+  std::vector<BufferRequirement> requirements(num_tensors,
+                                              BufferRequirement{0, -1, -1});
+
+  // Mirror the ArenaPlanner: the inputs, outputs and variables are never
+  // deallocated, nor are the op outputs that no op uses.
+  std::vector<int> first_op(num_tensors, -1);
+  std::vector<int> last_op(num_tensors, -1);
+  std::vector<bool> preserved(num_tensors, false);
+  if (subgraph->inputs()) {
+    for (int tensor_index : *subgraph->inputs()) {
+      if (tensor_index < 0 || tensor_index >= num_tensors) continue;
+      first_op[tensor_index] = 0;
+      preserved[tensor_index] = true;
+    }
+  }
+  if (subgraph->outputs()) {
+    for (int tensor_index : *subgraph->outputs()) {
+      if (tensor_index < 0 || tensor_index >= num_tensors) continue;
+      preserved[tensor_index] = true;
+    }
+  }
+  for (int i = 0; i < num_ops; ++i) {
+    const Operator* op = subgraph->operators()->Get(i);
+    if (op->inputs()) {
+      for (int tensor_index : *op->inputs()) {
+        if (tensor_index < 0 || tensor_index >= num_tensors) continue;
+        last_op[tensor_index] = i;
+      }
+    }
+    if (op->outputs()) {
+      for (int tensor_index : *op->outputs()) {
+        if (tensor_index < 0 || tensor_index >= num_tensors) continue;
+        if (first_op[tensor_index] == -1) first_op[tensor_index] = i;
+      }
+    }
+  }
+
+  for (int i = 0; i < num_tensors; ++i) {
+    const Tensor* tensor = subgraph->tensors()->Get(i);
+    if (first_op[i] == -1 || tensor->is_variable()) continue;
+    // Constant tensors are read from the model.
+    if (tensor->buffer() < model->buffers()->size()) {
+      const Buffer* buffer = model->buffers()->Get(tensor->buffer());
+      if (buffer && buffer->data() && buffer->data()->size() > 0) continue;
+    }
+    if (tensor->shape_signature()) {
+      const auto* signature = tensor->shape_signature();
+      if (std::find(signature->begin(), signature->end(), -1) !=
+          signature->end()) {
+        continue;
+      }
+    }
+    TfLiteType type;
+    size_t type_size;
+    if (ConvertTensorType(tensor->type(), &type, error_reporter) !=
+            kTfLiteOk ||
+        GetSizeOfType(/*context=*/nullptr, type, &type_size) != kTfLiteOk) {
+      continue;
+    }
+    size_t size = type_size;
+    if (tensor->shape()) {
+      for (int dim : *tensor->shape()) {
+        size *= std::max(dim, 0);
+      }
+    }
+    requirements[i].size = size;
+    requirements[i].first_op = first_op[i];
+    requirements[i].last_op =
+        preserved[i] || last_op[i] < first_op[i] ? kEndOfInference : last_op[i];
+  }
+  return requirements;
+}
+
+}  // namespace
+
+std::vector<size_t> PlanArenaOffsets(
+    const std::vector<BufferRequirement>& buffers, size_t alignment,
+    size_t* arena_size) {
+  const int num_buffers = buffers.size();
+  auto ordered_by = [&](std::function<bool(int, int)> compare) {
+    std::vector<int> order(num_buffers);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), compare);
+    return order;
+  };
+  auto lifetime = [&](int i) {
+    return static_cast<int64_t>(buffers[i].last_op) - buffers[i].first_op + 1;
+  };
+  auto whole_inference = [&](int i) {
+    return buffers[i].first_op == 0 && buffers[i].last_op == kEndOfInference;
+  };
+
+  std::vector<std::vector<int>> orders;
+  // The order of the ArenaPlanner.
+  orders.push_back(ordered_by([&](int a, int b) {
+    if (whole_inference(a) != whole_inference(b)) return whole_inference(a);
+    if (whole_inference(a)) return false;
+    if (buffers[a].size != buffers[b].size) {
+      return buffers[a].size > buffers[b].size;
+    }
+    return buffers[a].first_op < buffers[b].first_op;
+  }));
+  orders.push_back(ordered_by(
+      [&](int a, int b) { return buffers[a].size > buffers[b].size; }));
+  orders.push_back(
+      ordered_by([&](int a, int b) { return lifetime(a) > lifetime(b); }));
+  orders.push_back(ordered_by([&](int a, int b) {
+    return static_cast<double>(buffers[a].size) * lifetime(a) >
+           static_cast<double>(buffers[b].size) * lifetime(b);
+  }));
+  orders.push_back(ordered_by([&](int a, int b) {
+    if (buffers[a].first_op != buffers[b].first_op) {
+      return buffers[a].first_op < buffers[b].first_op;
+    }
+    return buffers[a].size > buffers[b].size;
+  }));
+
+  std::vector<size_t> offsets;
+  std::vector<size_t> best_offsets;
+  std::vector<int> best_order;
+  size_t best_size = std::numeric_limits<size_t>::max();
+  for (const std::vector<int>& order : orders) {
+    const size_t size = PlaceBuffers(buffers, order, alignment, &offsets);
+    if (size < best_size) {
+      best_size = size;
+      best_order = order;
+      best_offsets = offsets;
+    }
+  }
+
+  // Swap neighbors in the best order while it makes the arena smaller.
+  const int64_t cost_per_placement =
+      std::max<int64_t>(1, int64_t{num_buffers} * num_buffers / 2);
+  int64_t placements_left = kSearchBudget / cost_per_placement;
+  bool improved = true;
+  while (improved && placements_left > 0) {
+    improved = false;
+    for (int i = 1; i < num_buffers && placements_left > 0; ++i) {
+      std::swap(best_order[i - 1], best_order[i]);
+      --placements_left;
+      const size_t size =
+          PlaceBuffers(buffers, best_order, alignment, &offsets);
+      if (size < best_size) {
+        best_size = size;
+        best_offsets = offsets;
+        improved = true;
+      } else {
+        std::swap(best_order[i - 1], best_order[i]);
+      }
+    }
+  }
+
+  *arena_size = num_buffers == 0 ? 0 : best_size;
+  return best_offsets;
+}
+
+TfLiteStatus AddOfflineMemoryPlan(const Model* model, size_t alignment,
+                                  ErrorReporter* error_reporter,
+                                  std::string* output_model) {
+  if (!model || !model->subgraphs() || !model->buffers() || alignment == 0) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Invalid model or alignment.");
+    return kTfLiteError;
+  }
+  auto mutable_model = absl::make_unique<ModelT>();
+  model->UnPackTo(mutable_model.get(), nullptr);
+
+  // Drop a plan made before, leaving its buffers empty.
+  auto& metadata = mutable_model->metadata;
+  for (auto it = metadata.begin(); it != metadata.end();) {
+    if ((*it)->name == kOfflineMemoryAllocationMetadataName) {
+      if ((*it)->buffer < mutable_model->buffers.size()) {
+        mutable_model->buffers[(*it)->buffer]->data.clear();
+      }
+      it = metadata.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (int subgraph_index = 0; subgraph_index < model->subgraphs()->size();
+       ++subgraph_index) {
+    const SubGraph* subgraph = model->subgraphs()->Get(subgraph_index);
+    if (!subgraph->tensors()) continue;
+    const std::vector<BufferRequirement> requirements =
+        GetTensorRequirements(model, subgraph, error_reporter);
+
+    // Only plan the tensors that the arena holds.
+    std::vector<BufferRequirement> buffers;
+    std::vector<int> buffer_tensors;
+    for (int i = 0; i < static_cast<int>(requirements.size()); ++i) {
+      if (requirements[i].first_op != -1) {
+        buffers.push_back(requirements[i]);
+        buffer_tensors.push_back(i);
+      }
+    }
+    size_t arena_size;
+    const std::vector<size_t> offsets =
+        PlanArenaOffsets(buffers, alignment, &arena_size);
+    if (arena_size > std::numeric_limits<int32_t>::max()) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "The arena of subgraph %d is too large for offline "
+                           "planned offsets.",
+                           subgraph_index);
+      return kTfLiteError;
+    }
+
+    std::vector<int32_t> words = {kOfflineMemoryAllocationVersion,
+                                  subgraph_index,
+                                  static_cast<int32_t>(requirements.size())};
+    words.resize(words.size() + requirements.size(), -1);
+    for (size_t i = 0; i < buffer_tensors.size(); ++i) {
+      words[kOfflineMemoryAllocationHeaderSize + buffer_tensors[i]] =
+          static_cast<int32_t>(offsets[i]);
+    }
+
+    auto buffer = absl::make_unique<BufferT>();
+    buffer->data.resize(words.size() * sizeof(int32_t));
+    memcpy(buffer->data.data(), words.data(), buffer->data.size());
+    auto plan_metadata = absl::make_unique<MetadataT>();
+    plan_metadata->name = kOfflineMemoryAllocationMetadataName;
+    plan_metadata->buffer = mutable_model->buffers.size();
+    mutable_model->buffers.push_back(std::move(buffer));
+    metadata.push_back(std::move(plan_metadata));
+  }
+
+  flatbuffers::FlatBufferBuilder builder;
+  FinishModelBuffer(builder, Model::Pack(builder, mutable_model.get()));
+  output_model->assign(
+      reinterpret_cast<const char*>(builder.GetBufferPointer()),
+      builder.GetSize());
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -0,0 +1,64 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_OFFLINE_MEMORY_PLANNER_OFFLINE_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_TOOLS_OFFLINE_MEMORY_PLANNER_OFFLINE_MEMORY_PLANNER_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// A buffer of `size` bytes that is used from the op at index `first_op` to
+// the op at index `last_op`, both included.
+struct BufferRequirement {
+  size_t size;
+  int first_op;
+  int last_op;
+};
+
+// Returns arena offsets, aligned to `alignment`, for `buffers` such that the
+// buffers used by the same op don't overlap, and sets `arena_size` to the size
+// of the arena they take.
+//
+// Each buffer is placed in the smallest gap that fits between the buffers
+// placed before it, like the runtime ArenaPlanner does. The order the buffers
+// are placed in is searched for instead of being fixed: a few orderings are
+// tried, including the one of the ArenaPlanner, and the best one is improved
+// by swapping neighbors for as long as the arena shrinks, within a budget of
+// placements that shrinks with the number of buffers.
+std::vector<size_t> PlanArenaOffsets(
+    const std::vector<BufferRequirement>& buffers, size_t alignment,
+    size_t* arena_size);
+
+// Writes to `output_model` a copy of `model` that holds arena offsets planned
+// by PlanArenaOffsets() for the tensors of each subgraph, in the
+// "OfflineMemoryAllocation" metadata that the InterpreterBuilder reads.
+//
+// The tensors have the lifetimes the ArenaPlanner gives them when the ops run
+// in order, and the sizes of their static shapes. Constant, variable, string
+// and dynamically shaped tensors are left to the runtime planner, as are the
+// temporaries of the ops, which aren't known offline.
+TfLiteStatus AddOfflineMemoryPlan(const Model* model, size_t alignment,
+                                  ErrorReporter* error_reporter,
+                                  std::string* output_model);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_OFFLINE_MEMORY_PLANNER_OFFLINE_MEMORY_PLANNER_H_
@@ -0,0 +1,145 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/offline_memory_planner/offline_memory_planner.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/stderr_reporter.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace {
+
+constexpr char kMultiAddModelPath[] = "tensorflow/lite/testdata/multi_add.bin";
+
+TEST(PlanArenaOffsetsTest, EmptyPlan) {
+  size_t arena_size = 1;
+  EXPECT_TRUE(PlanArenaOffsets({}, 4, &arena_size).empty());
+  EXPECT_EQ(arena_size, 0);
+}
+
+TEST(PlanArenaOffsetsTest, AlignsOffsets) {
+  size_t arena_size;
+  const std::vector<size_t> offsets =
+      PlanArenaOffsets({{3, 0, 1}, {5, 0, 1}, {2, 1, 2}}, 4, &arena_size);
+  ASSERT_EQ(offsets.size(), 3);
+  for (size_t offset : offsets) {
+    EXPECT_EQ(offset % 4, 0);
+  }
+}
+
+TEST(PlanArenaOffsetsTest, BeatsPlacingTheLargestBuffersFirst) {
+  const std::vector<BufferRequirement> buffers = {
+      {3, 0, 2}, {1, 2, 3}, {6, 4, 5}, {6, 1, 1}, {3, 2, 4}};
+  size_t arena_size;
+  const std::vector<size_t> offsets =
+      PlanArenaOffsets(buffers, 1, &arena_size);
+  // Placing the buffers by decreasing size takes 12 bytes.
+  EXPECT_EQ(arena_size, 9);
+
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    EXPECT_LE(offsets[i] + buffers[i].size, arena_size);
+    for (size_t j = i + 1; j < buffers.size(); ++j) {
+      if (buffers[i].last_op < buffers[j].first_op ||
+          buffers[j].last_op < buffers[i].first_op) {
+        continue;
+      }
+      EXPECT_TRUE(offsets[i] + buffers[i].size <= offsets[j] ||
+                  offsets[j] + buffers[j].size <= offsets[i])
+          << "Buffers " << i << " and " << j << " overlap";
+    }
+  }
+}
+
+TEST(AddOfflineMemoryPlanTest, InterpreterUsesPlannedOffsets) {
+  auto model = FlatBufferModel::BuildFromFile(kMultiAddModelPath);
+  ASSERT_NE(model, nullptr);
+  std::string planned_model_data;
+  ASSERT_EQ(AddOfflineMemoryPlan(model->GetModel(), kDefaultTensorAlignment,
+                                 DefaultErrorReporter(), &planned_model_data),
+            kTfLiteOk);
+
+  // Read back the offsets of the metadata.
+  const Model* planned_model =
+      flatbuffers::GetRoot<Model>(planned_model_data.data());
+  ASSERT_NE(planned_model->metadata(), nullptr);
+  ASSERT_EQ(planned_model->metadata()->size(), 1);
+  const Metadata* metadata = planned_model->metadata()->Get(0);
+  EXPECT_EQ(metadata->name()->str(), "OfflineMemoryAllocation");
+  const auto* data = planned_model->buffers()->Get(metadata->buffer())->data();
+  std::vector<int32_t> words(data->size() / sizeof(int32_t));
+  memcpy(words.data(), data->data(), data->size());
+  // Seven tensors that are all in use while the second op runs.
+  ASSERT_EQ(words.size(), 3 + 7);
+  EXPECT_EQ(words[0], 1);
+  EXPECT_EQ(words[1], 0);
+  EXPECT_EQ(words[2], 7);
+
+  auto planned_flatbuffer_model = FlatBufferModel::BuildFromBuffer(
+      planned_model_data.data(), planned_model_data.size());
+  ASSERT_NE(planned_flatbuffer_model, nullptr);
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(InterpreterBuilder(*planned_flatbuffer_model, resolver)(
+                &interpreter),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  const char* base = interpreter->tensor(0)->data.raw - words[3];
+  for (int i = 0; i < 7; ++i) {
+    ASSERT_GE(words[3 + i], 0);
+    EXPECT_EQ(interpreter->tensor(i)->data.raw, base + words[3 + i]);
+  }
+
+  for (int i = 0; i < 4; ++i) {
+    float* input = interpreter->typed_tensor<float>(i);
+    for (int j = 0; j < 8 * 8 * 3; ++j) input[j] = i + 1;
+  }
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  // x = a + b + c and y = d + b + c.
+  EXPECT_EQ(interpreter->typed_tensor<float>(5)[0], 6);
+  EXPECT_EQ(interpreter->typed_tensor<float>(6)[0], 9);
+}
+
+TEST(AddOfflineMemoryPlanTest, ReplacesPlan) {
+  auto model = FlatBufferModel::BuildFromFile(kMultiAddModelPath);
+  ASSERT_NE(model, nullptr);
+  std::string planned_model_data;
+  ASSERT_EQ(AddOfflineMemoryPlan(model->GetModel(), kDefaultTensorAlignment,
+                                 DefaultErrorReporter(), &planned_model_data),
+            kTfLiteOk);
+  std::string replanned_model_data;
+  ASSERT_EQ(AddOfflineMemoryPlan(
+                flatbuffers::GetRoot<Model>(planned_model_data.data()),
+                kDefaultTensorAlignment, DefaultErrorReporter(),
+                &replanned_model_data),
+            kTfLiteOk);
+  const Model* replanned_model =
+      flatbuffers::GetRoot<Model>(replanned_model_data.data());
+  ASSERT_NE(replanned_model->metadata(), nullptr);
+  EXPECT_EQ(replanned_model->metadata()->size(), 1);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -54,12 +54,23 @@ class ThreadingOptions(options.OptionsBase):
       "The value 0 can be used to indicate that the threadpool size should be "
       "determined at runtime based on the number of available CPU cores.")
 
+  numa_node = options.create_option(
+      name="numa_node",
+      ty=int,
+      docstring=
+      "If set, the threads of the dataset are pinned to the given NUMA node, "
+      "and the buffers of its elements are allocated on that node. This keeps "
+      "the input pipeline from contending with the rest of the program for the "
+      "caches and memory bandwidth of other nodes.")
+
   def _to_proto(self):
     pb = dataset_options_pb2.ThreadingOptions()
     if self.max_intra_op_parallelism is not None:
       pb.max_intra_op_parallelism = self.max_intra_op_parallelism
     if self.private_threadpool_size is not None:
       pb.private_threadpool_size = self.private_threadpool_size
+    if self.numa_node is not None:
+      pb.numa_node = self.numa_node
     return pb
 
   def _from_proto(self, pb):
@@ -67,3 +78,5 @@ class ThreadingOptions(options.OptionsBase):
       self.max_intra_op_parallelism = pb.max_intra_op_parallelism
     if pb.WhichOneof("optional_private_threadpool_size") is not None:
       self.private_threadpool_size = pb.private_threadpool_size
+    if pb.WhichOneof("optional_numa_node") is not None:
+      self.numa_node = pb.numa_node
@@ -18,6 +18,8 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import time
+
 from absl.testing import parameterized
 import numpy as np
 
@@ -176,6 +178,85 @@ class MultiDeviceIteratorTest(test_base.DatasetTestBase,
       self.evaluate(elem_on_1)
       self.evaluate(elem_on_2)
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testOutOfOrderShardRequests(self):
+    dataset = dataset_ops.Dataset.range(8)
+    multi_device_iterator = multi_device_iterator_ops.MultiDeviceIterator(
+        dataset, [self._devices[1], self._devices[2]],
+        max_buffer_size=4,
+        prefetch_buffer_size=0)
+
+    self.evaluate(multi_device_iterator.initializer)
+    # The second shard is served first while the elements of the first shard
+    # are buffered, including two requests outstanding at once.
+    self.assertEqual(
+        1, self.evaluate(multi_device_iterator.get_next(self._devices[2])))
+    self.assertEqual(
+        3, self.evaluate(multi_device_iterator.get_next(self._devices[2])))
+    self.assertCountEqual([5, 7],
+                          self.evaluate([
+                              multi_device_iterator.get_next(self._devices[2]),
+                              multi_device_iterator.get_next(self._devices[2])
+                          ]))
+    for i in range(0, 8, 2):
+      elem_on_1 = multi_device_iterator.get_next(self._devices[1])
+      self.assertEqual(i, self.evaluate(elem_on_1))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testEndOfSequenceOnOneShard(self):
+    dataset = dataset_ops.Dataset.range(3)
+    multi_device_iterator = multi_device_iterator_ops.MultiDeviceIterator(
+        dataset, [self._devices[1], self._devices[2]],
+        max_buffer_size=4,
+        prefetch_buffer_size=0)
+
+    self.evaluate(multi_device_iterator.initializer)
+    self.assertEqual(
+        1, self.evaluate(multi_device_iterator.get_next(self._devices[2])))
+    # The input ends before the second shard gets another element, while the
+    # first shard still has two buffered.
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(multi_device_iterator.get_next(self._devices[2]))
+    self.assertEqual(
+        0, self.evaluate(multi_device_iterator.get_next(self._devices[1])))
+    self.assertEqual(
+        2, self.evaluate(multi_device_iterator.get_next(self._devices[1])))
+    # Further requests of either shard fail instead of waiting.
+    for _ in range(2):
+      with self.assertRaises(errors.OutOfRangeError):
+        self.evaluate(multi_device_iterator.get_next(self._devices[1]))
+      with self.assertRaises(errors.OutOfRangeError):
+        self.evaluate(multi_device_iterator.get_next(self._devices[2]))
+
+  @combinations.generate(test_base.graph_only_combinations())
+  def testPendingRequestIsCancelledByInitialization(self):
+    dataset = dataset_ops.Dataset.range(10)
+    multi_device_iterator = multi_device_iterator_ops.MultiDeviceIterator(
+        dataset, [self._devices[1], self._devices[2]],
+        max_buffer_size=1,
+        prefetch_buffer_size=0)
+    elem_on_1 = multi_device_iterator.get_next(self._devices[1])
+    elem_on_2 = multi_device_iterator.get_next(self._devices[2])
+
+    self.evaluate(multi_device_iterator.initializer)
+    self.assertEqual(1, self.evaluate(elem_on_2))
+
+    # The first shard's buffer is full, so the next element of the second
+    # shard is not fetched until the first shard is read.
+    def blocking_get_next():
+      with self.assertRaises(errors.CancelledError):
+        self.evaluate(elem_on_2)
+
+    thread = self.checkedThread(target=blocking_get_next)
+    thread.start()
+    # Let the request reach the iterator before it is initialized again.
+    time.sleep(0.5)
+    self.evaluate(multi_device_iterator.initializer)
+    thread.join()
+
+    # The new incarnation starts over.
+    self.assertEqual(0, self.evaluate(elem_on_1))
+
   @combinations.generate(test_base.graph_only_combinations())
   def testMultipleInitializationsGraph(self):
     dataset1 = dataset_ops.Dataset.range(1000)
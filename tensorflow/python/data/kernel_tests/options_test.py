@@ -163,6 +163,7 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.experimental_slack = True
     options.threading.max_intra_op_parallelism = 30
     options.threading.private_threadpool_size = 40
+    options.threading.numa_node = 0
     pb = options._to_proto()
     result = dataset_ops.Options()
     result._from_proto(pb)
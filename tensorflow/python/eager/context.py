@@ -1045,6 +1045,7 @@ class Context(object):
     rewriter_bool("disable_model_pruning")
     rewriter_toggle("scoped_allocator_optimization")
     rewriter_toggle("pin_to_host_optimization")
+    rewriter_toggle("multi_tensor_apply")
     rewriter_toggle("implementation_selector")
     rewriter_toggle("auto_mixed_precision")
     rewriter_toggle("use_plugin_optimizers")
@@ -1664,6 +1665,7 @@ class Context(object):
     rewriter_bool("disable_model_pruning")
     rewriter_toggle("scoped_allocator_optimization")
     rewriter_toggle("pin_to_host_optimization")
+    rewriter_toggle("multi_tensor_apply")
     rewriter_toggle("implementation_selector")
     rewriter_toggle("auto_mixed_precision")
     rewriter_toggle("use_plugin_optimizers")
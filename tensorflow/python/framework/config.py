@@ -230,6 +230,9 @@ def set_optimizer_experimental_options(options):
       - scoped_allocator_optimization: Try to allocate some independent Op
         outputs contiguously in order to merge or eliminate downstream Ops.
       - pin_to_host_optimization: Force small ops onto the CPU.
+      - multi_tensor_apply: Update the variables of the Adam and momentum
+        optimizers that share a device and hyperparameters with one op, which
+        is a single kernel launch on GPU.
       - implementation_selector: Enable the swap of kernel implementations based
         on the device placement.
       - auto_mixed_precision: Change certain float32 ops to float16 on Volta
@@ -143,6 +143,26 @@ class DecodeCSVOpTest(test.TestCase):
 
     self._test(args, expected_out)
 
+  def testEscapedQuotesInSeveralFields(self):
+    args = {
+        "records": ['"a""b","c""""d",e', '"""","",f'],
+        "record_defaults": [[""], [""], [""]]
+    }
+
+    expected_out = [[b'a"b', b'"'], [b'c""d', b""], [b"e", b"f"]]
+
+    self._test(args, expected_out)
+
+  def testLongStringsAcrossRecords(self):
+    args = {
+        "records": ["a" * 100 + ',"' + 'b""' * 40 + '"', "c,d"],
+        "record_defaults": [[""], [""]]
+    }
+
+    expected_out = [[b"a" * 100, b"c"], [b'b"' * 40, b"d"]]
+
+    self._test(args, expected_out)
+
   def testMultiRecords(self):
     args = {
         "records": ["1.0,4,aa", "0.2,5,bb", "3,6,cc"],
@@ -271,6 +291,15 @@ class DecodeCSVOpTest(test.TestCase):
     expected_out = [[0, 4], [1, 5], [2, 6]]
     self._test(args, expected_out)
 
+  def testSelectColsWithEscapedQuotes(self):
+    args = {
+        "records": ['"x""y","s""kip","z"', 'u,v,w'],
+        "record_defaults": [[""], [""]],
+        "select_cols": [0, 2]
+    }
+    expected_out = [[b'x"y', b"u"], [b"z", b"w"]]
+    self._test(args, expected_out)
+
   def testWrongSelectColsInclLast(self):
     # The last col is a edge-casey; add test for that
     args = {
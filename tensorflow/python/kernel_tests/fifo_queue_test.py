@@ -861,6 +861,60 @@ class FIFOQueueParallelTests(test.TestCase):
       for elem, result in zip(elems, results):
         self.assertEqual([elem], result)
 
+  def testParallelDequeueManyWhileEnqueueingAndClosing(self):
+    # We need each thread to keep its own device stack or the device scopes
+    # won't be properly nested.
+    ops.get_default_graph().switch_to_thread_local()
+    with self.cached_session() as sess:
+      q = data_flow_ops.FIFOQueue(10, dtypes_lib.int32, ((),))
+      num_elements = 1000
+      batch_size = 7
+      enqueue_placeholder = array_ops.placeholder(dtypes_lib.int32, [None])
+      enqueue_op = q.enqueue_many((enqueue_placeholder,))
+      close_op = q.close()
+      dequeued_t = q.dequeue_many(batch_size)
+      dequeued_up_to_t = q.dequeue_up_to(batch_size)
+
+      def enqueue():
+        for start in xrange(0, num_elements, 5):
+          sess.run(enqueue_op,
+                   feed_dict={enqueue_placeholder: np.arange(start, start + 5)})
+        self.evaluate(close_op)
+
+      # Each consumer records the batches it dequeued, in order.
+      batches = [[] for _ in xrange(3)]
+
+      def dequeue(consumer_batches):
+        while True:
+          try:
+            consumer_batches.append(self.evaluate(dequeued_t))
+          except errors_impl.OutOfRangeError:
+            return
+
+      threads = [self.checkedThread(target=enqueue)] + [
+          self.checkedThread(target=dequeue, args=(consumer_batches,))
+          for consumer_batches in batches
+      ]
+      for thread in threads:
+        thread.start()
+      for thread in threads:
+        thread.join()
+
+      # The elements left after the last full batch are still in the queue.
+      remainder = self.evaluate(dequeued_up_to_t)
+      self.assertEqual(num_elements % batch_size, len(remainder))
+      with self.assertRaisesRegex(errors_impl.OutOfRangeError,
+                                  "is closed and has insufficient"):
+        self.evaluate(dequeued_up_to_t)
+
+      for consumer_batches in batches:
+        elements = np.concatenate(consumer_batches + [[]])
+        self.assertTrue(np.all(np.diff(elements) > 0))
+      self.assertTrue(np.all(np.diff(remainder) > 0))
+      self.assertAllEqual(
+          np.arange(num_elements),
+          np.sort(np.concatenate(sum(batches, []) + [remainder])))
+
   def testBigDequeueMany(self):
     with self.cached_session() as sess:
       q = data_flow_ops.FIFOQueue(2, dtypes_lib.int32, ((),))
@@ -1415,6 +1415,31 @@ class DenseHashTableOpTest(test.TestCase):
     result = self.evaluate(output)
     self.assertAllEqual([10, -1, 12, -1], result)
 
+  def testLargeLookup(self):
+    # Enough keys for the lookup to be split across the intra-op threads.
+    num_keys = 10000
+    keys = np.arange(1, num_keys + 1, dtype=np.int64)
+    values = np.stack([keys, 2 * keys, 3 * keys], axis=1)
+    default_value = constant_op.constant([-1, -2, -3], dtypes.int64)
+    table = lookup_ops.DenseHashTable(
+        dtypes.int64,
+        dtypes.int64,
+        default_value=default_value,
+        empty_key=0,
+        deleted_key=-1)
+    self.evaluate(table.insert(keys, values))
+    self.assertAllEqual(num_keys, self.evaluate(table.size()))
+
+    # The second half of the looked up keys is missing.
+    input_keys = np.arange(1, 2 * num_keys + 1, dtype=np.int64)
+    output = table.lookup(input_keys)
+    self.assertAllEqual([2 * num_keys, 3], output.get_shape())
+
+    expected = np.tile(np.array([-1, -2, -3], dtype=np.int64),
+                       (2 * num_keys, 1))
+    expected[:num_keys] = values
+    self.assertAllEqual(expected, self.evaluate(output))
+
   def testResize(self):
     keys = constant_op.constant([11, 12, 13], dtypes.int64)
     values = constant_op.constant([0, 1, 2], dtypes.int64)
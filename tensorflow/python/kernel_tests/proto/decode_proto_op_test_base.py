@@ -368,3 +368,49 @@ class DecodeProtoOpTestBase(test_base.ProtoOpTestBase, parameterized.TestCase):
           for field_name, parsed in zip(comb, parsed_values):
             self.assertAllEqual(parsed, expected_field_values[field_name],
                                 'perm: {}, comb: {}'.format(indices, comb))
+
+  def testLargeBatch(self):
+    # Enough messages for the batch to be decoded in several shards.
+    batch_size = 1000
+    batch = [
+        test_example_pb2.TestValue(
+            int32_value=list(range(i % 4)),
+            string_value=['s%d' % i] * (i % 3)).SerializeToString()
+        for i in range(batch_size)
+    ]
+    sizes, (int32_values, string_values) = self.evaluate(
+        self._decode_module.decode_proto(
+            np.array(batch, dtype=object),
+            message_type='tensorflow.contrib.proto.TestValue',
+            field_names=['int32_value', 'string_value'],
+            output_types=[dtypes.int32, dtypes.string],
+            sanitize=False))
+
+    expected_sizes = [[i % 4, i % 3] for i in range(batch_size)]
+    expected_int32_values = [
+        list(range(i % 4)) + [0] * (3 - i % 4) for i in range(batch_size)
+    ]
+    expected_string_values = [
+        [b's%d' % i] * (i % 3) + [b''] * (2 - i % 3) for i in range(batch_size)
+    ]
+    self.assertAllEqual(sizes, expected_sizes)
+    self.assertAllEqual(int32_values, expected_int32_values)
+    self.assertAllEqual(string_values, expected_string_values)
+
+  def testCorruptProtobufInLargeBatch(self):
+    batch = [
+        test_example_pb2.TestValue(int32_value=[i]).SerializeToString()
+        for i in range(1000)
+    ]
+    batch[500] = 'This is not a binary protobuf'
+
+    with self.assertRaisesRegexp(
+        errors.DataLossError, 'Unable to parse binary protobuf'
+        '|Failed to consume entire buffer'):
+      self.evaluate(
+          self._decode_module.decode_proto(
+              np.array(batch, dtype=object),
+              message_type='tensorflow.contrib.proto.TestValue',
+              field_names=['int32_value'],
+              output_types=[dtypes.int32],
+              sanitize=False))
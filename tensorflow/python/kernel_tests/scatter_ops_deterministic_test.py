@@ -0,0 +1,75 @@
+# Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for deterministic functionality of scatter ops."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+import numpy as np
+
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import test_util
+from tensorflow.python.ops import state_ops
+from tensorflow.python.ops import variables
+from tensorflow.python.platform import test
+
+
+class ScatterDeterministicTest(test.TestCase):
+  """Test that the GPU code-paths of ScatterAdd and ScatterSub are deterministic.
+
+  The floating point updates are applied without contended atomics when
+  deterministic ops are enabled, so repeated runs must be bitwise identical.
+  """
+
+  _REPEAT_COUNT = 5
+
+  def _input(self, data_type):
+    np.random.seed(456)
+    ref = np.random.uniform(size=(10, 7)).astype(data_type)
+    # Repeated and out-of-range indices.
+    indices = np.random.randint(-2, 12, size=1000).astype(np.int32)
+    updates = np.random.uniform(size=(1000, 7)).astype(data_type)
+    return ref, indices, updates
+
+  def _scatter(self, op, ref, indices, updates):
+    ref_var = variables.Variable(ref)
+    self.evaluate(ref_var.initializer)
+    return self.evaluate(
+        op(ref_var, constant_op.constant(indices),
+           constant_op.constant(updates)))
+
+  @test_util.run_cuda_only
+  def testScatterAddSub(self):
+    for op, sign in [(state_ops.scatter_add, 1), (state_ops.scatter_sub, -1)]:
+      for data_type in [np.float16, np.float32, np.float64]:
+        with self.cached_session(force_gpu=True):
+          ref, indices, updates = self._input(data_type)
+          expected = self._scatter(op, ref, indices, updates)
+          for _ in range(self._REPEAT_COUNT):
+            self.assertAllEqual(expected,
+                                self._scatter(op, ref, indices, updates))
+          np_result = ref.astype(np.float64)
+          for i, index in enumerate(indices):
+            if 0 <= index < ref.shape[0]:
+              np_result[index] += sign * updates[i]
+          self.assertAllClose(np_result, expected, rtol=1e-2, atol=1e-2)
+
+
+if __name__ == "__main__":
+  os.environ["TF_DETERMINISTIC_OPS"] = "1"
+  test.main()
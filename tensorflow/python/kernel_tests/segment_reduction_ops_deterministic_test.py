@@ -20,11 +20,11 @@ from __future__ import print_function
 
 import os
 
+import numpy as np
+
 from tensorflow.python.eager import backprop
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
-from tensorflow.python.framework import errors_impl
-from tensorflow.python.framework import indexed_slices
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
@@ -33,117 +33,87 @@ from tensorflow.python.ops import variables
 from tensorflow.python.platform import test
 
 
-class SegmentReductionDeterminismExceptionsTest(test.TestCase):
-  """Test d9m-unimplemented exceptions from the segment reduction ops.
+class SegmentReductionDeterministicTest(test.TestCase):
+  """Test that the GPU code-paths of the segment reduction ops are deterministic.
 
-  Test that tf.errors.UnimplementedError is thrown or not thrown, as
-  appropriate, by the GPU code-paths for segment reduction ops when
-  deterministic ops are enabled.
+  The floating point sums and products are computed without atomics when
+  deterministic ops are enabled, so repeated runs must be bitwise identical.
 
   This test assumes that the base op test runs all the same test cases when
-  deterministic ops are not enabled and will therefore detect erroneous
-  exception throwing in those cases.
+  deterministic ops are not enabled and will therefore detect numerical errors
+  in those cases.
   """
 
-  def _input(self, data_type, segment_ids_type):
-    data = constant_op.constant([[1, 2, 3, 4], [5, 6, 7, 8]], dtype=data_type)
-    segment_ids = constant_op.constant([0, 1], dtype=segment_ids_type)
-    num_segments = 2
-    return data, segment_ids, num_segments
+  _REPEAT_COUNT = 5
+
+  def _input(self, data_type, segment_ids_type, num_segments, sorted_ids):
+    np.random.seed(123)
+    num_rows = 1000
+    data = np.random.uniform(0.5, 1.5, size=(num_rows, 5))
+    segment_ids = np.random.randint(0, num_segments, size=num_rows)
+    if sorted_ids:
+      segment_ids = np.sort(segment_ids)
+    return (constant_op.constant(data, dtype=data_type),
+            constant_op.constant(segment_ids, dtype=segment_ids_type))
+
+  def _assertReproducible(self, op_fn):
+    expected = self.evaluate(op_fn())
+    for _ in range(self._REPEAT_COUNT):
+      self.assertAllEqual(expected, self.evaluate(op_fn()))
 
   @test_util.run_cuda_only
   def testSortedOps(self):
-    op_should_throw_for_float = {
-        math_ops.segment_max: False,
-        math_ops.segment_min: False,
-        math_ops.segment_prod: True,
-        math_ops.segment_sum: True,
-    }
-    for op, should_throw_for_float in op_should_throw_for_float.items():
+    num_segments = 10
+    for op in [math_ops.segment_prod, math_ops.segment_sum]:
       for segment_ids_type in [dtypes.int32, dtypes.int64]:
         for data_type in [dtypes.float16, dtypes.float32, dtypes.float64]:
           with self.cached_session(force_gpu=True):
-            data, segment_ids, _ = self._input(data_type, segment_ids_type)
-            if should_throw_for_float:
-              with self.assertRaisesRegex(
-                  errors_impl.UnimplementedError,
-                  "Deterministic GPU implementation of sorted segment " +
-                  "reduction op not available."):
-                result = op(data, segment_ids)
-                self.evaluate(result)
-            else:
-              result = op(data, segment_ids)
-              self.evaluate(result)
-
-  _UNSORTED_ERROR_MESSAGE = ("Deterministic GPU implementation of unsorted " +
-                             "segment reduction op not available.")
+            data, segment_ids = self._input(
+                data_type, segment_ids_type, num_segments, sorted_ids=True)
+            self._assertReproducible(lambda: op(data, segment_ids))
 
   @test_util.run_cuda_only
   @test_util.run_in_graph_and_eager_modes
   def testUnsortedOps(self):
-    op_should_throw_for_float = {
-        math_ops.unsorted_segment_max: False,
-        math_ops.unsorted_segment_min: False,
-        math_ops.unsorted_segment_mean: True,  # uses unsorted_segment_sum
-        math_ops.unsorted_segment_sqrt_n: True,  # uses unsorted_segment_sum
-        math_ops.unsorted_segment_prod: True,
-        math_ops.unsorted_segment_sum: True,
-    }
+    num_segments = 10
     with self.session(force_gpu=True):
-      for op, should_throw_for_float in op_should_throw_for_float.items():
+      for op in [
+          math_ops.unsorted_segment_mean,  # uses unsorted_segment_sum
+          math_ops.unsorted_segment_sqrt_n,  # uses unsorted_segment_sum
+          math_ops.unsorted_segment_prod,
+          math_ops.unsorted_segment_sum,
+      ]:
         for segment_ids_type in [dtypes.int32, dtypes.int64]:
-          for data_type in [
-              dtypes.float16, dtypes.float32, dtypes.float64, dtypes.int32
-          ]:
-            if (op == math_ops.unsorted_segment_sqrt_n and
-                data_type == dtypes.int32):  # sqrt_n doesn't support int32
-              continue
-            data, segment_ids, num_segments = self._input(
-                data_type, segment_ids_type)
-            if (data_type != dtypes.int32) and should_throw_for_float:
-              with self.assertRaisesRegex(errors_impl.UnimplementedError,
-                                          self._UNSORTED_ERROR_MESSAGE):
-                result = op(data, segment_ids, num_segments)
-                self.evaluate(result)
-            else:
-              result = op(data, segment_ids, num_segments)
-              self.evaluate(result)
+          for data_type in [dtypes.float16, dtypes.float32, dtypes.float64]:
+            data, segment_ids = self._input(
+                data_type, segment_ids_type, num_segments, sorted_ids=False)
+            self._assertReproducible(
+                lambda: op(data, segment_ids, num_segments))
+
+  @test_util.run_cuda_only
+  def testUnsortedOpsOutOfRangeIds(self):
+    # Out-of-range segment ids are ignored, as on the nondeterministic path.
+    with self.cached_session(force_gpu=True):
+      data = constant_op.constant([[1., 2.], [3., 4.], [5., 6.], [7., 8.]])
+      segment_ids = constant_op.constant([2, -1, 0, 5])
+      result = math_ops.unsorted_segment_sum(data, segment_ids, 3)
+      self.assertAllEqual([[5., 6.], [0., 0.], [1., 2.]],
+                          self.evaluate(result))
 
   @test.disable_with_predicate(
       pred=test.is_built_with_rocm,
       skip_message="No ROCm support for complex types in segment reduction ops")
   @test_util.run_cuda_only
   def testUnsortedOpsComplex(self):
-    for op in [
-        math_ops.unsorted_segment_sum,
-    ]:
-      for data_type in [dtypes.complex64, dtypes.complex128]:
-        for segment_ids_type in [dtypes.int32, dtypes.int64]:
-          with self.cached_session(force_gpu=True):
-            data, segment_ids, num_segments = self._input(
-                data_type, segment_ids_type)
-            with self.assertRaisesRegex(errors_impl.UnimplementedError,
-                                        self._UNSORTED_ERROR_MESSAGE):
-              result = op(data, segment_ids, num_segments)
-              self.evaluate(result)
-
-  @test_util.run_cuda_only
-  @test_util.run_in_graph_and_eager_modes
-  def testConvertToTensor(self):
-    with self.session(force_gpu=True):
-      dtypes_to_test = [dtypes.float16, dtypes.float32, dtypes.float64]
-      if not test.is_built_with_rocm():
-        dtypes_to_test += [dtypes.complex64, dtypes.complex128]
-      for data_type in dtypes_to_test:
-        for segment_ids_type in [dtypes.int32, dtypes.int64]:
-          values, indices, _ = self._input(data_type, segment_ids_type)
-          sparse_value = indexed_slices.IndexedSlices(
-              values, indices, dense_shape=values.shape)
-          with self.assertRaisesRegex(errors_impl.UnimplementedError,
-                                      self._UNSORTED_ERROR_MESSAGE):
-            # convert_to_tensor with IndexedSlices uses unsorted_segment_sum
-            result = ops.convert_to_tensor(sparse_value)
-            self.evaluate(result)
+    num_segments = 10
+    for data_type in [dtypes.complex64, dtypes.complex128]:
+      for segment_ids_type in [dtypes.int32, dtypes.int64]:
+        with self.cached_session(force_gpu=True):
+          data, segment_ids = self._input(
+              data_type, segment_ids_type, num_segments, sorted_ids=False)
+          self._assertReproducible(
+              lambda: math_ops.unsorted_segment_sum(data, segment_ids,
+                                                    num_segments))
 
   @test_util.run_cuda_only
   def testGatherBackprop(self):
@@ -153,16 +123,18 @@ class SegmentReductionDeterminismExceptionsTest(test.TestCase):
     for data_type in dtypes_to_test:
       for segment_ids_type in [dtypes.int32, dtypes.int64]:
         with self.cached_session(force_gpu=True):
-          params, indices, _ = self._input(data_type, segment_ids_type)
-          params = variables.Variable(params)
-          with backprop.GradientTape() as tape:
-            tape.watch(params)
-            op_output = array_ops.gather(params, indices)
-          gradient = tape.gradient(op_output, params)
-          with self.assertRaisesRegex(errors_impl.UnimplementedError,
-                                      self._UNSORTED_ERROR_MESSAGE):
-            # convert_to_tensor on IndexedSlices
-            self.evaluate(params.assign(gradient))
+          params, indices = self._input(
+              data_type, segment_ids_type, num_segments=10, sorted_ids=False)
+          params = variables.Variable(params[:10])
+
+          def gradient():
+            with backprop.GradientTape() as tape:
+              tape.watch(params)
+              op_output = array_ops.gather(params, indices)
+            # convert_to_tensor with IndexedSlices uses unsorted_segment_sum
+            return ops.convert_to_tensor(tape.gradient(op_output, params))
+
+          self._assertReproducible(gradient)
 
 
 if __name__ == "__main__":
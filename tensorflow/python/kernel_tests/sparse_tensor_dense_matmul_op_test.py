@@ -178,6 +178,35 @@ class SparseTensorDenseMatMulTest(test.TestCase):
     self.assertAllClose(
         expected_t, sparse_ops.sparse_tensor_dense_matmul(sparse_t, dense_t))
 
+  @test_util.run_in_graph_and_eager_modes(use_gpu=False)
+  def testRepeatedSparseOperand(self):
+    np.random.seed(127)
+    x = np.random.rand(20, 10).astype(np.float32)
+    x[x < 0.7] = 0
+    indices = np.vstack(np.where(x)).astype(np.int64).T
+    shape = x.shape
+    indices_t = array_ops.placeholder_with_default(indices, shape=None)
+    values_t = array_ops.placeholder_with_default(x[np.where(x)], shape=None)
+    # The same indices with other values and dense operands.
+    for adjoint_a in (False, True):
+      for n in (3, 40):
+        y = np.random.rand(20 if adjoint_a else 10, n).astype(np.float32)
+        sparse_t = sparse_tensor.SparseTensor(indices_t, 2 * values_t, shape)
+        x_mat = x.T if adjoint_a else x
+        self.assertAllClose(
+            2 * x_mat.dot(y),
+            sparse_ops.sparse_tensor_dense_matmul(
+                sparse_t, y, adjoint_a=adjoint_a))
+
+    # Other indices, with the same number of entries.
+    other_x = x[::-1].copy()
+    other_indices = np.vstack(np.where(other_x)).astype(np.int64).T
+    sparse_t = sparse_tensor.SparseTensor(other_indices,
+                                          other_x[np.where(other_x)], shape)
+    y = np.random.rand(10, 40).astype(np.float32)
+    self.assertAllClose(
+        other_x.dot(y), sparse_ops.sparse_tensor_dense_matmul(sparse_t, y))
+
   @test_util.run_gpu_only
   def testInvalidIndicesForSparseTensorDenseMatmulOnGPU(self):
     indices = np.array([[1, 10]]).astype(np.int64)
@@ -167,6 +167,25 @@ class TopKTest(test.TestCase):
       values = -np.sort(-inputs, axis=1)[:, :k]
       self._validateTopK(inputs, k, values, indices)
 
+  def testLongRowTopK(self):
+    # Long rows are split into chunks on CPU.
+    b = 2
+    n = 300000
+    for k in [2, 10, 100]:
+      inputs = np.random.permutation(
+          np.linspace(0, 100, b * n, dtype=np.float32)).reshape(b, n)
+      indices = np.argsort(-inputs, axis=1)[:, :k]
+      values = -np.sort(-inputs, axis=1)[:, :k]
+      self._validateTopK(inputs, k, values, indices)
+
+  def testLongRowStableSort(self):
+    n = 300000
+    k = 20
+    inputs = np.random.randint(0, 4, size=(1, n)).astype(np.int32)
+    indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices)
+
   def testTopAll(self):
     inputs = [[0.1, 0.3, 0.2, 0.4], [0.1, 0.3, 0.3, 0.2]]
     self._validateTopK(inputs, 4, [[0.4, 0.3, 0.2, 0.1], [0.3, 0.3, 0.2, 0.1]],
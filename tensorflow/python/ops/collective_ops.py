@@ -80,7 +80,8 @@ def all_reduce_v2(t,
                   communication_hint='auto',
                   timeout=0,
                   ordering_token=None,
-                  max_subdivs_per_device=-1):
+                  max_subdivs_per_device=-1,
+                  compression='none'):
   """Reduces tensors collectively, across devices.
 
   Args:
@@ -108,6 +109,10 @@ def all_reduce_v2(t,
       parallelize processing of each per-device tensor. Setting to -1 disables
       subdivision and reverts to previous behavior of not sub-dividing tensor.
       Setting to 0 uses sytem defaults.
+    compression: the data type float32 and float64 values are cast to before
+      they are transferred between devices: `none`, `bfloat16` or `float16`.
+      Partial reductions are still computed in the type of `t`. NCCL reductions
+      only support `float16`, and reduce the cast values.
 
   Returns:
     An Op implementing the distributed reduction.
@@ -124,7 +129,8 @@ def all_reduce_v2(t,
       communication_hint=communication_hint.lower(),
       timeout_seconds=timeout,
       ordering_token=ordering_token or [],
-      max_subdivs_per_device=max_subdivs_per_device)
+      max_subdivs_per_device=max_subdivs_per_device,
+      compression=compression.lower())
 
 
 def all_gather(t,
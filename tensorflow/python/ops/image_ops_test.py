@@ -4264,6 +4264,34 @@ class JpegTest(test_util.TensorFlowTestCase):
           result = image_ops.decode_and_crop_jpeg(jpeg0, crop_window)
           self.evaluate(result)
 
+  def testDecodeAndResizeJpeg(self):
+    with self.cached_session():
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+      image0 = image_ops.decode_jpeg(jpeg0, channels=3)
+
+      # The image is decoded at its size, and resized as by `resize`.
+      image1 = gen_image_ops.decode_and_resize_jpeg(
+          jpeg0, [200, 100], channels=3, half_pixel_centers=True)
+      self.assertAllEqual([200, 100, 3], image1.get_shape().as_list())
+      self.assertAllEqual(
+          image_ops.resize_images_v2(image0, [200, 100]), image1)
+
+      # The image is decoded at a quarter of its size.
+      image2 = gen_image_ops.decode_and_resize_jpeg(
+          jpeg0, [64, 32], channels=3)
+      self.assertAllEqual(
+          math_ops.cast(
+              image_ops.decode_jpeg(jpeg0, channels=3, ratio=4),
+              dtypes.float32), image2)
+
+      # The image is decoded at a quarter of its size, and resized.
+      image3 = gen_image_ops.decode_and_resize_jpeg(
+          jpeg0, [50, 20], channels=3, half_pixel_centers=True)
+      image3, resized = self.evaluate(
+          [image3, image_ops.resize_images_v2(image0, [50, 20])])
+      self.assertLess(self.averageError(resized, image3), 8)
+
   def testSynthetic(self):
     with self.cached_session():
       # Encode it, then decode it, then encode it
@@ -290,6 +290,30 @@ class MatMulTest(test_util.TensorFlowTestCase, parameterized.TestCase):
     c = math_ops.matmul(a, b, output_type=dtypes.int32)
     self.assertAllEqual(c, c_np)
 
+  @parameterized.parameters(([2, 8, 16], [2, 16, 4], False, False),
+                            ([3, 2, 16, 8], [2, 4, 16], True, True),
+                            ([1, 8, 16], [3, 16, 12], False, False))
+  def testInt8MatmulLargerShapes(self, a_shape, b_shape, adjoint_a, adjoint_b):
+    # The shapes are large enough for the tensor cores on GPU, and broadcast.
+    np.random.seed(42)
+    a_np = np.random.randint(-128, 128, size=a_shape).astype(np.int8)
+    b_np = np.random.randint(-128, 128, size=b_shape).astype(np.int8)
+    a = constant_op.constant(a_np)
+    b = constant_op.constant(b_np)
+    c = math_ops.matmul(
+        a,
+        b,
+        adjoint_a=adjoint_a,
+        adjoint_b=adjoint_b,
+        output_type=dtypes.int32)
+    a_np = a_np.astype(np.int32)
+    b_np = b_np.astype(np.int32)
+    if adjoint_a:
+      a_np = np.swapaxes(a_np, -1, -2)
+    if adjoint_b:
+      b_np = np.swapaxes(b_np, -1, -2)
+    self.assertAllEqual(c, np.matmul(a_np, b_np))
+
   @parameterized.parameters((dtypes.int8), (dtypes.uint8))
   def testMixPrecMatmul(self, b_dtype):
     a = constant_op.constant(
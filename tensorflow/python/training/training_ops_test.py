@@ -27,7 +27,7 @@ from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import test_util
 from tensorflow.python.framework.test_util import TensorFlowTestCase
 # Import resource_variable_ops for the variables-to-tensor implicit conversion.
-from tensorflow.python.ops import resource_variable_ops  # pylint: disable=unused-import
+from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import variables
 from tensorflow.python.platform import googletest
 from tensorflow.python.training import training_ops
@@ -455,6 +455,86 @@ class TrainingOpsTest(TensorFlowTestCase):
     param_t = param - alpha_t * m_t / (np.sqrt(v_t) + epsilon)
     return param_t, m_t, v_t
 
+  def _multiVariables(self, values):
+    return [
+        resource_variable_ops.ResourceVariable(value) for value in values
+    ]
+
+  @test_util.run_deprecated_v1
+  def testResourceApplyAdamMulti(self):
+    # Including an empty variable, and more variables than are passed to the
+    # GPU kernel without a copy.
+    shapes = [[3], [0], [2, 5]] + [[7]] * 8
+    for dtype, use_gpu in itertools.product(
+        [np.float16, np.float32, np.float64], [False, True]):
+      var = [np.random.rand(*shape).astype(dtype) for shape in shapes]
+      m = [np.random.rand(*shape).astype(dtype) for shape in shapes]
+      v = [np.random.rand(*shape).astype(dtype) for shape in shapes]
+      grad = [np.random.rand(*shape).astype(dtype) for shape in shapes]
+      beta1 = np.array(0.9, dtype=dtype)
+      beta2 = np.array(0.999, dtype=dtype)
+      lr = np.array(0.001, dtype=dtype)
+      epsilon = np.array(1e-8, dtype=dtype)
+      with self.session(use_gpu=use_gpu):
+        var_t = self._multiVariables(var)
+        m_t = self._multiVariables(m)
+        v_t = self._multiVariables(v)
+        self.evaluate(variables.global_variables_initializer())
+        self.evaluate(
+            training_ops.resource_apply_adam_multi(
+                [t.handle for t in var_t], [t.handle for t in m_t],
+                [t.handle for t in v_t], beta1, beta2, lr, beta1, beta2,
+                epsilon, grad))
+        for i in range(len(shapes)):
+          new_var, new_m, new_v = self._adamUpdateNumpy(
+              var[i], grad[i], 1, m[i], v[i], lr, beta1, beta2, epsilon)
+          self.assertAllCloseAccordingToType(new_var, self.evaluate(var_t[i]))
+          self.assertAllCloseAccordingToType(new_m, self.evaluate(m_t[i]))
+          self.assertAllCloseAccordingToType(new_v, self.evaluate(v_t[i]))
+
+  @test_util.run_deprecated_v1
+  def testResourceApplyMomentumMulti(self):
+    shapes = [[3], [0], [2, 5]] + [[7]] * 8
+    for dtype, use_gpu, use_nesterov in itertools.product(
+        [np.float16, np.float32, np.float64], [False, True], [False, True]):
+      var = [np.random.rand(*shape).astype(dtype) for shape in shapes]
+      accum = [np.random.rand(*shape).astype(dtype) for shape in shapes]
+      grad = [np.random.rand(*shape).astype(dtype) for shape in shapes]
+      lr = np.array(0.01, dtype=dtype)
+      momentum = np.array(0.9, dtype=dtype)
+      with self.session(use_gpu=use_gpu):
+        var_t = self._multiVariables(var)
+        accum_t = self._multiVariables(accum)
+        self.evaluate(variables.global_variables_initializer())
+        self.evaluate(
+            training_ops.resource_apply_momentum_multi(
+                [t.handle for t in var_t], [t.handle for t in accum_t],
+                lr,
+                grad,
+                momentum,
+                use_nesterov=use_nesterov))
+        for i in range(len(shapes)):
+          new_accum = accum[i] * momentum + grad[i]
+          if use_nesterov:
+            new_var = var[i] - lr * (grad[i] + new_accum * momentum)
+          else:
+            new_var = var[i] - lr * new_accum
+          self.assertAllCloseAccordingToType(new_var, self.evaluate(var_t[i]))
+          self.assertAllCloseAccordingToType(new_accum,
+                                             self.evaluate(accum_t[i]))
+
+  @test_util.run_deprecated_v1
+  def testResourceApplyMomentumMultiRejectsRepeatedVariables(self):
+    with self.session():
+      var = resource_variable_ops.ResourceVariable([1.0, 2.0])
+      accum = resource_variable_ops.ResourceVariable([0.0, 0.0])
+      self.evaluate(variables.global_variables_initializer())
+      with self.assertRaisesOpError("Variables must be distinct"):
+        self.evaluate(
+            training_ops.resource_apply_momentum_multi(
+                [var.handle, var.handle], [accum.handle, accum.handle], 0.1,
+                [[1.0, 1.0], [1.0, 1.0]], 0.9))
+
 
 if __name__ == '__main__':
   googletest.main()
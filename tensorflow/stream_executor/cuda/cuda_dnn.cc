@@ -3486,7 +3486,8 @@ GetCudnnOperationGraph(dnn::ConvolutionKind kind, dnn::DataType element_type,
 port::StatusOr<std::unique_ptr<cudnn_frontend::OperationGraph>>
 GetCudnnFusedOperationGraph(
     dnn::ConvolutionKind kind, dnn::DataType element_type, double alpha,
-    double alpha2, Stream* stream, const dnn::BatchDescriptor& input_descriptor,
+    double alpha2, dnn::ActivationMode activation_mode, Stream* stream,
+    const dnn::BatchDescriptor& input_descriptor,
     const dnn::FilterDescriptor& filter_descriptor,
     const dnn::BatchDescriptor& bias_descriptor,
     const dnn::BatchDescriptor& output_descriptor,
@@ -3496,12 +3497,26 @@ GetCudnnFusedOperationGraph(
   cudnnDataType_t cudnn_type = ToCudnnDataType(element_type);
 
   // CUDNN fused operation supports the pattern in the form of
-  // Conv + Add + BiasAdd + Act. Therefore, we need to build a graph of the
-  // four ops with their input/output tensor edges:
-  // Conv   : input: tensor_x, tensor_w;    output: tensor_conv (virtual)
-  // Add    : input: tensor_conv, tensor_z; output: tensor_add (virtual)
-  // BiasAdd: input: tensor_add, tensor_b;  output: tensor_bias (virtual)
-  // Act    : input: tensor_bias;           output: tensor_y
+  // Conv + Add + BiasAdd + Act. We build a chain of the ops that are needed,
+  // each one reading the (virtual) output of the previous one:
+  // Conv   : input: tensor_x, tensor_w; output: 'C'
+  // Add    : input: 'C', tensor_z;      output: 'A', only if alpha2 != 0, so
+  //          that the side input is not read when it does not contribute.
+  // BiasAdd: input: 'A' or 'C', tensor_b; output: 'B'
+  // Act    : input: 'B';                only for kRelu.
+  // The last op writes tensor_y.
+  //
+  // The tensor UIDs match the variant pack of
+  // DoFusedConvolveWithExecutionPlanImpl.
+  if (activation_mode != dnn::ActivationMode::kNone &&
+      activation_mode != dnn::ActivationMode::kRelu) {
+    return port::UnimplementedError(
+        "cuDNN frontend fused convolution only supports Relu or None "
+        "activation.");
+  }
+  const bool use_side_input = alpha2 != 0.0;
+  const bool use_activation = activation_mode == dnn::ActivationMode::kRelu;
+
   int vector_size, vector_dim;
   std::tie(vector_size, vector_dim) =
       GetTensorVectorSizeAndDim(input_descriptor, element_type);
@@ -3542,6 +3557,7 @@ GetCudnnFusedOperationGraph(
                       .build();
   RETURN_MSG_IF_CUDNN_ERROR(tensor_y);
 
+  // Unused, but built anyway for logging when there is no side input.
   auto tensor_z = cudnn_frontend::TensorBuilder()
                       .setDim(output_dims.size(), &output_dims[0])
                       .setStrides(output_dims.size(), &output_strides[0])
@@ -3586,38 +3602,23 @@ GetCudnnFusedOperationGraph(
 
   std::tie(vector_size, vector_dim) =
       GetTensorVectorSizeAndDim(output_descriptor, element_type);
-  auto tensor_conv = cudnn_frontend::TensorBuilder()
-                         .setDim(output_dims.size(), &output_dims[0])
-                         .setStrides(output_dims.size(), &output_strides[0])
-                         .setVirtual()
-                         .setId('C')
-                         .setAlignment(32)
-                         .setDataType(cudnn_type)
-                         .setVectorCountAndDimension(vector_size, vector_dim)
-                         .build();
-  RETURN_MSG_IF_CUDNN_ERROR(tensor_conv);
-
-  auto tensor_add = cudnn_frontend::TensorBuilder()
-                        .setDim(output_dims.size(), &output_dims[0])
-                        .setStrides(output_dims.size(), &output_strides[0])
-                        .setVirtual()
-                        .setId('A')
-                        .setAlignment(32)
-                        .setDataType(cudnn_type)
-                        .setVectorCountAndDimension(vector_size, vector_dim)
-                        .build();
-  RETURN_MSG_IF_CUDNN_ERROR(tensor_add);
-
-  auto tensor_bias = cudnn_frontend::TensorBuilder()
-                         .setDim(output_dims.size(), &output_dims[0])
-                         .setStrides(output_dims.size(), &output_strides[0])
-                         .setVirtual()
-                         .setId('B')
-                         .setAlignment(32)
-                         .setDataType(cudnn_type)
-                         .setVectorCountAndDimension(vector_size, vector_dim)
-                         .build();
-  RETURN_MSG_IF_CUDNN_ERROR(tensor_bias);
+  // Intermediate tensors between the ops, which are not materialized.
+  std::vector<cudnn_frontend::Tensor> virtual_tensors;
+  virtual_tensors.reserve(3);
+  auto next_output = [&](bool is_last, int64 id) -> cudnn_frontend::Tensor& {
+    if (is_last) return tensor_y;
+    virtual_tensors.push_back(
+        cudnn_frontend::TensorBuilder()
+            .setDim(output_dims.size(), &output_dims[0])
+            .setStrides(output_dims.size(), &output_strides[0])
+            .setVirtual()
+            .setId(id)
+            .setAlignment(32)
+            .setDataType(cudnn_type)
+            .setVectorCountAndDimension(vector_size, vector_dim)
+            .build());
+    return virtual_tensors.back();
+  };
 
   // conv_desc.
   auto mode = convolution_descriptor.convolution_not_crosscorr()
@@ -3646,86 +3647,98 @@ GetCudnnFusedOperationGraph(
   // Beta is the scaling factor for output.
   double beta = 0.0;
 
+  std::vector<cudnn_frontend::Operation> ops;
+  ops.reserve(4);
+
   // CUDNN Operation
-  auto conv_op = cudnn_frontend::OperationBuilder(conv_mode)
-                     .setxDesc(tensor_x)
-                     .setyDesc(tensor_conv)
-                     .setwDesc(tensor_w)
-                     .setcDesc(conv_desc)
-                     .setAlpha(alpha)
-                     .setBeta(beta)
-                     .build();
-  RETURN_MSG_IF_CUDNN_ERROR(conv_op);
+  cudnn_frontend::Tensor& tensor_conv = next_output(false, 'C');
+  RETURN_MSG_IF_CUDNN_ERROR(tensor_conv);
+  ops.push_back(cudnn_frontend::OperationBuilder(conv_mode)
+                    .setxDesc(tensor_x)
+                    .setyDesc(tensor_conv)
+                    .setwDesc(tensor_w)
+                    .setcDesc(conv_desc)
+                    .setAlpha(alpha)
+                    .setBeta(beta)
+                    .build());
+  RETURN_MSG_IF_CUDNN_ERROR(ops.back());
+  cudnn_frontend::Tensor* last_output = &tensor_conv;
 
   auto add_desc = cudnn_frontend::PointWiseDescBuilder()
                       .setMode(CUDNN_POINTWISE_ADD)
                       .setMathPrecision(cudnn_type)
                       .build();
-  auto add_op = cudnn_frontend::OperationBuilder(
+  RETURN_MSG_IF_CUDNN_ERROR(add_desc);
+  if (use_side_input) {
+    // The convolution output is already scaled by alpha.
+    cudnn_frontend::Tensor& tensor_add = next_output(false, 'A');
+    RETURN_MSG_IF_CUDNN_ERROR(tensor_add);
+    ops.push_back(cudnn_frontend::OperationBuilder(
+                      CUDNN_BACKEND_OPERATION_POINTWISE_DESCRIPTOR)
+                      .setxDesc(*last_output)
+                      .setbDesc(tensor_z)
+                      .setyDesc(tensor_add)
+                      .setpwDesc(add_desc)
+                      .setAlpha(1.0)
+                      .setAlpha2(alpha2)
+                      .build());
+    RETURN_MSG_IF_CUDNN_ERROR(ops.back());
+    last_output = &tensor_add;
+  }
+
+  cudnn_frontend::Tensor& tensor_bias = next_output(!use_activation, 'B');
+  RETURN_MSG_IF_CUDNN_ERROR(tensor_bias);
+  ops.push_back(cudnn_frontend::OperationBuilder(
                     CUDNN_BACKEND_OPERATION_POINTWISE_DESCRIPTOR)
-                    .setxDesc(conv_op.getOutputTensor())
-                    .setbDesc(tensor_z)
-                    .setyDesc(tensor_add)
+                    .setxDesc(*last_output)
+                    .setbDesc(tensor_b)
+                    .setyDesc(tensor_bias)
                     .setpwDesc(add_desc)
-                    .setAlpha(alpha)
-                    .setAlpha2(alpha2)
-                    .build();
-  RETURN_MSG_IF_CUDNN_ERROR(add_op);
-
-  auto bias_add_desc = cudnn_frontend::PointWiseDescBuilder()
-                           .setMode(CUDNN_POINTWISE_ADD)
-                           .setMathPrecision(cudnn_type)
-                           .build();
-
-  auto bias_add_op = cudnn_frontend::OperationBuilder(
-                         CUDNN_BACKEND_OPERATION_POINTWISE_DESCRIPTOR)
-                         .setxDesc(add_op.getOutputTensor())
-                         .setbDesc(tensor_b)
-                         .setyDesc(tensor_bias)
-                         .setpwDesc(bias_add_desc)
-                         .build();
-  RETURN_MSG_IF_CUDNN_ERROR(bias_add_op);
+                    .build());
+  RETURN_MSG_IF_CUDNN_ERROR(ops.back());
+  last_output = &tensor_bias;
 
   auto act_desc = cudnn_frontend::PointWiseDescBuilder()
                       .setMode(CUDNN_POINTWISE_RELU_FWD)
                       .setMathPrecision(cudnn_type)
                       .build();
-
-  auto act_op = cudnn_frontend::OperationBuilder(
-                    CUDNN_BACKEND_OPERATION_POINTWISE_DESCRIPTOR)
-                    .setxDesc(bias_add_op.getOutputTensor())
-                    .setyDesc(tensor_y)
-                    .setpwDesc(act_desc)
-                    .build();
-  RETURN_MSG_IF_CUDNN_ERROR(bias_add_op);
+  RETURN_MSG_IF_CUDNN_ERROR(act_desc);
+  if (use_activation) {
+    ops.push_back(cudnn_frontend::OperationBuilder(
+                      CUDNN_BACKEND_OPERATION_POINTWISE_DESCRIPTOR)
+                      .setxDesc(*last_output)
+                      .setyDesc(tensor_y)
+                      .setpwDesc(act_desc)
+                      .build());
+    RETURN_MSG_IF_CUDNN_ERROR(ops.back());
+  }
 
   // CUDNN OperationGraph
-  std::array<cudnn_frontend::Operation const*, 4> ops = {&conv_op, &add_op,
-                                                         &bias_add_op, &act_op};
-
+  std::vector<cudnn_frontend::Operation const*> op_ptrs;
+  for (const cudnn_frontend::Operation& op : ops) {
+    op_ptrs.push_back(&op);
+  }
   auto op_graph = cudnn_frontend::OperationGraphBuilder()
                       .setHandle(cudnn.handle())
-                      .setOperationGraph(ops.size(), ops.data())
+                      .setOperationGraph(op_ptrs.size(), op_ptrs.data())
                       .build();
   RETURN_MSG_IF_CUDNN_ERROR(op_graph);
 
-  VLOG(4) << "\nTensor_x: " << tensor_x.describe()
-          << "\nTensor_y: " << tensor_y.describe()
-          << "\nTensor_z: " << tensor_z.describe()
-          << "\nTensor_w: " << tensor_w.describe()
-          << "\nTensor_b: " << tensor_b.describe()
-          << "\nTensor_conv: " << tensor_conv.describe()
-          << "\nTensor_add: " << tensor_add.describe()
-          << "\nTensor_bias: " << tensor_bias.describe()
-          << "\nConv: " << conv_desc.describe()
-          << "\nAdd: " << add_desc.describe()
-          << "\nBiasAdd: " << bias_add_desc.describe()
-          << "\nAct: " << act_desc.describe()
-          << "\nConvOp: " << conv_op.describe()
-          << "\nAddOp: " << add_op.describe()
-          << "\nBiasAddOp: " << bias_add_op.describe()
-          << "\nActOp: " << act_op.describe()
-          << "\nOpGraph: " << op_graph.describe();
+  if (VLOG_IS_ON(4)) {
+    std::ostringstream oss;
+    oss << "\nTensor_x: " << tensor_x.describe()
+        << "\nTensor_y: " << tensor_y.describe()
+        << "\nTensor_z: " << tensor_z.describe()
+        << "\nTensor_w: " << tensor_w.describe()
+        << "\nTensor_b: " << tensor_b.describe()
+        << "\nConv: " << conv_desc.describe()
+        << "\nAdd: " << add_desc.describe()
+        << "\nAct: " << act_desc.describe();
+    for (const cudnn_frontend::Operation& op : ops) {
+      oss << "\nOp: " << op.describe();
+    }
+    VLOG(4) << oss.str() << "\nOpGraph: " << op_graph.describe();
+  }
 
   return std::unique_ptr<cudnn_frontend::OperationGraph>(
       new cudnn_frontend::OperationGraph(std::move(op_graph)));
@@ -4262,8 +4275,9 @@ port::Status CudnnSupport::DoFusedConvolveWithExecutionPlanImpl(
         std::unique_ptr<cudnn_frontend::OperationGraph> op_graph,
         GetCudnnFusedOperationGraph(
             dnn::ConvolutionKind::FORWARD, accumulator_type, conv_input_scale,
-            side_input_scale, stream, conv_input_descriptor, filter_descriptor,
-            bias_descriptor, output_descriptor, convolution_descriptor, cudnn));
+            side_input_scale, activation_mode, stream, conv_input_descriptor,
+            filter_descriptor, bias_descriptor, output_descriptor,
+            convolution_descriptor, cudnn));
 
     SE_ASSIGN_OR_RETURN(current_plan, GetFirstWorkingExecutionPlan(
                                           stream, element_type, op_graph,
@@ -4303,15 +4317,19 @@ port::Status CudnnSupport::DoFusedConvolveWithExecutionPlanImpl(
     }
   }
 
+  // The side input is only part of the graph if it has a non-zero scale, see
+  // GetCudnnFusedOperationGraph.
   void* data_ptrs[] = {
       const_cast<void*>(conv_input_data.opaque()), output_data.opaque(),
-      const_cast<void*>(filter_data.opaque()), output_data.opaque(),
-      const_cast<void*>(biases.opaque())};
-  int64_t uids[] = {'x', 'y', 'w', 'z', 'b'};
+      const_cast<void*>(filter_data.opaque()),
+      const_cast<void*>(biases.opaque()),
+      const_cast<void*>(side_input_data.opaque())};
+  int64_t uids[] = {'x', 'y', 'w', 'b', 'z'};
+  const int num_data_ptrs = side_input_scale != 0.0 ? 5 : 4;
   auto variantPack = cudnn_frontend::VariantPackBuilder()
                          .setWorkspacePointer(scratch_memory.opaque())
-                         .setDataPointers(5, data_ptrs)
-                         .setUids(5, uids)
+                         .setDataPointers(num_data_ptrs, data_ptrs)
+                         .setUids(num_data_ptrs, uids)
                          .build();
   RETURN_MSG_IF_CUDNN_ERROR(variantPack);
 
@@ -4447,7 +4465,8 @@ bool CudnnSupport::GetConvolveExecutionPlans(
 
 port::Status CudnnSupport::GetFusedConvolveExecutionPlans(
     dnn::ConvolutionKind kind, dnn::DataType element_type,
-    double conv_input_scale, double side_input_scale, Stream* stream,
+    double conv_input_scale, double side_input_scale,
+    dnn::ActivationMode activation_mode, Stream* stream,
     const dnn::BatchDescriptor& input_descriptor,
     const dnn::FilterDescriptor& filter_descriptor,
     const dnn::BatchDescriptor& bias_descriptor,
@@ -4457,9 +4476,9 @@ port::Status CudnnSupport::GetFusedConvolveExecutionPlans(
 #if CUDNN_VERSION >= 8100 && TF_ENABLE_CUDNN_FRONTEND
   auto cudnn = cudnn_->GetHandle(parent_, stream);
   auto op_graph_status = GetCudnnFusedOperationGraph(
-      kind, element_type, conv_input_scale, side_input_scale, stream,
-      input_descriptor, filter_descriptor, bias_descriptor, output_descriptor,
-      convolution_descriptor, cudnn);
+      kind, element_type, conv_input_scale, side_input_scale, activation_mode,
+      stream, input_descriptor, filter_descriptor, bias_descriptor,
+      output_descriptor, convolution_descriptor, cudnn);
   if (!op_graph_status.status().ok()) {
     return port::Status(port::error::INTERNAL, "Cudnn graph failed to build.");
   }
@@ -220,9 +220,13 @@ class CudnnSupport : public dnn::DnnSupport {
       std::vector<std::unique_ptr<dnn::ConvolveExecutionPlan>>* out_exec_plans)
       override;
 
+  // Returns the execution plans of the convolution followed by the side input
+  // (if side_input_scale is non-zero), the bias and the activation (kRelu or
+  // kNone).
   port::Status GetFusedConvolveExecutionPlans(
       dnn::ConvolutionKind kind, dnn::DataType element_type,
-      double conv_input_scale, double side_input_scale, Stream* stream,
+      double conv_input_scale, double side_input_scale,
+      dnn::ActivationMode activation_mode, Stream* stream,
       const dnn::BatchDescriptor& input_descriptor,
       const dnn::FilterDescriptor& filter_descriptor,
       const dnn::BatchDescriptor& bias_descriptor,
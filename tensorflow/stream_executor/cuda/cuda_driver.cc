@@ -1053,6 +1053,68 @@ GpuDriver::CreateMemoryHandle(GpuContext* context, uint64 bytes) {
   return port::Status::OK();
 }
 
+/* static */ port::Status GpuDriver::StreamBeginCapture(GpuContext* context,
+                                                        CUstream stream) {
+  ScopedActivateContext activated{context};
+#if CUDA_VERSION >= 10010
+  // Thread-local capture, so that CUDA calls made by other threads meanwhile
+  // are not affected.
+  RETURN_IF_CUDA_RES_ERROR(
+      cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_THREAD_LOCAL),
+      "Failed to begin capturing CUDA stream");
+#else
+  RETURN_IF_CUDA_RES_ERROR(cuStreamBeginCapture(stream),
+                           "Failed to begin capturing CUDA stream");
+#endif
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      CUstream stream,
+                                                      CUgraph* graph) {
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuStreamEndCapture(stream, graph),
+                           "Failed to end capturing CUDA stream");
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(
+    GpuContext* context, CUgraph graph, CUgraphExec* graph_exec) {
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(
+      cuGraphInstantiate(graph_exec, graph, /*phErrorNode=*/nullptr,
+                         /*logBuffer=*/nullptr, /*bufferSize=*/0),
+      "Failed to instantiate CUDA graph");
+  return port::Status::OK();
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 CUgraphExec graph_exec,
+                                                 CUstream stream) {
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuGraphLaunch(graph_exec, stream),
+                           "Failed to launch CUDA graph");
+  return port::Status::OK();
+}
+
+/* static */ void GpuDriver::DestroyGraph(GpuContext* context,
+                                          CUgraph graph) {
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphDestroy(graph);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy CUDA graph: " << ToString(res);
+  }
+}
+
+/* static */ void GpuDriver::DestroyGraphExec(GpuContext* context,
+                                              CUgraphExec graph_exec) {
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphExecDestroy(graph_exec);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy executable CUDA graph: " << ToString(res);
+  }
+}
+
 /* static */ bool GpuDriver::IsStreamIdle(GpuContext* context,
                                           CUstream stream) {
   ScopedActivateContext activated{context};
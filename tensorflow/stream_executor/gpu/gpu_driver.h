@@ -404,6 +404,38 @@ class GpuDriver {
   // the stream immediately after this returns).
   static bool IsStreamIdle(GpuContext* context, GpuStreamHandle stream);
 
+  // Starts capturing the work that the calling thread enqueues onto stream
+  // into a graph, via cuStreamBeginCapture.  The work is not executed.
+  // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__STREAM.html
+  static port::Status StreamBeginCapture(GpuContext* context,
+                                         GpuStreamHandle stream);
+
+  // Stops the capture started by StreamBeginCapture, and returns the captured
+  // graph via cuStreamEndCapture.  The caller owns the graph.
+  // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__STREAM.html
+  static port::Status StreamEndCapture(GpuContext* context,
+                                       GpuStreamHandle stream,
+                                       GpuGraphHandle* graph);
+
+  // Creates an executable graph from graph via cuGraphInstantiate.  The caller
+  // owns the executable graph.
+  // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html
+  static port::Status GraphInstantiate(GpuContext* context,
+                                       GpuGraphHandle graph,
+                                       GpuGraphExecHandle* graph_exec);
+
+  // Enqueues the work of graph_exec onto stream via cuGraphLaunch.
+  // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html
+  static port::Status GraphLaunch(GpuContext* context,
+                                  GpuGraphExecHandle graph_exec,
+                                  GpuStreamHandle stream);
+
+  // Destroys a graph, or an executable graph once the work it is running has
+  // completed.
+  static void DestroyGraph(GpuContext* context, GpuGraphHandle graph);
+  static void DestroyGraphExec(GpuContext* context,
+                               GpuGraphExecHandle graph_exec);
+
   // Returns whether code in the from context can access memory in the to
   // context via cuDeviceCanAccessPeer.
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__PEER__ACCESS.html#group__CUDA__PEER__ACCESS_1g496bdaae1f632ebfb695b99d2c40f19e
@@ -60,6 +60,9 @@ using GpuSharedMemConfig = hipSharedMemConfig;
 using GpuComplexType = hipComplex;
 using GpuDoubleComplexType = hipDoubleComplex;
 using GpuRngHandle = hiprandGenerator_t;
+// Graphs are not supported on ROCm yet.
+using GpuGraphHandle = void*;
+using GpuGraphExecHandle = void*;
 
 #else  // CUDA
 
@@ -79,6 +82,8 @@ using GpuSharedMemConfig = CUsharedconfig;
 using GpuComplexType = cuComplex;
 using GpuDoubleComplexType = cuDoubleComplex;
 using GpuRngHandle = curandGenerator_t;
+using GpuGraphHandle = CUgraph;
+using GpuGraphExecHandle = CUgraphExec;
 
 #endif
 
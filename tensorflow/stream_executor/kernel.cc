@@ -19,6 +19,9 @@ limitations under the License.
 
 #include "tensorflow/stream_executor/kernel.h"
 
+#include <cstddef>
+#include <cstring>
+
 #include "absl/strings/string_view.h"
 #include "absl/strings/strip.h"
 #include "tensorflow/stream_executor/lib/demangle.h"
@@ -98,4 +101,36 @@ void KernelBase::set_name(absl::string_view name) {
       port::Demangle(absl::StripPrefix(name, "__device_stub_").data());
 }
 
+KernelArgsArrayCopy::KernelArgsArrayCopy(const KernelArgsArrayBase &args)
+    : total_shared_memory_bytes_(args.number_of_shared_bytes()) {
+  constexpr size_t kAlignment = alignof(std::max_align_t);
+  std::vector<size_t> offsets;
+  size_t storage_size = 0;
+  KernelArgIterator it = args.arg_iterator();
+  for (size_t index = 0; it.has_next(); ++index) {
+    KernelArg arg = it.next();
+    if (arg.is_shared) {
+      shared_memory_bytes_.push_back(arg.size);
+      shared_memory_indices_.push_back(index);
+    } else {
+      offsets.push_back(storage_size);
+      argument_sizes_.push_back(arg.size);
+      storage_size += (arg.size + kAlignment - 1) / kAlignment * kAlignment;
+    }
+  }
+
+  // Copy the values once the storage has its final size, so that the
+  // addresses stay valid.
+  storage_.resize(storage_size);
+  argument_addresses_.reserve(offsets.size());
+  it = args.arg_iterator();
+  for (size_t i = 0; it.has_next();) {
+    KernelArg arg = it.next();
+    if (arg.is_shared) continue;
+    char *value = storage_.data() + offsets[i++];
+    std::memcpy(value, arg.address, arg.size);
+    argument_addresses_.push_back(value);
+  }
+}
+
 }  // namespace stream_executor
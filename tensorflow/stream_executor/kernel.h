@@ -494,6 +494,48 @@ class KernelArgsArray : public KernelArgsArrayBase {
   size_t number_of_generic_arguments_ = 0;
 };
 
+// A copy of the arguments of another KernelArgsArrayBase that owns the argument
+// values, so that a launch can be issued after the original array is gone, e.g.
+// by a launch batch (see Stream::BeginLaunchBatch).
+class KernelArgsArrayCopy : public KernelArgsArrayBase {
+ public:
+  explicit KernelArgsArrayCopy(const KernelArgsArrayBase &args);
+
+  // Not copyable: argument_addresses_ points into storage_. Moving keeps the
+  // heap buffer of storage_ and therefore the addresses valid.
+  KernelArgsArrayCopy(KernelArgsArrayCopy &&) = default;
+  KernelArgsArrayCopy &operator=(KernelArgsArrayCopy &&) = default;
+
+  size_t number_of_arguments() const override {
+    return argument_addresses_.size() + shared_memory_bytes_.size();
+  }
+
+  uint64 number_of_shared_bytes() const override {
+    return total_shared_memory_bytes_;
+  }
+
+  port::ArraySlice<const void *> argument_addresses() const override {
+    return argument_addresses_;
+  }
+
+  KernelArgIterator arg_iterator() const override {
+    return KernelArgIterator(
+        argument_addresses_.size(), shared_memory_bytes_.size(),
+        argument_addresses_.data(), argument_sizes_.data(),
+        shared_memory_bytes_.data(), shared_memory_indices_.data());
+  }
+
+ private:
+  // Values of the non-shared-memory arguments, each aligned to
+  // alignof(std::max_align_t).
+  std::vector<char> storage_;
+  std::vector<const void *> argument_addresses_;
+  std::vector<size_t> argument_sizes_;
+  std::vector<size_t> shared_memory_bytes_;
+  std::vector<size_t> shared_memory_indices_;
+  uint64 total_shared_memory_bytes_ = 0;
+};
+
 // Typed variant of KernelBase, like a typed device function pointer. See the
 // file comment for details and example usage.
 //
@@ -816,6 +816,38 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return port::Status::OK();
 }
 
+/* static */ port::Status GpuDriver::StreamBeginCapture(
+    GpuContext* context, GpuStreamHandle stream) {
+  return port::Status{port::error::UNIMPLEMENTED,
+                      "Graphs are not supported on ROCm"};
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      GpuStreamHandle stream,
+                                                      GpuGraphHandle* graph) {
+  return port::Status{port::error::UNIMPLEMENTED,
+                      "Graphs are not supported on ROCm"};
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(
+    GpuContext* context, GpuGraphHandle graph, GpuGraphExecHandle* graph_exec) {
+  return port::Status{port::error::UNIMPLEMENTED,
+                      "Graphs are not supported on ROCm"};
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 GpuGraphExecHandle graph_exec,
+                                                 GpuStreamHandle stream) {
+  return port::Status{port::error::UNIMPLEMENTED,
+                      "Graphs are not supported on ROCm"};
+}
+
+/* static */ void GpuDriver::DestroyGraph(GpuContext* context,
+                                          GpuGraphHandle graph) {}
+
+/* static */ void GpuDriver::DestroyGraphExec(GpuContext* context,
+                                              GpuGraphExecHandle graph_exec) {}
+
 /* static */ bool GpuDriver::IsStreamIdle(GpuContext* context,
                                           GpuStreamHandle stream) {
   ScopedActivateContext activated{context};
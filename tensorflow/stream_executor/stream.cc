@@ -329,6 +329,8 @@ Stream &Stream::InitWithTimer(Timer *timer) {
 Stream &Stream::ThenRecordEvent(Event *event) {
   VLOG_CALL(PARAM(event));
 
+  FlushLaunches().IgnoreError();
+
   port::Status status = parent_->RecordEvent(this, event);
   if (!status.ok()) {
     LOG(ERROR) << "Error recording event in stream: " << status.error_message()
@@ -1179,6 +1181,8 @@ void Stream::ReturnSubStream(Stream *sub_stream) {
 Stream &Stream::ThenStartTimer(Timer *t) {
   VLOG_CALL(PARAM(t));
 
+  FlushLaunches().IgnoreError();
+
   CheckError(parent_->StartTimer(this, t));
   return *this;
 }
@@ -1186,6 +1190,8 @@ Stream &Stream::ThenStartTimer(Timer *t) {
 Stream &Stream::ThenStopTimer(Timer *t) {
   VLOG_CALL(PARAM(t));
 
+  FlushLaunches().IgnoreError();
+
   CheckError(parent_->StopTimer(this, t));
   return *this;
 }
@@ -1194,6 +1200,8 @@ Stream &Stream::ThenWaitFor(Stream *other) {
   VLOG_CALL(PARAM(other));
 
   CHECK(this != other) << "stream cannot wait for itself";
+  FlushLaunches().IgnoreError();
+  other->FlushLaunches().IgnoreError();
   if (ok() && other->ok()) {
     CheckError(parent_->CreateStreamDependency(this, other));
   } else {
@@ -1207,6 +1215,8 @@ Stream &Stream::ThenWaitFor(Stream *other) {
 Stream &Stream::ThenWaitFor(Event *event) {
   VLOG_CALL(PARAM(event));
 
+  FlushLaunches().IgnoreError();
+
   if (ok()) {
     port::Status status = parent_->WaitForEvent(this, event);
     if (!status.ok()) {
@@ -4276,6 +4286,8 @@ Stream &Stream::ThenTransformTensor(const dnn::BatchDescriptor &input_desc,
 Stream &Stream::ThenDoHostCallback(std::function<void()> callback) {
   VLOG_CALL(PARAM(callback));
 
+  FlushLaunches().IgnoreError();
+
   if (!ok()) {
     LOG(INFO) << DebugStreamPointers()
               << " was in error state before adding host callback";
@@ -4288,6 +4300,8 @@ Stream &Stream::ThenDoHostCallbackWithStatus(
     std::function<port::Status()> callback) {
   VLOG_CALL(PARAM(callback));
 
+  FlushLaunches().IgnoreError();
+
   if (!ok()) {
     LOG(INFO) << DebugStreamPointers()
               << " was in error state before adding host callback";
@@ -4421,6 +4435,8 @@ Stream &Stream::ThenEnqueueOnBackgroundThread(
 port::Status Stream::BlockHostUntilDone() {
   VLOG_CALL();
 
+  FlushLaunches().IgnoreError();
+
   if (!ok()) {
     port::Status status = port::Status(
         port::error::INTERNAL,
@@ -4438,6 +4454,50 @@ port::Status Stream::BlockHostUntilDone() {
   return error;
 }
 
+void Stream::BeginLaunchBatch() {
+  VLOG_CALL();
+
+  in_launch_batch_ = true;
+}
+
+port::Status Stream::EndLaunchBatch() {
+  VLOG_CALL();
+
+  port::Status status = FlushLaunches();
+  in_launch_batch_ = false;
+  return status;
+}
+
+port::Status Stream::FlushLaunches() {
+  if (deferred_launches_.empty()) {
+    return port::Status::OK();
+  }
+  std::vector<DeferredLaunch> launches;
+  std::swap(launches, deferred_launches_);
+  VLOG(2) << DebugStreamPointers() << " issuing " << launches.size()
+          << " deferred kernel launches";
+  for (const DeferredLaunch &launch : launches) {
+    port::Status status = parent_->implementation()->Launch(
+        this, launch.thread_dims, launch.block_dims, *launch.kernel,
+        launch.args);
+    if (!status.ok()) {
+      SetError();
+      LOG(WARNING) << "parent failed to launch deferred kernel: "
+                   << launch.kernel->name() << ": " << status;
+      return status;
+    }
+  }
+  return port::Status::OK();
+}
+
+void Stream::DeferLaunch(const ThreadDim &thread_dims,
+                         const BlockDim &block_dims, const KernelBase &kernel,
+                         const KernelArgsArrayBase &args) {
+  DCHECK(in_launch_batch_);
+  deferred_launches_.push_back(DeferredLaunch{thread_dims, block_dims, &kernel,
+                                              KernelArgsArrayCopy(args)});
+}
+
 void Stream::RunAfterBlockHostUntilDoneCallbacks() {
   std::vector<std::function<void()>> callbacks;
   {
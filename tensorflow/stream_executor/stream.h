@@ -25,6 +25,7 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <type_traits>
+#include <vector>
 
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/platform/macros.h"
@@ -2076,6 +2077,30 @@ class Stream {
   // Otherwise returns an error describing why the blocking failed.
   port::Status BlockHostUntilDone() TF_LOCKS_EXCLUDED(mu_);
 
+  // Starts deferring the kernel launches enqueued on this stream, e.g. with
+  // ThenLaunch(), instead of issuing them to the platform one by one. The
+  // deferred launches are issued back to back, in order, by FlushLaunches() or
+  // EndLaunchBatch(), and before this stream records an event, waits for or is
+  // waited for by another stream, waits for an event, starts or stops a timer,
+  // runs a host callback or blocks the host.
+  //
+  // Other work must not be enqueued on this stream while a batch is open, as
+  // it would run before the deferred launches, and the launched kernels must
+  // outlive the batch. Like the rest of the enqueue methods, this is not
+  // thread-safe.
+  void BeginLaunchBatch();
+
+  // Issues the deferred launches and stops deferring. Returns the error of the
+  // first launch that failed, if any, which also puts the stream in an error
+  // state.
+  port::Status EndLaunchBatch();
+
+  // Issues the deferred launches, if any, keeping the batch open.
+  port::Status FlushLaunches();
+
+  // Returns whether kernel launches on this stream are being deferred.
+  bool in_launch_batch() const { return in_launch_batch_; }
+
   // Warning! This method interacts with internal threads in
   // sometimes-unpredictable ways and is intended for GPU-Executor-internal
   // use
@@ -2153,6 +2178,20 @@ class Stream {
   template <typename... Args>
   friend struct ThenBlasImpl;  // for implementing ThenBlasXXX.
   friend class ocl::CLBlas;    // for parent_.
+  friend class StreamExecutor;  // for DeferLaunch().
+
+  // A kernel launch deferred by a launch batch.
+  struct DeferredLaunch {
+    ThreadDim thread_dims;
+    BlockDim block_dims;
+    const KernelBase *kernel;
+    KernelArgsArrayCopy args;
+  };
+
+  // Records a launch to be issued by FlushLaunches(). Must only be called
+  // while in_launch_batch().
+  void DeferLaunch(const ThreadDim &thread_dims, const BlockDim &block_dims,
+                   const KernelBase &kernel, const KernelArgsArrayBase &args);
 
   // Checks whether types match before a call to extended BLAS version.
   template <typename InputType, typename OutputType, typename ConstantType>
@@ -2258,6 +2297,12 @@ class Stream {
   std::vector<std::function<void()>> after_block_host_until_done_callbacks_
       TF_GUARDED_BY(mu_);
 
+  // Whether a launch batch is open, see BeginLaunchBatch().
+  bool in_launch_batch_ = false;
+
+  // Launches deferred by the open launch batch, in enqueue order.
+  std::vector<DeferredLaunch> deferred_launches_;
+
   // Implementation of ThenBlasLtMatmul that is shared by all types.
   template <typename ABType, typename CType>
   Stream &ThenBlasLtMatmulImpl(const blas::IBlasLtMatmulPlan *plan,
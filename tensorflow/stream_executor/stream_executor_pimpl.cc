@@ -482,6 +482,10 @@ port::Status StreamExecutor::Launch(Stream *stream,
   SubmitTrace(&TraceListener::LaunchSubmit, stream, thread_dims, block_dims,
               kernel, args);
 
+  if (stream->in_launch_batch()) {
+    stream->DeferLaunch(thread_dims, block_dims, kernel, args);
+    return port::Status::OK();
+  }
   return implementation_->Launch(stream, thread_dims, block_dims, kernel, args);
 }
 
@@ -379,7 +379,8 @@ class StreamExecutor {
 
   port::Status GetFusedConvolveExecutionPlans(
       dnn::ConvolutionKind kind, dnn::DataType element_type,
-      double conv_input_scale, double side_input_scale, Stream *stream,
+      double conv_input_scale, double side_input_scale,
+      dnn::ActivationMode activation_mode, Stream *stream,
       const dnn::BatchDescriptor &input_descriptor,
       const dnn::FilterDescriptor &filter_descriptor,
       const dnn::BatchDescriptor &bias_descriptor,
@@ -393,9 +394,10 @@ class StreamExecutor {
       gpu::CudnnSupport *cudnn_dnn =
           dynamic_cast<gpu::CudnnSupport *>(dnn_support);
       return cudnn_dnn->GetFusedConvolveExecutionPlans(
-          kind, element_type, conv_input_scale, side_input_scale, stream,
-          input_descriptor, filter_descriptor, bias_descriptor,
-          output_descriptor, convolution_descriptor, out_exec_plans);
+          kind, element_type, conv_input_scale, side_input_scale,
+          activation_mode, stream, input_descriptor, filter_descriptor,
+          bias_descriptor, output_descriptor, convolution_descriptor,
+          out_exec_plans);
 #endif  // GOOGLE_CUDA
     }
     return port::UnimplementedError("DNN library is not found.");
@@ -0,0 +1,404 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A C++ binary that benchmarks single kernels over the dtypes and shapes of a
+// sweep config, and compares the results against a stored baseline.
+//
+// See README.md for usage instructions.
+
+#include "tensorflow/tools/benchmark/kernel_sweep.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace kernel_sweep {
+
+namespace {
+
+constexpr char kKernelNodeName[] = "kernel";
+
+Status ParseShape(absl::string_view text, TensorShape* shape) {
+  if (text == "scalar") {
+    *shape = TensorShape({});
+    return Status::OK();
+  }
+  std::vector<int64> dims;
+  for (absl::string_view dim : absl::StrSplit(text, 'x')) {
+    int64 size;
+    if (!strings::safe_strto64(dim, &size) || size < 0) {
+      return errors::InvalidArgument("Invalid shape: ", text);
+    }
+    dims.push_back(size);
+  }
+  return TensorShapeUtils::MakeShape(dims, shape);
+}
+
+Status ParseLine(absl::string_view line, std::vector<KernelSweepCase>* cases) {
+  std::vector<string> tokens =
+      absl::StrSplit(line, absl::ByAnyChar(" \t"), absl::SkipEmpty());
+  if (tokens.size() < 3) {
+    return errors::InvalidArgument(
+        "Expected \"<op> <dtypes> <shapes> [<attr>=<value>...]\", got: ", line);
+  }
+  const OpDef* op_def;
+  TF_RETURN_IF_ERROR(OpRegistry::Global()->LookUpOpDef(tokens[0], &op_def));
+
+  NodeDef node_def;
+  node_def.set_name(kKernelNodeName);
+  node_def.set_op(tokens[0]);
+  const std::vector<string> attr_tokens(tokens.begin() + 3, tokens.end());
+  for (const string& attr : attr_tokens) {
+    const std::vector<string> name_and_value =
+        absl::StrSplit(attr, absl::MaxSplits('=', 1));
+    const OpDef::AttrDef* attr_def =
+        name_and_value.size() == 2 ? FindAttr(name_and_value[0], *op_def)
+                                   : nullptr;
+    if (attr_def == nullptr) {
+      return errors::InvalidArgument("Invalid attr ", attr, " for op ",
+                                     tokens[0]);
+    }
+    AttrValue value;
+    if (!ParseAttrValue(attr_def->type(), name_and_value[1], &value)) {
+      return errors::InvalidArgument("Could not parse attr ", attr,
+                                     " of type ", attr_def->type());
+    }
+    (*node_def.mutable_attr())[name_and_value[0]] = value;
+  }
+
+  for (absl::string_view dtype_name : absl::StrSplit(tokens[1], ',')) {
+    DataType dtype;
+    if (!DataTypeFromString(dtype_name, &dtype)) {
+      return errors::InvalidArgument("Invalid dtype: ", dtype_name);
+    }
+    NodeDef typed_node_def = node_def;
+    for (const OpDef::AttrDef& attr_def : op_def->attr()) {
+      if (attr_def.type() == "type" && !attr_def.has_default_value() &&
+          typed_node_def.attr().count(attr_def.name()) == 0) {
+        SetAttrValue(dtype, &(*typed_node_def.mutable_attr())[attr_def.name()]);
+      }
+    }
+    AddDefaultsToNodeDef(*op_def, &typed_node_def);
+
+    for (absl::string_view shapes : absl::StrSplit(tokens[2], '|')) {
+      KernelSweepCase sweep_case;
+      sweep_case.name =
+          strings::StrCat(tokens[0], "/", dtype_name, "/", shapes);
+      if (!attr_tokens.empty()) {
+        strings::StrAppend(&sweep_case.name, "/",
+                           absl::StrJoin(attr_tokens, ","));
+      }
+      sweep_case.node_def = typed_node_def;
+      for (absl::string_view shape : absl::StrSplit(shapes, ';')) {
+        sweep_case.input_shapes.emplace_back();
+        TF_RETURN_IF_ERROR(ParseShape(shape, &sweep_case.input_shapes.back()));
+      }
+      cases->push_back(std::move(sweep_case));
+    }
+  }
+  return Status::OK();
+}
+
+int64 NumBytes(DataType dtype, const TensorShape& shape) {
+  return DataTypeSize(dtype) * shape.num_elements();
+}
+
+}  // namespace
+
+Status ParseKernelSweepConfig(const string& config,
+                              std::vector<KernelSweepCase>* cases) {
+  for (absl::string_view line : absl::StrSplit(config, '\n')) {
+    line = absl::StripAsciiWhitespace(line);
+    if (line.empty() || line[0] == '#') continue;
+    TF_RETURN_IF_ERROR(ParseLine(line, cases));
+  }
+  return Status::OK();
+}
+
+Status RunKernelSweepCase(const KernelSweepCase& sweep_case,
+                          const KernelSweepOptions& options,
+                          KernelSweepResult* result) {
+  const OpDef* op_def;
+  TF_RETURN_IF_ERROR(
+      OpRegistry::Global()->LookUpOpDef(sweep_case.node_def.op(), &op_def));
+  DataTypeVector input_types;
+  DataTypeVector output_types;
+  TF_RETURN_IF_ERROR(InOutTypesForNode(sweep_case.node_def, *op_def,
+                                       &input_types, &output_types));
+  if (input_types.size() != sweep_case.input_shapes.size()) {
+    return errors::InvalidArgument(sweep_case.name, " has ",
+                                   sweep_case.input_shapes.size(),
+                                   " input shapes, but the op takes ",
+                                   input_types.size(), " inputs");
+  }
+
+  // Inputs are constants so that no feed is copied to the device in every
+  // run. TensorProtos without values hold zeros.
+  const string device = options.device == "gpu" ? "/device:GPU:0"
+                                                 : "/device:CPU:0";
+  GraphDef graph;
+  NodeDef* kernel = graph.add_node();
+  *kernel = sweep_case.node_def;
+  kernel->set_device(device);
+  result->bytes = 0;
+  for (int i = 0; i < input_types.size(); ++i) {
+    NodeDef* input = graph.add_node();
+    input->set_name(strings::StrCat("input_", i));
+    input->set_op("Const");
+    input->set_device(device);
+    SetAttrValue(input_types[i], &(*input->mutable_attr())["dtype"]);
+    TensorProto value;
+    value.set_dtype(input_types[i]);
+    sweep_case.input_shapes[i].AsProto(value.mutable_tensor_shape());
+    SetAttrValue(value, &(*input->mutable_attr())["value"]);
+    kernel->add_input(input->name());
+    result->bytes += NumBytes(input_types[i], sweep_case.input_shapes[i]);
+  }
+
+  // Run the graph as is, in particular without folding the constant inputs
+  // into the kernel.
+  SessionOptions session_options;
+  ConfigProto& config = session_options.config;
+  if (options.num_threads > 0) {
+    config.set_intra_op_parallelism_threads(options.num_threads);
+    config.set_inter_op_parallelism_threads(options.num_threads);
+  }
+  config.mutable_graph_options()->mutable_optimizer_options()->set_opt_level(
+      OptimizerOptions::L0);
+  config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_disable_meta_optimizer(true);
+  std::unique_ptr<Session> session(NewSession(session_options));
+  TF_RETURN_IF_ERROR(session->Create(graph));
+
+  std::vector<string> output_names;
+  for (int i = 0; i < output_types.size(); ++i) {
+    output_names.push_back(strings::StrCat(kKernelNodeName, ":", i));
+  }
+  std::vector<Tensor> outputs;
+  TF_RETURN_IF_ERROR(session->Run({}, output_names, {}, &outputs));
+  std::vector<TensorShape> output_shapes;
+  for (const Tensor& output : outputs) {
+    output_shapes.push_back(output.shape());
+    result->bytes += NumBytes(output.dtype(), output.shape());
+  }
+  result->flops = EstimateFlops(sweep_case.node_def, sweep_case.input_shapes,
+                                output_shapes);
+
+  for (int i = 0; i < options.warmup_runs; ++i) {
+    TF_RETURN_IF_ERROR(session->Run({}, {}, {kKernelNodeName}, nullptr));
+  }
+  std::vector<double> times_us;
+  for (int i = 0; i < std::max(options.num_runs, 1); ++i) {
+    const uint64 start_us = Env::Default()->NowMicros();
+    TF_RETURN_IF_ERROR(session->Run({}, {}, {kKernelNodeName}, nullptr));
+    times_us.push_back(Env::Default()->NowMicros() - start_us);
+  }
+  std::nth_element(times_us.begin(), times_us.begin() + times_us.size() / 2,
+                   times_us.end());
+  result->time_us = times_us[times_us.size() / 2];
+  return session->Close();
+}
+
+int64 EstimateFlops(const NodeDef& node_def,
+                    const std::vector<TensorShape>& input_shapes,
+                    const std::vector<TensorShape>& output_shapes) {
+  const string& op = node_def.op();
+  if (input_shapes.empty() || output_shapes.empty()) return 0;
+  const TensorShape& input = input_shapes[0];
+  const int64 output_count = output_shapes[0].num_elements();
+  auto bool_attr = [&node_def](const string& name) {
+    auto it = node_def.attr().find(name);
+    return it != node_def.attr().end() && it->second.b();
+  };
+  if (op == "MatMul" && input.dims() == 2) {
+    const int64 k = input.dim_size(bool_attr("transpose_a") ? 0 : 1);
+    return 2 * k * output_count;
+  }
+  if ((op == "BatchMatMul" || op == "BatchMatMulV2") && input.dims() >= 2) {
+    const int64 k = input.dim_size(input.dims() - (bool_attr("adj_x") ? 2 : 1));
+    return 2 * k * output_count;
+  }
+  if ((op == "Conv2D" || op == "DepthwiseConv2dNative") &&
+      input_shapes.size() >= 2 && input_shapes[1].dims() == 4) {
+    const TensorShape& filter = input_shapes[1];
+    int64 flops = 2 * output_count * filter.dim_size(0) * filter.dim_size(1);
+    // Each output of a depthwise convolution reads a single input channel.
+    if (op == "Conv2D") flops *= filter.dim_size(2);
+    return flops;
+  }
+  if (op == "Sum" || op == "Mean" || op == "Prod" || op == "Max" ||
+      op == "Min" || op == "ArgMax" || op == "ArgMin") {
+    return input.num_elements();
+  }
+  return 0;
+}
+
+Status ReadBaseline(const string& filename,
+                    std::map<string, double>* baseline) {
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(Env::Default(), filename, &contents));
+  for (absl::string_view line : absl::StrSplit(contents, '\n')) {
+    const std::vector<string> tokens =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    if (tokens.empty()) continue;
+    double time_us;
+    if (tokens.size() != 2 || !strings::safe_strtod(tokens[1], &time_us)) {
+      return errors::InvalidArgument("Invalid baseline line in ", filename,
+                                     ": ", line);
+    }
+    (*baseline)[tokens[0]] = time_us;
+  }
+  return Status::OK();
+}
+
+Status WriteBaseline(const string& filename,
+                     const std::map<string, double>& baseline) {
+  string contents;
+  for (const auto& name_and_time : baseline) {
+    strings::StrAppend(&contents, name_and_time.first, " ",
+                       name_and_time.second, "\n");
+  }
+  return WriteStringToFile(Env::Default(), filename, contents);
+}
+
+int Main(int argc, char** argv) {
+  string config_file = "";
+  string device = "cpu";
+  int32 num_threads = -1;
+  int32 warmup_runs = 2;
+  int32 num_runs = 20;
+  string baseline_file = "";
+  string output_baseline_file = "";
+  float max_regression = 0.1;
+
+  std::vector<Flag> flag_list = {
+      Flag("config", &config_file, "sweep config file name"),
+      Flag("device", &device, "device to run the kernels on, cpu or gpu"),
+      Flag("num_threads", &num_threads, "number of threads"),
+      Flag("warmup_runs", &warmup_runs, "runs of each case before timing"),
+      Flag("num_runs", &num_runs, "timed runs of each case"),
+      Flag("baseline", &baseline_file, "baseline file to compare against"),
+      Flag("output_baseline", &output_baseline_file,
+           "file to write the results to, as a baseline for later runs"),
+      Flag("max_regression", &max_regression,
+           "fail if a case is slower than the baseline by more than this "
+           "fraction"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result || config_file.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+  port::InitMain(argv[0], &argc, &argv);
+
+  string config;
+  Status s = ReadFileToString(Env::Default(), config_file, &config);
+  std::vector<KernelSweepCase> cases;
+  if (s.ok()) s = ParseKernelSweepConfig(config, &cases);
+  if (!s.ok()) {
+    LOG(ERROR) << "Could not read sweep config: " << s;
+    return -1;
+  }
+  std::map<string, double> baseline;
+  if (!baseline_file.empty()) {
+    s = ReadBaseline(baseline_file, &baseline);
+    if (!s.ok()) {
+      LOG(ERROR) << "Could not read baseline: " << s;
+      return -1;
+    }
+  }
+
+  KernelSweepOptions options;
+  options.device = device;
+  options.num_threads = num_threads;
+  options.warmup_runs = warmup_runs;
+  options.num_runs = num_runs;
+  std::map<string, double> results;
+  int num_failures = 0;
+  int num_regressions = 0;
+  printf("%-60s %12s %10s %10s %10s\n", "case", "time_us", "GFLOP/s", "GB/s",
+         "vs_base");
+  for (const KernelSweepCase& sweep_case : cases) {
+    KernelSweepResult result;
+    s = RunKernelSweepCase(sweep_case, options, &result);
+    if (!s.ok()) {
+      LOG(ERROR) << sweep_case.name << " failed: " << s;
+      ++num_failures;
+      continue;
+    }
+    results[sweep_case.name] = result.time_us;
+    string change = "-";
+    auto it = baseline.find(sweep_case.name);
+    if (it != baseline.end() && it->second > 0) {
+      const double ratio = result.time_us / it->second - 1;
+      change = strings::StrCat(static_cast<int>(ratio * 100), "%");
+      if (ratio > max_regression) {
+        LOG(ERROR) << sweep_case.name << " regressed from " << it->second
+                   << "us to " << result.time_us << "us";
+        ++num_regressions;
+      }
+    }
+    printf("%-60s %12.1f %10.2f %10.2f %10s\n", sweep_case.name.c_str(),
+           result.time_us, result.GFlopsPerSecond(), result.GBytesPerSecond(),
+           change.c_str());
+  }
+
+  if (!output_baseline_file.empty()) {
+    s = WriteBaseline(output_baseline_file, results);
+    if (!s.ok()) {
+      LOG(ERROR) << "Could not write baseline: " << s;
+      return -1;
+    }
+  }
+  if (num_failures > 0 || num_regressions > 0) {
+    LOG(ERROR) << num_failures << " cases failed and " << num_regressions
+               << " cases regressed by more than " << max_regression * 100
+               << "%";
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace kernel_sweep
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TOOLS_BENCHMARK_KERNEL_SWEEP_H_
+#define TENSORFLOW_TOOLS_BENCHMARK_KERNEL_SWEEP_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace kernel_sweep {
+
+// One kernel invocation to benchmark: a single op run on inputs of the given
+// shapes.
+struct KernelSweepCase {
+  // Unique name of the case, e.g. "MatMul/float/256x256;256x256".
+  string name;
+  // The op to run, with all attrs set. Inputs are not set.
+  NodeDef node_def;
+  std::vector<TensorShape> input_shapes;
+};
+
+// Parses a sweep config into the cases to run. Each non-empty line that does
+// not start with '#' describes a sweep over dtypes and input shapes:
+//
+//   <op> <dtype>[,<dtype>...] <shapes>[|<shapes>...] [<attr>=<value>...]
+//
+// where <shapes> lists the shape of each input separated by ';', dimensions
+// are separated by 'x' and "scalar" is the scalar shape. Attr values use the
+// AttrValue text format of the attr type, e.g. padding="SAME" or
+// strides=[1,1,1,1]. Type attrs that are neither set nor have a default are
+// set to the swept dtype. For example:
+//
+//   MatMul float,half 256x256;256x256|1024x1024;1024x1024
+//   Sum float 1024x1024;1 keep_dims=false
+//
+// A line yields one case per dtype and shape list.
+Status ParseKernelSweepConfig(const string& config,
+                              std::vector<KernelSweepCase>* cases);
+
+struct KernelSweepOptions {
+  // "cpu" or "gpu".
+  string device = "cpu";
+  int num_threads = -1;
+  int warmup_runs = 2;
+  int num_runs = 20;
+};
+
+struct KernelSweepResult {
+  // Median wall time of one run, which includes the executor overhead of a
+  // single-op step (a few microseconds on CPU).
+  double time_us = 0;
+  // Estimated floating point operations of one run, 0 if the op has no
+  // estimate.
+  int64 flops = 0;
+  // Bytes of all inputs and outputs, as a lower bound of the memory traffic.
+  int64 bytes = 0;
+
+  double GFlopsPerSecond() const {
+    return time_us > 0 ? flops / time_us / 1e3 : 0;
+  }
+  double GBytesPerSecond() const {
+    return time_us > 0 ? bytes / time_us / 1e3 : 0;
+  }
+};
+
+// Runs `sweep_case` on the device of `options`. Inputs are zero-initialized
+// constants, which are valid indices and axes for gathers and reductions.
+Status RunKernelSweepCase(const KernelSweepCase& sweep_case,
+                          const KernelSweepOptions& options,
+                          KernelSweepResult* result);
+
+// Estimates the floating point operations of `node_def` for the given input
+// and output shapes. Only covers matrix multiplications, convolutions and
+// reductions, and returns 0 for other ops.
+int64 EstimateFlops(const NodeDef& node_def,
+                    const std::vector<TensorShape>& input_shapes,
+                    const std::vector<TensorShape>& output_shapes);
+
+// A baseline maps case names to their median time in microseconds, stored as
+// one "<name> <time_us>" line per case.
+Status ReadBaseline(const string& filename, std::map<string, double>* baseline);
+Status WriteBaseline(const string& filename,
+                     const std::map<string, double>& baseline);
+
+int Main(int argc, char** argv);
+
+}  // namespace kernel_sweep
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_TOOLS_BENCHMARK_KERNEL_SWEEP_H_
@@ -0,0 +1,109 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tools/benchmark/kernel_sweep.h"
+
+#include <map>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/resource_loader.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace kernel_sweep {
+namespace {
+
+TEST(KernelSweepTest, ParseConfig) {
+  std::vector<KernelSweepCase> cases;
+  TF_ASSERT_OK(ParseKernelSweepConfig(
+      "# Comment.\n"
+      "MatMul float,half 2x3;3x4|8x8;8x8 transpose_a=false\n"
+      "\n"
+      "GatherV2 float 10x4;3;scalar Tindices=DT_INT32 Taxis=DT_INT32\n",
+      &cases));
+  ASSERT_EQ(cases.size(), 5);
+  EXPECT_EQ(cases[0].name, "MatMul/float/2x3;3x4/transpose_a=false");
+  EXPECT_EQ(cases[0].node_def.attr().at("T").type(), DT_FLOAT);
+  EXPECT_FALSE(cases[0].node_def.attr().at("transpose_b").b());
+  ASSERT_EQ(cases[0].input_shapes.size(), 2);
+  EXPECT_EQ(cases[0].input_shapes[1], TensorShape({3, 4}));
+  EXPECT_EQ(cases[3].name, "MatMul/half/8x8;8x8/transpose_a=false");
+  EXPECT_EQ(cases[3].node_def.attr().at("T").type(), DT_HALF);
+  EXPECT_EQ(cases[4].node_def.attr().at("Tparams").type(), DT_FLOAT);
+  EXPECT_EQ(cases[4].node_def.attr().at("Tindices").type(), DT_INT32);
+  EXPECT_EQ(cases[4].input_shapes[2], TensorShape({}));
+}
+
+TEST(KernelSweepTest, ParseConfigErrors) {
+  std::vector<KernelSweepCase> cases;
+  EXPECT_FALSE(ParseKernelSweepConfig("MatMul float", &cases).ok());
+  EXPECT_FALSE(ParseKernelSweepConfig("NoSuchOp float 2x2", &cases).ok());
+  EXPECT_FALSE(ParseKernelSweepConfig("MatMul floaty 2x2;2x2", &cases).ok());
+  EXPECT_FALSE(ParseKernelSweepConfig("MatMul float 2xa;2x2", &cases).ok());
+  EXPECT_FALSE(
+      ParseKernelSweepConfig("MatMul float 2x2;2x2 foo=true", &cases).ok());
+}
+
+TEST(KernelSweepTest, RunMatMul) {
+  std::vector<KernelSweepCase> cases;
+  TF_ASSERT_OK(ParseKernelSweepConfig("MatMul float 2x3;3x4", &cases));
+  ASSERT_EQ(cases.size(), 1);
+  KernelSweepOptions options;
+  options.num_runs = 3;
+  KernelSweepResult result;
+  TF_ASSERT_OK(RunKernelSweepCase(cases[0], options, &result));
+  EXPECT_GT(result.time_us, 0);
+  EXPECT_EQ(result.flops, 2 * 3 * 2 * 4);
+  EXPECT_EQ(result.bytes, (2 * 3 + 3 * 4 + 2 * 4) * sizeof(float));
+}
+
+TEST(KernelSweepTest, RunWrongNumberOfInputs) {
+  std::vector<KernelSweepCase> cases;
+  TF_ASSERT_OK(ParseKernelSweepConfig("MatMul float 2x3", &cases));
+  KernelSweepResult result;
+  EXPECT_FALSE(
+      RunKernelSweepCase(cases[0], KernelSweepOptions(), &result).ok());
+}
+
+TEST(KernelSweepTest, CoreOpsConfigParses) {
+  string config;
+  TF_ASSERT_OK(ReadFileToString(
+      Env::Default(),
+      GetDataDependencyFilepath(io::JoinPath(
+          "tensorflow", "tools", "benchmark", "kernel_sweep_core_ops.txt")),
+      &config));
+  std::vector<KernelSweepCase> cases;
+  TF_ASSERT_OK(ParseKernelSweepConfig(config, &cases));
+  EXPECT_FALSE(cases.empty());
+}
+
+TEST(KernelSweepTest, BaselineRoundTrip) {
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "kernel_sweep_baseline.txt");
+  const std::map<string, double> baseline = {{"MatMul/float/2x2;2x2", 1.5},
+                                             {"Relu/half/8", 20}};
+  TF_ASSERT_OK(WriteBaseline(filename, baseline));
+  std::map<string, double> read;
+  TF_ASSERT_OK(ReadBaseline(filename, &read));
+  EXPECT_EQ(read, baseline);
+}
+
+}  // namespace
+}  // namespace kernel_sweep
+}  // namespace tensorflow